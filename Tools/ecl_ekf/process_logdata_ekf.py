@@ -7,7 +7,12 @@ import os
 import matplotlib.pyplot as plt
 import numpy as np
 
-from pyulog import *
+try:
+    # C++ ULog reader of the ecl python bindings (src/lib/ecl/swig/ulog_reader.i), only decodes the topics used here
+    import ulog_reader
+except ImportError:
+    ulog_reader = None
+    from pyulog import *
 
 """
 Performs a health assessment on the ecl EKF navigation estimator data contained in a an ULog file
@@ -28,8 +33,33 @@ def is_valid_directory(parser, arg):
 args = parser.parse_args()
 ulog_file_name = args.filename
 
-ulog = ULog(ulog_file_name, None)
-data = ulog.data_list
+class TopicData(object):
+    """ data of a topic, in the same form as pyulog's ULog.Data """
+    def __init__(self, name, data):
+        self.name = name
+        self.data = data
+
+def read_topic(reader, topic_name):
+    """ read all fields of the first instance of a topic into a dict of numpy arrays """
+    topic_data = {}
+    for field_name in reader.fieldNames(topic_name):
+        values = reader.column_array(topic_name, field_name, 0)
+        if reader.is_integer_field(topic_name, field_name):
+            values = values.astype(np.int64)
+        topic_data[field_name] = values
+    return topic_data
+
+if ulog_reader is not None:
+    reader = ulog_reader.ULogReader()
+    if not reader.open(ulog_file_name):
+        raise IOError('{}: {}'.format(ulog_file_name, reader.error()))
+    logged_topics = reader.topic_names()
+    data = [TopicData(topic_name, read_topic(reader, topic_name))
+            for topic_name in ['estimator_status', 'ekf2_innovations', 'sensor_preflight']
+            if topic_name in logged_topics]
+else:
+    ulog = ULog(ulog_file_name, None)
+    data = ulog.data_list
 
 # extract data from innovations and status messages
 for d in data:
@@ -0,0 +1,184 @@
+#!/usr/bin/env python
+############################################################################
+#
+#   Copyright (C) 2017 PX4 Development Team. All rights reserved.
+
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions
+# are met:
+#
+# 1. Redistributions of source code must retain the above copyright
+#    notice, this list of conditions and the following disclaimer.
+# 2. Redistributions in binary form must reproduce the above copyright
+#    notice, this list of conditions and the following disclaimer in
+#    the documentation and/or other materials provided with the
+#    distribution.
+# 3. Neither the name PX4 nor the names of its contributors may be
+#    used to endorse or promote products derived from this software
+#    without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+# FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+# COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+# INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+# BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+# OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+# AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+# LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+# ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+# POSSIBILITY OF SUCH DAMAGE.
+#
+############################################################################
+
+
+"""
+px_generate_mixer_binaries.py:
+Precompile the text mixer files for fast loading at boot.
+
+For every mixer file (*.mix) in the folder, a binary version (*.mix.bin) is
+written next to it, which the mixer command loads without parsing (see
+MixerGroup::load_from_binary() and struct mixer_binary_header_s in
+src/modules/systemlib/mixer/mixer.h for the format).
+
+The scalings are applied here exactly as the text parser does it in single
+precision, so that the loaded mixers are identical. Files that use anything
+not understood here are skipped with a warning, the text file is then used.
+"""
+
+from __future__ import print_function
+import argparse
+import math
+import os
+import struct
+import sys
+
+MIXER_BINARY_MAGIC = 0x4258494d
+MIXER_BINARY_VERSION = 1
+
+GEOMETRIES = ("4+", "4x", "4h", "4v", "4w", "4s", "4dc", "6+", "6x", "6c", "6t",
+              "8+", "8x", "8c", "6m", "6a", "2-", "3y")
+
+
+class MixerFormatError(Exception):
+    pass
+
+
+def f32(value):
+    """round to single precision"""
+    return struct.unpack('<f', struct.pack('<f', value))[0]
+
+
+def scaled(value):
+    """<value> / 10000.0f"""
+    return f32(value / 10000.0)
+
+
+def parse_line(lines, tag, count):
+    if len(lines) == 0:
+        raise MixerFormatError("missing '{}:' line".format(tag))
+    line = lines.pop(0)
+    fields = line[2:].split()
+    if not line.startswith(tag + ":") or len(fields) < count:
+        raise MixerFormatError("expected '{}:' line, got '{}'".format(tag, line))
+    try:
+        return [int(x) for x in fields[:count]]
+    except ValueError:
+        raise MixerFormatError("invalid values in '{}'".format(line))
+
+
+def pack_scaler(values):
+    return struct.pack('<5f', *[scaled(v) for v in values])
+
+
+def simple_mixer(line, lines):
+    inputs = parse_line([line], 'M', 1)[0]
+    if inputs < 0 or inputs > 255:
+        raise MixerFormatError("invalid input count in '{}'".format(line))
+    data = struct.pack('<B3x', inputs) + pack_scaler(parse_line(lines, 'O', 5))
+    for i in range(inputs):
+        s = parse_line(lines, 'S', 7)
+        if not 0 <= s[0] <= 255 or not 0 <= s[1] <= 255:
+            raise MixerFormatError("invalid control in '{}'".format(s))
+        data += struct.pack('<BB2x', s[0], s[1]) + pack_scaler(s[2:])
+    return data
+
+
+def multirotor_mixer(line):
+    fields = line[2:].split()
+    if len(fields) < 5 or fields[0] not in GEOMETRIES:
+        raise MixerFormatError("unsupported multirotor mixer '{}'".format(line))
+    s = parse_line(['R: ' + ' '.join(fields[1:])], 'R', 4)
+    return struct.pack('<8s4f', fields[0].encode('ascii'), *[scaled(v) for v in s])
+
+
+def helicopter_mixer(line, lines):
+    servos = parse_line([line], 'H', 1)[0]
+    if servos < 3 or servos > 4:
+        raise MixerFormatError("only swash plates with 3 or 4 servos are supported")
+    data = struct.pack('<B3x', servos)
+    data += struct.pack('<5f', *[scaled(v) for v in parse_line(lines, 'T', 5)])
+    data += struct.pack('<5f', *[scaled(v) for v in parse_line(lines, 'P', 5)])
+    pi = f32(3.14159265)
+    for i in range(4):
+        if i < servos:
+            s = parse_line(lines, 'S', 6)
+            angle = f32(f32(s[0] * pi) / 180.0)
+            data += struct.pack('<6f', angle, *[scaled(v) for v in s[1:]])
+        else:
+            data += struct.pack('<6f', 0, 0, 0, 0, 0, 0)
+    return data
+
+
+def compile_mixer(text):
+    """@return the binary mixer definition for the text"""
+    lines = [l.strip() for l in text.splitlines() if l.strip()]
+    records = []
+    while len(lines) > 0:
+        line = lines.pop(0)
+        if line.startswith("Z:"):
+            records.append((b'Z', b''))
+        elif line.startswith("M:"):
+            records.append((b'M', simple_mixer(line, lines)))
+        elif line.startswith("R:"):
+            records.append((b'R', multirotor_mixer(line)))
+        elif line.startswith("H:"):
+            records.append((b'H', helicopter_mixer(line, lines)))
+        else:
+            raise MixerFormatError("unexpected line '{}'".format(line))
+
+    if len(records) == 0:
+        raise MixerFormatError("no mixers")
+
+    data = struct.pack('<IHH', MIXER_BINARY_MAGIC, MIXER_BINARY_VERSION, len(records))
+    for (tag, payload) in records:
+        data += struct.pack('<cBH', tag, 0, len(payload)) + payload
+    return data
+
+
+def main():
+    # Parse commandline arguments
+    parser = argparse.ArgumentParser(description="Mixer binary generator.")
+    parser.add_argument('--folder', action="store", required=True,
+                        help="Folder with the mixer files (e.g. ROMFS scratch folder).")
+    args = parser.parse_args()
+
+    for (root, dirs, files) in os.walk(args.folder):
+        for file in sorted(files):
+            if not file.endswith(".mix"):
+                continue
+            file_path = os.path.join(root, file)
+            with open(file_path, "r") as f:
+                text = f.read()
+            try:
+                data = compile_mixer(text)
+            except MixerFormatError as e:
+                print("{}: not precompiled ({})".format(file_path, e), file=sys.stderr)
+                continue
+            with open(file_path + ".bin", "wb") as f:
+                f.write(data)
+
+
+if __name__ == '__main__':
+    main()
@@ -182,6 +182,7 @@ class uploader(object):
     INFO_FLASH_SIZE = b'\x04'        # max firmware size in bytes
 
     PROG_MULTI_MAX  = 252            # protocol max is 255, must be multiple of 4
+    PROG_WINDOW_USB = 16             # PROG_MULTI commands in flight on USB links (flow controlled)
     READ_MULTI_MAX  = 252            # protocol max is 255
 
     NSH_INIT        = bytearray(b'\x0d\x0d\x0d')
@@ -373,7 +374,6 @@ class uploader(object):
         self.__send(length)
         self.__send(data)
         self.__send(uploader.EOC)
-        self.__getSync()
 
     # verify multiple bytes in flash
     def __verify_multi(self, data):
@@ -409,22 +409,40 @@ class uploader(object):
     def __split_len(self, seq, length):
         return [seq[i:i+length] for i in range(0, len(seq), length)]
 
-    # upload code
-    def __program(self, label, fw):
+    # upload code, with up to window PROG_MULTI commands sent before their INSYNC/OK reply is read.
+    # The bootloader handles the commands in order, so the replies of a window are read as they arrive
+    # and the round trip time is only paid once per window.
+    def __program(self, label, fw, window):
         print("\n", end='')
         code = fw.image
         groups = self.__split_len(code, uploader.PROG_MULTI_MAX)
 
         uploadProgress = 0
+        pending = 0
         for bytes in groups:
             self.__program_multi(bytes)
+            pending += 1
+            if pending >= window:
+                self.__getSync()
+                pending -= 1
 
             # Print upload progress (throttled, so it does not delay upload progress)
             uploadProgress += 1
             if uploadProgress % 256 == 0:
                 self.__drawProgressBar(label, uploadProgress, len(groups))
+        while pending > 0:
+            self.__getSync()
+            pending -= 1
         self.__drawProgressBar(label, 100, 100)
 
+    # CRC of the whole flash area (rev3+)
+    def __get_crc(self):
+        self.__send(uploader.GET_CRC +
+                    uploader.EOC)
+        crc = self.__recv_int()
+        self.__getSync()
+        return crc
+
     # verify code
     def __verify_v2(self, label, fw):
         print("\n", end='')
@@ -446,10 +464,7 @@ class uploader(object):
         print("\n", end='')
         self.__drawProgressBar(label, 1, 100)
         expect_crc = fw.crc(self.fw_maxsize)
-        self.__send(uploader.GET_CRC +
-                    uploader.EOC)
-        report_crc = self.__recv_int()
-        self.__getSync()
+        report_crc = self.__get_crc()
         if report_crc != expect_crc:
             print("Expected 0x%x" % expect_crc)
             print("Got      0x%x" % report_crc)
@@ -478,7 +493,9 @@ class uploader(object):
         self.fw_maxsize = self.__getInfo(uploader.INFO_FLASH_SIZE)
 
     # upload the firmware
-    def upload(self, fw, force=False, boot_delay=None):
+    #  window: number of PROG_MULTI commands in flight, see __program()
+    #  skip_unchanged: do not erase and program if the flash already holds the firmware (rev3+)
+    def upload(self, fw, force=False, boot_delay=None, window=1, skip_unchanged=False):
         # Make sure we are doing the right thing
         if self.board_type != fw.property('board_id'):
             msg = "Firmware not suitable for this board (board_type=%u board_id=%u)" % (
@@ -528,13 +545,17 @@ class uploader(object):
                 # ignore bad character encodings
                 pass
 
-        self.__erase("Erase  ")
-        self.__program("Program", fw)
+        if skip_unchanged and self.bl_rev >= 3 and self.__get_crc() == fw.crc(self.fw_maxsize):
+            print("\nFirmware unchanged, skipping erase and program.")
 
-        if self.bl_rev == 2:
-            self.__verify_v2("Verify ", fw)
         else:
-            self.__verify_v3("Verify ", fw)
+            self.__erase("Erase  ")
+            self.__program("Program", fw, window)
+
+            if self.bl_rev == 2:
+                self.__verify_v2("Verify ", fw)
+            else:
+                self.__verify_v3("Verify ", fw)
 
         if boot_delay is not None:
             self.__set_boot_delay(boot_delay)
@@ -593,6 +614,8 @@ def main():
     parser.add_argument('--baud-flightstack', action="store", default="57600", help="Comma-separated list of baud rate of the serial port (default is 57600) when communicating with flight stack (Mavlink or NSH), only required for true serial ports.")
     parser.add_argument('--force', action='store_true', default=False, help='Override board type check and continue loading')
     parser.add_argument('--boot-delay', type=int, default=None, help='minimum boot delay to store in flash')
+    parser.add_argument('--window', type=int, default=0, help='Number of program commands sent ahead of their reply (default: %d for USB CDC ACM ports, 1 for others)' % uploader.PROG_WINDOW_USB)
+    parser.add_argument('--skip-unchanged', action='store_true', default=False, help='Do not erase and program if the board already has this firmware (compares the flash CRC)')
     parser.add_argument('firmware', action="store", help="Firmware file to be uploaded")
     args = parser.parse_args()
 
@@ -702,7 +725,16 @@ def main():
 
                 try:
                     # ok, we have a bootloader, try flashing it
-                    up.upload(fw, force=args.force, boot_delay=args.boot_delay)
+                    window = args.window
+                    if window <= 0:
+                        # USB CDC ACM is flow controlled, a true serial port (including USB serial adapters,
+                        # e.g. FTDI) may overrun the bootloader. /dev/serial/by-id links resolve to the tty.
+                        cdc_port = os.path.realpath(port) if "linux" in _platform else port
+                        usb = (any(name in cdc_port for name in ["ACM", "usbmodem"]) or
+                               any(name in port for name in ["_PX4_", "usb-3D_Robotics", "usb-The_Autopilot"]))
+                        window = uploader.PROG_WINDOW_USB if usb else 1
+                    up.upload(fw, force=args.force, boot_delay=args.boot_delay, window=window,
+                              skip_unchanged=args.skip_unchanged)
 
                 except RuntimeError as ex:
                     # print the error
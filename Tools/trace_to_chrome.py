@@ -0,0 +1,194 @@
+#!/usr/bin/env python
+
+"""
+Convert an event trace dump (written by 'trace dump <file>', see
+src/modules/systemlib/trace.h) into the Chrome trace event format, which can
+be opened in chrome://tracing or https://ui.perfetto.dev.
+
+File format (all values little endian):
+- header: char magic[8] ('PX4TRACE'), uint16 version, uint8 event size,
+  uint8 pointer size, uint32 clock frequency [Hz], uint32 event count,
+  uint32 lost count, uint32 name count
+- event count events: uint32 time, uint16 type, uint16 id, pointer arg
+- name count names: uint16 type, uint16 id, uint32 reserved, uint64 arg,
+  char name[24]
+
+Task switches become spans per task, hrt callouts and work items spans on
+their own rows. perf counter spans, uORB publications/copies and MAVLink
+messages are shown on the running task.
+Callout and worker addresses are resolved with --elf (requires nm).
+"""
+
+from __future__ import print_function
+import bisect
+import json
+import struct
+import subprocess
+import sys
+from argparse import ArgumentParser
+
+TRACE_MAGIC = b'PX4TRACE'
+TRACE_VERSION = 1
+
+TASK_RESUME = 1
+TASK_SUSPEND = 2
+HRT_CALLOUT_BEGIN = 3
+HRT_CALLOUT_END = 4
+ORB_PUBLISH = 5
+ORB_COPY = 6
+WORK_BEGIN = 7
+WORK_END = 8
+PERF_BEGIN = 9
+PERF_END = 10
+MAVLINK_SEND = 11
+
+# rows (thread ids) for the events that are not recorded on a task
+TID_HRT = 100000
+TID_WORK = 100001
+
+
+def read_trace(data):
+    """ parse a dump, return (clock frequency, lost count, events, names) """
+    header_format = '<8sHBBIIII'
+    header_size = struct.calcsize(header_format)
+    magic, version, event_size, pointer_size, frequency, event_count, lost_count, name_count = \
+        struct.unpack_from(header_format, data, 0)
+
+    if magic != TRACE_MAGIC:
+        raise ValueError('not a trace file')
+
+    if version != TRACE_VERSION:
+        raise ValueError('unsupported version %i' % version)
+
+    event_format = '<IHH' + ('I' if pointer_size == 4 else 'Q')
+    event_format += 'x' * (event_size - struct.calcsize(event_format))
+    offset = header_size
+    events = []
+
+    for i in range(event_count):
+        events.append(struct.unpack_from(event_format, data, offset))
+        offset += event_size
+
+    name_format = '<HHIQ24s'
+    names = {}
+
+    for i in range(name_count):
+        name_type, name_id, _, arg, name = struct.unpack_from(name_format, data, offset)
+        offset += struct.calcsize(name_format)
+        key = name_id if name_type == TASK_RESUME else arg
+        names[(name_type, key)] = name.split(b'\0', 1)[0].decode('ascii', 'replace')
+
+    return frequency, lost_count, events, names
+
+
+def load_symbols(elf, nm):
+    """ return sorted (address, name) of the functions in an ELF file """
+    output = subprocess.check_output([nm, '-C', '--defined-only', elf]).decode('ascii', 'replace')
+    symbols = []
+
+    for line in output.splitlines():
+        fields = line.split(' ', 2)
+
+        if len(fields) == 3 and fields[1] in 'tTwW':
+            symbols.append((int(fields[0], 16), fields[2]))
+
+    symbols.sort()
+    return symbols
+
+
+def symbol_name(symbols, address):
+    address &= ~1  # thumb bit
+
+    if symbols:
+        i = bisect.bisect_right(symbols, (address, '\xff')) - 1
+
+        if i >= 0:
+            return symbols[i][1]
+
+    return '0x%x' % address
+
+
+def convert(frequency, events, names, symbols):
+    trace_events = []
+    rows = {TID_HRT: 'hrt callouts', TID_WORK: 'work queue'}
+    current_task = 0
+    time_us = 0.0
+    last_time = None
+
+    for time, event_type, event_id, arg in events:
+        # unwrap the 32 bit clock, assuming less than one wrap between events
+        if last_time is not None:
+            time_us += ((time - last_time) & 0xffffffff) * 1e6 / frequency
+
+        last_time = time
+        event = {'pid': 0, 'ts': time_us}
+
+        if event_type in (TASK_RESUME, TASK_SUSPEND):
+            name = names.get((TASK_RESUME, event_id), 'pid %i' % event_id)
+            rows[event_id] = name
+            event.update(tid=event_id, name=name, ph='B' if event_type == TASK_RESUME else 'E')
+
+            if event_type == TASK_RESUME:
+                current_task = event_id
+
+        elif event_type in (HRT_CALLOUT_BEGIN, HRT_CALLOUT_END):
+            event.update(tid=TID_HRT, name=symbol_name(symbols, arg),
+                         ph='B' if event_type == HRT_CALLOUT_BEGIN else 'E')
+
+        elif event_type in (WORK_BEGIN, WORK_END):
+            event.update(tid=TID_WORK, name=symbol_name(symbols, arg),
+                         ph='B' if event_type == WORK_BEGIN else 'E')
+
+        elif event_type in (PERF_BEGIN, PERF_END):
+            event.update(tid=current_task, name=names.get((PERF_BEGIN, arg), '0x%x' % arg),
+                         ph='B' if event_type == PERF_BEGIN else 'E')
+
+        elif event_type == MAVLINK_SEND:
+            event.update(tid=current_task, s='t', ph='i', name='mavlink %i' % event_id,
+                         args={'length': arg})
+
+        elif event_type in (ORB_PUBLISH, ORB_COPY):
+            topic = names.get((ORB_PUBLISH, arg), '0x%x' % arg)
+            event.update(tid=current_task, s='t', ph='i',
+                         name=('publish ' if event_type == ORB_PUBLISH else 'copy ') + topic,
+                         args={'generation': event_id})
+
+        else:
+            continue
+
+        trace_events.append(event)
+
+    for tid, name in rows.items():
+        trace_events.append({'pid': 0, 'tid': tid, 'ph': 'M', 'name': 'thread_name', 'args': {'name': name}})
+
+    return trace_events
+
+
+def main():
+    parser = ArgumentParser(description='Convert a PX4 event trace into the Chrome trace format')
+    parser.add_argument('input', help='trace file written by \'trace dump\'')
+    parser.add_argument('output', help='output JSON file')
+    parser.add_argument('--elf', help='firmware ELF file to resolve function addresses')
+    parser.add_argument('--nm', default='arm-none-eabi-nm', help='nm executable (default: %(default)s)')
+    args = parser.parse_args()
+
+    with open(args.input, 'rb') as f:
+        data = f.read()
+
+    try:
+        frequency, lost_count, events, names = read_trace(data)
+    except (ValueError, struct.error) as e:
+        print('Error: %s' % e, file=sys.stderr)
+        return 1
+
+    symbols = load_symbols(args.elf, args.nm) if args.elf else []
+
+    with open(args.output, 'w') as f:
+        json.dump({'traceEvents': convert(frequency, events, names, symbols)}, f)
+
+    print('%i events (%i lost before the dump)' % (len(events), lost_count))
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
@@ -0,0 +1,134 @@
+#!/usr/bin/env python
+
+"""
+Convert a compressed ULog file (.ulgz, written by the logger with SDLOG_COMPRESS=1)
+into a regular ULog file (.ulg) that can be read by all ULog tools.
+
+File format (all values little endian):
+- 8 byte file header: 'U', 'L', 'o', 'g', 'Z', 0x12, 0x35, <version (1)>
+- a sequence of blocks, each consisting of:
+  - uint16 compressed size (0 if the block is stored uncompressed)
+  - uint16 uncompressed size (at most 4096)
+  - the block data: compressed size bytes in the LZ4 block format, or
+    uncompressed size bytes if stored uncompressed
+
+Concatenating the uncompressed data of all blocks gives the original ULog file.
+A truncated last block (e.g. after a power loss) is ignored.
+"""
+
+from __future__ import print_function
+import os
+import struct
+import sys
+from argparse import ArgumentParser
+
+ULOGZ_MAGIC = b'ULogZ\x12\x35'
+ULOGZ_VERSION = 1
+
+
+def lz4_block_decompress(src, uncompressed_size):
+    """ decompress a single block in the LZ4 block format """
+    dst = bytearray()
+    i = 0
+    n = len(src)
+
+    while i < n:
+        token = src[i]
+        i += 1
+
+        # literals
+        literal_length = token >> 4
+        if literal_length == 15:
+            while True:
+                b = src[i]
+                i += 1
+                literal_length += b
+                if b != 255:
+                    break
+        dst += src[i:i + literal_length]
+        i += literal_length
+
+        if i >= n:
+            break # the last sequence has no match
+
+        # match
+        offset = src[i] | (src[i + 1] << 8)
+        i += 2
+        match_length = token & 0xf
+        if match_length == 15:
+            while True:
+                b = src[i]
+                i += 1
+                match_length += b
+                if b != 255:
+                    break
+        match_length += 4
+
+        if offset == 0 or offset > len(dst):
+            raise ValueError('invalid match offset')
+
+        start = len(dst) - offset
+        for k in range(match_length): # matches can overlap with the output
+            dst.append(dst[start + k])
+
+    if len(dst) != uncompressed_size:
+        raise ValueError('size mismatch: expected {}, got {}'.format(uncompressed_size, len(dst)))
+
+    return dst
+
+
+def decompress_file(input_file, output_file):
+    with open(input_file, 'rb') as f:
+        data = bytearray(f.read())
+
+    if len(data) < 8 or bytes(data[0:7]) != ULOGZ_MAGIC:
+        raise ValueError('not a compressed ULog file')
+
+    if data[7] != ULOGZ_VERSION:
+        raise ValueError('unsupported version {}'.format(data[7]))
+
+    pos = 8
+    blocks = 0
+    with open(output_file, 'wb') as out:
+        while pos + 4 <= len(data):
+            compressed_size, size = struct.unpack('<HH', bytes(data[pos:pos + 4]))
+            pos += 4
+            stored_size = compressed_size if compressed_size > 0 else size
+
+            if pos + stored_size > len(data):
+                print('Warning: ignoring truncated last block')
+                break
+
+            block = data[pos:pos + stored_size]
+            pos += stored_size
+
+            if compressed_size > 0:
+                block = lz4_block_decompress(block, size)
+
+            out.write(block)
+            blocks += 1
+
+    return blocks
+
+
+def main():
+    parser = ArgumentParser(description=__doc__.strip().split('\n')[0])
+    parser.add_argument('input', metavar='file.ulgz', help='compressed ULog file')
+    parser.add_argument('-o', '--output', help='output file (default: input file with .ulg extension)')
+    args = parser.parse_args()
+
+    output = args.output
+    if output is None:
+        output = os.path.splitext(args.input)[0] + '.ulg'
+
+    try:
+        blocks = decompress_file(args.input, output)
+    except ValueError as e:
+        print('Error: {}'.format(e))
+        sys.exit(1)
+
+    print('Wrote {} ({} blocks)'.format(output, blocks))
+
+
+if __name__ == '__main__':
+    main()
@@ -57,6 +57,7 @@ set(config_module_list
 	# System commands
 	#
 	systemcmds/bl_update
+	systemcmds/boot
 	systemcmds/mixer
 	systemcmds/param
 	systemcmds/perf
@@ -15,6 +15,7 @@ set(config_module_list
 	# System commands
 	#
 	systemcmds/bl_update
+	systemcmds/boot
 	systemcmds/mixer
 	systemcmds/param
 	systemcmds/perf
@@ -55,6 +55,7 @@ set(config_module_list
 	# System commands
 	#
 	systemcmds/bl_update
+	systemcmds/boot
 	systemcmds/config
 	#systemcmds/dumpfile
 	#systemcmds/esc_calib
@@ -4,6 +4,25 @@ px4_nuttx_configure(HWCLASS m4 CONFIG nsh ROMFS y ROMFSROOT px4fmu_common)
 
 set(config_uavcan_num_ifaces 1)
 
+# precompiled ROMFS mixers, loaded by the fmu driver without text parsing
+set(config_mixer_binaries y)
+
+# uORB topics created at 'uorb start' (<topic>[:<instances>[:<queue size>]])
+set(config_uorb_prealloc_topics
+	sensor_accel:2
+	sensor_gyro:2
+	sensor_mag:2
+	sensor_baro
+	sensor_combined
+	vehicle_attitude
+	vehicle_local_position
+	vehicle_global_position
+	vehicle_status
+	vehicle_command:1:3
+	actuator_controls_0
+	actuator_outputs
+	)
+
 set(config_module_list
 	#
 	# Board support modules
@@ -61,6 +80,7 @@ set(config_module_list
 	# System commands
 	#
 	systemcmds/bl_update
+	systemcmds/boot
 	systemcmds/config
 	systemcmds/dumpfile
 	systemcmds/esc_calib
@@ -77,7 +97,9 @@ set(config_module_list
 	systemcmds/sd_bench
 	systemcmds/top
 	systemcmds/topic_listener
+	systemcmds/trace
 	systemcmds/ver
+	systemcmds/work_queue
 
 	#
 	# Testing
@@ -90,6 +112,9 @@ set(config_module_list
 	modules/mavlink/mavlink_tests
 	modules/mc_pos_control/mc_pos_control_tests
 	modules/uORB/uORB_tests
+	modules/uORB/uORB_tests/bench
+	systemcmds/latency_bench
+	systemcmds/mixer_bench
 	systemcmds/tests
 
 	#
@@ -3,6 +3,7 @@ include(nuttx/px4_impl_nuttx)
 px4_nuttx_configure(HWCLASS m7 CONFIG nsh ROMFS y ROMFSROOT px4fmu_common)
 
 set(config_uavcan_num_ifaces 2)
+set(config_uavcan_static_pool_blocks 500)
 
 set(config_module_list
 	#
@@ -61,6 +62,7 @@ set(config_module_list
 	# System commands
 	#
 	systemcmds/bl_update
+	systemcmds/boot
 	systemcmds/config
 	systemcmds/dumpfile
 	systemcmds/esc_calib
@@ -77,7 +79,9 @@ set(config_module_list
 	systemcmds/sd_bench
 	systemcmds/top
 	systemcmds/topic_listener
+	systemcmds/trace
 	systemcmds/ver
+	systemcmds/work_queue
 
 	#
 	# Testing
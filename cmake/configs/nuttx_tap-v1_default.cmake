@@ -31,6 +31,7 @@ set(config_module_list
 	# System commands
 	#
 	systemcmds/bl_update
+	systemcmds/boot
 	systemcmds/led_control
 	systemcmds/mixer
 	systemcmds/param
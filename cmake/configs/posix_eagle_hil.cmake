@@ -24,6 +24,7 @@ set(config_module_list
 	drivers/led
 	drivers/linux_sbus
 
+	systemcmds/boot
 	systemcmds/param
 	systemcmds/ver
 
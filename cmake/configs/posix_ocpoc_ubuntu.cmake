@@ -27,6 +27,7 @@ set(config_module_list
 	#
 	# System commands
 	#
+	systemcmds/boot
 	systemcmds/param
 	systemcmds/mixer
 	systemcmds/ver
@@ -34,6 +34,7 @@ set(config_module_list
 	#
 	# System commands
 	#
+	systemcmds/boot
 	systemcmds/param
 	systemcmds/led_control
 	systemcmds/mixer
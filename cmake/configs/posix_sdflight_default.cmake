@@ -37,6 +37,7 @@ set(config_module_list
 	drivers/boards
 	drivers/qshell/posix
 
+	systemcmds/boot
 	systemcmds/param
 	systemcmds/led_control
 	systemcmds/mixer
@@ -32,6 +32,7 @@ set(config_module_list
 	#systemcmds/bl_update
 	#systemcmds/config
 	#systemcmds/dumpfile
+	systemcmds/boot
 	systemcmds/esc_calib
 	systemcmds/led_control
 	systemcmds/mixer
@@ -45,7 +46,9 @@ set(config_module_list
 	systemcmds/sd_bench
 	systemcmds/top
 	systemcmds/topic_listener
+	systemcmds/trace
 	systemcmds/ver
+	systemcmds/work_queue
 
 	#
 	# Testing
@@ -55,9 +58,13 @@ set(config_module_list
 	lib/rc/rc_tests
 	modules/commander/commander_tests
 	lib/controllib/controllib_test
+	lib/ecl/EKF/tests/symmetric_matrix
 	modules/mavlink/mavlink_tests
 	modules/mc_pos_control/mc_pos_control_tests
 	modules/uORB/uORB_tests
+	modules/uORB/uORB_tests/bench
+	systemcmds/latency_bench
+	systemcmds/mixer_bench
 	systemcmds/tests
 
 	platforms/posix/tests/hello
@@ -198,6 +205,10 @@ set_property(CACHE config_sitl_viewer PROPERTY STRINGS "jmavsim;none")
 set(config_sitl_debugger disable CACHE STRING "debugger for sitl")
 set_property(CACHE config_sitl_debugger PROPERTY STRINGS "disable;gdb;lldb")
 
+# Room for the topic subscriptions of many vehicle instances in one process
+# (see the 'vehicle' shell command)
+add_definitions(-DPX4_MAX_FD=16384)
+
 # If the environment variable 'replay' is defined, we are building with replay
 # support. In this case, we enable the orb publisher rules.
 set(REPLAY_FILE "$ENV{replay}")
@@ -8,6 +8,7 @@ set(config_module_list
 	platforms/common
 	platforms/posix/px4_layer
 	platforms/posix/work_queue
+	systemcmds/boot
 	systemcmds/param
 	systemcmds/ver
 	systemcmds/perf
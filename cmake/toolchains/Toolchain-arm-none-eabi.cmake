@@ -2,6 +2,7 @@
 #
 # NM
 # OBJCOPY
+# OBJDUMP
 # LD
 # CXX_COMPILER
 # C_COMPILER
@@ -37,7 +38,7 @@ endif()
 cmake_force_cxx_compiler(${CXX_COMPILER} GNU)
 
 # compiler tools
-foreach(tool objcopy nm ld)
+foreach(tool objcopy objdump nm ld)
 	string(TOUPPER ${tool} TOOL)
 	find_program(${TOOL} arm-none-eabi-${tool})
 	if(NOT ${TOOL})
@@ -14,15 +14,17 @@ OPTIND=1         # Reset in case getopts has been used previously in the shell.
 # Initialize our own variables:
 do_clean=true
 gui=false
+jobs=1
 
-while getopts "h?og" opt; do
+while getopts "h?ogj:" opt; do
     case "$opt" in
     h|\?)
 		echo """
-		$0 [-h] [-o] [-g]
+		$0 [-h] [-o] [-g] [-j <jobs>]
 		-h show help
 		-o don't clean before building (to save time)
 		-g run gazebo gui
+		-j run the test cases in parallel, with <jobs> isolated SITL instances (no gui)
 		"""
         exit 0
         ;;
@@ -31,6 +33,8 @@ while getopts "h?og" opt; do
         ;;
     g)  gui=true
         ;;
+    j)  jobs=$OPTARG
+        ;;
     esac
 done
 
@@ -108,6 +112,13 @@ echo -e "TEST_RESULT_TARGET_DIR\t: $TEST_RESULT_TARGET_DIR"
 # however, stop executing tests after the first failure
 set +e
 echo "=====> run tests"
+if [ "$jobs" -gt 1 ]
+then
+	# every test case in its own SITL instance, results and logs go directly to the job directory
+	python $SRC_DIR/integrationtests/run_tests_parallel.py -j $jobs -o $TEST_RESULT_TARGET_DIR
+	exit $?
+fi
+
 test $? -eq 0 && rostest px4 mavros_posix_tests_iris.launch gui:=$gui
 
 # commented out optical flow test for now since ci server has
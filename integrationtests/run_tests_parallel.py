@@ -0,0 +1,255 @@
+#!/usr/bin/env python
+#
+# Runs the SITL integration tests in parallel
+#
+# License: according to LICENSE.md in the root directory of the PX4 Firmware repository
+
+"""
+Runs the test cases (<test> elements) of the mavros_posix_tests_*.launch files in parallel.
+
+Every test case gets a fresh, isolated SITL instance: the worker running it shifts all the UDP ports of
+the startup script (simulator, MAVLink, mavros) and of the Gazebo model by a per-worker offset, uses
+its own Gazebo master port and its own ROS_HOME (working directory, logs and test results). rostest
+starts a separate ROS master on a free port for each case.
+
+The simulator does not run in lockstep, so the tests still run in real time: use at most one job per
+2 cores to avoid starving the simulation.
+
+All results are collected in the output directory, one sub-directory per test case, and merged into
+results.xml (JUnit format).
+"""
+
+from __future__ import print_function
+
+import argparse
+import glob
+import multiprocessing
+import os
+import re
+import shutil
+import subprocess
+import sys
+import threading
+import time
+import xml.etree.ElementTree as ET
+
+try:
+    import queue
+except ImportError:
+    import Queue as queue
+
+SRC_DIR = os.path.dirname(os.path.dirname(os.path.realpath(__file__)))
+
+PORT_OFFSET_STEP = 100 # ports of worker i are shifted by (i + 1) * PORT_OFFSET_STEP
+SITL_UDP_PORT = 14560 # default simulator port (SITL_UDP_PRT)
+MAVROS_LOCAL_PORT = 14540 # mavros side of the onboard MAVLink instance
+MAVROS_REMOTE_PORT = 14557 # SITL side of the onboard MAVLink instance
+GAZEBO_MASTER_PORT = 11345
+
+
+class TestCase(object):
+    def __init__(self, launch_file, vehicle, est, test_element):
+        self.launch_file = launch_file
+        self.vehicle = vehicle
+        self.est = est
+        self.test = test_element
+        self.name = '{}_{}'.format(vehicle, test_element.get('test-name'))
+
+
+def resolve(value, launch_args):
+    """ substitute $(arg name) with the default of a launch file argument """
+    return re.sub(r'\$\(arg (\w+)\)', lambda m: launch_args.get(m.group(1), ''), value)
+
+
+def read_test_cases(launch_file):
+    """ get the vehicle, estimator and the test cases of a test launch file """
+    root = ET.parse(launch_file).getroot()
+    launch_args = dict((arg.get('name'), arg.get('default', '')) for arg in root.findall('arg'))
+    vehicle = 'iris'
+    est = launch_args.get('est', 'lpe')
+
+    for include in root.findall('include'):
+        for arg in include.findall('arg'):
+            if arg.get('name') == 'vehicle':
+                vehicle = resolve(arg.get('value'), launch_args)
+
+            elif arg.get('name') == 'est':
+                est = resolve(arg.get('value'), launch_args)
+
+    return [TestCase(launch_file, vehicle, est, test) for test in root.iter('test')]
+
+
+def shift_ports(rcs, offset):
+    """ move the simulator and MAVLink ports of a startup script by offset """
+    shift = lambda m: m.group(1) + str(int(m.group(2)) + offset)
+    rcs = '\n'.join(re.sub(r'(-[uo] )(\d+)', shift, line) if line.startswith('mavlink ') else line
+                     for line in rcs.split('\n'))
+
+    if re.search(r'param set SITL_UDP_PRT \d+', rcs):
+        rcs = re.sub(r'(param set SITL_UDP_PRT )(\d+)', shift, rcs)
+
+    else:
+        rcs = rcs.replace('simulator start', 'param set SITL_UDP_PRT {}\nsimulator start'.format(SITL_UDP_PORT + offset), 1)
+
+    return rcs
+
+
+def write_case_files(case, case_dir, offset, models_dir):
+    """ write the startup script, model and launch file of a test case, return the launch file """
+    with open(os.path.join(SRC_DIR, 'posix-configs', 'SITL', 'init', case.est, case.vehicle), 'r') as f:
+        rcs = shift_ports(f.read(), offset)
+
+    rcs_file = os.path.join(case_dir, 'rcS')
+
+    with open(rcs_file, 'w') as f:
+        f.write(rcs)
+
+    sim_port = int(re.search(r'param set SITL_UDP_PRT (\d+)', rcs).group(1))
+
+    with open(os.path.join(models_dir, case.vehicle, case.vehicle + '.sdf'), 'r') as f:
+        sdf = re.sub(r'<mavlink_udp_port>\d+</mavlink_udp_port>',
+                     '<mavlink_udp_port>{}</mavlink_udp_port>'.format(sim_port), f.read())
+
+    sdf_file = os.path.join(case_dir, case.vehicle + '.sdf')
+
+    with open(sdf_file, 'w') as f:
+        f.write(sdf)
+
+    launch = ET.Element('launch')
+    include = ET.SubElement(launch, 'include', {'file': '$(find px4)/launch/mavros_posix_sitl.launch'})
+    args = [('headless', 'true'), ('gui', 'false'), ('vehicle', case.vehicle), ('est', case.est),
+            ('rcS', rcs_file), ('sdf', sdf_file),
+            ('fcu_url', 'udp://:{}@localhost:{}'.format(MAVROS_LOCAL_PORT + offset, MAVROS_REMOTE_PORT + offset))]
+
+    for name, value in args:
+        ET.SubElement(include, 'arg', {'name': name, 'value': value})
+
+    launch.append(case.test)
+    launch_file = os.path.join(case_dir, 'test.launch')
+    ET.ElementTree(launch).write(launch_file)
+    return launch_file
+
+
+def run_case(case, worker, output_dir, models_dir):
+    """ run a single test case in its own SITL instance, return True if it passed """
+    offset = (worker + 1) * PORT_OFFSET_STEP
+    case_dir = os.path.join(output_dir, case.name)
+
+    if os.path.exists(case_dir):
+        shutil.rmtree(case_dir) # results of a previous run
+
+    os.makedirs(case_dir)
+    launch_file = write_case_files(case, case_dir, offset, models_dir)
+
+    env = dict(os.environ)
+    env['ROS_HOME'] = case_dir
+    env['ROS_LOG_DIR'] = os.path.join(case_dir, 'log')
+    env['ROS_TEST_RESULT_DIR'] = os.path.join(case_dir, 'test_results')
+    env['PX4_LOG_DIR'] = os.path.join(case_dir, 'rootfs', 'fs', 'microsd', 'log')
+    env['GAZEBO_MASTER_URI'] = 'http://localhost:{}'.format(GAZEBO_MASTER_PORT + offset)
+
+    with open(os.path.join(case_dir, 'rostest.log'), 'w') as log:
+        result = subprocess.call(['rostest', launch_file], cwd=case_dir, env=env,
+                                 stdout=log, stderr=subprocess.STDOUT)
+
+    return result == 0
+
+
+def merge_results(output_dir):
+    """ merge the JUnit results of all cases into output_dir/results.xml, return (tests, failures) """
+    merged = ET.Element('testsuites')
+    tests = 0
+    failures = 0
+
+    for result_file in sorted(glob.glob(os.path.join(output_dir, '*', 'test_results', '*', '*.xml'))):
+        try:
+            suite = ET.parse(result_file).getroot()
+        except ET.ParseError:
+            continue
+
+        if suite.tag != 'testsuite':
+            continue
+
+        merged.append(suite)
+        tests += int(suite.get('tests', 0))
+        failures += int(suite.get('failures', 0)) + int(suite.get('errors', 0))
+
+    merged.set('tests', str(tests))
+    merged.set('failures', str(failures))
+    ET.ElementTree(merged).write(os.path.join(output_dir, 'results.xml'))
+    return tests, failures
+
+
+def main():
+    default_launch_files = [os.path.join(SRC_DIR, 'launch', name) for name in
+                            ['mavros_posix_tests_iris.launch', 'mavros_posix_tests_standard_vtol.launch']]
+
+    parser = argparse.ArgumentParser(description='Run the SITL integration tests in parallel')
+    parser.add_argument('launch_files', nargs='*', default=default_launch_files,
+                        help='test launch files (default: %(default)s)')
+    parser.add_argument('-j', '--jobs', type=int, default=max(1, multiprocessing.cpu_count() // 2),
+                        help='number of SITL instances running at the same time (default: %(default)s)')
+    parser.add_argument('-o', '--output', default='test_results', help='output directory (default: %(default)s)')
+    parser.add_argument('-f', '--filter', default='', help='only run the test cases matching this regex')
+    args = parser.parse_args()
+
+    models_dir = os.path.join(subprocess.check_output(['rospack', 'find', 'mavlink_sitl_gazebo'])
+                              .decode().strip(), 'models')
+
+    cases = []
+
+    for launch_file in args.launch_files:
+        cases += [case for case in read_test_cases(launch_file) if re.search(args.filter, case.name)]
+
+    if not os.path.isdir(args.output):
+        os.makedirs(args.output)
+
+    pending = queue.Queue()
+
+    for case in cases:
+        pending.put(case)
+
+    failed = []
+    lock = threading.Lock()
+    start_time = time.time()
+
+    def worker_main(worker):
+        while True:
+            try:
+                case = pending.get_nowait()
+            except queue.Empty:
+                return
+
+            case_start_time = time.time()
+            passed = run_case(case, worker, args.output, models_dir)
+
+            with lock:
+                print('[{}] {:<50} {} ({:.0f} s)'.format(worker, case.name, 'ok' if passed else 'FAILED',
+                                                         time.time() - case_start_time))
+                sys.stdout.flush()
+
+                if not passed:
+                    failed.append(case.name)
+
+    jobs = max(1, min(args.jobs, len(cases)))
+    print('running {} test cases with {} jobs'.format(len(cases), jobs))
+    workers = [threading.Thread(target=worker_main, args=(i,)) for i in range(jobs)]
+
+    for worker in workers:
+        worker.start()
+
+    for worker in workers:
+        worker.join()
+
+    tests, failures = merge_results(args.output)
+    print('{} test cases, {} tests, {} failures ({:.0f} s), results in {}'.format(
+        len(cases), tests, failures, time.time() - start_time, os.path.join(args.output, 'results.xml')))
+
+    for name in failed:
+        print('failed: {}'.format(name))
+
+    return 1 if failed else 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
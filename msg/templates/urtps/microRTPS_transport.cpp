@@ -34,7 +34,10 @@
 #include <termios.h>
 #include <stdio.h>
 #include <errno.h>
+#include <sys/mman.h>
 #include <sys/socket.h>
+#include <sys/stat.h>
+#include <time.h>
 
 #include "microRTPS_transport.h"
 
@@ -76,7 +79,11 @@ uint16_t const crc16_table[256] = {
 	0x8201, 0x42C0, 0x4380, 0x8341, 0x4100, 0x81C1, 0x8081, 0x4040
 };
 
-Transport_node::Transport_node(): rx_buff_pos(0)
+Transport_node::Transport_node():
+	rx_buff_pos(0),
+	tx_buff_pos(0),
+	message_crc(true),
+	tx_seq(0)
 {
 }
 
@@ -108,20 +115,25 @@ ssize_t Transport_node::read(uint8_t *topic_ID, char out_buffer[], size_t buffer
 
 	*topic_ID = 255;
 
-	ssize_t len = node_read((void *)(rx_buffer + rx_buff_pos), sizeof(rx_buffer) - rx_buff_pos);
+	ssize_t len = 0;
 
-	if (len <= 0) {
-		int errsv = errno;
+	// a frame can contain several messages: only read again once the buffered ones are consumed
+	if (!message_buffered()) {
+		len = node_read((void *)(rx_buffer + rx_buff_pos), sizeof(rx_buffer) - rx_buff_pos);
 
-		if (errsv && EAGAIN != errsv && ETIMEDOUT != errsv) {
-			printf("Read fail %d\n", errsv);
+		if (len <= 0) {
+			int errsv = errno;
+
+			if (errsv && EAGAIN != errsv && ETIMEDOUT != errsv) {
+				printf("Read fail %d\n", errsv);
+			}
+
+			return len;
 		}
 
-		return len;
+		rx_buff_pos += len;
 	}
 
-	rx_buff_pos += len;
-
 	// We read some
 	size_t header_size = sizeof(struct Header);
 
@@ -172,7 +184,7 @@ ssize_t Transport_node::read(uint8_t *topic_ID, char out_buffer[], size_t buffer
 	}
 
 	uint16_t read_crc = ((uint16_t)header->crc_h << 8) | header->crc_l;
-	uint16_t calc_crc = crc16((uint8_t *)rx_buffer + msg_start_pos + header_size, payload_len);
+	uint16_t calc_crc = message_crc ? crc16((uint8_t *)rx_buffer + msg_start_pos + header_size, payload_len) : 0;
 
 	if (read_crc != calc_crc) {
 		printf("BAD CRC %u != %u\n", read_crc, calc_crc);
@@ -193,54 +205,133 @@ ssize_t Transport_node::read(uint8_t *topic_ID, char out_buffer[], size_t buffer
 	return len;
 }
 
-ssize_t Transport_node::write(const uint8_t topic_ID, char buffer[], size_t length)
+bool Transport_node::message_buffered()
 {
-	if (!fds_OK()) {
-		return -1;
-	}
-
-	static struct Header header = {
-		.marker = {'>', '>', '>'},
-		.topic_ID = 0u,
-		.seq = 0u,
-		.payload_len_h = 0u,
-		.payload_len_l = 0u,
-		.crc_h = 0u,
-		.crc_l = 0u
+	const size_t header_size = sizeof(struct Header);
 
-	};
+	for (uint32_t pos = 0; pos + header_size <= rx_buff_pos; ++pos) {
+		if ('>' == rx_buffer[pos] && memcmp(rx_buffer + pos, ">>>", 3) == 0) {
+			const struct Header *header = (const struct Header *)&rx_buffer[pos];
+			uint32_t payload_len = ((uint32_t)header->payload_len_h << 8) | header->payload_len_l;
+			return pos + header_size + payload_len <= rx_buff_pos;
+		}
+	}
 
-	static uint8_t seq = 0;
+	return false;
+}
 
+void Transport_node::fill_header(Header &header, const uint8_t topic_ID, char buffer[], size_t length)
+{
 	// [>,>,>,topic_ID,seq,payload_length,CRCHigh,CRCLow,payload_start, ... ,payload_end]
 
-	uint16_t crc = crc16((uint8_t *)buffer, length);
+	uint16_t crc = message_crc ? crc16((uint8_t *)buffer, length) : 0;
 
+	memcpy(header.marker, ">>>", sizeof(header.marker));
 	header.topic_ID = topic_ID;
-	header.seq = seq++;
+	header.seq = tx_seq++;
 	header.payload_len_h = (length >> 8) & 0xff;
 	header.payload_len_l = length & 0xff;
 	header.crc_h = (crc >> 8) & 0xff;
 	header.crc_l = crc & 0xff;
+}
+
+ssize_t Transport_node::write(const uint8_t topic_ID, char buffer[], size_t length)
+{
+	ssize_t len = queue(topic_ID, buffer, length);
+
+	if (len < 0) {
+		return len;
+	}
+
+	ssize_t ret = flush();
+
+	return ret < 0 ? ret : len;
+}
+
+ssize_t Transport_node::queue(const uint8_t topic_ID, char buffer[], size_t length)
+{
+	if (!fds_OK()) {
+		return -1;
+	}
+
+	if (sizeof(struct Header) + length <= sizeof(tx_buffer)) {
+		char *payload = reserve(length);
+
+		if (payload == nullptr) {
+			return -1;
+		}
+
+		memcpy(payload, buffer, length);
+		return commit(topic_ID, length);
+	}
+
+	// too big for a frame: send it on its own, after the queued messages
+	if (flush() < 0) {
+		return -1;
+	}
+
+	struct Header header;
+	fill_header(header, topic_ID, buffer, length);
 
 	ssize_t len = node_write(&header, sizeof(header));
 
 	if (len != sizeof(header)) {
-		goto err;
+		return len < 0 ? len : -1;
 	}
 
 	len = node_write(buffer, length);
 
 	if (len != ssize_t(length)) {
-		goto err;
+		return len < 0 ? len : -1;
+	}
+
+	return sizeof(header) + length;
+}
+
+char *Transport_node::reserve(size_t max_length)
+{
+	const size_t header_size = sizeof(struct Header);
+
+	if (header_size + max_length > sizeof(tx_buffer)) {
+		return nullptr;
+	}
+
+	if (tx_buff_pos + header_size + max_length > sizeof(tx_buffer) && flush() < 0) {
+		return nullptr;
 	}
 
-	return len + sizeof(header);
+	return tx_buffer + tx_buff_pos + header_size;
+}
+
+ssize_t Transport_node::commit(const uint8_t topic_ID, size_t length)
+{
+	const size_t message_len = sizeof(struct Header) + length;
 
-err:
-	//int errsv = errno;
-	//if (len == -1 ) printf("                               => Writing error '%d'\n", errsv);
-	//else            printf("                               => Wrote '%ld' != length(%lu) error '%d'\n", (long)len, (unsigned long)length, errsv);
+	if (tx_buff_pos + message_len > sizeof(tx_buffer)) {
+		return -1;
+	}
+
+	fill_header(*(struct Header *)&tx_buffer[tx_buff_pos], topic_ID, tx_buffer + tx_buff_pos + sizeof(struct Header), length);
+	tx_buff_pos += message_len;
+
+	return message_len;
+}
+
+ssize_t Transport_node::flush()
+{
+	if (tx_buff_pos == 0) {
+		return 0;
+	}
+
+	ssize_t len = node_write(tx_buffer, tx_buff_pos);
+
+	// drop the frame on errors as well, the data is outdated by the next one
+	const uint32_t frame_len = tx_buff_pos;
+	tx_buff_pos = 0;
+
+	if (len != ssize_t(frame_len)) {
+		return len < 0 ? len : -1;
+	}
 
 	return len;
 }
@@ -374,12 +465,14 @@ ssize_t UART_node::node_write(void *buffer, size_t len)
 }
 
 
-UDP_node::UDP_node(uint16_t _udp_port_recv, uint16_t _udp_port_send):
+UDP_node::UDP_node(uint16_t _udp_port_recv, uint16_t _udp_port_send, bool _batched):
 	sender_fd(-1),
 	receiver_fd(-1),
 	udp_port_recv(_udp_port_recv),
-	udp_port_send(_udp_port_send)
+	udp_port_send(_udp_port_send),
+	batched(_batched)
 {
+	message_crc = !batched;
 }
 
 UDP_node::~UDP_node()
@@ -484,6 +577,30 @@ ssize_t UDP_node::node_read(void *buffer, size_t len)
 	// Blocking call
 	static socklen_t addrlen = sizeof(receiver_outaddr);
 	ret = recvfrom(receiver_fd, buffer, len, 0, (struct sockaddr *) &receiver_outaddr, &addrlen);
+
+	if (batched && ret > 0) {
+		// check the whole datagram (a truncated one fails as well), then strip the frame header
+		const Frame_header *frame = (const Frame_header *)buffer;
+		const size_t frame_header_size = sizeof(Frame_header);
+
+		if ((size_t)ret < frame_header_size || memcmp(frame->marker, "<<<", 3) != 0) {
+			printf("                                 (↓ %d)\n", ret);
+			return 0;
+		}
+
+		uint16_t read_crc = ((uint16_t)frame->crc_h << 8) | frame->crc_l;
+		uint16_t calc_crc = crc16((uint8_t *)buffer + frame_header_size, ret - frame_header_size);
+
+		if (read_crc != calc_crc) {
+			printf("BAD FRAME CRC %u != %u\n", read_crc, calc_crc);
+			printf("                                 (↓ %d)\n", ret);
+			return 0;
+		}
+
+		ret -= frame_header_size;
+		memmove(buffer, (char *)buffer + frame_header_size, ret);
+	}
+
 #endif /* __PX4_NUTTX */
 	return ret;
 }
@@ -496,7 +613,232 @@ ssize_t UDP_node::node_write(void *buffer, size_t len)
 
 	int ret = 0;
 #ifndef __PX4_NUTTX
-	ret = sendto(sender_fd, buffer, len, 0, (struct sockaddr *)&sender_outaddr, sizeof(sender_outaddr));
+
+	if (batched) {
+		Frame_header frame = {};
+		memcpy(frame.marker, "<<<", sizeof(frame.marker));
+		uint16_t crc = crc16((uint8_t *)buffer, len);
+		frame.crc_h = (crc >> 8) & 0xff;
+		frame.crc_l = crc & 0xff;
+
+		struct iovec iov[2];
+		iov[0].iov_base = &frame;
+		iov[0].iov_len = sizeof(frame);
+		iov[1].iov_base = buffer;
+		iov[1].iov_len = len;
+
+		struct msghdr msg = {};
+		msg.msg_name = &sender_outaddr;
+		msg.msg_namelen = sizeof(sender_outaddr);
+		msg.msg_iov = iov;
+		msg.msg_iovlen = 2;
+
+		ret = sendmsg(sender_fd, &msg, 0);
+
+		if (ret > 0) {
+			ret -= sizeof(frame);
+		}
+
+	} else {
+		ret = sendto(sender_fd, buffer, len, 0, (struct sockaddr *)&sender_outaddr, sizeof(sender_outaddr));
+	}
+
 #endif /* __PX4_NUTTX */
 	return ret;
 }
+
+Shmem_node::Shmem_node(const char *_shm_name, bool _client, uint32_t _poll_ms):
+	client(_client),
+	poll_ms(_poll_ms),
+	layout(nullptr),
+	rx_ring(nullptr),
+	tx_ring(nullptr),
+	closed(false)
+{
+	// the memory is not corrupted on the way
+	message_crc = false;
+
+	if (nullptr != _shm_name) {
+		strncpy(shm_name, _shm_name, sizeof(shm_name) - 1);
+	}
+}
+
+Shmem_node::~Shmem_node()
+{
+	close();
+#ifndef __PX4_NUTTX
+
+	// unmapped only here: close() can be called while the other thread accesses the rings
+	if (nullptr != layout) {
+		munmap(layout, sizeof(Layout));
+		layout = nullptr;
+
+		if (client) {
+			shm_unlink(shm_name);
+		}
+	}
+
+#endif /* __PX4_NUTTX */
+}
+
+int Shmem_node::init()
+{
+#ifndef __PX4_NUTTX
+	int fd = client ? shm_open(shm_name, O_RDWR | O_CREAT, 0666) : shm_open(shm_name, O_RDWR, 0);
+
+	if (fd < 0) {
+		printf("failed to open shared memory %s (%d)%s\n", shm_name, errno, client ? "" : ", start the client first");
+		return -errno;
+	}
+
+	if (client && ftruncate(fd, sizeof(Layout)) != 0) {
+		printf("failed to size shared memory %s (%d)\n", shm_name, errno);
+		::close(fd);
+		return -1;
+	}
+
+	struct stat st;
+
+	if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(Layout)) {
+		printf("invalid shared memory %s\n", shm_name);
+		::close(fd);
+		return -1;
+	}
+
+	void *base = mmap(nullptr, sizeof(Layout), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	::close(fd);
+
+	if (base == MAP_FAILED) {
+		printf("failed to map shared memory %s (%d)\n", shm_name, errno);
+		return -1;
+	}
+
+	layout = (Layout *)base;
+
+	if (client) {
+		// (re)initialize, the magic is set last
+		layout->magic = 0;
+		__sync_synchronize();
+
+		Ring *rings[] = {&layout->to_agent, &layout->to_client};
+
+		for (Ring *ring : rings) {
+			ring->head = 0;
+			ring->tail = 0;
+
+			if (sem_init(&ring->data_available, 1, 0) != 0) {
+				printf("failed to init semaphore (%d)\n", errno);
+				return -1;
+			}
+		}
+
+		__sync_synchronize();
+		layout->magic = MAGIC;
+
+	} else if (layout->magic != MAGIC) {
+		printf("shared memory %s not initialized\n", shm_name);
+		return -1;
+	}
+
+	rx_ring = client ? &layout->to_client : &layout->to_agent;
+	tx_ring = client ? &layout->to_agent : &layout->to_client;
+	return 0;
+#else
+	return -1;
+#endif /* __PX4_NUTTX */
+}
+
+bool Shmem_node::fds_OK()
+{
+	return (nullptr != rx_ring && !closed);
+}
+
+uint8_t Shmem_node::close()
+{
+	if (!closed && nullptr != layout) {
+		printf("Close shared memory\n");
+	}
+
+	closed = true;
+	return 0;
+}
+
+ssize_t Shmem_node::node_read(void *buffer, size_t len)
+{
+	if (nullptr == buffer || !fds_OK()) {
+		return -1;
+	}
+
+#ifndef __PX4_NUTTX
+
+	if (rx_ring->tail == rx_ring->head) {
+		struct timespec ts;
+		clock_gettime(CLOCK_REALTIME, &ts);
+		ts.tv_sec += poll_ms / 1000;
+		ts.tv_nsec += (poll_ms % 1000) * 1000000;
+
+		if (ts.tv_nsec >= 1000000000) {
+			ts.tv_sec++;
+			ts.tv_nsec -= 1000000000;
+		}
+
+		// there is a post per write, but the reader drains the ring: an empty ring after the wait is a stale post
+		while (rx_ring->tail == rx_ring->head) {
+			if (sem_timedwait(&rx_ring->data_available, &ts) != 0 && errno != EINTR) {
+				if (rx_ring->tail == rx_ring->head) {
+					return 0;
+				}
+
+				break;
+			}
+		}
+	}
+
+	__sync_synchronize();
+
+	const uint32_t tail = rx_ring->tail;
+	const uint32_t available = rx_ring->head - tail;
+	const uint32_t count = available < len ? available : len;
+	const uint32_t offset = tail % RING_SIZE;
+	const uint32_t first = (RING_SIZE - offset) < count ? (RING_SIZE - offset) : count;
+
+	memcpy(buffer, rx_ring->data + offset, first);
+	memcpy((char *)buffer + first, rx_ring->data, count - first);
+
+	__sync_synchronize();
+	rx_ring->tail = tail + count;
+	return count;
+#else
+	return -1;
+#endif /* __PX4_NUTTX */
+}
+
+ssize_t Shmem_node::node_write(void *buffer, size_t len)
+{
+	if (nullptr == buffer || !fds_OK()) {
+		return -1;
+	}
+
+#ifndef __PX4_NUTTX
+	const uint32_t head = tx_ring->head;
+
+	// all or nothing, so that the stream stays aligned to the messages
+	if (len > RING_SIZE - (head - tx_ring->tail)) {
+		errno = EAGAIN;
+		return -1;
+	}
+
+	const uint32_t offset = head % RING_SIZE;
+	const uint32_t first = (RING_SIZE - offset) < len ? (RING_SIZE - offset) : len;
+
+	memcpy(tx_ring->data + offset, buffer, first);
+	memcpy(tx_ring->data, (char *)buffer + first, len - first);
+
+	__sync_synchronize();
+	tx_ring->head = head + len;
+	sem_post(&tx_ring->data_available);
+	return len;
+#else
+	return -1;
+#endif /* __PX4_NUTTX */
+}
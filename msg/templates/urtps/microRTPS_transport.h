@@ -36,6 +36,7 @@
 #include <cstring>
 #include <arpa/inet.h>
 #include <poll.h>
+#include <semaphore.h>
 
 class Transport_node
 {
@@ -48,16 +49,47 @@ public:
 	ssize_t read(uint8_t *topic_ID, char out_buffer[], size_t buffer_len);
 	ssize_t write(const uint8_t topic_ID, char buffer[], size_t length);
 
+	/**
+	 * Add a message to the frame sent by the next flush(). The messages keep their own
+	 * header, so the receiver does not need to know about frames.
+	 * @return length of the message including the header, < 0 on error
+	 */
+	ssize_t queue(const uint8_t topic_ID, char buffer[], size_t length);
+
+	/**
+	 * Reserve the space for a message in the frame, so that it can be serialized in place
+	 * and then added with commit(). Flushes the frame if the message does not fit anymore.
+	 * @param max_length upper bound of the payload length
+	 * @return buffer for the payload, nullptr if the message does not fit into a frame
+	 */
+	char *reserve(size_t max_length);
+
+	/**
+	 * Add the message serialized into the buffer returned by the last reserve()
+	 * @return length of the message including the header, < 0 on error
+	 */
+	ssize_t commit(const uint8_t topic_ID, size_t length);
+
+	/**
+	 * Send all queued messages with a single write
+	 * @return number of bytes written, < 0 on error
+	 */
+	ssize_t flush();
+
 protected:
 	virtual ssize_t node_read(void *buffer, size_t len) = 0;
 	virtual ssize_t node_write(void *buffer, size_t len) = 0;
 	virtual bool fds_OK() = 0;
 	uint16_t crc16_byte(uint16_t crc, const uint8_t data);
 	uint16_t crc16(uint8_t const *buffer, size_t len);
+	bool message_buffered();
 
 protected:
 	uint32_t rx_buff_pos;
 	char rx_buffer[1024] = {};
+	uint32_t tx_buff_pos;
+	char tx_buffer[1024] = {}; ///< must not exceed rx_buffer, a UDP frame is read at once
+	bool message_crc; ///< false if the link checks the data itself (the CRC in the header is 0)
 
 private:
 	struct __attribute__((packed)) Header {
@@ -69,6 +101,10 @@ private:
 		uint8_t crc_h;
 		uint8_t crc_l;
 	};
+
+	void fill_header(Header &header, const uint8_t topic_ID, char buffer[], size_t length);
+
+	uint8_t tx_seq;
 };
 
 class UART_node: public Transport_node
@@ -92,10 +128,14 @@ protected:
 	struct pollfd poll_fd[1] = {};
 };
 
+/**
+ * UDP transport. In batched mode a datagram carries a single CRC over all its messages
+ * instead of one per message, both sides have to use the same mode.
+ */
 class UDP_node: public Transport_node
 {
 public:
-	UDP_node(uint16_t udp_port_recv, uint16_t udp_port_send);
+	UDP_node(uint16_t udp_port_recv, uint16_t udp_port_send, bool batched = false);
 	virtual ~UDP_node();
 
 	int init();
@@ -115,4 +155,56 @@ protected:
 	struct sockaddr_in sender_outaddr;
 	struct sockaddr_in receiver_inaddr;
 	struct sockaddr_in receiver_outaddr;
+	bool batched;
+
+private:
+	struct __attribute__((packed)) Frame_header {
+		char marker[3];
+		uint8_t crc_h;
+		uint8_t crc_l;
+	};
+};
+
+/**
+ * Transport over a shared memory segment, for a client and an agent on the same machine.
+ * The segment holds a byte ring per direction: the messages keep their framing, but
+ * without a CRC. The client creates the segment, the agent attaches to it.
+ */
+class Shmem_node: public Transport_node
+{
+public:
+	Shmem_node(const char *shm_name, bool client, uint32_t poll_ms);
+	virtual ~Shmem_node();
+
+	int init();
+	uint8_t close();
+
+protected:
+	ssize_t node_read(void *buffer, size_t len);
+	ssize_t node_write(void *buffer, size_t len);
+	bool fds_OK();
+
+	static constexpr uint32_t RING_SIZE = 64 * 1024; ///< power of 2
+	static constexpr uint32_t MAGIC = 0x52545001;
+
+	struct Ring {
+		volatile uint32_t head; ///< bytes written, only changed by the writer
+		volatile uint32_t tail; ///< bytes read, only changed by the reader
+		sem_t data_available;
+		char data[RING_SIZE];
+	};
+
+	struct Layout {
+		uint32_t magic;
+		Ring to_agent;
+		Ring to_client;
+	};
+
+	char shm_name[64] = {};
+	bool client;
+	uint32_t poll_ms;
+	Layout *layout;
+	Ring *rx_ring;
+	Ring *tx_ring;
+	bool closed;
 };
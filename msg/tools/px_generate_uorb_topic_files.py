@@ -365,18 +365,36 @@ def generate_topics_list_file(msgdir, outputdir, templatedir):
         for msg in msgs:
             msg_filename = os.path.join(msgdir, msg)
             multi_topics.extend(get_multi_topics(msg_filename))
-        tl_globals = {"msgs" : msgs, "multi_topics" : multi_topics}
+        tl_globals = {"msgs" : msgs, "multi_topics" : multi_topics, "prealloc_topics" : []}
         tl_template_file = os.path.join(templatedir, TOPICS_LIST_TEMPLATE_FILE)
         tl_out_file = os.path.join(outputdir, TOPICS_LIST_TEMPLATE_FILE.replace(".template", ""))
         generate_by_template(tl_out_file, tl_template_file, tl_globals)
 
-def generate_topics_list_file_from_files(files, outputdir, templatedir):
+def get_prealloc_topics(prealloc, topic_names):
+        """
+        Parse the list of topics to preallocate at uORB start.
+        Each entry has the form <topic name>[:<instances>[:<queue size>]]
+        """
+        prealloc_topics = []
+        for entry in prealloc:
+            fields = entry.split(':')
+            if len(fields) > 3 or fields[0] not in topic_names:
+                print('Error: invalid uORB preallocation entry: ' + entry)
+                exit(-1)
+            instances = int(fields[1]) if len(fields) > 1 else 1
+            queue_size = int(fields[2]) if len(fields) > 2 else 1
+            prealloc_topics.append((fields[0], instances, queue_size))
+        return prealloc_topics
+
+def generate_topics_list_file_from_files(files, outputdir, templatedir, prealloc=[]):
         # generate cpp file with topics list
         filenames = [os.path.basename(p) for p in files if os.path.basename(p).endswith(".msg")]
         multi_topics = []
         for msg_filename in files:
             multi_topics.extend(get_multi_topics(msg_filename))
-        tl_globals = {"msgs" : filenames, "multi_topics" : multi_topics}
+        topic_names = [f.replace(".msg", "") for f in filenames] + multi_topics
+        tl_globals = {"msgs" : filenames, "multi_topics" : multi_topics,
+                "prealloc_topics" : get_prealloc_topics(prealloc, topic_names)}
         tl_template_file = os.path.join(templatedir, TOPICS_LIST_TEMPLATE_FILE)
         tl_out_file = os.path.join(outputdir, TOPICS_LIST_TEMPLATE_FILE.replace(".template", ""))
         generate_by_template(tl_out_file, tl_template_file, tl_globals)
@@ -411,6 +429,9 @@ if __name__ == "__main__":
         parser.add_argument('-q', dest='quiet', default=False, action='store_true',
                             help='string added as prefix to the output file '
                             ' name when converting directories')
+        parser.add_argument('-a', dest='prealloc', nargs="*", default=[],
+                            help='topics to preallocate at uORB start, in the form '
+                            '<topic>[:<instances>[:<queue size>]] (only with -f)')
         args = parser.parse_args()
 
         if args.include_paths:
@@ -427,7 +448,7 @@ if __name__ == "__main__":
             for f in args.file:
                 generate_output_from_file(generate_idx, f, args.temporarydir, args.templatedir, INCL_DEFAULT)
             if generate_idx == 1:
-                generate_topics_list_file_from_files(args.file, args.outputdir, args.templatedir)
+                generate_topics_list_file_from_files(args.file, args.outputdir, args.templatedir, args.prealloc)
             copy_changed(args.temporarydir, args.outputdir, args.prefix, args.quiet)
         elif args.dir is not None:
             convert_dir_save(
@@ -5,6 +5,7 @@
 # precompiled and thus message generation will be much faster
 
 
+import sys
 import genmsg.msgs
 import gencpp
 
@@ -88,13 +89,31 @@ def sizeof_field_type(field):
     bare_name_str = bare_name(field.type)
     if bare_name_str in msgtype_size_map:
         return msgtype_size_map[bare_name_str]
-    return 0 # this is for non-builtin types: sort them at the end
+    return 0 # this is for non-builtin types
+
+def alignment_sort_key(field):
+    """
+    Sort key for the struct layout. Embedded types go first: they are 8 byte
+    aligned and their size is a multiple of 8 (they start with a timestamp and
+    are padded at the end), so right after the timestamp they need no padding.
+    The builtin types follow with decreasing size, which keeps each of them
+    naturally aligned.
+    """
+    if not field.is_builtin:
+        return 16
+    return sizeof_field_type(field)
+
+def sort_fields(fields):
+    """
+    Sort fields to minimize the padding (using a stable sort)
+    """
+    return sorted(fields, key=alignment_sort_key, reverse=True)
 
 def get_children_fields(base_type, search_path):
     (package, name) = genmsg.names.package_resource_name(base_type)
     tmp_msg_context = genmsg.msg_loader.MsgContext.create_default()
     spec_temp = genmsg.msg_loader.load_msg_by_type(tmp_msg_context, '%s/%s' %(package, name), search_path)  
-    sorted_fields = sorted(spec_temp.parsed_fields(), key=sizeof_field_type, reverse=True)
+    sorted_fields = sort_fields(spec_temp.parsed_fields())
     return sorted_fields
 
 def add_padding_bytes(fields, search_path):
@@ -146,6 +165,57 @@ def add_padding_bytes(fields, search_path):
         fields.append(padding_field)
     return (struct_size, num_padding_bytes)
 
+def get_padding_size(fields, padding_end_size):
+    """
+    Get the number of padding bytes that add_padding_bytes() inserted in
+    between the fields (not counting the padding at the end)
+    """
+    padding_size = 0
+    for field in fields:
+        if field.name.startswith('_padding'):
+            padding_size += field.array_len
+    return padding_size - padding_end_size
+
+def report_padding(topic_name, struct_size, padding_end_size, padding_size):
+    """
+    Print the bytes wasted by padding at build time. Padding in between the
+    fields is published, copied and logged with every update. The padding at
+    the end is not part of the topic size.
+    """
+    if padding_size > 0:
+        sys.stderr.write('uORB topic {0}: {1} of {2} bytes are padding\n'.format(
+            topic_name, padding_size, struct_size - padding_end_size))
+
+
+def get_serialized_size_max(fields, search_path, last_size=0):
+    """
+    Calculate an upper bound of the size of the micro-CDR serialization of the
+    fields (in the order of the serialize functions).
+    micro-CDR only aligns a value if it is bigger than the previous one, and
+    then by at most its size - 1.
+    returns a tuple with the size and the size of the last serialized value
+    """
+    total_size = 0
+    for field in fields:
+        if field.is_header:
+            continue
+        array_size = 1
+        if field.is_array:
+            array_size = field.array_len
+        if field.is_builtin:
+            size = msgtype_size_map[bare_name(field.base_type)]
+            if size > last_size:
+                total_size += size - 1
+            total_size += size * array_size
+            last_size = size
+        else:
+            children_fields = get_children_fields(field.base_type, search_path)
+            for i in range(array_size):
+                children_size, last_size = get_serialized_size_max(children_fields,
+                        search_path, last_size)
+                total_size += children_size
+    return (total_size, last_size)
+
 
 def convert_type(spec_type):
     """
@@ -235,9 +235,11 @@
 
 /* UART8 has no alternate pin config */
 
-/* UART RX DMA configurations */
-#define DMAMAP_USART1_RX DMAMAP_USART1_RX_2
-#define DMAMAP_USART6_RX DMAMAP_USART6_RX_2
+/* UART RX DMA configurations
+ * USART1 RX uses DMA2 stream 2 (and USART6 RX stream 1), so that stream 5 is free for TIM1_UP (DShot)
+ */
+#define DMAMAP_USART1_RX DMAMAP_USART1_RX_1
+#define DMAMAP_USART6_RX DMAMAP_USART6_RX_1
 
 /*
  * CAN
@@ -47,6 +47,7 @@
 #include <stdbool.h>
 
 #include <nuttx/sched.h>
+#include <nuttx/wqueue.h>
 
 #ifdef CONFIG_SCHED_INSTRUMENTATION
 
@@ -281,6 +282,28 @@ void sched_note_cpu_resumed(FAR struct tcb_s *tcb);
 #  define sched_note_cpu_resumed(t)
 #endif
 
+/********************************************************************************
+ * Name: sched_note_work_begin, sched_note_work_end
+ *
+ * Description:
+ *   Called by the kernel work queue threads before and after each work item.
+ *   The value returned by sched_note_work_begin() (e.g. a timestamp of the
+ *   outboard logic) is passed back to sched_note_work_end().
+ *
+ * Input Parameters:
+ *   qid    - The work queue (HPWORK or LPWORK)
+ *   worker - The work callback
+ *   begin  - The value returned by sched_note_work_begin()
+ *   late   - Clock ticks between the time the work was due and its start
+ *
+ ********************************************************************************/
+
+#ifdef CONFIG_SCHED_WORKQUEUE
+uint32_t sched_note_work_begin(void);
+void sched_note_work_end(int qid, worker_t worker, uint32_t begin,
+                         systime_t late);
+#endif
+
 #ifdef CONFIG_SCHED_INSTRUMENTATION_PREEMPTION
 void sched_note_premption(FAR struct tcb_s *tcb, bool locked);
 #else
@@ -375,6 +398,8 @@ int note_register(void);
 #  define sched_note_stop(t)
 #  define sched_note_suspend(t)
 #  define sched_note_resume(t)
+#  define sched_note_work_begin() 0
+#  define sched_note_work_end(q,w,b,l)
 #  define sched_note_cpu_start(t,c)
 #  define sched_note_cpu_started(t)
 #  define sched_note_cpu_pause(t,c)
@@ -48,6 +48,7 @@
 #include <nuttx/irq.h>
 #include <nuttx/clock.h>
 #include <nuttx/wqueue.h>
+#include <nuttx/sched_note.h>
 
 #include "wqueue/wqueue.h"
 
@@ -103,6 +104,18 @@ void work_process(FAR struct kwork_wqueue_s *wqueue, systime_t period, int wndx)
   systime_t stick;
   systime_t ctick;
   systime_t next;
+#ifdef CONFIG_SCHED_INSTRUMENTATION
+  systime_t late;
+  uint32_t begin;
+  int qid = LPWORK;
+
+#ifdef CONFIG_SCHED_HPWORK
+  if (wqueue == (FAR struct kwork_wqueue_s *)&g_hpwork)
+    {
+      qid = HPWORK;
+    }
+#endif
+#endif
 
   /* Then process queued work.  We need to keep interrupts disabled while
    * we process items in the work list.
@@ -161,9 +174,18 @@ void work_process(FAR struct kwork_wqueue_s *wqueue, systime_t period, int wndx)
                * performed... we don't have any idea how long this will take!
                */
 
+#ifdef CONFIG_SCHED_INSTRUMENTATION
+              late  = elapsed - work->delay;
+              begin = sched_note_work_begin();
+#endif
+
               leave_critical_section(flags);
               worker(arg);
 
+#ifdef CONFIG_SCHED_INSTRUMENTATION
+              sched_note_work_end(qid, worker, begin, late);
+#endif
+
               /* Now, unfortunately, since we re-enabled interrupts we don't
                * know the state of the work list and we will have to start
                * back at the head of the list.
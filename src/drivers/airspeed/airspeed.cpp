@@ -237,15 +237,40 @@ Airspeed::start()
 	_collect_phase = false;
 
 	/* schedule a cycle to start things */
-	work_queue(HPWORK, &_work, (worker_t)&Airspeed::cycle_trampoline, this, 1);
+	if (_scheduler == nullptr) {
+		_scheduler = device::I2CScheduler::instance(_bus);
+
+		if (_scheduler != nullptr) {
+			_scheduler->add(_scheduler_client, &Airspeed::cycle_trampoline, this, USEC_PER_TICK);
+			return;
+		}
+	}
+
+	schedule_cycle(USEC_PER_TICK);
 }
 
 void
 Airspeed::stop()
 {
+	if (_scheduler != nullptr) {
+		_scheduler->remove(_scheduler_client);
+		_scheduler = nullptr;
+	}
+
 	work_cancel(HPWORK, &_work);
 }
 
+void
+Airspeed::schedule_cycle(uint32_t delay_us)
+{
+	if (_scheduler != nullptr) {
+		_scheduler->schedule(_scheduler_client, delay_us);
+
+	} else {
+		work_queue(HPWORK, &_work, (worker_t)&Airspeed::cycle_trampoline, this, USEC2TICK(delay_us));
+	}
+}
+
 void
 Airspeed::update_status()
 {
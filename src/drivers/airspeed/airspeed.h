@@ -40,6 +40,7 @@
 #include <px4_config.h>
 #include <px4_defines.h>
 #include <px4_workqueue.h>
+#include <drivers/device/i2c_scheduler.h>
 #include <systemlib/airspeed.h>
 #include <systemlib/perf_counter.h>
 #include <uORB/topics/differential_pressure.h>
@@ -80,7 +81,9 @@ protected:
 	 */
 	void update_status();
 
-	work_s			_work;
+	work_s			_work;		///< used if there is no scheduler for the bus
+	device::I2CScheduler	*_scheduler{nullptr};
+	device::I2CScheduler::Client _scheduler_client;
 	bool			_sensor_ok;
 	bool			_last_published_sensor_ok;
 	uint32_t		_measure_ticks;
@@ -112,6 +115,13 @@ protected:
 	*/
 	void	stop();
 
+	/**
+	* Schedule the next cycle() call, together with the other drivers on the bus.
+	*
+	* @param delay_us	delay until the call
+	*/
+	void	schedule_cycle(uint32_t delay_us);
+
 	/**
 	* Static trampoline from the workq context; because we don't have a
 	* generic workq wrapper yet.
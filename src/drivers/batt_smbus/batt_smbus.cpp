@@ -76,6 +76,7 @@
 #include <drivers/drv_hrt.h>
 #include <drivers/drv_batt_smbus.h>
 #include <drivers/device/ringbuffer.h>
+#include <drivers/device/i2c_scheduler.h>
 
 #define BATT_SMBUS_ADDR_MIN             0x08	///< lowest possible address
 #define BATT_SMBUS_ADDR_MAX             0x7F	///< highest possible address
@@ -230,6 +231,11 @@ private:
 	 */
 	static void		cycle_trampoline(void *arg);
 
+	/**
+	 * schedule the next cycle, together with the other drivers on the bus
+	 */
+	void			schedule_cycle(uint32_t delay_us);
+
 	/**
 	 * perform a read from the battery
 	 */
@@ -277,7 +283,9 @@ private:
 
 	// internal variables
 	bool			_enabled;	///< true if we have successfully connected to battery
-	work_s			_work;		///< work queue for scheduling reads
+	work_s			_work;		///< work queue for scheduling reads if there is no scheduler for the bus
+	device::I2CScheduler	*_scheduler{nullptr};
+	device::I2CScheduler::Client _scheduler_client;
 	ringbuffer::RingBuffer	*_reports;	///< buffer of recorded voltages, currents
 	struct battery_status_s _last_report;	///< last published report, used for test()
 	orb_advert_t		_batt_topic;	///< uORB battery topic
@@ -566,15 +574,40 @@ BATT_SMBUS::start()
 	_reports->flush();
 
 	// schedule a cycle to start things
-	work_queue(HPWORK, &_work, (worker_t)&BATT_SMBUS::cycle_trampoline, this, 1);
+	if (_scheduler == nullptr) {
+		_scheduler = device::I2CScheduler::instance(_bus);
+
+		if (_scheduler != nullptr) {
+			_scheduler->add(_scheduler_client, &BATT_SMBUS::cycle_trampoline, this, USEC_PER_TICK);
+			return;
+		}
+	}
+
+	schedule_cycle(USEC_PER_TICK);
 }
 
 void
 BATT_SMBUS::stop()
 {
+	if (_scheduler != nullptr) {
+		_scheduler->remove(_scheduler_client);
+		_scheduler = nullptr;
+	}
+
 	work_cancel(HPWORK, &_work);
 }
 
+void
+BATT_SMBUS::schedule_cycle(uint32_t delay_us)
+{
+	if (_scheduler != nullptr) {
+		_scheduler->schedule(_scheduler_client, delay_us);
+
+	} else {
+		work_queue(HPWORK, &_work, (worker_t)&BATT_SMBUS::cycle_trampoline, this, USEC2TICK(delay_us));
+	}
+}
+
 void
 BATT_SMBUS::cycle_trampoline(void *arg)
 {
@@ -731,8 +764,7 @@ BATT_SMBUS::cycle()
 	}
 
 	// schedule a fresh cycle call when the measurement is done
-	work_queue(HPWORK, &_work, (worker_t)&BATT_SMBUS::cycle_trampoline, this,
-		   USEC2TICK(BATT_SMBUS_MEASUREMENT_INTERVAL_US));
+	schedule_cycle(BATT_SMBUS_MEASUREMENT_INTERVAL_US);
 }
 
 int
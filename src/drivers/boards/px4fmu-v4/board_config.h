@@ -318,6 +318,9 @@
 
 #define BOARD_HAS_PWM    DIRECT_PWM_OUTPUT_CHANNELS
 
+/* DShot on TIM1 (outputs 1-4), see DMAMAP_TIM1_UP. TIM4 has no free DMA stream (used by UART8 RX) */
+#define BOARD_HAS_DSHOT
+
 #define BOARD_FMU_GPIO_TAB { \
 		{GPIO_GPIO0_INPUT,       GPIO_GPIO0_OUTPUT,       0}, \
 		{GPIO_GPIO1_INPUT,       GPIO_GPIO1_OUTPUT,       0}, \
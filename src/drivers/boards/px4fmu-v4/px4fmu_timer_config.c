@@ -42,6 +42,7 @@
 #include <stdint.h>
 
 #include <stm32.h>
+#include <stm32_dma.h>
 #include <stm32_gpio.h>
 #include <stm32_tim.h>
 
@@ -60,7 +61,7 @@ __EXPORT const io_timers_t io_timers[MAX_IO_TIMERS] = {
 		.last_channel_index = 3,
 		.handler = io_timer_handler0,
 		.vectorno =  STM32_IRQ_TIM1CC,
-
+		.dshot_dmamap = DMAMAP_TIM1_UP,
 	},
 	{
 		.base = STM32_TIM4_BASE,
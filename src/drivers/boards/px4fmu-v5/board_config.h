@@ -313,6 +313,10 @@
 
 #define BOARD_HAS_HW_VERSIONING
 
+/* The linker script places PX4_FAST_CODE/PX4_FAST_DATA into ITCM RAM */
+
+#define BOARD_HAS_ITCM_RAM
+
 #define GPIO_HW_REV_DRIVE    /* PH14  */ (GPIO_OUTPUT|GPIO_PUSHPULL|GPIO_SPEED_2MHz|GPIO_OUTPUT_SET|GPIO_PORTH|GPIO_PIN14)
 #define GPIO_HW_REV_SENSE    /* PC3   */ ADC1_GPIO(13)
 #define GPIO_HW_VER_DRIVE    /* PG0   */ (GPIO_OUTPUT|GPIO_PUSHPULL|GPIO_SPEED_2MHz|GPIO_OUTPUT_SET|GPIO_PORTG|GPIO_PIN0)
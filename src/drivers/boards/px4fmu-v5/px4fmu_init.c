@@ -104,6 +104,12 @@ extern void led_on(int led);
 extern void led_off(int led);
 __END_DECLS
 
+/* ITCM RAM section bounds and load address, see scripts/ld.script */
+
+extern uint32_t _sitcm;
+extern uint32_t _eitcm;
+extern uint32_t _litcm;
+
 
 /************************************************************************************
  * Name: board_rc_input
@@ -212,6 +218,11 @@ stm32_boardinitialize(void)
 {
 	board_on_reset(-1); /* Reset PWM first thing */
 
+	/* copy the PX4_FAST_CODE/PX4_FAST_DATA section into ITCM RAM before anything can call into it */
+
+	memcpy(&_sitcm, &_litcm, (uintptr_t)&_eitcm - (uintptr_t)&_sitcm);
+	__asm__ __volatile__("dsb\n\tisb" ::: "memory");
+
 	/* configure LEDs */
 
 	board_autoled_initialize();
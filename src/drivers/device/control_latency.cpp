@@ -0,0 +1,170 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file control_latency.cpp
+ */
+
+#include "control_latency.h"
+
+#include <uORB/topics/vehicle_attitude.h>
+
+ControlLatency::ControlLatency() :
+	_attitude_sub(orb_subscribe(ORB_ID(vehicle_attitude)))
+{
+}
+
+ControlLatency::~ControlLatency()
+{
+	orb_unsubscribe(_attitude_sub);
+
+	if (_latency_pub != nullptr) {
+		orb_unadvertise(_latency_pub);
+	}
+}
+
+void
+ControlLatency::update(hrt_abstime output_time, hrt_abstime controls_timestamp, hrt_abstime controls_timestamp_sample)
+{
+	if (controls_timestamp_sample != 0) {
+		add_sample(control_latency_s::STAGE_CONTROLLER, controls_timestamp_sample, controls_timestamp);
+		add_sample(control_latency_s::STAGE_TOTAL, controls_timestamp_sample, output_time);
+	}
+
+	add_sample(control_latency_s::STAGE_OUTPUT, controls_timestamp, output_time);
+
+	/* the estimator runs in parallel to the rate controller, each estimate is counted once */
+	bool attitude_updated = false;
+	orb_check(_attitude_sub, &attitude_updated);
+
+	if (attitude_updated) {
+		vehicle_attitude_s attitude;
+		orb_copy(ORB_ID(vehicle_attitude), _attitude_sub, &attitude);
+
+		if (attitude.timestamp_sample != 0 && attitude.timestamp != _attitude_timestamp) {
+			add_sample(control_latency_s::STAGE_ESTIMATOR, attitude.timestamp_sample, attitude.timestamp);
+		}
+
+		_attitude_timestamp = attitude.timestamp;
+	}
+
+	if (output_time >= _latency.timestamp + PUBLISH_INTERVAL) {
+		publish(output_time);
+	}
+}
+
+void
+ControlLatency::add_sample(uint8_t stage, hrt_abstime from, hrt_abstime to)
+{
+	/* timestamps from another time base (e.g. replay) */
+	if (from == 0 || from > to) {
+		return;
+	}
+
+	const uint32_t latency = to - from;
+	uint32_t bin = latency / control_latency_s::LATENCY_BIN_WIDTH;
+
+	if (bin >= control_latency_s::LATENCY_BIN_COUNT) {
+		bin = control_latency_s::LATENCY_BIN_COUNT - 1;
+	}
+
+	if (_bins[stage][bin] < UINT16_MAX) {
+		_bins[stage][bin]++;
+	}
+
+	_latency.sample_count[stage]++;
+	_latency_sum[stage] += latency;
+
+	if (latency > _latency.latency_max[stage]) {
+		_latency.latency_max[stage] = latency;
+	}
+}
+
+uint32_t
+ControlLatency::percentile(uint8_t stage, uint32_t count) const
+{
+	uint32_t sum = 0;
+
+	for (unsigned bin = 0; bin < control_latency_s::LATENCY_BIN_COUNT; bin++) {
+		sum += _bins[stage][bin];
+
+		if (sum >= count) {
+			/* upper edge of the bin, but not above the largest sample */
+			const uint32_t latency = (bin + 1) * control_latency_s::LATENCY_BIN_WIDTH;
+			return (latency < _latency.latency_max[stage]) ? latency : _latency.latency_max[stage];
+		}
+	}
+
+	return _latency.latency_max[stage];
+}
+
+void
+ControlLatency::publish(hrt_abstime now)
+{
+	bool has_samples = false;
+
+	for (uint8_t stage = 0; stage < control_latency_s::STAGE_COUNT; stage++) {
+		const uint32_t count = _latency.sample_count[stage];
+
+		if (count == 0) {
+			continue;
+		}
+
+		has_samples = true;
+		_latency.latency_avg[stage] = _latency_sum[stage] / count;
+		/* rank of the percentile, rounded up */
+		_latency.latency_p50[stage] = percentile(stage, (count * 50 + 99) / 100);
+		_latency.latency_p95[stage] = percentile(stage, (count * 95 + 99) / 100);
+		_latency.latency_p99[stage] = percentile(stage, (count * 99 + 99) / 100);
+	}
+
+	_latency.timestamp = now;
+
+	if (has_samples) {
+		orb_publish_auto(ORB_ID(control_latency), &_latency_pub, &_latency, &_latency_instance, ORB_PRIO_DEFAULT);
+	}
+
+	const bool synchronized = _latency.synchronized;
+	_latency = {};
+	_latency.timestamp = now;
+	_latency.synchronized = synchronized;
+
+	for (uint8_t stage = 0; stage < control_latency_s::STAGE_COUNT; stage++) {
+		_latency_sum[stage] = 0;
+
+		for (unsigned bin = 0; bin < control_latency_s::LATENCY_BIN_COUNT; bin++) {
+			_bins[stage][bin] = 0;
+		}
+	}
+}
@@ -0,0 +1,85 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file control_latency.h
+ *
+ * Latency statistics of the control chain for output drivers, published as control_latency.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <drivers/drv_hrt.h>
+#include <uORB/uORB.h>
+#include <uORB/topics/control_latency.h>
+
+class ControlLatency
+{
+public:
+	static constexpr hrt_abstime PUBLISH_INTERVAL = 1000000; ///< [us]
+
+	ControlLatency();
+	~ControlLatency();
+
+	/**
+	 * Set if the outputs are triggered by the actuator_controls_0 publications.
+	 * Reported with the next publication.
+	 */
+	void set_synchronized(bool synchronized) { _latency.synchronized = synchronized; }
+
+	/**
+	 * Add the latencies of an output update with new actuator_controls_0.
+	 * Publishes the statistics once per publication interval.
+	 *
+	 * @param output_time		time of the output update
+	 * @param controls_timestamp	actuator_controls_0.timestamp
+	 * @param controls_timestamp_sample	actuator_controls_0.timestamp_sample
+	 */
+	void update(hrt_abstime output_time, hrt_abstime controls_timestamp, hrt_abstime controls_timestamp_sample);
+
+private:
+	void add_sample(uint8_t stage, hrt_abstime from, hrt_abstime to);
+	uint32_t percentile(uint8_t stage, uint32_t count) const;
+	void publish(hrt_abstime now);
+
+	orb_advert_t _latency_pub{nullptr};
+	int _latency_instance{-1};
+	int _attitude_sub{-1};
+	hrt_abstime _attitude_timestamp{0};
+
+	control_latency_s _latency{};
+	uint64_t _latency_sum[control_latency_s::STAGE_COUNT] {};
+	uint16_t _bins[control_latency_s::STAGE_COUNT][control_latency_s::LATENCY_BIN_COUNT] {};
+};
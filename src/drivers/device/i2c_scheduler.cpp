@@ -0,0 +1,200 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file i2c_scheduler.cpp
+ *
+ * Shared polling schedule of the low-rate drivers on an I2C bus.
+ */
+
+#include "i2c_scheduler.h"
+
+#include <px4_defines.h>
+#include <systemlib/work_queue_stats.h>
+
+namespace device
+{
+
+I2CScheduler *I2CScheduler::_instances[MAX_BUSES] {};
+
+I2CScheduler::I2CScheduler(int bus) :
+	_bus(bus),
+	_cycle_perf(perf_alloc(PC_ELAPSED, "i2c_sched: cycle"))
+{
+	px4_sem_init(&_lock, 0, 1);
+	work_queue_stats_register((worker_t)&I2CScheduler::cycle_trampoline, "i2c_scheduler");
+}
+
+I2CScheduler *I2CScheduler::instance(int bus)
+{
+	if (bus < 0 || bus >= (int)MAX_BUSES) {
+		return nullptr;
+	}
+
+	// drivers are started one after the other, the schedulers are never deleted
+	if (_instances[bus] == nullptr) {
+		_instances[bus] = new I2CScheduler(bus);
+	}
+
+	return _instances[bus];
+}
+
+void I2CScheduler::add(Client &client, callback_t callback, void *arg, uint32_t delay_us)
+{
+	do {} while (px4_sem_wait(&_lock) != 0);
+
+	client.callback = callback;
+	client.arg = arg;
+	client.scheduled = false;
+	client.next = nullptr;
+
+	// append, the clients run in the order they were added
+	Client **tail = &_clients;
+
+	while (*tail != nullptr) {
+		tail = &(*tail)->next;
+	}
+
+	*tail = &client;
+
+	px4_sem_post(&_lock);
+
+	schedule(client, delay_us);
+}
+
+void I2CScheduler::remove(Client &client)
+{
+	do {} while (px4_sem_wait(&_lock) != 0);
+
+	for (Client **c = &_clients; *c != nullptr; c = &(*c)->next) {
+		if (*c == &client) {
+			*c = client.next;
+			break;
+		}
+	}
+
+	client.scheduled = false;
+	client.next = nullptr;
+
+	schedule_work();
+
+	px4_sem_post(&_lock);
+}
+
+void I2CScheduler::schedule(Client &client, uint32_t delay_us)
+{
+	client.next_run = (uint32_t)hrt_absolute_time() + delay_us;
+	client.scheduled = true;
+
+	// within a cycle the next work is queued at the end of it
+	if (!_in_cycle) {
+		do {} while (px4_sem_wait(&_lock) != 0);
+
+		schedule_work();
+
+		px4_sem_post(&_lock);
+	}
+}
+
+void I2CScheduler::cycle_trampoline(void *arg)
+{
+	I2CScheduler *scheduler = reinterpret_cast<I2CScheduler *>(arg);
+	scheduler->cycle();
+}
+
+void I2CScheduler::cycle()
+{
+	do {} while (px4_sem_wait(&_lock) != 0);
+
+	perf_begin(_cycle_perf);
+	_in_cycle = true;
+
+	const uint32_t now = (uint32_t)hrt_absolute_time();
+
+	for (Client *client = _clients; client != nullptr; client = client->next) {
+		if (client->scheduled && (int32_t)(client->next_run - now) <= 0) {
+			client->scheduled = false;
+			client->callback(client->arg);
+		}
+	}
+
+	_in_cycle = false;
+
+	schedule_work();
+
+	perf_end(_cycle_perf);
+	px4_sem_post(&_lock);
+}
+
+void I2CScheduler::schedule_work()
+{
+	const uint32_t now = (uint32_t)hrt_absolute_time();
+	bool any = false;
+	int32_t earliest = 0;
+
+	for (Client *client = _clients; client != nullptr; client = client->next) {
+		if (client->scheduled) {
+			int32_t due = (int32_t)(client->next_run - now);
+
+			if (!any || due < earliest) {
+				earliest = due;
+				any = true;
+			}
+		}
+	}
+
+	// the work might be queued already by a schedule() from outside of the cycle
+	work_cancel(HPWORK, &_work);
+
+	if (!any) {
+		return;
+	}
+
+	// wait for the clients due within the window after the first, to serve them in the same cycle
+	int32_t wakeup = earliest;
+
+	for (Client *client = _clients; client != nullptr; client = client->next) {
+		if (client->scheduled) {
+			int32_t due = (int32_t)(client->next_run - now);
+
+			if (due > wakeup && due <= earliest + (int32_t)COALESCE_WINDOW) {
+				wakeup = due;
+			}
+		}
+	}
+
+	work_queue(HPWORK, &_work, (worker_t)&I2CScheduler::cycle_trampoline, this,
+		   wakeup > 0 ? USEC2TICK(wakeup) : 0);
+}
+
+} // namespace device
@@ -0,0 +1,120 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file i2c_scheduler.h
+ *
+ * Shared polling schedule of the low-rate drivers on an I2C bus.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <px4_sem.h>
+#include <px4_workqueue.h>
+#include <drivers/drv_hrt.h>
+#include <systemlib/perf_counter.h>
+
+namespace device
+{
+
+/**
+ * Runs the poll cycles of all the drivers on a bus from one work item.
+ *
+ * Each driver registers a Client and (re)schedules it with a delay, instead of queuing
+ * its own work. The clients that are due run in registration order within one work
+ * cycle, so their transactions do not interleave, and a wakeup is delayed by up to
+ * COALESCE_WINDOW to serve the clients due shortly after together.
+ */
+class __EXPORT I2CScheduler
+{
+public:
+	typedef void (*callback_t)(void *arg);
+
+	struct Client {
+		callback_t callback{nullptr};
+		void *arg{nullptr};
+		volatile uint32_t next_run{0};	///< lower 32 bits of the hrt time the client is due
+		volatile bool scheduled{false};
+		Client *next{nullptr};
+	};
+
+	static constexpr unsigned MAX_BUSES = 8;
+	static constexpr uint32_t COALESCE_WINDOW = 1000; ///< [us]
+
+	/**
+	 * Get the scheduler of a bus, created on first use.
+	 * @return scheduler, or nullptr for an invalid bus or if the allocation failed
+	 */
+	static I2CScheduler *instance(int bus);
+
+	/**
+	 * Add a client, the callback runs on the HP work queue after delay_us.
+	 * Must not be called from a client callback.
+	 */
+	void add(Client &client, callback_t callback, void *arg, uint32_t delay_us);
+
+	/**
+	 * Remove a client. Must not be called from a client callback.
+	 */
+	void remove(Client &client);
+
+	/**
+	 * Run the callback of a client once after delay_us. This can be called from the
+	 * callback itself to schedule the next cycle.
+	 */
+	void schedule(Client &client, uint32_t delay_us);
+
+private:
+	I2CScheduler(int bus);
+	~I2CScheduler() = default;
+
+	static void cycle_trampoline(void *arg);
+	void cycle();
+
+	/** queue the work for the next due client */
+	void schedule_work();
+
+	static I2CScheduler *_instances[MAX_BUSES];
+
+	work_s _work{};
+	px4_sem_t _lock;
+	Client *_clients{nullptr};
+	volatile bool _in_cycle{false};
+	const int _bus;
+
+	perf_counter_t _cycle_perf;
+};
+
+} // namespace device
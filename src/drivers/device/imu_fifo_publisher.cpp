@@ -0,0 +1,121 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2017 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file imu_fifo_publisher.cpp
+ */
+
+#include "imu_fifo_publisher.h"
+
+#include <math.h>
+
+ImuFifoPublisher::ImuFifoPublisher(int priority) :
+	_priority(priority)
+{
+}
+
+ImuFifoPublisher::~ImuFifoPublisher()
+{
+	if (_accel_pub != nullptr) {
+		orb_unadvertise(_accel_pub);
+	}
+
+	if (_gyro_pub != nullptr) {
+		orb_unadvertise(_gyro_pub);
+	}
+}
+
+int16_t
+ImuFifoPublisher::to_raw(float value)
+{
+	if (value >= INT16_MAX) {
+		return INT16_MAX;
+
+	} else if (value <= INT16_MIN) {
+		return INT16_MIN;
+	}
+
+	return (int16_t)roundf(value);
+}
+
+void
+ImuFifoPublisher::put(hrt_abstime timestamp_sample, float accel_x, float accel_y, float accel_z,
+		      float gyro_x, float gyro_y, float gyro_z)
+{
+	const uint8_t i = _accel.samples;
+
+	_accel.x[i] = to_raw(accel_x);
+	_accel.y[i] = to_raw(accel_y);
+	_accel.z[i] = to_raw(accel_z);
+
+	_gyro.x[i] = to_raw(gyro_x);
+	_gyro.y[i] = to_raw(gyro_y);
+	_gyro.z[i] = to_raw(gyro_z);
+
+	_accel.samples = _gyro.samples = i + 1;
+	_last_sample_time = timestamp_sample;
+
+	if (_accel.samples >= sensor_accel_fifo_s::MAX_SAMPLES) {
+		publish();
+	}
+}
+
+void
+ImuFifoPublisher::publish()
+{
+	if (_accel.samples == 0) {
+		return;
+	}
+
+	_accel.timestamp = _gyro.timestamp = hrt_absolute_time();
+	_accel.timestamp_sample = _gyro.timestamp_sample =
+					  _last_sample_time - (hrt_abstime)((_accel.samples - 1) * _dt);
+	_accel.dt = _gyro.dt = _dt;
+
+	if (_accel_pub == nullptr) {
+		_accel_pub = orb_advertise_multi(ORB_ID(sensor_accel_fifo), &_accel, &_accel_instance, _priority);
+
+	} else {
+		orb_publish(ORB_ID(sensor_accel_fifo), _accel_pub, &_accel);
+	}
+
+	if (_gyro_pub == nullptr) {
+		_gyro_pub = orb_advertise_multi(ORB_ID(sensor_gyro_fifo), &_gyro, &_gyro_instance, _priority);
+
+	} else {
+		orb_publish(ORB_ID(sensor_gyro_fifo), _gyro_pub, &_gyro);
+	}
+
+	_accel.samples = _gyro.samples = 0;
+}
@@ -0,0 +1,114 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2017 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file imu_fifo_publisher.h
+ *
+ * Collects the raw samples of an IMU FIFO read and publishes them
+ * as sensor_accel_fifo and sensor_gyro_fifo.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <drivers/drv_hrt.h>
+#include <uORB/uORB.h>
+#include <uORB/topics/sensor_accel_fifo.h>
+#include <uORB/topics/sensor_gyro_fifo.h>
+
+class ImuFifoPublisher
+{
+public:
+	/**
+	 * @param priority	uORB priority of the advertised topics
+	 */
+	ImuFifoPublisher(int priority = ORB_PRIO_DEFAULT);
+	~ImuFifoPublisher();
+
+	void set_device_ids(uint32_t accel_device_id, uint32_t gyro_device_id)
+	{
+		_accel.device_id = accel_device_id;
+		_gyro.device_id = gyro_device_id;
+	}
+
+	/**
+	 * Set the conversion from the raw sample values to SI units.
+	 * Takes effect with the next published message.
+	 */
+	void set_scale(float accel_scale, float gyro_scale)
+	{
+		_accel.scale = accel_scale;
+		_gyro.scale = gyro_scale;
+	}
+
+	/**
+	 * Set the sample interval.
+	 * Takes effect with the next published message.
+	 */
+	void set_sample_interval(float dt_us)
+	{
+		_dt = dt_us;
+	}
+
+	/**
+	 * Add a sample. The values are raw sensor values (multiply by the scale to get
+	 * SI units) in the board frame, they are rounded and clipped to the int16 range.
+	 * Publishes the collected samples if the messages are full.
+	 *
+	 * @param timestamp_sample	time of this sample
+	 */
+	void put(hrt_abstime timestamp_sample, float accel_x, float accel_y, float accel_z,
+		 float gyro_x, float gyro_y, float gyro_z);
+
+	/**
+	 * Publish the collected samples (if any), call this at the end of each FIFO read.
+	 * The sample timestamps are derived from the time of the last sample and the sample interval.
+	 */
+	void publish();
+
+private:
+	static int16_t to_raw(float value);
+
+	orb_advert_t _accel_pub{nullptr};
+	orb_advert_t _gyro_pub{nullptr};
+	int _accel_instance{-1};
+	int _gyro_instance{-1};
+	const int _priority;
+
+	hrt_abstime _last_sample_time{0};
+	float _dt{0.0f};
+
+	sensor_accel_fifo_s _accel{};
+	sensor_gyro_fifo_s _gyro{};
+};
@@ -0,0 +1,168 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2017 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file imu_integrator.cpp
+ */
+
+#include "imu_integrator.h"
+
+ImuIntegrator::ImuIntegrator(uint32_t reset_interval_us) :
+	_reset_interval(reset_interval_us)
+{
+}
+
+bool
+ImuIntegrator::put(uint64_t timestamp, const matrix::Vector3f &accel, const matrix::Vector3f &gyro,
+		   matrix::Vector3f &delta_angle, matrix::Vector3f &delta_velocity, uint32_t &integral_dt)
+{
+	if (_last_integration_time == 0) {
+		/* this is the first sample in the integrator */
+		_last_integration_time = timestamp;
+		_last_reset_time = timestamp;
+		_last_accel = accel;
+		_last_gyro = gyro;
+		return false;
+	}
+
+	// Leave dt at 0 if the integration time does not make sense.
+	// Without this check the integral is likely to explode.
+	float dt = 0.0f;
+
+	if (timestamp > _last_integration_time) {
+		dt = (timestamp - _last_integration_time) * 1e-6f;
+	}
+
+	integrate(dt, accel, gyro);
+	_last_integration_time = timestamp;
+
+	if (_reset_interval > 0 && timestamp - _last_reset_time >= _reset_interval) {
+		output(delta_angle, delta_velocity, integral_dt);
+		return true;
+	}
+
+	return false;
+}
+
+bool
+ImuIntegrator::put(uint64_t timestamp, uint32_t interval_us, const matrix::Vector3f accel[],
+		   const matrix::Vector3f gyro[], unsigned samples,
+		   matrix::Vector3f &delta_angle, matrix::Vector3f &delta_velocity, uint32_t &integral_dt)
+{
+	if (samples == 0) {
+		return false;
+	}
+
+	unsigned first = 0;
+
+	if (_last_integration_time == 0) {
+		_last_accel = accel[0];
+		_last_gyro = gyro[0];
+		first = 1;
+		_last_reset_time = timestamp - (samples - 1) * interval_us;
+	}
+
+	const float dt = interval_us * 1e-6f;
+
+	for (unsigned i = first; i < samples; i++) {
+		integrate(dt, accel[i], gyro[i]);
+	}
+
+	_last_integration_time = timestamp;
+
+	if (_reset_interval > 0 && timestamp - _last_reset_time >= _reset_interval) {
+		output(delta_angle, delta_velocity, integral_dt);
+		return true;
+	}
+
+	return false;
+}
+
+void
+ImuIntegrator::integrate(float dt, const matrix::Vector3f &accel, const matrix::Vector3f &gyro)
+{
+	// trapezoidal integration of the sample interval
+	const matrix::Vector3f delta_alpha = (gyro + _last_gyro) * (0.5f * dt);
+	const matrix::Vector3f delta_velocity = (accel + _last_accel) * (0.5f * dt);
+	_last_gyro = gyro;
+	_last_accel = accel;
+
+	// Two-sample coning and sculling corrections, using the increments of the previous sample
+	// to approximate the variation of the rates within the sample interval.
+	// Coning compensation derived by Paul Riseborough and Jonathan Challinger, following:
+	// Tian et al (2010) Three-loop Integration of GPS and Strapdown INS with Coning and Sculling Compensation
+	const matrix::Vector3f alpha_prev = _alpha + _last_delta_alpha * (1.0f / 6.0f);
+	const matrix::Vector3f velocity_prev = _velocity + _last_delta_velocity * (1.0f / 6.0f);
+
+	_beta += alpha_prev.cross(delta_alpha) * 0.5f;
+	_sculling += (alpha_prev.cross(delta_velocity) + velocity_prev.cross(delta_alpha)) * 0.5f;
+
+	_alpha += delta_alpha;
+	_velocity += delta_velocity;
+	_last_delta_alpha = delta_alpha;
+	_last_delta_velocity = delta_velocity;
+}
+
+void
+ImuIntegrator::output(matrix::Vector3f &delta_angle, matrix::Vector3f &delta_velocity, uint32_t &integral_dt)
+{
+	delta_angle = _alpha + _beta;
+
+	// The velocity increments are measured in the rotating body frame. Expressed in the frame at the start of the
+	// interval, the rotation adds 1/2 alpha x v; rotating the result to the frame at the end subtracts alpha x v
+	// (both to first order).
+	delta_velocity = _velocity - _alpha.cross(_velocity) * 0.5f + _sculling;
+
+	integral_dt = _last_integration_time - _last_reset_time;
+	_last_reset_time = _last_integration_time;
+
+	_alpha.zero();
+	_beta.zero();
+	_velocity.zero();
+	_sculling.zero();
+}
+
+void
+ImuIntegrator::reset()
+{
+	_last_integration_time = 0;
+	_last_reset_time = 0;
+
+	_alpha.zero();
+	_beta.zero();
+	_last_delta_alpha.zero();
+	_velocity.zero();
+	_sculling.zero();
+	_last_delta_velocity.zero();
+}
@@ -0,0 +1,131 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2017 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file imu_integrator.h
+ *
+ * Joint integrator for gyro and accelerometer samples, with coning and sculling
+ * compensation computed at the sample rate of the sensor.
+ *
+ * Feed it every sample (e.g. each sample of a FIFO read), and it will output the
+ * delta angle and delta velocity at the (lower) controller rate:
+ * - delta angle: rotation vector of the body over the integration interval,
+ *   corrected for coning
+ * - delta velocity: velocity increment expressed in the body frame at the end of
+ *   the interval (the frame the EKF rotates it with), corrected for the rotation
+ *   of the body during the interval and for sculling
+ *
+ * See Savage (1998) Strapdown Inertial Navigation Integration Algorithm Design,
+ * Part 1: Attitude Algorithms, Part 2: Velocity and Position Algorithms.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <matrix/math.hpp>
+
+class ImuIntegrator
+{
+public:
+	/**
+	 * @param reset_interval_us	interval after which the integrals are output and reset
+	 */
+	ImuIntegrator(uint32_t reset_interval_us = 4000 /* 250 Hz */);
+	~ImuIntegrator() = default;
+
+	void set_reset_interval(uint32_t reset_interval_us) { _reset_interval = reset_interval_us; }
+
+	/**
+	 * Put a sample into the integrals.
+	 *
+	 * @param timestamp		timestamp of the sample [us]
+	 * @param accel			corrected accelerometer sample [m/s^2]
+	 * @param gyro			corrected gyro sample [rad/s]
+	 * @param delta_angle		coning compensated delta angle [rad], only set on reset
+	 * @param delta_velocity	rotation and sculling compensated delta velocity [m/s], only set on reset
+	 * @param integral_dt		integration time [us], only set on reset
+	 * @return			true if the reset interval elapsed: the outputs are set and the
+	 *				integrator is reset
+	 */
+	bool put(uint64_t timestamp, const matrix::Vector3f &accel, const matrix::Vector3f &gyro,
+		 matrix::Vector3f &delta_angle, matrix::Vector3f &delta_velocity, uint32_t &integral_dt);
+
+	/**
+	 * Put a batch of equally spaced samples (e.g. one FIFO read) into the integrals.
+	 * The reset interval is only checked after the whole batch, so the output rate is
+	 * at most the batch rate.
+	 *
+	 * @param timestamp		timestamp of the last sample [us]
+	 * @param interval_us		sample interval [us]
+	 * @param accel			accelerometer samples [m/s^2], oldest first
+	 * @param gyro			gyro samples [rad/s], oldest first
+	 * @param samples		number of samples
+	 * @see put()
+	 */
+	bool put(uint64_t timestamp, uint32_t interval_us, const matrix::Vector3f accel[], const matrix::Vector3f gyro[],
+		 unsigned samples, matrix::Vector3f &delta_angle, matrix::Vector3f &delta_velocity, uint32_t &integral_dt);
+
+	/**
+	 * Drop the current integrals and the sample history, e.g. after a sensor reset or
+	 * a change of the sensor configuration.
+	 */
+	void reset();
+
+private:
+	/**
+	 * Integrate one sample over dt
+	 */
+	void integrate(float dt, const matrix::Vector3f &accel, const matrix::Vector3f &gyro);
+
+	/**
+	 * Output the compensated integrals and reset them
+	 */
+	void output(matrix::Vector3f &delta_angle, matrix::Vector3f &delta_velocity, uint32_t &integral_dt);
+
+	uint32_t _reset_interval;
+
+	uint64_t _last_integration_time{0};	///< timestamp of the last sample, 0 if there is none
+	uint64_t _last_reset_time{0};		///< start of the current integration interval
+
+	matrix::Vector3f _last_accel;		///< previous sample, for the trapezoidal integration
+	matrix::Vector3f _last_gyro;
+
+	matrix::Vector3f _alpha;		///< sum of the delta angles since the last reset
+	matrix::Vector3f _beta;			///< accumulated coning correction
+	matrix::Vector3f _last_delta_alpha;	///< delta angle of the previous sample
+
+	matrix::Vector3f _velocity;		///< sum of the delta velocities since the last reset
+	matrix::Vector3f _sculling;		///< accumulated sculling correction
+	matrix::Vector3f _last_delta_velocity;	///< delta velocity of the previous sample
+};
@@ -43,10 +43,12 @@
 #include <stdint.h>
 #include <stdio.h>
 
+#include <systemlib/mem_pool.h>
+
 namespace ringbuffer __EXPORT
 {
 
-class RingBuffer
+class RingBuffer : public MemPoolAllocated
 {
 public:
 	RingBuffer(unsigned num_items, size_t item_size);
@@ -176,4 +178,191 @@ private:
 	RingBuffer operator=(const RingBuffer &);
 };
 
+/**
+ * Typed single-producer, single-consumer ring buffer with static storage.
+ *
+ * Meant for the report queues between a driver's measure callback (producer,
+ * possibly in interrupt context) and read() (consumer). Neither side locks or
+ * disables interrupts: the producer only writes _head, the consumer only
+ * writes _tail, and the consumer detects reports the producer overwrote
+ * (force()) while they were copied out and retries.
+ *
+ * The storage has N slots, N must be a power of two. One slot is kept free for
+ * the report being written, so the queue depth can be changed at runtime up to
+ * N - 1.
+ */
+template<typename T, unsigned N>
+class RingBufferT
+{
+public:
+	static_assert(N >= 2 && (N & (N - 1)) == 0, "RingBufferT capacity must be a power of two");
+
+	RingBufferT(unsigned depth = N - 1) :
+		_depth((depth > 0 && depth < N) ? depth : N - 1)
+	{}
+
+	/**
+	 * Put an item into the buffer (producer).
+	 *
+	 * @param val		Item to put
+	 * @return		true if the item was put, false if the buffer is full
+	 */
+	bool put(const T &val)
+	{
+		const uint32_t head = __atomic_load_n(&_head, __ATOMIC_RELAXED);
+
+		if (head - __atomic_load_n(&_tail, __ATOMIC_ACQUIRE) >= _depth) {
+			return false;
+		}
+
+		write(head, val);
+		return true;
+	}
+
+	/**
+	 * Force an item into the buffer (producer), discarding the oldest item if
+	 * there is not space.
+	 *
+	 * @param val		Item to put
+	 * @return		true if an item was discarded to make space
+	 */
+	bool force(const T &val)
+	{
+		const uint32_t head = __atomic_load_n(&_head, __ATOMIC_RELAXED);
+		const bool discarded = head - __atomic_load_n(&_tail, __ATOMIC_ACQUIRE) >= _depth;
+
+		write(head, val);
+		return discarded;
+	}
+
+	/**
+	 * Get an item from the buffer (consumer).
+	 *
+	 * @param val		Item that was gotten
+	 * @return		true if an item was got, false if the buffer was empty.
+	 */
+	bool get(T &val)
+	{
+		return get_n(&val, 1) == 1;
+	}
+
+	/**
+	 * Get up to max items from the buffer (consumer), oldest first.
+	 *
+	 * @return		The number of items copied to val
+	 */
+	unsigned get_n(T *val, unsigned max)
+	{
+		for (;;) {
+			const uint32_t head = __atomic_load_n(&_head, __ATOMIC_ACQUIRE);
+			uint32_t tail = __atomic_load_n(&_tail, __ATOMIC_RELAXED);
+
+			/* drop the items that fell out of the queue depth */
+			if (head - tail > _depth) {
+				tail = head - _depth;
+			}
+
+			const unsigned n = (head - tail < max) ? head - tail : max;
+
+			for (unsigned i = 0; i < n; i++) {
+				val[i] = _items[(tail + i) & MASK];
+			}
+
+			/*
+			 * The producer writes slot _head before publishing it, so the copy is
+			 * only intact if _head did not reach the slot of the oldest item.
+			 */
+			__atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+			if (__atomic_load_n(&_head, __ATOMIC_RELAXED) - tail < N) {
+				__atomic_store_n(&_tail, tail + n, __ATOMIC_RELEASE);
+				return n;
+			}
+		}
+	}
+
+	/*
+	 * Get the number of items in the buffer.
+	 */
+	unsigned count() const
+	{
+		const uint32_t used = __atomic_load_n(&_head, __ATOMIC_ACQUIRE) - __atomic_load_n(&_tail, __ATOMIC_ACQUIRE);
+		return (used < _depth) ? used : _depth;
+	}
+
+	/*
+	 * Returns true if the buffer is empty.
+	 */
+	bool empty() const { return count() == 0; }
+
+	/*
+	 * Returns the queue depth.
+	 */
+	unsigned size() const { return _depth; }
+
+	/*
+	 * Returns the maximum queue depth.
+	 */
+	static constexpr unsigned capacity() { return N - 1; }
+
+	/*
+	 * Empties the buffer (consumer).
+	 */
+	void flush()
+	{
+		__atomic_store_n(&_tail, __atomic_load_n(&_head, __ATOMIC_ACQUIRE), __ATOMIC_RELEASE);
+	}
+
+	/*
+	 * Change the queue depth (consumer) and empty the buffer.
+	 *
+	 * @return		false if depth is 0 or above capacity()
+	 */
+	bool set_depth(unsigned depth)
+	{
+		if (depth < 1 || depth > capacity()) {
+			return false;
+		}
+
+		_depth = depth;
+		flush();
+		return true;
+	}
+
+	/*
+	 * printf() some info on the buffer
+	 */
+	void print_info(const char *name) const
+	{
+		printf("%s	%u/%u/%lu (%u/%u @ %p)\n",
+		       name,
+		       _depth,
+		       N,
+		       (unsigned long)sizeof(_items),
+		       (unsigned)_head,
+		       (unsigned)_tail,
+		       _items);
+	}
+
+private:
+	static constexpr uint32_t MASK = N - 1;
+
+	T			_items[N];
+	volatile unsigned	_depth;
+	uint32_t		_head{0};	/**< free running insertion count, written by the producer only */
+	uint32_t		_tail{0};	/**< free running removal count, written by the consumer only */
+
+	void write(uint32_t head, const T &val)
+	{
+		/* the consumer must see the previous _head before this slot changes */
+		__atomic_thread_fence(__ATOMIC_RELEASE);
+		_items[head & MASK] = val;
+		__atomic_store_n(&_head, head + 1, __ATOMIC_RELEASE);
+	}
+
+	/* we don't want this class to be copied */
+	RingBufferT(const RingBufferT &);
+	RingBufferT operator=(const RingBufferT &);
+};
+
 } // namespace ringbuffer
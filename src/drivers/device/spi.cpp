@@ -47,6 +47,7 @@
 
 #include <px4_config.h>
 #include <nuttx/arch.h>
+#include <nuttx/wqueue.h>
 #include "spi.h"
 
 #ifndef CONFIG_SPI_EXCHANGE
@@ -56,6 +57,29 @@
 namespace device
 {
 
+/**
+ * Pending transfer_async() transfers of a bus
+ */
+struct SPI::BusQueue {
+	struct Transfer {
+		SPI			*dev;
+		uint8_t			*send;
+		uint8_t			*recv;
+		unsigned		len;
+		transfer_callback_t	callback;
+		void			*arg;
+	};
+
+	static const unsigned	size = 8;
+	Transfer		transfers[size];
+	unsigned		head;		/**< next slot to write (in a critical section) */
+	unsigned		tail;		/**< next transfer to execute (in a critical section) */
+	bool			scheduled;	/**< worker queued or running */
+	struct work_s		work;
+};
+
+SPI::BusQueue SPI::_bus_queues[SPI::_max_buses] {};
+
 SPI::SPI(const char *name,
 	 const char *devname,
 	 int bus,
@@ -172,6 +196,69 @@ SPI::transfer(uint8_t *send, uint8_t *recv, unsigned len)
 	return result;
 }
 
+int
+SPI::transfer_async(uint8_t *send, uint8_t *recv, unsigned len, transfer_callback_t callback, void *arg)
+{
+	if ((send == nullptr && recv == nullptr) || callback == nullptr || _bus < 1 || _bus > _max_buses) {
+		return -EINVAL;
+	}
+
+	BusQueue &queue = _bus_queues[_bus - 1];
+	bool schedule = false;
+	int ret = OK;
+
+	irqstate_t state = px4_enter_critical_section();
+
+	if (queue.head - queue.tail >= BusQueue::size) {
+		ret = -EBUSY;
+
+	} else {
+		BusQueue::Transfer &t = queue.transfers[queue.head % BusQueue::size];
+		t.dev = this;
+		t.send = send;
+		t.recv = recv;
+		t.len = len;
+		t.callback = callback;
+		t.arg = arg;
+		queue.head++;
+
+		schedule = !queue.scheduled;
+		queue.scheduled = true;
+	}
+
+	px4_leave_critical_section(state);
+
+	if (schedule) {
+		work_queue(HPWORK, &queue.work, (worker_t)&SPI::bus_queue_worker, &queue, 0);
+	}
+
+	return ret;
+}
+
+void
+SPI::bus_queue_worker(void *arg)
+{
+	BusQueue *queue = (BusQueue *)arg;
+
+	/* execute everything that is queued, including what is added in the meantime */
+	for (;;) {
+		irqstate_t state = px4_enter_critical_section();
+
+		if (queue->tail == queue->head) {
+			queue->scheduled = false;
+			px4_leave_critical_section(state);
+			break;
+		}
+
+		BusQueue::Transfer t = queue->transfers[queue->tail % BusQueue::size];
+		queue->tail++;
+		px4_leave_critical_section(state);
+
+		int result = t.dev->transfer(t.send, t.recv, t.len);
+		t.callback(t.arg, result);
+	}
+}
+
 void
 SPI::set_frequency(uint32_t frequency)
 {
@@ -110,6 +110,36 @@ protected:
 	 */
 	int		transfer(uint8_t *send, uint8_t *recv, unsigned len);
 
+	/**
+	 * Completion callback of transfer_async(), called from the HP work queue thread.
+	 *
+	 * @param arg		The argument given to transfer_async().
+	 * @param result	OK if the exchange was successful, -errno otherwise.
+	 */
+	typedef void (*transfer_callback_t)(void *arg, int result);
+
+	/**
+	 * Queue a SPI transfer and return immediately.
+	 *
+	 * The transfers queued on a bus (by any device on it) are executed in order and
+	 * back-to-back on the HP work queue, using the locking mode of each device, so that
+	 * the caller (e.g. a HRT callback) does not have to wait for the exchange. In thread
+	 * context the SPI driver can block on its DMA completion instead of busy-waiting
+	 * (CONFIG_STM32_SPI_DMA, with LOCK_THREADS). Sharing the bus with clients calling
+	 * transfer() from interrupt context is subject to the same races as described above.
+	 *
+	 * Can be called from interrupt context. The buffers must stay valid until the callback.
+	 *
+	 * @param send		Bytes to send to the device, or nullptr.
+	 * @param recv		Buffer for receiving bytes from the device, or nullptr.
+	 * @param len		Number of bytes to transfer.
+	 * @param callback	Called when the transfer is done.
+	 * @param arg		Argument for the callback.
+	 * @return		OK if the transfer was queued, -EBUSY if the queue of
+	 *			the bus is full, -EINVAL on invalid arguments.
+	 */
+	int		transfer_async(uint8_t *send, uint8_t *recv, unsigned len, transfer_callback_t callback, void *arg);
+
 	/**
 	 * Set the SPI bus frequency
 	 * This is used to change frequency on the fly. Some sensors
@@ -139,6 +169,13 @@ private:
 	uint32_t		_frequency;
 	struct spi_dev_s	*_dev;
 
+	struct BusQueue;
+
+	static const int	_max_buses = 6;
+	static BusQueue		_bus_queues[_max_buses];	/**< transfer_async() queues, by bus number - 1 */
+
+	static void		bus_queue_worker(void *arg);
+
 	/* this class does not allow copying */
 	SPI(const SPI &);
 	SPI operator=(const SPI &);
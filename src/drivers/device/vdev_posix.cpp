@@ -43,6 +43,7 @@
 #include "device.h"
 #include "vfile.h"
 
+#include <drivers/drv_hrt.h>
 #include <hrt_work.h>
 #include <stdlib.h>
 #include <stdio.h>
@@ -53,13 +54,104 @@
 using namespace device;
 
 pthread_mutex_t filemutex = PTHREAD_MUTEX_INITIALIZER;
-px4_sem_t lockstep_sem;
-bool sim_lockstep = false;
 volatile bool sim_delay = false;
+static pthread_mutex_t sim_delay_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t sim_delay_cond = PTHREAD_COND_INITIALIZER;
+
+#ifndef __PX4_QURT
+/* The semaphore of px4_poll() is created once per thread and kept in thread specific data */
+static pthread_key_t poll_sem_key;
+static pthread_once_t poll_sem_key_once = PTHREAD_ONCE_INIT;
+
+static void poll_sem_free(void *sem)
+{
+	px4_sem_destroy((px4_sem_t *)sem);
+	delete (px4_sem_t *)sem;
+}
+
+static void poll_sem_key_create()
+{
+	pthread_key_create(&poll_sem_key, poll_sem_free);
+}
+#endif
+
+/* Get the semaphore for a px4_poll() call, nullptr if it cannot be allocated */
+static px4_sem_t *poll_sem_get(px4_sem_t *local_sem)
+{
+#ifdef __PX4_QURT
+	px4_sem_t *sem = local_sem;
+	px4_sem_init(sem, 0, 0);
+#else
+	// the thread's semaphore is reused, a local one is not needed
+	(void)local_sem;
+	pthread_once(&poll_sem_key_once, poll_sem_key_create);
+	px4_sem_t *sem = (px4_sem_t *)pthread_getspecific(poll_sem_key);
+
+	if (sem) {
+		// drop the posts of notifications that came in after the last wakeup
+		while (px4_sem_trywait(sem) == 0) {}
+
+		return sem;
+	}
+
+	sem = new px4_sem_t;
+
+	if (!sem) {
+		return nullptr;
+	}
+
+	px4_sem_init(sem, 0, 0);
+	pthread_setspecific(poll_sem_key, sem);
+#endif
+
+	// sem use case is a signal
+	px4_sem_setprotocol(sem, SEM_PRIO_NONE);
+
+	return sem;
+}
+
+static void poll_sem_release(px4_sem_t *sem)
+{
+#ifdef __PX4_QURT
+	px4_sem_destroy(sem);
+#endif
+}
+
+/* Get the name of the calling thread (for error output) */
+static const char *get_thread_name(char *thread_name, unsigned len)
+{
+#ifndef __PX4_QURT
+	int nret = pthread_getname_np(pthread_self(), thread_name, len);
+
+	if (nret || thread_name[0] == 0) {
+		PX4_WARN("failed getting thread name");
+	}
+
+#endif
+	return thread_name;
+}
+
+/* Block while the simulator delays the system (see px4_sim_start_delay()) */
+static void wait_for_sim_delay()
+{
+	if (!sim_delay) {
+		return;
+	}
+
+	pthread_mutex_lock(&sim_delay_mutex);
+
+	while (sim_delay) {
+		pthread_cond_wait(&sim_delay_cond, &sim_delay_mutex);
+	}
+
+	pthread_mutex_unlock(&sim_delay_mutex);
+}
 
 extern "C" {
 
+#ifndef PX4_MAX_FD
 #define PX4_MAX_FD 350
+#endif
 	static device::file_t filemap[PX4_MAX_FD] = {};
 
 	int px4_errno;
@@ -258,7 +350,7 @@ extern "C" {
 			return -1;
 		}
 
-		px4_sem_t sem;
+		px4_sem_t local_sem;
 		int count = 0;
 		int ret = -1;
 		unsigned int i;
@@ -266,44 +358,48 @@ extern "C" {
 		const unsigned NAMELEN = 32;
 		char thread_name[NAMELEN] = {};
 
-#ifndef __PX4_QURT
-		int nret = pthread_getname_np(pthread_self(), thread_name, NAMELEN);
+		wait_for_sim_delay();
 
-		if (nret || thread_name[0] == 0) {
-			PX4_WARN("failed getting thread name");
-		}
+		PX4_DEBUG("Called px4_poll timeout = %d", timeout);
 
-#endif
+		px4_sem_t *sem = poll_sem_get(&local_sem);
 
-		while (sim_delay) {
-			usleep(100);
+		if (!sem) {
+			px4_errno = ENOMEM;
+			return -1;
 		}
 
-		PX4_DEBUG("Called px4_poll timeout = %d", timeout);
+		// Look up all devices at once, they are used for the setup and
+		// the teardown
+		CDev *devs[nfds];
 
-		px4_sem_init(&sem, 0, 0);
+		pthread_mutex_lock(&filemutex);
 
-		// sem use case is a signal
-		px4_sem_setprotocol(&sem, SEM_PRIO_NONE);
+		for (i = 0; i < nfds; ++i) {
+			const int fd = fds[i].fd;
+			devs[i] = (fd < PX4_MAX_FD && fd >= 0) ? (CDev *)filemap[fd].vdev : nullptr;
+		}
+
+		pthread_mutex_unlock(&filemutex);
 
 		// Go through all fds and check them for a pollable state
 		bool fd_pollable = false;
 
 		for (i = 0; i < nfds; ++i) {
-			fds[i].sem     = &sem;
+			fds[i].sem     = sem;
 			fds[i].revents = 0;
 			fds[i].priv    = nullptr;
 
-			CDev *dev = get_vdev(fds[i].fd);
+			CDev *dev = devs[i];
 
 			// If fd is valid
 			if (dev) {
-				PX4_DEBUG("%s: px4_poll: CDev->poll(setup) %d", thread_name, fds[i].fd);
+				PX4_DEBUG("px4_poll: CDev->poll(setup) %d", fds[i].fd);
 				ret = dev->poll(&filemap[fds[i].fd], &fds[i], true);
 
 				if (ret < 0) {
 					PX4_WARN("%s: px4_poll() error: %s",
-						 thread_name, strerror(errno));
+						 get_thread_name(thread_name, NAMELEN), strerror(errno));
 					break;
 				}
 
@@ -316,7 +412,11 @@ extern "C" {
 		// If any FD can be polled, lock the semaphore and
 		// check for new data
 		if (fd_pollable) {
-			if (timeout > 0) {
+			if (timeout > 0 && hrt_lockstep_enabled()) {
+				// the timeout is in simulation time
+				ret = -hrt_lockstep_sem_timedwait(sem, hrt_absolute_time() + (hrt_abstime)timeout * 1000);
+
+			} else if (timeout > 0) {
 
 				// Get the current time
 				struct timespec ts;
@@ -333,7 +433,7 @@ extern "C" {
 
 				// Execute a blocking wait for that time in the future
 				errno = 0;
-				ret = px4_sem_timedwait(&sem, &ts);
+				ret = px4_sem_timedwait(sem, &ts);
 #ifndef __PX4_DARWIN
 				ret = errno;
 #endif
@@ -344,26 +444,26 @@ extern "C" {
 				}
 
 				if (ret && ret != -ETIMEDOUT) {
-					PX4_WARN("%s: px4_poll() sem error", thread_name);
+					PX4_WARN("%s: px4_poll() sem error", get_thread_name(thread_name, NAMELEN));
 				}
 
 			} else if (timeout < 0) {
-				px4_sem_wait(&sem);
+				px4_sem_wait(sem);
 			}
 
 			// We have waited now (or not, depending on timeout),
 			// go through all fds and count how many have data
 			for (i = 0; i < nfds; ++i) {
 
-				CDev *dev = get_vdev(fds[i].fd);
+				CDev *dev = devs[i];
 
 				// If fd is valid
 				if (dev) {
-					PX4_DEBUG("%s: px4_poll: CDev->poll(teardown) %d", thread_name, fds[i].fd);
+					PX4_DEBUG("px4_poll: CDev->poll(teardown) %d", fds[i].fd);
 					ret = dev->poll(&filemap[fds[i].fd], &fds[i], false);
 
 					if (ret < 0) {
-						PX4_WARN("%s: px4_poll() 2nd poll fail", thread_name);
+						PX4_WARN("%s: px4_poll() 2nd poll fail", get_thread_name(thread_name, NAMELEN));
 						break;
 					}
 
@@ -374,7 +474,7 @@ extern "C" {
 			}
 		}
 
-		px4_sem_destroy(&sem);
+		poll_sem_release(sem);
 
 		// Return the positive count if present,
 		// return the negative error number if failed
@@ -412,26 +512,19 @@ extern "C" {
 		CDev::showFiles();
 	}
 
-	void px4_enable_sim_lockstep()
-	{
-		px4_sem_init(&lockstep_sem, 0, 0);
-
-		// lockstep_sem use case is a signal
-
-		px4_sem_setprotocol(&lockstep_sem, SEM_PRIO_NONE);
-
-		sim_lockstep = true;
-		sim_delay = false;
-	}
-
 	void px4_sim_start_delay()
 	{
+		pthread_mutex_lock(&sim_delay_mutex);
 		sim_delay = true;
+		pthread_mutex_unlock(&sim_delay_mutex);
 	}
 
 	void px4_sim_stop_delay()
 	{
+		pthread_mutex_lock(&sim_delay_mutex);
 		sim_delay = false;
+		pthread_cond_broadcast(&sim_delay_cond);
+		pthread_mutex_unlock(&sim_delay_mutex);
 	}
 
 	bool px4_sim_delay_enabled()
@@ -46,6 +46,11 @@
 #include <px4_time.h>
 #include <queue.h>
 
+#ifdef __PX4_POSIX
+#include <pthread.h>
+#include <px4_sem.h>
+#endif
+
 __BEGIN_DECLS
 
 /**
@@ -69,14 +74,31 @@ typedef void	(* hrt_callout)(void *arg);
  * Callout record.
  */
 typedef struct hrt_call {
-	struct sq_entry_s	link;
+	struct hrt_call		*heap_child;	/**< callout queue linkage, see drv_hrt_callout_queue.h */
+	struct hrt_call		*heap_sibling;
+	struct hrt_call		*heap_prev;	/**< parent for the first child, previous sibling otherwise */
+	uint32_t		queued;
 
 	hrt_abstime		deadline;
 	hrt_abstime		period;
 	hrt_callout		callout;
 	void			*arg;
+#ifdef __PX4_POSIX
+	int			vehicle_instance;	/**< vehicle instance the callout runs in */
+#endif
 } *hrt_call_t;
 
+/**
+ * Callout statistics.
+ */
+struct hrt_callout_stats {
+	uint32_t	invoked;	/**< callouts invoked */
+	uint32_t	lateness_max;	/**< maximum delay between deadline and invocation [us] */
+	uint64_t	lateness_total;	/**< sum of the delays [us] */
+	uint16_t	queued;		/**< callouts currently queued */
+	uint16_t	queued_max;	/**< maximum number of queued callouts */
+};
+
 /**
  * Get absolute time in [us] (does not wrap).
  */
@@ -166,6 +188,13 @@ __EXPORT extern void	hrt_call_init(struct hrt_call *entry);
  */
 __EXPORT extern void	hrt_call_delay(struct hrt_call *entry, hrt_abstime delay);
 
+/**
+ * Get the callout statistics.
+ *
+ * @param reset		reset the statistics after reading them
+ */
+__EXPORT extern void	hrt_callout_stats_get(struct hrt_callout_stats *stats, bool reset);
+
 /*
  * Initialise the HRT.
  */
@@ -191,6 +220,46 @@ __EXPORT extern void	hrt_stop_delay(void);
  */
 __EXPORT extern void	hrt_stop_delay_delta(hrt_abstime delta);
 
+/**
+ * Switch the HRT to lockstep with a simulator.
+ *
+ * From then on the HRT does not follow the system clock, it continues from
+ * the current time and only advances with hrt_lockstep_set_time(). Timed waits
+ * of the work queues, px4_poll() and px4_usleep() wait for the HRT time.
+ */
+__EXPORT extern void	hrt_lockstep_enable(void);
+
+/**
+ * Return true if the HRT is in lockstep with a simulator.
+ */
+__EXPORT extern bool	hrt_lockstep_enabled(void);
+
+/**
+ * Advance the HRT time in lockstep mode and wake up the waits that are due.
+ *
+ * The time never goes backwards, an older time is ignored.
+ */
+__EXPORT extern void	hrt_lockstep_set_time(hrt_abstime time);
+
+/**
+ * Wait for the condition to be signalled or until the HRT deadline in lockstep mode.
+ *
+ * The mutex must be held, like for pthread_cond_timedwait().
+ *
+ * @return 0 if signalled (or a spurious wakeup), ETIMEDOUT if the deadline was reached
+ */
+__EXPORT extern int	hrt_lockstep_cond_timedwait(pthread_cond_t *cond, pthread_mutex_t *mutex, hrt_abstime deadline);
+
+/**
+ * Wait for the semaphore or until the HRT deadline in lockstep mode.
+ *
+ * The timeout is signalled by posting the semaphore, so it may be left posted
+ * if it was posted by someone else at the same time.
+ *
+ * @return 0 if the semaphore was posted, ETIMEDOUT if the deadline was reached
+ */
+__EXPORT extern int	hrt_lockstep_sem_timedwait(px4_sem_t *sem, hrt_abstime deadline);
+
 #endif
 
 __END_DECLS
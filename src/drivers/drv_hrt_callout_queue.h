@@ -0,0 +1,252 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2017 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file drv_hrt_callout_queue.h
+ *
+ * Callout queue shared by the HRT implementations.
+ *
+ * The queue is a pairing heap ordered by deadline: inserting a callout and
+ * looking up the next deadline are O(1), removing the earliest or an arbitrary
+ * callout is O(log n) amortized. The sorted list it replaces needed a linear
+ * search on every insert, which ran with interrupts disabled on NuttX.
+ *
+ * Only to be included by a drv_hrt.c. None of the functions lock, the caller
+ * holds the HRT lock (or has interrupts disabled).
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+#include <drivers/drv_hrt.h>
+
+/** hrt_call::queued value of the callouts in the queue */
+#define HRT_CALL_QUEUED	0x48525451u
+
+struct hrt_callout_queue {
+	struct hrt_call		*root;		/**< next callout to expire */
+	struct hrt_callout_stats stats;
+};
+
+static inline void
+hrt_callout_queue_init(struct hrt_callout_queue *queue)
+{
+	memset(queue, 0, sizeof(*queue));
+}
+
+/**
+ * Return the callout with the earliest deadline, or NULL if the queue is empty.
+ */
+static inline struct hrt_call *
+hrt_callout_queue_peek(struct hrt_callout_queue *queue)
+{
+	return queue->root;
+}
+
+/**
+ * Link two detached heaps, the root with the later deadline becomes the first
+ * child of the other one. Returns the new root.
+ */
+static inline struct hrt_call *
+hrt_callout_queue_link(struct hrt_call *a, struct hrt_call *b)
+{
+	if (a == NULL) {
+		return b;
+	}
+
+	if (b == NULL) {
+		return a;
+	}
+
+	if (b->deadline < a->deadline) {
+		struct hrt_call *tmp = a;
+		a = b;
+		b = tmp;
+	}
+
+	b->heap_prev = a;
+	b->heap_sibling = a->heap_child;
+
+	if (a->heap_child != NULL) {
+		a->heap_child->heap_prev = b;
+	}
+
+	a->heap_child = b;
+
+	return a;
+}
+
+/**
+ * Combine a list of siblings into a single detached heap (two-pass pairing).
+ *
+ * This is iterative, the stack usage does not depend on the queue length.
+ */
+static inline struct hrt_call *
+hrt_callout_queue_merge_pairs(struct hrt_call *first)
+{
+	struct hrt_call *pairs = NULL;
+
+	/* first pass, left to right: link the siblings in pairs, collecting the
+	 * results in reverse order (chained through heap_sibling) */
+	while (first != NULL) {
+		struct hrt_call *a = first;
+		struct hrt_call *b = a->heap_sibling;
+		first = (b != NULL) ? b->heap_sibling : NULL;
+
+		a->heap_sibling = a->heap_prev = NULL;
+
+		if (b != NULL) {
+			b->heap_sibling = b->heap_prev = NULL;
+		}
+
+		struct hrt_call *pair = hrt_callout_queue_link(a, b);
+		pair->heap_sibling = pairs;
+		pairs = pair;
+	}
+
+	/* second pass, right to left: link each pair into the result */
+	struct hrt_call *result = NULL;
+
+	while (pairs != NULL) {
+		struct hrt_call *next = pairs->heap_sibling;
+		pairs->heap_sibling = NULL;
+		result = hrt_callout_queue_link(result, pairs);
+		pairs = next;
+	}
+
+	return result;
+}
+
+/**
+ * Add a callout, which must not be queued yet.
+ *
+ * @return true if the callout is now the first to expire
+ */
+static inline bool
+hrt_callout_queue_insert(struct hrt_callout_queue *queue, struct hrt_call *entry)
+{
+	entry->heap_child = entry->heap_sibling = entry->heap_prev = NULL;
+	entry->queued = HRT_CALL_QUEUED;
+	queue->root = hrt_callout_queue_link(queue->root, entry);
+
+	if (++queue->stats.queued > queue->stats.queued_max) {
+		queue->stats.queued_max = queue->stats.queued;
+	}
+
+	return queue->root == entry;
+}
+
+/**
+ * Remove a callout if it is queued.
+ *
+ * The entry may be uninitialised (drivers call hrt_cancel() on entries that
+ * were never scheduled): only hrt_call::queued is read before the entry is
+ * known to be in the queue.
+ */
+static inline void
+hrt_callout_queue_remove(struct hrt_callout_queue *queue, struct hrt_call *entry)
+{
+	if (entry->queued != HRT_CALL_QUEUED) {
+		return;
+	}
+
+	struct hrt_call *children = hrt_callout_queue_merge_pairs(entry->heap_child);
+
+	if (entry == queue->root) {
+		queue->root = children;
+
+	} else {
+		/* unlink the subtree of the entry from its parent or previous sibling */
+		if (entry->heap_prev->heap_child == entry) {
+			entry->heap_prev->heap_child = entry->heap_sibling;
+
+		} else {
+			entry->heap_prev->heap_sibling = entry->heap_sibling;
+		}
+
+		if (entry->heap_sibling != NULL) {
+			entry->heap_sibling->heap_prev = entry->heap_prev;
+		}
+
+		queue->root = hrt_callout_queue_link(queue->root, children);
+	}
+
+	entry->heap_child = entry->heap_sibling = entry->heap_prev = NULL;
+	entry->queued = 0;
+	queue->stats.queued--;
+}
+
+/**
+ * Remove and return the callout with the earliest deadline if it is due at now,
+ * NULL otherwise. Updates the lateness statistics.
+ */
+static inline struct hrt_call *
+hrt_callout_queue_pop_expired(struct hrt_callout_queue *queue, hrt_abstime now)
+{
+	struct hrt_call *call = queue->root;
+
+	if (call == NULL || call->deadline > now) {
+		return NULL;
+	}
+
+	hrt_callout_queue_remove(queue, call);
+
+	uint32_t lateness = (now - call->deadline > UINT32_MAX) ? UINT32_MAX : (uint32_t)(now - call->deadline);
+	queue->stats.invoked++;
+	queue->stats.lateness_total += lateness;
+
+	if (lateness > queue->stats.lateness_max) {
+		queue->stats.lateness_max = lateness;
+	}
+
+	return call;
+}
+
+/**
+ * Copy the statistics, and optionally reset the counters (but not the
+ * number of queued callouts).
+ */
+static inline void
+hrt_callout_queue_stats(struct hrt_callout_queue *queue, struct hrt_callout_stats *stats, bool reset)
+{
+	*stats = queue->stats;
+
+	if (reset) {
+		queue->stats.invoked = 0;
+		queue->stats.lateness_total = 0;
+		queue->stats.lateness_max = 0;
+		queue->stats.queued_max = queue->stats.queued;
+	}
+}
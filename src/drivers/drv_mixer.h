@@ -109,6 +109,17 @@ struct mixer_simple_s {
  */
 #define MIXERIOCLOADBUF		_MIXERIOC(5)
 
+/** precompiled binary mixer definition (see MixerGroup::load_from_binary()) */
+struct mixer_binary_buf_s {
+	const void	*buf;
+	unsigned	buflen;
+};
+
+/**
+ * Add mixer(s) from the binary mixer definition in (const struct mixer_binary_buf_s *)arg
+ */
+#define MIXERIOCLOADBIN		_MIXERIOC(6)
+
 /*
  * XXX Thoughts for additional operations:
  *
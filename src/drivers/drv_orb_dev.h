@@ -96,4 +96,27 @@
 /** Check whether the topic is published, sets *(unsigned long *)arg to 1 if published, 0 otherwise */
 #define ORBIOCISPUBLISHED	_ORBIOC(17)
 
+/** Register a uORB::SubscriptionCallback *arg to be called on every publication of the topic */
+#define ORBIOCREGISTERCALLBACK	_ORBIOC(18)
+
+/** Unregister a uORB::SubscriptionCallback *arg previously registered with ORBIOCREGISTERCALLBACK */
+#define ORBIOCUNREGISTERCALLBACK	_ORBIOC(19)
+
+/** Copy all pending queue elements of the topic, arg is a pointer to struct orb_copy_multi_s */
+#define ORBIOCCOPYMULTI		_ORBIOC(20)
+
+/** Register a uORB::UpdateNotifier *arg to be notified on every publication of the topic */
+#define ORBIOCREGISTERNOTIFIER	_ORBIOC(21)
+
+/** Unregister a uORB::UpdateNotifier *arg previously registered with ORBIOCREGISTERNOTIFIER */
+#define ORBIOCUNREGISTERNOTIFIER	_ORBIOC(22)
+
+/** Argument of ORBIOCCOPYMULTI */
+struct orb_copy_multi_s {
+	void *buffer;		/**< buffer for max_items elements of size o_size */
+	unsigned max_items;	/**< maximum number of elements to copy */
+	unsigned count;		/**< returns the number of elements copied */
+	unsigned lost;		/**< returns the number of elements lost to queue overflow since the last copy */
+};
+
 #endif /* _DRV_UORB_H */
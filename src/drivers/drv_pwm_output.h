@@ -386,4 +386,40 @@ __EXPORT extern int	up_pwm_servo_set(unsigned channel, servo_position_t value);
  */
 __EXPORT extern servo_position_t up_pwm_servo_get(unsigned channel);
 
+/*
+ * Low-level DShot output interface (only on boards defining BOARD_HAS_DSHOT).
+ */
+
+/**
+ * Intialise the DShot outputs. A timer is only used for DShot if it supports it
+ * and all of its channels are in the mask, the other channels can be used for PWM.
+ *
+ * @param channel_mask	Bitmask of channels (LSB = channel 0) to use.
+ * @param dshot_pwm_freq	Bit rate in Hz: 150000, 300000 or 600000.
+ * @return		Bitmask of the channels that are initialized for DShot.
+ */
+__EXPORT extern int	up_dshot_init(uint32_t channel_mask, unsigned dshot_pwm_freq);
+
+/**
+ * Set the next DShot frame of a channel. It is sent with the next up_dshot_trigger().
+ *
+ * @param channel	The channel to set.
+ * @param throttle	0 to stop the motor, 1-47 are commands, 48-2047 is the throttle range.
+ * @param telemetry	Request a telemetry packet from the ESC.
+ */
+__EXPORT extern void	up_dshot_motor_data_set(unsigned channel, uint16_t throttle, bool telemetry);
+
+/**
+ * Send the DShot frames of all channels.
+ */
+__EXPORT extern void	up_dshot_trigger(void);
+
+/**
+ * Arm or disarm the DShot outputs.
+ *
+ * @param armed		If true, outputs are armed; if false they are disarmed.
+ * @return		OK on success.
+ */
+__EXPORT extern int	up_dshot_arm(bool armed);
+
 __END_DECLS
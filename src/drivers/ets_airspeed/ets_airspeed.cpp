@@ -200,11 +200,7 @@ ETSAirspeed::cycle()
 		if (_measure_ticks > USEC2TICK(CONVERSION_INTERVAL)) {
 
 			/* schedule a fresh cycle call when we are ready to measure again */
-			work_queue(HPWORK,
-				   &_work,
-				   (worker_t)&Airspeed::cycle_trampoline,
-				   this,
-				   _measure_ticks - USEC2TICK(CONVERSION_INTERVAL));
+			schedule_cycle((_measure_ticks - USEC2TICK(CONVERSION_INTERVAL)) * USEC_PER_TICK);
 
 			return;
 		}
@@ -223,11 +219,7 @@ ETSAirspeed::cycle()
 	_collect_phase = true;
 
 	/* schedule a fresh cycle call when the measurement is done */
-	work_queue(HPWORK,
-		   &_work,
-		   (worker_t)&Airspeed::cycle_trampoline,
-		   this,
-		   USEC2TICK(CONVERSION_INTERVAL));
+	schedule_cycle(CONVERSION_INTERVAL);
 }
 
 /**
@@ -428,10 +428,7 @@ GPSDriverUBX::receive(unsigned timeout)
 			//UBX_DEBUG("read %d bytes", ret);
 
 			/* pass received bytes to the packet decoder */
-			for (int i = 0; i < ret; i++) {
-				handled |= parseChar(buf[i]);
-				//UBX_DEBUG("parsed %d: 0x%x", i, buf[i]);
-			}
+			handled |= parseBuffer(buf, ret);
 
 			if (_interface == Interface::SPI) {
 				if (buf[ret - 1] == 0xff) {
@@ -452,6 +449,50 @@ GPSDriverUBX::receive(unsigned timeout)
 	}
 }
 
+int	// 0 = decoding, 1 = message handled, 2 = sat info message handled
+GPSDriverUBX::parseBuffer(const uint8_t *buf, int len)
+{
+	int handled = 0;
+	int i = 0;
+
+	while (i < len) {
+		if (_decode_state == UBX_DECODE_SYNC1 && !_rtcm_message) {
+			/* skip everything up to the next sync byte (NMEA, garbage) */
+			const uint8_t *sync = (const uint8_t *)memchr(buf + i, UBX_SYNC1, len - i);
+
+			if (!sync) {
+				break;
+			}
+
+			i = sync - buf;
+
+		} else if (_decode_state == UBX_DECODE_PAYLOAD && _rx_msg != UBX_MSG_NAV_SVINFO && _rx_msg != UBX_MSG_MON_VER) {
+			/* plain payload (see payloadRxAdd()): copy all available bytes at once */
+			const int count = MIN(len - i, (int)(_rx_payload_length - _rx_payload_index));
+			uint8_t *p_buf = (uint8_t *)&_buf;
+
+			memcpy(p_buf + _rx_payload_index, buf + i, count);
+
+			for (int j = i; j < i + count; j++) {
+				addByteToChecksum(buf[j]);
+			}
+
+			_rx_payload_index += count;
+			i += count;
+
+			if (_rx_payload_index >= _rx_payload_length) {
+				_decode_state = UBX_DECODE_CHKSUM1;
+			}
+
+			continue;
+		}
+
+		handled |= parseChar(buf[i++]);
+	}
+
+	return handled;
+}
+
 int	// 0 = decoding, 1 = message handled, 2 = sat info message handled
 GPSDriverUBX::parseChar(const uint8_t b)
 {
@@ -587,6 +587,14 @@ private:
 	 */
 	int parseChar(const uint8_t b);
 
+	/**
+	 * Parse a block of received bytes. Bytes between messages are skipped with a
+	 * search for the sync byte and plain payloads are copied in one go, everything
+	 * else goes through parseChar().
+	 * @return handled flags of parseChar(), or-ed over the block
+	 */
+	int parseBuffer(const uint8_t *buf, int len);
+
 	/**
 	 * Start payload rx
 	 */
@@ -46,6 +46,7 @@
 
 #ifndef __PX4_QURT
 #include <poll.h>
+#include <sys/ioctl.h>
 #endif
 
 
@@ -90,6 +91,9 @@
 #define TIMEOUT_5HZ 500
 #define RATE_MEASUREMENT_PERIOD 5000000
 #define GPS_WAIT_BEFORE_READ	20		// ms, wait before reading to save read() calls
+#define GPS_RTCM_BUFFER_SIZE	1024		// bytes, reassembled RTCM data waiting to be written to the device
+#define GPS_RTCM_FRAGMENT_SIZE	180		// bytes, payload of a full GPS_RTCM_DATA fragment
+#define GPS_RTCM_MAX_LATENCY	1000000		// us, corrections older than this when injected are counted as late
 
 
 /* struct for dynamic allocation of satellite info data */
@@ -148,6 +152,7 @@ private:
 
 	int				_serial_fd;					///< serial interface to GPS
 	unsigned			_baudrate;					///< current baudrate
+	unsigned			_uart_baudrate;					///< baudrate the serial port is set to (also during detection)
 	char				_port[20];					///< device / serial port path
 	bool				_healthy;					///< flag to signal if the GPS is ok
 	bool				_baudrate_changed;				///< flag to signal that the baudrate with the GPS has changed
@@ -171,6 +176,15 @@ private:
 
 	int _orb_inject_data_fd;
 
+	uint8_t _rtcm_buffer[GPS_RTCM_BUFFER_SIZE];			///< complete messages first, then the partial fragmented message
+	size_t _rtcm_buffer_len;					///< number of bytes of complete messages
+	size_t _rtcm_partial_len;					///< number of bytes of the partial message
+	int _rtcm_sequence;						///< sequence id of the partial message, -1 if none
+	uint8_t _rtcm_next_fragment;					///< expected fragment id of the partial message
+	uint32_t _rtcm_injected_bytes;
+	uint32_t _rtcm_dropped_bytes;					///< lost: buffer full, or missing/out of order fragments
+	uint32_t _rtcm_late_bytes;					///< injected more than GPS_RTCM_MAX_LATENCY after reception
+
 	orb_advert_t _dump_communication_pub;			///< if non-null, dump communication
 	gps_dump_s *_dump_to_device;
 	gps_dump_s *_dump_from_device;
@@ -223,11 +237,21 @@ private:
 	void handleInjectDataTopic();
 
 	/**
-	 * send data to the device, such as an RTCM stream
-	 * @param data
-	 * @param len
+	 * Add the data of an inject data topic message to the RTCM buffer. Fragmented
+	 * messages are reassembled and only added once complete, so that the device
+	 * never sees a partial message.
+	 */
+	void addInjectData(const gps_inject_data_s &msg);
+
+	/**
+	 * Drop the partial fragmented message, if any
+	 */
+	void dropPartialInjectData();
+
+	/**
+	 * send the complete messages in the RTCM buffer to the device at once
 	 */
-	inline bool injectData(uint8_t *data, size_t len);
+	void flushInjectData();
 
 	/**
 	 * set the Baudrate
@@ -264,6 +288,7 @@ extern "C" __EXPORT int gps_main(int argc, char *argv[]);
 GPS::GPS(const char *path, gps_driver_mode_t mode, GPSHelper::Interface interface, bool fake_gps,
 	 bool enable_sat_info, Instance instance) :
 	_serial_fd(-1),
+	_uart_baudrate(0),
 	_healthy(false),
 	_mode_changed(false),
 	_mode(mode),
@@ -281,6 +306,13 @@ GPS::GPS(const char *path, gps_driver_mode_t mode, GPSHelper::Interface interfac
 	_fake_gps(fake_gps),
 	_instance(instance),
 	_orb_inject_data_fd(-1),
+	_rtcm_buffer_len(0),
+	_rtcm_partial_len(0),
+	_rtcm_sequence(-1),
+	_rtcm_next_fragment(0),
+	_rtcm_injected_bytes(0),
+	_rtcm_dropped_bytes(0),
+	_rtcm_late_bytes(0),
 	_dump_communication_pub(nullptr),
 	_dump_to_device(nullptr),
 	_dump_from_device(nullptr)
@@ -400,22 +432,28 @@ int GPS::pollOrRead(uint8_t *buf, size_t buf_length, int timeout)
 			 * We are here because poll says there is some data, so this
 			 * won't block even on a blocking device. But don't read immediately
 			 * by 1-2 bytes, wait for some more data to save expensive read() calls.
-			 * If we have all requested data available, read it without waiting.
+			 * Wait for the time it takes to fill the buffer at the current baudrate,
+			 * and stop as soon as it is full or the line went idle (no new bytes
+			 * since the last check, i.e. the end of the burst of messages), but at most
+			 * GPS_WAIT_BEFORE_READ.
 			 * If more bytes are available, we'll go back to poll() again.
 			 */
-#ifdef __PX4_NUTTX
-			int err = 0;
-			int bytesAvailable = 0;
-			err = ioctl(_serial_fd, FIONREAD, (unsigned long)&bytesAvailable);
-
-			if ((err != 0) || (bytesAvailable < (int)buf_length)) {
-				usleep(GPS_WAIT_BEFORE_READ * 1000);
+			const int byte_time_us = _uart_baudrate > 0 ? 10 * 1000000 / _uart_baudrate : 1000; // 8N1: 10 bits per byte
+			int bytes_available = 0;
+			int last_bytes_available = -1;
+			int waited_us = 0;
+
+			while (waited_us < GPS_WAIT_BEFORE_READ * 1000 &&
+			       ioctl(_serial_fd, FIONREAD, (unsigned long)&bytes_available) == 0 &&
+			       bytes_available < (int)buf_length && bytes_available != last_bytes_available) {
+
+				const int wait_us = math::min(((int)buf_length - bytes_available) * byte_time_us,
+							      GPS_WAIT_BEFORE_READ * 1000 - waited_us);
+				usleep(wait_us);
+				waited_us += wait_us;
+				last_bytes_available = bytes_available;
 			}
 
-#else
-			usleep(GPS_WAIT_BEFORE_READ * 1000);
-#endif
-
 			ret = ::read(_serial_fd, buf, buf_length);
 
 		} else {
@@ -441,6 +479,7 @@ void GPS::handleInjectDataTopic()
 
 	bool updated = false;
 
+	/* collect everything that is queued, then write it with a single call */
 	do {
 		orb_check(_orb_inject_data_fd, &updated);
 
@@ -448,24 +487,89 @@ void GPS::handleInjectDataTopic()
 			struct gps_inject_data_s msg;
 			orb_copy(ORB_ID(gps_inject_data), _orb_inject_data_fd, &msg);
 
-			/* Write the message to the gps device. Note that the message could be fragmented.
-			 * But as we don't write anywhere else to the device during operation, we don't
-			 * need to assemble the message first.
-			 */
-			injectData(msg.data, msg.len);
+			if (msg.timestamp != 0 && hrt_elapsed_time(&msg.timestamp) > GPS_RTCM_MAX_LATENCY) {
+				_rtcm_late_bytes += msg.len;
+			}
+
+			addInjectData(msg);
 
 			++_last_rate_rtcm_injection_count;
 		}
 	} while (updated);
+
+	flushInjectData();
+}
+
+void GPS::addInjectData(const gps_inject_data_s &msg)
+{
+	const size_t len = math::min((size_t)msg.len, sizeof(msg.data));
+	const bool fragmented = msg.flags & 0x1;
+	const uint8_t fragment_id = (msg.flags >> 1) & 0x3;
+	const uint8_t sequence_id = (msg.flags >> 3) & 0x1f;
+
+	if (!fragmented || fragment_id == 0) {
+		/* start of a new message: the previous one did not complete */
+		dropPartialInjectData();
+
+		if (fragmented) {
+			_rtcm_sequence = sequence_id;
+		}
+
+	} else if (sequence_id != _rtcm_sequence || fragment_id != _rtcm_next_fragment) {
+		/* missing or out of order fragment: the message cannot be completed */
+		dropPartialInjectData();
+		_rtcm_dropped_bytes += len;
+		return;
+	}
+
+	if (_rtcm_buffer_len + _rtcm_partial_len + len > sizeof(_rtcm_buffer)) {
+		/* the device does not keep up: drop the message */
+		dropPartialInjectData();
+		_rtcm_dropped_bytes += len;
+		return;
+	}
+
+	memcpy(_rtcm_buffer + _rtcm_buffer_len + _rtcm_partial_len, msg.data, len);
+	_rtcm_partial_len += len;
+	_rtcm_next_fragment = fragment_id + 1;
+
+	/* a message ends with a fragment that is not full, or with the last possible fragment */
+	if (!fragmented || len < GPS_RTCM_FRAGMENT_SIZE || fragment_id == 3) {
+		_rtcm_buffer_len += _rtcm_partial_len;
+		_rtcm_partial_len = 0;
+		_rtcm_sequence = -1;
+	}
 }
 
-bool GPS::injectData(uint8_t *data, size_t len)
+void GPS::dropPartialInjectData()
 {
-	dumpGpsData(data, len, true);
+	_rtcm_dropped_bytes += _rtcm_partial_len;
+	_rtcm_partial_len = 0;
+	_rtcm_sequence = -1;
+}
+
+void GPS::flushInjectData()
+{
+	if (_rtcm_buffer_len == 0) {
+		return;
+	}
+
+	ssize_t written = ::write(_serial_fd, _rtcm_buffer, _rtcm_buffer_len);
+
+	if (written <= 0) {
+		/* keep the data for the next call */
+		return;
+	}
 
-	size_t written = ::write(_serial_fd, data, len);
 	::fsync(_serial_fd);
-	return written == len;
+
+	dumpGpsData(_rtcm_buffer, written, true);
+
+	_rtcm_injected_bytes += written;
+
+	/* keep what was not written and the partial message */
+	memmove(_rtcm_buffer, _rtcm_buffer + written, _rtcm_buffer_len - written + _rtcm_partial_len);
+	_rtcm_buffer_len -= written;
 }
 
 int GPS::setBaudrate(unsigned baud)
@@ -549,6 +653,8 @@ int GPS::setBaudrate(unsigned baud)
 		return -1;
 	}
 
+	_uart_baudrate = baud;
+
 	return 0;
 }
 
@@ -873,6 +979,11 @@ GPS::print_status()
 	}
 
 	PX4_INFO("port: %s, baudrate: %d, status: %s", _port, _baudrate, _healthy ? "OK" : "NOT OK");
+	if (_orb_inject_data_fd != -1) {
+		PX4_INFO("RTCM injected: %u B, dropped: %u B, late: %u B", _rtcm_injected_bytes, _rtcm_dropped_bytes,
+			 _rtcm_late_bytes);
+	}
+
 	PX4_INFO("sat info: %s, noise: %d, jamming detected: %s",
 		 (_p_report_sat_info != nullptr) ? "enabled" : "disabled",
 		 _report_gps_pos.noise_per_ms,
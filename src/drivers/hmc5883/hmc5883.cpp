@@ -63,6 +63,7 @@
 
 #include <systemlib/perf_counter.h>
 #include <systemlib/err.h>
+#include <systemlib/work_queue_stats.h>
 
 #include <drivers/drv_mag.h>
 #include <drivers/drv_hrt.h>
@@ -770,6 +771,8 @@ HMC5883::start()
 	_collect_phase = false;
 	_reports->flush();
 
+	work_queue_stats_register((worker_t)&HMC5883::cycle_trampoline, "hmc5883");
+
 	/* schedule a cycle to start things */
 	work_queue(HPWORK, &_work, (worker_t)&HMC5883::cycle_trampoline, this, 1);
 }
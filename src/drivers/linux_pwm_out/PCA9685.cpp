@@ -46,6 +46,7 @@
 #include <inttypes.h>
 #include <errno.h>
 #include <math.h>
+#include <string.h>
 #include <stdio.h>
 #include <unistd.h>
 
@@ -74,11 +75,21 @@ int PCA9685::send_output_pwm(const uint16_t *pwm, int num_outputs)
 		num_outputs = 16;
 	}
 
+	if (_fd == -1 || num_outputs <= 0) {
+		return 0;
+	}
+
+	// write the ON and OFF registers of all channels in one auto-increment transfer
+	uint8_t data[16 * LED_MULTIPLYER];
+
 	for (int i = 0; i < num_outputs; ++i) {
-		setPWM(i, pwm[i]);
+		data[i * LED_MULTIPLYER + 0] = 0;
+		data[i * LED_MULTIPLYER + 1] = 0;
+		data[i * LED_MULTIPLYER + 2] = pwm[i] & 0xFF;
+		data[i * LED_MULTIPLYER + 3] = pwm[i] >> 8;
 	}
 
-	return 0;
+	return write_bytes(_fd, LED0_ON_L, data, num_outputs * LED_MULTIPLYER);
 }
 
 PCA9685::PCA9685()
@@ -103,7 +114,7 @@ PCA9685::~PCA9685()
 void PCA9685::reset()
 {
 	if (_fd != -1) {
-		write_byte(_fd, MODE1, 0x00); //Normal mode
+		write_byte(_fd, MODE1, MODE1_AI); //Normal mode, register auto-increment
 		write_byte(_fd, MODE2, 0x04); //Normal mode
 	}
 }
@@ -173,6 +184,25 @@ void PCA9685::write_byte(int fd, uint8_t address, uint8_t data)
 	}
 }
 
+int PCA9685::write_bytes(int fd, uint8_t address, const uint8_t *data, int len)
+{
+	uint8_t buf[1 + 16 * LED_MULTIPLYER];
+
+	if (len > (int)sizeof(buf) - 1) {
+		return -1;
+	}
+
+	buf[0] = address;
+	memcpy(&buf[1], data, len);
+
+	if (write(fd, buf, 1 + len) != 1 + len) {
+		PX4_ERR("Write failed (%i)", errno);
+		return -1;
+	}
+
+	return 0;
+}
+
 int PCA9685::open_fd(int bus, int address)
 {
 	int fd;
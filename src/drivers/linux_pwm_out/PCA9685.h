@@ -52,6 +52,7 @@ namespace linux_pwm_out
 #define SUBADR2 0x03		//I2C-bus subaddress 2
 #define SUBADR3 0x04		//I2C-bus subaddress 3
 #define ALLCALLADR 0x05     //LED All Call I2C-bus address
+#define MODE1_AI 0x20		//MODE1: register auto-increment
 #define LED0 0x6			//LED0 start register
 #define LED0_ON_L 0x6		//LED0 output and brightness control byte 0
 #define LED0_ON_H 0x7		//LED0 output and brightness control byte 1
@@ -90,7 +91,7 @@ public:
 	int init(int bus, int address);
 	virtual ~PCA9685();
 
-	/** Sets PCA9685 mode to 00 */
+	/** Sets PCA9685 to normal mode, with register auto-increment */
 	void reset();
 
 	/**
@@ -133,6 +134,16 @@ private:
 	 */
 	void write_byte(int fd, uint8_t address, uint8_t data);
 
+	/**
+	 * Write consecutive registers in one I2C transfer (requires auto-increment, see reset())
+	 * @param fd file descriptor for I/O
+	 * @param address address of the first register to write to
+	 * @param data data to write
+	 * @param len number of bytes to write (at most 64)
+	 * @return 0 on success, -1 on error
+	 */
+	int write_bytes(int fd, uint8_t address, const uint8_t *data, int len);
+
 	/**
 	 * Open device file for PCA9685 I2C bus
 	 * @return fd returns the file descriptor number or -1 on error
@@ -49,6 +49,7 @@ NavioSysfsPWMOut::NavioSysfsPWMOut(const char *device, int max_num_outputs)
 
 	for (int i = 0; i < MAX_NUM_PWM; ++i) {
 		_pwm_fd[i] = -1;
+		_pwm_last[i] = 0;
 	}
 
 	_pwm_num = max_num_outputs;
@@ -117,11 +118,19 @@ int NavioSysfsPWMOut::send_output_pwm(const uint16_t *pwm, int num_outputs)
 
 	//convert this to duty_cycle in ns
 	for (int i = 0; i < num_outputs; ++i) {
+		// each channel is a sysfs file of its own, skip the write system call if the value did not change
+		if (pwm[i] == _pwm_last[i]) {
+			continue;
+		}
+
 		int n = ::snprintf(data, sizeof(data), "%u", pwm[i] * 1000);
 		int write_ret = ::write(_pwm_fd[i], data, n);
 
 		if (n != write_ret) {
 			ret = -1;
+
+		} else {
+			_pwm_last[i] = pwm[i];
 		}
 	}
 
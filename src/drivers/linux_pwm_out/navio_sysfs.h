@@ -59,6 +59,7 @@ private:
 	static const int FREQUENCY_PWM = 400;
 
 	int _pwm_fd[MAX_NUM_PWM];
+	uint16_t _pwm_last[MAX_NUM_PWM];	///< last written value of each channel, only changes are written
 	int _pwm_num;
 
 	const char *_device;
@@ -87,10 +87,11 @@
 #include <drivers/device/spi.h>
 #include <drivers/device/i2c.h>
 #include <drivers/device/ringbuffer.h>
-#include <drivers/device/integrator.h>
+#include <drivers/device/imu_integrator.h>
+#include <drivers/device/imu_fifo_publisher.h>
 #include <drivers/drv_accel.h>
 #include <drivers/drv_gyro.h>
-#include <mathlib/math/filter/LowPassFilter2p.hpp>
+#include <mathlib/math/filter/LowPassFilter2pVector3f.hpp>
 #include <lib/conversion/rotation.h>
 
 #include "mpu6000.h"
@@ -156,6 +157,13 @@ public:
 	// deliberately cause a sensor error
 	void 			test_error();
 
+	/**
+	 * Read the samples from the FIFO in bursts instead of one register snapshot per
+	 * measurement. The gyro is then sampled at MPU6000_FIFO_SAMPLE_RATE, and all samples
+	 * go through the filters and integrators. MPU6000 on SPI only, must be called before init().
+	 */
+	void			enable_fifo() { _fifo_enabled = true; }
+
 protected:
 	Device			*_interface;
 
@@ -183,7 +191,7 @@ private:
 	struct hrt_call		_call;
 	unsigned		_call_interval;
 
-	ringbuffer::RingBuffer	*_accel_reports;
+	ringbuffer::RingBufferT<accel_report, 16>	_accel_reports;
 
 	struct accel_calibration_s	_accel_scale;
 	float			_accel_range_scale;
@@ -192,13 +200,19 @@ private:
 	int			_accel_orb_class_instance;
 	int			_accel_class_instance;
 
-	ringbuffer::RingBuffer	*_gyro_reports;
+	ringbuffer::RingBufferT<gyro_report, 16>	_gyro_reports;
 
 	struct gyro_calibration_s	_gyro_scale;
 	float			_gyro_range_scale;
 	float			_gyro_range_rad_s;
 
 	unsigned		_sample_rate;
+
+	bool			_fifo_enabled;
+	struct MPUFIFOReport	*_fifo_report;
+	ImuFifoPublisher	*_fifo_pub;	///< all FIFO samples, as sensor_accel_fifo/sensor_gyro_fifo
+	perf_counter_t		_fifo_overflows;
+
 	perf_counter_t		_accel_reads;
 	perf_counter_t		_gyro_reads;
 	perf_counter_t		_sample_perf;
@@ -212,23 +226,19 @@ private:
 	uint8_t			_register_wait;
 	uint64_t		_reset_wait;
 
-	math::LowPassFilter2p	_accel_filter_x;
-	math::LowPassFilter2p	_accel_filter_y;
-	math::LowPassFilter2p	_accel_filter_z;
-	math::LowPassFilter2p	_gyro_filter_x;
-	math::LowPassFilter2p	_gyro_filter_y;
-	math::LowPassFilter2p	_gyro_filter_z;
+	math::LowPassFilter2pVector3f	_accel_filter;
+	math::LowPassFilter2pVector3f	_gyro_filter;
 
-	Integrator		_accel_int;
-	Integrator		_gyro_int;
+	ImuIntegrator		_imu_int;
 
 	enum Rotation		_rotation;
+	rot_table_t		_rotation_table;	///< _rotation, applied to each sample
 
 	// this is used to support runtime checking of key
 	// configuration registers to detect SPI bus errors and sensor
 	// reset
 #define MPU6000_CHECKED_PRODUCT_ID_INDEX 0
-#define MPU6000_NUM_CHECKED_REGISTERS 10
+#define MPU6000_NUM_CHECKED_REGISTERS 11
 	static const uint8_t	_checked_registers[MPU6000_NUM_CHECKED_REGISTERS];
 	uint8_t			_checked_values[MPU6000_NUM_CHECKED_REGISTERS];
 	uint8_t			_checked_next;
@@ -319,6 +329,46 @@ private:
 	 */
 	int			measure();
 
+	/**
+	 * Read all complete samples from the FIFO in one transfer and process them.
+	 */
+	int			measure_fifo();
+
+	/**
+	 * Clear the FIFO, after an overflow or a bad transfer.
+	 */
+	void			reset_fifo();
+
+	/**
+	 * Sample in native byte order, as read from the data registers or the FIFO
+	 */
+	struct Report {
+		int16_t		accel_x;
+		int16_t		accel_y;
+		int16_t		accel_z;
+		int16_t		temp;
+		int16_t		gyro_x;
+		int16_t		gyro_y;
+		int16_t		gyro_z;
+	};
+
+	/**
+	 * Scale, filter and integrate one sample, and publish the reports
+	 * if the integrators have an output.
+	 *
+	 * @param report		The sample, in the sensor frame.
+	 * @param timestamp_sample	Time the sample was taken.
+	 */
+	void			process_sample(struct Report &report, hrt_abstime timestamp_sample);
+
+	/**
+	 * @return rate of the samples going through the driver filters [Hz]
+	 */
+	float			filter_sample_rate(unsigned call_interval) const
+	{
+		return _fifo_enabled ? MPU6000_FIFO_SAMPLE_RATE : 1.0e6f / call_interval;
+	}
+
 	/**
 	 * Read a register from the MPU6000
 	 *
@@ -436,6 +486,7 @@ const uint8_t MPU6000::_checked_registers[MPU6000_NUM_CHECKED_REGISTERS] = { MPU
 									     MPUREG_ACCEL_CONFIG,
 									     MPUREG_INT_ENABLE,
 									     MPUREG_INT_PIN_CFG,
+									     MPUREG_FIFO_EN,
 									     MPUREG_ICM_UNDOC1
 									   };
 
@@ -489,18 +540,22 @@ MPU6000::MPU6000(device::Device *interface, const char *path_accel, const char *
 #endif
 	_call {},
 	_call_interval(0),
-	_accel_reports(nullptr),
+	_accel_reports(2),
 	_accel_scale{},
 	_accel_range_scale(0.0f),
 	_accel_range_m_s2(0.0f),
 	_accel_topic(nullptr),
 	_accel_orb_class_instance(-1),
 	_accel_class_instance(-1),
-	_gyro_reports(nullptr),
+	_gyro_reports(2),
 	_gyro_scale{},
 	_gyro_range_scale(0.0f),
 	_gyro_range_rad_s(0.0f),
 	_sample_rate(1000),
+	_fifo_enabled(false),
+	_fifo_report(nullptr),
+	_fifo_pub(nullptr),
+	_fifo_overflows(perf_alloc(PC_COUNT, "mpu6k_fifo_oflow")),
 	_accel_reads(perf_alloc(PC_COUNT, "mpu6k_acc_read")),
 	_gyro_reads(perf_alloc(PC_COUNT, "mpu6k_gyro_read")),
 	_sample_perf(perf_alloc(PC_ELAPSED, "mpu6k_read")),
@@ -512,15 +567,11 @@ MPU6000::MPU6000(device::Device *interface, const char *path_accel, const char *
 	_controller_latency_perf(perf_alloc_once(PC_ELAPSED, "ctrl_latency")),
 	_register_wait(0),
 	_reset_wait(0),
-	_accel_filter_x(MPU6000_ACCEL_DEFAULT_RATE, MPU6000_ACCEL_DEFAULT_DRIVER_FILTER_FREQ),
-	_accel_filter_y(MPU6000_ACCEL_DEFAULT_RATE, MPU6000_ACCEL_DEFAULT_DRIVER_FILTER_FREQ),
-	_accel_filter_z(MPU6000_ACCEL_DEFAULT_RATE, MPU6000_ACCEL_DEFAULT_DRIVER_FILTER_FREQ),
-	_gyro_filter_x(MPU6000_GYRO_DEFAULT_RATE, MPU6000_GYRO_DEFAULT_DRIVER_FILTER_FREQ),
-	_gyro_filter_y(MPU6000_GYRO_DEFAULT_RATE, MPU6000_GYRO_DEFAULT_DRIVER_FILTER_FREQ),
-	_gyro_filter_z(MPU6000_GYRO_DEFAULT_RATE, MPU6000_GYRO_DEFAULT_DRIVER_FILTER_FREQ),
-	_accel_int(1000000 / MPU6000_ACCEL_MAX_OUTPUT_RATE),
-	_gyro_int(1000000 / MPU6000_GYRO_MAX_OUTPUT_RATE, true),
+	_accel_filter(MPU6000_ACCEL_DEFAULT_RATE, MPU6000_ACCEL_DEFAULT_DRIVER_FILTER_FREQ),
+	_gyro_filter(MPU6000_GYRO_DEFAULT_RATE, MPU6000_GYRO_DEFAULT_DRIVER_FILTER_FREQ),
+	_imu_int(1000000 / MPU6000_ACCEL_MAX_OUTPUT_RATE),
 	_rotation(rotation),
+	_rotation_table{},
 	_checked_next(0),
 	_in_factory_test(false),
 	_last_temperature(0),
@@ -530,6 +581,8 @@ MPU6000::MPU6000(device::Device *interface, const char *path_accel, const char *
 	// disable debug() calls
 	_debug_enabled = false;
 
+	get_rot_table(_rotation, &_rotation_table);
+
 	// set the device type from the interface
 	_device_id.devid_s.bus_type = _interface->get_device_bus_type();
 	_device_id.devid_s.bus = _interface->get_device_bus();
@@ -597,13 +650,12 @@ MPU6000::~MPU6000()
 	/* delete the gyro subdriver */
 	delete _gyro;
 
-	/* free any existing reports */
-	if (_accel_reports != nullptr) {
-		delete _accel_reports;
+	if (_fifo_report != nullptr) {
+		delete _fifo_report;
 	}
 
-	if (_gyro_reports != nullptr) {
-		delete _gyro_reports;
+	if (_fifo_pub != nullptr) {
+		delete _fifo_pub;
 	}
 
 	if (_accel_class_instance != -1) {
@@ -619,6 +671,7 @@ MPU6000::~MPU6000()
 	perf_free(_good_transfers);
 	perf_free(_reset_retries);
 	perf_free(_duplicates);
+	perf_free(_fifo_overflows);
 }
 
 int
@@ -654,17 +707,21 @@ MPU6000::init()
 	}
 
 	ret = -ENOMEM;
-	/* allocate basic report buffers */
-	_accel_reports = new ringbuffer::RingBuffer(2, sizeof(accel_report));
 
-	if (_accel_reports == nullptr) {
-		return ret;
+	if (_fifo_enabled && (is_i2c() || !is_mpu_device())) {
+		PX4_WARN("FIFO mode only supported for the MPU6000 on SPI");
+		_fifo_enabled = false;
 	}
 
-	_gyro_reports = new ringbuffer::RingBuffer(2, sizeof(gyro_report));
+	if (_fifo_enabled) {
+		_fifo_report = new MPUFIFOReport;
+		_fifo_pub = new ImuFifoPublisher((is_external()) ? ORB_PRIO_MAX : ORB_PRIO_HIGH);
 
-	if (_gyro_reports == nullptr) {
-		return ret;
+		if (_fifo_report == nullptr || _fifo_pub == nullptr) {
+			return ret;
+		}
+
+		_fifo_pub->set_sample_interval(1e6f / MPU6000_FIFO_SAMPLE_RATE);
 	}
 
 	ret = -EIO;
@@ -695,9 +752,7 @@ MPU6000::init()
 	if (accel_cut_ph != PARAM_INVALID && param_get(accel_cut_ph, &accel_cut) == PX4_OK) {
 		PX4_INFO("accel cutoff set to %.2f Hz", double(accel_cut));
 
-		_accel_filter_x.set_cutoff_frequency(MPU6000_ACCEL_DEFAULT_RATE, accel_cut);
-		_accel_filter_y.set_cutoff_frequency(MPU6000_ACCEL_DEFAULT_RATE, accel_cut);
-		_accel_filter_z.set_cutoff_frequency(MPU6000_ACCEL_DEFAULT_RATE, accel_cut);
+		_accel_filter.set_cutoff_frequency(MPU6000_ACCEL_DEFAULT_RATE, accel_cut);
 
 	} else {
 		PX4_ERR("IMU_ACCEL_CUTOFF param invalid");
@@ -709,9 +764,7 @@ MPU6000::init()
 	if (gyro_cut_ph != PARAM_INVALID && param_get(gyro_cut_ph, &gyro_cut) == PX4_OK) {
 		PX4_INFO("gyro cutoff set to %.2f Hz", double(gyro_cut));
 
-		_gyro_filter_x.set_cutoff_frequency(MPU6000_GYRO_DEFAULT_RATE, gyro_cut);
-		_gyro_filter_y.set_cutoff_frequency(MPU6000_GYRO_DEFAULT_RATE, gyro_cut);
-		_gyro_filter_z.set_cutoff_frequency(MPU6000_GYRO_DEFAULT_RATE, gyro_cut);
+		_gyro_filter.set_cutoff_frequency(MPU6000_GYRO_DEFAULT_RATE, gyro_cut);
 
 	} else {
 		PX4_ERR("IMU_GYRO_CUTOFF param invalid");
@@ -732,7 +785,7 @@ MPU6000::init()
 
 	/* advertise sensor topic, measure manually to initialize valid report */
 	struct accel_report arp;
-	_accel_reports->get(&arp);
+	_accel_reports.get(arp);
 
 	/* measurement will have generated a report, publish */
 	_accel_topic = orb_advertise_multi(ORB_ID(sensor_accel), &arp,
@@ -744,7 +797,7 @@ MPU6000::init()
 
 	/* advertise sensor topic, measure manually to initialize valid report */
 	struct gyro_report grp;
-	_gyro_reports->get(&grp);
+	_gyro_reports.get(grp);
 
 	_gyro->_gyro_topic = orb_advertise_multi(ORB_ID(sensor_gyro), &grp,
 			     &_gyro->_gyro_orb_class_instance, (is_external()) ? ORB_PRIO_MAX : ORB_PRIO_HIGH);
@@ -783,7 +836,7 @@ int MPU6000::reset()
 		up_udelay(1000);
 
 		// Enable I2C bus or Disable I2C bus (recommended on data sheet)
-		write_checked_reg(MPUREG_USER_CTRL, is_i2c() ? 0 : BIT_I2C_IF_DIS);
+		write_checked_reg(MPUREG_USER_CTRL, (is_i2c() ? 0 : BIT_I2C_IF_DIS) | (_fifo_enabled ? BIT_USER_CTRL_FIFO_EN : 0));
 
 		px4_leave_critical_section(state);
 
@@ -847,6 +900,14 @@ int MPU6000::reset()
 		write_checked_reg(MPUREG_ICM_UNDOC1, MPUREG_ICM_UNDOC1_VALUE);
 	}
 
+	// FIFO: accel, temperature and gyro, in the same order as the data registers
+	write_checked_reg(MPUREG_FIFO_EN, _fifo_enabled ? (BITS_FIFO_ENABLE_ACCEL | BITS_FIFO_ENABLE_TEMP_OUT |
+			  BITS_FIFO_ENABLE_GYRO_XOUT | BITS_FIFO_ENABLE_GYRO_YOUT | BITS_FIFO_ENABLE_GYRO_ZOUT) : 0);
+
+	if (_fifo_enabled) {
+		reset_fifo();
+	}
+
 	// Oscillator set
 	// write_reg(MPUREG_PWR_MGMT_1,MPU_CLK_SEL_PLLGYROZ);
 	usleep(1000);
@@ -940,6 +1001,13 @@ MPU6000::_set_sample_rate(unsigned desired_sample_rate_hz)
 		desired_sample_rate_hz = MPU6000_GYRO_DEFAULT_RATE;
 	}
 
+	if (_fifo_enabled) {
+		// FIFO mode uses the full 8 kHz gyro output rate
+		write_checked_reg(MPUREG_SMPLRT_DIV, 0);
+		_sample_rate = MPU6000_FIFO_SAMPLE_RATE;
+		return;
+	}
+
 	uint8_t div = 1000 / desired_sample_rate_hz;
 
 	if (div > 200) { div = 200; }
@@ -958,6 +1026,11 @@ MPU6000::_set_dlpf_filter(uint16_t frequency_hz)
 {
 	uint8_t filter;
 
+	if (_fifo_enabled) {
+		// the 8 kHz gyro rate of the FIFO mode is only available with the 256 Hz filter
+		frequency_hz = 256;
+	}
+
 	/*
 	   choose next highest filter frequency available
 	 */
@@ -1043,29 +1116,19 @@ MPU6000::read(struct file *filp, char *buffer, size_t buflen)
 
 	/* if automatic measurement is not enabled, get a fresh measurement into the buffer */
 	if (_call_interval == 0) {
-		_accel_reports->flush();
+		_accel_reports.flush();
 		measure();
 	}
 
 	/* if no data, error (we could block here) */
-	if (_accel_reports->empty()) {
+	if (_accel_reports.empty()) {
 		return -EAGAIN;
 	}
 
 	perf_count(_accel_reads);
 
 	/* copy reports out of our buffer to the caller */
-	accel_report *arp = reinterpret_cast<accel_report *>(buffer);
-	int transferred = 0;
-
-	while (count--) {
-		if (!_accel_reports->get(arp)) {
-			break;
-		}
-
-		transferred++;
-		arp++;
-	}
+	unsigned transferred = _accel_reports.get_n(reinterpret_cast<accel_report *>(buffer), count);
 
 	/* return the number of bytes transferred */
 	return (transferred * sizeof(accel_report));
@@ -1328,29 +1391,19 @@ MPU6000::gyro_read(struct file *filp, char *buffer, size_t buflen)
 
 	/* if automatic measurement is not enabled, get a fresh measurement into the buffer */
 	if (_call_interval == 0) {
-		_gyro_reports->flush();
+		_gyro_reports.flush();
 		measure();
 	}
 
 	/* if no data, error (we could block here) */
-	if (_gyro_reports->empty()) {
+	if (_gyro_reports.empty()) {
 		return -EAGAIN;
 	}
 
 	perf_count(_gyro_reads);
 
 	/* copy reports out of our buffer to the caller */
-	gyro_report *grp = reinterpret_cast<gyro_report *>(buffer);
-	int transferred = 0;
-
-	while (count--) {
-		if (!_gyro_reports->get(grp)) {
-			break;
-		}
-
-		transferred++;
-		grp++;
-	}
+	unsigned transferred = _gyro_reports.get_n(reinterpret_cast<gyro_report *>(buffer), count);
 
 	/* return the number of bytes transferred */
 	return (transferred * sizeof(gyro_report));
@@ -1402,25 +1455,26 @@ MPU6000::ioctl(struct file *filp, int cmd, unsigned long arg)
 						return -EINVAL;
 					}
 
+					/* read the FIFO often enough so that it does not overflow */
+					if (_fifo_enabled && ticks > MPU6000_FIFO_MAX_INTERVAL) {
+						ticks = MPU6000_FIFO_MAX_INTERVAL;
+					}
+
 					// adjust filters
-					float cutoff_freq_hz = _accel_filter_x.get_cutoff_freq();
-					float sample_rate = 1.0e6f / ticks;
+					float cutoff_freq_hz = _accel_filter.get_cutoff_freq();
+					float sample_rate = filter_sample_rate(ticks);
 					_set_dlpf_filter(cutoff_freq_hz);
 
 					if (is_icm_device()) {
 						_set_icm_acc_dlpf_filter(cutoff_freq_hz);
 					}
 
-					_accel_filter_x.set_cutoff_frequency(sample_rate, cutoff_freq_hz);
-					_accel_filter_y.set_cutoff_frequency(sample_rate, cutoff_freq_hz);
-					_accel_filter_z.set_cutoff_frequency(sample_rate, cutoff_freq_hz);
+					_accel_filter.set_cutoff_frequency(sample_rate, cutoff_freq_hz);
 
 
-					float cutoff_freq_hz_gyro = _gyro_filter_x.get_cutoff_freq();
+					float cutoff_freq_hz_gyro = _gyro_filter.get_cutoff_freq();
 					_set_dlpf_filter(cutoff_freq_hz_gyro);
-					_gyro_filter_x.set_cutoff_frequency(sample_rate, cutoff_freq_hz_gyro);
-					_gyro_filter_y.set_cutoff_frequency(sample_rate, cutoff_freq_hz_gyro);
-					_gyro_filter_z.set_cutoff_frequency(sample_rate, cutoff_freq_hz_gyro);
+					_gyro_filter.set_cutoff_frequency(sample_rate, cutoff_freq_hz_gyro);
 
 					/* update interval for next measurement */
 					/* XXX this is a bit shady, but no other way to adjust... */
@@ -1455,25 +1509,16 @@ MPU6000::ioctl(struct file *filp, int cmd, unsigned long arg)
 		return 1000000 / _call_interval;
 
 	case SENSORIOCSQUEUEDEPTH: {
-			/* lower bound is mandatory, upper bound is a sanity check */
-			if ((arg < 1) || (arg > 100)) {
+			/* lower bound is mandatory, upper bound is the static queue capacity */
+			if (!_accel_reports.set_depth(arg)) {
 				return -EINVAL;
 			}
 
-			irqstate_t flags = px4_enter_critical_section();
-
-			if (!_accel_reports->resize(arg)) {
-				px4_leave_critical_section(flags);
-				return -ENOMEM;
-			}
-
-			px4_leave_critical_section(flags);
-
 			return OK;
 		}
 
 	case SENSORIOCGQUEUEDEPTH:
-		return _accel_reports->size();
+		return _accel_reports.size();
 
 	case ACCELIOCGSAMPLERATE:
 		return _sample_rate;
@@ -1483,7 +1528,7 @@ MPU6000::ioctl(struct file *filp, int cmd, unsigned long arg)
 		return OK;
 
 	case ACCELIOCGLOWPASS:
-		return _accel_filter_x.get_cutoff_freq();
+		return _accel_filter.get_cutoff_freq();
 
 	case ACCELIOCSLOWPASS:
 		// set hardware filtering
@@ -1494,9 +1539,7 @@ MPU6000::ioctl(struct file *filp, int cmd, unsigned long arg)
 		}
 
 		// set software filtering
-		_accel_filter_x.set_cutoff_frequency(1.0e6f / _call_interval, arg);
-		_accel_filter_y.set_cutoff_frequency(1.0e6f / _call_interval, arg);
-		_accel_filter_z.set_cutoff_frequency(1.0e6f / _call_interval, arg);
+		_accel_filter.set_cutoff_frequency(filter_sample_rate(_call_interval), arg);
 		return OK;
 
 	case ACCELIOCSSCALE: {
@@ -1550,25 +1593,16 @@ MPU6000::gyro_ioctl(struct file *filp, int cmd, unsigned long arg)
 		return ioctl(filp, cmd, arg);
 
 	case SENSORIOCSQUEUEDEPTH: {
-			/* lower bound is mandatory, upper bound is a sanity check */
-			if ((arg < 1) || (arg > 100)) {
+			/* lower bound is mandatory, upper bound is the static queue capacity */
+			if (!_gyro_reports.set_depth(arg)) {
 				return -EINVAL;
 			}
 
-			irqstate_t flags = px4_enter_critical_section();
-
-			if (!_gyro_reports->resize(arg)) {
-				px4_leave_critical_section(flags);
-				return -ENOMEM;
-			}
-
-			px4_leave_critical_section(flags);
-
 			return OK;
 		}
 
 	case SENSORIOCGQUEUEDEPTH:
-		return _gyro_reports->size();
+		return _gyro_reports.size();
 
 	case GYROIOCGSAMPLERATE:
 		return _sample_rate;
@@ -1578,14 +1612,12 @@ MPU6000::gyro_ioctl(struct file *filp, int cmd, unsigned long arg)
 		return OK;
 
 	case GYROIOCGLOWPASS:
-		return _gyro_filter_x.get_cutoff_freq();
+		return _gyro_filter.get_cutoff_freq();
 
 	case GYROIOCSLOWPASS:
 		// set hardware filtering
 		_set_dlpf_filter(arg);
-		_gyro_filter_x.set_cutoff_frequency(1.0e6f / _call_interval, arg);
-		_gyro_filter_y.set_cutoff_frequency(1.0e6f / _call_interval, arg);
-		_gyro_filter_z.set_cutoff_frequency(1.0e6f / _call_interval, arg);
+		_gyro_filter.set_cutoff_frequency(filter_sample_rate(_call_interval), arg);
 		return OK;
 
 	case GYROIOCSSCALE:
@@ -1728,8 +1760,8 @@ MPU6000::start()
 	_call_interval = last_call_interval;
 
 	/* discard any stale data in the buffers */
-	_accel_reports->flush();
-	_gyro_reports->flush();
+	_accel_reports.flush();
+	_gyro_reports.flush();
 
 	if (!is_i2c()) {
 		/* start polling at the specified rate */
@@ -1764,13 +1796,8 @@ MPU6000::stop()
 	memset(_last_accel, 0, sizeof(_last_accel));
 
 	/* discard unread data in the buffers */
-	if (_accel_reports != nullptr) {
-		_accel_reports->flush();
-	}
-
-	if (_gyro_reports != nullptr) {
-		_gyro_reports->flush();
-	}
+	_accel_reports.flush();
+	_gyro_reports.flush();
 }
 
 #if defined(USE_I2C)
@@ -1887,17 +1914,13 @@ MPU6000::measure()
 		return OK;
 	}
 
+	if (_fifo_enabled) {
+		return measure_fifo();
+	}
+
 	struct MPUReport mpu_report;
 
-	struct Report {
-		int16_t		accel_x;
-		int16_t		accel_y;
-		int16_t		accel_z;
-		int16_t		temp;
-		int16_t		gyro_x;
-		int16_t		gyro_y;
-		int16_t		gyro_z;
-	} report;
+	struct Report report;
 
 	/* start measuring */
 	perf_begin(_sample_perf);
@@ -1977,6 +2000,123 @@ MPU6000::measure()
 	}
 
 
+	process_sample(report, hrt_absolute_time());
+
+	/* stop measuring */
+	perf_end(_sample_perf);
+	return OK;
+}
+
+int
+MPU6000::measure_fifo()
+{
+	perf_begin(_sample_perf);
+
+	uint8_t fifo_count[2];
+
+	if (sizeof(fifo_count) != _interface->read(MPU6000_SET_SPEED(MPUREG_FIFO_COUNTH, MPU6000_HIGH_BUS_SPEED),
+			&fifo_count[0], sizeof(fifo_count))) {
+		perf_end(_sample_perf);
+		return -EIO;
+	}
+
+	/* the newest sample in the FIFO was taken at most one sample interval before now */
+	const hrt_abstime now = hrt_absolute_time();
+
+	check_registers();
+
+	const unsigned fifo_bytes = (fifo_count[0] << 8) | fifo_count[1];
+
+	if (fifo_bytes > sizeof(_fifo_report->samples)) {
+		/*
+		  the FIFO is (about to be) full: the oldest samples get
+		  overwritten, and the data is not aligned to the sample
+		  boundaries anymore
+		 */
+		perf_count(_fifo_overflows);
+		reset_fifo();
+		perf_end(_sample_perf);
+		return OK;
+	}
+
+	const unsigned samples = fifo_bytes / sizeof(MPUFIFOSample);
+
+	if (samples < 2) {
+		// leave them for the next burst, see MPUFIFOReport
+		perf_end(_sample_perf);
+		return OK;
+	}
+
+	const unsigned transfer_size = 1 + samples * sizeof(MPUFIFOSample);
+
+	if ((int)transfer_size != _interface->read(MPU6000_SET_SPEED(MPUREG_FIFO_R_W, MPU6000_HIGH_BUS_SPEED),
+			(uint8_t *)_fifo_report, transfer_size)) {
+		perf_end(_sample_perf);
+		return -EIO;
+	}
+
+	if (_register_wait != 0) {
+		// we are waiting for some good transfers before using
+		// the sensor again
+		_register_wait--;
+		perf_end(_sample_perf);
+		return OK;
+	}
+
+	for (unsigned i = 0; i < samples; i++) {
+		struct MPUFIFOSample &sample = _fifo_report->samples[i];
+		struct Report report;
+
+		report.accel_x = int16_t_from_bytes(sample.accel_x);
+		report.accel_y = int16_t_from_bytes(sample.accel_y);
+		report.accel_z = int16_t_from_bytes(sample.accel_z);
+		report.temp = int16_t_from_bytes(sample.temp);
+		report.gyro_x = int16_t_from_bytes(sample.gyro_x);
+		report.gyro_y = int16_t_from_bytes(sample.gyro_y);
+		report.gyro_z = int16_t_from_bytes(sample.gyro_z);
+
+		if (report.accel_x == 0 &&
+		    report.accel_y == 0 &&
+		    report.accel_z == 0 &&
+		    report.temp == 0 &&
+		    report.gyro_x == 0 &&
+		    report.gyro_y == 0 &&
+		    report.gyro_z == 0) {
+			// all zero data - probably a SPI bus error, the rest
+			// of the FIFO can't be trusted either
+			perf_count(_bad_transfers);
+			reset_fifo();
+
+			if (!_pub_blocked) {
+				_fifo_pub->publish();
+			}
+
+			perf_end(_sample_perf);
+			return -EIO;
+		}
+
+		process_sample(report, now - (samples - 1 - i) * (1000000 / MPU6000_FIFO_SAMPLE_RATE));
+	}
+
+	if (!_pub_blocked) {
+		_fifo_pub->publish();
+	}
+
+	perf_count(_good_transfers);
+
+	perf_end(_sample_perf);
+	return OK;
+}
+
+void
+MPU6000::reset_fifo()
+{
+	modify_reg(MPUREG_USER_CTRL, 0, BIT_USER_CTRL_FIFO_RST);
+}
+
+void
+MPU6000::process_sample(struct Report &report, hrt_abstime timestamp_sample)
+{
 	/*
 	 * Swap axes and negate y
 	 */
@@ -2003,7 +2143,7 @@ MPU6000::measure()
 	/*
 	 * Adjust and scale results to m/s^2.
 	 */
-	grb.timestamp = arb.timestamp = hrt_absolute_time();
+	grb.timestamp = arb.timestamp = timestamp_sample;
 
 	// report the error count as the sum of the number of bad
 	// transfers and bad register reads. This allows the higher
@@ -2038,23 +2178,20 @@ MPU6000::measure()
 	float zraw_f = report.accel_z;
 
 	// apply user specified rotation
-	rotate_3f(_rotation, xraw_f, yraw_f, zraw_f);
+	rotate_3f(_rotation_table, xraw_f, yraw_f, zraw_f);
+
+	const float accel_xr = xraw_f;
+	const float accel_yr = yraw_f;
+	const float accel_zr = zraw_f;
 
 	float x_in_new = ((xraw_f * _accel_range_scale) - _accel_scale.x_offset) * _accel_scale.x_scale;
 	float y_in_new = ((yraw_f * _accel_range_scale) - _accel_scale.y_offset) * _accel_scale.y_scale;
 	float z_in_new = ((zraw_f * _accel_range_scale) - _accel_scale.z_offset) * _accel_scale.z_scale;
 
-	arb.x = _accel_filter_x.apply(x_in_new);
-	arb.y = _accel_filter_y.apply(y_in_new);
-	arb.z = _accel_filter_z.apply(z_in_new);
-
-	math::Vector<3> aval(x_in_new, y_in_new, z_in_new);
-	math::Vector<3> aval_integrated;
-
-	bool accel_notify = _accel_int.put(arb.timestamp, aval, aval_integrated, arb.integral_dt);
-	arb.x_integral = aval_integrated(0);
-	arb.y_integral = aval_integrated(1);
-	arb.z_integral = aval_integrated(2);
+	const matrix::Vector3f accel_filtered = _accel_filter.apply(matrix::Vector3f(x_in_new, y_in_new, z_in_new));
+	arb.x = accel_filtered(0);
+	arb.y = accel_filtered(1);
+	arb.z = accel_filtered(2);
 
 	arb.scaling = _accel_range_scale;
 	arb.range_m_s2 = _accel_range_m_s2;
@@ -2081,23 +2218,37 @@ MPU6000::measure()
 	zraw_f = report.gyro_z;
 
 	// apply user specified rotation
-	rotate_3f(_rotation, xraw_f, yraw_f, zraw_f);
+	rotate_3f(_rotation_table, xraw_f, yraw_f, zraw_f);
 
 	float x_gyro_in_new = ((xraw_f * _gyro_range_scale) - _gyro_scale.x_offset) * _gyro_scale.x_scale;
 	float y_gyro_in_new = ((yraw_f * _gyro_range_scale) - _gyro_scale.y_offset) * _gyro_scale.y_scale;
 	float z_gyro_in_new = ((zraw_f * _gyro_range_scale) - _gyro_scale.z_offset) * _gyro_scale.z_scale;
 
-	grb.x = _gyro_filter_x.apply(x_gyro_in_new);
-	grb.y = _gyro_filter_y.apply(y_gyro_in_new);
-	grb.z = _gyro_filter_z.apply(z_gyro_in_new);
+	const matrix::Vector3f gyro_filtered = _gyro_filter.apply(matrix::Vector3f(x_gyro_in_new, y_gyro_in_new, z_gyro_in_new));
+	grb.x = gyro_filtered(0);
+	grb.y = gyro_filtered(1);
+	grb.z = gyro_filtered(2);
+
+	// integrate both sensors together, for the coning and sculling corrections
+	matrix::Vector3f delta_velocity;
+	matrix::Vector3f delta_angle;
+	uint32_t integral_dt = 0;
 
-	math::Vector<3> gval(x_gyro_in_new, y_gyro_in_new, z_gyro_in_new);
-	math::Vector<3> gval_integrated;
+	const bool notify = _imu_int.put(timestamp_sample, matrix::Vector3f(x_in_new, y_in_new, z_in_new),
+					 matrix::Vector3f(x_gyro_in_new, y_gyro_in_new, z_gyro_in_new),
+					 delta_angle, delta_velocity, integral_dt);
+	const bool accel_notify = notify;
+	const bool gyro_notify = notify;
 
-	bool gyro_notify = _gyro_int.put(arb.timestamp, gval, gval_integrated, grb.integral_dt);
-	grb.x_integral = gval_integrated(0);
-	grb.y_integral = gval_integrated(1);
-	grb.z_integral = gval_integrated(2);
+	arb.x_integral = delta_velocity(0);
+	arb.y_integral = delta_velocity(1);
+	arb.z_integral = delta_velocity(2);
+	arb.integral_dt = integral_dt;
+
+	grb.x_integral = delta_angle(0);
+	grb.y_integral = delta_angle(1);
+	grb.z_integral = delta_angle(2);
+	grb.integral_dt = integral_dt;
 
 	grb.scaling = _gyro_range_scale;
 	grb.range_rad_s = _gyro_range_rad_s;
@@ -2108,8 +2259,15 @@ MPU6000::measure()
 	/* return device ID */
 	grb.device_id = _gyro->_device_id.devid;
 
-	_accel_reports->force(&arb);
-	_gyro_reports->force(&grb);
+	if (_fifo_pub != nullptr) {
+		// the range (and thus the scale) can be changed with an ioctl
+		_fifo_pub->set_device_ids(arb.device_id, grb.device_id);
+		_fifo_pub->set_scale(_accel_range_scale, _gyro_range_scale);
+		_fifo_pub->put(timestamp_sample, accel_xr, accel_yr, accel_zr, xraw_f, yraw_f, zraw_f);
+	}
+
+	_accel_reports.force(arb);
+	_gyro_reports.force(grb);
 
 	/* notify anyone waiting for data */
 	if (accel_notify) {
@@ -2131,10 +2289,6 @@ MPU6000::measure()
 		/* publish it */
 		orb_publish(ORB_ID(sensor_gyro), _gyro->_gyro_topic, &grb);
 	}
-
-	/* stop measuring */
-	perf_end(_sample_perf);
-	return OK;
 }
 
 void
@@ -2148,8 +2302,14 @@ MPU6000::print_info()
 	perf_print_counter(_good_transfers);
 	perf_print_counter(_reset_retries);
 	perf_print_counter(_duplicates);
-	_accel_reports->print_info("accel queue");
-	_gyro_reports->print_info("gyro queue");
+
+	if (_fifo_enabled) {
+		::printf("FIFO mode, %u Hz\n", (unsigned)MPU6000_FIFO_SAMPLE_RATE);
+		perf_print_counter(_fifo_overflows);
+	}
+
+	_accel_reports.print_info("accel queue");
+	_gyro_reports.print_info("gyro queue");
 	::printf("checked_next: %u\n", _checked_next);
 
 	for (uint8_t i = 0; i < MPU6000_NUM_CHECKED_REGISTERS; i++) {
@@ -2164,9 +2324,9 @@ MPU6000::print_info()
 	}
 
 	::printf("temperature: %.1f\n", (double)_last_temperature);
-	float accel_cut = _accel_filter_x.get_cutoff_freq();
+	float accel_cut = _accel_filter.get_cutoff_freq();
 	::printf("accel cutoff set to %10.2f Hz\n", double(accel_cut));
-	float gyro_cut = _gyro_filter_x.get_cutoff_freq();
+	float gyro_cut = _gyro_filter.get_cutoff_freq();
 	::printf("gyro cutoff set to %10.2f Hz\n", double(gyro_cut));
 }
 
@@ -2301,8 +2461,8 @@ struct mpu6000_bus_option {
 #define NUM_BUS_OPTIONS (sizeof(bus_options)/sizeof(bus_options[0]))
 
 
-void	start(enum MPU6000_BUS busid, enum Rotation rotation, int range, int device_type);
-bool 	start_bus(struct mpu6000_bus_option &bus, enum Rotation rotation, int range, int device_type);
+void	start(enum MPU6000_BUS busid, enum Rotation rotation, int range, int device_type, bool fifo);
+bool 	start_bus(struct mpu6000_bus_option &bus, enum Rotation rotation, int range, int device_type, bool fifo);
 void	stop(enum MPU6000_BUS busid);
 void	test(enum MPU6000_BUS busid);
 static struct mpu6000_bus_option &find_bus(enum MPU6000_BUS busid);
@@ -2332,7 +2492,7 @@ struct mpu6000_bus_option &find_bus(enum MPU6000_BUS busid)
  * start driver for a specific bus option
  */
 bool
-start_bus(struct mpu6000_bus_option &bus, enum Rotation rotation, int range, int device_type)
+start_bus(struct mpu6000_bus_option &bus, enum Rotation rotation, int range, int device_type, bool fifo)
 {
 	int fd = -1;
 
@@ -2361,6 +2521,10 @@ start_bus(struct mpu6000_bus_option &bus, enum Rotation rotation, int range, int
 		return false;
 	}
 
+	if (fifo) {
+		bus.dev->enable_fifo();
+	}
+
 	if (OK != bus.dev->init()) {
 		goto fail;
 	}
@@ -2406,7 +2570,7 @@ fail:
  * or failed to detect the sensor.
  */
 void
-start(enum MPU6000_BUS busid, enum Rotation rotation, int range, int device_type)
+start(enum MPU6000_BUS busid, enum Rotation rotation, int range, int device_type, bool fifo)
 {
 
 	bool started = false;
@@ -2427,7 +2591,7 @@ start(enum MPU6000_BUS busid, enum Rotation rotation, int range, int device_type
 			continue;
 		}
 
-		started |= start_bus(bus_options[i], rotation, range, device_type);
+		started |= start_bus(bus_options[i], rotation, range, device_type, fifo);
 	}
 
 	exit(started ? 0 : 1);
@@ -2651,6 +2815,7 @@ usage()
 	warnx("    -T 6000|20608|20602 (default 6000)");
 	warnx("    -R rotation");
 	warnx("    -a accel range (in g)");
+	warnx("    -f FIFO mode (8 kHz gyro, MPU6000 on SPI only)");
 }
 
 } // namespace
@@ -2663,9 +2828,10 @@ mpu6000_main(int argc, char *argv[])
 	int ch;
 	enum Rotation rotation = ROTATION_NONE;
 	int accel_range = MPU6000_ACCEL_DEFAULT_RANGE_G;
+	bool fifo = false;
 
 	/* jump over start/off/etc and look at options first */
-	while ((ch = getopt(argc, argv, "T:XISsZzR:a:")) != EOF) {
+	while ((ch = getopt(argc, argv, "T:XISsZzR:a:f")) != EOF) {
 		switch (ch) {
 		case 'X':
 			busid = MPU6000_BUS_I2C_EXTERNAL;
@@ -2703,6 +2869,10 @@ mpu6000_main(int argc, char *argv[])
 			accel_range = atoi(optarg);
 			break;
 
+		case 'f':
+			fifo = true;
+			break;
+
 		default:
 			mpu6000::usage();
 			exit(0);
@@ -2716,7 +2886,7 @@ mpu6000_main(int argc, char *argv[])
 
 	 */
 	if (!strcmp(verb, "start")) {
-		mpu6000::start(busid, rotation, accel_range, device_type);
+		mpu6000::start(busid, rotation, accel_range, device_type, fifo);
 	}
 
 	if (!strcmp(verb, "stop")) {
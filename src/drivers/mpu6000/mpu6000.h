@@ -142,8 +142,16 @@
 #define BIT_INT_ANYRD_2CLEAR	0x10
 #define BIT_RAW_RDY_EN			0x01
 #define BIT_I2C_IF_DIS			0x10
+#define BIT_USER_CTRL_FIFO_EN		0x40
+#define BIT_USER_CTRL_FIFO_RST		0x04
 #define BIT_INT_STATUS_DATA		0x01
 
+#define BITS_FIFO_ENABLE_TEMP_OUT	0x80
+#define BITS_FIFO_ENABLE_GYRO_XOUT	0x40
+#define BITS_FIFO_ENABLE_GYRO_YOUT	0x20
+#define BITS_FIFO_ENABLE_GYRO_ZOUT	0x10
+#define BITS_FIFO_ENABLE_ACCEL		0x08
+
 #define MPU_WHOAMI_6000			0x68
 #define ICM_WHOAMI_20602		0x12
 #define ICM_WHOAMI_20608		0xaf
@@ -214,6 +222,13 @@
 
 #define MPU6000_ONE_G					9.80665f
 
+/* FIFO mode: the gyro is sampled at 8 kHz (on-chip DLPF bypassed) and the FIFO is read in bursts */
+#define MPU6000_FIFO_SAMPLE_RATE	8000
+#define MPU6000_FIFO_SIZE		1024
+#define MPU6000_FIFO_MAX_SAMPLES	(MPU6000_FIFO_SIZE / sizeof(MPUFIFOSample))
+/* longest burst interval before the FIFO overflows, with some margin */
+#define MPU6000_FIFO_MAX_INTERVAL	6000
+
 #ifdef PX4_SPI_BUS_EXT
 #define EXTERNAL_BUS PX4_SPI_BUS_EXT
 #else
@@ -238,6 +253,29 @@ struct MPUReport {
 	uint8_t		gyro_y[2];
 	uint8_t		gyro_z[2];
 };
+
+/**
+ * One FIFO entry, with accel, temperature and gyro enabled in MPUREG_FIFO_EN.
+ */
+struct MPUFIFOSample {
+	uint8_t		accel_x[2];
+	uint8_t		accel_y[2];
+	uint8_t		accel_z[2];
+	uint8_t		temp[2];
+	uint8_t		gyro_x[2];
+	uint8_t		gyro_y[2];
+	uint8_t		gyro_z[2];
+};
+
+/**
+ * Burst read of the FIFO, including command byte. The SPI interface only
+ * transfers in place for reads of at least sizeof(MPUReport), so at least
+ * two samples are read at once.
+ */
+struct MPUFIFOReport {
+	uint8_t		cmd;
+	struct MPUFIFOSample samples[MPU6000_FIFO_MAX_SAMPLES];
+};
 #pragma pack(pop)
 
 #define MPU_MAX_READ_BUFFER_SIZE (sizeof(MPUReport) + 1)
@@ -220,7 +220,7 @@ MPU9250_mag::_measure(struct ak8963_regs data)
 	float zraw_f = -data.z;
 
 	/* apply user specified rotation */
-	rotate_3f(_parent->_rotation, xraw_f, yraw_f, zraw_f);
+	rotate_3f(_parent->_rotation_table, xraw_f, yraw_f, zraw_f);
 
 	mrb.x = ((xraw_f * _mag_range_scale * _mag_asa_x) - _mag_scale.x_offset) * _mag_scale.x_scale;
 	mrb.y = ((yraw_f * _mag_range_scale * _mag_asa_y) - _mag_scale.y_offset) * _mag_scale.y_scale;
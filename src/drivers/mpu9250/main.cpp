@@ -71,6 +71,17 @@
 
 #include "mpu9250.h"
 
+/* data-ready pin of the internal sensor, if the board routes it */
+#if defined(GPIO_DRDY_MPU9250)
+#  define MPU9250_DRDY_INTERNAL GPIO_DRDY_MPU9250
+#elif defined(GPIO_SPI1_EXTI_MPU_DRDY)
+#  define MPU9250_DRDY_INTERNAL GPIO_SPI1_EXTI_MPU_DRDY
+#elif defined(GPIO_EXTI_MPU_DRDY)
+#  define MPU9250_DRDY_INTERNAL GPIO_EXTI_MPU_DRDY
+#else
+#  define MPU9250_DRDY_INTERNAL 0
+#endif
+
 #define MPU_DEVICE_PATH_ACCEL		"/dev/mpu9250_accel"
 #define MPU_DEVICE_PATH_GYRO		"/dev/mpu9250_gyro"
 #define MPU_DEVICE_PATH_MAG		"/dev/mpu9250_mag"
@@ -130,8 +141,9 @@ struct mpu9250_bus_option {
 #define NUM_BUS_OPTIONS (sizeof(bus_options)/sizeof(bus_options[0]))
 
 
-void	start(enum MPU9250_BUS busid, enum Rotation rotation, bool external_bus);
-bool	start_bus(struct mpu9250_bus_option &bus, enum Rotation rotation, bool external_bus);
+void	start(enum MPU9250_BUS busid, enum Rotation rotation, bool external_bus, bool fifo, bool drdy);
+bool	start_bus(struct mpu9250_bus_option &bus, enum Rotation rotation, bool external_bus, bool fifo,
+		  bool drdy);
 struct mpu9250_bus_option &find_bus(enum MPU9250_BUS busid);
 void	stop(enum MPU9250_BUS busid);
 void	test(enum MPU9250_BUS busid);
@@ -160,7 +172,7 @@ struct mpu9250_bus_option &find_bus(enum MPU9250_BUS busid)
  * start driver for a specific bus option
  */
 bool
-start_bus(struct mpu9250_bus_option &bus, enum Rotation rotation, bool external)
+start_bus(struct mpu9250_bus_option &bus, enum Rotation rotation, bool external, bool fifo, bool drdy)
 {
 	int fd = -1;
 
@@ -201,6 +213,13 @@ start_bus(struct mpu9250_bus_option &bus, enum Rotation rotation, bool external)
 		return false;
 	}
 
+	if (fifo) {
+		bus.dev->enable_fifo();
+
+	} else if (drdy && bus.busid == MPU9250_BUS_SPI_INTERNAL) {
+		bus.dev->enable_drdy(MPU9250_DRDY_INTERNAL);
+	}
+
 	if (OK != bus.dev->init()) {
 		goto fail;
 	}
@@ -242,7 +261,7 @@ fail:
  * or failed to detect the sensor.
  */
 void
-start(enum MPU9250_BUS busid, enum Rotation rotation, bool external)
+start(enum MPU9250_BUS busid, enum Rotation rotation, bool external, bool fifo, bool drdy)
 {
 
 	bool started = false;
@@ -258,7 +277,7 @@ start(enum MPU9250_BUS busid, enum Rotation rotation, bool external)
 			continue;
 		}
 
-		started |= start_bus(bus_options[i], rotation, external);
+		started |= start_bus(bus_options[i], rotation, external, fifo, drdy);
 	}
 
 	exit(started ? 0 : 1);
@@ -483,6 +502,8 @@ usage()
 	warnx("options:");
 	warnx("    -X    (external bus)");
 	warnx("    -R rotation");
+	warnx("    -f FIFO mode (8 kHz gyro, SPI only)");
+	warnx("    -d data-ready interrupt timestamps (internal SPI only)");
 }
 
 } // namespace
@@ -494,9 +515,11 @@ mpu9250_main(int argc, char *argv[])
 	int ch;
 	bool external = false;
 	enum Rotation rotation = ROTATION_NONE;
+	bool fifo = false;
+	bool drdy = false;
 
 	/* jump over start/off/etc and look at options first */
-	while ((ch = getopt(argc, argv, "XISsR:")) != EOF) {
+	while ((ch = getopt(argc, argv, "XISsR:fd")) != EOF) {
 		switch (ch) {
 		case 'X':
 			busid = MPU9250_BUS_I2C_EXTERNAL;
@@ -518,6 +541,14 @@ mpu9250_main(int argc, char *argv[])
 			rotation = (enum Rotation)atoi(optarg);
 			break;
 
+		case 'f':
+			fifo = true;
+			break;
+
+		case 'd':
+			drdy = true;
+			break;
+
 		default:
 			mpu9250::usage();
 			exit(0);
@@ -533,7 +564,7 @@ mpu9250_main(int argc, char *argv[])
 
 	 */
 	if (!strcmp(verb, "start")) {
-		mpu9250::start(busid, rotation, external);
+		mpu9250::start(busid, rotation, external, fifo, drdy);
 	}
 
 	if (!strcmp(verb, "stop")) {
@@ -72,10 +72,11 @@
 #include <drivers/device/spi.h>
 #include <drivers/device/ringbuffer.h>
 #include <drivers/device/integrator.h>
+#include <drivers/device/imu_fifo_publisher.h>
 #include <drivers/drv_accel.h>
 #include <drivers/drv_gyro.h>
 #include <drivers/drv_mag.h>
-#include <mathlib/math/filter/LowPassFilter2p.hpp>
+#include <mathlib/math/filter/LowPassFilter2pVector3f.hpp>
 #include <lib/conversion/rotation.h>
 
 #include "mag.h"
@@ -106,7 +107,8 @@ const uint8_t MPU9250::_checked_registers[MPU9250_NUM_CHECKED_REGISTERS] = { MPU
 									     MPUREG_ACCEL_CONFIG,
 									     MPUREG_ACCEL_CONFIG2,
 									     MPUREG_INT_ENABLE,
-									     MPUREG_INT_PIN_CFG
+									     MPUREG_INT_PIN_CFG,
+									     MPUREG_FIFO_EN
 									   };
 
 
@@ -126,19 +128,29 @@ MPU9250::MPU9250(device::Device *interface, device::Device *mag_interface, const
 #endif
 	_call {},
 	_call_interval(0),
-	_accel_reports(nullptr),
+	_accel_reports(2),
 	_accel_scale{},
 	_accel_range_scale(0.0f),
 	_accel_range_m_s2(0.0f),
 	_accel_topic(nullptr),
 	_accel_orb_class_instance(-1),
 	_accel_class_instance(-1),
-	_gyro_reports(nullptr),
+	_gyro_reports(2),
 	_gyro_scale{},
 	_gyro_range_scale(0.0f),
 	_gyro_range_rad_s(0.0f),
 	_dlpf_freq(MPU9250_DEFAULT_ONCHIP_FILTER_FREQ),
 	_sample_rate(1000),
+	_fifo_enabled(false),
+	_fifo_report(nullptr),
+	_fifo_pub(nullptr),
+	_fifo_mag_read(0),
+	_fifo_overflows(perf_alloc(PC_COUNT, "mpu9250_fifo_oflow")),
+	_drdy_gpio(0),
+	_drdy_last(0),
+	_drdy_count(0),
+	_drdy_decimation(1),
+	_drdy_interval(perf_alloc(PC_INTERVAL, "mpu9250_drdy_int")),
 	_accel_reads(perf_alloc(PC_COUNT, "mpu9250_acc_read")),
 	_gyro_reads(perf_alloc(PC_COUNT, "mpu9250_gyro_read")),
 	_sample_perf(perf_alloc(PC_ELAPSED, "mpu9250_read")),
@@ -150,15 +162,11 @@ MPU9250::MPU9250(device::Device *interface, device::Device *mag_interface, const
 	_controller_latency_perf(perf_alloc_once(PC_ELAPSED, "ctrl_latency")),
 	_register_wait(0),
 	_reset_wait(0),
-	_accel_filter_x(MPU9250_ACCEL_DEFAULT_RATE, MPU9250_ACCEL_DEFAULT_DRIVER_FILTER_FREQ),
-	_accel_filter_y(MPU9250_ACCEL_DEFAULT_RATE, MPU9250_ACCEL_DEFAULT_DRIVER_FILTER_FREQ),
-	_accel_filter_z(MPU9250_ACCEL_DEFAULT_RATE, MPU9250_ACCEL_DEFAULT_DRIVER_FILTER_FREQ),
-	_gyro_filter_x(MPU9250_GYRO_DEFAULT_RATE, MPU9250_GYRO_DEFAULT_DRIVER_FILTER_FREQ),
-	_gyro_filter_y(MPU9250_GYRO_DEFAULT_RATE, MPU9250_GYRO_DEFAULT_DRIVER_FILTER_FREQ),
-	_gyro_filter_z(MPU9250_GYRO_DEFAULT_RATE, MPU9250_GYRO_DEFAULT_DRIVER_FILTER_FREQ),
-	_accel_int(1000000 / MPU9250_ACCEL_MAX_OUTPUT_RATE),
-	_gyro_int(1000000 / MPU9250_GYRO_MAX_OUTPUT_RATE, true),
+	_accel_filter(MPU9250_ACCEL_DEFAULT_RATE, MPU9250_ACCEL_DEFAULT_DRIVER_FILTER_FREQ),
+	_gyro_filter(MPU9250_GYRO_DEFAULT_RATE, MPU9250_GYRO_DEFAULT_DRIVER_FILTER_FREQ),
+	_imu_int(1000000 / MPU9250_ACCEL_MAX_OUTPUT_RATE),
 	_rotation(rotation),
+	_rotation_table{},
 	_checked_next(0),
 	_last_temperature(0),
 	_last_accel_data{},
@@ -167,6 +175,8 @@ MPU9250::MPU9250(device::Device *interface, device::Device *mag_interface, const
 	// disable debug() calls
 	_debug_enabled = false;
 
+	get_rot_table(_rotation, &_rotation_table);
+
 	/* Set device parameters and make sure parameters of the bus device are adopted */
 	_device_id.devid_s.devtype = DRV_ACC_DEVTYPE_MPU9250;
 	_device_id.devid_s.bus_type = (device::Device::DeviceBusType)_interface->get_device_bus_type();
@@ -227,13 +237,12 @@ MPU9250::~MPU9250()
 	/* delete the magnetometer subdriver */
 	delete _mag;
 
-	/* free any existing reports */
-	if (_accel_reports != nullptr) {
-		delete _accel_reports;
+	if (_fifo_report != nullptr) {
+		delete _fifo_report;
 	}
 
-	if (_gyro_reports != nullptr) {
-		delete _gyro_reports;
+	if (_fifo_pub != nullptr) {
+		delete _fifo_pub;
 	}
 
 	if (_accel_class_instance != -1) {
@@ -249,6 +258,8 @@ MPU9250::~MPU9250()
 	perf_free(_good_transfers);
 	perf_free(_reset_retries);
 	perf_free(_duplicates);
+	perf_free(_fifo_overflows);
+	perf_free(_drdy_interval);
 }
 
 int
@@ -277,18 +288,22 @@ MPU9250::init()
 		return ret;
 	}
 
-	/* allocate basic report buffers */
-	_accel_reports = new ringbuffer::RingBuffer(2, sizeof(accel_report));
 	ret = -ENOMEM;
 
-	if (_accel_reports == nullptr) {
-		return ret;
+	if (_fifo_enabled && is_i2c()) {
+		PX4_WARN("FIFO mode not supported on I2C");
+		_fifo_enabled = false;
 	}
 
-	_gyro_reports = new ringbuffer::RingBuffer(2, sizeof(gyro_report));
+	if (_fifo_enabled) {
+		_fifo_report = new MPUFIFOReport;
+		_fifo_pub = new ImuFifoPublisher((is_external()) ? ORB_PRIO_MAX - 1 : ORB_PRIO_HIGH - 1);
 
-	if (_gyro_reports == nullptr) {
-		return ret;
+		if (_fifo_report == nullptr || _fifo_pub == nullptr) {
+			return ret;
+		}
+
+		_fifo_pub->set_sample_interval(1e6f / MPU9250_FIFO_SAMPLE_RATE);
 	}
 
 	if (reset_mpu() != OK) {
@@ -318,9 +333,7 @@ MPU9250::init()
 	if (accel_cut_ph != PARAM_INVALID && (param_get(accel_cut_ph, &accel_cut) == PX4_OK)) {
 		PX4_INFO("accel cutoff set to %.2f Hz", double(accel_cut));
 
-		_accel_filter_x.set_cutoff_frequency(MPU9250_ACCEL_DEFAULT_RATE, accel_cut);
-		_accel_filter_y.set_cutoff_frequency(MPU9250_ACCEL_DEFAULT_RATE, accel_cut);
-		_accel_filter_z.set_cutoff_frequency(MPU9250_ACCEL_DEFAULT_RATE, accel_cut);
+		_accel_filter.set_cutoff_frequency(MPU9250_ACCEL_DEFAULT_RATE, accel_cut);
 
 	} else {
 		PX4_ERR("IMU_ACCEL_CUTOFF param invalid");
@@ -332,9 +345,7 @@ MPU9250::init()
 	if (gyro_cut_ph != PARAM_INVALID && (param_get(gyro_cut_ph, &gyro_cut) == PX4_OK)) {
 		PX4_INFO("gyro cutoff set to %.2f Hz", double(gyro_cut));
 
-		_gyro_filter_x.set_cutoff_frequency(MPU9250_GYRO_DEFAULT_RATE, gyro_cut);
-		_gyro_filter_y.set_cutoff_frequency(MPU9250_GYRO_DEFAULT_RATE, gyro_cut);
-		_gyro_filter_z.set_cutoff_frequency(MPU9250_GYRO_DEFAULT_RATE, gyro_cut);
+		_gyro_filter.set_cutoff_frequency(MPU9250_GYRO_DEFAULT_RATE, gyro_cut);
 
 	} else {
 		PX4_ERR("IMU_GYRO_CUTOFF param invalid");
@@ -385,7 +396,7 @@ MPU9250::init()
 
 	/* advertise sensor topic, measure manually to initialize valid report */
 	struct accel_report arp;
-	_accel_reports->get(&arp);
+	_accel_reports.get(arp);
 
 	/* measurement will have generated a report, publish */
 	_accel_topic = orb_advertise_multi(ORB_ID(sensor_accel), &arp,
@@ -398,7 +409,7 @@ MPU9250::init()
 
 	/* advertise sensor topic, measure manually to initialize valid report */
 	struct gyro_report grp;
-	_gyro_reports->get(&grp);
+	_gyro_reports.get(grp);
 
 	_gyro->_gyro_topic = orb_advertise_multi(ORB_ID(sensor_gyro), &grp,
 			     &_gyro->_gyro_orb_class_instance, (is_external()) ? ORB_PRIO_MAX - 1 : ORB_PRIO_HIGH - 1);
@@ -456,7 +467,7 @@ int MPU9250::reset_mpu()
 
 	// Enable I2C bus or Disable I2C bus (recommended on data sheet)
 
-	write_checked_reg(MPUREG_USER_CTRL, is_i2c() ? 0 : BIT_I2C_IF_DIS);
+	write_checked_reg(MPUREG_USER_CTRL, (is_i2c() ? 0 : BIT_I2C_IF_DIS) | (_fifo_enabled ? BIT_I2C_FIFO_EN : 0));
 
 	// SAMPLE RATE
 	_set_sample_rate(_sample_rate);
@@ -501,6 +512,10 @@ int MPU9250::reset_mpu()
 
 	write_checked_reg(MPUREG_ACCEL_CONFIG2, BITS_ACCEL_CONFIG2_41HZ);
 
+	// FIFO: accel, temperature and gyro, in the same order as the data registers
+	write_checked_reg(MPUREG_FIFO_EN, _fifo_enabled ? (BITS_FIFO_ENABLE_ACCEL | BITS_FIFO_ENABLE_TEMP_OUT |
+			  BITS_FIFO_ENABLE_GYRO_XOUT | BITS_FIFO_ENABLE_GYRO_YOUT | BITS_FIFO_ENABLE_GYRO_ZOUT) : 0);
+
 	uint8_t retries = 3;
 	bool all_ok = false;
 
@@ -519,6 +534,10 @@ int MPU9250::reset_mpu()
 		}
 	}
 
+	if (_fifo_enabled) {
+		reset_fifo();
+	}
+
 	return all_ok ? OK : -EIO;
 }
 
@@ -555,6 +574,13 @@ MPU9250::_set_sample_rate(unsigned desired_sample_rate_hz)
 		desired_sample_rate_hz = MPU9250_GYRO_DEFAULT_RATE;
 	}
 
+	if (_fifo_enabled) {
+		// the divider does not apply to the 8 kHz output of the FIFO mode
+		write_checked_reg(MPUREG_SMPLRT_DIV, 0);
+		_sample_rate = MPU9250_FIFO_SAMPLE_RATE;
+		return;
+	}
+
 	uint8_t div = 1000 / desired_sample_rate_hz;
 
 	if (div > 200) { div = 200; }
@@ -573,6 +599,11 @@ MPU9250::_set_dlpf_filter(uint16_t frequency_hz)
 {
 	uint8_t filter;
 
+	if (_fifo_enabled) {
+		// the 8 kHz gyro rate of the FIFO mode is only available with the 250 Hz filter
+		frequency_hz = 250;
+	}
+
 	/*
 	   choose next highest filter frequency available
 	 */
@@ -628,29 +659,19 @@ MPU9250::read(struct file *filp, char *buffer, size_t buflen)
 
 	/* if automatic measurement is not enabled, get a fresh measurement into the buffer */
 	if (_call_interval == 0) {
-		_accel_reports->flush();
+		_accel_reports.flush();
 		measure();
 	}
 
 	/* if no data, error (we could block here) */
-	if (_accel_reports->empty()) {
+	if (_accel_reports.empty()) {
 		return -EAGAIN;
 	}
 
 	perf_count(_accel_reads);
 
 	/* copy reports out of our buffer to the caller */
-	accel_report *arp = reinterpret_cast<accel_report *>(buffer);
-	int transferred = 0;
-
-	while (count--) {
-		if (!_accel_reports->get(arp)) {
-			break;
-		}
-
-		transferred++;
-		arp++;
-	}
+	unsigned transferred = _accel_reports.get_n(reinterpret_cast<accel_report *>(buffer), count);
 
 	/* return the number of bytes transferred */
 	return (transferred * sizeof(accel_report));
@@ -753,29 +774,19 @@ MPU9250::gyro_read(struct file *filp, char *buffer, size_t buflen)
 
 	/* if automatic measurement is not enabled, get a fresh measurement into the buffer */
 	if (_call_interval == 0) {
-		_gyro_reports->flush();
+		_gyro_reports.flush();
 		measure();
 	}
 
 	/* if no data, error (we could block here) */
-	if (_gyro_reports->empty()) {
+	if (_gyro_reports.empty()) {
 		return -EAGAIN;
 	}
 
 	perf_count(_gyro_reads);
 
 	/* copy reports out of our buffer to the caller */
-	gyro_report *grp = reinterpret_cast<gyro_report *>(buffer);
-	int transferred = 0;
-
-	while (count--) {
-		if (!_gyro_reports->get(grp)) {
-			break;
-		}
-
-		transferred++;
-		grp++;
-	}
+	unsigned transferred = _gyro_reports.get_n(reinterpret_cast<gyro_report *>(buffer), count);
 
 	/* return the number of bytes transferred */
 	return (transferred * sizeof(gyro_report));
@@ -826,20 +837,21 @@ MPU9250::ioctl(struct file *filp, int cmd, unsigned long arg)
 						return -EINVAL;
 					}
 
+					/* read the FIFO often enough so that it does not overflow */
+					if (_fifo_enabled && ticks > MPU9250_FIFO_MAX_INTERVAL) {
+						ticks = MPU9250_FIFO_MAX_INTERVAL;
+					}
+
 					// adjust filters
-					float cutoff_freq_hz = _accel_filter_x.get_cutoff_freq();
-					float sample_rate = 1.0e6f / ticks;
+					float cutoff_freq_hz = _accel_filter.get_cutoff_freq();
+					float sample_rate = filter_sample_rate(ticks);
 					_set_dlpf_filter(cutoff_freq_hz);
-					_accel_filter_x.set_cutoff_frequency(sample_rate, cutoff_freq_hz);
-					_accel_filter_y.set_cutoff_frequency(sample_rate, cutoff_freq_hz);
-					_accel_filter_z.set_cutoff_frequency(sample_rate, cutoff_freq_hz);
+					_accel_filter.set_cutoff_frequency(sample_rate, cutoff_freq_hz);
 
 
-					float cutoff_freq_hz_gyro = _gyro_filter_x.get_cutoff_freq();
+					float cutoff_freq_hz_gyro = _gyro_filter.get_cutoff_freq();
 					_set_dlpf_filter(cutoff_freq_hz_gyro);
-					_gyro_filter_x.set_cutoff_frequency(sample_rate, cutoff_freq_hz_gyro);
-					_gyro_filter_y.set_cutoff_frequency(sample_rate, cutoff_freq_hz_gyro);
-					_gyro_filter_z.set_cutoff_frequency(sample_rate, cutoff_freq_hz_gyro);
+					_gyro_filter.set_cutoff_frequency(sample_rate, cutoff_freq_hz_gyro);
 
 					/* update interval for next measurement */
 					/* XXX this is a bit shady, but no other way to adjust... */
@@ -871,25 +883,16 @@ MPU9250::ioctl(struct file *filp, int cmd, unsigned long arg)
 		return 1000000 / _call_interval;
 
 	case SENSORIOCSQUEUEDEPTH: {
-			/* lower bound is mandatory, upper bound is a sanity check */
-			if ((arg < 1) || (arg > 100)) {
+			/* lower bound is mandatory, upper bound is the static queue capacity */
+			if (!_accel_reports.set_depth(arg)) {
 				return -EINVAL;
 			}
 
-			irqstate_t flags = px4_enter_critical_section();
-
-			if (!_accel_reports->resize(arg)) {
-				px4_leave_critical_section(flags);
-				return -ENOMEM;
-			}
-
-			px4_leave_critical_section(flags);
-
 			return OK;
 		}
 
 	case SENSORIOCGQUEUEDEPTH:
-		return _accel_reports->size();
+		return _accel_reports.size();
 
 	case ACCELIOCGSAMPLERATE:
 		return _sample_rate;
@@ -899,13 +902,11 @@ MPU9250::ioctl(struct file *filp, int cmd, unsigned long arg)
 		return OK;
 
 	case ACCELIOCGLOWPASS:
-		return _accel_filter_x.get_cutoff_freq();
+		return _accel_filter.get_cutoff_freq();
 
 	case ACCELIOCSLOWPASS:
 		// set software filtering
-		_accel_filter_x.set_cutoff_frequency(1.0e6f / _call_interval, arg);
-		_accel_filter_y.set_cutoff_frequency(1.0e6f / _call_interval, arg);
-		_accel_filter_z.set_cutoff_frequency(1.0e6f / _call_interval, arg);
+		_accel_filter.set_cutoff_frequency(filter_sample_rate(_call_interval), arg);
 		return OK;
 
 	case ACCELIOCSSCALE: {
@@ -967,25 +968,16 @@ MPU9250::gyro_ioctl(struct file *filp, int cmd, unsigned long arg)
 		return ioctl(filp, cmd, arg);
 
 	case SENSORIOCSQUEUEDEPTH: {
-			/* lower bound is mandatory, upper bound is a sanity check */
-			if ((arg < 1) || (arg > 100)) {
+			/* lower bound is mandatory, upper bound is the static queue capacity */
+			if (!_gyro_reports.set_depth(arg)) {
 				return -EINVAL;
 			}
 
-			irqstate_t flags = px4_enter_critical_section();
-
-			if (!_gyro_reports->resize(arg)) {
-				px4_leave_critical_section(flags);
-				return -ENOMEM;
-			}
-
-			px4_leave_critical_section(flags);
-
 			return OK;
 		}
 
 	case SENSORIOCGQUEUEDEPTH:
-		return _gyro_reports->size();
+		return _gyro_reports.size();
 
 	case GYROIOCGSAMPLERATE:
 		return _sample_rate;
@@ -995,13 +987,11 @@ MPU9250::gyro_ioctl(struct file *filp, int cmd, unsigned long arg)
 		return OK;
 
 	case GYROIOCGLOWPASS:
-		return _gyro_filter_x.get_cutoff_freq();
+		return _gyro_filter.get_cutoff_freq();
 
 	case GYROIOCSLOWPASS:
 		// set software filtering
-		_gyro_filter_x.set_cutoff_frequency(1.0e6f / _call_interval, arg);
-		_gyro_filter_y.set_cutoff_frequency(1.0e6f / _call_interval, arg);
-		_gyro_filter_z.set_cutoff_frequency(1.0e6f / _call_interval, arg);
+		_gyro_filter.set_cutoff_frequency(filter_sample_rate(_call_interval), arg);
 		return OK;
 
 	case GYROIOCSSCALE:
@@ -1151,8 +1141,8 @@ MPU9250::start()
 	stop();
 
 	/* discard any stale data in the buffers */
-	_accel_reports->flush();
-	_gyro_reports->flush();
+	_accel_reports.flush();
+	_gyro_reports.flush();
 	_mag->_mag_reports->flush();
 
 	if (_use_hrt) {
@@ -1162,6 +1152,23 @@ MPU9250::start()
 			       _call_interval - MPU9250_TIMER_REDUCTION,
 			       (hrt_callout)&MPU9250::measure_trampoline, this);
 
+#if defined(__PX4_NUTTX) && defined(CONFIG_ARCH_CHIP_STM32)
+
+		if (_drdy_gpio != 0 && !_fifo_enabled) {
+			/* the sensor produces a sample every 1/_sample_rate, only measure at the requested rate */
+			_drdy_decimation = (_call_interval * _sample_rate + 500000) / 1000000;
+
+			if (_drdy_decimation < 1) {
+				_drdy_decimation = 1;
+			}
+
+			_drdy_count = 0;
+			_drdy_last = 0;
+			stm32_gpiosetevent(_drdy_gpio, true, false, false, &MPU9250::drdy_interrupt, this);
+		}
+
+#endif
+
 	} else {
 #ifdef USE_I2C
 		/* schedule a cycle to start things */
@@ -1175,6 +1182,13 @@ void
 MPU9250::stop()
 {
 	if (_use_hrt) {
+#if defined(__PX4_NUTTX) && defined(CONFIG_ARCH_CHIP_STM32)
+
+		if (_drdy_gpio != 0) {
+			stm32_gpiosetevent(_drdy_gpio, false, false, false, nullptr, nullptr);
+		}
+
+#endif
 		hrt_cancel(&_call);
 
 	} else {
@@ -1225,10 +1239,33 @@ MPU9250::measure_trampoline(void *arg)
 {
 	MPU9250 *dev = reinterpret_cast<MPU9250 *>(arg);
 
+	/* the data-ready interrupt triggers the measurements while it is active */
+	if (dev->_drdy_last != 0 && hrt_elapsed_time(&dev->_drdy_last) < 2 * dev->_call_interval) {
+		return;
+	}
+
 	/* make another measurement */
 	dev->measure();
 }
 
+int
+MPU9250::drdy_interrupt(int irq, void *context, void *arg)
+{
+	MPU9250 *dev = reinterpret_cast<MPU9250 *>(arg);
+
+	/* the sample was latched on the rising edge, take the time before anything else */
+	const hrt_abstime now = hrt_absolute_time();
+	dev->_drdy_last = now;
+
+	if (++dev->_drdy_count >= dev->_drdy_decimation) {
+		dev->_drdy_count = 0;
+		perf_count(dev->_drdy_interval);
+		dev->measure(now);
+	}
+
+	return 0;
+}
+
 void
 MPU9250::check_registers(void)
 {
@@ -1332,24 +1369,21 @@ bool MPU9250::check_duplicate(uint8_t *accel_data)
 }
 
 void
-MPU9250::measure()
+MPU9250::measure(hrt_abstime timestamp_sample)
 {
 	if (hrt_absolute_time() < _reset_wait) {
 		// we're waiting for a reset to complete
 		return;
 	}
 
+	if (_fifo_enabled) {
+		measure_fifo();
+		return;
+	}
+
 	struct MPUReport mpu_report;
 
-	struct Report {
-		int16_t		accel_x;
-		int16_t		accel_y;
-		int16_t		accel_z;
-		int16_t		temp;
-		int16_t		gyro_x;
-		int16_t		gyro_y;
-		int16_t		gyro_z;
-	} report;
+	struct Report report;
 
 	/* start measuring */
 	perf_begin(_sample_perf);
@@ -1405,6 +1439,128 @@ MPU9250::measure()
 		return;
 	}
 
+	process_sample(report, (timestamp_sample != 0) ? timestamp_sample : hrt_absolute_time());
+
+	/* stop measuring */
+	perf_end(_sample_perf);
+}
+
+void
+MPU9250::measure_fifo()
+{
+	perf_begin(_sample_perf);
+
+	uint8_t fifo_count[2];
+
+	if (OK != _interface->read(MPU9250_SET_SPEED(MPUREG_FIFO_COUNTH, MPU9250_HIGH_BUS_SPEED),
+				   &fifo_count[0], sizeof(fifo_count))) {
+		perf_end(_sample_perf);
+		return;
+	}
+
+	/* the newest sample in the FIFO was taken at most one sample interval before now */
+	const hrt_abstime now = hrt_absolute_time();
+
+	check_registers();
+
+	const unsigned fifo_bytes = ((fifo_count[0] & 0x1f) << 8) | fifo_count[1];
+
+	if (fifo_bytes > sizeof(_fifo_report->samples)) {
+		/*
+		  the FIFO is (about to be) full: the oldest samples get
+		  overwritten, and the data is not aligned to the sample
+		  boundaries anymore
+		 */
+		perf_count(_fifo_overflows);
+		reset_fifo();
+		perf_end(_sample_perf);
+		return;
+	}
+
+	const unsigned samples = fifo_bytes / sizeof(MPUFIFOSample);
+
+	if (samples < 2) {
+		// leave them for the next burst, see MPUFIFOReport
+		perf_end(_sample_perf);
+		return;
+	}
+
+	if (OK != _interface->read(MPU9250_SET_SPEED(MPUREG_FIFO_R_W, MPU9250_HIGH_BUS_SPEED),
+				   (uint8_t *)_fifo_report,
+				   1 + samples * sizeof(MPUFIFOSample))) {
+		perf_end(_sample_perf);
+		return;
+	}
+
+	/* the mag is not in the FIFO, read it at twice its sample rate */
+	if (now - _fifo_mag_read >= 1000000 / (2 * MPU9250_AK8963_SAMPLE_RATE)) {
+		_fifo_mag_read = now;
+
+#ifdef USE_I2C
+
+		if (_mag->is_passthrough()) {
+#endif
+			struct MPUReport mpu_report;
+
+			if (OK == _interface->read(MPU9250_SET_SPEED(MPUREG_INT_STATUS, MPU9250_HIGH_BUS_SPEED),
+						   (uint8_t *)&mpu_report,
+						   sizeof(mpu_report))) {
+				_mag->_measure(mpu_report.mag);
+			}
+
+#ifdef USE_I2C
+
+		} else {
+			_mag->measure();
+		}
+
+#endif
+	}
+
+	if (_register_wait != 0) {
+		// we are waiting for some good transfers before using the sensor again
+		_register_wait--;
+		perf_end(_sample_perf);
+		return;
+	}
+
+	for (unsigned i = 0; i < samples; i++) {
+		struct MPUFIFOSample &sample = _fifo_report->samples[i];
+		struct Report report;
+
+		report.accel_x = int16_t_from_bytes(sample.accel_x);
+		report.accel_y = int16_t_from_bytes(sample.accel_y);
+		report.accel_z = int16_t_from_bytes(sample.accel_z);
+		report.temp    = int16_t_from_bytes(sample.temp);
+		report.gyro_x  = int16_t_from_bytes(sample.gyro_x);
+		report.gyro_y  = int16_t_from_bytes(sample.gyro_y);
+		report.gyro_z  = int16_t_from_bytes(sample.gyro_z);
+
+		if (check_null_data((uint32_t *)&report, sizeof(report) / 4)) {
+			// the rest of the FIFO can't be trusted either
+			reset_fifo();
+			break;
+		}
+
+		process_sample(report, now - (samples - 1 - i) * (1000000 / MPU9250_FIFO_SAMPLE_RATE));
+	}
+
+	if (!_pub_blocked) {
+		_fifo_pub->publish();
+	}
+
+	perf_end(_sample_perf);
+}
+
+void
+MPU9250::reset_fifo()
+{
+	modify_reg(MPUREG_USER_CTRL, 0, BIT_FIFO_RST);
+}
+
+void
+MPU9250::process_sample(struct Report &report, hrt_abstime timestamp_sample)
+{
 	/*
 	 * Swap axes and negate y
 	 */
@@ -1431,7 +1587,7 @@ MPU9250::measure()
 	/*
 	 * Adjust and scale results to m/s^2.
 	 */
-	grb.timestamp = arb.timestamp = hrt_absolute_time();
+	grb.timestamp = arb.timestamp = timestamp_sample;
 
 	// report the error count as the sum of the number of bad
 	// transfers and bad register reads. This allows the higher
@@ -1465,23 +1621,20 @@ MPU9250::measure()
 	float zraw_f = report.accel_z;
 
 	// apply user specified rotation
-	rotate_3f(_rotation, xraw_f, yraw_f, zraw_f);
+	rotate_3f(_rotation_table, xraw_f, yraw_f, zraw_f);
+
+	const float accel_xr = xraw_f;
+	const float accel_yr = yraw_f;
+	const float accel_zr = zraw_f;
 
 	float x_in_new = ((xraw_f * _accel_range_scale) - _accel_scale.x_offset) * _accel_scale.x_scale;
 	float y_in_new = ((yraw_f * _accel_range_scale) - _accel_scale.y_offset) * _accel_scale.y_scale;
 	float z_in_new = ((zraw_f * _accel_range_scale) - _accel_scale.z_offset) * _accel_scale.z_scale;
 
-	arb.x = _accel_filter_x.apply(x_in_new);
-	arb.y = _accel_filter_y.apply(y_in_new);
-	arb.z = _accel_filter_z.apply(z_in_new);
-
-	math::Vector<3> aval(x_in_new, y_in_new, z_in_new);
-	math::Vector<3> aval_integrated;
-
-	bool accel_notify = _accel_int.put(arb.timestamp, aval, aval_integrated, arb.integral_dt);
-	arb.x_integral = aval_integrated(0);
-	arb.y_integral = aval_integrated(1);
-	arb.z_integral = aval_integrated(2);
+	const matrix::Vector3f accel_filtered = _accel_filter.apply(matrix::Vector3f(x_in_new, y_in_new, z_in_new));
+	arb.x = accel_filtered(0);
+	arb.y = accel_filtered(1);
+	arb.z = accel_filtered(2);
 
 	arb.scaling = _accel_range_scale;
 	arb.range_m_s2 = _accel_range_m_s2;
@@ -1503,23 +1656,37 @@ MPU9250::measure()
 	zraw_f = report.gyro_z;
 
 	// apply user specified rotation
-	rotate_3f(_rotation, xraw_f, yraw_f, zraw_f);
+	rotate_3f(_rotation_table, xraw_f, yraw_f, zraw_f);
 
 	float x_gyro_in_new = ((xraw_f * _gyro_range_scale) - _gyro_scale.x_offset) * _gyro_scale.x_scale;
 	float y_gyro_in_new = ((yraw_f * _gyro_range_scale) - _gyro_scale.y_offset) * _gyro_scale.y_scale;
 	float z_gyro_in_new = ((zraw_f * _gyro_range_scale) - _gyro_scale.z_offset) * _gyro_scale.z_scale;
 
-	grb.x = _gyro_filter_x.apply(x_gyro_in_new);
-	grb.y = _gyro_filter_y.apply(y_gyro_in_new);
-	grb.z = _gyro_filter_z.apply(z_gyro_in_new);
+	const matrix::Vector3f gyro_filtered = _gyro_filter.apply(matrix::Vector3f(x_gyro_in_new, y_gyro_in_new, z_gyro_in_new));
+	grb.x = gyro_filtered(0);
+	grb.y = gyro_filtered(1);
+	grb.z = gyro_filtered(2);
+
+	// integrate both sensors together, for the coning and sculling corrections
+	matrix::Vector3f delta_velocity;
+	matrix::Vector3f delta_angle;
+	uint32_t integral_dt = 0;
 
-	math::Vector<3> gval(x_gyro_in_new, y_gyro_in_new, z_gyro_in_new);
-	math::Vector<3> gval_integrated;
+	const bool notify = _imu_int.put(timestamp_sample, matrix::Vector3f(x_in_new, y_in_new, z_in_new),
+					 matrix::Vector3f(x_gyro_in_new, y_gyro_in_new, z_gyro_in_new),
+					 delta_angle, delta_velocity, integral_dt);
+	const bool accel_notify = notify;
+	const bool gyro_notify = notify;
 
-	bool gyro_notify = _gyro_int.put(arb.timestamp, gval, gval_integrated, grb.integral_dt);
-	grb.x_integral = gval_integrated(0);
-	grb.y_integral = gval_integrated(1);
-	grb.z_integral = gval_integrated(2);
+	arb.x_integral = delta_velocity(0);
+	arb.y_integral = delta_velocity(1);
+	arb.z_integral = delta_velocity(2);
+	arb.integral_dt = integral_dt;
+
+	grb.x_integral = delta_angle(0);
+	grb.y_integral = delta_angle(1);
+	grb.z_integral = delta_angle(2);
+	grb.integral_dt = integral_dt;
 
 	grb.scaling = _gyro_range_scale;
 	grb.range_rad_s = _gyro_range_rad_s;
@@ -1530,8 +1697,15 @@ MPU9250::measure()
 	/* return device ID */
 	grb.device_id = _gyro->_device_id.devid;
 
-	_accel_reports->force(&arb);
-	_gyro_reports->force(&grb);
+	if (_fifo_pub != nullptr) {
+		// the range (and thus the scale) can be changed with an ioctl
+		_fifo_pub->set_device_ids(arb.device_id, grb.device_id);
+		_fifo_pub->set_scale(_accel_range_scale, _gyro_range_scale);
+		_fifo_pub->put(timestamp_sample, accel_xr, accel_yr, accel_zr, xraw_f, yraw_f, zraw_f);
+	}
+
+	_accel_reports.force(arb);
+	_gyro_reports.force(grb);
 
 	/* notify anyone waiting for data */
 	if (accel_notify) {
@@ -1553,9 +1727,6 @@ MPU9250::measure()
 		/* publish it */
 		orb_publish(ORB_ID(sensor_gyro), _gyro->_gyro_topic, &grb);
 	}
-
-	/* stop measuring */
-	perf_end(_sample_perf);
 }
 
 void
@@ -1569,8 +1740,21 @@ MPU9250::print_info()
 	perf_print_counter(_good_transfers);
 	perf_print_counter(_reset_retries);
 	perf_print_counter(_duplicates);
-	_accel_reports->print_info("accel queue");
-	_gyro_reports->print_info("gyro queue");
+
+	if (_fifo_enabled) {
+		::printf("FIFO mode, %u Hz\n", (unsigned)MPU9250_FIFO_SAMPLE_RATE);
+		perf_print_counter(_fifo_overflows);
+	}
+
+	if (_drdy_gpio != 0) {
+		::printf("data-ready interrupt: %s, decimation %u\n",
+			 (_drdy_last != 0 && hrt_elapsed_time(&_drdy_last) < 2 * _call_interval) ? "active" : "inactive",
+			 _drdy_decimation);
+		perf_print_counter(_drdy_interval);
+	}
+
+	_accel_reports.print_info("accel queue");
+	_gyro_reports.print_info("gyro queue");
 	_mag->_mag_reports->print_info("mag queue");
 	::printf("checked_next: %u\n", _checked_next);
 
@@ -1593,9 +1777,9 @@ MPU9250::print_info()
 	}
 
 	::printf("temperature: %.1f\n", (double)_last_temperature);
-	float accel_cut = _accel_filter_x.get_cutoff_freq();
+	float accel_cut = _accel_filter.get_cutoff_freq();
 	::printf("accel cutoff set to %10.2f Hz\n", double(accel_cut));
-	float gyro_cut = _gyro_filter_x.get_cutoff_freq();
+	float gyro_cut = _gyro_filter.get_cutoff_freq();
 	::printf("gyro cutoff set to %10.2f Hz\n", double(gyro_cut));
 }
 
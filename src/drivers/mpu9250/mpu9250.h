@@ -42,11 +42,12 @@
 #include <drivers/drv_hrt.h>
 
 #include <drivers/device/ringbuffer.h>
-#include <drivers/device/integrator.h>
+#include <drivers/device/imu_integrator.h>
+#include <drivers/device/imu_fifo_publisher.h>
 #include <drivers/drv_accel.h>
 #include <drivers/drv_gyro.h>
 #include <drivers/drv_mag.h>
-#include <mathlib/math/filter/LowPassFilter2p.hpp>
+#include <mathlib/math/filter/LowPassFilter2pVector3f.hpp>
 #include <lib/conversion/rotation.h>
 
 #include "mag.h"
@@ -150,6 +151,14 @@
 #define BIT_INT_ANYRD_2CLEAR		0x10
 #define BIT_INT_BYPASS_EN		0x02
 
+#define BIT_INT_FIFO_OFLOW		0x10
+
+#define BITS_FIFO_ENABLE_TEMP_OUT	0x80
+#define BITS_FIFO_ENABLE_GYRO_XOUT	0x40
+#define BITS_FIFO_ENABLE_GYRO_YOUT	0x20
+#define BITS_FIFO_ENABLE_GYRO_ZOUT	0x10
+#define BITS_FIFO_ENABLE_ACCEL		0x08
+
 #define BIT_I2C_READ_FLAG           0x80
 
 #define BIT_I2C_SLV0_NACK           0x01
@@ -192,6 +201,13 @@
 
 #define MPU9250_ONE_G					9.80665f
 
+/* FIFO mode: the gyro is sampled at 8 kHz (on-chip DLPF bypassed) and the FIFO is read in bursts */
+#define MPU9250_FIFO_SAMPLE_RATE	8000
+#define MPU9250_FIFO_SIZE		512
+#define MPU9250_FIFO_MAX_SAMPLES	(MPU9250_FIFO_SIZE / sizeof(MPUFIFOSample))
+/* longest burst interval before the FIFO overflows, with some margin */
+#define MPU9250_FIFO_MAX_INTERVAL	3000
+
 #define MPUIOCGIS_I2C	(unsigned)(DEVIOCGDEVICEID+100)
 
 
@@ -212,6 +228,29 @@ struct MPUReport {
 	uint8_t		gyro_z[2];
 	struct ak8963_regs mag;
 };
+
+/**
+ * One FIFO entry, with accel, temperature and gyro enabled in MPUREG_FIFO_EN.
+ */
+struct MPUFIFOSample {
+	uint8_t		accel_x[2];
+	uint8_t		accel_y[2];
+	uint8_t		accel_z[2];
+	uint8_t		temp[2];
+	uint8_t		gyro_x[2];
+	uint8_t		gyro_y[2];
+	uint8_t		gyro_z[2];
+};
+
+/**
+ * Burst read of the FIFO, including command byte. The SPI interface only
+ * transfers in place for reads of at least sizeof(MPUReport), so at least
+ * two samples are read at once.
+ */
+struct MPUFIFOReport {
+	uint8_t		cmd;
+	struct MPUFIFOSample samples[MPU9250_FIFO_MAX_SAMPLES];
+};
 #pragma pack(pop)
 
 #define MPU_MAX_WRITE_BUFFER_SIZE (2)
@@ -268,6 +307,21 @@ public:
 	// deliberately cause a sensor error
 	void 			test_error();
 
+	/**
+	 * Read the samples from the FIFO in bursts instead of one register snapshot per
+	 * measurement. The gyro is then sampled at MPU9250_FIFO_SAMPLE_RATE, and all samples
+	 * go through the filters and integrators. SPI only, must be called before init().
+	 */
+	void			enable_fifo() { _fifo_enabled = true; }
+
+	/**
+	 * Trigger the measurements from the data-ready interrupt of the sensor instead of the
+	 * HRT, and timestamp the samples in the interrupt. The HRT keeps polling at a lower
+	 * priority as a fallback, if the interrupt stops. SPI only, must be called before init().
+	 * @param gpio data-ready pin of the board (GPIO_EXTI input), 0 if there is none
+	 */
+	void			enable_drdy(uint32_t gpio) { _drdy_gpio = gpio; }
+
 protected:
 	Device			*_interface;
 
@@ -296,7 +350,7 @@ private:
 	struct hrt_call		_call;
 	unsigned		_call_interval;
 
-	ringbuffer::RingBuffer	*_accel_reports;
+	ringbuffer::RingBufferT<accel_report, 16>	_accel_reports;
 
 	struct accel_calibration_s	_accel_scale;
 	float			_accel_range_scale;
@@ -305,7 +359,7 @@ private:
 	int			_accel_orb_class_instance;
 	int			_accel_class_instance;
 
-	ringbuffer::RingBuffer	*_gyro_reports;
+	ringbuffer::RingBufferT<gyro_report, 16>	_gyro_reports;
 
 	struct gyro_calibration_s	_gyro_scale;
 	float			_gyro_range_scale;
@@ -314,6 +368,19 @@ private:
 	unsigned		_dlpf_freq;
 
 	unsigned		_sample_rate;
+
+	bool			_fifo_enabled;
+	struct MPUFIFOReport	*_fifo_report;
+	ImuFifoPublisher	*_fifo_pub;	///< all FIFO samples, as sensor_accel_fifo/sensor_gyro_fifo
+	hrt_abstime		_fifo_mag_read;	///< last time the mag registers were read in FIFO mode
+	perf_counter_t		_fifo_overflows;
+
+	uint32_t		_drdy_gpio;	///< data-ready pin, 0 if the HRT triggers the measurements
+	volatile hrt_abstime	_drdy_last;	///< time of the last data-ready interrupt
+	unsigned		_drdy_count;
+	unsigned		_drdy_decimation;	///< measure on every Nth interrupt, to match _call_interval
+	perf_counter_t		_drdy_interval;
+
 	perf_counter_t		_accel_reads;
 	perf_counter_t		_gyro_reads;
 	perf_counter_t		_sample_perf;
@@ -327,22 +394,18 @@ private:
 	uint8_t			_register_wait;
 	uint64_t		_reset_wait;
 
-	math::LowPassFilter2p	_accel_filter_x;
-	math::LowPassFilter2p	_accel_filter_y;
-	math::LowPassFilter2p	_accel_filter_z;
-	math::LowPassFilter2p	_gyro_filter_x;
-	math::LowPassFilter2p	_gyro_filter_y;
-	math::LowPassFilter2p	_gyro_filter_z;
+	math::LowPassFilter2pVector3f	_accel_filter;
+	math::LowPassFilter2pVector3f	_gyro_filter;
 
-	Integrator		_accel_int;
-	Integrator		_gyro_int;
+	ImuIntegrator		_imu_int;
 
 	enum Rotation		_rotation;
+	rot_table_t		_rotation_table;	///< _rotation, applied to each sample
 
 	// this is used to support runtime checking of key
 	// configuration registers to detect SPI bus errors and sensor
 	// reset
-#define MPU9250_NUM_CHECKED_REGISTERS 11
+#define MPU9250_NUM_CHECKED_REGISTERS 12
 	static const uint8_t	_checked_registers[MPU9250_NUM_CHECKED_REGISTERS];
 	uint8_t			_checked_values[MPU9250_NUM_CHECKED_REGISTERS];
 	uint8_t			_checked_bad[MPU9250_NUM_CHECKED_REGISTERS];
@@ -426,10 +489,57 @@ private:
 	 */
 	static void		measure_trampoline(void *arg);
 
+	/**
+	 * Data-ready interrupt handler, triggers a measurement on every _drdy_decimation'th sample.
+	 */
+	static int		drdy_interrupt(int irq, void *context, void *arg);
+
 	/**
 	 * Fetch measurements from the sensor and update the report buffers.
+	 * @param timestamp_sample time the sample was taken (from the data-ready interrupt),
+	 *			   0 to use the time of the transfer
+	 */
+	void			measure(hrt_abstime timestamp_sample = 0);
+
+	/**
+	 * Read all complete samples from the FIFO in one transfer and process them.
+	 */
+	void			measure_fifo();
+
+	/**
+	 * Clear the FIFO, after an overflow or a bad transfer.
 	 */
-	void			measure();
+	void			reset_fifo();
+
+	/**
+	 * Sample in native byte order, as read from the data registers or the FIFO
+	 */
+	struct Report {
+		int16_t		accel_x;
+		int16_t		accel_y;
+		int16_t		accel_z;
+		int16_t		temp;
+		int16_t		gyro_x;
+		int16_t		gyro_y;
+		int16_t		gyro_z;
+	};
+
+	/**
+	 * Scale, filter and integrate one sample, and publish the reports
+	 * if the integrators have an output.
+	 *
+	 * @param report		The sample, in the sensor frame.
+	 * @param timestamp_sample	Time the sample was taken.
+	 */
+	void			process_sample(struct Report &report, hrt_abstime timestamp_sample);
+
+	/**
+	 * @return rate of the samples going through the driver filters [Hz]
+	 */
+	float			filter_sample_rate(unsigned call_interval) const
+	{
+		return _fifo_enabled ? MPU9250_FIFO_SAMPLE_RATE : 1.0e6f / call_interval;
+	}
 
 	/**
 	 * Read a register from the mpu
@@ -66,6 +66,7 @@
 
 #include <systemlib/perf_counter.h>
 #include <systemlib/err.h>
+#include <systemlib/work_queue_stats.h>
 #include <platforms/px4_getopt.h>
 
 #include "ms5611.h"
@@ -612,6 +613,8 @@ MS5611::start_cycle(unsigned delay_ticks)
 	_measure_phase = 0;
 	_reports->flush();
 
+	work_queue_stats_register((worker_t)&MS5611::cycle_trampoline, "ms5611");
+
 	/* schedule a cycle to start things */
 	work_queue(HPWORK, &_work, (worker_t)&MS5611::cycle_trampoline, this, delay_ticks);
 }
@@ -121,6 +121,9 @@ int RcInput::navio_rc_init()
 		_ch_fd[i] = fd;
 	}
 
+	// only read the channels that could be opened (each one costs a system call per cycle)
+	_channels = i;
+
 	for (; i < input_rc_s::RC_INPUT_MAX_CHANNELS; ++i) {
 		_data.values[i] = UINT16_MAX;
 	}
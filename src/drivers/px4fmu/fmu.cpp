@@ -40,6 +40,7 @@
 #include <cfloat>
 
 #include <board_config.h>
+#include <drivers/device/control_latency.h>
 #include <drivers/device/device.h>
 #include <drivers/device/i2c.h>
 #include <drivers/drv_gpio.h>
@@ -62,6 +63,8 @@
 #include <systemlib/param/param.h>
 #include <systemlib/perf_counter.h>
 #include <systemlib/pwm_limit/pwm_limit.h>
+#include <systemlib/work_queue_stats.h>
+#include <uORB/SubscriptionCallback.hpp>
 #include <uORB/topics/actuator_armed.h>
 #include <uORB/topics/actuator_controls.h>
 #include <uORB/topics/actuator_outputs.h>
@@ -77,6 +80,7 @@
 #endif
 
 #define SCHEDULE_INTERVAL	2000	/**< The schedule interval in usec (500 Hz) */
+#define SYNC_OUTPUT_TIMEOUT	100000	/**< Synchronized outputs: cycle takes over after this time without controls [us] */
 
 static constexpr uint8_t CYCLE_COUNT = 10; /* safety switch must be held for 1 second to activate */
 static constexpr uint8_t MAX_ACTUATORS = DIRECT_PWM_OUTPUT_CHANNELS;
@@ -276,6 +280,16 @@ private:
 
 	float _mot_t_max;	// maximum rise time for motor (slew rate limiting)
 	float _thr_mdl_fac;	// thrust to pwm modelling factor
+	int32_t _mot_mix_mode;	// multirotor mixer mode (0: reference, 1: single-pass)
+	int32_t _pwm_out_sync;	// trigger the output updates from the actuator_controls_0 publications
+	int32_t _dshot_config;	// DShot bit rate [kHz], 0 for PWM
+	uint32_t _dshot_mask;	// channels initialized for DShot
+
+	uORB::SubscriptionCallback *_controls_callback;	///< schedules output_trampoline() on actuator_controls_0
+	bool		_output_sync_active;
+	hrt_abstime	_time_last_sync_output;
+
+	ControlLatency	_control_latency;
 
 	perf_counter_t	_ctl_latency;
 
@@ -285,6 +299,11 @@ private:
 	}
 
 	static void	cycle_trampoline(void *arg);
+
+	/**
+	 * Worker scheduled by the actuator_controls_0 publications when the outputs are synchronized
+	 */
+	static void	output_trampoline(void *arg);
 	int 		start();
 
 	static int	control_callback(uintptr_t handle,
@@ -299,8 +318,25 @@ private:
 	void		update_pwm_rev_mask();
 	void		update_pwm_out_state(bool on);
 
+	/**
+	 * convert a limited pwm value to a DShot throttle value: 0 (stop) if the output is disarmed or
+	 * below the minimum, otherwise [min, max] is mapped to the DShot throttle range.
+	 */
+	uint16_t	dshot_throttle(unsigned channel, uint16_t pwm) const;
+
 	void		update_params();
 
+	/**
+	 * register or unregister the actuator_controls_0 callback according to PWM_OUT_SYNC
+	 */
+	void		update_output_sync();
+
+	/**
+	 * fetch the actuator controls, run the mixers and update the outputs
+	 * @param poll_timeout timeout to wait for new controls [ms]
+	 */
+	void		update_outputs(int poll_timeout);
+
 	struct GPIOConfig {
 		uint32_t	input;
 		uint32_t	output;
@@ -386,6 +422,14 @@ PX4FMU::PX4FMU(bool run_as_task) :
 	_to_mixer_status(nullptr),
 	_mot_t_max(0.0f),
 	_thr_mdl_fac(0.0f),
+	_mot_mix_mode(0),
+	_pwm_out_sync(0),
+	_dshot_config(0),
+	_dshot_mask(0),
+	_controls_callback(nullptr),
+	_output_sync_active(false),
+	_time_last_sync_output(0),
+	_control_latency(),
 	_ctl_latency(perf_alloc(PC_ELAPSED, "ctl_lat"))
 {
 	for (unsigned i = 0; i < _max_actuators; i++) {
@@ -438,6 +482,9 @@ PX4FMU::PX4FMU(bool run_as_task) :
 
 PX4FMU::~PX4FMU()
 {
+	/* unregisters and cancels a pending output update */
+	delete _controls_callback;
+
 	for (unsigned i = 0; i < actuator_controls_s::NUM_ACTUATOR_CONTROL_GROUPS; i++) {
 		if (_control_subs[i] > 0) {
 			orb_unsubscribe(_control_subs[i]);
@@ -993,6 +1040,8 @@ PX4FMU::task_spawn(int argc, char *argv[])
 
 	if (!run_as_task) {
 
+		work_queue_stats_register((worker_t)&PX4FMU::cycle_trampoline, "fmu");
+
 		/* schedule a cycle to start things */
 		int ret = work_queue(HPWORK, &_work, (worker_t)&PX4FMU::cycle_trampoline, nullptr, 0);
 
@@ -1054,6 +1103,16 @@ PX4FMU::cycle_trampoline(void *arg)
 	dev->cycle();
 }
 
+void
+PX4FMU::output_trampoline(void *arg)
+{
+	PX4FMU *dev = reinterpret_cast<PX4FMU *>(arg);
+
+	/* runs on the same work queue as cycle(), so the two never run concurrently */
+	dev->update_outputs(0);
+	dev->_time_last_sync_output = hrt_absolute_time();
+}
+
 void
 PX4FMU::capture_trampoline(void *context, uint32_t chan_index,
 			   hrt_abstime edge_time, uint32_t edge_state, uint32_t overflow)
@@ -1152,12 +1211,57 @@ void
 PX4FMU::update_pwm_out_state(bool on)
 {
 	if (on && !_pwm_initialized && _pwm_mask != 0) {
-		up_pwm_servo_init(_pwm_mask);
+		_dshot_mask = 0;
+
+#ifdef BOARD_HAS_DSHOT
+
+		if (_dshot_config > 0) {
+			int ret = up_dshot_init(_pwm_mask, _dshot_config * 1000);
+
+			if (ret < 0) {
+				PX4_ERR("DShot init failed (%d)", ret);
+
+			} else {
+				_dshot_mask = ret;
+			}
+		}
+
+#endif
+
+		/* the remaining channels are PWM */
+		up_pwm_servo_init(_pwm_mask & ~_dshot_mask);
 		set_pwm_rate(_pwm_alt_rate_channels, _pwm_default_rate, _pwm_alt_rate);
 		_pwm_initialized = true;
 	}
 
 	up_pwm_servo_arm(on);
+
+#ifdef BOARD_HAS_DSHOT
+
+	if (_dshot_mask != 0) {
+		up_dshot_arm(on);
+	}
+
+#endif
+}
+
+uint16_t
+PX4FMU::dshot_throttle(unsigned channel, uint16_t pwm) const
+{
+	static constexpr uint16_t dshot_min_throttle = 48; // 1-47 are reserved for commands
+	static constexpr uint16_t dshot_max_throttle = 2047;
+
+	if (!_throttle_armed || _armed.lockdown || _armed.manual_lockdown ||
+	    pwm < _min_pwm[channel] || _max_pwm[channel] <= _min_pwm[channel]) {
+		return 0;
+	}
+
+	if (pwm >= _max_pwm[channel]) {
+		return dshot_max_throttle;
+	}
+
+	return dshot_min_throttle + (uint32_t)(pwm - _min_pwm[channel]) * (dshot_max_throttle - dshot_min_throttle) /
+	       (_max_pwm[channel] - _min_pwm[channel]);
 }
 
 void
@@ -1173,197 +1277,231 @@ PX4FMU::run()
 }
 
 void
-PX4FMU::cycle()
+PX4FMU::update_outputs(int poll_timeout)
 {
-	while (true) {
+	/* wait for an update */
+	unsigned n_updates = 0;
+	int ret = px4_poll(_poll_fds, _poll_fds_num, poll_timeout);
 
-		if (_groups_subscribed != _groups_required) {
-			subscribe();
-			_groups_subscribed = _groups_required;
-			/* force setting update rate */
-			_current_update_rate = 0;
-		}
+	/* this would be bad... */
+	if (ret < 0) {
+		DEVICE_LOG("poll error %d", errno);
 
-		int poll_timeout = 5; // needs to be small enough so that we don't miss RC input data
+	} else if (ret == 0) {
+		/* timeout: no control data, switch to failsafe values */
+		//			PX4_WARN("no PWM: failsafe");
 
-		if (!_run_as_task) {
-			/*
-			 * Adjust actuator topic update rate to keep up with
-			 * the highest servo update rate configured.
-			 *
-			 * We always mix at max rate; some channels may update slower.
-			 */
-			unsigned max_rate = (_pwm_default_rate > _pwm_alt_rate) ? _pwm_default_rate : _pwm_alt_rate;
+	} else {
+		perf_begin(_ctl_latency);
 
-			if (_current_update_rate != max_rate) {
-				_current_update_rate = max_rate;
-				int update_rate_in_ms = int(1000 / _current_update_rate);
+		if (_mixers != nullptr) {
+			/* get controls for required topics */
+			unsigned poll_id = 0;
 
-				/* reject faster than 500 Hz updates */
-				if (update_rate_in_ms < 2) {
-					update_rate_in_ms = 2;
-				}
+			for (unsigned i = 0; i < actuator_controls_s::NUM_ACTUATOR_CONTROL_GROUPS; i++) {
+				if (_control_subs[i] > 0) {
 
-				/* reject slower than 10 Hz updates */
-				if (update_rate_in_ms > 100) {
-					update_rate_in_ms = 100;
-				}
-
-				PX4_DEBUG("adjusted actuator update interval to %ums", update_rate_in_ms);
+					if (_poll_fds[poll_id].revents & POLLIN) {
+						if (i == 0) {
+							n_updates++;
+						}
 
-				for (unsigned i = 0; i < actuator_controls_s::NUM_ACTUATOR_CONTROL_GROUPS; i++) {
-					if (_control_subs[i] > 0) {
-						orb_set_interval(_control_subs[i], update_rate_in_ms);
+						orb_copy(_control_topics[i], _control_subs[i], &_controls[i]);
 					}
+
+					poll_id++;
 				}
 
-				// set to current max rate, even if we are actually checking slower/faster
-				_current_update_rate = max_rate;
-			}
+				/* During ESC calibration, we overwrite the throttle value. */
+				if (i == 0 && _armed.in_esc_calibration_mode) {
 
-			/* check if anything updated */
-			poll_timeout = 0;
-		}
+					/* Set all controls to 0 */
+					memset(&_controls[i], 0, sizeof(_controls[i]));
 
-		/* wait for an update */
-		unsigned n_updates = 0;
-		int ret = px4_poll(_poll_fds, _poll_fds_num, poll_timeout);
+					/* except thrust to maximum. */
+					_controls[i].control[actuator_controls_s::INDEX_THROTTLE] = 1.0f;
 
-		/* this would be bad... */
-		if (ret < 0) {
-			DEVICE_LOG("poll error %d", errno);
+					/* Switch off the PWM limit ramp for the calibration. */
+					_pwm_limit.state = PWM_LIMIT_STATE_ON;
+				}
+			}
+		}
+	} // poll_fds
 
-		} else if (ret == 0) {
-			/* timeout: no control data, switch to failsafe values */
-			//			PX4_WARN("no PWM: failsafe");
+	/* run the mixers on every cycle */
+	{
+		if (_mixers != nullptr) {
 
-		} else {
-			perf_begin(_ctl_latency);
+			if (_mot_t_max > FLT_EPSILON) {
+				hrt_abstime now = hrt_absolute_time();
+				float dt = (now - _time_last_mix) / 1e6f;
+				_time_last_mix = now;
 
-			if (_mixers != nullptr) {
-				/* get controls for required topics */
-				unsigned poll_id = 0;
+				if (dt < 0.0001f) {
+					dt = 0.0001f;
 
-				for (unsigned i = 0; i < actuator_controls_s::NUM_ACTUATOR_CONTROL_GROUPS; i++) {
-					if (_control_subs[i] > 0) {
+				} else if (dt > 0.02f) {
+					dt = 0.02f;
+				}
 
-						if (_poll_fds[poll_id].revents & POLLIN) {
-							if (i == 0) {
-								n_updates++;
-							}
+				// maximum value the outputs of the multirotor mixer are allowed to change in this cycle
+				// factor 2 is needed because actuator outputs are in the range [-1,1]
+				const float delta_out_max = 2.0f * 1000.0f * dt / (_max_pwm[0] - _min_pwm[0]) / _mot_t_max;
+				_mixers->set_max_delta_out_once(delta_out_max);
+			}
 
-							orb_copy(_control_topics[i], _control_subs[i], &_controls[i]);
-						}
+			if (_thr_mdl_fac > FLT_EPSILON) {
+				_mixers->set_thrust_factor(_thr_mdl_fac);
+			}
 
-						poll_id++;
-					}
+			_mixers->set_single_pass(_mot_mix_mode == 1);
 
-					/* During ESC calibration, we overwrite the throttle value. */
-					if (i == 0 && _armed.in_esc_calibration_mode) {
+			/* do mixing */
+			float outputs[_max_actuators];
+			const unsigned mixed_num_outputs = _mixers->mix(outputs, _num_outputs);
 
-						/* Set all controls to 0 */
-						memset(&_controls[i], 0, sizeof(_controls[i]));
+			/* the PWM limit call takes care of out of band errors, NaN and constrains */
+			uint16_t pwm_limited[MAX_ACTUATORS];
 
-						/* except thrust to maximum. */
-						_controls[i].control[actuator_controls_s::INDEX_THROTTLE] = 1.0f;
+			pwm_limit_calc(_throttle_armed, arm_nothrottle(), mixed_num_outputs, _reverse_pwm_mask,
+				       _disarmed_pwm, _min_pwm, _max_pwm, outputs, pwm_limited, &_pwm_limit);
 
-						/* Switch off the PWM limit ramp for the calibration. */
-						_pwm_limit.state = PWM_LIMIT_STATE_ON;
-					}
+			/* overwrite outputs in case of force_failsafe with _failsafe_pwm PWM values */
+			if (_armed.force_failsafe) {
+				for (size_t i = 0; i < mixed_num_outputs; i++) {
+					pwm_limited[i] = _failsafe_pwm[i];
 				}
 			}
-		} // poll_fds
 
-		/* run the mixers on every cycle */
-		{
-			if (_mixers != nullptr) {
-
-				if (_mot_t_max > FLT_EPSILON) {
-					hrt_abstime now = hrt_absolute_time();
-					float dt = (now - _time_last_mix) / 1e6f;
-					_time_last_mix = now;
+			/* overwrite outputs in case of lockdown with disarmed PWM values */
+			if (_armed.lockdown || _armed.manual_lockdown) {
+				for (size_t i = 0; i < mixed_num_outputs; i++) {
+					pwm_limited[i] = _disarmed_pwm[i];
+				}
+			}
 
-					if (dt < 0.0001f) {
-						dt = 0.0001f;
+			/* output to the servos */
+			if (_pwm_initialized) {
+				for (size_t i = 0; i < mixed_num_outputs; i++) {
+#ifdef BOARD_HAS_DSHOT
 
-					} else if (dt > 0.02f) {
-						dt = 0.02f;
+					if (_dshot_mask & (1 << i)) {
+						up_dshot_motor_data_set(i, dshot_throttle(i, pwm_limited[i]), false);
+						continue;
 					}
 
-					// maximum value the outputs of the multirotor mixer are allowed to change in this cycle
-					// factor 2 is needed because actuator outputs are in the range [-1,1]
-					const float delta_out_max = 2.0f * 1000.0f * dt / (_max_pwm[0] - _min_pwm[0]) / _mot_t_max;
-					_mixers->set_max_delta_out_once(delta_out_max);
+#endif
+					up_pwm_servo_set(i, pwm_limited[i]);
 				}
+			}
 
-				if (_thr_mdl_fac > FLT_EPSILON) {
-					_mixers->set_thrust_factor(_thr_mdl_fac);
+			/* Trigger all timer's channels in Oneshot mode to fire
+			 * the oneshots with updated values, and send the DShot frames.
+			 */
+			if (n_updates > 0) {
+				up_pwm_update();
+#ifdef BOARD_HAS_DSHOT
+
+				if (_pwm_initialized && _dshot_mask != 0) {
+					up_dshot_trigger();
 				}
 
-				/* do mixing */
-				float outputs[_max_actuators];
-				const unsigned mixed_num_outputs = _mixers->mix(outputs, _num_outputs);
+#endif
+				_control_latency.set_synchronized(_output_sync_active);
+				_control_latency.update(hrt_absolute_time(), _controls[0].timestamp, _controls[0].timestamp_sample);
+			}
 
-				/* the PWM limit call takes care of out of band errors, NaN and constrains */
-				uint16_t pwm_limited[MAX_ACTUATORS];
+			actuator_outputs_s actuator_outputs = {};
+			actuator_outputs.timestamp = hrt_absolute_time();
+			actuator_outputs.timestamp_sample = _controls[0].timestamp_sample;
+			actuator_outputs.noutputs = mixed_num_outputs;
 
-				pwm_limit_calc(_throttle_armed, arm_nothrottle(), mixed_num_outputs, _reverse_pwm_mask,
-					       _disarmed_pwm, _min_pwm, _max_pwm, outputs, pwm_limited, &_pwm_limit);
+			// zero unused outputs
+			for (size_t i = 0; i < mixed_num_outputs; ++i) {
+				actuator_outputs.output[i] = pwm_limited[i];
+			}
 
-				/* overwrite outputs in case of force_failsafe with _failsafe_pwm PWM values */
-				if (_armed.force_failsafe) {
-					for (size_t i = 0; i < mixed_num_outputs; i++) {
-						pwm_limited[i] = _failsafe_pwm[i];
-					}
-				}
+			orb_publish_auto(ORB_ID(actuator_outputs), &_outputs_pub, &actuator_outputs, &_class_instance, ORB_PRIO_DEFAULT);
 
-				/* overwrite outputs in case of lockdown with disarmed PWM values */
-				if (_armed.lockdown || _armed.manual_lockdown) {
-					for (size_t i = 0; i < mixed_num_outputs; i++) {
-						pwm_limited[i] = _disarmed_pwm[i];
-					}
-				}
+			/* publish mixer status */
+			MultirotorMixer::saturation_status saturation_status;
+			saturation_status.value = _mixers->get_saturation_status();
 
-				/* output to the servos */
-				if (_pwm_initialized) {
-					for (size_t i = 0; i < mixed_num_outputs; i++) {
-						up_pwm_servo_set(i, pwm_limited[i]);
-					}
-				}
+			if (saturation_status.flags.valid) {
+				multirotor_motor_limits_s motor_limits;
+				motor_limits.timestamp = hrt_absolute_time();
+				motor_limits.saturation_status = saturation_status.value;
 
-				/* Trigger all timer's channels in Oneshot mode to fire
-				 * the oneshots with updated values.
-				 */
-				if (n_updates > 0) {
-					up_pwm_update();
-				}
+				orb_publish_auto(ORB_ID(multirotor_motor_limits), &_to_mixer_status, &motor_limits, &_class_instance,
+						 ORB_PRIO_DEFAULT);
+			}
 
-				actuator_outputs_s actuator_outputs = {};
-				actuator_outputs.timestamp = hrt_absolute_time();
-				actuator_outputs.noutputs = mixed_num_outputs;
+			perf_end(_ctl_latency);
+		}
+	}
+}
 
-				// zero unused outputs
-				for (size_t i = 0; i < mixed_num_outputs; ++i) {
-					actuator_outputs.output[i] = pwm_limited[i];
-				}
+void
+PX4FMU::cycle()
+{
+	while (true) {
+
+		if (_groups_subscribed != _groups_required) {
+			subscribe();
+			_groups_subscribed = _groups_required;
+			/* force setting update rate */
+			_current_update_rate = 0;
+		}
+
+		int poll_timeout = 5; // needs to be small enough so that we don't miss RC input data
+
+		if (!_run_as_task) {
+			/*
+			 * Adjust actuator topic update rate to keep up with
+			 * the highest servo update rate configured.
+			 *
+			 * We always mix at max rate; some channels may update slower.
+			 */
+			unsigned max_rate = (_pwm_default_rate > _pwm_alt_rate) ? _pwm_default_rate : _pwm_alt_rate;
 
-				orb_publish_auto(ORB_ID(actuator_outputs), &_outputs_pub, &actuator_outputs, &_class_instance, ORB_PRIO_DEFAULT);
+			if (_current_update_rate != max_rate) {
+				_current_update_rate = max_rate;
+				int update_rate_in_ms = int(1000 / _current_update_rate);
 
-				/* publish mixer status */
-				MultirotorMixer::saturation_status saturation_status;
-				saturation_status.value = _mixers->get_saturation_status();
+				/* reject faster than 500 Hz updates */
+				if (update_rate_in_ms < 2) {
+					update_rate_in_ms = 2;
+				}
 
-				if (saturation_status.flags.valid) {
-					multirotor_motor_limits_s motor_limits;
-					motor_limits.timestamp = hrt_absolute_time();
-					motor_limits.saturation_status = saturation_status.value;
+				/* reject slower than 10 Hz updates */
+				if (update_rate_in_ms > 100) {
+					update_rate_in_ms = 100;
+				}
 
-					orb_publish_auto(ORB_ID(multirotor_motor_limits), &_to_mixer_status, &motor_limits, &_class_instance,
-							 ORB_PRIO_DEFAULT);
+				PX4_DEBUG("adjusted actuator update interval to %ums", update_rate_in_ms);
+
+				for (unsigned i = 0; i < actuator_controls_s::NUM_ACTUATOR_CONTROL_GROUPS; i++) {
+					if (_control_subs[i] > 0) {
+						/* synchronized outputs follow every publication of actuator_controls_0 */
+						orb_set_interval(_control_subs[i], (i == 0 && _output_sync_active) ? 0 : update_rate_in_ms);
+					}
 				}
 
-				perf_end(_ctl_latency);
+				// set to current max rate, even if we are actually checking slower/faster
+				_current_update_rate = max_rate;
 			}
+
+			/* check if anything updated */
+			poll_timeout = 0;
+		}
+
+		/*
+		 * With synchronized outputs the actuator_controls_0 publications trigger the output updates
+		 * (see output_trampoline()). The cycle only takes over if they stop, so that the disarmed
+		 * and failsafe values are still output.
+		 */
+		if (!_output_sync_active || hrt_elapsed_time(&_time_last_sync_output) > SYNC_OUTPUT_TIMEOUT) {
+			update_outputs(poll_timeout);
 		}
 
 		_cycle_timestamp = hrt_absolute_time();
@@ -1787,8 +1925,61 @@ void PX4FMU::update_params()
 	if (param_handle != PARAM_INVALID) {
 		param_get(param_handle, &_thr_mdl_fac);
 	}
+
+	// multirotor mixer mode
+	param_handle = param_find("MOT_MIX_MODE");
+
+	if (param_handle != PARAM_INVALID) {
+		param_get(param_handle, &_mot_mix_mode);
+	}
+
+	// synchronized outputs
+	param_handle = param_find("PWM_OUT_SYNC");
+
+	if (param_handle != PARAM_INVALID) {
+		param_get(param_handle, &_pwm_out_sync);
+	}
+
+	// DShot (applied when the outputs are initialized)
+	param_handle = param_find("DSHOT_CONFIG");
+
+	if (param_handle != PARAM_INVALID) {
+		param_get(param_handle, &_dshot_config);
+	}
+
+	update_output_sync();
 }
 
+void PX4FMU::update_output_sync()
+{
+	/* a task polls on the controls anyway */
+	const bool sync = (_pwm_out_sync != 0) && !_run_as_task;
+
+	if (sync == _output_sync_active) {
+		return;
+	}
+
+	if (sync && _controls_callback == nullptr) {
+		_controls_callback = new uORB::SubscriptionCallback(ORB_ID(actuator_controls_0),
+				(worker_t)&PX4FMU::output_trampoline, this, HPWORK);
+	}
+
+	if (_controls_callback == nullptr) {
+		_output_sync_active = false;
+		return;
+	}
+
+	if (sync) {
+		_output_sync_active = _controls_callback->register_callback();
+
+	} else {
+		_controls_callback->unregister_callback();
+		_output_sync_active = false;
+	}
+
+	/* reapply the subscription intervals */
+	_current_update_rate = 0;
+}
 
 int
 PX4FMU::control_callback(uintptr_t handle,
@@ -2531,6 +2722,7 @@ PX4FMU::pwm_ioctl(file *filp, int cmd, unsigned long arg)
 
 				_mixers->add_mixer(mixer);
 				_mixers->groups_required(_groups_required);
+				_mixers->compile();
 			}
 
 			break;
@@ -2564,6 +2756,40 @@ PX4FMU::pwm_ioctl(file *filp, int cmd, unsigned long arg)
 					_mixers->groups_required(_groups_required);
 					PX4_DEBUG("loaded mixers \n%s\n", buf);
 					update_pwm_trims();
+					_mixers->compile();
+				}
+			}
+
+			break;
+		}
+
+	case MIXERIOCLOADBIN: {
+			const mixer_binary_buf_s *binary = (const mixer_binary_buf_s *)arg;
+
+			if (_mixers == nullptr) {
+				_mixers = new MixerGroup(control_callback, (uintptr_t)_controls);
+			}
+
+			if (_mixers == nullptr) {
+				_groups_required = 0;
+				ret = -ENOMEM;
+
+			} else {
+
+				ret = _mixers->load_from_binary(binary->buf, binary->buflen);
+
+				if (ret != 0) {
+					PX4_DEBUG("binary mixer load failed with %d", ret);
+					delete _mixers;
+					_mixers = nullptr;
+					_groups_required = 0;
+					ret = -EINVAL;
+
+				} else {
+
+					_mixers->groups_required(_groups_required);
+					update_pwm_trims();
+					_mixers->compile();
 				}
 			}
 
@@ -3528,6 +3754,7 @@ int PX4FMU::print_status()
 
 	if (!_run_as_task) {
 		PX4_INFO("Max update rate: %i Hz", _current_update_rate);
+		PX4_INFO("Outputs synchronized with actuator_controls_0: %s", _output_sync_active ? "yes" : "no");
 	}
 
 	PX4_INFO("RC scan state: %s", RC_SCAN_STRING[_rc_scan_state]);
@@ -3569,6 +3796,10 @@ int PX4FMU::print_status()
 		PX4_INFO("PWM Mode: %s", mode_str);
 	}
 
+	if (_dshot_mask != 0) {
+		PX4_INFO("DShot%i outputs: 0x%x", (int)_dshot_config, (unsigned)_dshot_mask);
+	}
+
 	return 0;
 }
 
@@ -196,6 +196,53 @@ PARAM_DEFINE_FLOAT(THR_MDL_FAC, 0.0f);
  */
 PARAM_DEFINE_FLOAT(MOT_SLEW_MAX, 0.0f);
 
+/**
+ * Multirotor mixer mode
+ *
+ * The single-pass mixer computes the same outputs as the reference mixer as long as
+ * yaw does not saturate. When it does, yaw is limited to the range that keeps all
+ * outputs within their limits, instead of being corrected motor by motor.
+ * It is cheaper, see the mixer_bench command.
+ *
+ * @value 0 Reference
+ * @value 1 Single-pass
+ * @group PWM Outputs
+ */
+PARAM_DEFINE_INT32(MOT_MIX_MODE, 0);
+
+/**
+ * Synchronize the outputs with the actuator controls
+ *
+ * If enabled, each publication of actuator_controls_0 immediately triggers the mixing and the
+ * output update (including the Oneshot pulses) on the work queue, instead of waiting for the
+ * next fixed-rate cycle. This makes the latency from the sensor sample to the pulse short and
+ * constant. The output rate then follows the rate of the controller.
+ * The latency is published in the output_latency topic.
+ *
+ * Has no effect if the FMU runs as a task (SYS_FMU_TASK), which polls on the controls anyway.
+ *
+ * @boolean
+ * @group PWM Outputs
+ */
+PARAM_DEFINE_INT32(PWM_OUT_SYNC, 0);
+
+/**
+ * Configure DShot
+ *
+ * Use the digital DShot protocol instead of PWM on the FMU outputs that support it
+ * (on Pixracer: MAIN 1-4). The PWM_MIN and PWM_MAX range is mapped to the DShot throttle
+ * range, and the motors are stopped when disarmed.
+ * The ESCs do not need to be calibrated.
+ *
+ * @value 0 Disable (use PWM)
+ * @value 150 DShot150
+ * @value 300 DShot300
+ * @value 600 DShot600
+ * @reboot_required true
+ * @group PWM Outputs
+ */
+PARAM_DEFINE_INT32(DSHOT_CONFIG, 0);
+
 /**
  * Run the FMU as a task to reduce latency
  *
@@ -55,10 +55,10 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <math.h>
-#include <crc32.h>
 
 #include <arch/board/board.h>
 
+#include <drivers/device/control_latency.h>
 #include <drivers/device/device.h>
 #include <drivers/drv_rc_input.h>
 #include <drivers/drv_pwm_output.h>
@@ -73,6 +73,7 @@
 #include <systemlib/systemlib.h>
 #include <systemlib/param/param.h>
 #include <systemlib/circuit_breaker.h>
+#include <systemlib/crc.h>
 #include <systemlib/mavlink_log.h>
 #include <systemlib/battery.h>
 
@@ -106,6 +107,7 @@
 #define UPDATE_INTERVAL_MIN		2			// 2 ms	-> 500 Hz
 #define ORB_CHECK_INTERVAL		200000		// 200 ms -> 5 Hz
 #define IO_POLL_INTERVAL		20000		// 20 ms -> 50 Hz
+#define IO_BATCH_MAX_TRANSFERS		8		// per cycle: 4 control groups and the 4 status reads
 
 /**
  * The PX4IO class.
@@ -255,6 +257,11 @@ private:
 	perf_counter_t		_perf_write;		///< local performance counter for PWM control writes
 	perf_counter_t		_perf_sample_latency;	///< total system latency (based on passed-through timestamp)
 
+	ControlLatency		_control_latency;	///< latency statistics of the controls sent to IO
+	hrt_abstime		_controls_timestamp;	///< actuator_controls_0.timestamp of the last controls sent to IO
+	hrt_abstime		_controls_timestamp_sample;	///< actuator_controls_0.timestamp_sample of the last controls sent to IO
+	bool			_controls_queued;	///< new actuator_controls_0 are queued for the next io_batch_flush()
+
 	/* cached IO state */
 	uint16_t		_status;		///< Various IO status flags
 	uint16_t		_alarms;		///< Various IO alarms
@@ -306,6 +313,10 @@ private:
 	float			_last_throttle; ///< last throttle value for battery calculation
 	bool			_test_fmu_fail; ///< To test what happens if IO looses FMU
 
+	px4io_transfer_s	_batch[IO_BATCH_MAX_TRANSFERS]; ///< register transfers queued for io_batch_flush()
+	unsigned		_batch_count;
+	uint16_t		_control_regs[actuator_controls_s::NUM_ACTUATOR_CONTROL_GROUPS][PX4IO_PROTOCOL_MAX_CONTROL_COUNT];
+
 	/**
 	 * Trampoline to the worker task
 	 */
@@ -317,15 +328,36 @@ private:
 	void			task_main();
 
 	/**
-	 * Send controls for one group to IO
+	 * Queue the controls for one group to be sent to IO with the next io_batch_flush()
 	 */
 	int			io_set_control_state(unsigned group);
 
 	/**
-	 * Send all controls to IO
+	 * Queue all controls to be sent to IO with the next io_batch_flush()
 	 */
 	int			io_set_control_groups();
 
+	/**
+	 * Fetch status, alarms, raw RC input and PWM outputs from IO in one batch (together with
+	 * the queued controls), and handle them.
+	 */
+	int			io_poll();
+
+	/**
+	 * Queue a register transfer for the next io_batch_flush().
+	 * The values must stay valid until then.
+	 *
+	 * @return		The transfer (with the result after the flush), or nullptr if the batch is full.
+	 */
+	px4io_transfer_s	*io_batch_add(bool write, uint8_t page, uint8_t offset, uint16_t *values, unsigned num_values);
+
+	/**
+	 * Send the queued register transfers to IO back-to-back.
+	 *
+	 * @return		OK if all transfers succeeded.
+	 */
+	int			io_batch_flush();
+
 	/**
 	 * Update IO's arming-related state
 	 */
@@ -340,8 +372,10 @@ private:
 	 * Fetch status and alarms from IO
 	 *
 	 * Also publishes battery voltage/current.
+	 *
+	 * @param regs		The status registers if they are already fetched, nullptr to read them.
 	 */
-	int			io_get_status();
+	int			io_get_status(const uint16_t *regs = nullptr);
 
 	/**
 	 * Disable RC input handling
@@ -352,19 +386,27 @@ private:
 	 * Fetch RC inputs from IO.
 	 *
 	 * @param input_rc	Input structure to populate.
+	 * @param prefetched	The first io_rc_prefetch_count registers if they are already fetched,
+	 *			nullptr to read them.
 	 * @return		OK if data was returned.
 	 */
-	int			io_get_raw_rc_input(rc_input_values &input_rc);
+	int			io_get_raw_rc_input(rc_input_values &input_rc, const uint16_t *prefetched = nullptr);
+	static const unsigned	io_rc_prefetch_count = (PX4IO_P_RAW_RC_BASE - PX4IO_P_RAW_RC_COUNT) + 9;
 
 	/**
 	 * Fetch and publish raw RC input data.
+	 *
+	 * @param regs		see io_get_raw_rc_input()
 	 */
-	int			io_publish_raw_rc();
+	int			io_publish_raw_rc(const uint16_t *regs = nullptr);
 
 	/**
 	 * Fetch and publish the PWM servo outputs.
+	 *
+	 * @param servos	The servo registers if they are already fetched, nullptr to read them.
+	 * @param mixer_status	The mixer status register if it is already fetched.
 	 */
-	int			io_publish_pwm_outputs();
+	int			io_publish_pwm_outputs(const uint16_t *servos = nullptr, const uint16_t *mixer_status = nullptr);
 
 	/**
 	 * write register(s)
@@ -489,6 +531,10 @@ PX4IO::PX4IO(device::Device *interface) :
 	_perf_update(perf_alloc(PC_ELAPSED, "io update")),
 	_perf_write(perf_alloc(PC_ELAPSED, "io write")),
 	_perf_sample_latency(perf_alloc(PC_ELAPSED, "io latency")),
+	_control_latency(),
+	_controls_timestamp(0),
+	_controls_timestamp_sample(0),
+	_controls_queued(false),
 	_status(0),
 	_alarms(0),
 	_last_written_arming_s(0),
@@ -527,7 +573,10 @@ PX4IO::PX4IO(device::Device *interface) :
 	_analog_rc_rssi_stable(false),
 	_analog_rc_rssi_volt(-1.0f),
 	_last_throttle(0.0f),
-	_test_fmu_fail(false)
+	_test_fmu_fail(false),
+	_batch{},
+	_batch_count(0),
+	_control_regs{}
 {
 	/* we need this potentially before it could be set in task_main */
 	g_dev = this;
@@ -662,6 +711,7 @@ PX4IO::init()
 	_max_rc_input  = io_reg_get(PX4IO_PAGE_CONFIG, PX4IO_P_CONFIG_RC_INPUT_COUNT);
 
 	if ((_max_actuators < 1) || (_max_actuators > 16) ||
+	    (_max_controls > PX4IO_PROTOCOL_MAX_CONTROL_COUNT) ||
 	    (_max_relays > 32)   ||
 	    (_max_transfer < 16) || (_max_transfer > 255)  ||
 	    (_max_rc_input < 1)  || (_max_rc_input > 255)) {
@@ -993,14 +1043,8 @@ PX4IO::task_main()
 			/* run at 50-250Hz */
 			poll_last = now;
 
-			/* pull status and alarms from IO */
-			io_get_status();
-
-			/* get raw R/C input from IO */
-			io_publish_raw_rc();
-
-			/* fetch PWM outputs from IO */
-			io_publish_pwm_outputs();
+			/* pull status, alarms, raw R/C input and PWM outputs from IO, and send the controls */
+			io_poll();
 
 			/* check updates on uORB topics and handle it */
 			bool updated = false;
@@ -1017,6 +1061,14 @@ PX4IO::task_main()
 			}
 		}
 
+		/* send the controls if they were not sent with the poll */
+		(void)io_batch_flush();
+
+		if (_controls_queued) {
+			_control_latency.update(hrt_absolute_time(), _controls_timestamp, _controls_timestamp_sample);
+			_controls_queued = false;
+		}
+
 		if (now >= orb_check_last + ORB_CHECK_INTERVAL) {
 			/* run at 5Hz */
 			orb_check_last = now;
@@ -1301,7 +1353,7 @@ int
 PX4IO::io_set_control_state(unsigned group)
 {
 	actuator_controls_s	controls;	///< actuator outputs
-	uint16_t 		regs[_max_actuators];
+	uint16_t 		*regs = _control_regs[group];
 
 	/* get controls */
 	bool changed = false;
@@ -1312,7 +1364,12 @@ PX4IO::io_set_control_state(unsigned group)
 
 			if (changed) {
 				orb_copy(ORB_ID(actuator_controls_0), _t_actuator_controls_0, &controls);
-				perf_set_elapsed(_perf_sample_latency, hrt_elapsed_time(&controls.timestamp_sample));
+				if (controls.timestamp_sample != 0) {
+					perf_set_elapsed(_perf_sample_latency, hrt_elapsed_time(&controls.timestamp_sample));
+				}
+
+				_controls_timestamp = controls.timestamp;
+				_controls_timestamp_sample = controls.timestamp_sample;
 			}
 		}
 		break;
@@ -1378,11 +1435,109 @@ PX4IO::io_set_control_state(unsigned group)
 
 	if (!_test_fmu_fail) {
 		/* copy values to registers in IO */
-		return io_reg_set(PX4IO_PAGE_CONTROLS, group * PX4IO_PROTOCOL_MAX_CONTROL_COUNT, regs, _max_controls);
+		if (io_batch_add(true, PX4IO_PAGE_CONTROLS, group * PX4IO_PROTOCOL_MAX_CONTROL_COUNT, regs, _max_controls) == nullptr) {
+			return -ENOSPC;
+		}
 
-	} else {
+		_controls_queued = _controls_queued || (group == 0 && changed);
+	}
+
+	return OK;
+}
+
+int
+PX4IO::io_poll()
+{
+	uint16_t status_regs[6];
+	uint16_t rc_regs[io_rc_prefetch_count];
+	uint16_t servo_regs[_max_actuators];
+	uint16_t mixer_status;
+
+	/* the controls queued before are sent first */
+	px4io_transfer_s *status = io_batch_add(false, PX4IO_PAGE_STATUS, PX4IO_P_STATUS_FLAGS, status_regs,
+					       sizeof(status_regs) / sizeof(status_regs[0]));
+	px4io_transfer_s *rc = io_batch_add(false, PX4IO_PAGE_RAW_RC_INPUT, PX4IO_P_RAW_RC_COUNT, rc_regs,
+					    io_rc_prefetch_count);
+	px4io_transfer_s *servos = io_batch_add(false, PX4IO_PAGE_SERVOS, 0, servo_regs, _max_actuators);
+	px4io_transfer_s *mixer = io_batch_add(false, PX4IO_PAGE_STATUS, PX4IO_P_STATUS_MIXER, &mixer_status, 1);
+
+	int ret = io_batch_flush();
+
+	/* handle the status first, the RC input depends on it */
+	if (status != nullptr && status->result == OK) {
+		io_get_status(status_regs);
+	}
+
+	if (rc != nullptr && rc->result == OK) {
+		io_publish_raw_rc(rc_regs);
+	}
+
+	if (servos != nullptr && servos->result == OK && mixer != nullptr && mixer->result == OK) {
+		io_publish_pwm_outputs(servo_regs, &mixer_status);
+	}
+
+	return ret;
+}
+
+px4io_transfer_s *
+PX4IO::io_batch_add(bool write, uint8_t page, uint8_t offset, uint16_t *values, unsigned num_values)
+{
+	/* range check the transfer */
+	if (num_values > ((_max_transfer) / sizeof(*values))) {
+		DEVICE_DEBUG("io_batch_add: too many registers (%u, max %u)", num_values, _max_transfer / 2);
+		return nullptr;
+	}
+
+	if (_batch_count >= IO_BATCH_MAX_TRANSFERS) {
+		DEVICE_DEBUG("io_batch_add: batch full");
+		return nullptr;
+	}
+
+	px4io_transfer_s &transfer = _batch[_batch_count++];
+	transfer.values = values;
+	transfer.address = (page << 8) | offset;
+	transfer.count = num_values;
+	transfer.write = write;
+	transfer.result = -EIO;
+
+	return &transfer;
+}
+
+int
+PX4IO::io_batch_flush()
+{
+	if (_batch_count == 0) {
 		return OK;
 	}
+
+	px4io_batch_s batch = { _batch, _batch_count };
+	unsigned arg = (uintptr_t)&batch;
+
+	int ret = _interface->ioctl(PX4IO_INTERFACE_BATCH, arg);
+
+	if (ret == -ENODEV) {
+		/* the interface does not support batches, do one transfer after the other */
+		ret = OK;
+
+		for (unsigned i = 0; i < _batch_count; i++) {
+			px4io_transfer_s &transfer = _batch[i];
+			int result = transfer.write ? _interface->write(transfer.address, transfer.values, transfer.count) :
+				     _interface->read(transfer.address, transfer.values, transfer.count);
+			transfer.result = (result == (int)transfer.count) ? OK : result;
+
+			if (transfer.result != OK) {
+				ret = transfer.result;
+			}
+		}
+	}
+
+	if (ret != OK) {
+		DEVICE_DEBUG("io_batch_flush(%u): error %d", _batch_count, ret);
+	}
+
+	_batch_count = 0;
+
+	return ret;
 }
 
 
@@ -1754,19 +1909,23 @@ PX4IO::io_handle_vservo(uint16_t vservo, uint16_t vrssi)
 }
 
 int
-PX4IO::io_get_status()
+PX4IO::io_get_status(const uint16_t *regs)
 {
-	uint16_t	regs[6];
-	int		ret;
+	uint16_t	status_regs[6];
+	int		ret = OK;
 
 	/* get
 	 * STATUS_FLAGS, STATUS_ALARMS, STATUS_VBATT, STATUS_IBATT,
 	 * STATUS_VSERVO, STATUS_VRSSI, STATUS_PRSSI
 	 * in that order */
-	ret = io_reg_get(PX4IO_PAGE_STATUS, PX4IO_P_STATUS_FLAGS, &regs[0], sizeof(regs) / sizeof(regs[0]));
+	if (regs == nullptr) {
+		ret = io_reg_get(PX4IO_PAGE_STATUS, PX4IO_P_STATUS_FLAGS, &status_regs[0], sizeof(status_regs) / sizeof(status_regs[0]));
 
-	if (ret != OK) {
-		return ret;
+		if (ret != OK) {
+			return ret;
+		}
+
+		regs = status_regs;
 	}
 
 	io_handle_status(regs[0]);
@@ -1778,7 +1937,7 @@ PX4IO::io_get_status()
 }
 
 int
-PX4IO::io_get_raw_rc_input(rc_input_values &input_rc)
+PX4IO::io_get_raw_rc_input(rc_input_values &input_rc, const uint16_t *prefetched)
 {
 	uint32_t channel_count;
 	int	ret;
@@ -1794,10 +1953,16 @@ PX4IO::io_get_raw_rc_input(rc_input_values &input_rc)
 	 *
 	 * This should be the common case (9 channel R/C control being a reasonable upper bound).
 	 */
-	ret = io_reg_get(PX4IO_PAGE_RAW_RC_INPUT, PX4IO_P_RAW_RC_COUNT, &regs[0], prolog + 9);
+	if (prefetched != nullptr) {
+		memcpy(regs, prefetched, io_rc_prefetch_count * sizeof(regs[0]));
+		ret = OK;
 
-	if (ret != OK) {
-		return ret;
+	} else {
+		ret = io_reg_get(PX4IO_PAGE_RAW_RC_INPUT, PX4IO_P_RAW_RC_COUNT, &regs[0], io_rc_prefetch_count);
+
+		if (ret != OK) {
+			return ret;
+		}
 	}
 
 	/*
@@ -1876,7 +2041,7 @@ PX4IO::io_get_raw_rc_input(rc_input_values &input_rc)
 }
 
 int
-PX4IO::io_publish_raw_rc()
+PX4IO::io_publish_raw_rc(const uint16_t *regs)
 {
 
 	/* fetch values from IO */
@@ -1885,7 +2050,7 @@ PX4IO::io_publish_raw_rc()
 	/* set the RC status flag ORDER MATTERS! */
 	rc_val.rc_lost = !(_status & PX4IO_P_STATUS_FLAGS_RC_OK);
 
-	int ret = io_get_raw_rc_input(rc_val);
+	int ret = io_get_raw_rc_input(rc_val, regs);
 
 	if (ret != OK) {
 		return ret;
@@ -1926,18 +2091,26 @@ PX4IO::io_publish_raw_rc()
 }
 
 int
-PX4IO::io_publish_pwm_outputs()
+PX4IO::io_publish_pwm_outputs(const uint16_t *servos, const uint16_t *mixer_status)
 {
 	/* get servo values from IO */
 	uint16_t ctl[_max_actuators];
-	int ret = io_reg_get(PX4IO_PAGE_SERVOS, 0, ctl, _max_actuators);
+	int ret = OK;
 
-	if (ret != OK) {
-		return ret;
+	if (servos != nullptr) {
+		memcpy(ctl, servos, sizeof(ctl));
+
+	} else {
+		ret = io_reg_get(PX4IO_PAGE_SERVOS, 0, ctl, _max_actuators);
+
+		if (ret != OK) {
+			return ret;
+		}
 	}
 
 	actuator_outputs_s outputs = {};
 	outputs.timestamp = hrt_absolute_time();
+	outputs.timestamp_sample = _controls_timestamp_sample;
 	outputs.noutputs = _max_actuators;
 
 	/* convert from register format to float */
@@ -1950,10 +2123,16 @@ PX4IO::io_publish_pwm_outputs()
 
 	/* get mixer status flags from IO */
 	MultirotorMixer::saturation_status saturation_status;
-	ret = io_reg_get(PX4IO_PAGE_STATUS, PX4IO_P_STATUS_MIXER, &saturation_status.value, 1);
 
-	if (ret != OK) {
-		return ret;
+	if (mixer_status != nullptr) {
+		saturation_status.value = *mixer_status;
+
+	} else {
+		ret = io_reg_get(PX4IO_PAGE_STATUS, PX4IO_P_STATUS_MIXER, &saturation_status.value, 1);
+
+		if (ret != OK) {
+			return ret;
+		}
 	}
 
 	/* publish mixer status */
@@ -3189,22 +3368,26 @@ checkcrc(int argc, char *argv[])
 	uint32_t fw_crc = 0;
 	uint32_t nbytes = 0;
 
+	uint8_t buf[128];
+
 	while (true) {
-		uint8_t buf[16];
 		int n = read(fd, buf, sizeof(buf));
 
 		if (n <= 0) { break; }
 
-		fw_crc = crc32part(buf, n, fw_crc);
+		fw_crc = crc32_fast(buf, n, fw_crc);
 		nbytes += n;
 	}
 
 	close(fd);
 
+	// pad with erased flash up to the size of the application area
+	memset(buf, 0xff, sizeof(buf));
+
 	while (nbytes < app_size_max) {
-		uint8_t b = 0xff;
-		fw_crc = crc32part(&b, 1, fw_crc);
-		nbytes++;
+		const uint32_t n = (app_size_max - nbytes < sizeof(buf)) ? app_size_max - nbytes : sizeof(buf);
+		fw_crc = crc32_fast(buf, n, fw_crc);
+		nbytes += n;
 	}
 
 	int ret = g_dev->ioctl(nullptr, PX4IO_CHECK_CRC, fw_crc);
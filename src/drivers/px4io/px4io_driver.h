@@ -39,8 +39,31 @@
 
 #pragma once
 
+#include <stdint.h>
 #include <board_config.h>
 
+/**
+ * One register transfer of a batch
+ */
+struct px4io_transfer_s {
+	uint16_t	*values;	///< registers to write, or buffer for the registers read
+	uint16_t	address;	///< page << 8 | offset
+	uint8_t		count;		///< number of registers
+	bool		write;
+	int		result;		///< set by the interface: OK, or <0 on error
+};
+
+struct px4io_batch_s {
+	px4io_transfer_s	*transfers;
+	unsigned		count;
+};
+
+/**
+ * Interface ioctl: execute the transfers of a px4io_batch_s (arg is a pointer to it) back-to-back,
+ * without releasing the bus in between.
+ */
+#define PX4IO_INTERFACE_BATCH	2
+
 #ifdef PX4IO_SERIAL_BASE
 device::Device	*PX4IO_serial_interface();
 #endif
@@ -105,8 +105,11 @@ private:
 	 *
 	 * Maybe we can just send smaller packets (e.g. 8 regs) and loop for larger (less common)
 	 * transfers? Could cause issues with any regs expecting to be written atomically...
+	 *
+	 * There are two buffers, so that the next packet of a batch can be prepared while the
+	 * current one is being exchanged.
 	 */
-	static IOPacket		_dma_buffer;		// XXX static to ensure DMA-able memory
+	static IOPacket		_dma_buffer[2];		// XXX static to ensure DMA-able memory
 
 	DMA_HANDLE		_tx_dma;
 	DMA_HANDLE		_rx_dma;
@@ -116,6 +119,15 @@ private:
 	static const unsigned	_dma_status_waiting  = 0x00000000;
 	volatile unsigned	_rx_dma_status;
 
+	/** packet being exchanged */
+	IOPacket		*volatile _current_packet;
+
+	/** final DMA status of the last exchange of each buffer */
+	volatile unsigned	_packet_status[2];
+
+	/** next packet of a batch, started by the interrupt handler as soon as the current reply is complete */
+	IOPacket		*volatile _next_packet;
+
 	/** bus-ownership lock */
 	px4_sem_t			_bus_semaphore;
 
@@ -123,9 +135,31 @@ private:
 	px4_sem_t			_completion_semaphore;
 
 	/**
-	 * Start the transaction with IO and wait for it to complete.
+	 * Execute register transfers back-to-back, holding the bus.
+	 *
+	 * The request packet of the next transfer is prepared while the current one is exchanged,
+	 * and it is started from the interrupt handler as soon as the reply has been received.
+	 * A transfer that fails is retried (after the packet that was already started), so the
+	 * transfers are completed in order.
+	 *
+	 * @return		OK if all transfers succeeded, the error of the last failed transfer otherwise.
 	 */
-	int			_wait_complete();
+	int			_transfer(px4io_transfer_s *transfers, unsigned count);
+
+	/**
+	 * Fill in the request packet for a transfer, including the CRC.
+	 */
+	void			_prepare_packet(IOPacket *packet, const px4io_transfer_s &transfer);
+
+	/**
+	 * Start the exchange of a prepared packet with IO (also called from the interrupt handler).
+	 */
+	void			_start_exchange(IOPacket *packet);
+
+	/**
+	 * Wait for the exchange of a packet to complete, and check the reply.
+	 */
+	int			_wait_complete(IOPacket *packet);
 
 	/**
 	 * DMA completion handler.
@@ -164,7 +198,7 @@ private:
 
 };
 
-IOPacket PX4IO_serial::_dma_buffer;
+IOPacket PX4IO_serial::_dma_buffer[2];
 static PX4IO_serial *g_interface;
 
 device::Device
@@ -178,6 +212,9 @@ PX4IO_serial::PX4IO_serial() :
 	_tx_dma(nullptr),
 	_rx_dma(nullptr),
 	_rx_dma_status(_dma_status_inactive),
+	_current_packet(&_dma_buffer[0]),
+	_packet_status{},
+	_next_packet(nullptr),
 	_bus_semaphore(SEM_INITIALIZER(0)),
 	_completion_semaphore(SEM_INITIALIZER(0)),
 	_pc_txns(perf_alloc(PC_ELAPSED, "io_txns")),
@@ -373,6 +410,13 @@ PX4IO_serial::ioctl(unsigned operation, unsigned &arg)
 			return 0;
 		}
 
+		break;
+
+	case PX4IO_INTERFACE_BATCH: {
+			px4io_batch_s *batch = reinterpret_cast<px4io_batch_s *>((uintptr_t)arg);
+			return _transfer(batch->transfers, batch->count);
+		}
+
 	default:
 		break;
 	}
@@ -383,52 +427,31 @@ PX4IO_serial::ioctl(unsigned operation, unsigned &arg)
 int
 PX4IO_serial::write(unsigned address, void *data, unsigned count)
 {
-	uint8_t page = address >> 8;
-	uint8_t offset = address & 0xff;
-	const uint16_t *values = reinterpret_cast<const uint16_t *>(data);
-
-	if (count > PKT_MAX_REGS) {
-		return -EINVAL;
-	}
-
-	px4_sem_wait(&_bus_semaphore);
-
-	int result;
-
-	for (unsigned retries = 0; retries < 3; retries++) {
+	px4io_transfer_s transfer = {};
+	transfer.values = reinterpret_cast<uint16_t *>(data);
+	transfer.address = address;
+	transfer.count = count;
+	transfer.write = true;
 
-		_dma_buffer.count_code = count | PKT_CODE_WRITE;
-		_dma_buffer.page = page;
-		_dma_buffer.offset = offset;
-		memcpy((void *)&_dma_buffer.regs[0], (void *)values, (2 * count));
+	int result = _transfer(&transfer, 1);
 
-		for (unsigned i = count; i < PKT_MAX_REGS; i++) {
-			_dma_buffer.regs[i] = 0x55aa;
-		}
-
-		/* XXX implement check byte */
-
-		/* start the transaction and wait for it to complete */
-		result = _wait_complete();
-
-		/* successful transaction? */
-		if (result == OK) {
-
-			/* check result in packet */
-			if (PKT_CODE(_dma_buffer) == PKT_CODE_ERROR) {
-
-				/* IO didn't like it - no point retrying */
-				result = -EINVAL;
-				perf_count(_pc_protoerrs);
-			}
+	if (result == OK) {
+		result = count;
+	}
 
-			break;
-		}
+	return result;
+}
 
-		perf_count(_pc_retries);
-	}
+int
+PX4IO_serial::read(unsigned address, void *data, unsigned count)
+{
+	px4io_transfer_s transfer = {};
+	transfer.values = reinterpret_cast<uint16_t *>(data);
+	transfer.address = address;
+	transfer.count = count;
+	transfer.write = false;
 
-	px4_sem_post(&_bus_semaphore);
+	int result = _transfer(&transfer, 1);
 
 	if (result == OK) {
 		result = count;
@@ -438,82 +461,166 @@ PX4IO_serial::write(unsigned address, void *data, unsigned count)
 }
 
 int
-PX4IO_serial::read(unsigned address, void *data, unsigned count)
+PX4IO_serial::_transfer(px4io_transfer_s *transfers, unsigned count)
 {
-	uint8_t page = address >> 8;
-	uint8_t offset = address & 0xff;
-	uint16_t *values = reinterpret_cast<uint16_t *>(data);
+	for (unsigned i = 0; i < count; i++) {
+		if (transfers[i].count > PKT_MAX_REGS) {
+			return -EINVAL;
+		}
+	}
 
-	if (count > PKT_MAX_REGS) {
-		return -EINVAL;
+	if (count == 0) {
+		return OK;
 	}
 
 	px4_sem_wait(&_bus_semaphore);
 
-	int result;
+	perf_begin(_pc_txns);
+
+	int result = OK;
+	bool timed_out = false;
+	unsigned completed = 0;	// transfers that succeeded or ran out of retries
+	unsigned started = 0;	// transfers that are completed or on the wire
+	unsigned retries = 0;
 
-	for (unsigned retries = 0; retries < 3; retries++) {
+	while (completed < count) {
+		IOPacket *packet = &_dma_buffer[completed & 1];
 
-		_dma_buffer.count_code = count | PKT_CODE_READ;
-		_dma_buffer.page = page;
-		_dma_buffer.offset = offset;
+		if (started == completed) {
+			/* nothing on the wire: first transfer, or retry */
+			_prepare_packet(packet, transfers[completed]);
+			_start_exchange(packet);
+			started++;
+		}
 
-		/* start the transaction and wait for it to complete */
-		result = _wait_complete();
+		/* prepare the next packet while this one is exchanged */
+		IOPacket *next = nullptr;
 
-		/* successful transaction? */
-		if (result == OK) {
+		if (started < count) {
+			next = &_dma_buffer[started & 1];
+			_prepare_packet(next, transfers[started]);
+
+			irqstate_t flags = px4_enter_critical_section();
+			_next_packet = next;
+			px4_leave_critical_section(flags);
+		}
+
+		int ret = _wait_complete(packet);
+
+		if (ret == -ETIMEDOUT) {
+			timed_out = true;
+		}
+
+		/* take the next packet back if the interrupt handler did not start it */
+		irqstate_t flags = px4_enter_critical_section();
+		bool next_started = (next != nullptr) && (_next_packet == nullptr);
+		_next_packet = nullptr;
+		px4_leave_critical_section(flags);
+
+		if (ret == OK) {
+			px4io_transfer_s &transfer = transfers[completed];
+			transfer.result = OK;
 
 			/* check result in packet */
-			if (PKT_CODE(_dma_buffer) == PKT_CODE_ERROR) {
+			if (PKT_CODE(*packet) == PKT_CODE_ERROR) {
 
 				/* IO didn't like it - no point retrying */
-				result = -EINVAL;
+				transfer.result = -EINVAL;
 				perf_count(_pc_protoerrs);
 
+			} else if (!transfer.write) {
+
 				/* compare the received count with the expected count */
+				if (PKT_COUNT(*packet) != transfer.count) {
 
-			} else if (PKT_COUNT(_dma_buffer) != count) {
+					/* IO returned the wrong number of registers - no point retrying */
+					transfer.result = -EIO;
+					perf_count(_pc_protoerrs);
 
-				/* IO returned the wrong number of registers - no point retrying */
-				result = -EIO;
-				perf_count(_pc_protoerrs);
+				} else {
 
-				/* successful read */
+					/* copy back the result */
+					memcpy(transfer.values, &packet->regs[0], (2 * transfer.count));
+				}
+			}
+
+			if (transfer.result != OK) {
+				result = transfer.result;
+			}
+
+			completed++;
+			retries = 0;
+
+			if (next != nullptr) {
+				if (!next_started) {
+					_start_exchange(next);
+				}
 
-			} else {
+				started++;
+			}
 
-				/* copy back the result */
-				memcpy(values, &_dma_buffer.regs[0], (2 * count));
+		} else {
+			if (next_started) {
+				/* discard the exchange of the next packet, it is repeated after the retry */
+				(void)_wait_complete(next);
 			}
 
-			break;
+			started = completed;
+			perf_count(_pc_retries);
+
+			if (++retries >= 3) {
+				transfers[completed].result = ret;
+				result = ret;
+				completed++;
+				retries = 0;
+			}
 		}
+	}
 
-		perf_count(_pc_retries);
+	/* update counters */
+	if (timed_out) {
+		perf_cancel(_pc_txns);		/* don't count this as a transaction */
+
+	} else {
+		perf_end(_pc_txns);
 	}
 
 	px4_sem_post(&_bus_semaphore);
 
-	if (result == OK) {
-		result = count;
+	return result;
+}
+
+void
+PX4IO_serial::_prepare_packet(IOPacket *packet, const px4io_transfer_s &transfer)
+{
+	packet->count_code = transfer.count | (transfer.write ? PKT_CODE_WRITE : PKT_CODE_READ);
+	packet->page = transfer.address >> 8;
+	packet->offset = transfer.address & 0xff;
+
+	if (transfer.write) {
+		memcpy((void *)&packet->regs[0], (void *)transfer.values, (2 * transfer.count));
+
+		for (unsigned i = transfer.count; i < PKT_MAX_REGS; i++) {
+			packet->regs[i] = 0x55aa;
+		}
 	}
 
-	return result;
+	packet->crc = 0;
+	packet->crc = crc_packet(packet);
 }
 
-int
-PX4IO_serial::_wait_complete()
+void
+PX4IO_serial::_start_exchange(IOPacket *packet)
 {
 	/* clear any lingering error status */
 	(void)rSR;
 	(void)rDR;
 
 	/* start RX DMA */
-	perf_begin(_pc_txns);
 	perf_begin(_pc_dmasetup);
 
 	/* DMA setup time ~3µs */
+	_current_packet = packet;
 	_rx_dma_status = _dma_status_waiting;
 
 	/*
@@ -528,8 +635,8 @@ PX4IO_serial::_wait_complete()
 	stm32_dmasetup(
 		_rx_dma,
 		PX4IO_SERIAL_BASE + STM32_USART_DR_OFFSET,
-		reinterpret_cast<uint32_t>(&_dma_buffer),
-		sizeof(_dma_buffer),
+		reinterpret_cast<uint32_t>(packet),
+		sizeof(IOPacket),
 		DMA_SCR_CIRC		|	/* XXX see note above */
 		DMA_SCR_DIR_P2M		|
 		DMA_SCR_MINC		|
@@ -542,13 +649,11 @@ PX4IO_serial::_wait_complete()
 
 	/* start TX DMA - no callback if we also expect a reply */
 	/* DMA setup time ~3µs */
-	_dma_buffer.crc = 0;
-	_dma_buffer.crc = crc_packet(&_dma_buffer);
 	stm32_dmasetup(
 		_tx_dma,
 		PX4IO_SERIAL_BASE + STM32_USART_DR_OFFSET,
-		reinterpret_cast<uint32_t>(&_dma_buffer),
-		PKT_SIZE(_dma_buffer),
+		reinterpret_cast<uint32_t>(packet),
+		PKT_SIZE(*packet),
 		DMA_SCR_DIR_M2P		|
 		DMA_SCR_MINC		|
 		DMA_SCR_PSIZE_8BITS	|
@@ -561,7 +666,11 @@ PX4IO_serial::_wait_complete()
 	rCR3 |= USART_CR3_DMAT;
 
 	perf_end(_pc_dmasetup);
+}
 
+int
+PX4IO_serial::_wait_complete(IOPacket *packet)
+{
 	/* compute the deadline for a 10ms timeout */
 	struct timespec abstime;
 	clock_gettime(CLOCK_REALTIME, &abstime);
@@ -580,17 +689,17 @@ PX4IO_serial::_wait_complete()
 
 		if (ret == OK) {
 			/* check for DMA errors */
-			if (_rx_dma_status & DMA_STATUS_TEIF) {
+			if (_packet_status[packet - &_dma_buffer[0]] & DMA_STATUS_TEIF) {
 				perf_count(_pc_dmaerrs);
 				ret = -EIO;
 				break;
 			}
 
 			/* check packet CRC - corrupt packet errors mean IO receive CRC error */
-			uint8_t crc = _dma_buffer.crc;
-			_dma_buffer.crc = 0;
+			uint8_t crc = packet->crc;
+			packet->crc = 0;
 
-			if ((crc != crc_packet(&_dma_buffer)) | (PKT_CODE(_dma_buffer) == PKT_CODE_CORRUPT)) {
+			if ((crc != crc_packet(packet)) | (PKT_CODE(*packet) == PKT_CODE_CORRUPT)) {
 				perf_count(_pc_crcerrs);
 				ret = -EIO;
 				break;
@@ -604,7 +713,10 @@ PX4IO_serial::_wait_complete()
 			/* something has broken - clear out any partial DMA state and reconfigure */
 			_abort_dma();
 			perf_count(_pc_timeouts);
-			perf_cancel(_pc_txns);		/* don't count this as a transaction */
+
+			/* reset DMA status */
+			_rx_dma_status = _dma_status_inactive;
+			ret = -ETIMEDOUT;
 			break;
 		}
 
@@ -612,12 +724,6 @@ PX4IO_serial::_wait_complete()
 		syslog(LOG_ERR, "unexpected ret %d/%d\n", ret, errno);
 	}
 
-	/* reset DMA status */
-	_rx_dma_status = _dma_status_inactive;
-
-	/* update counters */
-	perf_end(_pc_txns);
-
 	return ret;
 }
 
@@ -646,6 +752,7 @@ PX4IO_serial::_do_rx_dma_callback(unsigned status)
 		}
 
 		/* save RX status */
+		_packet_status[_current_packet - &_dma_buffer[0]] = status;
 		_rx_dma_status = status;
 
 		/* disable UART DMA */
@@ -702,9 +809,9 @@ PX4IO_serial::_do_interrupt()
 		if (_rx_dma_status == _dma_status_waiting) {
 
 			/* verify that the received packet is complete */
-			size_t length = sizeof(_dma_buffer) - stm32_dmaresidual(_rx_dma);
+			size_t length = sizeof(IOPacket) - stm32_dmaresidual(_rx_dma);
 
-			if ((length < 1) || (length < PKT_SIZE(_dma_buffer))) {
+			if ((length < 1) || (length < PKT_SIZE(*_current_packet))) {
 				perf_count(_pc_badidle);
 
 				/* stop the receive DMA */
@@ -722,6 +829,13 @@ PX4IO_serial::_do_interrupt()
 
 			/* complete the short reception */
 			_do_rx_dma_callback(DMA_STATUS_TCIF);
+
+			/* start the next packet of a batch right away instead of waiting for the client */
+			if (_next_packet != nullptr && !(_rx_dma_status & DMA_STATUS_TEIF)) {
+				IOPacket *next = _next_packet;
+				_next_packet = nullptr;
+				_start_exchange(next);
+			}
 		}
 	}
 }
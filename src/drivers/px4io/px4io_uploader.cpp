@@ -575,7 +575,7 @@ int
 PX4IO_Uploader::verify_rev3(size_t fw_size_local)
 {
 	int ret;
-	uint8_t	file_buf[4];
+	uint8_t	*file_buf;
 	ssize_t count;
 	uint32_t sum = 0;
 	uint32_t bytes_read = 0;
@@ -594,12 +594,20 @@ PX4IO_Uploader::verify_rev3(size_t fw_size_local)
 		return ret;
 	}
 
+	/* read the file in program sized blocks rather than word by word, the CRC is the same */
+	file_buf = new uint8_t[PROG_MULTI_MAX];
+
+	if (!file_buf) {
+		log("Can't allocate verify buffer");
+		return -ENOMEM;
+	}
+
 	/* read through the firmware file again and calculate the checksum*/
 	while (bytes_read < fw_size_local) {
 		size_t n = fw_size_local - bytes_read;
 
-		if (n > sizeof(file_buf)) {
-			n = sizeof(file_buf);
+		if (n > PROG_MULTI_MAX) {
+			n = PROG_MULTI_MAX;
 		}
 
 		count = read_with_retry(_fw_fd, file_buf, n);
@@ -619,15 +627,19 @@ PX4IO_Uploader::verify_rev3(size_t fw_size_local)
 
 		/* stop if the file cannot be read */
 		if (count < 0) {
-			return -errno;
+			ret = -errno;
+			delete [] file_buf;
+			return ret;
 		}
 
 		/* calculate crc32 sum */
-		sum = crc32part((uint8_t *)&file_buf, sizeof(file_buf), sum);
+		sum = crc32part(file_buf, count, sum);
 
 		bytes_read += count;
 	}
 
+	delete [] file_buf;
+
 	/* fill the rest with 0xff */
 	while (bytes_read < fw_size_remote) {
 		sum = crc32part(&fill_blank, sizeof(fill_blank), sum);
@@ -0,0 +1,230 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2017 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/*
+ * @file drv_dshot.c
+ *
+ * DShot digital ESC protocol output on STM32 timer blocks.
+ *
+ * Each frame is 16 bits (11 bit throttle, telemetry request, 4 bit checksum), sent MSB first.
+ * The pulse widths of all bits are precomputed into a buffer, which is written to the CCR registers
+ * of the timer by a DMA burst on every update event. This needs one DMA stream per timer
+ * (io_timers_t::dshot_dmamap), and all channels of a timer have to be used for DShot.
+ */
+
+#include <px4_config.h>
+#include <nuttx/arch.h>
+#include <nuttx/irq.h>
+
+#include <sys/types.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <string.h>
+
+#include <arch/board/board.h>
+#include <drivers/drv_pwm_output.h>
+
+#include "drv_io_timer.h"
+
+#if defined(BOARD_HAS_DSHOT)
+
+#include <stm32_dma.h>
+#include <stm32_tim.h>
+
+#define DSHOT_MOTOR_PWM_BIT_1		14u
+#define DSHOT_MOTOR_PWM_BIT_0		7u
+#define DSHOT_FRAME_BITS		16u
+#define DSHOT_END_OF_FRAME_BITS		2u /* low bits at the end, so that the line stays low between frames */
+#define DSHOT_BURST_LENGTH		4u /* CCR1..CCR4 */
+#define DSHOT_BUFFER_SIZE		((DSHOT_FRAME_BITS + DSHOT_END_OF_FRAME_BITS) * DSHOT_BURST_LENGTH)
+#define DSHOT_MAX_THROTTLE		2047u
+
+#define DSHOT_DMA_SCR (DMA_SCR_PRIVERYHI | DMA_SCR_MSIZE_32BITS | DMA_SCR_PSIZE_32BITS | DMA_SCR_MINC | DMA_SCR_DIR_M2P)
+
+typedef struct dshot_handler_t {
+	DMA_HANDLE	dma_handle;
+	bool		init;
+} dshot_handler_t;
+
+static dshot_handler_t dshot_handler[MAX_IO_TIMERS] = {};
+
+/* per timer: one burst of DSHOT_BURST_LENGTH CCR values per bit */
+static uint32_t dshot_burst_buffer[MAX_IO_TIMERS][DSHOT_BUFFER_SIZE];
+
+static uint32_t dshot_channels = 0;
+
+int up_dshot_init(uint32_t channel_mask, unsigned dshot_pwm_freq)
+{
+	/* First free the current set of DShot channels */
+
+	uint32_t current = io_timer_get_mode_channels(IOTimerChanMode_Dshot);
+
+	for (unsigned channel = 0; current != 0 && channel < MAX_TIMER_IO_CHANNELS; channel++) {
+		if (current & (1 << channel)) {
+			io_timer_free_channel(channel);
+			current &= ~(1 << channel);
+		}
+	}
+
+	dshot_channels = 0;
+
+	for (unsigned timer = 0; timer < MAX_IO_TIMERS; timer++) {
+		uint32_t timer_channels = io_timer_get_group(timer);
+
+		/* a timer is only used if it supports DShot and all of its channels are requested */
+
+		if (io_timers[timer].base == 0 || io_timers[timer].dshot_dmamap == 0 ||
+		    timer_channels == 0 || (timer_channels & channel_mask) != timer_channels) {
+			continue;
+		}
+
+		int ret = 0;
+
+		for (unsigned channel = 0; ret == 0 && channel < MAX_TIMER_IO_CHANNELS; channel++) {
+			if (timer_channels & (1 << channel)) {
+
+				/* First free any that were not DShot mode before */
+
+				if (-EBUSY == io_timer_is_channel_free(channel)) {
+					io_timer_free_channel(channel);
+				}
+
+				ret = io_timer_channel_init(channel, IOTimerChanMode_Dshot, NULL, NULL);
+			}
+		}
+
+		if (ret == 0) {
+			ret = io_timer_set_dshot_mode(timer, dshot_pwm_freq, DSHOT_BURST_LENGTH);
+		}
+
+		if (ret != 0) {
+			for (unsigned channel = 0; channel < MAX_TIMER_IO_CHANNELS; channel++) {
+				if (timer_channels & (1 << channel)) {
+					io_timer_free_channel(channel);
+				}
+			}
+
+			continue;
+		}
+
+		if (!dshot_handler[timer].init) {
+			/* the stream is reserved for good, it must not be assigned to any other peripheral */
+			dshot_handler[timer].dma_handle = stm32_dmachannel(io_timers[timer].dshot_dmamap);
+
+			if (dshot_handler[timer].dma_handle == NULL) {
+				continue;
+			}
+
+			dshot_handler[timer].init = true;
+		}
+
+		/* all outputs low: also makes sure the end of frame bits are 0 */
+		memset(dshot_burst_buffer[timer], 0, sizeof(dshot_burst_buffer[timer]));
+
+		dshot_channels |= timer_channels;
+	}
+
+	return dshot_channels;
+}
+
+/**
+ * Build a DShot frame: 11 bit throttle, telemetry request bit and the XOR of the 3 nibbles
+ */
+static uint16_t dshot_packet(uint16_t throttle, bool telemetry)
+{
+	uint16_t packet = (throttle << 1) | (telemetry ? 1 : 0);
+	unsigned checksum = 0;
+	unsigned data = packet;
+
+	for (unsigned i = 0; i < 3; i++) {
+		checksum ^= data;
+		data >>= 4;
+	}
+
+	return (packet << 4) | (checksum & 0xf);
+}
+
+void up_dshot_motor_data_set(unsigned channel, uint16_t throttle, bool telemetry)
+{
+	if (channel >= MAX_TIMER_IO_CHANNELS || (dshot_channels & (1 << channel)) == 0) {
+		return;
+	}
+
+	if (throttle > DSHOT_MAX_THROTTLE) {
+		throttle = DSHOT_MAX_THROTTLE;
+	}
+
+	uint16_t packet = dshot_packet(throttle, telemetry);
+	uint32_t *buffer = dshot_burst_buffer[timer_io_channels[channel].timer_index];
+	unsigned ccr_index = timer_io_channels[channel].timer_channel - 1;
+
+	for (unsigned bit = 0; bit < DSHOT_FRAME_BITS; bit++) {
+		buffer[bit * DSHOT_BURST_LENGTH + ccr_index] =
+			(packet & (0x8000 >> bit)) ? DSHOT_MOTOR_PWM_BIT_1 : DSHOT_MOTOR_PWM_BIT_0;
+	}
+}
+
+void up_dshot_trigger(void)
+{
+	for (unsigned timer = 0; timer < MAX_IO_TIMERS; timer++) {
+		if (!dshot_handler[timer].init || (io_timer_get_group(timer) & dshot_channels) == 0) {
+			continue;
+		}
+
+		/* skip the timer if the previous frame is still being sent */
+
+		if (stm32_dmaresidual(dshot_handler[timer].dma_handle) > 0) {
+			continue;
+		}
+
+		io_timer_update_dma_req(timer, false);
+
+		stm32_dmasetup(dshot_handler[timer].dma_handle,
+			       io_timers[timer].base + STM32_GTIM_DMAR_OFFSET,
+			       (uint32_t)dshot_burst_buffer[timer],
+			       DSHOT_BUFFER_SIZE,
+			       DSHOT_DMA_SCR);
+
+		/* the frame is sent on the next update events, no completion callback is needed */
+		stm32_dmastart(dshot_handler[timer].dma_handle, NULL, NULL, false);
+
+		io_timer_update_dma_req(timer, true);
+	}
+}
+
+int up_dshot_arm(bool armed)
+{
+	return io_timer_set_enable(armed, IOTimerChanMode_Dshot, IO_TIMER_ALL_MODES_CHANNELS);
+}
+
+#endif /* BOARD_HAS_DSHOT */
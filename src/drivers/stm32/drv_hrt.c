@@ -61,6 +61,8 @@
 
 #include <board_config.h>
 #include <drivers/drv_hrt.h>
+#include <drivers/drv_hrt_callout_queue.h>
+#include <systemlib/trace.h>
 
 
 #include "stm32_gpio.h"
@@ -247,7 +249,7 @@
 /*
  * Queue of callout entries.
  */
-static struct sq_queue_s	callout_queue;
+static struct hrt_callout_queue	callout_queue;
 
 /* latency baseline (last compare value applied) */
 static uint16_t			latency_baseline;
@@ -757,7 +759,7 @@ hrt_store_absolute_time(volatile hrt_abstime *now)
 void
 hrt_init(void)
 {
-	sq_init(&callout_queue);
+	hrt_callout_queue_init(&callout_queue);
 	hrt_tim_init();
 
 #ifdef HRT_PPM_CHANNEL
@@ -807,16 +809,7 @@ hrt_call_internal(struct hrt_call *entry, hrt_abstime deadline, hrt_abstime inte
 	irqstate_t flags = px4_enter_critical_section();
 
 	/* if the entry is currently queued, remove it */
-	/* note that we are using a potentially uninitialised
-	   entry->link here, but it is safe as sq_rem() doesn't
-	   dereference the passed node unless it is found in the
-	   list. So we potentially waste a bit of time searching the
-	   queue for the uninitialised entry->link but we don't do
-	   anything actually unsafe.
-	*/
-	if (entry->deadline != 0) {
-		sq_rem(&entry->link, &callout_queue);
-	}
+	hrt_callout_queue_remove(&callout_queue, entry);
 
 	entry->deadline = deadline;
 	entry->period = interval;
@@ -847,7 +840,7 @@ hrt_cancel(struct hrt_call *entry)
 {
 	irqstate_t flags = px4_enter_critical_section();
 
-	sq_rem(&entry->link, &callout_queue);
+	hrt_callout_queue_remove(&callout_queue, entry);
 	entry->deadline = 0;
 
 	/* if this is a periodic call being removed by the callout, prevent it from
@@ -858,32 +851,26 @@ hrt_cancel(struct hrt_call *entry)
 	px4_leave_critical_section(flags);
 }
 
-static void
-hrt_call_enter(struct hrt_call *entry)
+/**
+ * Get the callout statistics.
+ */
+void
+hrt_callout_stats_get(struct hrt_callout_stats *stats, bool reset)
 {
-	struct hrt_call	*call, *next;
+	irqstate_t flags = px4_enter_critical_section();
 
-	call = (struct hrt_call *)sq_peek(&callout_queue);
+	hrt_callout_queue_stats(&callout_queue, stats, reset);
 
-	if ((call == NULL) || (entry->deadline < call->deadline)) {
-		sq_addfirst(&entry->link, &callout_queue);
-		hrtinfo("call enter at head, reschedule\n");
+	px4_leave_critical_section(flags);
+}
+
+static void
+hrt_call_enter(struct hrt_call *entry)
+{
+	if (hrt_callout_queue_insert(&callout_queue, entry)) {
 		/* we changed the next deadline, reschedule the timer event */
 		hrt_call_reschedule();
-
-	} else {
-		do {
-			next = (struct hrt_call *)sq_next(&call->link);
-
-			if ((next == NULL) || (entry->deadline < next->deadline)) {
-				hrtinfo("call enter after head\n");
-				sq_addafter(&call->link, &entry->link, &callout_queue);
-				break;
-			}
-		} while ((call = next) != NULL);
 	}
-
-	hrtinfo("scheduled\n");
 }
 
 static void
@@ -896,19 +883,12 @@ hrt_call_invoke(void)
 		/* get the current time */
 		hrt_abstime now = hrt_absolute_time();
 
-		call = (struct hrt_call *)sq_peek(&callout_queue);
+		call = hrt_callout_queue_pop_expired(&callout_queue, now);
 
 		if (call == NULL) {
 			break;
 		}
 
-		if (call->deadline > now) {
-			break;
-		}
-
-		sq_rem(&call->link, &callout_queue);
-		hrtinfo("call pop\n");
-
 		/* save the intended deadline for periodic calls */
 		deadline = call->deadline;
 
@@ -918,7 +898,9 @@ hrt_call_invoke(void)
 		/* invoke the callout (if there is one) */
 		if (call->callout) {
 			hrtinfo("call %p: %p(%p)\n", call, call->callout, call->arg);
+			TRACE_EVENT(TRACE_EVENT_HRT_CALLOUT_BEGIN, 0, call->callout);
 			call->callout(call->arg);
+			TRACE_EVENT(TRACE_EVENT_HRT_CALLOUT_END, 0, call->callout);
 		}
 
 		/* if the callout has a non-zero period, it has to be re-entered */
@@ -944,7 +926,7 @@ static void
 hrt_call_reschedule()
 {
 	hrt_abstime	now = hrt_absolute_time();
-	struct hrt_call	*next = (struct hrt_call *)sq_peek(&callout_queue);
+	struct hrt_call	*next = hrt_callout_queue_peek(&callout_queue);
 	hrt_abstime	deadline = now + HRT_INTERVAL_MAX;
 
 	/*
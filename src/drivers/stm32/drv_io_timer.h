@@ -53,6 +53,9 @@ __BEGIN_DECLS
 
 #define IO_TIMER_ALL_MODES_CHANNELS 0
 
+/* DShot: timer ticks per bit, the high time of a 1 and 0 bit is 70% and 35% of it */
+#define DSHOT_MOTOR_PWM_BIT_WIDTH	20u
+
 typedef enum io_timer_channel_mode_t {
 	IOTimerChanMode_NotUsed = 0,
 	IOTimerChanMode_PWMOut  = 1,
@@ -60,6 +63,7 @@ typedef enum io_timer_channel_mode_t {
 	IOTimerChanMode_Capture = 3,
 	IOTimerChanMode_OneShot = 4,
 	IOTimerChanMode_Trigger = 5,
+	IOTimerChanMode_Dshot   = 6,
 	IOTimerChanModeSize
 } io_timer_channel_mode_t;
 
@@ -82,6 +86,7 @@ typedef struct io_timers_t {
 	uint32_t    first_channel_index;
 	uint32_t    last_channel_index;
 	xcpt_t      handler;
+	uint32_t    dshot_dmamap; /* DMA channel of the timer's update request, 0 if DShot is not supported */
 } io_timers_t;
 
 /* array of channels in logical order */
@@ -133,4 +138,20 @@ __EXPORT int io_timer_get_channel_mode(unsigned channel);
 __EXPORT int io_timer_get_mode_channels(io_timer_channel_mode_t mode);
 __EXPORT extern void io_timer_trigger(void);
 
+/**
+ * Configure a timer for DShot: the counter runs at DSHOT_MOTOR_PWM_BIT_WIDTH ticks per bit,
+ * and each update event requests a DMA burst of dma_burst_length words to CCR1 onwards.
+ * All the channels of the timer must be in IOTimerChanMode_Dshot.
+ * @param timer timer index
+ * @param dshot_pwm_freq bit rate [Hz], e.g. 600000 for DShot600
+ * @param dma_burst_length number of CCR registers written on each update event (1..4)
+ * @return 0 on success, <0 errno otherwise
+ */
+__EXPORT int io_timer_set_dshot_mode(unsigned timer, unsigned dshot_pwm_freq, unsigned dma_burst_length);
+
+/**
+ * Enable or disable the update DMA request of a timer
+ */
+__EXPORT void io_timer_update_dma_req(unsigned timer, bool enable);
+
 __END_DECLS
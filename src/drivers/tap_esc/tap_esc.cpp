@@ -76,6 +76,9 @@
 #  define BOARD_TAP_ESC_MODE 0
 #endif
 
+/* publication interval of esc_status, the feedback of all ESCs received in between is collected */
+#define ESC_STATUS_PUBLISH_INTERVAL_US	20000
+
 /*
  * This driver connects to TAP ESCs via serial.
  */
@@ -132,6 +135,7 @@ private:
 	orb_advert_t        _esc_feedback_pub = nullptr;
 	orb_advert_t      _to_mixer_status; 	///< mixer status flags
 	esc_status_s      _esc_feedback;
+	bool              _esc_feedback_updated;	///< feedback received since the last esc_status publication
 	uint8_t           _channels_count; // The number of ESC channels
 
 	MixerGroup	*_mixers;
@@ -179,6 +183,7 @@ TAP_ESC::TAP_ESC(int channels_count):
 	_esc_feedback_pub(nullptr),
 	_to_mixer_status(nullptr),
 	_esc_feedback{},
+	_esc_feedback_updated(false),
 	_channels_count(channels_count),
 	_mixers(nullptr),
 	_groups_required(0),
@@ -458,18 +463,25 @@ void TAP_ESC::send_esc_outputs(const uint16_t *pwm, const unsigned num_pwm)
 
 void TAP_ESC::read_data_from_uart()
 {
-	uint8_t tmp_serial_buf[UART_BUFFER_SIZE];
+	/* read directly into the free space of the ring buffer, in two parts if it wraps around */
+	while (uartbuf.dat_cnt < UART_BUFFER_SIZE) {
+		int contiguous = UART_BUFFER_SIZE - uartbuf.tail;
 
-	int len =::read(_uart_fd, tmp_serial_buf, arraySize(tmp_serial_buf));
+		if (contiguous > UART_BUFFER_SIZE - uartbuf.dat_cnt) {
+			contiguous = UART_BUFFER_SIZE - uartbuf.dat_cnt;
+		}
 
-	if (len > 0 && (uartbuf.dat_cnt + len < UART_BUFFER_SIZE)) {
-		for (int i = 0; i < len; i++) {
-			uartbuf.esc_feedback_buf[uartbuf.tail++] = tmp_serial_buf[i];
-			uartbuf.dat_cnt++;
+		int len = ::read(_uart_fd, &uartbuf.esc_feedback_buf[uartbuf.tail], contiguous);
 
-			if (uartbuf.tail >= UART_BUFFER_SIZE) {
-				uartbuf.tail = 0;
-			}
+		if (len <= 0) {
+			break;
+		}
+
+		uartbuf.tail = (uartbuf.tail + len) % UART_BUFFER_SIZE;
+		uartbuf.dat_cnt += len;
+
+		if (len < contiguous) {
+			break;
 		}
 	}
 }
@@ -739,9 +751,17 @@ TAP_ESC::cycle()
 		}
 
 		send_esc_outputs(motor_out, esc_count);
+
+		/* and publish for anyone that cares to see */
+		orb_publish(ORB_ID(actuator_outputs), _outputs_pub, &_outputs);
+
+		/*
+		 * Handle all the feedback that arrived so far, without waiting for it: the response
+		 * to this cycle's request is handled in one of the next cycles.
+		 */
 		read_data_from_uart();
 
-		if (parse_tap_esc_feedback(&uartbuf, &_packet) == true) {
+		while (parse_tap_esc_feedback(&uartbuf, &_packet)) {
 			if (_packet.msg_id == ESCBUS_MSG_ID_RUN_INFO) {
 				RunInfoRepsonse &feed_back_data = _packet.d.rspRunInfo;
 
@@ -756,16 +776,19 @@ TAP_ESC::cycle()
 					_esc_feedback.esc_connectiontype = esc_status_s::ESC_CONNECTION_TYPE_SERIAL;
 					_esc_feedback.counter++;
 					_esc_feedback.esc_count = esc_count;
-
-					_esc_feedback.timestamp = hrt_absolute_time();
-
-					orb_publish(ORB_ID(esc_status), _esc_feedback_pub, &_esc_feedback);
+					_esc_feedback_updated = true;
 				}
 			}
 		}
 
-		/* and publish for anyone that cares to see */
-		orb_publish(ORB_ID(actuator_outputs), _outputs_pub, &_outputs);
+		/* publish the collected feedback at a reduced rate */
+		const hrt_abstime now = hrt_absolute_time();
+
+		if (_esc_feedback_updated && now >= _esc_feedback.timestamp + ESC_STATUS_PUBLISH_INTERVAL_US) {
+			_esc_feedback.timestamp = now;
+			orb_publish(ORB_ID(esc_status), _esc_feedback_pub, &_esc_feedback);
+			_esc_feedback_updated = false;
+		}
 
 	}
 
@@ -203,27 +203,38 @@ void OutputBase::_calculate_output_angles(const hrt_abstime &t)
 		_angle_setpoints[i] += dt * _angle_speeds[i];
 	}
 
-	//get the output angles and stabilize if necessary
-	vehicle_attitude_s vehicle_attitude;
+	if (!_stabilize[0] && !_stabilize[1] && !_stabilize[2]) {
+		for (int i = 0; i < 3; ++i) {
+			_angle_outputs[i] = matrix::wrap_pi(_angle_setpoints[i]);
+		}
 
-	if (_stabilize[0] || _stabilize[1] || _stabilize[2]) {
-		orb_copy(ORB_ID(vehicle_attitude), _vehicle_attitude_sub, &vehicle_attitude);
+		return;
 	}
 
-	matrix::Eulerf euler = matrix::Quatf(vehicle_attitude.q);
+	//stabilize: rotate the setpoint by the inverse of the vehicle attitude on the stabilized axes.
+	//Composing the rotations keeps the setpoint in the earth frame also when several axes are tilted.
+	vehicle_attitude_s vehicle_attitude;
+	orb_copy(ORB_ID(vehicle_attitude), _vehicle_attitude_sub, &vehicle_attitude);
 
-	for (int i = 0; i < 3; ++i) {
-		if (_stabilize[i]) {
-			_angle_outputs[i] = _angle_setpoints[i] - euler(i);
+	matrix::Quatf q_vehicle(vehicle_attitude.q);
 
-		} else {
-			_angle_outputs[i] = _angle_setpoints[i];
+	if (!_stabilize[0] || !_stabilize[1] || !_stabilize[2]) {
+		matrix::Eulerf euler_vehicle(vehicle_attitude.roll, vehicle_attitude.pitch, vehicle_attitude.yaw);
+
+		for (int i = 0; i < 3; ++i) {
+			if (!_stabilize[i]) {
+				euler_vehicle(i) = 0.f;
+			}
 		}
 
-		//bring angles into proper range [-pi, pi]
-		while (_angle_outputs[i] > M_PI_F) { _angle_outputs[i] -= 2.f * M_PI_F; }
+		q_vehicle = euler_vehicle;
+	}
+
+	const matrix::Quatf q_setpoint = matrix::Eulerf(_angle_setpoints[0], _angle_setpoints[1], _angle_setpoints[2]);
+	const matrix::Eulerf euler_output = q_vehicle.inversed() * q_setpoint;
 
-		while (_angle_outputs[i] < -M_PI_F) { _angle_outputs[i] += 2.f * M_PI_F; }
+	for (int i = 0; i < 3; ++i) {
+		_angle_outputs[i] = euler_output(i);
 	}
 }
 
@@ -53,6 +53,7 @@
 #include <systemlib/err.h>
 #include <px4_defines.h>
 #include <px4_tasks.h>
+#include <px4_posix.h>
 
 #include "input_mavlink.h"
 #include "input_rc.h"
@@ -62,6 +63,7 @@
 
 #include <uORB/uORB.h>
 #include <uORB/topics/parameter_update.h>
+#include <uORB/topics/vehicle_attitude.h>
 
 #include <px4_config.h>
 #include <px4_module.h>
@@ -98,6 +100,7 @@ struct Parameters {
 	float mnt_off_pitch;
 	float mnt_off_roll;
 	float mnt_off_yaw;
+	int32_t mnt_out_rate;
 
 	bool operator!=(const Parameters &p)
 	{
@@ -118,7 +121,8 @@ struct Parameters {
 		       mnt_range_yaw != p.mnt_range_yaw ||
 		       mnt_off_pitch != p.mnt_off_pitch ||
 		       mnt_off_roll != p.mnt_off_roll ||
-		       mnt_off_yaw != p.mnt_off_yaw;
+		       mnt_off_yaw != p.mnt_off_yaw ||
+		       mnt_out_rate != p.mnt_out_rate;
 #pragma GCC diagnostic pop
 
 	}
@@ -141,6 +145,7 @@ struct ParameterHandles {
 	param_t mnt_off_pitch;
 	param_t mnt_off_roll;
 	param_t mnt_off_yaw;
+	param_t mnt_out_rate;
 };
 
 
@@ -244,12 +249,16 @@ static int vmount_thread_main(int argc, char *argv[])
 	}
 
 	int parameter_update_sub = orb_subscribe(ORB_ID(parameter_update));
+
+	// the outputs are updated with the vehicle attitude, so that stabilization follows it without delay
+	int vehicle_attitude_sub = orb_subscribe(ORB_ID(vehicle_attitude));
+	orb_set_interval(vehicle_attitude_sub, params.mnt_out_rate > 0 ? 1000 / params.mnt_out_rate : 0);
+
 	thread_running = true;
 	ControlData *control_data = nullptr;
 	g_thread_data = &thread_data;
 
 	int last_active = 0;
-	hrt_abstime last_output_update = 0;
 
 	while (!thread_should_exit) {
 
@@ -354,16 +363,24 @@ static int vmount_thread_main(int argc, char *argv[])
 
 		if (thread_data.input_objs_len > 0) {
 
-			//get input: we cannot make the timeout too large, because the output needs to update
-			//periodically for stabilization and angle updates.
+			//wait for the next attitude update. The timeout keeps the outputs updating periodically
+			//for angle speeds when there is no attitude.
+			px4_pollfd_struct_t attitude_poll;
+			attitude_poll.fd = vehicle_attitude_sub;
+			attitude_poll.events = POLLIN;
+
+			if (px4_poll(&attitude_poll, 1, 20) > 0 && (attitude_poll.revents & POLLIN)) {
+				vehicle_attitude_s vehicle_attitude;
+				orb_copy(ORB_ID(vehicle_attitude), vehicle_attitude_sub, &vehicle_attitude);
+			}
 
+			//get input without blocking, the attitude updates pace the loop
 			for (int i = 0; i < thread_data.input_objs_len; ++i) {
 
 				bool already_active = (last_active == i);
 
 				ControlData *control_data_to_check = nullptr;
-				unsigned int poll_timeout = already_active ? 50 : 0; // poll only on active input to reduce latency
-				int ret = thread_data.input_objs[i]->update(poll_timeout, &control_data_to_check, already_active);
+				int ret = thread_data.input_objs[i]->update(0, &control_data_to_check, already_active);
 
 				if (ret) {
 					PX4_ERR("failed to read input %i (ret: %i)", i, ret);
@@ -376,21 +393,16 @@ static int vmount_thread_main(int argc, char *argv[])
 				}
 			}
 
-			hrt_abstime now = hrt_absolute_time();
-			if (now - last_output_update > 10000) { // rate-limit the update of outputs
-				last_output_update = now;
+			//update output
+			int ret = thread_data.output_obj->update(control_data);
 
-				//update output
-				int ret = thread_data.output_obj->update(control_data);
-
-				if (ret) {
-					PX4_ERR("failed to write output (%i)", ret);
-					break;
-				}
-
-				thread_data.output_obj->publish();
+			if (ret) {
+				PX4_ERR("failed to write output (%i)", ret);
+				break;
 			}
 
+			thread_data.output_obj->publish();
+
 		} else {
 			//wait for parameter changes. We still need to wake up regularily to check for thread exit requests
 			usleep(1e6);
@@ -411,6 +423,8 @@ static int vmount_thread_main(int argc, char *argv[])
 			update_params(param_handles, params, updated);
 
 			if (updated) {
+				orb_set_interval(vehicle_attitude_sub, params.mnt_out_rate > 0 ? 1000 / params.mnt_out_rate : 0);
+
 				//re-init objects
 				for (int i = 0; i < input_objs_len_max; ++i) {
 					if (thread_data.input_objs[i]) {
@@ -434,6 +448,7 @@ static int vmount_thread_main(int argc, char *argv[])
 	g_thread_data = nullptr;
 
 	orb_unsubscribe(parameter_update_sub);
+	orb_unsubscribe(vehicle_attitude_sub);
 
 	for (int i = 0; i < input_objs_len_max; ++i) {
 		if (thread_data.input_objs[i]) {
@@ -565,6 +580,7 @@ void update_params(ParameterHandles &param_handles, Parameters &params, bool &go
 	param_get(param_handles.mnt_off_pitch, &params.mnt_off_pitch);
 	param_get(param_handles.mnt_off_roll, &params.mnt_off_roll);
 	param_get(param_handles.mnt_off_yaw, &params.mnt_off_yaw);
+	param_get(param_handles.mnt_out_rate, &params.mnt_out_rate);
 
 	got_changes = prev_params != params;
 }
@@ -587,6 +603,7 @@ bool get_params(ParameterHandles &param_handles, Parameters &params)
 	param_handles.mnt_off_pitch = param_find("MNT_OFF_PITCH");
 	param_handles.mnt_off_roll = param_find("MNT_OFF_ROLL");
 	param_handles.mnt_off_yaw = param_find("MNT_OFF_YAW");
+	param_handles.mnt_out_rate = param_find("MNT_OUT_RATE");
 
 	if (param_handles.mnt_mode_in == PARAM_INVALID ||
 	    param_handles.mnt_mode_out == PARAM_INVALID ||
@@ -603,7 +620,8 @@ bool get_params(ParameterHandles &param_handles, Parameters &params)
 		param_handles.mnt_range_yaw == PARAM_INVALID ||
 		param_handles.mnt_off_pitch == PARAM_INVALID ||
 		param_handles.mnt_off_roll == PARAM_INVALID ||
-		param_handles.mnt_off_yaw == PARAM_INVALID) {
+		param_handles.mnt_off_yaw == PARAM_INVALID ||
+		param_handles.mnt_out_rate == PARAM_INVALID) {
 		return false;
 	}
 
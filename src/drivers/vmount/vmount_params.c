@@ -224,4 +224,16 @@ PARAM_DEFINE_FLOAT(MNT_OFF_ROLL, 0.0f);
 * @decimal 1
 * @group Mount
 */
-PARAM_DEFINE_FLOAT(MNT_OFF_YAW, 0.0f);
\ No newline at end of file
+PARAM_DEFINE_FLOAT(MNT_OFF_YAW, 0.0f);
+/**
+* Maximum output update rate.
+*
+* The outputs are updated with the vehicle attitude, at most at this rate.
+* Set to 0 to update on every attitude update, for directly driven gimbals.
+*
+* @unit Hz
+* @min 0
+* @max 1000
+* @group Mount
+*/
+PARAM_DEFINE_INT32(MNT_OUT_RATE, 100);
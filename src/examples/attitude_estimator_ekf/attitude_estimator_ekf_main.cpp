@@ -68,6 +68,7 @@
 
 #include <lib/mathlib/mathlib.h>
 #include <lib/geo/geo.h>
+#include <conversion/attitude.h>
 
 #include <systemlib/perf_counter.h>
 #include <systemlib/err.h>
@@ -615,6 +616,7 @@ int attitude_estimator_ekf_thread_main(int argc, char *argv[])
 					matrix::Quatf q = matrix::Quatf(R_declination * Ro);
 
 					memcpy(&att.q[0],&q._data[0],sizeof(att.q));
+					set_attitude_representations(att);
 
 					if (PX4_ISFINITE(att.q[0]) && PX4_ISFINITE(att.q[1])
 						&& PX4_ISFINITE(att.q[2]) && PX4_ISFINITE(att.q[3])) {
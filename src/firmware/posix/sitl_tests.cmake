@@ -63,6 +63,7 @@ set(test_cmds
 	hello
 	hrt_test
 	muorb_test
+	symmetric_matrix
 	vcdev_test
 	wqueue_test
 	)
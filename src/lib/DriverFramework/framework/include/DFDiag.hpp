@@ -46,6 +46,9 @@ class DFDiag
 public:
 	static void listRawDevices();
 	static void listRegisteredDevices();
+
+	// Print the scheduled work items with their timing statistics
+	static void listWorkItems();
 private:
 	DFDiag() {}
 	~DFDiag() {}
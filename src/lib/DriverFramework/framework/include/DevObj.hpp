@@ -93,6 +93,9 @@ public:
 
 	void setSampleInterval(unsigned int sample_interval_usecs);
 
+	// Set the priority of the periodic callback (see WorkPriority), takes effect on (re)start
+	void setSchedulingPriority(int priority) { m_scheduling_priority = priority; }
+
 	virtual ~DevObj();
 
 	union DeviceId getId()
@@ -127,6 +130,7 @@ public:
 	char 	 		*m_dev_class_path;
 	char 	 		*m_dev_instance_path;
 	unsigned int 		m_sample_interval_usecs;
+	int			m_scheduling_priority;
 	union DeviceId		m_id;
 
 	WorkHandle 		m_work_handle;
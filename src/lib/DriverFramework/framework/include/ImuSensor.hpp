@@ -115,7 +115,9 @@ public:
 		SPIDevObj("ImuSensor", device_path, IMU_CLASS_PATH, sample_interval_usec),
 #endif
 		m_mag_enabled(mag_enabled)
-	{}
+	{
+		setSchedulingPriority(WORK_PRIORITY_IMU);
+	}
 
 	virtual ~ImuSensor() = default;
 
@@ -56,6 +56,10 @@ public:
 	// Use timeout_us = 0 for blocking wait
 	int waitOnSignal(unsigned long timeout_us);
 
+	// Wait until an absolute deadline of the absoluteTime() clock
+	// Returns 0 on success, ETIMEDOUT on timeout
+	int waitOnSignalUntil(const struct timespec &deadline);
+
 	void signal();
 
 private:
@@ -57,6 +57,13 @@ public:
 
 typedef void (*WorkCallback)(void *arg);
 
+// Priorities of work items: if several items are due, the one with the highest
+// priority runs first (then the one with the earliest deadline)
+enum WorkPriority {
+	WORK_PRIORITY_DEFAULT = 0,
+	WORK_PRIORITY_IMU = 10,
+};
+
 // Get the offset time from startup
 uint64_t offsetTime();
 
@@ -74,7 +81,8 @@ class WorkMgr
 {
 public:
 	// Interface functions
-	static void getWorkHandle(WorkCallback cb, void *arg, uint32_t delay_usec, WorkHandle &handle);
+	static void getWorkHandle(WorkCallback cb, void *arg, uint32_t delay_usec, WorkHandle &handle,
+				  int priority = WORK_PRIORITY_DEFAULT);
 	static void releaseWorkHandle(WorkHandle &handle);
 	static int schedule(WorkHandle &handle);
 	static void setError(WorkHandle &h, int error);
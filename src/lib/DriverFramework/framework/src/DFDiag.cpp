@@ -40,6 +40,7 @@
 #include "DFLog.hpp"
 #include "DFDiag.hpp"
 #include "DevMgr.hpp"
+#include "WorkItems.hpp"
 
 using namespace DriverFramework;
 
@@ -55,6 +56,13 @@ void DFDiag::listRegisteredDevices()
 	}
 }
 
+void DFDiag::listWorkItems()
+{
+	DF_LOG_INFO("Work Items:");
+
+	WorkItems::printStatus();
+}
+
 void DFDiag::listRawDevices()
 {
 	int fd;
@@ -49,6 +49,7 @@ DevObj::DevObj(const char *name, const char *dev_path, const char *dev_class_pat
 	m_dev_class_path(nullptr),
 	m_dev_instance_path(nullptr),
 	m_sample_interval_usecs(sample_interval_usecs),
+	m_scheduling_priority(WORK_PRIORITY_DEFAULT),
 	m_id {},
 	m_pub_blocked(false),
 	m_driver_instance(-1),
@@ -165,7 +166,7 @@ int DevObj::start()
 
 	} else {
 		do {
-			WorkMgr::getWorkHandle(measure, this, m_sample_interval_usecs, m_work_handle);
+			WorkMgr::getWorkHandle(measure, this, m_sample_interval_usecs, m_work_handle, m_scheduling_priority);
 
 			if (!m_work_handle.isValid()) {
 				return -m_work_handle.getError();
@@ -325,7 +326,7 @@ void DevObj::setSampleInterval(unsigned int sample_interval_usecs)
 			WorkMgr::releaseWorkHandle(m_work_handle);
 
 			do {
-				WorkMgr::getWorkHandle(measure, this, m_sample_interval_usecs, m_work_handle);
+				WorkMgr::getWorkHandle(measure, this, m_sample_interval_usecs, m_work_handle, m_scheduling_priority);
 
 				if (!m_work_handle.isValid()) {
 					return;
@@ -481,12 +481,13 @@ void HRTWorkQueue::process()
 
 		if (next > now) {
 #endif
-			uint64_t wait_time_usec = next - now;
-
-			DF_LOG_DEBUG("HRTWorkQueue::process waiting for work (%" PRIi64 "usec)", wait_time_usec);
-			// Wait until next expiry or until a new item is rescheduled
+			DF_LOG_DEBUG("HRTWorkQueue::process waiting for work (%" PRIi64 "usec)", next - now);
+			// Wait until next expiry or until a new item is rescheduled. Waiting for the absolute
+			// deadline (instead of a relative timeout) avoids adding the time between reading the
+			// clock and going to sleep to the wakeup time.
+			struct timespec deadline = offsetTimeToAbsoluteTime(next);
 			m_reschedule.lock();
-			m_reschedule.waitOnSignal(wait_time_usec);
+			m_reschedule.waitOnSignalUntil(deadline);
 			m_reschedule.unlock();
 			DF_LOG_DEBUG("Done wait");
 		}
@@ -97,6 +97,15 @@ int SyncObj::waitOnSignal(unsigned long timeout_us)
 	return ret;
 }
 
+// waitOnSignalUntil must be called inside a lock()
+// of this object
+int SyncObj::waitOnSignalUntil(const struct timespec &deadline)
+{
+	DEBUG("wait %p until %ld.%09ld\n", &m_new_data_cond, (long)deadline.tv_sec, (long)deadline.tv_nsec);
+
+	return pthread_cond_timedwait(&m_new_data_cond, &m_lock, &deadline);
+}
+
 // signal must be called inside a lock()
 // of this object
 void SyncObj::signal()
@@ -254,6 +254,30 @@ void WorkItems::_unschedule(int index)
 	}
 }
 
+void WorkItems::printStatus()
+{
+	WorkItems &inst = instance();
+
+	inst.m_lock.lock();
+
+	DFManagedList<WorkItem>::Index idx = nullptr;
+	idx = inst.m_work_items.next(idx);
+
+	while (idx != nullptr) {
+		WorkItem *item = inst.m_work_items.get(idx);
+
+		if (item->m_in_use) {
+			DF_LOG_INFO("   callback=%p interval=%u us priority=%d runs=%u deadline misses=%u max late=%u us",
+				    item->m_callback, item->m_delay_usec, item->m_priority, item->m_run_count,
+				    item->m_deadline_misses, item->m_max_lateness);
+		}
+
+		idx = inst.m_work_items.next(idx);
+	}
+
+	inst.m_lock.unlock();
+}
+
 void WorkItems::processExpiredWorkItems(uint64_t &next)
 {
 	DF_LOG_DEBUG("WorkItems::processExpiredWorkItems %" PRIu64 "", next);
@@ -267,23 +291,29 @@ void WorkItems::processExpiredWorkItems(uint64_t &next)
 void WorkItems::_processExpiredWorkItems(uint64_t &next)
 {
 	DF_LOG_DEBUG("WorkItems::processExpiredWorkItems");
-	uint64_t now;
-	uint32_t elapsed;
+	uint64_t now = offsetTime();
 	uint32_t max_too_late_scheduled = 0;
 	bool had_work = false;
 
-	DFUIntList::Index idx = nullptr;
-	idx = m_work_list.next(idx);
+	// Run the due items one at a time, highest priority first, then by deadline. Each callback
+	// can take a while, so the selection is repeated after each one.
+	while (g_run_status && g_run_status->check()) {
+		WorkItem *due_item = nullptr;
 
-	while (g_run_status && g_run_status->check() && (idx != nullptr)) {
-		DF_LOG_DEBUG("HRTWorkQueue::process work exists");
-		unsigned int index;
-		m_work_list.get(idx, index);
+		DFUIntList::Index idx = nullptr;
+		idx = m_work_list.next(idx);
 
+		while (idx != nullptr) {
+			unsigned int index;
+			m_work_list.get(idx, index);
 
-		if (index < m_work_items.size()) {
 			WorkItem *item = nullptr;
-			getAt(index, &item);
+
+			if (index >= m_work_items.size() || !getAt(index, &item)) {
+				idx = m_work_list.next(idx);
+				continue;
+			}
+
 			DF_LOG_DEBUG("WorkList (%p) in use=%d delay=%u queue_time=%" PRIu64, item, item->m_in_use, item->m_delay_usec,
 				     item->m_queue_time);
 
@@ -294,43 +324,68 @@ void WorkItems::_processExpiredWorkItems(uint64_t &next)
 				continue;
 			}
 
-			now = offsetTime();
-			elapsed = now - item->m_queue_time;
-			//DF_LOG_DEBUG("now = %lu elapsed = %lu delay = %luusec\n", now, elapsed, item.m_delay_usec);
+			if (item->deadline() <= now &&
+			    (due_item == nullptr || item->m_priority > due_item->m_priority ||
+			     (item->m_priority == due_item->m_priority && item->deadline() < due_item->deadline()))) {
+				due_item = item;
+			}
+
+			idx = m_work_list.next(idx);
+		}
 
-			if (elapsed >= item->m_delay_usec) {
-				DF_LOG_DEBUG("WorkItems::processExpiredWorkItems  do work: (%p) (%u)", item, item->m_delay_usec);
-				item->updateStats(now);
+		if (due_item == nullptr) {
+			break;
+		}
 
-				// reschedule work
-				item->m_queue_time += item->m_delay_usec;
-				item->m_in_use = true;
+		DF_LOG_DEBUG("WorkItems::processExpiredWorkItems  do work: (%p) (%u)", due_item, due_item->m_delay_usec);
+		due_item->updateStats(now);
 
-				if (!had_work && elapsed - item->m_delay_usec > max_too_late_scheduled) {
-					//only take the first into account, because we don't want to include the callback
-					//execution time of the previous items
-					max_too_late_scheduled = elapsed - item->m_delay_usec;
-				}
+		const uint32_t lateness = now - due_item->deadline();
 
-				void *tmpptr = item->m_arg;
-				WorkCallback cb = item->m_callback;
-				m_lock.unlock();
-				cb(tmpptr);
-				had_work = true;
-				m_lock.lock();
-			}
+		if (!had_work && lateness > max_too_late_scheduled) {
+			//only take the first into account, because we don't want to include the callback
+			//execution time of the previous items
+			max_too_late_scheduled = lateness;
+		}
 
-			// Get next scheduling time
-			uint64_t cur_next = item->m_queue_time + item->m_delay_usec;
+		++due_item->m_run_count;
 
-			if (cur_next < next) {
-				next = cur_next;
-			}
+		if (lateness > due_item->m_max_lateness) {
+			due_item->m_max_lateness = lateness;
+		}
 
-			idx = m_work_list.next(idx);
+		if (lateness > due_item->m_delay_usec / 2) {
+			++due_item->m_deadline_misses;
 		}
+
+		// reschedule work: the deadlines are absolute, so that delays do not accumulate
+		due_item->m_queue_time += due_item->m_delay_usec;
+
+		void *tmpptr = due_item->m_arg;
+		WorkCallback cb = due_item->m_callback;
+		m_lock.unlock();
+		cb(tmpptr);
+		had_work = true;
+		m_lock.lock();
+
+		now = offsetTime();
 	}
 
+	// Get next scheduling time
+	DFUIntList::Index idx = nullptr;
+	idx = m_work_list.next(idx);
+
+	while (idx != nullptr) {
+		unsigned int index;
+		m_work_list.get(idx, index);
+		WorkItem *item = nullptr;
+
+		if (index < m_work_items.size() && getAt(index, &item) && item->m_in_use && item->deadline() < next) {
+			next = item->deadline();
+		}
+
+		idx = m_work_list.next(idx);
+	}
 
 #if 0 //debug the scheduling adjustment
 	static int no_work_counter = 0;
@@ -385,17 +440,17 @@ void WorkItems::_processExpiredWorkItems(uint64_t &next)
 	DF_LOG_DEBUG("Setting next=%" PRIu64, next);
 }
 
-int WorkItems::getIndex(WorkCallback cb, void *arg, uint32_t delay_usec, int &index)
+int WorkItems::getIndex(WorkCallback cb, void *arg, uint32_t delay_usec, int priority, int &index)
 {
 	WorkItems &inst = instance();
 
 	inst.m_lock.lock();
-	int ret = inst._getIndex(cb, arg, delay_usec, index);
+	int ret = inst._getIndex(cb, arg, delay_usec, priority, index);
 	inst.m_lock.unlock();
 	return ret;
 }
 
-int WorkItems::_getIndex(WorkCallback cb, void *arg, uint32_t delay_usec, int &index)
+int WorkItems::_getIndex(WorkCallback cb, void *arg, uint32_t delay_usec, int priority, int &index)
 {
 	int ret;
 
@@ -433,7 +488,7 @@ int WorkItems::_getIndex(WorkCallback cb, void *arg, uint32_t delay_usec, int &i
 		WorkItem *item = nullptr;
 		getAt(index, &item);
 
-		item->set(cb, arg, delay_usec);
+		item->set(cb, arg, delay_usec, priority);
 		ret = 0;
 
 	} else {
@@ -56,8 +56,9 @@ public:
 		return *instance;
 	}
 
-	static int  getIndex(WorkCallback cb, void *arg, uint32_t delay_usec, int &index);
+	static int  getIndex(WorkCallback cb, void *arg, uint32_t delay_usec, int priority, int &index);
 	static void processExpiredWorkItems(uint64_t &next);
+	static void printStatus();
 	static int  schedule(int index);
 	static void unschedule(int index);
 	static void finalize();
@@ -76,7 +77,7 @@ private:
 	void _unschedule(int index);
 	void _finalize();
 	void _processExpiredWorkItems(uint64_t &next);
-	int  _getIndex(WorkCallback cb, void *arg, uint32_t delay_usec, int &index);
+	int  _getIndex(WorkCallback cb, void *arg, uint32_t delay_usec, int priority, int &index);
 	bool _isValidIndex(int index);
 
 	class WorkItem
@@ -93,21 +94,35 @@ private:
 		void resetStats();
 		void dumpStats();
 
-		void set(WorkCallback callback, void *arg, uint32_t delay_usec)
+		void set(WorkCallback callback, void *arg, uint32_t delay_usec, int priority)
 		{
 			m_arg = arg;
 			m_queue_time = 0;
 			m_callback = callback;
 			m_delay_usec = delay_usec;
+			m_priority = priority;
 			m_in_use = false;
 
+			m_run_count = 0;
+			m_deadline_misses = 0;
+			m_max_lateness = 0;
+
 			resetStats();
 		}
 
+		// Deadline of the next run
+		uint64_t deadline() const { return m_queue_time + m_delay_usec; }
+
 		void 		*m_arg = nullptr;
 		uint64_t	m_queue_time = 0;
 		WorkCallback	m_callback = nullptr;
 		uint32_t	m_delay_usec = 0;
+		int		m_priority = WORK_PRIORITY_DEFAULT;
+
+		// scheduling statistics (see printStatus())
+		uint32_t	m_run_count = 0;
+		uint32_t	m_deadline_misses = 0;	// runs started more than half an interval late
+		uint32_t	m_max_lateness = 0;	// [us]
 
 #if SHOW_STATS == 1
 		// statistics
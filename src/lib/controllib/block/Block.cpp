@@ -81,6 +81,8 @@ void Block::getName(char *buf, size_t n)
 
 void Block::updateParams()
 {
+	_param_change_count = param_change_count();
+
 	BlockParamBase *param = getParams().getHead();
 	int count = 0;
 
@@ -98,6 +100,50 @@ void Block::updateParams()
 	}
 }
 
+void Block::updateChangedParams()
+{
+	param_t changed[PARAM_CHANGE_HISTORY_SIZE];
+
+	// read the counter first, so that no change in between can get lost
+	const uint32_t change_count = param_change_count();
+	const int num_changed = param_changed_since(_param_change_count, changed, PARAM_CHANGE_HISTORY_SIZE);
+
+	if (num_changed < 0) {
+		updateParams();
+		return;
+	}
+
+	_param_change_count = change_count;
+
+	if (num_changed > 0) {
+		updateParamsSubset(changed, num_changed);
+	}
+}
+
+void Block::updateParamsSubset(const param_t *changed, int num_changed)
+{
+	BlockParamBase *param = getParams().getHead();
+	int count = 0;
+
+	while (param != nullptr) {
+		if (count++ > maxParamsPerBlock) {
+			char name[blockNameLengthMax];
+			getName(name, blockNameLengthMax);
+			PX4_ERR("exceeded max params for block: %s", name);
+			break;
+		}
+
+		for (int i = 0; i < num_changed; i++) {
+			if (changed[i] == param->getHandle()) {
+				param->update();
+				break;
+			}
+		}
+
+		param = param->getSibling();
+	}
+}
+
 void Block::updateSubscriptions()
 {
 	uORB::SubscriptionNode *sub = getSubscriptions().getHead();
@@ -171,6 +217,24 @@ void SuperBlock::updateChildParams()
 	}
 }
 
+void SuperBlock::updateChildParamsSubset(const param_t *changed, int num_changed)
+{
+	Block *child = getChildren().getHead();
+	int count = 0;
+
+	while (child != nullptr) {
+		if (count++ > maxChildrenPerBlock) {
+			char name[blockNameLengthMax];
+			getName(name, blockNameLengthMax);
+			PX4_ERR("exceeded max children for block: %s", name);
+			break;
+		}
+
+		child->updateParamsSubset(changed, num_changed);
+		child = child->getSibling();
+	}
+}
+
 void SuperBlock::updateChildSubscriptions()
 {
 	Block *child = getChildren().getHead();
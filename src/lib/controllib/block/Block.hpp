@@ -63,6 +63,7 @@ class __EXPORT Block : public ListNode<Block *>
 {
 public:
 	friend class BlockParamBase;
+	friend class SuperBlock;
 
 	Block(SuperBlock *parent, const char *name);
 	virtual ~Block() = default;
@@ -76,6 +77,15 @@ public:
 	void getName(char *name, size_t n);
 
 	virtual void updateParams();
+
+	/**
+	 * Update only the params of this block and its children which changed since the
+	 * last call of updateParams() or updateChangedParams() on this block (@see param_changed_since()).
+	 * Meant to be called on the top-level block on a parameter_update, instead of updateParams().
+	 * All params are updated if the changes are not known.
+	 */
+	void updateChangedParams();
+
 	virtual void updateSubscriptions();
 	virtual void updatePublications();
 
@@ -89,9 +99,16 @@ protected:
 	List<uORB::PublicationNode *> &getPublications() { return _publications; }
 	List<BlockParamBase *> &getParams() { return _params; }
 
+	/**
+	 * Update the params whose handle is in changed.
+	 * @see updateChangedParams()
+	 */
+	virtual void updateParamsSubset(const param_t *changed, int num_changed);
+
 	const char *_name;
 	SuperBlock *_parent;
 	float _dt{0.0f};
+	uint32_t _param_change_count{0}; ///< param_change_count() at the last update
 
 	List<uORB::SubscriptionNode *> _subscriptions;
 	List<uORB::PublicationNode *> _publications;
@@ -136,8 +153,16 @@ public:
 	}
 
 protected:
+	void updateParamsSubset(const param_t *changed, int num_changed) override
+	{
+		Block::updateParamsSubset(changed, num_changed);
+
+		if (getChildren().getHead() != nullptr) { updateChildParamsSubset(changed, num_changed); }
+	}
+
 	List<Block *> &getChildren() { return _children; }
 	void updateChildParams();
+	void updateChildParamsSubset(const param_t *changed, int num_changed);
 	void updateChildSubscriptions();
 	void updateChildPublications();
 
@@ -64,6 +64,7 @@ public:
 
 	virtual bool update() = 0;
 	const char *getName() { return param_name(_handle); }
+	param_t getHandle() const { return _handle; }
 
 protected:
 	param_t _handle{PARAM_INVALID};
@@ -66,6 +66,7 @@ int blockRandUniformTest();
 int blockRandGaussTest();
 int blockStatsTest();
 int blockDelayTest();
+int blockParamUpdateTest();
 
 int basicBlocksTest()
 {
@@ -87,6 +88,7 @@ int basicBlocksTest()
 	failed = failed || blockRandGaussTest() < 0;
 	failed = failed || blockStatsTest() < 0;
 	failed = failed || blockDelayTest() < 0;
+	failed = failed || blockParamUpdateTest() < 0;
 	return failed ? -1 : 0;
 }
 
@@ -527,6 +529,34 @@ int blockDelayTest()
 	return 0;
 }
 
+int blockParamUpdateTest()
+{
+	printf("Test BlockParam update\t\t: ");
+	BlockPI blockPI(NULL, "TEST");
+	param_t param_i_max = param_find("TEST_I_MAX");
+	ASSERT_CL(param_i_max != PARAM_INVALID);
+	// everything is updated if the changes are not known
+	blockPI.updateChangedParams();
+	ASSERT_CL(equal(0.2f, blockPI.getKP()));
+	ASSERT_CL(equal(1.0f, blockPI.getIntegral().getMax()));
+	// change a param of a nested block
+	float value = 2.0f;
+	ASSERT_CL(param_set(param_i_max, &value) == PX4_OK);
+	blockPI.updateChangedParams();
+	ASSERT_CL(equal(0.2f, blockPI.getKP()));
+	ASSERT_CL(equal(2.0f, blockPI.getIntegral().getMax()));
+	// no change
+	blockPI.updateChangedParams();
+	ASSERT_CL(equal(2.0f, blockPI.getIntegral().getMax()));
+	// restore the default
+	value = 1.0f;
+	ASSERT_CL(param_set(param_i_max, &value) == PX4_OK);
+	blockPI.updateChangedParams();
+	ASSERT_CL(equal(1.0f, blockPI.getIntegral().getMax()));
+	printf("PASS\n");
+	return 0;
+}
+
 extern "C" __EXPORT int controllib_test_main(int argc, char *argv[]);
 
 int controllib_test_main(int argc, char *argv[])
@@ -267,3 +267,26 @@ rotate_3f(enum Rotation rot, float &x, float &y, float &z)
 		}
 	}
 }
+
+__EXPORT void
+get_rot_table(enum Rotation rot, rot_table_t *rot_table)
+{
+	// the columns are the rotated unit vectors, so that the table matches rotate_3f() exactly
+	for (unsigned col = 0; col < 3; col++) {
+		float v[3] = { 0.0f, 0.0f, 0.0f };
+		v[col] = 1.0f;
+		rotate_3f(rot, v[0], v[1], v[2]);
+
+		for (unsigned row = 0; row < 3; row++) {
+			rot_table->m[row][col] = v[row];
+		}
+	}
+}
+
+__EXPORT void
+rotate_3f_array(const rot_table_t &rot_table, float *xyz, unsigned count)
+{
+	for (unsigned i = 0; i < count; i++, xyz += 3) {
+		rotate_3f(rot_table, xyz[0], xyz[1], xyz[2]);
+	}
+}
@@ -139,5 +139,42 @@ get_rot_matrix(enum Rotation rot, math::Matrix<3, 3> *rot_matrix);
 __EXPORT void
 rotate_3f(enum Rotation rot, float &x, float &y, float &z);
 
+/**
+ * Rotation matrix of a Rotation, set up once with get_rot_table() (e.g. when the rotation of
+ * a driver is configured) and applied per sample without the switch on the rotation.
+ * The entries of the axis-aligned rotations are exactly 0 and +-1, so the results equal
+ * rotate_3f(enum Rotation, ...) (up to float rounding for the 45 degree yaw rotations).
+ */
+typedef struct {
+	float m[3][3];
+} rot_table_t;
+
+/**
+ * Get the rotation table of a rotation
+ */
+__EXPORT void
+get_rot_table(enum Rotation rot, rot_table_t *rot_table);
+
+/**
+ * rotate a 3 element float vector in-place with a precomputed rotation table
+ */
+static inline void
+rotate_3f(const rot_table_t &rot_table, float &x, float &y, float &z)
+{
+	const float tmpx = x;
+	const float tmpy = y;
+	const float tmpz = z;
+	x = rot_table.m[0][0] * tmpx + rot_table.m[0][1] * tmpy + rot_table.m[0][2] * tmpz;
+	y = rot_table.m[1][0] * tmpx + rot_table.m[1][1] * tmpy + rot_table.m[1][2] * tmpz;
+	z = rot_table.m[2][0] * tmpx + rot_table.m[2][1] * tmpy + rot_table.m[2][2] * tmpz;
+}
+
+/**
+ * rotate an array of 3 element float vectors in-place (x, y, z interleaved, e.g. the samples
+ * of a FIFO read) with a precomputed rotation table
+ */
+__EXPORT void
+rotate_3f_array(const rot_table_t &rot_table, float *xyz, unsigned count);
+
 
 #endif /* ROTATION_H_ */
@@ -37,10 +37,18 @@
  * Template RingBuffer.
  */
 
+#pragma once
+
 #include <inttypes.h>
 #include <cstdio>
 #include <cstring>
 
+/*
+ * The samples are stored in a power of two number of slots, so that the indices can wrap
+ * around with a mask. The buffer holds up to the requested number of samples, the
+ * oldest sample is dropped when a new one is pushed into a full buffer.
+ * Samples have to be pushed in time order, which allows a binary search by time.
+ */
 template <typename data_type>
 class RingBuffer
 {
@@ -48,7 +56,7 @@ public:
 	RingBuffer()
 	{
 		_buffer = NULL;
-		_head = _tail = _size = 0;
+		_head = _tail = _size = _mask = 0;
 		_first_write = true;
 	}
 	~RingBuffer() { delete[] _buffer; }
@@ -63,17 +71,26 @@ public:
 			delete[] _buffer;
 		}
 
-		_buffer = new data_type[size];
+		// use more slots than samples, so that a full buffer can be distinguished from a single sample
+		unsigned num_slots = 2;
+
+		while (num_slots <= static_cast<unsigned>(size)) {
+			num_slots *= 2;
+		}
+
+		_buffer = new data_type[num_slots];
 
 		if (_buffer == NULL) {
 			return false;
 		}
 
 		_size = size;
+		_mask = num_slots - 1;
 		// set the time elements to zero so that bad data is not retrieved from the buffers
-		for (unsigned index = 0; index < _size; index++) {
+		for (unsigned index = 0; index < num_slots; index++) {
 			_buffer[index].time_us = 0;
 		}
+		_head = _tail = 0;
 		_first_write = true;
 		return true;
 	}
@@ -87,24 +104,18 @@ public:
 
 	inline void push(data_type sample)
 	{
-		int head_new = _head;
-
 		if (_first_write) {
-			head_new = _head;
-
-		} else {
-			head_new = (_head + 1) % _size;
+			_buffer[_head] = sample;
+			_first_write = false;
+			return;
 		}
 
-		_buffer[head_new] = sample;
-		_head = head_new;
+		_head = (_head + 1) & _mask;
+		_buffer[_head] = sample;
 
-		// move tail if we overwrite it
-		if (_head == _tail && !_first_write) {
-			_tail = (_tail + 1) % _size;
-
-		} else {
-			_first_write = false;
+		// move tail if the buffer holds more than _size samples
+		if (((_head - _tail) & _mask) >= _size) {
+			_tail = (_tail + 1) & _mask;
 		}
 	}
 
@@ -125,38 +136,49 @@ public:
 
 	inline bool pop_first_older_than(uint64_t timestamp, data_type *sample)
 	{
-		// start looking from newest observation data
-		for (unsigned i = 0; i < _size; i++) {
-			int index = (_head - i);
-			index = index < 0 ? _size + index : index;
+		if (timestamp < _buffer[_tail].time_us) {
+			// all samples are newer
+			return false;
+		}
 
-			if (timestamp >= _buffer[index].time_us && timestamp - _buffer[index].time_us < 100000) {
+		// binary search for the newest sample which is not newer than timestamp, counting from the tail
+		unsigned first = 0;
+		unsigned last = (_head - _tail) & _mask;
 
-				// TODO Re-evaluate the static cast and usage patterns
-				memcpy(static_cast<void *>(sample), static_cast<void *>(&_buffer[index]), sizeof(*sample));
+		while (first < last) {
+			unsigned middle = (first + last + 1) / 2;
 
-				// Now we can set the tail to the item which comes after the one we removed
-				// since we don't want to have any older data in the buffer
-				if (index == static_cast<int>(_head)) {
-					_tail = _head;
-					_first_write = true;
+			if (_buffer[(_tail + middle) & _mask].time_us <= timestamp) {
+				first = middle;
 
-				} else {
-					_tail = (index + 1) % _size;
-				}
+			} else {
+				last = middle - 1;
+			}
+		}
 
-				_buffer[index].time_us = 0;
+		unsigned index = (_tail + first) & _mask;
 
-				return true;
-			}
+		// older samples would be even further away from the timestamp
+		if (timestamp - _buffer[index].time_us >= 100000) {
+			return false;
+		}
 
-			if (index == static_cast<int>(_tail)) {
-				// we have reached the tail and haven't got a match
-				return false;
-			}
+		// TODO Re-evaluate the static cast and usage patterns
+		memcpy(static_cast<void *>(sample), static_cast<void *>(&_buffer[index]), sizeof(*sample));
+
+		// Now we can set the tail to the item which comes after the one we removed
+		// since we don't want to have any older data in the buffer
+		if (index == _head) {
+			_tail = _head;
+			_first_write = true;
+
+		} else {
+			_tail = (index + 1) & _mask;
 		}
 
-		return false;
+		_buffer[index].time_us = 0;
+
+		return true;
 	}
 
 	data_type &operator[](unsigned index)
@@ -167,8 +189,8 @@ public:
 	// return data at the specified index
 	inline data_type get_from_index(unsigned index)
 	{
-		if (index >= _size) {
-			index = _size-1;
+		if (index > _mask) {
+			index = _mask;
 		}
 		return _buffer[index];
 	}
@@ -176,21 +198,27 @@ public:
 	// push data to the specified index
 	inline void push_to_index(unsigned index, data_type sample)
 	{
-		if (index >= _size) {
-			index = _size-1;
+		if (index > _mask) {
+			index = _mask;
 		}
 		_buffer[index] = sample;
 	}
 
-	// return the length of the buffer
+	// return the number of slots of the buffer, which is the range of the indices
 	unsigned get_length()
 	{
-		return _size;
+		return _mask + 1;
+	}
+
+	// return the memory used by the buffer in bytes
+	unsigned get_total_size()
+	{
+		return sizeof(*this) + (_buffer != NULL ? sizeof(data_type) * (_mask + 1) : 0);
 	}
 
 private:
 	data_type *_buffer;
-	unsigned _head, _tail, _size;
+	unsigned _head, _tail, _size, _mask;
 	bool _first_write;
 
 };
@@ -0,0 +1,104 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2017 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file SymmetricMatrix.h
+ * Template symmetric square matrix with packed storage.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+
+/**
+ * Square matrix which is symmetric by construction: only the upper triangle (including the
+ * diagonal) is stored, row by row, and element (i, j) is the same as element (j, i).
+ * This halves the memory, and algorithms only need to compute the upper triangle.
+ * The elements are not initialised by the default constructor, use {} for a zero matrix.
+ */
+template <typename Type, size_t N>
+class SymmetricMatrix
+{
+public:
+	static constexpr size_t num_elements = N * (N + 1) / 2;
+
+	Type &operator()(size_t row, size_t col)
+	{
+		return _data[index(row, col)];
+	}
+
+	const Type &operator()(size_t row, size_t col) const
+	{
+		return _data[index(row, col)];
+	}
+
+	/**
+	 * Row of the upper triangle, indexed by the column: upperRow(row)[col] is element (row, col)
+	 * for row <= col < N. The elements of a row are contiguous from the diagonal onwards.
+	 */
+	Type *upperRow(size_t row)
+	{
+		return &_data[index(row, row)] - row;
+	}
+
+	const Type *upperRow(size_t row) const
+	{
+		return &_data[index(row, row)] - row;
+	}
+
+	void setZero()
+	{
+		memset(_data, 0, sizeof(_data));
+	}
+
+	// zero the rows and (by symmetry) the columns first to last
+	void zeroRowsCols(size_t first, size_t last)
+	{
+		for (size_t row = 0; row < first; row++) {
+			memset(&_data[index(row, first)], 0, sizeof(Type) * (1 + last - first));
+		}
+
+		// the rows first to last are contiguous from their diagonal elements onwards
+		memset(&_data[index(first, first)], 0, sizeof(Type) * (index(last, N - 1) + 1 - index(first, first)));
+	}
+
+private:
+	// position of element (row, col) in the packed upper triangle
+	static constexpr size_t index(size_t row, size_t col)
+	{
+		return row <= col ? row * (2 * N - row - 1) / 2 + col : col * (2 * N - col - 1) / 2 + row;
+	}
+
+	Type _data[num_elements];
+};
@@ -0,0 +1,1036 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2017 Estimation and Control Library (ECL). All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name ECL nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file batch_replay.cpp
+ * Offline replay of the EKF on ULog files, without the PX4 stack.
+ *
+ * The logs must contain the ekf2 replay topics (SDLOG_PROFILE bit 1, estimator replay). The inputs are passed to the EKF with
+ * the same preprocessing as in the ekf2 module (src/modules/ekf2/ekf2_main.cpp, keep them in sync), and the logs are
+ * processed in parallel, as fast as possible. For every log a CSV file with the states, innovations and test ratios
+ * is written.
+ *
+ * For regression checks the output can be compared with the output of a known-good version (-r), and the run time of
+ * the EKF updates can be measured (-t).
+ *
+ * Usage: ekf_batch_replay [-j <jobs>] [-o <output dir>] [-p <PARAM>=<value>]... [-r <reference dir> [-e <tolerance>]]
+ *                         [-t] <log.ulg>...
+ */
+
+#include <ulog/ulog_reader.h>
+
+#include <ekf.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+
+struct Options {
+	std::string output_dir; ///< empty: next to the log
+	std::map<std::string, float> parameters; ///< overrides the parameters of the logs
+	std::string reference_dir; ///< empty: no comparison
+	double tolerance{1e-3}; ///< allowed deviation from the reference, relative to max(1, |reference|)
+	bool timing{false}; ///< measure the run time of the EKF updates
+};
+
+/**
+ * Set the EKF parameters from the (logged or overridden) parameter values, see the EKF2_* parameter bindings
+ * in the ekf2 module
+ */
+void setEkfParameters(const std::map<std::string, float> &values, parameters &p)
+{
+	struct ParameterBinding {
+		const char *name;
+		float *float_value;
+		int32_t *int_value;
+	};
+
+	const ParameterBinding bindings[] = {
+		{"EKF2_MIN_OBS_DT", nullptr, &p.sensor_interval_min_ms},
+		{"EKF2_MAG_DELAY", &p.mag_delay_ms, nullptr},
+		{"EKF2_BARO_DELAY", &p.baro_delay_ms, nullptr},
+		{"EKF2_GPS_DELAY", &p.gps_delay_ms, nullptr},
+		{"EKF2_OF_DELAY", &p.flow_delay_ms, nullptr},
+		{"EKF2_RNG_DELAY", &p.range_delay_ms, nullptr},
+		{"EKF2_ASP_DELAY", &p.airspeed_delay_ms, nullptr},
+		{"EKF2_EV_DELAY", &p.ev_delay_ms, nullptr},
+		{"EKF2_GYR_NOISE", &p.gyro_noise, nullptr},
+		{"EKF2_ACC_NOISE", &p.accel_noise, nullptr},
+		{"EKF2_COV_PRED_DT", nullptr, &p.cov_pred_dt_ms},
+		{"EKF2_GYR_B_NOISE", &p.gyro_bias_p_noise, nullptr},
+		{"EKF2_ACC_B_NOISE", &p.accel_bias_p_noise, nullptr},
+		{"EKF2_MAG_E_NOISE", &p.mage_p_noise, nullptr},
+		{"EKF2_MAG_B_NOISE", &p.magb_p_noise, nullptr},
+		{"EKF2_WIND_NOISE", &p.wind_vel_p_noise, nullptr},
+		{"EKF2_TERR_NOISE", &p.terrain_p_noise, nullptr},
+		{"EKF2_TERR_GRAD", &p.terrain_gradient, nullptr},
+		{"EKF2_GPS_V_NOISE", &p.gps_vel_noise, nullptr},
+		{"EKF2_GPS_P_NOISE", &p.gps_pos_noise, nullptr},
+		{"EKF2_NOAID_NOISE", &p.pos_noaid_noise, nullptr},
+		{"EKF2_BARO_NOISE", &p.baro_noise, nullptr},
+		{"EKF2_BARO_GATE", &p.baro_innov_gate, nullptr},
+		{"EKF2_GPS_P_GATE", &p.posNE_innov_gate, nullptr},
+		{"EKF2_GPS_V_GATE", &p.vel_innov_gate, nullptr},
+		{"EKF2_TAS_GATE", &p.tas_innov_gate, nullptr},
+		{"EKF2_HEAD_NOISE", &p.mag_heading_noise, nullptr},
+		{"EKF2_MAG_NOISE", &p.mag_noise, nullptr},
+		{"EKF2_EAS_NOISE", &p.eas_noise, nullptr},
+		{"EKF2_BETA_NOISE", &p.beta_noise, nullptr},
+		{"EKF2_MAG_DECL", &p.mag_declination_deg, nullptr},
+		{"EKF2_HDG_GATE", &p.heading_innov_gate, nullptr},
+		{"EKF2_MAG_GATE", &p.mag_innov_gate, nullptr},
+		{"EKF2_DECL_TYPE", nullptr, &p.mag_declination_source},
+		{"EKF2_MAG_TYPE", nullptr, &p.mag_fusion_type},
+		{"EKF2_MAG_ACCLIM", &p.mag_acc_gate, nullptr},
+		{"EKF2_MAG_YAWLIM", &p.mag_yaw_rate_gate, nullptr},
+		{"EKF2_GPS_CHECK", nullptr, &p.gps_check_mask},
+		{"EKF2_REQ_EPH", &p.req_hacc, nullptr},
+		{"EKF2_REQ_EPV", &p.req_vacc, nullptr},
+		{"EKF2_REQ_SACC", &p.req_sacc, nullptr},
+		{"EKF2_REQ_NSATS", nullptr, &p.req_nsats},
+		{"EKF2_REQ_GDOP", &p.req_gdop, nullptr},
+		{"EKF2_REQ_HDRIFT", &p.req_hdrift, nullptr},
+		{"EKF2_REQ_VDRIFT", &p.req_vdrift, nullptr},
+		{"EKF2_AID_MASK", nullptr, &p.fusion_mode},
+		{"EKF2_HGT_MODE", nullptr, &p.vdist_sensor_type},
+		{"EKF2_RNG_NOISE", &p.range_noise, nullptr},
+		{"EKF2_RNG_SFE", &p.range_noise_scaler, nullptr},
+		{"EKF2_RNG_GATE", &p.range_innov_gate, nullptr},
+		{"EKF2_MIN_RNG", &p.rng_gnd_clearance, nullptr},
+		{"EKF2_RNG_PITCH", &p.rng_sens_pitch, nullptr},
+		{"EKF2_RNG_AID", nullptr, &p.range_aid},
+		{"EKF2_RNG_A_VMAX", &p.max_vel_for_range_aid, nullptr},
+		{"EKF2_RNG_A_HMAX", &p.max_hagl_for_range_aid, nullptr},
+		{"EKF2_RNG_A_IGATE", &p.range_aid_innov_gate, nullptr},
+		{"EKF2_EV_GATE", &p.ev_innov_gate, nullptr},
+		{"EKF2_OF_N_MIN", &p.flow_noise, nullptr},
+		{"EKF2_OF_N_MAX", &p.flow_noise_qual_min, nullptr},
+		{"EKF2_OF_QMIN", nullptr, &p.flow_qual_min},
+		{"EKF2_OF_GATE", &p.flow_innov_gate, nullptr},
+		{"EKF2_OF_RMAX", &p.flow_rate_max, nullptr},
+		{"EKF2_IMU_POS_X", &p.imu_pos_body(0), nullptr},
+		{"EKF2_IMU_POS_Y", &p.imu_pos_body(1), nullptr},
+		{"EKF2_IMU_POS_Z", &p.imu_pos_body(2), nullptr},
+		{"EKF2_GPS_POS_X", &p.gps_pos_body(0), nullptr},
+		{"EKF2_GPS_POS_Y", &p.gps_pos_body(1), nullptr},
+		{"EKF2_GPS_POS_Z", &p.gps_pos_body(2), nullptr},
+		{"EKF2_RNG_POS_X", &p.rng_pos_body(0), nullptr},
+		{"EKF2_RNG_POS_Y", &p.rng_pos_body(1), nullptr},
+		{"EKF2_RNG_POS_Z", &p.rng_pos_body(2), nullptr},
+		{"EKF2_OF_POS_X", &p.flow_pos_body(0), nullptr},
+		{"EKF2_OF_POS_Y", &p.flow_pos_body(1), nullptr},
+		{"EKF2_OF_POS_Z", &p.flow_pos_body(2), nullptr},
+		{"EKF2_EV_POS_X", &p.ev_pos_body(0), nullptr},
+		{"EKF2_EV_POS_Y", &p.ev_pos_body(1), nullptr},
+		{"EKF2_EV_POS_Z", &p.ev_pos_body(2), nullptr},
+		{"EKF2_TAU_VEL", &p.vel_Tau, nullptr},
+		{"EKF2_TAU_POS", &p.pos_Tau, nullptr},
+		{"EKF2_GBIAS_INIT", &p.switch_on_gyro_bias, nullptr},
+		{"EKF2_ABIAS_INIT", &p.switch_on_accel_bias, nullptr},
+		{"EKF2_ANGERR_INIT", &p.initial_tilt_err, nullptr},
+		{"EKF2_ABL_LIM", &p.acc_bias_lim, nullptr},
+		{"EKF2_ABL_ACCLIM", &p.acc_bias_learn_acc_lim, nullptr},
+		{"EKF2_ABL_GYRLIM", &p.acc_bias_learn_gyr_lim, nullptr},
+		{"EKF2_ABL_TAU", &p.acc_bias_learn_tc, nullptr},
+		{"EKF2_DRAG_NOISE", &p.drag_noise, nullptr},
+		{"EKF2_BCOEF_X", &p.bcoef_x, nullptr},
+		{"EKF2_BCOEF_Y", &p.bcoef_y, nullptr},
+	};
+
+	for (const ParameterBinding &binding : bindings) {
+		auto value = values.find(binding.name);
+
+		if (value == values.end()) {
+			continue;
+		}
+
+		if (binding.float_value) {
+			*binding.float_value = value->second;
+
+		} else {
+			*binding.int_value = (int32_t)value->second;
+		}
+	}
+}
+
+float getParameter(const std::map<std::string, float> &values, const char *name, float default_value)
+{
+	auto value = values.find(name);
+	return value != values.end() ? value->second : default_value;
+}
+
+/**
+ * Logged messages of a topic, consumed in order
+ */
+struct Topic {
+	Topic(const ULogReader &reader, const char *topic_name) :
+		name(topic_name),
+		timestamp(reader.findField(topic_name, "timestamp"))
+	{}
+
+	ULogReader::Field field(const ULogReader &reader, const char *field_name) const
+	{
+		return reader.findField(name, field_name);
+	}
+
+	uint64_t timestamp_of(size_t i) const { return (uint64_t)timestamp.get(messages[i]); }
+
+	/**
+	 * get the latest message with a timestamp <= time
+	 * @return nullptr if there is no new message
+	 */
+	const uint8_t *latest(uint64_t time)
+	{
+		const uint8_t *message = nullptr;
+
+		while (index < messages.size() && timestamp_of(index) <= time) {
+			message = messages[index++];
+		}
+
+		return message;
+	}
+
+	/**
+	 * get the message with a timestamp matching time (in units of 0.1 ms, as in ekf2_timestamps)
+	 * @return nullptr if not found
+	 */
+	const uint8_t *matching(uint64_t time_100us)
+	{
+		while (index < messages.size() && timestamp_of(index) / 100 < time_100us) {
+			++index;
+		}
+
+		if (index < messages.size() && timestamp_of(index) / 100 == time_100us) {
+			return messages[index++];
+		}
+
+		return nullptr;
+	}
+
+	const char *name;
+	ULogReader::Field timestamp;
+	std::vector<const uint8_t *> messages;
+	size_t index{0}; ///< next message
+};
+
+void writeCsvHeader(FILE *file)
+{
+	fprintf(file, "timestamp");
+
+	for (int i = 0; i < 24; i++) {
+		fprintf(file, ",state[%i]", i);
+	}
+
+	for (int i = 0; i < 6; i++) {
+		fprintf(file, ",vel_pos_innov[%i]", i);
+	}
+
+	for (int i = 0; i < 3; i++) {
+		fprintf(file, ",mag_innov[%i]", i);
+	}
+
+	fprintf(file, ",heading_innov,airspeed_innov,beta_innov,flow_innov[0],flow_innov[1],hagl_innov"
+		",mag_test_ratio,vel_test_ratio,pos_test_ratio,hgt_test_ratio,tas_test_ratio,hagl_test_ratio"
+		",innovation_check_flags,control_mode_flags,filter_fault_flags\n");
+}
+
+void writeCsvRow(FILE *file, uint64_t timestamp, Ekf &ekf)
+{
+	float states[24];
+	ekf.get_state_delayed(states);
+
+	float vel_pos_innov[6];
+	float mag_innov[3];
+	float heading_innov, airspeed_innov, beta_innov, hagl_innov;
+	float flow_innov[2];
+	ekf.get_vel_pos_innov(vel_pos_innov);
+	ekf.get_mag_innov(mag_innov);
+	ekf.get_heading_innov(&heading_innov);
+	ekf.get_airspeed_innov(&airspeed_innov);
+	ekf.get_beta_innov(&beta_innov);
+	ekf.get_flow_innov(flow_innov);
+	ekf.get_hagl_innov(&hagl_innov);
+
+	uint16_t innovation_check_flags;
+	float mag, vel, pos, hgt, tas, hagl;
+	ekf.get_innovation_test_status(&innovation_check_flags, &mag, &vel, &pos, &hgt, &tas, &hagl);
+
+	uint32_t control_mode;
+	uint16_t filter_fault;
+	ekf.get_control_mode(&control_mode);
+	ekf.get_filter_fault_status(&filter_fault);
+
+	fprintf(file, "%" PRIu64, timestamp);
+
+	for (int i = 0; i < 24; i++) {
+		fprintf(file, ",%.7g", (double)states[i]);
+	}
+
+	for (int i = 0; i < 6; i++) {
+		fprintf(file, ",%.7g", (double)vel_pos_innov[i]);
+	}
+
+	for (int i = 0; i < 3; i++) {
+		fprintf(file, ",%.7g", (double)mag_innov[i]);
+	}
+
+	fprintf(file, ",%.7g,%.7g,%.7g,%.7g,%.7g,%.7g,%.7g,%.7g,%.7g,%.7g,%.7g,%.7g,%u,%u,%u\n",
+		(double)heading_innov, (double)airspeed_innov, (double)beta_innov, (double)flow_innov[0], (double)flow_innov[1],
+		(double)hagl_innov, (double)mag, (double)vel, (double)pos, (double)hgt, (double)tas, (double)hagl,
+		innovation_check_flags, control_mode, filter_fault);
+}
+
+std::string outputFileName(const std::string &log_file_name, const Options &options)
+{
+	std::string base = log_file_name;
+	const size_t extension = base.rfind(".ulg");
+
+	if (extension != std::string::npos && extension == base.size() - 4) {
+		base.erase(extension);
+	}
+
+	if (!options.output_dir.empty()) {
+		const size_t slash = base.rfind('/');
+		base = options.output_dir + "/" + (slash != std::string::npos ? base.substr(slash + 1) : base);
+	}
+
+	return base + "_ekf.csv";
+}
+
+void splitCsvLine(const std::string &line, std::vector<std::string> &values)
+{
+	values.clear();
+	size_t start = 0;
+	size_t comma;
+
+	while ((comma = line.find(',', start)) != std::string::npos) {
+		values.push_back(line.substr(start, comma - start));
+		start = comma + 1;
+	}
+
+	values.push_back(line.substr(start));
+}
+
+/**
+ * compare the CSV output of a log with a reference output. The timestamps and the status flags must match exactly,
+ * the other values within the tolerance.
+ * @param result largest deviation, or the first mismatch
+ * @return true if the output matches
+ */
+bool compareCsv(const std::string &file_name, const std::string &reference_file_name, double tolerance,
+		std::string &result)
+{
+	std::ifstream file(file_name);
+	std::ifstream reference(reference_file_name);
+
+	if (!reference) {
+		result = "no reference " + reference_file_name;
+		return false;
+	}
+
+	std::string line, reference_line;
+	std::vector<std::string> header, values, reference_values;
+
+	if (!std::getline(file, line) || !std::getline(reference, reference_line) || line != reference_line) {
+		result = "columns differ from " + reference_file_name;
+		return false;
+	}
+
+	splitCsvLine(line, header);
+
+	double max_deviation = 0.0;
+	size_t max_column = 0;
+	std::string max_timestamp;
+	size_t row = 0;
+	char buffer[256];
+
+	while (std::getline(reference, reference_line)) {
+		if (!std::getline(file, line)) {
+			snprintf(buffer, sizeof(buffer), "fewer updates than the reference (%zu)", row);
+			result = buffer;
+			return false;
+		}
+
+		splitCsvLine(line, values);
+		splitCsvLine(reference_line, reference_values);
+
+		if (values.size() != header.size() || reference_values.size() != header.size()) {
+			snprintf(buffer, sizeof(buffer), "invalid row %zu", row + 1);
+			result = buffer;
+			return false;
+		}
+
+		for (size_t i = 0; i < header.size(); i++) {
+			const bool exact = i == 0 || header[i].find("_flags") != std::string::npos;
+
+			if (exact) {
+				if (values[i] != reference_values[i]) {
+					snprintf(buffer, sizeof(buffer), "%s differs at %s: %s, reference %s", header[i].c_str(),
+						 reference_values[0].c_str(), values[i].c_str(), reference_values[i].c_str());
+					result = buffer;
+					return false;
+				}
+
+				continue;
+			}
+
+			const double value = strtod(values[i].c_str(), nullptr);
+			const double reference_value = strtod(reference_values[i].c_str(), nullptr);
+
+			if (std::isnan(value) || std::isnan(reference_value)) {
+				if (std::isnan(value) != std::isnan(reference_value)) {
+					max_deviation = INFINITY;
+					max_column = i;
+					max_timestamp = reference_values[0];
+				}
+
+				continue;
+			}
+
+			const double deviation = fabs(value - reference_value) / std::max(1.0, fabs(reference_value));
+
+			if (deviation > max_deviation) {
+				max_deviation = deviation;
+				max_column = i;
+				max_timestamp = reference_values[0];
+			}
+		}
+
+		row++;
+	}
+
+	if (std::getline(file, line)) {
+		snprintf(buffer, sizeof(buffer), "more updates than the reference (%zu)", row);
+		result = buffer;
+		return false;
+	}
+
+	if (max_deviation > 0.0) {
+		snprintf(buffer, sizeof(buffer), "max deviation %.3g in %s at %s", max_deviation, header[max_column].c_str(),
+			 max_timestamp.c_str());
+		result = buffer;
+
+	} else {
+		result = "identical";
+	}
+
+	return max_deviation <= tolerance;
+}
+
+/**
+ * format the percentiles of the update run times [us]
+ */
+std::string timingSummary(std::vector<float> &update_times)
+{
+	if (update_times.empty()) {
+		return "no updates";
+	}
+
+	std::sort(update_times.begin(), update_times.end());
+
+	auto percentile = [&update_times](float p) {
+		return (double)update_times[(size_t)(p * (update_times.size() - 1) + 0.5f)];
+	};
+
+	char buffer[128];
+	snprintf(buffer, sizeof(buffer), "update time p50 %.1f us, p90 %.1f us, p99 %.1f us, max %.1f us",
+		 percentile(0.5f), percentile(0.9f), percentile(0.99f), (double)update_times.back());
+	return buffer;
+}
+
+/**
+ * replay a log
+ * @param status result summary, or error
+ * @return true on success
+ */
+bool replayLog(const std::string &log_file_name, const Options &options, std::string &status)
+{
+	ULogReader reader;
+
+	if (!reader.open(log_file_name.c_str())) {
+		status = reader.error();
+		return false;
+	}
+
+	Topic ekf2_timestamps(reader, "ekf2_timestamps");
+	Topic sensor_combined(reader, "sensor_combined");
+	Topic gps(reader, "vehicle_gps_position");
+	Topic airspeed(reader, "airspeed");
+	Topic optical_flow(reader, "optical_flow");
+	Topic distance_sensor(reader, "distance_sensor");
+	Topic vision_position(reader, "vehicle_vision_position");
+	Topic vision_attitude(reader, "vehicle_vision_attitude");
+	Topic vehicle_status(reader, "vehicle_status");
+	Topic land_detected(reader, "vehicle_land_detected");
+	Topic sensor_baro(reader, "sensor_baro");
+
+	Topic *topics[] = {&ekf2_timestamps, &sensor_combined, &gps, &airspeed, &optical_flow, &distance_sensor,
+			   &vision_position, &vision_attitude, &vehicle_status, &land_detected, &sensor_baro
+			  };
+
+	// only a downward facing range finder is used (ROTATION_DOWNWARD_FACING)
+	const ULogReader::Field range_orientation = distance_sensor.field(reader, "orientation");
+
+	ULogReader::Message message;
+
+	while (reader.next(message)) {
+		if (message.subscription->multi_id != 0 && message.subscription->name != "distance_sensor") {
+			continue;
+		}
+
+		for (Topic *topic : topics) {
+			if (message.subscription->name == topic->name && topic->timestamp.valid()) {
+				if (topic != &distance_sensor || (int)range_orientation.get(message.data) == 25) {
+					topic->messages.push_back(message.data);
+				}
+			}
+		}
+	}
+
+	if (ekf2_timestamps.messages.empty() || sensor_combined.messages.empty()) {
+		status = "no ekf2 replay data (ekf2_timestamps, sensor_combined)";
+		return false;
+	}
+
+	// parameters
+	std::map<std::string, float> parameter_values = reader.parameters();
+
+	for (const auto &parameter : options.parameters) {
+		parameter_values[parameter.first] = parameter.second;
+	}
+
+	Ekf ekf;
+	parameters *params = ekf.getParamHandle();
+	setEkfParameters(parameter_values, *params);
+
+	const float mag_bias[3] = {
+		getParameter(parameter_values, "EKF2_MAGBIAS_X", 0.0f),
+		getParameter(parameter_values, "EKF2_MAGBIAS_Y", 0.0f),
+		getParameter(parameter_values, "EKF2_MAGBIAS_Z", 0.0f)
+	};
+	const float arsp_thr = getParameter(parameter_values, "EKF2_ARSP_THR", 0.0f);
+	const bool airspeed_disabled = getParameter(parameter_values, "FW_ARSP_MODE", 0.0f) > 0.5f;
+	const bool fuse_beta_enabled = (int)getParameter(parameter_values, "EKF2_FUSE_BETA", 0.0f) == 1;
+	const float ev_pos_noise = getParameter(parameter_values, "EKF2_EVP_NOISE", 0.05f);
+	const float ev_ang_noise = getParameter(parameter_values, "EKF2_EVA_NOISE", 0.05f);
+	const float aspd_max = getParameter(parameter_values, "EKF2_ASPD_MAX", 20.0f);
+	const float pcoef_xp = getParameter(parameter_values, "EKF2_PCOEF_XP", 0.0f);
+	const float pcoef_xn = getParameter(parameter_values, "EKF2_PCOEF_XN", 0.0f);
+	const float pcoef_y = getParameter(parameter_values, "EKF2_PCOEF_Y", 0.0f);
+	const float pcoef_z = getParameter(parameter_values, "EKF2_PCOEF_Z", 0.0f);
+
+	// fields
+	const ULogReader::Field ts_gps = ekf2_timestamps.field(reader, "gps_timestamp_rel");
+	const ULogReader::Field ts_flow = ekf2_timestamps.field(reader, "optical_flow_timestamp_rel");
+	const ULogReader::Field ts_range = ekf2_timestamps.field(reader, "distance_sensor_timestamp_rel");
+	const ULogReader::Field ts_airspeed = ekf2_timestamps.field(reader, "airspeed_timestamp_rel");
+	const ULogReader::Field ts_ev_pos = ekf2_timestamps.field(reader, "vision_position_timestamp_rel");
+	const ULogReader::Field ts_ev_att = ekf2_timestamps.field(reader, "vision_attitude_timestamp_rel");
+
+	const ULogReader::Field sc_gyro_rad = sensor_combined.field(reader, "gyro_rad");
+	const ULogReader::Field sc_gyro_dt = sensor_combined.field(reader, "gyro_integral_dt");
+	const ULogReader::Field sc_accel = sensor_combined.field(reader, "accelerometer_m_s2");
+	const ULogReader::Field sc_accel_dt = sensor_combined.field(reader, "accelerometer_integral_dt");
+	const ULogReader::Field sc_mag_rel = sensor_combined.field(reader, "magnetometer_timestamp_relative");
+	const ULogReader::Field sc_mag = sensor_combined.field(reader, "magnetometer_ga");
+	const ULogReader::Field sc_baro_rel = sensor_combined.field(reader, "baro_timestamp_relative");
+	const ULogReader::Field sc_baro_alt = sensor_combined.field(reader, "baro_alt_meter");
+
+	const ULogReader::Field gps_lat = gps.field(reader, "lat");
+	const ULogReader::Field gps_lon = gps.field(reader, "lon");
+	const ULogReader::Field gps_alt = gps.field(reader, "alt");
+	const ULogReader::Field gps_fix_type = gps.field(reader, "fix_type");
+	const ULogReader::Field gps_eph = gps.field(reader, "eph");
+	const ULogReader::Field gps_epv = gps.field(reader, "epv");
+	const ULogReader::Field gps_sacc = gps.field(reader, "s_variance_m_s");
+	const ULogReader::Field gps_vel = gps.field(reader, "vel_m_s");
+	const ULogReader::Field gps_vel_n = gps.field(reader, "vel_n_m_s");
+	const ULogReader::Field gps_vel_e = gps.field(reader, "vel_e_m_s");
+	const ULogReader::Field gps_vel_d = gps.field(reader, "vel_d_m_s");
+	const ULogReader::Field gps_vel_ned_valid = gps.field(reader, "vel_ned_valid");
+	const ULogReader::Field gps_nsats = gps.field(reader, "satellites_used");
+
+	const ULogReader::Field airspeed_ias = airspeed.field(reader, "indicated_airspeed_m_s");
+	const ULogReader::Field airspeed_tas = airspeed.field(reader, "true_airspeed_m_s");
+
+	const ULogReader::Field flow_x = optical_flow.field(reader, "pixel_flow_x_integral");
+	const ULogReader::Field flow_y = optical_flow.field(reader, "pixel_flow_y_integral");
+	const ULogReader::Field flow_quality = optical_flow.field(reader, "quality");
+	const ULogReader::Field flow_gyro_x = optical_flow.field(reader, "gyro_x_rate_integral");
+	const ULogReader::Field flow_gyro_y = optical_flow.field(reader, "gyro_y_rate_integral");
+	const ULogReader::Field flow_gyro_z = optical_flow.field(reader, "gyro_z_rate_integral");
+	const ULogReader::Field flow_dt = optical_flow.field(reader, "integration_timespan");
+
+	const ULogReader::Field range_distance = distance_sensor.field(reader, "current_distance");
+	const ULogReader::Field range_min = distance_sensor.field(reader, "min_distance");
+	const ULogReader::Field range_max = distance_sensor.field(reader, "max_distance");
+
+	const ULogReader::Field ev_x = vision_position.field(reader, "x");
+	const ULogReader::Field ev_y = vision_position.field(reader, "y");
+	const ULogReader::Field ev_z = vision_position.field(reader, "z");
+	const ULogReader::Field ev_q = vision_attitude.field(reader, "q");
+
+	const ULogReader::Field status_rotary_wing = vehicle_status.field(reader, "is_rotary_wing");
+	const ULogReader::Field land_detected_landed = land_detected.field(reader, "landed");
+	const ULogReader::Field baro_pressure = sensor_baro.field(reader, "pressure");
+
+	const std::string output_file_name = outputFileName(log_file_name, options);
+	FILE *output = fopen(output_file_name.c_str(), "w");
+
+	if (!output) {
+		status = "failed to open " + output_file_name;
+		return false;
+	}
+
+	writeCsvHeader(output);
+
+	static constexpr int relative_timestamp_invalid = 0x7fff; // ekf2_timestamps
+	static constexpr int64_t sensor_relative_timestamp_invalid = 0x7fffffff; // sensor_combined
+
+	// state of the input preprocessing, as in the ekf2 module
+	uint64_t timestamp_mag_us = 0;
+	uint64_t mag_time_sum_ms = 0;
+	uint8_t mag_sample_count = 0;
+	float mag_data_sum[3] = {};
+	uint32_t mag_time_ms_last_used = 0;
+	uint64_t timestamp_balt_us = 0;
+	uint64_t balt_time_sum_ms = 0;
+	uint8_t balt_sample_count = 0;
+	float balt_data_sum = 0.0f;
+	uint32_t balt_time_ms_last_used = 0;
+	float baro_pressure_mbar = 1013.5f;
+	bool is_rotary_wing = true;
+	float vel_body_wind[3] = {};
+
+	const uint8_t *ev_pos_message = nullptr;
+	const uint8_t *ev_att_message = nullptr;
+	size_t num_updates = 0;
+	std::vector<float> update_times; ///< run times of the updates that ran the filter [us]
+
+	if (options.timing) {
+		update_times.reserve(ekf2_timestamps.messages.size());
+	}
+
+	for (const uint8_t *timestamps : ekf2_timestamps.messages) {
+		const uint64_t now = (uint64_t)ekf2_timestamps.timestamp.get(timestamps);
+		const uint8_t *sensors = sensor_combined.latest(now);
+
+		if (!sensors || sensor_combined.timestamp_of(sensor_combined.index - 1) != now) {
+			continue;
+		}
+
+		// latest state
+		const uint8_t *status_message = vehicle_status.latest(now);
+		const bool vehicle_status_updated = status_message != nullptr;
+
+		if (vehicle_status_updated) {
+			is_rotary_wing = status_rotary_wing.get(status_message) > 0.5;
+		}
+
+		const uint8_t *land_detected_message = land_detected.latest(now);
+
+		const uint8_t *baro_message = sensor_baro.latest(now);
+
+		if (baro_message) {
+			baro_pressure_mbar = (float)baro_pressure.get(baro_message);
+		}
+
+		// data used by this iteration of ekf2
+		auto matching = [&](Topic & topic, const ULogReader::Field & relative) -> const uint8_t * {
+			const int rel = (int)relative.get(timestamps);
+			return rel == relative_timestamp_invalid ? nullptr : topic.matching(now / 100 + rel);
+		};
+
+		const uint8_t *gps_data = matching(gps, ts_gps);
+		const uint8_t *airspeed_data = airspeed_disabled ? nullptr : matching(airspeed, ts_airspeed);
+		const uint8_t *flow_data = matching(optical_flow, ts_flow);
+		const uint8_t *range_update = matching(distance_sensor, ts_range);
+		const uint8_t *ev_pos_update = matching(vision_position, ts_ev_pos);
+		const uint8_t *ev_att_update = matching(vision_attitude, ts_ev_att);
+
+		// IMU
+		const uint32_t gyro_integral_dt = (uint32_t)sc_gyro_dt.get(sensors);
+		const uint32_t accel_integral_dt = (uint32_t)sc_accel_dt.get(sensors);
+		float gyro_integral[3];
+		float accel_integral[3];
+
+		for (int i = 0; i < 3; i++) {
+			gyro_integral[i] = (float)sc_gyro_rad.get(sensors, i) * gyro_integral_dt / 1.e6f;
+			accel_integral[i] = (float)sc_accel.get(sensors, i) * accel_integral_dt / 1.e6f;
+		}
+
+		ekf.setIMUData(now, gyro_integral_dt, accel_integral_dt, gyro_integral, accel_integral);
+
+		// magnetometer, averaged over the minimum observation interval
+		const int64_t mag_rel = (int64_t)sc_mag_rel.get(sensors);
+
+		if (mag_rel == sensor_relative_timestamp_invalid) {
+			timestamp_mag_us = 0;
+
+		} else if (now + mag_rel != timestamp_mag_us) {
+			timestamp_mag_us = now + mag_rel;
+			mag_time_sum_ms += timestamp_mag_us / 1000;
+			mag_sample_count++;
+
+			for (int i = 0; i < 3; i++) {
+				mag_data_sum[i] += (float)sc_mag.get(sensors, i);
+			}
+
+			const uint32_t mag_time_ms = mag_time_sum_ms / mag_sample_count;
+
+			if (mag_time_ms - mag_time_ms_last_used > (uint32_t)params->sensor_interval_min_ms) {
+				float mag_data_avg_ga[3];
+
+				for (int i = 0; i < 3; i++) {
+					mag_data_avg_ga[i] = mag_data_sum[i] / (float)mag_sample_count - mag_bias[i];
+					mag_data_sum[i] = 0.0f;
+				}
+
+				ekf.setMagData(1000 * (uint64_t)mag_time_ms, mag_data_avg_ga);
+				mag_time_ms_last_used = mag_time_ms;
+				mag_time_sum_ms = 0;
+				mag_sample_count = 0;
+			}
+		}
+
+		// barometer, averaged and corrected for the static pressure error
+		const int64_t baro_rel = (int64_t)sc_baro_rel.get(sensors);
+
+		if (baro_rel == sensor_relative_timestamp_invalid) {
+			timestamp_balt_us = 0;
+
+		} else if (now + baro_rel != timestamp_balt_us) {
+			timestamp_balt_us = now + baro_rel;
+			balt_time_sum_ms += timestamp_balt_us / 1000;
+			balt_sample_count++;
+			balt_data_sum += (float)sc_baro_alt.get(sensors);
+			const uint32_t balt_time_ms = balt_time_sum_ms / balt_sample_count;
+
+			if (balt_time_ms - balt_time_ms_last_used > (uint32_t)params->sensor_interval_min_ms) {
+				float balt_data_avg = balt_data_sum / (float)balt_sample_count;
+
+				const float pressure_to_density = 100.0f / (CONSTANTS_AIR_GAS_CONST * (20.0f - CONSTANTS_ABSOLUTE_NULL_CELSIUS));
+				const float rho = pressure_to_density * baro_pressure_mbar;
+				ekf.set_air_density(rho);
+
+				const float max_airspeed_sq = aspd_max * aspd_max;
+				const float pcoef_x = vel_body_wind[0] >= 0.0f ? pcoef_xp : pcoef_xn;
+				const float pstatic_err = 0.5f * rho * (pcoef_x * fminf(vel_body_wind[0] * vel_body_wind[0], max_airspeed_sq) +
+							  pcoef_y * fminf(vel_body_wind[1] * vel_body_wind[1], max_airspeed_sq) +
+							  pcoef_z * fminf(vel_body_wind[2] * vel_body_wind[2], max_airspeed_sq));
+				balt_data_avg += pstatic_err / (rho * CONSTANTS_ONE_G);
+
+				ekf.setBaroData(1000 * (uint64_t)balt_time_ms, balt_data_avg);
+				balt_time_ms_last_used = balt_time_ms;
+				balt_time_sum_ms = 0;
+				balt_sample_count = 0;
+				balt_data_sum = 0.0f;
+			}
+		}
+
+		if (gps_data) {
+			gps_message gps_msg;
+			gps_msg.time_usec = gps.timestamp_of(gps.index - 1);
+			gps_msg.lat = (int32_t)gps_lat.get(gps_data);
+			gps_msg.lon = (int32_t)gps_lon.get(gps_data);
+			gps_msg.alt = (int32_t)gps_alt.get(gps_data);
+			gps_msg.fix_type = (uint8_t)gps_fix_type.get(gps_data);
+			gps_msg.eph = (float)gps_eph.get(gps_data);
+			gps_msg.epv = (float)gps_epv.get(gps_data);
+			gps_msg.sacc = (float)gps_sacc.get(gps_data);
+			gps_msg.vel_m_s = (float)gps_vel.get(gps_data);
+			gps_msg.vel_ned[0] = (float)gps_vel_n.get(gps_data);
+			gps_msg.vel_ned[1] = (float)gps_vel_e.get(gps_data);
+			gps_msg.vel_ned[2] = (float)gps_vel_d.get(gps_data);
+			gps_msg.vel_ned_valid = gps_vel_ned_valid.get(gps_data) > 0.5;
+			gps_msg.nsats = (uint8_t)gps_nsats.get(gps_data);
+			gps_msg.gdop = 0.0f;
+
+			ekf.setGpsData(gps_msg.time_usec, &gps_msg);
+		}
+
+		if (airspeed_data) {
+			const float true_airspeed = (float)airspeed_tas.get(airspeed_data);
+
+			if (!is_rotary_wing && arsp_thr > FLT_EPSILON && true_airspeed > arsp_thr) {
+				const float eas2tas = true_airspeed / (float)airspeed_ias.get(airspeed_data);
+				ekf.setAirspeedData(airspeed.timestamp_of(airspeed.index - 1), true_airspeed, eas2tas);
+			}
+		}
+
+		if (vehicle_status_updated) {
+			ekf.set_fuse_beta_flag(!is_rotary_wing && fuse_beta_enabled);
+			ekf.set_is_fixed_wing(!is_rotary_wing);
+		}
+
+		if (flow_data) {
+			flow_message flow;
+			flow.flowdata(0) = (float)flow_x.get(flow_data);
+			flow.flowdata(1) = (float)flow_y.get(flow_data);
+			flow.quality = (uint8_t)flow_quality.get(flow_data);
+			flow.gyrodata(0) = (float)flow_gyro_x.get(flow_data);
+			flow.gyrodata(1) = (float)flow_gyro_y.get(flow_data);
+			flow.gyrodata(2) = (float)flow_gyro_z.get(flow_data);
+			flow.dt = (uint32_t)flow_dt.get(flow_data);
+
+			if (std::isfinite(flow.flowdata(0)) && std::isfinite(flow.flowdata(1))) {
+				ekf.setOpticalFlowData(optical_flow.timestamp_of(optical_flow.index - 1), &flow);
+			}
+		}
+
+		if (range_update) {
+			float distance = (float)range_distance.get(range_update);
+			bool use_range = true;
+
+			// outside of the working range: use the ground clearance if on ground
+			if (range_min.get(range_update) >= distance || range_max.get(range_update) <= distance) {
+				if (ekf.get_in_air_status()) {
+					use_range = false;
+
+				} else {
+					distance = params->rng_gnd_clearance;
+				}
+			}
+
+			if (use_range) {
+				ekf.setRangeData(distance_sensor.timestamp_of(distance_sensor.index - 1), distance);
+			}
+		}
+
+		if (ev_pos_update || ev_att_update) {
+			ev_pos_message = ev_pos_update ? ev_pos_update : ev_pos_message;
+			ev_att_message = ev_att_update ? ev_att_update : ev_att_message;
+
+			ext_vision_message ev_data;
+			ev_data.posNED.setZero();
+			ev_data.quat = matrix::Quatf();
+
+			if (ev_pos_message) {
+				ev_data.posNED(0) = (float)ev_x.get(ev_pos_message);
+				ev_data.posNED(1) = (float)ev_y.get(ev_pos_message);
+				ev_data.posNED(2) = (float)ev_z.get(ev_pos_message);
+			}
+
+			if (ev_att_message) {
+				for (int i = 0; i < 4; i++) {
+					ev_data.quat(i) = (float)ev_q.get(ev_att_message, i);
+				}
+			}
+
+			ev_data.posErr = ev_pos_noise;
+			ev_data.angErr = ev_ang_noise;
+
+			const uint64_t ev_time = ev_pos_update ? vision_position.timestamp_of(vision_position.index - 1) :
+						 vision_attitude.timestamp_of(vision_attitude.index - 1);
+			ekf.setExtVisionData(ev_time, &ev_data);
+		}
+
+		if (land_detected_message) {
+			ekf.set_in_air_status(land_detected_landed.get(land_detected_message) < 0.5);
+		}
+
+		const auto update_start = std::chrono::steady_clock::now();
+		const bool updated = ekf.update();
+
+		if (options.timing && updated) {
+			update_times.push_back(std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() -
+					       update_start).count());
+		}
+
+		if (updated) {
+			writeCsvRow(output, now, ekf);
+			num_updates++;
+
+			// wind relative velocity in body frame, for the static pressure correction
+			float velocity[3];
+			float wind[2];
+			float q[4];
+			ekf.get_velocity(velocity);
+			ekf.get_wind_velocity(wind);
+			ekf.copy_quaternion(q);
+			matrix::Vector3f v_wind_comp(velocity[0] - wind[0], velocity[1] - wind[1], velocity[2]);
+			const matrix::Dcmf R_to_body(matrix::Quatf(q).inversed());
+			const matrix::Vector3f v_body = R_to_body * v_wind_comp;
+			vel_body_wind[0] = v_body(0);
+			vel_body_wind[1] = v_body(1);
+			vel_body_wind[2] = v_body(2);
+		}
+	}
+
+	fclose(output);
+
+	char summary[128];
+	snprintf(summary, sizeof(summary), "%zu updates, %.1f s of data -> ", num_updates,
+		 (sensor_combined.timestamp_of(sensor_combined.messages.size() - 1) - sensor_combined.timestamp_of(0)) * 1e-6);
+	status = summary + output_file_name;
+
+	if (options.timing) {
+		status += "\n  " + timingSummary(update_times);
+	}
+
+	if (!options.reference_dir.empty()) {
+		const size_t slash = output_file_name.rfind('/');
+		const std::string reference_file_name = options.reference_dir + "/" +
+							(slash != std::string::npos ? output_file_name.substr(slash + 1) : output_file_name);
+		std::string result;
+		const bool matches = compareCsv(output_file_name, reference_file_name, options.tolerance, result);
+		status += std::string("\n  reference: ") + (matches ? "ok, " : "FAILED, ") + result;
+		return matches;
+	}
+
+	return true;
+}
+
+int printUsage(const char *reason)
+{
+	if (reason) {
+		fprintf(stderr, "%s\n\n", reason);
+	}
+
+	fprintf(stderr, "Replay the EKF offline on ULog files with the ekf2 replay topics, and write the states,\n"
+		"innovations and test ratios to <log>_ekf.csv. The logs are processed in parallel.\n\n"
+		"Usage: ekf_batch_replay [-j <jobs>] [-o <output dir>] [-p <PARAM>=<value>]... [-r <reference dir> [-e <tolerance>]]\n"
+		"                        [-t] <log.ulg>...\n"
+		"  -j  number of logs processed in parallel (default: number of cores)\n"
+		"  -o  directory for the CSV files (default: next to the logs)\n"
+		"  -p  override a parameter of the logs, e.g. -p EKF2_GPS_DELAY=120\n"
+		"  -r  compare the CSV files with the ones of the same name in this directory, fail on a mismatch\n"
+		"  -e  allowed deviation from the reference, relative to max(1, |reference value|) (default: 1e-3)\n"
+		"  -t  report the percentiles of the EKF update run time (use -j 1 for repeatable results)\n");
+	return 1;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+	Options options;
+	unsigned num_jobs = std::thread::hardware_concurrency();
+	std::vector<std::string> log_files;
+
+	for (int i = 1; i < argc; i++) {
+		const std::string arg = argv[i];
+
+		if ((arg == "-j" || arg == "-o" || arg == "-p" || arg == "-r" || arg == "-e") && i + 1 >= argc) {
+			return printUsage("missing argument");
+		}
+
+		if (arg == "-j") {
+			num_jobs = atoi(argv[++i]);
+
+		} else if (arg == "-o") {
+			options.output_dir = argv[++i];
+
+		} else if (arg == "-p") {
+			const std::string parameter = argv[++i];
+			const size_t equal = parameter.find('=');
+
+			if (equal == std::string::npos) {
+				return printUsage("invalid parameter override");
+			}
+
+			options.parameters[parameter.substr(0, equal)] = strtof(parameter.c_str() + equal + 1, nullptr);
+
+		} else if (arg == "-r") {
+			options.reference_dir = argv[++i];
+
+		} else if (arg == "-e") {
+			options.tolerance = strtod(argv[++i], nullptr);
+
+		} else if (arg == "-t") {
+			options.timing = true;
+
+		} else if (arg[0] == '-') {
+			return printUsage(nullptr);
+
+		} else {
+			log_files.push_back(arg);
+		}
+	}
+
+	if (log_files.empty()) {
+		return printUsage("no log files");
+	}
+
+	if (num_jobs < 1) {
+		num_jobs = 1;
+	}
+
+	if (num_jobs > log_files.size()) {
+		num_jobs = log_files.size();
+	}
+
+	// each worker takes the next log until all are done
+	std::atomic<size_t> next_log{0};
+	std::atomic<int> num_failed{0};
+	std::mutex print_mutex;
+	std::vector<std::thread> workers;
+
+	for (unsigned i = 0; i < num_jobs; i++) {
+		workers.emplace_back([&]() {
+			size_t index;
+
+			while ((index = next_log++) < log_files.size()) {
+				std::string status;
+				const bool success = replayLog(log_files[index], options, status);
+
+				if (!success) {
+					num_failed++;
+				}
+
+				std::lock_guard<std::mutex> lock(print_mutex);
+				printf("%s: %s%s\n", log_files[index].c_str(), success ? "" : "error: ", status.c_str());
+			}
+		});
+	}
+
+	for (std::thread &worker : workers) {
+		worker.join();
+	}
+
+	return num_failed > 0 ? 1 : 0;
+}
@@ -40,6 +40,8 @@
  *
  */
 
+#pragma once
+
 namespace estimator
 {
 
@@ -191,6 +193,25 @@ struct dragSample {
 #define BADACC_PROBATION	10E6	///< Period of time that accel data declared bad must continuously pass checks to be declared good again (uSec)
 #define BADACC_BIAS_PNOISE	4.9f	///< The delta velocity process noise is set to this when accel data is declared bad (m/sec**2)
 
+// stages of Ekf::update() with a separate execution time measurement (see Ekf::get_stage_times())
+enum ekf_timing_stage {
+	TIMING_PREDICT_STATE = 0,	///< predictState()
+	TIMING_PREDICT_COVARIANCE,	///< predictCovariance()
+	TIMING_CONTROL,			///< alignment, observation buffer handling and height sensor timeouts in controlFusionModes()
+	TIMING_MAG,			///< controlMagFusion()
+	TIMING_OPTICAL_FLOW,		///< controlOpticalFlowFusion()
+	TIMING_GPS,			///< controlGpsFusion()
+	TIMING_AIR_DATA,		///< controlAirDataFusion()
+	TIMING_BETA,			///< controlBetaFusion()
+	TIMING_DRAG,			///< controlDragFusion()
+	TIMING_HEIGHT,			///< controlHeightFusion()
+	TIMING_VEL_POS,			///< controlVelPosFusion()
+	TIMING_EXT_VISION,		///< controlExternalVisionFusion()
+	TIMING_TERRAIN,			///< runTerrainEstimator()
+	TIMING_OUTPUT_STATES,		///< predictOutputStates() and correctOutputStates()
+	TIMING_NUM_STAGES
+};
+
 struct parameters {
 	// measurement source control
 	int32_t fusion_mode{MASK_USE_GPS};		///< bitmasked integer that selects which aiding sources will be used
@@ -210,6 +231,7 @@ struct parameters {
 	// input noise
 	float gyro_noise{1.5e-2f};		///< IMU angular rate noise used for covariance prediction (rad/sec)
 	float accel_noise{3.5e-1f};		///< IMU acceleration noise use for covariance prediction (m/sec**2)
+	int32_t cov_pred_dt_ms{0};		///< minimum time between covariance predictions, the IMU data of the filter updates in between is accumulated. 0 predicts the covariance at every filter update (mSec)
 
 	// process noise
 	float gyro_bias_p_noise{1.0e-3f};	///< process noise for IMU rate gyro bias prediction (rad/sec**2)
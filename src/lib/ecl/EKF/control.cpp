@@ -48,6 +48,8 @@ void Ekf::controlFusionModes()
 	// Store the status to enable change detection
 	_control_status_prev.value = _control_status.value;
 
+	uint64_t stage_start = stage_time_start();
+
 	// Get the magnetic declination
 	calcMagDeclination();
 
@@ -114,22 +116,32 @@ void Ekf::controlFusionModes()
 
 	// check for height sensor timeouts and reset and change sensor if necessary
 	controlHeightSensorTimeouts();
+	stage_start = stage_time_add(TIMING_CONTROL, stage_start);
 
 	// control use of observations for aiding
 	controlMagFusion();
+	stage_start = stage_time_add(TIMING_MAG, stage_start);
 	controlOpticalFlowFusion();
+	stage_start = stage_time_add(TIMING_OPTICAL_FLOW, stage_start);
 	controlGpsFusion();
+	stage_start = stage_time_add(TIMING_GPS, stage_start);
 	controlAirDataFusion();
+	stage_start = stage_time_add(TIMING_AIR_DATA, stage_start);
 	controlBetaFusion();
+	stage_start = stage_time_add(TIMING_BETA, stage_start);
 	controlDragFusion();
+	stage_start = stage_time_add(TIMING_DRAG, stage_start);
 	controlHeightFusion();
+	stage_start = stage_time_add(TIMING_HEIGHT, stage_start);
 
 	// For efficiency, fusion of direct state observations for position and velocity is performed sequentially
 	// in a single function using sensor data from multiple sources (GPS, baro, range finder, etc)
 	controlVelPosFusion();
+	stage_start = stage_time_add(TIMING_VEL_POS, stage_start);
 
 	// Additional data from an external vision sensor can also be fused.
 	controlExternalVisionFusion();
+	stage_time_add(TIMING_EXT_VISION, stage_start);
 
 	// report dead reckoning if we are no longer fusing measurements that directly constrain velocity drift
 	_is_dead_reckoning = (_time_last_imu - _time_last_pos_fuse > _params.no_aid_timeout_max)
@@ -323,11 +335,10 @@ void Ekf::controlOpticalFlowFusion()
 					}
 
 					// reset the velocity covariance terms
-					zeroRows(P,4,5);
-					zeroCols(P,4,5);
+					P.zeroRowsCols(4, 5);
 
 					// reset the horizontal velocity variance using the optical flow noise variance
-					P[5][5] = P[4][4] = sq(range) * calcOptFlowMeasVar();
+					P(5,5) = P(4,4) = sq(range) * calcOptFlowMeasVar();
 
 					if (!_control_status.flags.in_air) {
 						// we are likely starting OF for the first time so reset the horizontal position and vertical velocity states
@@ -343,8 +354,7 @@ void Ekf::controlOpticalFlowFusion()
 
 					// reset the corresponding covariances
 					// we are by definition at the origin at commencement so variances are also zeroed
-					zeroRows(P,7,8);
-					zeroCols(P,7,8);
+					P.zeroRowsCols(7, 8);
 
 					// align the output observer to the EKF states
 					alignOutputFilter();
@@ -518,7 +528,7 @@ void Ekf::controlHeightSensorTimeouts()
 	bool hgt_fusion_timeout = ((_time_last_imu - _time_last_hgt_fuse) > 5e6);
 
 	// reset the vertical position and velocity states
-	if ((P[9][9] > sq(_params.hgt_reset_lim)) && (hgt_fusion_timeout || continuous_bad_accel_hgt)) {
+	if ((P(9,9) > sq(_params.hgt_reset_lim)) && (hgt_fusion_timeout || continuous_bad_accel_hgt)) {
 		// boolean that indicates we will do a height reset
 		bool reset_height = false;
 
@@ -587,7 +597,7 @@ void Ekf::controlHeightSensorTimeouts()
 			baroSample baro_init = _baro_buffer.get_newest();
 			bool baro_data_fresh = ((_time_last_imu - baro_init.time_us) < 2 * BARO_MAX_INTERVAL);
 			float baro_innov = _state.pos(2) - (_hgt_sensor_offset - baro_init.hgt + _baro_hgt_offset);
-			bool baro_data_consistent = fabsf(baro_innov) < (sq(_params.baro_noise) + P[8][8]) * sq(_params.baro_innov_gate);
+			bool baro_data_consistent = fabsf(baro_innov) < (sq(_params.baro_noise) + P(8,8)) * sq(_params.baro_innov_gate);
 
 			// if baro data is acceptable and GPS data is inaccurate, reset height to baro
 			bool reset_to_baro = baro_data_consistent && baro_data_fresh && !_baro_hgt_faulty && !gps_hgt_accurate;
@@ -1143,12 +1153,11 @@ void Ekf::controlMagFusion()
 						}
 					} else {
 						// reset the mag field covariances
-						zeroRows(P, 16, 21);
-						zeroCols(P, 16, 21);
+						P.zeroRowsCols(16, 21);
 
 						// re-instate the last used variances
 						for (uint8_t index = 0; index <= 5; index ++) {
-							P[index+16][index+16] = _saved_mag_variance[index];
+							P(index+16,index+16) = _saved_mag_variance[index];
 						}
 					}
 				}
@@ -1161,7 +1170,7 @@ void Ekf::controlMagFusion()
 				// save magnetic field state variances for next time
 				if (_control_status.flags.mag_3D) {
 					for (uint8_t index = 0; index <= 5; index ++) {
-						_saved_mag_variance[index] = P[index+16][index+16];
+						_saved_mag_variance[index] = P(index+16,index+16);
 					}
 					_control_status.flags.mag_3D = false;
 				}
@@ -1181,10 +1190,9 @@ void Ekf::controlMagFusion()
 				// When re-commencing use of magnetometer to correct vehicle states
 				// set the field state variance to the observation variance and zero
 				// the covariance terms to allow the field states re-learn rapidly
-				zeroRows(P, 16, 21);
-				zeroCols(P, 16, 21);
+				P.zeroRowsCols(16, 21);
 				for (uint8_t index = 0; index <= 5; index ++) {
-					P[index+16][index+16] = sq(_params.mag_noise);
+					P(index+16,index+16) = sq(_params.mag_noise);
 				}
 			}
 
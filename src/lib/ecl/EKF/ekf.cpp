@@ -72,6 +72,8 @@ bool Ekf::init(uint64_t timestamp)
 	_q_down_sampled(2) = 0.0f;
 	_q_down_sampled(3) = 0.0f;
 
+	_cov_accum_steps = 0;
+
 	_imu_updated = false;
 	_NED_origin_initialised = false;
 	_gps_speed_valid = false;
@@ -110,19 +112,39 @@ bool Ekf::update()
 	if (_imu_updated) {
 
 		// perform state and covariance prediction for the main filter
+		uint64_t stage_start = stage_time_start();
 		predictState();
-		predictCovariance();
+		stage_start = stage_time_add(TIMING_PREDICT_STATE, stage_start);
+
+		imuSample imu_cov;
+		uint8_t cov_steps;
+
+		if (collectCovariancePredictionData(imu_cov, cov_steps)) {
+			predictCovariance(imu_cov, cov_steps);
+		}
+
+		stage_time_add(TIMING_PREDICT_COVARIANCE, stage_start);
 
 		// control fusion of observation data
 		controlFusionModes();
 
 		// run a separate filter for terrain estimation
+		stage_start = stage_time_start();
 		runTerrainEstimator();
+		stage_time_add(TIMING_TERRAIN, stage_start);
+
+	}
+
+	// the output observer always runs, the prediction might already have been done by predictOutput()
+	uint64_t stage_start = stage_time_start();
 
+	if (!_output_predicted) {
+		predictOutputStates();
 	}
 
-	// the output observer always runs
-	calculateOutputStates();
+	correctOutputStates();
+	_output_predicted = false;
+	stage_time_add(TIMING_OUTPUT_STATES, stage_start);
 
 	// check for NaN or inf on attitude states
 	if (!ISFINITE(_state.quat_nominal(0)) || !ISFINITE(_output_new.quat_nominal(0))) {
@@ -133,6 +155,39 @@ bool Ekf::update()
 	return _control_status.flags.tilt_align && _control_status.flags.yaw_align;
 }
 
+bool Ekf::predictOutput()
+{
+	if (!_filter_initialised) {
+		return false;
+	}
+
+	if (!_output_predicted) {
+		uint64_t stage_start = stage_time_start();
+		predictOutputStates();
+		_output_predicted = true;
+		stage_time_add(TIMING_OUTPUT_STATES, stage_start);
+	}
+
+	return ISFINITE(_output_new.quat_nominal(0)) && _control_status.flags.tilt_align && _control_status.flags.yaw_align;
+}
+
+uint64_t Ekf::stage_time_start() const
+{
+#ifdef ecl_absolute_time
+	return ecl_absolute_time();
+#else
+	return 0;
+#endif
+}
+
+uint64_t Ekf::stage_time_add(ekf_timing_stage stage, uint64_t start)
+{
+	// without a clock, both times are 0 and nothing is added
+	const uint64_t now = stage_time_start();
+	_stage_time_us[stage] += now - start;
+	return now;
+}
+
 bool Ekf::initialiseFilter()
 {
 	// Keep accumulating measurements until we have a minimum of 10 samples for the required sensors
@@ -427,6 +482,55 @@ bool Ekf::collect_imu(imuSample &imu)
 	return false;
 }
 
+bool Ekf::collectCovariancePredictionData(imuSample &imu, uint8_t &num_steps)
+{
+	// the time horizon of the covariance prediction is limited to keep the linearisation errors small
+	const float target_dt = 0.001f * (float)math::constrain(_params.cov_pred_dt_ms, (int32_t)0, (int32_t)100);
+
+	if (_cov_accum_steps == 0) {
+		if (target_dt < 0.5f * _dt_ekf_avg) {
+			// prediction at every filter update
+			imu = _imu_sample_delayed;
+			num_steps = 1;
+			return true;
+		}
+
+		_imu_cov_accum = _imu_sample_delayed;
+		_q_cov_accum.from_axis_angle(_imu_sample_delayed.delta_ang);
+
+	} else {
+		// accumulate the delta angles and the delta velocities in the latest body frame in the same way as collect_imu()
+		Quatf delta_q;
+		delta_q.rotate(_imu_sample_delayed.delta_ang);
+		_q_cov_accum = _q_cov_accum * delta_q;
+		_q_cov_accum.normalize();
+
+		Dcmf delta_R(delta_q.inversed());
+		_imu_cov_accum.delta_vel = delta_R * _imu_cov_accum.delta_vel
+					   + (_imu_sample_delayed.delta_vel + delta_R * _imu_sample_delayed.delta_vel) * 0.5f;
+		_imu_cov_accum.delta_ang_dt += _imu_sample_delayed.delta_ang_dt;
+		_imu_cov_accum.delta_vel_dt += _imu_sample_delayed.delta_vel_dt;
+		_imu_cov_accum.time_us = _imu_sample_delayed.time_us;
+	}
+
+	_cov_accum_steps++;
+
+	// predict once the next filter update would be closer to the target than this one
+	if (_imu_cov_accum.delta_ang_dt + 0.5f * _dt_ekf_avg < target_dt) {
+		return false;
+	}
+
+	if (_cov_accum_steps > 1) {
+		_imu_cov_accum.delta_ang = _q_cov_accum.to_axis_angle();
+	}
+
+	imu = _imu_cov_accum;
+	num_steps = _cov_accum_steps;
+	_cov_accum_steps = 0;
+
+	return true;
+}
+
 /*
  * Implement a strapdown INS algorithm using the latest IMU data at the current time horizon.
  * Buffer the INS states and calculate the difference with the EKF states at the delayed fusion time horizon.
@@ -437,7 +541,7 @@ bool Ekf::collect_imu(imuSample &imu)
  * “Recursive Attitude Estimation in the Presence of Multi-rate and Multi-delay Vector Measurements”
  * A Khosravian, J Trumpf, R Mahony, T Hamel, Australian National University
 */
-void Ekf::calculateOutputStates()
+void Ekf::predictOutputStates()
 {
 	// Use full rate IMU data at the current time horizon
 	imuSample imu_new = _imu_sample_new;
@@ -524,6 +628,16 @@ void Ekf::calculateOutputStates()
 	if (_imu_updated) {
 		_output_buffer.push(_output_new);
 		_output_vert_buffer.push(_output_vert_new);
+	}
+}
+
+/*
+ * Correct the output states so that they track the EKF states at the fusion time horizon, after
+ * the EKF update with the newest IMU sample (see predictOutputStates()).
+ */
+void Ekf::correctOutputStates()
+{
+	if (_imu_updated) {
 		_imu_updated = false;
 
 		// get the oldest INS state data from the ring buffer
@@ -40,8 +40,11 @@
  *
  */
 
+#pragma once
+
 #include "estimator_interface.h"
 #include "geo.h"
+#include "SymmetricMatrix.h"
 
 class Ekf : public EstimatorInterface
 {
@@ -56,6 +59,11 @@ public:
 	// should be called every time new data is pushed into the filter
 	bool update();
 
+	// run the output predictor for the newest IMU sample ahead of update(), so that the output states can be
+	// used without waiting for the fusion. update() must follow for the same sample, it then only applies the
+	// output corrections. Returns true if the output states are valid.
+	bool predictOutput();
+
 	// gets the innovations of velocity and position measurements
 	// 0-2 vel, 3-5 pos
 	void get_vel_pos_innov(float vel_pos_innov[6]);
@@ -226,12 +234,18 @@ public:
 	// return a bitmask integer that describes which state estimates can be used for flight control
 	void get_ekf_soln_status(uint16_t *status);
 
+	// return the accumulated execution time of each stage of update() since startup (uSec), indexed by ekf_timing_stage.
+	// The times are only measured if the platform provides ecl_absolute_time(), otherwise they stay at zero.
+	void get_stage_times(uint64_t times_us[TIMING_NUM_STAGES]) {memcpy(times_us, _stage_time_us, sizeof(_stage_time_us));}
+
 private:
 
 	static constexpr uint8_t _k_num_states{24};		///< number of EKF states
 	static constexpr float _k_earth_rate{0.000072921f};	///< earth spin rate (rad/sec)
 	static constexpr float _gravity_mss{9.80665f};		///< average earth gravity at sea level (m/sec**2)
 
+	typedef SymmetricMatrix<float, _k_num_states> CovarianceMatrix;
+
 	struct {
 		uint8_t velNE_counter;	///< number of horizontal position reset events (allow to wrap if count exceeds 255)
 		uint8_t velD_counter;	///< number of vertical velocity reset events (allow to wrap if count exceeds 255)
@@ -251,6 +265,8 @@ private:
 	stateSample _state{};		///< state struct of the ekf running at the delayed time horizon
 
 	bool _filter_initialised{false};	///< true when the EKF sttes and covariances been initialised
+	bool _output_predicted{false};	///< true when predictOutput() ran the output predictor for the newest IMU sample
+	uint64_t _stage_time_us[TIMING_NUM_STAGES] {};	///< accumulated execution time of the stages of update() (uSec)
 	bool _earth_rate_initialised{false};	///< true when we know the earth rotatin rate (requires GPS)
 
 	bool _fuse_height{false};	///< true when baro height data should be fused
@@ -304,7 +320,9 @@ private:
 	uint64_t _time_yaw_started{0};		///< last system time in usec that a yaw rotation moaneouvre was detected
 	uint8_t _num_bad_flight_yaw_events{0};	///< number of times a bad heading has been detected in flight and required a yaw reset
 
-	float P[_k_num_states][_k_num_states] {};	///< state covariance matrix
+	CovarianceMatrix P {};	///< state covariance matrix
+	uint8_t _active_states[_k_num_states] {};	///< indices of the states that are being estimated, in ascending order
+	uint8_t _num_active_states{0};	///< number of states in _active_states
 
 	float _vel_pos_innov[6] {};	///< NED velocity and position innovations: 0-2 vel (m/sec),  3-5 pos (m**2)
 	float _vel_pos_innov_var[6] {};	///< NED velocity and position innovation variances: 0-2 vel ((m/sec)**2), 3-5 pos (m**2)
@@ -337,6 +355,9 @@ private:
 	Vector3f _delta_angle_corr;	///< delta angle correction vector (rad)
 	imuSample _imu_down_sampled{};	///< down sampled imu data (sensor rate -> filter update rate)
 	Quatf _q_down_sampled;		///< down sampled quaternion (tracking delta angles between ekf update steps)
+	imuSample _imu_cov_accum{};	///< delayed imu data accumulated between covariance predictions
+	Quatf _q_cov_accum;		///< rotation since the last covariance prediction
+	uint8_t _cov_accum_steps{0};	///< number of filter updates accumulated since the last covariance prediction
 	Vector3f _vel_err_integ;	///< integral of velocity tracking error (m)
 	Vector3f _pos_err_integ;	///< integral of position tracking error (m.s)
 	float _output_tracking_error[3] {}; ///< contains the magnitude of the angle, velocity and position track errors (rad, m/s, m)
@@ -411,9 +432,11 @@ private:
 	float _rng_check_min_val{0.0f};		///< minimum value for new rng measurement when being stuck
 	float _rng_check_max_val{0.0f};		///< maximum value for new rng measurement when being stuck
 
-	// update the real time complementary filter states. This includes the prediction
-	// and the correction step
-	void calculateOutputStates();
+	// predict the real time complementary filter states with the newest IMU sample
+	void predictOutputStates();
+
+	// correct the real time complementary filter states towards the EKF states at the fusion time horizon
+	void correctOutputStates();
 
 	// initialise filter states of both the delayed ekf and the real time complementary filter
 	bool initialiseFilter(void);
@@ -424,8 +447,12 @@ private:
 	// predict ekf state
 	void predictState();
 
-	// predict ekf covariance
-	void predictCovariance();
+	// accumulate the delayed IMU data between covariance predictions (see parameters::cov_pred_dt_ms)
+	// returns true and the accumulated data and number of filter updates when the covariance prediction is due
+	bool collectCovariancePredictionData(imuSample &imu, uint8_t &num_steps);
+
+	// predict ekf covariance over num_steps filter updates using the accumulated imu data
+	void predictCovariance(const imuSample &imu, uint8_t num_steps);
 
 	// ekf sequential fusion of magnetometer measurements
 	void fuseMag();
@@ -490,14 +517,23 @@ private:
 	// limit the diagonal of the covariance matrix
 	void fixCovarianceErrors();
 
-	// make ekf covariance matrix symmetric between a nominated state indexe range
-	void makeSymmetrical(float (&cov_mat)[_k_num_states][_k_num_states], uint8_t first, uint8_t last);
-
 	// constrain the ekf states
 	void constrainStates();
 
+	// update the list of the states that are being estimated from the control status
+	// the covariances of the other states are held at zero, so the fusion steps can skip them
+	void updateActiveStates();
+
+	// return the start time of an execution time measurement (uSec), 0 if not supported
+	uint64_t stage_time_start() const;
+
+	// add the time since start to the accumulated time of a stage and return the current time, which
+	// is the start time for the next stage
+	uint64_t stage_time_add(ekf_timing_stage stage, uint64_t start);
+
 	// generic function which will perform a fusion step given a kalman gain K
 	// and a scalar innovation value
+	// only the active states are corrected, see updateActiveStates()
 	void fuse(float *K, float innovation);
 
 	// calculate the earth rotation vector from a given latitude
@@ -568,12 +604,6 @@ private:
 	// set control flags to use external vision height
 	void setControlEVHeight();
 
-	// zero the specified range of rows in the state covariance matrix
-	void zeroRows(float (&cov_mat)[_k_num_states][_k_num_states], uint8_t first, uint8_t last);
-
-	// zero the specified range of columns in the state covariance matrix
-	void zeroCols(float (&cov_mat)[_k_num_states][_k_num_states], uint8_t first, uint8_t last);
-
 	// calculate the measurement variance for the optical flow sensor
 	float calcOptFlowMeasVar();
 
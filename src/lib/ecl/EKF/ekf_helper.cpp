@@ -173,11 +173,10 @@ void Ekf::resetHeight()
 			_state.pos(2) = new_pos_down;
 
 			// reset the associated covariance values
-			zeroRows(P, 9, 9);
-			zeroCols(P, 9, 9);
+			P.zeroRowsCols(9, 9);
 
 			// the state variance is the same as the observation
-			P[9][9] = sq(_params.range_noise);
+			P(9,9) = sq(_params.range_noise);
 
 			vert_pos_reset = true;
 
@@ -198,11 +197,10 @@ void Ekf::resetHeight()
 			_state.pos(2) = _hgt_sensor_offset - baro_newest.hgt + _baro_hgt_offset;
 
 			// reset the associated covariance values
-			zeroRows(P, 9, 9);
-			zeroCols(P, 9, 9);
+			P.zeroRowsCols(9, 9);
 
 			// the state variance is the same as the observation
-			P[9][9] = sq(_params.baro_noise);
+			P(9,9) = sq(_params.baro_noise);
 
 			vert_pos_reset = true;
 
@@ -216,11 +214,10 @@ void Ekf::resetHeight()
 			_state.pos(2) = _hgt_sensor_offset - gps_newest.hgt + _gps_alt_ref;
 
 			// reset the associated covarince values
-			zeroRows(P, 9, 9);
-			zeroCols(P, 9, 9);
+			P.zeroRowsCols(9, 9);
 
 			// the state variance is the same as the observation
-			P[9][9] = sq(gps_newest.hacc);
+			P(9,9) = sq(gps_newest.hacc);
 
 			vert_pos_reset = true;
 
@@ -250,8 +247,7 @@ void Ekf::resetHeight()
 	}
 
 	// reset the vertical velocity covariance values
-	zeroRows(P, 6, 6);
-	zeroCols(P, 6, 6);
+	P.zeroRowsCols(6, 6);
 
 	// reset the vertical velocity state
 	if (_control_status.flags.gps && (_time_last_imu - gps_newest.time_us < 2 * GPS_MAX_INTERVAL)) {
@@ -259,7 +255,7 @@ void Ekf::resetHeight()
 		_state.vel(2) = gps_newest.vel(2);
 
 		// the state variance is the same as the observation
-		P[6][6] = sq(1.5f * gps_newest.sacc);
+		P(6,6) = sq(1.5f * gps_newest.sacc);
 
 	} else {
 		// we don't know what the vertical velocity is, so set it to zero
@@ -267,7 +263,7 @@ void Ekf::resetHeight()
 
 		// Set the variance to a value large enough to allow the state to converge quickly
 		// that does not destabilise the filter
-		P[6][6] = 10.0f;
+		P(6,6) = 10.0f;
 
 	}
 
@@ -419,7 +415,7 @@ bool Ekf::realignYawGPS()
 			_state.mag_I = _R_to_earth * _mag_sample_delayed.mag;
 
 			// use the combined EKF and GPS speed variance to calculate a rough estimate of the yaw error after alignment
-			float SpdErrorVariance = sq(_gps_sample_delayed.sacc) + P[4][4] + P[5][5];
+			float SpdErrorVariance = sq(_gps_sample_delayed.sacc) + P(4,4) + P(5,5);
 			float sineYawError = math::constrain(sqrtf(SpdErrorVariance) / gpsSpeed, 0.0f, 1.0f);
 			angle_err_var_vec(2) = sq(asinf(sineYawError));
 
@@ -427,11 +423,10 @@ bool Ekf::realignYawGPS()
 			initialiseQuatCovariances(angle_err_var_vec);
 
 			// reset the corresponding rows and columns in the covariance matrix and set the variances on the magnetic field states to the measurement variance
-			zeroRows(P, 16, 21);
-			zeroCols(P, 16, 21);
+			P.zeroRowsCols(16, 21);
 
 			for (uint8_t index = 16; index <= 21; index ++) {
-				P[index][index] = sq(_params.mag_noise);
+				P(index,index) = sq(_params.mag_noise);
 			}
 
 			// calculate the amount that the quaternion has changed by
@@ -624,11 +619,10 @@ bool Ekf::resetMagHeading(Vector3f &mag_init)
 	_state.mag_I = _R_to_earth * mag_init;
 
 	// reset the corresponding rows and columns in the covariance matrix and set the variances on the magnetic field states to the measurement variance
-	zeroRows(P, 16, 21);
-	zeroCols(P, 16, 21);
+	P.zeroRowsCols(16, 21);
 
 	for (uint8_t index = 16; index <= 21; index ++) {
-		P[index][index] = sq(_params.mag_noise);
+		P(index,index) = sq(_params.mag_noise);
 	}
 
 	// calculate the amount that the quaternion has changed by
@@ -679,18 +673,6 @@ void Ekf::calcMagDeclination()
 	}
 }
 
-// This function forces the covariance matrix to be symmetric
-void Ekf::makeSymmetrical(float (&cov_mat)[_k_num_states][_k_num_states], uint8_t first, uint8_t last)
-{
-	for (unsigned row = first; row <= last; row++) {
-		for (unsigned column = 0; column < row; column++) {
-			float tmp = (cov_mat[row][column] + cov_mat[column][row]) / 2;
-			cov_mat[row][column] = tmp;
-			cov_mat[column][row] = tmp;
-		}
-	}
-}
-
 void Ekf::constrainStates()
 {
 	for (int i = 0; i < 4; i++) {
@@ -862,7 +844,7 @@ void Ekf::get_gyro_bias(float bias[3])
 void Ekf::get_covariances(float *covariances)
 {
 	for (unsigned i = 0; i < _k_num_states; i++) {
-		covariances[i] = P[i][i];
+		covariances[i] = P(i,i);
 	}
 }
 
@@ -908,8 +890,8 @@ void Ekf::get_ekf_gpos_accuracy(float *ekf_eph, float *ekf_epv, bool *dead_recko
 			       (_control_status.flags.fuse_beta && _control_status.flags.fuse_aspd));
 
 	if (vel_pos_aiding && _NED_origin_initialised) {
-		hpos_err = sqrtf(P[7][7] + P[8][8] + sq(_gps_origin_eph));
-		vpos_err = sqrtf(P[9][9] + sq(_gps_origin_epv));
+		hpos_err = sqrtf(P(7,7) + P(8,8) + sq(_gps_origin_eph));
+		vpos_err = sqrtf(P(9,9) + sq(_gps_origin_epv));
 
 	} else {
 		hpos_err = 0.0f;
@@ -942,8 +924,8 @@ void Ekf::get_ekf_lpos_accuracy(float *ekf_eph, float *ekf_epv, bool *dead_recko
 			       (_control_status.flags.fuse_beta && _control_status.flags.fuse_aspd));
 
 	if (vel_pos_aiding && _NED_origin_initialised) {
-		hpos_err = sqrtf(P[7][7] + P[8][8]);
-		vpos_err = sqrtf(P[9][9]);
+		hpos_err = sqrtf(P(7,7) + P(8,8));
+		vpos_err = sqrtf(P(9,9));
 
 	} else {
 		hpos_err = 0.0f;
@@ -975,8 +957,8 @@ void Ekf::get_ekf_vel_accuracy(float *ekf_evh, float *ekf_evv, bool *dead_reckon
 			       (_control_status.flags.fuse_beta && _control_status.flags.fuse_aspd));
 
 	if (vel_pos_aiding && _NED_origin_initialised) {
-		hvel_err = sqrtf(P[4][4] + P[5][5]);
-		vvel_err = sqrtf(P[6][6]);
+		hvel_err = sqrtf(P(4,4) + P(5,5));
+		vvel_err = sqrtf(P(6,6));
 
 	} else {
 		hvel_err = 0.0f;
@@ -1051,19 +1033,18 @@ bool Ekf::reset_imu_bias()
 	_state.accel_bias.zero();
 
 	// Zero the corresponding covariances
-	zeroCols(P, 10, 15);
-	zeroRows(P, 10, 15);
+	P.zeroRowsCols(10, 15);
 
 	// Set the corresponding variances to the values use for initial alignment
 	float dt = 0.001f * (float)FILTER_UPDATE_PERIOD_MS;
-	P[12][12] = P[11][11] = P[10][10] = sq(_params.switch_on_gyro_bias * dt);
-	P[15][15] = P[14][14] = P[13][13] = sq(_params.switch_on_accel_bias * dt);
+	P(12,12) = P(11,11) = P(10,10) = sq(_params.switch_on_gyro_bias * dt);
+	P(15,15) = P(14,14) = P(13,13) = sq(_params.switch_on_accel_bias * dt);
 	_last_imu_bias_cov_reset_us = _imu_sample_delayed.time_us;
 
 	// Set previous frame values
-	_prev_dvel_bias_var(0) = P[13][13];
-	_prev_dvel_bias_var(1) = P[14][14];
-	_prev_dvel_bias_var(2) = P[15][15];
+	_prev_dvel_bias_var(0) = P(13,13);
+	_prev_dvel_bias_var(1) = P(14,14);
+	_prev_dvel_bias_var(2) = P(15,15);
 
 	return true;
 
@@ -1135,40 +1116,51 @@ void Ekf::fuse(float *K, float innovation)
 		_state.gyro_bias(i) = _state.gyro_bias(i) - K[i + 10] * innovation;
 	}
 
-	for (unsigned i = 0; i < 3; i++) {
-		_state.accel_bias(i) = _state.accel_bias(i) - K[i + 13] * innovation;
-	}
+	// the states from 13 onwards are only corrected while they are being estimated
+	for (unsigned n = 13; n < _num_active_states; n++) {
+		unsigned i = _active_states[n];
 
-	for (unsigned i = 0; i < 3; i++) {
-		_state.mag_I(i) = _state.mag_I(i) - K[i + 16] * innovation;
-	}
+		if (i <= 15) {
+			_state.accel_bias(i - 13) = _state.accel_bias(i - 13) - K[i] * innovation;
 
-	for (unsigned i = 0; i < 3; i++) {
-		_state.mag_B(i) = _state.mag_B(i) - K[i + 19] * innovation;
-	}
+		} else if (i <= 18) {
+			_state.mag_I(i - 16) = _state.mag_I(i - 16) - K[i] * innovation;
 
-	for (unsigned i = 0; i < 2; i++) {
-		_state.wind_vel(i) = _state.wind_vel(i) - K[i + 22] * innovation;
+		} else if (i <= 21) {
+			_state.mag_B(i - 19) = _state.mag_B(i - 19) - K[i] * innovation;
+
+		} else {
+			_state.wind_vel(i - 22) = _state.wind_vel(i - 22) - K[i] * innovation;
+		}
 	}
 }
 
-// zero specified range of rows in the state covariance matrix
-void Ekf::zeroRows(float (&cov_mat)[_k_num_states][_k_num_states], uint8_t first, uint8_t last)
+void Ekf::updateActiveStates()
 {
-	uint8_t row;
+	// the quaternion, velocity, position and delta angle bias states are always estimated
+	_num_active_states = 0;
 
-	for (row = first; row <= last; row++) {
-		memset(&cov_mat[row][0], 0, sizeof(cov_mat[0][0]) * 24);
+	for (uint8_t i = 0; i <= 12; i++) {
+		_active_states[_num_active_states++] = i;
 	}
-}
 
-// zero specified range of columns in the state covariance matrix
-void Ekf::zeroCols(float (&cov_mat)[_k_num_states][_k_num_states], uint8_t first, uint8_t last)
-{
-	uint8_t row;
+	// the covariances of the other states are zeroed by predictCovariance() while they are inhibited
+	if (!(_params.fusion_mode & MASK_INHIBIT_ACC_BIAS) && !_accel_bias_inhibit) {
+		for (uint8_t i = 13; i <= 15; i++) {
+			_active_states[_num_active_states++] = i;
+		}
+	}
 
-	for (row = 0; row <= 23; row++) {
-		memset(&cov_mat[row][first], 0, sizeof(cov_mat[0][0]) * (1 + last - first));
+	if (_control_status.flags.mag_3D) {
+		for (uint8_t i = 16; i <= 21; i++) {
+			_active_states[_num_active_states++] = i;
+		}
+	}
+
+	if (_control_status.flags.wind) {
+		for (uint8_t i = 22; i <= 23; i++) {
+			_active_states[_num_active_states++] = i;
+		}
 	}
 }
 
@@ -1262,13 +1254,13 @@ Vector3f Ekf::calcRotVecVariances()
 		float t15 = q3*t6*2.0f;
 		float t16 = q0*q3*t3*t8*2.0f;
 		float t17 = t15+t16;
-		rot_var_vec(0) = t10*(P[0][0]*t10+P[1][0]*t3*t11*2.0f)+t3*t11*(P[0][1]*t10+P[1][1]*t3*t11*2.0f)*2.0f;
-		rot_var_vec(1) = t14*(P[0][0]*t14+P[2][0]*t3*t11*2.0f)+t3*t11*(P[0][2]*t14+P[2][2]*t3*t11*2.0f)*2.0f;
-		rot_var_vec(2) = t17*(P[0][0]*t17+P[3][0]*t3*t11*2.0f)+t3*t11*(P[0][3]*t17+P[3][3]*t3*t11*2.0f)*2.0f;
+		rot_var_vec(0) = t10*(P(0,0)*t10+P(1,0)*t3*t11*2.0f)+t3*t11*(P(0,1)*t10+P(1,1)*t3*t11*2.0f)*2.0f;
+		rot_var_vec(1) = t14*(P(0,0)*t14+P(2,0)*t3*t11*2.0f)+t3*t11*(P(0,2)*t14+P(2,2)*t3*t11*2.0f)*2.0f;
+		rot_var_vec(2) = t17*(P(0,0)*t17+P(3,0)*t3*t11*2.0f)+t3*t11*(P(0,3)*t17+P(3,3)*t3*t11*2.0f)*2.0f;
 	} else {
-		rot_var_vec(0) = 4.0f * P[1][1];
-		rot_var_vec(1) = 4.0f * P[2][2];
-		rot_var_vec(2) = 4.0f * P[3][3];
+		rot_var_vec(0) = 4.0f * P(1,1);
+		rot_var_vec(1) = 4.0f * P(2,2);
+		rot_var_vec(2) = 4.0f * P(3,3);
 	}
 
 	return rot_var_vec;
@@ -1344,45 +1336,32 @@ void Ekf::initialiseQuatCovariances(Vector3f &rot_vec_var)
 		float t44 = t17-t36;
 
 		// zero all the quaternion covariances
-		zeroRows(P,0,3);
-		zeroCols(P,0,3);
+		P.zeroRowsCols(0, 3);
 
 		// Update the quaternion internal covariances using auto-code generated using matlab symbolic toolbox
-		P[0][0] = rot_vec_var(0)*t2*t9*t10*0.25f+rot_vec_var(1)*t4*t9*t10*0.25f+rot_vec_var(2)*t5*t9*t10*0.25f;
-		P[0][1] = t22;
-		P[0][2] = t35+rotX*rot_vec_var(0)*t3*t11*(t15-rotX*rotY*t10*t12*0.5f)*0.5f-rotY*rot_vec_var(1)*t3*t11*t30*0.5f;
-		P[0][3] = rotX*rot_vec_var(0)*t3*t11*(t16-rotX*rotZ*t10*t12*0.5f)*0.5f+rotY*rot_vec_var(1)*t3*t11*(t17-rotY*rotZ*t10*t12*0.5f)*0.5f-rotZ*rot_vec_var(2)*t3*t11*t33*0.5f;
-		P[1][0] = t22;
-		P[1][1] = rot_vec_var(0)*(t19*t19)+rot_vec_var(1)*(t24*t24)+rot_vec_var(2)*(t26*t26);
-		P[1][2] = rot_vec_var(2)*(t16-t25)*(t17-rotY*rotZ*t10*t12*0.5f)-rot_vec_var(0)*t19*t28-rot_vec_var(1)*t28*t30;
-		P[1][3] = rot_vec_var(1)*(t15-t23)*(t17-rotY*rotZ*t10*t12*0.5f)-rot_vec_var(0)*t19*t31-rot_vec_var(2)*t31*t33;
-		P[2][0] = t35-rotY*rot_vec_var(1)*t3*t11*t30*0.5f+rotX*rot_vec_var(0)*t3*t11*(t15-t23)*0.5f;
-		P[2][1] = rot_vec_var(2)*(t16-t25)*(t17-t36)-rot_vec_var(0)*t19*t28-rot_vec_var(1)*t28*t30;
-		P[2][2] = rot_vec_var(1)*(t30*t30)+rot_vec_var(0)*(t37*t37)+rot_vec_var(2)*(t38*t38);
-		P[2][3] = t42;
-		P[3][0] = rotZ*rot_vec_var(2)*t3*t11*t33*(-0.5f)+rotX*rot_vec_var(0)*t3*t11*(t16-t25)*0.5f+rotY*rot_vec_var(1)*t3*t11*(t17-t36)*0.5f;
-		P[3][1] = rot_vec_var(1)*(t15-t23)*(t17-t36)-rot_vec_var(0)*t19*t31-rot_vec_var(2)*t31*t33;
-		P[3][2] = t42;
-		P[3][3] = rot_vec_var(2)*(t33*t33)+rot_vec_var(0)*(t43*t43)+rot_vec_var(1)*(t44*t44);
+		P(0,0) = rot_vec_var(0)*t2*t9*t10*0.25f+rot_vec_var(1)*t4*t9*t10*0.25f+rot_vec_var(2)*t5*t9*t10*0.25f;
+		P(0,1) = t22;
+		P(0,2) = t35+rotX*rot_vec_var(0)*t3*t11*(t15-rotX*rotY*t10*t12*0.5f)*0.5f-rotY*rot_vec_var(1)*t3*t11*t30*0.5f;
+		P(0,3) = rotX*rot_vec_var(0)*t3*t11*(t16-rotX*rotZ*t10*t12*0.5f)*0.5f+rotY*rot_vec_var(1)*t3*t11*(t17-rotY*rotZ*t10*t12*0.5f)*0.5f-rotZ*rot_vec_var(2)*t3*t11*t33*0.5f;
+		P(1,1) = rot_vec_var(0)*(t19*t19)+rot_vec_var(1)*(t24*t24)+rot_vec_var(2)*(t26*t26);
+		P(1,2) = rot_vec_var(2)*(t16-t25)*(t17-rotY*rotZ*t10*t12*0.5f)-rot_vec_var(0)*t19*t28-rot_vec_var(1)*t28*t30;
+		P(1,3) = rot_vec_var(1)*(t15-t23)*(t17-rotY*rotZ*t10*t12*0.5f)-rot_vec_var(0)*t19*t31-rot_vec_var(2)*t31*t33;
+		P(2,2) = rot_vec_var(1)*(t30*t30)+rot_vec_var(0)*(t37*t37)+rot_vec_var(2)*(t38*t38);
+		P(2,3) = t42;
+		P(3,3) = rot_vec_var(2)*(t33*t33)+rot_vec_var(0)*(t43*t43)+rot_vec_var(1)*(t44*t44);
 
 	} else {
 		// the equations are badly conditioned so use a small angle approximation
-		P[0][0] = 0.0f;
-		P[0][1] = 0.0f;
-		P[0][2] = 0.0f;
-		P[0][3] = 0.0f;
-		P[1][0] = 0.0f;
-		P[1][1] = 0.25f * rot_vec_var(0);
-		P[1][2] = 0.0f;
-		P[1][3] = 0.0f;
-		P[2][0] = 0.0f;
-		P[2][1] = 0.0f;
-		P[2][2] = 0.25f * rot_vec_var(1);
-		P[2][3] = 0.0f;
-		P[3][0] = 0.0f;
-		P[3][1] = 0.0f;
-		P[3][2] = 0.0f;
-		P[3][3] = 0.25f * rot_vec_var(2);
+		P(0,0) = 0.0f;
+		P(0,1) = 0.0f;
+		P(0,2) = 0.0f;
+		P(0,3) = 0.0f;
+		P(1,1) = 0.25f * rot_vec_var(0);
+		P(1,2) = 0.0f;
+		P(1,3) = 0.0f;
+		P(2,2) = 0.25f * rot_vec_var(1);
+		P(2,3) = 0.0f;
+		P(3,3) = 0.25f * rot_vec_var(2);
 
 	}
 }
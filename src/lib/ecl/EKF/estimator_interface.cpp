@@ -193,7 +193,7 @@ void EstimatorInterface::setGpsData(uint64_t time_usec, struct gps_message *gps)
 		if (collect_gps(time_usec, gps)) {
 			float lpos_x = 0.0f;
 			float lpos_y = 0.0f;
-			map_projection_project(&_pos_ref, (gps->lat / 1.0e7), (gps->lon / 1.0e7), &lpos_x, &lpos_y);
+			map_projection_project_local(&_pos_ref, (gps->lat / 1.0e7), (gps->lon / 1.0e7), &lpos_x, &lpos_y);
 			gps_sample_new.pos(0) = lpos_x;
 			gps_sample_new.pos(1) = lpos_y;
 
@@ -379,14 +379,27 @@ bool EstimatorInterface::initialise_interface(uint64_t timestamp)
 	// limit to be no longer than the IMU buffer (we can't process data faster than the EKF prediction rate)
 	_obs_buffer_length = math::min(_obs_buffer_length, _imu_buffer_length);
 
+	// an observation stays in its buffer until its time stamp falls behind the fusion time horizon, which for a
+	// sensor with a delay happens earlier than for an undelayed one, so the buffer of each sensor is shortened
+	// by the fraction of the horizon covered by its delay. The observation rate limit (_min_obs_interval_us) is
+	// based on _obs_buffer_length, the length required for an undelayed sensor.
+	auto obs_buffer_length = [&](uint16_t delay_ms) -> uint8_t {
+		if (ekf_delay_ms == 0) {
+			return _obs_buffer_length;
+		}
+
+		const unsigned buffered_ms = ekf_delay_ms - math::min(delay_ms, ekf_delay_ms);
+		return (uint8_t)(((_obs_buffer_length - 1) * buffered_ms + ekf_delay_ms - 1) / ekf_delay_ms + 1);
+	};
+
 	if (!(_imu_buffer.allocate(_imu_buffer_length) &&
-	      _gps_buffer.allocate(_obs_buffer_length) &&
-	      _mag_buffer.allocate(_obs_buffer_length) &&
-	      _baro_buffer.allocate(_obs_buffer_length) &&
-	      _range_buffer.allocate(_obs_buffer_length) &&
-	      _airspeed_buffer.allocate(_obs_buffer_length) &&
-	      _flow_buffer.allocate(_obs_buffer_length) &&
-	      _ext_vision_buffer.allocate(_obs_buffer_length) &&
+	      _gps_buffer.allocate(obs_buffer_length(_params.gps_delay_ms)) &&
+	      _mag_buffer.allocate(obs_buffer_length(_params.mag_delay_ms)) &&
+	      _baro_buffer.allocate(obs_buffer_length(_params.baro_delay_ms)) &&
+	      _range_buffer.allocate(obs_buffer_length(_params.range_delay_ms)) &&
+	      _airspeed_buffer.allocate(obs_buffer_length(_params.airspeed_delay_ms)) &&
+	      _flow_buffer.allocate(obs_buffer_length(_params.flow_delay_ms)) &&
+	      _ext_vision_buffer.allocate(obs_buffer_length(_params.ev_delay_ms)) &&
 	      _drag_buffer.allocate(_obs_buffer_length) &&
 	      _output_buffer.allocate(_imu_buffer_length) &&
 	      _output_vert_buffer.allocate(_imu_buffer_length))) {
@@ -462,6 +475,21 @@ void EstimatorInterface::unallocate_buffers()
 
 }
 
+unsigned EstimatorInterface::get_buffer_memory_used()
+{
+	return _imu_buffer.get_total_size() +
+	       _gps_buffer.get_total_size() +
+	       _mag_buffer.get_total_size() +
+	       _baro_buffer.get_total_size() +
+	       _range_buffer.get_total_size() +
+	       _airspeed_buffer.get_total_size() +
+	       _flow_buffer.get_total_size() +
+	       _ext_vision_buffer.get_total_size() +
+	       _drag_buffer.get_total_size() +
+	       _output_buffer.get_total_size() +
+	       _output_vert_buffer.get_total_size();
+}
+
 bool EstimatorInterface::local_position_is_valid()
 {
 	// return true if we are not doing unconstrained free inertial navigation
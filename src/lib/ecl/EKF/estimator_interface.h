@@ -39,6 +39,8 @@
  *
  */
 
+#pragma once
+
 #include <matrix/matrix/math.hpp>
 #include "RingBuffer.h"
 #include "geo.h"
@@ -285,6 +287,9 @@ public:
 	virtual void get_accel_bias(float bias[3]) = 0;
 	virtual void get_gyro_bias(float bias[3]) = 0;
 
+	// get the memory used by the data buffers in bytes
+	unsigned get_buffer_memory_used();
+
 	// get EKF mode status
 	void get_control_mode(uint32_t *val)
 	{
@@ -361,6 +366,7 @@ protected:
 	 arrive too soon after the previous measurement will not be processed.
 	 max freq (Hz) = (OBS_BUFFER_LENGTH - 1) / (IMU_BUFFER_LENGTH * FILTER_UPDATE_PERIOD_MS * 0.001)
 	 This can be adjusted to match the max sensor data rate plus some margin for jitter.
+	 This is the length for a sensor without delay, the buffers of delayed sensors are shorter.
 	*/
 	uint8_t _obs_buffer_length{0};
 
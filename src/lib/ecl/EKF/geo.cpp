@@ -137,9 +137,12 @@ float get_mag_declination(float lat, float lon)
 		return 0.0f;
 	}
 
-	/* round down to nearest sampling resolution */
-	int min_lat = (int)(lat / SAMPLING_RES) * SAMPLING_RES;
-	int min_lon = (int)(lon / SAMPLING_RES) * SAMPLING_RES;
+	/* beyond the table the outermost row is used */
+	lat = fminf(fmaxf(lat, SAMPLING_MIN_LAT), SAMPLING_MAX_LAT);
+
+	/* round down to nearest sampling resolution (towards -inf, also for negative values) */
+	int min_lat = (int)floorf(lat / SAMPLING_RES) * SAMPLING_RES;
+	int min_lon = (int)floorf(lon / SAMPLING_RES) * SAMPLING_RES;
 
 	/* for the rare case of hitting the bounds exactly
 	 * the rounding logic wouldn't fit, so enforce it.
@@ -151,7 +154,7 @@ float get_mag_declination(float lat, float lon)
 	}
 
 	if (lat >= SAMPLING_MAX_LAT) {
-		min_lat = (int)(lat / SAMPLING_RES) * SAMPLING_RES - SAMPLING_RES;
+		min_lat = SAMPLING_MAX_LAT - SAMPLING_RES;
 	}
 
 	if (lon <= SAMPLING_MIN_LON) {
@@ -159,7 +162,7 @@ float get_mag_declination(float lat, float lon)
 	}
 
 	if (lon >= SAMPLING_MAX_LON) {
-		min_lon = (int)(lon / SAMPLING_RES) * SAMPLING_RES - SAMPLING_RES;
+		min_lon = SAMPLING_MAX_LON - SAMPLING_RES;
 	}
 
 	/* find index of nearest low sampling point */
@@ -189,9 +192,24 @@ float get_lookup_table_val(unsigned lat_index, unsigned lon_index)
  * formulas according to: http://mathworld.wolfram.com/AzimuthalEquidistantProjection.html
  */
 
-static struct map_projection_reference_s mp_ref = {0.0, 0.0, 0.0, 0.0, false, 0};
+static struct map_projection_reference_s mp_ref; /* zero initialized (init_done = false) */
 static struct globallocal_converter_reference_s gl_ref = {0.0f, false};
 
+/* split a coordinate into a float and the float remainder, for the local projection */
+static void split_double(double value, float *hi, float *lo)
+{
+	*hi = (float)value;
+	*lo = (float)(value - (double)*hi);
+}
+
+/* add a value with a magnitude of at least the one of hi to a split coordinate, without rounding error */
+static void add_split(float *hi, float *lo, float value)
+{
+	const float sum = *hi + value;
+	*lo += *hi - (sum - value);
+	*hi = sum;
+}
+
 bool map_projection_global_initialized()
 {
 	return map_projection_initialized(&mp_ref);
@@ -227,6 +245,11 @@ int map_projection_init_timestamped(struct map_projection_reference_s *ref, doub
 	ref->sin_lat = sin(ref->lat_rad);
 	ref->cos_lat = cos(ref->lat_rad);
 
+	split_double(lat_0, &ref->lat_deg_hi, &ref->lat_deg_lo);
+	split_double(lon_0, &ref->lon_deg_hi, &ref->lon_deg_lo);
+	ref->sin_lat_f = (float)ref->sin_lat;
+	ref->cos_lat_f = (float)ref->cos_lat;
+
 	ref->timestamp = timestamp;
 	ref->init_done = true;
 
@@ -325,6 +348,96 @@ int map_projection_reproject(const struct map_projection_reference_s *ref, float
 	return 0;
 }
 
+/*
+ * Local projection: the azimuthal equidistant projection evaluated in single precision.
+ * The coordinates are handled as a float plus the float remainder, so that the differences
+ * to the reference are exact, and the formulas are rearranged to avoid the difference of
+ * nearly equal terms (acos() of a value close to 1, asin() of the latitude).
+ */
+int map_projection_project_local(const struct map_projection_reference_s *ref, double lat, double lon, float *x,
+		float *y)
+{
+	if (!map_projection_initialized(ref)) {
+		return -1;
+	}
+
+	float lat_hi, lat_lo, lon_hi, lon_lo;
+	split_double(lat, &lat_hi, &lat_lo);
+	split_double(lon, &lon_hi, &lon_lo);
+
+	/* wrap across the antimeridian, so that the difference of the high parts is exact */
+	if (lon_hi - ref->lon_deg_hi > 180.0f) {
+		add_split(&lon_hi, &lon_lo, -360.0f);
+
+	} else if (lon_hi - ref->lon_deg_hi < -180.0f) {
+		add_split(&lon_hi, &lon_lo, 360.0f);
+	}
+
+	const float d_lat = ((lat_hi - ref->lat_deg_hi) + (lat_lo - ref->lat_deg_lo)) * M_DEG_TO_RAD;
+	const float d_lon = ((lon_hi - ref->lon_deg_hi) + (lon_lo - ref->lon_deg_lo)) * M_DEG_TO_RAD;
+
+	const float sin_d_lat = sinf(d_lat);
+	const float cos_lat = ref->cos_lat_f * cosf(d_lat) - ref->sin_lat_f * sin_d_lat;
+	const float sin_half_d_lon = sinf(0.5f * d_lon);
+
+	/* north and east components of the direction to the point, scaled by sin(c) */
+	const float n = sin_d_lat + 2.0f * ref->sin_lat_f * cos_lat * sin_half_d_lon * sin_half_d_lon;
+	const float e = cos_lat * sinf(d_lon);
+
+	const float sin_c = sqrtf(n * n + e * e);
+	const float k = (sin_c < FLT_EPSILON) ? 1.0f : (asinf(fminf(sin_c, 1.0f)) / sin_c);
+
+	*x = k * n * CONSTANTS_RADIUS_OF_EARTH;
+	*y = k * e * CONSTANTS_RADIUS_OF_EARTH;
+
+	return 0;
+}
+
+int map_projection_reproject_local(const struct map_projection_reference_s *ref, float x, float y, double *lat,
+		double *lon)
+{
+	if (!map_projection_initialized(ref)) {
+		return -1;
+	}
+
+	const float x_rad = x / CONSTANTS_RADIUS_OF_EARTH;
+	const float y_rad = y / CONSTANTS_RADIUS_OF_EARTH;
+	const float c = sqrtf(x_rad * x_rad + y_rad * y_rad);
+
+	float d_lat = 0.0f;
+	float d_lon = 0.0f;
+
+	if (c > 0.0f) {
+		/* unit vector to the point: up, north and east components at the reference */
+		const float sin_c_by_c = sinf(c) / c;
+		const float u = cosf(c);
+		const float n = x_rad * sin_c_by_c;
+		const float e = y_rad * sin_c_by_c;
+
+		/* distance from the polar axis, and its component in the meridian plane of the reference */
+		const float h = u * ref->cos_lat_f - n * ref->sin_lat_f;
+		const float rho = sqrtf(h * h + e * e);
+
+		/* rho - h, evaluated without cancellation */
+		const float q = (h > 0.0f) ? (e * e / (rho + h)) : (rho - h);
+
+		d_lat = atan2f(n - ref->sin_lat_f * q, u + ref->cos_lat_f * q);
+		d_lon = atan2f(e, h);
+	}
+
+	*lat = (double)ref->lat_deg_hi + (double)(ref->lat_deg_lo + d_lat * M_RAD_TO_DEG);
+	*lon = (double)ref->lon_deg_hi + (double)(ref->lon_deg_lo + d_lon * M_RAD_TO_DEG);
+
+	if (*lon > 180.0) {
+		*lon -= 360.0;
+
+	} else if (*lon < -180.0) {
+		*lon += 360.0;
+	}
+
+	return 0;
+}
+
 int map_projection_global_getref(double *lat_0, double *lon_0)
 {
 	if (!map_projection_global_initialized()) {
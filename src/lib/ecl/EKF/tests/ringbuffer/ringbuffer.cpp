@@ -79,7 +79,7 @@ int ringbuffer_main(int argc, char *argv[])
 	// Test3: pushing data into ringbuffer
 	buffer.push(x);
 	assert(buffer.get_newest().time_us == x.time_us);
-	assert(buffer.get_oldest().time_us == 0);
+	assert(buffer.get_oldest().time_us == x.time_us);
 	buffer.push(y);
 	buffer.push(z);
 	assert(buffer.get_newest().time_us == z.time_us);
@@ -101,7 +101,7 @@ int ringbuffer_main(int argc, char *argv[])
 	buffer.allocate(10);
 	buffer.push(x);
 	assert(buffer.get_newest().time_us == x.time_us);
-	assert(buffer.get_oldest().time_us == 0);
+	assert(buffer.get_oldest().time_us == x.time_us);
 	buffer.push(y);
 	buffer.push(z);
 	assert(buffer.get_newest().time_us == z.time_us);
@@ -117,5 +117,36 @@ int ringbuffer_main(int argc, char *argv[])
 	assert(buffer.pop_first_older_than(z.time_us + 100 , &pop) == true);
 	assert(pop.time_us == z.time_us);
 
+	// Test 5: wrap around a buffer whose size is not a power of two
+	buffer.allocate(5);
+
+	for (uint64_t i = 1; i <= 12; i++) {
+		sample s = {};
+		s.time_us = i * 10000;
+		buffer.push(s);
+	}
+
+	// only the last 5 samples are kept
+	assert(buffer.get_oldest().time_us == 80000);
+	assert(buffer.get_newest().time_us == 120000);
+	assert(buffer.pop_first_older_than(79999, &pop) == false);
+
+	// the newest sample which is not newer than the timestamp is returned, the older ones are dropped
+	assert(buffer.pop_first_older_than(105000, &pop) == true);
+	assert(pop.time_us == 100000);
+	assert(buffer.get_oldest().time_us == 110000);
+	assert(buffer.pop_first_older_than(105000, &pop) == false);
+	assert(buffer.pop_first_older_than(120000, &pop) == true);
+	assert(pop.time_us == 120000);
+
+	// the buffer is empty, the next sample overwrites the last one
+	assert(buffer.pop_first_older_than(120000, &pop) == false);
+	sample w = {};
+	w.time_us = 130000;
+	buffer.push(w);
+	assert(buffer.get_oldest().time_us == w.time_us);
+	assert(buffer.pop_first_older_than(w.time_us, &pop) == true);
+	assert(pop.time_us == w.time_us);
+
 	return 0;
 }
@@ -0,0 +1,132 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2017 Estimation and Control Library (ECL). All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name ECL nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file symmetric_matrix.cpp
+ * Test routines for the packed symmetric matrix used for the EKF covariance
+ *
+ */
+
+#include <stdint.h>
+#include <cassert>
+#include "../../SymmetricMatrix.h"
+
+#ifdef POSIX_SHARED
+// standalone ecl build (see EKF/CMakeLists.txt)
+#define __EXPORT
+#endif
+
+extern "C" __EXPORT int symmetric_matrix_main(int argc, char *argv[]);
+
+static const size_t N = 24;
+
+int symmetric_matrix_main(int argc, char *argv[])
+{
+	// Test1: storage is the upper triangle only
+	typedef SymmetricMatrix<float, N> Matrix;
+	assert(Matrix::num_elements == 300);
+	assert(sizeof(Matrix) == 300 * sizeof(float));
+
+	// Test2: zero initialisation
+	Matrix P {};
+
+	for (size_t i = 0; i < N; i++) {
+		for (size_t j = 0; j < N; j++) {
+			assert(P(i, j) == 0.0f);
+		}
+	}
+
+	// Test3: every element of the upper triangle has its own storage, shared with the lower triangle
+	for (size_t i = 0; i < N; i++) {
+		for (size_t j = i; j < N; j++) {
+			P(i, j) = (float)(i * N + j);
+		}
+	}
+
+	for (size_t i = 0; i < N; i++) {
+		for (size_t j = 0; j < N; j++) {
+			assert(P(i, j) == (float)(i <= j ? i * N + j : j * N + i));
+		}
+	}
+
+	// writing to the lower triangle changes the mirrored element
+	P(5, 2) = -1.0f;
+	assert(P(2, 5) == -1.0f);
+	P(2, 5) = (float)(2 * N + 5);
+
+	// Test4: zeroing rows and columns leaves the other elements untouched
+	P.zeroRowsCols(16, 21);
+
+	for (size_t i = 0; i < N; i++) {
+		for (size_t j = i; j < N; j++) {
+			assert(P(i, j) == (((i >= 16 && i <= 21) || (j >= 16 && j <= 21)) ? 0.0f : (float)(i * N + j)));
+		}
+	}
+
+	// single row and column at the end of the matrix
+	P.zeroRowsCols(N - 1, N - 1);
+
+	for (size_t i = 0; i < N; i++) {
+		assert(P(i, N - 1) == 0.0f);
+	}
+
+	assert(P(N - 2, N - 2) == (float)((N - 2) * N + N - 2));
+
+	// Test5: the upper triangle rows alias the elements
+	for (size_t i = 0; i < N - 2; i++) {
+		for (size_t j = i; j < N - 2; j++) {
+			assert(&P.upperRow(i)[j] == &P(i, j));
+		}
+	}
+
+	P.upperRow(3)[7] = -1.0f;
+	assert(P(7, 3) == -1.0f);
+	P(3, 7) = (float)(3 * N + 7);
+
+	// Test6: copy and reset
+	Matrix Q = P;
+	assert(Q(3, 7) == P(7, 3));
+	Q.setZero();
+	assert(Q(3, 7) == 0.0f);
+	assert(P(3, 7) == (float)(3 * N + 7));
+
+	return 0;
+}
+
+#ifdef POSIX_SHARED
+int main(int argc, char *argv[])
+{
+	return symmetric_matrix_main(argc, argv);
+}
+#endif
@@ -46,6 +46,9 @@
 
 void Ekf::fuseVelPosHeight()
 {
+	// only the states that are being estimated are updated
+	updateActiveStates();
+
 	bool fuse_map[6] = {}; // map of booleans true when [VN,VE,VD,PN,PE,PD] observations are available
 	bool innov_check_pass_map[6] = {}; // true when innovations consistency checks pass for [VN,VE,VD,PN,PE,PD] observations
 	float R[6] = {}; // observation variances for [VN,VE,VD,PN,PE,PD]
@@ -206,7 +209,7 @@ void Ekf::fuseVelPosHeight()
 		if (fuse_map[obs_index]) {
 			// compute the innovation variance SK = HPH + R
 			unsigned state_index = obs_index + 4;	// we start with vx and this is the 4. state
-			_vel_pos_innov_var[obs_index] = P[state_index][state_index] + R[obs_index];
+			_vel_pos_innov_var[obs_index] = P(state_index,state_index) + R[obs_index];
 			// Compute the ratio of innovation to gate size
 			_vel_pos_test_ratio[obs_index] = sq(_vel_pos_innov[obs_index]) / (sq(gate_size[obs_index]) *
 							 _vel_pos_innov_var[obs_index]);
@@ -258,25 +261,29 @@ void Ekf::fuseVelPosHeight()
 
 		// calculate kalman gain K = PHS, where S = 1/innovation variance
 		for (int row = 0; row < _k_num_states; row++) {
-			Kfusion[row] = P[row][state_index] / _vel_pos_innov_var[obs_index];
+			Kfusion[row] = P(row,state_index) / _vel_pos_innov_var[obs_index];
 		}
 
 		// update covarinace matrix via Pnew = (I - KH)P
-		float KHP[_k_num_states][_k_num_states];
-		for (unsigned row = 0; row < _k_num_states; row++) {
-			for (unsigned column = 0; column < _k_num_states; column++) {
-				KHP[row][column] = Kfusion[row] * P[state_index][column];
+		CovarianceMatrix KHP;
+		for (unsigned r = 0; r < _num_active_states; r++) {
+			unsigned row = _active_states[r];
+
+			for (unsigned c = r; c < _num_active_states; c++) {
+				unsigned column = _active_states[c];
+				KHP(row,column) = Kfusion[row] * P(state_index,column);
 			}
 		}
 
 		// if the covariance correction will result in a negative variance, then
 		// the covariance marix is unhealthy and must be corrected
 		bool healthy = true;
-		for (int i = 0; i < _k_num_states; i++) {
-			if (P[i][i] < KHP[i][i]) {
+		for (unsigned n = 0; n < _num_active_states; n++) {
+			unsigned i = _active_states[n];
+
+			if (P(i,i) < KHP(i,i)) {
 				// zero rows and columns
-				zeroRows(P,i,i);
-				zeroCols(P,i,i);
+				P.zeroRowsCols(i, i);
 
 				//flag as unhealthy
 				healthy = false;
@@ -316,9 +323,12 @@ void Ekf::fuseVelPosHeight()
 		// only apply covariance and state corrrections if healthy
 		if (healthy) {
 			// apply the covariance corrections
-			for (unsigned row = 0; row < _k_num_states; row++) {
-				for (unsigned column = 0; column < _k_num_states; column++) {
-					P[row][column] = P[row][column] - KHP[row][column];
+			for (unsigned r = 0; r < _num_active_states; r++) {
+				unsigned row = _active_states[r];
+
+				for (unsigned c = r; c < _num_active_states; c++) {
+					unsigned column = _active_states[c];
+					P(row,column) = P(row,column) - KHP(row,column);
 				}
 			}
 
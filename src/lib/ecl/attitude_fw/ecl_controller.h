@@ -72,6 +72,12 @@ struct ECL_ControlData {
 	float groundspeed;
 	float groundspeed_scaler;
 	bool lock_integrator;
+
+	/* attitude trigonometry, computed once per cycle by the caller and shared by the controllers */
+	float sin_roll;
+	float cos_roll;
+	float sin_pitch;
+	float cos_pitch;
 };
 
 class __EXPORT ECL_Controller
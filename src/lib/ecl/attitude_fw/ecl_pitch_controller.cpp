@@ -148,8 +148,8 @@ float ECL_PitchController::control_bodyrate(const struct ECL_ControlData &ctl_da
 float ECL_PitchController::control_euler_rate(const struct ECL_ControlData &ctl_data)
 {
 	/* Transform setpoint to body angular rates (jacobian) */
-	_bodyrate_setpoint = cosf(ctl_data.roll) * _rate_setpoint +
-			     cosf(ctl_data.pitch) * sinf(ctl_data.roll) * ctl_data.yaw_rate_setpoint;
+	_bodyrate_setpoint = ctl_data.cos_roll * _rate_setpoint +
+			     ctl_data.cos_pitch * ctl_data.sin_roll * ctl_data.yaw_rate_setpoint;
 
 	return control_bodyrate(ctl_data);
 }
@@ -137,7 +137,7 @@ float ECL_RollController::control_bodyrate(const struct ECL_ControlData &ctl_dat
 float ECL_RollController::control_euler_rate(const struct ECL_ControlData &ctl_data)
 {
 	/* Transform setpoint to body angular rates (jacobian) */
-	_bodyrate_setpoint = ctl_data.roll_rate_setpoint - sinf(ctl_data.pitch) * ctl_data.yaw_rate_setpoint;
+	_bodyrate_setpoint = ctl_data.roll_rate_setpoint - ctl_data.sin_pitch * ctl_data.yaw_rate_setpoint;
 
 	return control_bodyrate(ctl_data);
 
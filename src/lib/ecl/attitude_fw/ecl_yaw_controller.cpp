@@ -114,7 +114,7 @@ float ECL_YawController::control_attitude_impl_openloop(const struct ECL_Control
 
 	if (!inverted) {
 		/* Calculate desired yaw rate from coordinated turn constraint / (no side forces) */
-		_rate_setpoint = tanf(constrained_roll) * cosf(ctl_data.pitch) * 9.81f / (ctl_data.airspeed < ctl_data.airspeed_min ?
+		_rate_setpoint = tanf(constrained_roll) * ctl_data.cos_pitch * 9.81f / (ctl_data.airspeed < ctl_data.airspeed_min ?
 				 ctl_data.airspeed_min : ctl_data.airspeed);
 	}
 
@@ -215,8 +215,8 @@ float ECL_YawController::control_attitude_impl_accclosedloop(const struct ECL_Co
 float ECL_YawController::control_euler_rate(const struct ECL_ControlData &ctl_data)
 {
 	/* Transform setpoint to body angular rates (jacobian) */
-	_bodyrate_setpoint = -sinf(ctl_data.roll) * ctl_data.pitch_rate_setpoint +
-			     cosf(ctl_data.roll) * cosf(ctl_data.pitch) * _rate_setpoint;
+	_bodyrate_setpoint = -ctl_data.sin_roll * ctl_data.pitch_rate_setpoint +
+			     ctl_data.cos_roll * ctl_data.cos_pitch * _rate_setpoint;
 
 	return control_bodyrate(ctl_data);
 
@@ -95,8 +95,13 @@ void ECL_L1_Pos_Controller::navigate_waypoints(const math::Vector<2> &vector_A,
 	float xtrack_vel;
 	float ltrack_vel;
 
+	update_planar_scale(vector_curr_position(0));
+
+	/* estimate airplane position WRT to B */
+	math::Vector<2> vector_B_to_P = get_local_planar_vector(vector_B, vector_curr_position);
+
 	/* get the direction between the last (visited) and next waypoint */
-	_target_bearing = get_bearing_to_next_waypoint(vector_curr_position(0), vector_curr_position(1), vector_B(0), vector_B(1));
+	_target_bearing = atan2f(-vector_B_to_P(1), -vector_B_to_P(0));
 
 	/* enforce a minimum ground speed of 0.1 m/s to avoid singularities */
 	float ground_speed = math::max(ground_speed_vector.length(), 0.1f);
@@ -112,7 +117,7 @@ void ECL_L1_Pos_Controller::navigate_waypoints(const math::Vector<2> &vector_A,
 	 * skip A and directly continue to B
 	 */
 	if (vector_AB.length() < 1.0e-6f) {
-		vector_AB = get_local_planar_vector(vector_curr_position, vector_B);
+		vector_AB = -vector_B_to_P;
 	}
 
 	vector_AB.normalize();
@@ -131,13 +136,13 @@ void ECL_L1_Pos_Controller::navigate_waypoints(const math::Vector<2> &vector_A,
 	float distance_A_to_airplane = vector_A_to_airplane.length();
 	float alongTrackDist = vector_A_to_airplane * vector_AB;
 
-	/* estimate airplane position WRT to B */
-	math::Vector<2> vector_B_to_P_unit = get_local_planar_vector(vector_B, vector_curr_position).normalized();
-	
-	/* calculate angle of airplane position vector relative to line) */
+	math::Vector<2> vector_B_to_P_unit = vector_B_to_P.normalized();
 
-	// XXX this could probably also be based solely on the dot product
-	float AB_to_BP_bearing = atan2f(vector_B_to_P_unit % vector_AB, vector_B_to_P_unit * vector_AB);
+	/*
+	 * the angle of the airplane position vector relative to the line is below 100 degrees
+	 * if its cosine (dot product of the unit vectors) is above cos(100 deg)
+	 */
+	bool AB_to_BP_bearing_below_100deg = (vector_B_to_P_unit * vector_AB) > -0.173648f;
 
 	/* extension from [2], fly directly to A */
 	if (distance_A_to_airplane > _L1_distance && alongTrackDist / math::max(distance_A_to_airplane , 1.0f) < -0.7071f) {
@@ -150,7 +155,7 @@ void ECL_L1_Pos_Controller::navigate_waypoints(const math::Vector<2> &vector_A,
 		xtrack_vel = ground_speed_vector % (-vector_A_to_airplane_unit);
 		/* velocity along line */
 		ltrack_vel = ground_speed_vector * (-vector_A_to_airplane_unit);
-		eta = atan2f(xtrack_vel, ltrack_vel);
+		eta = math::fast_atan2f(xtrack_vel, ltrack_vel);
 		/* bearing from current position to L1 point */
 		_nav_bearing = atan2f(-vector_A_to_airplane_unit(1) , -vector_A_to_airplane_unit(0));
 
@@ -158,7 +163,7 @@ void ECL_L1_Pos_Controller::navigate_waypoints(const math::Vector<2> &vector_A,
 	 * If the AB vector and the vector from B to airplane point in the same
 	 * direction, we have missed the waypoint. At +- 90 degrees we are just passing it.
 	 */
-	} else if (fabsf(AB_to_BP_bearing) < math::radians(100.0f)) {
+	} else if (AB_to_BP_bearing_below_100deg) {
 		/*
 		 * Extension, fly back to waypoint.
 		 * 
@@ -174,7 +179,7 @@ void ECL_L1_Pos_Controller::navigate_waypoints(const math::Vector<2> &vector_A,
 		xtrack_vel = ground_speed_vector % (-vector_B_to_P_unit);
 		/* velocity along line */
 		ltrack_vel = ground_speed_vector * (-vector_B_to_P_unit);
-		eta = atan2f(xtrack_vel, ltrack_vel);
+		eta = math::fast_atan2f(xtrack_vel, ltrack_vel);
 		/* bearing from current position to L1 point */
 		_nav_bearing = atan2f(-vector_B_to_P_unit(1) , -vector_B_to_P_unit(0));
 
@@ -187,13 +192,13 @@ void ECL_L1_Pos_Controller::navigate_waypoints(const math::Vector<2> &vector_A,
 		/* velocity along line */
 		ltrack_vel = ground_speed_vector * vector_AB;
 		/* calculate eta2 (angle of velocity vector relative to line) */
-		float eta2 = atan2f(xtrack_vel, ltrack_vel);
+		float eta2 = math::fast_atan2f(xtrack_vel, ltrack_vel);
 		/* calculate eta1 (angle to L1 point) */
 		float xtrackErr = vector_A_to_airplane % vector_AB;
 		float sine_eta1 = xtrackErr / math::max(_L1_distance , 0.1f);
 		/* limit output to 45 degrees */
 		sine_eta1 = math::constrain(sine_eta1, -0.7071f, 0.7071f); //sin(pi/4) = 0.7071
-		float eta1 = asinf(sine_eta1);
+		float eta1 = math::fast_asinf(sine_eta1);
 		eta = eta1 + eta2;
 		/* bearing from current position to L1 point */
 		_nav_bearing = atan2f(vector_AB(1), vector_AB(0)) + eta1;
@@ -202,7 +207,7 @@ void ECL_L1_Pos_Controller::navigate_waypoints(const math::Vector<2> &vector_A,
 
 	/* limit angle to +-90 degrees */
 	eta = math::constrain(eta, (-M_PI_F) / 2.0f, +M_PI_F / 2.0f);
-	_lateral_accel = _K_L1 * ground_speed * ground_speed / _L1_distance * sinf(eta);
+	_lateral_accel = _K_L1 * ground_speed * ground_speed / _L1_distance * math::fast_sinf(eta);
 
 	/* flying to waypoints, not circling them */
 	_circle_mode = false;
@@ -221,8 +226,7 @@ void ECL_L1_Pos_Controller::navigate_loiter(const math::Vector<2> &vector_A, con
 	float K_crosstrack = omega * omega;
 	float K_velocity = 2.0f * _L1_damping * omega;
 
-	/* update bearing to next waypoint */
-	_target_bearing = get_bearing_to_next_waypoint(vector_curr_position(0), vector_curr_position(1), vector_A(0), vector_A(1));
+	update_planar_scale(vector_curr_position(0));
 
 	/* ground speed, enforce minimum of 0.1 m/s to avoid singularities */
 	float ground_speed = math::max(ground_speed_vector.length() , 0.1f);
@@ -232,13 +236,17 @@ void ECL_L1_Pos_Controller::navigate_loiter(const math::Vector<2> &vector_A, con
 
 	/* calculate the vector from waypoint A to current position */
 	math::Vector<2> vector_A_to_airplane = get_local_planar_vector(vector_A, vector_curr_position);
+	float distance_A_to_airplane = vector_A_to_airplane.length();
+
+	/* update bearing to next waypoint */
+	_target_bearing = atan2f(-vector_A_to_airplane(1), -vector_A_to_airplane(0));
 
 	math::Vector<2> vector_A_to_airplane_unit;
 
 	/* prevent NaN when normalizing */
-	if (vector_A_to_airplane.length() > FLT_EPSILON) {
+	if (distance_A_to_airplane > FLT_EPSILON) {
 		/* store the normalized vector from waypoint A to current position */
-		vector_A_to_airplane_unit = vector_A_to_airplane.normalized();
+		vector_A_to_airplane_unit = vector_A_to_airplane / distance_A_to_airplane;
 	} else {
 		vector_A_to_airplane_unit = vector_A_to_airplane;
 	}
@@ -249,19 +257,19 @@ void ECL_L1_Pos_Controller::navigate_loiter(const math::Vector<2> &vector_A, con
 	float xtrack_vel_center = vector_A_to_airplane_unit % ground_speed_vector;
 	/* velocity along line from waypoint to current position */
 	float ltrack_vel_center = - (ground_speed_vector * vector_A_to_airplane_unit);
-	float eta = atan2f(xtrack_vel_center, ltrack_vel_center);
+	float eta = math::fast_atan2f(xtrack_vel_center, ltrack_vel_center);
 	/* limit eta to 90 degrees */
 	eta = math::constrain(eta, -M_PI_F / 2.0f, +M_PI_F / 2.0f);
 
 	/* calculate the lateral acceleration to capture the center point */
-	float lateral_accel_sp_center = _K_L1 * ground_speed * ground_speed / _L1_distance * sinf(eta);
+	float lateral_accel_sp_center = _K_L1 * ground_speed * ground_speed / _L1_distance * math::fast_sinf(eta);
 
 	/* for PD control: Calculate radial position and velocity errors */
 
 	/* radial velocity error */
 	float xtrack_vel_circle = -ltrack_vel_center;
 	/* radial distance from the loiter circle (not center) */
-	float xtrack_err_circle = vector_A_to_airplane.length() - radius;
+	float xtrack_err_circle = distance_A_to_airplane - radius;
 
 	/* cross track error for feedback */
 	_crosstrack_error = xtrack_err_circle;
@@ -361,11 +369,20 @@ void ECL_L1_Pos_Controller::navigate_level_flight(float current_heading)
 }
 
 
+void ECL_L1_Pos_Controller::update_planar_scale(float lat)
+{
+	/* the scale changes by less than 0.02% per 0.01 degrees (about 1 km) of latitude */
+	if (!(fabsf(lat - _planar_ref_lat) < 0.01f)) {
+		_planar_ref_lat = lat;
+		_planar_lon_scale = cosf(math::radians(lat));
+	}
+}
+
 math::Vector<2> ECL_L1_Pos_Controller::get_local_planar_vector(const math::Vector<2> &origin, const math::Vector<2> &target) const
 {
 	/* this is an approximation for small angles, proposed by [2] */
 
-	math::Vector<2> out(math::radians((target(0) - origin(0))), math::radians((target(1) - origin(1))*cosf(math::radians(origin(0)))));
+	math::Vector<2> out(math::radians((target(0) - origin(0))), math::radians((target(1) - origin(1)) * _planar_lon_scale));
 
 	return out * static_cast<float>(CONSTANTS_RADIUS_OF_EARTH);
 }
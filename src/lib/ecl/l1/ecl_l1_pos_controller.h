@@ -83,7 +83,9 @@ public:
 		_L1_ratio(5.0),
 		_K_L1(2.0),
 		_heading_omega(1.0),
-		_roll_lim_rad(math::radians(10.0))
+		_roll_lim_rad(math::radians(10.0)),
+		_planar_ref_lat(NAN),
+		_planar_lon_scale(1.0f)
 	{
 	}
 
@@ -261,12 +263,22 @@ private:
 
 	float _roll_lim_rad;  ///<maximum roll angle
 
+	float _planar_ref_lat;		///< latitude of the cached longitude scale, in degrees
+	float _planar_lon_scale;	///< cos(latitude), meters per degree of longitude relative to latitude
+
+	/**
+	 * Update the longitude scale of get_local_planar_vector() for the current position.
+	 * The cosine is only recomputed when the latitude changed noticeably.
+	 */
+	void update_planar_scale(float lat);
+
 	/**
 	 * Convert a 2D vector from WGS84 to planar coordinates.
 	 *
 	 * This converts from latitude and longitude to planar
 	 * coordinates with (0,0) being at the position of ref and
-	 * returns a vector in meters towards wp.
+	 * returns a vector in meters towards wp. The longitude scale
+	 * is the one of the last update_planar_scale().
 	 *
 	 * @param ref The reference position in WGS84 coordinates
 	 * @param wp The point to convert to into the local coordinates, in WGS84 coordinates
@@ -0,0 +1,72 @@
+// SWIG Wrapper for the ULog reader (ulog/ulog_reader.h)
+%module ulog_reader
+%feature("autodoc", "3");
+
+%include "inttypes.i"
+%include "std_vector.i"
+%include "std_string.i"
+%include "std_map.i"
+
+// Include headers in the SWIG generated C++ file
+%{
+    #define SWIG_FILE_WITH_INIT
+    #include <cstdlib>
+    #include "../ulog/ulog_reader.h"
+%}
+
+%include "numpy.i"
+%init %{
+    import_array();
+%}
+
+%template(StringVector) std::vector<std::string>;
+%template(DoubleVector) std::vector<double>;
+%template(ParameterMap) std::map<std::string, float>;
+
+%apply (double **ARGOUTVIEWM_ARRAY1, int *DIM1) {(double **values, int *count)};
+
+// only the topic/field based interface is wrapped
+#define __attribute__(x)
+%ignore ULogReader::Field;
+%ignore ULogReader::Format;
+%ignore ULogReader::Subscription;
+%ignore ULogReader::Message;
+%ignore ULogReader::next;
+%ignore ULogReader::findField;
+%ignore ULogReader::findSubscription;
+%ignore ULogReader::readColumn;
+%ignore ULogReader::dataOffsets;
+%ignore ULogReader::otherOffsets;
+%ignore ULogReader::fileData;
+%ignore ULogReader::formats;
+%ignore ULogReader::subscriptions;
+
+%include "../ulog/ulog_reader.h"
+
+%extend ULogReader {
+    // values of a field as numpy array, without a copy to a python list
+    void column_array(const std::string &topic_name, const std::string &field_name, int multi_id,
+                      double **values, int *count) {
+        std::vector<double> column = self->column(topic_name, field_name, multi_id);
+        *count = column.size();
+        *values = (double *)malloc(column.size() * sizeof(double) + 1);
+        memcpy(*values, column.data(), column.size() * sizeof(double));
+    }
+
+    bool is_integer_field(const std::string &topic_name, const std::string &field_name) {
+        const ULogReader::Field field = self->findField(topic_name, field_name);
+        return field.valid() && field.type != ULogReader::Field::Type::float32
+               && field.type != ULogReader::Field::Type::float64;
+    }
+
+    // names of the logged topics (each instance once)
+    std::vector<std::string> topic_names() {
+        std::vector<std::string> names;
+
+        for (const auto &subscription : self->subscriptions()) {
+            names.push_back(subscription.second.name);
+        }
+
+        return names;
+    }
+}
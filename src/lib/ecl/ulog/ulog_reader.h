@@ -0,0 +1,833 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2017 Estimation and Control Library (ECL). All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name ECL nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+
+/**
+ * @file ulog_reader.h
+ * Header-only reader for ULog files, as written by the PX4 logger. The file format is described in
+ * the PX4 developer guide (logger module, messages.h).
+ *
+ * The file is memory-mapped (read into memory where mmap is not available) and the data messages are
+ * indexed per subscription when opening it. Messages can then be iterated in file order, or the values
+ * of a single field read as a column, which only decodes the messages of that topic.
+ */
+
+#pragma once
+
+#include <inttypes.h>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define ULOG_READER_USE_MMAP
+#endif
+
+class ULogReader
+{
+public:
+	/**
+	 * Location and type of a (scalar or array) field in a message
+	 */
+	struct Field {
+		enum class Type { invalid, int8, uint8, int16, uint16, int32, uint32, int64, uint64, float32, float64, boolean, character };
+
+		Type type{Type::invalid};
+		int array_size{1};
+		size_t offset{0};
+
+		bool valid() const { return type != Type::invalid; }
+
+		/**
+		 * read (an element of) the field from a message, converted to double
+		 * @param data message data
+		 * @param index array index
+		 */
+		double get(const uint8_t *data, int index = 0) const
+		{
+			const uint8_t *ptr = data + offset + index * elementSize(type);
+
+			switch (type) {
+			case Type::int8: return read_as<int8_t>(ptr);
+
+			case Type::uint8: return read_as<uint8_t>(ptr);
+
+			case Type::boolean: return read_as<uint8_t>(ptr);
+
+			case Type::character: return read_as<char>(ptr);
+
+			case Type::int16: return read_as<int16_t>(ptr);
+
+			case Type::uint16: return read_as<uint16_t>(ptr);
+
+			case Type::int32: return read_as<int32_t>(ptr);
+
+			case Type::uint32: return read_as<uint32_t>(ptr);
+
+			case Type::int64: return read_as<int64_t>(ptr);
+
+			case Type::uint64: return read_as<uint64_t>(ptr);
+
+			case Type::float32: return read_as<float>(ptr);
+
+			case Type::float64: return read_as<double>(ptr);
+
+			case Type::invalid: break;
+			}
+
+			return 0.0;
+		}
+
+		/** @return size of a single element of a type [bytes] */
+		static size_t elementSize(Type type)
+		{
+			switch (type) {
+			case Type::int16:
+			case Type::uint16: return 2;
+
+			case Type::int32:
+			case Type::uint32:
+			case Type::float32: return 4;
+
+			case Type::int64:
+			case Type::uint64:
+			case Type::float64: return 8;
+
+			default: return 1;
+			}
+		}
+	};
+
+	struct Format {
+		std::string fields; ///< field definitions ("type name;type name;...")
+		size_t size{0}; ///< message size [bytes], 0 if a type is unknown
+	};
+
+	struct Subscription {
+		std::string name;
+		uint8_t multi_id{0};
+		uint16_t msg_id{0};
+		const Format *format{nullptr};
+		std::vector<uint64_t> offsets; ///< file offsets of the data messages
+	};
+
+	struct Message {
+		const Subscription *subscription;
+		const uint8_t *data;
+		size_t size;
+	};
+
+	ULogReader() = default;
+	~ULogReader() { close(); }
+
+	ULogReader(const ULogReader &) = delete;
+	ULogReader &operator=(const ULogReader &) = delete;
+
+	/**
+	 * map a file, parse the header and the definitions and index the data section
+	 * @return true on success
+	 */
+	bool open(const char *file_name)
+	{
+		close();
+
+		if (!mapFile(file_name)) {
+			_error = "failed to read the file";
+			return false;
+		}
+
+		if (_size < file_header_size) {
+			_error = "not a ULog file";
+			return false;
+		}
+
+		static const uint8_t magic[] = {'U', 'L', 'o', 'g', 0x01, 0x12, 0x35};
+		static const uint8_t magic_compressed[] = {'U', 'L', 'o', 'g', 'Z', 0x12, 0x35};
+
+		if (memcmp(_data, magic_compressed, sizeof(magic_compressed)) == 0) {
+			_error = "compressed log, convert it with Tools/ulog_decompress.py first";
+			return false;
+		}
+
+		if (memcmp(_data, magic, sizeof(magic)) != 0) {
+			_error = "not a ULog file";
+			return false;
+		}
+
+		_start_time = read_as<uint64_t>(_data + 8);
+		_pos = file_header_size;
+		_end = _size;
+
+		if (!readDefinitions()) {
+			return false;
+		}
+
+		_data_start = _pos;
+		buildIndex();
+		return true;
+	}
+
+	void close()
+	{
+#ifdef ULOG_READER_USE_MMAP
+
+		if (_mapped) {
+			munmap((void *)_data, _size);
+		}
+
+		_mapped = false;
+#endif
+		_buffer.clear();
+		_data = nullptr;
+		_size = 0;
+		_pos = _end = _data_start = 0;
+		_formats.clear();
+		_subscriptions.clear();
+		_other_offsets.clear();
+		_parameters.clear();
+	}
+
+	/**
+	 * get the next data message, in file order
+	 * @return false at the end of the file or on an error
+	 */
+	bool next(Message &message)
+	{
+		while (_pos + sizeof(MessageHeader) <= _end) {
+			const MessageHeader header = read_as<MessageHeader>(_data + _pos);
+			const uint8_t *msg = _data + _pos + sizeof(MessageHeader);
+
+			if (_pos + sizeof(MessageHeader) + header.msg_size > _end) {
+				// truncated
+				break;
+			}
+
+			_pos += sizeof(MessageHeader) + header.msg_size;
+
+			if (header.msg_type == 'D' && header.msg_size >= 2) {
+				const Subscription *subscription = findSubscription(read_as<uint16_t>(msg));
+
+				if (subscription && subscription->format && header.msg_size - 2u >= subscription->format->size) {
+					message.subscription = subscription;
+					message.data = msg + 2;
+					message.size = header.msg_size - 2;
+					return true;
+				}
+			}
+		}
+
+		return false;
+	}
+
+	/** restart next() at the beginning of the data section */
+	void rewind() { _pos = _data_start; }
+
+	/**
+	 * find a field in the format of a topic. An array element can be selected with "name[index]".
+	 * @return invalid field if the topic or field does not exist, or the type is not a basic type
+	 */
+	Field findField(const std::string &topic_name, const std::string &field_name) const
+	{
+		Field field;
+		auto format = _formats.find(topic_name);
+
+		if (format == _formats.end() || format->second.size == 0) {
+			return field;
+		}
+
+		std::string name_to_find = field_name;
+		int element = -1;
+		const size_t element_bracket = field_name.find('[');
+
+		if (element_bracket != std::string::npos) {
+			name_to_find = field_name.substr(0, element_bracket);
+			element = atoi(field_name.c_str() + element_bracket + 1);
+		}
+
+		const std::string &fields = format->second.fields;
+		size_t offset = 0;
+		size_t prev_field_end = 0;
+		size_t field_end = fields.find(';');
+
+		while (field_end != std::string::npos) {
+			const size_t space_pos = fields.find(' ', prev_field_end);
+
+			if (space_pos != std::string::npos && space_pos < field_end) {
+				const std::string type_name_full = fields.substr(prev_field_end, space_pos - prev_field_end);
+
+				if (fields.compare(space_pos + 1, field_end - space_pos - 1, name_to_find) == 0) {
+					std::string type_name = type_name_full;
+					const size_t bracket = type_name.find('[');
+
+					if (bracket != std::string::npos) {
+						field.array_size = atoi(type_name.c_str() + bracket + 1);
+						type_name = type_name.substr(0, bracket);
+					}
+
+					field.type = basicType(type_name);
+					field.offset = offset;
+
+					if (element >= 0) {
+						if (element >= field.array_size) {
+							field.type = Field::Type::invalid;
+
+						} else {
+							field.offset += element * Field::elementSize(field.type);
+							field.array_size = 1;
+						}
+					}
+
+					return field;
+				}
+
+				offset += sizeOfFullType(type_name_full);
+			}
+
+			prev_field_end = field_end + 1;
+			field_end = fields.find(';', prev_field_end);
+		}
+
+		return field;
+	}
+
+	/**
+	 * names of the fields of a topic with a basic type, array elements as "name[index]". Padding and
+	 * nested types are skipped.
+	 */
+	std::vector<std::string> fieldNames(const std::string &topic_name) const
+	{
+		std::vector<std::string> names;
+		auto format = _formats.find(topic_name);
+
+		if (format == _formats.end()) {
+			return names;
+		}
+
+		const std::string &fields = format->second.fields;
+		size_t prev_field_end = 0;
+		size_t field_end = fields.find(';');
+
+		while (field_end != std::string::npos) {
+			const size_t space_pos = fields.find(' ', prev_field_end);
+
+			if (space_pos != std::string::npos && space_pos < field_end) {
+				std::string type_name = fields.substr(prev_field_end, space_pos - prev_field_end);
+				const std::string name = fields.substr(space_pos + 1, field_end - space_pos - 1);
+				int array_size = 0;
+				const size_t bracket = type_name.find('[');
+
+				if (bracket != std::string::npos) {
+					array_size = atoi(type_name.c_str() + bracket + 1);
+					type_name = type_name.substr(0, bracket);
+				}
+
+				if (basicType(type_name) != Field::Type::invalid && name.compare(0, 8, "_padding") != 0) {
+					if (array_size == 0) {
+						names.push_back(name);
+					}
+
+					for (int i = 0; i < array_size; ++i) {
+						names.push_back(name + "[" + std::to_string(i) + "]");
+					}
+				}
+			}
+
+			prev_field_end = field_end + 1;
+			field_end = fields.find(';', prev_field_end);
+		}
+
+		return names;
+	}
+
+	/** @return subscription of a topic instance, nullptr if it is not logged */
+	const Subscription *findSubscription(const std::string &topic_name, uint8_t multi_id = 0) const
+	{
+		for (const auto &subscription : _subscriptions) {
+			if (subscription.second.multi_id == multi_id && subscription.second.name == topic_name) {
+				return &subscription.second;
+			}
+		}
+
+		return nullptr;
+	}
+
+	/** @return subscription by msg_id, nullptr if there is none */
+	const Subscription *findSubscription(uint16_t msg_id) const
+	{
+		auto subscription = _subscriptions.find(msg_id);
+		return subscription != _subscriptions.end() ? &subscription->second : nullptr;
+	}
+
+	/**
+	 * read all values of a field of a subscription. Only the messages of this subscription are decoded.
+	 * @param index array index
+	 * @return number of values
+	 */
+	size_t readColumn(const Subscription &subscription, const Field &field, std::vector<double> &values,
+			  int index = 0) const
+	{
+		values.clear();
+
+		if (!field.valid() || !subscription.format) {
+			return 0;
+		}
+
+		values.reserve(subscription.offsets.size());
+
+		for (uint64_t offset : subscription.offsets) {
+			const MessageHeader header = read_as<MessageHeader>(_data + offset);
+
+			if (header.msg_size - 2u >= subscription.format->size) {
+				values.push_back(field.get(_data + offset + sizeof(MessageHeader) + 2, index));
+			}
+		}
+
+		return values.size();
+	}
+
+	/**
+	 * convenience wrapper: all values of a field ("name" or "name[index]") of a topic instance
+	 * @return empty if the topic or field does not exist
+	 */
+	std::vector<double> column(const std::string &topic_name, const std::string &field_name, int multi_id = 0) const
+	{
+		std::vector<double> values;
+		const Subscription *subscription = findSubscription(topic_name, multi_id);
+
+		if (subscription) {
+			readColumn(*subscription, findField(topic_name, field_name), values);
+		}
+
+		return values;
+	}
+
+	/** @return file offsets of the data messages of a msg_id */
+	const std::vector<uint64_t> &dataOffsets(uint16_t msg_id) const
+	{
+		static const std::vector<uint64_t> empty;
+		const Subscription *subscription = findSubscription(msg_id);
+		return subscription ? subscription->offsets : empty;
+	}
+
+	/** @return file offsets of all messages in the data section, except data messages */
+	const std::vector<uint64_t> &otherOffsets() const { return _other_offsets; }
+
+	/** @return file contents */
+	const uint8_t *fileData() const { return _data; }
+
+	/** @return end of the log data (excluding appended data) */
+	size_t dataEnd() const { return _end; }
+
+	/** @return file offset of the data section (first ADD_LOGGED_MSG message) */
+	size_t dataStart() const { return _data_start; }
+
+	/** @return logging start time from the file header [us] */
+	uint64_t startTime() const { return _start_time; }
+
+	const std::map<std::string, Format> &formats() const { return _formats; }
+	const std::map<uint16_t, Subscription> &subscriptions() const { return _subscriptions; }
+
+	/** parameters with their initial values (int32_t parameters are converted to float) */
+	const std::map<std::string, float> &parameters() const { return _parameters; }
+
+	const std::string &error() const { return _error; }
+
+private:
+	struct MessageHeader {
+		uint16_t msg_size;
+		uint8_t msg_type;
+	} __attribute__((packed));
+
+	// mirrors ULOG_INCOMPAT_FLAG0_DATA_APPENDED_MASK of the logger
+	static constexpr uint8_t incompat_flag0_data_appended_mask = 1 << 0;
+
+	static constexpr size_t file_header_size = 16; ///< magic (7), version (1), timestamp (8)
+
+	template <typename T>
+	static T read_as(const uint8_t *ptr)
+	{
+		T value;
+		memcpy(&value, ptr, sizeof(T));
+		return value;
+	}
+
+	bool mapFile(const char *file_name)
+	{
+#ifdef ULOG_READER_USE_MMAP
+		const int fd = ::open(file_name, O_RDONLY);
+
+		if (fd < 0) {
+			return false;
+		}
+
+		struct stat st;
+
+		if (fstat(fd, &st) == 0 && st.st_size > 0) {
+			void *data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+			if (data != MAP_FAILED) {
+				_data = (const uint8_t *)data;
+				_size = st.st_size;
+				_mapped = true;
+			}
+		}
+
+		::close(fd);
+
+		if (_mapped) {
+			return true;
+		}
+
+#endif
+		// fall back to reading the whole file
+		FILE *file = fopen(file_name, "rb");
+
+		if (!file) {
+			return false;
+		}
+
+		fseek(file, 0, SEEK_END);
+		const long file_size = ftell(file);
+		fseek(file, 0, SEEK_SET);
+
+		if (file_size > 0) {
+			_buffer.resize(file_size);
+
+			if (fread(_buffer.data(), 1, file_size, file) != (size_t)file_size) {
+				_buffer.clear();
+			}
+		}
+
+		fclose(file);
+		_data = _buffer.data();
+		_size = _buffer.size();
+		return _size > 0;
+	}
+
+	bool readDefinitions()
+	{
+		while (_pos + sizeof(MessageHeader) <= _end) {
+			const MessageHeader header = read_as<MessageHeader>(_data + _pos);
+			const uint8_t *message = _data + _pos + sizeof(MessageHeader);
+
+			if (_pos + sizeof(MessageHeader) + header.msg_size > _end) {
+				break;
+			}
+
+			switch (header.msg_type) {
+			case 'B':
+				if (!parseFlagBits(message, header.msg_size)) {
+					return false;
+				}
+
+				break;
+
+			case 'F':
+				if (!parseFormat(message, header.msg_size)) {
+					return false;
+				}
+
+				break;
+
+			case 'P':
+				parseParameter(message, header.msg_size);
+				break;
+
+			case 'A':
+				// first message of the data section: the formats are complete
+				computeFormatSizes();
+				return true;
+
+			default:
+				// info messages and anything unknown
+				break;
+			}
+
+			_pos += sizeof(MessageHeader) + header.msg_size;
+		}
+
+		_error = "no data section";
+		return false;
+	}
+
+	/** one pass over the data section: add the subscriptions and index all messages */
+	void buildIndex()
+	{
+		size_t pos = _data_start;
+
+		while (pos + sizeof(MessageHeader) <= _end) {
+			const MessageHeader header = read_as<MessageHeader>(_data + pos);
+			const uint8_t *message = _data + pos + sizeof(MessageHeader);
+
+			if (pos + sizeof(MessageHeader) + header.msg_size > _end) {
+				break; // truncated message
+			}
+
+			if (header.msg_type == 'D') {
+				if (header.msg_size >= 2) {
+					auto subscription = _subscriptions.find(read_as<uint16_t>(message));
+
+					if (subscription != _subscriptions.end()) {
+						subscription->second.offsets.push_back(pos);
+					}
+				}
+
+			} else {
+				if (header.msg_type == 'A') {
+					parseSubscription(message, header.msg_size);
+				}
+
+				_other_offsets.push_back(pos);
+			}
+
+			pos += sizeof(MessageHeader) + header.msg_size;
+		}
+	}
+
+	/** calculate the message sizes of all formats (0 if a type is unknown) */
+	void computeFormatSizes()
+	{
+		// nested types must be known first, so repeat until there is no progress
+		bool progress = true;
+
+		while (progress) {
+			progress = false;
+
+			for (auto &format : _formats) {
+				if (format.second.size > 0) {
+					continue;
+				}
+
+				const std::string &fields = format.second.fields;
+				size_t size = 0;
+				bool complete = true;
+				size_t prev_field_end = 0;
+				size_t field_end = fields.find(';');
+
+				while (field_end != std::string::npos && complete) {
+					const size_t space_pos = fields.find(' ', prev_field_end);
+
+					if (space_pos != std::string::npos && space_pos < field_end) {
+						const size_t field_size = sizeOfFullType(fields.substr(prev_field_end, space_pos - prev_field_end));
+						complete = field_size > 0;
+						size += field_size;
+					}
+
+					prev_field_end = field_end + 1;
+					field_end = fields.find(';', prev_field_end);
+				}
+
+				if (complete && size > 0) {
+					format.second.size = size;
+					progress = true;
+				}
+			}
+		}
+	}
+
+	bool parseFlagBits(const uint8_t *message, uint16_t msg_size)
+	{
+		if (msg_size != 40) {
+			_error = "unsupported length of the flag bits message";
+			return false;
+		}
+
+		const uint8_t *incompat_flags = message + 8;
+
+		if (incompat_flags[0] & ~incompat_flag0_data_appended_mask) {
+			_error = "unknown incompat bits";
+			return false;
+		}
+
+		for (int i = 1; i < 8; ++i) {
+			if (incompat_flags[i]) {
+				_error = "unknown incompat bits";
+				return false;
+			}
+		}
+
+		if (incompat_flags[0] & incompat_flag0_data_appended_mask) {
+			// the appended data is only used for hardfault dumps, ignore it
+			const uint64_t appended_offset = read_as<uint64_t>(message + 16);
+
+			if (appended_offset > 0 && appended_offset < _end) {
+				_end = appended_offset;
+			}
+		}
+
+		return true;
+	}
+
+	bool parseFormat(const uint8_t *message, uint16_t msg_size)
+	{
+		const std::string format((const char *)message, msg_size);
+		const size_t pos = format.find(':');
+
+		if (pos == std::string::npos) {
+			_error = "invalid format message";
+			return false;
+		}
+
+		_formats[format.substr(0, pos)].fields = format.substr(pos + 1);
+		return true;
+	}
+
+	void parseParameter(const uint8_t *message, uint16_t msg_size)
+	{
+		const uint8_t key_len = message[0];
+
+		if (msg_size < 1 + key_len + 4) {
+			return;
+		}
+
+		const std::string key((const char *)message + 1, key_len);
+		const size_t pos = key.find(' ');
+
+		if (pos == std::string::npos) {
+			return;
+		}
+
+		const std::string type = key.substr(0, pos);
+		const std::string name = key.substr(pos + 1);
+
+		if (type == "float") {
+			_parameters[name] = read_as<float>(message + 1 + key_len);
+
+		} else if (type == "int32_t") {
+			_parameters[name] = read_as<int32_t>(message + 1 + key_len);
+		}
+	}
+
+	void parseSubscription(const uint8_t *message, uint16_t msg_size)
+	{
+		if (msg_size < 4) {
+			return;
+		}
+
+		Subscription subscription;
+		subscription.multi_id = message[0];
+		subscription.msg_id = read_as<uint16_t>(message + 1);
+		subscription.name = std::string((const char *)message + 3, msg_size - 3);
+
+		auto format = _formats.find(subscription.name);
+
+		if (format != _formats.end() && format->second.size > 0) {
+			subscription.format = &format->second;
+		}
+
+		// keep the index if a msg_id is added again
+		Subscription &entry = _subscriptions[subscription.msg_id];
+		subscription.offsets.swap(entry.offsets);
+		entry = subscription;
+	}
+
+	static Field::Type basicType(const std::string &type_name)
+	{
+		static const struct {
+			const char *name;
+			Field::Type type;
+		} types[] = {
+			{"int8_t", Field::Type::int8}, {"uint8_t", Field::Type::uint8},
+			{"int16_t", Field::Type::int16}, {"uint16_t", Field::Type::uint16},
+			{"int32_t", Field::Type::int32}, {"uint32_t", Field::Type::uint32},
+			{"int64_t", Field::Type::int64}, {"uint64_t", Field::Type::uint64},
+			{"float", Field::Type::float32}, {"double", Field::Type::float64},
+			{"bool", Field::Type::boolean}, {"char", Field::Type::character},
+		};
+
+		for (const auto &type : types) {
+			if (type_name == type.name) {
+				return type.type;
+			}
+		}
+
+		return Field::Type::invalid;
+	}
+
+	/** @return size of a (possibly nested) type without array, 0 if unknown */
+	size_t sizeOfType(const std::string &type_name) const
+	{
+		const Field::Type type = basicType(type_name);
+
+		if (type != Field::Type::invalid) {
+			return Field::elementSize(type);
+		}
+
+		// nested type
+		auto format = _formats.find(type_name);
+
+		if (format != _formats.end()) {
+			return format->second.size;
+		}
+
+		return 0;
+	}
+
+	/** @return size of a type that can be an array ("float[3]"), 0 if unknown */
+	size_t sizeOfFullType(const std::string &type_name_full) const
+	{
+		const size_t bracket = type_name_full.find('[');
+
+		if (bracket == std::string::npos) {
+			return sizeOfType(type_name_full);
+		}
+
+		return atoi(type_name_full.c_str() + bracket + 1) * sizeOfType(type_name_full.substr(0, bracket));
+	}
+
+	const uint8_t *_data{nullptr}; ///< file contents
+	size_t _size{0};
+	std::vector<uint8_t> _buffer; ///< file contents if the file is not mapped
+#ifdef ULOG_READER_USE_MMAP
+	bool _mapped {false};
+#endif
+
+	size_t _pos{0}; ///< read position of next()
+	size_t _end{0}; ///< end of the log data (excluding appended data)
+	size_t _data_start{0};
+	uint64_t _start_time{0};
+
+	std::map<std::string, Format> _formats;
+	std::map<uint16_t, Subscription> _subscriptions; ///< by msg_id
+	std::vector<uint64_t> _other_offsets;
+	std::map<std::string, float> _parameters;
+	std::string _error;
+};
@@ -39,92 +39,189 @@
  * @author Lorenz Meier <lorenz@px4.io>
  */
 
+
 #include "data_validator_group.h"
 #include <ecl/ecl.h>
 #include <cfloat>
+#include <string.h>
 
 DataValidatorGroup::DataValidatorGroup(unsigned siblings) :
-	_first(nullptr),
+	_num_validators(0),
+	_timeout_interval_us(20000),
+	_value_equal_count_threshold(DataValidator::VALUE_EQUAL_COUNT_DEFAULT),
 	_curr_best(-1),
 	_prev_best(-1),
 	_first_failover_time(0),
 	_toggle_count(0)
 {
-	DataValidator *next = _first;
-
 	for (unsigned i = 0; i < siblings; i++) {
-		next = new DataValidator(next);
+		add_new_validator();
 	}
-
-	_first = next;
-	_timeout_interval_us = _first->get_timeout();
 }
 
-DataValidatorGroup::~DataValidatorGroup()
+bool DataValidatorGroup::add_new_validator()
 {
-	while (_first) {
-		DataValidator* next = _first->sibling();
-		delete (_first);
-		_first = next;
+	if (_num_validators >= max_validators) {
+		return false;
 	}
-}
 
-DataValidator *DataValidatorGroup::add_new_validator()
-{
-	DataValidator *validator = new DataValidator(_first);
-	if (!validator) {
-		return nullptr;
-	}
-	_first = validator;
-	_first->set_timeout(_timeout_interval_us);
-	return _first;
+	const unsigned i = _num_validators;
+
+	_error_mask[i] = DataValidator::ERROR_FLAG_NO_ERROR;
+	_time_last[i] = 0;
+	_event_count[i] = 0;
+	_error_count[i] = 0;
+	_error_density[i] = 0;
+	_priority[i] = 0;
+	_data_confidence[i] = 0.0f;
+	_value_equal_count[i] = 0;
+	memset(_mean[i], 0, sizeof(_mean[i]));
+	memset(_lp[i], 0, sizeof(_lp[i]));
+	memset(_M2[i], 0, sizeof(_M2[i]));
+	memset(_rms[i], 0, sizeof(_rms[i]));
+	memset(_value[i], 0, sizeof(_value[i]));
+	memset(_vibe[i], 0, sizeof(_vibe[i]));
+
+	_num_validators++;
+	return true;
 }
 
 void
 DataValidatorGroup::set_timeout(uint32_t timeout_interval_us)
 {
-	DataValidator *next = _first;
-
-	while (next != nullptr) {
-		next->set_timeout(timeout_interval_us);
-		next = next->sibling();
-	}
 	_timeout_interval_us = timeout_interval_us;
 }
 
 void
 DataValidatorGroup::set_equal_value_threshold(uint32_t threshold)
 {
-	DataValidator *next = _first;
-
-	while (next != nullptr) {
-		next->set_equal_value_threshold(threshold);
-		next = next->sibling();
-	}
+	_value_equal_count_threshold = threshold;
 }
 
 
 void
 DataValidatorGroup::put(unsigned index, uint64_t timestamp, float val[3], uint64_t error_count, int priority)
 {
-	DataValidator *next = _first;
-	unsigned i = 0;
+	if (index >= _num_validators) {
+		return;
+	}
+
+	_event_count[index]++;
 
-	while (next != nullptr) {
-		if (i == index) {
-			next->put(timestamp, val, error_count, priority);
-			break;
+	if (error_count > _error_count[index]) {
+		_error_density[index] += (error_count - _error_count[index]);
+	} else if (_error_density[index] > 0) {
+		_error_density[index]--;
+	}
+
+	_error_count[index] = error_count;
+	_priority[index] = priority;
+
+	float *mean = _mean[index];
+	float *lp = _lp[index];
+	float *M2 = _M2[index];
+	float *rms = _rms[index];
+	float *value = _value[index];
+	float *vibe = _vibe[index];
+
+	if (_time_last[index] == 0) {
+		for (unsigned i = 0; i < dimensions; i++) {
+			mean[i] = 0;
+			lp[i] = val[i];
+			M2[i] = 0;
+		}
+	} else {
+		const float event_count_inv = 1.0f / _event_count[index];
+		const float variance_scale = 1.0f / (_event_count[index] - 1);
+		float equal_count = _value_equal_count[index];
+
+		for (unsigned i = 0; i < dimensions; i++) {
+			float lp_val = val[i] - lp[i];
+
+			float delta_val = lp_val - mean[i];
+			mean[i] += delta_val * event_count_inv;
+			M2[i] += delta_val * (lp_val - mean[i]);
+			rms[i] = sqrtf(M2[i] * variance_scale);
+
+			if (fabsf(value[i] - val[i]) < 0.000001f) {
+				equal_count++;
+			} else {
+				equal_count = 0;
+			}
 		}
-		next = next->sibling();
-		i++;
+
+		_value_equal_count[index] = equal_count;
+	}
+
+	for (unsigned i = 0; i < dimensions; i++) {
+		vibe[i] = vibe[i] * 0.99f + 0.01f * fabsf(val[i] - lp[i]);
+
+		// XXX replace with better filter, make it auto-tune to update rate
+		lp[i] = lp[i] * 0.99f + 0.01f * val[i];
+
+		value[i] = val[i];
 	}
+
+	_time_last[index] = timestamp;
+
+	update_data_confidence(index);
+}
+
+void
+DataValidatorGroup::update_data_confidence(unsigned index)
+{
+	float ret = 1.0f;
+
+	/* we got the exact same sensor value N times in a row */
+	if (_value_equal_count[index] > _value_equal_count_threshold) {
+		_error_mask[index] |= DataValidator::ERROR_FLAG_STALE_DATA;
+		ret = 0.0f;
+
+	/* check error count limit */
+	} else if (_error_count[index] > DataValidator::NORETURN_ERRCOUNT) {
+		_error_mask[index] |= DataValidator::ERROR_FLAG_HIGH_ERRCOUNT;
+		ret = 0.0f;
+
+	/* cap error density counter at window size */
+	} else if (_error_density[index] > DataValidator::ERROR_DENSITY_WINDOW) {
+		_error_mask[index] |= DataValidator::ERROR_FLAG_HIGH_ERRDENSITY;
+		_error_density[index] = DataValidator::ERROR_DENSITY_WINDOW;
+	}
+
+	/* no critical errors */
+	if (ret > 0.0f) {
+		/* return local error density for last N measurements */
+		ret = 1.0f - (_error_density[index] / DataValidator::ERROR_DENSITY_WINDOW);
+
+		if (ret > 0.0f) {
+			_error_mask[index] = DataValidator::ERROR_FLAG_NO_ERROR;
+		}
+	}
+
+	_data_confidence[index] = ret;
+}
+
+float
+DataValidatorGroup::confidence(unsigned index, uint64_t timestamp)
+{
+	/* check if we have any data */
+	if (_time_last[index] == 0) {
+		_error_mask[index] |= DataValidator::ERROR_FLAG_NO_DATA;
+		return 0.0f;
+	}
+
+	/* timed out - that's it */
+	if (timestamp - _time_last[index] > _timeout_interval_us) {
+		_error_mask[index] |= DataValidator::ERROR_FLAG_TIMEOUT;
+		return 0.0f;
+	}
+
+	return _data_confidence[index];
 }
 
 float*
 DataValidatorGroup::get_best(uint64_t timestamp, int *index)
 {
-	DataValidator *next = _first;
-
 	// XXX This should eventually also include voting
 	int pre_check_best = _curr_best;
 	float pre_check_confidence = 1.0f;
@@ -132,15 +229,12 @@ DataValidatorGroup::get_best(uint64_t timestamp, int *index)
 	float max_confidence = -1.0f;
 	int max_priority = -1000;
 	int max_index = -1;
-	DataValidator *best = nullptr;
 
-	unsigned i = 0;
-
-	while (next != nullptr) {
-		float confidence = next->confidence(timestamp);
+	for (unsigned i = 0; i < _num_validators; i++) {
+		float confidence = this->confidence(i, timestamp);
 
 		if (static_cast<int>(i) == pre_check_best) {
-			pre_check_prio = next->priority();
+			pre_check_prio = _priority[i];
 			pre_check_confidence = confidence;
 		}
 
@@ -150,17 +244,13 @@ DataValidatorGroup::get_best(uint64_t timestamp, int *index)
 		 * 2) the confidence is no less than 1% different and the priority is higher
 		 */
 		if ((((max_confidence < MIN_REGULAR_CONFIDENCE) && (confidence >= MIN_REGULAR_CONFIDENCE)) ||
-			(confidence > max_confidence && (next->priority() >= max_priority)) ||
-			(fabsf(confidence - max_confidence) < 0.01f && (next->priority() > max_priority))
+			(confidence > max_confidence && (_priority[i] >= max_priority)) ||
+			(fabsf(confidence - max_confidence) < 0.01f && (_priority[i] > max_priority))
 			) && (confidence > 0.0f)) {
 			max_index = i;
 			max_confidence = confidence;
-			max_priority = next->priority();
-			best = next;
+			max_priority = _priority[i];
 		}
-
-		next = next->sibling();
-		i++;
 	}
 
 	/* the current best sensor is not matching the previous best sensor,
@@ -175,7 +265,7 @@ DataValidatorGroup::get_best(uint64_t timestamp, int *index)
 			/* this is not a failover */
 			true_failsafe = false;
 			/* reset error flags, this is likely a hotplug sensor coming online late */
-			best->reset_state();
+			_error_mask[max_index] = DataValidator::ERROR_FLAG_NO_ERROR;
 		}
 
 		/* if we're no initialized, initialize the bookkeeping but do not count a failsafe */
@@ -199,30 +289,24 @@ DataValidatorGroup::get_best(uint64_t timestamp, int *index)
 		_curr_best = max_index;
 	}
 	*index = max_index;
-	return (best) ? best->value() : nullptr;
+	return (max_index >= 0) ? _value[max_index] : nullptr;
 }
 
 float
 DataValidatorGroup::get_vibration_factor(uint64_t timestamp)
 {
-	DataValidator *next = _first;
-
 	float vibe = 0.0f;
 
 	/* find the best RMS value of a non-timed out sensor */
-	while (next != nullptr) {
+	for (unsigned i = 0; i < _num_validators; i++) {
 
-		if (next->confidence(timestamp) > 0.5f) {
-			float* rms = next->rms();
-
-			for (unsigned j = 0; j < 3; j++) {
-				if (rms[j] > vibe) {
-					vibe = rms[j];
+		if (confidence(i, timestamp) > 0.5f) {
+			for (unsigned j = 0; j < dimensions; j++) {
+				if (_rms[i][j] > vibe) {
+					vibe = _rms[i][j];
 				}
 			}
 		}
-
-		next = next->sibling();
 	}
 
 	return vibe;
@@ -231,22 +315,16 @@ DataValidatorGroup::get_vibration_factor(uint64_t timestamp)
 float
 DataValidatorGroup::get_vibration_offset(uint64_t timestamp, int axis)
 {
-	DataValidator *next = _first;
-
 	float vibe = -1.0f;
 
 	/* find the best vibration value of a non-timed out sensor */
-	while (next != nullptr) {
-
-		if (next->confidence(timestamp) > 0.5f) {
-			float* vibration_offset = next->vibration_offset();
+	for (unsigned i = 0; i < _num_validators; i++) {
 
-			if (vibe < 0.0f || vibration_offset[axis] < vibe) {
-				vibe = vibration_offset[axis];
+		if (confidence(i, timestamp) > 0.5f) {
+			if (vibe < 0.0f || _vibe[i][axis] < vibe) {
+				vibe = _vibe[i][axis];
 			}
 		}
-
-		next = next->sibling();
 	}
 
 	return vibe;
@@ -260,14 +338,13 @@ DataValidatorGroup::print()
 		_curr_best, _prev_best, (_toggle_count > 0) ? "YES" : "NO",
 		_toggle_count);
 
-	DataValidator *next = _first;
-	unsigned i = 0;
+	const uint64_t now = ecl_absolute_time();
 
-	while (next != nullptr) {
-		if (next->used()) {
-			uint32_t flags = next->state();
+	for (unsigned i = 0; i < _num_validators; i++) {
+		if (_time_last[i] > 0) {
+			uint32_t flags = _error_mask[i];
 
-			ECL_INFO("sensor #%u, prio: %d, state:%s%s%s%s%s%s", i, next->priority(),
+			ECL_INFO("sensor #%u, prio: %d, state:%s%s%s%s%s%s", i, _priority[i],
 			((flags & DataValidator::ERROR_FLAG_NO_DATA) ? " OFF" : ""),
 			((flags & DataValidator::ERROR_FLAG_STALE_DATA) ? " STALE" : ""),
 			((flags & DataValidator::ERROR_FLAG_TIMEOUT) ? " TOUT" : ""),
@@ -275,10 +352,18 @@ DataValidatorGroup::print()
 			((flags & DataValidator::ERROR_FLAG_HIGH_ERRDENSITY) ? " EDNST" : ""),
 			((flags == DataValidator::ERROR_FLAG_NO_ERROR) ? " OK" : ""));
 
-			next->print();
+			print_validator(i, now);
 		}
-		next = next->sibling();
-		i++;
+	}
+}
+
+void
+DataValidatorGroup::print_validator(unsigned index, uint64_t timestamp)
+{
+	for (unsigned i = 0; i < dimensions; i++) {
+		ECL_INFO("\tval: %8.4f, lp: %8.4f mean dev: %8.4f RMS: %8.4f conf: %8.4f",
+			(double)_value[index][i], (double)_lp[index][i], (double)_mean[index][i],
+			(double)_rms[index][i], (double)confidence(index, timestamp));
 	}
 }
 
@@ -291,15 +376,9 @@ DataValidatorGroup::failover_count()
 int
 DataValidatorGroup::failover_index()
 {
-	DataValidator *next = _first;
-	unsigned i = 0;
-
-	while (next != nullptr) {
-		if (next->used() && (next->state() != DataValidator::ERROR_FLAG_NO_ERROR) && (i == (unsigned)_prev_best)) {
-			return i;
-		}
-		next = next->sibling();
-		i++;
+	if (_prev_best >= 0 && (unsigned)_prev_best < _num_validators && _time_last[_prev_best] > 0
+		&& _error_mask[_prev_best] != DataValidator::ERROR_FLAG_NO_ERROR) {
+		return _prev_best;
 	}
 	return -1;
 }
@@ -307,15 +386,8 @@ DataValidatorGroup::failover_index()
 uint32_t
 DataValidatorGroup::failover_state()
 {
-	DataValidator *next = _first;
-	unsigned i = 0;
-
-	while (next != nullptr) {
-		if (next->used() && (next->state() != DataValidator::ERROR_FLAG_NO_ERROR) && (i == (unsigned)_prev_best)) {
-			return next->state();
-		}
-		next = next->sibling();
-		i++;
+	if (_prev_best >= 0 && (unsigned)_prev_best < _num_validators && _time_last[_prev_best] > 0) {
+		return _error_mask[_prev_best];
 	}
 	return DataValidator::ERROR_FLAG_NO_ERROR;
 }
@@ -36,6 +36,10 @@
  *
  * A data validation group to identify anomalies in data streams
  *
+ * The validator state of all instances is kept in fixed-size arrays (struct of arrays),
+ * so that put() and get_best() work on contiguous data without walking a list.
+ * It implements the same checks as DataValidator.
+ *
  * @author Lorenz Meier <lorenz@px4.io>
  */
 
@@ -45,17 +49,20 @@
 
 class __EXPORT DataValidatorGroup {
 public:
+	static const unsigned dimensions = DataValidator::dimensions;
+	static const unsigned max_validators = 4;	/**< maximum number of instances in a group */
+
 	/**
-	 * @param siblings initial number of DataValidator's. Must be > 0.
+	 * @param siblings initial number of validators. Must be > 0 and <= max_validators.
 	 */
 	DataValidatorGroup(unsigned siblings);
-	virtual ~DataValidatorGroup();
+	virtual ~DataValidatorGroup() = default;
 
 	/**
-	 * Create a new Validator (with index equal to the number of currently existing validators)
-	 * @return the newly created DataValidator or nullptr on error
+	 * Add a new validator (with index equal to the number of currently existing validators)
+	 * @return false if the group is full
 	 */
-	DataValidator *add_new_validator();
+	bool			add_new_validator();
 
 	/**
 	 * Put an item into the validator group.
@@ -133,8 +140,40 @@ public:
 
 
 private:
-	DataValidator *_first;		/**< sibling in the group */
+	/**
+	 * Get the confidence of a validator. Only the timeout depends on the timestamp,
+	 * the other checks are evaluated on each put().
+	 * @return		the confidence between 0 and 1
+	 */
+	float			confidence(unsigned index, uint64_t timestamp);
+
+	/**
+	 * Evaluate the checks of a validator that only change with new data
+	 */
+	void			update_data_confidence(unsigned index);
+
+	void			print_validator(unsigned index, uint64_t timestamp);
+
+	unsigned _num_validators;	/**< number of validators in use */
 	uint32_t _timeout_interval_us; /**< currently set timeout */
+	float _value_equal_count_threshold; /**< when to consider an equal count as a problem */
+
+	/* validator state, indexed by the validator */
+	uint32_t _error_mask[max_validators];		/**< sensor error state */
+	uint64_t _time_last[max_validators];		/**< last timestamp */
+	uint64_t _event_count[max_validators];		/**< total data counter */
+	uint64_t _error_count[max_validators];		/**< error count */
+	int _error_density[max_validators];		/**< ratio between successful reads and errors */
+	int _priority[max_validators];			/**< sensor nominal priority */
+	float _data_confidence[max_validators];		/**< confidence from the checks other than the timeout */
+	float _value_equal_count[max_validators];	/**< equal values in a row */
+	float _mean[max_validators][dimensions];	/**< mean of value */
+	float _lp[max_validators][dimensions];		/**< low pass value */
+	float _M2[max_validators][dimensions];		/**< RMS component value */
+	float _rms[max_validators][dimensions];		/**< root mean square error */
+	float _value[max_validators][dimensions];	/**< last value */
+	float _vibe[max_validators][dimensions];	/**< vibration level, in sensor unit */
+
 	int _curr_best;		/**< currently best index */
 	int _prev_best;		/**< the previous best index */
 	uint64_t _first_failover_time;	/**< timestamp where the first failover occured or zero if none occured */
@@ -71,6 +71,15 @@ struct map_projection_reference_s {
 	double sin_lat;
 	double cos_lat;
 	bool init_done;
+
+	/* single precision copy of the reference for the local projection, with the
+	 * coordinates split into a float and the float remainder (degrees) */
+	float lat_deg_hi;
+	float lat_deg_lo;
+	float lon_deg_hi;
+	float lon_deg_lo;
+	float sin_lat_f;
+	float cos_lat_f;
 };
 
 struct globallocal_converter_reference_s {
@@ -196,6 +205,36 @@ __EXPORT int map_projection_global_reproject(float x, float y, double *lat, doub
 __EXPORT int map_projection_reproject(const struct map_projection_reference_s *ref, float x, float y, double *lat,
 				      double *lon);
 
+/**
+ * Transforms a point in the geographic coordinate system to the local
+ * azimuthal equidistant plane using the projection given by the argument,
+ * in single precision (see map_projection_project()).
+ * Only the split of the coordinates into two floats is done in double precision. The
+ * result is accurate to about 1e-7 of the distance to the reference for points within
+ * a few hundred km, which makes it much cheaper on targets without a double precision FPU.
+ * @param x north
+ * @param y east
+ * @param lat in degrees (47.1234567°, not 471234567°)
+ * @param lon in degrees (8.1234567°, not 81234567°)
+ * @return 0 if map_projection_init was called before, -1 else
+ */
+__EXPORT int map_projection_project_local(const struct map_projection_reference_s *ref, double lat, double lon, float *x,
+		float *y);
+
+/**
+ * Transforms a point in the local azimuthal equidistant plane to the
+ * geographic coordinate system using the projection given by the argument,
+ * in single precision (see map_projection_project_local()).
+ *
+ * @param x north
+ * @param y east
+ * @param lat in degrees (47.1234567°, not 471234567°)
+ * @param lon in degrees (8.1234567°, not 81234567°)
+ * @return 0 if map_projection_init was called before, -1 else
+ */
+__EXPORT int map_projection_reproject_local(const struct map_projection_reference_s *ref, float x, float y, double *lat,
+		double *lon);
+
 /**
  * Get reference position of the global map projection
  */
@@ -44,6 +44,7 @@
 *
 */
 
+#include <math.h>
 #include <stdint.h>
 #include "geo_mag_declination.h"
 
@@ -54,9 +55,15 @@
 #define SAMPLING_MIN_LON	-180.0f
 #define SAMPLING_MAX_LON	180.0f
 
-#define constrain(val, min, max) (val < min) ? min : ((val > max) ? max : val)
+#define SAMPLING_NUM_LAT	13
+#define SAMPLING_NUM_LON	37
 
-static const int8_t declination_table[13][37] = \
+/** distance between two lookups of get_mag_declination_cached(), ~1 km along a meridian */
+#define CACHE_DISTANCE_DEG	0.009f
+
+#define constrain(val, min, max) ((val) < (min) ? (min) : ((val) > (max) ? (max) : (val)))
+
+static const int8_t declination_table[SAMPLING_NUM_LAT][SAMPLING_NUM_LON] = \
 {
 	{ 47, 45, 44, 43, 41, 40, 38, 36, 33, 28, 23, 16, 10, 4, -1, -5, -9, -14, -19, -26, -33, -41, -48, -55, -61, -67, -71, -74, -75, -72, -61, -23, 23, 41, 46, 47, 47 },
 	{ 30, 30, 30, 30, 30, 29, 29, 29, 27, 23, 18, 11, 3, -3, -9, -12, -15, -17, -21, -26, -32, -39, -46, -51, -55, -57, -56, -52, -44, -31, -14, 1, 13, 21, 26, 29, 30 },
@@ -74,24 +81,16 @@ static const int8_t declination_table[13][37] = \
 };
 
 static float get_lookup_table_val(unsigned lat, unsigned lon);
-static unsigned get_lookup_table_index(float *val, float min, float max);
+static unsigned get_lookup_table_index(float val, float min, unsigned num);
 
-unsigned get_lookup_table_index(float *val, float min, float max)
+unsigned get_lookup_table_index(float val, float min, unsigned num)
 {
-	/* for the rare case of hitting the bounds exactly
-	 * the rounding logic wouldn't fit, so enforce it.
-	 */
-	/* limit to table bounds - required for maxima even when table spans full globe range */
-	if (*val < min) {
-		*val = min;
-	}
-
-	/* limit to (table bounds - 1) because bilinear interpolation requires checking (index + 1) */
-	if (*val > max) {
-		*val = max - SAMPLING_RES;
-	}
+	/* index of the sampling point below the value (rounding towards -inf, also for negative values),
+	 * limited to (table size - 2) because bilinear interpolation requires checking (index + 1) */
+	const float index_f = floorf((val - min) / SAMPLING_RES);
+	int index = (int)index_f;
 
-	return (-(min) + *val)  / SAMPLING_RES;
+	return constrain(index, 0, (int)num - 2);
 }
 
 __EXPORT float get_mag_declination(float lat, float lon)
@@ -106,13 +105,12 @@ __EXPORT float get_mag_declination(float lat, float lon)
 		return 0.0f;
 	}
 
-	/* round down to nearest sampling resolution */
-	float min_lat = (int)(lat / SAMPLING_RES) * SAMPLING_RES;
-	float min_lon = (int)(lon / SAMPLING_RES) * SAMPLING_RES;
+	/* beyond the table the outermost row is used */
+	lat = constrain(lat, SAMPLING_MIN_LAT, SAMPLING_MAX_LAT);
 
 	/* find index of nearest low sampling point */
-	unsigned min_lat_index = get_lookup_table_index(&min_lat, SAMPLING_MIN_LAT, SAMPLING_MAX_LAT);
-	unsigned min_lon_index = get_lookup_table_index(&min_lon, SAMPLING_MIN_LON, SAMPLING_MAX_LON);
+	unsigned min_lat_index = get_lookup_table_index(lat, SAMPLING_MIN_LAT, SAMPLING_NUM_LAT);
+	unsigned min_lon_index = get_lookup_table_index(lon, SAMPLING_MIN_LON, SAMPLING_NUM_LON);
 
 	float declination_sw = get_lookup_table_val(min_lat_index, min_lon_index);
 	float declination_se = get_lookup_table_val(min_lat_index, min_lon_index + 1);
@@ -120,6 +118,9 @@ __EXPORT float get_mag_declination(float lat, float lon)
 	float declination_nw = get_lookup_table_val(min_lat_index + 1, min_lon_index);
 
 	/* perform bilinear interpolation on the four grid corners */
+	float min_lat = SAMPLING_MIN_LAT + min_lat_index * SAMPLING_RES;
+	float min_lon = SAMPLING_MIN_LON + min_lon_index * SAMPLING_RES;
+
 	float lat_scale = constrain((lat - min_lat) / SAMPLING_RES, 0.0f, 1.0f);
 	float lon_scale = constrain((lon - min_lon) / SAMPLING_RES, 0.0f, 1.0f);
 
@@ -129,6 +130,21 @@ __EXPORT float get_mag_declination(float lat, float lon)
 	return lat_scale * (declination_max - declination_min) + declination_min;
 }
 
+__EXPORT float get_mag_declination_cached(struct mag_declination_cache_s *cache, float lat, float lon)
+{
+	if (!cache->valid ||
+	    fabsf(lat - cache->lat) > CACHE_DISTANCE_DEG ||
+	    fabsf(lon - cache->lon) > CACHE_DISTANCE_DEG) {
+
+		cache->declination = get_mag_declination(lat, lon);
+		cache->lat = lat;
+		cache->lon = lon;
+		cache->valid = true;
+	}
+
+	return cache->declination;
+}
+
 float get_lookup_table_val(unsigned lat_index, unsigned lon_index)
 {
 	return declination_table[lat_index][lon_index];
@@ -40,8 +40,32 @@
 
 #pragma once
 
+#include <stdbool.h>
+
 __BEGIN_DECLS
 
+/**
+ * Magnetic declination, interpolated bilinearly from the lookup table.
+ * @param lat latitude [deg]
+ * @param lon longitude [deg]
+ * @return declination [deg], 0 for invalid coordinates
+ */
 __EXPORT float get_mag_declination(float lat, float lon);
 
+/**
+ * Last lookup of get_mag_declination_cached(), zero-initialize before the first use.
+ */
+struct mag_declination_cache_s {
+	float lat;
+	float lon;
+	float declination;
+	bool valid;
+};
+
+/**
+ * Declination at the position, only looked up again after the position changed by about 1 km
+ * (@see get_mag_declination()).
+ */
+__EXPORT float get_mag_declination_cached(struct mag_declination_cache_s *cache, float lat, float lon);
+
 __END_DECLS
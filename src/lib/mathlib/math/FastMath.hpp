@@ -0,0 +1,154 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2017 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file FastMath.hpp
+ *
+ * Polynomial approximations of the trigonometric functions, for call sites
+ * that run every control or estimator cycle and can accept a small, bounded
+ * error. They avoid the argument checks and the double precision paths of the
+ * newlib routines. Use them explicitly where the accuracy is sufficient,
+ * the standard functions remain the default.
+ *
+ * Maximum absolute errors, checked by 'tests mathlib':
+ * - fast_atan2f(), fast_atanf(): 1.2e-5 rad (Abramowitz & Stegun 4.4.49)
+ * - fast_asinf(), fast_acosf(): 2e-5 rad
+ * - fast_sinf(), fast_cosf(): 1e-6 in [-2 pi, 2 pi] (A&S 4.3.97), the
+ *   range reduction adds about 1 ulp of the argument beyond that
+ * - fast_sqrtf(): exact (hardware square root where available)
+ */
+
+#pragma once
+
+#include <float.h>
+#include <math.h>
+#include <platforms/px4_defines.h>
+
+namespace math
+{
+
+/**
+ * Square root, without the errno handling of sqrtf(): the result for x < 0 is NaN.
+ */
+inline float fast_sqrtf(float x)
+{
+#if defined(__ARM_FP) && (__ARM_FP & 4)
+	float result;
+	__asm__("vsqrt.f32 %0, %1" : "=t"(result) : "t"(x));
+	return result;
+#else
+	return sqrtf(x);
+#endif
+}
+
+/**
+ * atan(x) for |x| <= 1
+ */
+inline float fast_atanf_unit(float x)
+{
+	const float x2 = x * x;
+	return x * (0.9998660f + x2 * (-0.3302995f + x2 * (0.1801410f + x2 * (-0.0851330f + x2 * 0.0208351f))));
+}
+
+/**
+ * atan2(y, x). Unlike atan2f(), the sign of a zero y is ignored.
+ */
+inline float fast_atan2f(float y, float x)
+{
+	const float ax = fabsf(x);
+	const float ay = fabsf(y);
+
+	if (ax < FLT_MIN && ay < FLT_MIN) {
+		return 0.0f;
+	}
+
+	float result;
+
+	if (ay > ax) {
+		result = M_PI_2_F - fast_atanf_unit(ax / ay);
+
+	} else {
+		result = fast_atanf_unit(ay / ax);
+	}
+
+	if (x < 0.0f) {
+		result = M_PI_F - result;
+	}
+
+	return (y < 0.0f) ? -result : result;
+}
+
+inline float fast_atanf(float x)
+{
+	return fast_atan2f(x, 1.0f);
+}
+
+/**
+ * asin(x) for |x| <= 1, the argument is constrained
+ */
+inline float fast_asinf(float x)
+{
+	x = (x > 1.0f) ? 1.0f : ((x < -1.0f) ? -1.0f : x);
+	return fast_atan2f(x, fast_sqrtf((1.0f - x) * (1.0f + x)));
+}
+
+inline float fast_acosf(float x)
+{
+	return M_PI_2_F - fast_asinf(x);
+}
+
+inline float fast_sinf(float x)
+{
+	/* reduce to [-pi, pi], then fold into [-pi/2, pi/2] */
+	if (x > M_PI_F || x < -M_PI_F) {
+		x -= M_TWOPI_F * roundf(x * (1.0f / M_TWOPI_F));
+	}
+
+	if (x > M_PI_2_F) {
+		x = M_PI_F - x;
+
+	} else if (x < -M_PI_2_F) {
+		x = -M_PI_F - x;
+	}
+
+	const float x2 = x * x;
+	return x * (1.0f + x2 * (-0.1666666664f + x2 * (0.0083333315f + x2 * (-0.0001984090f + x2 * (0.0000027526f + x2 *
+			-0.0000000239f)))));
+}
+
+inline float fast_cosf(float x)
+{
+	return fast_sinf(x + M_PI_2_F);
+}
+
+}
@@ -0,0 +1,97 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2017 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file LowPassFilter2pVector3f.cpp
+ */
+
+#include <px4_defines.h>
+#include "LowPassFilter2pVector3f.hpp"
+#include <cmath>
+
+namespace math
+{
+
+void LowPassFilter2pVector3f::set_cutoff_frequency(float sample_freq, float cutoff_freq)
+{
+	_cutoff_freq = cutoff_freq;
+
+	if (_cutoff_freq <= 0.0f) {
+		// no filtering
+		return;
+	}
+
+	const float fr = sample_freq / _cutoff_freq;
+	const float ohm = tanf(M_PI_F / fr);
+	const float c = 1.0f + 2.0f * cosf(M_PI_F / 4.0f) * ohm + ohm * ohm;
+	_b0 = ohm * ohm / c;
+	_b1 = 2.0f * _b0;
+	_b2 = _b0;
+	_a1 = 2.0f * (ohm * ohm - 1.0f) / c;
+	_a2 = (1.0f - 2.0f * cosf(M_PI_F / 4.0f) * ohm + ohm * ohm) / c;
+}
+
+matrix::Vector3f LowPassFilter2pVector3f::apply(const matrix::Vector3f &sample)
+{
+	if (_cutoff_freq <= 0.0f) {
+		// no filtering
+		return sample;
+	}
+
+	// do the filtering
+	matrix::Vector3f delay_element_0 = sample - _delay_element_1 * _a1 - _delay_element_2 * _a2;
+
+	for (int i = 0; i < 3; i++) {
+		if (!PX4_ISFINITE(delay_element_0(i))) {
+			// don't allow bad values to propagate via the filter
+			delay_element_0(i) = sample(i);
+		}
+	}
+
+	const matrix::Vector3f output = delay_element_0 * _b0 + _delay_element_1 * _b1 + _delay_element_2 * _b2;
+
+	_delay_element_2 = _delay_element_1;
+	_delay_element_1 = delay_element_0;
+
+	return output;
+}
+
+matrix::Vector3f LowPassFilter2pVector3f::reset(const matrix::Vector3f &sample)
+{
+	const matrix::Vector3f dval = sample / (_b0 + _b1 + _b2);
+	_delay_element_1 = dval;
+	_delay_element_2 = dval;
+	return apply(sample);
+}
+
+} // namespace math
@@ -0,0 +1,91 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2017 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file LowPassFilter2pVector3f.hpp
+ * Second order low pass filter for three axes, same design as LowPassFilter2p
+ * but with a single set of coefficients for all axes.
+ */
+
+#pragma once
+
+#include <matrix/math.hpp>
+
+namespace math
+{
+class __EXPORT LowPassFilter2pVector3f
+{
+public:
+	LowPassFilter2pVector3f(float sample_freq, float cutoff_freq)
+	{
+		// set initial parameters
+		set_cutoff_frequency(sample_freq, cutoff_freq);
+	}
+
+	/**
+	 * Change filter parameters
+	 */
+	void set_cutoff_frequency(float sample_freq, float cutoff_freq);
+
+	/**
+	 * Add a new raw value to the filter
+	 *
+	 * @return retrieve the filtered result
+	 */
+	matrix::Vector3f apply(const matrix::Vector3f &sample);
+
+	/**
+	 * Return the cutoff frequency
+	 */
+	float get_cutoff_freq() const
+	{
+		return _cutoff_freq;
+	}
+
+	/**
+	 * Reset the filter state to this value
+	 */
+	matrix::Vector3f reset(const matrix::Vector3f &sample);
+
+private:
+	float _cutoff_freq{0.0f};
+	float _a1{0.0f};
+	float _a2{0.0f};
+	float _b0{0.0f};
+	float _b1{0.0f};
+	float _b2{0.0f};
+	matrix::Vector3f _delay_element_1;	// buffered sample -1
+	matrix::Vector3f _delay_element_2;	// buffered sample -2
+};
+
+} // namespace math
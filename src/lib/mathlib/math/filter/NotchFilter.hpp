@@ -0,0 +1,164 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2017 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file NotchFilter.hpp
+ * Second order notch filter (biquad), for float or matrix::Vector3f samples.
+ *
+ * The filter is implemented in direct form I, so that the notch frequency can be
+ * changed at runtime (e.g. to follow a measured vibration peak) without a reset:
+ * the state only consists of past inputs and outputs, which stay valid.
+ */
+
+#pragma once
+
+#include <px4_defines.h>
+#include <matrix/math.hpp>
+#include <cmath>
+
+namespace math
+{
+template<typename T>
+class NotchFilter
+{
+public:
+	NotchFilter() = default;
+
+	NotchFilter(float sample_freq, float notch_freq, float bandwidth)
+	{
+		set_parameters(sample_freq, notch_freq, bandwidth);
+	}
+
+	/**
+	 * Change filter parameters. The filter state is kept.
+	 * The filter is disabled (passes the input through) if the notch frequency is not
+	 * within (0, sample_freq / 2) or the bandwidth is not positive.
+	 * @param sample_freq [Hz]
+	 * @param notch_freq center frequency [Hz]
+	 * @param bandwidth -3dB bandwidth [Hz]
+	 */
+	void set_parameters(float sample_freq, float notch_freq, float bandwidth)
+	{
+		_notch_freq = notch_freq;
+		_bandwidth = bandwidth;
+		_sample_freq = sample_freq;
+
+		if (!enabled()) {
+			return;
+		}
+
+		const float alpha = tanf(M_PI_F * bandwidth / sample_freq);
+		const float beta = -cosf(2.0f * M_PI_F * notch_freq / sample_freq);
+		const float a0_inv = 1.0f / (alpha + 1.0f);
+
+		_b0 = a0_inv;
+		_b1 = 2.0f * beta * a0_inv;
+		_b2 = a0_inv;
+		_a1 = _b1;
+		_a2 = (1.0f - alpha) * a0_inv;
+	}
+
+	/**
+	 * Add a new raw value to the filter
+	 *
+	 * @return retrieve the filtered result
+	 */
+	T apply(const T &sample)
+	{
+		if (!enabled()) {
+			// keep the state consistent, so that the filter can be enabled without a transient
+			reset(sample);
+			return sample;
+		}
+
+		T output = sample * _b0 + _delay_in_1 * _b1 + _delay_in_2 * _b2 - _delay_out_1 * _a1 - _delay_out_2 * _a2;
+
+		if (!is_finite(output)) {
+			// don't allow bad values to propagate via the filter
+			reset(sample);
+			return sample;
+		}
+
+		_delay_in_2 = _delay_in_1;
+		_delay_in_1 = sample;
+		_delay_out_2 = _delay_out_1;
+		_delay_out_1 = output;
+
+		return output;
+	}
+
+	/**
+	 * Reset the filter state to this value (the notch has unity DC gain)
+	 */
+	void reset(const T &sample)
+	{
+		_delay_in_1 = sample;
+		_delay_in_2 = sample;
+		_delay_out_1 = sample;
+		_delay_out_2 = sample;
+	}
+
+	bool enabled() const
+	{
+		return _notch_freq > 0.0f && _bandwidth > 0.0f && _notch_freq < 0.5f * _sample_freq;
+	}
+
+	float get_notch_freq() const { return _notch_freq; }
+	float get_bandwidth() const { return _bandwidth; }
+	float get_sample_freq() const { return _sample_freq; }
+
+private:
+	static bool is_finite(float value) { return PX4_ISFINITE(value); }
+
+	static bool is_finite(const matrix::Vector3f &value)
+	{
+		return PX4_ISFINITE(value(0)) && PX4_ISFINITE(value(1)) && PX4_ISFINITE(value(2));
+	}
+
+	float _notch_freq{0.0f};
+	float _bandwidth{0.0f};
+	float _sample_freq{0.0f};
+
+	float _a1{0.0f};
+	float _a2{0.0f};
+	float _b0{1.0f};
+	float _b1{0.0f};
+	float _b2{0.0f};
+
+	T _delay_in_1{};	// input sample -1
+	T _delay_in_2{};	// input sample -2
+	T _delay_out_1{};	// output sample -1
+	T _delay_out_2{};	// output sample -2
+};
+
+} // namespace math
@@ -93,18 +93,8 @@ public:
     template<size_t P>
     Matrix<Type, M, P> operator*(const Matrix<Type, N, P> &other) const
     {
-        const Matrix<Type, M, N> &self = *this;
         Matrix<Type, M, P> res;
-        res.setZero();
-
-        for (size_t i = 0; i < M; i++) {
-            for (size_t k = 0; k < P; k++) {
-                for (size_t j = 0; j < N; j++) {
-                    res(i, k) += self(i, j) * other(j, k);
-                }
-            }
-        }
-
+        mult(*this, other, res);
         return res;
     }
 
@@ -182,13 +172,23 @@ public:
     void operator+=(const Matrix<Type, M, N> &other)
     {
         Matrix<Type, M, N> &self = *this;
-        self = self + other;
+
+        for (size_t i = 0; i < M; i++) {
+            for (size_t j = 0; j < N; j++) {
+                self(i, j) += other(i, j);
+            }
+        }
     }
 
     void operator-=(const Matrix<Type, M, N> &other)
     {
         Matrix<Type, M, N> &self = *this;
-        self = self - other;
+
+        for (size_t i = 0; i < M; i++) {
+            for (size_t j = 0; j < N; j++) {
+                self(i, j) -= other(i, j);
+            }
+        }
     }
 
     template<size_t P>
@@ -254,17 +254,23 @@ public:
     void operator/=(Type scalar)
     {
         Matrix<Type, M, N> &self = *this;
-        self = self * (1.0f / scalar);
+        self *= (1.0f / scalar);
     }
 
-    inline void operator+=(Type scalar)
+    void operator+=(Type scalar)
     {
-        *this = (*this) + scalar;
+        Matrix<Type, M, N> &self = *this;
+
+        for (size_t i = 0; i < M; i++) {
+            for (size_t j = 0; j < N; j++) {
+                self(i, j) += scalar;
+            }
+        }
     }
 
     inline void operator-=(Type scalar)
     {
-        *this = (*this) - scalar;
+        *this += -scalar;
     }
 
 
@@ -459,6 +465,59 @@ public:
 
 };
 
+/**
+ * Fused operations, evaluated into the destination in one pass instead of
+ * building a temporary per operator. The destination must not alias one of
+ * the matrix operands.
+ */
+
+/**
+ * res = A * B
+ */
+template<typename Type, size_t M, size_t N, size_t P>
+void mult(const Matrix<Type, M, N> &A, const Matrix<Type, N, P> &B, Matrix<Type, M, P> &res)
+{
+    for (size_t i = 0; i < M; i++) {
+        for (size_t k = 0; k < P; k++) {
+            Type sum = 0;
+            for (size_t j = 0; j < N; j++) {
+                sum += A(i, j) * B(j, k);
+            }
+            res(i, k) = sum;
+        }
+    }
+}
+
+/**
+ * res += alpha * A * B
+ */
+template<typename Type, size_t M, size_t N, size_t P>
+void multAdd(const Matrix<Type, M, N> &A, const Matrix<Type, N, P> &B, Matrix<Type, M, P> &res, Type alpha = Type(1))
+{
+    for (size_t i = 0; i < M; i++) {
+        for (size_t k = 0; k < P; k++) {
+            Type sum = 0;
+            for (size_t j = 0; j < N; j++) {
+                sum += A(i, j) * B(j, k);
+            }
+            res(i, k) += alpha * sum;
+        }
+    }
+}
+
+/**
+ * res += alpha * A
+ */
+template<typename Type, size_t M, size_t N>
+void addScaled(Matrix<Type, M, N> &res, const Matrix<Type, M, N> &A, Type alpha)
+{
+    for (size_t i = 0; i < M; i++) {
+        for (size_t j = 0; j < N; j++) {
+            res(i, j) += alpha * A(i, j);
+        }
+    }
+}
+
 template<typename Type, size_t M, size_t N>
 Matrix<Type, M, N> zeros() {
     Matrix<Type, M, N> m;
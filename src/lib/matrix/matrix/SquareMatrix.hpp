@@ -245,6 +245,96 @@ bool inv(const SquareMatrix<Type, M> & A, SquareMatrix<Type, M> & inv)
     return true;
 }
 
+/**
+ * closed form inverse of a 1x1 matrix
+ */
+template<typename Type>
+bool inv(const SquareMatrix<Type, 1> & A, SquareMatrix<Type, 1> & inv)
+{
+    if (!(fabs(static_cast<float>(A(0, 0))) > 0.0f)) {
+        return false;
+    }
+
+    Type res = Type(1) / A(0, 0);
+
+    if (!is_finite(res)) {
+        return false;
+    }
+
+    inv(0, 0) = res;
+    return true;
+}
+
+/**
+ * closed form inverse of a 2x2 matrix
+ */
+template<typename Type>
+bool inv(const SquareMatrix<Type, 2> & A, SquareMatrix<Type, 2> & inv)
+{
+    Type det = A(0, 0) * A(1, 1) - A(0, 1) * A(1, 0);
+
+    if (!(fabs(static_cast<float>(det)) > 0.0f)) {
+        return false;
+    }
+
+    SquareMatrix<Type, 2> res;
+    res(0, 0) = A(1, 1) / det;
+    res(0, 1) = -A(0, 1) / det;
+    res(1, 0) = -A(1, 0) / det;
+    res(1, 1) = A(0, 0) / det;
+
+    for (size_t i = 0; i < 2; i++) {
+        for (size_t j = 0; j < 2; j++) {
+            if (!is_finite(res(i, j))) {
+                return false;
+            }
+        }
+    }
+
+    inv = res;
+    return true;
+}
+
+/**
+ * closed form inverse of a 3x3 matrix (adjugate divided by the determinant)
+ */
+template<typename Type>
+bool inv(const SquareMatrix<Type, 3> & A, SquareMatrix<Type, 3> & inv)
+{
+    // cofactors of the first row
+    Type c00 = A(1, 1) * A(2, 2) - A(1, 2) * A(2, 1);
+    Type c01 = A(1, 2) * A(2, 0) - A(1, 0) * A(2, 2);
+    Type c02 = A(1, 0) * A(2, 1) - A(1, 1) * A(2, 0);
+    Type det = A(0, 0) * c00 + A(0, 1) * c01 + A(0, 2) * c02;
+
+    if (!(fabs(static_cast<float>(det)) > 0.0f)) {
+        return false;
+    }
+
+    SquareMatrix<Type, 3> res;
+    res(0, 0) = c00;
+    res(1, 0) = c01;
+    res(2, 0) = c02;
+    res(0, 1) = A(0, 2) * A(2, 1) - A(0, 1) * A(2, 2);
+    res(1, 1) = A(0, 0) * A(2, 2) - A(0, 2) * A(2, 0);
+    res(2, 1) = A(0, 1) * A(2, 0) - A(0, 0) * A(2, 1);
+    res(0, 2) = A(0, 1) * A(1, 2) - A(0, 2) * A(1, 1);
+    res(1, 2) = A(0, 2) * A(1, 0) - A(0, 0) * A(1, 2);
+    res(2, 2) = A(0, 0) * A(1, 1) - A(0, 1) * A(1, 0);
+    res /= det;
+
+    for (size_t i = 0; i < 3; i++) {
+        for (size_t j = 0; j < 3; j++) {
+            if (!is_finite(res(i, j))) {
+                return false;
+            }
+        }
+    }
+
+    inv = res;
+    return true;
+}
+
 /**
  * inverse based on LU factorization with partial pivotting
  */
@@ -301,14 +391,137 @@ SquareMatrix <Type, M> cholesky(const SquareMatrix<Type, M> & A)
 /**
  * cholesky inverse
  *
- * TODO: Check if gaussian elimination jumps straight to back-substitution
- * for L or we need to do it manually. Will impact speed otherwise.
+ * Inverts the lower triangular factor by forward substitution and
+ * returns inv(L)^T * inv(L). Only the lower triangle of A is used.
+ *
+ * Note: A must be symmetric positive definite, false is returned otherwise
+ */
+template<typename Type, size_t M>
+bool choleskyInv(const SquareMatrix<Type, M> & A, SquareMatrix<Type, M> & inv)
+{
+    SquareMatrix<Type, M> L;
+
+    for (size_t j = 0; j < M; j++) {
+        Type res = A(j, j);
+        for (size_t k = 0; k < j; k++) {
+            res -= L(j, k)*L(j, k);
+        }
+        if (!(res > 0) || !is_finite(res)) {
+            return false;
+        }
+        L(j, j) = Type(sqrt(res));
+        for (size_t i = j + 1; i < M; i++) {
+            Type sum = A(i, j);
+            for (size_t k = 0; k < j; k++) {
+                sum -= L(i, k)*L(j, k);
+            }
+            L(i, j) = sum/L(j, j);
+        }
+    }
+
+    // inverse of L, also lower triangular
+    SquareMatrix<Type, M> L_inv;
+    for (size_t j = 0; j < M; j++) {
+        L_inv(j, j) = Type(1)/L(j, j);
+        for (size_t i = j + 1; i < M; i++) {
+            Type sum = 0;
+            for (size_t k = j; k < i; k++) {
+                sum -= L(i, k)*L_inv(k, j);
+            }
+            L_inv(i, j) = sum/L(i, i);
+        }
+    }
+
+    // inv(A) = L_inv^T * L_inv, symmetric
+    SquareMatrix<Type, M> res;
+    for (size_t i = 0; i < M; i++) {
+        for (size_t j = i; j < M; j++) {
+            Type sum = 0;
+            for (size_t k = j; k < M; k++) {
+                sum += L_inv(k, i)*L_inv(k, j);
+            }
+            if (!is_finite(sum)) {
+                return false;
+            }
+            res(i, j) = sum;
+            res(j, i) = sum;
+        }
+    }
+
+    inv = res;
+    return true;
+}
+
+/**
+ * cholesky inverse, zero matrix if A is not positive definite
  */
 template<typename Type, size_t M>
 SquareMatrix <Type, M> choleskyInv(const SquareMatrix<Type, M> & A)
 {
-    SquareMatrix<Type, M> L_inv = inv(cholesky(A));
-    return L_inv.T()*L_inv;
+    SquareMatrix<Type, M> i;
+    if (!choleskyInv(A, i)) {
+        i.setZero();
+    }
+    return i;
+}
+
+/**
+ * fused symmetric product res += A * P * A^T, e.g. for A * P * A^T + Q
+ *
+ * P and res must be symmetric. Only the upper triangle is accumulated,
+ * the lower one is mirrored, so res stays exactly symmetric.
+ */
+template<typename Type, size_t N, size_t M>
+void symmetricProductAdd(const Matrix<Type, N, M> & A, const Matrix<Type, M, M> & P, Matrix<Type, N, N> & res)
+{
+    Matrix<Type, N, M> AP;
+    mult(A, P, AP);
+    for (size_t i = 0; i < N; i++) {
+        for (size_t j = i; j < N; j++) {
+            Type sum = 0;
+            for (size_t k = 0; k < M; k++) {
+                sum += AP(i, k)*A(j, k);
+            }
+            res(i, j) += sum;
+            res(j, i) = res(i, j);
+        }
+    }
+}
+
+/**
+ * symmetric product A * P * A^T
+ *
+ * P must be symmetric. Only the upper triangle of the result is
+ * computed, the lower one is mirrored, so the result is exactly symmetric.
+ */
+template<typename Type, size_t N, size_t M>
+SquareMatrix<Type, N> symmetricProduct(const Matrix<Type, N, M> & A, const Matrix<Type, M, M> & P)
+{
+    SquareMatrix<Type, N> res;
+    symmetricProductAdd(A, P, res);
+    return res;
+}
+
+/**
+ * symmetric rank-k update P += alpha * A * A^T
+ *
+ * P must be symmetric, only its upper triangle is computed and mirrored.
+ */
+template<typename Type, size_t M, size_t K>
+void symmetricRankUpdate(Matrix<Type, M, M> & P, const Matrix<Type, M, K> & A, Type alpha = Type(1))
+{
+    for (size_t i = 0; i < M; i++) {
+        for (size_t j = i; j < M; j++) {
+            Type sum = 0;
+            for (size_t k = 0; k < K; k++) {
+                sum += A(i, k)*A(j, k);
+            }
+            P(i, j) += alpha*sum;
+            if (i != j) {
+                P(j, i) = P(i, j);
+            }
+        }
+    }
 }
 
 typedef SquareMatrix<float, 3> Matrix3f;
@@ -15,9 +15,11 @@ int kalman_correct(
     Type & beta
 )
 {
-    SquareMatrix<Type, N> S_I = SquareMatrix<Type, N>(C*P*C.T() + R).I();
+    SquareMatrix<Type, N> S = R;
+    symmetricProductAdd(C, P, S);
+    SquareMatrix<Type, N> S_I = S.I();
     Matrix<Type, M, N> K = P*C.T()*S_I;
-    dx = K*r;
+    mult(K, r, dx);
     beta = Scalar<Type>(r.T()*S_I*r);
     dP = K*C*P*(-1);
     return 0;
@@ -0,0 +1,163 @@
+#include "test_macros.hpp"
+#include <matrix/math.hpp>
+
+#include <chrono>
+
+using namespace matrix;
+
+static const size_t n_iter = 20000;
+
+static const size_t n_x = 10;
+static const size_t n_y = 6;
+
+typedef std::chrono::steady_clock benchmark_clock;
+
+static double elapsed_ns(benchmark_clock::time_point start)
+{
+    std::chrono::duration<double, std::nano> dt = benchmark_clock::now() - start;
+    return dt.count() / double(n_iter);
+}
+
+template<size_t M>
+static SquareMatrix<float, M> covariance(float scale)
+{
+    SquareMatrix<float, M> P;
+
+    for (size_t i = 0; i < M; i++) {
+        for (size_t j = 0; j < M; j++) {
+            P(i, j) = scale / float(1 + i + j);
+        }
+
+        P(i, i) += scale;
+    }
+
+    return P;
+}
+
+/**
+ * Compares the fixed size kernels against the generic code on the
+ * operations of a Kalman filter update (see local_position_estimator).
+ * Only the results are checked, the timings are printed for reference.
+ */
+int main()
+{
+    // 3x3 inverse
+    SquareMatrix<float, 3> S3 = covariance<3>(2.0f);
+    SquareMatrix<float, 3> S3_I_lu;
+    SquareMatrix<float, 3> S3_I;
+    float sum_lu = 0;
+    float sum_fixed = 0;
+
+    benchmark_clock::time_point start = benchmark_clock::now();
+
+    for (size_t i = 0; i < n_iter; i++) {
+        S3(0, 0) += 1e-6f;
+        TEST((inv<float, 3>(S3, S3_I_lu)));
+        sum_lu += S3_I_lu(0, 0);
+    }
+
+    double t_lu = elapsed_ns(start);
+
+    S3 = covariance<3>(2.0f);
+    start = benchmark_clock::now();
+
+    for (size_t i = 0; i < n_iter; i++) {
+        S3(0, 0) += 1e-6f;
+        TEST(inv(S3, S3_I));
+        sum_fixed += S3_I(0, 0);
+    }
+
+    double t_fixed = elapsed_ns(start);
+    TEST(isEqual(S3_I, S3_I_lu));
+    TEST(fabs(sum_lu - sum_fixed) < 1e-3f * fabs(sum_lu));
+    printf("inv 3x3:       LU %8.1f ns, closed form %8.1f ns\n", t_lu, t_fixed);
+
+    // 6x6 inverse
+    SquareMatrix<float, n_y> S6 = covariance<n_y>(2.0f);
+    SquareMatrix<float, n_y> S6_I_lu;
+    SquareMatrix<float, n_y> S6_I;
+
+    start = benchmark_clock::now();
+
+    for (size_t i = 0; i < n_iter; i++) {
+        TEST((inv<float, n_y>(S6, S6_I_lu)));
+    }
+
+    t_lu = elapsed_ns(start);
+    start = benchmark_clock::now();
+
+    for (size_t i = 0; i < n_iter; i++) {
+        TEST(choleskyInv(S6, S6_I));
+    }
+
+    t_fixed = elapsed_ns(start);
+    TEST((S6_I - S6_I_lu).abs().max() < 1e-5f);
+    printf("inv 6x6:       LU %8.1f ns, cholesky    %8.1f ns\n", t_lu, t_fixed);
+
+    // covariance update P -= K * C * P with K = P * C^T * inv(S)
+    SquareMatrix<float, n_x> P = covariance<n_x>(1.0f);
+    Matrix<float, n_y, n_x> C;
+
+    for (size_t i = 0; i < n_y; i++) {
+        C(i, i) = 1;
+    }
+
+    SquareMatrix<float, n_x> P_generic;
+    SquareMatrix<float, n_x> P_fixed;
+
+    start = benchmark_clock::now();
+
+    for (size_t i = 0; i < n_iter; i++) {
+        Matrix<float, n_y, n_y> S = C * P * C.transpose() + S6;
+        Matrix<float, n_x, n_y> K = P * C.transpose() * inv<float, n_y>(S);
+        P_generic = P - K * C * P;
+    }
+
+    t_lu = elapsed_ns(start);
+    start = benchmark_clock::now();
+
+    for (size_t i = 0; i < n_iter; i++) {
+        SquareMatrix<float, n_y> S = symmetricProduct(C, P) + S6;
+        Matrix<float, n_x, n_y> PCt = P * C.transpose();
+        P_fixed = P - symmetricProduct(PCt, choleskyInv(S));
+    }
+
+    t_fixed = elapsed_ns(start);
+    TEST((P_fixed - P_generic).abs().max() < 1e-5f);
+    TEST((P_fixed - P_fixed.T()).abs().max() <= 0.0f);
+    printf("update 10x6:   generic %8.1f ns, symmetric %8.1f ns\n", t_lu, t_fixed);
+
+    // covariance prediction A * P * A^T + Q
+    SquareMatrix<float, n_x> A = covariance<n_x>(0.1f) + eye<float, n_x>();
+    SquareMatrix<float, n_x> Q = eye<float, n_x>() * 0.01f;
+    float sum_generic = 0;
+    float sum_fused = 0;
+
+    start = benchmark_clock::now();
+
+    for (size_t i = 0; i < n_iter; i++) {
+        A(0, 1) += 1e-6f;
+        P_generic = A * P * A.T() + Q;
+        sum_generic += P_generic(0, 1);
+    }
+
+    t_lu = elapsed_ns(start);
+    A(0, 1) = 0.1f / 2.0f;
+    start = benchmark_clock::now();
+
+    for (size_t i = 0; i < n_iter; i++) {
+        A(0, 1) += 1e-6f;
+        P_fixed = Q;
+        symmetricProductAdd(A, P, P_fixed);
+        sum_fused += P_fixed(0, 1);
+    }
+
+    t_fixed = elapsed_ns(start);
+    TEST((P_fixed - P_generic).abs().max() < 1e-5f);
+    TEST(fabs(sum_generic - sum_fused) < 1e-4f * fabs(sum_generic));
+    printf("predict 10x10: generic %8.1f ns, fused     %8.1f ns\n", t_lu, t_fixed);
+
+    return 0;
+}
+
+/* vim: set et fenc=utf-8 ff=unix sts=0 sw=4 ts=4 : */
@@ -121,6 +121,56 @@ int main()
     I3.setIdentity();
     TEST(isEqual(choleskyInv(A4)*A4, I3));
     TEST(isEqual(cholesky(Z3), Z3));
+    TEST(isEqual(choleskyInv(Z3), Z3));
+    TEST(!choleskyInv(Z3, A3_I));
+
+    // closed form 1x1 and 2x2 inverse
+    SquareMatrix<float, 1> A1;
+    A1(0, 0) = 4;
+    SquareMatrix<float, 1> A1_I = inv(A1);
+    TEST(fabs(A1_I(0, 0) - 0.25f) < 1e-7f);
+    A1(0, 0) = 0;
+    TEST(!A1.I(A1_I));
+
+    float data5[4] = {4, 7, 2, 6};
+    float data5_check[4] = {0.6f, -0.7f, -0.2f, 0.4f};
+    SquareMatrix<float, 2> A5(data5);
+    SquareMatrix<float, 2> A5_I_check(data5_check);
+    TEST(isEqual(inv(A5), A5_I_check));
+    A5(1, 0) = 8;
+    A5(1, 1) = 14;
+    SquareMatrix<float, 2> A5_I;
+    TEST(!A5.I(A5_I));
+    TEST(isEqual(A5.I(), zeros<float, 2, 2>()));
+
+    // closed form 3x3 inverse agrees with LU
+    SquareMatrix<float, 3> A6_I_lu;
+    SquareMatrix<float, 3> A6_I = inv(A4);
+    TEST((inv<float, 3>(A4, A6_I_lu)));
+    TEST(isEqual(A6_I, A6_I_lu));
+    TEST(isEqual(A6_I * A4, I3));
+
+    // 6x6 cholesky inverse of a covariance like matrix
+    float data7[36] = {
+        4.0f,  0.5f,  0.1f,  0.2f,  0.0f,  0.1f,
+        0.5f,  3.0f,  0.3f,  0.0f,  0.1f,  0.0f,
+        0.1f,  0.3f,  2.0f,  0.1f,  0.0f,  0.2f,
+        0.2f,  0.0f,  0.1f,  1.0f,  0.1f,  0.0f,
+        0.0f,  0.1f,  0.0f,  0.1f,  0.5f,  0.05f,
+        0.1f,  0.0f,  0.2f,  0.0f,  0.05f, 0.25f
+    };
+    SquareMatrix<float, 6> A7(data7);
+    SquareMatrix<float, 6> A7_I;
+    SquareMatrix<float, 6> I6;
+    I6.setIdentity();
+    TEST(choleskyInv(A7, A7_I));
+    TEST((A7_I * A7 - I6).abs().max() < 1e-5f);
+    TEST((A7_I - inv(A7)).abs().max() < 1e-4f);
+    TEST((A7_I - A7_I.T()).abs().max() <= 0.0f);
+
+    // not positive definite
+    A7(5, 5) = -1;
+    TEST(!choleskyInv(A7, A7_I));
     return 0;
 }
 
@@ -26,6 +26,29 @@ int main()
     TEST(isEqual(B, B_check));
     Matrix3f C = B_check.edivide(C_check);
     TEST(isEqual(C, C_check));
+
+    // fused operations
+    float data_D[6] = {1, 2, 3, 4, 5, 6};
+    Matrix<float, 2, 3> D(data_D);
+    Matrix<float, 2, 3> D_A;
+    mult(D, A, D_A);
+    TEST(isEqual(D_A, D * A));
+
+    Matrix<float, 2, 3> D_sum = D;
+    multAdd(D, A, D_sum, 2.0f);
+    TEST(isEqual(D_sum, D + D * A * 2.0f));
+
+    addScaled(D_sum, D, -1.0f);
+    TEST(isEqual(D_sum, D * A * 2.0f));
+
+    Matrix3f E = A;
+    E += A_I;
+    TEST(isEqual(E, A + A_I));
+    E -= A;
+    TEST(isEqual(E, A_I));
+    E += 1.0f;
+    E -= 1.0f;
+    TEST(isEqual(E, A_I));
     return 0;
 }
 
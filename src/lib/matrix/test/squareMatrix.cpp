@@ -26,6 +26,34 @@ int main()
     SquareMatrix<float, 3> eA = expm(SquareMatrix<float, 3>(A*dt), 5);
     SquareMatrix<float, 3> eA_check(data_check);
     TEST((eA - eA_check).abs().max() < 1e-3);
+
+    // symmetric product A * P * A^T
+    float data_P[9] = {2, 0.5f, 0.1f,
+                       0.5f, 1, 0.2f,
+                       0.1f, 0.2f, 3
+                      };
+    SquareMatrix<float, 3> P(data_P);
+    float data_C[6] = {1, 0, 2,
+                       0, 3, 1
+                      };
+    Matrix<float, 2, 3> C(data_C);
+    SquareMatrix<float, 2> CPCt = symmetricProduct(C, P);
+    TEST(isEqual(CPCt, C * P * C.T()));
+    TEST(fabs(CPCt(0, 1) - CPCt(1, 0)) <= 0.0f);
+    TEST(isEqual(symmetricProduct(A, P), A * P * A.T()));
+
+    // fused A * P * A^T + Q
+    SquareMatrix<float, 2> Q = eye<float, 2>() * 0.1f;
+    SquareMatrix<float, 2> CPCt_Q = Q;
+    symmetricProductAdd(C, P, CPCt_Q);
+    TEST(isEqual(CPCt_Q, C * P * C.T() + Q));
+    TEST(fabs(CPCt_Q(0, 1) - CPCt_Q(1, 0)) <= 0.0f);
+
+    // symmetric rank-k update P += alpha * C^T * C
+    SquareMatrix<float, 3> P_check = P + C.T() * C * 0.5f;
+    symmetricRankUpdate(P, Matrix<float, 3, 2>(C.T()), 0.5f);
+    TEST(isEqual(P, P_check));
+    TEST((P - P.T()).abs().max() <= 0.0f);
     return 0;
 }
 
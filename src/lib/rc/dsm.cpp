@@ -613,6 +613,24 @@ dsm_parse(const uint64_t now, const uint8_t *frame, const unsigned len, uint16_t
 	/* keep decoding until we have consumed the buffer */
 	for (unsigned d = 0; d < len; d++) {
 
+		/*
+		 * Whole frame in the input at a frame boundary (the usual case when the caller reads
+		 * all available bytes): copy it at once and let the state machine handle its last byte.
+		 */
+		if (dsm_partial_frame_count == 0 && len - d >= DSM_FRAME_SIZE
+		    && (dsm_decode_state == DSM_DECODE_STATE_SYNC
+			|| (dsm_decode_state == DSM_DECODE_STATE_DESYNC && (now - dsm_last_rx_time) > 5000))) {
+
+			if (dsm_decode_state == DSM_DECODE_STATE_DESYNC) {
+				dsm_decode_state = DSM_DECODE_STATE_SYNC;
+				dsm_chan_count = 0;
+			}
+
+			memcpy(&dsm_frame[0], &frame[d], DSM_FRAME_SIZE - 1);
+			dsm_partial_frame_count = DSM_FRAME_SIZE - 1;
+			d += DSM_FRAME_SIZE - 1;
+		}
+
 		/* overflow check */
 		if (dsm_partial_frame_count == sizeof(dsm_frame) / sizeof(dsm_frame[0])) {
 			dsm_partial_frame_count = 0;
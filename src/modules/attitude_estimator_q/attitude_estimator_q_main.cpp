@@ -39,10 +39,12 @@
  * @author Anton Babushkin <anton.babushkin@me.com>
  */
 
+#include <conversion/attitude.h>
 #include <drivers/drv_hrt.h>
 #include <lib/geo/geo.h>
 #include <mathlib/math/filter/LowPassFilter2p.hpp>
 #include <mathlib/mathlib.h>
+#include <matrix/math.hpp>
 #include <px4_config.h>
 #include <px4_posix.h>
 #include <px4_tasks.h>
@@ -57,9 +59,10 @@
 
 extern "C" __EXPORT int attitude_estimator_q_main(int argc, char *argv[]);
 
-using math::Vector;
-using math::Matrix;
-using math::Quaternion;
+using matrix::Dcmf;
+using matrix::Eulerf;
+using matrix::Quatf;
+using matrix::Vector3f;
 
 class AttitudeEstimatorQ;
 
@@ -118,6 +121,7 @@ private:
 		param_t	acc_comp;
 		param_t	bias_max;
 		param_t	ext_hdg_mode;
+		param_t	gyro_batch;
 	} _params_handles{};		/**< handles for interesting parameters */
 
 	float		_w_accel = 0.0f;
@@ -126,25 +130,29 @@ private:
 	float		_w_gyro_bias = 0.0f;
 	float		_mag_decl = 0.0f;
 	bool		_mag_decl_auto = false;
+	mag_declination_cache_s _mag_decl_cache{};
 	bool		_acc_comp = false;
 	float		_bias_max = 0.0f;
 	int32_t		_ext_hdg_mode = 0;
+	int32_t		_gyro_batch = 1;		/**< gyro samples per correction step */
+	int32_t		_gyro_batch_count = 0;
 
-	Vector<3>	_gyro;
-	Vector<3>	_accel;
-	Vector<3>	_mag;
+	Vector3f	_gyro;
+	Vector3f	_accel;
+	Vector3f	_mag;
 
-	Vector<3>	_vision_hdg;
-	Vector<3>	_mocap_hdg;
+	Vector3f	_vision_hdg;
+	Vector3f	_mocap_hdg;
 
-	Quaternion	_q;
-	Vector<3>	_rates;
-	Vector<3>	_gyro_bias;
+	Quatf		_q;
+	Vector3f	_rates;
+	Vector3f	_gyro_bias;
+	Vector3f	_corr;		/**< correction rate of the last correction step, without the gyro feed forward */
 
-	Vector<3>	_vel_prev;
+	Vector3f	_vel_prev;
 	hrt_abstime	_vel_prev_t = 0;
 
-	Vector<3>	_pos_acc;
+	Vector3f	_pos_acc;
 
 	bool		_inited = false;
 	bool		_data_good = false;
@@ -158,6 +166,9 @@ private:
 
 	bool update(float dt);
 
+	// Correction rate from the heading and accelerometer errors, for the normalized _q
+	Vector3f correction(float spin_rate);
+
 	// Update magnetic declination (in rads) immediately changing yaw rotation
 	void update_mag_declination(float new_declination);
 };
@@ -174,23 +185,9 @@ AttitudeEstimatorQ::AttitudeEstimatorQ()
 	_params_handles.acc_comp	= param_find("ATT_ACC_COMP");
 	_params_handles.bias_max	= param_find("ATT_BIAS_MAX");
 	_params_handles.ext_hdg_mode	= param_find("ATT_EXT_HDG_M");
-
-	_vel_prev.zero();
-	_pos_acc.zero();
-
-	_gyro.zero();
-	_accel.zero();
-	_mag.zero();
-
-	_vision_hdg.zero();
-	_mocap_hdg.zero();
+	_params_handles.gyro_batch	= param_find("ATT_GYRO_BATCH");
 
 	_q.zero();
-	_rates.zero();
-	_gyro_bias.zero();
-
-	_vel_prev.zero();
-	_pos_acc.zero();
 }
 
 /**
@@ -302,7 +299,7 @@ void AttitudeEstimatorQ::task_main()
 				_accel(1) = sensors.accelerometer_m_s2[1];
 				_accel(2) = sensors.accelerometer_m_s2[2];
 
-				if (_accel.length() < 0.01f) {
+				if (_accel.norm() < 0.01f) {
 					PX4_ERR("WARNING: degenerate accel!");
 					continue;
 				}
@@ -313,7 +310,7 @@ void AttitudeEstimatorQ::task_main()
 				_mag(1) = sensors.magnetometer_ga[1];
 				_mag(2) = sensors.magnetometer_ga[2];
 
-				if (_mag.length() < 0.01f) {
+				if (_mag.norm() < 0.01f) {
 					PX4_ERR("WARNING: degenerate mag!");
 					continue;
 				}
@@ -330,15 +327,13 @@ void AttitudeEstimatorQ::task_main()
 			vehicle_attitude_s vision;
 
 			if (orb_copy(ORB_ID(vehicle_vision_attitude), _vision_sub, &vision) == PX4_OK) {
-				math::Quaternion q(vision.q);
-
-				math::Matrix<3, 3> Rvis = q.to_dcm();
-				math::Vector<3> v(1.0f, 0.0f, 0.4f);
+				Dcmf Rvis = Quatf(vision.q);
+				Vector3f v(1.0f, 0.0f, 0.4f);
 
 				// Rvis is Rwr (robot respect to world) while v is respect to world.
 				// Hence Rvis must be transposed having (Rwr)' * Vw
 				// Rrw * Vw = vn. This way we have consistency
-				_vision_hdg = Rvis.transposed() * v;
+				_vision_hdg = Rvis.transpose() * v;
 
 				// vision external heading usage (ATT_EXT_HDG_M 1)
 				if (_ext_hdg_mode == 1) {
@@ -355,15 +350,13 @@ void AttitudeEstimatorQ::task_main()
 			att_pos_mocap_s mocap;
 
 			if (orb_copy(ORB_ID(att_pos_mocap), _mocap_sub, &mocap) == PX4_OK) {
-				math::Quaternion q(mocap.q);
-				math::Matrix<3, 3> Rmoc = q.to_dcm();
-
-				math::Vector<3> v(1.0f, 0.0f, 0.4f);
+				Dcmf Rmoc = Quatf(mocap.q);
+				Vector3f v(1.0f, 0.0f, 0.4f);
 
 				// Rmoc is Rwr (robot respect to world) while v is respect to world.
 				// Hence Rmoc must be transposed having (Rwr)' * Vw
 				// Rrw * Vw = vn. This way we have consistency
-				_mocap_hdg = Rmoc.transposed() * v;
+				_mocap_hdg = Rmoc.transpose() * v;
 
 				// Motion Capture external heading usage (ATT_EXT_HDG_M 2)
 				if (_ext_hdg_mode == 2) {
@@ -382,18 +375,18 @@ void AttitudeEstimatorQ::task_main()
 			if (orb_copy(ORB_ID(vehicle_global_position), _global_pos_sub, &gpos) == PX4_OK) {
 				if (_mag_decl_auto && gpos.eph < 20.0f && hrt_elapsed_time(&gpos.timestamp) < 1000000) {
 					/* set magnetic declination automatically */
-					update_mag_declination(math::radians(get_mag_declination(gpos.lat, gpos.lon)));
+					update_mag_declination(math::radians(get_mag_declination_cached(&_mag_decl_cache, gpos.lat, gpos.lon)));
 				}
 
 				if (_acc_comp && gpos.timestamp != 0 && hrt_absolute_time() < gpos.timestamp + 20000 && gpos.eph < 5.0f && _inited) {
 					/* position data is actual */
-					Vector<3> vel(gpos.vel_n, gpos.vel_e, gpos.vel_d);
+					Vector3f vel(gpos.vel_n, gpos.vel_e, gpos.vel_d);
 
 					/* velocity updated */
 					if (_vel_prev_t != 0 && gpos.timestamp != _vel_prev_t) {
 						float vel_dt = (gpos.timestamp - _vel_prev_t) / 1e6f;
 						/* calculate acceleration in body frame */
-						_pos_acc = _q.conjugate_inversed((vel - _vel_prev) / vel_dt);
+						_pos_acc = Dcmf(_q).transpose() * ((vel - _vel_prev) / vel_dt);
 					}
 
 					_vel_prev_t = gpos.timestamp;
@@ -415,7 +408,8 @@ void AttitudeEstimatorQ::task_main()
 
 		if (update(dt)) {
 			vehicle_attitude_s att = {
-				.timestamp = sensors.timestamp,
+				.timestamp = hrt_absolute_time(),
+				.timestamp_sample = sensors.timestamp,
 				.rollspeed = _rates(0),
 				.pitchspeed = _rates(1),
 				.yawspeed = _rates(2),
@@ -425,6 +419,8 @@ void AttitudeEstimatorQ::task_main()
 				.quat_reset_counter = 0,
 			};
 
+			set_attitude_representations(att);
+
 			/* the instance count is not used here */
 			int att_inst;
 			orb_publish_auto(ORB_ID(vehicle_attitude), &_att_pub, &att, &att_inst, ORB_PRIO_HIGH);
@@ -475,6 +471,10 @@ void AttitudeEstimatorQ::update_parameters(bool force)
 
 		param_get(_params_handles.bias_max, &_bias_max);
 		param_get(_params_handles.ext_hdg_mode, &_ext_hdg_mode);
+
+		param_get(_params_handles.gyro_batch, &_gyro_batch);
+		_gyro_batch = math::constrain(_gyro_batch, 1, 10);
+		_gyro_batch_count = 0;
 	}
 }
 
@@ -482,35 +482,34 @@ bool AttitudeEstimatorQ::init()
 {
 	// Rotation matrix can be easily constructed from acceleration and mag field vectors
 	// 'k' is Earth Z axis (Down) unit vector in body frame
-	Vector<3> k = -_accel;
+	Vector3f k = -_accel;
 	k.normalize();
 
 	// 'i' is Earth X axis (North) unit vector in body frame, orthogonal with 'k'
-	Vector<3> i = (_mag - k * (_mag * k));
+	Vector3f i = (_mag - k * (_mag * k));
 	i.normalize();
 
 	// 'j' is Earth Y axis (East) unit vector in body frame, orthogonal with 'k' and 'i'
-	Vector<3> j = k % i;
+	Vector3f j = k % i;
 
 	// Fill rotation matrix
-	Matrix<3, 3> R;
-	R.set_row(0, i);
-	R.set_row(1, j);
-	R.set_row(2, k);
+	Dcmf R;
+	R.setRow(0, i);
+	R.setRow(1, j);
+	R.setRow(2, k);
 
 	// Convert to quaternion
-	_q.from_dcm(R);
+	_q = R;
 
 	// Compensate for magnetic declination
-	Quaternion decl_rotation;
-	decl_rotation.from_yaw(_mag_decl);
+	Quatf decl_rotation = Eulerf(0.0f, 0.0f, _mag_decl);
 	_q = decl_rotation * _q;
 
 	_q.normalize();
 
 	if (PX4_ISFINITE(_q(0)) && PX4_ISFINITE(_q(1)) &&
 	    PX4_ISFINITE(_q(2)) && PX4_ISFINITE(_q(3)) &&
-	    _q.length() > 0.95f && _q.length() < 1.05f) {
+	    _q.norm() > 0.95f && _q.norm() < 1.05f) {
 		_inited = true;
 
 	} else {
@@ -531,80 +530,48 @@ bool AttitudeEstimatorQ::update(float dt)
 		return init();
 	}
 
-	Quaternion q_last = _q;
-
-	// Angular rate of correction
-	Vector<3> corr;
-	float spinRate = _gyro.length();
+	const Quatf q_last = _q;
 
-	if (_ext_hdg_mode > 0 && _ext_hdg_good) {
-		if (_ext_hdg_mode == 1) {
-			// Vision heading correction
-			// Project heading to global frame and extract XY component
-			Vector<3> vision_hdg_earth = _q.conjugate(_vision_hdg);
-			float vision_hdg_err = _wrap_pi(atan2f(vision_hdg_earth(1), vision_hdg_earth(0)));
-			// Project correction to body frame
-			corr += _q.conjugate_inversed(Vector<3>(0.0f, 0.0f, -vision_hdg_err)) * _w_ext_hdg;
-		}
+	const float spinRate = _gyro.norm();
 
-		if (_ext_hdg_mode == 2) {
-			// Mocap heading correction
-			// Project heading to global frame and extract XY component
-			Vector<3> mocap_hdg_earth = _q.conjugate(_mocap_hdg);
-			float mocap_hdg_err = _wrap_pi(atan2f(mocap_hdg_earth(1), mocap_hdg_earth(0)));
-			// Project correction to body frame
-			corr += _q.conjugate_inversed(Vector<3>(0.0f, 0.0f, -mocap_hdg_err)) * _w_ext_hdg;
-		}
+	// Heading and accelerometer correction, once per batch of gyro samples: the gyro
+	// samples in between only propagate the attitude with the last correction rate.
+	if (_gyro_batch_count == 0) {
+		_q.normalize();
+		_corr = correction(spinRate);
 	}
 
-	if (_ext_hdg_mode == 0 || !_ext_hdg_good) {
-		// Magnetometer correction
-		// Project mag field vector to global frame and extract XY component
-		Vector<3> mag_earth = _q.conjugate(_mag);
-		float mag_err = _wrap_pi(atan2f(mag_earth(1), mag_earth(0)) - _mag_decl);
-		float gainMult = 1.0f;
-		const float fifty_dps = 0.873f;
-
-		if (spinRate > fifty_dps) {
-			gainMult = math::min(spinRate / fifty_dps, 10.0f);
-		}
-
-		// Project magnetometer correction to body frame
-		corr += _q.conjugate_inversed(Vector<3>(0.0f, 0.0f, -mag_err)) * _w_mag * gainMult;
+	if (++_gyro_batch_count >= _gyro_batch) {
+		_gyro_batch_count = 0;
 	}
 
-	_q.normalize();
-
-
-	// Accelerometer correction
-	// Project 'k' unit vector of earth frame to body frame
-	// Vector<3> k = _q.conjugate_inversed(Vector<3>(0.0f, 0.0f, 1.0f));
-	// Optimized version with dropped zeros
-	Vector<3> k(
-		2.0f * (_q(1) * _q(3) - _q(0) * _q(2)),
-		2.0f * (_q(2) * _q(3) + _q(0) * _q(1)),
-		(_q(0) * _q(0) - _q(1) * _q(1) - _q(2) * _q(2) + _q(3) * _q(3))
-	);
-
-	corr += (k % (_accel - _pos_acc).normalized()) * _w_accel;
-
 	// Gyro bias estimation
 	if (spinRate < 0.175f) {
-		_gyro_bias += corr * (_w_gyro_bias * dt);
+		const float bias_gain = _w_gyro_bias * dt;
 
 		for (int i = 0; i < 3; i++) {
-			_gyro_bias(i) = math::constrain(_gyro_bias(i), -_bias_max, _bias_max);
+			_gyro_bias(i) = math::constrain(_gyro_bias(i) + _corr(i) * bias_gain, -_bias_max, _bias_max);
 		}
-
 	}
 
 	_rates = _gyro + _gyro_bias;
 
 	// Feed forward gyro
-	corr += _rates;
-
-	// Apply correction to state
-	_q += _q.derivative(corr) * dt;
+	const float w0 = _corr(0) + _rates(0);
+	const float w1 = _corr(1) + _rates(1);
+	const float w2 = _corr(2) + _rates(2);
+
+	// Apply correction to state: q += 0.5 * q * (0, w) * dt
+	const float q0 = _q(0);
+	const float q1 = _q(1);
+	const float q2 = _q(2);
+	const float q3 = _q(3);
+	const float half_dt = 0.5f * dt;
+
+	_q(0) = q0 + (-q1 * w0 - q2 * w1 - q3 * w2) * half_dt;
+	_q(1) = q1 + (q0 * w0 - q3 * w1 + q2 * w2) * half_dt;
+	_q(2) = q2 + (q3 * w0 + q0 * w1 - q1 * w2) * half_dt;
+	_q(3) = q3 + (-q2 * w0 + q1 * w1 + q0 * w2) * half_dt;
 
 	// Normalize quaternion
 	_q.normalize();
@@ -615,12 +582,71 @@ bool AttitudeEstimatorQ::update(float dt)
 		_q = q_last;
 		_rates.zero();
 		_gyro_bias.zero();
+		_corr.zero();
 		return false;
 	}
 
 	return true;
 }
 
+Vector3f AttitudeEstimatorQ::correction(float spin_rate)
+{
+	const float q0 = _q(0);
+	const float q1 = _q(1);
+	const float q2 = _q(2);
+	const float q3 = _q(3);
+
+	// First two rows of the body to earth rotation matrix, for the heading of body vectors
+	const float r00 = q0 * q0 + q1 * q1 - q2 * q2 - q3 * q3;
+	const float r01 = 2.0f * (q1 * q2 - q0 * q3);
+	const float r02 = 2.0f * (q0 * q2 + q1 * q3);
+	const float r10 = 2.0f * (q1 * q2 + q0 * q3);
+	const float r11 = q0 * q0 - q1 * q1 + q2 * q2 - q3 * q3;
+	const float r12 = 2.0f * (q2 * q3 - q0 * q1);
+
+	// Project 'k' unit vector of earth frame to body frame (last row of the rotation matrix)
+	const Vector3f k(
+		2.0f * (q1 * q3 - q0 * q2),
+		2.0f * (q2 * q3 + q0 * q1),
+		(q0 * q0 - q1 * q1 - q2 * q2 + q3 * q3)
+	);
+
+	// Heading error around the earth Z axis, projected to body frame with 'k'
+	float hdg_corr = 0.0f;
+
+	if (_ext_hdg_mode > 0 && _ext_hdg_good) {
+		// Vision (1) or mocap (2) heading correction
+		// Project heading to global frame and extract XY component
+		const Vector3f &hdg = (_ext_hdg_mode == 1) ? _vision_hdg : _mocap_hdg;
+
+		if (_ext_hdg_mode == 1 || _ext_hdg_mode == 2) {
+			const float hdg_err = _wrap_pi(atan2f(r10 * hdg(0) + r11 * hdg(1) + r12 * hdg(2),
+							      r00 * hdg(0) + r01 * hdg(1) + r02 * hdg(2)));
+			hdg_corr = -hdg_err * _w_ext_hdg;
+		}
+
+	} else {
+		// Magnetometer correction
+		// Project mag field vector to global frame and extract XY component
+		const float mag_err = _wrap_pi(atan2f(r10 * _mag(0) + r11 * _mag(1) + r12 * _mag(2),
+						      r00 * _mag(0) + r01 * _mag(1) + r02 * _mag(2)) - _mag_decl);
+		float gainMult = 1.0f;
+		const float fifty_dps = 0.873f;
+
+		if (spin_rate > fifty_dps) {
+			gainMult = math::min(spin_rate / fifty_dps, 10.0f);
+		}
+
+		hdg_corr = -mag_err * _w_mag * gainMult;
+	}
+
+	// Accelerometer correction
+	Vector3f accel = _accel - _pos_acc;
+	accel.normalize();
+
+	return k * hdg_corr + (k % accel) * _w_accel;
+}
+
 void AttitudeEstimatorQ::update_mag_declination(float new_declination)
 {
 	// Apply initial declination or trivial rotations without changing estimation
@@ -629,8 +655,7 @@ void AttitudeEstimatorQ::update_mag_declination(float new_declination)
 
 	} else {
 		// Immediately rotate current estimation to avoid gyro bias growth
-		Quaternion decl_rotation;
-		decl_rotation.from_yaw(new_declination - _mag_decl);
+		Quatf decl_rotation = Eulerf(0.0f, 0.0f, new_declination - _mag_decl);
 		_q = decl_rotation * _q;
 		_mag_decl = new_declination;
 	}
@@ -134,3 +134,16 @@ PARAM_DEFINE_INT32(ATT_ACC_COMP, 1);
  * @decimal 3
  */
 PARAM_DEFINE_FLOAT(ATT_BIAS_MAX, 0.05f);
+
+/**
+ * Gyro samples per correction step
+ *
+ * The heading and accelerometer corrections are computed once per this number of
+ * gyro samples, the samples in between only propagate the attitude. Values above 1
+ * reduce the load at high gyro rates.
+ *
+ * @group Attitude Q estimator
+ * @min 1
+ * @max 10
+ */
+PARAM_DEFINE_INT32(ATT_GYRO_BATCH, 1);
@@ -121,6 +121,176 @@ CameraFeedback::stop()
 }
 
 
+/**
+ * Find the samples around t in a history ring: before is the newest sample at or
+ * before t, after the oldest sample after t, or -1 if there is none.
+ */
+template<typename T>
+static void
+find_bracket(const T *history, int size, int count, int next, hrt_abstime t, int &before, int &after)
+{
+	before = -1;
+	after = -1;
+
+	// go from the newest to the oldest sample
+	for (int i = 0; i < count; i++) {
+		int index = (next - 1 - i + size) % size;
+
+		if (history[index].timestamp <= t) {
+			before = index;
+			break;
+		}
+
+		after = index;
+	}
+}
+
+void
+CameraFeedback::add_position_sample(const vehicle_global_position_s &gpos)
+{
+	position_sample_s &sample = _pos_history[_pos_history_next];
+	sample.timestamp = gpos.timestamp;
+	sample.lat = gpos.lat;
+	sample.lon = gpos.lon;
+	sample.alt = gpos.alt;
+	sample.ground_distance = gpos.terrain_alt_valid ? (gpos.alt - gpos.terrain_alt) : -1.0f;
+
+	_pos_history_next = (_pos_history_next + 1) % HISTORY_SIZE;
+
+	if (_pos_history_count < HISTORY_SIZE) {
+		_pos_history_count++;
+	}
+}
+
+void
+CameraFeedback::add_attitude_sample(const vehicle_attitude_s &att)
+{
+	attitude_sample_s &sample = _att_history[_att_history_next];
+	sample.timestamp = att.timestamp;
+	memcpy(sample.q, att.q, sizeof(sample.q));
+
+	_att_history_next = (_att_history_next + 1) % HISTORY_SIZE;
+
+	if (_att_history_count < HISTORY_SIZE) {
+		_att_history_count++;
+	}
+}
+
+bool
+CameraFeedback::interpolate_position(hrt_abstime t, position_sample_s &pos) const
+{
+	int before, after;
+	find_bracket(_pos_history, HISTORY_SIZE, _pos_history_count, _pos_history_next, t, before, after);
+
+	if (before < 0 && after < 0) {
+		return false;
+	}
+
+	if (before < 0 || after < 0) {
+		pos = _pos_history[before >= 0 ? before : after];
+		pos.timestamp = t;
+		return true;
+	}
+
+	const position_sample_s &a = _pos_history[before];
+	const position_sample_s &b = _pos_history[after];
+	const double k = (double)(t - a.timestamp) / (double)(b.timestamp - a.timestamp);
+
+	pos.timestamp = t;
+	pos.lat = a.lat + (b.lat - a.lat) * k;
+	pos.lon = a.lon + (b.lon - a.lon) * k;
+	pos.alt = a.alt + (b.alt - a.alt) * (float)k;
+
+	if (a.ground_distance >= 0.0f && b.ground_distance >= 0.0f) {
+		pos.ground_distance = a.ground_distance + (b.ground_distance - a.ground_distance) * (float)k;
+
+	} else {
+		pos.ground_distance = (k < 0.5) ? a.ground_distance : b.ground_distance;
+	}
+
+	return true;
+}
+
+bool
+CameraFeedback::interpolate_attitude(hrt_abstime t, float q[4]) const
+{
+	int before, after;
+	find_bracket(_att_history, HISTORY_SIZE, _att_history_count, _att_history_next, t, before, after);
+
+	if (before < 0 && after < 0) {
+		return false;
+	}
+
+	if (before < 0 || after < 0) {
+		memcpy(q, _att_history[before >= 0 ? before : after].q, sizeof(float) * 4);
+		return true;
+	}
+
+	const attitude_sample_s &a = _att_history[before];
+	const attitude_sample_s &b = _att_history[after];
+	const float k = (float)(t - a.timestamp) / (float)(b.timestamp - a.timestamp);
+
+	// take the shorter way, q and -q are the same rotation
+	const float dot = a.q[0] * b.q[0] + a.q[1] * b.q[1] + a.q[2] * b.q[2] + a.q[3] * b.q[3];
+	const float sign = (dot < 0.0f) ? -1.0f : 1.0f;
+	float norm = 0.0f;
+
+	for (int i = 0; i < 4; i++) {
+		q[i] = a.q[i] * (1.0f - k) + sign * b.q[i] * k;
+		norm += q[i] * q[i];
+	}
+
+	norm = sqrtf(norm);
+
+	if (norm > FLT_EPSILON) {
+		for (int i = 0; i < 4; i++) {
+			q[i] /= norm;
+		}
+	}
+
+	return true;
+}
+
+void
+CameraFeedback::publish_capture(const camera_trigger_s &trig)
+{
+	position_sample_s pos;
+	struct camera_capture_s capture = {};
+
+	// the samples at the trigger time: the trigger is timestamped in the hrt callout that fires it
+	if (!interpolate_position(trig.timestamp, pos) ||
+	    !interpolate_attitude(trig.timestamp, capture.q)) {
+		// reject until we have valid data
+		return;
+	}
+
+	// Fill timestamps
+	capture.timestamp = trig.timestamp;
+
+	capture.timestamp_utc = trig.timestamp_utc;
+
+	// Fill image sequence
+	capture.seq = trig.seq;
+
+	// Fill position data
+	capture.lat = pos.lat;
+
+	capture.lon = pos.lon;
+
+	capture.alt = pos.alt;
+
+	capture.ground_distance = pos.ground_distance;
+
+	// TODO : the attitude needs to be rotated by camera orientation or set to gimbal orientation when available
+
+	// Indicate that no capture feedback from camera is available
+	capture.result = -1;
+
+	int instance_id;
+
+	orb_publish_auto(ORB_ID(camera_capture), &_capture_pub, &capture, &instance_id, ORB_PRIO_DEFAULT);
+}
+
 void
 CameraFeedback::task_main()
 {
@@ -131,20 +301,21 @@ CameraFeedback::task_main()
 		return;
 	}
 
-	// Polling sources
+	// Polling sources: the position is polled as well, so that every sample goes into the history
 	_trigger_sub = orb_subscribe(ORB_ID(camera_trigger));
-	struct camera_trigger_s trig = {};
-
-	px4_pollfd_struct_t fds[1] = {};
-	fds[0].fd = _trigger_sub;
-	fds[0].events = POLLIN;
-
-	// Geotagging subscriptions
 	_gpos_sub = orb_subscribe(ORB_ID(vehicle_global_position));
 	_att_sub = orb_subscribe(ORB_ID(vehicle_attitude));
+
+	struct camera_trigger_s trig = {};
 	struct vehicle_global_position_s gpos = {};
 	struct vehicle_attitude_s att = {};
 
+	px4_pollfd_struct_t fds[2] = {};
+	fds[0].fd = _trigger_sub;
+	fds[0].events = POLLIN;
+	fds[1].fd = _gpos_sub;
+	fds[1].events = POLLIN;
+
 	bool updated = false;
 
 	while (!_task_should_exit) {
@@ -157,67 +328,46 @@ CameraFeedback::task_main()
 			continue;
 		}
 
-		/* trigger subscription updated */
-		if (fds[0].revents & POLLIN) {
+		/* update the geotagging history */
+		if (fds[1].revents & POLLIN) {
+			orb_copy(ORB_ID(vehicle_global_position), _gpos_sub, &gpos);
+			add_position_sample(gpos);
+		}
 
-			orb_copy(ORB_ID(camera_trigger), _trigger_sub, &trig);
+		orb_check(_att_sub, &updated);
 
-			/* update geotagging subscriptions */
-			orb_check(_gpos_sub, &updated);
+		if (updated) {
+			orb_copy(ORB_ID(vehicle_attitude), _att_sub, &att);
+			add_attitude_sample(att);
+		}
 
-			if (updated) {
-				orb_copy(ORB_ID(vehicle_global_position), _gpos_sub, &gpos);
-			}
+		/* trigger subscription updated */
+		if (fds[0].revents & POLLIN) {
 
-			orb_check(_att_sub, &updated);
+			orb_copy(ORB_ID(camera_trigger), _trigger_sub, &trig);
 
-			if (updated) {
-				orb_copy(ORB_ID(vehicle_attitude), _att_sub, &att);
-			}
+			if (trig.timestamp != 0) {
+				if (_pending_count == PENDING_SIZE) {
+					// should not happen at a sane trigger rate: publish the oldest with what we have
+					publish_capture(_pending[0]);
+					memmove(&_pending[0], &_pending[1], sizeof(_pending[0]) * (PENDING_SIZE - 1));
+					_pending_count--;
+				}
 
-			if (trig.timestamp == 0 ||
-			    gpos.timestamp == 0 ||
-			    att.timestamp == 0) {
-				// reject until we have valid data
-				continue;
+				_pending[_pending_count++] = trig;
 			}
+		}
 
-			struct camera_capture_s capture = {};
-
-			// Fill timestamps
-			capture.timestamp = trig.timestamp;
-
-			capture.timestamp_utc = trig.timestamp_utc;
-
-			// Fill image sequence
-			capture.seq = trig.seq;
-
-			// Fill position data
-			capture.lat = gpos.lat;
-
-			capture.lon = gpos.lon;
-
-			capture.alt = gpos.alt;
-
-			capture.ground_distance = gpos.terrain_alt_valid ? (gpos.alt - gpos.terrain_alt) : -1.0f;
-
-			// Fill attitude data
-			// TODO : this needs to be rotated by camera orientation or set to gimbal orientation when available
-			capture.q[0] = att.q[0];
-
-			capture.q[1] = att.q[1];
-
-			capture.q[2] = att.q[2];
-
-			capture.q[3] = att.q[3];
-
-			// Indicate that no capture feedback from camera is available
-			capture.result = -1;
-
-			int instance_id;
-
-			orb_publish_auto(ORB_ID(camera_capture), &_capture_pub, &capture, &instance_id, ORB_PRIO_DEFAULT);
+		/* publish the triggers once there is a position sample after them to interpolate with */
+		const hrt_abstime now = hrt_absolute_time();
+		const hrt_abstime latest_pos = (_pos_history_count > 0) ?
+					       _pos_history[(_pos_history_next - 1 + HISTORY_SIZE) % HISTORY_SIZE].timestamp : 0;
 
+		while (_pending_count > 0 &&
+		       (latest_pos >= _pending[0].timestamp || now - _pending[0].timestamp > MAX_WAIT)) {
+			publish_capture(_pending[0]);
+			memmove(&_pending[0], &_pending[1], sizeof(_pending[0]) * (_pending_count - 1));
+			_pending_count--;
 		}
 
 	}
@@ -44,6 +44,7 @@
 #include <fcntl.h>
 #include <stdbool.h>
 #include <poll.h>
+#include <float.h>
 #include <mathlib/mathlib.h>
 #include <systemlib/systemlib.h>
 #include <systemlib/err.h>
@@ -95,6 +96,23 @@ public:
 
 private:
 
+	static constexpr int HISTORY_SIZE = 16;			/**< position and attitude samples kept for interpolation */
+	static constexpr int PENDING_SIZE = 4;			/**< triggers waiting for a position after their timestamp */
+	static constexpr hrt_abstime MAX_WAIT = 200000;		/**< max time to wait for the next position sample [us] */
+
+	struct position_sample_s {
+		hrt_abstime timestamp;
+		double lat;
+		double lon;
+		float alt;
+		float ground_distance;	/**< -1 if unknown */
+	};
+
+	struct attitude_sample_s {
+		hrt_abstime timestamp;
+		float q[4];
+	};
+
 	bool		_task_should_exit;		/**< if true, task should exit */
 	int			_main_task;				/**< handle for task */
 
@@ -109,8 +127,39 @@ private:
 
 	camera_feedback_mode_t _camera_feedback_mode;
 
+	position_sample_s	_pos_history[HISTORY_SIZE] {};
+	attitude_sample_s	_att_history[HISTORY_SIZE] {};
+	int			_pos_history_count{0};
+	int			_att_history_count{0};
+	int			_pos_history_next{0};	/**< index the next sample is written to */
+	int			_att_history_next{0};
+
+	camera_trigger_s	_pending[PENDING_SIZE] {};	/**< oldest first */
+	int			_pending_count{0};
+
 	void		task_main();
 
+	void		add_position_sample(const vehicle_global_position_s &gpos);
+	void		add_attitude_sample(const vehicle_attitude_s &att);
+
+	/**
+	 * Interpolate the position at time t from the bracketing samples of the history.
+	 * Outside of the history the nearest sample is used.
+	 *
+	 * @return		false if there is no sample
+	 */
+	bool		interpolate_position(hrt_abstime t, position_sample_s &pos) const;
+
+	/**
+	 * Interpolate the attitude at time t (normalized linear interpolation), like interpolate_position().
+	 */
+	bool		interpolate_attitude(hrt_abstime t, float q[4]) const;
+
+	/**
+	 * Publish the capture of a trigger with the interpolated position and attitude.
+	 */
+	void		publish_capture(const camera_trigger_s &trig);
+
 	/**
 	 * Shim for calling task_main from task_create.
 	 */
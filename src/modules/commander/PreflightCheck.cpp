@@ -66,7 +66,9 @@
 #include <uORB/topics/airspeed.h>
 #include <uORB/topics/differential_pressure.h>
 #include <uORB/topics/estimator_status.h>
+#include <uORB/topics/parameter_update.h>
 #include <uORB/topics/sensor_preflight.h>
+#include <uORB/topics/sensor_selection.h>
 #include <uORB/topics/vehicle_gps_position.h>
 
 #include "PreflightCheck.h"
@@ -78,6 +80,75 @@ using namespace DriverFramework;
 namespace Commander
 {
 
+/**
+ * Result of the device part of a sensor check (present, calibrated, self test). Opening the
+ * device and running the ioctls and the parameter lookups is slow, and the result only changes
+ * with the calibration parameters or the sensor state. So a passed check is kept until the
+ * parameters or the sensor selection (failover) change, or it gets older than
+ * sensor_check_cache_timeout. Failed checks are not cached, so that they are reported
+ * and recover as before.
+ */
+struct sensor_check_cache_s {
+	hrt_abstime timestamp;	///< time of the passed check, 0 if none
+	int device_id;
+};
+
+static constexpr hrt_abstime sensor_check_cache_timeout = 30 * 1000 * 1000;
+
+static sensor_check_cache_s mag_check_cache[max_optional_mag_count] = {};
+static sensor_check_cache_s accel_check_cache[max_optional_accel_count] = {};
+static sensor_check_cache_s gyro_check_cache[max_optional_gyro_count] = {};
+static sensor_check_cache_s baro_check_cache[max_optional_baro_count] = {};
+
+static void invalidate_sensor_check_cache()
+{
+	static int param_sub = -1;
+	static int sensor_selection_sub = -1;
+
+	if (param_sub < 0) {
+		param_sub = orb_subscribe(ORB_ID(parameter_update));
+		sensor_selection_sub = orb_subscribe(ORB_ID(sensor_selection));
+	}
+
+	bool param_updated = false;
+	bool sensor_selection_updated = false;
+	orb_check(param_sub, &param_updated);
+	orb_check(sensor_selection_sub, &sensor_selection_updated);
+
+	if (param_updated) {
+		parameter_update_s param_update;
+		orb_copy(ORB_ID(parameter_update), param_sub, &param_update);
+	}
+
+	if (sensor_selection_updated) {
+		sensor_selection_s sensor_selection;
+		orb_copy(ORB_ID(sensor_selection), sensor_selection_sub, &sensor_selection);
+	}
+
+	if (param_updated || sensor_selection_updated) {
+		memset(mag_check_cache, 0, sizeof(mag_check_cache));
+		memset(accel_check_cache, 0, sizeof(accel_check_cache));
+		memset(gyro_check_cache, 0, sizeof(gyro_check_cache));
+		memset(baro_check_cache, 0, sizeof(baro_check_cache));
+	}
+}
+
+static bool sensor_check_cached(const sensor_check_cache_s &cache, int &device_id)
+{
+	if (cache.timestamp != 0 && hrt_elapsed_time(&cache.timestamp) < sensor_check_cache_timeout) {
+		device_id = cache.device_id;
+		return true;
+	}
+
+	return false;
+}
+
+static void sensor_check_cache_store(sensor_check_cache_s &cache, bool success, int device_id)
+{
+	cache.timestamp = success ? hrt_absolute_time() : 0;
+	cache.device_id = device_id;
+}
+
 static int check_calibration(DevHandle &h, const char *param_template, int &devid)
 {
 	bool calibration_found;
@@ -121,6 +192,10 @@ static int check_calibration(DevHandle &h, const char *param_template, int &devi
 
 static bool magnometerCheck(orb_advert_t *mavlink_log_pub, unsigned instance, bool optional, int &device_id, bool report_fail)
 {
+	if (sensor_check_cached(mag_check_cache[instance], device_id)) {
+		return true;
+	}
+
 	bool success = true;
 
 	char s[30];
@@ -160,6 +235,7 @@ static bool magnometerCheck(orb_advert_t *mavlink_log_pub, unsigned instance, bo
 
 out:
 	DevMgr::releaseHandle(h);
+	sensor_check_cache_store(mag_check_cache[instance], success, device_id);
 	return success;
 }
 
@@ -241,7 +317,15 @@ static bool magConsistencyCheck(orb_advert_t *mavlink_log_pub, bool report_statu
 
 static bool accelerometerCheck(orb_advert_t *mavlink_log_pub, unsigned instance, bool optional, bool dynamic, int &device_id, bool report_fail)
 {
+	/* the range check reads a measurement, it is never cached */
+	const bool cached = sensor_check_cached(accel_check_cache[instance], device_id);
+
+	if (cached && !dynamic) {
+		return true;
+	}
+
 	bool success = true;
+	int ret;
 
 	char s[30];
 	sprintf(s, "%s%u", ACCEL_BASE_DEVICE_PATH, instance);
@@ -255,10 +339,15 @@ static bool accelerometerCheck(orb_advert_t *mavlink_log_pub, unsigned instance,
 			}
 		}
 
+		accel_check_cache[instance].timestamp = 0;
 		return false;
 	}
 
-	int ret = check_calibration(h, "CAL_ACC%u_ID", device_id);
+	if (cached) {
+		goto dynamic_check;
+	}
+
+	ret = check_calibration(h, "CAL_ACC%u_ID", device_id);
 
 	if (ret) {
 		if (report_fail) {
@@ -278,6 +367,9 @@ static bool accelerometerCheck(orb_advert_t *mavlink_log_pub, unsigned instance,
 		goto out;
 	}
 
+	sensor_check_cache_store(accel_check_cache[instance], true, device_id);
+
+dynamic_check:
 #ifdef __PX4_NUTTX
 	if (dynamic) {
 		/* check measurement result range */
@@ -309,11 +401,20 @@ static bool accelerometerCheck(orb_advert_t *mavlink_log_pub, unsigned instance,
 
 out:
 	DevMgr::releaseHandle(h);
+
+	if (!success) {
+		accel_check_cache[instance].timestamp = 0;
+	}
+
 	return success;
 }
 
 static bool gyroCheck(orb_advert_t *mavlink_log_pub, unsigned instance, bool optional, int &device_id, bool report_fail)
 {
+	if (sensor_check_cached(gyro_check_cache[instance], device_id)) {
+		return true;
+	}
+
 	bool success = true;
 
 	char s[30];
@@ -353,11 +454,16 @@ static bool gyroCheck(orb_advert_t *mavlink_log_pub, unsigned instance, bool opt
 
 out:
 	DevMgr::releaseHandle(h);
+	sensor_check_cache_store(gyro_check_cache[instance], success, device_id);
 	return success;
 }
 
 static bool baroCheck(orb_advert_t *mavlink_log_pub, unsigned instance, bool optional, int &device_id, bool report_fail)
 {
+	if (sensor_check_cached(baro_check_cache[instance], device_id)) {
+		return true;
+	}
+
 	bool success = true;
 
 	char s[30];
@@ -389,6 +495,7 @@ static bool baroCheck(orb_advert_t *mavlink_log_pub, unsigned instance, bool opt
 //out:
 
 	DevMgr::releaseHandle(h);
+	sensor_check_cache_store(baro_check_cache[instance], success, device_id);
 	return success;
 }
 
@@ -620,6 +727,10 @@ bool preflightCheck(orb_advert_t *mavlink_log_pub, bool checkSensors, bool check
 
 	bool failed = false;
 
+	if (checkSensors) {
+		invalidate_sensor_check_cache();
+	}
+
 	/* ---- MAG ---- */
 	if (checkSensors) {
 		bool prime_found = false;
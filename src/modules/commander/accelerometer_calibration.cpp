@@ -156,7 +156,7 @@ static int device_prio_max = 0;
 static int32_t device_id_primary = 0;
 
 calibrate_return do_accel_calibration_measurements(orb_advert_t *mavlink_log_pub, float (&accel_offs)[max_accel_sens][3], float (&accel_T)[max_accel_sens][3][3], unsigned *active_sensors);
-calibrate_return read_accelerometer_avg(int sensor_correction_sub, int (&subs)[max_accel_sens], float (&accel_avg)[max_accel_sens][detect_orientation_side_count][3], unsigned orient, unsigned samples_num);
+calibrate_return read_accelerometer_avg(int sensor_correction_sub, int (&subs)[max_accel_sens], float (&accel_avg)[max_accel_sens][detect_orientation_side_count][3], unsigned orient, unsigned samples_num, float *dispersion = nullptr);
 int mat_invert3(float src[3][3], float dst[3][3]);
 calibrate_return calculate_calibration_values(unsigned sensor, float (&accel_ref)[max_accel_sens][detect_orientation_side_count][3], float (&accel_T)[max_accel_sens][3][3], float (&accel_offs)[max_accel_sens][3], float g);
 
@@ -428,12 +428,20 @@ static calibrate_return accel_calibration_worker(detect_orientation_return orien
 
 	calibration_log_info(worker_data->mavlink_log_pub, "[cal] Hold still, measuring %s side", detect_orientation_str(orientation));
 
-	read_accelerometer_avg(worker_data->sensor_correction_sub, worker_data->subs, worker_data->accel_ref, orientation, samples_num);
+	float dispersion[max_accel_sens] = {};
 
-	calibration_log_info(worker_data->mavlink_log_pub, "[cal] %s side result: [%8.4f %8.4f %8.4f]", detect_orientation_str(orientation),
+	if (read_accelerometer_avg(worker_data->sensor_correction_sub, worker_data->subs, worker_data->accel_ref, orientation,
+				   samples_num, dispersion) != calibrate_return_ok) {
+		calibration_log_critical(worker_data->mavlink_log_pub, CAL_ERROR_SENSOR_MSG);
+		return calibrate_return_error;
+	}
+
+	calibration_log_info(worker_data->mavlink_log_pub, "[cal] %s side result: [%8.4f %8.4f %8.4f] (dispersion %.4f)",
+				     detect_orientation_str(orientation),
 				     (double)worker_data->accel_ref[0][orientation][0],
 				     (double)worker_data->accel_ref[0][orientation][1],
-				     (double)worker_data->accel_ref[0][orientation][2]);
+				     (double)worker_data->accel_ref[0][orientation][2],
+				     (double)dispersion[0]);
 
 	worker_data->done_count++;
 	calibration_log_info(worker_data->mavlink_log_pub, CAL_QGC_PROGRESS_MSG, 17 * worker_data->done_count);
@@ -564,9 +572,10 @@ calibrate_return do_accel_calibration_measurements(orb_advert_t *mavlink_log_pub
 }
 
 /*
- * Read specified number of accelerometer samples, calculate average and dispersion.
+ * Read specified number of accelerometer samples, calculate average and dispersion
+ * (standard deviation of the samples, optional).
  */
-calibrate_return read_accelerometer_avg(int sensor_correction_sub, int (&subs)[max_accel_sens], float (&accel_avg)[max_accel_sens][detect_orientation_side_count][3], unsigned orient, unsigned samples_num)
+calibrate_return read_accelerometer_avg(int sensor_correction_sub, int (&subs)[max_accel_sens], float (&accel_avg)[max_accel_sens][detect_orientation_side_count][3], unsigned orient, unsigned samples_num, float *dispersion)
 {
 	/* get total sensor board rotation matrix */
 	param_t board_rotation_h = param_find("SENS_BOARD_ROT");
@@ -600,9 +609,11 @@ calibrate_return read_accelerometer_avg(int sensor_correction_sub, int (&subs)[m
 		fds[i].events = POLLIN;
 	}
 
-	unsigned counts[max_accel_sens] = { 0 };
-	float accel_sum[max_accel_sens][3];
-	memset(accel_sum, 0, sizeof(accel_sum));
+	sensor_stats_s stats[max_accel_sens];
+
+	for (unsigned s = 0; s < max_accel_sens; s++) {
+		sensor_stats_reset(stats[s]);
+	}
 
 	unsigned errcount = 0;
 	struct sensor_correction_s sensor_correction; /**< sensor thermal corrections */
@@ -618,41 +629,25 @@ calibrate_return read_accelerometer_avg(int sensor_correction_sub, int (&subs)[m
 		}
 	}
 
+	/* thermal offset corrections of each instance */
+	const float *correction_offset[max_accel_sens] = {sensor_correction.accel_offset_0, sensor_correction.accel_offset_1, sensor_correction.accel_offset_2};
+
 	/* use the first sensor to pace the readout, but do per-sensor counts */
-	while (counts[0] < samples_num) {
+	while (stats[0].count < samples_num) {
 		int poll_ret = px4_poll(&fds[0], max_accel_sens, 1000);
 
 		if (poll_ret > 0) {
 
+			// the poll result tells which instances have new data, read all of them in this pass
 			for (unsigned s = 0; s < max_accel_sens; s++) {
-				bool changed;
-				orb_check(subs[s], &changed);
-
-				if (changed) {
+				if (fds[s].revents & POLLIN) {
 
 					struct accel_report arp;
 					orb_copy(ORB_ID(sensor_accel), subs[s], &arp);
 
 					// Apply thermal offset corrections in sensor/board frame
-					if (s == 0) {
-						accel_sum[s][0] += (arp.x - sensor_correction.accel_offset_0[0]);
-						accel_sum[s][1] += (arp.y - sensor_correction.accel_offset_0[1]);
-						accel_sum[s][2] += (arp.z - sensor_correction.accel_offset_0[2]);
-					} else if (s == 1) {
-						accel_sum[s][0] += (arp.x - sensor_correction.accel_offset_1[0]);
-						accel_sum[s][1] += (arp.y - sensor_correction.accel_offset_1[1]);
-						accel_sum[s][2] += (arp.z - sensor_correction.accel_offset_1[2]);
-					} else if (s == 2) {
-						accel_sum[s][0] += (arp.x - sensor_correction.accel_offset_2[0]);
-						accel_sum[s][1] += (arp.y - sensor_correction.accel_offset_2[1]);
-						accel_sum[s][2] += (arp.z - sensor_correction.accel_offset_2[2]);
-					} else {
-						accel_sum[s][0] += arp.x;
-						accel_sum[s][1] += arp.y;
-						accel_sum[s][2] += arp.z;
-					}
-
-					counts[s]++;
+					sensor_stats_add_sample(stats[s], arp.x - correction_offset[s][0], arp.y - correction_offset[s][1],
+								arp.z - correction_offset[s][2]);
 				}
 			}
 
@@ -667,15 +662,28 @@ calibrate_return read_accelerometer_avg(int sensor_correction_sub, int (&subs)[m
 	}
 
 	// rotate sensor measurements from sensor to body frame using board rotation matrix
-	for (unsigned i = 0; i < max_accel_sens; i++) {
-		math::Vector<3> accel_sum_vec(&accel_sum[i][0]);
-		accel_sum_vec = board_rotation * accel_sum_vec;
-		memcpy(&accel_sum[i][0], &accel_sum_vec.data[0], sizeof(accel_sum[i]));
-	}
-
 	for (unsigned s = 0; s < max_accel_sens; s++) {
-		for (unsigned i = 0; i < 3; i++) {
-			accel_avg[s][orient][i] = accel_sum[s][i] / counts[s];
+		if (stats[s].count == 0) {
+			// inactive instance
+			for (unsigned i = 0; i < 3; i++) {
+				accel_avg[s][orient][i] = NAN;
+			}
+
+			continue;
+		}
+
+		math::Vector<3> accel_avg_vec(&stats[s].mean[0]);
+		accel_avg_vec = board_rotation * accel_avg_vec;
+		memcpy(&accel_avg[s][orient][0], &accel_avg_vec.data[0], sizeof(accel_avg[s][orient]));
+
+		if (dispersion != nullptr) {
+			float variance = 0.0f;
+
+			for (unsigned i = 0; i < 3; i++) {
+				variance += sensor_stats_variance(stats[s], i);
+			}
+
+			dispersion[s] = sqrtf(variance);
 		}
 	}
 
@@ -527,6 +527,234 @@ int run_lm_ellipsoid_fit(const float x[], const float y[], const float z[], floa
 	}
 }
 
+void ellipsoid_fit_reset(ellipsoid_fit_state_s &state)
+{
+	memset(&state, 0, sizeof(state));
+}
+
+void ellipsoid_fit_add_sample(ellipsoid_fit_state_s &state, float x, float y, float z, float forgetting_factor)
+{
+	const float row[9] = {x * x, y * y, z * z, 2.0f * x * y, 2.0f * x * z, 2.0f * y * z, 2.0f * x, 2.0f * y, 2.0f * z};
+
+	// only the upper triangle is accumulated, the matrix is symmetric
+	for (uint8_t i = 0; i < 9; i++) {
+		for (uint8_t j = i; j < 9; j++) {
+			state.ata[i * 9 + j] = forgetting_factor * state.ata[i * 9 + j] + row[i] * row[j];
+		}
+
+		state.atb[i] = forgetting_factor * state.atb[i] + row[i];
+	}
+
+	const float sphere_row[4] = {2.0f * x, 2.0f * y, 2.0f * z, 1.0f};
+	const float length_squared = x * x + y * y + z * z;
+
+	for (uint8_t i = 0; i < 4; i++) {
+		for (uint8_t j = 0; j < 4; j++) {
+			state.sphere_ata[i * 4 + j] = forgetting_factor * state.sphere_ata[i * 4 + j] + sphere_row[i] * sphere_row[j];
+		}
+
+		state.sphere_atb[i] = forgetting_factor * state.sphere_atb[i] + sphere_row[i] * length_squared;
+	}
+
+	state.count++;
+}
+
+static int sphere_fit_solve(const ellipsoid_fit_state_s &state, float *offset_x, float *offset_y, float *offset_z,
+			    float *sphere_radius, float *diag_x, float *diag_y, float *diag_z, float *offdiag_x, float *offdiag_y,
+			    float *offdiag_z)
+{
+	float ata_inv[16];
+	memcpy(ata_inv, state.sphere_ata, sizeof(ata_inv));
+
+	if (state.count < 4 || !mat_inverse(ata_inv, ata_inv, 4)) {
+		return 1;
+	}
+
+	float v[4] = {};
+
+	for (uint8_t i = 0; i < 4; i++) {
+		for (uint8_t j = 0; j < 4; j++) {
+			v[i] += ata_inv[i * 4 + j] * state.sphere_atb[j];
+		}
+	}
+
+	// |x - center|^2 = r^2: d = r^2 - |center|^2
+	const float radius_squared = v[3] + v[0] * v[0] + v[1] * v[1] + v[2] * v[2];
+
+	if (!PX4_ISFINITE(radius_squared) || radius_squared <= 0.0f) {
+		return 1;
+	}
+
+	*offset_x = v[0];
+	*offset_y = v[1];
+	*offset_z = v[2];
+	*sphere_radius = sqrtf(radius_squared);
+	*diag_x = 1.0f;
+	*diag_y = 1.0f;
+	*diag_z = 1.0f;
+	*offdiag_x = 0.0f;
+	*offdiag_y = 0.0f;
+	*offdiag_z = 0.0f;
+
+	return 0;
+}
+
+static int ellipsoid_fit_solve_ellipsoid(const ellipsoid_fit_state_s &state, float *offset_x, float *offset_y,
+		float *offset_z, float *sphere_radius, float *diag_x, float *diag_y, float *diag_z, float *offdiag_x,
+		float *offdiag_y, float *offdiag_z)
+{
+	if (state.count < 9) {
+		return 1;
+	}
+
+	// solve the normal equations for the ellipsoid parameters
+	float ata_inv[81];
+
+	for (uint8_t i = 0; i < 9; i++) {
+		for (uint8_t j = 0; j < 9; j++) {
+			ata_inv[i * 9 + j] = (j >= i) ? state.ata[i * 9 + j] : state.ata[j * 9 + i];
+		}
+	}
+
+	if (!mat_inverse(ata_inv, ata_inv, 9)) {
+		return 1;
+	}
+
+	float v[9] = {};
+
+	for (uint8_t i = 0; i < 9; i++) {
+		for (uint8_t j = 0; j < 9; j++) {
+			v[i] += ata_inv[i * 9 + j] * state.atb[j];
+		}
+	}
+
+	// x^T M x + 2 b^T x = 1: the center is -M^-1 b
+	const float M_data[3][3] = {
+		{v[0], v[3], v[4]},
+		{v[3], v[1], v[5]},
+		{v[4], v[5], v[2]}
+	};
+	math::Matrix<3, 3> M(M_data);
+	const math::Vector<3> b(v[6], v[7], v[8]);
+
+	float M_inv_data[9];
+	memcpy(M_inv_data, M.data, sizeof(M_inv_data));
+
+	if (!mat_inverse(M_inv_data, M_inv_data, 3)) {
+		return 1;
+	}
+
+	const math::Matrix<3, 3> M_inv(M_inv_data);
+	const math::Vector<3> center = -(M_inv * b);
+
+	// (x - center)^T M (x - center) = 1 + center^T M center
+	const float k = 1.0f + center * (M * center);
+
+	if (!PX4_ISFINITE(k) || k <= 0.0f) {
+		return 1;
+	}
+
+	M = M / k;
+
+	// M must be positive definite (leading principal minors)
+	const float det = M(0, 0) * (M(1, 1) * M(2, 2) - M(1, 2) * M(2, 1))
+			  - M(0, 1) * (M(1, 0) * M(2, 2) - M(1, 2) * M(2, 0))
+			  + M(0, 2) * (M(1, 0) * M(2, 1) - M(1, 1) * M(2, 0));
+
+	if (M(0, 0) <= 0.0f || M(0, 0) * M(1, 1) - M(0, 1) * M(1, 0) <= 0.0f || det <= 0.0f) {
+		return 1;
+	}
+
+	// the sphere with the same volume as the ellipsoid: the correction does not change the scale
+	const float radius = powf(det, -1.0f / 6.0f);
+
+	// the symmetric correction W maps the ellipsoid onto the sphere: W^T W = radius^2 M,
+	// W = sqrt(radius^2 M) (Denman-Beavers iteration, radius^2 M is close to identity)
+	math::Matrix<3, 3> Y = M * (radius * radius);
+	math::Matrix<3, 3> Z;
+	Z.identity();
+
+	for (int i = 0; i < 20; i++) {
+		float Y_inv[9];
+		float Z_inv[9];
+		memcpy(Y_inv, Y.data, sizeof(Y_inv));
+		memcpy(Z_inv, Z.data, sizeof(Z_inv));
+
+		if (!mat_inverse(Y_inv, Y_inv, 3) || !mat_inverse(Z_inv, Z_inv, 3)) {
+			return 1;
+		}
+
+		const math::Matrix<3, 3> Y_next = (Y + math::Matrix<3, 3>(Z_inv)) * 0.5f;
+		Z = (Z + math::Matrix<3, 3>(Y_inv)) * 0.5f;
+
+		const math::Matrix<3, 3> step = Y_next - Y;
+		Y = Y_next;
+
+		float change = 0.0f;
+
+		for (uint8_t j = 0; j < 9; j++) {
+			change += fabsf(step.data[j / 3][j % 3]);
+		}
+
+		if (change < 1e-6f) {
+			break;
+		}
+	}
+
+	*offset_x = center(0);
+	*offset_y = center(1);
+	*offset_z = center(2);
+	*sphere_radius = radius;
+	*diag_x = Y(0, 0);
+	*diag_y = Y(1, 1);
+	*diag_z = Y(2, 2);
+	*offdiag_x = Y(0, 1);
+	*offdiag_y = Y(0, 2);
+	*offdiag_z = Y(1, 2);
+
+	return 0;
+}
+
+int ellipsoid_fit_solve(const ellipsoid_fit_state_s &state, bool sphere_only, float *offset_x, float *offset_y,
+			float *offset_z, float *sphere_radius, float *diag_x, float *diag_y, float *diag_z, float *offdiag_x,
+			float *offdiag_y, float *offdiag_z)
+{
+	if (!sphere_only && ellipsoid_fit_solve_ellipsoid(state, offset_x, offset_y, offset_z, sphere_radius,
+			diag_x, diag_y, diag_z, offdiag_x, offdiag_y, offdiag_z) == 0) {
+		return 0;
+	}
+
+	return sphere_fit_solve(state, offset_x, offset_y, offset_z, sphere_radius, diag_x, diag_y, diag_z,
+				offdiag_x, offdiag_y, offdiag_z);
+}
+
+void sensor_stats_reset(sensor_stats_s &stats)
+{
+	memset(&stats, 0, sizeof(stats));
+}
+
+void sensor_stats_add_sample(sensor_stats_s &stats, float x, float y, float z)
+{
+	const float sample[3] = {x, y, z};
+
+	stats.count++;
+
+	for (unsigned i = 0; i < 3; i++) {
+		const float delta = sample[i] - stats.mean[i];
+		stats.mean[i] += delta / stats.count;
+		stats.m2[i] += delta * (sample[i] - stats.mean[i]);
+	}
+}
+
+float sensor_stats_variance(const sensor_stats_s &stats, unsigned axis)
+{
+	if (stats.count < 2) {
+		return 0.0f;
+	}
+
+	return stats.m2[axis] / (stats.count - 1);
+}
+
 enum detect_orientation_return detect_orientation(orb_advert_t *mavlink_log_pub, int cancel_sub, int accel_sub,
 		bool lenient_still_position)
 {
@@ -69,6 +69,61 @@ int run_lm_ellipsoid_fit(const float x[], const float y[], const float z[], floa
 		      unsigned int size, float *offset_x, float *offset_y, float *offset_z,
 		      float *sphere_radius, float *diag_x, float *diag_y, float *diag_z, float *offdiag_x, float *offdiag_y,
 		      float *offdiag_z);
+
+/**
+ * State of a streaming least-squares ellipsoid fit.
+ *
+ * The samples are accumulated into the normal equations of the algebraic ellipsoid fit
+ * (a x^2 + b y^2 + c z^2 + 2d xy + 2e xz + 2f yz + 2g x + 2h y + 2i z = 1), and of the
+ * sphere fit (2ax + 2by + 2cz + d = x^2 + y^2 + z^2) as a fallback, so the memory does not
+ * depend on the number of samples and adding a sample is O(1).
+ */
+struct ellipsoid_fit_state_s {
+	float ata[9 * 9];	///< D^T D of the sample rows D = [x^2 y^2 z^2 2xy 2xz 2yz 2x 2y 2z]
+	float atb[9];		///< D^T 1
+	float sphere_ata[4 * 4];	///< S^T S of the sample rows S = [2x 2y 2z 1]
+	float sphere_atb[4];		///< S^T (x^2 + y^2 + z^2)
+	unsigned count;
+};
+
+void ellipsoid_fit_reset(ellipsoid_fit_state_s &state);
+
+/**
+ * Add a sample to the fit.
+ *
+ * @param forgetting_factor weight of the previous samples, 1 for a batch fit. A value below 1
+ *	makes the fit a recursive least-squares estimate that tracks a slowly changing calibration.
+ */
+void ellipsoid_fit_add_sample(ellipsoid_fit_state_s &state, float x, float y, float z, float forgetting_factor = 1.0f);
+
+/**
+ * Solve the fit for the calibration, in the format of ellipsoid_fit_least_squares(): the
+ * symmetric matrix (diag, offdiag) maps the offset-free samples onto a sphere of sphere_radius.
+ * If the samples do not describe an ellipsoid, or sphere_only is set (samples that do not
+ * cover all directions), the result of the sphere fit is returned, with an identity matrix.
+ *
+ * @return 0 on success, 1 on failure
+ */
+int ellipsoid_fit_solve(const ellipsoid_fit_state_s &state, bool sphere_only, float *offset_x, float *offset_y, float *offset_z,
+			float *sphere_radius, float *diag_x, float *diag_y, float *diag_z, float *offdiag_x, float *offdiag_y,
+			float *offdiag_z);
+
+/**
+ * Running mean and variance of a 3D sensor signal (Welford's algorithm), so that sensor
+ * samples can be reduced as they are read, without storing them or summing large values.
+ */
+struct sensor_stats_s {
+	float mean[3];
+	float m2[3];	///< sum of the squared differences from the mean
+	unsigned count;
+};
+
+void sensor_stats_reset(sensor_stats_s &stats);
+void sensor_stats_add_sample(sensor_stats_s &stats, float x, float y, float z);
+
+/// @return the sample variance of an axis, 0 for less than 2 samples
+float sensor_stats_variance(const sensor_stats_s &stats, unsigned axis);
+
 bool inverse4x4(float m[], float invOut[]);
 bool mat_inverse(float* A, float* inv, uint8_t n);
 
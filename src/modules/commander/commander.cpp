@@ -258,6 +258,22 @@ static bool _last_condition_global_position_valid = false;
 
 static struct vehicle_land_detected_s land_detector = {};
 
+/**
+ * Inputs of set_nav_state() as of its last evaluation. It only needs to run again when they change.
+ */
+struct nav_state_inputs_s {
+	struct vehicle_status_s status;
+	struct actuator_armed_s armed;
+	struct commander_state_s internal_state;
+	struct status_flags_s status_flags;
+	bool mission_finished;
+	bool stay_in_failsafe;
+	bool landed;
+	bool valid;		///< cleared to force an evaluation (e.g. after a parameter change)
+};
+
+static struct nav_state_inputs_s nav_state_inputs = {};
+
 /**
  * The daemon app only briefly exists to start
  * the background job. The stack size assigned in the
@@ -332,6 +348,12 @@ static void answer_command(struct vehicle_command_s &cmd, unsigned result,
 /* publish vehicle status flags from the global variable status_flags*/
 static void publish_status_flags(orb_advert_t &vehicle_status_flags_pub);
 
+/**
+ * Compare the current inputs of set_nav_state() with the stored ones (timestamps excluded) and store them.
+ * @return true if they changed
+ */
+static bool update_nav_state_inputs(bool mission_finished, bool stay_in_failsafe, bool landed);
+
 
 static int power_button_state_notification_cb(board_power_button_state_notification_e request)
 {
@@ -1520,7 +1542,8 @@ int commander_thread_main(int argc, char *argv[])
 	int ret;
 
 	/* Start monitoring loop */
-	unsigned counter = 0;
+	unsigned counter = 0;	///< monitoring ticks, the loop can run more often (see the poll at the end of the loop)
+	hrt_abstime last_monitoring_tick = 0;
 	unsigned stick_off_counter = 0;
 	unsigned stick_on_counter = 0;
 
@@ -1652,6 +1675,21 @@ int commander_thread_main(int argc, char *argv[])
 	int cpuload_sub = orb_subscribe(ORB_ID(cpuload));
 	memset(&cpuload, 0, sizeof(cpuload));
 
+	/* Topics that wake up the main loop before the next monitoring tick. These are
+	 * events that trigger a state change (commands, landing, safety switch, mission and
+	 * geofence failsafes), so the reaction is not delayed by the loop period. The
+	 * loop copies them, so that the poll only returns for new updates. */
+	px4_pollfd_struct_t wakeup_fds[5] = {};
+	wakeup_fds[0].fd = cmd_sub;
+	wakeup_fds[1].fd = land_detector_sub;
+	wakeup_fds[2].fd = safety_sub;
+	wakeup_fds[3].fd = mission_result_sub;
+	wakeup_fds[4].fd = geofence_result_sub;
+
+	for (unsigned i = 0; i < sizeof(wakeup_fds) / sizeof(wakeup_fds[0]); i++) {
+		wakeup_fds[i].events = POLLIN;
+	}
+
 	control_status_leds(&status, &armed, true, &battery, &cpuload);
 
 	/* Get parameter values controlloing activation of position failure failsafe and convert to required units*/
@@ -1777,6 +1815,13 @@ int commander_thread_main(int argc, char *argv[])
 
 	while (!thread_should_exit) {
 
+		/* everything counted in loop iterations only advances on monitoring ticks */
+		const bool monitoring_tick = hrt_elapsed_time(&last_monitoring_tick) >= COMMANDER_MONITORING_INTERVAL;
+
+		if (monitoring_tick) {
+			last_monitoring_tick = hrt_absolute_time();
+		}
+
 		arming_ret = TRANSITION_NOT_CHANGED;
 
 		/* update parameters */
@@ -1889,6 +1934,9 @@ int commander_thread_main(int argc, char *argv[])
 			/* failsafe response to loss of navigation accuracy */
 			param_get(_param_posctl_nav_loss_act, &posctl_nav_loss_act);
 
+			/* the failsafe actions are inputs of the navigation state */
+			nav_state_inputs.valid = false;
+
 			param_init_forced = false;
 		}
 
@@ -2619,7 +2667,7 @@ int commander_thread_main(int argc, char *argv[])
 				flight_termination_printed = true;
 			}
 
-			if (counter % (1000000 / COMMANDER_MONITORING_INTERVAL) == 0) {
+			if (monitoring_tick && counter % (1000000 / COMMANDER_MONITORING_INTERVAL) == 0) {
 				mavlink_log_critical(&mavlink_log_pub, "Flight termination active");
 			}
 		}
@@ -2706,7 +2754,9 @@ int commander_thread_main(int argc, char *argv[])
 									     arm_requirements,
 									     hrt_elapsed_time(&commander_boot_timestamp));
 				}
-				stick_off_counter++;
+				if (monitoring_tick) {
+					stick_off_counter++;
+				}
 			/* do not reset the counter when holding the arm button longer than needed */
 			} else if (!(arm_switch_is_button == 1 && sp_man.arm_switch == manual_control_setpoint_s::SWITCH_POS_ON)) {
 				stick_off_counter = 0;
@@ -2762,7 +2812,9 @@ int commander_thread_main(int argc, char *argv[])
 						}
 					}
 				}
-				stick_on_counter++;
+				if (monitoring_tick) {
+					stick_on_counter++;
+				}
 			/* do not reset the counter when holding the arm button longer than needed */
 			} else if (!(arm_switch_is_button == 1 && sp_man.arm_switch == manual_control_setpoint_s::SWITCH_POS_ON)) {
 				stick_on_counter = 0;
@@ -2983,7 +3035,7 @@ int commander_thread_main(int argc, char *argv[])
 					flight_termination_printed = true;
 				}
 
-				if (counter % (1000000 / COMMANDER_MONITORING_INTERVAL) == 0) {
+				if (monitoring_tick && counter % (1000000 / COMMANDER_MONITORING_INTERVAL) == 0) {
 					mavlink_log_critical(&mavlink_log_pub, "DL and GPS lost: flight termination");
 				}
 			}
@@ -3008,7 +3060,7 @@ int commander_thread_main(int argc, char *argv[])
 					flight_termination_printed = true;
 				}
 
-				if (counter % (1000000 / COMMANDER_MONITORING_INTERVAL) == 0) {
+				if (monitoring_tick && counter % (1000000 / COMMANDER_MONITORING_INTERVAL) == 0) {
 					mavlink_log_critical(&mavlink_log_pub, "RC and GPS lost: flight termination");
 				}
 			}
@@ -3042,20 +3094,27 @@ int commander_thread_main(int argc, char *argv[])
 
 		was_armed = armed.armed;
 
-		/* now set navigation state according to failsafe and main state */
-		bool nav_state_changed = set_nav_state(&status,
-											   &armed,
-											   &internal_state,
-											   &mavlink_log_pub,
-											   (link_loss_actions_t)datalink_loss_act,
-											   _mission_result.finished,
-											   _mission_result.stay_in_failsafe,
-											   &status_flags,
-											   land_detector.landed,
-											   (link_loss_actions_t)rc_loss_act,
-											   offboard_loss_act,
-											   offboard_loss_rc_act,
-											   posctl_nav_loss_act);
+		/* now set navigation state according to failsafe and main state, if any of the inputs changed */
+		bool nav_state_changed = false;
+
+		if (update_nav_state_inputs(_mission_result.finished, _mission_result.stay_in_failsafe, land_detector.landed)) {
+			nav_state_changed = set_nav_state(&status,
+							  &armed,
+							  &internal_state,
+							  &mavlink_log_pub,
+							  (link_loss_actions_t)datalink_loss_act,
+							  _mission_result.finished,
+							  _mission_result.stay_in_failsafe,
+							  &status_flags,
+							  land_detector.landed,
+							  (link_loss_actions_t)rc_loss_act,
+							  offboard_loss_act,
+							  offboard_loss_rc_act,
+							  posctl_nav_loss_act);
+
+			/* store the evaluated state: evaluating it again with the same inputs gives the same result */
+			update_nav_state_inputs(_mission_result.finished, _mission_result.stay_in_failsafe, land_detector.landed);
+		}
 
 		if (status.failsafe != failsafe_old)
 		{
@@ -3078,7 +3137,7 @@ int commander_thread_main(int argc, char *argv[])
 		}
 
 		/* publish states (armed, control mode, vehicle status) at least with 5 Hz */
-		if (counter % (200000 / COMMANDER_MONITORING_INTERVAL) == 0 || status_changed) {
+		if ((monitoring_tick && counter % (200000 / COMMANDER_MONITORING_INTERVAL) == 0) || status_changed) {
 			set_control_mode();
 			control_mode.timestamp = now;
 			orb_publish(ORB_ID(vehicle_control_mode), control_mode_pub, &control_mode);
@@ -3153,20 +3212,22 @@ int commander_thread_main(int argc, char *argv[])
 			status_changed = true;
 		}
 
-		counter++;
+		if (monitoring_tick) {
+			counter++;
 
-		int blink_state = blink_msg_state();
+			int blink_state = blink_msg_state();
 
-		if (blink_state > 0) {
-			/* blinking LED message, don't touch LEDs */
-			if (blink_state == 2) {
-				/* blinking LED message completed, restore normal state */
-				control_status_leds(&status, &armed, true, &battery, &cpuload);
-			}
+			if (blink_state > 0) {
+				/* blinking LED message, don't touch LEDs */
+				if (blink_state == 2) {
+					/* blinking LED message completed, restore normal state */
+					control_status_leds(&status, &armed, true, &battery, &cpuload);
+				}
 
-		} else {
-			/* normal state */
-			control_status_leds(&status, &armed, status_changed, &battery, &cpuload);
+			} else {
+				/* normal state */
+				control_status_leds(&status, &armed, status_changed, &battery, &cpuload);
+			}
 		}
 
 		status_changed = false;
@@ -3189,7 +3250,12 @@ int commander_thread_main(int argc, char *argv[])
 
 		arm_auth_update(now);
 
-		usleep(COMMANDER_MONITORING_INTERVAL);
+		/* wait for the next monitoring tick or an event, whichever comes first */
+		const hrt_abstime since_tick = hrt_elapsed_time(&last_monitoring_tick);
+		const int timeout_ms = (since_tick < COMMANDER_MONITORING_INTERVAL) ?
+				       (COMMANDER_MONITORING_INTERVAL - since_tick + 999) / 1000 : 0;
+
+		px4_poll(wakeup_fds, sizeof(wakeup_fds) / sizeof(wakeup_fds[0]), timeout_ms);
 	}
 
 	/* wait for threads to complete */
@@ -4404,6 +4470,28 @@ void *commander_low_prio_loop(void *arg)
 	return nullptr;
 }
 
+bool update_nav_state_inputs(bool mission_finished, bool stay_in_failsafe, bool landed)
+{
+	struct nav_state_inputs_s inputs;
+	memset(&inputs, 0, sizeof(inputs)); // compared with memcmp, clear the padding
+
+	memcpy(&inputs.status, &status, sizeof(inputs.status));
+	memcpy(&inputs.armed, &armed, sizeof(inputs.armed));
+	memcpy(&inputs.internal_state, &internal_state, sizeof(inputs.internal_state));
+	memcpy(&inputs.status_flags, &status_flags, sizeof(inputs.status_flags));
+	inputs.status.timestamp = 0;
+	inputs.armed.timestamp = 0;
+	inputs.internal_state.timestamp = 0;
+	inputs.mission_finished = mission_finished;
+	inputs.stay_in_failsafe = stay_in_failsafe;
+	inputs.landed = landed;
+	inputs.valid = true;
+
+	const bool changed = memcmp(&inputs, &nav_state_inputs, sizeof(inputs)) != 0;
+	memcpy(&nav_state_inputs, &inputs, sizeof(inputs));
+	return changed;
+}
+
 void publish_status_flags(orb_advert_t &vehicle_status_flags_pub) {
 	struct vehicle_status_flags_s v_flags;
 	memset(&v_flags, 0, sizeof(v_flags));
@@ -77,10 +77,14 @@ typedef struct  {
 static calibrate_return gyro_calibration_worker(int cancel_sub, void* data)
 {
 	gyro_worker_data_t*	worker_data = (gyro_worker_data_t*)(data);
-	unsigned		calibration_counter[max_gyros] = { 0 }, slow_count = 0;
+	unsigned		slow_count = 0;
 	const unsigned		calibration_count = 5000;
 	struct gyro_report	gyro_report;
 	unsigned		poll_errcount = 0;
+	sensor_stats_s		stats[max_gyros];
+
+	/* maximum standard deviation of the samples of a gyro at rest, in rad/s */
+	const float		max_still_stddev = 0.1f;
 
 	struct sensor_correction_s sensor_correction; /**< sensor thermal corrections */
 	if (orb_copy(ORB_ID(sensor_correction), worker_data->sensor_correction_sub, &sensor_correction) != 0) {
@@ -93,10 +97,15 @@ static calibrate_return gyro_calibration_worker(int cancel_sub, void* data)
 		}
 	}
 
+	/* thermal corrections of each instance */
+	const float *correction_offset[max_gyros] = {sensor_correction.gyro_offset_0, sensor_correction.gyro_offset_1, sensor_correction.gyro_offset_2};
+	const float *correction_scale[max_gyros] = {sensor_correction.gyro_scale_0, sensor_correction.gyro_scale_1, sensor_correction.gyro_scale_2};
+
 	px4_pollfd_struct_t fds[max_gyros];
 	for (unsigned s = 0; s < max_gyros; s++) {
 		fds[s].fd = worker_data->gyro_sensor_sub[s];
 		fds[s].events = POLLIN;
+		sensor_stats_reset(stats[s]);
 	}
 
 	memset(&worker_data->gyro_report_0, 0, sizeof(worker_data->gyro_report_0));
@@ -121,59 +130,43 @@ static calibrate_return gyro_calibration_worker(int cancel_sub, void* data)
 		if (poll_ret > 0) {
 			unsigned update_count = calibration_count;
 			for (unsigned s = 0; s < max_gyros; s++) {
-				if (calibration_counter[s] >= calibration_count) {
-					// Skip if instance has enough samples
-					continue;
-				}
+				// the poll result tells which instances have new data, read all of them in this pass
+				if (stats[s].count < calibration_count && (fds[s].revents & POLLIN)) {
+					orb_copy(ORB_ID(sensor_gyro), worker_data->gyro_sensor_sub[s], &gyro_report);
 
-				bool changed;
-				orb_check(worker_data->gyro_sensor_sub[s], &changed);
+					const float x = (gyro_report.x - correction_offset[s][0]) * correction_scale[s][0];
+					const float y = (gyro_report.y - correction_offset[s][1]) * correction_scale[s][1];
+					const float z = (gyro_report.z - correction_offset[s][2]) * correction_scale[s][2];
 
-				if (changed) {
-					orb_copy(ORB_ID(sensor_gyro), worker_data->gyro_sensor_sub[s], &gyro_report);
+					sensor_stats_add_sample(stats[s], x, y, z);
 
 					if (s == 0) {
-						// take a working copy
-						worker_data->gyro_scale[s].x_offset += (gyro_report.x - sensor_correction.gyro_offset_0[0]) * sensor_correction.gyro_scale_0[0];
-						worker_data->gyro_scale[s].y_offset += (gyro_report.y - sensor_correction.gyro_offset_0[1]) * sensor_correction.gyro_scale_0[1];
-						worker_data->gyro_scale[s].z_offset += (gyro_report.z - sensor_correction.gyro_offset_0[2]) * sensor_correction.gyro_scale_0[2];
-
 						// take a reference copy of the primary sensor including correction for thermal drift
-						orb_copy(ORB_ID(sensor_gyro), worker_data->gyro_sensor_sub[s], &worker_data->gyro_report_0);
-						worker_data->gyro_report_0.x = (gyro_report.x - sensor_correction.gyro_offset_0[0]) * sensor_correction.gyro_scale_0[0];
-						worker_data->gyro_report_0.y = (gyro_report.y - sensor_correction.gyro_offset_0[1]) * sensor_correction.gyro_scale_0[1];
-						worker_data->gyro_report_0.z = (gyro_report.z - sensor_correction.gyro_offset_0[2]) * sensor_correction.gyro_scale_0[2];
-
-					} else if (s == 1) {
-						worker_data->gyro_scale[s].x_offset += (gyro_report.x - sensor_correction.gyro_offset_1[0]) * sensor_correction.gyro_scale_1[0];
-						worker_data->gyro_scale[s].y_offset += (gyro_report.y - sensor_correction.gyro_offset_1[1]) * sensor_correction.gyro_scale_1[1];
-						worker_data->gyro_scale[s].z_offset += (gyro_report.z - sensor_correction.gyro_offset_1[2]) * sensor_correction.gyro_scale_1[2];
-
-					} else if (s == 2) {
-						worker_data->gyro_scale[s].x_offset += (gyro_report.x - sensor_correction.gyro_offset_2[0]) * sensor_correction.gyro_scale_2[0];
-						worker_data->gyro_scale[s].y_offset += (gyro_report.y - sensor_correction.gyro_offset_2[1]) * sensor_correction.gyro_scale_2[1];
-						worker_data->gyro_scale[s].z_offset += (gyro_report.z - sensor_correction.gyro_offset_2[2]) * sensor_correction.gyro_scale_2[2];
-
-					} else {
-						worker_data->gyro_scale[s].x_offset += gyro_report.x;
-						worker_data->gyro_scale[s].y_offset += gyro_report.y;
-						worker_data->gyro_scale[s].z_offset += gyro_report.z;
-
+						worker_data->gyro_report_0 = gyro_report;
+						worker_data->gyro_report_0.x = x;
+						worker_data->gyro_report_0.y = y;
+						worker_data->gyro_report_0.z = z;
 					}
-
-					calibration_counter[s]++;
-
 				}
 
-				// Maintain the sample count of the slowest sensor 
-				if (calibration_counter[s] && calibration_counter[s] < update_count) {
-					update_count = calibration_counter[s];
+				// Maintain the sample count of the slowest sensor
+				if (stats[s].count && stats[s].count < update_count) {
+					update_count = stats[s].count;
 				}
 
 			}
 
 			if (update_count % (calibration_count / 20) == 0) {
 				calibration_log_info(worker_data->mavlink_log_pub, CAL_QGC_PROGRESS_MSG, (update_count * 100) / calibration_count);
+
+				// the dispersion shows motion before all samples are collected: retry early
+				for (unsigned s = 0; s < max_gyros; s++) {
+					for (unsigned axis = 0; axis < 3; axis++) {
+						if (sensor_stats_variance(stats[s], axis) > max_still_stddev * max_still_stddev) {
+							return calibrate_return_error;
+						}
+					}
+				}
 			}
 
 			// Propagate out the slowest sensor's count
@@ -192,14 +185,14 @@ static calibrate_return gyro_calibration_worker(int cancel_sub, void* data)
 	}
 
 	for (unsigned s = 0; s < max_gyros; s++) {
-		if (worker_data->device_id[s] != 0 && calibration_counter[s] < calibration_count / 2) {
+		if (worker_data->device_id[s] != 0 && stats[s].count < calibration_count / 2) {
 			calibration_log_critical(worker_data->mavlink_log_pub, "[cal] ERROR: missing data, sensor %d", s)
 			return calibrate_return_error;
 		}
 
-		worker_data->gyro_scale[s].x_offset /= calibration_counter[s];
-		worker_data->gyro_scale[s].y_offset /= calibration_counter[s];
-		worker_data->gyro_scale[s].z_offset /= calibration_counter[s];
+		worker_data->gyro_scale[s].x_offset = stats[s].mean[0];
+		worker_data->gyro_scale[s].y_offset = stats[s].mean[1];
+		worker_data->gyro_scale[s].z_offset = stats[s].mean[2];
 	}
 
 	return calibrate_return_ok;
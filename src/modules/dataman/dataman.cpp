@@ -52,21 +52,31 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <systemlib/err.h>
+#include <systemlib/mem_pool.h>
 #include <queue.h>
 #include <string.h>
 #include <semaphore.h>
 #include <unistd.h>
 #include <platforms/px4_getopt.h>
 #include <drivers/drv_hrt.h>
+#include <px4_time.h>
 
 #include "dataman.h"
 #include <systemlib/param/param.h>
+#include <uORB/uORB.h>
+#include <uORB/topics/actuator_armed.h>
 
 #if defined(FLASH_BASED_DATAMAN)
 #include <nuttx/clock.h>
 #include <nuttx/progmem.h>
 #endif
 
+#if defined(__PX4_POSIX) && !defined(__PX4_QURT)
+#define MMAP_BASED_DATAMAN
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
 
 __BEGIN_DECLS
 __EXPORT int dataman_main(int argc, char *argv[]);
@@ -80,6 +90,25 @@ static int  _file_clear(dm_item_t item);
 static int  _file_restart(dm_reset_reason reason);
 static int _file_initialize(unsigned max_offset);
 static void _file_shutdown();
+static int _file_wait(px4_sem_t *sem);
+
+/* File backend page cache */
+#define DM_FILE_CACHE_PAGE_SIZE 512	/* SD card sector size */
+#if defined(MEMORY_CONSTRAINED_SYSTEM)
+#define DM_FILE_CACHE_PAGES 2
+#else
+#define DM_FILE_CACHE_PAGES 8
+#endif
+#define DM_FILE_FLUSH_TIMEOUT_USEC 500000		/* write-back delay for DM_PERSIST_POWER_ON_RESET items */
+#define DM_FILE_FLUSH_TIMEOUT_VOLATILE_USEC 5000000	/* write-back delay for all other items */
+#define DM_FILE_ARMED_CHECK_INTERVAL_USEC 100000	/* check for a disarm while there is data to write back */
+
+typedef struct {
+	int offset;		/* file offset of the cached data, -1 if unused */
+	unsigned last_use;	/* for LRU replacement */
+	bool dirty;		/* the page has been modified and needs to be written back */
+	uint8_t data[DM_FILE_CACHE_PAGE_SIZE];
+} dm_file_cache_page_t;
 
 /* Private Ram based Operations */
 static ssize_t _ram_write(dm_item_t item, unsigned index, dm_persitence_t persistence, const void *buf,
@@ -104,6 +133,17 @@ static void _ram_flash_shutdown();
 static int _ram_flash_wait(px4_sem_t *sem);
 #endif
 
+#if defined(MMAP_BASED_DATAMAN)
+/* Private memory-mapped file based Operations (reads are done by the RAM backend) */
+static ssize_t _mmap_write(dm_item_t item, unsigned index, dm_persitence_t persistence, const void *buf,
+			   size_t count);
+static int  _mmap_clear(dm_item_t item);
+static int  _mmap_restart(dm_reset_reason reason);
+static int _mmap_initialize(unsigned max_offset);
+static void _mmap_shutdown();
+static int _mmap_wait(px4_sem_t *sem);
+#endif
+
 typedef struct dm_operations_t {
 	ssize_t (*write)(dm_item_t item, unsigned index, dm_persitence_t persistence, const void *buf, size_t count);
 	ssize_t (*read)(dm_item_t item, unsigned index, void *buf, size_t count);
@@ -121,7 +161,7 @@ static dm_operations_t dm_file_operations = {
 	.restart = _file_restart,
 	.initialize = _file_initialize,
 	.shutdown = _file_shutdown,
-	.wait = px4_sem_wait,
+	.wait = _file_wait,
 };
 
 static dm_operations_t dm_ram_operations = {
@@ -146,12 +186,35 @@ static dm_operations_t dm_ram_flash_operations = {
 };
 #endif
 
+#if defined(MMAP_BASED_DATAMAN)
+static dm_operations_t dm_mmap_operations = {
+	.write   = _mmap_write,
+	.read    = _ram_read,
+	.clear   = _mmap_clear,
+	.restart = _mmap_restart,
+	.initialize = _mmap_initialize,
+	.shutdown = _mmap_shutdown,
+	.wait = _mmap_wait,
+};
+#endif
+
 static dm_operations_t *g_dm_ops;
 
 static struct {
 	union {
 		struct {
 			int fd;
+			unsigned size;
+			dm_file_cache_page_t *cache; /* nullptr if it could not be allocated (uncached access) */
+			unsigned cache_use_count;
+			hrt_abstime flush_timeout_usec; /* write back the dirty pages at this time, 0 if there are none */
+			bool sync_pending; /* data has been written since the last fsync */
+			int armed_sub;
+			bool armed;
+			unsigned cache_hits;
+			unsigned cache_misses;
+			unsigned write_backs;
+			unsigned syncs;
 		} file;
 		struct {
 			uint8_t *data;
@@ -164,6 +227,19 @@ static struct {
 			/* sync above with RAM backend */
 			hrt_abstime flush_timeout_usec;
 		} ram_flash;
+#endif
+#if defined(MMAP_BASED_DATAMAN)
+		struct {
+			uint8_t *data;
+			uint8_t *data_end;
+			/* sync above with RAM backend */
+			int fd;
+			unsigned size;
+			unsigned sync_start; /* file range to msync, empty if sync_start >= sync_end */
+			unsigned sync_end;
+			hrt_abstime sync_timeout_usec; /* msync at this time, 0 if there is nothing to sync */
+			unsigned syncs;
+		} mmap;
 #endif
 	};
 	bool running;
@@ -175,6 +251,8 @@ typedef enum {
 	dm_read_func,
 	dm_clear_func,
 	dm_restart_func,
+	dm_write_range_func,
+	dm_read_range_func,
 	dm_number_of_funcs
 } dm_function_t;
 
@@ -182,9 +260,10 @@ typedef enum {
 typedef struct {
 	sq_entry_t link;	/**< list linkage */
 	px4_sem_t wait_sem;
-	unsigned char first;
 	unsigned char func;
 	ssize_t result;
+	dm_completion_callback_t callback;	/**< if set, called by the worker thread instead of posting wait_sem */
+	void *callback_arg;
 	union {
 		struct {
 			dm_item_t item;
@@ -205,11 +284,24 @@ typedef struct {
 		struct {
 			dm_reset_reason reason;
 		} restart_params;
+		struct {
+			dm_item_t item;
+			unsigned index;
+			unsigned count;
+			dm_persitence_t persistence;
+			const void *buf;
+			size_t item_len;
+		} write_range_params;
+		struct {
+			dm_item_t item;
+			unsigned index;
+			unsigned count;
+			void *buf;
+			size_t item_len;
+		} read_range_params;
 	};
 } work_q_item_t;
 
-const size_t k_work_item_allocation_chunk_size = 8;
-
 /* Usage statistics */
 static unsigned g_func_counts[dm_number_of_funcs];
 
@@ -263,6 +355,9 @@ static enum {
 	BACKEND_RAM,
 #if defined(FLASH_BASED_DATAMAN)
 	BACKEND_RAM_FLASH,
+#endif
+#if defined(MMAP_BASED_DATAMAN)
+	BACKEND_MMAP,
 #endif
 	BACKEND_LAST
 } backend = BACKEND_NONE;
@@ -276,7 +371,6 @@ typedef struct {
 	unsigned max_size;	/* Maximum queue size reached */
 } work_q_t;
 
-static work_q_t g_free_q;	/* queue of free work items. So that we don't always need to call malloc and free*/
 static work_q_t g_work_q;	/* pending work items. To be consumed by worker thread */
 
 static px4_sem_t g_work_queued_sema;	/* To notify worker thread a work item has been queued */
@@ -314,38 +408,8 @@ create_work_item()
 {
 	work_q_item_t *item;
 
-	/* Try to reuse item from free item queue */
-	lock_queue(&g_free_q);
-
-	if ((item = (work_q_item_t *)sq_remfirst(&(g_free_q.q)))) {
-		g_free_q.size--;
-	}
-
-	unlock_queue(&g_free_q);
-
-	/* If we there weren't any free items then obtain memory for a new ones */
-	if (item == nullptr) {
-		item = (work_q_item_t *)malloc(k_work_item_allocation_chunk_size * sizeof(work_q_item_t));
-
-		if (item) {
-			item->first = 1;
-			lock_queue(&g_free_q);
-
-			for (size_t i = 1; i < k_work_item_allocation_chunk_size; i++) {
-				(item + i)->first = 0;
-				sq_addfirst(&(item + i)->link, &(g_free_q.q));
-			}
-
-			/* Update the queue size and potentially the maximum queue size */
-			g_free_q.size += k_work_item_allocation_chunk_size - 1;
-
-			if (g_free_q.size > g_free_q.max_size) {
-				g_free_q.max_size = g_free_q.size;
-			}
-
-			unlock_queue(&g_free_q);
-		}
-	}
+	/* Work items come from the pool allocator, so that we don't fragment the heap */
+	item = (work_q_item_t *)mem_pool_alloc(sizeof(work_q_item_t));
 
 	/* If we got one then lock the item*/
 	if (item) {
@@ -354,6 +418,9 @@ create_work_item()
 		/* item->wait_sem use case is a signal */
 
 		px4_sem_setprotocol(&item->wait_sem, SEM_PRIO_NONE);
+
+		item->callback = nullptr;
+		item->callback_arg = nullptr;
 	}
 
 	/* return the item pointer, or nullptr if all failed */
@@ -366,16 +433,8 @@ static inline void
 destroy_work_item(work_q_item_t *item)
 {
 	px4_sem_destroy(&item->wait_sem); /* Destroy the item lock */
-	/* Return the item to the free item queue for later reuse */
-	lock_queue(&g_free_q);
-	sq_addfirst(&item->link, &(g_free_q.q));
-
-	/* Update the queue size and potentially the maximum queue size */
-	if (++g_free_q.size > g_free_q.max_size) {
-		g_free_q.max_size = g_free_q.size;
-	}
-
-	unlock_queue(&g_free_q);
+	/* Return the item to the pool for later reuse */
+	mem_pool_free(item, sizeof(work_q_item_t));
 }
 
 static inline work_q_item_t *
@@ -394,8 +453,8 @@ dequeue_work_item()
 	return work;
 }
 
-static int
-enqueue_work_item_and_wait_for_result(work_q_item_t *item)
+static void
+enqueue_work_item(work_q_item_t *item)
 {
 	/* put the work item at the end of the work queue */
 	lock_queue(&g_work_q);
@@ -410,6 +469,12 @@ enqueue_work_item_and_wait_for_result(work_q_item_t *item)
 
 	/* tell the work thread that work is available */
 	px4_sem_post(&g_work_queued_sema);
+}
+
+static int
+enqueue_work_item_and_wait_for_result(work_q_item_t *item)
+{
+	enqueue_work_item(item);
 
 	/* wait for the result */
 	px4_sem_wait(&item->wait_sem);
@@ -494,12 +559,226 @@ static ssize_t _ram_write(dm_item_t item, unsigned index, dm_persitence_t persis
 	return count;
 }
 
+/* Write a cached page back to the data manager file (without fsync) */
+static int
+_file_cache_write_back(dm_file_cache_page_t *page)
+{
+	if (!page->dirty) {
+		return 0;
+	}
+
+	unsigned len = DM_FILE_CACHE_PAGE_SIZE;
+
+	if (page->offset + len > dm_operations_data.file.size) {
+		len = dm_operations_data.file.size - page->offset;
+	}
+
+	if (lseek(dm_operations_data.file.fd, page->offset, SEEK_SET) != page->offset) {
+		return -1;
+	}
+
+	if (write(dm_operations_data.file.fd, page->data, len) != (ssize_t)len) {
+		return -1;
+	}
+
+	page->dirty = false;
+	dm_operations_data.file.sync_pending = true;
+	dm_operations_data.file.write_backs++;
+	return 0;
+}
+
+/* Write back all dirty pages in file order, and make sure the data is on the physical media if sync is set */
+static int
+_file_cache_flush(bool sync)
+{
+	int result = 0;
+	int last_offset = -1;
+
+	if (dm_operations_data.file.cache) {
+		while (true) {
+			dm_file_cache_page_t *next = nullptr;
+
+			for (unsigned i = 0; i < DM_FILE_CACHE_PAGES; i++) {
+				dm_file_cache_page_t *page = &dm_operations_data.file.cache[i];
+
+				if (page->dirty && page->offset > last_offset && (!next || page->offset < next->offset)) {
+					next = page;
+				}
+			}
+
+			if (!next) {
+				break;
+			}
+
+			/* Pages that fail are kept dirty and retried with the next flush */
+			if (_file_cache_write_back(next) != 0) {
+				result = -1;
+			}
+
+			last_offset = next->offset;
+		}
+	}
+
+	if (sync && dm_operations_data.file.sync_pending) {
+		fsync(dm_operations_data.file.fd);
+		dm_operations_data.file.sync_pending = false;
+		dm_operations_data.file.syncs++;
+	}
+
+	dm_operations_data.file.flush_timeout_usec = result == 0 ? 0 :
+			hrt_absolute_time() + DM_FILE_FLUSH_TIMEOUT_VOLATILE_USEC;
+	return result;
+}
+
+/* Drop all cached data without writing it back */
+static void
+_file_cache_invalidate()
+{
+	if (dm_operations_data.file.cache) {
+		for (unsigned i = 0; i < DM_FILE_CACHE_PAGES; i++) {
+			dm_operations_data.file.cache[i].offset = -1;
+			dm_operations_data.file.cache[i].last_use = 0;
+			dm_operations_data.file.cache[i].dirty = false;
+		}
+	}
+
+	dm_operations_data.file.cache_use_count = 0;
+	dm_operations_data.file.flush_timeout_usec = 0;
+}
+
+/* Get the cached page starting at offset, replacing the least recently used page on a miss */
+static dm_file_cache_page_t *
+_file_cache_get_page(int offset)
+{
+	dm_file_cache_page_t *page = &dm_operations_data.file.cache[0];
+
+	for (unsigned i = 0; i < DM_FILE_CACHE_PAGES; i++) {
+		dm_file_cache_page_t *candidate = &dm_operations_data.file.cache[i];
+
+		if (candidate->offset == offset) {
+			candidate->last_use = ++dm_operations_data.file.cache_use_count;
+			dm_operations_data.file.cache_hits++;
+			return candidate;
+		}
+
+		if (candidate->last_use < page->last_use) {
+			page = candidate;
+		}
+	}
+
+	dm_operations_data.file.cache_misses++;
+
+	if (_file_cache_write_back(page) != 0) {
+		return nullptr;
+	}
+
+	page->offset = -1;
+
+	unsigned len = DM_FILE_CACHE_PAGE_SIZE;
+
+	if (offset + len > dm_operations_data.file.size) {
+		len = dm_operations_data.file.size - offset;
+	}
+
+	ssize_t len_read = -1;
+
+	if (lseek(dm_operations_data.file.fd, offset, SEEK_SET) == offset) {
+		len_read = read(dm_operations_data.file.fd, page->data, len);
+	}
+
+	if (len_read < 0) {
+		return nullptr;
+	}
+
+	/* The part of the file that has never been written reads as empty entries */
+	memset(page->data + len_read, 0, DM_FILE_CACHE_PAGE_SIZE - len_read);
+
+	page->offset = offset;
+	page->last_use = ++dm_operations_data.file.cache_use_count;
+	return page;
+}
+
+/* Read or write count bytes at offset in the data manager file through the page cache */
+static int
+_file_cache_access(int offset, void *buf, size_t count, bool write_access)
+{
+	uint8_t *data = (uint8_t *)buf;
+
+	if (!dm_operations_data.file.cache) {
+		ssize_t len = -1;
+
+		if (lseek(dm_operations_data.file.fd, offset, SEEK_SET) == offset) {
+			if (write_access) {
+				if ((len = write(dm_operations_data.file.fd, data, count)) == (ssize_t)count) {
+					fsync(dm_operations_data.file.fd);        /* Make sure data is written to physical media */
+				}
+
+			} else {
+				len = read(dm_operations_data.file.fd, data, count);
+
+				/* A zero length entry is a empty entry */
+				if (len >= 0 && (size_t)len < count) {
+					memset(data + len, 0, count - len);
+					len = count;
+				}
+			}
+		}
+
+		return len == (ssize_t)count ? 0 : -1;
+	}
+
+	while (count > 0) {
+		const int page_offset = offset - (offset % DM_FILE_CACHE_PAGE_SIZE);
+		const size_t offset_in_page = offset - page_offset;
+		size_t len = DM_FILE_CACHE_PAGE_SIZE - offset_in_page;
+
+		if (len > count) {
+			len = count;
+		}
+
+		dm_file_cache_page_t *page = _file_cache_get_page(page_offset);
+
+		if (!page) {
+			return -1;
+		}
+
+		if (write_access) {
+			memcpy(page->data + offset_in_page, data, len);
+			page->dirty = true;
+
+		} else {
+			memcpy(data, page->data + offset_in_page, len);
+		}
+
+		offset += len;
+		data += len;
+		count -= len;
+	}
+
+	return 0;
+}
+
+/* Schedule the write-back of the written data, keeping the earliest deadline */
+static void
+_file_update_flush_timeout(hrt_abstime timeout_usec)
+{
+	if (!dm_operations_data.file.cache) {
+		/* uncached writes are synchronous */
+		return;
+	}
+
+	const hrt_abstime flush_time = hrt_absolute_time() + timeout_usec;
+
+	if (dm_operations_data.file.flush_timeout_usec == 0 || flush_time < dm_operations_data.file.flush_timeout_usec) {
+		dm_operations_data.file.flush_timeout_usec = flush_time;
+	}
+}
+
 /* write to the data manager file */
 static ssize_t
 _file_write(dm_item_t item, unsigned index, dm_persitence_t persistence, const void *buf, size_t count)
 {
 	unsigned char buffer[g_per_item_size[item]];
-	size_t len;
 	int offset;
 
 	/* Get the offset for this item */
@@ -527,20 +806,14 @@ _file_write(dm_item_t item, unsigned index, dm_persitence_t persistence, const v
 
 	count += DM_SECTOR_HDR_SIZE;
 
-	len = -1;
-
-	/* Seek to the right spot in the data manager file and write the data item */
-	if (lseek(dm_operations_data.file.fd, offset, SEEK_SET) == offset) {
-		if ((len = write(dm_operations_data.file.fd, buffer, count)) == count) {
-			fsync(dm_operations_data.file.fd);        /* Make sure data is written to physical media */
-		}
-	}
-
-	/* Make sure the write succeeded */
-	if (len != count) {
+	/* Put the data item into the cache, it is written to the file later */
+	if (_file_cache_access(offset, buffer, count, true) != 0) {
 		return -1;
 	}
 
+	_file_update_flush_timeout(persistence == DM_PERSIST_POWER_ON_RESET ? DM_FILE_FLUSH_TIMEOUT_USEC :
+				   DM_FILE_FLUSH_TIMEOUT_VOLATILE_USEC);
+
 	/* All is well... return the number of user data written */
 	return count - DM_SECTOR_HDR_SIZE;
 }
@@ -613,7 +886,7 @@ static ssize_t
 _file_read(dm_item_t item, unsigned index, void *buf, size_t count)
 {
 	unsigned char buffer[g_per_item_size[item]];
-	int len, offset;
+	int offset;
 
 	/* Get the offset for this item */
 	offset = calculate_offset(item, index);
@@ -629,20 +902,8 @@ _file_read(dm_item_t item, unsigned index, void *buf, size_t count)
 	}
 
 	/* Read the prefix and data */
-	len = -1;
-
-	if (lseek(dm_operations_data.file.fd, offset, SEEK_SET) == offset) {
-		len = read(dm_operations_data.file.fd, buffer, count + DM_SECTOR_HDR_SIZE);
-	}
-
-	/* Check for read error */
-	if (len < 0) {
-		return -errno;
-	}
-
-	/* A zero length entry is a empty entry */
-	if (len == 0) {
-		buffer[0] = 0;
+	if (_file_cache_access(offset, buffer, count + DM_SECTOR_HDR_SIZE, false) != 0) {
+		return errno ? -errno : -1;
 	}
 
 	/* See if we got data */
@@ -714,26 +975,17 @@ _file_clear(dm_item_t item)
 	for (i = 0; (unsigned)i < g_per_item_max_index[item]; i++) {
 		char buf[1];
 
-		if (lseek(dm_operations_data.file.fd, offset, SEEK_SET) != offset) {
-			result = -1;
-			break;
-		}
-
 		/* Avoid SD flash wear by only doing writes where necessary */
-		if (read(dm_operations_data.file.fd, buf, 1) < 1) {
+		if (_file_cache_access(offset, buf, 1, false) != 0) {
+			result = -1;
 			break;
 		}
 
 		/* If item has length greater than 0 it needs to be overwritten */
 		if (buf[0]) {
-			if (lseek(dm_operations_data.file.fd, offset, SEEK_SET) != offset) {
-				result = -1;
-				break;
-			}
-
 			buf[0] = 0;
 
-			if (write(dm_operations_data.file.fd, buf, 1) != 1) {
+			if (_file_cache_access(offset, buf, 1, true) != 0) {
 				result = -1;
 				break;
 			}
@@ -742,8 +994,7 @@ _file_clear(dm_item_t item)
 		offset += g_per_item_size[item];
 	}
 
-	/* Make sure data is actually written to physical media */
-	fsync(dm_operations_data.file.fd);
+	_file_update_flush_timeout(DM_FILE_FLUSH_TIMEOUT_USEC);
 	return result;
 }
 
@@ -813,16 +1064,9 @@ _file_restart(dm_reset_reason reason)
 	for (int item = (int)DM_KEY_SAFE_POINTS; item < (int)DM_KEY_NUM_KEYS; item++) {
 		for (unsigned i = 0; i < g_per_item_max_index[item]; i++) {
 			/* Get data segment at current offset */
-			if (lseek(dm_operations_data.file.fd, offset, SEEK_SET) != offset) {
-				result = -1;
-				item = DM_KEY_NUM_KEYS;
-				break;
-			}
-
 			uint8_t buffer[2];
-			ssize_t len = read(dm_operations_data.file.fd, buffer, sizeof(buffer));
 
-			if (len != sizeof(buffer)) {
+			if (_file_cache_access(offset, buffer, sizeof(buffer), false) != 0) {
 				result = -1;
 				item = DM_KEY_NUM_KEYS;
 				break;
@@ -846,17 +1090,9 @@ _file_restart(dm_reset_reason reason)
 
 				/* Set segment to unused if data does not persist */
 				if (clear_entry) {
-					if (lseek(dm_operations_data.file.fd, offset, SEEK_SET) != offset) {
-						result = -1;
-						item = DM_KEY_NUM_KEYS;
-						break;
-					}
-
 					buffer[0] = 0;
 
-					len = write(dm_operations_data.file.fd, buffer, 1);
-
-					if (len != 1) {
+					if (_file_cache_access(offset, buffer, 1, true) != 0) {
 						result = -1;
 						item = DM_KEY_NUM_KEYS;
 						break;
@@ -868,7 +1104,9 @@ _file_restart(dm_reset_reason reason)
 		}
 	}
 
-	fsync(dm_operations_data.file.fd);
+	if (_file_cache_flush(true) != 0) {
+		result = -1;
+	}
 
 	/* tell the caller how it went */
 	return result;
@@ -885,6 +1123,20 @@ _ram_flash_restart(dm_reset_reason reason)
 static int
 _file_initialize(unsigned max_offset)
 {
+	dm_operations_data.file.size = max_offset;
+	dm_operations_data.file.sync_pending = false;
+	dm_operations_data.file.cache_hits = 0;
+	dm_operations_data.file.cache_misses = 0;
+	dm_operations_data.file.write_backs = 0;
+	dm_operations_data.file.syncs = 0;
+	dm_operations_data.file.cache = (dm_file_cache_page_t *)malloc(DM_FILE_CACHE_PAGES * sizeof(dm_file_cache_page_t));
+
+	if (dm_operations_data.file.cache == nullptr) {
+		PX4_WARN("Could not allocate the cache, using uncached access");
+	}
+
+	_file_cache_invalidate();
+
 	/* See if the data manage file exists and is a multiple of the sector size */
 	dm_operations_data.file.fd = open(k_data_manager_device_path, O_RDONLY | O_BINARY);
 
@@ -902,6 +1154,7 @@ _file_initialize(unsigned max_offset)
 		}
 
 		close(dm_operations_data.file.fd);
+		_file_cache_invalidate();
 
 		if (incompat) {
 			unlink(k_data_manager_device_path);
@@ -913,12 +1166,14 @@ _file_initialize(unsigned max_offset)
 
 	if (dm_operations_data.file.fd < 0) {
 		PX4_WARN("Could not open data manager file %s", k_data_manager_device_path);
+		free(dm_operations_data.file.cache);
 		px4_sem_post(&g_init_sema); /* Don't want to hang startup */
 		return -1;
 	}
 
 	if ((unsigned)lseek(dm_operations_data.file.fd, max_offset, SEEK_SET) != max_offset) {
 		close(dm_operations_data.file.fd);
+		free(dm_operations_data.file.cache);
 		PX4_WARN("Could not seek data manager file %s", k_data_manager_device_path);
 		px4_sem_post(&g_init_sema); /* Don't want to hang startup */
 		return -1;
@@ -933,7 +1188,10 @@ _file_initialize(unsigned max_offset)
 		PX4_ERR("Failed writing compat: %d", ret);
 	}
 
-	fsync(dm_operations_data.file.fd);
+	_file_cache_flush(true);
+
+	dm_operations_data.file.armed_sub = orb_subscribe(ORB_ID(actuator_armed));
+	dm_operations_data.file.armed = false;
 	dm_operations_data.running = true;
 
 	return 0;
@@ -999,7 +1257,14 @@ _ram_flash_initialize(unsigned max_offset)
 static void
 _file_shutdown()
 {
+	if (_file_cache_flush(true) != 0) {
+		PX4_ERR("Failed writing back cached data");
+	}
+
+	orb_unsubscribe(dm_operations_data.file.armed_sub);
 	close(dm_operations_data.file.fd);
+	free(dm_operations_data.file.cache);
+	dm_operations_data.file.cache = nullptr;
 	dm_operations_data.running = false;
 }
 
@@ -1079,6 +1344,260 @@ _ram_flash_wait(px4_sem_t *sem)
 }
 #endif
 
+/* Returns true if the vehicle got disarmed since the last check */
+static bool
+_file_check_disarm()
+{
+	bool updated = false;
+
+	if (orb_check(dm_operations_data.file.armed_sub, &updated) != 0 || !updated) {
+		return false;
+	}
+
+	actuator_armed_s armed;
+
+	if (orb_copy(ORB_ID(actuator_armed), dm_operations_data.file.armed_sub, &armed) != 0) {
+		return false;
+	}
+
+	const bool was_armed = dm_operations_data.file.armed;
+	dm_operations_data.file.armed = armed.armed;
+	return was_armed && !armed.armed;
+}
+
+static int
+_file_wait(px4_sem_t *sem)
+{
+	if (!dm_operations_data.file.flush_timeout_usec) {
+		px4_sem_wait(sem);
+		return 0;
+	}
+
+	/* While there is data to write back, wake up regularly to check for a disarm */
+	const hrt_abstime now = hrt_absolute_time();
+
+	if (now < dm_operations_data.file.flush_timeout_usec) {
+		hrt_abstime timeout = dm_operations_data.file.flush_timeout_usec - now;
+
+		if (timeout > DM_FILE_ARMED_CHECK_INTERVAL_USEC) {
+			timeout = DM_FILE_ARMED_CHECK_INTERVAL_USEC;
+		}
+
+		struct timespec abstime;
+		px4_clock_gettime(CLOCK_REALTIME, &abstime);
+		const uint64_t nsecs = abstime.tv_nsec + timeout * 1000;
+		abstime.tv_sec += nsecs / 1000000000;
+		abstime.tv_nsec = nsecs % 1000000000;
+
+		px4_sem_timedwait(sem, &abstime);
+	}
+
+	/* A disarm forces the write-back, so that nothing is lost when the vehicle is powered off */
+	const bool disarmed = _file_check_disarm();
+
+	if (disarmed || hrt_absolute_time() >= dm_operations_data.file.flush_timeout_usec) {
+		if (_file_cache_flush(true) != 0) {
+			PX4_ERR("Failed writing back cached data");
+		}
+	}
+
+	return 0;
+}
+
+#if defined(MMAP_BASED_DATAMAN)
+/* Synchronously write the pending range of the mapping to the file */
+static int
+_mmap_sync()
+{
+	int result = 0;
+
+	if (dm_operations_data.mmap.sync_start < dm_operations_data.mmap.sync_end) {
+		/* msync needs a page aligned start address */
+		const unsigned page_size = sysconf(_SC_PAGESIZE);
+		const unsigned start = dm_operations_data.mmap.sync_start - dm_operations_data.mmap.sync_start % page_size;
+
+		if (msync(dm_operations_data.mmap.data + start, dm_operations_data.mmap.sync_end - start, MS_SYNC) != 0) {
+			result = -1;
+		}
+
+		dm_operations_data.mmap.syncs++;
+	}
+
+	dm_operations_data.mmap.sync_start = dm_operations_data.mmap.size;
+	dm_operations_data.mmap.sync_end = 0;
+	dm_operations_data.mmap.sync_timeout_usec = 0;
+	return result;
+}
+
+/* Mark a file range to be synced. Only data that has to survive a power cycle needs an msync: the kernel writes
+ * back the mapping anyway, so nothing is lost if only the process terminates. */
+static void
+_mmap_mark_for_sync(unsigned offset, unsigned len)
+{
+	if (offset < dm_operations_data.mmap.sync_start) {
+		dm_operations_data.mmap.sync_start = offset;
+	}
+
+	if (offset + len > dm_operations_data.mmap.sync_end) {
+		dm_operations_data.mmap.sync_end = offset + len;
+	}
+
+	if (!dm_operations_data.mmap.sync_timeout_usec) {
+		dm_operations_data.mmap.sync_timeout_usec = hrt_absolute_time() + DM_FILE_FLUSH_TIMEOUT_USEC;
+	}
+}
+
+static ssize_t
+_mmap_write(dm_item_t item, unsigned index, dm_persitence_t persistence, const void *buf, size_t count)
+{
+	ssize_t ret = dm_ram_operations.write(item, index, persistence, buf, count);
+
+	if (ret < 0) {
+		return ret;
+	}
+
+	if (persistence == DM_PERSIST_POWER_ON_RESET) {
+		_mmap_mark_for_sync(calculate_offset(item, index), g_per_item_size[item]);
+	}
+
+	return ret;
+}
+
+static int
+_mmap_clear(dm_item_t item)
+{
+	int ret = dm_ram_operations.clear(item);
+
+	if (ret < 0) {
+		return ret;
+	}
+
+	/* the cleared items might have been persistent */
+	_mmap_mark_for_sync(calculate_offset(item, 0), g_per_item_max_index[item] * g_per_item_size[item]);
+	return ret;
+}
+
+static int
+_mmap_restart(dm_reset_reason reason)
+{
+	int ret = dm_ram_operations.restart(reason);
+
+	_mmap_mark_for_sync(0, dm_operations_data.mmap.size);
+
+	if (_mmap_sync() != 0) {
+		ret = -1;
+	}
+
+	return ret;
+}
+
+static int
+_mmap_initialize(unsigned max_offset)
+{
+	dm_operations_data.mmap.size = max_offset;
+	dm_operations_data.mmap.syncs = 0;
+
+	/* Open or create the data manager file, it has the same layout as the one of the file backend */
+	dm_operations_data.mmap.fd = open(k_data_manager_device_path, O_RDWR | O_CREAT | O_BINARY, PX4_O_MODE_666);
+
+	if (dm_operations_data.mmap.fd < 0) {
+		PX4_WARN("Could not open data manager file %s", k_data_manager_device_path);
+		px4_sem_post(&g_init_sema); /* Don't want to hang startup */
+		return -1;
+	}
+
+	/* Extend (with zeros) or truncate the file to the required size, so that the whole mapping is backed */
+	struct stat st;
+
+	if (fstat(dm_operations_data.mmap.fd, &st) != 0 ||
+	    ((unsigned)st.st_size != max_offset && ftruncate(dm_operations_data.mmap.fd, max_offset) != 0)) {
+		close(dm_operations_data.mmap.fd);
+		PX4_WARN("Could not resize data manager file %s", k_data_manager_device_path);
+		px4_sem_post(&g_init_sema); /* Don't want to hang startup */
+		return -1;
+	}
+
+	void *data = mmap(nullptr, max_offset, PROT_READ | PROT_WRITE, MAP_SHARED, dm_operations_data.mmap.fd, 0);
+
+	if (data == MAP_FAILED) {
+		close(dm_operations_data.mmap.fd);
+		PX4_WARN("Could not map data manager file %s", k_data_manager_device_path);
+		px4_sem_post(&g_init_sema); /* Don't want to hang startup */
+		return -1;
+	}
+
+	dm_operations_data.mmap.data = (uint8_t *)data;
+	dm_operations_data.mmap.data_end = &dm_operations_data.mmap.data[max_offset - 1];
+	dm_operations_data.mmap.sync_start = max_offset;
+	dm_operations_data.mmap.sync_end = 0;
+	dm_operations_data.mmap.sync_timeout_usec = 0;
+
+	struct dataman_compat_s compat_state;
+	int ret = g_dm_ops->read(DM_KEY_COMPAT, 0, &compat_state, sizeof(compat_state));
+
+	if (ret != sizeof(compat_state) || compat_state.key != DM_COMPAT_KEY) {
+		/* Not compatible: clear the file and write the current compat info */
+		memset(dm_operations_data.mmap.data, 0, max_offset);
+		_mmap_mark_for_sync(0, max_offset);
+
+		compat_state.key = DM_COMPAT_KEY;
+		ret = g_dm_ops->write(DM_KEY_COMPAT, 0, DM_PERSIST_POWER_ON_RESET, &compat_state, sizeof(compat_state));
+
+		if (ret != sizeof(compat_state)) {
+			PX4_ERR("Failed writing compat: %d", ret);
+		}
+
+		_mmap_sync();
+	}
+
+	dm_operations_data.running = true;
+
+	return 0;
+}
+
+static void
+_mmap_shutdown()
+{
+	if (_mmap_sync() != 0) {
+		PX4_ERR("Failed syncing data manager file");
+	}
+
+	munmap(dm_operations_data.mmap.data, dm_operations_data.mmap.size);
+	close(dm_operations_data.mmap.fd);
+	dm_operations_data.mmap.data = nullptr;
+	dm_operations_data.running = false;
+}
+
+static int
+_mmap_wait(px4_sem_t *sem)
+{
+	if (!dm_operations_data.mmap.sync_timeout_usec) {
+		px4_sem_wait(sem);
+		return 0;
+	}
+
+	const hrt_abstime now = hrt_absolute_time();
+
+	if (now < dm_operations_data.mmap.sync_timeout_usec) {
+		struct timespec abstime;
+		px4_clock_gettime(CLOCK_REALTIME, &abstime);
+		const uint64_t nsecs = abstime.tv_nsec + (dm_operations_data.mmap.sync_timeout_usec - now) * 1000;
+		abstime.tv_sec += nsecs / 1000000000;
+		abstime.tv_nsec = nsecs % 1000000000;
+
+		px4_sem_timedwait(sem, &abstime);
+	}
+
+	if (hrt_absolute_time() >= dm_operations_data.mmap.sync_timeout_usec) {
+		if (_mmap_sync() != 0) {
+			PX4_ERR("Failed syncing data manager file");
+		}
+	}
+
+	return 0;
+}
+#endif
+
 /** Write to the data manager file */
 __EXPORT ssize_t
 dm_write(dm_item_t item, unsigned index, dm_persitence_t persistence, const void *buf, size_t count)
@@ -1155,6 +1674,119 @@ dm_clear(dm_item_t item)
 	return enqueue_work_item_and_wait_for_result(work);
 }
 
+/* Get a work item for a write range request */
+static work_q_item_t *
+create_write_range_work_item(dm_item_t item, unsigned index, unsigned count, dm_persitence_t persistence,
+			     const void *buf, size_t item_len)
+{
+	work_q_item_t *work;
+
+	/* Make sure data manager has been started and is not shutting down */
+	if (!is_running() || g_task_should_exit) {
+		return nullptr;
+	}
+
+	if ((work = create_work_item()) == nullptr) {
+		return nullptr;
+	}
+
+	work->func = dm_write_range_func;
+	work->write_range_params.item = item;
+	work->write_range_params.index = index;
+	work->write_range_params.count = count;
+	work->write_range_params.persistence = persistence;
+	work->write_range_params.buf = buf;
+	work->write_range_params.item_len = item_len;
+	return work;
+}
+
+/* Get a work item for a read range request */
+static work_q_item_t *
+create_read_range_work_item(dm_item_t item, unsigned index, unsigned count, void *buf, size_t item_len)
+{
+	work_q_item_t *work;
+
+	/* Make sure data manager has been started and is not shutting down */
+	if (!is_running() || g_task_should_exit) {
+		return nullptr;
+	}
+
+	if ((work = create_work_item()) == nullptr) {
+		return nullptr;
+	}
+
+	work->func = dm_read_range_func;
+	work->read_range_params.item = item;
+	work->read_range_params.index = index;
+	work->read_range_params.count = count;
+	work->read_range_params.buf = buf;
+	work->read_range_params.item_len = item_len;
+	return work;
+}
+
+/** Write consecutive items to the data manager file */
+__EXPORT ssize_t
+dm_write_range(dm_item_t item, unsigned index, unsigned count, dm_persitence_t persistence, const void *buf,
+	       size_t item_len)
+{
+	work_q_item_t *work = create_write_range_work_item(item, index, count, persistence, buf, item_len);
+
+	if (work == nullptr) {
+		return -1;
+	}
+
+	/* Enqueue the item on the work queue and wait for the worker thread to complete processing it */
+	return (ssize_t)enqueue_work_item_and_wait_for_result(work);
+}
+
+/** Retrieve consecutive items from the data manager file */
+__EXPORT ssize_t
+dm_read_range(dm_item_t item, unsigned index, unsigned count, void *buf, size_t item_len)
+{
+	work_q_item_t *work = create_read_range_work_item(item, index, count, buf, item_len);
+
+	if (work == nullptr) {
+		return -1;
+	}
+
+	/* Enqueue the item on the work queue and wait for the worker thread to complete processing it */
+	return (ssize_t)enqueue_work_item_and_wait_for_result(work);
+}
+
+/** Queue a write of consecutive items without waiting for the result */
+__EXPORT int
+dm_write_range_async(dm_item_t item, unsigned index, unsigned count, dm_persitence_t persistence, const void *buf,
+		     size_t item_len, dm_completion_callback_t callback, void *arg)
+{
+	work_q_item_t *work = create_write_range_work_item(item, index, count, persistence, buf, item_len);
+
+	if (work == nullptr) {
+		return -1;
+	}
+
+	work->callback = callback;
+	work->callback_arg = arg;
+	enqueue_work_item(work);
+	return 0;
+}
+
+/** Queue a read of consecutive items without waiting for the result */
+__EXPORT int
+dm_read_range_async(dm_item_t item, unsigned index, unsigned count, void *buf, size_t item_len,
+		    dm_completion_callback_t callback, void *arg)
+{
+	work_q_item_t *work = create_read_range_work_item(item, index, count, buf, item_len);
+
+	if (work == nullptr) {
+		return -1;
+	}
+
+	work->callback = callback;
+	work->callback_arg = arg;
+	enqueue_work_item(work);
+	return 0;
+}
+
 __EXPORT int
 dm_lock(dm_item_t item)
 {
@@ -1249,6 +1881,40 @@ dm_flash_sector_description_set(const dm_sector_descriptor_t *description)
 }
 #endif
 
+/* Write consecutive items, stopping at the first failure. Returns the number of items written */
+static ssize_t
+_write_range(dm_item_t item, unsigned index, unsigned count, dm_persitence_t persistence, const void *buf,
+	     size_t item_len)
+{
+	const uint8_t *data = (const uint8_t *)buf;
+	unsigned i;
+
+	for (i = 0; i < count; i++) {
+		if (g_dm_ops->write(item, index + i, persistence, data + i * item_len, item_len) != (ssize_t)item_len) {
+			break;
+		}
+	}
+
+	return i;
+}
+
+/* Read consecutive items, stopping at the first one that fails or is not item_len long. Returns the number of
+ * items read */
+static ssize_t
+_read_range(dm_item_t item, unsigned index, unsigned count, void *buf, size_t item_len)
+{
+	uint8_t *data = (uint8_t *)buf;
+	unsigned i;
+
+	for (i = 0; i < count; i++) {
+		if (g_dm_ops->read(item, index + i, data + i * item_len, item_len) != (ssize_t)item_len) {
+			break;
+		}
+	}
+
+	return i;
+}
+
 static int
 task_main(int argc, char *argv[])
 {
@@ -1268,6 +1934,12 @@ task_main(int argc, char *argv[])
 		g_dm_ops = &dm_ram_flash_operations;
 		break;
 #endif
+#if defined(MMAP_BASED_DATAMAN)
+
+	case BACKEND_MMAP:
+		g_dm_ops = &dm_mmap_operations;
+		break;
+#endif
 
 	default:
 		PX4_WARN("No valid backend set.");
@@ -1304,7 +1976,6 @@ task_main(int argc, char *argv[])
 	g_task_should_exit = false;
 
 	init_q(&g_work_q);
-	init_q(&g_free_q);
 
 	px4_sem_init(&g_work_queued_sema, 1, 0);
 
@@ -1356,6 +2027,13 @@ task_main(int argc, char *argv[])
 			 restart_type_str, max_offset);
 		break;
 #endif
+#if defined(MMAP_BASED_DATAMAN)
+
+	case BACKEND_MMAP:
+		PX4_INFO("%s, data manager memory-mapped file '%s' size is %d bytes",
+			 restart_type_str, k_data_manager_device_path, max_offset);
+		break;
+#endif
 
 	default:
 		break;
@@ -1402,13 +2080,35 @@ task_main(int argc, char *argv[])
 				work->result = g_dm_ops->restart(work->restart_params.reason);
 				break;
 
+			case dm_write_range_func:
+				g_func_counts[dm_write_range_func]++;
+				work->result =
+					_write_range(work->write_range_params.item, work->write_range_params.index, work->write_range_params.count,
+						     work->write_range_params.persistence, work->write_range_params.buf,
+						     work->write_range_params.item_len);
+				break;
+
+			case dm_read_range_func:
+				g_func_counts[dm_read_range_func]++;
+				work->result =
+					_read_range(work->read_range_params.item, work->read_range_params.index, work->read_range_params.count,
+						    work->read_range_params.buf, work->read_range_params.item_len);
+				break;
+
 			default: /* should never happen */
 				work->result = -1;
 				break;
 			}
 
 			/* Inform the caller that work is done */
-			px4_sem_post(&work->wait_sem);
+			if (work->callback) {
+				/* nobody waits for an asynchronous request, so the work item is released here */
+				work->callback(work->callback_arg, work->result);
+				destroy_work_item(work);
+
+			} else {
+				px4_sem_post(&work->wait_sem);
+			}
 		}
 
 		/* time to go???? */
@@ -1419,21 +2119,9 @@ task_main(int argc, char *argv[])
 
 	g_dm_ops->shutdown();
 
-	/* The work queue is now empty, empty the free queue */
-	for (;;) {
-		if ((work = (work_q_item_t *)sq_remfirst(&(g_free_q.q))) == nullptr) {
-			break;
-		}
-
-		if (work->first) {
-			free(work);
-		}
-	}
-
 end:
 	backend = BACKEND_NONE;
 	destroy_q(&g_work_q);
-	destroy_q(&g_free_q);
 	px4_sem_destroy(&g_work_queued_sema);
 	px4_sem_destroy(&g_sys_state_mutex_mission);
 	px4_sem_destroy(&g_sys_state_mutex_fence);
@@ -1474,7 +2162,21 @@ status()
 	PX4_INFO("Reads    %d", g_func_counts[dm_read_func]);
 	PX4_INFO("Clears   %d", g_func_counts[dm_clear_func]);
 	PX4_INFO("Restarts %d", g_func_counts[dm_restart_func]);
-	PX4_INFO("Max Q lengths work %d, free %d", g_work_q.max_size, g_free_q.max_size);
+	PX4_INFO("Range writes %d, reads %d", g_func_counts[dm_write_range_func], g_func_counts[dm_read_range_func]);
+	PX4_INFO("Max Q length work %d", g_work_q.max_size);
+
+	if (backend == BACKEND_FILE && dm_operations_data.file.cache) {
+		PX4_INFO("Cache hits %u, misses %u, write-backs %u, syncs %u", dm_operations_data.file.cache_hits,
+			 dm_operations_data.file.cache_misses, dm_operations_data.file.write_backs, dm_operations_data.file.syncs);
+	}
+
+#if defined(MMAP_BASED_DATAMAN)
+
+	if (backend == BACKEND_MMAP) {
+		PX4_INFO("Syncs %u", dm_operations_data.mmap.syncs);
+	}
+
+#endif
 }
 
 static void
@@ -1505,6 +2207,19 @@ Each type has a specific type and a fixed maximum amount of storage items, so th
 Reading and writing a single item is always atomic. If multiple items need to be read/modified atomically, there is
 an additional lock per item type via `dm_lock`.
 
+Consecutive items can be transferred in a single request with `dm_read_range`/`dm_write_range`, or without blocking
+the caller with the `_async` variants, which call a completion callback from the dataman thread. Requests are
+processed in order.
+
+The file backend caches the data in RAM pages of the SD card sector size. Writes are collected in the cache and written
+back (followed by an fsync) at most 0.5s later for `DM_PERSIST_POWER_ON_RESET` items, 5s later for all other items,
+and immediately on disarm and shutdown.
+
+On POSIX targets the file can also be memory-mapped (option -m), so that reads and writes are memory accesses instead of
+syscalls. The kernel writes the data back, and items with `DM_PERSIST_POWER_ON_RESET` persistence are additionally
+synced to the storage (msync) at most 0.5s after they are written, as well as after a restart and on shutdown. The file
+layout is the same as for the file backend.
+
 **DM_KEY_FENCE_POINTS** and **DM_KEY_SAFE_POINTS** items: the first data element is a `mission_stats_entry_s` struct,
 which stores the number of items for these types. These items are always updated atomically in one transaction (from
 the mavlink mission manager). During that time, navigator will try to acquire the geofence item lock, fail, and will not
@@ -1517,6 +2232,7 @@ check for geofence violations.
 	PRINT_MODULE_USAGE_PARAM_STRING('f', nullptr, "<file>", "Storage file", true);
 	PRINT_MODULE_USAGE_PARAM_FLAG('r', "Use RAM backend (NOT persistent)", true);
 	PRINT_MODULE_USAGE_PARAM_FLAG('i', "Use FLASH backend", true);
+	PRINT_MODULE_USAGE_PARAM_FLAG('m', "Memory-map the storage file (POSIX only), can be combined with -f", true);
 	PRINT_MODULE_USAGE_PARAM_COMMENT("The options -f, -r and -i are mutually exclusive. If nothing is specified, a file 'dataman' is used");
 
 	PRINT_MODULE_USAGE_COMMAND_DESCR("poweronrestart", "Restart dataman (on power on)");
@@ -1556,14 +2272,22 @@ dataman_main(int argc, char *argv[])
 
 		/* jump over start and look at options first */
 
-		while ((ch = px4_getopt(argc, argv, "f:ri", &dmoptind, &dmoptarg)) != EOF) {
+		while ((ch = px4_getopt(argc, argv, "f:rim", &dmoptind, &dmoptarg)) != EOF) {
 			switch (ch) {
 			case 'f':
-				if (backend_check()) {
-					return -1;
+#if defined(MMAP_BASED_DATAMAN)
+				if (backend != BACKEND_MMAP) {
+#endif
+
+					if (backend_check()) {
+						return -1;
+					}
+
+					backend = BACKEND_FILE;
+#if defined(MMAP_BASED_DATAMAN)
 				}
 
-				backend = BACKEND_FILE;
+#endif
 				k_data_manager_device_path = strdup(dmoptarg);
 				PX4_INFO("dataman file set to: %s", k_data_manager_device_path);
 				break;
@@ -1594,6 +2318,19 @@ dataman_main(int argc, char *argv[])
 				return -1;
 #endif
 
+			case 'm':
+#if defined(MMAP_BASED_DATAMAN)
+				if (backend != BACKEND_FILE && backend_check()) {
+					return -1;
+				}
+
+				backend = BACKEND_MMAP;
+				break;
+#else
+				PX4_WARN("Memory-mapped file backend is not available");
+				return -1;
+#endif
+
 			//no break
 			default:
 				usage();
@@ -1603,6 +2340,13 @@ dataman_main(int argc, char *argv[])
 
 		if (backend == BACKEND_NONE) {
 			backend = BACKEND_FILE;
+		}
+
+		if ((backend == BACKEND_FILE
+#if defined(MMAP_BASED_DATAMAN)
+		     || backend == BACKEND_MMAP
+#endif
+		    ) && !k_data_manager_device_path) {
 			k_data_manager_device_path = strdup(default_device_path);
 		}
 
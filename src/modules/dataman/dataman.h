@@ -127,6 +127,79 @@ dm_write(
 	size_t buflen			/* Length in bytes of data to retrieve */
 );
 
+/**
+ * Retrieve consecutive items from the data manager store in a single request.
+ * The items are stored back to back in the buffer, reading stops at the first item that cannot be read or has a
+ * different length than item_len.
+ * @return number of items read, -1 on error
+ */
+__EXPORT ssize_t
+dm_read_range(
+	dm_item_t item,			/* The item type to retrieve */
+	unsigned index,			/* The index of the first item */
+	unsigned count,			/* The number of items */
+	void *buffer,			/* Pointer to caller data buffer (count * item_len bytes) */
+	size_t item_len			/* Length in bytes of each item */
+);
+
+/**
+ * Write consecutive items to the data manager store in a single request.
+ * Writing stops at the first item that fails. A request with count 0 does not write anything, but can be used to
+ * wait until all earlier asynchronous requests are completed.
+ * @return number of items written, -1 on error
+ */
+__EXPORT ssize_t
+dm_write_range(
+	dm_item_t item,			/* The item type to store */
+	unsigned index,			/* The index of the first item */
+	unsigned count,			/* The number of items */
+	dm_persitence_t persistence,	/* The persistence level of these items */
+	const void *buffer,		/* Pointer to caller data buffer (count * item_len bytes) */
+	size_t item_len			/* Length in bytes of each item */
+);
+
+/**
+ * Completion callback of an asynchronous request. It is called from the dataman thread and must not block.
+ * @param arg the argument passed with the request
+ * @param result the result of the request (@see dm_read_range(), dm_write_range())
+ */
+typedef void (*dm_completion_callback_t)(void *arg, ssize_t result);
+
+/**
+ * Queue a read of consecutive items without waiting for it (@see dm_read_range()).
+ * The buffer must stay valid until the callback is called.
+ * Requests are processed in order, so a blocking call returns only after all earlier requests completed.
+ * @return 0 if the request is queued (the callback is called exactly once), -1 on error (the callback is not called)
+ */
+__EXPORT int
+dm_read_range_async(
+	dm_item_t item,			/* The item type to retrieve */
+	unsigned index,			/* The index of the first item */
+	unsigned count,			/* The number of items */
+	void *buffer,			/* Pointer to caller data buffer (count * item_len bytes) */
+	size_t item_len,		/* Length in bytes of each item */
+	dm_completion_callback_t callback,	/* Called when the request is completed */
+	void *arg			/* Argument passed to the callback */
+);
+
+/**
+ * Queue a write of consecutive items without waiting for it (@see dm_write_range()).
+ * The buffer must stay valid until the callback is called.
+ * Requests are processed in order, so a blocking call returns only after all earlier requests completed.
+ * @return 0 if the request is queued (the callback is called exactly once), -1 on error (the callback is not called)
+ */
+__EXPORT int
+dm_write_range_async(
+	dm_item_t item,			/* The item type to store */
+	unsigned index,			/* The index of the first item */
+	unsigned count,			/* The number of items */
+	dm_persitence_t persistence,	/* The persistence level of these items */
+	const void *buffer,		/* Pointer to caller data buffer (count * item_len bytes) */
+	size_t item_len,		/* Length in bytes of each item */
+	dm_completion_callback_t callback,	/* Called when the request is completed */
+	void *arg			/* Argument passed to the callback */
+);
+
 /**
  * Lock all items of a type. Can be used for atomic updates of multiple items (single items are always updated
  * atomically).
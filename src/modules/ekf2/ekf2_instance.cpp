@@ -0,0 +1,351 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2017 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file ekf2_instance.cpp
+ */
+
+#include "ekf2_instance.h"
+
+#include <string.h>
+
+void Ekf2InstanceInputs::merge(const Ekf2InstanceInputs &inputs)
+{
+	if (inputs.mag_updated) {
+		mag_updated = true;
+		mag_time_us = inputs.mag_time_us;
+		memcpy(mag_data, inputs.mag_data, sizeof(mag_data));
+	}
+
+	if (inputs.baro_updated) {
+		baro_updated = true;
+		baro_time_us = inputs.baro_time_us;
+		baro_alt = inputs.baro_alt;
+		air_density = inputs.air_density;
+	}
+
+	if (inputs.gps_updated) {
+		gps_updated = true;
+		gps_time_us = inputs.gps_time_us;
+		gps = inputs.gps;
+	}
+
+	if (inputs.airspeed_updated) {
+		airspeed_updated = true;
+		airspeed_time_us = inputs.airspeed_time_us;
+		true_airspeed = inputs.true_airspeed;
+		eas2tas = inputs.eas2tas;
+	}
+
+	if (inputs.vehicle_status_updated) {
+		vehicle_status_updated = true;
+		fuse_beta = inputs.fuse_beta;
+		is_fixed_wing = inputs.is_fixed_wing;
+	}
+
+	if (inputs.flow_updated) {
+		flow_updated = true;
+		flow_time_us = inputs.flow_time_us;
+		flow = inputs.flow;
+	}
+
+	if (inputs.range_updated) {
+		range_updated = true;
+		range_time_us = inputs.range_time_us;
+		range = inputs.range;
+	}
+
+	if (inputs.ev_updated) {
+		ev_updated = true;
+		ev_time_us = inputs.ev_time_us;
+		ev = inputs.ev;
+	}
+
+	if (inputs.land_detected_updated) {
+		land_detected_updated = true;
+		in_air = inputs.in_air;
+	}
+}
+
+void Ekf2InstanceInputs::apply(Ekf &ekf)
+{
+	if (mag_updated) {
+		ekf.setMagData(mag_time_us, mag_data);
+	}
+
+	if (baro_updated) {
+		ekf.set_air_density(air_density);
+		ekf.setBaroData(baro_time_us, baro_alt);
+	}
+
+	if (gps_updated) {
+		ekf.setGpsData(gps_time_us, &gps);
+	}
+
+	if (airspeed_updated) {
+		ekf.setAirspeedData(airspeed_time_us, true_airspeed, eas2tas);
+	}
+
+	if (vehicle_status_updated) {
+		ekf.set_fuse_beta_flag(fuse_beta);
+		ekf.set_is_fixed_wing(is_fixed_wing);
+	}
+
+	if (flow_updated) {
+		ekf.setOpticalFlowData(flow_time_us, &flow);
+	}
+
+	if (range_updated) {
+		ekf.setRangeData(range_time_us, range);
+	}
+
+	if (ev_updated) {
+		ekf.setExtVisionData(ev_time_us, &ev);
+	}
+
+	if (land_detected_updated) {
+		ekf.set_in_air_status(in_air);
+	}
+}
+
+void Ekf2InstanceInputs::clear_updated()
+{
+	mag_updated = false;
+	baro_updated = false;
+	gps_updated = false;
+	airspeed_updated = false;
+	vehicle_status_updated = false;
+	flow_updated = false;
+	range_updated = false;
+	ev_updated = false;
+	land_detected_updated = false;
+}
+
+#ifdef EKF2_MULTI_INSTANCE_SUPPORTED
+
+#include <px4_defines.h>
+#include <px4_log.h>
+#include <px4_posix.h>
+#include <px4_tasks.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <uORB/uORB.h>
+
+Ekf2Instance::Ekf2Instance(int index, int imu_instance) :
+	_index(index),
+	_imu_instance(imu_instance)
+{
+	pthread_mutex_init(&_ekf_mutex, nullptr);
+	pthread_mutex_init(&_input_mutex, nullptr);
+}
+
+Ekf2Instance::~Ekf2Instance()
+{
+	pthread_mutex_destroy(&_ekf_mutex);
+	pthread_mutex_destroy(&_input_mutex);
+}
+
+int Ekf2Instance::thread_start()
+{
+	pthread_attr_t thr_attr;
+	pthread_attr_init(&thr_attr);
+
+	// same priority as the ekf2 task (inherited)
+	pthread_attr_setstacksize(&thr_attr, PX4_STACK_ADJUSTED(6000));
+
+	int ret = pthread_create(&_thread, &thr_attr, &Ekf2Instance::run_helper, this);
+	pthread_attr_destroy(&thr_attr);
+
+	return ret;
+}
+
+void Ekf2Instance::thread_stop()
+{
+	_exit_thread = true;
+
+	// wait for thread to complete (it polls with a timeout)
+	int ret = pthread_join(_thread, nullptr);
+
+	if (ret) {
+		PX4_WARN("join failed: %d", ret);
+	}
+}
+
+void *Ekf2Instance::run_helper(void *context)
+{
+	Ekf2Instance *instance = reinterpret_cast<Ekf2Instance *>(context);
+
+	char name[16];
+	snprintf(name, sizeof(name), "ekf2_inst%d", instance->_index);
+	px4_prctl(PR_SET_NAME, name, px4_getpid());
+
+	instance->run();
+	return nullptr;
+}
+
+void Ekf2Instance::post_inputs(const Ekf2InstanceInputs &inputs)
+{
+	pthread_mutex_lock(&_input_mutex);
+	_inputs.merge(inputs);
+	pthread_mutex_unlock(&_input_mutex);
+}
+
+void Ekf2Instance::post_params(const parameters &params)
+{
+	pthread_mutex_lock(&_input_mutex);
+	_params = params;
+	_params_updated = true;
+	pthread_mutex_unlock(&_input_mutex);
+}
+
+bool Ekf2Instance::get_health(hrt_abstime now, float &test_ratio)
+{
+	pthread_mutex_lock(&_input_mutex);
+	const bool healthy = _tilt_aligned && (_last_update_us > 0) && (now < _last_update_us + _update_timeout_us);
+	test_ratio = _test_ratio_filt;
+	pthread_mutex_unlock(&_input_mutex);
+
+	return healthy;
+}
+
+void Ekf2Instance::run()
+{
+#ifdef __PX4_LINUX
+	// spread the instances over the cores (the ekf2 task itself is not pinned)
+	const long num_cores = sysconf(_SC_NPROCESSORS_ONLN);
+
+	if (num_cores > 1) {
+		cpu_set_t cpus;
+		CPU_ZERO(&cpus);
+		CPU_SET(_index % num_cores, &cpus);
+
+		if (pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) != 0) {
+			PX4_WARN("instance %d: failed to set the CPU affinity", _index);
+		}
+	}
+
+#endif /* __PX4_LINUX */
+
+	int imu_sub = orb_subscribe_multi(ORB_ID(vehicle_imu), _imu_instance);
+
+	px4_pollfd_struct_t fds[1] = {};
+	fds[0].fd = imu_sub;
+	fds[0].events = POLLIN;
+
+	Ekf2InstanceInputs inputs{};
+	parameters params;
+	hrt_abstime last_update_us = 0;
+
+	while (!_exit_thread) {
+		int ret = px4_poll(fds, 1, 100);
+
+		if (ret <= 0 || !(fds[0].revents & POLLIN)) {
+			continue;
+		}
+
+		vehicle_imu_s imu;
+		orb_copy(ORB_ID(vehicle_imu), imu_sub, &imu);
+
+		// take the staged data
+		pthread_mutex_lock(&_input_mutex);
+		inputs = _inputs;
+		_inputs.clear_updated();
+		const bool params_updated = _params_updated;
+
+		if (params_updated) {
+			params = _params;
+			_params_updated = false;
+		}
+
+		pthread_mutex_unlock(&_input_mutex);
+
+		const hrt_abstime now = hrt_absolute_time();
+
+		pthread_mutex_lock(&_ekf_mutex);
+
+		if (params_updated) {
+			*_ekf.getParamHandle() = params;
+		}
+
+		if (_imu.timestamp > 0 && (imu.gyro_device_id != _imu.gyro_device_id
+					   || imu.accel_device_id != _imu.accel_device_id)) {
+			PX4_WARN("instance %d: IMU changed, resetting IMU bias", _index);
+			_ekf.reset_imu_bias();
+		}
+
+		_imu = imu;
+
+		inputs.apply(_ekf);
+
+		float gyro_integral[3];
+		const float gyro_dt = imu.gyro_integral_dt / 1.e6f;
+		gyro_integral[0] = imu.gyro_rad[0] * gyro_dt;
+		gyro_integral[1] = imu.gyro_rad[1] * gyro_dt;
+		gyro_integral[2] = imu.gyro_rad[2] * gyro_dt;
+
+		float accel_integral[3];
+		const float accel_dt = imu.accelerometer_integral_dt / 1.e6f;
+		accel_integral[0] = imu.accelerometer_m_s2[0] * accel_dt;
+		accel_integral[1] = imu.accelerometer_m_s2[1] * accel_dt;
+		accel_integral[2] = imu.accelerometer_m_s2[2] * accel_dt;
+
+		_ekf.setIMUData(now, imu.gyro_integral_dt, imu.accelerometer_integral_dt, gyro_integral, accel_integral);
+
+		const bool updated = _ekf.update();
+		float test_ratio = 0.0f;
+		uint32_t control_mode = 0;
+
+		if (updated) {
+			// only written by this thread
+			test_ratio = _test_ratio_filt;
+			ekf2_update_test_ratio(_ekf, last_update_us > 0 ? (now - last_update_us) * 1e-6f : 0.0f, test_ratio);
+			_ekf.get_control_mode(&control_mode);
+			last_update_us = now;
+		}
+
+		pthread_mutex_unlock(&_ekf_mutex);
+
+		if (updated) {
+			pthread_mutex_lock(&_input_mutex);
+			_test_ratio_filt = test_ratio;
+			_last_update_us = now;
+			_tilt_aligned = control_mode & 1;
+			pthread_mutex_unlock(&_input_mutex);
+		}
+	}
+
+	orb_unsubscribe(imu_sub);
+}
+
+#endif /* EKF2_MULTI_INSTANCE_SUPPORTED */
@@ -0,0 +1,198 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2017 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file ekf2_instance.h
+ * Additional EKF instance, running in its own thread.
+ */
+
+#pragma once
+
+#include <drivers/drv_hrt.h>
+#include <ecl/EKF/ekf.h>
+#include <mathlib/mathlib.h>
+#include <pthread.h>
+#include <uORB/topics/vehicle_imu.h>
+
+#if defined(__PX4_POSIX) && !defined(__PX4_QURT)
+#define EKF2_MULTI_INSTANCE_SUPPORTED
+#endif
+
+/**
+ * Non-IMU data passed by the ekf2 task to the EKF instances, in the form it is given to the main EKF.
+ * Only the latest data of each type is kept until an instance uses it.
+ */
+struct Ekf2InstanceInputs {
+	bool mag_updated;
+	uint64_t mag_time_us;
+	float mag_data[3];		///< bias corrected magnetometer data (Gauss)
+
+	bool baro_updated;
+	uint64_t baro_time_us;
+	float baro_alt;			///< corrected barometric altitude (m)
+	float air_density;		///< (kg/m**3)
+
+	bool gps_updated;
+	uint64_t gps_time_us;
+	gps_message gps;
+
+	bool airspeed_updated;
+	uint64_t airspeed_time_us;
+	float true_airspeed;		///< (m/s)
+	float eas2tas;
+
+	bool vehicle_status_updated;
+	bool fuse_beta;
+	bool is_fixed_wing;
+
+	bool flow_updated;
+	uint64_t flow_time_us;
+	flow_message flow;
+
+	bool range_updated;
+	uint64_t range_time_us;
+	float range;			///< (m)
+
+	bool ev_updated;
+	uint64_t ev_time_us;
+	ext_vision_message ev;
+
+	bool land_detected_updated;
+	bool in_air;
+
+	/** take over the updated data of another set of inputs */
+	void merge(const Ekf2InstanceInputs &inputs);
+
+	/** pass the updated data to an EKF, in the same order as the ekf2 task */
+	void apply(Ekf &ekf);
+
+	void clear_updated();
+};
+
+/**
+ * Low pass filter the largest of the magnetometer, velocity, position and height innovation test ratios
+ * of an EKF. The result is used to select the EKF instance for the outputs.
+ * @param dt time since the last update (s)
+ */
+static inline void ekf2_update_test_ratio(Ekf &ekf, float dt, float &test_ratio_filt)
+{
+	static constexpr float tau = 1.0f; ///< filter time constant (s)
+
+	uint16_t status;
+	float mag, vel, pos, hgt, tas, hagl;
+	ekf.get_innovation_test_status(&status, &mag, &vel, &pos, &hgt, &tas, &hagl);
+
+	const float test_ratio = fmaxf(fmaxf(mag, vel), fmaxf(pos, hgt));
+	test_ratio_filt += math::constrain(dt / tau, 0.0f, 1.0f) * (test_ratio - test_ratio_filt);
+}
+
+#ifdef EKF2_MULTI_INSTANCE_SUPPORTED
+
+/**
+ * @class Ekf2Instance
+ * Runs an EKF on the data of one IMU (vehicle_imu topic), in a thread of its own.
+ * The other sensor data and the parameters are passed in by the ekf2 task (post_inputs(), post_params()),
+ * which also selects the instance that is used for the outputs. The EKF must be locked while it is accessed
+ * from outside of the instance thread.
+ */
+class Ekf2Instance
+{
+public:
+	/**
+	 * @param index instance index (>= 1, the main EKF of the ekf2 task is instance 0)
+	 * @param imu_instance uORB instance of vehicle_imu to use
+	 */
+	Ekf2Instance(int index, int imu_instance);
+	~Ekf2Instance();
+
+	/**
+	 * start the thread
+	 * @return 0 on success, error number otherwise (@see pthread_create)
+	 */
+	int thread_start();
+
+	void thread_stop();
+
+	/** pass the latest non-IMU data (thread-safe) */
+	void post_inputs(const Ekf2InstanceInputs &inputs);
+
+	/** pass the parameters, they are applied before the next update (thread-safe) */
+	void post_params(const parameters &params);
+
+	/**
+	 * get the health of the instance (thread-safe)
+	 * @param test_ratio filtered innovation test ratio (@see ekf2_update_test_ratio())
+	 * @return true if the EKF has recently been updated and the tilt is aligned
+	 */
+	bool get_health(hrt_abstime now, float &test_ratio);
+
+	void lock() { pthread_mutex_lock(&_ekf_mutex); }
+	void unlock() { pthread_mutex_unlock(&_ekf_mutex); }
+
+	/** @return the EKF, only access it while locked */
+	Ekf &ekf() { return _ekf; }
+
+	/** @return the last IMU data used by the EKF, only access it while locked */
+	const vehicle_imu_s &imu() const { return _imu; }
+
+	int index() const { return _index; }
+
+private:
+	static void *run_helper(void *);
+
+	void run();
+
+	static constexpr hrt_abstime _update_timeout_us = 1000000; ///< the instance is unhealthy without an update for 1s
+
+	const int _index;
+	const int _imu_instance;
+
+	Ekf _ekf;
+	vehicle_imu_s _imu{};
+
+	pthread_mutex_t _ekf_mutex;	///< protects _ekf and _imu
+	pthread_mutex_t _input_mutex;	///< protects the members below
+
+	Ekf2InstanceInputs _inputs{};	///< staged data, not yet passed to the EKF
+	parameters _params{};		///< staged parameters
+	bool _params_updated{false};
+	float _test_ratio_filt{0.0f};
+	hrt_abstime _last_update_us{0};
+	bool _tilt_aligned{false};
+
+	volatile bool _exit_thread{false};
+	pthread_t _thread{0};
+};
+
+#endif /* EKF2_MULTI_INSTANCE_SUPPORTED */
@@ -42,6 +42,7 @@
 
 #include <controllib/block/BlockParam.hpp>
 #include <controllib/blocks.hpp>
+#include <conversion/attitude.h>
 #include <drivers/drv_hrt.h>
 #include <ecl/EKF/ekf.h>
 #include <mathlib/mathlib.h>
@@ -50,14 +51,18 @@
 #include <px4_posix.h>
 #include <px4_tasks.h>
 #include <px4_time.h>
+#include <systemlib/perf_counter.h>
 #include <systemlib/systemlib.h>
+#include <uORB/SubscriptionCallback.hpp>
 #include <uORB/topics/airspeed.h>
 #include <uORB/topics/distance_sensor.h>
 #include <uORB/topics/ekf2_innovations.h>
 #include <uORB/topics/ekf2_timestamps.h>
 #include <uORB/topics/estimator_status.h>
+#include <uORB/topics/estimator_timing.h>
 #include <uORB/topics/optical_flow.h>
 #include <uORB/topics/parameter_update.h>
+#include <uORB/topics/replay_status.h>
 #include <uORB/topics/sensor_baro.h>
 #include <uORB/topics/sensor_bias.h>
 #include <uORB/topics/sensor_combined.h>
@@ -70,6 +75,9 @@
 #include <uORB/topics/vehicle_status.h>
 #include <uORB/topics/wind_estimate.h>
 
+#include "ekf2_instance.h"
+#include "terrain_grid.h"
+
 using control::BlockParamFloat;
 using control::BlockParamExtFloat;
 using control::BlockParamInt;
@@ -83,7 +91,7 @@ class Ekf2 final : public control::SuperBlock, public ModuleBase<Ekf2>
 {
 public:
 	Ekf2();
-	~Ekf2() override = default;
+	~Ekf2() override;
 
 	/** @see ModuleBase */
 	static int task_spawn(int argc, char *argv[]);
@@ -102,14 +110,62 @@ public:
 
 	void set_replay_mode(bool replay) { _replay_mode = replay; }
 
+	/** direct replay: the filter updates run synchronously in the thread of the replay module */
+	void set_replay_direct(bool direct) { _replay_direct = direct; }
+
 	static void	task_main_trampoline(int argc, char *argv[]);
 
+	/**
+	 * Like ModuleBase::run_trampoline(), but in replay mode the estimator is replaced by a new one
+	 * when the replay module starts another pass over the log (parameter sweep).
+	 */
+	static void run_trampoline_restartable(int argc, char *argv[]);
+
 	int print_status() override;
 
 private:
 	int getRangeSubIndex(const int *subs); ///< get subscribtion index of first downward-facing range sensor
 
+	/**
+	 * Continue a reset counter of the outputs across a switch of the EKF instance, which is reported as a reset.
+	 * @param counter reset counter of the selected instance, replaced by the published counter
+	 * @param counter_prev last published counter
+	 * @param offset offset of the published counter from the counter of the selected instance
+	 */
+	void continue_reset_counter(uint8_t &counter, uint8_t counter_prev, uint8_t &offset)
+	{
+		if (_instance_switched) {
+			offset = counter_prev + 1 - counter;
+		}
+
+		counter += offset;
+	}
+
+	/**
+	 * Collect the execution time of the filter updates and publish estimator_timing once per second.
+	 * @param now time at the end of the update
+	 * @param update_time_us execution time of Ekf::update()
+	 */
+	void update_timing(hrt_abstime now, uint32_t update_time_us);
+
+	/**
+	 * Publish vehicle_attitude and vehicle_local_position from the output predictor of an EKF instance.
+	 * @param ekf instance used for the outputs
+	 * @param now publication time
+	 * @param sensors IMU data of the newest sample
+	 * @param gyro_rad angular rate of the IMU used by the instance (rad/s)
+	 */
+	void publish_output(Ekf &ekf, hrt_abstime now, const sensor_combined_s &sensors, const float *gyro_rad);
+
+#ifdef EKF2_MULTI_INSTANCE_SUPPORTED
+	/** update the health of the main instance and select the instance used for the outputs */
+	void select_instance(hrt_abstime now);
+#endif
+
 	bool 	_replay_mode = false;			///< true when we use replay data from a log
+	bool	_replay_direct = false;			///< replay mode: filter updates are called from the publication of sensor_combined
+	bool	_replay_restart = false;		///< replay mode: a new pass over the log started, restart the estimator
+	bool	_replay_restarted = false;		///< replay mode: this estimator replaces the one of the previous pass
 
 	// time slip monitoring
 	uint64_t _integrated_time_us = 0;	///< integral of gyro delta time from start (uSec)
@@ -162,6 +218,16 @@ private:
 	orb_advert_t _estimator_innovations_pub{nullptr};
 	orb_advert_t _ekf2_timestamps_pub{nullptr};
 	orb_advert_t _sensor_bias_pub{nullptr};
+	orb_advert_t _estimator_timing_pub{nullptr};
+
+	// execution time monitoring
+	perf_counter_t _perf_update{perf_alloc(PC_ELAPSED, "ekf2_update")};
+	static constexpr hrt_abstime _timing_interval_us = 1000000;	///< publication interval of estimator_timing (uSec)
+	hrt_abstime _timing_start_us = 0;	///< start of the current timing interval (uSec)
+	uint64_t _stage_times_last_us[TIMING_NUM_STAGES] {};	///< accumulated stage times at the start of the interval (uSec)
+	uint32_t _timing_num_updates = 0;	///< number of filter updates in the current interval
+	uint32_t _timing_update_total_us = 0;	///< total execution time of the filter updates in the interval (uSec)
+	uint32_t _timing_update_max_us = 0;	///< longest filter update in the interval (uSec)
 
 	uORB::Publication<vehicle_local_position_s> _vehicle_local_position_pub;
 	uORB::Publication<vehicle_global_position_s> _vehicle_global_position_pub;
@@ -173,6 +239,36 @@ private:
 
 	parameters *_params;	///< pointer to ekf parameter struct (located in _ekf class instance)
 
+	Ekf2InstanceInputs _instance_inputs{};	///< non-IMU data of this iteration, for the additional EKF instances
+
+#ifdef EKF2_MULTI_INSTANCE_SUPPORTED
+	static constexpr int _max_instances = 4;	///< maximum number of EKF instances (including the main one)
+	static constexpr float _instance_switch_margin = 0.5f;	///< test ratio improvement needed to switch to a healthy instance
+	static constexpr hrt_abstime _instance_switch_holdoff_us = 10000000;	///< minimum time between switches to a healthy instance
+
+	Ekf2Instance *_instances[_max_instances - 1] {};	///< additional EKF instances
+	int _num_instances{1};			///< number of EKF instances (including the main one)
+	int _selected_instance{0};		///< instance used for the outputs (0: the main instance _ekf)
+	hrt_abstime _last_instance_switch_us{0};
+	float _test_ratio_filt{0.0f};		///< filtered innovation test ratio of the main instance
+	hrt_abstime _last_test_ratio_update_us{0};
+#endif
+
+	TerrainGrid _terrain_grid;		///< terrain altitudes measured by the range finder
+	float _terrain_vpos{0.0f};		///< vertical position of the terrain of the last published local position (m)
+	float _global_pos_x_last{0.0f};		///< local position of the last global position reprojection (m)
+	float _global_pos_y_last{0.0f};
+
+	// The reset counters of the outputs continue across a switch of the EKF instance
+	bool _instance_switched{false};		///< true until the outputs of a newly selected instance are published
+	matrix::Quatf _att_q_last;		///< last published attitude
+	uint8_t _quat_reset_counter_last{0};	///< last published quaternion reset counter
+	uint8_t _quat_reset_counter_offset{0};
+	uint8_t _z_reset_counter_offset{0};
+	uint8_t _vz_reset_counter_offset{0};
+	uint8_t _xy_reset_counter_offset{0};
+	uint8_t _vxy_reset_counter_offset{0};
+
 	BlockParamExtInt
 	_obs_dt_min_ms;	///< Maximmum time delay of any sensor used to increse buffer length to handle large timing jitter (mSec)
 	BlockParamExtFloat _mag_delay_ms;	///< magnetometer measurement delay relative to the IMU (mSec)
@@ -186,6 +282,7 @@ private:
 
 	BlockParamExtFloat _gyro_noise;	///< IMU angular rate noise used for covariance prediction (rad/sec)
 	BlockParamExtFloat _accel_noise;	///< IMU acceleration noise use for covariance prediction (m/sec**2)
+	BlockParamExtInt _cov_pred_dt_ms;	///< minimum time between covariance predictions (mSec)
 
 	// process noise
 	BlockParamExtFloat _gyro_bias_p_noise;	///< process noise for IMU rate gyro bias prediction (rad/sec**2)
@@ -279,6 +376,8 @@ private:
 	_arspFusionThreshold; 	///< A value of zero will disabled airspeed fusion. Any positive value sets the minimum airspeed which will be used (m/sec)
 	BlockParamInt _fuseBeta;		///< Controls synthetic sideslip fusion, 0 disables, 1 enables
 
+	BlockParamInt _terrain_grid_enabled;	///< remember the terrain measured by the range finder, 0 disables, 1 enables
+
 	// output predictor filter time constants
 	BlockParamExtFloat _tau_vel;		///< time constant used by the output velocity complementary filter (sec)
 	BlockParamExtFloat _tau_pos;		///< time constant used by the output position complementary filter (sec)
@@ -317,6 +416,8 @@ private:
 	BlockParamFloat _K_pstatic_coef_y;	///< static pressure position error coefficient along the Y body axis
 	BlockParamFloat _K_pstatic_coef_z;	///< static pressure position error coefficient along the Z body axis
 
+	BlockParamInt _multi_instances;	///< number of EKF instances
+
 	BlockParamInt _airspeed_disabled;	///< airspeed mode parameter
 
 };
@@ -336,6 +437,7 @@ Ekf2::Ekf2():
 	_ev_delay_ms(this, "EV_DELAY", true, _params->ev_delay_ms),
 	_gyro_noise(this, "GYR_NOISE", true, _params->gyro_noise),
 	_accel_noise(this, "ACC_NOISE", true, _params->accel_noise),
+	_cov_pred_dt_ms(this, "COV_PRED_DT", true, _params->cov_pred_dt_ms),
 	_gyro_bias_p_noise(this, "GYR_B_NOISE", true, _params->gyro_bias_p_noise),
 	_accel_bias_p_noise(this, "ACC_B_NOISE", true, _params->accel_bias_p_noise),
 	_mage_p_noise(this, "MAG_E_NOISE", true, _params->mage_p_noise),
@@ -406,6 +508,7 @@ Ekf2::Ekf2():
 	_ev_pos_z(this, "EV_POS_Z", true, _params->ev_pos_body(2)),
 	_arspFusionThreshold(this, "ARSP_THR"),
 	_fuseBeta(this, "FUSE_BETA"),
+	_terrain_grid_enabled(this, "TERR_GRID"),
 	_tau_vel(this, "TAU_VEL", true, _params->vel_Tau),
 	_tau_pos(this, "TAU_POS", true, _params->pos_Tau),
 	_gyr_bias_init(this, "GBIAS_INIT", true, _params->switch_on_gyro_bias),
@@ -429,16 +532,42 @@ Ekf2::Ekf2():
 	_K_pstatic_coef_xn(this, "PCOEF_XN"),
 	_K_pstatic_coef_y(this, "PCOEF_Y"),
 	_K_pstatic_coef_z(this, "PCOEF_Z"),
+	_multi_instances(this, "MULTI_INST"),
 	// non EKF2 parameters
 	_airspeed_disabled(this, "FW_ARSP_MODE", false)
 {
 }
 
+Ekf2::~Ekf2()
+{
+	perf_free(_perf_update);
+}
+
 int Ekf2::print_status()
 {
 	PX4_INFO("local position OK %s", (_ekf.local_position_is_valid()) ? "yes" : "no");
 	PX4_INFO("global position OK %s", (_ekf.global_position_is_valid()) ? "yes" : "no");
 	PX4_INFO("time slip: %" PRIu64 " us", _last_time_slip_us);
+	PX4_INFO("buffers: %u bytes", _ekf.get_buffer_memory_used());
+	perf_print_counter(_perf_update);
+
+#ifdef EKF2_MULTI_INSTANCE_SUPPORTED
+
+	if (_num_instances > 1) {
+		PX4_INFO("instance 0: test ratio %.2f%s", (double)_test_ratio_filt, _selected_instance == 0 ? " (selected)" : "");
+
+		for (int i = 1; i < _num_instances; i++) {
+			float test_ratio;
+			const bool healthy = _instances[i - 1]->get_health(hrt_absolute_time(), test_ratio);
+			_instances[i - 1]->lock();
+			const unsigned buffer_memory = _instances[i - 1]->ekf().get_buffer_memory_used();
+			_instances[i - 1]->unlock();
+			PX4_INFO("instance %i: test ratio %.2f%s%s, buffers: %u bytes", i, (double)test_ratio,
+				 healthy ? "" : " (unhealthy)", _selected_instance == i ? " (selected)" : "", buffer_memory);
+		}
+	}
+
+#endif
 	return 0;
 }
 
@@ -467,13 +596,52 @@ void Ekf2::run()
 		range_finder_subs[i] = orb_subscribe_multi(ORB_ID(distance_sensor), i);
 	}
 
-	px4_pollfd_struct_t fds[1] = {};
+	px4_pollfd_struct_t fds[2] = {};
 	fds[0].fd = sensors_sub;
 	fds[0].events = POLLIN;
+	unsigned num_fds = 1;
+	int replay_status_sub = -1;
+
+	if (_replay_mode) {
+		// the replay module announces every pass over the log: we restart for each pass after the first
+		replay_status_sub = orb_subscribe(ORB_ID(replay_status));
+		fds[1].fd = replay_status_sub;
+		fds[1].events = POLLIN;
+		num_fds = 2;
+	}
 
 	// initialise parameter cache
 	updateParams();
 
+#ifdef EKF2_MULTI_INSTANCE_SUPPORTED
+
+	// start the additional EKF instances, each using the IMU with the same index
+	if (!_replay_mode) {
+		const int num_instances = constrain(_multi_instances.get(), 1, _max_instances);
+
+		for (int i = 1; i < num_instances; i++) {
+			Ekf2Instance *instance = new Ekf2Instance(i, i);
+
+			if (instance == nullptr) {
+				PX4_ERR("alloc failed");
+				break;
+			}
+
+			instance->post_params(*_params);
+
+			if (instance->thread_start() != 0) {
+				PX4_ERR("instance %i: thread start failed", i);
+				delete instance;
+				break;
+			}
+
+			_instances[_num_instances - 1] = instance;
+			_num_instances++;
+		}
+	}
+
+#endif
+
 	// initialize data structures outside of loop
 	// because they will else not always be
 	// properly populated
@@ -490,24 +658,14 @@ void Ekf2::run()
 	sensor_baro_s sensor_baro = {};
 	sensor_baro.pressure = 1013.5; // initialise pressure to sea level
 
-	while (!should_exit()) {
-		int ret = px4_poll(fds, sizeof(fds) / sizeof(fds[0]), 1000);
-
-		if (!(fds[0].revents & POLLIN)) {
-			// no new data
-			continue;
-		}
-
-		if (ret < 0) {
-			// Poll error, sleep and try again
-			usleep(10000);
-			continue;
-
-		} else if (ret == 0) {
-			// Poll timeout or no new data, do nothing
-			continue;
-		}
+	if (_replay_restarted) {
+		// tell the replay module that we're ready for the data of the new pass
+		vehicle_attitude_s att = {};
+		_att_pub = orb_advertise(ORB_ID(vehicle_attitude), &att);
+	}
 
+	// one filter update with the latest sensor data
+	auto filter_update = [&]() {
 		bool params_updated = false;
 		orb_check(params_sub, &params_updated);
 
@@ -515,7 +673,15 @@ void Ekf2::run()
 			// read from param to clear updated flag
 			parameter_update_s update;
 			orb_copy(ORB_ID(parameter_update), params_sub, &update);
-			updateParams();
+			updateChangedParams();
+
+#ifdef EKF2_MULTI_INSTANCE_SUPPORTED
+
+			for (int i = 1; i < _num_instances; i++) {
+				_instances[i - 1]->post_params(*_params);
+			}
+
+#endif
 		}
 
 		bool gps_updated = false;
@@ -650,6 +816,22 @@ void Ekf2::run()
 
 		_ekf.setIMUData(now, sensors.gyro_integral_dt, sensors.accelerometer_integral_dt, gyro_integral, accel_integral);
 
+		// Publish the attitude and local position predicted with the new IMU sample before the other sensors are
+		// read and fused, this removes the fusion from the latency of the outputs. Replay mode keeps the publication
+		// after the update, the replay module synchronises with it.
+		bool output_published = false;
+
+#ifdef EKF2_MULTI_INSTANCE_SUPPORTED
+		const bool main_instance_selected = (_selected_instance == 0);
+#else
+		const bool main_instance_selected = true;
+#endif
+
+		if (main_instance_selected && !_replay_mode && _ekf.predictOutput()) {
+			publish_output(_ekf, now, sensors, sensors.gyro_rad);
+			output_published = true;
+		}
+
 		// read mag data
 		if (sensors.magnetometer_timestamp_relative == sensor_combined_s::RELATIVE_TIMESTAMP_INVALID) {
 			// set a zero timestamp to let the ekf replay program know that this data is not valid
@@ -708,6 +890,9 @@ void Ekf2::run()
 								    _mag_data_sum[2] *mag_sample_count_inv - _mag_bias_z.get()
 								   };
 					_ekf.setMagData(1000 * (uint64_t)mag_time_ms, mag_data_avg_ga);
+					_instance_inputs.mag_updated = true;
+					_instance_inputs.mag_time_us = 1000 * (uint64_t)mag_time_ms;
+					memcpy(_instance_inputs.mag_data, mag_data_avg_ga, sizeof(mag_data_avg_ga));
 					_mag_time_ms_last_used = mag_time_ms;
 					_mag_time_sum_ms = 0;
 					_mag_sample_count = 0;
@@ -765,6 +950,10 @@ void Ekf2::run()
 
 					// push to estimator
 					_ekf.setBaroData(1000 * (uint64_t)balt_time_ms, balt_data_avg);
+					_instance_inputs.baro_updated = true;
+					_instance_inputs.baro_time_us = 1000 * (uint64_t)balt_time_ms;
+					_instance_inputs.baro_alt = balt_data_avg;
+					_instance_inputs.air_density = rho;
 					_balt_time_ms_last_used = balt_time_ms;
 					_balt_time_sum_ms = 0;
 					_balt_sample_count = 0;
@@ -793,6 +982,10 @@ void Ekf2::run()
 			//TODO: add gdop to gps topic
 			gps_msg.gdop = 0.0f;
 
+			_instance_inputs.gps_updated = true;
+			_instance_inputs.gps_time_us = gps.timestamp;
+			_instance_inputs.gps = gps_msg;
+
 			_ekf.setGpsData(gps.timestamp, &gps_msg);
 		}
 
@@ -804,6 +997,10 @@ void Ekf2::run()
 		if (fuse_airspeed) {
 			float eas2tas = airspeed.true_airspeed_m_s / airspeed.indicated_airspeed_m_s;
 			_ekf.setAirspeedData(airspeed.timestamp, airspeed.true_airspeed_m_s, eas2tas);
+			_instance_inputs.airspeed_updated = true;
+			_instance_inputs.airspeed_time_us = airspeed.timestamp;
+			_instance_inputs.true_airspeed = airspeed.true_airspeed_m_s;
+			_instance_inputs.eas2tas = eas2tas;
 		}
 
 		if (vehicle_status_updated) {
@@ -813,6 +1010,10 @@ void Ekf2::run()
 
 			// let the EKF know if the vehicle motion is that of a fixed wing (forward flight only relative to wind)
 			_ekf.set_is_fixed_wing(!vehicle_status.is_rotary_wing);
+
+			_instance_inputs.vehicle_status_updated = true;
+			_instance_inputs.fuse_beta = fuse_beta;
+			_instance_inputs.is_fixed_wing = !vehicle_status.is_rotary_wing;
 		}
 
 		if (optical_flow_updated) {
@@ -828,11 +1029,17 @@ void Ekf2::run()
 			if (PX4_ISFINITE(optical_flow.pixel_flow_y_integral) &&
 			    PX4_ISFINITE(optical_flow.pixel_flow_x_integral)) {
 				_ekf.setOpticalFlowData(optical_flow.timestamp, &flow);
+				_instance_inputs.flow_updated = true;
+				_instance_inputs.flow_time_us = optical_flow.timestamp;
+				_instance_inputs.flow = flow;
 			}
 		}
 
 		if (range_finder_updated) {
 			_ekf.setRangeData(range_finder.timestamp, range_finder.current_distance);
+			_instance_inputs.range_updated = true;
+			_instance_inputs.range_time_us = range_finder.timestamp;
+			_instance_inputs.range = range_finder.current_distance;
 		}
 
 		// get external vision data
@@ -851,6 +1058,9 @@ void Ekf2::run()
 
 			// use timestamp from external computer, clocks are synchronized when using MAVROS
 			_ekf.setExtVisionData(vision_position_updated ? ev_pos.timestamp : ev_att.timestamp, &ev_data);
+			_instance_inputs.ev_updated = true;
+			_instance_inputs.ev_time_us = vision_position_updated ? ev_pos.timestamp : ev_att.timestamp;
+			_instance_inputs.ev = ev_data;
 		}
 
 		orb_check(vehicle_land_detected_sub, &vehicle_land_detected_updated);
@@ -858,10 +1068,53 @@ void Ekf2::run()
 		if (vehicle_land_detected_updated) {
 			orb_copy(ORB_ID(vehicle_land_detected), vehicle_land_detected_sub, &vehicle_land_detected);
 			_ekf.set_in_air_status(!vehicle_land_detected.landed);
+			_instance_inputs.land_detected_updated = true;
+			_instance_inputs.in_air = !vehicle_land_detected.landed;
+		}
+
+#ifdef EKF2_MULTI_INSTANCE_SUPPORTED
+
+		for (int i = 1; i < _num_instances; i++) {
+			_instances[i - 1]->post_inputs(_instance_inputs);
 		}
 
+#endif
+		_instance_inputs.clear_updated();
+
 		// run the EKF update and output
-		if (_ekf.update()) {
+		perf_begin(_perf_update);
+		const hrt_abstime update_start = hrt_absolute_time();
+		const bool ekf_updated = _ekf.update();
+		const hrt_abstime update_end = hrt_absolute_time();
+		perf_end(_perf_update);
+		update_timing(update_end, (uint32_t)(update_end - update_start));
+
+#ifdef EKF2_MULTI_INSTANCE_SUPPORTED
+		Ekf2Instance *selected_instance = nullptr;
+
+		if (_num_instances > 1) {
+			if (ekf_updated) {
+				select_instance(now);
+			}
+
+			if (_selected_instance > 0) {
+				selected_instance = _instances[_selected_instance - 1];
+				selected_instance->lock();
+			}
+		}
+
+		// the outputs are taken from the selected instance
+		Ekf &ekf = selected_instance ? selected_instance->ekf() : _ekf;
+		const float *gyro_rad = selected_instance ? selected_instance->imu().gyro_rad : sensors.gyro_rad;
+		const float *accel_m_s2 = selected_instance ? selected_instance->imu().accelerometer_m_s2 :
+					  sensors.accelerometer_m_s2;
+#else
+		Ekf &ekf = _ekf;
+		const float *gyro_rad = sensors.gyro_rad;
+		const float *accel_m_s2 = sensors.accelerometer_m_s2;
+#endif
+
+		if (ekf_updated) {
 
 			// integrate time to monitor time slippage
 			if (_start_time_us == 0) {
@@ -872,149 +1125,58 @@ void Ekf2::run()
 			}
 
 			matrix::Quatf q;
-			_ekf.copy_quaternion(q.data());
+			ekf.copy_quaternion(q.data());
 
 			// In-run bias estimates
 			float gyro_bias[3];
-			_ekf.get_gyro_bias(gyro_bias);
-
-			{
-				// generate vehicle attitude quaternion data
-				vehicle_attitude_s att;
-				att.timestamp = now;
-
-				q.copyTo(att.q);
-				_ekf.get_quat_reset(&att.delta_q_reset[0], &att.quat_reset_counter);
-
-				att.rollspeed = sensors.gyro_rad[0] - gyro_bias[0];
-				att.pitchspeed = sensors.gyro_rad[1] - gyro_bias[1];
-				att.yawspeed = sensors.gyro_rad[2] - gyro_bias[2];
-
-				// publish vehicle attitude data
-				if (_att_pub == nullptr) {
-					_att_pub = orb_advertise(ORB_ID(vehicle_attitude), &att);
+			ekf.get_gyro_bias(gyro_bias);
 
-				} else {
-					orb_publish(ORB_ID(vehicle_attitude), _att_pub, &att);
-				}
-			}
-
-			// generate vehicle local position data
-			vehicle_local_position_s &lpos = _vehicle_local_position_pub.get();
-
-			lpos.timestamp = now;
-
-			// Position of body origin in local NED frame
-			float position[3];
-			_ekf.get_position(position);
-			const float lpos_x_prev = lpos.x;
-			const float lpos_y_prev = lpos.y;
-			lpos.x = (_ekf.local_position_is_valid()) ? position[0] : 0.0f;
-			lpos.y = (_ekf.local_position_is_valid()) ? position[1] : 0.0f;
-			lpos.z = position[2];
-
-			// Velocity of body origin in local NED frame (m/s)
-			float velocity[3];
-			_ekf.get_velocity(velocity);
-
-			lpos.vx = velocity[0];
-			lpos.vy = velocity[1];
-			lpos.vz = velocity[2];
-
-			float pos_d_deriv;
-			_ekf.get_pos_d_deriv(&pos_d_deriv);
-			lpos.z_deriv = pos_d_deriv; // vertical position time derivative (m/s)
-
-			// Acceleration of body origin in local NED frame
-			float vel_deriv[3] = {};
-			_ekf.get_vel_deriv_ned(vel_deriv);
-			lpos.ax = vel_deriv[0];
-			lpos.ay = vel_deriv[1];
-			lpos.az = vel_deriv[2];
-
-			// TODO: better status reporting
-			lpos.xy_valid = _ekf.local_position_is_valid() && !_vel_innov_preflt_fail;
-			lpos.z_valid = !_vel_innov_preflt_fail;
-			lpos.v_xy_valid = _ekf.local_position_is_valid() && !_vel_innov_preflt_fail;
-			lpos.v_z_valid = !_vel_innov_preflt_fail;
-
-			// Position of local NED origin in GPS / WGS84 frame
-			map_projection_reference_s ekf_origin = {};
-			uint64_t origin_time = 0;
-
-			// true if position (x,y,z) has a valid WGS-84 global reference (ref_lat, ref_lon, alt)
-			const bool ekf_origin_valid = _ekf.get_ekf_origin(&origin_time, &ekf_origin, &lpos.ref_alt);
-			lpos.xy_global = ekf_origin_valid;
-			lpos.z_global = ekf_origin_valid;
-
-			if (ekf_origin_valid && (origin_time > lpos.ref_timestamp)) {
-				lpos.ref_timestamp = origin_time;
-				lpos.ref_lat = ekf_origin.lat_rad * 180.0 / M_PI; // Reference point latitude in degrees
-				lpos.ref_lon = ekf_origin.lon_rad * 180.0 / M_PI; // Reference point longitude in degrees
-			}
-
-			// The rotation of the tangent plane vs. geographical north
-			matrix::Eulerf euler(q);
-			lpos.yaw = euler.psi();
-
-			lpos.dist_bottom_valid = _ekf.get_terrain_valid();
-
-			float terrain_vpos;
-			_ekf.get_terrain_vert_pos(&terrain_vpos);
-			lpos.dist_bottom = terrain_vpos - position[2]; // Distance to bottom surface (ground) in meters
-
-			// constrain the distance to ground to _params->rng_gnd_clearance
-			if (lpos.dist_bottom < _params->rng_gnd_clearance) {
-				lpos.dist_bottom = _params->rng_gnd_clearance;
+			if (!output_published || &ekf != &_ekf) {
+				publish_output(ekf, now, sensors, gyro_rad);
 			}
 
-			lpos.dist_bottom_rate = -velocity[2]; // Distance to bottom surface (ground) change rate
-
-			bool dead_reckoning;
-			_ekf.get_ekf_lpos_accuracy(&lpos.eph, &lpos.epv, &dead_reckoning);
-			_ekf.get_ekf_vel_accuracy(&lpos.evh, &lpos.evv, &dead_reckoning);
-
-			// get state reset information of position and velocity
-			_ekf.get_posD_reset(&lpos.delta_z, &lpos.z_reset_counter);
-			_ekf.get_velD_reset(&lpos.delta_vz, &lpos.vz_reset_counter);
-			_ekf.get_posNE_reset(&lpos.delta_xy[0], &lpos.xy_reset_counter);
-			_ekf.get_velNE_reset(&lpos.delta_vxy[0], &lpos.vxy_reset_counter);
-
-			// publish vehicle local position data
-			_vehicle_local_position_pub.update();
+			const vehicle_local_position_s &lpos = _vehicle_local_position_pub.get();
+			const float velocity[3] = {lpos.vx, lpos.vy, lpos.vz};
 
-			if (_ekf.global_position_is_valid() && !_vel_innov_preflt_fail) {
+			if (ekf.global_position_is_valid() && !_vel_innov_preflt_fail) {
 				// generate and publish global position data
 				vehicle_global_position_s &global_pos = _vehicle_global_position_pub.get();
 
 				global_pos.timestamp = now;
 
-				if (fabsf(lpos_x_prev - lpos.x) > FLT_EPSILON || fabsf(lpos_y_prev - lpos.y) > FLT_EPSILON) {
-					map_projection_reproject(&ekf_origin, lpos.x, lpos.y, &global_pos.lat, &global_pos.lon);
+				if (fabsf(_global_pos_x_last - lpos.x) > FLT_EPSILON || fabsf(_global_pos_y_last - lpos.y) > FLT_EPSILON) {
+					map_projection_reference_s ekf_origin = {};
+					uint64_t origin_time = 0;
+					float ref_alt = 0.0f;
+					ekf.get_ekf_origin(&origin_time, &ekf_origin, &ref_alt);
+					map_projection_reproject_local(&ekf_origin, lpos.x, lpos.y, &global_pos.lat, &global_pos.lon);
+					_global_pos_x_last = lpos.x;
+					_global_pos_y_last = lpos.y;
 				}
 
 				global_pos.lat_lon_reset_counter = lpos.xy_reset_counter;
 
-				global_pos.alt = -position[2] + lpos.ref_alt; // Altitude AMSL in meters
-				_ekf.get_posD_reset(&global_pos.delta_alt, &global_pos.alt_reset_counter);
+				global_pos.alt = -lpos.z + lpos.ref_alt; // Altitude AMSL in meters
+				global_pos.delta_alt = lpos.delta_z;
+				global_pos.alt_reset_counter = lpos.z_reset_counter;
 				// global altitude has opposite sign of local down position
 				global_pos.delta_alt *= -1.0f;
 
 				global_pos.vel_n = velocity[0]; // Ground north velocity, m/s
 				global_pos.vel_e = velocity[1]; // Ground east velocity, m/s
 				global_pos.vel_d = velocity[2]; // Ground downside velocity, m/s
-				global_pos.pos_d_deriv = pos_d_deriv; // vertical position time derivative, m/s
+				global_pos.pos_d_deriv = lpos.z_deriv; // vertical position time derivative, m/s
 
-				global_pos.yaw = euler.psi(); // Yaw in radians -PI..+PI.
+				global_pos.yaw = lpos.yaw; // Yaw in radians -PI..+PI.
 
-				_ekf.get_ekf_gpos_accuracy(&global_pos.eph, &global_pos.epv, &global_pos.dead_reckoning);
+				ekf.get_ekf_gpos_accuracy(&global_pos.eph, &global_pos.epv, &global_pos.dead_reckoning);
 				global_pos.evh = lpos.evh;
 				global_pos.evv = lpos.evv;
 
 				global_pos.terrain_alt_valid = lpos.dist_bottom_valid;
 
 				if (global_pos.terrain_alt_valid) {
-					global_pos.terrain_alt = lpos.ref_alt - terrain_vpos; // Terrain altitude in m, WGS84
+					global_pos.terrain_alt = lpos.ref_alt - _terrain_vpos; // Terrain altitude in m, WGS84
 
 				} else {
 					global_pos.terrain_alt = 0.0f; // Terrain altitude in m, WGS84
@@ -1022,7 +1184,7 @@ void Ekf2::run()
 
 				global_pos.pressure_alt = sensors.baro_alt_meter; // Pressure altitude AMSL (m)
 
-				global_pos.dead_reckoning = _ekf.inertial_dead_reckoning(); // True if this position is estimated through dead-reckoning
+				global_pos.dead_reckoning = ekf.inertial_dead_reckoning(); // True if this position is estimated through dead-reckoning
 
 				_vehicle_global_position_pub.update();
 			}
@@ -1030,19 +1192,19 @@ void Ekf2::run()
 			{
 				// publish all corrected sensor readings and bias estimates after mag calibration is updated above
 				float accel_bias[3];
-				_ekf.get_accel_bias(accel_bias);
+				ekf.get_accel_bias(accel_bias);
 
 				sensor_bias_s bias;
 
 				bias.timestamp = now;
 
-				bias.gyro_x = sensors.gyro_rad[0] - gyro_bias[0];
-				bias.gyro_y = sensors.gyro_rad[1] - gyro_bias[1];
-				bias.gyro_z = sensors.gyro_rad[2] - gyro_bias[2];
+				bias.gyro_x = gyro_rad[0] - gyro_bias[0];
+				bias.gyro_y = gyro_rad[1] - gyro_bias[1];
+				bias.gyro_z = gyro_rad[2] - gyro_bias[2];
 
-				bias.accel_x = sensors.accelerometer_m_s2[0] - accel_bias[0];
-				bias.accel_y = sensors.accelerometer_m_s2[1] - accel_bias[1];
-				bias.accel_z = sensors.accelerometer_m_s2[2] - accel_bias[2];
+				bias.accel_x = accel_m_s2[0] - accel_bias[0];
+				bias.accel_y = accel_m_s2[1] - accel_bias[1];
+				bias.accel_z = accel_m_s2[2] - accel_bias[2];
 
 				bias.mag_x = sensors.magnetometer_ga[0] - (_last_valid_mag_cal[0] / 1000.0f); // mGauss -> Gauss
 				bias.mag_y = sensors.magnetometer_ga[1] - (_last_valid_mag_cal[1] / 1000.0f); // mGauss -> Gauss
@@ -1072,20 +1234,20 @@ void Ekf2::run()
 				// publish estimator status
 				estimator_status_s status;
 				status.timestamp = now;
-				_ekf.get_state_delayed(status.states);
-				_ekf.get_covariances(status.covariances);
-				_ekf.get_gps_check_status(&status.gps_check_fail_flags);
-				_ekf.get_control_mode(&status.control_mode_flags);
-				_ekf.get_filter_fault_status(&status.filter_fault_flags);
-				_ekf.get_innovation_test_status(&status.innovation_check_flags, &status.mag_test_ratio,
+				ekf.get_state_delayed(status.states);
+				ekf.get_covariances(status.covariances);
+				ekf.get_gps_check_status(&status.gps_check_fail_flags);
+				ekf.get_control_mode(&status.control_mode_flags);
+				ekf.get_filter_fault_status(&status.filter_fault_flags);
+				ekf.get_innovation_test_status(&status.innovation_check_flags, &status.mag_test_ratio,
 								&status.vel_test_ratio, &status.pos_test_ratio,
 								&status.hgt_test_ratio, &status.tas_test_ratio,
 								&status.hagl_test_ratio);
 
 				status.pos_horiz_accuracy = lpos.eph;
 				status.pos_vert_accuracy = lpos.epv;
-				_ekf.get_ekf_soln_status(&status.solution_status_flags);
-				_ekf.get_imu_vibe_metrics(status.vibe);
+				ekf.get_ekf_soln_status(&status.solution_status_flags);
+				ekf.get_imu_vibe_metrics(status.vibe);
 
 				// monitor time slippage
 				if (_start_time_us != 0 && now > _start_time_us) {
@@ -1179,7 +1341,7 @@ void Ekf2::run()
 
 				{
 					float velNE_wind[2];
-					_ekf.get_wind_velocity(velNE_wind);
+					ekf.get_wind_velocity(velNE_wind);
 
 					// Calculate wind-compensated velocity in body frame
 					Vector3f v_wind_comp(velocity);
@@ -1209,25 +1371,25 @@ void Ekf2::run()
 				// publish estimator innovation data
 				ekf2_innovations_s innovations;
 				innovations.timestamp = now;
-				_ekf.get_vel_pos_innov(&innovations.vel_pos_innov[0]);
-				_ekf.get_mag_innov(&innovations.mag_innov[0]);
-				_ekf.get_heading_innov(&innovations.heading_innov);
-				_ekf.get_airspeed_innov(&innovations.airspeed_innov);
-				_ekf.get_beta_innov(&innovations.beta_innov);
-				_ekf.get_flow_innov(&innovations.flow_innov[0]);
-				_ekf.get_hagl_innov(&innovations.hagl_innov);
-				_ekf.get_drag_innov(&innovations.drag_innov[0]);
-
-				_ekf.get_vel_pos_innov_var(&innovations.vel_pos_innov_var[0]);
-				_ekf.get_mag_innov_var(&innovations.mag_innov_var[0]);
-				_ekf.get_heading_innov_var(&innovations.heading_innov_var);
-				_ekf.get_airspeed_innov_var(&innovations.airspeed_innov_var);
-				_ekf.get_beta_innov_var(&innovations.beta_innov_var);
-				_ekf.get_flow_innov_var(&innovations.flow_innov_var[0]);
-				_ekf.get_hagl_innov_var(&innovations.hagl_innov_var);
-				_ekf.get_drag_innov_var(&innovations.drag_innov_var[0]);
-
-				_ekf.get_output_tracking_error(&innovations.output_tracking_error[0]);
+				ekf.get_vel_pos_innov(&innovations.vel_pos_innov[0]);
+				ekf.get_mag_innov(&innovations.mag_innov[0]);
+				ekf.get_heading_innov(&innovations.heading_innov);
+				ekf.get_airspeed_innov(&innovations.airspeed_innov);
+				ekf.get_beta_innov(&innovations.beta_innov);
+				ekf.get_flow_innov(&innovations.flow_innov[0]);
+				ekf.get_hagl_innov(&innovations.hagl_innov);
+				ekf.get_drag_innov(&innovations.drag_innov[0]);
+
+				ekf.get_vel_pos_innov_var(&innovations.vel_pos_innov_var[0]);
+				ekf.get_mag_innov_var(&innovations.mag_innov_var[0]);
+				ekf.get_heading_innov_var(&innovations.heading_innov_var);
+				ekf.get_airspeed_innov_var(&innovations.airspeed_innov_var);
+				ekf.get_beta_innov_var(&innovations.beta_innov_var);
+				ekf.get_flow_innov_var(&innovations.flow_innov_var[0]);
+				ekf.get_hagl_innov_var(&innovations.hagl_innov_var);
+				ekf.get_drag_innov_var(&innovations.drag_innov_var[0]);
+
+				ekf.get_output_tracking_error(&innovations.output_tracking_error[0]);
 
 				// calculate noise filtered velocity innovations which are used for pre-flight checking
 				if (vehicle_status.arming_state == vehicle_status_s::ARMING_STATE_STANDBY) {
@@ -1258,6 +1420,8 @@ void Ekf2::run()
 				}
 			}
 
+			_instance_switched = false;
+
 		} else if (_replay_mode) {
 			// in replay mode we have to tell the replay module not to wait for an update
 			// we do this by publishing an attitude with zero timestamp
@@ -1272,6 +1436,14 @@ void Ekf2::run()
 			}
 		}
 
+#ifdef EKF2_MULTI_INSTANCE_SUPPORTED
+
+		if (selected_instance != nullptr) {
+			selected_instance->unlock();
+		}
+
+#endif
+
 		{
 			// publish ekf2_timestamps (using 0.1 ms relative timestamps)
 			ekf2_timestamps_s ekf2_timestamps;
@@ -1332,8 +1504,83 @@ void Ekf2::run()
 				orb_publish(ORB_ID(ekf2_timestamps), _ekf2_timestamps_pub, &ekf2_timestamps);
 			}
 		}
+	};
+
+	// the replay module announces every pass over the log: we restart for each pass after the first
+	auto replay_restart_requested = [&]() {
+		if (replay_status_sub >= 0 && (fds[1].revents & POLLIN)) {
+			replay_status_s replay_status;
+			orb_copy(ORB_ID(replay_status), replay_status_sub, &replay_status);
+
+			if (replay_status.pass > 0) {
+				_replay_restart = true;
+			}
+		}
+
+		return _replay_restart;
+	};
+
+	if (_replay_direct) {
+		// direct replay: the replay module runs the filter updates in its thread, from within the
+		// publication of sensor_combined, so there is no wakeup and no handshake per sample
+		using FilterUpdate = decltype(filter_update);
+		uORB::SubscriptionCallback direct_callback(ORB_ID(sensor_combined), [](void *arg) { (*(FilterUpdate *)arg)(); },
+				&filter_update, uORB::SubscriptionCallback::DIRECT);
+
+		if (!direct_callback.register_callback()) {
+			PX4_ERR("direct replay: callback registration failed");
+
+		} else {
+			while (!should_exit()) {
+				px4_poll(&fds[1], 1, 1000);
+
+				if (replay_restart_requested()) {
+					break;
+				}
+			}
+
+			direct_callback.unregister_callback();
+		}
+
+	} else {
+		while (!should_exit()) {
+			int ret = px4_poll(fds, num_fds, 1000);
+
+			if (replay_restart_requested()) {
+				break;
+			}
+
+			if (!(fds[0].revents & POLLIN)) {
+				// no new data
+				continue;
+			}
+
+			if (ret < 0) {
+				// Poll error, sleep and try again
+				usleep(10000);
+				continue;
+
+			} else if (ret == 0) {
+				// Poll timeout or no new data, do nothing
+				continue;
+			}
+
+			filter_update();
+		}
 	}
 
+#ifdef EKF2_MULTI_INSTANCE_SUPPORTED
+
+	for (int i = 1; i < _num_instances; i++) {
+		_instances[i - 1]->thread_stop();
+		delete _instances[i - 1];
+		_instances[i - 1] = nullptr;
+	}
+
+	_num_instances = 1;
+
+#endif
+
 	orb_unsubscribe(sensors_sub);
 	orb_unsubscribe(gps_sub);
 	orb_unsubscribe(airspeed_sub);
@@ -1346,12 +1593,293 @@ void Ekf2::run()
 	orb_unsubscribe(sensor_selection_sub);
 	orb_unsubscribe(sensor_baro_sub);
 
+	if (replay_status_sub >= 0) {
+		orb_unsubscribe(replay_status_sub);
+	}
+
 	for (unsigned i = 0; i < ORB_MULTI_MAX_INSTANCES; i++) {
 		orb_unsubscribe(range_finder_subs[i]);
 		range_finder_subs[i] = -1;
 	}
 }
 
+void Ekf2::publish_output(Ekf &ekf, hrt_abstime now, const sensor_combined_s &sensors, const float *gyro_rad)
+{
+	matrix::Quatf q;
+	ekf.copy_quaternion(q.data());
+
+	float gyro_bias[3];
+	ekf.get_gyro_bias(gyro_bias);
+
+	{
+		// generate vehicle attitude quaternion data
+		vehicle_attitude_s att;
+		att.timestamp = now;
+		att.timestamp_sample = sensors.timestamp;
+
+		q.copyTo(att.q);
+		set_attitude_representations(att);
+		ekf.get_quat_reset(&att.delta_q_reset[0], &att.quat_reset_counter);
+
+		if (_instance_switched) {
+			// report the switch of the EKF instance as a reset of the attitude
+			matrix::Quatf delta_q_reset = _att_q_last.inversed() * q;
+			delta_q_reset.copyTo(att.delta_q_reset);
+		}
+
+		continue_reset_counter(att.quat_reset_counter, _quat_reset_counter_last, _quat_reset_counter_offset);
+		_att_q_last = q;
+		_quat_reset_counter_last = att.quat_reset_counter;
+
+		att.rollspeed = gyro_rad[0] - gyro_bias[0];
+		att.pitchspeed = gyro_rad[1] - gyro_bias[1];
+		att.yawspeed = gyro_rad[2] - gyro_bias[2];
+
+		// publish vehicle attitude data
+		if (_att_pub == nullptr) {
+			_att_pub = orb_advertise(ORB_ID(vehicle_attitude), &att);
+
+		} else {
+			orb_publish(ORB_ID(vehicle_attitude), _att_pub, &att);
+		}
+	}
+
+	// generate vehicle local position data
+	vehicle_local_position_s &lpos = _vehicle_local_position_pub.get();
+
+	lpos.timestamp = now;
+
+	// Position of body origin in local NED frame
+	float position[3];
+	ekf.get_position(position);
+	const float lpos_x_prev = lpos.x;
+	const float lpos_y_prev = lpos.y;
+	const float lpos_z_prev = lpos.z;
+	const float lpos_vx_prev = lpos.vx;
+	const float lpos_vy_prev = lpos.vy;
+	const float lpos_vz_prev = lpos.vz;
+	lpos.x = (ekf.local_position_is_valid()) ? position[0] : 0.0f;
+	lpos.y = (ekf.local_position_is_valid()) ? position[1] : 0.0f;
+	lpos.z = position[2];
+
+	// Velocity of body origin in local NED frame (m/s)
+	float velocity[3];
+	ekf.get_velocity(velocity);
+
+	lpos.vx = velocity[0];
+	lpos.vy = velocity[1];
+	lpos.vz = velocity[2];
+
+	float pos_d_deriv;
+	ekf.get_pos_d_deriv(&pos_d_deriv);
+	lpos.z_deriv = pos_d_deriv; // vertical position time derivative (m/s)
+
+	// Acceleration of body origin in local NED frame
+	float vel_deriv[3] = {};
+	ekf.get_vel_deriv_ned(vel_deriv);
+	lpos.ax = vel_deriv[0];
+	lpos.ay = vel_deriv[1];
+	lpos.az = vel_deriv[2];
+
+	// TODO: better status reporting
+	lpos.xy_valid = ekf.local_position_is_valid() && !_vel_innov_preflt_fail;
+	lpos.z_valid = !_vel_innov_preflt_fail;
+	lpos.v_xy_valid = ekf.local_position_is_valid() && !_vel_innov_preflt_fail;
+	lpos.v_z_valid = !_vel_innov_preflt_fail;
+
+	// Position of local NED origin in GPS / WGS84 frame
+	map_projection_reference_s ekf_origin = {};
+	uint64_t origin_time = 0;
+
+	// true if position (x,y,z) has a valid WGS-84 global reference (ref_lat, ref_lon, alt)
+	const bool ekf_origin_valid = ekf.get_ekf_origin(&origin_time, &ekf_origin, &lpos.ref_alt);
+	lpos.xy_global = ekf_origin_valid;
+	lpos.z_global = ekf_origin_valid;
+
+	if (ekf_origin_valid && (origin_time > lpos.ref_timestamp)) {
+		lpos.ref_timestamp = origin_time;
+		lpos.ref_lat = ekf_origin.lat_rad * 180.0 / M_PI; // Reference point latitude in degrees
+		lpos.ref_lon = ekf_origin.lon_rad * 180.0 / M_PI; // Reference point longitude in degrees
+	}
+
+	// The rotation of the tangent plane vs. geographical north
+	matrix::Eulerf euler(q);
+	lpos.yaw = euler.psi();
+
+	lpos.dist_bottom_valid = ekf.get_terrain_valid();
+
+	ekf.get_terrain_vert_pos(&_terrain_vpos);
+
+	if (_terrain_grid_enabled.get() == 1 && ekf_origin_valid && ekf.local_position_is_valid()) {
+		double lat;
+		double lon;
+		map_projection_reproject_local(&ekf_origin, lpos.x, lpos.y, &lat, &lon);
+
+		if (lpos.dist_bottom_valid) {
+			_terrain_grid.update(lat, lon, lpos.ref_alt - _terrain_vpos);
+
+		} else {
+			// no range finder estimate: use the terrain measured when we have been here before
+			float terrain_alt;
+
+			if (_terrain_grid.get(lat, lon, terrain_alt)) {
+				_terrain_vpos = lpos.ref_alt - terrain_alt;
+				lpos.dist_bottom_valid = true;
+			}
+		}
+	}
+
+	lpos.dist_bottom = _terrain_vpos - position[2]; // Distance to bottom surface (ground) in meters
+
+	// constrain the distance to ground to _params->rng_gnd_clearance
+	if (lpos.dist_bottom < _params->rng_gnd_clearance) {
+		lpos.dist_bottom = _params->rng_gnd_clearance;
+	}
+
+	lpos.dist_bottom_rate = -velocity[2]; // Distance to bottom surface (ground) change rate
+
+	bool dead_reckoning;
+	ekf.get_ekf_lpos_accuracy(&lpos.eph, &lpos.epv, &dead_reckoning);
+	ekf.get_ekf_vel_accuracy(&lpos.evh, &lpos.evv, &dead_reckoning);
+
+	// get state reset information of position and velocity
+	const uint8_t z_reset_counter_prev = lpos.z_reset_counter;
+	const uint8_t vz_reset_counter_prev = lpos.vz_reset_counter;
+	const uint8_t xy_reset_counter_prev = lpos.xy_reset_counter;
+	const uint8_t vxy_reset_counter_prev = lpos.vxy_reset_counter;
+	ekf.get_posD_reset(&lpos.delta_z, &lpos.z_reset_counter);
+	ekf.get_velD_reset(&lpos.delta_vz, &lpos.vz_reset_counter);
+	ekf.get_posNE_reset(&lpos.delta_xy[0], &lpos.xy_reset_counter);
+	ekf.get_velNE_reset(&lpos.delta_vxy[0], &lpos.vxy_reset_counter);
+
+	if (_instance_switched) {
+		// report the switch of the EKF instance as a reset of the position and velocity
+		lpos.delta_z = lpos.z - lpos_z_prev;
+		lpos.delta_vz = lpos.vz - lpos_vz_prev;
+		lpos.delta_xy[0] = lpos.x - lpos_x_prev;
+		lpos.delta_xy[1] = lpos.y - lpos_y_prev;
+		lpos.delta_vxy[0] = lpos.vx - lpos_vx_prev;
+		lpos.delta_vxy[1] = lpos.vy - lpos_vy_prev;
+	}
+
+	continue_reset_counter(lpos.z_reset_counter, z_reset_counter_prev, _z_reset_counter_offset);
+	continue_reset_counter(lpos.vz_reset_counter, vz_reset_counter_prev, _vz_reset_counter_offset);
+	continue_reset_counter(lpos.xy_reset_counter, xy_reset_counter_prev, _xy_reset_counter_offset);
+	continue_reset_counter(lpos.vxy_reset_counter, vxy_reset_counter_prev, _vxy_reset_counter_offset);
+
+	// publish vehicle local position data
+	_vehicle_local_position_pub.update();
+}
+
+void Ekf2::update_timing(hrt_abstime now, uint32_t update_time_us)
+{
+	if (_timing_start_us == 0) {
+		_timing_start_us = now;
+		_ekf.get_stage_times(_stage_times_last_us);
+		return;
+	}
+
+	_timing_num_updates++;
+	_timing_update_total_us += update_time_us;
+	_timing_update_max_us = math::max(_timing_update_max_us, update_time_us);
+
+	if (now - _timing_start_us < _timing_interval_us) {
+		return;
+	}
+
+	uint64_t stage_times_us[TIMING_NUM_STAGES];
+	_ekf.get_stage_times(stage_times_us);
+	uint32_t stage_us[TIMING_NUM_STAGES];
+
+	for (int i = 0; i < TIMING_NUM_STAGES; i++) {
+		stage_us[i] = (uint32_t)(stage_times_us[i] - _stage_times_last_us[i]);
+		_stage_times_last_us[i] = stage_times_us[i];
+	}
+
+	estimator_timing_s timing = {};
+	timing.timestamp = now;
+	timing.interval_us = (uint32_t)(now - _timing_start_us);
+	timing.num_updates = _timing_num_updates;
+	timing.update_total_us = _timing_update_total_us;
+	timing.update_max_us = _timing_update_max_us;
+	timing.predict_state_us = stage_us[TIMING_PREDICT_STATE];
+	timing.predict_covariance_us = stage_us[TIMING_PREDICT_COVARIANCE];
+	timing.control_us = stage_us[TIMING_CONTROL];
+	timing.mag_us = stage_us[TIMING_MAG];
+	timing.optical_flow_us = stage_us[TIMING_OPTICAL_FLOW];
+	timing.gps_us = stage_us[TIMING_GPS];
+	timing.air_data_us = stage_us[TIMING_AIR_DATA];
+	timing.beta_us = stage_us[TIMING_BETA];
+	timing.drag_us = stage_us[TIMING_DRAG];
+	timing.height_us = stage_us[TIMING_HEIGHT];
+	timing.vel_pos_us = stage_us[TIMING_VEL_POS];
+	timing.ext_vision_us = stage_us[TIMING_EXT_VISION];
+	timing.terrain_us = stage_us[TIMING_TERRAIN];
+	timing.output_states_us = stage_us[TIMING_OUTPUT_STATES];
+
+	if (_estimator_timing_pub == nullptr) {
+		_estimator_timing_pub = orb_advertise(ORB_ID(estimator_timing), &timing);
+
+	} else {
+		orb_publish(ORB_ID(estimator_timing), _estimator_timing_pub, &timing);
+	}
+
+	_timing_start_us = now;
+	_timing_num_updates = 0;
+	_timing_update_total_us = 0;
+	_timing_update_max_us = 0;
+}
+
+#ifdef EKF2_MULTI_INSTANCE_SUPPORTED
+void Ekf2::select_instance(hrt_abstime now)
+{
+	// health of the main instance, it is updated by this task
+	if (_last_test_ratio_update_us > 0) {
+		ekf2_update_test_ratio(_ekf, (now - _last_test_ratio_update_us) * 1e-6f, _test_ratio_filt);
+	}
+
+	_last_test_ratio_update_us = now;
+
+	uint32_t control_mode;
+	_ekf.get_control_mode(&control_mode);
+
+	bool healthy[_max_instances];
+	float test_ratio[_max_instances];
+	healthy[0] = control_mode & 1; // tilt aligned
+	test_ratio[0] = _test_ratio_filt;
+
+	for (int i = 1; i < _num_instances; i++) {
+		healthy[i] = _instances[i - 1]->get_health(now, test_ratio[i]);
+	}
+
+	// find the healthy instance with the lowest test ratio
+	int best = -1;
+
+	for (int i = 0; i < _num_instances; i++) {
+		if (healthy[i] && (best < 0 || test_ratio[i] < test_ratio[best])) {
+			best = i;
+		}
+	}
+
+	if (best < 0 || best == _selected_instance) {
+		return;
+	}
+
+	// switch away from an unhealthy instance immediately, otherwise only if the other instance is
+	// clearly better and the last switch is not too recent
+	const bool switch_instance = !healthy[_selected_instance]
+				     || ((test_ratio[_selected_instance] - test_ratio[best] > _instance_switch_margin)
+					 && (now > _last_instance_switch_us + _instance_switch_holdoff_us));
+
+	if (switch_instance) {
+		PX4_WARN("switching to EKF instance %i", best);
+		_selected_instance = best;
+		_last_instance_switch_us = now;
+		_instance_switched = true;
+	}
+}
+#endif
+
 int Ekf2::getRangeSubIndex(const int *subs)
 {
 	for (unsigned i = 0; i < ORB_MULTI_MAX_INSTANCES; i++) {
@@ -1380,12 +1908,65 @@ Ekf2 *Ekf2::instantiate(int argc, char *argv[])
 	if (instance) {
 		if (argc >= 2 && !strcmp(argv[1], "-r")) {
 			instance->set_replay_mode(true);
+
+		} else if (argc >= 2 && !strcmp(argv[1], "-d")) {
+			instance->set_replay_mode(true);
+			instance->set_replay_direct(true);
 		}
 	}
 
 	return instance;
 }
 
+void Ekf2::run_trampoline_restartable(int argc, char *argv[])
+{
+#ifdef __PX4_NUTTX
+	// on NuttX task_create() adds the task name as first argument
+	argc -= 1;
+	argv += 1;
+#endif
+
+	_object = instantiate(argc, argv);
+
+	if (!_object) {
+		PX4_ERR("failed to instantiate object");
+	}
+
+	while (_object) {
+		Ekf2 *object = (Ekf2 *)_object;
+		object->run();
+
+		if (!object->_replay_restart || object->should_exit()) {
+			break;
+		}
+
+		Ekf2 *instance = new Ekf2();
+
+		if (instance == nullptr) {
+			PX4_ERR("alloc failed");
+
+		} else {
+			instance->set_replay_mode(true);
+			instance->set_replay_direct(object->_replay_direct);
+			instance->_replay_restarted = true;
+		}
+
+		// the commands access the object with the module lock held
+		lock_module();
+		_object = instance;
+
+		if (instance && object->should_exit()) {
+			instance->request_stop();
+		}
+
+		unlock_module();
+
+		delete object;
+	}
+
+	exit_and_cleanup();
+}
+
 int Ekf2::custom_command(int argc, char *argv[])
 {
 	return print_usage("unknown command");
@@ -1405,13 +1986,18 @@ Attitude and position estimator using an Extended Kalman Filter. It is used for
 The documentation can be found on the [tuning_the_ecl_ekf](https://dev.px4.io/en/tutorials/tuning_the_ecl_ekf.html) page.
 
 ekf2 can be started in replay mode (`-r`): in this mode it does not access the system time, but only uses the
-timestamps from the sensor topics.
+timestamps from the sensor topics. When the replay module replays a log several times (parameter sweep), the
+estimator is restarted for every pass over the log.
+
+In direct replay mode (`-d`), the filter updates run in the thread of the replay module, from within the publication
+of `sensor_combined`. This avoids a thread wakeup and a handshake per sample, for offline replay as fast as possible.
 
 )DESCR_STR");
 
 	PRINT_MODULE_USAGE_NAME("ekf2", "estimator");
 	PRINT_MODULE_USAGE_COMMAND("start");
 	PRINT_MODULE_USAGE_PARAM_FLAG('r', "Enable replay mode", true);
+	PRINT_MODULE_USAGE_PARAM_FLAG('d', "Enable direct replay mode (filter updates in the replay thread)", true);
 	PRINT_MODULE_USAGE_DEFAULT_COMMANDS();
 
 	return 0;
@@ -1423,7 +2009,7 @@ int Ekf2::task_spawn(int argc, char *argv[])
 				      SCHED_DEFAULT,
 				      SCHED_PRIORITY_ESTIMATOR,
 				      5720,
-				      (px4_main_t)&run_trampoline,
+				      (px4_main_t)&run_trampoline_restartable,
 				      (char *const *)argv);
 
 	if (_task_id < 0) {
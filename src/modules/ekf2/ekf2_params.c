@@ -261,6 +261,21 @@ PARAM_DEFINE_FLOAT(EKF2_GYR_NOISE, 1.5e-2f);
  */
 PARAM_DEFINE_FLOAT(EKF2_ACC_NOISE, 3.5e-1f);
 
+/**
+ * Minimum time between covariance predictions.
+ *
+ * The IMU data of the filter updates in between is accumulated and the covariance is predicted
+ * over the whole interval, with the process noise scaled accordingly. This reduces the CPU load
+ * at the cost of linearisation errors during fast manoeuvres. Set to 0 to predict the covariance
+ * at every filter update.
+ *
+ * @group EKF2
+ * @min 0
+ * @max 100
+ * @unit ms
+ */
+PARAM_DEFINE_INT32(EKF2_COV_PRED_DT, 0);
+
 /**
  * Process noise for IMU rate gyro bias prediction.
  *
@@ -1020,6 +1035,20 @@ PARAM_DEFINE_FLOAT(EKF2_MAGB_K, 0.2f);
  */
 PARAM_DEFINE_INT32(EKF2_RNG_AID, 0);
 
+/**
+ * Terrain map.
+ *
+ * If enabled, the terrain altitude estimated from the range finder is stored in a grid with 20 m spacing
+ * (the most recently visited area, about 16 tiles of 160 x 160 m). Where the range finder does not provide a
+ * terrain estimate (out of range or lost lock), the stored altitude of the area is used for the distance to
+ * ground and the terrain altitude instead. The map is kept in RAM and lost at reboot.
+ *
+ * @group EKF2
+ * @value 0 Disabled
+ * @value 1 Enabled
+ */
+PARAM_DEFINE_INT32(EKF2_TERR_GRID, 0);
+
 /**
  * Maximum horizontal velocity allowed for range aid mode.
  *
@@ -1200,3 +1229,16 @@ PARAM_DEFINE_FLOAT(EKF2_ABL_GYRLIM, 3.0f);
  * @decimal 2
  */
 PARAM_DEFINE_FLOAT(EKF2_ABL_TAU, 0.5f);
+
+/**
+ * Number of EKF instances.
+ * Additional instances run in parallel, each in its own thread and on the data of one IMU (with uORB instance 1, 2, ...),
+ * while the main instance uses the voted IMU data. The outputs are taken from the healthy instance with the lowest innovation test ratios.
+ * Only supported on POSIX targets, and not used in replay.
+ *
+ * @group EKF2
+ * @min 1
+ * @max 4
+ * @reboot_required true
+ */
+PARAM_DEFINE_INT32(EKF2_MULTI_INST, 1);
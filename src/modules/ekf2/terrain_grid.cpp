@@ -0,0 +1,171 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2017 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file terrain_grid.cpp
+ */
+
+#include "terrain_grid.h"
+
+#include <mathlib/mathlib.h>
+
+#include <math.h>
+
+void
+TerrainGrid::update(double lat, double lon, float terrain_alt)
+{
+	if (!PX4_ISFINITE(terrain_alt)) {
+		return;
+	}
+
+	if (!_initialized) {
+		/* meters per degree on a sphere with the earth radius */
+		const double meters_per_deg = 6371000.0 * M_PI / 180.0;
+
+		_cell_size_lat = (double)CELL_SIZE / meters_per_deg;
+		_cell_size_lon = _cell_size_lat / math::max(cos(lat * M_PI / 180.0), 0.01);
+		_initialized = true;
+	}
+
+	int32_t cell_x;
+	int32_t cell_y;
+	cell_coordinates(lat, lon, cell_x, cell_y);
+
+	Tile *tile = find_tile(cell_x, cell_y, true);
+
+	if (tile == nullptr) {
+		return;
+	}
+
+	if (!tile->used) {
+		tile->used = true;
+		tile->ref_alt = terrain_alt;
+	}
+
+	int16_t &cell = tile->cells[cell_x - tile->x * TILE_CELLS][cell_y - tile->y * TILE_CELLS];
+
+	float alt = terrain_alt;
+
+	if (cell != CELL_UNKNOWN) {
+		const float alt_prev = tile->ref_alt + cell * CELL_RESOLUTION;
+		alt = alt_prev + FILTER_GAIN * (terrain_alt - alt_prev);
+	}
+
+	const float offset = math::constrain((alt - tile->ref_alt) / CELL_RESOLUTION, (float)(INT16_MIN + 1), (float)INT16_MAX);
+	cell = (int16_t)roundf(offset);
+}
+
+bool
+TerrainGrid::get(double lat, double lon, float &terrain_alt)
+{
+	if (!_initialized) {
+		return false;
+	}
+
+	int32_t cell_x;
+	int32_t cell_y;
+	cell_coordinates(lat, lon, cell_x, cell_y);
+
+	Tile *tile = find_tile(cell_x, cell_y, false);
+
+	if (tile == nullptr) {
+		return false;
+	}
+
+	const int16_t cell = tile->cells[cell_x - tile->x * TILE_CELLS][cell_y - tile->y * TILE_CELLS];
+
+	if (cell == CELL_UNKNOWN) {
+		return false;
+	}
+
+	terrain_alt = tile->ref_alt + cell * CELL_RESOLUTION;
+	return true;
+}
+
+void
+TerrainGrid::reset()
+{
+	for (unsigned i = 0; i < NUM_TILES; i++) {
+		_tiles[i].used = false;
+	}
+
+	_initialized = false;
+}
+
+void
+TerrainGrid::cell_coordinates(double lat, double lon, int32_t &cell_x, int32_t &cell_y) const
+{
+	cell_x = (int32_t)floor(lat / _cell_size_lat);
+	cell_y = (int32_t)floor(lon / _cell_size_lon);
+}
+
+TerrainGrid::Tile *
+TerrainGrid::find_tile(int32_t cell_x, int32_t cell_y, bool create)
+{
+	const int32_t tile_x = tile_coordinate(cell_x);
+	const int32_t tile_y = tile_coordinate(cell_y);
+
+	const unsigned hash = ((uint32_t)tile_x * 73856093u) ^ ((uint32_t)tile_y * 19349663u);
+
+	Tile *replace = nullptr;
+
+	for (unsigned i = 0; i < TILE_PROBES; i++) {
+		Tile &tile = _tiles[(hash + i) & (NUM_TILES - 1)];
+
+		if (tile.used && tile.x == tile_x && tile.y == tile_y) {
+			tile.last_use = ++_use_count;
+			return &tile;
+		}
+
+		if (replace == nullptr || (replace->used && (!tile.used || tile.last_use < replace->last_use))) {
+			replace = &tile;
+		}
+	}
+
+	if (!create) {
+		return nullptr;
+	}
+
+	replace->x = tile_x;
+	replace->y = tile_y;
+	replace->used = false;
+	replace->last_use = ++_use_count;
+
+	for (int i = 0; i < TILE_CELLS; i++) {
+		for (int j = 0; j < TILE_CELLS; j++) {
+			replace->cells[i][j] = CELL_UNKNOWN;
+		}
+	}
+
+	return replace;
+}
@@ -0,0 +1,110 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2017 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file terrain_grid.h
+ * Terrain altitude map of the area flown over, built from the range finder terrain estimate.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+/**
+ * @class TerrainGrid
+ * Grid of terrain altitudes in RAM, organized in tiles of TILE_CELLS x TILE_CELLS cells.
+ * The tiles are kept in a small hash table, so that both update() and get() are O(1). If the table is full, the
+ * least recently used tile is replaced.
+ * The cells are aligned to a lat/lon grid, the longitude spacing is set at the first update (the grid is meant for a
+ * local area, not for covering distances where the meridian convergence matters).
+ */
+class TerrainGrid
+{
+public:
+	static constexpr float CELL_SIZE = 20.0f; ///< grid spacing (m)
+
+	TerrainGrid() = default;
+	~TerrainGrid() = default;
+
+	/**
+	 * Add a terrain altitude measurement
+	 * @param lat latitude (deg)
+	 * @param lon longitude (deg)
+	 * @param terrain_alt terrain altitude AMSL (m)
+	 */
+	void update(double lat, double lon, float terrain_alt);
+
+	/**
+	 * Terrain altitude of the cell containing the position
+	 * @return true if the cell has been measured
+	 */
+	bool get(double lat, double lon, float &terrain_alt);
+
+	/** drop all cells */
+	void reset();
+
+private:
+	static constexpr int TILE_CELLS = 8;
+	static constexpr unsigned NUM_TILES = 16; ///< must be a power of 2
+	static constexpr unsigned TILE_PROBES = 4; ///< number of table slots searched for a tile
+	static constexpr float CELL_RESOLUTION = 0.1f; ///< resolution of the stored altitude (m)
+	static constexpr int16_t CELL_UNKNOWN = INT16_MIN;
+	static constexpr float FILTER_GAIN = 0.05f; ///< weight of a new measurement of a known cell
+
+	struct Tile {
+		int32_t x; ///< tile coordinates (in tiles, south-west corner)
+		int32_t y;
+		uint32_t last_use;
+		bool used;
+		float ref_alt; ///< the cells store the offset to this altitude
+		int16_t cells[TILE_CELLS][TILE_CELLS];
+	};
+
+	/**
+	 * Find the tile containing a cell
+	 * @param create replace an unused or the least recently used tile if not found
+	 * @return nullptr if not found
+	 */
+	Tile *find_tile(int32_t cell_x, int32_t cell_y, bool create);
+
+	void cell_coordinates(double lat, double lon, int32_t &cell_x, int32_t &cell_y) const;
+
+	static int32_t tile_coordinate(int32_t cell) { return (cell >= 0) ? cell / TILE_CELLS : -((-cell - 1) / TILE_CELLS) - 1; }
+
+	Tile _tiles[NUM_TILES] {};
+	uint32_t _use_count{0};
+
+	bool _initialized{false};
+	double _cell_size_lat{0.0}; ///< (deg)
+	double _cell_size_lon{0.0}; ///< (deg)
+};
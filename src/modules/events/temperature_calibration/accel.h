@@ -56,5 +56,7 @@ private:
 
 	virtual inline int update_sensor_instance(PerSensorData &data, int sensor_sub);
 
+	uint8_t sensor_type() const { return temperature_calibration_status_s::SENSOR_ACCEL; }
+
 	inline int finish_sensor_instance(PerSensorData &data, int sensor_index);
 };
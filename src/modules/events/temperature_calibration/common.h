@@ -42,11 +42,16 @@
 
 #include <px4_log.h>
 #include <mathlib/mathlib.h>
+#include <drivers/drv_hrt.h>
+#include <uORB/uORB.h>
+#include <uORB/topics/temperature_calibration_status.h>
 
 #include "polyfit.hpp"
 
 #define SENSOR_COUNT_MAX		3
 
+#define TC_TEMPERATURE_BIN_WIDTH	0.1f ///< temperature range averaged into one fit sample (deg C)
+
 
 #define TC_ERROR_INITIAL_TEMP_TOO_HIGH 110 ///< starting temperature was above the configured allowed temperature
 #define TC_ERROR_COMMUNICATION         112 ///< no sensors found
@@ -80,6 +85,12 @@ public:
 	/** reset all driver-level calibration parameters */
 	virtual void reset_calibration() = 0;
 
+	/**
+	 * publish the progress and the current fit quality of all sensor instances
+	 * @param pub temperature_calibration_status publication, advertised on the first call
+	 */
+	virtual void publish_status(orb_advert_t &pub) = 0;
+
 protected:
 
 	/**
@@ -163,13 +174,56 @@ public:
 		return 110;
 	}
 
+	/**
+	 * @see TemperatureCalibrationBase::publish_status()
+	 */
+	void publish_status(orb_advert_t &pub)
+	{
+		for (unsigned uorb_index = 0; uorb_index < _num_sensor_instances; uorb_index++) {
+			PerSensorData &data = _data[uorb_index];
+
+			temperature_calibration_status_s status{};
+			status.timestamp = hrt_absolute_time();
+			status.sensor_type = sensor_type();
+			status.instance = uorb_index;
+			status.device_id = data.device_id;
+			status.progress = -1;
+			status.low_temp = data.low_temp;
+			status.high_temp = data.high_temp;
+			status.num_bins = data.P[0].num_samples();
+
+			if (data.cold_soaked) {
+				status.progress = math::min(100, (int)((data.high_temp - data.low_temp) / _min_temperature_rise * 100.f));
+			}
+
+			for (int axis = 0; axis < 3; axis++) {
+				status.fit_rms[axis] = NAN;
+
+				// the fit needs more samples than coefficients
+				if (axis < Dim && data.P[axis].num_samples() > PolyfitOrder + 1) {
+					double res[PolyfitOrder + 1];
+					data.P[axis].fit(res);
+					status.fit_rms[axis] = (float)data.P[axis].residual_rms(res);
+				}
+			}
+
+			if (pub == nullptr) {
+				pub = orb_advertise_queue(ORB_ID(temperature_calibration_status), &status, 3 * SENSOR_COUNT_MAX);
+
+			} else {
+				orb_publish(ORB_ID(temperature_calibration_status), pub, &status);
+			}
+		}
+	}
+
 protected:
 
 	struct PerSensorData {
 		float sensor_sample_filt[Dim + 1]; ///< last value is the temperature
-		polyfitter < PolyfitOrder + 1 > P[Dim];
-		unsigned hot_soak_sat = 0; /**< counter that increments every time the sensor temperature reduces
-									from the last reading */
+		polyfitter < PolyfitOrder + 1 > P[Dim]; ///< one sample per temperature bin
+		double bin_sum[Dim + 1] = {}; ///< sum of the samples of the current temperature bin
+		unsigned bin_samples = 0; ///< number of samples in bin_sum
+		int bin_index = 0; ///< current temperature bin, counted from low_temp
 		uint32_t device_id = 0; ///< ID for the sensor being calibrated
 		bool cold_soaked = false; ///< true when the sensor cold soak starting temperature condition had been
 		/// verified and the starting temperature set
@@ -184,11 +238,100 @@ protected:
 	PerSensorData _data[SENSOR_COUNT_MAX];
 
 	/**
-	 * update a single sensor instance
+	 * update a single sensor instance: read a new sample into data.sensor_sample_filt and pass it to update_sample()
 	 * @return 0 when done, 1 not finished yet, <0 for an error
 	 */
 	virtual int update_sensor_instance(PerSensorData &data, int sensor_sub) = 0;
 
+	/** @return sensor type of temperature_calibration_status */
+	virtual uint8_t sensor_type() const = 0;
+
+	/**
+	 * Add the sample in data.sensor_sample_filt to the calibration. The samples are averaged per temperature bin
+	 * and the fit is updated once per bin, when the temperature has risen into the next bin. Samples of a bin
+	 * below the current one (the temperature decreased) are ignored.
+	 * @return 0 when done, 1 not finished yet, <0 for an error
+	 */
+	int update_sample(PerSensorData &data)
+	{
+		const float temperature = data.sensor_sample_filt[Dim];
+
+		// wait for min start temp to be reached before starting calibration
+		if (temperature < _min_start_temperature) {
+			return 1;
+		}
+
+		if (!data.cold_soaked) {
+			// allow time for sensors and filters to settle
+			if (hrt_absolute_time() > 10E6) {
+				// If intial temperature exceeds maximum declare an error condition and exit
+				if (temperature > _max_start_temperature) {
+					return -TC_ERROR_INITIAL_TEMP_TOO_HIGH;
+
+				} else {
+					data.cold_soaked = true;
+					data.low_temp = temperature; // Record the low temperature
+					data.high_temp = data.low_temp; // Initialise the high temperature to the initial temperature
+					data.ref_temp = temperature + 0.5f * _min_temperature_rise;
+					return 1;
+				}
+
+			} else {
+				return 1;
+			}
+		}
+
+		const int bin_index = (int)((temperature - data.low_temp) / TC_TEMPERATURE_BIN_WIDTH);
+
+		if (bin_index < data.bin_index) {
+			return 1;
+		}
+
+		if (bin_index > data.bin_index) {
+			add_bin_to_fit(data);
+			data.bin_index = bin_index;
+		}
+
+		for (int i = 0; i <= Dim; i++) {
+			data.bin_sum[i] += data.sensor_sample_filt[i];
+		}
+
+		data.bin_samples++;
+
+		if (temperature > data.high_temp) {
+			data.high_temp = temperature;
+		}
+
+		if ((data.high_temp - data.low_temp) > _min_temperature_rise) {
+			add_bin_to_fit(data);
+			data.hot_soaked = true;
+		}
+
+		return 1;
+	}
+
+	/** update the fit with the mean of the current temperature bin and start a new bin */
+	void add_bin_to_fit(PerSensorData &data)
+	{
+		if (data.bin_samples == 0) {
+			return;
+		}
+
+		const double relative_temperature = data.bin_sum[Dim] / data.bin_samples - data.ref_temp;
+
+		for (int i = 0; i < Dim; i++) {
+			data.P[i].update(relative_temperature, data.bin_sum[i] / data.bin_samples);
+		}
+
+		TC_DEBUG("bin %i: %.6f, %u samples\n", data.bin_index, relative_temperature, data.bin_samples);
+
+		for (int i = 0; i <= Dim; i++) {
+			data.bin_sum[i] = 0.0;
+		}
+
+		data.bin_samples = 0;
+	}
+
 	unsigned _num_sensor_instances{0};
 	int _sensor_subs[SENSOR_COUNT_MAX];
 };
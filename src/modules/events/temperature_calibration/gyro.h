@@ -57,5 +57,7 @@ private:
 
 	virtual int update_sensor_instance(PerSensorData &data, int sensor_sub);
 
+	uint8_t sensor_type() const { return temperature_calibration_status_s::SENSOR_GYRO; }
+
 	inline int finish_sensor_instance(PerSensorData &data, int sensor_index);
 };
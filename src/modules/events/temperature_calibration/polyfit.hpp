@@ -122,6 +122,30 @@ public:
 	{
 		update_VTV(x);
 		update_VTY(x, y);
+		_YTY += y * y;
+		_num_samples++;
+	}
+
+	unsigned num_samples() const { return _num_samples; }
+
+	/**
+	 * RMS of the fit errors ei of all samples, from the accumulated sums: ∑ei^2 = ∑yi^2 - transpose(A)*VTY
+	 * @param res coefficients returned by fit()
+	 */
+	double residual_rms(const double res[]) const
+	{
+		if (_num_samples == 0) {
+			return 0.0;
+		}
+
+		double sum_squared_errors = _YTY;
+
+		for (unsigned i = 0; i < _forder; i++) {
+			sum_squared_errors -= res[i] * _VTY(i);
+		}
+
+		// cancellation can make a near perfect fit slightly negative
+		return sqrt(fmax(sum_squared_errors, 0.0) / _num_samples);
 	}
 
 	bool fit(double res[])
@@ -155,6 +179,8 @@ public:
 private:
 	matrix::SquareMatrix<double, _forder> _VTV;
 	matrix::Vector<double, _forder> _VTY;
+	double _YTY{0.0};
+	unsigned _num_samples{0};
 
 	void update_VTY(double x, double y)
 	{
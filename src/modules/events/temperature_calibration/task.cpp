@@ -93,6 +93,9 @@ private:
 	void publish_led_control(led_control_s &led_control);
 
 	orb_advert_t _led_control_pub = nullptr;
+	orb_advert_t _status_pub = nullptr; ///< temperature_calibration_status
+
+	static constexpr unsigned UPDATE_INTERVAL_US = 20000; ///< sensor decimation: 50 Hz
 
 	bool	_force_task_exit = false;
 	int	_control_task = -1;		// task handle for task
@@ -111,7 +114,6 @@ void TemperatureCalibration::task_main()
 {
 	// subscribe to all gyro instances
 	int gyro_sub[SENSOR_COUNT_MAX] = {};
-	px4_pollfd_struct_t fds[SENSOR_COUNT_MAX] = {};
 	unsigned num_gyro = orb_group_count(ORB_ID(sensor_gyro));
 
 	if (num_gyro > SENSOR_COUNT_MAX) {
@@ -120,8 +122,6 @@ void TemperatureCalibration::task_main()
 
 	for (unsigned i = 0; i < num_gyro; i++) {
 		gyro_sub[i] = orb_subscribe_multi(ORB_ID(sensor_gyro), i);
-		fds[i].fd = gyro_sub[i];
-		fds[i].events = POLLIN;
 	}
 
 	int32_t min_temp_rise = 24;
@@ -198,34 +198,16 @@ void TemperatureCalibration::task_main()
 	bool abort_calibration = false;
 
 	while (!_force_task_exit) {
-		/* we poll on the gyro(s), since this is the sensor with the highest update rate.
+		/* the temperatures change slowly and the samples are averaged per temperature bin, so the sensors
+		 * are decimated to a fixed rate instead of processing every sample.
 		 * Each individual sensor will then check on its own if there's new data.
 		 */
-		int ret = px4_poll(fds, num_gyro, 1000);
-
-		if (ret < 0) {
-			// Poll error, sleep and try again
-			usleep(10000);
-			continue;
-
-		} else if (ret == 0) {
-			// Poll timeout or no new data, do nothing
-			continue;
-		}
-
-		//if gyro is not enabled: we must do an orb_copy here, so that poll() does not immediately return again
-		if (!_gyro) {
-			sensor_gyro_s gyro_data;
-
-			for (int i = 0; i < num_gyro; ++i) {
-				orb_copy(ORB_ID(sensor_gyro), gyro_sub[i], &gyro_data);
-			}
-		}
+		usleep(UPDATE_INTERVAL_US);
 
 		int min_progress = 110;
 
 		for (int i = 0; i < num_calibrators; ++i) {
-			ret = calibrators[i]->update();
+			int ret = calibrators[i]->update();
 
 			if (ret == -TC_ERROR_COMMUNICATION) {
 				abort_calibration = true;
@@ -262,12 +244,16 @@ void TemperatureCalibration::task_main()
 			publish_led_control(led_control);
 		}
 
-		//print progress each second
+		//print and publish progress each second
 		hrt_abstime now = hrt_absolute_time();
 
 		if (now > next_progress_output) {
 			PX4_INFO("Calibration progress: %i%%", min_progress);
 			next_progress_output = now + 1e6;
+
+			for (int i = 0; i < num_calibrators; ++i) {
+				calibrators[i]->publish_status(_status_pub);
+			}
 		}
 	}
 
@@ -277,6 +263,10 @@ void TemperatureCalibration::task_main()
 	} else {
 		PX4_INFO("Sensor Measurments completed");
 
+		for (int i = 0; i < num_calibrators; ++i) {
+			calibrators[i]->publish_status(_status_pub);
+		}
+
 		// save params immediately so that we can check the result and don't have to wait for param save timeout
 		param_control_autosave(false);
 
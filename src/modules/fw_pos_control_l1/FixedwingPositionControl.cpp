@@ -46,6 +46,8 @@ FixedwingPositionControl::FixedwingPositionControl() :
 	_parameter_handles.l1_period = param_find("FW_L1_PERIOD");
 	_parameter_handles.l1_damping = param_find("FW_L1_DAMPING");
 
+	_parameter_handles.loop_rate = param_find("FW_POS_RATE");
+
 	_parameter_handles.airspeed_min = param_find("FW_AIRSPD_MIN");
 	_parameter_handles.airspeed_trim = param_find("FW_AIRSPD_TRIM");
 	_parameter_handles.airspeed_max = param_find("FW_AIRSPD_MAX");
@@ -129,6 +131,14 @@ FixedwingPositionControl::parameters_update()
 	param_get(_parameter_handles.l1_damping, &(_parameters.l1_damping));
 	param_get(_parameter_handles.l1_period, &(_parameters.l1_period));
 
+	/* the attitude controller runs at the attitude rate, the position control loop is decimated */
+	param_get(_parameter_handles.loop_rate, &(_parameters.loop_rate));
+	_parameters.loop_rate = constrain(_parameters.loop_rate, 10, 100);
+
+	if (_global_pos_sub >= 0) {
+		orb_set_interval(_global_pos_sub, 1000 / _parameters.loop_rate);
+	}
+
 	param_get(_parameter_handles.airspeed_min, &(_parameters.airspeed_min));
 	param_get(_parameter_handles.airspeed_trim, &(_parameters.airspeed_trim));
 	param_get(_parameter_handles.airspeed_max, &(_parameters.airspeed_max));
@@ -360,15 +370,11 @@ FixedwingPositionControl::vehicle_attitude_poll()
 		orb_copy(ORB_ID(vehicle_attitude), _vehicle_attitude_sub, &_att);
 	}
 
-	/* set rotation matrix and euler angles */
-	math::Quaternion q_att(_att.q);
-	_R_nb = q_att.to_dcm();
-
-	math::Vector<3> euler_angles;
-	euler_angles = _R_nb.to_euler();
-	_roll    = euler_angles(0);
-	_pitch   = euler_angles(1);
-	_yaw     = euler_angles(2);
+	/* set rotation matrix and euler angles, precomputed by the estimator */
+	_R_nb.set(_att.R);
+	_roll    = _att.roll;
+	_pitch   = _att.pitch;
+	_yaw     = _att.yaw;
 }
 
 void
@@ -1059,8 +1065,7 @@ FixedwingPositionControl::control_position(const math::Vector<2> &curr_pos, cons
 
 			if (_runway_takeoff.runwayTakeoffEnabled()) {
 				if (!_runway_takeoff.isInitialized()) {
-					Eulerf euler(Quatf(_att.q));
-					_runway_takeoff.init(euler.psi(), _global_pos.lat, _global_pos.lon);
+					_runway_takeoff.init(_att.yaw, _global_pos.lat, _global_pos.lon);
 
 					/* need this already before takeoff is detected
 					 * doesn't matter if it gets reset when takeoff is detected eventually */
@@ -1508,8 +1513,8 @@ FixedwingPositionControl::task_main()
 	orb_set_interval(_vehicle_status_sub, 200);
 	/* rate limit vehicle land detected updates to 5Hz */
 	orb_set_interval(_vehicle_land_detected_sub, 200);
-	/* rate limit position updates to 50 Hz */
-	orb_set_interval(_global_pos_sub, 20);
+	/* rate limit position updates to FW_POS_RATE */
+	orb_set_interval(_global_pos_sub, 1000 / _parameters.loop_rate);
 
 	/* abort on a nonzero return value from the parameter init */
 	if (parameters_update() != PX4_OK) {
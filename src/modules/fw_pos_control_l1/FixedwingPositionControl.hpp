@@ -260,6 +260,8 @@ private:
 		float l1_period;
 		float l1_damping;
 
+		int32_t loop_rate;				///< position control rate [Hz]
+
 		float time_const;
 		float time_const_throt;
 		float min_sink_rate;
@@ -318,6 +320,8 @@ private:
 		param_t l1_period;
 		param_t l1_damping;
 
+		param_t loop_rate;
+
 		param_t time_const;
 		param_t time_const_throt;
 		param_t min_sink_rate;
@@ -60,6 +60,19 @@
  */
 PARAM_DEFINE_FLOAT(FW_L1_PERIOD, 20.0f);
 
+/**
+ * Position control rate
+ *
+ * Maximum rate of the position control loop. The attitude controller runs
+ * at the attitude estimate rate independently of this rate.
+ *
+ * @unit Hz
+ * @min 10
+ * @max 100
+ * @group FW L1 Control
+ */
+PARAM_DEFINE_INT32(FW_POS_RATE, 50);
+
 /**
  * L1 damping
  *
@@ -45,7 +45,9 @@
 #include <px4_config.h>
 #include <px4_defines.h>
 #include <drivers/drv_hrt.h>
+#include <systemlib/work_queue_stats.h>
 #include "uORB/topics/parameter_update.h"
+#include "uORB/topics/vehicle_local_position.h"
 
 namespace land_detector
 {
@@ -57,11 +59,14 @@ LandDetector::LandDetector() :
 
 LandDetector::~LandDetector()
 {
+	delete _local_pos_callback;
 	perf_free(_cycle_perf);
 }
 
 int LandDetector::start()
 {
+	work_queue_stats_register((worker_t)&LandDetector::_cycle_trampoline, "land_detector");
+
 	/* schedule a cycle to start things */
 	return work_queue(HPWORK, &_work, (worker_t)&LandDetector::_cycle_trampoline, this, 0);
 }
@@ -94,6 +99,16 @@ void LandDetector::_cycle()
 
 		_check_params(true);
 
+		// Run on position updates instead of a fixed rate. The callback subscribes from the work queue,
+		// which is also where the cycle runs.
+		_local_pos_callback = new uORB::SubscriptionCallback(ORB_ID(vehicle_local_position),
+				(worker_t)&LandDetector::_cycle_trampoline, this, HPWORK, 1000 / LAND_DETECTOR_UPDATE_RATE_HZ);
+
+		if (_local_pos_callback != nullptr && !_local_pos_callback->register_callback()) {
+			delete _local_pos_callback;
+			_local_pos_callback = nullptr;
+		}
+
 		_object = this;
 	}
 
@@ -146,15 +161,27 @@ void LandDetector::_cycle()
 	perf_end(_cycle_perf);
 
 	if (!should_exit()) {
-
-		// Schedule next cycle.
-		work_queue(HPWORK, &_work, (worker_t)&LandDetector::_cycle_trampoline, this,
-			   USEC2TICK(1000000 / LAND_DETECTOR_UPDATE_RATE_HZ));
+		_schedule_cycle();
 
 	} else {
+		// the cycle might have been triggered by the callback with the timer still pending
+		work_cancel(HPWORK, &_work);
 		exit_and_cleanup();
 	}
 }
+
+void LandDetector::_schedule_cycle()
+{
+	// With the callback the timer only runs the cycle if vehicle_local_position stops updating
+	// (e.g. no estimator running). It is restarted on every cycle.
+	const uint32_t interval_us = (_local_pos_callback != nullptr) ? LAND_DETECTOR_TIMEOUT_US :
+				     1000000 / LAND_DETECTOR_UPDATE_RATE_HZ;
+
+	// queueing a work item that is still pending would corrupt the queue
+	work_cancel(HPWORK, &_work);
+	work_queue(HPWORK, &_work, (worker_t)&LandDetector::_cycle_trampoline, this, USEC2TICK(interval_us));
+}
+
 void LandDetector::_check_params(const bool force)
 {
 	bool updated;
@@ -178,12 +205,26 @@ void LandDetector::_check_params(const bool force)
 
 void LandDetector::_update_state()
 {
+	/* the ground contact and maybe landed conditions are only evaluated if their inputs have changed enough,
+	 * the hysteresis is updated on every cycle in any case */
+	const bool evaluate = _state_inputs_changed();
+
 	/* when we are landed we also have ground contact for sure but only one output state can be true at a particular time
 	 * with higher priority for landed */
 	_freefall_hysteresis.set_state_and_update(_get_freefall_state());
 	_landed_hysteresis.set_state_and_update(_get_landed_state());
-	_maybe_landed_hysteresis.set_state_and_update(_get_maybe_landed_state());
-	_ground_contact_hysteresis.set_state_and_update(_get_ground_contact_state());
+
+	if (evaluate) {
+		_maybe_landed_result = _get_maybe_landed_state();
+	}
+
+	_maybe_landed_hysteresis.set_state_and_update(_maybe_landed_result);
+
+	if (evaluate) {
+		_ground_contact_result = _get_ground_contact_state();
+	}
+
+	_ground_contact_hysteresis.set_state_and_update(_ground_contact_result);
 
 	if (_freefall_hysteresis.get_state()) {
 		_state = LandDetectionState::FREEFALL;
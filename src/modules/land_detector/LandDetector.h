@@ -48,6 +48,7 @@
 #include <systemlib/param/param.h>
 #include <systemlib/perf_counter.h>
 #include <uORB/uORB.h>
+#include <uORB/SubscriptionCallback.hpp>
 #include <uORB/topics/vehicle_land_detected.h>
 
 namespace land_detector
@@ -92,6 +93,8 @@ public:
 
 	/**
 	 * Get the work queue going.
+	 * The cycle runs on vehicle_local_position updates (at most at LAND_DETECTOR_UPDATE_RATE_HZ),
+	 * and with a timer if the topic is not updated.
 	 */
 	int start();
 
@@ -136,6 +139,15 @@ protected:
 	 */
 	virtual float _get_max_altitude() = 0;
 
+	/**
+	 * Called every cycle after _update_topics(), before the state is updated.
+	 * _get_ground_contact_state() and _get_maybe_landed_state() are only evaluated if this returns true,
+	 * otherwise their previous results are used. An implementation can return false as long as
+	 * the inputs stay within bands in which the results cannot change.
+	 * @return true if the ground contact and maybe landed state need to be evaluated
+	 */
+	virtual bool _state_inputs_changed() { return true; }
+
 	/**
 	 * Convenience function for polling uORB subscriptions.
 	 *
@@ -143,9 +155,12 @@ protected:
 	 */
 	static bool _orb_update(const struct orb_metadata *meta, int handle, void *buffer);
 
-	/** Run main land detector loop at this rate in Hz. */
+	/** Run main land detector loop at most at this rate in Hz. */
 	static constexpr uint32_t LAND_DETECTOR_UPDATE_RATE_HZ = 50;
 
+	/** Run the loop from a timer if vehicle_local_position is not updated within this time. */
+	static constexpr uint32_t LAND_DETECTOR_TIMEOUT_US = 100000;
+
 	orb_advert_t _landDetectedPub{nullptr};
 	vehicle_land_detected_s _landDetected{};
 
@@ -167,6 +182,9 @@ private:
 
 	void _update_state();
 
+	/** schedule the timer for the next cycle, replacing a pending one */
+	void _schedule_cycle();
+
 	param_t _p_total_flight_time_high{PARAM_INVALID};
 	param_t _p_total_flight_time_low{PARAM_INVALID};
 	uint64_t _total_flight_time{0}; ///< in microseconds
@@ -174,6 +192,11 @@ private:
 
 	struct work_s	_work {};
 
+	uORB::SubscriptionCallback *_local_pos_callback{nullptr}; ///< schedules _cycle() on vehicle_local_position
+
+	bool _maybe_landed_result{true}; ///< last result of _get_maybe_landed_state()
+	bool _ground_contact_result{true}; ///< last result of _get_ground_contact_state()
+
 	perf_counter_t	_cycle_perf;
 };
 
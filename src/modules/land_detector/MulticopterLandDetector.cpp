@@ -61,6 +61,7 @@
  * @author Julian Oes <julian@oes.ch>
  */
 
+#include <cfloat>
 #include <cmath>
 #include <drivers/drv_hrt.h>
 #include <mathlib/mathlib.h>
@@ -292,6 +293,84 @@ bool MulticopterLandDetector::_get_landed_state()
 
 }
 
+/** @return distance from value to the closer one of the two thresholds */
+static float threshold_margin(float value, float threshold_a, float threshold_b)
+{
+	return math::min(fabsf(value - threshold_a), fabsf(value - threshold_b));
+}
+
+/** @return false if value moved by margin or more (or is not finite) */
+static bool within_margin(float value, float reference, float margin)
+{
+	return fabsf(value - reference) < margin;
+}
+
+bool MulticopterLandDetector::_state_inputs_changed()
+{
+	const hrt_abstime now = hrt_absolute_time();
+	const float vel_xy_sq = _vehicleLocalPosition.vx * _vehicleLocalPosition.vx
+				+ _vehicleLocalPosition.vy * _vehicleLocalPosition.vy;
+	const float vel_z_abs = fabsf(_vehicleLocalPosition.vz);
+	const float thrust = _actuators.control[3];
+	const float rates_abs[3] = {fabsf(_vehicleAttitude.rollspeed), fabsf(_vehicleAttitude.pitchspeed), fabsf(_vehicleAttitude.yawspeed)};
+
+	const bool changed = (now >= _evaluated_inputs.time + STATE_EVALUATION_INTERVAL_US)
+			     || (_arming.armed != _evaluated_inputs.armed)
+			     || (_control_mode.flag_control_altitude_enabled != _evaluated_inputs.altitude_enabled)
+			     || (_control_mode.flag_control_climb_rate_enabled != _evaluated_inputs.climb_rate_enabled)
+			     || (_vehicleLocalPosition.xy_valid != _evaluated_inputs.xy_valid)
+			     || (_vehicleLocalPosition.z_valid != _evaluated_inputs.z_valid)
+			     || (_ground_contact_hysteresis.get_state() != _evaluated_inputs.ground_contact)
+			     || (_maybe_landed_hysteresis.get_state() != _evaluated_inputs.maybe_landed)
+			     || !within_margin(vel_xy_sq, _evaluated_inputs.vel_xy_sq, _evaluated_inputs.vel_xy_sq_margin)
+			     || !within_margin(vel_z_abs, _evaluated_inputs.vel_z_abs, _evaluated_inputs.vel_z_abs_margin)
+			     || !within_margin(_vehicleLocalPositionSetpoint.vz, _evaluated_inputs.vel_z_sp, _evaluated_inputs.vel_z_sp_margin)
+			     || !within_margin(thrust, _evaluated_inputs.thrust, _evaluated_inputs.thrust_margin)
+			     || !within_margin(rates_abs[0], _evaluated_inputs.rates_abs[0], _evaluated_inputs.rates_abs_margin)
+			     || !within_margin(rates_abs[1], _evaluated_inputs.rates_abs[1], _evaluated_inputs.rates_abs_margin)
+			     || !within_margin(rates_abs[2], _evaluated_inputs.rates_abs[2], _evaluated_inputs.rates_abs_margin);
+
+	if (!changed) {
+		return false;
+	}
+
+	// the thresholds of _get_ground_contact_state() and _get_maybe_landed_state(), for both
+	// the normal and the widened acceptance thresholds of the land phase
+	const float land_speed_threshold = 0.9f * math::max(_params.landSpeed, 0.1f);
+	const float max_climb_rate = math::min(0.5f * land_speed_threshold, _params.maxClimbRate);
+	const float low_thrust = _params.minThrottle + (_params.hoverThrottle - _params.minThrottle) * 0.3f;
+	const float minimal_thrust = _control_mode.flag_control_altitude_enabled ?
+				     _params.minThrottle + (_params.hoverThrottle - _params.minThrottle) * _params.throttleRange :
+				     _params.minManThrottle + 0.01f;
+
+	_evaluated_inputs.time = now;
+	_evaluated_inputs.vel_xy_sq = vel_xy_sq;
+	_evaluated_inputs.vel_xy_sq_margin = fabsf(vel_xy_sq - _params.maxVelocity * _params.maxVelocity);
+	_evaluated_inputs.vel_z_abs = vel_z_abs;
+	_evaluated_inputs.vel_z_abs_margin = threshold_margin(vel_z_abs, _params.maxClimbRate * 2.5f, max_climb_rate);
+	_evaluated_inputs.vel_z_sp = _vehicleLocalPositionSetpoint.vz;
+	_evaluated_inputs.vel_z_sp_margin = fabsf(_vehicleLocalPositionSetpoint.vz - land_speed_threshold);
+	_evaluated_inputs.thrust = thrust;
+	_evaluated_inputs.thrust_margin = threshold_margin(thrust, low_thrust, minimal_thrust);
+	_evaluated_inputs.rates_abs_margin = FLT_MAX;
+
+	for (int i = 0; i < 3; ++i) {
+		_evaluated_inputs.rates_abs[i] = rates_abs[i];
+		_evaluated_inputs.rates_abs_margin = math::min(_evaluated_inputs.rates_abs_margin,
+						     threshold_margin(rates_abs[i], _params.maxRotation_rad_s, _params.maxRotation_rad_s * 2.5f));
+	}
+
+	_evaluated_inputs.armed = _arming.armed;
+	_evaluated_inputs.altitude_enabled = _control_mode.flag_control_altitude_enabled;
+	_evaluated_inputs.climb_rate_enabled = _control_mode.flag_control_climb_rate_enabled;
+	_evaluated_inputs.xy_valid = _vehicleLocalPosition.xy_valid;
+	_evaluated_inputs.z_valid = _vehicleLocalPosition.z_valid;
+	_evaluated_inputs.ground_contact = _ground_contact_hysteresis.get_state();
+	_evaluated_inputs.maybe_landed = _maybe_landed_hysteresis.get_state();
+
+	return true;
+}
+
 float MulticopterLandDetector::_get_max_altitude()
 {
 	/* ToDo: add a meaningful altitude */
@@ -82,6 +82,8 @@ protected:
 	virtual bool _get_freefall_state() override;
 
 	virtual float _get_max_altitude() override;
+
+	virtual bool _state_inputs_changed() override;
 private:
 
 	/** Time in us that landing conditions have to hold before triggering a land. */
@@ -96,6 +98,10 @@ private:
 	/** Time interval in us in which wider acceptance thresholds are used after landed. */
 	static constexpr uint64_t LAND_DETECTOR_LAND_PHASE_TIME_US = 2000000;
 
+	/** Time in us after which ground contact and maybe landed are evaluated even if the inputs do not change
+	 * (they also depend on timeouts). */
+	static constexpr uint64_t STATE_EVALUATION_INTERVAL_US = 100000;
+
 	/**
 	* @brief Handles for interesting parameters
 	**/
@@ -148,6 +154,32 @@ private:
 	uint64_t _min_trust_start;		///< timestamp when minimum trust was applied first
 	uint64_t _landed_time;
 
+	/**
+	 * Inputs of the last ground contact and maybe landed evaluation. The margins are the distances
+	 * to the closest threshold they are compared against, so the results cannot change as long as
+	 * every input stays closer than its margin.
+	 */
+	struct {
+		hrt_abstime time;
+		float vel_xy_sq;
+		float vel_xy_sq_margin;
+		float vel_z_abs;
+		float vel_z_abs_margin;
+		float vel_z_sp;
+		float vel_z_sp_margin;
+		float thrust;
+		float thrust_margin;
+		float rates_abs[3];
+		float rates_abs_margin;
+		bool armed;
+		bool altitude_enabled;
+		bool climb_rate_enabled;
+		bool xy_valid;
+		bool z_valid;
+		bool ground_contact;
+		bool maybe_landed;
+	} _evaluated_inputs{};
+
 	/* get control mode dependent pilot throttle threshold with which we should quit landed state and take off */
 	float _get_takeoff_throttle();
 	bool _has_altitude_lock();
@@ -77,6 +77,17 @@ bool VtolLandDetector::_get_maybe_landed_state()
 	return MulticopterLandDetector::_get_maybe_landed_state();
 }
 
+bool VtolLandDetector::_state_inputs_changed()
+{
+	const bool changed = MulticopterLandDetector::_state_inputs_changed();
+
+	// maybe landed also depends on the vehicle type
+	const bool type_changed = _vehicle_status.is_rotary_wing != _was_rotary_wing;
+	_was_rotary_wing = _vehicle_status.is_rotary_wing;
+
+	return changed || type_changed;
+}
+
 bool VtolLandDetector::_get_landed_state()
 {
 	// Only trigger in RW mode
@@ -60,6 +60,7 @@ protected:
 	void _update_topics() override;
 	bool _get_landed_state() override;
 	bool _get_maybe_landed_state() override;
+	bool _state_inputs_changed() override;
 
 private:
 	struct {
@@ -77,6 +78,7 @@ private:
 	vehicle_status_s	_vehicle_status{};
 
 	bool _was_in_air{false}; /**< indicates whether the vehicle was in the air in the previous iteration */
+	bool _was_rotary_wing{false}; /**< vehicle type of the previous iteration */
 	float _airspeed_filtered{0.0f}; /**< low pass filtered airspeed */
 };
 
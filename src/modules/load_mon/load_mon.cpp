@@ -54,10 +54,17 @@
 #include <systemlib/systemlib.h>
 #include <systemlib/cpuload.h>
 #include <systemlib/perf_counter.h>
+#include <systemlib/work_queue_stats.h>
 
 #include <uORB/uORB.h>
 #include <uORB/topics/cpuload.h>
 #include <uORB/topics/task_stack_info.h>
+#include <uORB/topics/work_item_stats.h>
+
+#ifdef __PX4_LINUX
+#include <systemlib/thread_stats.h>
+#include <uORB/topics/task_stats.h>
+#endif
 
 extern struct system_load_s system_load;
 
@@ -101,8 +108,8 @@ private:
 	/** Do a calculation of the CPU load and publish it. */
 	void _compute();
 
-	/** Calculate the memory usage */
-	float _ram_used();
+	/** Calculate the memory usage and the heap statistics of _cpuload */
+	void _heap_usage();
 
 #ifdef __PX4_NUTTX
 	/* Calculate stack usage */
@@ -113,6 +120,20 @@ private:
 	orb_advert_t _task_stack_info_pub;
 #endif
 
+#ifdef __PX4_LINUX
+	/* Publish the scheduling statistics of the next threads */
+	void _thread_stats();
+
+	int _stats_thread_index;
+	orb_advert_t _task_stats_pub;
+#endif
+
+	/* Publish the statistics of the next work queue items */
+	void _work_item_stats();
+
+	int _work_item_index;
+	orb_advert_t _work_item_stats_pub;
+
 	struct work_s _work;
 
 	struct cpuload_s _cpuload;
@@ -128,6 +149,12 @@ LoadMon::LoadMon() :
 	_stack_task_index(0),
 	_task_stack_info_pub(nullptr),
 #endif
+#ifdef __PX4_LINUX
+	_stats_thread_index(0),
+	_task_stats_pub(nullptr),
+#endif
+	_work_item_index(0),
+	_work_item_stats_pub(nullptr),
 	_work {},
 	_cpuload{},
 	_cpuload_pub(nullptr),
@@ -164,6 +191,8 @@ int LoadMon::task_spawn(int argc, char *argv[])
 		return -1;
 	}
 
+	work_queue_stats_register((worker_t)&LoadMon::cycle_trampoline, "load_mon");
+
 	/* Schedule a cycle to start things. */
 	int ret = work_queue(LPWORK, &obj->_work, (worker_t)&LoadMon::cycle_trampoline, obj, 0);
 
@@ -212,7 +241,7 @@ void LoadMon::_compute()
 
 	_cpuload.timestamp = hrt_absolute_time();
 	_cpuload.load = 1.0f - (float)interval_idletime / (float)LOAD_MON_INTERVAL_US;
-	_cpuload.ram_usage = _ram_used();
+	_heap_usage();
 
 #ifdef __PX4_NUTTX
 
@@ -222,6 +251,12 @@ void LoadMon::_compute()
 
 #endif
 
+#ifdef __PX4_LINUX
+	_thread_stats();
+#endif
+
+	_work_item_stats();
+
 	if (_cpuload_pub == nullptr) {
 		_cpuload_pub = orb_advertise(ORB_ID(cpuload), &_cpuload);
 
@@ -230,8 +265,14 @@ void LoadMon::_compute()
 	}
 }
 
-float LoadMon::_ram_used()
+void LoadMon::_heap_usage()
 {
+	_cpuload.ram_usage = 0.0f;
+	_cpuload.heap_free = 0;
+	_cpuload.heap_largest_free_block = 0;
+	_cpuload.heap_free_blocks = 0;
+	_cpuload.heap_fragmentation = 0.0f;
+
 #ifdef __PX4_NUTTX
 	struct mallinfo mem;
 
@@ -246,16 +287,25 @@ float LoadMon::_ram_used()
 	// mem.fordblks: free (bytes)
 	// mem.mxordblk: largest remaining block (bytes)
 
-	float load = (float)mem.uordblks / mem.arena;
+	// mem.ordblks: number of free blocks
+
+	_cpuload.ram_usage = (float)mem.uordblks / mem.arena;
 
 	// Check for corruption of the allocation counters
 	if ((mem.arena > CONFIG_RAM_SIZE) || (mem.fordblks > CONFIG_RAM_SIZE)) {
-		load = 1.0f;
+		_cpuload.ram_usage = 1.0f;
+		return;
+	}
+
+	_cpuload.heap_free = mem.fordblks;
+	_cpuload.heap_largest_free_block = mem.mxordblk;
+	_cpuload.heap_free_blocks = mem.ordblks;
+
+	// the share of the free heap that cannot be used for one large allocation
+	if (mem.fordblks > 0) {
+		_cpuload.heap_fragmentation = 1.0f - (float)mem.mxordblk / mem.fordblks;
 	}
 
-	return load;
-#else
-	return 0.0f;
 #endif
 }
 
@@ -278,6 +328,7 @@ void LoadMon::_stack_usage()
 		if (system_load.tasks[task_index].valid && system_load.tasks[task_index].tcb->pid > 0) {
 
 			stack_free = up_check_tcbstack_remain(system_load.tasks[task_index].tcb);
+			_task_stack_info.stack_size = system_load.tasks[task_index].tcb->adj_stack_size;
 
 			strncpy((char *)_task_stack_info.task_name, system_load.tasks[task_index].tcb->name,
 				task_stack_info_s::MAX_REPORT_TASK_NAME_LEN);
@@ -319,9 +370,92 @@ void LoadMon::_stack_usage()
 }
 #endif
 
+#ifdef __PX4_LINUX
+void LoadMon::_thread_stats()
+{
+	/* Publish a few threads per cycle to keep the load and the logged data low,
+	 * the statistics are totals since the thread started. */
+	const int num_threads_per_cycle = 4;
+
+	int tids[THREAD_STATS_MAX_THREADS];
+	const int thread_count = thread_stats_list(tids, THREAD_STATS_MAX_THREADS);
+
+	if (thread_count == 0) {
+		return;
+	}
+
+	for (int i = 0; i < num_threads_per_cycle && i < thread_count; i++) {
+		_stats_thread_index = (_stats_thread_index + 1) % thread_count;
+
+		thread_stats_s stats;
+
+		if (!thread_stats_get(tids[_stats_thread_index], &stats)) {
+			continue;
+		}
+
+		task_stats_s task_stats = {};
+		task_stats.timestamp = hrt_absolute_time();
+		strncpy((char *)task_stats.task_name, stats.name, task_stats_s::MAX_TASK_NAME_LEN);
+		task_stats.tid = tids[_stats_thread_index];
+		task_stats.run_time = stats.run_time_us;
+		task_stats.wait_time = stats.wait_time_us;
+		task_stats.timeslices = stats.timeslices;
+		task_stats.voluntary_switches = stats.voluntary_switches;
+		task_stats.involuntary_switches = stats.involuntary_switches;
+		task_stats.cpu = stats.cpu;
+
+		if (_task_stats_pub == nullptr) {
+			_task_stats_pub = orb_advertise_queue(ORB_ID(task_stats), &task_stats, num_threads_per_cycle);
+
+		} else {
+			orb_publish(ORB_ID(task_stats), _task_stats_pub, &task_stats);
+		}
+	}
+}
+#endif
+
+void LoadMon::_work_item_stats()
+{
+	/* Same as the threads: a few items per cycle, totals since the last reset */
+	const int num_items_per_cycle = 4;
+
+	const int item_count = work_queue_stats_count();
+
+	for (int i = 0; i < num_items_per_cycle && i < item_count; i++) {
+		_work_item_index = (_work_item_index + 1) % item_count;
+
+		work_queue_stats_s stats;
+
+		if (!work_queue_stats_get(_work_item_index, &stats)) {
+			continue;
+		}
+
+		work_item_stats_s work_item_stats = {};
+		work_item_stats.timestamp = hrt_absolute_time();
+		memcpy(work_item_stats.name, stats.name, sizeof(work_item_stats.name));
+		work_item_stats.worker = (uintptr_t)stats.worker;
+		work_item_stats.queue = stats.qid;
+		work_item_stats.run_count = stats.run_count;
+		work_item_stats.run_time = stats.run_time_us;
+		work_item_stats.run_time_max = stats.run_time_max_us;
+		work_item_stats.lateness = stats.lateness_us;
+		work_item_stats.lateness_max = stats.lateness_max_us;
+
+		if (_work_item_stats_pub == nullptr) {
+			_work_item_stats_pub = orb_advertise_queue(ORB_ID(work_item_stats), &work_item_stats, num_items_per_cycle);
+
+		} else {
+			orb_publish(ORB_ID(work_item_stats), _work_item_stats_pub, &work_item_stats);
+		}
+	}
+}
+
 int LoadMon::print_status()
 {
 	PX4_INFO("running");
+	PX4_INFO("heap: %u bytes free in %u blocks, largest %u bytes (fragmentation %.2f)",
+		 (unsigned)_cpuload.heap_free, (unsigned)_cpuload.heap_free_blocks, (unsigned)_cpuload.heap_largest_free_block,
+		 (double)_cpuload.heap_fragmentation);
 	perf_print_counter(_stack_perf);
 	return 0;
 }
@@ -336,10 +470,18 @@ int LoadMon::print_usage(const char *reason)
 		R"DESCR_STR(
 ### Description
 Background process running periodically with 1 Hz on the LP work queue to calculate the CPU load and RAM
-usage and publish the `cpuload` topic.
+usage and publish the `cpuload` topic. On NuttX this includes the free heap, the largest free block and the
+heap fragmentation.
+
+On NuttX it also checks the stack usage of each process (a few per cycle) and publishes the stack high-water
+mark and size as `task_stack_info`, which is logged. If the free stack falls below 300 bytes, a warning is
+output, which will also appear in the log file.
+
+On Linux it publishes the scheduling statistics of a few threads per cycle (`task_stats` topic): run time,
+time waiting on a run queue and context switches. `top sched` shows them live.
 
-On NuttX it also checks the stack usage of each process and if it falls below 300 bytes, a warning is output,
-which will also appear in the log file.
+The run time and schedule lateness of the work queue items are published the same way (`work_item_stats`
+topic), `work_queue status` shows them live.
 )DESCR_STR");
 
 	PRINT_MODULE_USAGE_NAME("load_mon", "system");
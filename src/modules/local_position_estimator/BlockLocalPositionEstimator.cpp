@@ -119,6 +119,18 @@ BlockLocalPositionEstimator::BlockLocalPositionEstimator() :
 	_xDelay(this, ""),
 	_tDelay(this, ""),
 
+	// perf counters
+	_perf_predict(perf_alloc(PC_ELAPSED, "lpe_predict")),
+	_perf_predict_cov(perf_alloc(PC_ELAPSED, "lpe_predict_cov")),
+	_perf_baro(perf_alloc(PC_ELAPSED, "lpe_baro_correct")),
+	_perf_gps(perf_alloc(PC_ELAPSED, "lpe_gps_correct")),
+	_perf_lidar(perf_alloc(PC_ELAPSED, "lpe_lidar_correct")),
+	_perf_sonar(perf_alloc(PC_ELAPSED, "lpe_sonar_correct")),
+	_perf_flow(perf_alloc(PC_ELAPSED, "lpe_flow_correct")),
+	_perf_vision(perf_alloc(PC_ELAPSED, "lpe_vision_correct")),
+	_perf_mocap(perf_alloc(PC_ELAPSED, "lpe_mocap_correct")),
+	_perf_land(perf_alloc(PC_ELAPSED, "lpe_land_correct")),
+
 	// misc
 	_polls(),
 	_timeStamp(hrt_absolute_time()),
@@ -148,7 +160,8 @@ BlockLocalPositionEstimator::BlockLocalPositionEstimator() :
 	// masks
 	_sensorTimeout(UINT16_MAX),
 	_sensorFault(0),
-	_estimatorInitialized(0)
+	_estimatorInitialized(0),
+	_cov_predict_dt(0)
 {
 	// assign distance subs to array
 	_dist_subs[0] = &_sub_dist0;
@@ -192,7 +205,18 @@ BlockLocalPositionEstimator::BlockLocalPositionEstimator() :
 }
 
 BlockLocalPositionEstimator::~BlockLocalPositionEstimator()
-{}
+{
+	perf_free(_perf_predict);
+	perf_free(_perf_predict_cov);
+	perf_free(_perf_baro);
+	perf_free(_perf_gps);
+	perf_free(_perf_lidar);
+	perf_free(_perf_sonar);
+	perf_free(_perf_flow);
+	perf_free(_perf_vision);
+	perf_free(_perf_mocap);
+	perf_free(_perf_land);
+}
 
 Vector<float, BlockLocalPositionEstimator::n_x> BlockLocalPositionEstimator::dynamics(
 	float t,
@@ -309,7 +333,7 @@ void BlockLocalPositionEstimator::update()
 
 	// update parameters
 	if (paramsUpdated) {
-		updateParams();
+		updateChangedParams();
 		updateSSParams();
 	}
 
@@ -443,7 +467,17 @@ void BlockLocalPositionEstimator::update()
 	}
 
 	// do prediction
+	perf_begin(_perf_predict);
 	predict();
+	perf_end(_perf_predict);
+
+	// the covariance is predicted at a lower rate, but it has to be up to date for a correction
+	if (_cov_predict_dt >= COV_PREDICT_DT || gpsUpdated || baroUpdated || lidarUpdated || sonarUpdated
+	    || flowUpdated || visionUpdated || mocapUpdated || landUpdated) {
+		perf_begin(_perf_predict_cov);
+		predictCovariance();
+		perf_end(_perf_predict_cov);
+	}
 
 	// sensor corrections/ initializations
 	if (gpsUpdated) {
@@ -451,7 +485,9 @@ void BlockLocalPositionEstimator::update()
 			gpsInit();
 
 		} else {
+			perf_begin(_perf_gps);
 			gpsCorrect();
+			perf_end(_perf_gps);
 		}
 	}
 
@@ -460,7 +496,9 @@ void BlockLocalPositionEstimator::update()
 			baroInit();
 
 		} else {
+			perf_begin(_perf_baro);
 			baroCorrect();
+			perf_end(_perf_baro);
 		}
 	}
 
@@ -469,7 +507,9 @@ void BlockLocalPositionEstimator::update()
 			lidarInit();
 
 		} else {
+			perf_begin(_perf_lidar);
 			lidarCorrect();
+			perf_end(_perf_lidar);
 		}
 	}
 
@@ -478,7 +518,9 @@ void BlockLocalPositionEstimator::update()
 			sonarInit();
 
 		} else {
+			perf_begin(_perf_sonar);
 			sonarCorrect();
+			perf_end(_perf_sonar);
 		}
 	}
 
@@ -487,7 +529,9 @@ void BlockLocalPositionEstimator::update()
 			flowInit();
 
 		} else {
+			perf_begin(_perf_flow);
 			flowCorrect();
+			perf_end(_perf_flow);
 		}
 	}
 
@@ -496,7 +540,9 @@ void BlockLocalPositionEstimator::update()
 			visionInit();
 
 		} else {
+			perf_begin(_perf_vision);
 			visionCorrect();
+			perf_end(_perf_vision);
 		}
 	}
 
@@ -505,7 +551,9 @@ void BlockLocalPositionEstimator::update()
 			mocapInit();
 
 		} else {
+			perf_begin(_perf_mocap);
 			mocapCorrect();
+			perf_end(_perf_mocap);
 		}
 	}
 
@@ -514,7 +562,9 @@ void BlockLocalPositionEstimator::update()
 			landInit();
 
 		} else {
+			perf_begin(_perf_land);
 			landCorrect();
+			perf_end(_perf_land);
 		}
 	}
 
@@ -797,6 +847,10 @@ void BlockLocalPositionEstimator::updateSSParams()
 		_pn_t_noise_density.get() +
 		(_t_max_grade.get() / 100.0f) * sqrtf(_x(X_vx) * _x(X_vx) + _x(X_vy) * _x(X_vy));
 	_Q(X_tz, X_tz) = pn_t_noise_density * pn_t_noise_density;
+
+	// B and R only change here, the input noise is constant for the covariance prediction
+	_Q_input = _Q;
+	symmetricProductAdd(_B, _R, _Q_input);
 }
 
 void BlockLocalPositionEstimator::predict()
@@ -865,25 +919,38 @@ void BlockLocalPositionEstimator::predict()
 
 	// propagate
 	_x += dx;
-	Matrix<float, n_x, n_x> dP = (_A * _P + _P * _A.transpose() +
-				      _B * _R * _B.transpose() + _Q) * getDt();
+	_cov_predict_dt += getDt();
+	_xLowPass.update(_x);
+	_aglLowPass.update(agl());
+}
+
+void BlockLocalPositionEstimator::predictCovariance()
+{
+	// dP = (A * P + P * A^T + B * R * B^T + Q) * dt, with P symmetric: P * A^T = (A * P)^T,
+	// so only the upper triangle of A * P is needed
+	const Matrix<float, n_x, n_x> AP = _A * _P;
+	const float dt = _cov_predict_dt;
+	_cov_predict_dt = 0;
+
+	bool propagate[n_x];
+
+	for (int i = 0; i < n_x; i++) {
+		// if diagonal element greater than max, stop propagating
+		propagate[i] = _P(i, i) <= P_MAX;
+	}
 
-	// covariance propagation logic
 	for (int i = 0; i < n_x; i++) {
-		if (_P(i, i) > P_MAX) {
-			// if diagonal element greater than max, stop propagating
-			dP(i, i) = 0;
+		if (!propagate[i]) {
+			continue;
+		}
 
-			for (int j = 0; j < n_x; j++) {
-				dP(i, j) = 0;
-				dP(j, i) = 0;
+		for (int j = i; j < n_x; j++) {
+			if (propagate[j]) {
+				_P(i, j) += (AP(i, j) + AP(j, i) + _Q_input(i, j)) * dt;
+				_P(j, i) = _P(i, j);
 			}
 		}
 	}
-
-	_P += dP;
-	_xLowPass.update(_x);
-	_aglLowPass.update(agl());
 }
 
 int BlockLocalPositionEstimator::getDelayPeriods(float delay, uint8_t *periods)
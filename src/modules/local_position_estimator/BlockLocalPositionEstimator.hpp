@@ -5,6 +5,7 @@
 #include <mathlib/mathlib.h>
 #include <lib/geo/geo.h>
 #include <matrix/Matrix.hpp>
+#include <systemlib/perf_counter.h>
 
 // uORB Subscriptions
 #include <uORB/Subscription.hpp>
@@ -34,6 +35,7 @@ using namespace control;
 
 static const float DELAY_MAX = 0.5f;	// seconds
 static const float HIST_STEP = 0.05f;	// 20 hz
+static const float COV_PREDICT_DT = 0.02f;	// 50 hz, covariance prediction period
 static const float BIAS_MAX = 1e-1f;
 static const size_t HIST_LEN = 10;	// DELAY_MAX / HIST_STEP;
 static const size_t N_DIST_SUBS = 4;
@@ -168,6 +170,9 @@ private:
 	// predict the next state
 	void predict();
 
+	// propagate the covariance over the time accumulated since the last call
+	void predictCovariance();
+
 	// lidar
 	int  lidarMeasure(Vector<float, n_y_lidar> &y);
 	void lidarCorrect();
@@ -346,6 +351,18 @@ private:
 	BlockDelay<float, n_x, 1, HIST_LEN> _xDelay;
 	BlockDelay<uint64_t, 1, 1, HIST_LEN> _tDelay;
 
+	// perf counters
+	perf_counter_t _perf_predict;
+	perf_counter_t _perf_predict_cov;
+	perf_counter_t _perf_baro;
+	perf_counter_t _perf_gps;
+	perf_counter_t _perf_lidar;
+	perf_counter_t _perf_sonar;
+	perf_counter_t _perf_flow;
+	perf_counter_t _perf_vision;
+	perf_counter_t _perf_mocap;
+	perf_counter_t _perf_land;
+
 	// misc
 	px4_pollfd_struct_t _polls[3];
 	uint64_t _timeStamp;
@@ -389,4 +406,6 @@ private:
 	Matrix<float, n_x, n_u>  _B;	// input matrix
 	Matrix<float, n_u, n_u>  _R;	// input covariance
 	Matrix<float, n_x, n_x>  _Q;	// process noise covariance
+	Matrix<float, n_x, n_x>  _Q_input;	// input and process noise covariance, B * R * B^T + Q
+	float _cov_predict_dt;	// time since the last covariance prediction
 };
@@ -66,8 +66,8 @@ void BlockLocalPositionEstimator::baroCorrect()
 	R(0, 0) = _baro_stddev.get() * _baro_stddev.get();
 
 	// residual
-	Matrix<float, n_y_baro, n_y_baro> S_I =
-		inv<float, n_y_baro>((C * _P * C.transpose()) + R);
+	SquareMatrix<float, n_y_baro> S = symmetricProduct(C, _P) + R;
+	SquareMatrix<float, n_y_baro> S_I = inv(S);
 	Vector<float, n_y_baro> r = y - (C * _x);
 
 	// fault detection
@@ -86,10 +86,11 @@ void BlockLocalPositionEstimator::baroCorrect()
 	}
 
 	// kalman filter correction always
-	Matrix<float, n_x, n_y_baro> K = _P * C.transpose() * S_I;
+	Matrix<float, n_x, n_y_baro> PCt = _P * C.transpose();
+	Matrix<float, n_x, n_y_baro> K = PCt * S_I;
 	Vector<float, n_x> dx = K * r;
 	_x += dx;
-	_P -= K * C * _P;
+	_P -= symmetricProduct(PCt, S_I);
 }
 
 void BlockLocalPositionEstimator::baroCheckTimeout()
@@ -170,7 +170,7 @@ void BlockLocalPositionEstimator::flowCorrect()
 	Vector<float, 2> r = y - C * _x;
 
 	// residual covariance
-	Matrix<float, n_y_flow, n_y_flow> S = C * _P * C.transpose() + R;
+	SquareMatrix<float, n_y_flow> S = symmetricProduct(C, _P) + R;
 
 	// publish innovations
 	_pub_innov.get().flow_innov[0] = r(0);
@@ -179,7 +179,7 @@ void BlockLocalPositionEstimator::flowCorrect()
 	_pub_innov.get().flow_innov_var[1] = S(1, 1);
 
 	// residual covariance, (inverse)
-	Matrix<float, n_y_flow, n_y_flow> S_I = inv<float, n_y_flow>(S);
+	SquareMatrix<float, n_y_flow> S_I = inv(S);
 
 	// fault detection
 	float beta = (r.transpose() * (S_I * r))(0, 0);
@@ -196,11 +196,11 @@ void BlockLocalPositionEstimator::flowCorrect()
 	}
 
 	if (!(_sensorFault & SENSOR_FLOW)) {
-		Matrix<float, n_x, n_y_flow> K =
-			_P * C.transpose() * S_I;
+		Matrix<float, n_x, n_y_flow> PCt = _P * C.transpose();
+		Matrix<float, n_x, n_y_flow> K = PCt * S_I;
 		Vector<float, n_x> dx = K * r;
 		_x += dx;
-		_P -= K * C * _P;
+		_P -= symmetricProduct(PCt, S_I);
 	}
 }
 
@@ -185,7 +185,7 @@ void BlockLocalPositionEstimator::gpsCorrect()
 	Vector<float, n_y_gps> r = y - C * x0;
 
 	// residual covariance
-	Matrix<float, n_y_gps, n_y_gps> S = C * _P * C.transpose() + R;
+	SquareMatrix<float, n_y_gps> S = symmetricProduct(C, _P) + R;
 
 	// publish innovations
 	for (int i = 0; i < 6; i++) {
@@ -194,7 +194,7 @@ void BlockLocalPositionEstimator::gpsCorrect()
 	}
 
 	// residual covariance, (inverse)
-	Matrix<float, n_y_gps, n_y_gps> S_I = inv<float, n_y_gps>(S);
+	SquareMatrix<float, n_y_gps> S_I = choleskyInv(S);
 
 	// fault detection
 	float beta = (r.transpose() * (S_I * r))(0, 0);
@@ -216,10 +216,11 @@ void BlockLocalPositionEstimator::gpsCorrect()
 	}
 
 	// kalman filter correction always for GPS
-	Matrix<float, n_x, n_y_gps> K = _P * C.transpose() * S_I;
+	Matrix<float, n_x, n_y_gps> PCt = _P * C.transpose();
+	Matrix<float, n_x, n_y_gps> K = PCt * S_I;
 	Vector<float, n_x> dx = K * r;
 	_x += dx;
-	_P -= K * C * _P;
+	_P -= symmetricProduct(PCt, S_I);
 }
 
 void BlockLocalPositionEstimator::gpsCheckTimeout()
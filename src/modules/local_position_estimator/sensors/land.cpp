@@ -59,7 +59,8 @@ void BlockLocalPositionEstimator::landCorrect()
 	R(Y_land_agl, Y_land_agl) = _land_z_stddev.get() * _land_z_stddev.get();
 
 	// residual
-	Matrix<float, n_y_land, n_y_land> S_I = inv<float, n_y_land>((C * _P * C.transpose()) + R);
+	SquareMatrix<float, n_y_land> S = symmetricProduct(C, _P) + R;
+	SquareMatrix<float, n_y_land> S_I = inv(S);
 	Vector<float, n_y_land> r = y - C * _x;
 	_pub_innov.get().hagl_innov = r(Y_land_agl);
 	_pub_innov.get().hagl_innov_var = R(Y_land_agl, Y_land_agl);
@@ -85,10 +86,11 @@ void BlockLocalPositionEstimator::landCorrect()
 	}
 
 	// kalman filter correction always for land detector
-	Matrix<float, n_x, n_y_land> K = _P * C.transpose() * S_I;
+	Matrix<float, n_x, n_y_land> PCt = _P * C.transpose();
+	Matrix<float, n_x, n_y_land> K = PCt * S_I;
 	Vector<float, n_x> dx = K * r;
 	_x += dx;
-	_P -= K * C * _P;
+	_P -= symmetricProduct(PCt, S_I);
 }
 
 void BlockLocalPositionEstimator::landCheckTimeout()
@@ -88,14 +88,14 @@ void BlockLocalPositionEstimator::lidarCorrect()
 	// residual
 	Vector<float, n_y_lidar> r = y - C * _x;
 	// residual covariance
-	Matrix<float, n_y_lidar, n_y_lidar> S = C * _P * C.transpose() + R;
+	SquareMatrix<float, n_y_lidar> S = symmetricProduct(C, _P) + R;
 
 	// publish innovations
 	_pub_innov.get().hagl_innov = r(0);
 	_pub_innov.get().hagl_innov_var = S(0, 0);
 
 	// residual covariance, (inverse)
-	Matrix<float, n_y_lidar, n_y_lidar> S_I = inv<float, n_y_lidar>(S);
+	SquareMatrix<float, n_y_lidar> S_I = inv(S);
 
 	// fault detection
 	float beta = (r.transpose() * (S_I * r))(0, 0);
@@ -115,10 +115,11 @@ void BlockLocalPositionEstimator::lidarCorrect()
 	}
 
 	// kalman filter correction always
-	Matrix<float, n_x, n_y_lidar> K = _P * C.transpose() * S_I;
+	Matrix<float, n_x, n_y_lidar> PCt = _P * C.transpose();
+	Matrix<float, n_x, n_y_lidar> K = PCt * S_I;
 	Vector<float, n_x> dx = K * r;
 	_x += dx;
-	_P -= K * C * _P;
+	_P -= symmetricProduct(PCt, S_I);
 }
 
 void BlockLocalPositionEstimator::lidarCheckTimeout()
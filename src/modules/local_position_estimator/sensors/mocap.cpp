@@ -76,7 +76,7 @@ void BlockLocalPositionEstimator::mocapCorrect()
 	// residual
 	Vector<float, n_y_mocap> r = y - C * _x;
 	// residual covariance
-	Matrix<float, n_y_mocap, n_y_mocap> S = C * _P * C.transpose() + R;
+	SquareMatrix<float, n_y_mocap> S = symmetricProduct(C, _P) + R;
 
 	// publish innovations
 	for (int i = 0; i < 3; i++) {
@@ -90,7 +90,7 @@ void BlockLocalPositionEstimator::mocapCorrect()
 	}
 
 	// residual covariance, (inverse)
-	Matrix<float, n_y_mocap, n_y_mocap> S_I = inv<float, n_y_mocap>(S);
+	SquareMatrix<float, n_y_mocap> S_I = inv(S);
 
 	// fault detection
 	float beta = (r.transpose() * (S_I * r))(0, 0);
@@ -107,10 +107,11 @@ void BlockLocalPositionEstimator::mocapCorrect()
 	}
 
 	// kalman filter correction always
-	Matrix<float, n_x, n_y_mocap> K = _P * C.transpose() * S_I;
+	Matrix<float, n_x, n_y_mocap> PCt = _P * C.transpose();
+	Matrix<float, n_x, n_y_mocap> K = PCt * S_I;
 	Vector<float, n_x> dx = K * r;
 	_x += dx;
-	_P -= K * C * _P;
+	_P -= symmetricProduct(PCt, S_I);
 }
 
 void BlockLocalPositionEstimator::mocapCheckTimeout()
@@ -106,14 +106,14 @@ void BlockLocalPositionEstimator::sonarCorrect()
 	// residual
 	Vector<float, n_y_sonar> r = y - C * _x;
 	// residual covariance
-	Matrix<float, n_y_sonar, n_y_sonar> S = C * _P * C.transpose() + R;
+	SquareMatrix<float, n_y_sonar> S = symmetricProduct(C, _P) + R;
 
 	// publish innovations
 	_pub_innov.get().hagl_innov = r(0);
 	_pub_innov.get().hagl_innov_var = S(0, 0);
 
 	// residual covariance, (inverse)
-	Matrix<float, n_y_sonar, n_y_sonar> S_I = inv<float, n_y_sonar>(S);
+	SquareMatrix<float, n_y_sonar> S_I = inv(S);
 
 	// fault detection
 	float beta = (r.transpose()  * (S_I * r))(0, 0);
@@ -134,11 +134,11 @@ void BlockLocalPositionEstimator::sonarCorrect()
 
 	// kalman filter correction if no fault
 	if (!(_sensorFault & SENSOR_SONAR)) {
-		Matrix<float, n_x, n_y_sonar> K =
-			_P * C.transpose() * S_I;
+		Matrix<float, n_x, n_y_sonar> PCt = _P * C.transpose();
+		Matrix<float, n_x, n_y_sonar> K = PCt * S_I;
 		Vector<float, n_x> dx = K * r;
 		_x += dx;
-		_P -= K * C * _P;
+		_P -= symmetricProduct(PCt, S_I);
 	}
 }
 
@@ -114,7 +114,8 @@ void BlockLocalPositionEstimator::visionCorrect()
 	Vector<float, n_x> x0 = _xDelay.get(i_hist);
 
 	// residual
-	Matrix<float, n_y_vision, n_y_vision> S_I = inv<float, n_y_vision>((C * _P * C.transpose()) + R);
+	SquareMatrix<float, n_y_vision> S = symmetricProduct(C, _P) + R;
+	SquareMatrix<float, n_y_vision> S_I = inv(S);
 	Matrix<float, n_y_vision, 1> r = y - C * x0;
 
 	// fault detection
@@ -133,10 +134,11 @@ void BlockLocalPositionEstimator::visionCorrect()
 
 	// kalman filter correction if no fault
 	if (!(_sensorFault & SENSOR_VISION)) {
-		Matrix<float, n_x, n_y_vision> K = _P * C.transpose() * S_I;
+		Matrix<float, n_x, n_y_vision> PCt = _P * C.transpose();
+		Matrix<float, n_x, n_y_vision> K = PCt * S_I;
 		Vector<float, n_x> dx = K * r;
 		_x += dx;
-		_P -= K * C * _P;
+		_P -= symmetricProduct(PCt, S_I);
 	}
 }
 
@@ -0,0 +1,197 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2017 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+#include "log_compressor.h"
+
+#include <string.h>
+
+namespace px4
+{
+namespace logger
+{
+constexpr size_t LogCompressor::max_block_size;
+
+LogCompressor::~LogCompressor()
+{
+	if (_hash_table) {
+		delete[] _hash_table;
+	}
+}
+
+bool LogCompressor::init()
+{
+	if (_hash_table == nullptr) {
+		_hash_table = new uint16_t[1 << hash_bits];
+
+		if (_hash_table) {
+			memset(_hash_table, 0, sizeof(_hash_table[0]) << hash_bits);
+		}
+	}
+
+	return _hash_table != nullptr;
+}
+
+uint32_t LogCompressor::read32(const uint8_t *p)
+{
+	uint32_t v;
+	memcpy(&v, p, sizeof(v));
+	return v;
+}
+
+unsigned LogCompressor::hash(uint32_t sequence)
+{
+	return (sequence * 2654435761u) >> (32 - hash_bits);
+}
+
+uint8_t *LogCompressor::write_length(uint8_t *op, size_t length)
+{
+	length -= 15;
+
+	while (length >= 255) {
+		*op++ = 255;
+		length -= 255;
+	}
+
+	*op++ = (uint8_t)length;
+	return op;
+}
+
+size_t LogCompressor::compress(const uint8_t *src, size_t size, uint8_t *dst)
+{
+	if (size > max_block_size || size <= match_limit || !_hash_table) {
+		return 0;
+	}
+
+	// positions are relative to the block, so the entries left from the previous block need no reset:
+	// every candidate is verified before it is used
+
+	const uint8_t *ip = src + 1;
+	const uint8_t *anchor = src;
+	const uint8_t *const iend = src + size;
+	const uint8_t *const mflimit = iend - match_limit;
+	const uint8_t *const matchlimit = iend - last_literals;
+
+	uint8_t *op = dst;
+	uint8_t *const oend = dst + size; // only accept output that is smaller than the input
+
+	while (ip < mflimit) {
+		const uint32_t sequence = read32(ip);
+		const unsigned h = hash(sequence);
+		const uint8_t *ref = src + _hash_table[h];
+		_hash_table[h] = (uint16_t)(ip - src);
+
+		if (ref >= ip || read32(ref) != sequence) {
+			++ip;
+			continue;
+		}
+
+		// extend the match backwards into the pending literals
+		while (ip > anchor && ref > src && ip[-1] == ref[-1]) {
+			--ip;
+			--ref;
+		}
+
+		const uint8_t *match_end = ip + min_match;
+		const uint8_t *ref_end = ref + min_match;
+
+		while (match_end < matchlimit && *match_end == *ref_end) {
+			++match_end;
+			++ref_end;
+		}
+
+		const size_t literal_length = ip - anchor;
+		const size_t match_length = match_end - ip - min_match;
+
+		// token + literal length bytes + literals + offset + match length bytes
+		if (op + 1 + literal_length / 255 + 1 + literal_length + 2 + match_length / 255 + 1 >= oend) {
+			return 0;
+		}
+
+		uint8_t *token = op++;
+
+		if (literal_length >= 15) {
+			*token = 15 << 4;
+			op = write_length(op, literal_length);
+
+		} else {
+			*token = (uint8_t)(literal_length << 4);
+		}
+
+		memcpy(op, anchor, literal_length);
+		op += literal_length;
+
+		const uint16_t offset = (uint16_t)(ip - ref);
+		*op++ = (uint8_t)(offset & 0xff);
+		*op++ = (uint8_t)(offset >> 8);
+
+		if (match_length >= 15) {
+			*token |= 15;
+			op = write_length(op, match_length);
+
+		} else {
+			*token |= (uint8_t)match_length;
+		}
+
+		ip = match_end;
+		anchor = ip;
+
+		// also index a position inside the match, this improves the ratio for repeated records
+		if (ip < mflimit) {
+			_hash_table[hash(read32(ip - 2))] = (uint16_t)(ip - 2 - src);
+		}
+	}
+
+	// the remaining bytes are literals
+	const size_t literal_length = iend - anchor;
+
+	if (op + 1 + literal_length / 255 + 1 + literal_length >= oend) {
+		return 0;
+	}
+
+	if (literal_length >= 15) {
+		*op++ = 15 << 4;
+		op = write_length(op, literal_length);
+
+	} else {
+		*op++ = (uint8_t)(literal_length << 4);
+	}
+
+	memcpy(op, anchor, literal_length);
+	op += literal_length;
+
+	return op - dst;
+}
+
+}
+}
@@ -0,0 +1,94 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2017 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace px4
+{
+namespace logger
+{
+
+/**
+ * @class LogCompressor
+ * Fast block compressor for the log writer thread. The output uses the LZ4 block format
+ * (https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md), so it can be decompressed
+ * by any LZ4 implementation. The compression is greedy with a single hash probe, trading
+ * compression ratio for a low and constant CPU load.
+ */
+class LogCompressor
+{
+public:
+	/** maximum input size of a block: offsets and hash table entries are 16 bit */
+	static constexpr size_t max_block_size = 4096;
+
+	LogCompressor() = default;
+	~LogCompressor();
+
+	/**
+	 * allocate the hash table
+	 * @return true on success
+	 */
+	bool init();
+
+	/**
+	 * Compress a block
+	 * @param src input data
+	 * @param size input size, at most max_block_size
+	 * @param dst output buffer, with space for at least size bytes
+	 * @return compressed size, or 0 if the data does not compress (it must be stored as-is then)
+	 */
+	size_t compress(const uint8_t *src, size_t size, uint8_t *dst);
+
+private:
+	static constexpr int hash_bits = 11;
+	static constexpr size_t min_match = 4;
+	static constexpr size_t last_literals = 5; ///< the last bytes of a block are always literals
+	static constexpr size_t match_limit = 12; ///< a match must start at least this many bytes before the end
+
+	static inline uint32_t read32(const uint8_t *p);
+	static inline unsigned hash(uint32_t sequence);
+
+	/**
+	 * write an LZ4 length extension (for lengths >= 15)
+	 */
+	static inline uint8_t *write_length(uint8_t *op, size_t length);
+
+	uint16_t *_hash_table = nullptr; ///< block positions of the last occurrence of each hashed sequence
+};
+
+}
+}
@@ -84,7 +84,7 @@ public:
 	bool is_started(Backend query_backend) const;
 
 	/**
-	 * Write a single ulog message (including header). The caller must call lock() before calling this.
+	 * Write a single ulog message (including header). Must be called from the logger thread only.
 	 * @param dropout_start timestamp when lastest dropout occured. 0 if no dropout at the moment.
 	 * @return 0 on success (or if no logging started),
 	 *         -1 if not enough space in the buffer left (file backend), -2 mavlink backend failed
@@ -101,19 +101,67 @@ public:
 
 	/* file logging methods */
 
-	void lock()
+	void notify()
 	{
-		if (_log_writer_file) { _log_writer_file->lock(); }
+		if (_log_writer_file) { _log_writer_file->notify(); }
 	}
 
-	void unlock()
+	/**
+	 * Compress the log file (file backend only). Must be called before starting a log.
+	 * @return true if compression is enabled
+	 */
+	bool enable_compression_file()
 	{
-		if (_log_writer_file) { _log_writer_file->unlock(); }
+		if (_log_writer_file) { return _log_writer_file->enable_compression(); }
+
+		return false;
 	}
 
-	void notify()
+	/** @see LogWriterFile::enable_mmap() */
+	bool enable_mmap_file()
 	{
-		if (_log_writer_file) { _log_writer_file->notify(); }
+		if (_log_writer_file) { return _log_writer_file->enable_mmap(); }
+
+		return false;
+	}
+
+	/** @see LogWriterFile::enable_history() */
+	bool enable_history_file(hrt_abstime duration)
+	{
+		if (_log_writer_file) { return _log_writer_file->enable_history(duration); }
+
+		return false;
+	}
+
+	/** @see LogWriterFile::write_history() */
+	void write_history_file(void *ptr, size_t size)
+	{
+		if (_log_writer_file) { _log_writer_file->write_history(ptr, size); }
+	}
+
+	/** @see LogWriterFile::end_definitions() */
+	void end_definitions_file()
+	{
+		if (_log_writer_file) { _log_writer_file->end_definitions(); }
+	}
+
+	/** @see LogWriterFile::set_index_file() */
+	void set_index_file(const char *index_file)
+	{
+		if (_log_writer_file) { _log_writer_file->set_index_file(index_file); }
+	}
+
+	/** @see LogWriterFile::set_write_size() */
+	void set_write_size_file(size_t write_size)
+	{
+		if (_log_writer_file) { _log_writer_file->set_write_size(write_size); }
+	}
+
+	bool compression_enabled_file() const
+	{
+		if (_log_writer_file) { return _log_writer_file->compression_enabled(); }
+
+		return false;
 	}
 
 	size_t get_total_written_file() const
@@ -123,6 +171,13 @@ public:
 		return 0;
 	}
 
+	size_t get_total_logged_file() const
+	{
+		if (_log_writer_file) { return _log_writer_file->get_total_logged(); }
+
+		return 0;
+	}
+
 	size_t get_buffer_size_file() const
 	{
 		if (_log_writer_file) { return _log_writer_file->get_buffer_size(); }
@@ -130,6 +185,17 @@ public:
 		return 0;
 	}
 
+	/** @see LogWriterFile::get_statistics() */
+	bool get_statistics_file(LogWriterFileStatistics &statistics, bool reset)
+	{
+		if (_log_writer_file) {
+			_log_writer_file->get_statistics(statistics, reset);
+			return true;
+		}
+
+		return false;
+	}
+
 	size_t get_buffer_fill_count_file() const
 	{
 		if (_log_writer_file) { return _log_writer_file->get_buffer_fill_count(); }
@@ -35,27 +35,37 @@
 #include "messages.h"
 #include <fcntl.h>
 #include <string.h>
+#include <stdint.h>
 
 #include <mathlib/mathlib.h>
 #include <px4_posix.h>
+#include <px4_time.h>
+#include <unistd.h>
 #ifdef __PX4_NUTTX
 #include <systemlib/hardfault_log.h>
 #endif /* __PX4_NUTTX */
+#ifdef LOG_WRITER_FILE_MMAP_SUPPORTED
+#include <sys/mman.h>
+#endif /* LOG_WRITER_FILE_MMAP_SUPPORTED */
 
 namespace px4
 {
 namespace logger
 {
 constexpr size_t LogWriterFile::_min_write_chunk;
+constexpr size_t LogWriterFile::_compress_buffer_size;
 
 
 LogWriterFile::LogWriterFile(size_t buffer_size) :
 	//We always write larger chunks (orb messages) to the buffer, so the buffer
 	//needs to be larger than the minimum write chunk (300 is somewhat arbitrary)
-	_buffer_size(math::max(buffer_size, _min_write_chunk + 300))
+	//The size is rounded up to a multiple of the minimum write chunk, so that the end of the
+	//buffer corresponds to a cluster boundary in the file
+	_buffer_size((math::max(buffer_size, _min_write_chunk + 300) + _min_write_chunk - 1) & ~(_min_write_chunk - 1))
 {
-	pthread_mutex_init(&_mtx, nullptr);
-	pthread_cond_init(&_cv, nullptr);
+	px4_sem_init(&_sem, 0, 0);
+	/* _sem use case is a signal */
+	px4_sem_setprotocol(&_sem, SEM_PRIO_NONE);
 	/* allocate write performance counters */
 	_perf_write = perf_alloc(PC_ELAPSED, "logger_sd_write");
 	_perf_fsync = perf_alloc(PC_ELAPSED, "logger_sd_fsync");
@@ -66,10 +76,44 @@ bool LogWriterFile::init()
 	return true;
 }
 
+bool LogWriterFile::enable_compression()
+{
+	if (_compressor) {
+		return true;
+	}
+
+	_compressor = new LogCompressor();
+	_compress_buffer = new uint8_t[_compress_buffer_size];
+
+	if (_compressor == nullptr || _compress_buffer == nullptr || !_compressor->init()) {
+		delete _compressor;
+		delete[] _compress_buffer;
+		_compressor = nullptr;
+		_compress_buffer = nullptr;
+		return false;
+	}
+
+	return true;
+}
+
+bool LogWriterFile::enable_mmap()
+{
+#ifdef LOG_WRITER_FILE_MMAP_SUPPORTED
+
+	if (_compressor) {
+		return false;
+	}
+
+	_use_mmap = true;
+	return true;
+#else
+	return false;
+#endif /* LOG_WRITER_FILE_MMAP_SUPPORTED */
+}
+
 LogWriterFile::~LogWriterFile()
 {
-	pthread_mutex_destroy(&_mtx);
-	pthread_cond_destroy(&_cv);
+	px4_sem_destroy(&_sem);
 	perf_free(_perf_write);
 	perf_free(_perf_fsync);
 
@@ -80,6 +124,14 @@ LogWriterFile::~LogWriterFile()
 	if (_buffer) {
 		delete[] _buffer;
 	}
+
+	if (_compressor) {
+		delete _compressor;
+	}
+
+	if (_compress_buffer) {
+		delete[] _compress_buffer;
+	}
 }
 
 void LogWriterFile::start_log(const char *filename)
@@ -94,7 +146,20 @@ void LogWriterFile::start_log(const char *filename)
 		PX4_ERR("Failed to register ULog file to the hardfault handler (%i)", ret);
 	}
 
-	_fd = ::open(filename, O_CREAT | O_WRONLY, PX4_O_MODE_666);
+	if (strlen(filename) < sizeof(_file_name)) {
+		strcpy(_file_name, filename);
+
+	} else {
+		_file_name[0] = '\0';
+	}
+
+	// the clock is only meaningful once it has been set (e.g. from GPS)
+	struct timespec ts = {};
+	px4_clock_gettime(CLOCK_REALTIME, &ts);
+	_file_time_utc = ts.tv_sec > 60 * 60 * 24 ? ts.tv_sec : 0;
+
+	// mmap requires read access, even if we only write
+	_fd = ::open(filename, O_CREAT | (_use_mmap ? O_RDWR : O_WRONLY), PX4_O_MODE_666);
 
 	if (_fd < 0) {
 		PX4_ERR("Can't open log file %s, errno: %d", filename, errno);
@@ -102,6 +167,34 @@ void LogWriterFile::start_log(const char *filename)
 		return;
 	}
 
+#ifdef LOG_WRITER_FILE_MMAP_SUPPORTED
+
+	if (_use_mmap) {
+		_total_written = 0;
+		_total_logged = 0;
+		_mmap_base = nullptr;
+		_mmap_file_offset = 0;
+		_mmap_pos = 0;
+
+		int ret_map = map_next_window();
+
+		if (ret_map != 0) {
+			PX4_ERR("Can't map log file (%i)", ret_map);
+			::close(_fd);
+			_fd = -1;
+			_should_run = false;
+			return;
+		}
+
+		PX4_INFO("Opened log file: %s (memory-mapped)", filename);
+		_should_run = true;
+		_running = true;
+		notify();
+		return;
+	}
+
+#endif /* LOG_WRITER_FILE_MMAP_SUPPORTED */
+
 	if (_buffer == nullptr) {
 		_buffer = new uint8_t[_buffer_size];
 
@@ -114,14 +207,46 @@ void LogWriterFile::start_log(const char *filename)
 		}
 	}
 
+	// Clear buffer and counters (unless it contains the history)
+	const bool write_history = history_enabled() && _head != _tail;
+
+	if (!write_history) {
+		_head = 0;
+		_tail = 0;
+	}
+
+	_total_written = 0;
+	_total_logged = 0;
+	_compress_count = 0;
+	_preallocated_size = 0;
+
+	if (_compressor) {
+		const ulog_compressed_file_header_s header = {{'U', 'L', 'o', 'g', 'Z', 0x12, 0x35, ULOG_COMPRESSED_VERSION}};
+
+		if (::write(_fd, &header, sizeof(header)) != sizeof(header)) {
+			PX4_ERR("Can't write log file header");
+			::close(_fd);
+			_fd = -1;
+			_should_run = false;
+			return;
+		}
+
+		_total_written = sizeof(header);
+	}
+
+	preallocate();
+
+	if (write_history) {
+		// the definitions must come before the history in the file: write them directly,
+		// and let the writer thread start with the buffer in end_definitions()
+		PX4_INFO("Opened log file: %s (%zu bytes of history)", filename, fill_count(_head, _tail));
+		_write_direct = true;
+		return;
+	}
+
 	PX4_INFO("Opened log file: %s", filename);
 	_should_run = true;
 	_running = true;
-
-	// Clear buffer and counters
-	_head = 0;
-	_count = 0;
-	_total_written = 0;
 	notify();
 }
 
@@ -157,6 +282,107 @@ int LogWriterFile::hardfault_store_filename(const char *log_file)
 	return 0;
 }
 
+void LogWriterFile::end_definitions()
+{
+	if (!_write_direct) {
+		return;
+	}
+
+	_write_direct = false;
+	_should_run = true;
+	_running = true;
+	notify();
+}
+
+bool LogWriterFile::enable_history(hrt_abstime duration)
+{
+	if (_use_mmap) {
+		return false;
+	}
+
+	if (_buffer == nullptr) {
+		_buffer = new uint8_t[_buffer_size];
+
+		if (_buffer == nullptr) {
+			return false;
+		}
+	}
+
+	_history_duration = duration;
+	return true;
+}
+
+void LogWriterFile::write_history(void *ptr, size_t size)
+{
+	if (!history_enabled() || is_started() || _running || size >= _buffer_size) {
+		return;
+	}
+
+	const hrt_abstime now = hrt_absolute_time();
+
+	// drop the oldest messages (all history messages are data messages, starting with a timestamp)
+	// until there is enough space and the oldest one is within the history duration
+	while (_head != _tail) {
+		uint8_t msg[sizeof(ulog_message_data_header_s) + sizeof(uint64_t)];
+		read_buffer(_tail, msg, sizeof(msg));
+
+		uint64_t timestamp;
+		memcpy(&timestamp, &msg[sizeof(ulog_message_data_header_s)], sizeof(timestamp));
+
+		if (_buffer_size - 1 - fill_count(_head, _tail) >= size && timestamp + _history_duration >= now) {
+			break;
+		}
+
+		const size_t msg_size = ULOG_MSG_HEADER_LEN + (msg[0] | (msg[1] << 8));
+		_tail = (_tail + msg_size) % _buffer_size;
+	}
+
+	write_no_check(ptr, size);
+}
+
+void LogWriterFile::read_buffer(size_t pos, void *dst, size_t size) const
+{
+	uint8_t *dst_c = reinterpret_cast<uint8_t *>(dst);
+	const size_t n = math::min(size, _buffer_size - pos);	// bytes to end of the buffer
+
+	memcpy(dst_c, &_buffer[pos], n);
+	memcpy(&dst_c[n], &_buffer[0], size - n);
+}
+
+int LogWriterFile::write_direct(const void *ptr, size_t size)
+{
+	const uint8_t *ptr_c = reinterpret_cast<const uint8_t *>(ptr);
+
+	while (size > 0) {
+		ssize_t written;
+
+		if (_compressor) {
+			written = write_compressed(ptr_c, size, false);
+
+		} else {
+			written = timed_write(ptr_c, size);
+
+			if (written > 0) {
+				_total_written += written;
+			}
+		}
+
+		if (written <= 0) {
+			PX4_WARN("error writing log file");
+			_write_direct = false;
+			::close(_fd);
+			_fd = -1;
+			return 0;
+		}
+
+		_total_logged += written;
+		ptr_c += written;
+		size -= written;
+	}
+
+	return 0;
+}
+
 void LogWriterFile::stop_log()
 {
 	_should_run = false;
@@ -211,64 +437,76 @@ void LogWriterFile::run()
 	while (!_exit_thread) {
 		// Outer endless loop
 		// Wait for _should_run flag
-		while (!_exit_thread) {
-			bool start = false;
-			pthread_mutex_lock(&_mtx);
-			pthread_cond_wait(&_cv, &_mtx);
-			start = _should_run;
-			pthread_mutex_unlock(&_mtx);
-
-			if (start) {
-				break;
-			}
+		while (!_exit_thread && !_should_run) {
+			px4_sem_wait(&_sem);
 		}
 
 		if (_exit_thread) {
 			break;
 		}
 
-		int poll_count = 0;
+#ifdef LOG_WRITER_FILE_MMAP_SUPPORTED
+
+		if (_use_mmap) {
+			run_mmap();
+			continue;
+		}
+
+#endif /* LOG_WRITER_FILE_MMAP_SUPPORTED */
+
 		int written = 0;
+		size_t fsync_total_written = _total_written;
+		hrt_abstime last_fsync = hrt_absolute_time();
 
 		while (true) {
 			size_t available = 0;
 			void *read_ptr = nullptr;
 			bool is_part = false;
 
-			/* lock _buffer
-			 * wait for sufficient data, cycle on notify()
-			 */
-			pthread_mutex_lock(&_mtx);
-
+			/* wait for sufficient data, cycle on notify() */
 			while (true) {
 				available = get_read_ptr(&read_ptr, &is_part);
 
 				/* if sufficient data available or partial read or terminating, exit this wait loop */
-				if ((available >= _min_write_chunk) || is_part || !_should_run) {
+				if ((available >= _write_size) || is_part || !_should_run) {
 					/* GOTO end of block */
 					break;
 				}
 
-				/* wait for a call to notify()
-				 * this call unlocks the mutex while waiting, and returns with the mutex locked
-				 */
-				pthread_cond_wait(&_cv, &_mtx);
+				/* wait for a call to notify(). A wakeup posted since the last check is not lost,
+				 * as it is kept in the semaphore count */
+				px4_sem_wait(&_sem);
 			}
 
-			pthread_mutex_unlock(&_mtx);
 			written = 0;
 
 			if (available > 0) {
-				perf_begin(_perf_write);
-				written = ::write(_fd, read_ptr, available);
-				perf_end(_perf_write);
-
-				/* call fsync periodically to minimize potential loss of data */
-				if (++poll_count >= 100) {
-					perf_begin(_perf_fsync);
-					::fsync(_fd);
-					perf_end(_perf_fsync);
-					poll_count = 0;
+				if (_compressor) {
+					written = write_compressed(read_ptr, available, !_should_run);
+
+				} else {
+					size_t write_size = available;
+
+					if (_should_run) {
+						/* end the write on a cluster boundary, so that the next write starts aligned.
+						 * The buffer size is a multiple of the cluster size, so the end of the buffer
+						 * (partial read) is aligned as well. */
+						const size_t aligned_end = (_total_written + available) & ~(_min_write_chunk - 1);
+
+						if (aligned_end > _total_written) {
+							write_size = aligned_end - _total_written;
+						}
+					}
+
+					written = timed_write(read_ptr, write_size);
+				}
+
+				/* call fsync after a fixed amount of data (or time) to minimize potential loss of data */
+				if (_total_written - fsync_total_written >= _fsync_interval_bytes ||
+				    (_total_written != fsync_total_written && hrt_elapsed_time(&last_fsync) > _fsync_interval_max)) {
+					timed_fsync();
+					fsync_total_written = _total_written;
+					last_fsync = hrt_absolute_time();
 				}
 
 				if (written < 0) {
@@ -278,19 +516,24 @@ void LogWriterFile::run()
 					break;
 				}
 
-				pthread_mutex_lock(&_mtx);
-				/* subtract bytes written from number in _buffer (_count -= written) */
+				/* release the written bytes to the producer */
 				mark_read(written);
-				pthread_mutex_unlock(&_mtx);
 
-				_total_written += written;
+				if (!_compressor) {
+					_total_written += written;
+				}
+
+				_total_logged += written;
+				preallocate();
 			}
 
 			if (!_should_run && written == static_cast<int>(available) && !is_part) {
 				// Stop only when all data written
+				if (_compressor && flush_compressed(true) < 0) {
+					PX4_WARN("error writing log file");
+				}
+
 				_running = false;
-				_head = 0;
-				_count = 0;
 
 				if (_fd >= 0) {
 					int res = ::close(_fd);
@@ -301,6 +544,7 @@ void LogWriterFile::run()
 
 					} else {
 						PX4_INFO("closed logfile, bytes written: %zu", _total_written);
+						append_index_entry();
 					}
 				}
 
@@ -316,10 +560,8 @@ int LogWriterFile::write_message(void *ptr, size_t size, uint64_t dropout_start)
 		int ret;
 
 		while ((ret = write(ptr, size, dropout_start)) == -1) {
-			unlock();
 			notify();
 			usleep(3000);
-			lock();
 		}
 
 		return ret;
@@ -334,8 +576,29 @@ int LogWriterFile::write(void *ptr, size_t size, uint64_t dropout_start)
 		return 0;
 	}
 
-	// Bytes available to write
-	size_t available = _buffer_size - _count;
+	if (_write_direct) {
+		return write_direct(ptr, size);
+	}
+
+#ifdef LOG_WRITER_FILE_MMAP_SUPPORTED
+
+	if (_use_mmap) {
+		if (dropout_start) {
+			ulog_message_dropout_s dropout_msg;
+			dropout_msg.duration = (uint16_t)(hrt_elapsed_time(&dropout_start) / 1000);
+
+			if (write_mmap(&dropout_msg, sizeof(dropout_msg))) {
+				return -1;
+			}
+		}
+
+		return write_mmap(ptr, size);
+	}
+
+#endif /* LOG_WRITER_FILE_MMAP_SUPPORTED */
+
+	// Bytes available to write (one byte is kept free to distinguish a full from an empty buffer)
+	size_t available = _buffer_size - 1 - fill_count(_head, _tail);
 	size_t dropout_size = 0;
 
 	if (dropout_start) {
@@ -360,14 +623,15 @@ int LogWriterFile::write(void *ptr, size_t size, uint64_t dropout_start)
 
 void LogWriterFile::write_no_check(void *ptr, size_t size)
 {
-	size_t n = _buffer_size - _head;	// bytes to end of the buffer
+	size_t head = _head;
+	size_t n = _buffer_size - head;	// bytes to end of the buffer
 
 	uint8_t *buffer_c = reinterpret_cast<uint8_t *>(ptr);
 
 	if (size > n) {
 		// Message goes over the end of the buffer
-		memcpy(&(_buffer[_head]), buffer_c, n);
-		_head = 0;
+		memcpy(&(_buffer[head]), buffer_c, n);
+		head = 0;
 
 	} else {
 		n = 0;
@@ -375,26 +639,378 @@ void LogWriterFile::write_no_check(void *ptr, size_t size)
 
 	// now: n = bytes already written
 	size_t p = size - n;	// number of bytes to write
-	memcpy(&(_buffer[_head]), &(buffer_c[n]), p);
-	_head = (_head + p) % _buffer_size;
-	_count += size;
+	memcpy(&(_buffer[head]), &(buffer_c[n]), p);
+
+	// publish the data to the writer thread only after it is completely in the buffer
+	__sync_synchronize();
+	_head = (head + p) % _buffer_size;
+}
+
+int LogWriterFile::write_compressed(const void *ptr, size_t size, bool flush)
+{
+	const size_t block_size = math::min(size, LogCompressor::max_block_size);
+	ulog_compressed_block_s block;
+	block.size = block_size;
+	block.compressed_size = _compressor->compress((const uint8_t *)ptr,
+				block_size, &_compress_buffer[_compress_count + sizeof(block)]);
+
+	if (block.compressed_size == 0) {
+		// not compressible: store it
+		memcpy(&_compress_buffer[_compress_count + sizeof(block)], ptr, block_size);
+	}
+
+	memcpy(&_compress_buffer[_compress_count], &block, sizeof(block));
+	_compress_count += sizeof(block) + (block.compressed_size > 0 ? block.compressed_size : block_size);
+
+	if (_compress_count >= _min_write_chunk || flush) {
+		if (flush_compressed(flush) < 0) {
+			return -1;
+		}
+	}
+
+	return block_size;
+}
+
+int LogWriterFile::flush_compressed(bool all)
+{
+	size_t write_size = _compress_count;
+
+	if (!all) {
+		/* write up to the next cluster boundary, and keep the rest for the next write */
+		const size_t aligned_end = (_total_written + _compress_count) & ~(_min_write_chunk - 1);
+
+		if (aligned_end <= _total_written) {
+			return 0;
+		}
+
+		write_size = aligned_end - _total_written;
+	}
+
+	if (write_size == 0) {
+		return 0;
+	}
+
+	int written = timed_write(_compress_buffer, write_size);
+
+	// a partial write would corrupt the block structure
+	if (written != static_cast<int>(write_size)) {
+		return -1;
+	}
+
+	_total_written += written;
+	_compress_count -= write_size;
+
+	if (_compress_count > 0) {
+		memmove(_compress_buffer, &_compress_buffer[write_size], _compress_count);
+	}
+
+	return 0;
+}
+
+void LogWriterFile::set_write_size(size_t write_size)
+{
+	/* a multiple of the cluster size, and leave room in the buffer for the logger to write into */
+	write_size = math::min(write_size, _buffer_size / 2);
+	write_size &= ~(_min_write_chunk - 1);
+	_write_size = math::max(write_size, _min_write_chunk);
+}
+
+ssize_t LogWriterFile::timed_write(const void *ptr, size_t size)
+{
+	perf_begin(_perf_write);
+	const hrt_abstime start = hrt_absolute_time();
+	ssize_t written = ::write(_fd, ptr, size);
+	const uint32_t duration = hrt_elapsed_time(&start);
+	perf_end(_perf_write);
+
+	int bucket = 0;
+
+	for (uint32_t limit = 500; bucket < LogWriterFileStatistics::latency_buckets - 1 && duration >= limit; limit *= 2) {
+		++bucket;
+	}
+
+	++_statistics.write_latency_histogram[bucket];
+
+	if (duration > _statistics.write_latency_max) {
+		_statistics.write_latency_max = duration;
+	}
+
+	return written;
+}
+
+void LogWriterFile::timed_fsync()
+{
+	perf_begin(_perf_fsync);
+	const hrt_abstime start = hrt_absolute_time();
+	::fsync(_fd);
+	const uint32_t duration = hrt_elapsed_time(&start);
+	perf_end(_perf_fsync);
+
+	++_statistics.fsync_count;
+	_statistics.fsync_time_total += duration;
+
+	if (duration > _statistics.fsync_time_max) {
+		_statistics.fsync_time_max = duration;
+	}
+}
+
+void LogWriterFile::get_statistics(LogWriterFileStatistics &statistics, bool reset)
+{
+	// the writer thread might update the statistics concurrently: this only affects the accuracy
+	statistics = _statistics;
+
+	if (reset) {
+		memset(&_statistics, 0, sizeof(_statistics));
+	}
+}
+
+void LogWriterFile::preallocate()
+{
+#ifdef __PX4_LINUX
+
+	/* reserve the file space upfront, so that the file system does not need to find free space on each write */
+	if (_total_written + _write_size * 2 > _preallocated_size) {
+		if (fallocate(_fd, FALLOC_FL_KEEP_SIZE, _preallocated_size, _preallocate_step) == 0) {
+			_preallocated_size += _preallocate_step;
+
+		} else {
+			/* not supported by the file system: do not try again for this file */
+			_preallocated_size = SIZE_MAX;
+		}
+	}
+
+#endif /* __PX4_LINUX */
+}
+
+#ifdef LOG_WRITER_FILE_MMAP_SUPPORTED
+
+int LogWriterFile::write_mmap(const void *ptr, size_t size)
+{
+	const uint8_t *data = (const uint8_t *)ptr;
+
+	while (size > 0) {
+		if (_mmap_pos >= _mmap_window_size) {
+			int ret = map_next_window();
+
+			if (ret != 0) {
+				// cannot continue: stop logging, the writer thread closes the file
+				PX4_ERR("Can't map log file (%i)", ret);
+				_should_run = false;
+				notify();
+				return -1;
+			}
+		}
+
+		const size_t n = math::min(size, _mmap_window_size - _mmap_pos);
+		memcpy(_mmap_base + _mmap_pos, data, n);
+		_mmap_pos += n;
+		_total_written += n;
+		_total_logged += n;
+		data += n;
+		size -= n;
+	}
+
+	return 0;
+}
+
+int LogWriterFile::map_next_window()
+{
+	if (_mmap_base) {
+		// rotation: start the writeback of the full window, we don't need it anymore
+		msync(_mmap_base, _mmap_window_size, MS_ASYNC);
+		munmap(_mmap_base, _mmap_window_size);
+		_mmap_base = nullptr;
+		_mmap_file_offset += _mmap_window_size;
+	}
+
+	const size_t file_size = _mmap_file_offset + _mmap_window_size;
+
+#ifdef __PX4_LINUX
+
+	/* reserve the blocks, so that page faults do not need to allocate file space */
+	if (fallocate(_fd, 0, _mmap_file_offset, _mmap_window_size) != 0)
+#endif /* __PX4_LINUX */
+	{
+		if (ftruncate(_fd, file_size) != 0) {
+			return -errno;
+		}
+	}
+
+	void *base = mmap(nullptr, _mmap_window_size, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, _mmap_file_offset);
+
+	if (base == MAP_FAILED) {
+		return -errno;
+	}
+
+	madvise(base, _mmap_window_size, MADV_SEQUENTIAL);
+	_mmap_base = (uint8_t *)base;
+	_mmap_pos = 0;
+	return 0;
+}
+
+void LogWriterFile::run_mmap()
+{
+	size_t fsync_total_written = _total_written;
+	hrt_abstime last_fsync = hrt_absolute_time();
+
+	// the logger thread writes directly into the mapping: we only need to make sure the data gets
+	// to the file regularly (fsync also writes back the mapped pages)
+	while (_should_run) {
+		px4_sem_wait(&_sem);
+
+		if (_total_written - fsync_total_written >= _fsync_interval_bytes ||
+		    (_total_written != fsync_total_written && hrt_elapsed_time(&last_fsync) > _fsync_interval_max)) {
+			fsync_total_written = _total_written;
+			timed_fsync();
+			last_fsync = hrt_absolute_time();
+		}
+	}
+
+	// logging is stopped, so the logger thread does not access the mapping anymore
+	if (_mmap_base) {
+		msync(_mmap_base, _mmap_pos, MS_SYNC);
+		munmap(_mmap_base, _mmap_window_size);
+		_mmap_base = nullptr;
+	}
+
+	// remove the unused, extended part of the file
+	int res = ftruncate(_fd, _total_written);
+	res |= ::close(_fd);
+	_fd = -1;
+	_running = false;
+
+	if (res) {
+		PX4_WARN("error closing log file");
+
+	} else {
+		PX4_INFO("closed logfile, bytes written: %zu", _total_written);
+		append_index_entry();
+	}
+}
+
+#endif /* LOG_WRITER_FILE_MMAP_SUPPORTED */
+
+void LogWriterFile::append_index_entry()
+{
+	if (!_index_file) {
+		return;
+	}
+
+	char line[160];
+	int n = -1;
+
+	if (_file_name[0] != '\0') {
+		n = snprintf(line, sizeof(line), "%u %u %s\n", (unsigned)_file_time_utc, (unsigned)_total_written, _file_name);
+	}
+
+	bool ok = n > 0 && n < (int)sizeof(line);
+	int ret = ok ? replace_index_entry(line) : -1;
+
+	if (ret == 0) {
+		int fd = ::open(_index_file, O_WRONLY | O_APPEND);
+
+		if (fd < 0) {
+			// no index (yet): the next listing scans the log directories and creates it
+			return;
+		}
+
+		ok = ::write(fd, line, n) == n;
+		::close(fd);
+
+	} else {
+		ok = ret > 0;
+	}
+
+	if (!ok) {
+		// an incomplete index must not be used
+		PX4_WARN("failed to update the log index");
+		unlink(_index_file);
+	}
+}
+
+int LogWriterFile::replace_index_entry(const char *entry)
+{
+	// a listing taken while the log was open has already indexed it, with the size at that time
+	FILE *index = fopen(_index_file, "r");
+
+	if (!index) {
+		return 0;
+	}
+
+	char line[160];
+	bool found = false;
+
+	while (!found && fgets(line, sizeof(line), index)) {
+		found = index_entry_matches(line);
+	}
+
+	if (!found) {
+		fclose(index);
+		return 0;
+	}
+
+	char tmp_file[64];
+	int n = snprintf(tmp_file, sizeof(tmp_file), "%s.tmp", _index_file);
+	FILE *tmp = (n > 0 && n < (int)sizeof(tmp_file)) ? fopen(tmp_file, "w") : nullptr;
+	bool ok = tmp != nullptr;
+
+	rewind(index);
+
+	while (ok && fgets(line, sizeof(line), index)) {
+		ok = fputs(index_entry_matches(line) ? entry : line, tmp) >= 0;
+	}
+
+	fclose(index);
+
+	if (tmp) {
+		ok = (fclose(tmp) == 0) && ok;
+		ok = ok && rename(tmp_file, _index_file) == 0;
+
+		if (!ok) {
+			unlink(tmp_file);
+		}
+	}
+
+	return ok ? 1 : -1;
+}
+
+bool LogWriterFile::index_entry_matches(const char *line) const
+{
+	// "<UTC time [s]> <size [bytes]> <path>\n"
+	const char *path = strchr(line, ' ');
+
+	if (path) {
+		path = strchr(path + 1, ' ');
+	}
+
+	if (!path) {
+		return false;
+	}
+
+	++path;
+	const size_t len = strlen(_file_name);
+	return strncmp(path, _file_name, len) == 0 && (path[len] == '\n' || path[len] == '\0');
 }
 
 size_t LogWriterFile::get_read_ptr(void **ptr, bool *is_part)
 {
-	// bytes available to read
-	int read_ptr = _head - _count;
+	// take a snapshot of the head: the producer may advance it concurrently
+	const size_t head = _head;
+	const size_t tail = _tail;
+
+	// make sure the data up to head is visible
+	__sync_synchronize();
+
+	*ptr = &_buffer[tail];
 
-	if (read_ptr < 0) {
-		read_ptr += _buffer_size;
-		*ptr = &_buffer[read_ptr];
+	if (head < tail) {
+		// the data wraps around the end of the buffer
 		*is_part = true;
-		return _buffer_size - read_ptr;
+		return _buffer_size - tail;
 
 	} else {
-		*ptr = &_buffer[read_ptr];
 		*is_part = false;
-		return _count;
+		return head - tail;
 	}
 }
 
@@ -36,17 +36,37 @@
 #include <px4_defines.h>
 #include <stdint.h>
 #include <pthread.h>
+#include <px4_sem.h>
 #include <drivers/drv_hrt.h>
 #include <systemlib/perf_counter.h>
+#include "log_compressor.h"
+
+#if defined(__PX4_POSIX) && !defined(__PX4_QURT)
+#define LOG_WRITER_FILE_MMAP_SUPPORTED
+#endif
 
 namespace px4
 {
 namespace logger
 {
 
+/**
+ * Write and fsync timing statistics of LogWriterFile
+ */
+struct LogWriterFileStatistics {
+	static constexpr int latency_buckets = 8;
+	uint32_t write_latency_histogram[latency_buckets]; ///< write durations: <0.5, <1, <2, ..., <32, >=32 ms
+	uint32_t write_latency_max; ///< [us]
+	uint32_t fsync_count;
+	uint32_t fsync_time_max; ///< [us]
+	uint64_t fsync_time_total; ///< [us]
+};
+
 /**
  * @class LogWriterFile
- * Writes logging data to a file
+ * Writes logging data to a file.
+ * The buffer is a single-producer single-consumer ring: write_message() is only called from the
+ * logger thread, which owns _head, while the writer thread owns _tail. No lock is needed between them.
  */
 class LogWriterFile
 {
@@ -56,6 +76,70 @@ public:
 
 	bool init();
 
+	/**
+	 * Compress the written data (see Tools/ulog_decompress.py for the file format).
+	 * Must be called before starting a log.
+	 * @return true on success, false if the required buffers could not be allocated
+	 */
+	bool enable_compression();
+
+	bool compression_enabled() const { return _compressor != nullptr; }
+
+	/**
+	 * Write the log into a memory-mapped file instead of going through the buffer and the writer thread
+	 * (POSIX only). The file is extended and mapped in windows of _mmap_window_size, and the kernel
+	 * handles the writeback. The log buffer is not allocated in that case.
+	 * Must be called before starting a log, and cannot be combined with compression.
+	 * @return true on success, false if not supported
+	 */
+	bool enable_mmap();
+
+	bool mmap_enabled() const { return _use_mmap; }
+
+	/**
+	 * Set the size of the writes to the file. It is rounded down to a multiple of the
+	 * cluster size (4 KB), and limited to half of the buffer size.
+	 * Larger writes increase the SD card throughput. Must be called before starting a log.
+	 */
+	void set_write_size(size_t write_size);
+
+	size_t get_write_size() const { return _write_size; }
+
+	/**
+	 * Append an entry for every closed log to an index file, so that the logs can be listed without
+	 * scanning the log directories (see MavlinkLogHandler). Each line has the format
+	 * "<UTC time [s]> <size [bytes]> <path>".
+	 * Entries are only appended if the index exists: whoever creates it (by scanning the logs) makes
+	 * sure it is complete. If an entry cannot be added, the index is removed.
+	 * @param index_file path to the index (not copied)
+	 */
+	void set_index_file(const char *index_file) { _index_file = index_file; }
+
+	/**
+	 * Keep a history of the logged data in the buffer while no log is running (pre-trigger logging).
+	 * The oldest messages are dropped if the buffer is full or if they are older than the duration.
+	 * When a log is started, the definitions are written directly to the file, followed by the
+	 * history (@see end_definitions()). Must be called before starting a log, and cannot be combined
+	 * with mmap.
+	 * @param duration maximum age of the history [us]
+	 * @return true on success, false if the buffer could not be allocated or mmap is enabled
+	 */
+	bool enable_history(hrt_abstime duration);
+
+	bool history_enabled() const { return _history_duration > 0; }
+
+	/**
+	 * Add a data message to the history. Ignored while a log is running or the previous one is
+	 * still being written.
+	 */
+	void write_history(void *ptr, size_t size);
+
+	/**
+	 * Mark the end of the definitions of a log: if the log was started with a history, the
+	 * following messages are written to the buffer again, after the history
+	 */
+	void end_definitions();
+
 	/**
 	 * start the thread
 	 * @return 0 on success, error number otherwise (@see pthread_create)
@@ -68,29 +152,34 @@ public:
 
 	void stop_log();
 
-	bool is_started() const { return _should_run; }
+	bool is_started() const { return _should_run || _write_direct; }
 
 	/** @see LogWriter::write_message() */
 	int write_message(void *ptr, size_t size, uint64_t dropout_start = 0);
 
-	void lock()
+	/**
+	 * wake up the writer thread (does not block)
+	 */
+	void notify()
 	{
-		pthread_mutex_lock(&_mtx);
-	}
+		int value;
 
-	void unlock()
-	{
-		pthread_mutex_unlock(&_mtx);
+		/* a single pending wakeup is enough, the writer checks the buffer state after each wakeup */
+		if (px4_sem_getvalue(&_sem, &value) != 0 || value <= 0) {
+			px4_sem_post(&_sem);
+		}
 	}
 
-	void notify()
+	/** @return number of bytes written to the file (after compression) */
+	size_t get_total_written() const
 	{
-		pthread_cond_broadcast(&_cv);
+		return _total_written;
 	}
 
-	size_t get_total_written() const
+	/** @return number of logged bytes (before compression) */
+	size_t get_total_logged() const
 	{
-		return _total_written;
+		return _total_logged;
 	}
 
 	size_t get_buffer_size() const
@@ -98,9 +187,15 @@ public:
 		return _buffer_size;
 	}
 
+	/**
+	 * get the write statistics (updated by the writer thread)
+	 * @param reset reset them after reading
+	 */
+	void get_statistics(LogWriterFileStatistics &statistics, bool reset);
+
 	size_t get_buffer_fill_count() const
 	{
-		return _count;
+		return fill_count(_head, _tail);
 	}
 
 	void set_need_reliable_transfer(bool need_reliable)
@@ -122,7 +217,14 @@ private:
 
 	void mark_read(size_t n)
 	{
-		_count -= n;
+		/* make sure the data is read before the producer can overwrite it */
+		__sync_synchronize();
+		_tail = (_tail + n) % _buffer_size;
+	}
+
+	size_t fill_count(size_t head, size_t tail) const
+	{
+		return head >= tail ? head - tail : head + _buffer_size - tail;
 	}
 
 	/**
@@ -143,21 +245,115 @@ private:
 	 */
 	inline void write_no_check(void *ptr, size_t size);
 
+	/**
+	 * Write to the file from the logger thread, while the writer thread is idle (definitions of
+	 * a log started with a history)
+	 * @return 0 (the log is closed on a write error)
+	 */
+	int write_direct(const void *ptr, size_t size);
+
+	/**
+	 * copy data from the buffer (handling the wrap-around)
+	 */
+	void read_buffer(size_t pos, void *dst, size_t size) const;
+
+	/**
+	 * Compress (part of) a chunk from the buffer and write the compressed data to the file,
+	 * once at least _min_write_chunk bytes are collected.
+	 * @param flush write the collected data in any case
+	 * @return number of bytes consumed from ptr, <0 on write error
+	 */
+	int write_compressed(const void *ptr, size_t size, bool flush);
+
+	/**
+	 * Write the collected compressed data to the file
+	 * @param all write all data, instead of only up to the last cluster boundary
+	 * @return 0 on success, <0 on write error
+	 */
+	int flush_compressed(bool all);
+
+	/**
+	 * extend the reserved file space in advance if the current reservation is used up
+	 * (where supported by the OS)
+	 */
+	void preallocate();
+
+	/** write to the file and update the statistics */
+	ssize_t timed_write(const void *ptr, size_t size);
+
+	/** fsync the file and update the statistics */
+	void timed_fsync();
+
+	/** add the closed log file to the index (if enabled) */
+	void append_index_entry();
+
+	/**
+	 * Replace the entry of the closed log file in the index, if there is one.
+	 * @return 1 if it was replaced, 0 if there is none (or no index), -1 on error
+	 */
+	int replace_index_entry(const char *entry);
+
+	/** @return true if the index line is the entry of the current log file */
+	bool index_entry_matches(const char *line) const;
+
+#ifdef LOG_WRITER_FILE_MMAP_SUPPORTED
+	/**
+	 * copy data into the mapped file, mapping the next window if needed
+	 * @return 0 on success, -1 on error
+	 */
+	int write_mmap(const void *ptr, size_t size);
+
+	/**
+	 * unmap the current window (if any), then extend the file and map the next window
+	 * @return 0 on success, <0 on error
+	 */
+	int map_next_window();
+
+	/**
+	 * writer thread loop for a memory-mapped log: sync the data periodically, and finalize
+	 * the file when logging is stopped
+	 */
+	void run_mmap();
+#endif /* LOG_WRITER_FILE_MMAP_SUPPORTED */
+
 	/* 512 didn't seem to work properly, 4096 should match the FAT cluster size */
 	static constexpr size_t	_min_write_chunk = 4096;
 
+	/* collected compressed data: one write chunk plus the largest block that can be appended */
+	static constexpr size_t _compress_buffer_size = _min_write_chunk + LogCompressor::max_block_size + 4;
+
+	static constexpr size_t _fsync_interval_bytes = 256 * 1024;
+	static constexpr hrt_abstime _fsync_interval_max = 5000000; ///< fsync at least every 5s if there is new data
+	static constexpr size_t _preallocate_step = 8 * 1024 * 1024;
+	static constexpr size_t _mmap_window_size = 4 * 1024 * 1024; ///< must be a multiple of the page size
+
 	int			_fd = -1;
 	uint8_t 	*_buffer = nullptr;
 	const size_t	_buffer_size;
-	size_t			_head = 0; ///< next position to write to
-	size_t			_count = 0; ///< number of bytes in _buffer to be written
+	size_t		_write_size = _min_write_chunk; ///< minimum size of a write (except for partial reads)
+	size_t		_preallocated_size = 0; ///< reserved file space
+	volatile size_t	_head = 0; ///< next position to write to (only modified by the logger thread)
+	volatile size_t	_tail = 0; ///< next position to read from (only modified by the writer thread, or to drop history)
 	size_t		_total_written = 0;
+	size_t		_total_logged = 0;
+	const char	*_index_file = nullptr;
+	char		_file_name[128] {}; ///< current log file, for the index
+	uint32_t	_file_time_utc = 0; ///< start time of the current log, 0 if unknown
+	LogCompressor	*_compressor = nullptr;
+	uint8_t		*_compress_buffer = nullptr;
+	size_t		_compress_count = 0; ///< number of bytes in _compress_buffer to be written
+	bool		_use_mmap = false;
+	uint8_t		*_mmap_base = nullptr; ///< currently mapped window
+	size_t		_mmap_file_offset = 0; ///< file offset of the mapped window
+	size_t		_mmap_pos = 0; ///< write position within the mapped window
+	hrt_abstime	_history_duration = 0; ///< 0 if disabled
+	bool		_write_direct = false; ///< if true, write() writes to the file directly
 	bool		_should_run = false;
-	bool		_running = false;
+	volatile bool	_running = false;
 	bool 		_exit_thread = false;
 	bool		_need_reliable_transfer = false;
-	pthread_mutex_t		_mtx;
-	pthread_cond_t		_cv;
+	px4_sem_t	_sem; ///< signals new data or a state change to the writer thread
+	LogWriterFileStatistics _statistics{};
 	perf_counter_t _perf_write;
 	perf_counter_t _perf_fsync;
 	pthread_t _thread = 0;
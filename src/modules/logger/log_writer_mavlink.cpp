@@ -86,6 +86,8 @@ void LogWriterMavlink::start_log()
 	_ulog_stream_data.sequence = 0;
 	_ulog_stream_data.length = 0;
 	_ulog_stream_data.first_message_offset = 0;
+	_last_reliable_sequence = _ulog_stream_data.sequence - 1;
+	_acked_sequence = _last_reliable_sequence;
 	_is_started = true;
 }
 
@@ -132,6 +134,11 @@ void LogWriterMavlink::set_need_reliable_transfer(bool need_reliable)
 			// make sure to send previous data using reliable transfer
 			publish_message();
 		}
+
+		// the receiver expects all definitions before the data: wait until they are acked
+		if (is_started()) {
+			wait_for_acks(0);
+		}
 	}
 
 	_need_reliable_transfer = need_reliable;
@@ -154,48 +161,54 @@ int LogWriterMavlink::publish_message()
 	}
 
 	if (_need_reliable_transfer) {
-		// we need to wait for an ack. Note that this blocks the main logger thread, so if a file logging
-		// is already running, it will miss samples.
-		px4_pollfd_struct_t fds[1];
-		fds[0].fd = _ulog_stream_ack_sub;
-		fds[0].events = POLLIN;
-		bool got_ack = false;
-		const int timeout_ms = ulog_stream_ack_s::ACK_TIMEOUT * ulog_stream_ack_s::ACK_MAX_TRIES;
+		_last_reliable_sequence = _ulog_stream_data.sequence;
 
-		hrt_abstime started = hrt_absolute_time();
+		// wait only if the window is full. Note that this blocks the main logger thread, so if a file
+		// logging is already running, it will miss samples.
+		if (wait_for_acks(ulog_stream_ack_s::WINDOW_SIZE - 1)) {
+			return -2;
+		}
+	}
 
-		do {
-			int ret = px4_poll(fds, sizeof(fds) / sizeof(fds[0]), timeout_ms);
+	_ulog_stream_data.sequence++;
+	_ulog_stream_data.length = 0;
+	_ulog_stream_data.first_message_offset = 255;
+	return 0;
+}
 
-			if (ret <= 0) {
-				break;
-			}
+int LogWriterMavlink::wait_for_acks(uint16_t max_unacked)
+{
+	px4_pollfd_struct_t fds[1];
+	fds[0].fd = _ulog_stream_ack_sub;
+	fds[0].events = POLLIN;
+	const int timeout_ms = ulog_stream_ack_s::ACK_TIMEOUT * ulog_stream_ack_s::ACK_MAX_TRIES;
+
+	hrt_abstime last_progress = hrt_absolute_time();
 
-			if (fds[0].revents & POLLIN) {
-				ulog_stream_ack_s ack;
-				orb_copy(ORB_ID(ulog_stream_ack), _ulog_stream_ack_sub, &ack);
+	while ((uint16_t)(_last_reliable_sequence - _acked_sequence) > max_unacked) {
+		int ret = px4_poll(fds, sizeof(fds) / sizeof(fds[0]), timeout_ms);
 
-				if (ack.sequence == _ulog_stream_data.sequence) {
-					got_ack = true;
-				}
+		if (ret > 0 && (fds[0].revents & POLLIN)) {
+			ulog_stream_ack_s ack;
+			orb_copy(ORB_ID(ulog_stream_ack), _ulog_stream_ack_sub, &ack);
 
-			} else {
-				break;
+			// the ack is cumulative: ignore stale ones outside of the window
+			const uint16_t unacked = _last_reliable_sequence - _acked_sequence;
+
+			if ((uint16_t)(ack.sequence - _acked_sequence) <= unacked && ack.sequence != _acked_sequence) {
+				PX4_DEBUG("got ack for %i in %i ms", ack.sequence, (int)(hrt_elapsed_time(&last_progress) / 1000));
+				_acked_sequence = ack.sequence;
+				last_progress = hrt_absolute_time();
 			}
-		} while (!got_ack && hrt_elapsed_time(&started) / 1000 < timeout_ms);
+		}
 
-		if (!got_ack) {
+		if (ret < 0 || hrt_elapsed_time(&last_progress) / 1000 >= timeout_ms) {
 			PX4_ERR("Ack timeout. Stopping mavlink log");
 			stop_log();
 			return -2;
 		}
-
-		PX4_DEBUG("got ack in %i ms", (int)(hrt_elapsed_time(&started) / 1000));
 	}
 
-	_ulog_stream_data.sequence++;
-	_ulog_stream_data.length = 0;
-	_ulog_stream_data.first_message_offset = 255;
 	return 0;
 }
 
@@ -44,7 +44,9 @@ namespace logger
 
 /**
  * @class LogWriterMavlink
- * Writes logging data to uORB, and then sent via mavlink
+ * Writes logging data to uORB, and then sent via mavlink.
+ * Reliable transfer uses a sliding window: up to ulog_stream_ack_s::WINDOW_SIZE messages can be
+ * unacked, and the acks from mavlink are cumulative.
  */
 class LogWriterMavlink
 {
@@ -72,12 +74,20 @@ public:
 
 private:
 
-	/** publish message, wait for ack if needed & reset message */
+	/** publish message, wait for ack if the window is full & reset message */
 	int publish_message();
 
+	/**
+	 * wait until at most max_unacked messages are unacked
+	 * @return 0 on success, -2 on timeout (and logging is stopped)
+	 */
+	int wait_for_acks(uint16_t max_unacked);
+
 	ulog_stream_s _ulog_stream_data;
 	orb_advert_t _ulog_stream_pub = nullptr;
 	int _ulog_stream_ack_sub = -1;
+	uint16_t _last_reliable_sequence = 0; ///< sequence of the last message published with FLAGS_NEED_ACK
+	uint16_t _acked_sequence = 0; ///< all messages up to this sequence are acked
 	bool _need_reliable_transfer = false;
 	bool _is_started = false;
 	const unsigned int _queue_size;
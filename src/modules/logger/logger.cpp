@@ -35,6 +35,7 @@
 #include "logger.h"
 #include "messages.h"
 
+#include <ctype.h>
 #include <dirent.h>
 #include <sys/stat.h>
 #include <errno.h>
@@ -46,7 +47,9 @@
 #include <uORB/uORBTopics.h>
 #include <uORB/Subscription.hpp>
 #include <uORB/topics/log_message.h>
+#include <uORB/topics/logger_status.h>
 #include <uORB/topics/parameter_update.h>
+#include <uORB/topics/replay_status.h>
 #include <uORB/topics/vehicle_status.h>
 #include <uORB/topics/vehicle_gps_position.h>
 #include <uORB/topics/vehicle_command_ack.h>
@@ -59,6 +62,7 @@
 #include <px4_sem.h>
 #include <px4_shutdown.h>
 #include <px4_tasks.h>
+#include <mathlib/mathlib.h>
 #include <systemlib/mavlink_log.h>
 #include <replay/definitions.hpp>
 #include <version/version.h>
@@ -156,7 +160,8 @@ Both backends can be enabled and used at the same time.
 ### Implementation
 The implementation uses two threads:
 - The main thread, running at a fixed rate (or polling on a topic if started with -p) and checking for
-  data updates
+  data updates. With -u, only the topics that have been published since the last iteration are checked
+  (using uORB update notifications), which reduces the CPU load with many logged topics.
 - The writer thread, writing data to the file
 
 In between there is a write buffer with configurable size. It should be large to avoid dropouts.
@@ -180,6 +185,7 @@ $ logger on
 	PRINT_MODULE_USAGE_PARAM_INT('q', 14, 1, 100, "uORB queue size for mavlink mode", true);
 	PRINT_MODULE_USAGE_PARAM_STRING('p', nullptr, "<topic_name>",
 					 "Poll on a topic instead of running with fixed rate (Log rate and topic intervals are ignored if this is set)", true);
+	PRINT_MODULE_USAGE_PARAM_FLAG('u', "Event-driven: only copy topics with an update notification", true);
 	PRINT_MODULE_USAGE_COMMAND_DESCR("on", "start logging now, override arming (logger must be running)");
 	PRINT_MODULE_USAGE_COMMAND_DESCR("off", "stop logging now, override arming (logger must be running)");
 	PRINT_MODULE_USAGE_DEFAULT_COMMANDS();
@@ -208,6 +214,12 @@ int Logger::print_status()
 {
 	PX4_INFO("Running in mode: %s", configured_backend_mode());
 
+	if (_update_notifiers) {
+		PX4_INFO("Event-driven topic capture");
+	}
+
+	PX4_INFO("Logging %zu topics (setup took %" PRIu64 " us)", _subscriptions.size(), _topics_setup_time);
+
 	bool is_logging = false;
 	if (_writer.is_started(LogWriter::BackendFile)) {
 		PX4_INFO("File Logging Running");
@@ -240,6 +252,14 @@ void Logger::print_statistics()
 
 	PX4_INFO("Log file: %s/%s", _log_dir, _log_file_name);
 	PX4_INFO("Wrote %4.2f MiB (avg %5.2f KiB/s)", (double)mebibytes, (double)(kibibytes / seconds));
+
+	if (_writer.compression_enabled_file() && _writer.get_total_written_file() > 0) {
+		PX4_INFO("Compression ratio: %.2f", (double)_writer.get_total_logged_file() / _writer.get_total_written_file());
+	}
+	if (_throttle_level > 0) {
+		PX4_INFO("Throttling topics with priority < %i (buffer back-pressure)", _throttle_level);
+	}
+
 	PX4_INFO("Since last status: dropouts: %zu (max len: %.3f s), max used buffer: %zu / %zu B",
 		 _write_dropouts, (double)_max_dropout_duration, _high_water, _writer.get_buffer_size_file());
 	_high_water = 0;
@@ -259,12 +279,13 @@ Logger *Logger::instantiate(int argc, char *argv[])
 	// topic sizes get reduced
 	LogWriter::Backend backend = LogWriter::BackendAll;
 	const char *poll_topic = nullptr;
+	bool event_driven = false;
 
 	int myoptind = 1;
 	int ch;
 	const char *myoptarg = nullptr;
 
-	while ((ch = px4_getopt(argc, argv, "r:b:etfm:q:p:", &myoptind, &myoptarg)) != EOF) {
+	while ((ch = px4_getopt(argc, argv, "r:b:etfm:q:p:u", &myoptind, &myoptarg)) != EOF) {
 		switch (ch) {
 		case 'r': {
 				unsigned long r = strtoul(myoptarg, nullptr, 10);
@@ -322,6 +343,10 @@ Logger *Logger::instantiate(int argc, char *argv[])
 			poll_topic = myoptarg;
 			break;
 
+		case 'u':
+			event_driven = true;
+			break;
+
 		case 'q':
 			queue_size = strtoul(myoptarg, nullptr, 10);
 
@@ -347,7 +372,7 @@ Logger *Logger::instantiate(int argc, char *argv[])
 	}
 
 	Logger *logger = new Logger(backend, log_buffer_size, log_interval, poll_topic, log_on_start,
-				    log_until_shutdown, log_name_timestamp, queue_size);
+				    log_until_shutdown, log_name_timestamp, queue_size, event_driven);
 
 #if defined(DBGPRINT) && defined(__PX4_NUTTX)
 	struct mallinfo alloc_info = mallinfo();
@@ -376,7 +401,8 @@ Logger *Logger::instantiate(int argc, char *argv[])
 
 
 Logger::Logger(LogWriter::Backend backend, size_t buffer_size, uint32_t log_interval, const char *poll_topic_name,
-	       bool log_on_start, bool log_until_shutdown, bool log_name_timestamp, unsigned int queue_size) :
+	       bool log_on_start, bool log_until_shutdown, bool log_name_timestamp, unsigned int queue_size,
+	       bool event_driven) :
 	_arm_override(false),
 	_log_on_start(log_on_start),
 	_log_until_shutdown(log_until_shutdown),
@@ -386,6 +412,11 @@ Logger::Logger(LogWriter::Backend backend, size_t buffer_size, uint32_t log_inte
 {
 	_log_utc_offset = param_find("SDLOG_UTC_OFFSET");
 	_log_dirs_max = param_find("SDLOG_DIRS_MAX");
+	_log_compress = param_find("SDLOG_COMPRESS");
+	_log_mmap = param_find("SDLOG_MMAP");
+	_log_definitions_cache = param_find("SDLOG_DEF_CACHE");
+	_log_write_size = param_find("SDLOG_WR_SIZE");
+	_log_pre_time = param_find("SDLOG_PRE_TIME");
 	_sdlog_profile_handle = param_find("SDLOG_PROFILE");
 
 	if (poll_topic_name) {
@@ -402,6 +433,14 @@ Logger::Logger(LogWriter::Backend backend, size_t buffer_size, uint32_t log_inte
 			PX4_ERR("Failed to find topic %s", poll_topic_name);
 		}
 	}
+
+	if (event_driven) {
+		_update_notifiers = new uORB::UpdateNotifier*[MAX_TOPICS_NUM * ORB_MULTI_MAX_INSTANCES]();
+
+		if (!_update_notifiers) {
+			PX4_ERR("alloc failed, checking all topics");
+		}
+	}
 }
 
 Logger::~Logger()
@@ -413,6 +452,18 @@ Logger::~Logger()
 	if (_msg_buffer) {
 		delete[](_msg_buffer);
 	}
+
+	if (_update_notifiers) {
+		delete[](_update_notifiers);
+	}
+
+	if (_definitions_cache) {
+		free(_definitions_cache);
+	}
+
+	for (LoggerSubscription &sub : _subscriptions) {
+		delete sub.field_subset;
+	}
 }
 
 bool Logger::request_stop_static()
@@ -453,6 +504,10 @@ LoggerSubscription* Logger::add_topic(const orb_metadata *topic)
 
 	if (_subscriptions.push_back(LoggerSubscription(fd, topic))) {
 		subscription = &_subscriptions[_subscriptions.size() - 1];
+
+		if (fd >= 0) {
+			register_update_notifier(*subscription, 0);
+		}
 	} else {
 		PX4_WARN("logger: failed to add topic. Too many subscriptions");
 		if (fd >= 0) {
@@ -463,32 +518,193 @@ LoggerSubscription* Logger::add_topic(const orb_metadata *topic)
 	return subscription;
 }
 
-bool Logger::add_topic(const char *name, unsigned interval)
+bool Logger::add_topic(const char *name, unsigned interval, TopicPriority priority, const char *field_list)
 {
 	const orb_metadata **topics = orb_get_topics();
-	LoggerSubscription *subscription = nullptr;
 
 	for (size_t i = 0; i < orb_topics_count(); i++) {
 		if (strcmp(name, topics[i]->o_name) == 0) {
-			bool already_added = false;
-
-			// check if already added: if so, only update the interval
-			for (size_t j = 0; j < _subscriptions.size(); ++j) {
-				if (_subscriptions[j].metadata == topics[i]) {
-					PX4_DEBUG("logging topic %s, interval: %i, already added, only setting interval",
-						  topics[i]->o_name, interval);
-					subscription = &_subscriptions[j];
-					already_added = true;
-					break;
-				}
+			LoggerSubscription *subscription = add_topic(topics[i], interval, priority);
+
+			if (subscription && field_list && !set_field_subset(*subscription, field_list)) {
+				PX4_WARN("logging all fields of %s", name);
 			}
 
-			if (!already_added) {
-				subscription = add_topic(topics[i]);
-				PX4_DEBUG("logging topic: %s, interval: %i", topics[i]->o_name, interval);
-				break;
+			return subscription;
+		}
+	}
+
+	return false;
+}
+
+int Logger::field_size(const char *type, size_t type_len)
+{
+	static const struct {
+		const char *name;
+		int size;
+	} builtin_types[] = {
+		{"int8_t", 1}, {"uint8_t", 1}, {"char", 1}, {"bool", 1},
+		{"int16_t", 2}, {"uint16_t", 2},
+		{"int32_t", 4}, {"uint32_t", 4}, {"float", 4},
+		{"int64_t", 8}, {"uint64_t", 8}, {"double", 8},
+	};
+
+	size_t base_len = type_len;
+	int array_size = 1;
+	const char *bracket = (const char *)memchr(type, '[', type_len);
+
+	if (bracket) {
+		base_len = bracket - type;
+		array_size = atoi(bracket + 1);
+	}
+
+	for (const auto &builtin_type : builtin_types) {
+		if (strlen(builtin_type.name) == base_len && strncmp(builtin_type.name, type, base_len) == 0) {
+			return builtin_type.size * array_size;
+		}
+	}
+
+	// embedded type: it has the name of its topic
+	const orb_metadata **topics = orb_get_topics();
+
+	for (size_t i = 0; i < orb_topics_count(); i++) {
+		if (strlen(topics[i]->o_name) == base_len && strncmp(topics[i]->o_name, type, base_len) == 0) {
+			return topics[i]->o_size * array_size;
+		}
+	}
+
+	return -1;
+}
+
+bool Logger::set_field_subset(LoggerSubscription &sub, const char *field_list)
+{
+	LoggerFieldSubset *subset = new LoggerFieldSubset();
+
+	if (!subset) {
+		return false;
+	}
+
+	int format_len = snprintf(subset->format, sizeof(subset->format), "%s_subset:", sub.metadata->o_name);
+	subset->name_len = format_len - 1;
+
+	int num_requested = 1;
+
+	for (const char *c = field_list; *c != '\0'; ++c) {
+		if (*c == ',') {
+			++num_requested;
+		}
+	}
+
+	// walk the fields of the topic (format: "<type> <name>;...") and keep the timestamp and the selected ones
+	const char *field = sub.metadata->o_fields;
+	int offset = 0;
+	int num_selected = 0;
+	bool ok = true;
+
+	while (ok && *field != '\0') {
+		const char *end = strchr(field, ';');
+		const char *space = (const char *)memchr(field, ' ', end ? end - field : 0);
+
+		if (!end || !space) {
+			break;
+		}
+
+		const int size = field_size(field, space - field);
+
+		if (size < 0) {
+			PX4_ERR("%s: unknown type of field %.*s", sub.metadata->o_name, (int)(end - field), field);
+			ok = false;
+			break;
+		}
+
+		const char *name = space + 1;
+		const size_t name_len = end - name;
+		bool selected = offset == 0; // the timestamp is always logged
+
+		for (const char *item = field_list; !selected && *item != '\0';) {
+			const size_t item_len = strcspn(item, ",");
+
+			if (item_len == name_len && strncmp(item, name, name_len) == 0) {
+				selected = true;
+				++num_selected;
+			}
+
+			item += item_len;
+
+			if (*item == ',') {
+				++item;
+			}
+		}
+
+		if (selected) {
+			LoggerFieldSubset::Range *last = subset->num_ranges > 0 ? &subset->ranges[subset->num_ranges - 1] : nullptr;
+
+			if (last && last->offset + last->size == offset) {
+				last->size += size;
+
+			} else if (subset->num_ranges < LoggerFieldSubset::MAX_RANGES) {
+				subset->ranges[subset->num_ranges].offset = offset;
+				subset->ranges[subset->num_ranges].size = size;
+				++subset->num_ranges;
+
+			} else {
+				PX4_ERR("%s: too many fields", sub.metadata->o_name);
+				ok = false;
+			}
+
+			const int len = end - field + 1;
+
+			if (format_len + len >= (int)sizeof(subset->format)) {
+				PX4_ERR("%s: format string too large", sub.metadata->o_name);
+				ok = false;
+
+			} else {
+				memcpy(subset->format + format_len, field, len);
+				format_len += len;
+				subset->size += size;
 			}
 		}
+
+		offset += size;
+		field = end + 1;
+	}
+
+	if (ok && num_selected != num_requested) {
+		PX4_ERR("%s: unknown field in '%s'", sub.metadata->o_name, field_list);
+		ok = false;
+	}
+
+	if (!ok) {
+		delete subset;
+		return false;
+	}
+
+	subset->format[format_len] = '\0';
+	delete sub.field_subset;
+	sub.field_subset = subset;
+	PX4_DEBUG("logging %s: %i of %zu bytes", subset->format, subset->size, sub.metadata->o_size_no_padding);
+	return true;
+}
+
+LoggerSubscription *Logger::add_topic(const orb_metadata *topic, unsigned interval, TopicPriority priority)
+{
+	LoggerSubscription *subscription = nullptr;
+	bool already_added = false;
+
+	// check if already added: if so, only update the interval
+	for (size_t j = 0; j < _subscriptions.size(); ++j) {
+		if (_subscriptions[j].metadata == topic) {
+			PX4_DEBUG("logging topic %s, interval: %i, already added, only setting interval",
+				  topic->o_name, interval);
+			subscription = &_subscriptions[j];
+			already_added = true;
+			break;
+		}
+	}
+
+	if (!already_added) {
+		subscription = add_topic(topic);
+		PX4_DEBUG("logging topic: %s, interval: %i", topic->o_name, interval);
 	}
 
 	// if we poll on a topic, we don't use the interval and let the polled topic define the maximum interval
@@ -497,11 +713,15 @@ bool Logger::add_topic(const char *name, unsigned interval)
 	}
 
 	if (subscription) {
+		subscription->interval = interval;
+
+		// if added several times, the highest priority is used
+		if (!already_added || priority > subscription->priority) {
+			subscription->priority = priority;
+		}
+
 		if (subscription->fd[0] >= 0) {
-			orb_set_interval(subscription->fd[0], interval);
-		} else {
-			// store the interval: use a value < 0 to know it's not a valid fd
-			subscription->fd[0] = -interval - 1;
+			orb_set_interval(subscription->fd[0], topic_interval(*subscription));
 		}
 	}
 
@@ -541,17 +761,7 @@ bool Logger::try_to_subscribe_topic(LoggerSubscription &sub, int multi_instance)
 	bool ret = false;
 	if (OK == orb_exists(sub.metadata, multi_instance)) {
 
-		unsigned int interval;
-
-		if (multi_instance == 0) {
-			// the first instance and no subscription yet: this means we stored the negative interval as fd
-			interval = (unsigned int) (-(sub.fd[0] + 1));
-		} else {
-			// set to the same interval as the first instance
-			if (orb_get_interval(sub.fd[0], &interval) != 0) {
-				interval = 0;
-			}
-		}
+		unsigned int interval = topic_interval(sub);
 
 		int &handle = sub.fd[multi_instance];
 		handle = orb_subscribe_multi(sub.metadata, multi_instance);
@@ -561,6 +771,7 @@ bool Logger::try_to_subscribe_topic(LoggerSubscription &sub, int multi_instance)
 			if (interval > 0) {
 				orb_set_interval(handle, interval);
 			}
+			register_update_notifier(sub, multi_instance);
 			ret = true;
 		} else {
 			PX4_ERR("orb_subscribe_multi %s failed (%i)", sub.metadata->o_name, errno);
@@ -569,119 +780,66 @@ bool Logger::try_to_subscribe_topic(LoggerSubscription &sub, int multi_instance)
 	return ret;
 }
 
-void Logger::add_default_topics()
+void Logger::register_update_notifier(LoggerSubscription &sub, int multi_instance)
 {
-#ifdef CONFIG_ARCH_BOARD_SITL
-	add_topic("vehicle_attitude_groundtruth", 10);
-	add_topic("vehicle_global_position_groundtruth", 100);
-	add_topic("vehicle_local_position_groundtruth", 100);
-#endif
+	if (!_update_notifiers) {
+		return;
+	}
 
-	// Note: try to avoid setting the interval where possible, as it increases RAM usage
-	add_topic("actuator_controls_0", 100);
-	add_topic("actuator_controls_1", 100);
-	add_topic("actuator_outputs", 100);
-	add_topic("airspeed", 200);
-	add_topic("att_pos_mocap", 50);
-	add_topic("battery_status", 500);
-	add_topic("camera_capture");
-	add_topic("camera_trigger");
-	add_topic("cpuload");
-	add_topic("distance_sensor", 100);
-	add_topic("ekf2_innovations", 200);
-	add_topic("esc_status", 250);
-	add_topic("estimator_status", 200);
-	add_topic("input_rc", 200);
-	add_topic("manual_control_setpoint", 200);
-	add_topic("optical_flow", 50);
-	add_topic("position_setpoint_triplet", 200);
-	add_topic("sensor_combined", 100);
-	add_topic("sensor_preflight", 200);
-	add_topic("system_power", 500);
-	add_topic("tecs_status", 200);
-	add_topic("telemetry_status");
-	add_topic("vehicle_attitude", 30);
-	add_topic("vehicle_attitude_setpoint", 100);
-	add_topic("vehicle_command");
-	add_topic("vehicle_global_position", 200);
-	add_topic("vehicle_gps_position");
-	add_topic("vehicle_land_detected");
-	add_topic("vehicle_local_position", 100);
-	add_topic("vehicle_local_position_setpoint", 100);
-	add_topic("vehicle_rates_setpoint", 30);
-	add_topic("vehicle_status", 200);
-	add_topic("vehicle_vision_attitude");
-	add_topic("vehicle_vision_position");
-	add_topic("vtol_vehicle_status", 200);
-	add_topic("wind_estimate", 200);
-}
+	const int idx = (&sub - &_subscriptions[0]) * ORB_MULTI_MAX_INSTANCES + multi_instance;
 
-void Logger::add_high_rate_topics()
-{
-	// maximum rate to analyze fast maneuvers (e.g. for racing)
-	add_topic("actuator_controls_0");
-	add_topic("actuator_outputs");
-	add_topic("manual_control_setpoint");
-	add_topic("vehicle_attitude");
-	add_topic("vehicle_attitude_setpoint");
-	add_topic("vehicle_rates_setpoint");
+	if (!_update_notifiers[idx]) {
+		_update_notifiers[idx] = new uORB::UpdateNotifier(&_updated_topics[idx / 32], 1u << (idx % 32));
+	}
+
+	if (_update_notifiers[idx] && !_update_notifiers[idx]->register_notifier(sub.fd[multi_instance])) {
+		PX4_DEBUG("no update notifier for %s (instance %i)", sub.metadata->o_name, multi_instance);
+	}
 }
 
-void Logger::add_debug_topics()
+bool Logger::update_pending(const uint32_t *updated, int sub_idx, int multi_instance) const
 {
-	add_topic("debug_key_value");
-	add_topic("debug_value");
-	add_topic("debug_vect");
-}
+	const int idx = sub_idx * ORB_MULTI_MAX_INSTANCES + multi_instance;
 
-void Logger::add_estimator_replay_topics()
-{
-	// for estimator replay (need to be at full rate)
-	add_topic("ekf2_timestamps");
-
-	// current EKF2 subscriptions
-	add_topic("airspeed");
-	add_topic("distance_sensor");
-	add_topic("optical_flow");
-	add_topic("sensor_baro");
-	add_topic("sensor_combined");
-	add_topic("sensor_selection");
-	add_topic("vehicle_gps_position");
-	add_topic("vehicle_land_detected");
-	add_topic("vehicle_status");
-	add_topic("vehicle_vision_attitude");
-	add_topic("vehicle_vision_position");
-}
+	if (!_update_notifiers || !_update_notifiers[idx] || !_update_notifiers[idx]->registered()) {
+		return true;
+	}
 
-void Logger::add_thermal_calibration_topics()
-{
-	add_topic("sensor_accel", 100);
-	add_topic("sensor_baro", 100);
-	add_topic("sensor_gyro", 100);
+	return updated[idx / 32] & (1u << (idx % 32));
 }
 
-void Logger::add_sensor_comparison_topics()
+int Logger::add_profile_topics(SDLogProfileMask profile)
 {
-	add_topic("sensor_accel", 100);
-	add_topic("sensor_baro", 100);
-	add_topic("sensor_gyro", 100);
-	add_topic("sensor_mag", 100);
-}
+	int ntopics = 0;
 
-void Logger::add_system_identification_topics()
-{
-	// for system id need to log imu and controls at full rate
-	add_topic("actuator_controls_0");
-	add_topic("actuator_controls_1");
-	add_topic("sensor_combined");
+	// the order matters: if several profiles add the same topic, the logging rate of the last one will be used
+	for (size_t i = 0; i < topic_profiles_count; ++i) {
+		const TopicProfile &topic_profile = topic_profiles[i];
+
+		if (!(profile & topic_profile.mask)) {
+			continue;
+		}
+
+		for (size_t j = 0; j < topic_profile.num_topics; ++j) {
+			const ProfileTopic &topic = topic_profile.topics[j];
+
+			if (add_topic(topic.metadata, topic.interval, topic.priority)) {
+				++ntopics;
+			}
+		}
+
+		PX4_DEBUG("added profile %s (%zu topics)", topic_profile.name, topic_profile.num_topics);
+	}
+
+	return ntopics;
 }
 
 int Logger::add_topics_from_file(const char *fname)
 {
 	FILE		*fp;
-	char		line[80];
-	char		topic_name[80];
+	char		line[160];
 	unsigned	interval;
+	unsigned	priority;
 	int			ntopics = 0;
 
 	/* open the topic list file */
@@ -706,25 +864,51 @@ int Logger::add_topics_from_file(const char *fname)
 			continue;
 		}
 
-		// read line with format: <topic_name>[, <interval>]
-		interval = 0;
-		int nfields = sscanf(line, "%s %u", topic_name, &interval);
+		// read line with format: <topic_name>[ <field>[,<field>...]][, <interval>[, <priority>]]
+		// the separators can be commas or spaces. The optional list of fields (without spaces) restricts
+		// the logged fields of the topic, e.g. "sensor_combined gyro_rad,accelerometer_m_s2 4"
+		char *topic_name = line + strspn(line, " \t");
+		char *name_end = topic_name + strcspn(topic_name, " ,\t\r\n");
+		char *next = name_end + strspn(name_end, " ,\t");
+		char *field_list = nullptr;
 
-		if (nfields > 0) {
-			int name_len = strlen(topic_name);
+		if (isalpha(*next) || *next == '_') {
+			field_list = next;
+			next += strcspn(next, " \t\r\n");
 
-			if (name_len > 0 && topic_name[name_len - 1] == ',') {
-				topic_name[name_len - 1] = '\0';
+			if (*next != '\0') {
+				*next++ = '\0';
 			}
+		}
 
-			/* add topic with specified interval */
-			if (add_topic(topic_name, interval)) {
-				ntopics++;
+		*name_end = '\0';
 
-			} else {
-				PX4_ERR("Failed to add topic %s", topic_name);
+		if (*topic_name == '\0') {
+			continue;
+		}
+
+		for (char *c = next; *c != '\0'; ++c) {
+			if (*c == ',') {
+				*c = ' ';
 			}
 		}
+
+		interval = 0;
+		priority = (unsigned)TopicPriority::NORMAL;
+		sscanf(next, "%u %u", &interval, &priority);
+
+		if (priority > (unsigned)TopicPriority::CRITICAL) {
+			PX4_WARN("invalid priority %u for topic %s", priority, topic_name);
+			priority = (unsigned)TopicPriority::CRITICAL;
+		}
+
+		/* add topic with specified interval, priority and fields */
+		if (add_topic(topic_name, interval, (TopicPriority)priority, field_list)) {
+			ntopics++;
+
+		} else {
+			PX4_ERR("Failed to add topic %s", topic_name);
+		}
 	}
 
 	fclose(fp);
@@ -776,6 +960,7 @@ void Logger::run()
 	int log_message_sub = orb_subscribe(ORB_ID(log_message));
 	orb_set_interval(log_message_sub, 20);
 
+	const hrt_abstime topics_setup_start = hrt_absolute_time();
 	int ntopics = add_topics_from_file(PX4_ROOTFSDIR "/fs/microsd/etc/logging/logger_topics.txt");
 
 	if (ntopics > 0) {
@@ -794,38 +979,11 @@ void Logger::run()
 			sdlog_profile = SDLogProfileMask::DEFAULT;
 		}
 
-		// load appropriate topics for profile
-		// the order matters: if several profiles add the same topic, the logging rate of the last one will be used
-		if (sdlog_profile & SDLogProfileMask::DEFAULT) {
-			add_default_topics();
-		}
-
-		if (sdlog_profile & SDLogProfileMask::ESTIMATOR_REPLAY) {
-			add_estimator_replay_topics();
-		}
-
-		if (sdlog_profile & SDLogProfileMask::THERMAL_CALIBRATION) {
-			add_thermal_calibration_topics();
-		}
-
-		if (sdlog_profile & SDLogProfileMask::SYSTEM_IDENTIFICATION) {
-			add_system_identification_topics();
-		}
-
-		if (sdlog_profile & SDLogProfileMask::HIGH_RATE) {
-			add_high_rate_topics();
-		}
-
-		if (sdlog_profile & SDLogProfileMask::DEBUG_TOPICS) {
-			add_debug_topics();
-		}
-
-		if (sdlog_profile & SDLogProfileMask::SENSOR_COMPARISON) {
-			add_sensor_comparison_topics();
-		}
-
+		add_profile_topics(sdlog_profile);
 	}
 
+	_topics_setup_time = hrt_elapsed_time(&topics_setup_start);
+
 	int vehicle_command_sub = -1;
 	orb_advert_t vehicle_command_ack_pub = nullptr;
 
@@ -833,6 +991,12 @@ void Logger::run()
 		vehicle_command_sub = orb_subscribe(ORB_ID(vehicle_command));
 	}
 
+	int replay_status_sub = -1;
+
+	if (_replay_file_name) {
+		replay_status_sub = orb_subscribe(ORB_ID(replay_status));
+	}
+
 	//all topics added. Get required message buffer size
 	int max_msg_size = 0, ret;
 
@@ -873,6 +1037,61 @@ void Logger::run()
 		return;
 	}
 
+	int32_t log_compress = 0;
+
+	if (_log_compress != PARAM_INVALID) {
+		param_get(_log_compress, &log_compress);
+	}
+
+	if (log_compress != 0 && (_writer.backend() & LogWriter::BackendFile)) {
+		if (!_writer.enable_compression_file()) {
+			PX4_ERR("failed to enable log compression");
+		}
+	}
+
+	int32_t log_mmap = 0;
+
+	if (_log_mmap != PARAM_INVALID) {
+		param_get(_log_mmap, &log_mmap);
+	}
+
+	if (log_mmap != 0 && (_writer.backend() & LogWriter::BackendFile)) {
+		if (!_writer.enable_mmap_file()) {
+			PX4_WARN("memory-mapped logging not supported (or compression enabled)");
+		}
+	}
+
+	int32_t log_definitions_cache = 0;
+
+	if (_log_definitions_cache != PARAM_INVALID) {
+		param_get(_log_definitions_cache, &log_definitions_cache);
+	}
+
+	_definitions_cache_enabled = log_definitions_cache != 0 && (_writer.backend() & LogWriter::BackendFile);
+
+	int32_t log_write_size = 4;
+
+	if (_log_write_size != PARAM_INVALID) {
+		param_get(_log_write_size, &log_write_size);
+	}
+
+	_writer.set_write_size_file(log_write_size * 1024);
+	_writer.set_index_file(LOG_INDEX);
+
+	int32_t log_pre_time = 0;
+
+	if (_log_pre_time != PARAM_INVALID) {
+		param_get(_log_pre_time, &log_pre_time);
+	}
+
+	if (log_pre_time > 0 && !_log_on_start && (_writer.backend() & LogWriter::BackendFile)) {
+		_history_enabled = _writer.enable_history_file(log_pre_time * 1000000ull);
+
+		if (!_history_enabled) {
+			PX4_WARN("pre-trigger history not supported (or memory-mapped logging enabled)");
+		}
+	}
+
 #ifdef DBGPRINT
 	hrt_abstime	timer_start = 0;
 	uint32_t	total_bytes = 0;
@@ -924,6 +1143,11 @@ void Logger::run()
 				     (vehicle_status.arming_state == vehicle_status_s::ARMING_STATE_ARMED_ERROR) ||
 				     _arm_override;
 
+			// with a pre-trigger history, a failsafe starts a log as well (and it stops as on disarming)
+			if (_history_enabled && vehicle_status.failsafe) {
+				armed = true;
+			}
+
 			if (_was_armed != armed && !_log_until_shutdown) {
 				_was_armed = armed;
 
@@ -949,6 +1173,31 @@ void Logger::run()
 			}
 		}
 
+		/* replay parameter sweep: log every pass over the replayed log into a separate file */
+		if (replay_status_sub != -1) {
+			bool replay_status_updated = false;
+			ret = orb_check(replay_status_sub, &replay_status_updated);
+
+			if (ret == 0 && replay_status_updated) {
+				replay_status_s replay_status;
+				orb_copy(ORB_ID(replay_status), replay_status_sub, &replay_status);
+
+				if (replay_status.pass > 0) {
+					// start over as for the first pass
+					if (_writer.is_started(LogWriter::BackendFile)) {
+						stop_log_file();
+					}
+
+					_should_stop_file_log = false;
+					_was_armed = false;
+
+					if (_log_on_start) {
+						start_log_file();
+					}
+				}
+			}
+		}
+
 		/* check for logging command from MAVLink */
 		if (vehicle_command_sub != -1) {
 			bool command_updated = false;
@@ -985,7 +1234,10 @@ void Logger::run()
 
 		const hrt_abstime loop_time = hrt_absolute_time();
 
-		if (_writer.is_started()) {
+		/* while no file log is running, the data is kept in the pre-trigger history */
+		const bool capture_history = _history_enabled && !_writer.is_started(LogWriter::BackendFile);
+
+		if (_writer.is_started() || capture_history) {
 
 			/* check if we need to output the process load */
 			if (_next_load_print != 0 && loop_time >= _next_load_print) {
@@ -1008,24 +1260,67 @@ void Logger::run()
 			// this needs to change to a timestamped record to record a history of parameter changes
 			if (parameter_update_sub.update()) {
 				write_changed_parameters();
+				_definitions_cache_valid = false;
+			}
+
+			if (capture_history) {
+				update_definitions_cache();
 			}
 
-			/* wait for lock on log buffer */
-			_writer.lock();
+			/* fetch the topic instances published since the last iteration (event-driven mode) */
+			uint32_t updated_topics[UPDATE_BITMAP_WORDS];
+
+			if (_update_notifiers) {
+				for (size_t i = 0; i < UPDATE_BITMAP_WORDS; ++i) {
+					updated_topics[i] = uORB::UpdateNotifier::fetch_and_clear(&_updated_topics[i]);
+				}
+			}
 
 			int sub_idx = 0;
 
 			for (LoggerSubscription &sub : _subscriptions) {
 				/* each message consists of a header followed by an orb data object
 				 */
-				size_t msg_size = sizeof(ulog_message_data_header_s) + sub.metadata->o_size_no_padding;
+				size_t msg_size = sizeof(ulog_message_data_header_s) +
+						  (sub.field_subset ? sub.field_subset->size : sub.metadata->o_size_no_padding);
+				bool try_to_subscribe = sub_idx == next_subscribe_topic_index;
 
 				/* if this topic has been updated, copy the new data into the message buffer
 				 * and write a message to the log
 				 */
 				for (int instance = 0; instance < ORB_MULTI_MAX_INSTANCES; instance++) {
-					if (copy_if_updated_multi(sub, instance, _msg_buffer + sizeof(ulog_message_data_header_s),
-								  sub_idx == next_subscribe_topic_index)) {
+					if (sub.fd[instance] < 0) {
+						if (!try_to_subscribe) {
+							continue;
+						}
+
+					} else if (!update_pending(updated_topics, sub_idx, instance)) {
+						continue;
+					}
+
+					const bool was_subscribed = sub.fd[instance] >= 0;
+
+					if (!copy_if_updated_multi(sub, instance, _msg_buffer + sizeof(ulog_message_data_header_s),
+								   try_to_subscribe)) {
+						if (!was_subscribed && sub.fd[instance] < 0) {
+							/* instances are advertised in order: if this one does not exist, the next ones
+							 * do not either, so don't try to subscribe them in this round */
+							try_to_subscribe = false;
+
+						} else if (was_subscribed && _update_notifiers && topic_interval(sub) > 0) {
+							/* not updated because of the interval: check again in the next iteration */
+							const int idx = sub_idx * ORB_MULTI_MAX_INSTANCES + instance;
+
+							if (_update_notifiers[idx]) {
+								_update_notifiers[idx]->notify();
+							}
+						}
+
+					} else {
+
+						if (sub.field_subset) {
+							sub.field_subset->extract(_msg_buffer + sizeof(ulog_message_data_header_s));
+						}
 
 						uint16_t write_msg_size = static_cast<uint16_t>(msg_size - ULOG_MSG_HEADER_LEN);
 						//write one byte after another (necessary because of alignment)
@@ -1038,8 +1333,14 @@ void Logger::run()
 
 						//PX4_INFO("topic: %s, size = %zu, out_size = %zu", sub.metadata->o_name, sub.metadata->o_size, msg_size);
 
+						if (capture_history) {
+							_writer.write_history_file(_msg_buffer, msg_size);
+						}
+
 						if (write_message(_msg_buffer, msg_size)) {
 
+							sub.bytes_logged += msg_size;
+
 #ifdef DBGPRINT
 							total_bytes += msg_size;
 #endif /* DBGPRINT */
@@ -1062,29 +1363,22 @@ void Logger::run()
 			if (ret == 0 && log_message_updated) {
 				log_message_s log_message;
 				orb_copy(ORB_ID(log_message), log_message_sub, &log_message);
-				const char *message = (const char *)log_message.text;
-				int message_len = strlen(message);
-
-				if (message_len > 0) {
-					uint16_t write_msg_size = sizeof(ulog_message_logging_s) - sizeof(ulog_message_logging_s::message)
-								  - ULOG_MSG_HEADER_LEN + message_len;
-					_msg_buffer[0] = (uint8_t)write_msg_size;
-					_msg_buffer[1] = (uint8_t)(write_msg_size >> 8);
-					_msg_buffer[2] = static_cast<uint8_t>(ULogMessageType::LOGGING);
-					_msg_buffer[3] = log_message.severity + '0';
-					memcpy(_msg_buffer + 4, &log_message.timestamp, sizeof(ulog_message_logging_s::timestamp));
-					strncpy((char *)(_msg_buffer + 12), message, sizeof(ulog_message_logging_s::message));
-
-					write_message(_msg_buffer, write_msg_size + ULOG_MSG_HEADER_LEN);
-				}
+				write_logging_message(log_message.severity, log_message.timestamp, (const char *)log_message.text);
 			}
 
 			if (!_dropout_start && _writer.get_buffer_fill_count_file() > _high_water) {
 				_high_water = _writer.get_buffer_fill_count_file();
 			}
 
-			/* release the log buffer */
-			_writer.unlock();
+			if (_writer.get_buffer_fill_count_file() > _status_high_water) {
+				_status_high_water = _writer.get_buffer_fill_count_file();
+			}
+
+			if (loop_time >= _next_status_publication) {
+				publish_logger_status(loop_time);
+			}
+
+			update_throttling(loop_time);
 
 			/* notify the writer thread if data is available */
 			if (data_written) {
@@ -1122,13 +1416,23 @@ void Logger::run()
 
 		} else { // not logging
 
+			if (parameter_update_sub.update()) {
+				_definitions_cache_valid = false;
+			}
+
+			// (re)build the definitions cache while we're idle, so that it's ready when logging starts
+			update_definitions_cache();
+
 			// try to subscribe to new topics, even if we don't log, so that:
 			// - we avoid subscribing to many topics at once, when logging starts
 			// - we'll get the data immediately once we start logging (no need to wait for the next subscribe timeout)
 			if (next_subscribe_topic_index != -1) {
 				for (int instance = 0; instance < ORB_MULTI_MAX_INSTANCES; instance++) {
 					if (_subscriptions[next_subscribe_topic_index].fd[instance] < 0) {
-						try_to_subscribe_topic(_subscriptions[next_subscribe_topic_index], instance);
+						// instances are advertised in order: stop at the first one that does not exist
+						if (!try_to_subscribe_topic(_subscriptions[next_subscribe_topic_index], instance)) {
+							break;
+						}
 					}
 				}
 				if (++next_subscribe_topic_index >= _subscriptions.size()) {
@@ -1181,6 +1485,12 @@ void Logger::run()
 	//unsubscribe
 	for (LoggerSubscription &sub : _subscriptions) {
 		for (int instance = 0; instance < ORB_MULTI_MAX_INSTANCES; instance++) {
+			if (_update_notifiers) {
+				const int idx = (&sub - &_subscriptions[0]) * ORB_MULTI_MAX_INSTANCES + instance;
+				delete _update_notifiers[idx];
+				_update_notifiers[idx] = nullptr;
+			}
+
 			if (sub.fd[instance] >= 0) {
 				orb_unsubscribe(sub.fd[instance]);
 				sub.fd[instance] = -1;
@@ -1197,6 +1507,11 @@ void Logger::run()
 		_mavlink_log_pub = nullptr;
 	}
 
+	if (_logger_status_pub) {
+		orb_unadvertise(_logger_status_pub);
+		_logger_status_pub = nullptr;
+	}
+
 	if (vehicle_command_ack_pub) {
 		orb_unadvertise(vehicle_command_ack_pub);
 	}
@@ -1205,11 +1520,182 @@ void Logger::run()
 		orb_unsubscribe(vehicle_command_sub);
 	}
 
+	if (replay_status_sub != -1) {
+		orb_unsubscribe(replay_status_sub);
+	}
+
 	px4_unregister_shutdown_hook(&Logger::request_stop_static);
 }
 
+void Logger::write_logging_message(uint8_t severity, hrt_abstime timestamp, const char *message)
+{
+	int message_len = strlen(message);
+
+	if (message_len <= 0) {
+		return;
+	}
+
+	if (message_len > (int)sizeof(ulog_message_logging_s::message)) {
+		message_len = sizeof(ulog_message_logging_s::message);
+	}
+
+	uint16_t write_msg_size = sizeof(ulog_message_logging_s) - sizeof(ulog_message_logging_s::message)
+				  - ULOG_MSG_HEADER_LEN + message_len;
+	_msg_buffer[0] = (uint8_t)write_msg_size;
+	_msg_buffer[1] = (uint8_t)(write_msg_size >> 8);
+	_msg_buffer[2] = static_cast<uint8_t>(ULogMessageType::LOGGING);
+	_msg_buffer[3] = severity + '0';
+	memcpy(_msg_buffer + 4, &timestamp, sizeof(ulog_message_logging_s::timestamp));
+	strncpy((char *)(_msg_buffer + 12), message, sizeof(ulog_message_logging_s::message));
+
+	write_message(_msg_buffer, write_msg_size + ULOG_MSG_HEADER_LEN);
+}
+
+unsigned Logger::topic_interval(const LoggerSubscription &sub) const
+{
+	const int priority = (int)sub.priority;
+
+	if (_throttle_level <= priority) {
+		return sub.interval;
+	}
+
+	// each throttling level above the topic priority reduces the rate by a factor of 4
+	const unsigned base_interval = sub.interval > 0 ? sub.interval : THROTTLE_BASE_INTERVAL;
+	const unsigned max_interval = sub.interval > THROTTLE_MAX_INTERVAL ? sub.interval : THROTTLE_MAX_INTERVAL;
+	const unsigned interval = base_interval << (2 * (_throttle_level - priority));
+
+	return interval < max_interval ? interval : max_interval;
+}
+
+void Logger::set_throttle_level(int level)
+{
+	_throttle_level = level;
+
+	for (LoggerSubscription &sub : _subscriptions) {
+		const unsigned interval = topic_interval(sub);
+
+		for (int instance = 0; instance < ORB_MULTI_MAX_INSTANCES; instance++) {
+			if (sub.fd[instance] >= 0) {
+				orb_set_interval(sub.fd[instance], interval);
+			}
+		}
+	}
+}
+
+void Logger::update_throttling(hrt_abstime now)
+{
+	if (now < _throttle_next_check || !_writer.is_started(LogWriter::BackendFile)) {
+		return;
+	}
+
+	_throttle_next_check = now + THROTTLE_CHECK_INTERVAL;
+
+	const size_t buffer_size = _writer.get_buffer_size_file();
+	const size_t fill_count = _writer.get_buffer_fill_count_file();
+	int level = _throttle_level;
+
+	if ((fill_count > buffer_size * 6 / 10 || _dropout_start) && level < MAX_THROTTLE_LEVEL
+	    && now - _throttle_last_change > THROTTLE_RAISE_DELAY) {
+		++level;
+
+	} else if (fill_count < buffer_size / 5 && level > 0 && now - _throttle_last_change > THROTTLE_RELEASE_DELAY) {
+		--level;
+	}
+
+	if (level == _throttle_level) {
+		return;
+	}
+
+	set_throttle_level(level);
+	_throttle_last_change = now;
+
+	// record the decimation in the log, so that it can be taken into account during analysis
+	char message[sizeof(ulog_message_logging_s::message)];
+
+	if (level > 0) {
+		snprintf(message, sizeof(message), "[logger] buffer %i%% full: decimating topics with priority < %i",
+			 (int)(fill_count * 100 / buffer_size), level);
+
+	} else {
+		snprintf(message, sizeof(message), "[logger] buffer %i%% full: logging all topics at full rate",
+			 (int)(fill_count * 100 / buffer_size));
+	}
+
+	PX4_DEBUG("%s", message);
+	write_logging_message(6, now, message); // info
+}
+
+void Logger::publish_logger_status(hrt_abstime now)
+{
+	_next_status_publication = now + 1000000;
+
+	if (!_writer.is_started(LogWriter::BackendFile)) {
+		return;
+	}
+
+	logger_status_s status = {};
+	LogWriterFileStatistics statistics;
+	_writer.get_statistics_file(statistics, true);
+
+	const size_t total_written = _writer.get_total_written_file();
+
+	if (_last_status_publication > 0 && now > _last_status_publication && total_written >= _last_status_total_written) {
+		status.write_rate = (total_written - _last_status_total_written) / ((now - _last_status_publication) * 1e-6f);
+	}
+
+	_last_status_publication = now;
+	_last_status_total_written = total_written;
+
+	status.timestamp = now;
+	status.total_written = total_written;
+	status.buffer_size = _writer.get_buffer_size_file();
+	status.buffer_high_water = _status_high_water;
+	status.dropouts = _log_dropouts;
+	status.max_dropout_duration = _status_max_dropout_duration;
+	status.throttle_level = _throttle_level;
+
+	static_assert(sizeof(status.write_latency_histogram) == sizeof(statistics.write_latency_histogram),
+		      "write_latency_histogram size mismatch");
+	memcpy(status.write_latency_histogram, statistics.write_latency_histogram, sizeof(status.write_latency_histogram));
+	status.write_latency_max = statistics.write_latency_max;
+	status.fsync_count = statistics.fsync_count;
+	status.fsync_time_max = statistics.fsync_time_max;
+
+	if (statistics.fsync_count > 0) {
+		status.fsync_time_avg = statistics.fsync_time_total / statistics.fsync_count;
+	}
+
+	_status_high_water = 0;
+	_status_max_dropout_duration = 0.f;
+
+	if (_logger_status_pub == nullptr) {
+		_logger_status_pub = orb_advertise(ORB_ID(logger_status), &status);
+
+	} else {
+		orb_publish(ORB_ID(logger_status), _logger_status_pub, &status);
+	}
+}
+
+void Logger::write_topic_statistics()
+{
+	char buffer[64];
+	int counter = 0;
+
+	for (const LoggerSubscription &sub : _subscriptions) {
+		if (sub.bytes_logged > 0) {
+			snprintf(buffer, sizeof(buffer), "%s: %u B", sub.metadata->o_name, (unsigned)sub.bytes_logged);
+			write_info_multiple("logger_topic_bytes", buffer, counter != 0);
+			++counter;
+		}
+	}
+}
+
 bool Logger::write_message(void *ptr, size_t size)
 {
+	if (_definitions_cache_capture) {
+		return append_definitions_cache(ptr, size);
+	}
+
 	if (_writer.write_message(ptr, size, _dropout_start) != -1) {
 
 		if (_dropout_start) {
@@ -1219,6 +1705,10 @@ bool Logger::write_message(void *ptr, size_t size)
 				_max_dropout_duration = dropout_duration;
 			}
 
+			if (dropout_duration > _status_max_dropout_duration) {
+				_status_max_dropout_duration = dropout_duration;
+			}
+
 			_dropout_start = 0;
 		}
 
@@ -1228,6 +1718,7 @@ bool Logger::write_message(void *ptr, size_t size)
 	if (!_dropout_start) {
 		_dropout_start = hrt_absolute_time();
 		++_write_dropouts;
+		++_log_dropouts;
 		_high_water = 0;
 	}
 
@@ -1311,6 +1802,9 @@ int Logger::get_log_file_name(char *file_name, size_t file_name_size)
 		replay_suffix = "_replayed";
 	}
 
+	/* compressed logs need to be converted with Tools/ulog_decompress.py */
+	const char *file_extension = _writer.compression_enabled_file() ? "ulgz" : "ulg";
+
 
 	if (time_ok) {
 		if (create_log_dir(&tt)) {
@@ -1319,7 +1813,7 @@ int Logger::get_log_file_name(char *file_name, size_t file_name_size)
 
 		char log_file_name_time[16] = "";
 		strftime(log_file_name_time, sizeof(log_file_name_time), "%H_%M_%S", &tt);
-		snprintf(_log_file_name, sizeof(_log_file_name), "%s%s.ulg", log_file_name_time, replay_suffix);
+		snprintf(_log_file_name, sizeof(_log_file_name), "%s%s.%s", log_file_name_time, replay_suffix, file_extension);
 		snprintf(file_name, file_name_size, "%s/%s", _log_dir, _log_file_name);
 
 	} else {
@@ -1332,7 +1826,8 @@ int Logger::get_log_file_name(char *file_name, size_t file_name_size)
 		/* look for the next file that does not exist */
 		while (file_number <= MAX_NO_LOGFILE) {
 			/* format log file path: e.g. /fs/microsd/sess001/log001.ulg */
-			snprintf(_log_file_name, sizeof(_log_file_name), "log%03u%s.ulg", file_number, replay_suffix);
+			snprintf(_log_file_name, sizeof(_log_file_name), "log%03u%s.%s", file_number, replay_suffix,
+				 file_extension);
 			snprintf(file_name, file_name_size, "%s/%s", _log_dir, _log_file_name);
 
 			if (!file_exist(file_name)) {
@@ -1430,15 +1925,26 @@ void Logger::start_log_file()
 	/* print logging path, important to find log file later */
 	mavlink_log_info(&_mavlink_log_pub, "[logger] file: %s", file_name);
 
+	set_throttle_level(0);
+	_throttle_last_change = 0;
+
+	for (LoggerSubscription &sub : _subscriptions) {
+		sub.bytes_logged = 0;
+	}
+
+	_log_dropouts = 0;
+	_last_status_publication = 0;
+	_status_high_water = 0;
+	_status_max_dropout_duration = 0.f;
+
 	_writer.start_log_file(file_name);
 	_writer.select_write_backend(LogWriter::BackendFile);
 	_writer.set_need_reliable_transfer(true);
 	write_header();
-	write_version();
-	write_formats();
-	write_parameters();
+	write_definitions();
 	write_perf_data(true);
 	write_all_add_logged_msg();
+	_writer.end_definitions_file();
 	_writer.set_need_reliable_transfer(false);
 	_writer.unselect_write_backend();
 	_writer.notify();
@@ -1451,6 +1957,89 @@ void Logger::start_log_file()
 	initialize_load_output();
 }
 
+void Logger::write_definitions()
+{
+	if (!_definitions_cache_valid || _definitions_cache_params_used != param_count_used()) {
+		// not (yet) available or outdated: generate the definitions directly
+		write_version();
+		write_formats();
+		write_parameters();
+		return;
+	}
+
+	// the cache is written in chunks that are guaranteed to fit into the write buffer
+	const size_t chunk_size_max = _writer.get_buffer_size_file() / 2;
+	size_t offset = 0;
+
+	while (offset < _definitions_cache_size) {
+		size_t chunk_size = math::min(_definitions_cache_size - offset, chunk_size_max);
+		write_message(_definitions_cache + offset, chunk_size);
+		offset += chunk_size;
+		_writer.notify();
+	}
+}
+
+void Logger::update_definitions_cache()
+{
+	if (!_definitions_cache_enabled) {
+		return;
+	}
+
+	// parameters that got used since the cache was built (e.g. by a module started later)
+	if (_definitions_cache_valid && _definitions_cache_params_used == param_count_used()) {
+		return;
+	}
+
+	_definitions_cache_size = 0;
+	_definitions_cache_overflow = false;
+	_definitions_cache_params_used = param_count_used();
+
+	_definitions_cache_capture = true;
+	write_version();
+	write_formats();
+	write_parameters();
+	_definitions_cache_capture = false;
+
+	if (_definitions_cache_overflow) {
+		PX4_WARN("definitions cache disabled (exceeds %zu bytes)", DEFINITIONS_CACHE_MAX_SIZE);
+		free(_definitions_cache);
+		_definitions_cache = nullptr;
+		_definitions_cache_capacity = 0;
+		_definitions_cache_enabled = false;
+		return;
+	}
+
+	_definitions_cache_valid = true;
+}
+
+bool Logger::append_definitions_cache(const void *ptr, size_t size)
+{
+	if (_definitions_cache_overflow) {
+		return false;
+	}
+
+	if (_definitions_cache_size + size > _definitions_cache_capacity) {
+		size_t capacity = _definitions_cache_capacity + (size > DEFINITIONS_CACHE_ALLOC_STEP ? size : DEFINITIONS_CACHE_ALLOC_STEP);
+		uint8_t *cache = nullptr;
+
+		if (capacity <= DEFINITIONS_CACHE_MAX_SIZE) {
+			cache = (uint8_t *)realloc(_definitions_cache, capacity);
+		}
+
+		if (!cache) {
+			_definitions_cache_overflow = true;
+			return false;
+		}
+
+		_definitions_cache = cache;
+		_definitions_cache_capacity = capacity;
+	}
+
+	memcpy(_definitions_cache + _definitions_cache_size, ptr, size);
+	_definitions_cache_size += size;
+	return true;
+}
+
 void Logger::stop_log_file()
 {
 	if (!_writer.is_started(LogWriter::BackendFile)) {
@@ -1459,6 +2048,7 @@ void Logger::stop_log_file()
 
 	_writer.set_need_reliable_transfer(true);
 	write_perf_data(false);
+	write_topic_statistics();
 	_writer.set_need_reliable_transfer(false);
 	_writer.stop_log_file();
 }
@@ -1504,7 +2094,9 @@ struct perf_callback_data_t {
 void Logger::perf_iterate_callback(perf_counter_t handle, void *user)
 {
 	perf_callback_data_t *callback_data = (perf_callback_data_t *)user;
-	const int buffer_length = 256;
+	// the value must fit into an info message next to its key ('char[220] perf_counter_postflight'),
+	// otherwise write_info_multiple() drops it. Long lines (histograms) are truncated instead.
+	const int buffer_length = 220;
 	char buffer[buffer_length];
 	const char *perf_name;
 
@@ -1585,7 +2177,6 @@ void Logger::write_load_output(bool preflight)
 
 void Logger::write_formats()
 {
-	_writer.lock();
 	ulog_message_format_s msg = {};
 	const orb_metadata **topics = orb_get_topics();
 
@@ -1598,13 +2189,20 @@ void Logger::write_formats()
 		write_message(&msg, msg_size);
 	}
 
-	_writer.unlock();
+	//and the derived formats of the logged field subsets
+	for (const LoggerSubscription &sub : _subscriptions) {
+		if (sub.field_subset) {
+			int format_len = snprintf(msg.format, sizeof(msg.format), "%s", sub.field_subset->format);
+			size_t msg_size = sizeof(msg) - sizeof(msg.format) + format_len;
+			msg.msg_size = msg_size - ULOG_MSG_HEADER_LEN;
+
+			write_message(&msg, msg_size);
+		}
+	}
 }
 
 void Logger::write_all_add_logged_msg()
 {
-	_writer.lock();
-
 	for (LoggerSubscription &sub : _subscriptions) {
 		for (int instance = 0; instance < ORB_MULTI_MAX_INSTANCES; ++instance) {
 			if (sub.fd[instance] >= 0) {
@@ -1612,8 +2210,6 @@ void Logger::write_all_add_logged_msg()
 			}
 		}
 	}
-
-	_writer.unlock();
 }
 
 void Logger::write_add_logged_msg(LoggerSubscription &subscription, int instance)
@@ -1627,9 +2223,15 @@ void Logger::write_add_logged_msg(LoggerSubscription &subscription, int instance
 	msg.msg_id = subscription.msg_ids[instance];
 	msg.multi_id = instance;
 
-	int message_name_len = strlen(subscription.metadata->o_name);
+	const char *message_name = subscription.metadata->o_name;
+	int message_name_len = strlen(message_name);
+
+	if (subscription.field_subset) {
+		message_name = subscription.field_subset->format;
+		message_name_len = subscription.field_subset->name_len;
+	}
 
-	memcpy(msg.message_name, subscription.metadata->o_name, message_name_len);
+	memcpy(msg.message_name, message_name, message_name_len);
 
 	size_t msg_size = sizeof(msg) - sizeof(msg.message_name) + message_name_len;
 	msg.msg_size = msg_size - ULOG_MSG_HEADER_LEN;
@@ -1643,7 +2245,6 @@ void Logger::write_add_logged_msg(LoggerSubscription &subscription, int instance
 /* write info message */
 void Logger::write_info(const char *name, const char *value)
 {
-	_writer.lock();
 	ulog_message_info_header_s msg = {};
 	uint8_t *buffer = reinterpret_cast<uint8_t *>(&msg);
 	msg.msg_type = static_cast<uint8_t>(ULogMessageType::INFO);
@@ -1662,13 +2263,10 @@ void Logger::write_info(const char *name, const char *value)
 
 		write_message(buffer, msg_size);
 	}
-
-	_writer.unlock();
 }
 
 void Logger::write_info_multiple(const char *name, const char *value, bool is_continued)
 {
-	_writer.lock();
 	ulog_message_info_multiple_header_s msg;
 	uint8_t *buffer = reinterpret_cast<uint8_t *>(&msg);
 	msg.msg_type = static_cast<uint8_t>(ULogMessageType::INFO_MULTIPLE);
@@ -1688,8 +2286,6 @@ void Logger::write_info_multiple(const char *name, const char *value, bool is_co
 
 		write_message(buffer, msg_size);
 	}
-
-	_writer.unlock();
 }
 
 void Logger::write_info(const char *name, int32_t value)
@@ -1706,7 +2302,6 @@ void Logger::write_info(const char *name, uint32_t value)
 template<typename T>
 void Logger::write_info_template(const char *name, T value, const char *type_str)
 {
-	_writer.lock();
 	ulog_message_info_header_s msg = {};
 	uint8_t *buffer = reinterpret_cast<uint8_t *>(&msg);
 	msg.msg_type = static_cast<uint8_t>(ULogMessageType::INFO);
@@ -1722,8 +2317,6 @@ void Logger::write_info_template(const char *name, T value, const char *type_str
 	msg.msg_size = msg_size - ULOG_MSG_HEADER_LEN;
 
 	write_message(buffer, msg_size);
-
-	_writer.unlock();
 }
 
 void Logger::write_header()
@@ -1738,7 +2331,6 @@ void Logger::write_header()
 	header.magic[6] = 0x35;
 	header.magic[7] = 0x01; //file version 1
 	header.timestamp = hrt_absolute_time();
-	_writer.lock();
 	write_message(&header, sizeof(header));
 
 	// write the Flags message: this MUST be written right after the ulog header
@@ -1749,8 +2341,6 @@ void Logger::write_header()
 	flag_bits.msg_type = static_cast<uint8_t>(ULogMessageType::FLAG_BITS);
 
 	write_message(&flag_bits, sizeof(flag_bits));
-
-	_writer.unlock();
 }
 
 /* write version info messages */
@@ -1822,7 +2412,6 @@ void Logger::write_version()
 
 void Logger::write_parameters()
 {
-	_writer.lock();
 	ulog_message_parameter_header_s msg = {};
 	uint8_t *buffer = reinterpret_cast<uint8_t *>(&msg);
 
@@ -1884,13 +2473,11 @@ void Logger::write_parameters()
 		}
 	} while ((param != PARAM_INVALID) && (param_idx < (int) param_count()));
 
-	_writer.unlock();
 	_writer.notify();
 }
 
 void Logger::write_changed_parameters()
 {
-	_writer.lock();
 	ulog_message_parameter_header_s msg = {};
 	uint8_t *buffer = reinterpret_cast<uint8_t *>(&msg);
 
@@ -1954,7 +2541,6 @@ void Logger::write_changed_parameters()
 		}
 	} while ((param != PARAM_INVALID) && (param_idx < (int) param_count()));
 
-	_writer.unlock();
 	_writer.notify();
 }
 
@@ -2068,6 +2654,9 @@ int Logger::check_free_space()
 		PX4_WARN("removing log directory %s to get more space (left=%u MiB)", directory_to_delete,
 			 (unsigned int)(statfs_buf.f_bavail / 1024U * statfs_buf.f_bsize / 1024U));
 
+		// the index would still list the removed logs: drop it, the next listing rebuilds it
+		unlink(LOG_INDEX);
+
 		if (remove_directory(directory_to_delete)) {
 			PX4_ERR("Failed to delete directory");
 			break;
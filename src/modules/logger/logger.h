@@ -35,9 +35,12 @@
 
 #include "log_writer.h"
 #include "array.h"
+#include "topic_profiles.h"
 #include <px4_defines.h>
+#include <string.h>
 #include <drivers/drv_hrt.h>
 #include <uORB/Subscription.hpp>
+#include <uORB/UpdateNotifier.hpp>
 #include <version/version.h>
 #include <systemlib/param/param.h>
 #include <systemlib/printload.h>
@@ -61,26 +64,47 @@ namespace px4
 namespace logger
 {
 
-enum class SDLogProfileMask : int32_t {
-	DEFAULT =               1 << 0,
-	ESTIMATOR_REPLAY =      1 << 1,
-	THERMAL_CALIBRATION =   1 << 2,
-	SYSTEM_IDENTIFICATION = 1 << 3,
-	HIGH_RATE =             1 << 4,
-	DEBUG_TOPICS =          1 << 5,
-	SENSOR_COMPARISON =	1 << 6
-};
+/**
+ * Subset of the fields of a topic that is logged instead of the whole struct (configured in
+ * logger_topics.txt). It is logged with a derived format named <topic>_subset, which contains the
+ * timestamp and the selected fields in the order of the struct.
+ */
+struct LoggerFieldSubset {
+	static constexpr int MAX_RANGES = 8;
+
+	struct Range {
+		uint16_t offset; ///< offset in the topic struct
+		uint16_t size;
+	};
+
+	Range ranges[MAX_RANGES]; ///< contiguous blocks of selected fields, ordered by offset
+	int num_ranges = 0;
+	uint16_t size = 0; ///< logged size of a sample [bytes]
+	uint16_t name_len = 0; ///< length of the message name at the start of format
+	char format[256]; ///< ULog format string: "<topic>_subset:<fields>"
 
-inline bool operator&(SDLogProfileMask a, SDLogProfileMask b)
-{
-	return static_cast<int32_t>(a) & static_cast<int32_t>(b);
-}
+	/**
+	 * Move the selected fields of a topic struct to the start of the buffer (in-place)
+	 */
+	void extract(uint8_t *data) const
+	{
+		uint16_t offset = 0;
+
+		for (int i = 0; i < num_ranges; ++i) {
+			memmove(data + offset, data + ranges[i].offset, ranges[i].size);
+			offset += ranges[i].size;
+		}
+	}
+};
 
 struct LoggerSubscription {
-	int fd[ORB_MULTI_MAX_INSTANCES]; ///< uorb subscription. The first fd is also used to store the interval if
-	/// not subscribed yet (-interval - 1)
+	int fd[ORB_MULTI_MAX_INSTANCES]; ///< uorb subscription (-1 if not subscribed yet)
 	uint16_t msg_ids[ORB_MULTI_MAX_INSTANCES];
 	const orb_metadata *metadata = nullptr;
+	uint16_t interval = 0; ///< configured logging interval [ms] (0 = as fast as the topic is updated)
+	TopicPriority priority = TopicPriority::NORMAL;
+	uint32_t bytes_logged = 0; ///< bytes written to the current log file (all instances)
+	LoggerFieldSubset *field_subset = nullptr; ///< if set, only these fields are logged (owned by the Logger)
 
 	LoggerSubscription() {}
 
@@ -103,7 +127,8 @@ class Logger : public ModuleBase<Logger>
 {
 public:
 	Logger(LogWriter::Backend backend, size_t buffer_size, uint32_t log_interval, const char *poll_topic_name,
-	       bool log_on_start, bool log_until_shutdown, bool log_name_timestamp, unsigned int queue_size);
+	       bool log_on_start, bool log_until_shutdown, bool log_name_timestamp, unsigned int queue_size,
+	       bool event_driven);
 
 	~Logger();
 
@@ -137,9 +162,12 @@ public:
 	 * (because it does not write an ADD_LOGGED_MSG message).
 	 * @param name topic name
 	 * @param interval limit rate if >0, otherwise log as fast as the topic is updated.
+	 * @param priority determines the order in which topics are decimated if the write buffer fills up
+	 * @param field_list comma-separated list of fields to log instead of the whole topic (nullptr for all)
 	 * @return true on success
 	 */
-	bool add_topic(const char *name, unsigned interval = 0);
+	bool add_topic(const char *name, unsigned interval = 0, TopicPriority priority = TopicPriority::NORMAL,
+		       const char *field_list = nullptr);
 
 	/**
 	 * add a logged topic (called by add_topic() above).
@@ -149,6 +177,13 @@ public:
 	 */
 	LoggerSubscription *add_topic(const orb_metadata *topic);
 
+	/**
+	 * add a logged topic with a given interval and priority (@see add_topic(const char *, ...)).
+	 * If the topic is already added, only the interval (and the priority, if higher) are updated.
+	 * @return the subscription on success, nullptr otherwise
+	 */
+	LoggerSubscription *add_topic(const orb_metadata *topic, unsigned interval, TopicPriority priority);
+
 	/**
 	 * request the logger thread to stop (this method does not block).
 	 * @return true if the logger is stopped, false if (still) running
@@ -168,7 +203,6 @@ private:
 
 	/**
 	 * Write an ADD_LOGGED_MSG to the log for a given subscription and instance.
-	 * _writer.lock() must be held when calling this.
 	 */
 	void write_add_logged_msg(LoggerSubscription &subscription, int instance);
 
@@ -254,6 +288,24 @@ private:
 
 	void write_changed_parameters();
 
+	/**
+	 * write the definitions section of a log file (version, formats and parameters), from the
+	 * definitions cache if it is valid, or generated directly otherwise
+	 */
+	void write_definitions();
+
+	/**
+	 * build the definitions cache, if it is enabled and not valid. The cache is built while not
+	 * logging and invalidated on parameter changes, so that starting a log is mostly a memory copy.
+	 */
+	void update_definitions_cache();
+
+	/**
+	 * append a message to the definitions cache (called by write_message() while building it)
+	 * @return false if the cache is full
+	 */
+	bool append_definitions_cache(const void *ptr, size_t size);
+
 	inline bool copy_if_updated_multi(LoggerSubscription &sub, int multi_instance, void *buffer, bool try_to_subscribe);
 
 	/**
@@ -262,9 +314,52 @@ private:
 	 */
 	bool try_to_subscribe_topic(LoggerSubscription &sub, int multi_instance);
 
+	/**
+	 * Register an update notifier for a subscribed topic instance (only in event-driven mode).
+	 * If it fails, the instance is checked in every iteration.
+	 */
+	void register_update_notifier(LoggerSubscription &sub, int multi_instance);
+
+	/**
+	 * Check if a subscription instance needs to be checked for updates in this iteration
+	 * @param updated bitmap of updated topic instances (fetched from _updated_topics)
+	 */
+	bool update_pending(const uint32_t *updated, int sub_idx, int multi_instance) const;
+
+	/**
+	 * Write a logged string message (ULogMessageType::LOGGING)
+	 * @param severity log level (same as log_message_s::severity)
+	 */
+	void write_logging_message(uint8_t severity, hrt_abstime timestamp, const char *message);
+
+	/**
+	 * Adjust the throttling level based on the file buffer fill level: under back-pressure, the logging
+	 * interval of low priority topics is increased, and restored once the buffer drains again.
+	 */
+	void update_throttling(hrt_abstime now);
+
+	/**
+	 * Set the throttling level and apply the resulting intervals to all subscriptions
+	 */
+	void set_throttle_level(int level);
+
+	/**
+	 * @return the logging interval [ms] of a subscription for the current throttling level
+	 */
+	unsigned topic_interval(const LoggerSubscription &sub) const;
+
+	/**
+	 * Publish the logger_status topic (file backend)
+	 */
+	void publish_logger_status(hrt_abstime now);
+
+	/**
+	 * Write the number of bytes logged per topic as info messages (at the end of the log)
+	 */
+	void write_topic_statistics();
+
 	/**
 	 * Write exactly one ulog message to the logger and handle dropouts.
-	 * Must be called with _writer.lock() held.
 	 * @return true if data written, false otherwise (on overflow)
 	 */
 	bool write_message(void *ptr, size_t size);
@@ -284,13 +379,24 @@ private:
 	 */
 	int add_topics_from_file(const char *fname);
 
-	void add_default_topics();
-	void add_estimator_replay_topics();
-	void add_thermal_calibration_topics();
-	void add_system_identification_topics();
-	void add_high_rate_topics();
-	void add_debug_topics();
-	void add_sensor_comparison_topics();
+	/**
+	 * Restrict the logged fields of a subscription (@see LoggerFieldSubset)
+	 * @param field_list comma-separated list of field names
+	 * @return true on success, false if a field is unknown or the subset is too large
+	 */
+	bool set_field_subset(LoggerSubscription &sub, const char *field_list);
+
+	/**
+	 * @return the size of a field of an o_fields string, -1 if the type is unknown
+	 * @param type type of the field, e.g. "float[3]" or an embedded topic type
+	 */
+	static int field_size(const char *type, size_t type_len);
+
+	/**
+	 * add the topics of all profiles selected in a mask (@see topic_profiles)
+	 * @return number of topics added
+	 */
+	int add_profile_topics(SDLogProfileMask profile);
 
 	void ack_vehicle_command(orb_advert_t &vehicle_command_ack_pub, vehicle_command_s *cmd, uint32_t result);
 
@@ -307,10 +413,22 @@ private:
 
 	static constexpr size_t 	MAX_TOPICS_NUM = 64; /**< Maximum number of logged topics */
 	static constexpr unsigned	MAX_NO_LOGFILE = 999;	/**< Maximum number of log files */
+	static constexpr size_t		UPDATE_BITMAP_WORDS = (MAX_TOPICS_NUM * ORB_MULTI_MAX_INSTANCES + 31) / 32;
+
+	static constexpr int		MAX_THROTTLE_LEVEL = (int)TopicPriority::CRITICAL; /**< critical topics are never throttled */
+	static constexpr hrt_abstime	THROTTLE_CHECK_INTERVAL = 100000;	/**< buffer fill level check interval [us] */
+	static constexpr hrt_abstime	THROTTLE_RAISE_DELAY = 300000;	/**< min time between throttling increases [us] */
+	static constexpr hrt_abstime	THROTTLE_RELEASE_DELAY = 2000000;	/**< min time before reducing throttling [us] */
+	static constexpr unsigned	THROTTLE_BASE_INTERVAL = 10;	/**< throttled interval base for full-rate topics [ms] */
+	static constexpr unsigned	THROTTLE_MAX_INTERVAL = 2000;	/**< max throttled interval [ms] */
+	static constexpr size_t		DEFINITIONS_CACHE_ALLOC_STEP = 4096;	/**< definitions cache allocation granularity */
+	static constexpr size_t		DEFINITIONS_CACHE_MAX_SIZE = 128 * 1024;	/**< the cache is disabled if it gets larger */
 #if defined(__PX4_POSIX_EAGLE) || defined(__PX4_POSIX_EXCELSIOR)
 	static constexpr const char	*LOG_ROOT = PX4_ROOTFSDIR"/log";
+	static constexpr const char	*LOG_INDEX = PX4_ROOTFSDIR"/log/logindex.txt";
 #else
 	static constexpr const char 	*LOG_ROOT = PX4_ROOTFSDIR"/fs/microsd/log";
+	static constexpr const char	*LOG_INDEX = PX4_ROOTFSDIR"/fs/microsd/log/logindex.txt";
 #endif
 
 	uint8_t						*_msg_buffer{nullptr};
@@ -320,6 +438,7 @@ private:
 	char 						_log_file_name[32];
 	bool						_has_log_dir{false};
 	bool						_was_armed{false};
+	bool						_history_enabled{false}; ///< pre-trigger history in the file buffer (SDLOG_PRE_TIME)
 	bool						_arm_override{false};
 
 
@@ -330,6 +449,20 @@ private:
 	size_t						_write_dropouts{0}; ///< failed buffer writes due to buffer overflow
 	size_t						_high_water{0}; ///< maximum used write buffer
 
+	// logger_status
+	orb_advert_t					_logger_status_pub{nullptr};
+	hrt_abstime					_next_status_publication{0};
+	hrt_abstime					_last_status_publication{0};
+	size_t						_last_status_total_written{0};
+	size_t						_status_high_water{0}; ///< maximum used write buffer since last publication
+	float						_status_max_dropout_duration{0.0f};
+	uint32_t					_log_dropouts{0}; ///< dropouts in the current log file
+
+	// back-pressure handling
+	int						_throttle_level{0}; ///< topics with a priority below this are decimated
+	hrt_abstime					_throttle_last_change{0};
+	hrt_abstime					_throttle_next_check{0};
+
 	const bool 					_log_on_start;
 	const bool 					_log_until_shutdown;
 	const bool					_log_name_timestamp;
@@ -337,6 +470,10 @@ private:
 	LogWriter					_writer;
 	uint32_t					_log_interval{0};
 	const orb_metadata				*_polling_topic_meta{nullptr}; ///< if non-null, poll on this topic instead of sleeping
+
+	// event-driven mode: only check the topic instances that have been published since the last iteration
+	uORB::UpdateNotifier				**_update_notifiers{nullptr}; ///< per subscription instance, nullptr if disabled
+	volatile uint32_t				_updated_topics[UPDATE_BITMAP_WORDS] {}; ///< set by the publishers
 	orb_advert_t					_mavlink_log_pub{nullptr};
 	uint16_t					_next_topic_id{0}; ///< id of next subscribed ulog topic
 	char						*_replay_file_name{nullptr};
@@ -344,11 +481,27 @@ private:
 											will be stopped after load printing */
 	print_load_s					_load{}; ///< process load data
 	hrt_abstime					_next_load_print{0}; ///< timestamp when to print the process load
+	hrt_abstime					_topics_setup_time{0}; ///< time spent adding the logged topics [us]
+
+	// pre-serialized definitions section (version, formats, parameters) for the file backend
+	uint8_t						*_definitions_cache{nullptr};
+	size_t						_definitions_cache_size{0};
+	size_t						_definitions_cache_capacity{0};
+	unsigned					_definitions_cache_params_used{0}; ///< param_count_used() when the cache was built
+	bool						_definitions_cache_enabled{false};
+	bool						_definitions_cache_valid{false};
+	bool						_definitions_cache_capture{false}; ///< if true, write_message() appends to the cache
+	bool						_definitions_cache_overflow{false};
 
 	// control
 	param_t						_sdlog_profile_handle{PARAM_INVALID};
 	param_t						_log_utc_offset{PARAM_INVALID};
 	param_t						_log_dirs_max{PARAM_INVALID};
+	param_t						_log_compress{PARAM_INVALID};
+	param_t						_log_mmap{PARAM_INVALID};
+	param_t						_log_definitions_cache{PARAM_INVALID};
+	param_t						_log_write_size{PARAM_INVALID};
+	param_t						_log_pre_time{PARAM_INVALID};
 };
 
 } //namespace logger
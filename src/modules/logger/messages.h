@@ -57,6 +57,21 @@ struct ulog_file_header_s {
 	uint64_t timestamp;
 };
 
+/*
+ * Compressed ULog (SDLOG_COMPRESS): the file header is followed by a sequence of blocks, each
+ * consisting of a block header and the (LZ4 block format) compressed data. The uncompressed
+ * blocks form a regular ULog file. See Tools/ulog_decompress.py.
+ */
+#define ULOG_COMPRESSED_VERSION 1
+struct ulog_compressed_file_header_s {
+	uint8_t magic[8]; ///< 'U', 'L', 'o', 'g', 'Z', 0x12, 0x35, version
+};
+
+struct ulog_compressed_block_s {
+	uint16_t compressed_size; ///< 0 if the data is stored uncompressed
+	uint16_t size; ///< uncompressed size
+};
+
 #define ULOG_MSG_HEADER_LEN 3 //accounts for msg_size and msg_type
 struct ulog_message_header_s {
 	uint16_t msg_size;
@@ -86,9 +86,10 @@ PARAM_DEFINE_INT32(SDLOG_MODE, 0);
  * 4 : Set to true to enable full rates for analysis of fast maneuvers (RC, attitude, rates and actuators)
  * 5 : Set to true to enable debugging topics (debug_*.msg topics, for custom code)
  * 6 : Set to true to enable topics for sensor comparison (low rate raw IMU, Baro and Magnetomer data)
+ * 7 : Set to true to enable all raw IMU samples (sensor_*_fifo topics, for vibration analysis)
  *
  * @min 0
- * @max 127
+ * @max 255
  * @bit 0 default set (log analysis)
  * @bit 1 estimator replay (EKF2)
  * @bit 2 thermal calibration
@@ -96,6 +97,7 @@ PARAM_DEFINE_INT32(SDLOG_MODE, 0);
  * @bit 4 high rate
  * @bit 5 debug
  * @bit 6 sensor comparison
+ * @bit 7 IMU FIFO
  * @reboot_required true
  * @group SD Logging
  */
@@ -129,3 +131,80 @@ PARAM_DEFINE_INT32(SDLOG_DIRS_MAX, 0);
  * @group SD Logging
  */
 PARAM_DEFINE_INT32(SDLOG_UUID, 1);
+
+/**
+ * Compress log files
+ *
+ * If enabled, the log data is compressed before writing it to the SD card, reducing
+ * the write bandwidth. The files get the extension .ulgz and need to be converted
+ * with Tools/ulog_decompress.py before they can be analyzed.
+ * This costs some CPU time and 12 KB of RAM.
+ *
+ * @boolean
+ * @reboot_required true
+ * @group SD Logging
+ */
+PARAM_DEFINE_INT32(SDLOG_COMPRESS, 0);
+
+/**
+ * Write memory-mapped log files
+ *
+ * If enabled, the logger writes directly into a memory-mapped log file and lets the
+ * kernel handle the writeback, instead of copying the data through the log buffer and
+ * the writer thread. The log buffer is not allocated in that case.
+ * Only supported on POSIX systems (e.g. Snapdragon, Navio), and not in combination
+ * with SDLOG_COMPRESS.
+ *
+ * @boolean
+ * @reboot_required true
+ * @group SD Logging
+ */
+PARAM_DEFINE_INT32(SDLOG_MMAP, 0);
+
+/**
+ * Cache the log file definitions
+ *
+ * If enabled, the static part at the beginning of a log file (version information,
+ * message formats and parameters) is serialized once while not logging and kept in RAM,
+ * and written with a few memory copies when logging starts. The cache is rebuilt after
+ * a parameter change. This reduces the time to start a log at the cost of RAM (typically
+ * 30-60 KB, at most 128 KB).
+ *
+ * @boolean
+ * @reboot_required true
+ * @group SD Logging
+ */
+PARAM_DEFINE_INT32(SDLOG_DEF_CACHE, 0);
+
+/**
+ * Log file write size
+ *
+ * Minimum size of a write to the log file. Writes are aligned to 4 KB (the FAT
+ * cluster size), and larger writes increase the SD card throughput. The value is
+ * limited to half of the logger buffer size (see the -b option of the logger).
+ *
+ * @unit KB
+ * @min 4
+ * @max 32
+ * @reboot_required true
+ * @group SD Logging
+ */
+PARAM_DEFINE_INT32(SDLOG_WR_SIZE, 4);
+
+/**
+ * Pre-trigger logging duration
+ *
+ * If set, the logged topics are continuously captured into the log buffer while
+ * not logging, and the last seconds of data are written at the beginning of the
+ * log when logging starts (on arming, or on a failsafe). This helps to find the
+ * cause of problems that happen right before or at arming.
+ * The history is limited by the size of the log buffer (see the -b option of the
+ * logger). Not used if logging from boot, or with SDLOG_MMAP.
+ *
+ * @unit s
+ * @min 0
+ * @max 60
+ * @reboot_required true
+ * @group SD Logging
+ */
+PARAM_DEFINE_INT32(SDLOG_PRE_TIME, 0);
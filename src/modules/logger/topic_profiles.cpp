@@ -0,0 +1,228 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2017 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file topic_profiles.cpp
+ * Precompiled topic tables of the logging profiles (SDLOG_PROFILE)
+ */
+
+#include "topic_profiles.h"
+
+#include <uORB/topics/actuator_controls.h>
+#include <uORB/topics/actuator_outputs.h>
+#include <uORB/topics/airspeed.h>
+#include <uORB/topics/att_pos_mocap.h>
+#include <uORB/topics/battery_status.h>
+#include <uORB/topics/camera_capture.h>
+#include <uORB/topics/camera_trigger.h>
+#include <uORB/topics/control_latency.h>
+#include <uORB/topics/cpuload.h>
+#include <uORB/topics/debug_key_value.h>
+#include <uORB/topics/debug_value.h>
+#include <uORB/topics/debug_vect.h>
+#include <uORB/topics/distance_sensor.h>
+#include <uORB/topics/ekf2_innovations.h>
+#include <uORB/topics/ekf2_timestamps.h>
+#include <uORB/topics/esc_status.h>
+#include <uORB/topics/estimator_status.h>
+#include <uORB/topics/estimator_timing.h>
+#include <uORB/topics/input_rc.h>
+#include <uORB/topics/logger_status.h>
+#include <uORB/topics/manual_control_setpoint.h>
+#include <uORB/topics/optical_flow.h>
+#include <uORB/topics/position_setpoint_triplet.h>
+#include <uORB/topics/sensor_accel.h>
+#include <uORB/topics/sensor_accel_fifo.h>
+#include <uORB/topics/sensor_baro.h>
+#include <uORB/topics/sensor_combined.h>
+#include <uORB/topics/sensor_gyro.h>
+#include <uORB/topics/sensor_gyro_fifo.h>
+#include <uORB/topics/sensor_mag.h>
+#include <uORB/topics/sensor_preflight.h>
+#include <uORB/topics/sensor_selection.h>
+#include <uORB/topics/system_power.h>
+#include <uORB/topics/task_stack_info.h>
+#include <uORB/topics/task_stats.h>
+#include <uORB/topics/tecs_status.h>
+#include <uORB/topics/telemetry_status.h>
+#include <uORB/topics/temperature_calibration_status.h>
+#include <uORB/topics/vehicle_attitude.h>
+#include <uORB/topics/vehicle_attitude_setpoint.h>
+#include <uORB/topics/vehicle_command.h>
+#include <uORB/topics/vehicle_global_position.h>
+#include <uORB/topics/vehicle_gps_position.h>
+#include <uORB/topics/vehicle_land_detected.h>
+#include <uORB/topics/vehicle_local_position.h>
+#include <uORB/topics/vehicle_local_position_setpoint.h>
+#include <uORB/topics/vehicle_rates_setpoint.h>
+#include <uORB/topics/vehicle_status.h>
+#include <uORB/topics/vtol_vehicle_status.h>
+#include <uORB/topics/wind_estimate.h>
+#include <uORB/topics/work_item_stats.h>
+
+namespace px4
+{
+namespace logger
+{
+
+static constexpr ProfileTopic default_topics[] = {
+	// Note: try to avoid setting the interval where possible, as it increases RAM usage
+#ifdef CONFIG_ARCH_BOARD_SITL
+	{ORB_ID(vehicle_attitude_groundtruth), 10, TopicPriority::NORMAL},
+	{ORB_ID(vehicle_global_position_groundtruth), 100, TopicPriority::NORMAL},
+	{ORB_ID(vehicle_local_position_groundtruth), 100, TopicPriority::NORMAL},
+#endif
+
+	{ORB_ID(actuator_controls_0), 100, TopicPriority::NORMAL},
+	{ORB_ID(actuator_controls_1), 100, TopicPriority::NORMAL},
+	{ORB_ID(actuator_outputs), 100, TopicPriority::NORMAL},
+	{ORB_ID(airspeed), 200, TopicPriority::NORMAL},
+	{ORB_ID(att_pos_mocap), 50, TopicPriority::NORMAL},
+	{ORB_ID(battery_status), 500, TopicPriority::NORMAL},
+	{ORB_ID(camera_capture), 0, TopicPriority::NORMAL},
+	{ORB_ID(camera_trigger), 0, TopicPriority::NORMAL},
+	{ORB_ID(control_latency), 0, TopicPriority::LOW},
+	{ORB_ID(cpuload), 0, TopicPriority::LOW},
+	{ORB_ID(distance_sensor), 100, TopicPriority::NORMAL},
+	{ORB_ID(ekf2_innovations), 200, TopicPriority::CRITICAL},
+	{ORB_ID(esc_status), 250, TopicPriority::LOW},
+	{ORB_ID(estimator_status), 200, TopicPriority::CRITICAL},
+	{ORB_ID(estimator_timing), 0, TopicPriority::LOW},
+	{ORB_ID(input_rc), 200, TopicPriority::NORMAL},
+	{ORB_ID(logger_status), 0, TopicPriority::LOW},
+	{ORB_ID(manual_control_setpoint), 200, TopicPriority::NORMAL},
+	{ORB_ID(optical_flow), 50, TopicPriority::NORMAL},
+	{ORB_ID(position_setpoint_triplet), 200, TopicPriority::NORMAL},
+	{ORB_ID(sensor_combined), 100, TopicPriority::CRITICAL},
+	{ORB_ID(sensor_preflight), 200, TopicPriority::LOW},
+	{ORB_ID(system_power), 500, TopicPriority::LOW},
+	{ORB_ID(task_stack_info), 0, TopicPriority::LOW},
+	{ORB_ID(task_stats), 0, TopicPriority::LOW},
+	{ORB_ID(tecs_status), 200, TopicPriority::LOW},
+	{ORB_ID(telemetry_status), 0, TopicPriority::LOW},
+	{ORB_ID(temperature_calibration_status), 0, TopicPriority::LOW},
+	{ORB_ID(vehicle_attitude), 30, TopicPriority::CRITICAL},
+	{ORB_ID(vehicle_attitude_setpoint), 100, TopicPriority::NORMAL},
+	{ORB_ID(vehicle_command), 0, TopicPriority::NORMAL},
+	{ORB_ID(vehicle_global_position), 200, TopicPriority::CRITICAL},
+	{ORB_ID(vehicle_gps_position), 0, TopicPriority::NORMAL},
+	{ORB_ID(vehicle_land_detected), 0, TopicPriority::NORMAL},
+	{ORB_ID(vehicle_local_position), 100, TopicPriority::CRITICAL},
+	{ORB_ID(vehicle_local_position_setpoint), 100, TopicPriority::NORMAL},
+	{ORB_ID(vehicle_rates_setpoint), 30, TopicPriority::NORMAL},
+	{ORB_ID(vehicle_status), 200, TopicPriority::NORMAL},
+	{ORB_ID(vehicle_vision_attitude), 0, TopicPriority::NORMAL},
+	{ORB_ID(vehicle_vision_position), 0, TopicPriority::NORMAL},
+	{ORB_ID(vtol_vehicle_status), 200, TopicPriority::NORMAL},
+	{ORB_ID(wind_estimate), 200, TopicPriority::LOW},
+	{ORB_ID(work_item_stats), 0, TopicPriority::LOW},
+};
+
+static constexpr ProfileTopic estimator_replay_topics[] = {
+	// for estimator replay (need to be at full rate, also under write buffer back-pressure).
+	// The topics after ekf2_timestamps are the current EKF2 subscriptions
+	{ORB_ID(ekf2_timestamps), 0, TopicPriority::CRITICAL},
+	{ORB_ID(airspeed), 0, TopicPriority::CRITICAL},
+	{ORB_ID(distance_sensor), 0, TopicPriority::CRITICAL},
+	{ORB_ID(optical_flow), 0, TopicPriority::CRITICAL},
+	{ORB_ID(sensor_baro), 0, TopicPriority::CRITICAL},
+	{ORB_ID(sensor_combined), 0, TopicPriority::CRITICAL},
+	{ORB_ID(sensor_selection), 0, TopicPriority::CRITICAL},
+	{ORB_ID(vehicle_gps_position), 0, TopicPriority::CRITICAL},
+	{ORB_ID(vehicle_land_detected), 0, TopicPriority::CRITICAL},
+	{ORB_ID(vehicle_status), 0, TopicPriority::CRITICAL},
+	{ORB_ID(vehicle_vision_attitude), 0, TopicPriority::CRITICAL},
+	{ORB_ID(vehicle_vision_position), 0, TopicPriority::CRITICAL},
+};
+
+static constexpr ProfileTopic thermal_calibration_topics[] = {
+	{ORB_ID(sensor_accel), 100, TopicPriority::NORMAL},
+	{ORB_ID(sensor_baro), 100, TopicPriority::NORMAL},
+	{ORB_ID(sensor_gyro), 100, TopicPriority::NORMAL},
+};
+
+static constexpr ProfileTopic system_identification_topics[] = {
+	// for system id need to log imu and controls at full rate
+	{ORB_ID(actuator_controls_0), 0, TopicPriority::NORMAL},
+	{ORB_ID(actuator_controls_1), 0, TopicPriority::NORMAL},
+	{ORB_ID(sensor_combined), 0, TopicPriority::NORMAL},
+};
+
+static constexpr ProfileTopic high_rate_topics[] = {
+	// maximum rate to analyze fast maneuvers (e.g. for racing)
+	{ORB_ID(actuator_controls_0), 0, TopicPriority::NORMAL},
+	{ORB_ID(actuator_outputs), 0, TopicPriority::NORMAL},
+	{ORB_ID(manual_control_setpoint), 0, TopicPriority::NORMAL},
+	{ORB_ID(vehicle_attitude), 0, TopicPriority::NORMAL},
+	{ORB_ID(vehicle_attitude_setpoint), 0, TopicPriority::NORMAL},
+	{ORB_ID(vehicle_rates_setpoint), 0, TopicPriority::NORMAL},
+};
+
+static constexpr ProfileTopic debug_topics[] = {
+	{ORB_ID(debug_key_value), 0, TopicPriority::BEST_EFFORT},
+	{ORB_ID(debug_value), 0, TopicPriority::BEST_EFFORT},
+	{ORB_ID(debug_vect), 0, TopicPriority::BEST_EFFORT},
+};
+
+static constexpr ProfileTopic sensor_comparison_topics[] = {
+	{ORB_ID(sensor_accel), 100, TopicPriority::NORMAL},
+	{ORB_ID(sensor_baro), 100, TopicPriority::NORMAL},
+	{ORB_ID(sensor_gyro), 100, TopicPriority::NORMAL},
+	{ORB_ID(sensor_mag), 100, TopicPriority::NORMAL},
+};
+
+static constexpr ProfileTopic imu_fifo_topics[] = {
+	// all IMU samples for vibration analysis, dropped first under write buffer back-pressure
+	{ORB_ID(sensor_accel_fifo), 0, TopicPriority::BEST_EFFORT},
+	{ORB_ID(sensor_gyro_fifo), 0, TopicPriority::BEST_EFFORT},
+};
+
+#define PROFILE(mask, name, topics) { SDLogProfileMask::mask, name, topics, sizeof(topics) / sizeof(topics[0]) }
+
+const TopicProfile topic_profiles[] = {
+	PROFILE(DEFAULT, "default", default_topics),
+	PROFILE(ESTIMATOR_REPLAY, "estimator replay", estimator_replay_topics),
+	PROFILE(THERMAL_CALIBRATION, "thermal calibration", thermal_calibration_topics),
+	PROFILE(SYSTEM_IDENTIFICATION, "system identification", system_identification_topics),
+	PROFILE(HIGH_RATE, "high rate", high_rate_topics),
+	PROFILE(DEBUG_TOPICS, "debug", debug_topics),
+	PROFILE(SENSOR_COMPARISON, "sensor comparison", sensor_comparison_topics),
+	PROFILE(IMU_FIFO, "IMU FIFO", imu_fifo_topics),
+};
+
+#undef PROFILE
+
+const size_t topic_profiles_count = sizeof(topic_profiles) / sizeof(topic_profiles[0]);
+
+} //namespace logger
+} //namespace px4
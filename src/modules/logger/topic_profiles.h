@@ -0,0 +1,101 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2017 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <uORB/uORB.h>
+
+namespace px4
+{
+namespace logger
+{
+
+enum class SDLogProfileMask : int32_t {
+	DEFAULT =               1 << 0,
+	ESTIMATOR_REPLAY =      1 << 1,
+	THERMAL_CALIBRATION =   1 << 2,
+	SYSTEM_IDENTIFICATION = 1 << 3,
+	HIGH_RATE =             1 << 4,
+	DEBUG_TOPICS =          1 << 5,
+	SENSOR_COMPARISON =	1 << 6,
+	IMU_FIFO =		1 << 7
+};
+
+inline bool operator&(SDLogProfileMask a, SDLogProfileMask b)
+{
+	return static_cast<int32_t>(a) & static_cast<int32_t>(b);
+}
+
+/**
+ * Priority of a logged topic: if the write buffer fills up, the logging rate of lower priority topics
+ * is reduced first. Critical topics are always logged at the configured rate.
+ */
+enum class TopicPriority : uint8_t {
+	BEST_EFFORT =           0,
+	LOW =                   1,
+	NORMAL =                2,
+	CRITICAL =              3
+};
+
+/**
+ * A topic of a logging profile
+ */
+struct ProfileTopic {
+	const orb_metadata *metadata;
+	uint16_t interval; ///< logging interval [ms] (0 = as fast as the topic is updated)
+	TopicPriority priority;
+};
+
+/**
+ * A logging profile, selected with its bit in SDLOG_PROFILE
+ */
+struct TopicProfile {
+	SDLogProfileMask mask;
+	const char *name;
+	const ProfileTopic *topics;
+	size_t num_topics;
+};
+
+/**
+ * All logging profiles, in the order in which they are applied: if several selected profiles
+ * contain the same topic, the interval of the last one is used (and the highest priority).
+ * The tables are constant (stored in flash) and reference the topic metadata directly, so
+ * that no lookup by name is needed.
+ */
+extern const TopicProfile topic_profiles[];
+extern const size_t topic_profiles_count;
+
+} //namespace logger
+} //namespace px4
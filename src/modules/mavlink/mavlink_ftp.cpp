@@ -34,7 +34,6 @@
 /// @file mavlink_ftp.cpp
 ///	@author px4dev, Don Gagne <don@thegagnes.com>
 
-#include <crc32.h>
 #include <unistd.h>
 #include <stdio.h>
 #include <fcntl.h>
@@ -42,6 +41,8 @@
 #include <errno.h>
 #include <cstring>
 
+#include <systemlib/crc.h>
+
 #include "mavlink_ftp.h"
 #include "mavlink_main.h"
 #include "mavlink_tests/mavlink_ftp_test.h"
@@ -55,7 +56,10 @@ MavlinkFTP::MavlinkFTP(Mavlink *mavlink) :
 	_mavlink(mavlink),
 	_work_buffer1{nullptr},
 	_work_buffer2{nullptr},
-	_last_work_buffer_access{0}
+	_last_work_buffer_access{0},
+	_read_ahead_buffer{nullptr},
+	_read_ahead_offset{0},
+	_read_ahead_size{0}
 {
 	// initialize session
 	_session_info.fd = -1;
@@ -71,6 +75,9 @@ MavlinkFTP::~MavlinkFTP()
 		delete[] _work_buffer2;
 	}
 
+	if (_read_ahead_buffer) {
+		delete[] _read_ahead_buffer;
+	}
 }
 
 unsigned
@@ -227,6 +234,11 @@ MavlinkFTP::_process_request(mavlink_file_transfer_protocol_t *ftp_req, uint8_t
 		stream_send = true;
 		break;
 
+	case kCmdBurstReadMissing:
+		errorCode = _workBurstMissing(payload, target_system_id);
+		stream_send = true;
+		break;
+
 	case kCmdWriteFile:
 		errorCode = _workWrite(payload);
 		break;
@@ -545,6 +557,7 @@ MavlinkFTP::_workOpen(PayloadHeader *payload, int oflag)
 	_session_info.fd = fd;
 	_session_info.file_size = fileSize;
 	_session_info.stream_download = false;
+	_invalidate_read_ahead();
 
 	payload->session = 0;
 	payload->size = sizeof(uint32_t);
@@ -571,12 +584,7 @@ MavlinkFTP::_workRead(PayloadHeader *payload)
 		return kErrEOF;
 	}
 
-	if (lseek(_session_info.fd, payload->offset, SEEK_SET) < 0) {
-		PX4_ERR("seek fail");
-		return kErrFailErrno;
-	}
-
-	int bytes_read = ::read(_session_info.fd, &payload->data[0], kMaxDataLength);
+	int bytes_read = _read_session_file(payload->offset, &payload->data[0], kMaxDataLength);
 
 	if (bytes_read < 0) {
 		// Negative return indicates error other than eof
@@ -589,6 +597,56 @@ MavlinkFTP::_workRead(PayloadHeader *payload)
 	return kErrNone;
 }
 
+int
+MavlinkFTP::_read_session_file(uint32_t offset, uint8_t *dst, int len)
+{
+	if (!_read_ahead_buffer) {
+		_read_ahead_buffer = new uint8_t[_read_ahead_buffer_len];
+		_read_ahead_size = 0;
+	}
+
+	_last_work_buffer_access = hrt_absolute_time();
+
+	if (!_read_ahead_buffer) {
+		// no memory for the read-ahead: read directly
+		if (lseek(_session_info.fd, offset, SEEK_SET) < 0) {
+			return -1;
+		}
+
+		return ::read(_session_info.fd, dst, len);
+	}
+
+	// the buffered data can be used if it contains the whole request, or everything up to EOF
+	bool hit = offset >= _read_ahead_offset && offset < _read_ahead_offset + _read_ahead_size &&
+		   (offset + len <= _read_ahead_offset + _read_ahead_size || _read_ahead_size < _read_ahead_buffer_len);
+
+	if (!hit) {
+		_read_ahead_size = 0;
+
+		if (lseek(_session_info.fd, offset, SEEK_SET) < 0) {
+			return -1;
+		}
+
+		int bytes_read = ::read(_session_info.fd, _read_ahead_buffer, _read_ahead_buffer_len);
+
+		if (bytes_read <= 0) {
+			return bytes_read;
+		}
+
+		_read_ahead_offset = offset;
+		_read_ahead_size = bytes_read;
+	}
+
+	const int available = _read_ahead_offset + _read_ahead_size - offset;
+
+	if (len > available) {
+		len = available;
+	}
+
+	memcpy(dst, &_read_ahead_buffer[offset - _read_ahead_offset], len);
+	return len;
+}
+
 /// @brief Responds to a Stream command
 MavlinkFTP::ErrorCode
 MavlinkFTP::_workBurst(PayloadHeader *payload, uint8_t target_system_id)
@@ -600,10 +658,75 @@ MavlinkFTP::_workBurst(PayloadHeader *payload, uint8_t target_system_id)
 #ifdef MAVLINK_FTP_DEBUG
 	PX4_INFO("FTP: burst offset:%d", payload->offset);
 #endif
+	uint32_t window = kBurstWindowDefault;
+
+	if (payload->size == sizeof(uint32_t)) {
+		std::memcpy(&window, payload->data, sizeof(uint32_t));
+
+		if (window < kMaxDataLength) {
+			window = kMaxDataLength;
+
+		} else if (window > kBurstWindowMax) {
+			window = kBurstWindowMax;
+		}
+	}
+
 	// Setup for streaming sends
 	_session_info.stream_download = true;
 	_session_info.stream_offset = payload->offset;
 	_session_info.stream_chunk_transmitted = 0;
+	_session_info.stream_seq_number = payload->seq_number + 1;
+	_session_info.stream_target_system_id = target_system_id;
+	_session_info.stream_window = window;
+	_session_info.stream_resend_count = 0;
+	_session_info.stream_resend_index = 0;
+	_session_info.stream_resend_only = false;
+
+	return kErrNone;
+}
+
+/// @brief Responds to a request to resend lost burst packets
+MavlinkFTP::ErrorCode
+MavlinkFTP::_workBurstMissing(PayloadHeader *payload, uint8_t target_system_id)
+{
+	if (payload->session != 0 || _session_info.fd < 0) {
+		return kErrInvalidSession;
+	}
+
+	const unsigned count = payload->size / sizeof(uint32_t);
+
+	if (count == 0 || count > kMaxBurstResend || payload->size % sizeof(uint32_t) != 0) {
+		return kErrInvalidDataSize;
+	}
+
+	// validate all offsets first: an invalid request must not change the packets that are still queued
+	for (unsigned i = 0; i < count; i++) {
+		uint32_t offset;
+		std::memcpy(&offset, &payload->data[i * sizeof(uint32_t)], sizeof(uint32_t));
+
+		if (offset >= _session_info.file_size) {
+			return kErrEOF;
+		}
+	}
+
+	// a new request replaces the packets that are still queued
+	std::memcpy(_session_info.stream_resend, payload->data, count * sizeof(uint32_t));
+
+#ifdef MAVLINK_FTP_DEBUG
+	PX4_INFO("FTP: burst resend of %d packets", count);
+#endif
+
+	_session_info.stream_resend_count = count;
+	_session_info.stream_resend_index = 0;
+
+	if (!_session_info.stream_download) {
+		// the burst is over: only send the missing packets, and complete the burst with the last one
+		_session_info.stream_download = true;
+		_session_info.stream_resend_only = true;
+		_session_info.stream_chunk_transmitted = 0;
+		_session_info.stream_window = kBurstWindowDefault;
+	}
+
 	_session_info.stream_seq_number = payload->seq_number + 1;
 	_session_info.stream_target_system_id = target_system_id;
 
@@ -618,6 +741,8 @@ MavlinkFTP::_workWrite(PayloadHeader *payload)
 		return kErrInvalidSession;
 	}
 
+	_invalidate_read_ahead();
+
 	if (lseek(_session_info.fd, payload->offset, SEEK_SET) < 0) {
 		// Unable to see to the specified location
 		PX4_ERR("seek fail");
@@ -865,8 +990,19 @@ MavlinkFTP::_workCalcFileCRC32(PayloadHeader *payload)
 		return kErrFailErrno;
 	}
 
+	// read in large blocks through the read-ahead buffer if there is memory for it, its contents are
+	// invalidated since they no longer belong to the session file
+	if (!_read_ahead_buffer) {
+		_read_ahead_buffer = new uint8_t[_read_ahead_buffer_len];
+	}
+
+	_invalidate_read_ahead();
+
+	uint8_t *buffer = _read_ahead_buffer ? _read_ahead_buffer : (uint8_t *)_work_buffer2;
+	const int buffer_len = _read_ahead_buffer ? _read_ahead_buffer_len : _work_buffer2_len;
+
 	do {
-		bytes_read = ::read(fd, _work_buffer2, _work_buffer2_len);
+		bytes_read = ::read(fd, buffer, buffer_len);
 
 		if (bytes_read < 0) {
 			int r_errno = errno;
@@ -875,8 +1011,8 @@ MavlinkFTP::_workCalcFileCRC32(PayloadHeader *payload)
 			return kErrFailErrno;
 		}
 
-		checksum = crc32part((uint8_t *)_work_buffer2, bytes_read, checksum);
-	} while (bytes_read == _work_buffer2_len);
+		checksum = crc32_fast(buffer, bytes_read, checksum);
+	} while (bytes_read > 0);
 
 	::close(fd);
 
@@ -966,7 +1102,7 @@ MavlinkFTP::_copy_file(const char *src_path, const char *dst_path, size_t length
 void MavlinkFTP::send(const hrt_abstime t)
 {
 
-	if (_work_buffer1 || _work_buffer2) {
+	if (_work_buffer1 || _work_buffer2 || _read_ahead_buffer) {
 		// free the work buffers if they are not used for a while
 		if (hrt_elapsed_time(&_last_work_buffer_access) > 2000000) {
 			if (_work_buffer1) {
@@ -978,6 +1114,11 @@ void MavlinkFTP::send(const hrt_abstime t)
 				delete[] _work_buffer2;
 				_work_buffer2 = nullptr;
 			}
+
+			if (_read_ahead_buffer) {
+				delete[] _read_ahead_buffer;
+				_read_ahead_buffer = nullptr;
+			}
 		}
 	}
 
@@ -1011,19 +1152,24 @@ void MavlinkFTP::send(const hrt_abstime t)
 		mavlink_file_transfer_protocol_t ftp_msg;
 		PayloadHeader *payload = reinterpret_cast<PayloadHeader *>(&ftp_msg.payload[0]);
 
+		// lost packets requested by the client go first
+		const bool resend = _session_info.stream_resend_index < _session_info.stream_resend_count;
+
 		payload->seq_number = _session_info.stream_seq_number;
 		payload->session = 0;
 		payload->opcode = kRspAck;
 		payload->req_opcode = kCmdBurstReadFile;
-		payload->offset = _session_info.stream_offset;
+		payload->burst_complete = false;
+		payload->offset = resend ? _session_info.stream_resend[_session_info.stream_resend_index++] :
+				  _session_info.stream_offset;
 		_session_info.stream_seq_number++;
 
 #ifdef MAVLINK_FTP_DEBUG
-		PX4_INFO("stream send: offset %d", _session_info.stream_offset);
+		PX4_INFO("stream send: offset %d%s", payload->offset, resend ? " (resend)" : "");
 #endif
 
 		// We have to test seek past EOF ourselves, lseek will allow seek past EOF
-		if (_session_info.stream_offset >= _session_info.file_size) {
+		if (payload->offset >= _session_info.file_size) {
 			error_code = kErrEOF;
 #ifdef MAVLINK_FTP_DEBUG
 			PX4_INFO("stream download: sending Nak EOF");
@@ -1031,16 +1177,7 @@ void MavlinkFTP::send(const hrt_abstime t)
 		}
 
 		if (error_code == kErrNone) {
-			if (lseek(_session_info.fd, payload->offset, SEEK_SET) < 0) {
-				error_code = kErrFailErrno;
-#ifdef MAVLINK_FTP_DEBUG
-				PX4_WARN("stream download: seek fail");
-#endif
-			}
-		}
-
-		if (error_code == kErrNone) {
-			int bytes_read = ::read(_session_info.fd, &payload->data[0], kMaxDataLength);
+			int bytes_read = _read_session_file(payload->offset, &payload->data[0], kMaxDataLength);
 
 			if (bytes_read < 0) {
 				// Negative return indicates error other than eof
@@ -1051,8 +1188,11 @@ void MavlinkFTP::send(const hrt_abstime t)
 
 			} else {
 				payload->size = bytes_read;
-				_session_info.stream_offset += bytes_read;
 				_session_info.stream_chunk_transmitted += bytes_read;
+
+				if (!resend) {
+					_session_info.stream_offset += bytes_read;
+				}
 			}
 		}
 
@@ -1069,6 +1209,17 @@ void MavlinkFTP::send(const hrt_abstime t)
 			}
 
 			_session_info.stream_download = false;
+			_session_info.stream_resend_count = 0;
+			_session_info.stream_resend_index = 0;
+
+		} else if (_session_info.stream_resend_only &&
+			   _session_info.stream_resend_index >= _session_info.stream_resend_count) {
+			// all the requested packets are resent
+			payload->burst_complete = true;
+			_session_info.stream_download = false;
+			_session_info.stream_resend_only = false;
+			_session_info.stream_resend_count = 0;
+			_session_info.stream_resend_index = 0;
 
 		} else {
 #ifndef MAVLINK_FTP_UNIT_TEST
@@ -1076,8 +1227,10 @@ void MavlinkFTP::send(const hrt_abstime t)
 			if (max_bytes_to_send < (get_size() * 2)) {
 				more_data = false;
 
-				/* perform transfers in 35K chunks - this is determined empirical */
-				if (_session_info.stream_chunk_transmitted > 35000) {
+				/* perform transfers in chunks of the requested window size, so the client
+				 * can request the packets it missed */
+				if (_session_info.stream_chunk_transmitted > _session_info.stream_window &&
+				    _session_info.stream_resend_index >= _session_info.stream_resend_count) {
 					payload->burst_complete = true;
 					_session_info.stream_download = false;
 					_session_info.stream_chunk_transmitted = 0;
@@ -103,7 +103,8 @@ public:
 		kCmdTruncateFile,	///< Truncate file at <path> to <offset> length
 		kCmdRename,		///< Rename <path1> to <path2>
 		kCmdCalcFileCRC32,	///< Calculate CRC32 for file at <path>
-		kCmdBurstReadFile,	///< Burst download session file
+		kCmdBurstReadFile,	///< Burst download session file from <offset>, optional window size in bytes (uint32) in data
+		kCmdBurstReadMissing,	///< Resend the burst packets of <session> at the offsets (uint32) in data
 
 		kRspAck = 128,		///< Ack response
 		kRspNak			///< Nak response
@@ -136,6 +137,7 @@ private:
 	ErrorCode	_workOpen(PayloadHeader *payload, int oflag);
 	ErrorCode	_workRead(PayloadHeader *payload);
 	ErrorCode	_workBurst(PayloadHeader *payload, uint8_t target_system_id);
+	ErrorCode	_workBurstMissing(PayloadHeader *payload, uint8_t target_system_id);
 	ErrorCode	_workWrite(PayloadHeader *payload);
 	ErrorCode	_workTerminate(PayloadHeader *payload);
 	ErrorCode	_workReset(PayloadHeader *payload);
@@ -156,6 +158,17 @@ private:
 	 */
 	bool _ensure_buffers_exist();
 
+	/**
+	 * read from the session file through the read-ahead buffer, so that sequential reads of
+	 * packet sized chunks don't each result in a seek and a small read on the storage.
+	 * Falls back to reading directly if the buffer cannot be allocated.
+	 * @return number of bytes read (0 at EOF), <0 on error (errno is set)
+	 */
+	int _read_session_file(uint32_t offset, uint8_t *dst, int len);
+
+	/** drop the read-ahead data, e.g. when the session file changes */
+	void _invalidate_read_ahead() { _read_ahead_size = 0; }
+
 	static const char	kDirentFile = 'F';	///< Identifies File returned from List command
 	static const char	kDirentDir = 'D';	///< Identifies Directory returned from List command
 	static const char	kDirentSkip = 'S';	///< Identifies Skipped entry from List command
@@ -163,6 +176,13 @@ private:
 	/// @brief Maximum data size in RequestHeader::data
 	static const uint8_t	kMaxDataLength = MAVLINK_MSG_FILE_TRANSFER_PROTOCOL_FIELD_PAYLOAD_LEN - sizeof(PayloadHeader);
 
+	/// @brief Default number of bytes sent in a burst before burst_complete is set (determined empirically)
+	static const uint32_t	kBurstWindowDefault = 35000;
+	static const uint32_t	kBurstWindowMax = 1024 * 1024;
+
+	/// @brief Maximum number of packets that can be requested with a kCmdBurstReadMissing command
+	static const uint8_t	kMaxBurstResend = 16;
+
 	struct SessionInfo {
 		int		fd;
 		uint32_t	file_size;
@@ -171,6 +191,11 @@ private:
 		uint16_t	stream_seq_number;
 		uint8_t		stream_target_system_id;
 		unsigned	stream_chunk_transmitted;
+		uint32_t	stream_window;		///< number of bytes sent before the burst is completed
+		uint32_t	stream_resend[kMaxBurstResend]; ///< offsets of packets to resend before continuing the stream
+		uint8_t		stream_resend_count;
+		uint8_t		stream_resend_index;	///< next entry of stream_resend to send
+		bool		stream_resend_only;	///< complete the burst once the resend queue is sent
 	};
 	struct SessionInfo _session_info;	///< Session info, fd=-1 for no active session
 
@@ -190,6 +215,12 @@ private:
 	static constexpr int _work_buffer2_len = 256;
 	hrt_abstime _last_work_buffer_access; ///< timestamp when the buffers were last accessed
 
+	/* read-ahead buffer for file downloads, allocated on the first read and freed with the work buffers */
+	uint8_t *_read_ahead_buffer;
+	static constexpr int _read_ahead_buffer_len = 2048; ///< multiple of the sector size
+	uint32_t _read_ahead_offset; ///< file offset of the buffered data
+	int _read_ahead_size; ///< number of valid bytes in _read_ahead_buffer
+
 	// prepend a root directory to each file/dir access to avoid enumerating the full FS tree (e.g. on Linux).
 	// Note that requests can still fall outside of the root dir by using ../..
 #ifdef MAVLINK_FTP_UNIT_TEST
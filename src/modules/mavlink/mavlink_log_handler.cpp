@@ -37,14 +37,19 @@
 #include "mavlink_log_handler.h"
 #include "mavlink_main.h"
 #include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <time.h>
 
 #define MOUNTPOINT PX4_ROOTFSDIR "/fs/microsd"
 
 static const char *kLogRoot    = MOUNTPOINT "/log";
+static const char *kLogIndex   = MOUNTPOINT "/log/logindex.txt"; // maintained by the logger, see LogWriterFile
 static const char *kLogData    = MOUNTPOINT "/logdata.txt";
 static const char *kTmpData    = MOUNTPOINT "/$log$.txt";
 
+static const size_t kReadAheadSize = 2048;
+
 #ifdef __PX4_NUTTX
 #define PX4LOG_REGULAR_FILE DTYPE_FILE
 #define PX4LOG_DIRECTORY    DTYPE_DIRECTORY
@@ -341,7 +346,12 @@ LogListHelper::LogListHelper()
 	, current_log_size(0)
 	, current_log_data_offset(0)
 	, current_log_data_remaining(0)
-	, current_log_filep(nullptr)
+	, current_log_fd(-1)
+	, _index_filep(nullptr)
+	, _index_line(0)
+	, _read_buffer(nullptr)
+	, _read_buffer_offset(0)
+	, _read_buffer_size(0)
 {
 	_init();
 }
@@ -349,8 +359,17 @@ LogListHelper::LogListHelper()
 //-------------------------------------------------------------------
 LogListHelper::~LogListHelper()
 {
-	// Remove log data files (if any)
-	unlink(kLogData);
+	if (_index_filep) {
+		::fclose(_index_filep);
+	}
+
+	if (current_log_fd >= 0) {
+		::close(current_log_fd);
+	}
+
+	delete[] _read_buffer;
+
+	// Remove temp file (if any)
 	unlink(kTmpData);
 }
 
@@ -358,53 +377,66 @@ LogListHelper::~LogListHelper()
 bool
 LogListHelper::get_entry(int idx, uint32_t &size, uint32_t &date, char *filename, int filename_len)
 {
-	//-- Find log file in log list file created during init()
+	//-- Find log file in the log index
 	size = 0;
 	date = 0;
-	bool result = false;
-	//-- Open list of log files
-	FILE *f = ::fopen(kLogData, "r");
-
-	if (f) {
-		//--- Find requested entry
-		char line[160];
-		int count = 0;
-
-		while (fgets(line, sizeof(line), f)) {
-			//-- Found our "index"
-			if (count++ == idx) {
-				char file[160];
-
-				if (sscanf(line, "%u %u %s", &date, &size, file) == 3) {
-					if (filename && filename_len > 0) {
-						strncpy(filename, file, filename_len);
-						filename[filename_len - 1] = 0; // ensure null-termination
-					}
 
-					result = true;
-					break;
-				}
-			}
+	if (idx < 0 || idx >= log_count) {
+		return false;
+	}
+
+	//-- Entries are mostly requested in order: only start over for earlier ones
+	if (_index_filep && idx < _index_line) {
+		::fclose(_index_filep);
+		_index_filep = nullptr;
+	}
+
+	if (!_index_filep) {
+		_index_filep = ::fopen(kLogIndex, "r");
+		_index_line = 0;
+
+		if (!_index_filep) {
+			return false;
 		}
+	}
+
+	//--- Find requested entry
+	char line[160];
+
+	while (fgets(line, sizeof(line), _index_filep)) {
+		//-- Found our "index"
+		if (_index_line++ == idx) {
+			char file[160];
+
+			if (sscanf(line, "%u %u %s", &date, &size, file) != 3) {
+				return false;
+			}
 
-		fclose(f);
+			if (filename && filename_len > 0) {
+				strncpy(filename, file, filename_len);
+				filename[filename_len - 1] = 0; // ensure null-termination
+			}
+
+			return true;
+		}
 	}
 
-	return result;
+	return false;
 }
 
 //-------------------------------------------------------------------
 bool
 LogListHelper::open_for_transmit()
 {
-	if (current_log_filep) {
-		::fclose(current_log_filep);
-		current_log_filep = nullptr;
+	if (current_log_fd >= 0) {
+		::close(current_log_fd);
+		current_log_fd = -1;
 	}
 
-	current_log_filep = ::fopen(current_log_filename, "rb");
+	_read_buffer_size = 0;
+	current_log_fd = ::open(current_log_filename, O_RDONLY);
 
-	if (!current_log_filep) {
+	if (current_log_fd < 0) {
 		PX4LOG_WARN("MavlinkLogHandler::open_for_transmit Could not open %s\n", current_log_filename);
 		return false;
 	}
@@ -420,21 +452,46 @@ LogListHelper::get_log_data(uint8_t len, uint8_t *buffer)
 		return 0;
 	}
 
-	if (!current_log_filep) {
+	if (current_log_fd < 0) {
 		PX4LOG_WARN("MavlinkLogHandler::get_log_data file not open %s\n", current_log_filename);
 		return 0;
 	}
 
-	long int offset = current_log_data_offset - ftell(current_log_filep);
+	//-- Refill the read-ahead buffer unless it holds the requested data
+	if (current_log_data_offset < _read_buffer_offset ||
+	    current_log_data_offset + len > _read_buffer_offset + _read_buffer_size) {
 
-	if (offset && fseek(current_log_filep, offset, SEEK_CUR)) {
-		fclose(current_log_filep);
-		current_log_filep = nullptr;
-		PX4LOG_WARN("MavlinkLogHandler::get_log_data Seek error in %s\n", current_log_filename);
-		return 0;
+		if (!_read_buffer) {
+			_read_buffer = new uint8_t[kReadAheadSize];
+
+			if (!_read_buffer) {
+				return 0;
+			}
+		}
+
+		_read_buffer_size = 0;
+
+		if (lseek(current_log_fd, current_log_data_offset, SEEK_SET) < 0) {
+			::close(current_log_fd);
+			current_log_fd = -1;
+			PX4LOG_WARN("MavlinkLogHandler::get_log_data Seek error in %s\n", current_log_filename);
+			return 0;
+		}
+
+		ssize_t bytes_read = ::read(current_log_fd, _read_buffer, kReadAheadSize);
+
+		if (bytes_read < 0) {
+			PX4LOG_WARN("MavlinkLogHandler::get_log_data Read error in %s\n", current_log_filename);
+			return 0;
+		}
+
+		_read_buffer_offset = current_log_data_offset;
+		_read_buffer_size = bytes_read;
 	}
 
-	size_t result = fread(buffer, 1, len, current_log_filep);
+	size_t available = _read_buffer_offset + _read_buffer_size - current_log_data_offset;
+	size_t result = len < available ? len : available;
+	memcpy(buffer, _read_buffer + (current_log_data_offset - _read_buffer_offset), result);
 	return result;
 }
 
@@ -444,14 +501,20 @@ LogListHelper::_init()
 {
 	/*
 
-		When this helper is created, it scans the log directory
-		and collects all log files found into one file for easy,
-		subsequent access.
+		When this helper is created, it uses the log index if there
+		is one. The logger appends every new log to it.
+		Otherwise it scans the log directory and collects all log
+		files into a new index for easy, subsequent access.
 	*/
 
 	current_log_filename[0] = 0;
-	// Remove old log data file (if any)
+	// Remove the log data file of older versions (if any)
 	unlink(kLogData);
+
+	if (_load_index()) {
+		return;
+	}
+
 	// Open log directory
 	DIR *dp = opendir(kLogRoot);
 
@@ -490,13 +553,35 @@ LogListHelper::_init()
 	closedir(dp);
 	fclose(f);
 
-	// Rename temp file to data file
-	if (rename(kTmpData, kLogData)) {
+	// Rename temp file to index
+	if (rename(kTmpData, kLogIndex)) {
 		PX4LOG_WARN("MavlinkLogHandler::init Error renaming %s\n", kTmpData);
 		log_count = 0;
 	}
 }
 
+//-------------------------------------------------------------------
+bool
+LogListHelper::_load_index()
+{
+	FILE *f = ::fopen(kLogIndex, "r");
+
+	if (!f) {
+		return false;
+	}
+
+	//-- One entry per line
+	char line[160];
+	log_count = 0;
+
+	while (fgets(line, sizeof(line), f)) {
+		log_count++;
+	}
+
+	fclose(f);
+	return true;
+}
+
 //-------------------------------------------------------------------
 bool
 LogListHelper::_get_session_date(const char *path, const char *dir, time_t &date)
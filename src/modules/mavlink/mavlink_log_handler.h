@@ -77,14 +77,21 @@ public:
 	uint32_t    current_log_size;
 	uint32_t    current_log_data_offset;
 	uint32_t    current_log_data_remaining;
-	FILE       *current_log_filep;
+	int         current_log_fd;
 	char        current_log_filename[128];
 
 private:
 	void        _init();
+	bool        _load_index();
 	bool        _get_session_date(const char *path, const char *dir, time_t &date);
 	void        _scan_logs(FILE *f, const char *dir, time_t &date);
 	bool        _get_log_time_size(const char *path, const char *file, time_t &date, uint32_t &size);
+
+	FILE       *_index_filep;           ///< log index, kept open for sequential access in get_entry()
+	int         _index_line;            ///< index of the next line read from _index_filep
+	uint8_t    *_read_buffer;           ///< read-ahead buffer for the current log
+	uint32_t    _read_buffer_offset;    ///< file offset of _read_buffer
+	size_t      _read_buffer_size;      ///< number of valid bytes in _read_buffer
 };
 
 // MAVLink LOG_* Message Handler
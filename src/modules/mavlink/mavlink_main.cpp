@@ -52,12 +52,14 @@
 #include <errno.h>
 #include <assert.h>
 #include <math.h>
+#include <float.h>
 #include <poll.h>
 #include <termios.h>
 #include <time.h>
 
 #ifdef __PX4_POSIX
 #include <net/if.h>
+#include <netinet/tcp.h>
 #endif
 
 #include <sys/ioctl.h>
@@ -73,6 +75,7 @@
 #include <systemlib/perf_counter.h>
 #include <systemlib/systemlib.h>
 #include <systemlib/mavlink_log.h>
+#include <systemlib/trace.h>
 #include <geo/geo.h>
 #include <dataman/dataman.h>
 #include <version/version.h>
@@ -83,6 +86,7 @@
 
 #include "mavlink_bridge_header.h"
 #include "mavlink_main.h"
+#include "mavlink_routing.h"
 #include "mavlink_messages.h"
 #include "mavlink_receiver.h"
 #include "mavlink_rate_limiter.h"
@@ -107,6 +111,9 @@
 
 static Mavlink *_mavlink_instances = nullptr;
 
+/* routes to the systems and components behind each instance, learned from heartbeats */
+static MavlinkRoutingTable _routing_table;
+
 /**
  * mavlink app start / stop handling function
  *
@@ -209,7 +216,10 @@ Mavlink::Mavlink() :
 	_received_messages(false),
 	_main_loop_delay(1000),
 	_subscriptions(nullptr),
+	_subscriptions_released(0),
 	_streams(nullptr),
+	_stream_scheduler(),
+	_stream_schedule_invalid(true),
 	_mavlink_shell(nullptr),
 	_mavlink_ulog(nullptr),
 	_mavlink_ulog_stop_requested(false),
@@ -219,14 +229,18 @@ Mavlink::Mavlink() :
 	_logbuffer(5, sizeof(mavlink_log_s)),
 	_total_counter(0),
 	_receive_thread{},
+	_receiver(nullptr),
 	_verbose(false),
 	_forwarding_on(false),
 	_ftp_on(false),
 	_uart_fd(-1),
+	_uart_buf{},
+	_uart_buf_len(0),
 	_baudrate(57600),
 	_datarate(1000),
 	_datarate_events(500),
 	_rate_mult(1.0f),
+	_rate_mult_priority{1.0f, 1.0f, 1.0f},
 	_last_hw_rate_timestamp(0),
 	_mavlink_param_queue_index(0),
 	mavlink_link_termination_allowed(false),
@@ -256,6 +270,17 @@ Mavlink::Mavlink() :
 	_broadcast_failed_warned(false),
 	_network_buf{},
 	_network_buf_len(0),
+	_tcp_listen_fd(-1),
+	_tcp_connecting_fd(-1),
+	_tcp_nodelay(true),
+	_tcp_last_connect_time(0),
+	_tcp_tx_pending{},
+	_tcp_tx_pending_len(0),
+#ifdef MAVLINK_UDP_BATCHING
+	_network_queue{},
+	_network_queue_len{},
+	_network_queue_count(0),
+#endif
 #endif
 	_socket_fd(-1),
 	_protocol(SERIAL),
@@ -264,6 +289,8 @@ Mavlink::Mavlink() :
 	_rstatus {},
 	_message_buffer {},
 	_message_buffer_mutex {},
+	_forward_broadcast_budget(0.0f),
+	_forward_broadcast_time(0),
 	_send_mutex {},
 	_param_initialized(false),
 	_broadcast_mode(Mavlink::BROADCAST_MODE_OFF),
@@ -331,6 +358,7 @@ Mavlink::~Mavlink()
 {
 	perf_free(_loop_perf);
 	perf_free(_txerr_perf);
+	_routing_table.remove_link(this);
 
 	if (_task_running) {
 		/* task wakes up every 10ms or so at the longest */
@@ -479,7 +507,7 @@ Mavlink::destroy_all_instances()
 }
 
 int
-Mavlink::get_status_all_instances()
+Mavlink::get_status_all_instances(bool show_streams_status, bool show_messages_status)
 {
 	Mavlink *inst = ::_mavlink_instances;
 
@@ -490,6 +518,14 @@ Mavlink::get_status_all_instances()
 		printf("\ninstance #%u:\n", iterations);
 		inst->display_status();
 
+		if (show_streams_status) {
+			inst->display_status_streams();
+		}
+
+		if (show_messages_status) {
+			inst->display_status_messages();
+		}
+
 		/* move on */
 		inst = inst->next;
 		iterations++;
@@ -546,21 +582,46 @@ Mavlink::instance_exists(const char *device_name, Mavlink *self)
 void
 Mavlink::forward_message(const mavlink_message_t *msg, Mavlink *self)
 {
+	const mavlink_msg_entry_t *meta = mavlink_get_msg_entry(msg->msgid);
+
+	if (meta == nullptr) {
+		return;
+	}
+
+	// Extract target system and target component if set (the offsets are relative to the payload)
+	const uint8_t *payload = (const uint8_t *)_MAV_PAYLOAD(msg);
+	unsigned target_system_id = (meta->target_system_ofs != 0) ? payload[meta->target_system_ofs] : 0;
+	unsigned target_component_id = (meta->target_component_ofs != 0) ? payload[meta->target_component_ofs] : 233;
+
+	// Broadcast or addressing this system and not trying to talk
+	// to the autopilot component -> pass on to other components
+	bool forward = (target_system_id == 0 || target_system_id == self->get_system_id())
+		       && (target_component_id == 0 || target_component_id != self->get_component_id());
+
+	bool broadcast = target_system_id == 0;
+	const hrt_abstime now = hrt_absolute_time();
+
 	Mavlink *inst;
 	LL_FOREACH(_mavlink_instances, inst) {
 		if (inst != self) {
-			const mavlink_msg_entry_t *meta = mavlink_get_msg_entry(msg->msgid);
 
-			// Extract target system and target component if set
-			unsigned target_system_id = (meta->target_system_ofs != 0) ? ((uint8_t *)msg)[meta->target_system_ofs] : 0;
-			unsigned target_component_id = (meta->target_component_ofs != 0) ? ((uint8_t *)msg)[meta->target_component_ofs] : 233;
+			if (broadcast) {
+				// rate-limited per link
+				if (forward) {
+					inst->pass_message(msg, true);
+				}
+
+				continue;
+			}
 
-			// Broadcast or addressing this system and not trying to talk
-			// to the autopilot component -> pass on to other components
-			if ((target_system_id == 0 || target_system_id == self->get_system_id())
-			    && (target_component_id == 0 || target_component_id != self->get_component_id())) {
+			// targeted message: only send it to the link(s) the target is known on,
+			// or to all links as long as the target is unknown
+			unsigned component_id = (meta->target_component_ofs != 0) ? target_component_id : 0;
+			bool known;
+			bool route = _routing_table.has_route(target_system_id, component_id, inst, now, known);
 
-				inst->pass_message(msg);
+			if (route || (!known && forward)) {
+				inst->pass_message(msg, false);
 			}
 		}
 	}
@@ -611,6 +672,9 @@ void Mavlink::mavlink_update_system()
 
 		/* test param - needs to be referenced, but is unused */
 		(void)param_find("MAV_TEST_PAR");
+
+		/* read when the shell is started */
+		(void)param_find("MAV_SH_DIFF");
 	}
 
 	/* update system and component id */
@@ -964,6 +1028,26 @@ Mavlink::begin_send()
 	pthread_mutex_lock(&_send_mutex);
 }
 
+bool
+Mavlink::udp_broadcast_required()
+{
+	struct telemetry_status_s &tstatus = get_rx_status();
+
+	/* resend message via broadcast if no valid connection exists */
+	if ((_mode != MAVLINK_MODE_ONBOARD) && broadcast_enabled() &&
+	    (!get_client_source_initialized()
+	     || (hrt_elapsed_time(&tstatus.heartbeat_time) > 3 * 1000 * 1000))) {
+
+		if (!_broadcast_address_found) {
+			find_broadcast_address();
+		}
+
+		return _broadcast_address_found;
+	}
+
+	return false;
+}
+
 int
 Mavlink::send_packet()
 {
@@ -979,41 +1063,45 @@ Mavlink::send_packet()
 
 	if (get_protocol() == UDP) {
 
+#ifdef MAVLINK_UDP_BATCHING
+		/* the packet was written into the queue slot by send_bytes(), it is sent with the next flush */
+		_network_queue_len[_network_queue_count] = _network_buf_len;
+		ret = _network_buf_len;
+
+		if (++_network_queue_count == NETWORK_QUEUE_SIZE) {
+			send_network_queue();
+		}
 
+#else
 		ret = sendto(_socket_fd, _network_buf, _network_buf_len, 0,
 			     (struct sockaddr *)&_src_addr, sizeof(_src_addr));
 
-		struct telemetry_status_s &tstatus = get_rx_status();
-
-		/* resend message via broadcast if no valid connection exists */
-		if ((_mode != MAVLINK_MODE_ONBOARD) && broadcast_enabled() &&
-		    (!get_client_source_initialized()
-		     || (hrt_elapsed_time(&tstatus.heartbeat_time) > 3 * 1000 * 1000))) {
+		if (udp_broadcast_required()) {
 
-			if (!_broadcast_address_found) {
-				find_broadcast_address();
-			}
-
-			if (_broadcast_address_found && _network_buf_len > 0) {
-
-				int bret = sendto(_socket_fd, _network_buf, _network_buf_len, 0,
-						  (struct sockaddr *)&_bcast_addr, sizeof(_bcast_addr));
+			int bret = sendto(_socket_fd, _network_buf, _network_buf_len, 0,
+					  (struct sockaddr *)&_bcast_addr, sizeof(_bcast_addr));
 
-				if (bret <= 0) {
-					if (!_broadcast_failed_warned) {
-						PX4_ERR("sending broadcast failed, errno: %d: %s", errno, strerror(errno));
-						_broadcast_failed_warned = true;
-					}
-
-				} else {
-					_broadcast_failed_warned = false;
+			if (bret <= 0) {
+				if (!_broadcast_failed_warned) {
+					PX4_ERR("sending broadcast failed, errno: %d: %s", errno, strerror(errno));
+					_broadcast_failed_warned = true;
 				}
+
+			} else {
+				_broadcast_failed_warned = false;
 			}
 		}
 
+#endif /* MAVLINK_UDP_BATCHING */
+
 	} else if (get_protocol() == TCP) {
-		/* not implemented, but possible to do so */
-		PX4_ERR("TCP transport pending implementation");
+		ret = tcp_send(_network_buf, _network_buf_len);
+
+		/* count dropped packets as tx errors to reduce the stream rates (but not while disconnected) */
+		if (ret < 0 && _socket_fd >= 0) {
+			count_txerr();
+			count_txerrbytes(_network_buf_len);
+		}
 	}
 
 	_network_buf_len = 0;
@@ -1023,6 +1111,109 @@ Mavlink::send_packet()
 	return ret;
 }
 
+void
+Mavlink::flush_send_buffers()
+{
+	pthread_mutex_lock(&_send_mutex);
+
+	if (_uart_buf_len > 0) {
+		write_uart_buf();
+	}
+
+#ifdef MAVLINK_UDP_BATCHING
+
+	if (_network_queue_count > 0) {
+		send_network_queue();
+	}
+
+#endif
+
+	pthread_mutex_unlock(&_send_mutex);
+}
+
+void
+Mavlink::write_uart_buf()
+{
+	ssize_t ret = ::write(_uart_fd, _uart_buf, _uart_buf_len);
+
+	if (ret != (ssize_t)_uart_buf_len) {
+		count_txerr();
+		count_txerrbytes(_uart_buf_len);
+
+	} else {
+		_last_write_success_time = hrt_absolute_time();
+		count_txbytes(_uart_buf_len);
+	}
+
+	_uart_buf_len = 0;
+}
+
+#ifdef MAVLINK_UDP_BATCHING
+void
+Mavlink::send_network_queue()
+{
+	/* the broadcast copies go in a separate batch, so that a failing broadcast does not drop the unicast datagrams */
+	struct mmsghdr msgs[NETWORK_QUEUE_SIZE];
+	struct mmsghdr bcast_msgs[NETWORK_QUEUE_SIZE];
+	struct iovec iovs[NETWORK_QUEUE_SIZE];
+	const bool broadcast = udp_broadcast_required();
+	const unsigned num_msgs = _network_queue_count;
+
+	memset(msgs, 0, sizeof(msgs));
+	memset(bcast_msgs, 0, sizeof(bcast_msgs));
+
+	for (unsigned i = 0; i < num_msgs; ++i) {
+		iovs[i].iov_base = _network_queue[i];
+		iovs[i].iov_len = _network_queue_len[i];
+
+		msgs[i].msg_hdr.msg_name = &_src_addr;
+		msgs[i].msg_hdr.msg_namelen = sizeof(_src_addr);
+		msgs[i].msg_hdr.msg_iov = &iovs[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+
+		bcast_msgs[i].msg_hdr.msg_name = &_bcast_addr;
+		bcast_msgs[i].msg_hdr.msg_namelen = sizeof(_bcast_addr);
+		bcast_msgs[i].msg_hdr.msg_iov = &iovs[i];
+		bcast_msgs[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	_network_queue_count = 0;
+
+	send_network_batch(msgs, num_msgs);
+
+	if (broadcast) {
+		if (send_network_batch(bcast_msgs, num_msgs)) {
+			_broadcast_failed_warned = false;
+
+		} else if (!_broadcast_failed_warned) {
+			PX4_ERR("sending broadcast failed, errno: %d: %s", errno, strerror(errno));
+			_broadcast_failed_warned = true;
+		}
+	}
+}
+
+bool
+Mavlink::send_network_batch(struct mmsghdr *msgs, unsigned num_msgs)
+{
+	unsigned num_sent = 0;
+	bool success = true;
+
+	while (num_sent < num_msgs) {
+		int ret = sendmmsg(_socket_fd, &msgs[num_sent], num_msgs - num_sent, 0);
+
+		if (ret <= 0) {
+			/* the failed datagram is dropped, as with sendto(), continue with the next one */
+			success = false;
+			ret = 1;
+		}
+
+		num_sent += ret;
+	}
+
+	return success;
+}
+#endif /* MAVLINK_UDP_BATCHING */
+
 void
 Mavlink::send_bytes(const uint8_t *buf, unsigned packet_len)
 {
@@ -1032,6 +1223,8 @@ Mavlink::send_bytes(const uint8_t *buf, unsigned packet_len)
 		return;
 	}
 
+	TRACE_EVENT(TRACE_EVENT_MAVLINK_SEND, buf[0] == MAVLINK_STX_MAVLINK1 ? buf[5] : buf[7] | (buf[8] << 8), packet_len);
+
 	_last_write_try_time = hrt_absolute_time();
 
 	if (_mavlink_start_time == 0) {
@@ -1039,33 +1232,51 @@ Mavlink::send_bytes(const uint8_t *buf, unsigned packet_len)
 	}
 
 	if (get_protocol() == SERIAL) {
-		/* check if there is space in the buffer, let it overflow else */
+		/* check if there is space in the buffer (the collected bytes included), let it overflow else */
 		unsigned buf_free = get_free_tx_buf();
 
-		if (buf_free < packet_len) {
+		if (buf_free < _uart_buf_len + packet_len && _uart_buf_len > 0) {
+			/* write the collected bytes first, the driver might have room for this packet afterwards */
+			write_uart_buf();
+			buf_free = get_free_tx_buf();
+		}
+
+		if (buf_free < _uart_buf_len + packet_len) {
 			/* not enough space in buffer to send */
 			count_txerr();
 			count_txerrbytes(packet_len);
 			return;
 		}
+
+		/* collect the bytes, they are written to the UART with one write() by flush_send_buffers() */
+		if (_uart_buf_len + packet_len > sizeof(_uart_buf)) {
+			write_uart_buf();
+		}
+
+		memcpy(&_uart_buf[_uart_buf_len], buf, packet_len);
+		_uart_buf_len += packet_len;
+		return;
 	}
 
 	size_t ret = -1;
 
-	/* send message to UART */
-	if (get_protocol() == SERIAL) {
-		ret = ::write(_uart_fd, buf, packet_len);
+#ifdef __PX4_POSIX
+	/* UDP datagrams are assembled directly in the queue slot, to save a copy in send_packet() */
+	uint8_t *network_buf = _network_buf;
+
+#ifdef MAVLINK_UDP_BATCHING
+
+	if (get_protocol() == UDP) {
+		network_buf = _network_queue[_network_queue_count];
 	}
 
-#ifdef __PX4_POSIX
+#endif
 
-	else {
-		if (_network_buf_len + packet_len < sizeof(_network_buf) / sizeof(_network_buf[0])) {
-			memcpy(&_network_buf[_network_buf_len], buf, packet_len);
-			_network_buf_len += packet_len;
+	if (_network_buf_len + packet_len < MAVLINK_MAX_PACKET_LEN) {
+		memcpy(&network_buf[_network_buf_len], buf, packet_len);
+		_network_buf_len += packet_len;
 
-			ret = packet_len;
-		}
+		ret = packet_len;
 	}
 
 #endif
@@ -1260,9 +1471,236 @@ Mavlink::init_udp()
 #endif
 }
 
+#ifdef __PX4_POSIX
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0 // SO_NOSIGPIPE is set instead
+#endif
+
+void
+Mavlink::init_tcp()
+{
+#if defined (__PX4_LINUX) || defined (__PX4_DARWIN)
+
+	if (_src_addr_initialized) {
+		/* client mode: connect to the partner */
+		PX4_DEBUG("Setting up TCP client to %s:%d", inet_ntoa(_src_addr.sin_addr), _network_port);
+		_src_addr.sin_port = htons(_network_port);
+
+		/* messages are only accepted once connected */
+		_src_addr_initialized = false;
+		tcp_update_connection();
+		return;
+	}
+
+	PX4_DEBUG("Setting up TCP server with port %d", _network_port);
+
+	_myaddr.sin_family = AF_INET;
+	_myaddr.sin_addr.s_addr = htonl(INADDR_ANY);
+	_myaddr.sin_port = htons(_network_port);
+
+	if ((_tcp_listen_fd = socket(AF_INET, SOCK_STREAM, 0)) < 0) {
+		PX4_WARN("create socket failed: %s", strerror(errno));
+		return;
+	}
+
+	int reuse = 1;
+	setsockopt(_tcp_listen_fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+	if (bind(_tcp_listen_fd, (struct sockaddr *)&_myaddr, sizeof(_myaddr)) < 0 || listen(_tcp_listen_fd, 1) < 0) {
+		PX4_WARN("bind/listen failed: %s", strerror(errno));
+		close(_tcp_listen_fd);
+		_tcp_listen_fd = -1;
+		return;
+	}
+
+	fcntl(_tcp_listen_fd, F_SETFL, fcntl(_tcp_listen_fd, F_GETFL, 0) | O_NONBLOCK);
+
+#endif
+}
+
+void
+Mavlink::tcp_update_connection()
+{
+#if defined (__PX4_LINUX) || defined (__PX4_DARWIN)
+
+	if (_socket_fd >= 0) {
+		return;
+	}
+
+	if (_tcp_listen_fd >= 0) {
+		/* server mode */
+		struct sockaddr_in addr;
+		socklen_t addrlen = sizeof(addr);
+		int fd = accept(_tcp_listen_fd, (struct sockaddr *)&addr, &addrlen);
+
+		if (fd >= 0) {
+			PX4_INFO("TCP connection from %s", inet_ntoa(addr.sin_addr));
+			tcp_set_connection(fd);
+		}
+
+		return;
+	}
+
+	/* client mode */
+	if (_tcp_connecting_fd >= 0) {
+		struct pollfd fds = {};
+		fds.fd = _tcp_connecting_fd;
+		fds.events = POLLOUT;
+
+		if (poll(&fds, 1, 0) <= 0) {
+			if (hrt_elapsed_time(&_tcp_last_connect_time) > TCP_CONNECT_INTERVAL) {
+				/* timed out, retry */
+				close(_tcp_connecting_fd);
+				_tcp_connecting_fd = -1;
+			}
+
+			return;
+		}
+
+		int error = 0;
+		socklen_t len = sizeof(error);
+
+		if (getsockopt(_tcp_connecting_fd, SOL_SOCKET, SO_ERROR, &error, &len) == 0 && error == 0) {
+			PX4_INFO("TCP connected to %s:%d", inet_ntoa(_src_addr.sin_addr), _network_port);
+			tcp_set_connection(_tcp_connecting_fd);
+
+		} else {
+			close(_tcp_connecting_fd);
+		}
+
+		_tcp_connecting_fd = -1;
+		return;
+	}
+
+	if (_tcp_last_connect_time != 0 && hrt_elapsed_time(&_tcp_last_connect_time) < TCP_CONNECT_INTERVAL) {
+		return;
+	}
+
+	_tcp_last_connect_time = hrt_absolute_time();
+
+	int fd = socket(AF_INET, SOCK_STREAM, 0);
+
+	if (fd < 0) {
+		PX4_WARN("create socket failed: %s", strerror(errno));
+		return;
+	}
+
+	fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+
+	if (connect(fd, (struct sockaddr *)&_src_addr, sizeof(_src_addr)) == 0) {
+		tcp_set_connection(fd);
+
+	} else if (errno == EINPROGRESS) {
+		_tcp_connecting_fd = fd;
+
+	} else {
+		close(fd);
+	}
+
+#endif
+}
+
+void
+Mavlink::tcp_set_connection(int fd)
+{
+	fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+
+	int nodelay = _tcp_nodelay ? 1 : 0;
+
+	if (setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay)) < 0) {
+		PX4_WARN("setting TCP_NODELAY failed: %s", strerror(errno));
+	}
+
+	/* a larger send buffer allows bulk transfers (log download, FTP) to use the full link */
+	int send_buffer_size = TCP_SEND_BUFFER_SIZE;
+	setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &send_buffer_size, sizeof(send_buffer_size));
+
+#ifdef SO_NOSIGPIPE
+	int nosigpipe = 1;
+	setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &nosigpipe, sizeof(nosigpipe));
+#endif
+
+	pthread_mutex_lock(&_send_mutex);
+	_tcp_tx_pending_len = 0;
+	_socket_fd = fd;
+	_src_addr_initialized = true;
+	pthread_mutex_unlock(&_send_mutex);
+}
+
+int
+Mavlink::tcp_send(const uint8_t *buf, unsigned len)
+{
+	if (_socket_fd < 0) {
+		return -1;
+	}
+
+	/* complete a partially sent packet first */
+	if (_tcp_tx_pending_len > 0) {
+		ssize_t n = ::send(_socket_fd, _tcp_tx_pending, _tcp_tx_pending_len, MSG_NOSIGNAL);
+
+		if (n < 0) {
+			if (errno != EAGAIN) {
+				tcp_close_connection_locked();
+			}
+
+			return -1;
+		}
+
+		_tcp_tx_pending_len -= n;
+		memmove(_tcp_tx_pending, &_tcp_tx_pending[n], _tcp_tx_pending_len);
+
+		if (_tcp_tx_pending_len > 0) {
+			return -1;
+		}
+	}
+
+	ssize_t n = ::send(_socket_fd, buf, len, MSG_NOSIGNAL);
+
+	if (n < 0) {
+		if (errno != EAGAIN) {
+			tcp_close_connection_locked();
+		}
+
+		return -1;
+	}
+
+	if ((unsigned)n < len) {
+		_tcp_tx_pending_len = len - n;
+		memcpy(_tcp_tx_pending, &buf[n], _tcp_tx_pending_len);
+	}
+
+	return len;
+}
+
+void
+Mavlink::tcp_close_connection()
+{
+	pthread_mutex_lock(&_send_mutex);
+	tcp_close_connection_locked();
+	pthread_mutex_unlock(&_send_mutex);
+}
+
+void
+Mavlink::tcp_close_connection_locked()
+{
+	if (_socket_fd >= 0) {
+		PX4_INFO("TCP connection closed");
+		close(_socket_fd);
+		_socket_fd = -1;
+		_tcp_tx_pending_len = 0;
+	}
+}
+
+#endif /* __PX4_POSIX */
+
 void
 Mavlink::handle_message(const mavlink_message_t *msg)
 {
+	if (msg->msgid == MAVLINK_MSG_ID_HEARTBEAT) {
+		_routing_table.learn(msg->sysid, msg->compid, this, hrt_absolute_time());
+	}
+
 	if (!accepting_commands()) {
 		return;
 	}
@@ -1363,7 +1801,7 @@ void Mavlink::send_protocol_version()
 	set_proto_version(curr_proto_ver);
 }
 
-MavlinkOrbSubscription *Mavlink::add_orb_subscription(const orb_id_t topic, int instance)
+MavlinkOrbSubscription *Mavlink::add_orb_subscription(const orb_id_t topic, int instance, bool shared)
 {
 	/* check if already subscribed to this topic */
 	MavlinkOrbSubscription *sub;
@@ -1376,7 +1814,7 @@ MavlinkOrbSubscription *Mavlink::add_orb_subscription(const orb_id_t topic, int
 	}
 
 	/* add new subscription */
-	MavlinkOrbSubscription *sub_new = new MavlinkOrbSubscription(topic, instance);
+	MavlinkOrbSubscription *sub_new = new MavlinkOrbSubscription(topic, instance, shared);
 
 	LL_APPEND(_subscriptions, sub_new);
 
@@ -1417,6 +1855,7 @@ Mavlink::configure_stream(const char *stream_name, const float rate)
 				delete stream;
 			}
 
+			_stream_schedule_invalid = true;
 			return OK;
 		}
 	}
@@ -1434,6 +1873,7 @@ Mavlink::configure_stream(const char *stream_name, const float rate)
 			stream = streams_list[i]->new_instance(this);
 			stream->set_interval(interval);
 			LL_APPEND(_streams, stream);
+			_stream_schedule_invalid = true;
 
 			return OK;
 		}
@@ -1475,6 +1915,8 @@ Mavlink::adjust_stream_rates(const float multiplier)
 			stream->set_interval(interval);
 		}
 	}
+
+	_stream_schedule_invalid = true;
 }
 
 void
@@ -1625,12 +2067,29 @@ Mavlink::message_buffer_mark_read(int n)
 }
 
 void
-Mavlink::pass_message(const mavlink_message_t *msg)
+Mavlink::pass_message(const mavlink_message_t *msg, bool broadcast)
 {
 	if (_forwarding_on) {
 		/* size is 8 bytes plus variable payload */
 		int size = MAVLINK_NUM_NON_PAYLOAD_BYTES + msg->len;
 		pthread_mutex_lock(&_message_buffer_mutex);
+
+		if (broadcast) {
+			/* refill the budget (at most 1 s worth) */
+			const float rate = _datarate * FORWARD_BROADCAST_SHARE;
+			const hrt_abstime now = hrt_absolute_time();
+
+			_forward_broadcast_budget = fminf(rate, _forward_broadcast_budget + rate * (now - _forward_broadcast_time) / 1e6f);
+			_forward_broadcast_time = now;
+
+			if (_forward_broadcast_budget < size) {
+				pthread_mutex_unlock(&_message_buffer_mutex);
+				return;
+			}
+
+			_forward_broadcast_budget -= size;
+		}
+
 		message_buffer_write(msg, size);
 		pthread_mutex_unlock(&_message_buffer_mutex);
 	}
@@ -1646,7 +2105,10 @@ MavlinkShell *
 Mavlink::get_shell()
 {
 	if (!_mavlink_shell) {
-		_mavlink_shell = new MavlinkShell();
+		int32_t screen_diff = 0;
+		param_get(param_find("MAV_SH_DIFF"), &screen_diff);
+
+		_mavlink_shell = new MavlinkShell(screen_diff != 0);
 
 		if (!_mavlink_shell) {
 			PX4_ERR("Failed to allocate a shell");
@@ -1679,15 +2141,19 @@ Mavlink::update_rate_mult()
 {
 	float const_rate = 0.0f;
 	float rate = 0.0f;
+	float priority_rate[MavlinkStream::PRIORITY_COUNT] = {};
 
 	/* scale down rates if their theoretical bandwidth is exceeding the link bandwidth */
 	MavlinkStream *stream;
 	LL_FOREACH(_streams, stream) {
+		float stream_rate = (stream->get_interval() > 0) ? stream->get_size_avg() * 1000000.0f / stream->get_interval() : 0;
+
 		if (stream->const_rate()) {
-			const_rate += (stream->get_interval() > 0) ? stream->get_size_avg() * 1000000.0f / stream->get_interval() : 0;
+			const_rate += stream_rate;
 
 		} else {
-			rate += (stream->get_interval() > 0) ? stream->get_size_avg() * 1000000.0f / stream->get_interval() : 0;
+			rate += stream_rate;
+			priority_rate[stream->get_priority()] += stream_rate;
 		}
 	}
 
@@ -1756,6 +2222,43 @@ Mavlink::update_rate_mult()
 
 	/* ensure the rate multiplier never drops below 5% so that something is always sent */
 	_rate_mult = fmaxf(0.05f, _rate_mult);
+
+	update_priority_rate_mult(priority_rate, rate);
+}
+
+void
+Mavlink::update_priority_rate_mult(const float priority_rate[MavlinkStream::PRIORITY_COUNT], float rate)
+{
+	float rate_mult[MavlinkStream::PRIORITY_COUNT];
+
+	if (_rate_mult >= 1.0f || rate <= 0.0f) {
+		/* enough bandwidth for all streams */
+		for (int i = 0; i < MavlinkStream::PRIORITY_COUNT; ++i) {
+			rate_mult[i] = _rate_mult;
+		}
+
+	} else {
+		/* the available bandwidth for the scaled streams, assigned from the highest priority down */
+		float budget = _rate_mult * rate;
+
+		for (int i = MavlinkStream::PRIORITY_COUNT - 1; i >= 0; --i) {
+			float mult = (priority_rate[i] > 0.0f) ? budget / priority_rate[i] : 1.0f;
+
+			/* same limits as for the overall multiplier */
+			mult = fmaxf(0.05f, fminf(1.0f, mult));
+			rate_mult[i] = mult;
+			budget = fmaxf(0.0f, budget - mult * priority_rate[i]);
+		}
+	}
+
+	for (int i = 0; i < MavlinkStream::PRIORITY_COUNT; ++i) {
+		if (fabsf(rate_mult[i] - _rate_mult_priority[i]) > FLT_EPSILON) {
+			_rate_mult_priority[i] = rate_mult[i];
+
+			/* the intervals changed */
+			_stream_schedule_invalid = true;
+		}
+	}
 }
 
 int
@@ -1787,7 +2290,7 @@ Mavlink::task_main(int argc, char *argv[])
 	int temp_int_arg;
 #endif
 
-	while ((ch = px4_getopt(argc, argv, "b:r:d:u:o:m:t:fvwx", &myoptind, &myoptarg)) != EOF) {
+	while ((ch = px4_getopt(argc, argv, "b:r:d:u:o:m:t:T:fvwxN", &myoptind, &myoptarg)) != EOF) {
 		switch (ch) {
 		case 'b':
 			_baudrate = strtoul(myoptarg, nullptr, 10);
@@ -1856,12 +2359,32 @@ Mavlink::task_main(int argc, char *argv[])
 			}
 
 			break;
+
+		case 'T':
+			temp_int_arg = strtoul(myoptarg, &eptr, 10);
+
+			if (*eptr == '\0') {
+				_network_port = temp_int_arg;
+				set_protocol(TCP);
+
+			} else {
+				PX4_ERR("invalid tcp port '%s'", myoptarg);
+				err_flag = true;
+			}
+
+			break;
+
+		case 'N':
+			_tcp_nodelay = false;
+			break;
 #else
 
 		case 'u':
 		case 'o':
 		case 't':
-			PX4_ERR("UDP options not supported on this platform");
+		case 'T':
+		case 'N':
+			PX4_ERR("UDP/TCP options not supported on this platform");
 			err_flag = true;
 			break;
 #endif
@@ -1965,6 +2488,15 @@ Mavlink::task_main(int argc, char *argv[])
 
 		PX4_INFO("mode: %s, data rate: %d B/s on udp port %hu remote port %hu",
 			 mavlink_mode_str(_mode), _datarate, _network_port, _remote_port);
+
+	} else if (get_protocol() == TCP) {
+		if (Mavlink::get_instance_for_network_port(_network_port) != nullptr) {
+			PX4_ERR("port %d already occupied", _network_port);
+			return PX4_ERROR;
+		}
+
+		PX4_INFO("mode: %s, data rate: %d B/s on tcp port %hu (%s)",
+			 mavlink_mode_str(_mode), _datarate, _network_port, _src_addr_initialized ? "client" : "server");
 	}
 
 	/* initialize send mutex */
@@ -1992,13 +2524,14 @@ Mavlink::task_main(int argc, char *argv[])
 	uint64_t param_time = 0;
 	MavlinkOrbSubscription *status_sub = add_orb_subscription(ORB_ID(vehicle_status));
 	uint64_t status_time = 0;
-	MavlinkOrbSubscription *ack_sub = add_orb_subscription(ORB_ID(vehicle_command_ack));
+	/* queued topics: every instance needs to get all the messages */
+	MavlinkOrbSubscription *ack_sub = add_orb_subscription(ORB_ID(vehicle_command_ack), 0, false);
 	uint64_t ack_time = 0;
 	/* We don't want to miss the first advertise of an ACK, so we subscribe from the
 	 * beginning and not just when the topic exists. */
 	ack_sub->subscribe_from_beginning(true);
 
-	MavlinkOrbSubscription *mavlink_log_sub = add_orb_subscription(ORB_ID(mavlink_log));
+	MavlinkOrbSubscription *mavlink_log_sub = add_orb_subscription(ORB_ID(mavlink_log), 0, false);
 
 	struct vehicle_status_s status;
 	status_sub->update(&status_time, &status);
@@ -2172,6 +2705,14 @@ Mavlink::task_main(int argc, char *argv[])
 		init_udp();
 	}
 
+#ifdef __PX4_POSIX
+
+	if (get_protocol() == TCP) {
+		init_tcp();
+	}
+
+#endif
+
 	/* if the protocol is serial, we send the system version blindly */
 	if (get_protocol() == SERIAL) {
 		send_autopilot_capabilites();
@@ -2181,8 +2722,22 @@ Mavlink::task_main(int argc, char *argv[])
 	MavlinkReceiver::receive_start(&_receive_thread, this);
 
 	while (!_task_should_exit) {
-		/* main loop */
-		usleep(_main_loop_delay);
+		/* main loop: sleep until the next stream is due, but at most for the main loop delay */
+		unsigned sleep_time = _main_loop_delay;
+		const hrt_abstime next_stream_update = _stream_scheduler.next_update_time();
+
+		if (!_stream_schedule_invalid && next_stream_update != 0) {
+			const hrt_abstime now = hrt_absolute_time();
+
+			if (next_stream_update < now + MAVLINK_MIN_INTERVAL) {
+				sleep_time = MAVLINK_MIN_INTERVAL;
+
+			} else if (next_stream_update - now < sleep_time) {
+				sleep_time = next_stream_update - now;
+			}
+		}
+
+		px4_usleep(sleep_time);
 
 		perf_begin(_loop_perf);
 
@@ -2197,6 +2752,14 @@ Mavlink::task_main(int argc, char *argv[])
 
 		check_radio_config();
 
+#ifdef __PX4_POSIX
+
+		if (get_protocol() == TCP) {
+			tcp_update_connection();
+		}
+
+#endif
+
 		if (status_sub->update(&status_time, &status)) {
 			/* switch HIL mode if required */
 			set_hil_enabled(status.hil_state == vehicle_status_s::HIL_STATE_ON);
@@ -2229,15 +2792,16 @@ Mavlink::task_main(int argc, char *argv[])
 			_logbuffer.put(&mavlink_log);
 		}
 
-		/* check for shell output */
-		if (_mavlink_shell && _mavlink_shell->available() > 0) {
-			if (get_free_tx_buf() >= MAVLINK_MSG_ID_SERIAL_CONTROL_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES) {
-				mavlink_serial_control_t msg;
+		/* check for shell output, sent in full messages unless the shell is idle */
+		if (_mavlink_shell && get_free_tx_buf() >= MAVLINK_MSG_ID_SERIAL_CONTROL_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES) {
+			mavlink_serial_control_t msg;
+			msg.count = _mavlink_shell->read_output(msg.data, sizeof(msg.data));
+
+			if (msg.count > 0) {
 				msg.baudrate = 0;
 				msg.flags = SERIAL_CONTROL_FLAG_REPLY;
 				msg.timeout = 0;
 				msg.device = SERIAL_CONTROL_DEV_SHELL;
-				msg.count = _mavlink_shell->read(msg.data, sizeof(msg.data));
 				mavlink_msg_serial_control_send_struct(get_channel(), &msg);
 			}
 		}
@@ -2254,7 +2818,7 @@ Mavlink::task_main(int argc, char *argv[])
 					_mavlink_ulog->start_ack_received();
 				}
 
-				int ret = _mavlink_ulog->handle_update(get_channel());
+				int ret = _mavlink_ulog->handle_update(get_channel(), _datarate);
 
 				if (ret < 0) { //abort the streaming on error
 					if (ret != -1) {
@@ -2301,10 +2865,20 @@ Mavlink::task_main(int argc, char *argv[])
 			_subscribe_to_stream = nullptr;
 		}
 
-		/* update streams */
-		MavlinkStream *stream;
-		LL_FOREACH(_streams, stream) {
-			stream->update(t);
+		/* update the streams that are due */
+		if (_stream_schedule_invalid) {
+			_stream_schedule_invalid = !_stream_scheduler.rebuild(_streams);
+		}
+
+		if (_stream_schedule_invalid) {
+			/* no schedule (out of memory): check all the streams */
+			MavlinkStream *stream;
+			LL_FOREACH(_streams, stream) {
+				stream->update(t);
+			}
+
+		} else {
+			_stream_scheduler.update(t, _main_loop_delay);
 		}
 
 		/* pass messages from other UARTs */
@@ -2355,6 +2929,9 @@ Mavlink::task_main(int argc, char *argv[])
 			}
 		}
 
+		/* send the packets collected during this iteration */
+		flush_send_buffers();
+
 		/* update TX/RX rates*/
 		if (t > _bytes_timestamp + 1000000) {
 			if (_bytes_timestamp != 0) {
@@ -2368,6 +2945,14 @@ Mavlink::task_main(int argc, char *argv[])
 			}
 
 			_bytes_timestamp = t;
+
+			/* unsubscribe from the topics which are no longer read, e.g. by disabled streams */
+			MavlinkOrbSubscription *sub;
+			LL_FOREACH(_subscriptions, sub) {
+				if (sub->release_if_idle()) {
+					++_subscriptions_released;
+				}
+			}
 		}
 
 		perf_end(_loop_perf);
@@ -2393,6 +2978,7 @@ Mavlink::task_main(int argc, char *argv[])
 	}
 
 	_streams = nullptr;
+	_stream_scheduler.rebuild(_streams);
 
 	/* delete subscriptions */
 	MavlinkOrbSubscription *sub_to_del = nullptr;
@@ -2416,6 +3002,20 @@ Mavlink::task_main(int argc, char *argv[])
 		_socket_fd = -1;
 	}
 
+#ifdef __PX4_POSIX
+
+	if (_tcp_listen_fd >= 0) {
+		close(_tcp_listen_fd);
+		_tcp_listen_fd = -1;
+	}
+
+	if (_tcp_connecting_fd >= 0) {
+		close(_tcp_connecting_fd);
+		_tcp_connecting_fd = -1;
+	}
+
+#endif
+
 	if (_forwarding_on) {
 		message_buffer_destroy();
 		pthread_mutex_destroy(&_message_buffer_mutex);
@@ -2603,16 +3203,37 @@ Mavlink::display_status()
 	printf("\ttx: %.3f kB/s\n", (double)_rate_tx);
 	printf("\ttxerr: %.3f kB/s\n", (double)_rate_txerr);
 	printf("\trx: %.3f kB/s\n", (double)_rate_rx);
-	printf("\trate mult: %.3f\n", (double)_rate_mult);
+	printf("\trate mult: %.3f (low: %.3f, normal: %.3f, high: %.3f)\n", (double)_rate_mult,
+	       (double)_rate_mult_priority[MavlinkStream::PRIORITY_LOW],
+	       (double)_rate_mult_priority[MavlinkStream::PRIORITY_NORMAL],
+	       (double)_rate_mult_priority[MavlinkStream::PRIORITY_HIGH]);
+	printf("\tlink usage: %.1f%% of %.3f kB/s\n", (double)(_rate_tx * 1000.0f / _datarate * 100.0f),
+	       (double)(_datarate / 1000.0f));
 
 	if (_mavlink_ulog) {
-		printf("\tULog rate: %.1f%% of max %.1f%%\n", (double)_mavlink_ulog->current_data_rate() * 100.,
-		       (double)_mavlink_ulog->maximum_data_rate() * 100.);
+		printf("\tULog rate: %.1f%% of max %.1f%% (%.3f kB/s)\n", (double)_mavlink_ulog->current_data_rate() * 100.,
+		       (double)_mavlink_ulog->maximum_data_rate() * 100., (double)(_mavlink_ulog->achieved_data_rate() / 1000.f));
 	}
 
+	unsigned subscriptions = 0;
+	unsigned subscribed = 0;
+	MavlinkOrbSubscription *sub;
+	LL_FOREACH(_subscriptions, sub) {
+		++subscriptions;
+
+		if (sub->is_subscribed()) {
+			++subscribed;
+		}
+	}
+
+	printf("\tuORB subscriptions: %u of %u subscribed, %u released when idle\n", subscribed, subscriptions,
+	       _subscriptions_released);
+
 	printf("\taccepting commands: %s, FTP enabled: %s\n", accepting_commands() ? "YES" : "NO", _ftp_on ? "YES" : "NO");
 	printf("\tMAVLink version: %i\n", _protocol_version);
 
+	_routing_table.print_routes(this, hrt_absolute_time());
+
 	printf("\ttransport protocol: ");
 
 	switch (_protocol) {
@@ -2621,7 +3242,12 @@ Mavlink::display_status()
 		break;
 
 	case TCP:
+#ifdef __PX4_POSIX
+		printf("TCP (%i, %s, %s)\n", _network_port, _tcp_listen_fd >= 0 ? "server" : "client",
+		       _socket_fd >= 0 ? "connected" : "not connected");
+#else
 		printf("TCP\n");
+#endif
 		break;
 
 	case SERIAL:
@@ -2630,6 +3256,44 @@ Mavlink::display_status()
 	}
 }
 
+void
+Mavlink::display_status_streams()
+{
+	static const char *priority_names[MavlinkStream::PRIORITY_COUNT] = {"low", "normal", "high"};
+
+	printf("\t%-30s %-7s %10s %10s\n", "stream", "prio", "rate [Hz]", "eff. [Hz]");
+
+	MavlinkStream *stream;
+	LL_FOREACH(_streams, stream) {
+		const int interval = stream->get_interval();
+		const int effective_interval = stream->get_effective_interval();
+
+		printf("\t%-30s %-7s ", stream->get_name(),
+		       stream->const_rate() ? "const" : priority_names[stream->get_priority()]);
+
+		if (interval > 0) {
+			printf("%10.2f %10.2f\n", (double)(1000000.0f / interval),
+			       (double)(1000000.0f / effective_interval));
+
+		} else {
+			printf("%10s %10s\n", "unlimited", "unlimited");
+		}
+	}
+}
+
+void
+Mavlink::display_status_messages()
+{
+	MavlinkReceiver *receiver = _receiver;
+
+	if (receiver != nullptr) {
+		receiver->print_status();
+
+	} else {
+		printf("\treceiver not running\n");
+	}
+}
+
 int
 Mavlink::stream_command(int argc, char *argv[])
 {
@@ -2796,6 +3460,9 @@ $ mavlink stream -u 14556 -s HIGHRES_IMU -r 50
 #ifdef __PX4_POSIX
 	PRINT_MODULE_USAGE_PARAM_INT('u', 14556, 0, 65536, "Select UDP Network Port (local)", true);
 	PRINT_MODULE_USAGE_PARAM_INT('o', 14550, 0, 65536, "Select UDP Network Port (remote)", true);
+	PRINT_MODULE_USAGE_PARAM_INT('T', 5760, 0, 65536,
+				     "Use TCP on this port: listen for a connection, or connect to the partner IP if given with -t", true);
+	PRINT_MODULE_USAGE_PARAM_FLAG('N', "Keep Nagle's algorithm enabled on TCP (higher latency, fewer packets)", true);
 	PRINT_MODULE_USAGE_PARAM_STRING('t', "127.0.0.1", nullptr,
 					"Partner IP (broadcasting can be enabled via MAV_BROADCAST param)", true);
 #endif
@@ -2812,6 +3479,8 @@ $ mavlink stream -u 14556 -s HIGHRES_IMU -r 50
 	PRINT_MODULE_USAGE_COMMAND_DESCR("stop-all", "Stop all instances");
 
 	PRINT_MODULE_USAGE_COMMAND_DESCR("status", "Print status for all instances");
+	PRINT_MODULE_USAGE_ARG("streams|messages",
+			       "Print the configured and effective rates of all streams, or the received messages per ID", true);
 
 	PRINT_MODULE_USAGE_COMMAND_DESCR("stream", "Configure the sending rate of a stream for a running instance");
 #ifdef __PX4_POSIX
@@ -2845,7 +3514,9 @@ int mavlink_main(int argc, char *argv[])
 		return Mavlink::destroy_all_instances();
 
 	} else if (!strcmp(argv[1], "status")) {
-		return Mavlink::get_status_all_instances();
+		bool show_streams_status = argc > 2 && strcmp(argv[2], "streams") == 0;
+		bool show_messages_status = argc > 2 && strcmp(argv[2], "messages") == 0;
+		return Mavlink::get_status_all_instances(show_streams_status, show_messages_status);
 
 	} else if (!strcmp(argv[1], "verbose")) {
 		bool on = true;
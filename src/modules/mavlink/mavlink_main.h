@@ -67,16 +67,24 @@
 #include "mavlink_bridge_header.h"
 #include "mavlink_orb_subscription.h"
 #include "mavlink_stream.h"
+#include "mavlink_stream_scheduler.h"
 #include "mavlink_messages.h"
 #include "mavlink_shell.h"
 #include "mavlink_ulog.h"
 
+#if defined(__PX4_LINUX)
+/* send and receive several UDP datagrams per system call (sendmmsg/recvmmsg) */
+#define MAVLINK_UDP_BATCHING
+#endif
+
 enum Protocol {
 	SERIAL = 0,
 	UDP,
 	TCP,
 };
 
+class MavlinkReceiver;
+
 class Mavlink
 {
 
@@ -103,6 +111,21 @@ public:
 	 */
 	void			display_status();
 
+	/**
+	 * Display the configured and the effective rates of all streams.
+	 */
+	void			display_status_streams();
+
+	/**
+	 * Display the number of received messages per message ID.
+	 */
+	void			display_status_messages();
+
+	/**
+	 * Set the receiver of this instance (called from the receiver thread), nullptr when it exits.
+	 */
+	void			set_receiver(MavlinkReceiver *receiver) { _receiver = receiver; }
+
 	static int		stream_command(int argc, char *argv[]);
 
 	static int		instance_count();
@@ -130,7 +153,7 @@ public:
 
 	static int		destroy_all_instances();
 
-	static int		get_status_all_instances();
+	static int		get_status_all_instances(bool show_streams_status, bool show_messages_status);
 
 	/**
 	 * Set all instances to verbose mode
@@ -305,6 +328,12 @@ public:
 	 */
 	int             	send_packet();
 
+	/**
+	 * Write the bytes collected for the UART, and send the UDP datagrams queued by send_packet()
+	 * (if MAVLINK_UDP_BATCHING is defined). Called by the main loop and the receiver after sending.
+	 */
+	void			flush_send_buffers();
+
 	/**
 	 * Resend message as is, don't change sequence number and CRC.
 	 */
@@ -312,7 +341,12 @@ public:
 
 	void			handle_message(const mavlink_message_t *msg);
 
-	MavlinkOrbSubscription *add_orb_subscription(const orb_id_t topic, int instance = 0);
+	/**
+	 * Get the subscription of this instance to a topic, creating it if needed.
+	 * @param shared share the copied data with the other instances (see MavlinkOrbSubscription).
+	 *               Must be false for topics with a queue.
+	 */
+	MavlinkOrbSubscription *add_orb_subscription(const orb_id_t topic, int instance = 0, bool shared = true);
 
 	int			get_instance_id();
 
@@ -379,6 +413,11 @@ public:
 
 	float			get_rate_mult();
 
+	/**
+	 * @return the rate multiplier for the streams of a priority
+	 */
+	float			get_rate_mult(MavlinkStream::Priority priority) const { return _rate_mult_priority[priority]; }
+
 	float			get_baudrate() { return _baudrate; }
 
 	/* Functions for waiting to start transmission until message received. */
@@ -430,6 +469,12 @@ public:
 
 	int 			get_socket_fd() { return _socket_fd; };
 #ifdef __PX4_POSIX
+	/**
+	 * Close the TCP connection (e.g. after the partner closed it). In server mode the next
+	 * connection is accepted, in client mode the connection is re-established.
+	 */
+	void			tcp_close_connection();
+
 	struct sockaddr_in 	*get_client_source_address() { return &_src_addr; }
 
 	void			set_client_source_initialized() { _src_addr_initialized = true; }
@@ -466,7 +511,7 @@ public:
 	{
 		if (_mavlink_ulog) { return; }
 
-		_mavlink_ulog = MavlinkULog::try_start(_datarate, 0.7f, target_system, target_component);
+		_mavlink_ulog = MavlinkULog::try_start(0.7f, target_system, target_component);
 	}
 	void			request_stop_ulog_streaming()
 	{
@@ -506,7 +551,10 @@ private:
 	unsigned		_main_loop_delay;	/**< mainloop delay, depends on data rate */
 
 	MavlinkOrbSubscription	*_subscriptions;
+	unsigned		_subscriptions_released;	/**< number of subscriptions released because they were idle */
 	MavlinkStream		*_streams;
+	MavlinkStreamScheduler	_stream_scheduler;
+	bool			_stream_schedule_invalid;	/**< streams or intervals changed, the schedule needs a rebuild */
 
 	MavlinkShell			*_mavlink_shell;
 	MavlinkULog			*_mavlink_ulog;
@@ -521,6 +569,7 @@ private:
 	unsigned int		_total_counter;
 
 	pthread_t		_receive_thread;
+	MavlinkReceiver		*_receiver;
 
 	bool			_verbose;
 	bool			_forwarding_on;
@@ -528,10 +577,14 @@ private:
 #ifndef __PX4_QURT
 	int			_uart_fd;
 #endif
+	static constexpr unsigned UART_BUF_SIZE = 512;	///< bytes collected before they are written to the UART
+	uint8_t			_uart_buf[UART_BUF_SIZE];	///< packets of the current iteration, written with one write()
+	unsigned		_uart_buf_len;
 	int			_baudrate;
 	int			_datarate;		///< data rate for normal streams (attitude, position, etc.)
 	int			_datarate_events;	///< data rate for params, waypoints, text messages
 	float			_rate_mult;
+	float			_rate_mult_priority[MavlinkStream::PRIORITY_COUNT];	/**< rate multiplier per stream priority */
 	hrt_abstime		_last_hw_rate_timestamp;
 
 	/**
@@ -572,6 +625,18 @@ private:
 	bool _broadcast_failed_warned;
 	uint8_t _network_buf[MAVLINK_MAX_PACKET_LEN];
 	unsigned _network_buf_len;
+	int _tcp_listen_fd;		///< listening socket in TCP server mode, -1 otherwise
+	int _tcp_connecting_fd;		///< socket with a pending connect in TCP client mode, -1 otherwise
+	bool _tcp_nodelay;		///< disable Nagle's algorithm on the TCP connection
+	hrt_abstime _tcp_last_connect_time;
+	uint8_t _tcp_tx_pending[MAVLINK_MAX_PACKET_LEN];	///< rest of a partially sent packet
+	unsigned _tcp_tx_pending_len;
+#ifdef MAVLINK_UDP_BATCHING
+	static constexpr unsigned NETWORK_QUEUE_SIZE = 8;	///< max number of datagrams sent per system call
+	uint8_t _network_queue[NETWORK_QUEUE_SIZE][MAVLINK_MAX_PACKET_LEN];
+	unsigned _network_queue_len[NETWORK_QUEUE_SIZE];
+	unsigned _network_queue_count;
+#endif
 #endif
 	int _socket_fd;
 	Protocol	_protocol;
@@ -590,6 +655,11 @@ private:
 	mavlink_message_buffer	_message_buffer;
 
 	pthread_mutex_t		_message_buffer_mutex;
+
+	/* token bucket for forwarded broadcast messages [bytes] (protected by _message_buffer_mutex) */
+	static constexpr float	FORWARD_BROADCAST_SHARE = 0.25f;	///< max share of _datarate for forwarded broadcasts
+	float			_forward_broadcast_budget;
+	hrt_abstime		_forward_broadcast_time;
 	pthread_mutex_t		_send_mutex;
 
 	bool			_param_initialized;
@@ -643,7 +713,12 @@ private:
 
 	void message_buffer_mark_read(int n);
 
-	void pass_message(const mavlink_message_t *msg);
+	/**
+	 * Queue a message from another instance to be sent on this link
+	 * @param broadcast the message is not targeted: it is dropped if the broadcast forwarding budget
+	 *                  of this link is used up
+	 */
+	void pass_message(const mavlink_message_t *msg, bool broadcast);
 
 	/**
 	 * Check the configuration of a connected radio
@@ -658,10 +733,76 @@ private:
 	 */
 	void update_rate_mult();
 
+	/**
+	 * Distribute the bandwidth given by _rate_mult over the stream priorities: if the link cannot
+	 * carry all streams, the higher priorities are served first.
+	 * @param priority_rate requested (unscaled) data rate per priority [B/s], excluding constant rate streams
+	 * @param rate total requested data rate [B/s]
+	 */
+	void update_priority_rate_mult(const float priority_rate[MavlinkStream::PRIORITY_COUNT], float rate);
+
 	void find_broadcast_address();
 
+	/**
+	 * @return true if the UDP packets need to be sent to the broadcast address as well
+	 * (no valid connection to a GCS exists)
+	 */
+	bool udp_broadcast_required();
+
+	/**
+	 * Write the collected bytes to the UART. Must be called with _send_mutex held.
+	 */
+	void write_uart_buf();
+
+#ifdef MAVLINK_UDP_BATCHING
+	/**
+	 * Send all queued datagrams to the partner (and the broadcast address if required)
+	 * with sendmmsg(). Must be called with _send_mutex held.
+	 */
+	void send_network_queue();
+
+	/**
+	 * Send a batch of datagrams with sendmmsg(). A datagram that fails is dropped and the rest are still sent.
+	 * @return true if all datagrams were sent
+	 */
+	bool send_network_batch(struct mmsghdr *msgs, unsigned num_msgs);
+#endif
+
 	void init_udp();
 
+#ifdef __PX4_POSIX
+	static constexpr int TCP_SEND_BUFFER_SIZE = 64 * 1024;
+	static constexpr hrt_abstime TCP_CONNECT_INTERVAL = 1000000;	///< client mode reconnect interval [us]
+
+	/**
+	 * Set up the TCP transport: in server mode (no partner IP given) listen on the network port,
+	 * in client mode the connection is established by tcp_update_connection().
+	 */
+	void init_tcp();
+
+	/**
+	 * Accept a new connection (server mode) or (re)connect to the partner (client mode)
+	 * if not connected. Non-blocking, called from the main loop.
+	 */
+	void tcp_update_connection();
+
+	/**
+	 * Configure a new TCP connection and start using it
+	 */
+	void tcp_set_connection(int fd);
+
+	/**
+	 * Send a packet over the TCP connection without blocking. If only part of it can be sent, the
+	 * rest is sent before the next packet, so that the stream always contains complete packets.
+	 * Must be called with _send_mutex held.
+	 * @return number of bytes sent (or queued), -1 if the packet was dropped
+	 */
+	int tcp_send(const uint8_t *buf, unsigned len);
+
+	/** @see tcp_close_connection(), must be called with _send_mutex held */
+	void tcp_close_connection_locked();
+#endif
+
 	/**
 	 * Main mavlink task.
 	 */
@@ -445,6 +445,11 @@ public:
 		return 0;	// commands stream is not regular and not predictable
 	}
 
+	Priority get_priority()
+	{
+		return PRIORITY_HIGH;
+	}
+
 private:
 	MavlinkOrbSubscription *_cmd_sub;
 	uint64_t _cmd_time;
@@ -455,7 +460,7 @@ private:
 
 protected:
 	explicit MavlinkStreamCommandLong(Mavlink *mavlink) : MavlinkStream(mavlink),
-		_cmd_sub(_mavlink->add_orb_subscription(ORB_ID(vehicle_command))),
+		_cmd_sub(_mavlink->add_orb_subscription(ORB_ID(vehicle_command), 0, false)),
 		_cmd_time(0)
 	{}
 
@@ -520,6 +525,11 @@ public:
 		return MAVLINK_MSG_ID_SYS_STATUS_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES;
 	}
 
+	Priority get_priority()
+	{
+		return PRIORITY_HIGH;
+	}
+
 private:
 	MavlinkOrbSubscription *_status_sub;
 	MavlinkOrbSubscription *_cpuload_sub;
@@ -629,6 +639,11 @@ public:
 		return MAVLINK_MSG_ID_HIGHRES_IMU_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES;
 	}
 
+	Priority get_priority()
+	{
+		return PRIORITY_LOW;
+	}
+
 private:
 	MavlinkOrbSubscription *_sensor_sub;
 	uint64_t _sensor_time;
@@ -759,6 +774,11 @@ public:
 		return MAVLINK_MSG_ID_ATTITUDE_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES;
 	}
 
+	Priority get_priority()
+	{
+		return PRIORITY_HIGH;
+	}
+
 private:
 	MavlinkOrbSubscription *_att_sub;
 	uint64_t _att_time;
@@ -780,11 +800,10 @@ protected:
 
 		if (_att_sub->update(&_att_time, &att)) {
 			mavlink_attitude_t msg = {};
-			matrix::Eulerf euler = matrix::Quatf(att.q);
 			msg.time_boot_ms = att.timestamp / 1000;
-			msg.roll = euler.phi();
-			msg.pitch = euler.theta();
-			msg.yaw = euler.psi();
+			msg.roll = att.roll;
+			msg.pitch = att.pitch;
+			msg.yaw = att.yaw;
 			msg.rollspeed = att.rollspeed;
 			msg.pitchspeed = att.pitchspeed;
 			msg.yawspeed = att.yawspeed;
@@ -968,10 +987,9 @@ protected:
 
 		if (updated) {
 			mavlink_vfr_hud_t msg = {};
-			matrix::Eulerf euler = matrix::Quatf(att.q);
 			msg.airspeed = airspeed.indicated_airspeed_m_s;
 			msg.groundspeed = sqrtf(pos.vel_n * pos.vel_n + pos.vel_e * pos.vel_e);
-			msg.heading = _wrap_2pi(euler.psi()) * M_RAD_TO_DEG_F;
+			msg.heading = _wrap_2pi(att.yaw) * M_RAD_TO_DEG_F;
 
 			if (armed.armed) {
 				// VFR_HUD throttle should only be used for operator feedback.
@@ -1042,6 +1060,11 @@ public:
 		return MAVLINK_MSG_ID_GPS_RAW_INT_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES;
 	}
 
+	Priority get_priority()
+	{
+		return PRIORITY_HIGH;
+	}
+
 private:
 	MavlinkOrbSubscription *_gps_sub;
 	uint64_t _gps_time;
@@ -1249,7 +1272,7 @@ private:
 
 protected:
 	explicit MavlinkStreamADSBVehicle(Mavlink *mavlink) : MavlinkStream(mavlink),
-		_pos_sub(_mavlink->add_orb_subscription(ORB_ID(transponder_report))),
+		_pos_sub(_mavlink->add_orb_subscription(ORB_ID(transponder_report), 0, false)),
 		_pos_time(0)
 	{}
 
@@ -1580,6 +1603,11 @@ public:
 		return MAVLINK_MSG_ID_GLOBAL_POSITION_INT_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES;
 	}
 
+	Priority get_priority()
+	{
+		return PRIORITY_HIGH;
+	}
+
 private:
 	MavlinkOrbSubscription *_pos_sub;
 	uint64_t _pos_time;
@@ -1811,6 +1839,11 @@ public:
 		return MAVLINK_MSG_ID_LOCAL_POSITION_NED_COV_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES;
 	}
 
+	Priority get_priority()
+	{
+		return PRIORITY_LOW;
+	}
+
 private:
 	MavlinkOrbSubscription *_est_sub;
 	uint64_t _est_time;
@@ -1893,6 +1926,11 @@ public:
 		return MAVLINK_MSG_ID_VIBRATION_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES;
 	}
 
+	Priority get_priority()
+	{
+		return PRIORITY_LOW;
+	}
+
 private:
 	MavlinkOrbSubscription *_est_sub;
 	uint64_t _est_time;
@@ -2050,6 +2088,11 @@ public:
 		return _home_sub->is_published() ? (MAVLINK_MSG_ID_HOME_POSITION_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES) : 0;
 	}
 
+	Priority get_priority()
+	{
+		return PRIORITY_HIGH;
+	}
+
 private:
 	MavlinkOrbSubscription *_home_sub;
 
@@ -2149,6 +2192,11 @@ public:
 		return MAVLINK_MSG_ID_SERVO_OUTPUT_RAW_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES;
 	}
 
+	Priority get_priority()
+	{
+		return PRIORITY_LOW;
+	}
+
 private:
 	MavlinkOrbSubscription *_act_sub;
 	uint64_t _act_time;
@@ -2238,6 +2286,11 @@ public:
 		return _att_ctrl_sub->is_published() ? (MAVLINK_MSG_ID_ACTUATOR_CONTROL_TARGET_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES) : 0;
 	}
 
+	Priority get_priority()
+	{
+		return PRIORITY_LOW;
+	}
+
 private:
 	MavlinkOrbSubscription *_att_ctrl_sub;
 	uint64_t _att_ctrl_time;
@@ -3145,6 +3198,11 @@ public:
 		return (_debug_time > 0) ? MAVLINK_MSG_ID_NAMED_VALUE_FLOAT_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES : 0;
 	}
 
+	Priority get_priority()
+	{
+		return PRIORITY_LOW;
+	}
+
 private:
 	MavlinkOrbSubscription *_debug_sub;
 	uint64_t _debug_time;
@@ -3214,6 +3272,11 @@ public:
 		return (_debug_time > 0) ? MAVLINK_MSG_ID_DEBUG_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES : 0;
 	}
 
+	Priority get_priority()
+	{
+		return PRIORITY_LOW;
+	}
+
 private:
 	MavlinkOrbSubscription *_debug_sub;
 	uint64_t _debug_time;
@@ -3281,6 +3344,11 @@ public:
 		return (_debug_time > 0) ? MAVLINK_MSG_ID_DEBUG_VECT_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES : 0;
 	}
 
+	Priority get_priority()
+	{
+		return PRIORITY_LOW;
+	}
+
 private:
 	MavlinkOrbSubscription *_debug_sub;
 	uint64_t _debug_time;
@@ -3596,6 +3664,11 @@ public:
 		return MAVLINK_MSG_ID_EXTENDED_SYS_STATE_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES;
 	}
 
+	Priority get_priority()
+	{
+		return PRIORITY_HIGH;
+	}
+
 private:
 	MavlinkOrbSubscription *_status_sub;
 	MavlinkOrbSubscription *_landed_sub;
@@ -3853,6 +3926,11 @@ public:
 		return (_wind_estimate_time > 0) ? MAVLINK_MSG_ID_WIND_COV_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES : 0;
 	}
 
+	Priority get_priority()
+	{
+		return PRIORITY_LOW;
+	}
+
 private:
 	MavlinkOrbSubscription *_wind_estimate_sub;
 	uint64_t _wind_estimate_time;
@@ -4216,6 +4294,11 @@ public:
 		       MAVLINK_NUM_NON_PAYLOAD_BYTES : 0;
 	}
 
+	Priority get_priority()
+	{
+		return PRIORITY_LOW;
+	}
+
 private:
 	MavlinkOrbSubscription *_att_sub;
 	MavlinkOrbSubscription *_gpos_sub;
@@ -60,8 +60,17 @@ unsigned MavlinkMissionManager::_count[3] = { 0, 0, 0 };
 int MavlinkMissionManager::_current_seq = 0;
 int MavlinkMissionManager::_last_reached = -1;
 bool MavlinkMissionManager::_transfer_in_progress = false;
+bool MavlinkMissionManager::_navigator_switch_pending = false;
+hrt_abstime MavlinkMissionManager::_navigator_switch_time = 0;
 constexpr unsigned MavlinkMissionManager::MAX_COUNT[];
 uint16_t MavlinkMissionManager::_geofence_update_counter = 0;
+MavlinkMissionManager::TransferBuffer MavlinkMissionManager::_transfer_buffers[2] = {};
+unsigned MavlinkMissionManager::_transfer_buffer_index = 0;
+dm_item_t MavlinkMissionManager::_transfer_dm_item = DM_KEY_WAYPOINTS_OFFBOARD_0;
+size_t MavlinkMissionManager::_transfer_item_len = 0;
+volatile bool MavlinkMissionManager::_transfer_write_failed = false;
+mission_item_s MavlinkMissionManager::_transfer_window_items[TRANSFER_WINDOW] = {};
+int MavlinkMissionManager::_transfer_window_seq[TRANSFER_WINDOW] = {};
 
 #define CHECK_SYSID_COMPID_MISSION(_msg)		(_msg.target_system == mavlink_system.sysid && \
 		((_msg.target_component == mavlink_system.compid) || \
@@ -85,6 +94,8 @@ MavlinkMissionManager::MavlinkMissionManager(Mavlink *mavlink) :
 	_transfer_current_seq(-1),
 	_transfer_partner_sysid(0),
 	_transfer_partner_compid(0),
+	_transfer_request_seq(0),
+	_transfer_window(1),
 	_offboard_mission_sub(-1),
 	_mission_result_sub(-1),
 	_offboard_mission_pub(nullptr),
@@ -176,6 +187,12 @@ MavlinkMissionManager::update_active_mission(int dataman_id, unsigned count, int
 	int res = dm_write(DM_KEY_MISSION_STATE, 0, DM_PERSIST_POWER_ON_RESET, &mission, sizeof(mission_s));
 
 	if (res == sizeof(mission_s)) {
+		/* navigator keeps using the previous storage until it has checked the mission */
+		if (dataman_id != _dataman_id) {
+			_navigator_switch_pending = true;
+			_navigator_switch_time = hrt_absolute_time();
+		}
+
 		/* update active mission state */
 		_dataman_id = dataman_id;
 		_count[(uint8_t)MAV_MISSION_TYPE_MISSION] = count;
@@ -471,6 +488,23 @@ MavlinkMissionManager::send_mission_request(uint8_t sysid, uint8_t compid, uint1
 	}
 }
 
+void
+MavlinkMissionManager::send_transfer_requests(bool resend)
+{
+	if (resend || _transfer_request_seq < _transfer_seq) {
+		_transfer_request_seq = _transfer_seq;
+	}
+
+	/* keep several requests in flight, so the items arrive back-to-back instead of one per round trip */
+	while (_transfer_request_seq < _transfer_count && _transfer_request_seq < _transfer_seq + _transfer_window) {
+		if (_transfer_window_seq[_transfer_request_seq % TRANSFER_WINDOW] != (int)_transfer_request_seq) {
+			send_mission_request(_transfer_partner_sysid, _transfer_partner_compid, _transfer_request_seq);
+		}
+
+		++_transfer_request_seq;
+	}
+}
+
 
 void
 MavlinkMissionManager::send_mission_item_reached(uint16_t seq)
@@ -497,6 +531,11 @@ MavlinkMissionManager::send(const hrt_abstime now)
 
 		_current_seq = mission_result.seq_current;
 
+		if (_navigator_switch_pending && mission_result.dataman_id == _dataman_id) {
+			/* navigator uses the new mission, the other storage is free */
+			_navigator_switch_pending = false;
+		}
+
 		if (_verbose) { PX4_INFO("WPM: got mission result, new current_seq: %d", _current_seq); }
 
 		if (mission_result.reached) {
@@ -530,8 +569,16 @@ MavlinkMissionManager::send(const hrt_abstime now)
 	/* check for timed-out operations */
 	if (_state == MAVLINK_WPM_STATE_GETLIST && (_time_last_sent > 0)
 	    && hrt_elapsed_time(&_time_last_sent) > _retry_timeout) {
-		// try to request item again after timeout
-		send_mission_request(_transfer_partner_sysid, _transfer_partner_compid, _transfer_seq);
+		if (_transfer_window > 1) {
+			// an item or request got lost, or the partner only answers one request at a time:
+			// continue the transfer with one request in flight
+			if (_verbose) { PX4_INFO("WPM: MISSION_ITEM timeout, requesting one item at a time"); }
+
+			_transfer_window = 1;
+		}
+
+		// try to request the missing items again after timeout
+		send_transfer_requests(true);
 
 	} else if (_state == MAVLINK_WPM_STATE_SENDLIST && (_time_last_sent > 0)
 		   && hrt_elapsed_time(&_time_last_sent) > _retry_timeout) {
@@ -874,6 +921,16 @@ MavlinkMissionManager::handle_mission_count(const mavlink_message_t *msg)
 				return;
 			}
 
+			if (_mission_type == MAV_MISSION_TYPE_MISSION && wpc.count > 0 && _navigator_switch_pending &&
+			    hrt_elapsed_time(&_navigator_switch_time) < NAVIGATOR_SWITCH_TIMEOUT) {
+				/* the inactive storage still holds the mission in use, until navigator has checked the last upload */
+				if (_verbose) { PX4_ERR("WPM: MISSION_COUNT ERROR: previous mission still being checked"); }
+
+				send_mission_ack(_transfer_partner_sysid, _transfer_partner_compid, MAV_MISSION_ERROR);
+				_transfer_in_progress = false;
+				return;
+			}
+
 			if (wpc.count == 0) {
 				if (_verbose) { PX4_INFO("WPM: MISSION_COUNT 0, clearing waypoints list and staying in state MAVLINK_WPM_STATE_IDLE"); }
 
@@ -910,6 +967,11 @@ MavlinkMissionManager::handle_mission_count(const mavlink_message_t *msg)
 			_transfer_count = wpc.count;
 			_transfer_dataman_id = _dataman_id == 0 ? 1 : 0;	// use inactive storage for transmission
 			_transfer_current_seq = -1;
+			_transfer_window = TRANSFER_WINDOW;
+
+			for (unsigned i = 0; i < TRANSFER_WINDOW; ++i) {
+				_transfer_window_seq[i] = -1;
+			}
 
 			if (_mission_type == MAV_MISSION_TYPE_FENCE) {
 				// We're about to write new geofence items, so take the lock. It will be released when
@@ -947,7 +1009,7 @@ MavlinkMissionManager::handle_mission_count(const mavlink_message_t *msg)
 			return;
 		}
 
-		send_mission_request(_transfer_partner_sysid, _transfer_partner_compid, _transfer_seq);
+		send_transfer_requests(true);
 	}
 }
 
@@ -963,9 +1025,105 @@ MavlinkMissionManager::switch_to_idle_state()
 		if (_verbose) { PX4_INFO("unlocking geofence"); }
 	}
 
+	reset_transfer_buffers();
+
 	_state = MAVLINK_WPM_STATE_IDLE;
 }
 
+bool
+MavlinkMissionManager::buffer_transfer_item(dm_item_t dm_item, unsigned index, const void *item, size_t item_len)
+{
+	static_assert(sizeof(mission_fence_point_s) <= sizeof(mission_item_s), "transfer buffer too small");
+	static_assert(sizeof(mission_save_point_s) <= sizeof(mission_item_s), "transfer buffer too small");
+
+	TransferBuffer *buffer = &_transfer_buffers[_transfer_buffer_index];
+
+	if (buffer->count > 0 && (dm_item != _transfer_dm_item || index != buffer->start_index + buffer->count)) {
+		// not consecutive: write out what we have first
+		if (!write_transfer_buffer(false)) {
+			return false;
+		}
+
+		buffer = &_transfer_buffers[_transfer_buffer_index];
+	}
+
+	if (buffer->count == 0) {
+		buffer->start_index = index;
+		_transfer_dm_item = dm_item;
+		_transfer_item_len = item_len;
+	}
+
+	memcpy(buffer->data + buffer->count * item_len, item, item_len);
+	buffer->count++;
+
+	if (buffer->count == TRANSFER_BUFFER_ITEMS) {
+		return write_transfer_buffer(false);
+	}
+
+	return !_transfer_write_failed;
+}
+
+bool
+MavlinkMissionManager::write_transfer_buffer(bool wait)
+{
+	TransferBuffer &buffer = _transfer_buffers[_transfer_buffer_index];
+	TransferBuffer &other = _transfer_buffers[1 - _transfer_buffer_index];
+
+	if (wait || other.write_pending) {
+		// dataman processes the requests in order, so this also waits for the pending write of the other buffer
+		ssize_t ret = dm_write_range(_transfer_dm_item, buffer.start_index, buffer.count, DM_PERSIST_POWER_ON_RESET,
+					     buffer.data, _transfer_item_len);
+
+		if (ret != (ssize_t)buffer.count) {
+			_transfer_write_failed = true;
+		}
+
+		buffer.count = 0;
+
+	} else if (buffer.count > 0) {
+		buffer.write_count = buffer.count;
+		buffer.write_pending = true;
+
+		if (dm_write_range_async(_transfer_dm_item, buffer.start_index, buffer.count, DM_PERSIST_POWER_ON_RESET,
+					 buffer.data, _transfer_item_len, &MavlinkMissionManager::transfer_buffer_written, &buffer) != 0) {
+			buffer.write_pending = false;
+			_transfer_write_failed = true;
+		}
+
+		buffer.count = 0;
+		_transfer_buffer_index = 1 - _transfer_buffer_index;
+	}
+
+	return !_transfer_write_failed;
+}
+
+void
+MavlinkMissionManager::transfer_buffer_written(void *arg, ssize_t result)
+{
+	TransferBuffer *buffer = (TransferBuffer *)arg;
+
+	if (result != (ssize_t)buffer->write_count) {
+		_transfer_write_failed = true;
+	}
+
+	// make sure the result is visible before the buffer is released
+	__sync_synchronize();
+	buffer->write_pending = false;
+}
+
+void
+MavlinkMissionManager::reset_transfer_buffers()
+{
+	_transfer_buffers[_transfer_buffer_index].count = 0;
+
+	if (_transfer_buffers[0].write_pending || _transfer_buffers[1].write_pending) {
+		// nothing is written, but it returns after the pending writes (the buffers must not be reused before)
+		dm_write_range(_transfer_dm_item, 0, 0, DM_PERSIST_POWER_ON_RESET, nullptr, _transfer_item_len);
+	}
+
+	_transfer_write_failed = false;
+}
+
 
 void
 MavlinkMissionManager::handle_mission_item(const mavlink_message_t *msg)
@@ -1009,8 +1167,9 @@ MavlinkMissionManager::handle_mission_item_both(const mavlink_message_t *msg)
 		if (_state == MAVLINK_WPM_STATE_GETLIST) {
 			_time_last_recv = hrt_absolute_time();
 
-			if (wp.seq != _transfer_seq) {
-				if (_verbose) { PX4_ERR("WPM: MISSION_ITEM ERROR: seq %u was not the expected %u", wp.seq, _transfer_seq); }
+			if (wp.seq != _transfer_seq && (wp.seq < _transfer_seq || wp.seq >= _transfer_seq + _transfer_window
+							|| wp.seq >= _transfer_count)) {
+				if (_verbose) { PX4_ERR("WPM: MISSION_ITEM ERROR: seq %u was not expected (next %u)", wp.seq, _transfer_seq); }
 
 				/* don't send request here, it will be performed in eventloop after timeout */
 				return;
@@ -1044,107 +1203,41 @@ MavlinkMissionManager::handle_mission_item_both(const mavlink_message_t *msg)
 			return;
 		}
 
-		bool write_failed = false;
-		bool check_failed = false;
-
-		switch (_mission_type) {
-
-		case MAV_MISSION_TYPE_MISSION: {
-				// check that we don't get a wrong item (hardening against wrong client implementations, the list here
-				// does not need to be complete)
-				if (mission_item.nav_cmd == MAV_CMD_NAV_FENCE_POLYGON_VERTEX_INCLUSION ||
-				    mission_item.nav_cmd == MAV_CMD_NAV_FENCE_POLYGON_VERTEX_EXCLUSION ||
-				    mission_item.nav_cmd == MAV_CMD_NAV_FENCE_CIRCLE_INCLUSION ||
-				    mission_item.nav_cmd == MAV_CMD_NAV_FENCE_CIRCLE_EXCLUSION ||
-				    mission_item.nav_cmd == MAV_CMD_NAV_RALLY_POINT) {
-					check_failed = true;
-
-				} else {
-					dm_item_t dm_item = DM_KEY_WAYPOINTS_OFFBOARD(_transfer_dataman_id);
-
-					write_failed = dm_write(dm_item, wp.seq, DM_PERSIST_POWER_ON_RESET, &mission_item,
-								sizeof(struct mission_item_s)) != sizeof(struct mission_item_s);
-
-					if (!write_failed) {
-						/* waypoint marked as current */
-						if (wp.current) {
-							_transfer_current_seq = wp.seq;
-						}
-					}
-				}
-			}
-			break;
-
-		case MAV_MISSION_TYPE_FENCE: { // Write a geofence point
-				mission_fence_point_s mission_fence_point;
-				mission_fence_point.nav_cmd = mission_item.nav_cmd;
-				mission_fence_point.lat = mission_item.lat;
-				mission_fence_point.lon = mission_item.lon;
-				mission_fence_point.alt = mission_item.altitude;
-
-				if (mission_item.nav_cmd == MAV_CMD_NAV_FENCE_POLYGON_VERTEX_INCLUSION ||
-				    mission_item.nav_cmd == MAV_CMD_NAV_FENCE_POLYGON_VERTEX_EXCLUSION) {
-					mission_fence_point.vertex_count = mission_item.vertex_count;
-
-					if (mission_item.vertex_count < 3) { // feasibility check
-						PX4_ERR("Fence: too few vertices");
-						check_failed = true;
-						update_geofence_count(0);
-					}
-
-				} else {
-					mission_fence_point.circle_radius = mission_item.circle_radius;
-				}
-
-				mission_fence_point.frame = mission_item.frame;
-
-				if (!check_failed) {
-					write_failed = dm_write(DM_KEY_FENCE_POINTS, wp.seq + 1, DM_PERSIST_POWER_ON_RESET, &mission_fence_point,
-								sizeof(mission_fence_point_s)) != sizeof(mission_fence_point_s);
-				}
+		/* waypoint marked as current */
+		if (wp.current) {
+			_transfer_current_seq = wp.seq;
+		}
 
-			}
-			break;
+		if (wp.seq != _transfer_seq) {
+			/* received ahead of a missing item: keep it until the missing ones arrived */
+			const unsigned slot = wp.seq % TRANSFER_WINDOW;
+			_transfer_window_items[slot] = mission_item;
+			_transfer_window_seq[slot] = wp.seq;
 
-		case MAV_MISSION_TYPE_RALLY: { // Write a safe point / rally point
-				mission_save_point_s mission_save_point;
-				mission_save_point.lat = mission_item.lat;
-				mission_save_point.lon = mission_item.lon;
-				mission_save_point.alt = mission_item.altitude;
-				mission_save_point.frame = mission_item.frame;
-				write_failed = dm_write(DM_KEY_SAFE_POINTS, wp.seq + 1, DM_PERSIST_POWER_ON_RESET, &mission_save_point,
-							sizeof(mission_save_point_s)) != sizeof(mission_save_point_s);
-			}
-			break;
+			if (_verbose) { PX4_INFO("WPM: MISSION_ITEM seq %u received ahead of seq %u", wp.seq, _transfer_seq); }
 
-		default:
-			_mavlink->send_statustext_critical("Received unknown mission type, abort.");
-			break;
+			return;
 		}
 
-		if (write_failed || check_failed) {
-			if (_verbose) { PX4_ERR("WPM: MISSION_ITEM ERROR: error writing seq %u to dataman ID %i", wp.seq, _transfer_dataman_id); }
+		if (!store_transfer_item(mission_item)) {
+			return;
+		}
 
-			send_mission_ack(_transfer_partner_sysid, _transfer_partner_compid, MAV_MISSION_ERROR);
+		/* store the items that were received ahead of this one */
+		while (_transfer_seq < _transfer_count) {
+			const unsigned slot = _transfer_seq % TRANSFER_WINDOW;
 
-			if (write_failed) {
-				_mavlink->send_statustext_critical("Unable to write on micro SD");
+			if (_transfer_window_seq[slot] != (int)_transfer_seq) {
+				break;
 			}
 
-			switch_to_idle_state();
-			_transfer_in_progress = false;
-			return;
-		}
+			_transfer_window_seq[slot] = -1;
 
-		/* waypoint marked as current */
-		if (wp.current) {
-			_transfer_current_seq = wp.seq;
+			if (!store_transfer_item(_transfer_window_items[slot])) {
+				return;
+			}
 		}
 
-		if (_verbose) { PX4_INFO("WPM: MISSION_ITEM seq %u received", wp.seq); }
-
-		_transfer_seq = wp.seq + 1;
-
 		if (_transfer_seq == _transfer_count) {
 			/* got all new mission items successfully */
 			if (_verbose) { PX4_INFO("WPM: MISSION_ITEM got all %u items, current_seq=%u, changing state to MAVLINK_WPM_STATE_IDLE", _transfer_count, _transfer_current_seq); }
@@ -1183,10 +1276,108 @@ MavlinkMissionManager::handle_mission_item_both(const mavlink_message_t *msg)
 			_transfer_in_progress = false;
 
 		} else {
-			/* request next item */
-			send_mission_request(_transfer_partner_sysid, _transfer_partner_compid, _transfer_seq);
+			/* request the next items */
+			send_transfer_requests(false);
+		}
+	}
+}
+
+bool
+MavlinkMissionManager::store_transfer_item(const mission_item_s &mission_item)
+{
+	bool write_failed = false;
+	bool check_failed = false;
+
+	switch (_mission_type) {
+
+	case MAV_MISSION_TYPE_MISSION: {
+			// check that we don't get a wrong item (hardening against wrong client implementations, the list here
+			// does not need to be complete)
+			if (mission_item.nav_cmd == MAV_CMD_NAV_FENCE_POLYGON_VERTEX_INCLUSION ||
+			    mission_item.nav_cmd == MAV_CMD_NAV_FENCE_POLYGON_VERTEX_EXCLUSION ||
+			    mission_item.nav_cmd == MAV_CMD_NAV_FENCE_CIRCLE_INCLUSION ||
+			    mission_item.nav_cmd == MAV_CMD_NAV_FENCE_CIRCLE_EXCLUSION ||
+			    mission_item.nav_cmd == MAV_CMD_NAV_RALLY_POINT) {
+				check_failed = true;
+
+			} else {
+				dm_item_t dm_item = DM_KEY_WAYPOINTS_OFFBOARD(_transfer_dataman_id);
+
+				write_failed = !buffer_transfer_item(dm_item, _transfer_seq, &mission_item, sizeof(struct mission_item_s));
+			}
+		}
+		break;
+
+	case MAV_MISSION_TYPE_FENCE: { // Write a geofence point
+			mission_fence_point_s mission_fence_point;
+			mission_fence_point.nav_cmd = mission_item.nav_cmd;
+			mission_fence_point.lat = mission_item.lat;
+			mission_fence_point.lon = mission_item.lon;
+			mission_fence_point.alt = mission_item.altitude;
+
+			if (mission_item.nav_cmd == MAV_CMD_NAV_FENCE_POLYGON_VERTEX_INCLUSION ||
+			    mission_item.nav_cmd == MAV_CMD_NAV_FENCE_POLYGON_VERTEX_EXCLUSION) {
+				mission_fence_point.vertex_count = mission_item.vertex_count;
+
+				if (mission_item.vertex_count < 3) { // feasibility check
+					PX4_ERR("Fence: too few vertices");
+					check_failed = true;
+					update_geofence_count(0);
+				}
+
+			} else {
+				mission_fence_point.circle_radius = mission_item.circle_radius;
+			}
+
+			mission_fence_point.frame = mission_item.frame;
+
+			if (!check_failed) {
+				write_failed = !buffer_transfer_item(DM_KEY_FENCE_POINTS, _transfer_seq + 1, &mission_fence_point,
+								     sizeof(mission_fence_point_s));
+			}
+
+		}
+		break;
+
+	case MAV_MISSION_TYPE_RALLY: { // Write a safe point / rally point
+			mission_save_point_s mission_save_point;
+			mission_save_point.lat = mission_item.lat;
+			mission_save_point.lon = mission_item.lon;
+			mission_save_point.alt = mission_item.altitude;
+			mission_save_point.frame = mission_item.frame;
+			write_failed = !buffer_transfer_item(DM_KEY_SAFE_POINTS, _transfer_seq + 1, &mission_save_point,
+							     sizeof(mission_save_point_s));
+		}
+		break;
+
+	default:
+		_mavlink->send_statustext_critical("Received unknown mission type, abort.");
+		break;
+	}
+
+	if (!write_failed && !check_failed && _transfer_seq + 1 == _transfer_count) {
+		/* last item: all items need to be stored before the new count is set */
+		write_failed = !write_transfer_buffer(true);
+	}
+
+	if (write_failed || check_failed) {
+		if (_verbose) { PX4_ERR("WPM: MISSION_ITEM ERROR: error writing seq %u to dataman ID %i", _transfer_seq, _transfer_dataman_id); }
+
+		send_mission_ack(_transfer_partner_sysid, _transfer_partner_compid, MAV_MISSION_ERROR);
+
+		if (write_failed) {
+			_mavlink->send_statustext_critical("Unable to write on micro SD");
 		}
+
+		switch_to_idle_state();
+		_transfer_in_progress = false;
+		return false;
 	}
+
+	if (_verbose) { PX4_INFO("WPM: MISSION_ITEM seq %u received", _transfer_seq); }
+
+	_transfer_seq++;
+	return true;
 }
 
 
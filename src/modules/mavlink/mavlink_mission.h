@@ -121,8 +121,18 @@ private:
 	unsigned		_transfer_current_seq;			///< Current item ID for current transmission (-1 means not initialized)
 	unsigned		_transfer_partner_sysid;		///< Partner system ID for current transmission
 	unsigned		_transfer_partner_compid;		///< Partner component ID for current transmission
+	unsigned		_transfer_request_seq;			///< Next item to request in current transmission
+	unsigned		_transfer_window;			///< Number of items requested ahead of _transfer_seq (1: one at a time)
 	static bool		_transfer_in_progress;			///< Global variable checking for current transmission
 
+	/**
+	 * A new mission has been handed to navigator, which keeps using the previous storage until the mission is checked.
+	 * Uploads are rejected until then, as they would overwrite the mission in use.
+	 */
+	static bool		_navigator_switch_pending;
+	static hrt_abstime	_navigator_switch_time;			///< time the mission was handed to navigator
+	static constexpr hrt_abstime NAVIGATOR_SWITCH_TIMEOUT = 10 * 1000 * 1000; ///< give up waiting (navigator not running)
+
 	int			_offboard_mission_sub;
 	int			_mission_result_sub;
 	orb_advert_t		_offboard_mission_pub;
@@ -130,6 +140,35 @@ private:
 	static uint16_t _geofence_update_counter;
 	bool		_geofence_locked; ///< if true, we currently hold the dm_lock for the geofence (transaction in progress)
 
+	static constexpr unsigned TRANSFER_BUFFER_ITEMS = 8;	///< number of received items written to dataman in one request
+
+	/**
+	 * Received items, written to dataman in batches (static, as there is only one transfer at a time).
+	 * While one buffer is written asynchronously, the next items are collected in the other one.
+	 */
+	struct TransferBuffer {
+		uint8_t data[TRANSFER_BUFFER_ITEMS * sizeof(mission_item_s)];
+		unsigned start_index;		///< dataman index of the first item
+		unsigned count;			///< number of collected items
+		unsigned write_count;		///< number of items of the pending write
+		volatile bool write_pending;	///< an asynchronous write of this buffer is in progress
+	};
+
+	static TransferBuffer	_transfer_buffers[2];
+	static unsigned		_transfer_buffer_index;		///< buffer that is currently filled
+	static dm_item_t	_transfer_dm_item;		///< dataman item type of the buffered items
+	static size_t		_transfer_item_len;		///< size of a buffered item
+	static volatile bool	_transfer_write_failed;		///< a buffered write failed during the current transmission
+
+	static constexpr unsigned TRANSFER_WINDOW = 8;	///< maximum number of item requests in flight during an upload
+
+	/**
+	 * Items received ahead of _transfer_seq, stored in slot (seq % TRANSFER_WINDOW) until the
+	 * missing items before them arrived.
+	 */
+	static mission_item_s	_transfer_window_items[TRANSFER_WINDOW];
+	static int		_transfer_window_seq[TRANSFER_WINDOW];	///< sequence of the item in a slot, -1 if empty
+
 	MavlinkRateLimiter	_slow_rate_limiter;
 
 	bool _verbose;
@@ -193,6 +232,12 @@ private:
 
 	void send_mission_request(uint8_t sysid, uint8_t compid, uint16_t seq);
 
+	/**
+	 * Request the next items of the current upload, keeping up to _transfer_window requests in flight.
+	 * @param resend request all missing items again, starting at _transfer_seq
+	 */
+	void send_transfer_requests(bool resend);
+
 	/**
 	 *  @brief emits a message that a waypoint reached
 	 *
@@ -243,4 +288,32 @@ private:
 	 * set _state to idle (and do necessary cleanup)
 	 */
 	void switch_to_idle_state();
+
+	/**
+	 * Add a received item to the transfer buffer, and write the buffer to dataman once it is full.
+	 * @return false if writing failed
+	 */
+	bool buffer_transfer_item(dm_item_t dm_item, unsigned index, const void *item, size_t item_len);
+
+	/**
+	 * Write the collected items to dataman.
+	 * @param wait block until all buffered items (including pending asynchronous writes) are written
+	 * @return false if writing failed
+	 */
+	bool write_transfer_buffer(bool wait);
+
+	/**
+	 * Store the next item (_transfer_seq) of the current upload and advance _transfer_seq.
+	 * On failure, the error ack is sent and the transfer is aborted.
+	 * @return false if the transfer was aborted
+	 */
+	bool store_transfer_item(const mission_item_s &mission_item);
+
+	/**
+	 * Drop the collected items and wait for pending writes (used when a transmission ends)
+	 */
+	void reset_transfer_buffers();
+
+	/** completion callback of the asynchronous transfer buffer writes (called from the dataman thread) */
+	static void transfer_buffer_written(void *arg, ssize_t result);
 };
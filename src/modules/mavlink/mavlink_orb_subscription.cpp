@@ -49,24 +49,257 @@
 #include <px4_defines.h>
 #include <uORB/uORB.h>
 
-MavlinkOrbSubscription::MavlinkOrbSubscription(const orb_id_t topic, int instance) :
+#ifdef MAVLINK_ORB_SUBSCRIPTION_SHARED
+/**
+ * Subscription and last copy of a topic, shared by all mavlink instances
+ */
+struct MavlinkOrbSubscription::SharedTopic {
+	SharedTopic *next;
+	orb_id_t topic;
+	uint8_t instance;
+	unsigned users;			///< number of MavlinkOrbSubscription objects using it
+	unsigned active_users;		///< number of users which are not idle, unsubscribed if 0
+	int fd;
+	bool published;
+	bool subscribe_from_beginning;
+	hrt_abstime last_pub_check;
+	uint8_t *data;			///< last copied data, allocated with the first copy
+	uint64_t time;			///< publication time of data
+	unsigned generation;		///< incremented with every copy, 0 if nothing was copied yet
+};
+
+MavlinkOrbSubscription::SharedTopic *MavlinkOrbSubscription::_shared_topics = nullptr;
+pthread_mutex_t MavlinkOrbSubscription::_shared_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif /* MAVLINK_ORB_SUBSCRIPTION_SHARED */
+
+/**
+ * Check if a topic has been published, and subscribe to it once it is
+ */
+static bool
+check_published(const orb_id_t topic, int instance, bool subscribe_from_beginning, int &fd, bool &published,
+		hrt_abstime &last_pub_check)
+{
+	// If we marked it as published no need to check again
+	if (published) {
+		return true;
+	}
+
+	hrt_abstime now = hrt_absolute_time();
+
+	if (now - last_pub_check < 300000) {
+		return false;
+	}
+
+	// We are checking now
+	last_pub_check = now;
+
+	// We don't want to subscribe to anything that does not exist
+	// in order to save memory and file descriptors.
+	// However, for some topics like vehicle_command_ack, we want to subscribe
+	// from the beginning in order not to miss the first publish respective advertise.
+	if (!subscribe_from_beginning && orb_exists(topic, instance)) {
+		return false;
+	}
+
+	if (fd < 0) {
+		fd = orb_subscribe_multi(topic, instance);
+	}
+
+	bool updated;
+	orb_check(fd, &updated);
+
+	if (updated) {
+		published = true;
+	}
+
+	// topic may have been last published before we subscribed
+	uint64_t time_topic = 0;
+
+	if (!published && orb_stat(fd, &time_topic) == PX4_OK) {
+		if (time_topic != 0) {
+			published = true;
+		}
+	}
+
+	return published;
+}
+
+MavlinkOrbSubscription::MavlinkOrbSubscription(const orb_id_t topic, int instance, bool shared) :
 	next(nullptr),
 	_topic(topic),
 	_fd(-1),
 	_instance(instance),
 	_published(false),
 	_subscribe_from_beginning(false),
-	_last_pub_check(0)
+	_last_pub_check(0),
+	_used(false),
+	_idle_checks(0),
+	_shared(nullptr),
+	_shared_generation(0),
+	_shared_active(false)
 {
+#ifdef MAVLINK_ORB_SUBSCRIPTION_SHARED
+
+	if (shared) {
+		/* falls back to a private subscription if the allocation fails */
+		_shared = acquire_shared(topic, instance);
+	}
+
+#endif
 }
 
 MavlinkOrbSubscription::~MavlinkOrbSubscription()
 {
+#ifdef MAVLINK_ORB_SUBSCRIPTION_SHARED
+
+	if (_shared) {
+		release_shared(_shared, _shared_active);
+	}
+
+#endif
+
 	if (_fd >= 0) {
 		orb_unsubscribe(_fd);
 	}
 }
 
+#ifdef MAVLINK_ORB_SUBSCRIPTION_SHARED
+MavlinkOrbSubscription::SharedTopic *
+MavlinkOrbSubscription::acquire_shared(const orb_id_t topic, int instance)
+{
+	pthread_mutex_lock(&_shared_mutex);
+
+	SharedTopic *shared;
+
+	LL_FOREACH(_shared_topics, shared) {
+		if (shared->topic == topic && shared->instance == instance) {
+			break;
+		}
+	}
+
+	if (shared == nullptr) {
+		shared = new SharedTopic{};
+
+		if (shared != nullptr) {
+			shared->topic = topic;
+			shared->instance = instance;
+			shared->fd = -1;
+			LL_APPEND(_shared_topics, shared);
+		}
+	}
+
+	if (shared != nullptr) {
+		++shared->users;
+	}
+
+	pthread_mutex_unlock(&_shared_mutex);
+
+	return shared;
+}
+
+void
+MavlinkOrbSubscription::release_shared(SharedTopic *shared, bool active)
+{
+	pthread_mutex_lock(&_shared_mutex);
+
+	if (active) {
+		--shared->active_users;
+	}
+
+	if (--shared->users == 0) {
+		LL_DELETE(_shared_topics, shared);
+
+		if (shared->fd >= 0) {
+			orb_unsubscribe(shared->fd);
+		}
+
+		delete[] shared->data;
+		delete shared;
+	}
+
+	pthread_mutex_unlock(&_shared_mutex);
+}
+
+void
+MavlinkOrbSubscription::activate_shared()
+{
+	if (!_shared_active) {
+		_shared_active = true;
+		++_shared->active_users;
+	}
+}
+
+void
+MavlinkOrbSubscription::update_shared(SharedTopic *shared)
+{
+	bool updated = false;
+
+	/* the first user after subscribing gets the current data even if it was published before */
+	if (shared->generation != 0 && (orb_check(shared->fd, &updated) != PX4_OK || !updated)) {
+		return;
+	}
+
+	if (shared->data == nullptr) {
+		shared->data = new uint8_t[shared->topic->o_size];
+
+		if (shared->data == nullptr) {
+			return;
+		}
+	}
+
+	uint64_t time_topic;
+
+	if (orb_stat(shared->fd, &time_topic)) {
+		/* error getting last topic publication time */
+		time_topic = 0;
+	}
+
+	if (orb_copy(shared->topic, shared->fd, shared->data) == PX4_OK) {
+		shared->time = time_topic;
+
+		if (++shared->generation == 0) {
+			shared->generation = 1;
+		}
+	}
+}
+
+bool
+MavlinkOrbSubscription::update_shared_copy(uint64_t *time, void *data, bool only_if_changed)
+{
+	bool copied = false;
+
+	pthread_mutex_lock(&_shared_mutex);
+
+	activate_shared();
+
+	if (check_published(_topic, _instance, _shared->subscribe_from_beginning, _shared->fd, _shared->published,
+			    _shared->last_pub_check)) {
+		update_shared(_shared);
+
+		/* the data is left untouched if there is nothing new (or copying the topic failed) */
+		const bool changed = only_if_changed ? _shared->generation != _shared_generation
+				     : (time == nullptr || _shared->time == 0 || _shared->time != *time);
+
+		if (_shared->generation != 0 && changed) {
+			if (data != nullptr) {
+				memcpy(data, _shared->data, _topic->o_size);
+			}
+
+			if (time != nullptr) {
+				*time = _shared->time;
+			}
+
+			_shared_generation = _shared->generation;
+			copied = true;
+		}
+	}
+
+	pthread_mutex_unlock(&_shared_mutex);
+
+	return copied;
+}
+#endif /* MAVLINK_ORB_SUBSCRIPTION_SHARED */
+
 orb_id_t
 MavlinkOrbSubscription::get_topic() const
 {
@@ -79,10 +312,32 @@ MavlinkOrbSubscription::get_instance() const
 	return _instance;
 }
 
+int
+MavlinkOrbSubscription::get_fd()
+{
+#ifdef MAVLINK_ORB_SUBSCRIPTION_SHARED
+
+	if (_shared) {
+		return _shared->fd;
+	}
+
+#endif
+
+	return _fd;
+}
+
 bool
 MavlinkOrbSubscription::update(uint64_t *time, void *data)
 {
+	_used = true;
+
+#ifdef MAVLINK_ORB_SUBSCRIPTION_SHARED
 
+	if (_shared) {
+		return update_shared_copy(time, data, false);
+	}
+
+#endif
 
 	// TODO this is NOT atomic operation, we can get data newer than time
 	// if topic was published between orb_stat and orb_copy calls.
@@ -112,6 +367,16 @@ MavlinkOrbSubscription::update(uint64_t *time, void *data)
 bool
 MavlinkOrbSubscription::update(void *data)
 {
+	_used = true;
+
+#ifdef MAVLINK_ORB_SUBSCRIPTION_SHARED
+
+	if (_shared) {
+		return update_shared_copy(nullptr, data, false);
+	}
+
+#endif
+
 	if (!is_published()) {
 		return false;
 	}
@@ -131,6 +396,16 @@ MavlinkOrbSubscription::update(void *data)
 bool
 MavlinkOrbSubscription::update_if_changed(void *data)
 {
+	_used = true;
+
+#ifdef MAVLINK_ORB_SUBSCRIPTION_SHARED
+
+	if (_shared) {
+		return update_shared_copy(nullptr, data, true);
+	}
+
+#endif
+
 	bool prevpub = _published;
 
 	if (!is_published()) {
@@ -155,53 +430,101 @@ MavlinkOrbSubscription::update_if_changed(void *data)
 bool
 MavlinkOrbSubscription::is_published()
 {
-	// If we marked it as published no need to check again
-	if (_published) {
-		return true;
+	_used = true;
+
+#ifdef MAVLINK_ORB_SUBSCRIPTION_SHARED
+
+	if (_shared) {
+		pthread_mutex_lock(&_shared_mutex);
+		activate_shared();
+		bool published = check_published(_topic, _instance, _shared->subscribe_from_beginning, _shared->fd,
+						 _shared->published, _shared->last_pub_check);
+		pthread_mutex_unlock(&_shared_mutex);
+		return published;
 	}
 
-	hrt_abstime now = hrt_absolute_time();
+#endif
 
-	if (now - _last_pub_check < 300000) {
-		return false;
+	return check_published(_topic, _instance, _subscribe_from_beginning, _fd, _published, _last_pub_check);
+}
+
+void
+MavlinkOrbSubscription::subscribe_from_beginning(bool from_beginning)
+{
+#ifdef MAVLINK_ORB_SUBSCRIPTION_SHARED
+
+	if (_shared) {
+		pthread_mutex_lock(&_shared_mutex);
+		_shared->subscribe_from_beginning = _shared->subscribe_from_beginning || from_beginning;
+		pthread_mutex_unlock(&_shared_mutex);
+		return;
 	}
 
-	// We are checking now
-	_last_pub_check = now;
+#endif
 
-	// We don't want to subscribe to anything that does not exist
-	// in order to save memory and file descriptors.
-	// However, for some topics like vehicle_command_ack, we want to subscribe
-	// from the beginning in order not to miss the first publish respective advertise.
-	if (!_subscribe_from_beginning && orb_exists(_topic, _instance)) {
+	_subscribe_from_beginning = from_beginning;
+}
+
+bool
+MavlinkOrbSubscription::release_if_idle()
+{
+	if (_used) {
+		_used = false;
+		_idle_checks = 0;
 		return false;
 	}
 
-	if (_fd < 0) {
-		_fd = orb_subscribe_multi(_topic, _instance);
+	if (_idle_checks < IDLE_RELEASE_CHECKS) {
+		++_idle_checks;
+		return false;
 	}
 
-	bool updated;
-	orb_check(_fd, &updated);
+#ifdef MAVLINK_ORB_SUBSCRIPTION_SHARED
 
-	if (updated) {
-		_published = true;
-	}
+	if (_shared) {
+		if (!_shared_active) {
+			return false;
+		}
 
-	// topic may have been last published before we subscribed
-	uint64_t time_topic = 0;
+		pthread_mutex_lock(&_shared_mutex);
 
-	if (!_published && orb_stat(_fd, &time_topic) == PX4_OK) {
-		if (time_topic != 0) {
-			_published = true;
+		_shared_active = false;
+
+		if (--_shared->active_users == 0 && _shared->fd >= 0 && !_shared->subscribe_from_beginning) {
+			orb_unsubscribe(_shared->fd);
+			_shared->fd = -1;
+			_shared->published = false;
+			_shared->last_pub_check = 0;
 		}
+
+		pthread_mutex_unlock(&_shared_mutex);
+		return true;
+	}
+
+#endif
+
+	/* topics subscribed from the beginning must not miss a publication */
+	if (_fd < 0 || _subscribe_from_beginning) {
+		return false;
 	}
 
-	return _published;
+	orb_unsubscribe(_fd);
+	_fd = -1;
+	_published = false;
+	_last_pub_check = 0;
+	return true;
 }
 
-void
-MavlinkOrbSubscription::subscribe_from_beginning(bool from_beginning)
+bool
+MavlinkOrbSubscription::is_subscribed() const
 {
-	_subscribe_from_beginning = from_beginning;
+#ifdef MAVLINK_ORB_SUBSCRIPTION_SHARED
+
+	if (_shared) {
+		return _shared_active && _shared->fd >= 0;
+	}
+
+#endif
+
+	return _fd >= 0;
 }
@@ -43,14 +43,27 @@
 
 #include <systemlib/uthash/utlist.h>
 #include <drivers/drv_hrt.h>
+#include <systemlib/mem_pool.h>
+#include <pthread.h>
 #include "uORB/uORB.h"	// orb_id_t
 
-class MavlinkOrbSubscription
+#if defined(__PX4_POSIX)
+/* uORB handles are valid process-wide: the instances can share a subscription per topic */
+#define MAVLINK_ORB_SUBSCRIPTION_SHARED
+#endif
+
+class MavlinkOrbSubscription : public MemPoolAllocated
 {
 public:
 	MavlinkOrbSubscription *next;	///< pointer to next subscription in list
 
-	MavlinkOrbSubscription(const orb_id_t topic, int instance);
+	/**
+	 * @param shared use the process-wide copy of the topic, which is shared by all the mavlink
+	 *               instances and only copied once per publication. This must not be used for
+	 *               topics with a queue, where each instance needs to receive all messages.
+	 *               Ignored if MAVLINK_ORB_SUBSCRIPTION_SHARED is not defined.
+	 */
+	MavlinkOrbSubscription(const orb_id_t topic, int instance, bool shared = false);
 	~MavlinkOrbSubscription();
 
 	/**
@@ -90,18 +103,69 @@ public:
 
 	void subscribe_from_beginning(bool from_beginning);
 
+	/**
+	 * Unsubscribe if the topic was not read during the last IDLE_RELEASE_CHECKS calls, e.g. because
+	 * the streams using it were disabled. The next update subscribes again, like a new subscription.
+	 * Shared topics are unsubscribed once all their users are idle.
+	 * Call this periodically from the thread using the subscription.
+	 *
+	 * @return true if this call released the subscription
+	 */
+	bool release_if_idle();
+
+	/**
+	 * @return true if the topic is currently subscribed by this object
+	 */
+	bool is_subscribed() const;
+
+	static constexpr uint8_t IDLE_RELEASE_CHECKS = 10;
+
 	orb_id_t get_topic() const;
 	int get_instance() const;
 
-	int get_fd() { return _fd; }
+	int get_fd();
 
 private:
+	struct SharedTopic;
+
 	const orb_id_t _topic;		///< topic metadata
 	int _fd;			///< subscription handle
 	const uint8_t _instance;		///< get topic instance
 	bool _published;		///< topic was ever published
 	bool _subscribe_from_beginning; ///< we need to subscribe from the beginning, e.g. for vehicle_command_acks
 	hrt_abstime _last_pub_check;	///< when we checked last
+	bool _used;			///< read since the last release_if_idle() call
+	uint8_t _idle_checks;		///< number of release_if_idle() calls without a read
+
+	SharedTopic *_shared;		///< shared copy of the topic, nullptr for a private subscription
+	unsigned _shared_generation;	///< generation of the shared data last returned by this subscription
+	bool _shared_active;		///< counted in the active users of the shared topic
+
+#ifdef MAVLINK_ORB_SUBSCRIPTION_SHARED
+	static SharedTopic *_shared_topics;	///< all the shared topics, protected by _shared_mutex
+	static pthread_mutex_t _shared_mutex;
+
+	static SharedTopic *acquire_shared(const orb_id_t topic, int instance);
+	static void release_shared(SharedTopic *shared, bool active);
+
+	/**
+	 * count this object in the active users of the shared topic (called with _shared_mutex held)
+	 */
+	void activate_shared();
+
+	/**
+	 * check for a publication and copy it into the shared buffer (called with _shared_mutex held)
+	 */
+	static void update_shared(SharedTopic *shared);
+
+	/**
+	 * copy the shared data if it changed since the last call (only_if_changed), or if its publication time differs
+	 * from *time (or in any case if time is nullptr). data and *time are left untouched if nothing is copied.
+	 * @param time set to the publication time of the data
+	 * @return true if data was copied
+	 */
+	bool update_shared_copy(uint64_t *time, void *data, bool only_if_changed);
+#endif /* MAVLINK_ORB_SUBSCRIPTION_SHARED */
 
 	/* do not allow copying this class */
 	MavlinkOrbSubscription(const MavlinkOrbSubscription &);
@@ -48,9 +48,17 @@
 #include "mavlink_main.h"
 
 #define HASH_PARAM "_HASH_CHECK"
+#define HASH_DELTA_PARAM "_HASH_DELTA"
 
 MavlinkParametersManager::MavlinkParametersManager(Mavlink *mavlink) :
 	_send_all_index(-1),
+	_hash_history{},
+	_hash_history_count(0),
+	_hash_history_next(0),
+	_delta_params{},
+	_delta_count(-1),
+	_delta_index(0),
+	_delta_change_count(0),
 	_uavcan_open_request_list(nullptr),
 	_uavcan_waiting_for_request_response(false),
 	_uavcan_queued_request_items(0),
@@ -89,6 +97,9 @@ MavlinkParametersManager::handle_message(const mavlink_message_t *msg)
 
 			if (req_list.target_system == mavlink_system.sysid &&
 			    (req_list.target_component == mavlink_system.compid || req_list.target_component == MAV_COMP_ID_ALL)) {
+				/* a full list supersedes a delta transfer */
+				_delta_count = -1;
+
 				if (_send_all_index < 0) {
 					_send_all_index = PARAM_HASH;
 
@@ -134,10 +145,19 @@ MavlinkParametersManager::handle_message(const mavlink_message_t *msg)
 				/* Whatever the value is, we're being told to stop sending */
 				if (strncmp(name, "_HASH_CHECK", sizeof(name)) == 0) {
 					_send_all_index = -1;
+					_delta_count = -1;
 					/* No other action taken, return */
 					return;
 				}
 
+				/* the ground station has the parameters with the given hash cached, send only the changes */
+				if (strncmp(name, HASH_DELTA_PARAM, sizeof(name)) == 0) {
+					uint32_t hash;
+					memcpy(&hash, &set.param_value, sizeof(hash));
+					start_delta_transfer(hash);
+					return;
+				}
+
 				/* attempt to find parameter, set and send it */
 				param_t param = param_find_no_notification(name);
 
@@ -208,16 +228,7 @@ MavlinkParametersManager::handle_message(const mavlink_message_t *msg)
 					/* XXX: I left this in so older versions of QGC wouldn't break */
 					if (strncmp(req_read.param_id, HASH_PARAM, MAVLINK_MSG_PARAM_VALUE_FIELD_PARAM_ID_LEN) == 0) {
 						/* return hash check for cached params */
-						uint32_t hash = param_hash_check();
-
-						/* build the one-off response message */
-						mavlink_param_value_t param_value;
-						param_value.param_count = param_count_used();
-						param_value.param_index = -1;
-						strncpy(param_value.param_id, HASH_PARAM, MAVLINK_MSG_PARAM_VALUE_FIELD_PARAM_ID_LEN);
-						param_value.param_type = MAV_PARAM_TYPE_UINT32;
-						memcpy(&param_value.param_value, &hash, sizeof(hash));
-						mavlink_msg_param_value_send_struct(_mavlink->get_channel(), &param_value);
+						send_hash_check(param_change_count());
 
 					} else {
 						/* local name buffer to enforce null-terminated string */
@@ -384,6 +395,24 @@ MavlinkParametersManager::send_one()
 						    &msg);
 		_mavlink_resend_uart(_mavlink->get_channel(), &mavlink_packet);
 
+	} else if (_delta_count >= 0 && _mavlink->boot_complete()) {
+		/* send the changed parameters of a delta request */
+
+		/* skip if no space is available */
+		if (!space_available) {
+			return false;
+		}
+
+		if (_delta_index < _delta_count) {
+			send_param(_delta_params[_delta_index++]);
+			return true;
+		}
+
+		/* the current hash terminates the transfer */
+		send_hash_check(_delta_change_count);
+		_delta_count = -1;
+		return false;
+
 	} else if (_send_all_index >= 0 && _mavlink->boot_complete()) {
 		/* send all parameters if requested, but only after the system has booted */
 
@@ -397,16 +426,7 @@ MavlinkParametersManager::send_one()
 		 */
 		if (_send_all_index == PARAM_HASH) {
 			/* return hash check for cached params */
-			uint32_t hash = param_hash_check();
-
-			/* build the one-off response message */
-			mavlink_param_value_t msg;
-			msg.param_count = param_count_used();
-			msg.param_index = -1;
-			strncpy(msg.param_id, HASH_PARAM, MAVLINK_MSG_PARAM_VALUE_FIELD_PARAM_ID_LEN);
-			msg.param_type = MAV_PARAM_TYPE_UINT32;
-			memcpy(&msg.param_value, &hash, sizeof(hash));
-			mavlink_msg_param_value_send_struct(_mavlink->get_channel(), &msg);
+			send_hash_check(param_change_count());
 
 			/* after this we should start sending all params */
 			_send_all_index = 0;
@@ -506,6 +526,78 @@ MavlinkParametersManager::send_param(param_t param, int component_id)
 	return 0;
 }
 
+void
+MavlinkParametersManager::send_hash_check(uint32_t change_count)
+{
+	/* the hash is cached by the param module, it is only recomputed after changes */
+	uint32_t hash = param_hash_check();
+
+	/* build the one-off response message */
+	mavlink_param_value_t msg;
+	msg.param_count = param_count_used();
+	msg.param_index = -1;
+	strncpy(msg.param_id, HASH_PARAM, MAVLINK_MSG_PARAM_VALUE_FIELD_PARAM_ID_LEN);
+	msg.param_type = MAV_PARAM_TYPE_UINT32;
+	memcpy(&msg.param_value, &hash, sizeof(hash));
+	mavlink_msg_param_value_send_struct(_mavlink->get_channel(), &msg);
+
+	/* remember the hash, replacing an older entry with the same hash */
+	int index = _hash_history_next;
+
+	for (int i = 0; i < _hash_history_count; i++) {
+		if (_hash_history[i].hash == hash) {
+			index = i;
+			break;
+		}
+	}
+
+	_hash_history[index].hash = hash;
+	_hash_history[index].change_count = change_count;
+
+	if (index == _hash_history_next) {
+		_hash_history_next = (_hash_history_next + 1) % HASH_HISTORY_SIZE;
+
+		if (_hash_history_count < HASH_HISTORY_SIZE) {
+			++_hash_history_count;
+		}
+	}
+}
+
+void
+MavlinkParametersManager::start_delta_transfer(uint32_t hash)
+{
+	/* read the change count first: changes occurring in between are sent again, but never missed */
+	const uint32_t change_count = param_change_count();
+	int num_changed = -1;
+
+	for (int i = 0; i < _hash_history_count; i++) {
+		if (_hash_history[i].hash == hash) {
+			num_changed = param_changed_since(_hash_history[i].change_count, _delta_params, PARAM_CHANGE_HISTORY_SIZE);
+			break;
+		}
+	}
+
+	if (num_changed < 0) {
+		/* unknown hash or too many changes: fall back to sending everything, starting with the hash */
+		_delta_count = -1;
+		_send_all_index = PARAM_HASH;
+		return;
+	}
+
+	/* only send the used parameters, others are not known to the ground station */
+	_delta_count = 0;
+
+	for (int i = 0; i < num_changed; i++) {
+		if (param_used(_delta_params[i])) {
+			_delta_params[_delta_count++] = _delta_params[i];
+		}
+	}
+
+	_delta_index = 0;
+	_delta_change_count = change_count;
+	_send_all_index = -1;
+}
+
 void MavlinkParametersManager::request_next_uavcan_parameter()
 {
 	// Request a parameter if we are not already waiting on a response and if the list is not empty
@@ -70,6 +70,23 @@ public:
 private:
 	int		_send_all_index;
 
+	/* hashes reported to the ground station, with the parameter change count at that time */
+	struct HashHistoryItem {
+		uint32_t hash;
+		uint32_t change_count;
+	};
+
+	static constexpr int HASH_HISTORY_SIZE = 4;
+
+	HashHistoryItem	_hash_history[HASH_HISTORY_SIZE];
+	int		_hash_history_count;
+	int		_hash_history_next;
+
+	param_t		_delta_params[PARAM_CHANGE_HISTORY_SIZE]; ///< parameters to send for a delta request
+	int		_delta_count; ///< number of entries in _delta_params, -1 if no delta transfer is active
+	int		_delta_index; ///< next entry of _delta_params to send
+	uint32_t	_delta_change_count; ///< parameter change count at the start of the delta transfer
+
 	/* do not allow top copying this class */
 	MavlinkParametersManager(MavlinkParametersManager &);
 	MavlinkParametersManager &operator = (const MavlinkParametersManager &);
@@ -81,6 +98,19 @@ protected:
 
 	int send_param(param_t param, int component_id = -1);
 
+	/**
+	 * send the hash of all parameters (_HASH_CHECK), and remember it for delta requests
+	 * @param change_count the parameter change count (param_change_count()) from which on the
+	 *                     ground station will receive all changes
+	 */
+	void send_hash_check(uint32_t change_count);
+
+	/**
+	 * start sending the parameters which changed since the ground station received the given hash,
+	 * or all parameters if the changes are not known
+	 */
+	void start_delta_transfer(uint32_t hash);
+
 	// Item of a single-linked list to store requested uavcan parameters
 	struct _uavcan_open_request_list_item {
 		uavcan_parameter_request_s req;
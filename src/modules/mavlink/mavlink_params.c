@@ -113,6 +113,18 @@ PARAM_DEFINE_INT32(MAV_FWDEXTSP, 1);
  */
 PARAM_DEFINE_INT32(MAV_BROADCAST, 0);
 
+/**
+ * Send only the changed lines of repeated screen refreshes in the MAVLink shell
+ *
+ * Reduces the bandwidth of commands like top, which redraw the whole screen.
+ * Requires a terminal that supports cursor movement (VT100). Taken into account
+ * when the shell is started.
+ *
+ * @boolean
+ * @group MAVLink
+ */
+PARAM_DEFINE_INT32(MAV_SH_DIFF, 0);
+
 /**
  * Test parameter
  *
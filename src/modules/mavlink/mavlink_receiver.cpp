@@ -73,6 +73,7 @@
 
 #include <mathlib/mathlib.h>
 
+#include <conversion/attitude.h>
 #include <conversion/rotation.h>
 
 #include <systemlib/param/param.h>
@@ -150,6 +151,7 @@ MavlinkReceiver::MavlinkReceiver(Mavlink *parent) :
 	_hil_local_alt0(0.0f),
 	_hil_local_proj_ref{},
 	_offboard_control_mode{},
+	_offboard_control_mode_published{},
 	_att_sp{},
 	_rates_sp{},
 	_time_offset_avg_alpha(0.8),
@@ -159,7 +161,10 @@ MavlinkReceiver::MavlinkReceiver(Mavlink *parent) :
 	_mom_switch_state(0),
 	_p_bat_emergen_thr(param_find("BAT_EMERGEN_THR")),
 	_p_bat_crit_thr(param_find("BAT_CRIT_THR")),
-	_p_bat_low_thr(param_find("BAT_LOW_THR"))
+	_p_bat_low_thr(param_find("BAT_LOW_THR")),
+	_message_count{},
+	_message_count_other(0),
+	_deferred_count(0)
 {
 }
 
@@ -191,209 +196,203 @@ void MavlinkReceiver::acknowledge(uint8_t sysid, uint8_t compid, uint16_t comman
 	}
 }
 
-void
-MavlinkReceiver::handle_message(mavlink_message_t *msg)
-{
-	if (!_mavlink->get_config_link_on()) {
-		if (_mavlink->get_mode() == Mavlink::MAVLINK_MODE_CONFIG) {
-			_mavlink->set_config_link_on(true);
-		}
-	}
-
-	switch (msg->msgid) {
-	case MAVLINK_MSG_ID_COMMAND_LONG:
-		if (_mavlink->accepting_commands()) {
-			handle_message_command_long(msg);
-		}
-
-		break;
+/*
+ * Receiver handlers and the components consuming each message. Must be kept sorted by message ID,
+ * as it is searched with a binary search. A message is offered to the components only if it has an
+ * entry, so a component handling a new message requires an entry here as well.
+ */
+const MavlinkReceiver::MessageHandler MavlinkReceiver::_message_handlers[] = {
+	{MAVLINK_MSG_ID_HEARTBEAT, &MavlinkReceiver::handle_message_heartbeat, 0},
+	{MAVLINK_MSG_ID_SYSTEM_TIME, &MavlinkReceiver::handle_message_system_time, 0},
+	{MAVLINK_MSG_ID_PING, &MavlinkReceiver::handle_message_ping, 0},
+	{MAVLINK_MSG_ID_SET_MODE, &MavlinkReceiver::handle_message_set_mode, HANDLER_REQUIRES_COMMANDS},
+	{MAVLINK_MSG_ID_PARAM_REQUEST_READ, nullptr, HANDLER_PARAMETERS},
+	{MAVLINK_MSG_ID_PARAM_REQUEST_LIST, nullptr, HANDLER_PARAMETERS},
+	{MAVLINK_MSG_ID_PARAM_SET, nullptr, HANDLER_PARAMETERS},
+	{MAVLINK_MSG_ID_MISSION_ITEM, nullptr, HANDLER_MISSION},
+	{MAVLINK_MSG_ID_MISSION_REQUEST, nullptr, HANDLER_MISSION},
+	{MAVLINK_MSG_ID_MISSION_SET_CURRENT, nullptr, HANDLER_MISSION},
+	{MAVLINK_MSG_ID_MISSION_REQUEST_LIST, nullptr, HANDLER_MISSION},
+	{MAVLINK_MSG_ID_MISSION_COUNT, nullptr, HANDLER_MISSION},
+	{MAVLINK_MSG_ID_MISSION_CLEAR_ALL, nullptr, HANDLER_MISSION},
+	{MAVLINK_MSG_ID_MISSION_ACK, nullptr, HANDLER_MISSION},
+	{MAVLINK_MSG_ID_GPS_GLOBAL_ORIGIN, &MavlinkReceiver::handle_message_gps_global_origin, 0},
+	{MAVLINK_MSG_ID_PARAM_MAP_RC, nullptr, HANDLER_PARAMETERS},
+	{MAVLINK_MSG_ID_MISSION_REQUEST_INT, nullptr, HANDLER_MISSION},
+	{MAVLINK_MSG_ID_ATTITUDE_QUATERNION_COV, &MavlinkReceiver::handle_message_attitude_quaternion_cov, 0},
+	{MAVLINK_MSG_ID_LOCAL_POSITION_NED_COV, &MavlinkReceiver::handle_message_local_position_ned_cov, 0},
+	{MAVLINK_MSG_ID_REQUEST_DATA_STREAM, &MavlinkReceiver::handle_message_request_data_stream, HANDLER_REQUIRES_COMMANDS},
+	{MAVLINK_MSG_ID_MANUAL_CONTROL, &MavlinkReceiver::handle_message_manual_control, 0},
+	{MAVLINK_MSG_ID_RC_CHANNELS_OVERRIDE, &MavlinkReceiver::handle_message_rc_channels_override, 0},
+	{MAVLINK_MSG_ID_MISSION_ITEM_INT, nullptr, HANDLER_MISSION},
+	{MAVLINK_MSG_ID_COMMAND_INT, &MavlinkReceiver::handle_message_command_int, HANDLER_REQUIRES_COMMANDS},
+	{MAVLINK_MSG_ID_COMMAND_LONG, &MavlinkReceiver::handle_message_command_long, HANDLER_REQUIRES_COMMANDS},
+	{MAVLINK_MSG_ID_COMMAND_ACK, &MavlinkReceiver::handle_message_command_ack, 0},
+	{MAVLINK_MSG_ID_SET_ATTITUDE_TARGET, &MavlinkReceiver::handle_message_set_attitude_target, 0},
+	{MAVLINK_MSG_ID_SET_POSITION_TARGET_LOCAL_NED, &MavlinkReceiver::handle_message_set_position_target_local_ned, 0},
+	{MAVLINK_MSG_ID_VISION_POSITION_ESTIMATE, &MavlinkReceiver::handle_message_vision_position_estimate, 0},
+	{MAVLINK_MSG_ID_OPTICAL_FLOW_RAD, &MavlinkReceiver::handle_message_optical_flow_rad, 0},
+	{MAVLINK_MSG_ID_HIL_SENSOR, &MavlinkReceiver::handle_message_hil_sensor, HANDLER_HIL_ONLY},
+	{MAVLINK_MSG_ID_RADIO_STATUS, &MavlinkReceiver::handle_message_radio_status, 0},
+	{MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL, nullptr, HANDLER_FTP},
+	{MAVLINK_MSG_ID_TIMESYNC, &MavlinkReceiver::handle_message_timesync, 0},
+	{MAVLINK_MSG_ID_HIL_GPS, &MavlinkReceiver::handle_message_hil_gps, HANDLER_HIL_GPS},
+	{MAVLINK_MSG_ID_HIL_OPTICAL_FLOW, &MavlinkReceiver::handle_message_hil_optical_flow, HANDLER_HIL_ONLY},
+	{MAVLINK_MSG_ID_HIL_STATE_QUATERNION, &MavlinkReceiver::handle_message_hil_state_quaternion, HANDLER_HIL_ONLY},
+	{MAVLINK_MSG_ID_LOG_REQUEST_LIST, nullptr, HANDLER_LOG},
+	{MAVLINK_MSG_ID_LOG_REQUEST_DATA, nullptr, HANDLER_LOG},
+	{MAVLINK_MSG_ID_LOG_ERASE, nullptr, HANDLER_LOG},
+	{MAVLINK_MSG_ID_LOG_REQUEST_END, nullptr, HANDLER_LOG},
+	{MAVLINK_MSG_ID_SERIAL_CONTROL, &MavlinkReceiver::handle_message_serial_control, 0},
+	{MAVLINK_MSG_ID_DISTANCE_SENSOR, &MavlinkReceiver::handle_message_distance_sensor, 0},
+	{MAVLINK_MSG_ID_ATT_POS_MOCAP, &MavlinkReceiver::handle_message_att_pos_mocap, 0},
+	{MAVLINK_MSG_ID_SET_ACTUATOR_CONTROL_TARGET, &MavlinkReceiver::handle_message_set_actuator_control_target, 0},
+	{MAVLINK_MSG_ID_FOLLOW_TARGET, &MavlinkReceiver::handle_message_follow_target, 0},
+	{MAVLINK_MSG_ID_BATTERY_STATUS, &MavlinkReceiver::handle_message_battery_status, 0},
+	{MAVLINK_MSG_ID_GPS_RTCM_DATA, &MavlinkReceiver::handle_message_gps_rtcm_data, 0},
+	{MAVLINK_MSG_ID_ADSB_VEHICLE, &MavlinkReceiver::handle_message_adsb_vehicle, 0},
+	{MAVLINK_MSG_ID_COLLISION, &MavlinkReceiver::handle_message_collision, 0},
+	{MAVLINK_MSG_ID_DEBUG_VECT, &MavlinkReceiver::handle_message_debug_vect, 0},
+	{MAVLINK_MSG_ID_NAMED_VALUE_FLOAT, &MavlinkReceiver::handle_message_named_value_float, 0},
+	{MAVLINK_MSG_ID_DEBUG, &MavlinkReceiver::handle_message_debug, 0},
+	{MAVLINK_MSG_ID_PLAY_TUNE, &MavlinkReceiver::handle_message_play_tune, 0},
+	{MAVLINK_MSG_ID_LOGGING_ACK, &MavlinkReceiver::handle_message_logging_ack, 0},
+};
 
-	case MAVLINK_MSG_ID_COMMAND_INT:
-		if (_mavlink->accepting_commands()) {
-			handle_message_command_int(msg);
-		}
+int
+MavlinkReceiver::find_message_handler(uint32_t msgid)
+{
+	static_assert(sizeof(_message_handlers) / sizeof(_message_handlers[0]) == MESSAGE_HANDLER_COUNT,
+		      "MESSAGE_HANDLER_COUNT does not match the handler table");
 
-		break;
+	int low = 0;
+	int high = MESSAGE_HANDLER_COUNT - 1;
 
-	case MAVLINK_MSG_ID_COMMAND_ACK:
-		handle_message_command_ack(msg);
-		break;
+	while (low <= high) {
+		const int mid = (low + high) / 2;
 
-	case MAVLINK_MSG_ID_OPTICAL_FLOW_RAD:
-		handle_message_optical_flow_rad(msg);
-		break;
+		if (_message_handlers[mid].msgid < msgid) {
+			low = mid + 1;
 
-	case MAVLINK_MSG_ID_PING:
-		handle_message_ping(msg);
-		break;
+		} else if (_message_handlers[mid].msgid > msgid) {
+			high = mid - 1;
 
-	case MAVLINK_MSG_ID_SET_MODE:
-		if (_mavlink->accepting_commands()) {
-			handle_message_set_mode(msg);
+		} else {
+			return mid;
 		}
+	}
 
-		break;
-
-	case MAVLINK_MSG_ID_ATT_POS_MOCAP:
-		handle_message_att_pos_mocap(msg);
-		break;
-
-	case MAVLINK_MSG_ID_SET_POSITION_TARGET_LOCAL_NED:
-		handle_message_set_position_target_local_ned(msg);
-		break;
-
-	case MAVLINK_MSG_ID_SET_ATTITUDE_TARGET:
-		handle_message_set_attitude_target(msg);
-		break;
-
-	case MAVLINK_MSG_ID_SET_ACTUATOR_CONTROL_TARGET:
-		handle_message_set_actuator_control_target(msg);
-		break;
-
-	case MAVLINK_MSG_ID_VISION_POSITION_ESTIMATE:
-		handle_message_vision_position_estimate(msg);
-		break;
-
-	case MAVLINK_MSG_ID_ATTITUDE_QUATERNION_COV:
-		handle_message_attitude_quaternion_cov(msg);
-		break;
-
-	case MAVLINK_MSG_ID_LOCAL_POSITION_NED_COV:
-		handle_message_local_position_ned_cov(msg);
-		break;
-
-	case MAVLINK_MSG_ID_GPS_GLOBAL_ORIGIN:
-		handle_message_gps_global_origin(msg);
-		break;
-
-	case MAVLINK_MSG_ID_RADIO_STATUS:
-		handle_message_radio_status(msg);
-		break;
-
-	case MAVLINK_MSG_ID_MANUAL_CONTROL:
-		handle_message_manual_control(msg);
-		break;
-
-	case MAVLINK_MSG_ID_RC_CHANNELS_OVERRIDE:
-		handle_message_rc_channels_override(msg);
-		break;
-
-	case MAVLINK_MSG_ID_HEARTBEAT:
-		handle_message_heartbeat(msg);
-		break;
+	return -1;
+}
 
-	case MAVLINK_MSG_ID_REQUEST_DATA_STREAM:
-		if (_mavlink->accepting_commands()) {
-			handle_message_request_data_stream(msg);
+void
+MavlinkReceiver::handle_message(mavlink_message_t *msg)
+{
+	if (!_mavlink->get_config_link_on()) {
+		if (_mavlink->get_mode() == Mavlink::MAVLINK_MODE_CONFIG) {
+			_mavlink->set_config_link_on(true);
 		}
+	}
 
-		break;
-
-	case MAVLINK_MSG_ID_SYSTEM_TIME:
-		handle_message_system_time(msg);
-		break;
-
-	case MAVLINK_MSG_ID_TIMESYNC:
-		handle_message_timesync(msg);
-		break;
-
-	case MAVLINK_MSG_ID_DISTANCE_SENSOR:
-		handle_message_distance_sensor(msg);
-		break;
+	const int index = find_message_handler(msg->msgid);
 
-	case MAVLINK_MSG_ID_FOLLOW_TARGET:
-		handle_message_follow_target(msg);
-		break;
+	if (index >= 0) {
+		const MessageHandler &entry = _message_handlers[index];
+		bool handle = true;
 
-	case MAVLINK_MSG_ID_ADSB_VEHICLE:
-		handle_message_adsb_vehicle(msg);
-		break;
+		++_message_count[index];
 
-	case MAVLINK_MSG_ID_COLLISION:
-		handle_message_collision(msg);
-		break;
+		if (entry.flags & HANDLER_REQUIRES_COMMANDS) {
+			handle = _mavlink->accepting_commands();
 
-	case MAVLINK_MSG_ID_GPS_RTCM_DATA:
-		handle_message_gps_rtcm_data(msg);
-		break;
-
-	case MAVLINK_MSG_ID_BATTERY_STATUS:
-		handle_message_battery_status(msg);
-		break;
+		} else if (entry.flags & HANDLER_HIL_ONLY) {
+			/*
+			 * Only decode hil messages in HIL mode.
+			 *
+			 * The HIL mode is enabled by the HIL bit flag
+			 * in the system mode. Either send a set mode
+			 * COMMAND_LONG message or a SET_MODE message
+			 */
+			handle = _mavlink->get_hil_enabled();
 
-	case MAVLINK_MSG_ID_SERIAL_CONTROL:
-		handle_message_serial_control(msg);
-		break;
+		} else if (entry.flags & HANDLER_HIL_GPS) {
+			/*
+			 * Accept HIL GPS messages if use_hil_gps flag is true.
+			 * This allows to provide fake gps measurements to the system.
+			 */
+			handle = _mavlink->get_hil_enabled() ||
+				 (_mavlink->get_use_hil_gps() && msg->sysid == mavlink_system.sysid);
+		}
 
-	case MAVLINK_MSG_ID_LOGGING_ACK:
-		handle_message_logging_ack(msg);
-		break;
+		if (handle && entry.handler != nullptr) {
+			(this->*entry.handler)(msg);
+		}
 
-	case MAVLINK_MSG_ID_PLAY_TUNE:
-		handle_message_play_tune(msg);
-		break;
+		if (entry.flags & HANDLER_MISSION) {
+			_mission_manager.handle_message(msg);
+		}
 
-	case MAVLINK_MSG_ID_NAMED_VALUE_FLOAT:
-		handle_message_named_value_float(msg);
-		break;
+		if (entry.flags & HANDLER_PARAMETERS) {
+			_parameters_manager.handle_message(msg);
+		}
 
-	case MAVLINK_MSG_ID_DEBUG:
-		handle_message_debug(msg);
-		break;
+		if ((entry.flags & HANDLER_FTP) && _mavlink->ftp_enabled()) {
+			_mavlink_ftp.handle_message(msg);
+		}
 
-	case MAVLINK_MSG_ID_DEBUG_VECT:
-		handle_message_debug_vect(msg);
-		break;
+		if (entry.flags & HANDLER_LOG) {
+			_mavlink_log_handler.handle_message(msg);
+		}
 
-	default:
-		break;
+	} else {
+		++_message_count_other;
 	}
 
-	/*
-	 * Only decode hil messages in HIL mode.
-	 *
-	 * The HIL mode is enabled by the HIL bit flag
-	 * in the system mode. Either send a set mode
-	 * COMMAND_LONG message or a SET_MODE message
-	 *
-	 * Accept HIL GPS messages if use_hil_gps flag is true.
-	 * This allows to provide fake gps measurements to the system.
-	 */
-	if (_mavlink->get_hil_enabled()) {
-		switch (msg->msgid) {
-		case MAVLINK_MSG_ID_HIL_SENSOR:
-			handle_message_hil_sensor(msg);
-			break;
+	/* handle packet with parent object */
+	_mavlink->handle_message(msg);
 
-		case MAVLINK_MSG_ID_HIL_STATE_QUATERNION:
-			handle_message_hil_state_quaternion(msg);
-			break;
+	/* If we've received a valid message, mark the flag indicating so.
+	   This is used in the '-w' command-line flag. */
+	_mavlink->set_has_received_messages(true);
+}
 
-		case MAVLINK_MSG_ID_HIL_OPTICAL_FLOW:
-			handle_message_hil_optical_flow(msg);
-			break;
+void
+MavlinkReceiver::update_control_mode()
+{
+	bool updated;
+	orb_check(_control_mode_sub, &updated);
 
-		default:
-			break;
-		}
+	if (updated) {
+		orb_copy(ORB_ID(vehicle_control_mode), _control_mode_sub, &_control_mode);
 	}
+}
 
+void
+MavlinkReceiver::publish_offboard_control_mode(const offboard_control_mode_s &offboard_control_mode)
+{
+	const offboard_control_mode_s &last = _offboard_control_mode_published;
+
+	const bool changed = offboard_control_mode.ignore_thrust != last.ignore_thrust ||
+			     offboard_control_mode.ignore_attitude != last.ignore_attitude ||
+			     offboard_control_mode.ignore_bodyrate != last.ignore_bodyrate ||
+			     offboard_control_mode.ignore_position != last.ignore_position ||
+			     offboard_control_mode.ignore_velocity != last.ignore_velocity ||
+			     offboard_control_mode.ignore_acceleration_force != last.ignore_acceleration_force ||
+			     offboard_control_mode.ignore_alt_hold != last.ignore_alt_hold;
+
+	if (!changed && _offboard_control_mode_pub != nullptr &&
+	    offboard_control_mode.timestamp < last.timestamp + OFFBOARD_CONTROL_MODE_INTERVAL) {
+		return;
+	}
 
-	if (_mavlink->get_hil_enabled() || (_mavlink->get_use_hil_gps() && msg->sysid == mavlink_system.sysid)) {
-		switch (msg->msgid) {
-		case MAVLINK_MSG_ID_HIL_GPS:
-			handle_message_hil_gps(msg);
-			break;
+	_offboard_control_mode_published = offboard_control_mode;
 
-		default:
-			break;
-		}
+	if (_offboard_control_mode_pub == nullptr) {
+		_offboard_control_mode_pub = orb_advertise(ORB_ID(offboard_control_mode), &offboard_control_mode);
 
+	} else {
+		orb_publish(ORB_ID(offboard_control_mode), _offboard_control_mode_pub, &offboard_control_mode);
 	}
-
-	/* If we've received a valid message, mark the flag indicating so.
-	   This is used in the '-w' command-line flag. */
-	_mavlink->set_has_received_messages(true);
 }
 
 bool
@@ -874,23 +873,11 @@ MavlinkReceiver::handle_message_set_position_target_local_ned(mavlink_message_t
 
 		offboard_control_mode.timestamp = hrt_absolute_time();
 
-		if (_offboard_control_mode_pub == nullptr) {
-			_offboard_control_mode_pub = orb_advertise(ORB_ID(offboard_control_mode), &offboard_control_mode);
-
-		} else {
-			orb_publish(ORB_ID(offboard_control_mode), _offboard_control_mode_pub, &offboard_control_mode);
-		}
+		publish_offboard_control_mode(offboard_control_mode);
 
 		/* If we are in offboard control mode and offboard control loop through is enabled
 		 * also publish the setpoint topic which is read by the controller */
 		if (_mavlink->get_forward_externalsp()) {
-			bool updated;
-			orb_check(_control_mode_sub, &updated);
-
-			if (updated) {
-				orb_copy(ORB_ID(vehicle_control_mode), _control_mode_sub, &_control_mode);
-			}
-
 			if (_control_mode.flag_control_offboard_enabled) {
 				if (is_force_sp && offboard_control_mode.ignore_position &&
 				    offboard_control_mode.ignore_velocity) {
@@ -1055,22 +1042,10 @@ MavlinkReceiver::handle_message_set_actuator_control_target(mavlink_message_t *m
 
 		offboard_control_mode.timestamp = hrt_absolute_time();
 
-		if (_offboard_control_mode_pub == nullptr) {
-			_offboard_control_mode_pub = orb_advertise(ORB_ID(offboard_control_mode), &offboard_control_mode);
-
-		} else {
-			orb_publish(ORB_ID(offboard_control_mode), _offboard_control_mode_pub, &offboard_control_mode);
-		}
+		publish_offboard_control_mode(offboard_control_mode);
 
 
 		/* If we are in offboard control mode, publish the actuator controls */
-		bool updated;
-		orb_check(_control_mode_sub, &updated);
-
-		if (updated) {
-			orb_copy(ORB_ID(vehicle_control_mode), _control_mode_sub, &_control_mode);
-		}
-
 		if (_control_mode.flag_control_offboard_enabled) {
 
 			actuator_controls.timestamp = hrt_absolute_time();
@@ -1253,23 +1228,11 @@ MavlinkReceiver::handle_message_set_attitude_target(mavlink_message_t *msg)
 
 		_offboard_control_mode.timestamp = hrt_absolute_time();
 
-		if (_offboard_control_mode_pub == nullptr) {
-			_offboard_control_mode_pub = orb_advertise(ORB_ID(offboard_control_mode), &_offboard_control_mode);
-
-		} else {
-			orb_publish(ORB_ID(offboard_control_mode), _offboard_control_mode_pub, &_offboard_control_mode);
-		}
+		publish_offboard_control_mode(_offboard_control_mode);
 
 		/* If we are in offboard control mode and offboard control loop through is enabled
 		 * also publish the setpoint topic which is read by the controller */
 		if (_mavlink->get_forward_externalsp()) {
-			bool updated;
-			orb_check(_control_mode_sub, &updated);
-
-			if (updated) {
-				orb_copy(ORB_ID(vehicle_control_mode), _control_mode_sub, &_control_mode);
-			}
-
 			if (_control_mode.flag_control_offboard_enabled) {
 
 				/* Publish attitude setpoint if attitude and thrust ignore bits are not set */
@@ -2098,6 +2061,7 @@ void MavlinkReceiver::handle_message_gps_rtcm_data(mavlink_message_t *msg)
 	mavlink_msg_gps_rtcm_data_decode(msg, &gps_rtcm_data_msg);
 
 	gps_inject_data_s gps_inject_data_topic = {};
+	gps_inject_data_topic.timestamp = hrt_absolute_time();
 	gps_inject_data_topic.len = math::min((int)sizeof(gps_rtcm_data_msg.data),
 					      (int)sizeof(uint8_t) * gps_rtcm_data_msg.len);
 	gps_inject_data_topic.flags = gps_rtcm_data_msg.flags;
@@ -2145,9 +2109,11 @@ MavlinkReceiver::handle_message_hil_state_quaternion(mavlink_message_t *msg)
 	{
 		hil_attitude = {};
 		hil_attitude.timestamp = timestamp;
+		hil_attitude.timestamp_sample = timestamp;
 
 		matrix::Quatf q(hil_state.attitude_quaternion);
 		q.copyTo(hil_attitude.q);
+		set_attitude_representations(hil_attitude);
 
 		hil_attitude.rollspeed = hil_state.rollspeed;
 		hil_attitude.pitchspeed = hil_state.pitchspeed;
@@ -2366,6 +2332,18 @@ MavlinkReceiver::receive_thread(void *arg)
 #ifdef __PX4_POSIX
 	/* 1500 is the Wifi MTU, so we make sure to fit a full packet */
 	uint8_t buf[1600 * 5];
+#ifdef MAVLINK_UDP_BATCHING
+	/* one slot per datagram, each as large as buf so that no datagram is truncated (too large for the stack) */
+	const unsigned datagram_slots = 5;
+	const size_t datagram_slot_size = sizeof(buf);
+	uint8_t *datagrams = new uint8_t[datagram_slot_size * datagram_slots];
+
+	if (datagrams == nullptr) {
+		PX4_ERR("receive buffer allocation failed");
+		return nullptr;
+	}
+
+#endif
 #else
 	/* the serial port buffers internally as well, we just need to fit a small chunk */
 	uint8_t buf[64];
@@ -2381,7 +2359,9 @@ MavlinkReceiver::receive_thread(void *arg)
 
 #ifdef __PX4_POSIX
 	struct sockaddr_in srcaddr = {};
+#ifndef MAVLINK_UDP_BATCHING
 	socklen_t addrlen = sizeof(srcaddr);
+#endif
 
 	if (_mavlink->get_protocol() == UDP || _mavlink->get_protocol() == TCP) {
 		// make sure mavlink app has booted before we start using the socket
@@ -2401,6 +2381,18 @@ MavlinkReceiver::receive_thread(void *arg)
 	_mission_manager.set_verbose(verbose);
 
 	while (!_mavlink->_task_should_exit) {
+		/* the data to parse */
+		const uint8_t *data = buf;
+
+#ifdef __PX4_POSIX
+
+		if (_mavlink->get_protocol() == TCP) {
+			/* the socket changes with each connection (negative fds are ignored by poll) */
+			fds[0].fd = _mavlink->get_socket_fd();
+		}
+
+#endif
+
 		if (poll(&fds[0], 1, timeout) > 0) {
 			if (_mavlink->get_protocol() == SERIAL) {
 
@@ -2421,18 +2413,64 @@ MavlinkReceiver::receive_thread(void *arg)
 
 			if (_mavlink->get_protocol() == UDP) {
 				if (fds[0].revents & POLLIN) {
+#ifdef MAVLINK_UDP_BATCHING
+					/* drain up to one datagram per slot of buf with a single call */
+					struct mmsghdr msgs[datagram_slots];
+					struct iovec iovs[datagram_slots];
+					struct sockaddr_in srcaddrs[datagram_slots];
+
+					memset(msgs, 0, sizeof(msgs));
+
+					for (unsigned i = 0; i < datagram_slots; ++i) {
+						iovs[i].iov_base = &datagrams[i * datagram_slot_size];
+						iovs[i].iov_len = datagram_slot_size;
+						msgs[i].msg_hdr.msg_name = &srcaddrs[i];
+						msgs[i].msg_hdr.msg_namelen = sizeof(srcaddrs[i]);
+						msgs[i].msg_hdr.msg_iov = &iovs[i];
+						msgs[i].msg_hdr.msg_iovlen = 1;
+					}
+
+					int num_received = recvmmsg(_mavlink->get_socket_fd(), msgs, datagram_slots, MSG_DONTWAIT, nullptr);
+
+					if (num_received > 0) {
+						/* make the data contiguous for the parser (a datagram only contains complete messages) */
+						nread = 0;
+
+						for (int i = 0; i < num_received; ++i) {
+							memmove(&datagrams[nread], &datagrams[i * datagram_slot_size], msgs[i].msg_len);
+							nread += msgs[i].msg_len;
+						}
+
+						data = datagrams;
+						srcaddr = srcaddrs[num_received - 1];
+
+					} else {
+						nread = -1;
+					}
+
+#else
 					nread = recvfrom(_mavlink->get_socket_fd(), buf, sizeof(buf), 0, (struct sockaddr *)&srcaddr, &addrlen);
+#endif /* MAVLINK_UDP_BATCHING */
 				}
 
-			} else {
-				// could be TCP or other protocol
+			} else if (_mavlink->get_protocol() == TCP) {
+				if (fds[0].revents & (POLLIN | POLLHUP | POLLERR)) {
+					nread = ::read(fds[0].fd, buf, sizeof(buf));
+
+					if (nread == 0 || (nread < 0 && errno != EAGAIN)) {
+						/* connection closed by the partner */
+						_mavlink->tcp_close_connection();
+						nread = 0;
+					}
+				}
 			}
 
 			struct sockaddr_in *srcaddr_last = _mavlink->get_client_source_address();
 
 			int localhost = (127 << 24) + 1;
 
-			if (!_mavlink->get_client_source_initialized()) {
+			/* with TCP, the partner is known once connected */
+			if (_mavlink->get_protocol() == UDP && !_mavlink->get_client_source_initialized()) {
 
 				// set the address either if localhost or if 3 seconds have passed
 				// this ensures that a GCS running on localhost can get a hold of
@@ -2452,9 +2490,13 @@ MavlinkReceiver::receive_thread(void *arg)
 			// only start accepting messages once we're sure who we talk to
 
 			if (_mavlink->get_client_source_initialized()) {
+				if (nread > 0) {
+					update_control_mode();
+				}
+
 				/* if read failed, this loop won't execute */
 				for (ssize_t i = 0; i < nread; i++) {
-					if (mavlink_parse_char(_mavlink->get_channel(), buf[i], &msg, &_status)) {
+					if (mavlink_parse_char(_mavlink->get_channel(), data[i], &msg, &_status)) {
 
 						/* check if we received version 2 and request a switch. */
 						if (!(_mavlink->get_status()->flags & MAVLINK_STATUS_FLAG_IN_MAVLINK1)) {
@@ -2462,28 +2504,27 @@ MavlinkReceiver::receive_thread(void *arg)
 							_mavlink->set_proto_version(2);
 						}
 
-						/* handle generic messages and commands */
-						handle_message(&msg);
-
-						/* handle packet with mission manager */
-						_mission_manager.handle_message(&msg);
+						/* the component protocols (parameters, mission, FTP, log) can take a while: handle
+						 * them after the rest of the read, so that they don't delay setpoints and mocap data */
+						const int index = find_message_handler(msg.msgid);
 
-						/* handle packet with parameter component */
-						_parameters_manager.handle_message(&msg);
+						if (index >= 0 && (_message_handlers[index].flags & HANDLER_DEFERRED)
+						    && _deferred_count < DEFERRED_MESSAGES_MAX) {
+							memcpy(&_deferred_messages[_deferred_count++], &msg, sizeof(msg));
 
-						if (_mavlink->ftp_enabled()) {
-							/* handle packet with ftp component */
-							_mavlink_ftp.handle_message(&msg);
+						} else {
+							/* dispatch to the handlers and components registered for the message */
+							handle_message(&msg);
 						}
-
-						/* handle packet with log component */
-						_mavlink_log_handler.handle_message(&msg);
-
-						/* handle packet with parent object */
-						_mavlink->handle_message(&msg);
 					}
 				}
 
+				for (unsigned i = 0; i < _deferred_count; i++) {
+					handle_message(&_deferred_messages[i]);
+				}
+
+				_deferred_count = 0;
+
 				/* count received bytes (nread will be -1 on read error) */
 				if (nread > 0) {
 					_mavlink->count_rxbytes(nread);
@@ -2511,14 +2552,28 @@ MavlinkReceiver::receive_thread(void *arg)
 			}
 		}
 
+		/* send the replies queued during this iteration */
+		_mavlink->flush_send_buffers();
 	}
 
+#ifdef MAVLINK_UDP_BATCHING
+	delete[] datagrams;
+#endif
+
 	return nullptr;
 }
 
 void MavlinkReceiver::print_status()
 {
+	printf("\t%-8s %10s\n", "msg id", "received");
 
+	for (unsigned i = 0; i < MESSAGE_HANDLER_COUNT; i++) {
+		if (_message_count[i] > 0) {
+			printf("\t%-8u %10u\n", (unsigned)_message_handlers[i].msgid, (unsigned)_message_count[i]);
+		}
+	}
+
+	printf("\t%-8s %10u\n", "other", (unsigned)_message_count_other);
 }
 
 uint64_t MavlinkReceiver::sync_stamp(uint64_t usec)
@@ -2546,15 +2601,20 @@ void MavlinkReceiver::smooth_time_offset(int64_t offset_ns)
 void *MavlinkReceiver::start_helper(void *context)
 {
 
-	MavlinkReceiver *rcv = new MavlinkReceiver((Mavlink *)context);
+	Mavlink *parent = (Mavlink *)context;
+	MavlinkReceiver *rcv = new MavlinkReceiver(parent);
 
 	if (!rcv) {
 		PX4_ERR("alloc failed");
 		return nullptr;
 	}
 
+	parent->set_receiver(rcv);
+
 	void *ret = rcv->receive_thread(nullptr);
 
+	parent->set_receiver(nullptr);
+
 	delete rcv;
 
 	return ret;
@@ -102,7 +102,7 @@ public:
 	~MavlinkReceiver();
 
 	/**
-	 * Display the mavlink status.
+	 * Display the number of received messages per message ID.
 	 */
 	void		print_status();
 
@@ -115,8 +115,62 @@ public:
 
 private:
 
+	/**
+	 * Flags of a message handler table entry: the condition under which the message is handled,
+	 * and the components that consume the message in addition to the receiver itself.
+	 */
+	enum MessageHandlerFlags : uint8_t {
+		HANDLER_REQUIRES_COMMANDS = (1 << 0), ///< only handled if the instance accepts commands
+		HANDLER_HIL_ONLY = (1 << 1), ///< only handled in HIL mode
+		HANDLER_HIL_GPS = (1 << 2), ///< handled in HIL mode, or from our own system if MAV_USEHILGPS is set
+		HANDLER_MISSION = (1 << 3), ///< passed to the mission manager
+		HANDLER_PARAMETERS = (1 << 4), ///< passed to the parameters manager
+		HANDLER_FTP = (1 << 5), ///< passed to the FTP component (if enabled)
+		HANDLER_LOG = (1 << 6), ///< passed to the log handler
+
+		/** messages of the component protocols, handled after the other messages of a read (@see receive_thread()) */
+		HANDLER_DEFERRED = HANDLER_MISSION | HANDLER_PARAMETERS | HANDLER_FTP | HANDLER_LOG,
+	};
+
+	struct MessageHandler {
+		uint32_t msgid;
+		void (MavlinkReceiver::*handler)(mavlink_message_t *msg); ///< nullptr if only used by a component
+		uint8_t flags; ///< MessageHandlerFlags
+	};
+
+	static constexpr unsigned MESSAGE_HANDLER_COUNT = 55;
+
+	/** all the handled messages, sorted by message ID */
+	static const MessageHandler _message_handlers[];
+
+	/**
+	 * Look up the handler table entry of a message ID
+	 * @return index into _message_handlers, or -1 if the message is not handled
+	 */
+	static int find_message_handler(uint32_t msgid);
+
 	void acknowledge(uint8_t sysid, uint8_t compid, uint16_t command, uint8_t result);
+
+	/**
+	 * Dispatch a message to the receiver handler and the components registered for its ID,
+	 * and to the parent object (which sees all messages, for forwarding and routing)
+	 */
 	void handle_message(mavlink_message_t *msg);
+
+	/**
+	 * Fetch the vehicle control mode if it changed (once per read, so that the setpoint
+	 * handlers can use the cached state)
+	 */
+	void update_control_mode();
+
+	/**
+	 * Publish the offboard control mode of a setpoint message. The commander only uses it to
+	 * select the controllers and to detect the loss of the offboard link, so it is only published
+	 * if it changed or the last publication is older than OFFBOARD_CONTROL_MODE_INTERVAL.
+	 * Like this, a setpoint message only leads to the publication of the setpoint itself.
+	 */
+	void publish_offboard_control_mode(const offboard_control_mode_s &offboard_control_mode);
+
 	void handle_message_command_long(mavlink_message_t *msg);
 	void handle_message_command_int(mavlink_message_t *msg);
 	/**
@@ -262,6 +316,7 @@ private:
 	float _hil_local_alt0;
 	struct map_projection_reference_s _hil_local_proj_ref;
 	struct offboard_control_mode_s _offboard_control_mode;
+	struct offboard_control_mode_s _offboard_control_mode_published; ///< last published offboard control mode
 	struct vehicle_attitude_setpoint_s _att_sp;
 	struct vehicle_rates_setpoint_s _rates_sp;
 	double _time_offset_avg_alpha;
@@ -277,6 +332,16 @@ private:
 	param_t _p_bat_crit_thr;
 	param_t _p_bat_low_thr;
 
+	uint32_t _message_count[MESSAGE_HANDLER_COUNT]; ///< number of received messages per handler table entry
+	uint32_t _message_count_other; ///< number of received messages without a table entry (forwarding only)
+
+	static constexpr hrt_abstime OFFBOARD_CONTROL_MODE_INTERVAL = 100000; ///< [us], the commander timeout is 500 ms
+
+	static constexpr unsigned DEFERRED_MESSAGES_MAX = 4;
+
+	mavlink_message_t _deferred_messages[DEFERRED_MESSAGES_MAX]; ///< component protocol messages of the current read
+	unsigned _deferred_count;
+
 	MavlinkReceiver(const MavlinkReceiver &) = delete;
 	MavlinkReceiver operator=(const MavlinkReceiver &) = delete;
 };
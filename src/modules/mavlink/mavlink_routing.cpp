@@ -0,0 +1,131 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2017 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file mavlink_routing.cpp
+ * Routing table for forwarding messages between MAVLink instances
+ */
+
+#include "mavlink_routing.h"
+
+#include <stdio.h>
+
+void
+MavlinkRoutingTable::learn(uint8_t system_id, uint8_t component_id, Mavlink *link, hrt_abstime now)
+{
+	pthread_mutex_lock(&_mutex);
+
+	Route *oldest = &_routes[0];
+
+	for (unsigned i = 0; i < MAX_ROUTES; ++i) {
+		Route &route = _routes[i];
+
+		if (route.last_seen != 0 && route.system_id == system_id && route.component_id == component_id) {
+			/* refresh (the component might also have moved to another link) */
+			route.link = link;
+			route.last_seen = now;
+			pthread_mutex_unlock(&_mutex);
+			return;
+		}
+
+		if (route.last_seen < oldest->last_seen) {
+			oldest = &route;
+		}
+	}
+
+	oldest->system_id = system_id;
+	oldest->component_id = component_id;
+	oldest->link = link;
+	oldest->last_seen = now;
+
+	pthread_mutex_unlock(&_mutex);
+}
+
+void
+MavlinkRoutingTable::remove_link(const Mavlink *link)
+{
+	pthread_mutex_lock(&_mutex);
+
+	for (unsigned i = 0; i < MAX_ROUTES; ++i) {
+		if (_routes[i].link == link) {
+			_routes[i].last_seen = 0;
+			_routes[i].link = nullptr;
+		}
+	}
+
+	pthread_mutex_unlock(&_mutex);
+}
+
+bool
+MavlinkRoutingTable::has_route(uint8_t target_system_id, uint8_t target_component_id, const Mavlink *link,
+			       hrt_abstime now, bool &known)
+{
+	bool found = false;
+	known = false;
+
+	pthread_mutex_lock(&_mutex);
+
+	for (unsigned i = 0; i < MAX_ROUTES; ++i) {
+		const Route &route = _routes[i];
+
+		if (is_valid(route, now) && route.system_id == target_system_id
+		    && (target_component_id == 0 || route.component_id == target_component_id)) {
+			known = true;
+
+			if (route.link == link) {
+				found = true;
+			}
+		}
+	}
+
+	pthread_mutex_unlock(&_mutex);
+
+	return found;
+}
+
+void
+MavlinkRoutingTable::print_routes(const Mavlink *link, hrt_abstime now)
+{
+	pthread_mutex_lock(&_mutex);
+
+	for (unsigned i = 0; i < MAX_ROUTES; ++i) {
+		const Route &route = _routes[i];
+
+		if (route.link == link && is_valid(route, now)) {
+			printf("\troute: sys %u, comp %u (%.1f s ago)\n", route.system_id, route.component_id,
+			       (double)((now - route.last_seen) / 1e6));
+		}
+	}
+
+	pthread_mutex_unlock(&_mutex);
+}
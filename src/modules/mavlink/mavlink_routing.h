@@ -0,0 +1,106 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2017 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file mavlink_routing.h
+ * Routing table for forwarding messages between MAVLink instances
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <pthread.h>
+#include <drivers/drv_hrt.h>
+
+class Mavlink;
+
+/**
+ * @class MavlinkRoutingTable
+ * Maps system and component IDs to the MAVLink instance (link) that they were heard on, learned from
+ * received heartbeats. Entries expire if no heartbeat is received for ROUTE_TIMEOUT.
+ * All methods are thread-safe (the table is shared by the receiver threads of all instances).
+ */
+class MavlinkRoutingTable
+{
+public:
+	static constexpr unsigned MAX_ROUTES = 16;
+	static constexpr hrt_abstime ROUTE_TIMEOUT = 10000000; ///< [us]
+
+	/* trivial, so that a global table is initialized statically */
+	MavlinkRoutingTable() = default;
+
+	/**
+	 * add or refresh a route (if the table is full, the oldest route is replaced)
+	 */
+	void learn(uint8_t system_id, uint8_t component_id, Mavlink *link, hrt_abstime now);
+
+	/**
+	 * remove all routes through a link
+	 */
+	void remove_link(const Mavlink *link);
+
+	/**
+	 * check how to forward a message to a target
+	 * @param target_component_id 0 for all components of the target system
+	 * @param link link to check
+	 * @param known set to true if a route to the target exists through any link
+	 * @return true if a route to the target exists through link
+	 */
+	bool has_route(uint8_t target_system_id, uint8_t target_component_id, const Mavlink *link, hrt_abstime now,
+		       bool &known);
+
+	/**
+	 * print the routes through a link
+	 */
+	void print_routes(const Mavlink *link, hrt_abstime now);
+
+private:
+	struct Route {
+		hrt_abstime last_seen; ///< 0 if unused
+		Mavlink *link;
+		uint8_t system_id;
+		uint8_t component_id;
+	};
+
+	bool is_valid(const Route &route, hrt_abstime now) const
+	{
+		return route.last_seen != 0 && now - route.last_seen < ROUTE_TIMEOUT;
+	}
+
+	Route _routes[MAX_ROUTES] {};
+	pthread_mutex_t _mutex = PTHREAD_MUTEX_INITIALIZER;
+
+	/* do not allow copying this class */
+	MavlinkRoutingTable(const MavlinkRoutingTable &);
+	MavlinkRoutingTable &operator=(const MavlinkRoutingTable &);
+};
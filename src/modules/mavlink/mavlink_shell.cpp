@@ -43,6 +43,7 @@
 
 #include <unistd.h>
 #include <errno.h>
+#include <string.h>
 #include <sys/ioctl.h>
 
 
@@ -51,7 +52,8 @@
 #endif /* __PX4_NUTTX */
 
 
-MavlinkShell::MavlinkShell()
+MavlinkShell::MavlinkShell(bool screen_diff) :
+	_screen_diff(screen_diff)
 {
 }
 
@@ -179,3 +181,129 @@ size_t MavlinkShell::available()
 
 	return 0;
 }
+
+size_t MavlinkShell::read_output(uint8_t *buffer, size_t len)
+{
+	const hrt_abstime now = hrt_absolute_time();
+	size_t avail = available();
+
+	/* leave room for a full line, processing a chunk can flush it */
+	while (avail > 0 && _pending_len + LINE_LEN < PENDING_LEN) {
+		uint8_t chunk[64];
+		size_t chunk_len = PENDING_LEN - LINE_LEN - _pending_len;
+
+		if (chunk_len > sizeof(chunk)) {
+			chunk_len = sizeof(chunk);
+		}
+
+		if (chunk_len > avail) {
+			chunk_len = avail;
+		}
+
+		ssize_t ret = ::read(_from_shell_fd, chunk, chunk_len);
+
+		if (ret <= 0) {
+			break;
+		}
+
+		avail -= ret;
+		_last_output = now;
+
+		if (!_screen_diff) {
+			add_output(chunk, ret);
+			continue;
+		}
+
+		for (ssize_t i = 0; i < ret; ++i) {
+			_line[_line_len++] = chunk[i];
+
+			if (chunk[i] == '\n' || _line_len == LINE_LEN) {
+				process_line(chunk[i] == '\n');
+			}
+		}
+	}
+
+	if (_pending_len < len) {
+		if (_pending_len + _line_len == 0 || now - _last_output < OUTPUT_IDLE_TIMEOUT) {
+			return 0;
+		}
+
+		/* idle: send what we have, including an incomplete line such as the prompt */
+		if (_line_len > 0) {
+			process_line(false);
+		}
+
+		_in_frame = false;
+		len = _pending_len;
+	}
+
+	memcpy(buffer, _pending, len);
+	_pending_len -= len;
+	memmove(_pending, _pending + len, _pending_len);
+	return len;
+}
+
+void MavlinkShell::add_output(const uint8_t *data, size_t len)
+{
+	memcpy(_pending + _pending_len, data, len);
+	_pending_len += len;
+}
+
+void MavlinkShell::process_line(bool complete)
+{
+	static const uint8_t cursor_home[] = "\033[H";
+	static const uint8_t clear_screen[] = "\033[2J";
+
+	const bool home = _line_len >= 3 && memcmp(_line, cursor_home, 3) == 0;
+
+	if (_line_len >= 4 && memcmp(_line, clear_screen, 4) == 0) {
+		memset(_row_hash, 0, sizeof(_row_hash));
+	}
+
+	if (home) {
+		_in_frame = true;
+		_row = 0;
+
+		if (++_frames >= FULL_REFRESH_FRAMES) {
+			memset(_row_hash, 0, sizeof(_row_hash));
+			_frames = 0;
+		}
+	}
+
+	if (!_in_frame || _row >= SCREEN_ROWS) {
+		add_output(_line, _line_len);
+
+	} else if (!complete) {
+		/* the rest of the line follows separately: stop comparing until the next refresh */
+		_row_hash[_row] = 0;
+		_in_frame = false;
+		add_output(_line, _line_len);
+
+	} else {
+		/* FNV-1a */
+		uint32_t hash = 2166136261u;
+
+		for (size_t i = 0; i < _line_len; ++i) {
+			hash = (hash ^ _line[i]) * 16777619u;
+		}
+
+		if (hash == _row_hash[_row]) {
+			/* the terminal still shows this line: only move the cursor */
+			const size_t newline_len = (_line_len >= 2 && _line[_line_len - 2] == '\r') ? 2 : 1;
+
+			if (home) {
+				add_output(cursor_home, 3);
+			}
+
+			add_output(_line + _line_len - newline_len, newline_len);
+
+		} else {
+			_row_hash[_row] = hash;
+			add_output(_line, _line_len);
+		}
+
+		++_row;
+	}
+
+	_line_len = 0;
+}
@@ -42,13 +42,17 @@
 #include <stddef.h>
 #include <stdint.h>
 #include <px4_tasks.h>
+#include <drivers/drv_hrt.h>
 
 #pragma once
 
 class MavlinkShell
 {
 public:
-	MavlinkShell();
+	/**
+	 * @param screen_diff only send the changed lines of repeated screen refreshes (e.g. top)
+	 */
+	MavlinkShell(bool screen_diff = false);
 
 	~MavlinkShell();
 
@@ -78,7 +82,37 @@ public:
 	 */
 	size_t available();
 
+	/**
+	 * Read the shell output for the next message, non-blocking. The output is coalesced
+	 * into full messages: this returns 0 while less than len bytes are pending, until the
+	 * output has been idle for OUTPUT_IDLE_TIMEOUT.
+	 * @param len message payload length
+	 * @return number of bytes read.
+	 */
+	size_t read_output(uint8_t *buffer, size_t len);
+
 private:
+	static constexpr hrt_abstime OUTPUT_IDLE_TIMEOUT = 20000;
+	static constexpr size_t LINE_LEN = 128; ///< longest line compared for the screen diff
+	static constexpr size_t PENDING_LEN = 2 * LINE_LEN;
+	static constexpr unsigned SCREEN_ROWS = 48;
+	static constexpr unsigned FULL_REFRESH_FRAMES = 10; ///< resend the whole screen in case messages were lost
+
+	uint8_t _pending[PENDING_LEN]; ///< output ready to be sent
+	size_t _pending_len = 0;
+	hrt_abstime _last_output = 0;
+
+	const bool _screen_diff;
+	uint8_t _line[LINE_LEN]; ///< output line that is not yet compared
+	size_t _line_len = 0;
+	bool _in_frame = false; ///< inside a screen refresh (starting with cursor home)
+	unsigned _row = 0;
+	unsigned _frames = 0;
+	uint32_t _row_hash[SCREEN_ROWS] {}; ///< hash of each line of the last screen refresh, 0 if unknown
+
+	void add_output(const uint8_t *data, size_t len);
+	void process_line(bool complete);
+
 
 	int _to_shell_fd = -1; /** fd to write to the shell */
 	int _from_shell_fd = -1; /** fd to read from the shell */
@@ -91,11 +91,7 @@ MavlinkStream::update(const hrt_abstime t)
 	}
 
 	int64_t dt = t - _last_sent;
-	int interval = (_interval > 0) ? _interval : 0;
-
-	if (!const_rate()) {
-		interval /= _mavlink->get_rate_mult();
-	}
+	int interval = get_effective_interval();
 
 	// Send the message if it is due or
 	// if it will overrun the next scheduled send interval
@@ -128,3 +124,38 @@ MavlinkStream::update(const hrt_abstime t)
 
 	return -1;
 }
+
+int
+MavlinkStream::get_effective_interval()
+{
+	int interval = (_interval > 0) ? _interval : 0;
+
+	if (!const_rate()) {
+		interval /= _mavlink->get_rate_mult(get_priority());
+	}
+
+	return interval;
+}
+
+hrt_abstime
+MavlinkStream::get_next_update_time()
+{
+	if (_last_sent == 0) {
+		return 0;
+	}
+
+	int interval = get_effective_interval();
+
+	if (interval == 0) {
+		return _last_sent;
+	}
+
+	/* same condition as in update(): send up to 30% of the loop delay early */
+	int64_t early = (int64_t)interval - (_mavlink->get_main_loop_delay() / 10) * 3;
+
+	if (early < 0) {
+		return _last_sent;
+	}
+
+	return _last_sent + early + 1;
+}
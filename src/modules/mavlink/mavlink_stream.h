@@ -49,6 +49,17 @@ class MavlinkStream
 {
 
 public:
+	/**
+	 * Stream priority: if the link cannot carry all the streams, the rates of the lower
+	 * priority streams are reduced first
+	 */
+	enum Priority {
+		PRIORITY_LOW = 0,
+		PRIORITY_NORMAL,
+		PRIORITY_HIGH,
+		PRIORITY_COUNT
+	};
+
 	MavlinkStream *next;
 
 	MavlinkStream(Mavlink *mavlink);
@@ -72,6 +83,12 @@ public:
 	 * @return 0 if updated / sent, -1 if unchanged
 	 */
 	int update(const hrt_abstime t);
+
+	/**
+	 * @return the time from which on the stream is due to be sent (0 if never sent), based on the
+	 * last send time and the current interval (@see update())
+	 */
+	hrt_abstime get_next_update_time();
 	virtual const char *get_name() const = 0;
 	virtual uint16_t get_id() = 0;
 
@@ -80,6 +97,13 @@ public:
 	 */
 	virtual bool const_rate() { return false; }
 
+	virtual Priority get_priority() { return PRIORITY_NORMAL; }
+
+	/**
+	 * @return the interval taking the rate multiplier into account, 0 for an unlimited rate
+	 */
+	int get_effective_interval();
+
 	/**
 	 * Get maximal total messages size on update
 	 */
@@ -0,0 +1,155 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2017 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file mavlink_stream_scheduler.cpp
+ * Deadline-ordered scheduling of the MAVLink streams
+ */
+
+#include "mavlink_stream_scheduler.h"
+#include "mavlink_stream.h"
+
+MavlinkStreamScheduler::~MavlinkStreamScheduler()
+{
+	delete[] _entries;
+}
+
+bool
+MavlinkStreamScheduler::rebuild(MavlinkStream *streams)
+{
+	unsigned count = 0;
+
+	for (MavlinkStream *stream = streams; stream != nullptr; stream = stream->next) {
+		++count;
+	}
+
+	if (count > _capacity) {
+		delete[] _entries;
+		_entries = new Entry[count];
+		_capacity = _entries ? count : 0;
+	}
+
+	_size = 0;
+
+	if (count > _capacity) {
+		return false;
+	}
+
+	for (MavlinkStream *stream = streams; stream != nullptr; stream = stream->next) {
+		_entries[_size].time = stream->get_next_update_time();
+		_entries[_size].stream = stream;
+		++_size;
+	}
+
+	/* heapify */
+	for (unsigned i = _size / 2; i > 0; --i) {
+		sift_down(i - 1, _size);
+	}
+
+	return true;
+}
+
+void
+MavlinkStreamScheduler::update(const hrt_abstime t, const hrt_abstime poll_interval)
+{
+	/* Move the due streams behind the heap (like in a heap sort), so that each one is
+	 * updated exactly once, even if it is still due afterwards */
+	unsigned heap_size = _size;
+
+	while (heap_size > 0 && _entries[0].time <= t) {
+		--heap_size;
+		Entry due = _entries[0];
+		_entries[0] = _entries[heap_size];
+		_entries[heap_size] = due;
+		sift_down(0, heap_size);
+	}
+
+	for (unsigned i = heap_size; i < _size; ++i) {
+		MavlinkStream *stream = _entries[i].stream;
+		stream->update(t);
+
+		hrt_abstime next_time = stream->get_next_update_time();
+
+		/* not sent or unlimited rate: check again at the loop rate */
+		if (next_time <= t) {
+			next_time = t + poll_interval;
+		}
+
+		_entries[i].time = next_time;
+		sift_up(i);
+	}
+}
+
+void
+MavlinkStreamScheduler::sift_down(unsigned i, unsigned size)
+{
+	while (true) {
+		unsigned smallest = i;
+		unsigned left = 2 * i + 1;
+		unsigned right = left + 1;
+
+		if (left < size && _entries[left].time < _entries[smallest].time) {
+			smallest = left;
+		}
+
+		if (right < size && _entries[right].time < _entries[smallest].time) {
+			smallest = right;
+		}
+
+		if (smallest == i) {
+			return;
+		}
+
+		Entry tmp = _entries[i];
+		_entries[i] = _entries[smallest];
+		_entries[smallest] = tmp;
+		i = smallest;
+	}
+}
+
+void
+MavlinkStreamScheduler::sift_up(unsigned i)
+{
+	while (i > 0) {
+		unsigned parent = (i - 1) / 2;
+
+		if (_entries[parent].time <= _entries[i].time) {
+			return;
+		}
+
+		Entry tmp = _entries[i];
+		_entries[i] = _entries[parent];
+		_entries[parent] = tmp;
+		i = parent;
+	}
+}
@@ -0,0 +1,96 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2017 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file mavlink_stream_scheduler.h
+ * Deadline-ordered scheduling of the MAVLink streams
+ */
+
+#pragma once
+
+#include <drivers/drv_hrt.h>
+
+class MavlinkStream;
+
+/**
+ * @class MavlinkStreamScheduler
+ * Min-heap of the streams of a MAVLink instance, keyed on the time at which each stream is due next
+ * (@see MavlinkStream::get_next_update_time()). The main loop only updates the streams that are due,
+ * and can sleep until the next deadline.
+ * The streams are owned by the stream list of the instance: the schedule must be rebuilt whenever
+ * that list or the stream intervals change.
+ */
+class MavlinkStreamScheduler
+{
+public:
+	MavlinkStreamScheduler() = default;
+	~MavlinkStreamScheduler();
+
+	/**
+	 * rebuild the schedule from a stream list
+	 * @return false on allocation failure (the schedule is empty in that case)
+	 */
+	bool rebuild(MavlinkStream *streams);
+
+	/**
+	 * update all the streams that are due and reschedule them
+	 * @param t current time
+	 * @param poll_interval time after which streams are checked again if they did not send anything
+	 *                      (e.g. because there is no new data)
+	 */
+	void update(const hrt_abstime t, const hrt_abstime poll_interval);
+
+	/**
+	 * @return time at which the next stream is due, 0 if there are no streams
+	 */
+	hrt_abstime next_update_time() const { return _size > 0 ? _entries[0].time : 0; }
+
+	unsigned size() const { return _size; }
+
+private:
+	struct Entry {
+		hrt_abstime time; ///< time when the stream is due next
+		MavlinkStream *stream;
+	};
+
+	void sift_down(unsigned i, unsigned size);
+	void sift_up(unsigned i);
+
+	Entry *_entries{nullptr};
+	unsigned _size{0};
+	unsigned _capacity{0};
+
+	/* do not allow copying this class */
+	MavlinkStreamScheduler(const MavlinkStreamScheduler &);
+	MavlinkStreamScheduler &operator=(const MavlinkStreamScheduler &);
+};
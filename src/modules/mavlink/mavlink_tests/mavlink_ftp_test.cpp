@@ -588,6 +588,104 @@ bool MavlinkFtpTest::_burst_test()
 	return true;
 }
 
+/// @brief Tests for correct reponse to a request to resend missing burst packets.
+bool MavlinkFtpTest::_burst_missing_test()
+{
+	MavlinkFTP::PayloadHeader		payload;
+	const MavlinkFTP::PayloadHeader		*reply;
+
+	// use the test case which takes two packets, and request the second one
+	const DownloadTestCase *test = &_rgDownloadTestCases[2];
+	struct stat st;
+
+	// Read in the file so we can compare it to what we get back
+	ut_compare("stat failed", stat(test->file, &st), 0);
+	uint8_t *bytes = new uint8_t[st.st_size];
+	ut_assert("new failed", bytes != nullptr);
+	int fd = ::open(test->file, O_RDONLY);
+	ut_assert("open failed", fd != -1);
+	int bytes_read = ::read(fd, bytes, st.st_size);
+	ut_compare("read failed", bytes_read, st.st_size);
+	::close(fd);
+
+	payload.opcode = MavlinkFTP::kCmdOpenFileRO;
+	payload.offset = 0;
+
+	bool success = _send_receive_msg(&payload,		// FTP payload header
+					 strlen(test->file) + 1,	// size in bytes of data
+					 (uint8_t *)test->file,	// Data to start into FTP message payload
+					 &reply);		// Payload inside FTP message response
+
+	if (!success) {
+		delete[] bytes;
+		return false;
+	}
+
+	ut_compare("Didn't get Ack back", reply->opcode, MavlinkFTP::kRspAck);
+
+	uint32_t full_packet_bytes = MAVLINK_MSG_FILE_TRANSFER_PROTOCOL_FIELD_PAYLOAD_LEN - sizeof(MavlinkFTP::PayloadHeader);
+
+	// Request the second packet, the reply is sent using the stream mechanism
+	payload.opcode = MavlinkFTP::kCmdBurstReadMissing;
+	payload.session = reply->session;
+	payload.offset = 0;
+
+	mavlink_message_t msg;
+	_setup_ftp_msg(&payload, sizeof(full_packet_bytes), (uint8_t *)&full_packet_bytes, &msg);
+	_ftp_server->handle_message(&msg);
+
+	hrt_abstime t = 0;
+	_ftp_server->send(t);
+
+	success = _decode_message(&_reply_msg, &reply);
+
+	if (!success) {
+		delete[] bytes;
+		return false;
+	}
+
+	ut_compare("Didn't get Ack back", reply->opcode, MavlinkFTP::kRspAck);
+	ut_compare("Request opcode incorrect", reply->req_opcode, MavlinkFTP::kCmdBurstReadFile);
+	ut_compare("Offset incorrect", reply->offset, full_packet_bytes);
+	ut_compare("burst_complete incorrect", reply->burst_complete, 1);
+	ut_compare("Payload size incorrect", reply->size, (uint32_t)st.st_size - full_packet_bytes);
+	ut_compare("File contents differ", memcmp(reply->data, &bytes[full_packet_bytes], reply->size), 0);
+	ut_compare("All packets should have been sent", _ftp_server->get_size(), 0);
+
+	delete[] bytes;
+
+	// Offsets past EOF are rejected
+	uint32_t eof_offset = st.st_size;
+	success = _send_receive_msg(&payload,	// FTP payload header
+				    sizeof(eof_offset),	// size in bytes of data
+				    (uint8_t *)&eof_offset,	// Data to start into FTP message payload
+				    &reply);	// Payload inside FTP message response
+
+	if (!success) {
+		return false;
+	}
+
+	ut_compare("Didn't get Nak back", reply->opcode, MavlinkFTP::kRspNak);
+	ut_compare("Incorrect error code", reply->data[0], MavlinkFTP::kErrEOF);
+
+	// Terminate session
+	payload.opcode = MavlinkFTP::kCmdTerminateSession;
+	payload.size = 0;
+
+	success = _send_receive_msg(&payload,	// FTP payload header
+				    0,		// size in bytes of data
+				    nullptr,	// Data to start into FTP message payload
+				    &reply);	// Payload inside FTP message response
+
+	if (!success) {
+		return false;
+	}
+
+	ut_compare("Didn't get Ack back", reply->opcode, MavlinkFTP::kRspAck);
+
+	return true;
+}
+
 /// @brief Tests for correct reponse to a Read command on an invalid session.
 bool MavlinkFtpTest::_read_badsession_test()
 {
@@ -955,6 +1053,7 @@ bool MavlinkFtpTest::run_tests()
 	ut_run_test(_read_test);
 	ut_run_test(_read_badsession_test);
 	ut_run_test(_burst_test);
+	ut_run_test(_burst_missing_test);
 	ut_run_test(_removedirectory_test);
 	ut_run_test(_createdirectory_test);
 	ut_run_test(_removefile_test);
@@ -49,11 +49,9 @@ px4_sem_t MavlinkULog::_lock;
 const float MavlinkULog::_rate_calculation_delta_t = 0.1f;
 
 
-MavlinkULog::MavlinkULog(int datarate, float max_rate_factor, uint8_t target_system, uint8_t target_component)
+MavlinkULog::MavlinkULog(float max_rate_factor, uint8_t target_system, uint8_t target_component)
 	: _target_system(target_system), _target_component(target_component),
 	  _max_rate_factor(max_rate_factor),
-	  _max_num_messages(math::max(1, (int)ceilf(_rate_calculation_delta_t *_max_rate_factor * datarate /
-				      (MAVLINK_MSG_ID_LOGGING_DATA_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES)))),
 	  _current_rate_factor(max_rate_factor)
 {
 	_ulog_stream_sub = orb_subscribe(ORB_ID(ulog_stream));
@@ -65,6 +63,7 @@ MavlinkULog::MavlinkULog(int datarate, float max_rate_factor, uint8_t target_sys
 	_waiting_for_initial_ack = true;
 	_last_sent_time = hrt_absolute_time(); //(ab)use this timestamp during initialization
 	_next_rate_check = _last_sent_time + _rate_calculation_delta_t * 1.e6f;
+	_last_budget_update = _last_sent_time;
 }
 
 MavlinkULog::~MavlinkULog()
@@ -87,7 +86,23 @@ void MavlinkULog::start_ack_received()
 	}
 }
 
-int MavlinkULog::handle_update(mavlink_channel_t channel)
+void MavlinkULog::update_budget(int datarate)
+{
+	const hrt_abstime now = hrt_absolute_time();
+	const float rate = _max_rate_factor * datarate;
+
+	_budget += rate * (now - _last_budget_update) * 1.e-6f;
+	_last_budget_update = now;
+
+	// allow a burst of one rate interval, but at least a full window so that a fast link is never the limit
+	const float max_budget = math::max(rate * _rate_calculation_delta_t, (float)(WINDOW_SIZE * MESSAGE_ACKED_SIZE));
+
+	if (_budget > max_budget) {
+		_budget = max_budget;
+	}
+}
+
+int MavlinkULog::handle_update(mavlink_channel_t channel, int datarate)
 {
 	static_assert(sizeof(ulog_stream_s::data) == MAVLINK_MSG_LOGGING_DATA_FIELD_DATA_LEN,
 		      "Invalid uorb ulog_stream.data length");
@@ -103,63 +118,54 @@ int MavlinkULog::handle_update(mavlink_channel_t channel)
 		return 0;
 	}
 
-	// check if we're waiting for an ACK
-	if (_last_sent_time) {
-		bool check_for_updates = false;
-
-		if (_ack_received) {
-			_last_sent_time = 0;
-			check_for_updates = true;
-
-		} else {
-
-			if (hrt_elapsed_time(&_last_sent_time) > ulog_stream_ack_s::ACK_TIMEOUT * 1000) {
-				if (++_sent_tries > ulog_stream_ack_s::ACK_MAX_TRIES) {
-					return -ETIMEDOUT;
-
-				} else {
-					PX4_DEBUG("re-sending ulog mavlink message (try=%i)", _sent_tries);
-					_last_sent_time = hrt_absolute_time();
-					mavlink_logging_data_acked_t msg;
-					msg.sequence = _ulog_data.sequence;
-					msg.length = _ulog_data.length;
-					msg.first_message_offset = _ulog_data.first_message_offset;
-					msg.target_system = _target_system;
-					msg.target_component = _target_component;
-					memcpy(msg.data, _ulog_data.data, sizeof(msg.data));
-					mavlink_msg_logging_data_acked_send_struct(channel, &msg);
-				}
+	update_budget(datarate);
+
+	// re-send the messages in the window which did not get acked in time (only those)
+	const hrt_abstime now = hrt_absolute_time();
+	lock();
+
+	for (int i = 0; i < _window_count && _budget >= MESSAGE_ACKED_SIZE; ++i) {
+		WindowEntry &entry = _window[(_window_start + i) % WINDOW_SIZE];
+
+		if (!entry.acked && now - entry.sent_time > ulog_stream_ack_s::ACK_TIMEOUT * 1000) {
+			if (++entry.tries > ulog_stream_ack_s::ACK_MAX_TRIES) {
+				unlock();
+				return -ETIMEDOUT;
 			}
-		}
 
-		if (!check_for_updates) {
-			return 0;
+			PX4_DEBUG("re-sending ulog mavlink message %i (try=%i)", entry.data.sequence, entry.tries);
+			entry.sent_time = now;
+			send_data_acked(channel, entry.data);
+			_budget -= MESSAGE_ACKED_SIZE;
+			_bytes_sent += MESSAGE_ACKED_SIZE;
 		}
 	}
 
+	unlock();
+
 	bool updated = false;
 	int ret = orb_check(_ulog_stream_sub, &updated);
 
-	while (updated && !ret && _current_num_msgs < _max_num_messages) {
+	// send everything that is queued and fits into the budget in one go.
+	// If the window is full, leave the messages in the queue until we get acks
+	while (updated && !ret && _budget >= MESSAGE_ACKED_SIZE && _window_count < WINDOW_SIZE) {
+		int message_size = 0;
+
 		orb_copy(ORB_ID(ulog_stream), _ulog_stream_sub, &_ulog_data);
 
 		if (_ulog_data.timestamp > 0) {
 			if (_ulog_data.flags & ulog_stream_s::FLAGS_NEED_ACK) {
-				_sent_tries = 1;
-				_last_sent_time = hrt_absolute_time();
 				lock();
-				_wait_for_ack_sequence = _ulog_data.sequence;
-				_ack_received = false;
+				WindowEntry &entry = _window[(_window_start + _window_count) % WINDOW_SIZE];
+				entry.data = _ulog_data;
+				entry.sent_time = hrt_absolute_time();
+				entry.tries = 1;
+				entry.acked = false;
+				++_window_count;
 				unlock();
 
-				mavlink_logging_data_acked_t msg;
-				msg.sequence = _ulog_data.sequence;
-				msg.length = _ulog_data.length;
-				msg.first_message_offset = _ulog_data.first_message_offset;
-				msg.target_system = _target_system;
-				msg.target_component = _target_component;
-				memcpy(msg.data, _ulog_data.data, sizeof(msg.data));
-				mavlink_msg_logging_data_acked_send_struct(channel, &msg);
+				send_data_acked(channel, _ulog_data);
+				message_size = MESSAGE_ACKED_SIZE;
 
 			} else {
 				mavlink_logging_data_t msg;
@@ -170,10 +176,12 @@ int MavlinkULog::handle_update(mavlink_channel_t channel)
 				msg.target_component = _target_component;
 				memcpy(msg.data, _ulog_data.data, sizeof(msg.data));
 				mavlink_msg_logging_data_send_struct(channel, &msg);
+				message_size = MESSAGE_SIZE;
 			}
 		}
 
-		++_current_num_msgs;
+		_budget -= message_size;
+		_bytes_sent += message_size;
 		ret = orb_check(_ulog_stream_sub, &updated);
 	}
 
@@ -181,17 +189,13 @@ int MavlinkULog::handle_update(mavlink_channel_t channel)
 	hrt_abstime t = hrt_absolute_time();
 
 	if (t > _next_rate_check) {
-		if (_current_num_msgs < _max_num_messages) {
-			_current_rate_factor = _max_rate_factor * (float)_current_num_msgs / _max_num_messages;
+		const float dt = (t - _next_rate_check) * 1.e-6f + _rate_calculation_delta_t;
+		_achieved_rate = _bytes_sent / dt;
+		_current_rate_factor = datarate > 0 ? math::min(_achieved_rate / datarate, _max_rate_factor) : 0.f;
 
-		} else {
-			_current_rate_factor = _max_rate_factor;
-		}
-
-		_current_num_msgs = 0;
+		_bytes_sent = 0;
 		_next_rate_check = t + _rate_calculation_delta_t * 1.e6f;
-		PX4_DEBUG("current rate=%.3f (max=%i msgs in %.3fs)", (double)_current_rate_factor, _max_num_messages,
-			  (double)_rate_calculation_delta_t);
+		PX4_DEBUG("current rate=%.3f (%.1f kB/s)", (double)_current_rate_factor, (double)(_achieved_rate / 1000.f));
 	}
 
 	return 0;
@@ -207,15 +211,14 @@ void MavlinkULog::initialize()
 	_init = true;
 }
 
-MavlinkULog *MavlinkULog::try_start(int datarate, float max_rate_factor, uint8_t target_system,
-				    uint8_t target_component)
+MavlinkULog *MavlinkULog::try_start(float max_rate_factor, uint8_t target_system, uint8_t target_component)
 {
 	MavlinkULog *ret = nullptr;
 	bool failed = false;
 	lock();
 
 	if (!_instance) {
-		ret = _instance = new MavlinkULog(datarate, max_rate_factor, target_system, target_component);
+		ret = _instance = new MavlinkULog(max_rate_factor, target_system, target_component);
 
 		if (!_instance) {
 			failed = true;
@@ -248,15 +251,46 @@ void MavlinkULog::handle_ack(mavlink_logging_ack_t ack)
 	lock();
 
 	if (_instance) { // make sure stop() was not called right before
-		if (_wait_for_ack_sequence == ack.sequence) {
-			_ack_received = true;
-			publish_ack(ack.sequence);
+		for (int i = 0; i < _window_count; ++i) {
+			WindowEntry &entry = _window[(_window_start + i) % WINDOW_SIZE];
+
+			if (entry.data.sequence == ack.sequence) {
+				entry.acked = true;
+				break;
+			}
+		}
+
+		// release all acked messages at the start of the window and ack them to the logger at once
+		bool window_moved = false;
+		uint16_t acked_sequence = 0;
+
+		while (_window_count > 0 && _window[_window_start].acked) {
+			acked_sequence = _window[_window_start].data.sequence;
+			_window_start = (_window_start + 1) % WINDOW_SIZE;
+			--_window_count;
+			window_moved = true;
+		}
+
+		if (window_moved) {
+			publish_ack(acked_sequence);
 		}
 	}
 
 	unlock();
 }
 
+void MavlinkULog::send_data_acked(mavlink_channel_t channel, const ulog_stream_s &data)
+{
+	mavlink_logging_data_acked_t msg;
+	msg.sequence = data.sequence;
+	msg.length = data.length;
+	msg.first_message_offset = data.first_message_offset;
+	msg.target_system = _target_system;
+	msg.target_component = _target_component;
+	memcpy(msg.data, data.data, sizeof(msg.data));
+	mavlink_msg_logging_data_acked_send_struct(channel, &msg);
+}
+
 void MavlinkULog::publish_ack(uint16_t sequence)
 {
 	ulog_stream_ack_s ack;
@@ -54,6 +54,8 @@
 /**
  * @class MavlinkULog
  * ULog streaming class. At most one instance (stream) can exist, assigned to a specific mavlink channel.
+ * Messages that need an ack are sent with a sliding window: up to WINDOW_SIZE messages can be unacked,
+ * and on timeout only the unacked ones are re-sent. The logger gets cumulative acks.
  */
 class MavlinkULog
 {
@@ -66,13 +68,12 @@ public:
 	/**
 	 * try to start a new stream. This fails if a stream is already running.
 	 * thread-safe
-	 * @param datarate maximum link data rate in B/s
-	 * @param max_rate_factor let ulog streaming use a maximum of max_rate_factor * datarate
+	 * @param max_rate_factor let ulog streaming use a maximum of max_rate_factor * the data rate of the instance
 	 * @param target_system ID for mavlink message
 	 * @param target_component ID for mavlink message
 	 * @return instance, or nullptr
 	 */
-	static MavlinkULog *try_start(int datarate, float max_rate_factor, uint8_t target_system, uint8_t target_component);
+	static MavlinkULog *try_start(float max_rate_factor, uint8_t target_system, uint8_t target_component);
 
 	/**
 	 * stop the stream. It also deletes the singleton object, so make sure cleanup
@@ -83,11 +84,14 @@ public:
 
 	/**
 	 * periodic update method: check for ulog stream messages and handle retransmission.
+	 * All the queued messages are sent at once, as long as they fit into the byte budget of
+	 * max_rate_factor * datarate.
+	 * @param datarate current data rate of the mavlink instance in B/s
 	 * @return 0 on success, <0 otherwise
 	 */
-	int handle_update(mavlink_channel_t channel);
+	int handle_update(mavlink_channel_t channel, int datarate);
 
-	/** ack from mavlink for a data message */
+	/** ack from mavlink for a data message (can be received in any order) */
 	void handle_ack(mavlink_logging_ack_t ack);
 
 	/** this is called when we got an vehicle_command_ack from the logger */
@@ -96,10 +100,13 @@ public:
 	float current_data_rate() const { return _current_rate_factor; }
 	float maximum_data_rate() const { return _max_rate_factor; }
 
+	/** @return achieved streaming throughput in B/s, including the mavlink overhead */
+	float achieved_data_rate() const { return _achieved_rate; }
+
 	int get_ulog_stream_fd() const { return _ulog_stream_sub; }
 private:
 
-	MavlinkULog(int datarate, float max_rate_factor, uint8_t target_system, uint8_t target_component);
+	MavlinkULog(float max_rate_factor, uint8_t target_system, uint8_t target_component);
 
 	~MavlinkULog();
 
@@ -115,6 +122,21 @@ private:
 
 	void publish_ack(uint16_t sequence);
 
+	void send_data_acked(mavlink_channel_t channel, const ulog_stream_s &data);
+
+	void update_budget(int datarate);
+
+	static constexpr int WINDOW_SIZE = ulog_stream_ack_s::WINDOW_SIZE;
+	static constexpr int MESSAGE_SIZE = MAVLINK_MSG_ID_LOGGING_DATA_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES;
+	static constexpr int MESSAGE_ACKED_SIZE = MAVLINK_MSG_ID_LOGGING_DATA_ACKED_LEN + MAVLINK_NUM_NON_PAYLOAD_BYTES;
+
+	struct WindowEntry {
+		ulog_stream_s data;
+		hrt_abstime sent_time; ///< last time the message was sent
+		uint8_t tries;
+		bool acked;
+	};
+
 	static px4_sem_t _lock;
 	static bool _init;
 	static MavlinkULog *_instance;
@@ -122,19 +144,21 @@ private:
 
 	int _ulog_stream_sub = -1;
 	orb_advert_t _ulog_stream_ack_pub = nullptr;
-	uint16_t _wait_for_ack_sequence;
-	uint8_t _sent_tries = 0;
-	volatile bool _ack_received = false; ///< set to true if a matching ack received
-	hrt_abstime _last_sent_time = 0; ///< last time we sent a message that requires an ack
+	WindowEntry _window[WINDOW_SIZE]; ///< sent messages that require an ack, in sequence order
+	int _window_start = 0; ///< index of the oldest entry
+	volatile int _window_count = 0; ///< number of used entries (protected by lock())
+	hrt_abstime _last_sent_time = 0; ///< used to detect a timeout during initialization
 	ulog_stream_s _ulog_data;
 	bool _waiting_for_initial_ack = false;
 	const uint8_t _target_system;
 	const uint8_t _target_component;
 
 	const float _max_rate_factor; ///< maximum rate percentage at which we're allowed to push data
-	const int _max_num_messages; ///< maximum number of messages we can send within _rate_calculation_delta_t
 	float _current_rate_factor; ///< currently used rate percentage
-	int _current_num_msgs = 0;  ///< number of messages sent within the current time interval
+	float _achieved_rate = 0.f; ///< throughput of the last rate interval [B/s]
+	float _budget = 0.f; ///< bytes that can be sent now, refilled at _max_rate_factor * datarate
+	hrt_abstime _last_budget_update = 0;
+	int _bytes_sent = 0; ///< bytes sent within the current rate interval
 	hrt_abstime _next_rate_check; ///< next timestamp at which to update the rate
 
 	/* do not allow copying this class */
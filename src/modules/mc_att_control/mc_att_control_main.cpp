@@ -57,6 +57,7 @@
 #include <drivers/drv_hrt.h>
 #include <lib/geo/geo.h>
 #include <lib/mathlib/mathlib.h>
+#include <lib/mathlib/math/filter/NotchFilter.hpp>
 #include <lib/tailsitter_recovery/tailsitter_recovery.h>
 #include <px4_config.h>
 #include <px4_defines.h>
@@ -132,6 +133,7 @@ private:
 	int		_v_rates_sp_sub;		/**< vehicle rates setpoint subscription */
 	int		_v_control_mode_sub;	/**< vehicle control mode subscription */
 	int		_params_sub;			/**< parameter updates subscription */
+	uint32_t	_param_change_count;		/**< parameter change count when the parameters were last read */
 	int		_manual_control_sp_sub;	/**< manual control setpoint subscription */
 	int		_vehicle_status_sub;	/**< vehicle status subscription */
 	int		_motor_limits_sub;		/**< motor limits subscription */
@@ -171,6 +173,10 @@ private:
 	perf_counter_t	_controller_latency_perf;
 
 	math::Vector<3>		_rates_prev;	/**< angular rates on previous step */
+	math::NotchFilter<matrix::Vector3f> _gyro_notch;	/**< notch filter on the measured rates */
+	float			_loop_update_rate_hz{250.0f};	/**< estimated loop rate, used as sample rate of the notch filter */
+	hrt_abstime		_last_attitude_run{0};	/**< last run of the attitude stage */
+	hrt_abstime		_att_interval_us{0};	/**< attitude stage interval, 0 = with every gyro sample */
 	math::Vector<3>		_rates_sp_prev; /**< previous rates setpoint */
 	math::Vector<3>		_rates_sp;		/**< angular rates setpoint */
 	math::Vector<3>		_rates_int;		/**< angular rates integral error */
@@ -200,6 +206,9 @@ private:
 		param_t tpa_rate_p;
 		param_t tpa_rate_i;
 		param_t tpa_rate_d;
+		param_t gyro_notch_freq;
+		param_t gyro_notch_bw;
+		param_t att_loop_rate;
 		param_t yaw_p;
 		param_t yaw_rate_p;
 		param_t yaw_rate_i;
@@ -250,6 +259,10 @@ private:
 		float tpa_rate_i;					/**< Throttle PID Attenuation slope */
 		float tpa_rate_d;					/**< Throttle PID Attenuation slope */
 
+		float gyro_notch_freq;				/**< notch filter center frequency [Hz], 0 = disabled */
+		float gyro_notch_bw;				/**< notch filter bandwidth [Hz] */
+		int32_t att_loop_rate;				/**< attitude stage rate [Hz], 0 = gyro rate */
+
 		float roll_rate_max;
 		float pitch_rate_max;
 		float yaw_rate_max;
@@ -305,6 +318,18 @@ private:
 	 */
 	void		control_attitude_rates(float dt);
 
+	/**
+	 * Attitude stage, runs at MC_ATT_LOOP_RATE: select the rates setpoint (attitude
+	 * controller, acro or external rates setpoint) and publish it, or handle flight termination.
+	 */
+	void		control_attitude_setpoint(float dt);
+
+	/**
+	 * Rate stage, runs with every gyro sample: rates controller and actuator controls.
+	 * @param publish_status also publish the controller status
+	 */
+	void		control_rates(float dt, bool publish_status);
+
 	/**
 	 * Throttle PID attenuation.
 	 */
@@ -337,6 +362,7 @@ MulticopterAttitudeControl::MulticopterAttitudeControl() :
 	_v_att_sp_sub(-1),
 	_v_control_mode_sub(-1),
 	_params_sub(-1),
+	_param_change_count(0),
 	_manual_control_sp_sub(-1),
 	_vehicle_status_sub(-1),
 	_motor_limits_sub(-1),
@@ -371,7 +397,7 @@ MulticopterAttitudeControl::MulticopterAttitudeControl() :
 	_sensor_bias{},
 	_saturation_status{},
 	/* performance counters */
-	_loop_perf(perf_alloc(PC_ELAPSED, "mc_att_control")),
+	_loop_perf(perf_alloc(PC_HISTOGRAM, "mc_att_control")),
 	_controller_latency_perf(perf_alloc_once(PC_ELAPSED, "ctrl_latency"))
 {
 	for (uint8_t i = 0; i < MAX_GYRO_COUNT; i++) {
@@ -434,6 +460,10 @@ MulticopterAttitudeControl::MulticopterAttitudeControl() :
 	_params_handles.tpa_rate_i	 	= 	param_find("MC_TPA_RATE_I");
 	_params_handles.tpa_rate_d	 	= 	param_find("MC_TPA_RATE_D");
 
+	_params_handles.gyro_notch_freq		= 	param_find("MC_NOTCH_FREQ");
+	_params_handles.gyro_notch_bw		= 	param_find("MC_NOTCH_BW");
+	_params_handles.att_loop_rate		= 	param_find("MC_ATT_LOOP_RATE");
+
 	_params_handles.yaw_p			=	param_find("MC_YAW_P");
 	_params_handles.yaw_rate_p		= 	param_find("MC_YAWRATE_P");
 	_params_handles.yaw_rate_i		= 	param_find("MC_YAWRATE_I");
@@ -509,6 +539,8 @@ MulticopterAttitudeControl::parameters_update()
 {
 	float v;
 
+	_param_change_count = param_change_count();
+
 	float roll_tc, pitch_tc;
 
 	param_get(_params_handles.roll_tc, &roll_tc);
@@ -606,6 +638,13 @@ MulticopterAttitudeControl::parameters_update()
 
 	param_get(_params_handles.bat_scale_en, &_params.bat_scale_en);
 
+	param_get(_params_handles.gyro_notch_freq, &_params.gyro_notch_freq);
+	param_get(_params_handles.gyro_notch_bw, &_params.gyro_notch_bw);
+	_gyro_notch.set_parameters(_loop_update_rate_hz, _params.gyro_notch_freq, _params.gyro_notch_bw);
+
+	param_get(_params_handles.att_loop_rate, &_params.att_loop_rate);
+	_att_interval_us = (_params.att_loop_rate > 0) ? 1000000 / _params.att_loop_rate : 0;
+
 	_actuators_0_circuit_breaker_enabled = circuit_breaker_enabled("CBRK_RATE_CTRL", CBRK_RATE_CTRL_KEY);
 
 	/* rotation of the autopilot relative to the body */
@@ -638,7 +677,16 @@ MulticopterAttitudeControl::parameter_update_poll()
 	if (updated) {
 		struct parameter_update_s param_update;
 		orb_copy(ORB_ID(parameter_update), _params_sub, &param_update);
-		parameters_update();
+
+		/* skip the reload if none of our parameters changed */
+		if (param_group_changed_since(_param_change_count, "MC_")
+		    || param_group_changed_since(_param_change_count, "SENS_BOARD_")
+		    || param_group_changed_since(_param_change_count, "VT_")) {
+			parameters_update();
+
+		} else {
+			_param_change_count = param_update.change_count;
+		}
 	}
 }
 
@@ -812,9 +860,8 @@ MulticopterAttitudeControl::control_attitude(float dt)
 	math::Quaternion q_sp(_v_att_sp.q_d[0], _v_att_sp.q_d[1], _v_att_sp.q_d[2], _v_att_sp.q_d[3]);
 	math::Matrix<3, 3> R_sp = q_sp.to_dcm();
 
-	/* get current rotation matrix from control state quaternions */
-	math::Quaternion q_att(_v_att.q[0], _v_att.q[1], _v_att.q[2], _v_att.q[3]);
-	math::Matrix<3, 3> R = q_att.to_dcm();
+	/* current rotation matrix, precomputed by the estimator */
+	math::Matrix<3, 3> R(_v_att.R);
 
 	/* all input data is ready, run controller itself */
 
@@ -949,7 +996,7 @@ MulticopterAttitudeControl::pid_attenuations(float tpa_breakpoint, float tpa_rat
  * Input: '_rates_sp' vector, '_thrust_sp'
  * Output: '_att_control' vector
  */
-void
+PX4_FAST_CODE void
 MulticopterAttitudeControl::control_attitude_rates(float dt)
 {
 	/* reset integral if disarmed */
@@ -989,6 +1036,18 @@ MulticopterAttitudeControl::control_attitude_rates(float dt)
 	rates(1) -= _sensor_bias.gyro_y_bias;
 	rates(2) -= _sensor_bias.gyro_z_bias;
 
+	/* notch out the frame vibration, retuning when the loop rate estimate has drifted */
+	_loop_update_rate_hz = 0.99f * _loop_update_rate_hz + 0.01f / dt;
+
+	if (fabsf(_loop_update_rate_hz - _gyro_notch.get_sample_freq()) > 0.1f * _gyro_notch.get_sample_freq()) {
+		_gyro_notch.set_parameters(_loop_update_rate_hz, _params.gyro_notch_freq, _params.gyro_notch_bw);
+	}
+
+	const matrix::Vector3f rates_filtered = _gyro_notch.apply(matrix::Vector3f(rates.data));
+	rates(0) = rates_filtered(0);
+	rates(1) = rates_filtered(1);
+	rates(2) = rates_filtered(2);
+
 	math::Vector<3> rates_p_scaled = _params.rate_p.emult(pid_attenuations(_params.tpa_breakpoint_p, _params.tpa_rate_p));
 	//math::Vector<3> rates_i_scaled = _params.rate_i.emult(pid_attenuations(_params.tpa_breakpoint_i, _params.tpa_rate_i));
 	math::Vector<3> rates_d_scaled = _params.rate_d.emult(pid_attenuations(_params.tpa_breakpoint_d, _params.tpa_rate_d));
@@ -1048,6 +1107,205 @@ MulticopterAttitudeControl::control_attitude_rates(float dt)
 	}
 }
 
+void
+MulticopterAttitudeControl::control_attitude_setpoint(float dt)
+{
+	/* Check if we are in rattitude mode and the pilot is above the threshold on pitch
+	 * or roll (yaw can rotate 360 in normal att control).  If both are true don't
+	 * even bother running the attitude controllers */
+	if (_v_control_mode.flag_control_rattitude_enabled) {
+		if (fabsf(_manual_control_sp.y) > _params.rattitude_thres ||
+		    fabsf(_manual_control_sp.x) > _params.rattitude_thres) {
+			_v_control_mode.flag_control_attitude_enabled = false;
+		}
+	}
+
+	if (_v_control_mode.flag_control_attitude_enabled) {
+
+		if (_ts_opt_recovery == nullptr) {
+			// the  tailsitter recovery instance has not been created, thus, the vehicle
+			// is not a tailsitter, do normal attitude control
+			control_attitude(dt);
+
+		} else {
+			vehicle_attitude_setpoint_poll();
+			_thrust_sp = _v_att_sp.thrust;
+			math::Quaternion q(_v_att.q[0], _v_att.q[1], _v_att.q[2], _v_att.q[3]);
+			math::Quaternion q_sp(&_v_att_sp.q_d[0]);
+			_ts_opt_recovery->setAttGains(_params.att_p, _params.yaw_ff);
+			_ts_opt_recovery->calcOptimalRates(q, q_sp, _v_att_sp.yaw_sp_move_rate, _rates_sp);
+
+			/* limit rates */
+			for (int i = 0; i < 3; i++) {
+				_rates_sp(i) = math::constrain(_rates_sp(i), -_params.mc_rate_max(i), _params.mc_rate_max(i));
+			}
+		}
+
+		/* publish attitude rates setpoint */
+		_v_rates_sp.roll = _rates_sp(0);
+		_v_rates_sp.pitch = _rates_sp(1);
+		_v_rates_sp.yaw = _rates_sp(2);
+		_v_rates_sp.thrust = _thrust_sp;
+		_v_rates_sp.timestamp = hrt_absolute_time();
+
+		if (_v_rates_sp_pub != nullptr) {
+			orb_publish(_rates_sp_id, _v_rates_sp_pub, &_v_rates_sp);
+
+		} else if (_rates_sp_id) {
+			_v_rates_sp_pub = orb_advertise(_rates_sp_id, &_v_rates_sp);
+		}
+
+	} else {
+		/* attitude controller disabled, poll rates setpoint topic */
+		if (_v_control_mode.flag_control_manual_enabled) {
+			/* manual rates control - ACRO mode */
+			matrix::Vector3f man_rate_sp;
+			man_rate_sp(0) = math::superexpo(_manual_control_sp.y, _params.acro_expo, _params.acro_superexpo);
+			man_rate_sp(1) = math::superexpo(-_manual_control_sp.x, _params.acro_expo, _params.acro_superexpo);
+			man_rate_sp(2) = math::superexpo(_manual_control_sp.r, _params.acro_expo, _params.acro_superexpo);
+			man_rate_sp = man_rate_sp.emult(_params.acro_rate_max);
+			_rates_sp = math::Vector<3>(man_rate_sp.data());
+			_thrust_sp = _manual_control_sp.z;
+
+			/* publish attitude rates setpoint */
+			_v_rates_sp.roll = _rates_sp(0);
+			_v_rates_sp.pitch = _rates_sp(1);
+			_v_rates_sp.yaw = _rates_sp(2);
+			_v_rates_sp.thrust = _thrust_sp;
+			_v_rates_sp.timestamp = hrt_absolute_time();
+
+			if (_v_rates_sp_pub != nullptr) {
+				orb_publish(_rates_sp_id, _v_rates_sp_pub, &_v_rates_sp);
+
+			} else if (_rates_sp_id) {
+				_v_rates_sp_pub = orb_advertise(_rates_sp_id, &_v_rates_sp);
+			}
+
+		} else {
+			/* attitude controller disabled, poll rates setpoint topic */
+			vehicle_rates_setpoint_poll();
+			_rates_sp(0) = _v_rates_sp.roll;
+			_rates_sp(1) = _v_rates_sp.pitch;
+			_rates_sp(2) = _v_rates_sp.yaw;
+			_thrust_sp = _v_rates_sp.thrust;
+		}
+	}
+
+	if (_v_control_mode.flag_control_termination_enabled) {
+		if (!_vehicle_status.is_vtol) {
+
+			_rates_sp.zero();
+			_rates_int.zero();
+			_thrust_sp = 0.0f;
+			_att_control.zero();
+
+			/* publish actuator controls */
+			_actuators.control[0] = 0.0f;
+			_actuators.control[1] = 0.0f;
+			_actuators.control[2] = 0.0f;
+			_actuators.control[3] = 0.0f;
+			_actuators.timestamp = hrt_absolute_time();
+			_actuators.timestamp_sample = _v_att.timestamp_sample;
+
+			if (!_actuators_0_circuit_breaker_enabled) {
+				if (_actuators_0_pub != nullptr) {
+
+					orb_publish(_actuators_id, _actuators_0_pub, &_actuators);
+					perf_end(_controller_latency_perf);
+
+				} else if (_actuators_id) {
+					_actuators_0_pub = orb_advertise(_actuators_id, &_actuators);
+				}
+			}
+
+			_controller_status.roll_rate_integ = _rates_int(0);
+			_controller_status.pitch_rate_integ = _rates_int(1);
+			_controller_status.yaw_rate_integ = _rates_int(2);
+			_controller_status.timestamp = hrt_absolute_time();
+
+			/* publish controller status */
+			if (_controller_status_pub != nullptr) {
+				orb_publish(ORB_ID(mc_att_ctrl_status), _controller_status_pub, &_controller_status);
+
+			} else {
+				_controller_status_pub = orb_advertise(ORB_ID(mc_att_ctrl_status), &_controller_status);
+			}
+
+			/* publish attitude rates setpoint */
+			_v_rates_sp.roll = _rates_sp(0);
+			_v_rates_sp.pitch = _rates_sp(1);
+			_v_rates_sp.yaw = _rates_sp(2);
+			_v_rates_sp.thrust = _thrust_sp;
+			_v_rates_sp.timestamp = hrt_absolute_time();
+
+			if (_v_rates_sp_pub != nullptr) {
+				orb_publish(_rates_sp_id, _v_rates_sp_pub, &_v_rates_sp);
+
+			} else if (_rates_sp_id) {
+				_v_rates_sp_pub = orb_advertise(_rates_sp_id, &_v_rates_sp);
+			}
+		}
+	}
+}
+
+void
+MulticopterAttitudeControl::control_rates(float dt, bool publish_status)
+{
+	/* the termination output was published by the attitude stage */
+	if (!_v_control_mode.flag_control_rates_enabled ||
+	    (_v_control_mode.flag_control_termination_enabled && !_vehicle_status.is_vtol)) {
+		return;
+	}
+
+	control_attitude_rates(dt);
+
+	/* publish actuator controls */
+	_actuators.control[0] = (PX4_ISFINITE(_att_control(0))) ? _att_control(0) : 0.0f;
+	_actuators.control[1] = (PX4_ISFINITE(_att_control(1))) ? _att_control(1) : 0.0f;
+	_actuators.control[2] = (PX4_ISFINITE(_att_control(2))) ? _att_control(2) : 0.0f;
+	_actuators.control[3] = (PX4_ISFINITE(_thrust_sp)) ? _thrust_sp : 0.0f;
+	_actuators.control[7] = _v_att_sp.landing_gear;
+	_actuators.timestamp = hrt_absolute_time();
+	/* the rate controller runs on the gyro samples */
+	_actuators.timestamp_sample = _sensor_gyro.timestamp;
+
+	/* scale effort by battery status */
+	if (_params.bat_scale_en && _battery_status.scale > 0.0f) {
+		for (int i = 0; i < 4; i++) {
+			_actuators.control[i] *= _battery_status.scale;
+		}
+	}
+
+	if (!_actuators_0_circuit_breaker_enabled) {
+		if (_actuators_0_pub != nullptr) {
+
+			orb_publish(_actuators_id, _actuators_0_pub, &_actuators);
+			perf_end(_controller_latency_perf);
+
+		} else if (_actuators_id) {
+			_actuators_0_pub = orb_advertise(_actuators_id, &_actuators);
+		}
+
+	}
+
+	if (!publish_status) {
+		return;
+	}
+
+	_controller_status.roll_rate_integ = _rates_int(0);
+	_controller_status.pitch_rate_integ = _rates_int(1);
+	_controller_status.yaw_rate_integ = _rates_int(2);
+	_controller_status.timestamp = hrt_absolute_time();
+
+	/* publish controller status */
+	if (_controller_status_pub != nullptr) {
+		orb_publish(ORB_ID(mc_att_ctrl_status), _controller_status_pub, &_controller_status);
+
+	} else {
+		_controller_status_pub = orb_advertise(ORB_ID(mc_att_ctrl_status), &_controller_status);
+	}
+}
+
 void
 MulticopterAttitudeControl::task_main_trampoline(int argc, char *argv[])
 {
@@ -1116,12 +1374,13 @@ MulticopterAttitudeControl::task_main()
 		/* run controller on gyro changes */
 		if (poll_fds.revents & POLLIN) {
 			static uint64_t last_run = 0;
-			float dt = (hrt_absolute_time() - last_run) / 1000000.0f;
-			last_run = hrt_absolute_time();
+			const hrt_abstime now = hrt_absolute_time();
+			float dt = (now - last_run) / 1000000.0f;
+			last_run = now;
 
-			/* guard against too small (< 2ms) and too large (> 20ms) dt's */
-			if (dt < 0.002f) {
-				dt = 0.002f;
+			/* guard against too small (< 0.2ms) and too large (> 20ms) dt's */
+			if (dt < 0.0002f) {
+				dt = 0.0002f;
 
 			} else if (dt > 0.02f) {
 				dt = 0.02f;
@@ -1130,198 +1389,40 @@ MulticopterAttitudeControl::task_main()
 			/* copy gyro data */
 			orb_copy(ORB_ID(sensor_gyro), _sensor_gyro_sub[_selected_gyro], &_sensor_gyro);
 
-			/* check for updates in other topics */
-			parameter_update_poll();
-			vehicle_control_mode_poll();
-			vehicle_manual_poll();
-			vehicle_status_poll();
-			vehicle_motor_limits_poll();
-			battery_status_poll();
-			vehicle_attitude_poll();
-			sensor_correction_poll();
-			sensor_bias_poll();
-
-			/* Check if we are in rattitude mode and the pilot is above the threshold on pitch
-			 * or roll (yaw can rotate 360 in normal att control).  If both are true don't
-			 * even bother running the attitude controllers */
-			if (_v_control_mode.flag_control_rattitude_enabled) {
-				if (fabsf(_manual_control_sp.y) > _params.rattitude_thres ||
-				    fabsf(_manual_control_sp.x) > _params.rattitude_thres) {
-					_v_control_mode.flag_control_attitude_enabled = false;
-				}
-			}
+			/*
+			 * The attitude controller and the setpoint and status polling run at MC_ATT_LOOP_RATE,
+			 * the rate controller with every gyro sample. Half a gyro interval of tolerance keeps
+			 * the attitude loop from skipping a sample because of jitter.
+			 */
+			const bool run_attitude = (_att_interval_us == 0) ||
+						  (now - _last_attitude_run + (hrt_abstime)(dt * 500000.0f) >= _att_interval_us);
 
-			if (_v_control_mode.flag_control_attitude_enabled) {
-
-				if (_ts_opt_recovery == nullptr) {
-					// the  tailsitter recovery instance has not been created, thus, the vehicle
-					// is not a tailsitter, do normal attitude control
-					control_attitude(dt);
-
-				} else {
-					vehicle_attitude_setpoint_poll();
-					_thrust_sp = _v_att_sp.thrust;
-					math::Quaternion q(_v_att.q[0], _v_att.q[1], _v_att.q[2], _v_att.q[3]);
-					math::Quaternion q_sp(&_v_att_sp.q_d[0]);
-					_ts_opt_recovery->setAttGains(_params.att_p, _params.yaw_ff);
-					_ts_opt_recovery->calcOptimalRates(q, q_sp, _v_att_sp.yaw_sp_move_rate, _rates_sp);
-
-					/* limit rates */
-					for (int i = 0; i < 3; i++) {
-						_rates_sp(i) = math::constrain(_rates_sp(i), -_params.mc_rate_max(i), _params.mc_rate_max(i));
-					}
-				}
-
-				/* publish attitude rates setpoint */
-				_v_rates_sp.roll = _rates_sp(0);
-				_v_rates_sp.pitch = _rates_sp(1);
-				_v_rates_sp.yaw = _rates_sp(2);
-				_v_rates_sp.thrust = _thrust_sp;
-				_v_rates_sp.timestamp = hrt_absolute_time();
+			if (run_attitude) {
+				float att_dt = (now - _last_attitude_run) / 1000000.0f;
+				_last_attitude_run = now;
 
-				if (_v_rates_sp_pub != nullptr) {
-					orb_publish(_rates_sp_id, _v_rates_sp_pub, &_v_rates_sp);
+				if (att_dt < 0.002f) {
+					att_dt = 0.002f;
 
-				} else if (_rates_sp_id) {
-					_v_rates_sp_pub = orb_advertise(_rates_sp_id, &_v_rates_sp);
+				} else if (att_dt > 0.02f) {
+					att_dt = 0.02f;
 				}
 
-			} else {
-				/* attitude controller disabled, poll rates setpoint topic */
-				if (_v_control_mode.flag_control_manual_enabled) {
-					/* manual rates control - ACRO mode */
-					matrix::Vector3f man_rate_sp;
-					man_rate_sp(0) = math::superexpo(_manual_control_sp.y, _params.acro_expo, _params.acro_superexpo);
-					man_rate_sp(1) = math::superexpo(-_manual_control_sp.x, _params.acro_expo, _params.acro_superexpo);
-					man_rate_sp(2) = math::superexpo(_manual_control_sp.r, _params.acro_expo, _params.acro_superexpo);
-					man_rate_sp = man_rate_sp.emult(_params.acro_rate_max);
-					_rates_sp = math::Vector<3>(man_rate_sp.data());
-					_thrust_sp = _manual_control_sp.z;
-
-					/* publish attitude rates setpoint */
-					_v_rates_sp.roll = _rates_sp(0);
-					_v_rates_sp.pitch = _rates_sp(1);
-					_v_rates_sp.yaw = _rates_sp(2);
-					_v_rates_sp.thrust = _thrust_sp;
-					_v_rates_sp.timestamp = hrt_absolute_time();
-
-					if (_v_rates_sp_pub != nullptr) {
-						orb_publish(_rates_sp_id, _v_rates_sp_pub, &_v_rates_sp);
-
-					} else if (_rates_sp_id) {
-						_v_rates_sp_pub = orb_advertise(_rates_sp_id, &_v_rates_sp);
-					}
-
-				} else {
-					/* attitude controller disabled, poll rates setpoint topic */
-					vehicle_rates_setpoint_poll();
-					_rates_sp(0) = _v_rates_sp.roll;
-					_rates_sp(1) = _v_rates_sp.pitch;
-					_rates_sp(2) = _v_rates_sp.yaw;
-					_thrust_sp = _v_rates_sp.thrust;
-				}
+				/* check for updates in other topics */
+				parameter_update_poll();
+				vehicle_control_mode_poll();
+				vehicle_manual_poll();
+				vehicle_status_poll();
+				vehicle_motor_limits_poll();
+				battery_status_poll();
+				vehicle_attitude_poll();
+				sensor_correction_poll();
+				sensor_bias_poll();
+
+				control_attitude_setpoint(att_dt);
 			}
 
-			if (_v_control_mode.flag_control_rates_enabled) {
-				control_attitude_rates(dt);
-
-				/* publish actuator controls */
-				_actuators.control[0] = (PX4_ISFINITE(_att_control(0))) ? _att_control(0) : 0.0f;
-				_actuators.control[1] = (PX4_ISFINITE(_att_control(1))) ? _att_control(1) : 0.0f;
-				_actuators.control[2] = (PX4_ISFINITE(_att_control(2))) ? _att_control(2) : 0.0f;
-				_actuators.control[3] = (PX4_ISFINITE(_thrust_sp)) ? _thrust_sp : 0.0f;
-				_actuators.control[7] = _v_att_sp.landing_gear;
-				_actuators.timestamp = hrt_absolute_time();
-				_actuators.timestamp_sample = _v_att.timestamp;
-
-				/* scale effort by battery status */
-				if (_params.bat_scale_en && _battery_status.scale > 0.0f) {
-					for (int i = 0; i < 4; i++) {
-						_actuators.control[i] *= _battery_status.scale;
-					}
-				}
-
-				_controller_status.roll_rate_integ = _rates_int(0);
-				_controller_status.pitch_rate_integ = _rates_int(1);
-				_controller_status.yaw_rate_integ = _rates_int(2);
-				_controller_status.timestamp = hrt_absolute_time();
-
-				if (!_actuators_0_circuit_breaker_enabled) {
-					if (_actuators_0_pub != nullptr) {
-
-						orb_publish(_actuators_id, _actuators_0_pub, &_actuators);
-						perf_end(_controller_latency_perf);
-
-					} else if (_actuators_id) {
-						_actuators_0_pub = orb_advertise(_actuators_id, &_actuators);
-					}
-
-				}
-
-				/* publish controller status */
-				if (_controller_status_pub != nullptr) {
-					orb_publish(ORB_ID(mc_att_ctrl_status), _controller_status_pub, &_controller_status);
-
-				} else {
-					_controller_status_pub = orb_advertise(ORB_ID(mc_att_ctrl_status), &_controller_status);
-				}
-			}
-
-			if (_v_control_mode.flag_control_termination_enabled) {
-				if (!_vehicle_status.is_vtol) {
-
-					_rates_sp.zero();
-					_rates_int.zero();
-					_thrust_sp = 0.0f;
-					_att_control.zero();
-
-					/* publish actuator controls */
-					_actuators.control[0] = 0.0f;
-					_actuators.control[1] = 0.0f;
-					_actuators.control[2] = 0.0f;
-					_actuators.control[3] = 0.0f;
-					_actuators.timestamp = hrt_absolute_time();
-					_actuators.timestamp_sample = _v_att.timestamp;
-
-					if (!_actuators_0_circuit_breaker_enabled) {
-						if (_actuators_0_pub != nullptr) {
-
-							orb_publish(_actuators_id, _actuators_0_pub, &_actuators);
-							perf_end(_controller_latency_perf);
-
-						} else if (_actuators_id) {
-							_actuators_0_pub = orb_advertise(_actuators_id, &_actuators);
-						}
-					}
-
-					_controller_status.roll_rate_integ = _rates_int(0);
-					_controller_status.pitch_rate_integ = _rates_int(1);
-					_controller_status.yaw_rate_integ = _rates_int(2);
-					_controller_status.timestamp = hrt_absolute_time();
-
-					/* publish controller status */
-					if (_controller_status_pub != nullptr) {
-						orb_publish(ORB_ID(mc_att_ctrl_status), _controller_status_pub, &_controller_status);
-
-					} else {
-						_controller_status_pub = orb_advertise(ORB_ID(mc_att_ctrl_status), &_controller_status);
-					}
-
-					/* publish attitude rates setpoint */
-					_v_rates_sp.roll = _rates_sp(0);
-					_v_rates_sp.pitch = _rates_sp(1);
-					_v_rates_sp.yaw = _rates_sp(2);
-					_v_rates_sp.thrust = _thrust_sp;
-					_v_rates_sp.timestamp = hrt_absolute_time();
-
-					if (_v_rates_sp_pub != nullptr) {
-						orb_publish(_rates_sp_id, _v_rates_sp_pub, &_v_rates_sp);
-
-					} else if (_rates_sp_id) {
-						_v_rates_sp_pub = orb_advertise(_rates_sp_id, &_v_rates_sp);
-					}
-				}
-			}
+			control_rates(dt, run_attitude);
 		}
 
 		perf_end(_loop_perf);
@@ -554,3 +554,48 @@ PARAM_DEFINE_FLOAT(MC_TPA_RATE_I, 0.0f);
  * @group Multicopter Attitude Control
  */
 PARAM_DEFINE_FLOAT(MC_TPA_RATE_D, 0.0f);
+
+/**
+ * Gyro notch filter frequency
+ *
+ * Center frequency of a notch filter on the measured angular rates used by the rate controller,
+ * to reject a narrow band of frame or propeller vibration.
+ * The filter follows the measured loop rate. Set to 0 to disable it.
+ *
+ * @unit Hz
+ * @min 0.0
+ * @max 500.0
+ * @decimal 1
+ * @increment 1.0
+ * @group Multicopter Attitude Control
+ */
+PARAM_DEFINE_FLOAT(MC_NOTCH_FREQ, 0.0f);
+
+/**
+ * Gyro notch filter bandwidth
+ *
+ * Width of the stop band of the notch filter (see MC_NOTCH_FREQ).
+ * A wider notch adds more phase delay around the notch frequency.
+ *
+ * @unit Hz
+ * @min 1.0
+ * @max 100.0
+ * @decimal 1
+ * @increment 1.0
+ * @group Multicopter Attitude Control
+ */
+PARAM_DEFINE_FLOAT(MC_NOTCH_BW, 20.0f);
+
+/**
+ * Attitude control loop rate
+ *
+ * The rate controller runs with every gyro sample. The attitude controller, and the polling
+ * of the setpoints and vehicle state, run at this lower rate, to keep the rate loop short
+ * with high rate gyro drivers. Set to 0 to run them with every gyro sample as well.
+ *
+ * @unit Hz
+ * @min 0
+ * @max 1000
+ * @group Multicopter Attitude Control
+ */
+PARAM_DEFINE_INT32(MC_ATT_LOOP_RATE, 250);
@@ -0,0 +1,210 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2017 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file TrajectoryGenerator.cpp
+ */
+
+#include "TrajectoryGenerator.h"
+
+#include <float.h>
+#include <math.h>
+#include <px4_defines.h>
+#include <mathlib/mathlib.h>
+
+namespace pos_control
+{
+
+bool
+TrajectoryGenerator::plan(float length, float start_vel, float end_vel, float max_vel, float max_acc,
+			  float max_jerk)
+{
+	if (!(max_vel > 0.0f) || !(max_acc > 0.0f) || !(max_jerk > 0.0f) || !(length >= 0.0f) ||
+	    !PX4_ISFINITE(start_vel) || !PX4_ISFINITE(end_vel)) {
+		return false;
+	}
+
+	_max_acc = max_acc;
+	_max_jerk = max_jerk;
+
+	start_vel = math::max(start_vel, 0.0f);
+	end_vel = math::constrain(end_vel, 0.0f, max_vel);
+
+	const float min_cruise_vel = math::max(start_vel, end_vel);
+	float cruise_vel;
+	float cruise_time = 0.0f;
+	float dist = distance_needed(start_vel, max_vel, end_vel);
+
+	if (dist <= length) {
+		/* long enough to reach the cruise velocity */
+		cruise_vel = max_vel;
+		cruise_time = (length - dist) / cruise_vel;
+
+	} else if (max_vel <= min_cruise_vel || distance_needed(start_vel, min_cruise_vel, end_vel) >= length) {
+		/* too short: change directly to the end velocity */
+		cruise_vel = min_cruise_vel;
+
+	} else {
+		/* the distance is monotonic in the cruise velocity, so bisect for the highest velocity that fits.
+		 * This only runs when planning. */
+		float lower = min_cruise_vel;
+		float upper = max_vel;
+
+		for (int i = 0; i < 16; i++) {
+			const float mid = 0.5f * (lower + upper);
+
+			if (distance_needed(start_vel, mid, end_vel) <= length) {
+				lower = mid;
+
+			} else {
+				upper = mid;
+			}
+		}
+
+		cruise_vel = lower;
+
+		if (cruise_vel > FLT_EPSILON) {
+			cruise_time = math::max(length - distance_needed(start_vel, cruise_vel, end_vel), 0.0f) / cruise_vel;
+		}
+	}
+
+	_num_segments = 0;
+	_duration = 0.0f;
+	_end_pos = 0.0f;
+	_cruise_vel = cruise_vel;
+	_end_vel = end_vel;
+
+	/* the state at the start of the first segment */
+	_segments[0].pos = 0.0f;
+	_segments[0].vel = start_vel;
+	_segments[0].acc = 0.0f;
+
+	add_velocity_change(start_vel, cruise_vel);
+	add_segment(cruise_time, 0.0f);
+	add_velocity_change(cruise_vel, end_vel);
+
+	return true;
+}
+
+float
+TrajectoryGenerator::velocity_change_time(float start_vel, float end_vel) const
+{
+	const float delta_vel = fabsf(end_vel - start_vel);
+
+	if (delta_vel * _max_jerk >= _max_acc * _max_acc) {
+		/* the acceleration limit is reached */
+		return delta_vel / _max_acc + _max_acc / _max_jerk;
+	}
+
+	return 2.0f * sqrtf(delta_vel / _max_jerk);
+}
+
+void
+TrajectoryGenerator::add_velocity_change(float start_vel, float end_vel)
+{
+	const float delta_vel = end_vel - start_vel;
+	const float jerk = delta_vel > 0.0f ? _max_jerk : -_max_jerk;
+	float jerk_time;
+	float const_acc_time = 0.0f;
+
+	if (fabsf(delta_vel) * _max_jerk >= _max_acc * _max_acc) {
+		jerk_time = _max_acc / _max_jerk;
+		const_acc_time = fabsf(delta_vel) / _max_acc - jerk_time;
+
+	} else {
+		jerk_time = sqrtf(fabsf(delta_vel) / _max_jerk);
+	}
+
+	add_segment(jerk_time, jerk);
+	add_segment(const_acc_time, 0.0f);
+	add_segment(jerk_time, -jerk);
+}
+
+void
+TrajectoryGenerator::add_segment(float duration, float jerk)
+{
+	if (duration < 1e-6f || _num_segments >= MAX_SEGMENTS) {
+		return;
+	}
+
+	Segment &segment = _segments[_num_segments];
+
+	if (_num_segments > 0) {
+		/* start where the previous segment ends */
+		const Segment &prev = _segments[_num_segments - 1];
+		segment_state(prev, prev.duration, segment.pos, segment.vel, segment.acc);
+	}
+
+	segment.start_time = _duration;
+	segment.duration = duration;
+	segment.jerk = jerk;
+
+	++_num_segments;
+	_duration += duration;
+
+	float vel, acc;
+	segment_state(segment, duration, _end_pos, vel, acc);
+}
+
+void
+TrajectoryGenerator::segment_state(const Segment &segment, float dt, float &pos, float &vel, float &acc)
+{
+	acc = segment.acc + segment.jerk * dt;
+	vel = segment.vel + (segment.acc + 0.5f * segment.jerk * dt) * dt;
+	pos = segment.pos + (segment.vel + (0.5f * segment.acc + segment.jerk * dt / 6.0f) * dt) * dt;
+}
+
+void
+TrajectoryGenerator::evaluate(float t, float &pos, float &vel, float &acc) const
+{
+	if (_num_segments == 0 || t >= _duration) {
+		/* after the end of the profile: continue with the end velocity */
+		pos = _end_pos + _end_vel * math::max(t - _duration, 0.0f);
+		vel = _end_vel;
+		acc = 0.0f;
+		return;
+	}
+
+	t = math::max(t, 0.0f);
+
+	int i = 0;
+
+	while (i < _num_segments - 1 && t >= _segments[i].start_time + _segments[i].duration) {
+		++i;
+	}
+
+	const Segment &segment = _segments[i];
+	segment_state(segment, math::min(t - segment.start_time, segment.duration), pos, vel, acc);
+}
+
+} // namespace pos_control
@@ -0,0 +1,127 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2017 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file TrajectoryGenerator.h
+ * Jerk-limited trajectory along a straight line segment.
+ *
+ * The profile is planned once (e.g. when a new setpoint triplet arrives) as a sequence of
+ * constant-jerk segments. Evaluating it on every control cycle is then a cubic polynomial,
+ * which gives the position setpoint together with the feed-forward velocity and acceleration.
+ */
+
+#pragma once
+
+namespace pos_control
+{
+
+class TrajectoryGenerator
+{
+public:
+	TrajectoryGenerator() = default;
+	~TrajectoryGenerator() = default;
+
+	/**
+	 * Plan a profile along a line of a given length. The acceleration is assumed to be zero at the start.
+	 * If the distance is too short to reach end_vel, the end velocity is reached behind the end of the line.
+	 * @param length distance to travel [m]
+	 * @param start_vel velocity at the start, >= 0 [m/s]
+	 * @param end_vel velocity at the end, >= 0 [m/s]
+	 * @param max_vel cruise velocity [m/s]
+	 * @param max_acc acceleration limit [m/s^2]
+	 * @param max_jerk jerk limit [m/s^3]
+	 * @return false if the limits are invalid (the profile is not changed in that case)
+	 */
+	bool plan(float length, float start_vel, float end_vel, float max_vel, float max_acc, float max_jerk);
+
+	/**
+	 * Evaluate the profile. Beyond the end, the profile continues with the end velocity.
+	 * @param t time since the start of the profile [s]
+	 * @param pos distance from the start [m]
+	 * @param vel velocity [m/s]
+	 * @param acc acceleration [m/s^2]
+	 */
+	void evaluate(float t, float &pos, float &vel, float &acc) const;
+
+	/** @return duration of the profile [s] */
+	float duration() const { return _duration; }
+
+	/** @return velocity reached after the acceleration phase [m/s] */
+	float cruise_velocity() const { return _cruise_vel; }
+
+	void reset() { _num_segments = 0; _duration = 0.0f; }
+
+	static constexpr int MAX_SEGMENTS = 7;
+
+private:
+	struct Segment {
+		float start_time;
+		float duration;
+		float jerk;
+		float pos; ///< state at the start of the segment
+		float vel;
+		float acc;
+	};
+
+	/**
+	 * append up to 3 segments (jerk, constant acceleration, jerk) that change the velocity
+	 * from start_vel to end_vel with zero acceleration at both ends
+	 */
+	void add_velocity_change(float start_vel, float end_vel);
+
+	void add_segment(float duration, float jerk);
+
+	/** evaluate the polynomial of a segment at dt after its start */
+	static void segment_state(const Segment &segment, float dt, float &pos, float &vel, float &acc);
+
+	/** @return duration of a velocity change from start_vel to end_vel */
+	float velocity_change_time(float start_vel, float end_vel) const;
+
+	/** @return distance needed to accelerate from start_vel to cruise_vel and then decelerate to end_vel */
+	float distance_needed(float start_vel, float cruise_vel, float end_vel) const
+	{
+		return 0.5f * (start_vel + cruise_vel) * velocity_change_time(start_vel, cruise_vel)
+		       + 0.5f * (cruise_vel + end_vel) * velocity_change_time(cruise_vel, end_vel);
+	}
+
+	Segment _segments[MAX_SEGMENTS];
+	int _num_segments = 0;
+	float _duration = 0.0f;
+	float _end_pos = 0.0f;
+	float _cruise_vel = 0.0f;
+	float _end_vel = 0.0f;
+	float _max_acc = 0.0f;
+	float _max_jerk = 0.0f;
+};
+
+} // namespace pos_control
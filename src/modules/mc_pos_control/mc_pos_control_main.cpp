@@ -76,6 +76,8 @@
 #include <controllib/blocks.hpp>
 #include <controllib/block/BlockParam.hpp>
 
+#include "TrajectoryGenerator.h"
+
 #define SIGMA_SINGLE_OP			0.000001f
 #define SIGMA_NORM			0.001f
 /**
@@ -179,6 +181,7 @@ private:
 	control::BlockParamFloat _jerk_hor_max; /**< maximum jerk in manual controlled mode when braking to zero */
 	control::BlockParamFloat _jerk_hor_min; /**< minimum jerk in manual controlled mode when braking to zero */
 	control::BlockParamFloat _mis_yaw_error; /**< yaw error threshold that is used in mission as update criteria */
+	control::BlockParamFloat _jerk_auto; /**< jerk limit of the auto trajectory, 0 to disable it */
 	control::BlockDerivative _vel_x_deriv;
 	control::BlockDerivative _vel_y_deriv;
 	control::BlockDerivative _vel_z_deriv;
@@ -279,6 +282,8 @@ private:
 	math::Vector<3> _vel_prev;			/**< velocity on previous step */
 	math::Vector<3> _vel_sp_prev;
 	math::Vector<3> _vel_err_d;		/**< derivative of current velocity */
+	math::Vector<3> _vel_ff;		/**< velocity feed-forward added to the position controller output */
+	math::Vector<3> _acc_ff;		/**< acceleration feed-forward added to the thrust setpoint */
 	math::Vector<3> _curr_pos_sp;  /**< current setpoint of the triplets */
 	math::Vector<3> _prev_pos_sp; /**< previous setpoint of the triples */
 	matrix::Vector2f _stick_input_xy_prev; /**< for manual controlled mode to detect direction change */
@@ -295,6 +300,15 @@ private:
 	float _manual_jerk_limit_z; /**< jerk limit in manual mode in z */
 	float _takeoff_vel_limit; /**< velocity limit value which gets ramped up */
 
+	pos_control::TrajectoryGenerator _trajectory; /**< along-track profile from previous to current setpoint in auto */
+	bool _trajectory_active = false; /**< true if _trajectory is planned for the current line */
+	float _trajectory_time = 0.0f; /**< time along _trajectory */
+	float _trajectory_offset = 0.0f; /**< distance from the previous setpoint to the start of _trajectory */
+	float _trajectory_length = 0.0f; /**< distance from the previous to the current setpoint */
+	matrix::Vector2f _trajectory_origin; /**< previous setpoint the trajectory was planned from */
+	matrix::Vector2f _trajectory_unit; /**< unit vector from the previous to the current setpoint */
+	matrix::Vector2f _trajectory_vel; /**< velocity along the trajectory on the last evaluation */
+
 	// counters for reset events on position and velocity states
 	// they are used to identify a reset event
 	uint8_t _z_reset_counter;
@@ -362,6 +376,15 @@ private:
 
 	void vel_sp_slewrate(float dt);
 
+	/**
+	 * Follow the jerk-limited trajectory from the previous to the current setpoint in xy.
+	 * The trajectory is planned when the line changes, and evaluated on every call.
+	 * Sets the xy position setpoint as well as the velocity and acceleration feed-forward.
+	 * @param replan true if the triplet has been updated
+	 */
+	void follow_trajectory_xy(float dt, bool replan, bool next_setpoint_valid, const math::Vector<3> &next_sp,
+				  math::Vector<3> &pos_sp);
+
 	void update_velocity_derivative();
 
 	void do_control(float dt);
@@ -449,6 +472,7 @@ MulticopterPositionControl::MulticopterPositionControl() :
 	_jerk_hor_max(this, "JERK_MAX", true),
 	_jerk_hor_min(this, "JERK_MIN", true),
 	_mis_yaw_error(this, "MIS_YAW_ERR", false),
+	_jerk_auto(this, "JERK_AUTO", true),
 	_vel_x_deriv(this, "VELD"),
 	_vel_y_deriv(this, "VELD"),
 	_vel_z_deriv(this, "VELD"),
@@ -473,8 +497,9 @@ MulticopterPositionControl::MulticopterPositionControl() :
 	_xy_reset_counter(0),
 	_heading_reset_counter(0)
 {
-	/* Make the attitude quaternion valid */
+	/* Make the attitude quaternion and rotation matrix valid */
 	_att.q[0] = 1.0f;
+	_att.R[0] = _att.R[4] = _att.R[8] = 1.0f;
 
 	_ref_pos = {};
 
@@ -493,6 +518,8 @@ MulticopterPositionControl::MulticopterPositionControl() :
 	_vel_prev.zero();
 	_vel_sp_prev.zero();
 	_vel_err_d.zero();
+	_vel_ff.zero();
+	_acc_ff.zero();
 	_curr_pos_sp.zero();
 	_prev_pos_sp.zero();
 	_stick_input_xy_prev.zero();
@@ -586,7 +613,12 @@ MulticopterPositionControl::parameters_update(bool force)
 
 	if (updated || force) {
 		/* update C++ param system */
-		updateParams();
+		if (force) {
+			updateParams();
+
+		} else {
+			updateChangedParams();
+		}
 
 		/* update legacy C interface params */
 		param_get(_params_handles.thr_min, &_params.thr_min);
@@ -739,12 +771,9 @@ MulticopterPositionControl::poll_subscriptions()
 	if (updated) {
 		orb_copy(ORB_ID(vehicle_attitude), _vehicle_attitude_sub, &_att);
 
-		/* get current rotation matrix and euler angles from control state quaternions */
-		math::Quaternion q_att(_att.q[0], _att.q[1], _att.q[2], _att.q[3]);
-		_R = q_att.to_dcm();
-		math::Vector<3> euler_angles;
-		euler_angles = _R.to_euler();
-		_yaw = euler_angles(2);
+		/* current rotation matrix and yaw, precomputed by the estimator */
+		_R.set(_att.R);
+		_yaw = _att.yaw;
 
 		if (_control_mode.flag_control_manual_enabled) {
 			if (_heading_reset_counter != _att.quat_reset_counter) {
@@ -1728,6 +1757,8 @@ void MulticopterPositionControl::control_auto(float dt)
 			_triplet_lat_lon_finite = true;
 		}
 
+		_trajectory_active = false;
+
 		_reset_pos_sp = true;
 		_reset_alt_sp = true;
 	}
@@ -1752,9 +1783,9 @@ void MulticopterPositionControl::control_auto(float dt)
 		if (PX4_ISFINITE(_pos_sp_triplet.current.lat) &&
 		    PX4_ISFINITE(_pos_sp_triplet.current.lon)) {
 			/* project setpoint to local frame */
-			map_projection_project(&_ref_pos,
-					       _pos_sp_triplet.current.lat, _pos_sp_triplet.current.lon,
-					       &curr_pos_sp.data[0], &curr_pos_sp.data[1]);
+			map_projection_project_local(&_ref_pos,
+					             _pos_sp_triplet.current.lat, _pos_sp_triplet.current.lon,
+					             &curr_pos_sp.data[0], &curr_pos_sp.data[1]);
 
 			_triplet_lat_lon_finite = true;
 
@@ -1800,9 +1831,9 @@ void MulticopterPositionControl::control_auto(float dt)
 	}
 
 	if (_pos_sp_triplet.previous.valid) {
-		map_projection_project(&_ref_pos,
-				       _pos_sp_triplet.previous.lat, _pos_sp_triplet.previous.lon,
-				       &prev_sp.data[0], &prev_sp.data[1]);
+		map_projection_project_local(&_ref_pos,
+				             _pos_sp_triplet.previous.lat, _pos_sp_triplet.previous.lon,
+				             &prev_sp.data[0], &prev_sp.data[1]);
 		prev_sp(2) = -(_pos_sp_triplet.previous.alt - _ref_alt);
 
 		if (PX4_ISFINITE(prev_sp(0)) &&
@@ -1820,9 +1851,9 @@ void MulticopterPositionControl::control_auto(float dt)
 	}
 
 	if (_pos_sp_triplet.next.valid) {
-		map_projection_project(&_ref_pos,
-				       _pos_sp_triplet.next.lat, _pos_sp_triplet.next.lon,
-				       &next_sp.data[0], &next_sp.data[1]);
+		map_projection_project_local(&_ref_pos,
+				             _pos_sp_triplet.next.lat, _pos_sp_triplet.next.lon,
+				             &next_sp.data[0], &next_sp.data[1]);
 		next_sp(2) = -(_pos_sp_triplet.next.alt - _ref_alt);
 
 		if (PX4_ISFINITE(next_sp(0)) &&
@@ -1961,7 +1992,17 @@ void MulticopterPositionControl::control_auto(float dt)
 						   && ((pos_sp_diff.length()) < SIGMA_NORM);
 
 			/* only follow line if previous to current has a minimum distance */
-			if ((vec_prev_to_current.length()  > _nav_rad.get()) && !stay_at_current_pos) {
+			const bool follow_line = (vec_prev_to_current.length()  > _nav_rad.get()) && !stay_at_current_pos;
+			const bool follow_trajectory = follow_line && _jerk_auto.get() > 0.0f;
+
+			if (!follow_trajectory) {
+				_trajectory_active = false;
+			}
+
+			if (follow_trajectory) {
+				follow_trajectory_xy(dt, triplet_updated, next_setpoint_valid, next_sp, pos_sp);
+
+			} else if (follow_line) {
 
 				/* normalize prev-current line (always > nav_rad) */
 				matrix::Vector2f unit_prev_to_current = vec_prev_to_current.normalized();
@@ -2288,6 +2329,81 @@ void MulticopterPositionControl::control_auto(float dt)
 	}
 }
 
+void
+MulticopterPositionControl::follow_trajectory_xy(float dt, bool replan, bool next_setpoint_valid,
+		const math::Vector<3> &next_sp, math::Vector<3> &pos_sp)
+{
+	const matrix::Vector2f origin(_prev_pos_sp(0), _prev_pos_sp(1));
+	const matrix::Vector2f pos(_pos(0), _pos(1));
+	const matrix::Vector2f origin_diff(origin - _trajectory_origin);
+
+	/* plan once per line: the previous setpoint can also change without a triplet update (e.g. on reset) */
+	if (replan || !_trajectory_active || (origin_diff * origin_diff) > SIGMA_NORM * SIGMA_NORM) {
+		const matrix::Vector2f target(_curr_pos_sp(0), _curr_pos_sp(1));
+		const matrix::Vector2f vec_origin_to_target(target - origin);
+
+		/* the caller makes sure the line is longer than the acceptance radius */
+		_trajectory_length = vec_origin_to_target.length();
+		_trajectory_unit = vec_origin_to_target / _trajectory_length;
+		_trajectory_origin = origin;
+
+		/* start at the projection of the current position onto the line */
+		_trajectory_offset = math::constrain(matrix::Vector2f(pos - origin) * _trajectory_unit, 0.0f, _trajectory_length);
+
+		/* keep the velocity setpoint continuous when going from one line to the next */
+		const matrix::Vector2f vel_start = _trajectory_active ? _trajectory_vel : matrix::Vector2f(_vel(0), _vel(1));
+
+		/* pass the current setpoint with the same velocity as without the trajectory */
+		float end_vel = 0.0f;
+
+		if (next_setpoint_valid && !(_pos_sp_triplet.current.type == position_setpoint_s::SETPOINT_TYPE_LOITER)) {
+			matrix::Vector2f unit_current_to_next((next_sp(0) - target(0)), (next_sp(1) - target(1)));
+
+			if (unit_current_to_next.length() > SIGMA_NORM) {
+				end_vel = get_vel_close(_trajectory_unit, unit_current_to_next.normalized());
+			}
+		}
+
+		_trajectory_active = _trajectory.plan(_trajectory_length - _trajectory_offset, vel_start * _trajectory_unit,
+						      end_vel, get_cruising_speed_xy(), _acceleration_hor.get(), _jerk_auto.get());
+		_trajectory_time = 0.0f;
+	}
+
+	if (!_trajectory_active) {
+		/* invalid limits: just go to the target point */
+		_trajectory_vel.zero();
+		return;
+	}
+
+	float dist, vel, acc;
+	_trajectory.evaluate(_trajectory_time, dist, vel, acc);
+
+	/* the navigator switches to the next setpoint before the end is reached, don't run past it otherwise */
+	if (_trajectory_offset + dist >= _trajectory_length) {
+		dist = _trajectory_length - _trajectory_offset;
+		vel = 0.0f;
+		acc = 0.0f;
+	}
+
+	/* stop advancing along the trajectory if the vehicle falls behind by more than the position controller
+	 * can correct at cruise speed (e.g. in strong wind), so that the setpoint does not run away */
+	const float dist_behind = _trajectory_offset + dist - matrix::Vector2f(pos - _trajectory_origin) * _trajectory_unit;
+
+	if (dist_behind * _params.pos_p(0) < get_cruising_speed_xy()) {
+		_trajectory_time += dt;
+	}
+
+	/* the cross-track error is corrected by the position controller */
+	pos_sp(0) = _trajectory_origin(0) + _trajectory_unit(0) * (_trajectory_offset + dist);
+	pos_sp(1) = _trajectory_origin(1) + _trajectory_unit(1) * (_trajectory_offset + dist);
+
+	_trajectory_vel = _trajectory_unit * vel;
+	_vel_ff(0) = _trajectory_vel(0);
+	_vel_ff(1) = _trajectory_vel(1);
+	_acc_ff(0) = _trajectory_unit(0) * acc;
+	_acc_ff(1) = _trajectory_unit(1) * acc;
+}
+
 void
 MulticopterPositionControl::update_velocity_derivative()
 {
@@ -2342,6 +2458,10 @@ MulticopterPositionControl::do_control(float dt)
 	_run_pos_control = true;
 	_run_alt_control = true;
 
+	/* only set by the auto trajectory */
+	_vel_ff.zero();
+	_acc_ff.zero();
+
 	if (_control_mode.flag_control_manual_enabled) {
 		/* manual control */
 		control_manual(dt);
@@ -2387,8 +2507,8 @@ MulticopterPositionControl::calculate_velocity_setpoint(float dt)
 
 		// If for any reason, we get a NaN position setpoint, we better just stay where we are.
 		if (PX4_ISFINITE(_pos_sp(0)) && PX4_ISFINITE(_pos_sp(1))) {
-			_vel_sp(0) = (_pos_sp(0) - _pos(0)) * _params.pos_p(0);
-			_vel_sp(1) = (_pos_sp(1) - _pos(1)) * _params.pos_p(1);
+			_vel_sp(0) = (_pos_sp(0) - _pos(0)) * _params.pos_p(0) + _vel_ff(0);
+			_vel_sp(1) = (_pos_sp(1) - _pos(1)) * _params.pos_p(1) + _vel_ff(1);
 
 		} else {
 			_vel_sp(0) = 0.0f;
@@ -2523,7 +2643,8 @@ MulticopterPositionControl::calculate_thrust_setpoint(float dt)
 
 	} else {
 		thrust_sp = vel_err.emult(_params.vel_p) + _vel_err_d.emult(_params.vel_d)
-			    + _thrust_int - math::Vector<3>(0.0f, 0.0f, _params.thr_hover);
+			    + _thrust_int - math::Vector<3>(0.0f, 0.0f, _params.thr_hover)
+			    + _acc_ff * (_params.thr_hover / CONSTANTS_ONE_G);
 	}
 
 	if (!_control_mode.flag_control_velocity_enabled && !_control_mode.flag_control_acceleration_enabled) {
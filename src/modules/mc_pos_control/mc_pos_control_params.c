@@ -478,6 +478,24 @@ PARAM_DEFINE_FLOAT(MPC_ACC_DOWN_MAX, 10.0f);
  */
 PARAM_DEFINE_FLOAT(MPC_JERK_MAX, 0.0f);
 
+/**
+ * Jerk limit in auto mode
+ *
+ * If set to a value greater than 0, the horizontal motion from one waypoint to the next
+ * follows a jerk-limited trajectory. It is planned once per waypoint with MPC_XY_CRUISE,
+ * MPC_ACC_HOR and this jerk limit, and its velocity and acceleration are used as feed-forward
+ * by the position controller.
+ * Set to 0 to use the velocity ramps instead.
+ *
+ * @unit m/s/s/s
+ * @min 0.0
+ * @max 15.0
+ * @increment 1
+ * @decimal 2
+ * @group Multicopter Position Control
+ */
+PARAM_DEFINE_FLOAT(MPC_JERK_AUTO, 0.0f);
+
 /**
  * Minimum jerk in manual controlled mode for BRAKING to zero
  *
@@ -43,6 +43,8 @@
 #include <unit_test.h>
 #include <mathlib/mathlib.h>
 
+#include "../TrajectoryGenerator.h"
+
 extern "C" __EXPORT int mc_pos_control_tests_main(int argc, char *argv[]);
 
 bool mcPosControlTests();
@@ -65,6 +67,7 @@ public:
 
 private:
 	bool cross_sphere_line_test();
+	bool trajectory_generator_test();
 };
 
 McPosControlTests::McPosControlTests()
@@ -182,9 +185,65 @@ bool McPosControlTests::cross_sphere_line_test()
 	return true;
 }
 
+bool McPosControlTests::trajectory_generator_test()
+{
+	pos_control::TrajectoryGenerator trajectory;
+	float pos, vel, acc;
+
+	// invalid limits
+	ut_assert_false(trajectory.plan(10.0f, 0.0f, 0.0f, 5.0f, 0.0f, 4.0f));
+	ut_assert_false(trajectory.plan(10.0f, 0.0f, 0.0f, 5.0f, 2.0f, 0.0f));
+
+	// long line: reaches cruise speed, stops at the end
+	ut_assert_true(trajectory.plan(20.0f, 0.0f, 0.0f, 5.0f, 2.0f, 4.0f));
+	ut_compare_float("long cruise vel", trajectory.cruise_velocity(), 5.0f, 3);
+	ut_compare_float("long duration", trajectory.duration(), 7.0f, 3);
+
+	trajectory.evaluate(trajectory.duration() * 0.5f, pos, vel, acc);
+	ut_compare_float("long mid pos", pos, 10.0f, 3);
+	ut_compare_float("long mid vel", vel, 5.0f, 3);
+	ut_compare_float("long mid acc", acc, 0.0f, 3);
+
+	trajectory.evaluate(trajectory.duration(), pos, vel, acc);
+	ut_compare_float("long end pos", pos, 20.0f, 3);
+	ut_compare_float("long end vel", vel, 0.0f, 3);
+
+	// acceleration and jerk limits
+	float vel_prev = 0.0f;
+	float acc_prev = 0.0f;
+	const float dt = 0.01f;
+
+	for (float t = dt; t < trajectory.duration(); t += dt) {
+		trajectory.evaluate(t, pos, vel, acc);
+		ut_assert_true(fabsf(acc) <= 2.0f + 1e-3f);
+		ut_assert_true(fabsf(acc - acc_prev) <= 4.0f * dt + 1e-3f);
+		ut_assert_true(fabsf(vel - vel_prev) <= 2.0f * dt + 1e-3f);
+		vel_prev = vel;
+		acc_prev = acc;
+	}
+
+	// short line: cruise speed is not reached
+	ut_assert_true(trajectory.plan(3.0f, 0.0f, 0.0f, 5.0f, 2.0f, 4.0f));
+	ut_compare_float("short cruise vel", trajectory.cruise_velocity(), 2.0f, 3);
+	trajectory.evaluate(trajectory.duration(), pos, vel, acc);
+	ut_compare_float("short end pos", pos, 3.0f, 3);
+	ut_compare_float("short end vel", vel, 0.0f, 3);
+
+	// passing the end with a velocity, continues with it
+	ut_assert_true(trajectory.plan(20.0f, 3.0f, 1.0f, 5.0f, 2.0f, 4.0f));
+	trajectory.evaluate(trajectory.duration(), pos, vel, acc);
+	ut_compare_float("pass end pos", pos, 20.0f, 3);
+	ut_compare_float("pass end vel", vel, 1.0f, 3);
+	trajectory.evaluate(trajectory.duration() + 1.0f, pos, vel, acc);
+	ut_compare_float("pass after end pos", pos, 21.0f, 3);
+
+	return true;
+}
+
 bool McPosControlTests::run_tests()
 {
 	ut_run_test(cross_sphere_line_test);
+	ut_run_test(trajectory_generator_test);
 
 	return (_tests_failed == 0);
 }
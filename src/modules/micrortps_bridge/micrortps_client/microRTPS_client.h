@@ -57,14 +57,21 @@
 #define POLL_MS 1
 #define DEFAULT_RECV_PORT 2019
 #define DEFAULT_SEND_PORT 2020
+#define SHM_NAME "/px4_micrortps"
+#define SEND_POLL_TIMEOUT_MS 100
+#define MAX_TOPIC_INTERVALS 8
 
 void *send(void *data);
 void micrortps_start_topics(struct timespec &begin, int &total_read, uint32_t &received, int &loop);
 
+/** Update interval in ms of a sent topic: the per-topic interval if given, the global one otherwise */
+int topic_update_interval(const char *topic);
+
 struct options {
 	enum class eTransports {
 		UART,
-		UDP
+		UDP,
+		SHM
 	};
 	eTransports transport = options::eTransports::UART;
 	char device[64] = DEVICE;
@@ -75,6 +82,12 @@ struct options {
 	int poll_ms = POLL_MS;
 	uint16_t recv_port = DEFAULT_RECV_PORT;
 	uint16_t send_port = DEFAULT_SEND_PORT;
+	bool udp_batched = false;
+	struct topic_interval {
+		char topic[64];
+		int interval_ms;
+	} topic_intervals[MAX_TOPIC_INTERVALS] = {};
+	int num_topic_intervals = 0;
 };
 
 extern struct options _options;
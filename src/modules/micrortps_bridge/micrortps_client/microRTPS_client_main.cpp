@@ -58,38 +58,80 @@ static void usage(const char *name)
 	PRINT_MODULE_USAGE_NAME("micrortps_client", "communication");
 	PRINT_MODULE_USAGE_COMMAND("start");
 
-	PRINT_MODULE_USAGE_PARAM_STRING('t', "UART", "UART|UDP", "Transport protocol", true);
+	PRINT_MODULE_USAGE_PARAM_STRING('t', "UART", "UART|UDP|SHM", "Transport protocol (SHM: shared memory with a local agent)",
+					true);
 	PRINT_MODULE_USAGE_PARAM_STRING('d', "/dev/ttyACM0", "<file:dev>", "Select Serial Device", true);
 	PRINT_MODULE_USAGE_PARAM_INT('b', 460800, 9600, 3000000, "Baudrate", true);
-	PRINT_MODULE_USAGE_PARAM_INT('p', 1, 1, 1000, "Poll timeout for UART in ms", true);
+	PRINT_MODULE_USAGE_PARAM_INT('p', 1, 1, 1000, "Poll timeout for UART and SHM in ms", true);
 	PRINT_MODULE_USAGE_PARAM_INT('u', 0, 0, 10000,
 				     "Interval in ms to limit the update rate of all sent topics (0=unlimited)", true);
+	PRINT_MODULE_USAGE_PARAM_STRING('i', nullptr, "<topic>:<ms>",
+					"Interval to limit the update rate of a single sent topic, overrides -u (can be repeated)", true);
 	PRINT_MODULE_USAGE_PARAM_INT('l', 10000, -1, 100000, "Limit number of iterations until the program exits (-1=infinite)",
 				     true);
-	PRINT_MODULE_USAGE_PARAM_INT('w', 1, 1, 1000, "Time in ms for which each iteration sleeps", true);
+	PRINT_MODULE_USAGE_PARAM_INT('w', 1, 1, 1000, "Time in ms for which each receive iteration sleeps", true);
 	PRINT_MODULE_USAGE_PARAM_INT('r', 2019, 0, 65536, "Select UDP Network Port for receiving (local)", true);
 	PRINT_MODULE_USAGE_PARAM_INT('s', 2020, 0, 65536, "Select UDP Network Port for sending (remote)", true);
+	PRINT_MODULE_USAGE_PARAM_FLAG('f', "UDP: one CRC per datagram instead of per message (the agent needs -f as well)", true);
 
 	PRINT_MODULE_USAGE_COMMAND("stop");
 	PRINT_MODULE_USAGE_COMMAND("status");
 }
 
+int topic_update_interval(const char *topic)
+{
+	for (int i = 0; i < _options.num_topic_intervals; ++i) {
+		if (strcmp(_options.topic_intervals[i].topic, topic) == 0) {
+			return _options.topic_intervals[i].interval_ms;
+		}
+	}
+
+	return _options.update_time_ms;
+}
+
+static int parse_topic_interval(const char *arg)
+{
+	const char *separator = strchr(arg, ':');
+
+	if (separator == nullptr || separator == arg || (size_t)(separator - arg) >= sizeof(options::topic_interval::topic)) {
+		PX4_ERR("invalid topic interval %s", arg);
+		return -1;
+	}
+
+	if (_options.num_topic_intervals >= MAX_TOPIC_INTERVALS) {
+		PX4_ERR("too many topic intervals");
+		return -1;
+	}
+
+	options::topic_interval &interval = _options.topic_intervals[_options.num_topic_intervals++];
+	memcpy(interval.topic, arg, separator - arg);
+	interval.topic[separator - arg] = '\0';
+	interval.interval_ms = strtol(separator + 1, nullptr, 10);
+	return 0;
+}
+
 static int parse_options(int argc, char *argv[])
 {
 	int ch;
 	int myoptind = 1;
 	const char *myoptarg = nullptr;
 
-	while ((ch = px4_getopt(argc, argv, "t:d:u:l:w:b:p:r:s:", &myoptind, &myoptarg)) != EOF) {
+	_options.num_topic_intervals = 0;
+
+	while ((ch = px4_getopt(argc, argv, "t:d:u:i:l:w:b:p:r:s:f", &myoptind, &myoptarg)) != EOF) {
 		switch (ch) {
 		case 't': _options.transport      = strcmp(myoptarg, "UDP") == 0 ?
 							    options::eTransports::UDP
+							    : strcmp(myoptarg, "SHM") == 0 ?
+							    options::eTransports::SHM
 							    : options::eTransports::UART;      break;
 
 		case 'd': if (nullptr != myoptarg) strcpy(_options.device, myoptarg); break;
 
 		case 'u': _options.update_time_ms = strtol(myoptarg, nullptr, 10);    break;
 
+		case 'i': if (0 > parse_topic_interval(myoptarg)) return -1;         break;
+
 		case 'l': _options.loops          = strtol(myoptarg, nullptr, 10);    break;
 
 		case 'w': _options.sleep_ms       = strtol(myoptarg, nullptr, 10);    break;
@@ -102,6 +144,8 @@ static int parse_options(int argc, char *argv[])
 
 		case 's': _options.send_port      = strtoul(optarg, nullptr, 10);     break;
 
+		case 'f': _options.udp_batched    = true;                             break;
+
 		default:
 			usage(argv[1]);
 			return -1;
@@ -138,9 +182,16 @@ static int micrortps_start(int argc, char *argv[])
 		break;
 
 	case options::eTransports::UDP: {
-			transport_node = new UDP_node(_options.recv_port, _options.send_port);
-			printf("\nUDP transport: recv port: %u; send port: %u; sleep: %dms\n\n",
-			       _options.recv_port, _options.send_port, _options.sleep_ms);
+			transport_node = new UDP_node(_options.recv_port, _options.send_port, _options.udp_batched);
+			printf("\nUDP transport: recv port: %u; send port: %u; sleep: %dms%s\n\n",
+			       _options.recv_port, _options.send_port, _options.sleep_ms, _options.udp_batched ? "; batched" : "");
+		}
+		break;
+
+	case options::eTransports::SHM: {
+			transport_node = new Shmem_node(SHM_NAME, true, _options.poll_ms);
+			printf("\nShared memory transport: %s; sleep: %dms; poll: %dms\n\n",
+			       SHM_NAME, _options.sleep_ms, _options.poll_ms);
 		}
 		break;
 
@@ -100,11 +100,12 @@ int px4muorb_param_update_to_shmem(uint32_t param, const uint8_t *value,
 		return -1;
 	}
 
-	shmem_info_p->params_val[param] = *param_value;
+	shmem_param_write(shmem_info_p, param, *param_value);
 
 	byte_changed = param / 8;
 	bit_changed = 1 << param % 8;
-	shmem_info_p->krait_changed_index[byte_changed] |= bit_changed;
+	__sync_fetch_and_or(&shmem_info_p->krait_changed_index[byte_changed], bit_changed);
+	shmem_info_p->krait_generation++;
 
 	release_shmem_lock(__FILE__, __LINE__);
 
@@ -117,17 +118,11 @@ int px4muorb_param_update_index_from_shmem(unsigned char *data, int data_len_in_
 		return -1;
 	}
 
-	if (get_shmem_lock(__FILE__, __LINE__) != 0) {
-		PX4_INFO("Could not get shmem lock\n");
-		return -1;
-	}
-
+	/* the bits are set and cleared atomically, no need for the lock */
 	for (int i = 0; i < data_len_in_bytes; i++) {
 		data[i] = shmem_info_p->adsp_changed_index[i];
 	}
 
-	release_shmem_lock(__FILE__, __LINE__);
-
 	return 0;
 }
 
@@ -141,19 +136,12 @@ int px4muorb_param_update_value_from_shmem(uint32_t param, const uint8_t *value,
 		return -1;
 	}
 
-	if (get_shmem_lock(__FILE__, __LINE__) != 0) {
-		PX4_INFO("Could not get shmem lock\n");
-		return -1;
-	}
-
-	*param_value = shmem_info_p->params_val[param];
-
-	/*also clear the index since we are holding the lock*/
+	/*clear the index first, so that a concurrent change sets it again*/
 	byte_changed = param / 8;
 	bit_changed = 1 << param % 8;
-	shmem_info_p->adsp_changed_index[byte_changed] &= ~bit_changed;
+	__sync_fetch_and_and(&shmem_info_p->adsp_changed_index[byte_changed], ~bit_changed);
 
-	release_shmem_lock(__FILE__, __LINE__);
+	*param_value = shmem_param_read(shmem_info_p, param);
 
 	return 0;
 }
@@ -248,6 +236,53 @@ int px4muorb_send_topic_data(const char *name, const uint8_t *data,
 	return rc;
 }
 
+int px4muorb_send_bulk_data(const uint8_t *data, int data_len_in_bytes, int topic_count)
+{
+	uORB::FastRpcChannel *channel = uORB::FastRpcChannel::GetInstance();
+	uORBCommunicator::IChannelRxHandler *rxHandler = channel->GetRxHandler();
+
+	if (rxHandler == nullptr) {
+		return -1;
+	}
+
+	/* same packet layout as used by px4muorb_receive_bulk_data() */
+	struct BulkTransferHeader {
+		uint16_t _MsgType;
+		uint16_t _MsgNameLen;
+		uint16_t _DataLen;
+	};
+
+	int rc = 0;
+	int bytes_processed = 0;
+
+	for (int i = 0; i < topic_count; ++i) {
+		if (bytes_processed + (int)sizeof(struct BulkTransferHeader) > data_len_in_bytes) {
+			PX4_ERR("bulk data truncated (%i of %i topics)", i, topic_count);
+			return -1;
+		}
+
+		const uint8_t *packet = &data[bytes_processed];
+		const struct BulkTransferHeader *header = (const struct BulkTransferHeader *)packet;
+		const int packet_len = sizeof(struct BulkTransferHeader) + header->_MsgNameLen + header->_DataLen;
+
+		if (bytes_processed + packet_len > data_len_in_bytes || header->_MsgNameLen == 0) {
+			PX4_ERR("bulk data packing error (%i of %i topics)", i, topic_count);
+			return -1;
+		}
+
+		const char *name = (const char *)(packet + sizeof(struct BulkTransferHeader));
+		const uint8_t *topic_data = (const uint8_t *)(name + header->_MsgNameLen);
+
+		if (rxHandler->process_received_message(name, header->_DataLen, (uint8_t *)topic_data) != 0) {
+			rc = -1;
+		}
+
+		bytes_processed += packet_len;
+	}
+
+	return rc;
+}
+
 int px4muorb_is_subscriber_present(const char *topic_name, int *status)
 {
 	int rc = 0;
@@ -58,6 +58,8 @@ extern "C" {
 
 	int px4muorb_send_topic_data(const char *name, const uint8_t *data, int data_len_in_bytes) __EXPORT;
 
+	int px4muorb_send_bulk_data(const uint8_t *data, int data_len_in_bytes, int topic_count) __EXPORT;
+
 	int px4muorb_is_subscriber_present(const char *topic_name, int *status) __EXPORT;
 
 	int px4muorb_receive_msg(int *msg_type, char *topic_name, int topic_name_len, uint8_t *data, int data_len_in_bytes,
@@ -32,6 +32,7 @@
  ****************************************************************************/
 
 #include <string.h>
+#include <stdlib.h>
 #include "modules/uORB/uORBManager.hpp"
 #include "uORBKraitFastRpcChannel.hpp"
 
@@ -39,7 +40,7 @@ extern "C" { __EXPORT int muorb_main(int argc, char *argv[]); }
 
 static void usage()
 {
-	warnx("Usage: muorb 'start', 'stop', 'status'");
+	warnx("Usage: muorb 'start [-f <flush interval us>]', 'stop', 'status'");
 }
 
 
@@ -61,6 +62,10 @@ muorb_main(int argc, char *argv[])
 			PX4_WARN("muorb already running");
 
 		} else {
+			if (argc > 3 && !strcmp(argv[2], "-f")) {
+				uORB::KraitFastRpcChannel::GetInstance()->set_flush_interval(strtoul(argv[3], nullptr, 10));
+			}
+
 			// register the fast rpc channel with UORB.
 			uORB::Manager::get_instance()->set_uorb_communicator(uORB::KraitFastRpcChannel::GetInstance());
 
@@ -90,6 +95,7 @@ muorb_main(int argc, char *argv[])
 	if (!strcmp(argv[1], "status")) {
 		if (uORB::KraitFastRpcChannel::isInstance()) {
 			PX4_WARN("muorb running");
+			uORB::KraitFastRpcChannel::GetInstance()->print_status();
 
 		} else {
 			PX4_WARN("muorb not running");
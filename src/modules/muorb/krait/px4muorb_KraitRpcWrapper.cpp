@@ -65,6 +65,7 @@ static const uint32_t _MAX_TOPICS = 64;
 static const uint32_t _MAX_BULK_TRANSFER_BUFFER_SIZE =
 	_MAX_TOPIC_DATA_BUFFER_SIZE * _MAX_TOPICS;
 static uint8_t *_BulkTransferBuffer = 0;
+static uint8_t *_SendBulkTransferBuffer = 0;
 
 unsigned char *adsp_changed_index = 0;
 
@@ -178,6 +179,15 @@ bool px4muorb::KraitRpcWrapper::Initialize()
 			__FUNCTION__, (_MAX_BULK_TRANSFER_BUFFER_SIZE * sizeof(uint8_t)), _BulkTransferBuffer);
 	}
 
+	_SendBulkTransferBuffer = (uint8_t *) rpcmem_alloc(MUORB_KRAIT_FASTRPC_HEAP_ID,
+				  MUORB_KRAIT_FASTRPC_MEM_FLAGS,
+				  _MAX_BULK_TRANSFER_BUFFER_SIZE * sizeof(uint8_t));
+
+	if (_SendBulkTransferBuffer == NULL) {
+		/* not fatal, messages are sent one by one in that case */
+		PX4_ERR("%s rpcmem_alloc failed! for send bulk transfer buffer", __FUNCTION__);
+	}
+
 	_TopicNameBuffer = (char *) rpcmem_alloc(MUORB_KRAIT_FASTRPC_HEAP_ID,
 			   MUORB_KRAIT_FASTRPC_MEM_FLAGS,
 			   _MAX_TOPIC_NAME_BUFFER * sizeof(char));
@@ -263,6 +273,11 @@ bool px4muorb::KraitRpcWrapper::Terminate()
 		_BulkTransferBuffer = 0;
 	}
 
+	if (_SendBulkTransferBuffer != NULL) {
+		rpcmem_free(_SendBulkTransferBuffer);
+		_SendBulkTransferBuffer = 0;
+	}
+
 	if (_TopicNameBuffer != NULL) {
 		rpcmem_free(_TopicNameBuffer);
 		_TopicNameBuffer = 0;
@@ -315,6 +330,22 @@ int32_t px4muorb::KraitRpcWrapper::SendData(const char *topic,
 		px4muorb_send_topic_data(topic, data, length_in_bytes) : -1);
 }
 
+int32_t px4muorb::KraitRpcWrapper::SendBulkData(int32_t length_in_bytes, int32_t topic_count)
+{
+	return ((_Initialized && _SendBulkTransferBuffer) ?
+		px4muorb_send_bulk_data(_SendBulkTransferBuffer, length_in_bytes, topic_count) : -1);
+}
+
+uint8_t *px4muorb::KraitRpcWrapper::GetSendBulkBuffer()
+{
+	return _SendBulkTransferBuffer;
+}
+
+int32_t px4muorb::KraitRpcWrapper::GetSendBulkBufferSize()
+{
+	return _MAX_BULK_TRANSFER_BUFFER_SIZE;
+}
+
 int32_t px4muorb::KraitRpcWrapper::ReceiveData(int32_t *msg_type, char **topic,
 		int32_t *length_in_bytes, uint8_t **data)
 {
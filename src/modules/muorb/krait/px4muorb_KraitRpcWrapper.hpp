@@ -70,6 +70,14 @@ public:
 	int32_t AddSubscriber(const char *topic);
 	int32_t RemoveSubscriber(const char *topic);
 	int32_t SendData(const char *topic, int32_t length_in_bytes, const uint8_t *data);
+
+	/**
+	 * Send the data of multiple topics in one transfer. The data must be packed into the
+	 * buffer returned by GetSendBulkBuffer().
+	 */
+	int32_t SendBulkData(int32_t length_in_bytes, int32_t topic_count);
+	uint8_t *GetSendBulkBuffer();
+	static int32_t GetSendBulkBufferSize();
 	int32_t ReceiveData(int32_t *msg_type, char **topic, int32_t *length_in_bytes, uint8_t **data);
 	int32_t IsSubscriberPresent(const char *topic, int32_t *status);
 	int32_t ReceiveBulkData(uint8_t **bulk_data, int32_t *length_in_bytes, int32_t *topic_count);
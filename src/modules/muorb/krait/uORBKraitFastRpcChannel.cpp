@@ -36,7 +36,12 @@
 #include "px4_tasks.h"
 #include <drivers/drv_hrt.h>
 #include <cstdio>
+#include <cstring>
 #include <pthread.h>
+#include <unistd.h>
+#include "uORB/uORBManager.hpp"
+#include "uORB/uORBUtils.hpp"
+#include "uORB/uORBDevices.hpp"
 
 #define LOG_TAG "uORBKraitFastRpcChannel.cpp"
 
@@ -62,8 +67,16 @@ static hrt_abstime   _log_check_interval = 10000000;
 uORB::KraitFastRpcChannel::KraitFastRpcChannel() :
 	_RxHandler(nullptr),
 	_ThreadStarted(false),
-	_ThreadShouldExit(false)
+	_ThreadShouldExit(false),
+	_SendThreadStarted(false),
+	_FlushInterval(0),
+	_MsgCount(0),
+	_CoalescedCount(0),
+	_BulkTransferCount(0),
+	_BulkMsgCount(0),
+	_SendErrorCount(0)
 {
+	pthread_mutex_init(&_PendingMutex, nullptr);
 	_KraitWrapper.Initialize();
 }
 
@@ -109,14 +122,9 @@ int16_t uORB::KraitFastRpcChannel::register_handler(uORBCommunicator::IChannelRx
 	return 0;
 }
 
-int16_t uORB::KraitFastRpcChannel::send_message(const char *messageName, int32_t length, uint8_t *data)
+bool uORB::KraitFastRpcChannel::remote_subscriber_present(const char *messageName)
 {
-	int16_t rc = 0;
 	int32_t status = 0;
-	hrt_abstime t1, t4;
-	hrt_abstime t2 = 0;
-	hrt_abstime t3 = 0;
-	t1 = hrt_absolute_time();
 
 	if (_AdspSubscriberCache.find(std::string(messageName)) == _AdspSubscriberCache.end()) {
 		// check the status from adsp. as it is not cached.
@@ -134,11 +142,169 @@ int16_t uORB::KraitFastRpcChannel::send_message(const char *messageName, int32_t
 		}
 	}
 
-	if (_AdspSubscriberCache[messageName] > 0) {// there are remote subscribers
+	return _AdspSubscriberCache[messageName] > 0;
+}
+
+void uORB::KraitFastRpcChannel::queue_message(const char *messageName, int32_t length, uint8_t *data)
+{
+	pthread_mutex_lock(&_PendingMutex);
+
+	std::map<std::string, PendingTopic>::iterator it = _PendingTopics.find(messageName);
+
+	if (it == _PendingTopics.end()) {
+		PendingTopic topic;
+		topic._DataLen = length;
+		topic._Count = 0;
+		topic._QueueSize = 1;
+
+		/* queued topics keep all messages (up to the queue size) instead of only the latest */
+		char nodepath[orb_maxpath];
+
+		if (uORB::Utils::node_mkpath(nodepath, PUBSUB, messageName) == OK) {
+			uORB::DeviceMaster *master = uORB::Manager::get_instance()->get_device_master(PUBSUB);
+			uORB::DeviceNode *node = master ? master->getDeviceNode(nodepath) : nullptr;
+
+			if (node != nullptr && node->get_queue_size() > 1) {
+				topic._QueueSize = node->get_queue_size();
+			}
+		}
+
+		topic._Data.resize(topic._QueueSize * length);
+		it = _PendingTopics.insert(std::make_pair(std::string(messageName), topic)).first;
+	}
+
+	PendingTopic &topic = it->second;
+
+	if (topic._DataLen != length) {
+		/* should not happen: the size of a topic does not change */
+		PX4_ERR("topic %s: size changed from %d to %d", messageName, topic._DataLen, length);
+		topic._DataLen = length;
+		topic._Count = 0;
+		topic._Data.resize(topic._QueueSize * length);
+	}
+
+	if (topic._Count == topic._QueueSize) {
+		/* drop the oldest message */
+		if (topic._QueueSize > 1) {
+			memmove(&topic._Data[0], &topic._Data[length], (topic._QueueSize - 1) * length);
+		}
+
+		--topic._Count;
+		++_CoalescedCount;
+	}
+
+	memcpy(&topic._Data[topic._Count * length], data, length);
+	++topic._Count;
+
+	pthread_mutex_unlock(&_PendingMutex);
+}
+
+void uORB::KraitFastRpcChannel::flush()
+{
+	uint8_t *buffer = _KraitWrapper.GetSendBulkBuffer();
+	const int32_t buffer_size = px4muorb::KraitRpcWrapper::GetSendBulkBufferSize();
+	bool more_pending = true;
+
+	while (more_pending) {
+		int32_t bytes_packed = 0;
+		int32_t topic_count = 0;
+		more_pending = false;
+
+		/* topics that do not fit into an empty buffer are sent on their own */
+		std::vector<std::pair<std::string, PendingTopic> > oversize;
+
+		pthread_mutex_lock(&_PendingMutex);
+
+		for (std::map<std::string, PendingTopic>::iterator it = _PendingTopics.begin(); it != _PendingTopics.end(); ++it) {
+			PendingTopic &topic = it->second;
+
+			if (topic._Count == 0) {
+				continue;
+			}
+
+			const uint16_t name_len = it->first.length() + 1;
+			const int32_t packet_len = sizeof(struct BulkTransferHeader) + name_len + topic._DataLen;
+
+			if (packet_len * topic._Count > buffer_size) {
+				oversize.push_back(std::make_pair(it->first, topic));
+				topic._Count = 0;
+				continue;
+			}
+
+			if (bytes_packed + packet_len * topic._Count > buffer_size) {
+				/* send the topic with the next transfer */
+				more_pending = true;
+				continue;
+			}
+
+			for (int i = 0; i < topic._Count; ++i) {
+				struct BulkTransferHeader *header = (struct BulkTransferHeader *)&buffer[bytes_packed];
+				header->_MsgType = _DATA_MSG_TYPE;
+				header->_MsgNameLen = name_len;
+				header->_DataLen = topic._DataLen;
+				bytes_packed += sizeof(struct BulkTransferHeader);
+				memcpy(&buffer[bytes_packed], it->first.c_str(), name_len);
+				bytes_packed += name_len;
+				memcpy(&buffer[bytes_packed], &topic._Data[i * topic._DataLen], topic._DataLen);
+				bytes_packed += topic._DataLen;
+				++topic_count;
+			}
+
+			topic._Count = 0;
+		}
+
+		pthread_mutex_unlock(&_PendingMutex);
+
+		for (size_t i = 0; i < oversize.size(); ++i) {
+			PendingTopic &topic = oversize[i].second;
+
+			for (int j = 0; j < topic._Count; ++j) {
+				if (_KraitWrapper.SendData(oversize[i].first.c_str(), topic._DataLen, &topic._Data[j * topic._DataLen]) != 0) {
+					++_SendErrorCount;
+				}
+			}
+		}
+
+		if (topic_count == 0) {
+			continue;
+		}
+
+		if (_KraitWrapper.SendBulkData(bytes_packed, topic_count) != 0) {
+			++_SendErrorCount;
+		}
+
+		++_BulkTransferCount;
+		_BulkMsgCount += topic_count;
+	}
+}
+
+int16_t uORB::KraitFastRpcChannel::send_message(const char *messageName, int32_t length, uint8_t *data)
+{
+	int16_t rc = 0;
+	hrt_abstime t1, t4;
+	hrt_abstime t2 = 0;
+	hrt_abstime t3 = 0;
+	t1 = hrt_absolute_time();
+
+	const bool remote_subscriber = remote_subscriber_present(messageName);
+
+	if (remote_subscriber && _SendThreadStarted) {
+		++_MsgCount;
+		queue_message(messageName, length, data);
+		return 0;
+	}
+
+	if (remote_subscriber) {// there are remote subscribers
+		++_MsgCount;
 		t2 = hrt_absolute_time();
 		rc = _KraitWrapper.SendData(messageName, length, data);
 		t3 = hrt_absolute_time();
 		_snd_msg_count++;
+
+		if (rc != 0) {
+			++_SendErrorCount;
+		}
+
 		//PX4_DEBUG( "***** SENDING[%s] topic to remote....\n", messageName.c_str() );
 
 	} else {
@@ -152,7 +318,7 @@ int16_t uORB::KraitFastRpcChannel::send_message(const char *messageName, int32_t
 
 	if ((t4 - t1) > _overall_snd_max) { _overall_snd_max = (t4 - t1); }
 
-	if (_AdspSubscriberCache[messageName] > 0) {
+	if (remote_subscriber) {
 		if ((t3 - t2) < _snd_msg_min) { _snd_msg_min = (t3 - t2); }
 
 		if ((t3 - t2) > _snd_msg_max) { _snd_msg_max = (t3 - t2); }
@@ -205,6 +371,32 @@ void uORB::KraitFastRpcChannel::Start()
 	}
 
 	pthread_attr_destroy(&recv_thread_attr);
+
+	if (_FlushInterval > 0) {
+		if (_KraitWrapper.GetSendBulkBuffer() == nullptr) {
+			PX4_ERR("no bulk transfer buffer, sending messages directly");
+			return;
+		}
+
+		pthread_attr_t send_thread_attr;
+		pthread_attr_init(&send_thread_attr);
+
+		(void)pthread_attr_getschedparam(&send_thread_attr, &param);
+		param.sched_priority = SCHED_PRIORITY_MAX - 80;
+		(void)pthread_attr_setschedparam(&send_thread_attr, &param);
+
+		pthread_attr_setstacksize(&send_thread_attr, 4096);
+
+		if (pthread_create(&_SendThread, &send_thread_attr, send_thread_start, (void *)this) != 0) {
+			PX4_ERR("Error  creating the send thread for muorb");
+
+		} else {
+			pthread_setname_np(_SendThread, "muorb_krait_sender");
+			_SendThreadStarted = true;
+		}
+
+		pthread_attr_destroy(&send_thread_attr);
+	}
 }
 
 void uORB::KraitFastRpcChannel::Stop()
@@ -215,6 +407,30 @@ void uORB::KraitFastRpcChannel::Stop()
 	pthread_join(_RecvThread, NULL);
 	//PX4_DEBUG("*** After calling pthread_join...\n");
 	_ThreadStarted = false;
+
+	if (_SendThreadStarted) {
+		pthread_join(_SendThread, NULL);
+		/* messages published from now on are sent directly */
+		_SendThreadStarted = false;
+		flush();
+	}
+}
+
+void uORB::KraitFastRpcChannel::print_status()
+{
+	if (_SendThreadStarted) {
+		PX4_INFO("flush interval: %u us", _FlushInterval);
+
+	} else {
+		PX4_INFO("flush interval: disabled");
+	}
+
+	PX4_INFO("messages: %u, coalesced: %u, send errors: %u", _MsgCount, _CoalescedCount, _SendErrorCount);
+
+	if (_BulkTransferCount > 0) {
+		PX4_INFO("bulk transfers: %u, avg. messages per transfer: %.2f", _BulkTransferCount,
+			 (double)_BulkMsgCount / _BulkTransferCount);
+	}
 }
 
 void  *uORB::KraitFastRpcChannel::thread_start(void *handler)
@@ -226,6 +442,25 @@ void  *uORB::KraitFastRpcChannel::thread_start(void *handler)
 	return 0;
 }
 
+void  *uORB::KraitFastRpcChannel::send_thread_start(void *handler)
+{
+	if (handler != nullptr) {
+		((uORB::KraitFastRpcChannel *)handler)->fastrpc_send_thread();
+	}
+
+	return 0;
+}
+
+void uORB::KraitFastRpcChannel::fastrpc_send_thread()
+{
+	while (!_ThreadShouldExit) {
+		usleep(_FlushInterval);
+		flush();
+	}
+
+	PX4_DEBUG("[uORB::KraitFastRpcChannel::fastrpc_send_thread] Exiting fastrpc_send_thread\n");
+}
+
 void uORB::KraitFastRpcChannel::fastrpc_recv_thread()
 {
 	// sit in while loop.
@@ -40,6 +40,7 @@
 #include "uORB/uORBCommunicator.hpp"
 #include "px4muorb_KraitRpcWrapper.hpp"
 #include <map>
+#include <vector>
 #include "drivers/drv_hrt.h"
 
 namespace uORB
@@ -157,12 +158,30 @@ public:
 	void Start();
 	void Stop();
 
+	/**
+	 * Set the interval at which the pending topic data is sent to the ADSP in a
+	 * single transfer. Non-queued topics are coalesced (only the latest message is
+	 * sent), queued topics keep up to queue size messages.
+	 * Must be called before Start().
+	 * @param interval_us
+	 * 	flush interval in microseconds; 0 (default) sends every message directly.
+	 */
+	void set_flush_interval(uint32_t interval_us) { _FlushInterval = interval_us; }
+
+	/**
+	 * Print the send statistics.
+	 */
+	void print_status();
+
 private: // data members
 	static uORB::KraitFastRpcChannel *_InstancePtr;
 	uORBCommunicator::IChannelRxHandler *_RxHandler;
 	pthread_t   _RecvThread;
 	bool _ThreadStarted;
 	bool _ThreadShouldExit;
+	pthread_t   _SendThread;
+	bool _SendThreadStarted;
+	uint32_t _FlushInterval;
 
 	static const int32_t _CONTROL_MSG_TYPE_ADD_SUBSCRIBER = 1;
 	static const int32_t _CONTROL_MSG_TYPE_REMOVE_SUBSCRIBER = 2;
@@ -183,13 +202,46 @@ private: // data members
 	//hrt_abstime  _SubCacheSampleTimestamp;
 	static const hrt_abstime _SubCacheRefreshRate = 1000000; // 1 second;
 
+	struct PendingTopic {
+		std::vector<uint8_t> _Data; ///< up to _QueueSize messages, oldest first
+		int32_t _DataLen;
+		uint16_t _Count;
+		uint16_t _QueueSize;
+	};
+
+	std::map<std::string, PendingTopic> _PendingTopics;
+	pthread_mutex_t _PendingMutex;
+
+	uint32_t _MsgCount;         ///< messages passed to send_message() with remote subscribers
+	uint32_t _CoalescedCount;   ///< messages overwritten before being sent
+	uint32_t _BulkTransferCount;
+	uint32_t _BulkMsgCount;     ///< messages sent via bulk transfers
+	uint32_t _SendErrorCount;
+
 private://class members.
 	/// constructor.
 	KraitFastRpcChannel();
 
 	static void  *thread_start(void *handler);
+	static void  *send_thread_start(void *handler);
 
 	void fastrpc_recv_thread();
+	void fastrpc_send_thread();
+
+	/**
+	 * Check (with caching) if the ADSP has subscribers for a topic.
+	 */
+	bool remote_subscriber_present(const char *messageName);
+
+	/**
+	 * Store a message until the next flush.
+	 */
+	void queue_message(const char *messageName, int32_t length, uint8_t *data);
+
+	/**
+	 * Send all pending messages to the ADSP.
+	 */
+	void flush();
 
 };
 
@@ -76,7 +76,9 @@ FollowTarget::FollowTarget(Navigator *navigator, const char *name) :
 	_yaw_rate(0.0F),
 	_responsiveness(0.0F),
 	_yaw_auto_max(0.0F),
-	_yaw_angle(0.0F)
+	_yaw_angle(0.0F),
+	_perf_active(perf_alloc(PC_ELAPSED, "follow_target")),
+	_perf_target_updates(perf_alloc(PC_COUNT, "follow_target: target updates"))
 {
 	updateParams();
 	_current_target_motion = {};
@@ -91,6 +93,8 @@ FollowTarget::FollowTarget(Navigator *navigator, const char *name) :
 
 FollowTarget::~FollowTarget()
 {
+	perf_free(_perf_active);
+	perf_free(_perf_target_updates);
 }
 
 void FollowTarget::on_inactive()
@@ -121,7 +125,8 @@ void FollowTarget::on_activation()
 
 void FollowTarget::on_active()
 {
-	struct map_projection_reference_s target_ref;
+	perf_begin(_perf_active);
+
 	math::Vector<3> target_reported_velocity(0, 0, 0);
 	follow_target_s target_motion_with_offset = {};
 	uint64_t current_time = hrt_absolute_time();
@@ -156,6 +161,12 @@ void FollowTarget::on_active()
 		target_reported_velocity(0) = _current_target_motion.vx;
 		target_reported_velocity(1) = _current_target_motion.vy;
 
+		// the target frame only changes with the target, all projections below are done in it
+
+		if (_target_frame.set_reference(_current_target_motion.lat, _current_target_motion.lon)) {
+			perf_count(_perf_target_updates);
+		}
+
 	} else if (((current_time - _current_target_motion.timestamp) / 1000) > TARGET_TIMEOUT_MS && target_velocity_valid()) {
 		reset_target_validity();
 	}
@@ -166,9 +177,10 @@ void FollowTarget::on_active()
 
 		// get distance to target
 
-		map_projection_init(&target_ref, _navigator->get_global_position()->lat, _navigator->get_global_position()->lon);
-		map_projection_project(&target_ref, _current_target_motion.lat, _current_target_motion.lon, &_target_distance(0),
-				       &_target_distance(1));
+		float x, y;
+		_target_frame.project(_navigator->get_global_position()->lat, _navigator->get_global_position()->lon, x, y);
+		_target_distance(0) = -x;
+		_target_distance(1) = -y;
 
 	}
 
@@ -180,12 +192,11 @@ void FollowTarget::on_active()
 
 		// ignore a small dt
 		if (dt_ms > 10.0F) {
-			// get last gps known reference for target
-			map_projection_init(&target_ref, _previous_target_motion.lat, _previous_target_motion.lon);
-
-			// calculate distance the target has moved
-			map_projection_project(&target_ref, _current_target_motion.lat, _current_target_motion.lon,
-					       &(_target_position_delta(0)), &(_target_position_delta(1)));
+			// calculate distance the target has moved since the last known position
+			float x, y;
+			_target_frame.project(_previous_target_motion.lat, _previous_target_motion.lon, x, y);
+			_target_position_delta(0) = -x;
+			_target_position_delta(1) = -y;
 
 			// update the average velocity of the target based on the position
 			_est_target_vel = _target_position_delta / (dt_ms / 1000.0f);
@@ -224,10 +235,7 @@ void FollowTarget::on_active()
 				// this really needs to control the yaw rate directly in the attitude pid controller
 				// but seems to work ok for now since the yaw rate cannot be controlled directly in auto mode
 
-				_yaw_angle = get_bearing_to_next_waypoint(_navigator->get_global_position()->lat,
-						_navigator->get_global_position()->lon,
-						_current_target_motion.lat,
-						_current_target_motion.lon);
+				_yaw_angle = atan2f(_target_distance(1), _target_distance(0));
 
 				_yaw_rate = (_yaw_angle - _navigator->get_global_position()->yaw) / (dt_ms / 1000.0F);
 
@@ -257,9 +265,8 @@ void FollowTarget::on_active()
 
 		// get the target position using the calculated offset
 
-		map_projection_init(&target_ref,  _current_target_motion.lat, _current_target_motion.lon);
-		map_projection_reproject(&target_ref, _target_position_offset(0), _target_position_offset(1),
-					 &target_motion_with_offset.lat, &target_motion_with_offset.lon);
+		_target_frame.reproject(_target_position_offset(0), _target_position_offset(1),
+					target_motion_with_offset.lat, target_motion_with_offset.lon);
 	}
 
 	// clamp yaw rate smoothing if we are with in
@@ -349,6 +356,8 @@ void FollowTarget::on_active()
 			break;
 		}
 	}
+
+	perf_end(_perf_active);
 }
 
 void FollowTarget::update_position_sp(bool use_velocity, bool use_position, float yaw_rate)
@@ -385,6 +394,7 @@ void FollowTarget::reset_target_validity()
 	_est_target_vel.zero();
 	_target_distance.zero();
 	_target_position_offset.zero();
+	_target_frame.reset();
 	reset_mission_item_reached();
 	_follow_target_state = SET_WAIT_FOR_TARGET_POSITION;
 }
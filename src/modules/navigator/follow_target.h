@@ -44,8 +44,10 @@
 #include <controllib/block/BlockParam.hpp>
 #include <lib/mathlib/math/Vector.hpp>
 #include <lib/mathlib/math/Matrix.hpp>
+#include <systemlib/perf_counter.h>
 #include "navigator_mode.h"
 #include "mission_block.h"
+#include "geo_local_frame.h"
 #include <uORB/topics/follow_target.h>
 
 class FollowTarget : public MissionBlock
@@ -140,10 +142,13 @@ private:
 
 	follow_target_s _current_target_motion;
 	follow_target_s _previous_target_motion;
+	GeoLocalFrame _target_frame; ///< local frame around the filtered target position, updated with the target
 	float _yaw_rate;
 	float _responsiveness;
 	float _yaw_auto_max;
 	float _yaw_angle;
+	perf_counter_t _perf_active;
+	perf_counter_t _perf_target_updates;
 
 	// Mavlink defined motion reporting capabilities
 
@@ -0,0 +1,111 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2017 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+/**
+ * @file geo_local_frame.h
+ * Cheap conversions between global and local coordinates around a fixed reference point.
+ */
+
+#pragma once
+
+#include <math.h>
+
+/**
+ * @class GeoLocalFrame
+ * Local north/east frame around a reference point (equirectangular approximation).
+ * The scale factors are computed when the reference is set, so that converting a position is a double subtraction
+ * and a float multiplication, instead of the double precision trigonometry of lib/geo. Within a few km of the
+ * reference the error is well below the GPS accuracy.
+ */
+class GeoLocalFrame
+{
+public:
+	GeoLocalFrame() = default;
+	~GeoLocalFrame() = default;
+
+	/**
+	 * Set the reference point. The scale factors are only recomputed if the reference moved by at least 1e-7 deg.
+	 * @return true if the reference changed
+	 */
+	bool set_reference(double lat, double lon);
+
+	/** Invalidate the reference */
+	void reset() { _valid = false; }
+
+	bool valid() const { return _valid; }
+
+	double ref_lat() const { return _ref_lat; }
+	double ref_lon() const { return _ref_lon; }
+
+	/**
+	 * Position in the local frame
+	 * @param x north [m]
+	 * @param y east [m]
+	 */
+	void project(double lat, double lon, float &x, float &y) const
+	{
+		x = (float)(lat - _ref_lat) * _m_per_deg_lat;
+		y = (float)(lon - _ref_lon) * _m_per_deg_lon;
+	}
+
+	/**
+	 * Global position of a point in the local frame
+	 */
+	void reproject(float x, float y, double &lat, double &lon) const
+	{
+		lat = _ref_lat + (double)(x / _m_per_deg_lat);
+		lon = _ref_lon + (double)(y / _m_per_deg_lon);
+	}
+
+	/** @return horizontal distance between the reference and a position [m] */
+	float distance_to(double lat, double lon) const
+	{
+		float x, y;
+		project(lat, lon, x, y);
+		return sqrtf(x * x + y * y);
+	}
+
+	/** @return bearing from a position to the reference [rad] */
+	float bearing_from(double lat, double lon) const
+	{
+		float x, y;
+		project(lat, lon, x, y);
+		return atan2f(-y, -x);
+	}
+
+private:
+	double _ref_lat{0.0};
+	double _ref_lon{0.0};
+	float _m_per_deg_lat{1.0f};
+	float _m_per_deg_lon{1.0f};
+	bool _valid{false};
+};
@@ -46,6 +46,7 @@
 #include <dataman/dataman.h>
 #include <drivers/drv_hrt.h>
 #include <geo/geo.h>
+#include <mathlib/mathlib.h>
 #include <systemlib/mavlink_log.h>
 #include <v2.0/common/mavlink.h>
 
@@ -74,6 +75,8 @@ Geofence::~Geofence()
 	if (_polygons) {
 		delete[](_polygons);
 	}
+
+	freeIndex();
 }
 
 void Geofence::updateFence()
@@ -106,17 +109,35 @@ void Geofence::_updateFence()
 
 	// iterate over all polygons and store their starting vertices
 	_num_polygons = 0;
+	freeIndex();
 	int current_seq = 1;
 
-	while (current_seq <= num_fence_items) {
-		mission_fence_point_s mission_fence_point;
-		bool is_circle_area = false;
+	if (num_fence_items > DM_KEY_FENCE_POINTS_MAX - 1) {
+		num_fence_items = DM_KEY_FENCE_POINTS_MAX - 1;
+	}
 
-		if (dm_read(DM_KEY_FENCE_POINTS, current_seq, &mission_fence_point, sizeof(mission_fence_point_s)) !=
-		    sizeof(mission_fence_point_s)) {
-			PX4_ERR("dm_read failed");
-			break;
-		}
+	if (num_fence_items <= 0) {
+		return;
+	}
+
+	// load all fence items in one request
+	mission_fence_point_s *fence_points = new mission_fence_point_s[num_fence_items];
+
+	if (!fence_points) {
+		PX4_ERR("alloc failed");
+		return;
+	}
+
+	const int num_read = dm_read_range(DM_KEY_FENCE_POINTS, 1, num_fence_items, fence_points,
+					   sizeof(mission_fence_point_s));
+
+	if (num_read != num_fence_items) {
+		PX4_ERR("dm_read failed");
+	}
+
+	while (current_seq <= num_read) {
+		const mission_fence_point_s &mission_fence_point = fence_points[current_seq - 1];
+		bool is_circle_area = false;
 
 		switch (mission_fence_point.nav_cmd) {
 		case MAV_CMD_NAV_FENCE_RETURN_POINT:
@@ -154,12 +175,14 @@ void Geofence::_updateFence()
 				if (!_polygons) {
 					_num_polygons = 0;
 					PX4_ERR("alloc failed");
+					delete[](fence_points);
 					return;
 				}
 
 				PolygonInfo &polygon = _polygons[_num_polygons];
 				polygon.dataman_index = current_seq;
 				polygon.fence_type = mission_fence_point.nav_cmd;
+				polygon.valid = false;
 
 				if (is_circle_area) {
 					polygon.circle_radius = mission_fence_point.circle_radius;
@@ -183,6 +206,175 @@ void Geofence::_updateFence()
 
 	}
 
+	buildIndex(fence_points, num_read);
+
+	delete[](fence_points);
+}
+
+void Geofence::freeIndex()
+{
+	delete[](_vertices);
+	_vertices = nullptr;
+	delete[](_slab_edge_start);
+	_slab_edge_start = nullptr;
+	delete[](_slab_edges);
+	_slab_edges = nullptr;
+}
+
+void Geofence::buildIndex(const mission_fence_point_s *fence_points, int num_fence_points)
+{
+	if (_num_polygons == 0 || num_fence_points <= 0) {
+		return;
+	}
+
+	// the local frame is centered at the first fence point
+	map_projection_init(&_projection_reference, fence_points[0].lat, fence_points[0].lon);
+
+	// count the vertices and slabs
+	int num_vertices = 0;
+	int num_slabs = 0;
+
+	for (int polygon_idx = 0; polygon_idx < _num_polygons; ++polygon_idx) {
+		PolygonInfo &polygon = _polygons[polygon_idx];
+		const bool is_circle = polygon.fence_type == MAV_CMD_NAV_FENCE_CIRCLE_INCLUSION ||
+				       polygon.fence_type == MAV_CMD_NAV_FENCE_CIRCLE_EXCLUSION;
+		const int vertex_count = is_circle ? 1 : polygon.vertex_count;
+
+		polygon.valid = polygon.dataman_index + vertex_count - 1 <= num_fence_points;
+
+		for (int i = 0; i < vertex_count && polygon.valid; ++i) {
+			const uint8_t frame = fence_points[polygon.dataman_index - 1 + i].frame;
+
+			if (frame != MAV_FRAME_GLOBAL && frame != MAV_FRAME_GLOBAL_INT
+			    && frame != MAV_FRAME_GLOBAL_RELATIVE_ALT && frame != MAV_FRAME_GLOBAL_RELATIVE_ALT_INT) {
+				// TODO: handle different frames
+				PX4_ERR("Frame type %i not supported", (int)frame);
+				polygon.valid = false;
+			}
+		}
+
+		if (!polygon.valid) {
+			continue;
+		}
+
+		polygon.vertex_index = num_vertices;
+		num_vertices += vertex_count;
+
+		if (!is_circle) {
+			polygon.slab_index = num_slabs;
+			polygon.num_slabs = math::constrain(vertex_count / VERTICES_PER_SLAB, 1, MAX_SLABS_PER_POLYGON);
+			num_slabs += polygon.num_slabs;
+		}
+	}
+
+	_vertices = new Vertex[num_vertices];
+	_slab_edge_start = new uint16_t[num_slabs + 1];
+
+	if (!_vertices || !_slab_edge_start) {
+		PX4_ERR("alloc failed");
+		freeIndex();
+		_num_polygons = 0;
+		return;
+	}
+
+	// project the vertices and get the bounding boxes
+	for (int polygon_idx = 0; polygon_idx < _num_polygons; ++polygon_idx) {
+		PolygonInfo &polygon = _polygons[polygon_idx];
+
+		if (!polygon.valid) {
+			continue;
+		}
+
+		const bool is_circle = polygon.fence_type == MAV_CMD_NAV_FENCE_CIRCLE_INCLUSION ||
+				       polygon.fence_type == MAV_CMD_NAV_FENCE_CIRCLE_EXCLUSION;
+		const int vertex_count = is_circle ? 1 : polygon.vertex_count;
+
+		for (int i = 0; i < vertex_count; ++i) {
+			const mission_fence_point_s &point = fence_points[polygon.dataman_index - 1 + i];
+			Vertex &vertex = _vertices[polygon.vertex_index + i];
+			map_projection_project(&_projection_reference, point.lat, point.lon, &vertex.x, &vertex.y);
+
+			if (i == 0) {
+				polygon.min_x = polygon.max_x = vertex.x;
+				polygon.min_y = polygon.max_y = vertex.y;
+
+			} else {
+				polygon.min_x = math::min(polygon.min_x, vertex.x);
+				polygon.max_x = math::max(polygon.max_x, vertex.x);
+				polygon.min_y = math::min(polygon.min_y, vertex.y);
+				polygon.max_y = math::max(polygon.max_y, vertex.y);
+			}
+		}
+
+		if (is_circle) {
+			polygon.min_x -= polygon.circle_radius;
+			polygon.max_x += polygon.circle_radius;
+			polygon.min_y -= polygon.circle_radius;
+			polygon.max_y += polygon.circle_radius;
+
+		} else {
+			polygon.slab_width = (polygon.max_y - polygon.min_y) / polygon.num_slabs;
+		}
+	}
+
+	// assign the edges to the slabs: first count them, then fill them in
+	for (int pass = 0; pass < 2; ++pass) {
+		int num_slab_edges = 0;
+
+		for (int polygon_idx = 0; polygon_idx < _num_polygons; ++polygon_idx) {
+			const PolygonInfo &polygon = _polygons[polygon_idx];
+
+			if (!polygon.valid || polygon.fence_type == MAV_CMD_NAV_FENCE_CIRCLE_INCLUSION ||
+			    polygon.fence_type == MAV_CMD_NAV_FENCE_CIRCLE_EXCLUSION) {
+				continue;
+			}
+
+			const Vertex *vertices = &_vertices[polygon.vertex_index];
+
+			// overlap the slabs a bit, so that rounding cannot drop an edge at a slab boundary
+			const float margin = 0.01f * polygon.slab_width;
+
+			for (int slab = 0; slab < polygon.num_slabs; ++slab) {
+				const float slab_min = polygon.min_y + slab * polygon.slab_width - margin;
+				const float slab_max = polygon.min_y + (slab + 1) * polygon.slab_width + margin;
+
+				if (pass == 0) {
+					_slab_edge_start[polygon.slab_index + slab] = num_slab_edges;
+				}
+
+				for (unsigned i = 0, j = polygon.vertex_count - 1; i < polygon.vertex_count; j = i++) {
+					const float edge_min = math::min(vertices[i].y, vertices[j].y);
+					const float edge_max = math::max(vertices[i].y, vertices[j].y);
+
+					// edges along x never cross the ray (edge_max >= edge_min, so this is an exact equality test)
+					if (!(edge_max > edge_min)) {
+						continue;
+					}
+
+					// the first and last slab are open, so that points on the bounding box are covered
+					if ((edge_max >= slab_min || slab == 0) && (edge_min <= slab_max || slab == polygon.num_slabs - 1)) {
+						if (pass == 1) {
+							_slab_edges[num_slab_edges] = i;
+						}
+
+						++num_slab_edges;
+					}
+				}
+			}
+		}
+
+		if (pass == 0) {
+			_slab_edge_start[num_slabs] = num_slab_edges;
+			_slab_edges = new uint16_t[num_slab_edges > 0 ? num_slab_edges : 1];
+
+			if (!_slab_edges) {
+				PX4_ERR("alloc failed");
+				freeIndex();
+				_num_polygons = 0;
+				return;
+			}
+		}
+	}
 }
 
 bool Geofence::checkAll(const struct vehicle_global_position_s &global_position)
@@ -302,8 +494,10 @@ bool Geofence::checkPolygons(double lat, double lon, float altitude)
 		_updateFence();
 	}
 
+	// the fence is in RAM now
+	dm_unlock(DM_KEY_FENCE_POINTS);
+
 	if (isEmpty()) {
-		dm_unlock(DM_KEY_FENCE_POINTS);
 		/* Empty fence -> accept all points */
 		return true;
 	}
@@ -311,7 +505,6 @@ bool Geofence::checkPolygons(double lat, double lon, float altitude)
 	/* Vertical check */
 	if (_altitude_max > _altitude_min) { // only enable vertical check if configured properly
 		if (altitude > _altitude_max || altitude < _altitude_min) {
-			dm_unlock(DM_KEY_FENCE_POINTS);
 			return false;
 		}
 	}
@@ -322,9 +515,12 @@ bool Geofence::checkPolygons(double lat, double lon, float altitude)
 	bool inside_inclusion = false;
 	bool had_inclusion_areas = false;
 
+	float x, y;
+	map_projection_project(&_projection_reference, lat, lon, &x, &y);
+
 	for (int polygon_idx = 0; polygon_idx < _num_polygons; ++polygon_idx) {
 		if (_polygons[polygon_idx].fence_type == MAV_CMD_NAV_FENCE_CIRCLE_INCLUSION) {
-			bool inside = insideCircle(_polygons[polygon_idx], lat, lon, altitude);
+			bool inside = insideCircle(_polygons[polygon_idx], x, y);
 
 			if (inside) {
 				inside_inclusion = true;
@@ -333,14 +529,14 @@ bool Geofence::checkPolygons(double lat, double lon, float altitude)
 			had_inclusion_areas = true;
 
 		} else if (_polygons[polygon_idx].fence_type == MAV_CMD_NAV_FENCE_CIRCLE_EXCLUSION) {
-			bool inside = insideCircle(_polygons[polygon_idx], lat, lon, altitude);
+			bool inside = insideCircle(_polygons[polygon_idx], x, y);
 
 			if (inside) {
 				outside_exclusion = false;
 			}
 
 		} else { // it's a polygon
-			bool inside = insidePolygon(_polygons[polygon_idx], lat, lon, altitude);
+			bool inside = insidePolygon(_polygons[polygon_idx], x, y);
 
 			if (_polygons[polygon_idx].fence_type == MAV_CMD_NAV_FENCE_POLYGON_VERTEX_INCLUSION) {
 				if (inside) {
@@ -357,46 +553,35 @@ bool Geofence::checkPolygons(double lat, double lon, float altitude)
 		}
 	}
 
-	dm_unlock(DM_KEY_FENCE_POINTS);
-
 	return (!had_inclusion_areas || inside_inclusion) && outside_exclusion;
 }
 
-bool Geofence::insidePolygon(const PolygonInfo &polygon, double lat, double lon, float altitude)
+bool Geofence::insidePolygon(const PolygonInfo &polygon, float x, float y)
 {
+	if (!polygon.valid || x < polygon.min_x || x > polygon.max_x || y < polygon.min_y || y > polygon.max_y) {
+		return false;
+	}
 
 	/* Adaptation of algorithm originally presented as
 	 * PNPOLY - Point Inclusion in Polygon Test
 	 * W. Randolph Franklin (WRF)
 	 * Only supports non-complex polygons (not self intersecting)
+	 * Only the edges of the slab that contains the point are tested.
 	 */
 
-	mission_fence_point_s temp_vertex_i;
-	mission_fence_point_s temp_vertex_j;
-	bool c = false;
-
-	for (unsigned i = 0, j = polygon.vertex_count - 1; i < polygon.vertex_count; j = i++) {
-		if (dm_read(DM_KEY_FENCE_POINTS, polygon.dataman_index + i, &temp_vertex_i,
-			    sizeof(mission_fence_point_s)) != sizeof(mission_fence_point_s)) {
-			break;
-		}
+	int slab = polygon.slab_width > FLT_EPSILON ? (int)((y - polygon.min_y) / polygon.slab_width) : 0;
+	slab = math::constrain(slab, 0, polygon.num_slabs - 1);
 
-		if (dm_read(DM_KEY_FENCE_POINTS, polygon.dataman_index + j, &temp_vertex_j,
-			    sizeof(mission_fence_point_s)) != sizeof(mission_fence_point_s)) {
-			break;
-		}
+	const Vertex *vertices = &_vertices[polygon.vertex_index];
+	const uint16_t edges_end = _slab_edge_start[polygon.slab_index + slab + 1];
+	bool c = false;
 
-		if (temp_vertex_i.frame != MAV_FRAME_GLOBAL && temp_vertex_i.frame != MAV_FRAME_GLOBAL_INT
-		    && temp_vertex_i.frame != MAV_FRAME_GLOBAL_RELATIVE_ALT
-		    && temp_vertex_i.frame != MAV_FRAME_GLOBAL_RELATIVE_ALT_INT) {
-			// TODO: handle different frames
-			PX4_ERR("Frame type %i not supported", (int)temp_vertex_i.frame);
-			break;
-		}
+	for (uint16_t edge = _slab_edge_start[polygon.slab_index + slab]; edge < edges_end; ++edge) {
+		const unsigned i = _slab_edges[edge];
+		const unsigned j = i == 0 ? polygon.vertex_count - 1 : i - 1;
 
-		if (((double)temp_vertex_i.lon >= lon) != ((double)temp_vertex_j.lon >= lon) &&
-		    (lat <= (double)(temp_vertex_j.lat - temp_vertex_i.lat) * (lon - (double)temp_vertex_i.lon) /
-		     (double)(temp_vertex_j.lon - temp_vertex_i.lon) + (double)temp_vertex_i.lat)) {
+		if ((vertices[i].y >= y) != (vertices[j].y >= y) &&
+		    (x <= (vertices[j].x - vertices[i].x) * (y - vertices[i].y) / (vertices[j].y - vertices[i].y) + vertices[i].x)) {
 			c = !c;
 		}
 	}
@@ -404,34 +589,15 @@ bool Geofence::insidePolygon(const PolygonInfo &polygon, double lat, double lon,
 	return c;
 }
 
-bool Geofence::insideCircle(const PolygonInfo &polygon, double lat, double lon, float altitude)
+bool Geofence::insideCircle(const PolygonInfo &polygon, float x, float y)
 {
-
-	mission_fence_point_s circle_point;
-
-	if (dm_read(DM_KEY_FENCE_POINTS, polygon.dataman_index, &circle_point,
-		    sizeof(mission_fence_point_s)) != sizeof(mission_fence_point_s)) {
-		PX4_ERR("dm_read failed");
-		return false;
-	}
-
-	if (circle_point.frame != MAV_FRAME_GLOBAL && circle_point.frame != MAV_FRAME_GLOBAL_INT
-	    && circle_point.frame != MAV_FRAME_GLOBAL_RELATIVE_ALT
-	    && circle_point.frame != MAV_FRAME_GLOBAL_RELATIVE_ALT_INT) {
-		// TODO: handle different frames
-		PX4_ERR("Frame type %i not supported", (int)circle_point.frame);
+	if (!polygon.valid) {
 		return false;
 	}
 
-	if (!map_projection_initialized(&_projection_reference)) {
-		map_projection_init(&_projection_reference, lat, lon);
-	}
-
-	float x1, y1, x2, y2;
-	map_projection_project(&_projection_reference, lat, lon, &x1, &y1);
-	map_projection_project(&_projection_reference, circle_point.lat, circle_point.lon, &x2, &y2);
-	float dx = x1 - x2, dy = y1 - y2;
-	return dx * dx + dy * dy < circle_point.circle_radius * circle_point.circle_radius;
+	const Vertex &center = _vertices[polygon.vertex_index];
+	float dx = x - center.x, dy = y - center.y;
+	return dx * dx + dy * dy < polygon.circle_radius * polygon.circle_radius;
 }
 
 bool
@@ -48,6 +48,7 @@
 #include <controllib/blocks.hpp>
 #include <drivers/drv_hrt.h>
 #include <geo/geo.h>
+#include <navigator/navigation.h>
 #include <px4_defines.h>
 #include <uORB/topics/sensor_combined.h>
 #include <uORB/topics/vehicle_global_position.h>
@@ -153,10 +154,35 @@ private:
 			uint16_t vertex_count;
 			float circle_radius;
 		};
+		bool valid; ///< false if the area cannot be checked (unsupported frame or missing vertices)
+		uint16_t vertex_index; ///< index of the first vertex in _vertices (the center for circles)
+		uint16_t slab_index; ///< index of the first slab in _slab_edge_start (polygons only)
+		uint16_t num_slabs;
+		float slab_width; ///< [m]
+		float min_x, min_y, max_x, max_y; ///< bounding box [m]
 	};
 	PolygonInfo *_polygons{nullptr};
 	int _num_polygons{0};
 
+	/** fence vertex in the local frame of _projection_reference */
+	struct Vertex {
+		float x; ///< [m] north
+		float y; ///< [m] east
+	};
+
+	/*
+	 * The fence is kept in RAM in the local frame. For the crossing test only the edges that span the y coordinate
+	 * of the point matter, so the bounding box of each polygon is split into slabs along y, and each slab lists the
+	 * edges that overlap it. Edges are identified by the polygon vertex offset of their first vertex, the second one
+	 * is the previous vertex.
+	 */
+	Vertex *_vertices{nullptr};
+	uint16_t *_slab_edge_start{nullptr}; ///< edges of slab s: _slab_edges[_slab_edge_start[s]] ... [_slab_edge_start[s + 1] - 1]
+	uint16_t *_slab_edges{nullptr};
+
+	static constexpr int VERTICES_PER_SLAB = 4;
+	static constexpr int MAX_SLABS_PER_POLYGON = 16;
+
 	map_projection_reference_s _projection_reference = {}; ///< reference to convert (lon, lat) to local [m]
 
 	/* Params */
@@ -175,6 +201,16 @@ private:
 	 */
 	void _updateFence();
 
+	/**
+	 * project the vertices of all polygons & circles to the local frame, and build the bounding boxes and slabs
+	 * @param fence_points all fence items, starting at dataman index 1
+	 * @param num_fence_points number of valid items in fence_points
+	 */
+	void buildIndex(const mission_fence_point_s *fence_points, int num_fence_points);
+
+	/** free the data allocated by buildIndex() */
+	void freeIndex();
+
 	/**
 	 * Check if a point passes the Geofence test.
 	 * This takes all polygons and minimum & maximum altitude into account
@@ -200,16 +236,18 @@ private:
 
 	/**
 	 * Check if a single point is within a polygon
+	 * @param x, y point in the local frame [m]
 	 * @return true if within polygon
 	 */
-	bool insidePolygon(const PolygonInfo &polygon, double lat, double lon, float altitude);
+	bool insidePolygon(const PolygonInfo &polygon, float x, float y);
 
 	/**
 	 * Check if a single point is within a circle
 	 * @param polygon must be a circle!
+	 * @param x, y point in the local frame [m]
 	 * @return true if within polygon the circle
 	 */
-	bool insideCircle(const PolygonInfo &polygon, double lat, double lon, float altitude);
+	bool insideCircle(const PolygonInfo &polygon, float x, float y);
 };
 
 #endif /* GEOFENCE_H_ */
@@ -60,6 +60,9 @@ public:
 
 	virtual void on_active();
 
+	/* only reacts to reposition commands and disarming */
+	uint32_t active_dependencies() const override { return TOPIC_VEHICLE_COMMAND | TOPIC_VEHICLE_STATUS; }
+
 	enum mission_yaw_mode {
 		MISSION_YAWMODE_NONE = 0,
 		MISSION_YAWMODE_FRONT_TO_WAYPOINT = 1,
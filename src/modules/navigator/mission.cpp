@@ -80,6 +80,8 @@ Mission::on_inactive()
 	 * is used for missions such as RTL. */
 	_navigator->set_cruising_speed();
 
+	update_mission_check();
+
 	/* Without home a mission can't be valid yet anyway, let's wait. */
 	if (!_navigator->home_position_valid()) {
 		return;
@@ -170,6 +172,8 @@ Mission::on_activation()
 void
 Mission::on_active()
 {
+	bool mission_installed = update_mission_check();
+
 	check_mission_valid(false);
 
 	/* check if anything has changed */
@@ -184,19 +188,18 @@ Mission::on_active()
 	orb_check(_navigator->get_offboard_mission_sub(), &offboard_updated);
 
 	if (offboard_updated) {
-		update_offboard_mission();
+		mission_installed = update_offboard_mission() || mission_installed;
 	}
 
 	/* reset the current offboard mission if needed */
 	if (need_to_reset_mission(true)) {
 		reset_offboard_mission(_offboard_mission);
-		update_offboard_mission();
+		mission_installed = update_offboard_mission() || mission_installed;
 		_navigator->reset_cruising_speed();
-		offboard_updated = true;
 	}
 
 	/* reset mission items if needed */
-	if (onboard_updated || offboard_updated) {
+	if (onboard_updated || mission_installed) {
 		set_mission_items();
 	}
 
@@ -304,6 +307,8 @@ Mission::update_onboard_mission()
 	/* reset triplets */
 	_navigator->reset_triplets();
 
+	_item_prefetch.invalidate();
+
 	if (orb_copy(ORB_ID(onboard_mission), _navigator->get_onboard_mission_sub(), &_onboard_mission) == OK) {
 		/* accept the current index set by the onboard mission if it is within bounds */
 		if (_onboard_mission.current_seq >= 0
@@ -346,18 +351,66 @@ Mission::update_onboard_mission()
 	}
 }
 
-void
+bool
 Mission::update_offboard_mission()
 {
-	bool failed = true;
+	if (orb_copy(ORB_ID(offboard_mission), _navigator->get_offboard_mission_sub(), &_pending_offboard_mission) == OK) {
+		// The following is not really a warning, but it can be useful to have this message in the log file
+		PX4_WARN("offboard mission updated: dataman_id=%d, count=%d, current_seq=%d", _pending_offboard_mission.dataman_id,
+			 _pending_offboard_mission.count, _pending_offboard_mission.current_seq);
+
+		/* the current mission stays in use until the new one is checked */
+		_offboard_mission_pending = true;
+		check_mission_valid(true);
+
+		/* short missions are checked right away */
+		return update_mission_check();
+
+	} else {
+		PX4_ERR("offboard mission update failed, handle: %d", _navigator->get_offboard_mission_sub());
+	}
+
+	/* drop any mission which is still being checked */
+	_pending_offboard_mission = _offboard_mission;
+	_offboard_mission_pending = false;
+	install_offboard_mission(false);
+
+	return true;
+}
+
+bool
+Mission::update_mission_check()
+{
+	if (!_missionFeasibilityChecker.update()) {
+		return false;
+	}
+
+	const mission_s &mission = _offboard_mission_pending ? _pending_offboard_mission : _offboard_mission;
+
+	_navigator->get_mission_result()->valid = _missionFeasibilityChecker.feasible();
+	_navigator->get_mission_result()->seq_total = mission.count;
+	_navigator->increment_mission_instance_count();
+	_navigator->set_mission_result_updated();
+
+	if (_offboard_mission_pending) {
+		_offboard_mission_pending = false;
+		install_offboard_mission(_missionFeasibilityChecker.feasible());
+		return true;
+	}
+
+	return false;
+}
+
+void
+Mission::install_offboard_mission(bool valid)
+{
+	_item_prefetch.invalidate();
 
 	/* reset triplets */
 	_navigator->reset_triplets();
 
-	if (orb_copy(ORB_ID(offboard_mission), _navigator->get_offboard_mission_sub(), &_offboard_mission) == OK) {
-		// The following is not really a warning, but it can be useful to have this message in the log file
-		PX4_WARN("offboard mission updated: dataman_id=%d, count=%d, current_seq=%d", _offboard_mission.dataman_id,
-			 _offboard_mission.count, _offboard_mission.current_seq);
+	if (valid) {
+		_offboard_mission = _pending_offboard_mission;
 
 		/* determine current index */
 		if (_offboard_mission.current_seq >= 0 && _offboard_mission.current_seq < (int)_offboard_mission.count) {
@@ -376,28 +429,19 @@ Mission::update_offboard_mission()
 			/* otherwise, just leave it */
 		}
 
-		check_mission_valid(true);
-
-		failed = !_navigator->get_mission_result()->valid;
-
-		if (!failed) {
-			/* reset mission failure if we have an updated valid mission */
-			_navigator->get_mission_result()->failure = false;
+		/* reset mission failure if we have an updated valid mission */
+		_navigator->get_mission_result()->failure = false;
 
-			/* reset reached info as well */
-			_navigator->get_mission_result()->reached = false;
-			_navigator->get_mission_result()->seq_reached = 0;
-			_navigator->get_mission_result()->seq_total = _offboard_mission.count;
+		/* reset reached info as well */
+		_navigator->get_mission_result()->reached = false;
+		_navigator->get_mission_result()->seq_reached = 0;
+		_navigator->get_mission_result()->seq_total = _offboard_mission.count;
 
-			/* reset work item if new mission has been accepted */
-			_work_item_type = WORK_ITEM_TYPE_DEFAULT;
-		}
+		/* reset work item if new mission has been accepted */
+		_work_item_type = WORK_ITEM_TYPE_DEFAULT;
 
 	} else {
-		PX4_ERR("offboard mission update failed, handle: %d", _navigator->get_offboard_mission_sub());
-	}
-
-	if (failed) {
+		_offboard_mission = _pending_offboard_mission;
 		_offboard_mission.count = 0;
 		_offboard_mission.current_seq = 0;
 		_current_offboard_mission_index = 0;
@@ -405,6 +449,9 @@ Mission::update_offboard_mission()
 		PX4_ERR("mission check failed");
 	}
 
+	/* the previous storage can be written by the next upload from now on */
+	_navigator->get_mission_result()->dataman_id = _offboard_mission.dataman_id;
+
 	set_current_offboard_mission_item();
 }
 
@@ -1289,7 +1336,7 @@ Mission::read_mission_item(bool onboard, int offset, struct mission_item_s *miss
 		struct mission_item_s mission_item_tmp;
 
 		/* read mission item from datamanager */
-		if (dm_read(dm_item, *mission_index_ptr, &mission_item_tmp, len) != len) {
+		if (!_item_prefetch.read(dm_item, mission->count, *mission_index_ptr, &mission_item_tmp)) {
 			/* not supposed to happen unless the datamanager can't access the SD card, etc. */
 			mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Waypoint could not be read.");
 			return false;
@@ -1315,6 +1362,8 @@ Mission::read_mission_item(bool onboard, int offset, struct mission_item_s *miss
 						return false;
 					}
 
+					_item_prefetch.update(dm_item, *mission_index_ptr, mission_item_tmp);
+
 					report_do_jump_mission_changed(*mission_index_ptr, mission_item_tmp.do_jump_repeat_count);
 				}
 
@@ -1435,15 +1484,12 @@ Mission::check_mission_valid(bool force)
 {
 	if ((!_home_inited && _navigator->home_position_valid()) || force) {
 
-		_navigator->get_mission_result()->valid =
-			_missionFeasibilityChecker.checkMissionFeasible(_offboard_mission,
-					_param_dist_1wp.get(),
-					_param_dist_between_wps.get(),
-					false);
+		/* (re)start the check, update_mission_check() publishes the result once it is done */
+		_missionFeasibilityChecker.start(_offboard_mission_pending ? _pending_offboard_mission : _offboard_mission,
+						 _param_dist_1wp.get(),
+						 _param_dist_between_wps.get(),
+						 false);
 
-		_navigator->get_mission_result()->seq_total = _offboard_mission.count;
-		_navigator->increment_mission_instance_count();
-		_navigator->set_mission_result_updated();
 		_home_inited = _navigator->home_position_valid();
 	}
 }
@@ -1451,6 +1497,9 @@ Mission::check_mission_valid(bool force)
 void
 Mission::reset_offboard_mission(struct mission_s &mission)
 {
+	/* the jump counters are reset below */
+	_item_prefetch.invalidate();
+
 	dm_lock(DM_KEY_MISSION_STATE);
 
 	if (dm_read(DM_KEY_MISSION_STATE, 0, &mission, sizeof(mission_s)) == sizeof(mission_s)) {
@@ -47,6 +47,7 @@
 
 #include "mission_block.h"
 #include "mission_feasibility_checker.h"
+#include "mission_item_prefetch.h"
 #include "navigator_mode.h"
 
 #include <cfloat>
@@ -103,8 +104,9 @@ private:
 
 	/**
 	 * Update offboard mission topic
+	 * @return true if the current offboard mission has changed
 	 */
-	void update_offboard_mission();
+	bool update_offboard_mission();
 
 	/**
 	 * Move on to next mission item or switch to loiter
@@ -220,6 +222,18 @@ private:
 	 */
 	void check_mission_valid(bool force);
 
+	/**
+	 * Continue the running mission feasibility check, and publish the result once it is finished.
+	 * A new offboard mission is only used once it has been checked.
+	 * @return true if a new offboard mission has been installed
+	 */
+	bool update_mission_check();
+
+	/**
+	 * Make the checked offboard mission the current one
+	 */
+	void install_offboard_mission(bool valid);
+
 
 	/**
 	 * Reset offboard mission
@@ -246,6 +260,8 @@ private:
 
 	struct mission_s _onboard_mission {};
 	struct mission_s _offboard_mission {};
+	struct mission_s _pending_offboard_mission {};		/**< updated offboard mission, used once it has been checked */
+	bool _offboard_mission_pending{false};
 
 	int _current_onboard_mission_index{-1};
 	int _current_offboard_mission_index{-1};
@@ -263,6 +279,8 @@ private:
 
 	MissionFeasibilityChecker _missionFeasibilityChecker; /**< class that checks if a mission is feasible */
 
+	MissionItemPrefetch _item_prefetch; /**< upcoming mission items */
+
 	float _min_current_sp_distance_xy{FLT_MAX}; /**< minimum distance which was achieved to the current waypoint  */
 
 	float _distance_current_previous{0.0f}; /**< distance from previous to current sp in pos_sp_triplet,
@@ -50,197 +50,172 @@
 #include <mathlib/mathlib.h>
 #include <systemlib/mavlink_log.h>
 
-bool
-MissionFeasibilityChecker::checkMissionFeasible(const mission_s &mission,
-		float max_distance_to_1st_waypoint, float max_distance_between_waypoints,
-		bool land_start_req)
-{
-	dm_item_t dm_current = DM_KEY_WAYPOINTS_OFFBOARD(mission.dataman_id);
-	const size_t nMissionItems = mission.count;
-
-	const bool isRotarywing = (_navigator->get_vstatus()->is_rotary_wing || _navigator->get_vstatus()->is_vtol);
-
-	Geofence &geofence = _navigator->get_geofence();
-	fw_pos_ctrl_status_s *fw_pos_ctrl_status = _navigator->get_fw_pos_ctrl_status();
-	const float home_alt = _navigator->get_home_position()->alt;
-	const bool home_valid = _navigator->home_position_valid();
 
-	bool &warning_issued = _navigator->get_mission_result()->warning;
-	const float default_acceptance_rad  = _navigator->get_default_acceptance_radius();
-	const float default_altitude_acceptance_rad  = _navigator->get_altitude_acceptance_radius();
-	const bool landed = _navigator->get_land_detected()->landed;
-
-	bool failed = false;
-	bool warned = false;
+void
+MissionFeasibilityChecker::start(const mission_s &mission,
+				 float max_distance_to_1st_waypoint, float max_distance_between_waypoints,
+				 bool land_start_req)
+{
+	_dm_current = DM_KEY_WAYPOINTS_OFFBOARD(mission.dataman_id);
+	_num_items = mission.count;
+	_max_distance_to_1st_waypoint = max_distance_to_1st_waypoint;
+	_max_distance_between_waypoints = max_distance_between_waypoints;
+	_land_start_req = land_start_req;
+
+	_is_rotary_wing = (_navigator->get_vstatus()->is_rotary_wing || _navigator->get_vstatus()->is_vtol);
+	_landed = _navigator->get_land_detected()->landed;
+	_home_alt = _navigator->get_home_position()->alt;
+	_check_geofence = _navigator->get_geofence().valid();
+
+	/* rotary wings use the altitude acceptance radius for the takeoff check */
+	_takeoff_acceptance_rad = _is_rotary_wing ? _navigator->get_altitude_acceptance_radius() :
+				  _navigator->get_default_acceptance_radius();
+
+	_next_index = 0;
+	_first_waypoint_checked = false;
+	_home_altitude_warned = false;
+	_has_last_position = false;
+	_land_start_found = false;
+	_landing_valid = false;
+	_do_land_start_index = 0;
+	_landing_approach_index = 0;
+
+	_feasible = false;
+	_in_progress = true;
 
 	// first check if we have a valid position
-	if (!home_valid) {
-		failed = true;
-		warned = true;
-		mavlink_log_info(_navigator->get_mavlink_log_pub(), "Not yet ready for mission, no position lock.");
+	_home_valid = _navigator->home_position_valid();
 
-	} else {
-		failed = failed ||
-			 !checkDistanceToFirstWaypoint(dm_current, nMissionItems, max_distance_to_1st_waypoint, warning_issued);
+	if (!_home_valid) {
+		mavlink_log_info(_navigator->get_mavlink_log_pub(), "Not yet ready for mission, no position lock.");
 	}
+}
 
-	// check if all mission item commands are supported
-	failed = failed || !checkMissionItemValidity(dm_current, nMissionItems, landed);
-	failed = failed
-		 || !checkDistancesBetweenWaypoints(dm_current, nMissionItems, max_distance_between_waypoints, warning_issued);
-	failed = failed || !checkGeofence(dm_current, nMissionItems, geofence, home_alt, home_valid);
-	failed = failed || !checkHomePositionAltitude(dm_current, nMissionItems, home_alt, home_valid, warned);
-
-	if (isRotarywing) {
-		failed = failed
-			 || !checkRotarywing(dm_current, nMissionItems, home_alt, home_valid, default_altitude_acceptance_rad);
+bool
+MissionFeasibilityChecker::update()
+{
+	if (!_in_progress) {
+		return false;
+	}
 
-	} else {
-		failed = failed
-			 || !checkFixedwing(dm_current, nMissionItems, fw_pos_ctrl_status, home_alt, home_valid,
-					    default_acceptance_rad, land_start_req);
+	if (!_home_valid) {
+		_in_progress = false;
+		return true;
 	}
 
-	return !failed;
-}
+	size_t checked = 0;
 
-bool
-MissionFeasibilityChecker::checkRotarywing(dm_item_t dm_current, size_t nMissionItems,
-		float home_alt, bool home_valid, float default_altitude_acceptance_rad)
-{
-	for (size_t i = 0; i < nMissionItems; i++) {
-		struct mission_item_s missionitem = {};
-		const ssize_t len = sizeof(struct mission_item_s);
+	while (_next_index < _num_items && checked < MAX_ITEMS_PER_UPDATE) {
+		const unsigned count = math::min((size_t)ITEM_BATCH_SIZE, _num_items - _next_index);
 
-		if (dm_read(dm_current, i, &missionitem, len) != len) {
+		if (dm_read_range(_dm_current, _next_index, count, _items, sizeof(mission_item_s)) != (ssize_t)count) {
 			/* not supposed to happen unless the datamanager can't access the SD card, etc. */
-			return false;
+			mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: Cannot access SD card");
+			_in_progress = false;
+			return true;
 		}
 
-		// look for a takeoff waypoint
-		if (missionitem.nav_cmd == NAV_CMD_TAKEOFF) {
-			// make sure that the altitude of the waypoint is at least one meter larger than the altitude acceptance radius
-			// this makes sure that the takeoff waypoint is not reached before we are at least one meter in the air
-			float takeoff_alt = missionitem.altitude_is_relative ? missionitem.altitude : missionitem.altitude - home_alt;
-
-			// check if we should use default acceptance radius
-			float acceptance_radius = default_altitude_acceptance_rad;
-
-			// if a specific acceptance radius has been defined, use that one instead
-			if (missionitem.acceptance_radius > NAV_EPSILON_POSITION) {
-				acceptance_radius = missionitem.acceptance_radius;
+		for (unsigned i = 0; i < count; i++) {
+			if (!checkItem(_items[i], _next_index)) {
+				_in_progress = false;
+				return true;
 			}
 
-			if (takeoff_alt - 1.0f < acceptance_radius) {
-				mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: Takeoff altitude too low!");
-				return false;
-			}
+			_previous_item = _items[i];
+			_next_index++;
 		}
+
+		checked += count;
 	}
 
-	// all checks have passed
+	if (_next_index < _num_items) {
+		/* continue with the next call */
+		return false;
+	}
+
+	_feasible = checkMissionEnd();
+	_in_progress = false;
 	return true;
 }
 
 bool
-MissionFeasibilityChecker::checkFixedwing(dm_item_t dm_current, size_t nMissionItems,
-		fw_pos_ctrl_status_s *fw_pos_ctrl_status, float home_alt, bool home_valid,
-		float default_acceptance_rad, bool land_start_req)
+MissionFeasibilityChecker::checkMissionFeasible(const mission_s &mission,
+		float max_distance_to_1st_waypoint, float max_distance_between_waypoints,
+		bool land_start_req)
 {
-	/* Perform checks and issue feedback to the user for all checks */
-	bool resTakeoff = checkFixedWingTakeoff(dm_current, nMissionItems, home_alt, home_valid, land_start_req);
-	bool resLanding = checkFixedWingLanding(dm_current, nMissionItems, fw_pos_ctrl_status, land_start_req);
+	start(mission, max_distance_to_1st_waypoint, max_distance_between_waypoints, land_start_req);
+
+	while (!update()) {}
 
-	/* Mission is only marked as feasible if all checks return true */
-	return (resTakeoff && resLanding);
+	return _feasible;
 }
 
 bool
-MissionFeasibilityChecker::checkGeofence(dm_item_t dm_current, size_t nMissionItems, Geofence &geofence, float home_alt,
-		bool home_valid)
+MissionFeasibilityChecker::checkItem(const mission_item_s &missionitem, size_t index)
 {
-
-	if (geofence.isHomeRequired() && !home_valid) {
-		mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Geofence requires valid home position");
+	if (!checkDistanceToFirstWaypoint(missionitem)) {
 		return false;
 	}
 
-	/* Check if all mission items are inside the geofence (if we have a valid geofence) */
-	if (geofence.valid()) {
-		for (size_t i = 0; i < nMissionItems; i++) {
-			struct mission_item_s missionitem = {};
-			const ssize_t len = sizeof(missionitem);
+	// check if all mission item commands are supported
+	if (!checkMissionItemValidity(missionitem, index)) {
+		return false;
+	}
 
-			if (dm_read(dm_current, i, &missionitem, len) != len) {
-				/* not supposed to happen unless the datamanager can't access the SD card, etc. */
-				return false;
-			}
+	if (!checkDistancesBetweenWaypoints(missionitem)) {
+		return false;
+	}
 
-			if (missionitem.altitude_is_relative && !home_valid) {
-				mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Geofence requires valid home position");
-				return false;
-			}
+	if (!checkGeofence(missionitem, index)) {
+		return false;
+	}
 
-			// Geofence function checks against home altitude amsl
-			missionitem.altitude = missionitem.altitude_is_relative ? missionitem.altitude + home_alt : missionitem.altitude;
+	if (!checkHomePositionAltitude(missionitem, index)) {
+		return false;
+	}
 
-			if (MissionBlock::item_contains_position(missionitem) &&
-			    !geofence.check(missionitem)) {
+	if (!checkTakeoff(missionitem)) {
+		return false;
+	}
 
-				mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Geofence violation for waypoint %d", i + 1);
-				return false;
-			}
-		}
+	if (!_is_rotary_wing && !checkFixedWingLanding(missionitem, index)) {
+		return false;
 	}
 
 	return true;
 }
 
 bool
-MissionFeasibilityChecker::checkHomePositionAltitude(dm_item_t dm_current, size_t nMissionItems,
-		float home_alt, bool home_valid, bool &warning_issued, bool throw_error)
+MissionFeasibilityChecker::checkMissionEnd()
 {
-	/* Check if all waypoints are above the home altitude */
-	for (size_t i = 0; i < nMissionItems; i++) {
-		struct mission_item_s missionitem = {};
-		const ssize_t len = sizeof(struct mission_item_s);
-
-		if (dm_read(dm_current, i, &missionitem, len) != len) {
-			warning_issued = true;
-			/* not supposed to happen unless the datamanager can't access the SD card, etc. */
-			return false;
-		}
-
-		/* reject relative alt without home set */
-		if (missionitem.altitude_is_relative && !home_valid && MissionBlock::item_contains_position(missionitem)) {
-
-			warning_issued = true;
+	if (!_is_rotary_wing) {
+		return checkFixedWingLandStart();
+	}
 
-			if (throw_error) {
-				mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: No home pos, WP %d uses rel alt", i + 1);
-				return false;
+	// all checks have passed
+	return true;
+}
 
-			} else	{
-				mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Warning: No home pos, WP %d uses rel alt", i + 1);
-				return true;
-			}
+bool
+MissionFeasibilityChecker::checkTakeoff(const mission_item_s &missionitem)
+{
+	// look for a takeoff waypoint
+	if (missionitem.nav_cmd == NAV_CMD_TAKEOFF) {
+		// make sure that the altitude of the waypoint is at least one meter larger than the acceptance radius
+		// this makes sure that the takeoff waypoint is not reached before we are at least one meter in the air
+		float takeoff_alt = missionitem.altitude_is_relative ? missionitem.altitude : missionitem.altitude - _home_alt;
+
+		// check if we should use default acceptance radius
+		float acceptance_radius = _takeoff_acceptance_rad;
+
+		// if a specific acceptance radius has been defined, use that one instead
+		if (missionitem.acceptance_radius > NAV_EPSILON_POSITION) {
+			acceptance_radius = missionitem.acceptance_radius;
 		}
 
-		/* calculate the global waypoint altitude */
-		float wp_alt = (missionitem.altitude_is_relative) ? missionitem.altitude + home_alt : missionitem.altitude;
-
-		if ((home_alt > wp_alt) && MissionBlock::item_contains_position(missionitem)) {
-
-			warning_issued = true;
-
-			if (throw_error) {
-				mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: Waypoint %d below home", i + 1);
-				return false;
-
-			} else	{
-				mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Warning: Waypoint %d below home", i + 1);
-				return true;
-			}
+		if (takeoff_alt - 1.0f < acceptance_radius) {
+			mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: Takeoff altitude too low!");
+			return false;
 		}
 	}
 
@@ -248,77 +223,48 @@ MissionFeasibilityChecker::checkHomePositionAltitude(dm_item_t dm_current, size_
 }
 
 bool
-MissionFeasibilityChecker::checkMissionItemValidity(dm_item_t dm_current, size_t nMissionItems, bool landed)
+MissionFeasibilityChecker::checkGeofence(const mission_item_s &missionitem, size_t index)
 {
-	// do not allow mission if we find unsupported item
-	for (size_t i = 0; i < nMissionItems; i++) {
-		struct mission_item_s missionitem;
-		const ssize_t len = sizeof(struct mission_item_s);
+	/* Check if all mission items are inside the geofence (if we have a valid geofence) */
+	if (!_check_geofence || !MissionBlock::item_contains_position(missionitem)) {
+		return true;
+	}
 
-		if (dm_read(dm_current, i, &missionitem, len) != len) {
-			// not supposed to happen unless the datamanager can't access the SD card, etc.
-			mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: Cannot access SD card");
-			return false;
-		}
+	// Geofence function checks against home altitude amsl
+	mission_item_s item = missionitem;
+	item.altitude = item.altitude_is_relative ? item.altitude + _home_alt : item.altitude;
 
-		// check if we find unsupported items and reject mission if so
-		if (missionitem.nav_cmd != NAV_CMD_IDLE &&
-		    missionitem.nav_cmd != NAV_CMD_WAYPOINT &&
-		    missionitem.nav_cmd != NAV_CMD_LOITER_UNLIMITED &&
-		    missionitem.nav_cmd != NAV_CMD_LOITER_TIME_LIMIT &&
-		    missionitem.nav_cmd != NAV_CMD_RETURN_TO_LAUNCH &&
-		    missionitem.nav_cmd != NAV_CMD_LAND &&
-		    missionitem.nav_cmd != NAV_CMD_TAKEOFF &&
-		    missionitem.nav_cmd != NAV_CMD_LOITER_TO_ALT &&
-		    missionitem.nav_cmd != NAV_CMD_VTOL_TAKEOFF &&
-		    missionitem.nav_cmd != NAV_CMD_VTOL_LAND &&
-		    missionitem.nav_cmd != NAV_CMD_DELAY &&
-		    missionitem.nav_cmd != NAV_CMD_DO_JUMP &&
-		    missionitem.nav_cmd != NAV_CMD_DO_CHANGE_SPEED &&
-		    missionitem.nav_cmd != NAV_CMD_DO_SET_SERVO &&
-		    missionitem.nav_cmd != NAV_CMD_DO_LAND_START &&
-		    missionitem.nav_cmd != NAV_CMD_DO_TRIGGER_CONTROL &&
-		    missionitem.nav_cmd != NAV_CMD_DO_DIGICAM_CONTROL &&
-		    missionitem.nav_cmd != NAV_CMD_IMAGE_START_CAPTURE &&
-		    missionitem.nav_cmd != NAV_CMD_IMAGE_STOP_CAPTURE &&
-		    missionitem.nav_cmd != NAV_CMD_VIDEO_START_CAPTURE &&
-		    missionitem.nav_cmd != NAV_CMD_VIDEO_STOP_CAPTURE &&
-		    missionitem.nav_cmd != NAV_CMD_DO_MOUNT_CONFIGURE &&
-		    missionitem.nav_cmd != NAV_CMD_DO_MOUNT_CONTROL &&
-		    missionitem.nav_cmd != NAV_CMD_DO_SET_ROI &&
-		    missionitem.nav_cmd != NAV_CMD_DO_SET_CAM_TRIGG_DIST &&
-		    missionitem.nav_cmd != NAV_CMD_DO_SET_CAM_TRIGG_INTERVAL &&
-		    missionitem.nav_cmd != NAV_CMD_SET_CAMERA_MODE &&
-		    missionitem.nav_cmd != NAV_CMD_DO_VTOL_TRANSITION) {
-
-			mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: item %i: unsupported cmd: %d", (int)(i + 1),
-					     (int)missionitem.nav_cmd);
-			return false;
-		}
+	if (!_navigator->get_geofence().check(item)) {
+		mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Geofence violation for waypoint %d", index + 1);
+		return false;
+	}
 
-		/* Check non navigation item */
-		if (missionitem.nav_cmd == NAV_CMD_DO_SET_SERVO) {
+	return true;
+}
 
-			/* check actuator number */
-			if (missionitem.params[0] < 0 || missionitem.params[0] > 5) {
-				mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Actuator number %d is out of bounds 0..5",
-						     (int)missionitem.params[0]);
-				return false;
-			}
+bool
+MissionFeasibilityChecker::checkHomePositionAltitude(const mission_item_s &missionitem, size_t index,
+		bool throw_error)
+{
+	/* only the first waypoint below home is reported */
+	if (_home_altitude_warned) {
+		return true;
+	}
 
-			/* check actuator value */
-			if (missionitem.params[1] < -PWM_DEFAULT_MAX || missionitem.params[1] > PWM_DEFAULT_MAX) {
-				mavlink_log_critical(_navigator->get_mavlink_log_pub(),
-						     "Actuator value %d is out of bounds -PWM_DEFAULT_MAX..PWM_DEFAULT_MAX", (int)missionitem.params[1]);
-				return false;
-			}
-		}
+	/* Check if all waypoints are above the home altitude */
+	float wp_alt = (missionitem.altitude_is_relative) ? missionitem.altitude + _home_alt : missionitem.altitude;
+
+	if ((_home_alt > wp_alt) && MissionBlock::item_contains_position(missionitem)) {
 
-		// check if the mission starts with a land command while the vehicle is landed
-		if (missionitem.nav_cmd == NAV_CMD_LAND && i == 0 && landed) {
+		_home_altitude_warned = true;
 
-			mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: starts with landing");
+		if (throw_error) {
+			mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: Waypoint %d below home", index + 1);
 			return false;
+
+		} else	{
+			mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Warning: Waypoint %d below home", index + 1);
+			return true;
 		}
 	}
 
@@ -326,149 +272,160 @@ MissionFeasibilityChecker::checkMissionItemValidity(dm_item_t dm_current, size_t
 }
 
 bool
-MissionFeasibilityChecker::checkFixedWingTakeoff(dm_item_t dm_current, size_t nMissionItems,
-		float home_alt, bool home_valid, float default_acceptance_rad)
+MissionFeasibilityChecker::checkMissionItemValidity(const mission_item_s &missionitem, size_t index)
 {
-	for (size_t i = 0; i < nMissionItems; i++) {
-		struct mission_item_s missionitem = {};
-		const ssize_t len = sizeof(struct mission_item_s);
+	// check if we find unsupported items and reject mission if so
+	if (missionitem.nav_cmd != NAV_CMD_IDLE &&
+	    missionitem.nav_cmd != NAV_CMD_WAYPOINT &&
+	    missionitem.nav_cmd != NAV_CMD_LOITER_UNLIMITED &&
+	    missionitem.nav_cmd != NAV_CMD_LOITER_TIME_LIMIT &&
+	    missionitem.nav_cmd != NAV_CMD_RETURN_TO_LAUNCH &&
+	    missionitem.nav_cmd != NAV_CMD_LAND &&
+	    missionitem.nav_cmd != NAV_CMD_TAKEOFF &&
+	    missionitem.nav_cmd != NAV_CMD_LOITER_TO_ALT &&
+	    missionitem.nav_cmd != NAV_CMD_VTOL_TAKEOFF &&
+	    missionitem.nav_cmd != NAV_CMD_VTOL_LAND &&
+	    missionitem.nav_cmd != NAV_CMD_DELAY &&
+	    missionitem.nav_cmd != NAV_CMD_DO_JUMP &&
+	    missionitem.nav_cmd != NAV_CMD_DO_CHANGE_SPEED &&
+	    missionitem.nav_cmd != NAV_CMD_DO_SET_SERVO &&
+	    missionitem.nav_cmd != NAV_CMD_DO_LAND_START &&
+	    missionitem.nav_cmd != NAV_CMD_DO_TRIGGER_CONTROL &&
+	    missionitem.nav_cmd != NAV_CMD_DO_DIGICAM_CONTROL &&
+	    missionitem.nav_cmd != NAV_CMD_IMAGE_START_CAPTURE &&
+	    missionitem.nav_cmd != NAV_CMD_IMAGE_STOP_CAPTURE &&
+	    missionitem.nav_cmd != NAV_CMD_VIDEO_START_CAPTURE &&
+	    missionitem.nav_cmd != NAV_CMD_VIDEO_STOP_CAPTURE &&
+	    missionitem.nav_cmd != NAV_CMD_DO_MOUNT_CONFIGURE &&
+	    missionitem.nav_cmd != NAV_CMD_DO_MOUNT_CONTROL &&
+	    missionitem.nav_cmd != NAV_CMD_DO_SET_ROI &&
+	    missionitem.nav_cmd != NAV_CMD_DO_SET_CAM_TRIGG_DIST &&
+	    missionitem.nav_cmd != NAV_CMD_DO_SET_CAM_TRIGG_INTERVAL &&
+	    missionitem.nav_cmd != NAV_CMD_SET_CAMERA_MODE &&
+	    missionitem.nav_cmd != NAV_CMD_DO_VTOL_TRANSITION) {
+
+		mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: item %i: unsupported cmd: %d", (int)(index + 1),
+				     (int)missionitem.nav_cmd);
+		return false;
+	}
 
-		if (dm_read(dm_current, i, &missionitem, len) != len) {
-			/* not supposed to happen unless the datamanager can't access the SD card, etc. */
+	/* Check non navigation item */
+	if (missionitem.nav_cmd == NAV_CMD_DO_SET_SERVO) {
+
+		/* check actuator number */
+		if (missionitem.params[0] < 0 || missionitem.params[0] > 5) {
+			mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Actuator number %d is out of bounds 0..5",
+					     (int)missionitem.params[0]);
 			return false;
 		}
 
-		// look for a takeoff waypoint
-		if (missionitem.nav_cmd == NAV_CMD_TAKEOFF) {
-			// make sure that the altitude of the waypoint is at least one meter larger than the acceptance radius
-			// this makes sure that the takeoff waypoint is not reached before we are at least one meter in the air
-
-			float takeoff_alt = missionitem.altitude_is_relative
-					    ? missionitem.altitude
-					    : missionitem.altitude - home_alt;
-
-			// check if we should use default acceptance radius
-			float acceptance_radius = default_acceptance_rad;
+		/* check actuator value */
+		if (missionitem.params[1] < -PWM_DEFAULT_MAX || missionitem.params[1] > PWM_DEFAULT_MAX) {
+			mavlink_log_critical(_navigator->get_mavlink_log_pub(),
+					     "Actuator value %d is out of bounds -PWM_DEFAULT_MAX..PWM_DEFAULT_MAX", (int)missionitem.params[1]);
+			return false;
+		}
+	}
 
-			if (missionitem.acceptance_radius > NAV_EPSILON_POSITION) {
-				acceptance_radius = missionitem.acceptance_radius;
-			}
+	// check if the mission starts with a land command while the vehicle is landed
+	if (missionitem.nav_cmd == NAV_CMD_LAND && index == 0 && _landed) {
 
-			if (takeoff_alt - 1.0f < acceptance_radius) {
-				mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: Takeoff altitude too low!");
-				return false;
-			}
-		}
+		mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: starts with landing");
+		return false;
 	}
 
-	// all checks have passed
 	return true;
 }
 
 bool
-MissionFeasibilityChecker::checkFixedWingLanding(dm_item_t dm_current, size_t nMissionItems,
-		fw_pos_ctrl_status_s *fw_pos_ctrl_status, bool land_start_req)
+MissionFeasibilityChecker::checkFixedWingLanding(const mission_item_s &missionitem, size_t index)
 {
-	/* Go through all mission items and search for a landing waypoint
-	 * if landing waypoint is found: the previous waypoint is checked to be at a feasible distance and altitude given the landing slope */
-
-	bool landing_valid = false;
-
-	bool land_start_found = false;
-	size_t do_land_start_index = 0;
-	size_t landing_approach_index = 0;
+	/* Search for a landing waypoint. If a landing waypoint is found, the previous waypoint is checked to be at a
+	 * feasible distance and altitude given the landing slope */
 
-	for (size_t i = 0; i < nMissionItems; i++) {
-		struct mission_item_s missionitem;
-		const ssize_t len = sizeof(missionitem);
-
-		if (dm_read(dm_current, i, &missionitem, len) != len) {
-			/* not supposed to happen unless the datamanager can't access the SD card, etc. */
+	// if DO_LAND_START found then require valid landing AFTER
+	if (missionitem.nav_cmd == NAV_CMD_DO_LAND_START) {
+		if (_land_start_found) {
+			mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: more than one land start.");
 			return false;
-		}
 
-		// if DO_LAND_START found then require valid landing AFTER
-		if (missionitem.nav_cmd == NAV_CMD_DO_LAND_START) {
-			if (land_start_found) {
-				mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: more than one land start.");
-				return false;
-
-			} else {
-				land_start_found = true;
-				do_land_start_index = i;
-			}
+		} else {
+			_land_start_found = true;
+			_do_land_start_index = index;
 		}
+	}
 
-		if (missionitem.nav_cmd == NAV_CMD_LAND) {
-			mission_item_s missionitem_previous {};
-
-			if (i > 0) {
-				landing_approach_index = i - 1;
-
-				if (dm_read(dm_current, landing_approach_index, &missionitem_previous, len) != len) {
-					/* not supposed to happen unless the datamanager can't access the SD card, etc. */
-					return false;
-				}
+	if (missionitem.nav_cmd == NAV_CMD_LAND) {
+		if (index > 0) {
+			const mission_item_s &missionitem_previous = _previous_item;
+			_landing_approach_index = index - 1;
 
-				if (MissionBlock::item_contains_position(missionitem_previous)) {
-					float wp_distance = get_distance_to_next_waypoint(missionitem_previous.lat, missionitem_previous.lon, missionitem.lat,
-							    missionitem.lon);
+			if (MissionBlock::item_contains_position(missionitem_previous)) {
+				fw_pos_ctrl_status_s *fw_pos_ctrl_status = _navigator->get_fw_pos_ctrl_status();
 
-					float slope_alt_req = Landingslope::getLandingSlopeAbsoluteAltitude(wp_distance, missionitem.altitude,
-							      fw_pos_ctrl_status->landing_horizontal_slope_displacement, fw_pos_ctrl_status->landing_slope_angle_rad);
+				float wp_distance = get_distance_to_next_waypoint(missionitem_previous.lat, missionitem_previous.lon, missionitem.lat,
+						    missionitem.lon);
 
-					float wp_distance_req = Landingslope::getLandingSlopeWPDistance(missionitem_previous.altitude, missionitem.altitude,
-								fw_pos_ctrl_status->landing_horizontal_slope_displacement, fw_pos_ctrl_status->landing_slope_angle_rad);
+				float slope_alt_req = Landingslope::getLandingSlopeAbsoluteAltitude(wp_distance, missionitem.altitude,
+						      fw_pos_ctrl_status->landing_horizontal_slope_displacement, fw_pos_ctrl_status->landing_slope_angle_rad);
 
-					if (wp_distance > fw_pos_ctrl_status->landing_flare_length) {
-						/* Last wp is before flare region */
+				float wp_distance_req = Landingslope::getLandingSlopeWPDistance(missionitem_previous.altitude, missionitem.altitude,
+							fw_pos_ctrl_status->landing_horizontal_slope_displacement, fw_pos_ctrl_status->landing_slope_angle_rad);
 
-						const float delta_altitude = missionitem.altitude - missionitem_previous.altitude;
+				if (wp_distance > fw_pos_ctrl_status->landing_flare_length) {
+					/* Last wp is before flare region */
 
-						if (delta_altitude < 0) {
-							if (missionitem_previous.altitude > slope_alt_req) {
-								/* Landing waypoint is above altitude of slope at the given waypoint distance */
-								mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: adjust landing approach.");
-								mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Move down %.1fm or move further away by %.1fm.",
-										     (double)(slope_alt_req - missionitem_previous.altitude),
-										     (double)(wp_distance_req - wp_distance));
+					const float delta_altitude = missionitem.altitude - missionitem_previous.altitude;
 
-								return false;
-							}
+					if (delta_altitude < 0) {
+						if (missionitem_previous.altitude > slope_alt_req) {
+							/* Landing waypoint is above altitude of slope at the given waypoint distance */
+							mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: adjust landing approach.");
+							mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Move down %.1fm or move further away by %.1fm.",
+									     (double)(slope_alt_req - missionitem_previous.altitude),
+									     (double)(wp_distance_req - wp_distance));
 
-						} else {
-							/* Landing waypoint is above last waypoint */
-							mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: landing above last waypoint.");
 							return false;
 						}
 
 					} else {
-						/* Last wp is in flare region */
-						mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: waypoint within landing flare.");
+						/* Landing waypoint is above last waypoint */
+						mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: landing above last waypoint.");
 						return false;
 					}
 
-					landing_valid = true;
-
 				} else {
-					// mission item before land doesn't have a position
-					mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: need landing approach.");
+					/* Last wp is in flare region */
+					mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: waypoint within landing flare.");
 					return false;
 				}
 
+				_landing_valid = true;
+
 			} else {
-				mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: starts with land waypoint.");
+				// mission item before land doesn't have a position
+				mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: need landing approach.");
 				return false;
 			}
+
+		} else {
+			mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: starts with land waypoint.");
+			return false;
 		}
 	}
 
-	if (land_start_req && !land_start_found) {
+	return true;
+}
+
+bool
+MissionFeasibilityChecker::checkFixedWingLandStart()
+{
+	if (_land_start_req && !_land_start_found) {
 		mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: land start required.");
 		return false;
 	}
 
-	if (land_start_found && (!landing_valid || (do_land_start_index > landing_approach_index))) {
+	if (_land_start_found && (!_landing_valid || (_do_land_start_index > _landing_approach_index))) {
 		mavlink_log_critical(_navigator->get_mavlink_log_pub(), "Mission rejected: invalid land start.");
 		return false;
 	}
@@ -478,120 +435,94 @@ MissionFeasibilityChecker::checkFixedWingLanding(dm_item_t dm_current, size_t nM
 }
 
 bool
-MissionFeasibilityChecker::checkDistanceToFirstWaypoint(dm_item_t dm_current, size_t nMissionItems,
-		float max_distance, bool &warning_issued)
+MissionFeasibilityChecker::checkDistanceToFirstWaypoint(const mission_item_s &mission_item)
 {
-	if (max_distance <= 0.0f) {
-		/* param not set, check is ok */
+	if (_max_distance_to_1st_waypoint <= 0.0f || _first_waypoint_checked) {
+		/* param not set or first waypoint already checked, check is ok */
 		return true;
 	}
 
-	/* find first waypoint (with lat/lon) item in datamanager */
-	for (size_t i = 0; i < nMissionItems; i++) {
+	/* check only items with valid lat/lon */
+	if (!MissionBlock::item_contains_position(mission_item)) {
+		return true;
+	}
 
-		struct mission_item_s mission_item {};
+	_first_waypoint_checked = true;
 
-		if (!(dm_read(dm_current, i, &mission_item, sizeof(mission_item_s)) == sizeof(mission_item_s))) {
-			/* error reading, mission is invalid */
-			mavlink_log_info(_navigator->get_mavlink_log_pub(), "Error reading offboard mission.");
-			return false;
-		}
-
-		/* check only items with valid lat/lon */
-		if (!MissionBlock::item_contains_position(mission_item)) {
-			continue;
-		}
+	const float max_distance = _max_distance_to_1st_waypoint;
 
-		/* check distance from current position to item */
-		float dist_to_1wp = get_distance_to_next_waypoint(
-					    mission_item.lat, mission_item.lon,
-					    _navigator->get_home_position()->lat, _navigator->get_home_position()->lon);
+	/* check distance from current position to item */
+	float dist_to_1wp = get_distance_to_next_waypoint(
+				    mission_item.lat, mission_item.lon,
+				    _navigator->get_home_position()->lat, _navigator->get_home_position()->lon);
 
-		if (dist_to_1wp < max_distance) {
+	if (dist_to_1wp < max_distance) {
 
-			if (dist_to_1wp > ((max_distance * 3) / 2)) {
-				/* allow at 2/3 distance, but warn */
-				mavlink_log_critical(_navigator->get_mavlink_log_pub(),
-						     "First waypoint far away: %d meters.", (int)dist_to_1wp);
-				warning_issued = true;
-			}
-
-			return true;
-
-		} else {
-			/* item is too far from home */
+		if (dist_to_1wp > ((max_distance * 3) / 2)) {
+			/* allow at 2/3 distance, but warn */
 			mavlink_log_critical(_navigator->get_mavlink_log_pub(),
-					     "First waypoint too far away: %d meters, %d max.",
-					     (int)dist_to_1wp, (int)max_distance);
-			warning_issued = true;
-			return false;
+					     "First waypoint far away: %d meters.", (int)dist_to_1wp);
+			_navigator->get_mission_result()->warning = true;
 		}
-	}
 
-	/* no waypoints found in mission, then we will not fly far away */
-	return true;
+		return true;
+
+	} else {
+		/* item is too far from home */
+		mavlink_log_critical(_navigator->get_mavlink_log_pub(),
+				     "First waypoint too far away: %d meters, %d max.",
+				     (int)dist_to_1wp, (int)max_distance);
+		_navigator->get_mission_result()->warning = true;
+		return false;
+	}
 }
 
 bool
-MissionFeasibilityChecker::checkDistancesBetweenWaypoints(dm_item_t dm_current, size_t nMissionItems,
-		float max_distance, bool &warning_issued)
+MissionFeasibilityChecker::checkDistancesBetweenWaypoints(const mission_item_s &mission_item)
 {
+	const float max_distance = _max_distance_between_waypoints;
+
 	if (max_distance <= 0.0f) {
 		/* param not set, check is ok */
 		return true;
 	}
 
-	double last_lat = NAN;
-	double last_lon = NAN;
-
-	/* Go through all waypoints */
-	for (size_t i = 0; i < nMissionItems; i++) {
-
-		struct mission_item_s mission_item {};
-
-		if (!(dm_read(dm_current, i, &mission_item, sizeof(mission_item_s)) == sizeof(mission_item_s))) {
-			/* error reading, mission is invalid */
-			mavlink_log_info(_navigator->get_mavlink_log_pub(), "Error reading offboard mission.");
-			return false;
-		}
-
-		/* check only items with valid lat/lon */
-		if (!MissionBlock::item_contains_position(mission_item)) {
-			continue;
-		}
-
-		/* Compare it to last waypoint if already available. */
-		if (PX4_ISFINITE(last_lat) && PX4_ISFINITE(last_lon)) {
+	/* check only items with valid lat/lon */
+	if (!MissionBlock::item_contains_position(mission_item)) {
+		return true;
+	}
 
-			/* check distance from current position to item */
-			float dist_between_waypoints = get_distance_to_next_waypoint(
-							       mission_item.lat, mission_item.lon,
-							       last_lat, last_lon);
+	/* Compare it to last waypoint if already available. */
+	if (_has_last_position) {
 
-			if (dist_between_waypoints < max_distance) {
+		/* check distance from current position to item */
+		float dist_between_waypoints = get_distance_to_next_waypoint(
+						       mission_item.lat, mission_item.lon,
+						       _last_lat, _last_lon);
 
-				if (dist_between_waypoints > ((max_distance * 3) / 2)) {
-					/* allow at 2/3 distance, but warn */
-					mavlink_log_critical(_navigator->get_mavlink_log_pub(),
-							     "Distance between waypoints very far: %d meters.",
-							     (int)dist_between_waypoints);
-					warning_issued = true;
-				}
+		if (dist_between_waypoints < max_distance) {
 
-			} else {
-				/* item is too far from home */
+			if (dist_between_waypoints > ((max_distance * 3) / 2)) {
+				/* allow at 2/3 distance, but warn */
 				mavlink_log_critical(_navigator->get_mavlink_log_pub(),
-						     "Distance between waypoints too far: %d meters, %d max.",
-						     (int)dist_between_waypoints, (int)max_distance);
-				warning_issued = true;
-				return false;
+						     "Distance between waypoints very far: %d meters.",
+						     (int)dist_between_waypoints);
+				_navigator->get_mission_result()->warning = true;
 			}
-		}
 
-		last_lat = mission_item.lat;
-		last_lon = mission_item.lon;
+		} else {
+			/* item is too far from home */
+			mavlink_log_critical(_navigator->get_mavlink_log_pub(),
+					     "Distance between waypoints too far: %d meters, %d max.",
+					     (int)dist_between_waypoints, (int)max_distance);
+			_navigator->get_mission_result()->warning = true;
+			return false;
+		}
 	}
 
-	/* We ran through all waypoints and have not found any distances between waypoints that are too far. */
+	_last_lat = mission_item.lat;
+	_last_lon = mission_item.lon;
+	_has_last_position = true;
+
 	return true;
 }
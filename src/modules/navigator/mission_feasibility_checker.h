@@ -49,35 +49,71 @@
 class Geofence;
 class Navigator;
 
+/**
+ * The mission is checked in a single pass over the items, which can be split over several calls of update(), so
+ * that long missions do not block the navigator loop. The items are read in batches with dm_read_range().
+ */
 class MissionFeasibilityChecker
 {
 private:
+	static constexpr unsigned ITEM_BATCH_SIZE = 8; ///< number of items read from dataman in one request
+	static constexpr unsigned MAX_ITEMS_PER_UPDATE = 64; ///< number of items checked per call to update()
+
 	Navigator *_navigator{nullptr};
 
-	/* Checks for all airframes */
-	bool checkGeofence(dm_item_t dm_current, size_t nMissionItems, Geofence &geofence, float home_alt, bool home_valid);
+	/* inputs of the running check, captured in start() */
+	dm_item_t _dm_current{DM_KEY_WAYPOINTS_OFFBOARD_0};
+	size_t _num_items{0};
+	float _max_distance_to_1st_waypoint{0.0f};
+	float _max_distance_between_waypoints{0.0f};
+	bool _land_start_req{false};
+	bool _home_valid{false};
+	bool _is_rotary_wing{false};
+	bool _landed{false};
+	float _home_alt{0.0f};
+	float _takeoff_acceptance_rad{0.0f};
+	bool _check_geofence{false};
+
+	/* progress */
+	bool _in_progress{false};
+	bool _feasible{false};
+	size_t _next_index{0};
+	mission_item_s _items[ITEM_BATCH_SIZE] {};
+
+	/* state of the individual checks */
+	bool _first_waypoint_checked{false};
+	bool _home_altitude_warned{false};
+	double _last_lat{0.0};
+	double _last_lon{0.0};
+	bool _has_last_position{false};
+	mission_item_s _previous_item{};
+	bool _land_start_found{false};
+	bool _landing_valid{false};
+	size_t _do_land_start_index{0};
+	size_t _landing_approach_index{0};
+
+	/** run all checks on one item, @return false if the mission is not feasible */
+	bool checkItem(const mission_item_s &missionitem, size_t index);
+
+	/** run the checks that need the whole mission, @return false if the mission is not feasible */
+	bool checkMissionEnd();
 
-	bool checkHomePositionAltitude(dm_item_t dm_current, size_t nMissionItems, float home_alt, bool home_valid,
-				       bool &warning_issued, bool throw_error = false);
+	/* Checks for all airframes */
+	bool checkGeofence(const mission_item_s &missionitem, size_t index);
 
-	bool checkMissionItemValidity(dm_item_t dm_current, size_t nMissionItems, bool condition_landed);
+	bool checkHomePositionAltitude(const mission_item_s &missionitem, size_t index, bool throw_error = false);
 
-	bool checkDistanceToFirstWaypoint(dm_item_t dm_current, size_t nMissionItems, float max_distance, bool &warning_issued);
-	bool checkDistancesBetweenWaypoints(dm_item_t dm_current, size_t nMissionItems, float max_distance,
-					    bool &warning_issued);
+	bool checkMissionItemValidity(const mission_item_s &missionitem, size_t index);
 
-	/* Checks specific to fixedwing airframes */
-	bool checkFixedwing(dm_item_t dm_current, size_t nMissionItems, fw_pos_ctrl_status_s *fw_pos_ctrl_status,
-			    float home_alt, bool home_valid, float default_acceptance_rad, bool land_start_req);
+	bool checkDistanceToFirstWaypoint(const mission_item_s &missionitem);
+	bool checkDistancesBetweenWaypoints(const mission_item_s &missionitem);
 
-	bool checkFixedWingTakeoff(dm_item_t dm_current, size_t nMissionItems, float home_alt, bool home_valid,
-				   float default_acceptance_rad);
-	bool checkFixedWingLanding(dm_item_t dm_current, size_t nMissionItems, fw_pos_ctrl_status_s *fw_pos_ctrl_status,
-				   bool land_start_req);
+	/** takeoff altitude check (for fixedwing and rotarywing airframes) */
+	bool checkTakeoff(const mission_item_s &missionitem);
 
-	/* Checks specific to rotarywing airframes */
-	bool checkRotarywing(dm_item_t dm_current, size_t nMissionItems,
-			     float home_alt, bool home_valid, float default_altitude_acceptance_rad);
+	/* Checks specific to fixedwing airframes */
+	bool checkFixedWingLanding(const mission_item_s &missionitem, size_t index);
+	bool checkFixedWingLandStart();
 
 public:
 	MissionFeasibilityChecker(Navigator *navigator) : _navigator(navigator) {}
@@ -86,7 +122,27 @@ public:
 	MissionFeasibilityChecker(const MissionFeasibilityChecker &) = delete;
 	MissionFeasibilityChecker &operator=(const MissionFeasibilityChecker &) = delete;
 
+	/**
+	 * Start checking a mission (a running check is aborted). The vehicle state (home, landed, airframe type) is taken
+	 * at this point. The result is available after update() returned true.
+	 */
+	void start(const mission_s &mission,
+		   float max_distance_to_1st_waypoint, float max_distance_between_waypoints,
+		   bool land_start_req);
+
+	/**
+	 * Continue the running check.
+	 * @return true if the check is finished (@see feasible())
+	 */
+	bool update();
+
+	bool inProgress() const { return _in_progress; }
+
+	/** result of the last finished check */
+	bool feasible() const { return _feasible; }
+
 	/*
+	 * Check the whole mission at once.
 	 * Returns true if mission is feasible and false otherwise
 	 */
 	bool checkMissionFeasible(const mission_s &mission,
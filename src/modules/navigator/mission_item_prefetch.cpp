@@ -0,0 +1,187 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2017 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+/**
+ * @file mission_item_prefetch.cpp
+ */
+
+#include "mission_item_prefetch.h"
+
+#include <mathlib/mathlib.h>
+#include <px4_defines.h>
+#include <string.h>
+#include <unistd.h>
+
+MissionItemPrefetch::~MissionItemPrefetch()
+{
+	/* the dataman thread still writes to the refill buffer */
+	while (_refill_pending) {
+		usleep(1000);
+	}
+}
+
+bool
+MissionItemPrefetch::read(dm_item_t dm_item, unsigned count, unsigned index, mission_item_s *mission_item)
+{
+	process_refill();
+
+	if (dm_item != _dm_item || count != _count) {
+		invalidate();
+		_dm_item = dm_item;
+		_count = count;
+	}
+
+	if (index >= _count) {
+		return false;
+	}
+
+	if (index < _begin || index >= _end) {
+		/* not cached (first item or a jump): read a batch directly into the ring */
+		invalidate();
+
+		const unsigned batch = math::min(REFILL_SIZE, _count - index);
+
+		if (dm_read_range(_dm_item, index, batch, _ring, sizeof(mission_item_s)) != (ssize_t)batch) {
+			return false;
+		}
+
+		_head = 0;
+		_begin = index;
+		_end = index + batch;
+	}
+
+	memcpy(mission_item, &slot(index), sizeof(mission_item_s));
+
+	request_refill(index);
+
+	return true;
+}
+
+void
+MissionItemPrefetch::update(dm_item_t dm_item, unsigned index, const mission_item_s &mission_item)
+{
+	if (dm_item != _dm_item) {
+		return;
+	}
+
+	if (index >= _begin && index < _end) {
+		slot(index) = mission_item;
+	}
+
+	/* a pending refill might have read the item before it was written */
+	if (_refill_requested && index >= _refill_index && index < _refill_index + _refill_count) {
+		_refill_discard = true;
+	}
+}
+
+void
+MissionItemPrefetch::invalidate()
+{
+	_head = 0;
+	_begin = 0;
+	_end = 0;
+
+	if (_refill_requested) {
+		_refill_discard = true;
+	}
+}
+
+void
+MissionItemPrefetch::refill_done(void *arg, ssize_t result)
+{
+	MissionItemPrefetch *prefetch = (MissionItemPrefetch *)arg;
+
+	prefetch->_refill_result = result;
+
+	/* publish the result and the buffer content before releasing the buffer */
+	__sync_synchronize();
+	prefetch->_refill_pending = false;
+}
+
+void
+MissionItemPrefetch::process_refill()
+{
+	if (!_refill_requested || _refill_pending) {
+		return;
+	}
+
+	__sync_synchronize();
+
+	_refill_requested = false;
+
+	/* the items are appended, if the ring still ends where the request started */
+	if (_refill_discard || _refill_result != (ssize_t)_refill_count || _refill_index != _end || _begin == _end) {
+		return;
+	}
+
+	for (unsigned i = 0; i < _refill_count; i++) {
+		if (_end - _begin == RING_SIZE) {
+			/* drop the oldest item */
+			_head = (_head + 1) % RING_SIZE;
+			_begin++;
+		}
+
+		_end++;
+		slot(_end - 1) = _refill[i];
+	}
+}
+
+void
+MissionItemPrefetch::request_refill(unsigned index)
+{
+	if (_refill_requested || _end >= _count) {
+		return;
+	}
+
+	/* keep a few items before the read one, it might be a lookahead of the current item */
+	const unsigned keep_from = (index > _begin + KEEP_BEHIND) ? index - KEEP_BEHIND : _begin;
+	const unsigned space = RING_SIZE - (_end - keep_from);
+	const unsigned count = math::min(math::min(REFILL_SIZE, space), _count - _end);
+
+	/* wait for a full batch, except for the end of the mission */
+	if (count == 0 || (count < REFILL_SIZE && _end + count < _count)) {
+		return;
+	}
+
+	_refill_index = _end;
+	_refill_count = count;
+	_refill_discard = false;
+	_refill_pending = true;
+
+	if (dm_read_range_async(_dm_item, _refill_index, _refill_count, _refill, sizeof(mission_item_s),
+				&MissionItemPrefetch::refill_done, this) != 0) {
+		_refill_pending = false;
+		return;
+	}
+
+	_refill_requested = true;
+}
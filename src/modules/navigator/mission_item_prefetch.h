@@ -0,0 +1,111 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2017 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+/**
+ * @file mission_item_prefetch.h
+ * Keeps the upcoming mission items in RAM, so that a waypoint transition does not wait for the dataman.
+ */
+
+#pragma once
+
+#include <dataman/dataman.h>
+#include <navigator/navigation.h>
+
+#include <sys/types.h>
+
+/**
+ * @class MissionItemPrefetch
+ * Ring of consecutive mission items. The ring is refilled in the background with dm_read_range_async() while the
+ * mission progresses, a read outside of the ring falls back to a blocking dataman read.
+ * All methods must be called from the same thread (the navigator), only the completion callback runs on the dataman
+ * thread.
+ */
+class MissionItemPrefetch
+{
+public:
+	MissionItemPrefetch() = default;
+	~MissionItemPrefetch();
+
+	MissionItemPrefetch(const MissionItemPrefetch &) = delete;
+	MissionItemPrefetch &operator=(const MissionItemPrefetch &) = delete;
+
+	/**
+	 * Read a mission item
+	 * @param dm_item dataman item of the mission
+	 * @param count number of items in the mission
+	 * @param index index of the item
+	 * @return true on success
+	 */
+	bool read(dm_item_t dm_item, unsigned count, unsigned index, mission_item_s *mission_item);
+
+	/**
+	 * Update a cached item after it has been written to the dataman
+	 */
+	void update(dm_item_t dm_item, unsigned index, const mission_item_s &mission_item);
+
+	/**
+	 * Drop all cached items, must be called when the mission items are changed in the dataman
+	 */
+	void invalidate();
+
+private:
+	static constexpr unsigned RING_SIZE = 24; ///< number of cached items
+	static constexpr unsigned REFILL_SIZE = 8; ///< maximum number of items read with one request
+	static constexpr unsigned KEEP_BEHIND = 8; ///< items kept before the last read one (the current item during lookahead)
+
+	static void refill_done(void *arg, ssize_t result);
+
+	/** merge the items of a completed refill into the ring */
+	void process_refill();
+
+	/** request the items following the ring, if there is enough free space */
+	void request_refill(unsigned index);
+
+	mission_item_s &slot(unsigned index) { return _ring[(_head + index - _begin) % RING_SIZE]; }
+
+	mission_item_s _ring[RING_SIZE] {};
+	unsigned _head{0}; ///< slot of the item _begin
+	unsigned _begin{0}; ///< index of the first cached item
+	unsigned _end{0}; ///< index after the last cached item
+
+	dm_item_t _dm_item{DM_KEY_WAYPOINTS_OFFBOARD_0};
+	unsigned _count{0};
+
+	/* refill request, the buffer is owned by the dataman thread while _refill_pending is set */
+	mission_item_s _refill[REFILL_SIZE] {};
+	unsigned _refill_index{0};
+	unsigned _refill_count{0};
+	bool _refill_requested{false};
+	bool _refill_discard{false}; ///< the cache was changed after the request, so its result is dropped
+	volatile bool _refill_pending{false};
+	volatile ssize_t _refill_result{0};
+};
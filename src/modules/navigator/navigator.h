@@ -158,6 +158,9 @@ public:
 	Geofence	&get_geofence() { return _geofence; }
 
 	bool		get_can_loiter_at_sp() { return _can_loiter_at_sp; }
+
+	/** inputs updated in the current loop iteration (@see NavigatorMode::Topic) */
+	uint32_t	get_updated_topics() const { return _updated_topics; }
 	float		get_loiter_radius() { return _param_loiter_radius.get(); }
 
 	/**
@@ -297,6 +300,15 @@ private:
 	Geofence	_geofence;			/**< class that handles the geofence */
 	bool		_geofence_violation_warning_sent{false}; /**< prevents spaming to mavlink */
 
+	/* position of the last geofence check */
+	double		_geofence_check_lat{0.0};
+	double		_geofence_check_lon{0.0};
+	float		_geofence_check_alt{0.0f};
+	float		_geofence_check_baro_alt{0.0f};
+	uint64_t	_geofence_check_home_timestamp{0};
+
+	uint32_t	_updated_topics{0};		/**< inputs updated in the current loop iteration */
+
 	bool		_can_loiter_at_sp{false};			/**< flags if current position SP can be used to loiter */
 	bool		_pos_sp_triplet_updated{false};		/**< flags if position SP triplet needs to be published */
 	bool 		_pos_sp_triplet_published_invalid_once{false};	/**< flags if position SP triplet has been published once to UORB */
@@ -331,6 +343,11 @@ private:
 	float _mission_cruising_speed_fw{-1.0f};
 	float _mission_throttle{-1.0f};
 
+	/**
+	 * Check if the vehicle moved (or the home changed) enough since the last geofence check to repeat it
+	 */
+	bool		geofence_position_changed();
+
 	// update subscriptions
 	void		fw_pos_ctrl_status_update(bool force = false);
 	void		global_position_update();
@@ -77,6 +77,8 @@
 extern "C" __EXPORT int navigator_main(int argc, char *argv[]);
 
 #define GEOFENCE_CHECK_INTERVAL 200000
+#define GEOFENCE_CHECK_INTERVAL_MAX 1000000	/**< check the geofence at least every 1 s, even without movement */
+#define GEOFENCE_CHECK_DISTANCE 1.0f		/**< horizontal or vertical movement to repeat the geofence check [m] */
 
 namespace navigator
 {
@@ -165,6 +167,31 @@ Navigator::gps_position_update()
 	orb_copy(ORB_ID(vehicle_gps_position), _gps_pos_sub, &_gps_pos);
 }
 
+bool
+Navigator::geofence_position_changed()
+{
+	if (_home_pos.timestamp != _geofence_check_home_timestamp) {
+		return true;
+	}
+
+	const bool gps = (_geofence.getSource() == Geofence::GF_SOURCE_GPS);
+	const double lat = gps ? _gps_pos.lat * 1e-7 : _global_pos.lat;
+	const double lon = gps ? _gps_pos.lon * 1e-7 : _global_pos.lon;
+	const float alt = gps ? _gps_pos.alt * 1e-3f : _global_pos.alt;
+
+	if (fabsf(alt - _geofence_check_alt) > GEOFENCE_CHECK_DISTANCE ||
+	    fabsf(_sensor_combined.baro_alt_meter - _geofence_check_baro_alt) > GEOFENCE_CHECK_DISTANCE) {
+		return true;
+	}
+
+	/* small angle approximation, the longitude difference is scaled with the latitude of the last check */
+	const float meters_per_deg = (float)(CONSTANTS_RADIUS_OF_EARTH * M_PI / 180.0);
+	const float dnorth = (float)(lat - _geofence_check_lat) * meters_per_deg;
+	const float deast = (float)(lon - _geofence_check_lon) * meters_per_deg * cosf(math::radians((float)_geofence_check_lat));
+
+	return (dnorth * dnorth + deast * deast) > GEOFENCE_CHECK_DISTANCE * GEOFENCE_CHECK_DISTANCE;
+}
+
 void
 Navigator::sensor_combined_update()
 {
@@ -281,8 +308,11 @@ Navigator::task_main()
 		/* wait for up to 1000ms for data */
 		int pret = px4_poll(&fds[0], (sizeof(fds) / sizeof(fds[0])), 1000);
 
+		_updated_topics = 0;
+
 		if (pret == 0) {
 			/* Let the loop run anyway, don't do `continue` here. */
+			_updated_topics = NavigatorMode::TOPIC_ALL;
 
 		} else if (pret < 0) {
 			/* this is undesirable but not much we can do - might want to flag unhappy status */
@@ -294,6 +324,7 @@ Navigator::task_main()
 			if (fds[0].revents & POLLIN) {
 				/* success, local pos is available */
 				local_position_update();
+				_updated_topics |= NavigatorMode::TOPIC_LOCAL_POSITION;
 			}
 		}
 
@@ -306,6 +337,7 @@ Navigator::task_main()
 
 		if (updated) {
 			gps_position_update();
+			_updated_topics |= NavigatorMode::TOPIC_GPS_POSITION;
 
 			if (_geofence.getSource() == Geofence::GF_SOURCE_GPS) {
 				have_geofence_position_data = true;
@@ -317,6 +349,7 @@ Navigator::task_main()
 
 		if (updated) {
 			global_position_update();
+			_updated_topics |= NavigatorMode::TOPIC_GLOBAL_POSITION;
 
 			if (_geofence.getSource() == Geofence::GF_SOURCE_GLOBALPOS) {
 				have_geofence_position_data = true;
@@ -328,6 +361,7 @@ Navigator::task_main()
 
 		if (updated) {
 			sensor_combined_update();
+			_updated_topics |= NavigatorMode::TOPIC_SENSOR_COMBINED;
 		}
 
 		/* parameters updated */
@@ -335,6 +369,7 @@ Navigator::task_main()
 
 		if (updated) {
 			params_update();
+			_updated_topics |= NavigatorMode::TOPIC_PARAMETERS;
 		}
 
 		/* vehicle status updated */
@@ -342,6 +377,7 @@ Navigator::task_main()
 
 		if (updated) {
 			vehicle_status_update();
+			_updated_topics |= NavigatorMode::TOPIC_VEHICLE_STATUS;
 		}
 
 		/* vehicle land detected updated */
@@ -349,6 +385,7 @@ Navigator::task_main()
 
 		if (updated) {
 			vehicle_land_detected_update();
+			_updated_topics |= NavigatorMode::TOPIC_LAND_DETECTED;
 		}
 
 		/* navigation capabilities updated */
@@ -356,6 +393,7 @@ Navigator::task_main()
 
 		if (updated) {
 			fw_pos_ctrl_status_update();
+			_updated_topics |= NavigatorMode::TOPIC_FW_POS_CTRL_STATUS;
 		}
 
 		/* home position updated */
@@ -363,6 +401,7 @@ Navigator::task_main()
 
 		if (updated) {
 			home_position_update();
+			_updated_topics |= NavigatorMode::TOPIC_HOME_POSITION;
 		}
 
 		/* vehicle_command updated */
@@ -371,6 +410,7 @@ Navigator::task_main()
 		if (updated) {
 			vehicle_command_s cmd;
 			orb_copy(ORB_ID(vehicle_command), _vehicle_command_sub, &cmd);
+			_updated_topics |= NavigatorMode::TOPIC_VEHICLE_COMMAND;
 
 			if (cmd.command == vehicle_command_s::VEHICLE_CMD_DO_GO_AROUND) {
 
@@ -577,7 +617,14 @@ Navigator::task_main()
 
 		if (have_geofence_position_data &&
 		    (_geofence.getGeofenceAction() != geofence_result_s::GF_ACTION_NONE) &&
-		    (hrt_elapsed_time(&last_geofence_check) > GEOFENCE_CHECK_INTERVAL)) {
+		    (hrt_elapsed_time(&last_geofence_check) > GEOFENCE_CHECK_INTERVAL) &&
+		    (hrt_elapsed_time(&last_geofence_check) > GEOFENCE_CHECK_INTERVAL_MAX || geofence_position_changed())) {
+
+			_geofence_check_lat = _geofence.getSource() == Geofence::GF_SOURCE_GPS ? _gps_pos.lat * 1e-7 : _global_pos.lat;
+			_geofence_check_lon = _geofence.getSource() == Geofence::GF_SOURCE_GPS ? _gps_pos.lon * 1e-7 : _global_pos.lon;
+			_geofence_check_alt = _geofence.getSource() == Geofence::GF_SOURCE_GPS ? _gps_pos.alt * 1e-3f : _global_pos.alt;
+			_geofence_check_baro_alt = _sensor_combined.baro_alt_meter;
+			_geofence_check_home_timestamp = _home_pos.timestamp;
 
 			bool inside = _geofence.check(_global_pos, _gps_pos, _sensor_combined.baro_alt_meter, _home_pos,
 						      home_position_valid());
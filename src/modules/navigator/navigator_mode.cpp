@@ -64,8 +64,8 @@ NavigatorMode::run(bool active)
 			_navigator->set_mission_result_updated();
 			on_activation();
 
-		} else {
-			/* periodic updates when active */
+		} else if ((_navigator->get_updated_topics() & active_dependencies()) != 0) {
+			/* periodic updates when active (inputs changed) */
 			on_active();
 		}
 
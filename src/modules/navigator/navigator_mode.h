@@ -61,8 +61,32 @@ public:
 	NavigatorMode(const NavigatorMode &) = delete;
 	NavigatorMode operator=(const NavigatorMode &) = delete;
 
+	/**
+	 * Inputs of the navigator which changed in a loop iteration (bitmask, @see active_dependencies())
+	 */
+	enum Topic : uint32_t {
+		TOPIC_LOCAL_POSITION = (1 << 0),
+		TOPIC_GLOBAL_POSITION = (1 << 1),
+		TOPIC_GPS_POSITION = (1 << 2),
+		TOPIC_SENSOR_COMBINED = (1 << 3),
+		TOPIC_PARAMETERS = (1 << 4),
+		TOPIC_VEHICLE_STATUS = (1 << 5),
+		TOPIC_LAND_DETECTED = (1 << 6),
+		TOPIC_FW_POS_CTRL_STATUS = (1 << 7),
+		TOPIC_HOME_POSITION = (1 << 8),
+		TOPIC_VEHICLE_COMMAND = (1 << 9),
+		TOPIC_ALL = 0xffffffff ///< also set if the loop ran without new data (timeout)
+	};
+
 	void run(bool active);
 
+	/**
+	 * Inputs used by on_active(). It is only called if one of them changed, on activation or when the navigator
+	 * loop times out. By default on_active() runs in every loop iteration; only modes without time-based logic
+	 * may restrict it.
+	 */
+	virtual uint32_t active_dependencies() const { return TOPIC_ALL; }
+
 	/**
 	 * This function is called while the mode is inactive
 	 */
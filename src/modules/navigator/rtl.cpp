@@ -132,13 +132,15 @@ RTL::set_rtl_item()
 
 	_navigator->set_can_loiter_at_sp(false);
 
+	_home_frame.set_reference(_navigator->get_home_position()->lat, _navigator->get_home_position()->lon);
+	const double lat = _navigator->get_global_position()->lat;
+	const double lon = _navigator->get_global_position()->lon;
+
 	switch (_rtl_state) {
 	case RTL_STATE_CLIMB: {
 
 			// check if we are pretty close to home already
-			float home_dist = get_distance_to_next_waypoint(_navigator->get_home_position()->lat,
-					  _navigator->get_home_position()->lon,
-					  _navigator->get_global_position()->lat, _navigator->get_global_position()->lon);
+			float home_dist = _home_frame.distance_to(lat, lon);
 
 			// if we are close to home we do not climb as high, otherwise we climb to return alt
 			float climb_alt = _navigator->get_home_position()->alt + get_rtl_altitude();
@@ -173,18 +175,14 @@ RTL::set_rtl_item()
 
 			// use home yaw if close to home
 			/* check if we are pretty close to home already */
-			float home_dist = get_distance_to_next_waypoint(_navigator->get_home_position()->lat,
-					  _navigator->get_home_position()->lon,
-					  _navigator->get_global_position()->lat, _navigator->get_global_position()->lon);
+			float home_dist = _home_frame.distance_to(lat, lon);
 
 			if (home_dist < _param_rtl_min_dist.get()) {
 				_mission_item.yaw = _navigator->get_home_position()->yaw;
 
 			} else {
 				// use current heading to home
-				_mission_item.yaw = get_bearing_to_next_waypoint(
-							    _navigator->get_global_position()->lat, _navigator->get_global_position()->lon,
-							    _navigator->get_home_position()->lat, _navigator->get_home_position()->lon);
+				_mission_item.yaw = _home_frame.bearing_from(lat, lon);
 			}
 
 			_mission_item.loiter_radius = _navigator->get_loiter_radius();
@@ -220,14 +218,10 @@ RTL::set_rtl_item()
 			_mission_item.yaw = _navigator->get_home_position()->yaw;
 
 			// except for vtol which might be still off here and should point towards this location
-			float d_current = get_distance_to_next_waypoint(
-						  _navigator->get_global_position()->lat, _navigator->get_global_position()->lon,
-						  _mission_item.lat, _mission_item.lon);
+			float d_current = _home_frame.distance_to(lat, lon);
 
 			if (_navigator->get_vstatus()->is_vtol && d_current > _navigator->get_acceptance_radius()) {
-				_mission_item.yaw = get_bearing_to_next_waypoint(
-							    _navigator->get_global_position()->lat, _navigator->get_global_position()->lon,
-							    _mission_item.lat, _mission_item.lon);
+				_mission_item.yaw = _home_frame.bearing_from(lat, lon);
 			}
 
 			_mission_item.loiter_radius = _navigator->get_loiter_radius();
@@ -50,6 +50,7 @@
 
 #include "navigator_mode.h"
 #include "mission_block.h"
+#include "geo_local_frame.h"
 
 class Navigator;
 
@@ -95,6 +96,8 @@ private:
 
 	bool _rtl_alt_min{false};
 
+	GeoLocalFrame _home_frame; ///< local frame around home, updated when home changes
+
 	control::BlockParamFloat _param_return_alt;
 	control::BlockParamFloat _param_descend_alt;
 	control::BlockParamFloat _param_land_delay;
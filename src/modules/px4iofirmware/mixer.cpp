@@ -92,6 +92,7 @@ enum mixer_source {
 static volatile mixer_source source;
 
 static int mixer_callback(uintptr_t handle, uint8_t control_group, uint8_t control_index, float &control);
+static int mixer_callback_fixed(uintptr_t handle, uint8_t control_group, uint8_t control_index, int32_t &control);
 static int mixer_mix_threadsafe(float *outputs, volatile uint16_t *limits);
 
 static MixerGroup mixer_group(mixer_callback, 0);
@@ -481,6 +482,98 @@ mixer_callback(uintptr_t handle,
 	return 0;
 }
 
+/*
+ * Integer version of mixer_callback() for the fixed-point mixer program: the
+ * controls are kept in register units, which avoids the software float
+ * division of REG_TO_FLOAT() for every control on every cycle.
+ */
+static int
+mixer_callback_fixed(uintptr_t handle,
+		     uint8_t control_group,
+		     uint8_t control_index,
+		     int32_t &control)
+{
+	control = 0;
+
+	if (control_group >= PX4IO_CONTROL_GROUPS) {
+		return -1;
+	}
+
+	switch (source) {
+	case MIX_FMU:
+		if (control_index < PX4IO_CONTROL_CHANNELS && control_group < PX4IO_CONTROL_GROUPS) {
+			control = REG_TO_SIGNED(r_page_controls[CONTROL_PAGE_INDEX(control_group, control_index)]);
+			break;
+		}
+
+		return -1;
+
+	case MIX_OVERRIDE:
+		if (r_page_rc_input[PX4IO_P_RC_VALID] & (1 << CONTROL_PAGE_INDEX(control_group, control_index))) {
+			control = REG_TO_SIGNED(r_page_rc_input[PX4IO_P_RC_BASE + control_index]);
+			break;
+		}
+
+		return -1;
+
+	case MIX_OVERRIDE_FMU_OK:
+		if (r_page_rc_input[PX4IO_P_RC_VALID] & (1 << CONTROL_PAGE_INDEX(control_group, control_index))) {
+			control = REG_TO_SIGNED(r_page_rc_input[PX4IO_P_RC_BASE + control_index]);
+			break;
+
+		} else if (control_index < PX4IO_CONTROL_CHANNELS && control_group < PX4IO_CONTROL_GROUPS) {
+			control = REG_TO_SIGNED(r_page_controls[CONTROL_PAGE_INDEX(control_group, control_index)]);
+			break;
+		}
+
+		return -1;
+
+	case MIX_FAILSAFE:
+	case MIX_NONE:
+		control = 0;
+		return -1;
+	}
+
+	/* apply trim offsets for override channels */
+	if ((source == MIX_OVERRIDE || source == MIX_OVERRIDE_FMU_OK) &&
+	    control_group == actuator_controls_s::GROUP_INDEX_ATTITUDE) {
+		if (control_index == actuator_controls_s::INDEX_ROLL) {
+			control = control * REG_TO_SIGNED(r_setup_scale_roll) / Mixer::FIXED_ONE + REG_TO_SIGNED(r_setup_trim_roll);
+
+		} else if (control_index == actuator_controls_s::INDEX_PITCH) {
+			control = control * REG_TO_SIGNED(r_setup_scale_pitch) / Mixer::FIXED_ONE + REG_TO_SIGNED(r_setup_trim_pitch);
+
+		} else if (control_index == actuator_controls_s::INDEX_YAW) {
+			control = control * REG_TO_SIGNED(r_setup_scale_yaw) / Mixer::FIXED_ONE + REG_TO_SIGNED(r_setup_trim_yaw);
+		}
+	}
+
+	/* limit output */
+	if (control > Mixer::FIXED_ONE) {
+		control = Mixer::FIXED_ONE;
+
+	} else if (control < -Mixer::FIXED_ONE) {
+		control = -Mixer::FIXED_ONE;
+	}
+
+	if ((control_group == actuator_controls_s::GROUP_INDEX_ATTITUDE ||
+	     control_group == actuator_controls_s::GROUP_INDEX_ATTITUDE_ALTERNATE) &&
+	    control_index == actuator_controls_s::INDEX_THROTTLE) {
+
+		/* motor spinup phase - lock throttle to zero */
+		if ((pwm_limit.state == PWM_LIMIT_STATE_RAMP) || (should_arm_nothrottle && !should_arm)) {
+			control = 0;
+		}
+
+		/* only safety off, but not armed - set throttle as invalid */
+		if (should_arm_nothrottle && !should_arm) {
+			control = Mixer::FIXED_INVALID;
+		}
+	}
+
+	return 0;
+}
+
 /*
  * XXX error handling here should be more aggressive; currently it is
  * possible to get STATUS_FLAGS_MIXER_OK set even though the mixer has
@@ -527,6 +620,9 @@ mixer_handle_text_create_mixer()
 		}
 
 		mixer_text_length = resid;
+
+		/* evaluate the simple mixers in integer arithmetic, falls back to the mixer list without memory */
+		mixer_group.compile_fixed(mixer_callback_fixed);
 	}
 
 	mixer_update_pending = false;
@@ -41,6 +41,7 @@
 
 #include "definitions.hpp"
 
+#include <ecl/ulog/ulog_reader.h>
 #include <px4_module.h>
 #include <uORB/uORBTopics.h>
 #include <uORB/topics/ekf2_timestamps.h>
@@ -51,9 +52,12 @@ namespace px4
 /**
  * @class Replay
  * Parses an ULog file and replays it in 'real-time'. The timestamp of each replayed message is offset
- * to match the starting time of replay. It keeps a stream for each subscription to find the next message
- * to replay. This is necessary because data messages from different subscriptions don't need to be in
+ * to match the starting time of replay. The file is memory-mapped and indexed in a single pass at startup
+ * (see ULogReader): each subscription keeps a cursor into the data messages of its msg_id to find the next
+ * message to replay.
+ * This is necessary because data messages from different subscriptions don't need to be in
  * monotonic increasing order.
+ * For a parameter sweep, the log is replayed once per parameter variant, without parsing it again.
  */
 class Replay : public ModuleBase<Replay>
 {
@@ -135,6 +139,7 @@ protected:
 		bool ignored = false; ///< if true, it will not be considered for publication in the main loop
 
 		std::streampos next_read_pos;
+		size_t next_index = 0; ///< index of next_read_pos in _reader.dataOffsets(msg_id)
 		uint64_t next_timestamp; ///< timestamp of the file
 
 		CompatBase *compat = nullptr;
@@ -176,6 +181,11 @@ protected:
 	 */
 	virtual void onSubscriptionAdded(Subscription &sub, uint16_t msg_id) {}
 
+	/**
+	 * called when the start of a pass over the log was announced (replay_status), before any data is published
+	 */
+	virtual void onPassStarted() {}
+
 	/**
 	 * handle delay until topic can be published.
 	 * @param next_file_timestamp timestamp of next message to publish
@@ -188,38 +198,54 @@ protected:
 	 * handle the publication of a topic update
 	 * @return true if published, false otherwise
 	 */
-	virtual bool handleTopicUpdate(Subscription &sub, void *data, std::ifstream &replay_file);
+	virtual bool handleTopicUpdate(Subscription &sub, void *data);
 
 	/**
 	 * read a topic from the file (offset given by the subscription) into _read_buffer
 	 */
-	void readTopicDataToBuffer(const Subscription &sub, std::ifstream &replay_file);
+	void readTopicDataToBuffer(const Subscription &sub);
 
 	/**
-	 * Find next data message for this subscription, starting with the stored file offset.
-	 * Skip the first message, and if found, read the timestamp and store the new file offset.
-	 * This also takes care of new subscriptions and parameter updates. When reaching EOF,
+	 * Find next data message for this subscription in the index, starting after the stored file offset.
+	 * If found, read the timestamp and store the new file offset. When there are no more messages,
 	 * the subscription is set to invalid.
-	 * File seek position is arbitrary after this call.
-	 * @return false on file error
 	 */
-	bool nextDataMessage(std::ifstream &file, Subscription &subscription, int msg_id);
+	void nextDataMessage(Subscription &subscription, int msg_id);
+
+	/**
+	 * read the timestamp of a data message of a subscription
+	 * @param offset file offset of the message
+	 */
+	uint64_t readTimestamp(const Subscription &sub, uint64_t offset) const;
 
 	std::vector<Subscription> _subscriptions;
 	std::vector<uint8_t> _read_buffer;
 
+	ULogReader _reader; ///< memory-mapped and indexed replay file
+
+	uint32_t _pass = 0; ///< current pass over the log (parameter variant)
+
+	std::string _sweep_file; ///< parameter variants to replay the log with (empty: replay once)
+
 private:
+	/** parameter set of a sweep, applied on top of the log parameters and the user overrides */
+	struct ParamVariant {
+		std::string name;
+		std::vector<std::pair<std::string, double>> params;
+	};
+
+	std::vector<ParamVariant> _sweep_variants;
+	orb_advert_t _replay_status_pub = nullptr;
+
 	std::set<std::string> _overridden_params;
 	std::map<std::string, std::string> _file_formats; ///< all formats we read from the file
 
 	uint64_t _file_start_time;
 	uint64_t _replay_start_time;
-	std::streampos _data_section_start; ///< first ADD_LOGGED_MSG message
-
 	/** keep track of file position to avoid adding a subscription multiple times. */
 	std::streampos _subscription_file_pos = 0;
 
-	uint64_t _read_until_file_position = 1ULL << 60; ///< read limit if log contains appended data
+	size_t _next_additional_message = 0; ///< next entry of _reader.otherOffsets() to handle
 
 	bool readFileHeader(std::ifstream &file);
 
@@ -243,7 +269,7 @@ private:
 	bool readDefinitionsAndApplyParams(std::ifstream &file);
 
 	/**
-	 * Read and handle additional messages starting at current file position, while position < end_position.
+	 * Read and handle the indexed additional messages that were not handled yet, while position < end_position.
 	 * This handles dropout and parameter update messages.
 	 * We need to handle these separately, because they have no timestamp. We look at the file position instead.
 	 * @return false on file error
@@ -262,6 +288,29 @@ private:
 
 	void setUserParams(const char *filename);
 
+	/** set an int32 or float parameter from a value read from a text file */
+	static void setParam(const std::string &param_name, double value);
+
+	/**
+	 * Read the parameter variants of a sweep. Each variant starts with a line '[name]', followed by
+	 * lines '<param> <value>', as in the override file.
+	 * @return true on success
+	 */
+	bool readSweepFile(const char *filename);
+
+	/** apply the parameters of a variant, they are not overwritten by the log */
+	void applyVariant(const ParamVariant &variant);
+
+	/** undo applyVariant(): reset the parameters, so that they can be applied from the log again */
+	void resetVariant(const ParamVariant &variant);
+
+	/**
+	 * Replay the data section once, starting with an empty set of subscriptions
+	 * @param num_passes total number of passes, for replay_status
+	 * @return number of published messages
+	 */
+	uint32_t replayPass(std::ifstream &replay_file, uint32_t num_passes);
+
 	static char *_replay_file;
 };
 
@@ -277,6 +326,7 @@ protected:
 
 	void onEnterMainLoop() override;
 	void onExitMainLoop() override;
+	void onPassStarted() override;
 
 	uint64_t handleTopicDelay(uint64_t next_file_time, uint64_t timestamp_offset) override;
 
@@ -284,25 +334,24 @@ protected:
 	 * handle ekf2 topic publication in ekf2 replay mode
 	 * @param sub
 	 * @param data
-	 * @param replay_file file currently replayed (file seek position should be considered arbitrary after this call)
 	 * @return true if published, false otherwise
 	 */
-	bool handleTopicUpdate(Subscription &sub, void *data, std::ifstream &replay_file) override;
+	bool handleTopicUpdate(Subscription &sub, void *data) override;
 
 	void onSubscriptionAdded(Subscription &sub, uint16_t msg_id) override;
 
 private:
 
-	bool publishEkf2Topics(const ekf2_timestamps_s &ekf2_timestamps, std::ifstream &replay_file);
+	bool publishEkf2Topics(const ekf2_timestamps_s &ekf2_timestamps);
 
 	/**
-	 * find the next message for a subscription that matches a given timestamp and publish it
+	 * find the next message for a subscription that matches a given timestamp (binary search in the index)
+	 * and publish it
 	 * @param timestamp in 0.1 ms
 	 * @param msg_id
-	 * @param replay_file file currently replayed (file seek position should be considered arbitrary after this call)
 	 * @return true if timestamp found and published
 	 */
-	bool findTimestampAndPublish(uint64_t timestamp, uint16_t msg_id, std::ifstream &replay_file);
+	bool findTimestampAndPublish(uint64_t timestamp, uint16_t msg_id);
 
 	int _vehicle_attitude_sub = -1;
 
@@ -46,6 +46,7 @@
 #include <px4_tasks.h>
 #include <px4_time.h>
 
+#include <algorithm>
 #include <cstring>
 #include <float.h>
 #include <fstream>
@@ -56,6 +57,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string>
+#include <unistd.h>
 
 #include <logger/messages.h>
 
@@ -63,6 +65,7 @@
 #include <uORB/topics/airspeed.h>
 #include <uORB/topics/distance_sensor.h>
 #include <uORB/topics/optical_flow.h>
+#include <uORB/topics/replay_status.h>
 #include <uORB/topics/sensor_combined.h>
 #include <uORB/topics/vehicle_status.h>
 #include <uORB/topics/vehicle_gps_position.h>
@@ -144,22 +147,93 @@ void Replay::setUserParams(const char *filename)
 		mystrstream >> param_name;
 		mystrstream >> value_string;
 
-		double param_value_double = stod(value_string);
-
-		param_t handle = param_find(param_name.c_str());
-		param_type_t param_format = param_type(handle);
 		_overridden_params.insert(param_name);
+		setParam(param_name, stod(value_string));
+	}
+}
+
+void Replay::setParam(const std::string &param_name, double value)
+{
+	param_t handle = param_find(param_name.c_str());
+	param_type_t param_format = param_type(handle);
+
+	if (param_format == PARAM_TYPE_INT32) {
+		int32_t value_int = (int32_t)value;
+		param_set(handle, (const void *)&value_int);
+
+	} else if (param_format == PARAM_TYPE_FLOAT) {
+		float value_float = (float)value;
+		param_set(handle, (const void *)&value_float);
+	}
+}
+
+bool Replay::readSweepFile(const char *filename)
+{
+	string line, param_name, value_string;
+	ifstream myfile(filename);
 
-		if (param_format == PARAM_TYPE_INT32) {
-			int32_t value = 0;
-			value = (int32_t)param_value_double;
-			param_set(handle, (const void *)&value);
+	if (!myfile.is_open()) {
+		PX4_ERR("Failed to open sweep file %s", filename);
+		return false;
+	}
 
-		} else if (param_format == PARAM_TYPE_FLOAT) {
-			float value = 0;
-			value = (float)param_value_double;
-			param_set(handle, (const void *)&value);
+	while (getline(myfile, line)) {
+		if (line.empty() || line[0] == '#') {
+			continue;
 		}
+
+		if (line[0] == '[') {
+			size_t end = line.find(']');
+
+			if (end == string::npos) {
+				PX4_ERR("invalid variant name: %s", line.c_str());
+				return false;
+			}
+
+			_sweep_variants.push_back(ParamVariant());
+			_sweep_variants.back().name = line.substr(1, end - 1);
+			continue;
+		}
+
+		if (_sweep_variants.empty()) {
+			PX4_ERR("parameter outside of a variant: %s", line.c_str());
+			return false;
+		}
+
+		istringstream mystrstream(line);
+		mystrstream >> param_name;
+		mystrstream >> value_string;
+
+		if (param_find(param_name.c_str()) == PARAM_INVALID) {
+			PX4_ERR("unknown parameter %s in variant %s", param_name.c_str(), _sweep_variants.back().name.c_str());
+			return false;
+		}
+
+		_sweep_variants.back().params.push_back(std::make_pair(param_name, stod(value_string)));
+	}
+
+	if (_sweep_variants.empty()) {
+		PX4_ERR("no variants in sweep file %s", filename);
+		return false;
+	}
+
+	PX4_INFO("Parameter sweep with %zu variants from %s", _sweep_variants.size(), filename);
+	return true;
+}
+
+void Replay::applyVariant(const ParamVariant &variant)
+{
+	for (const auto &param : variant.params) {
+		_overridden_params.insert(param.first);
+		setParam(param.first, param.second);
+	}
+}
+
+void Replay::resetVariant(const ParamVariant &variant)
+{
+	for (const auto &param : variant.params) {
+		_overridden_params.erase(param.first);
+		param_reset(param_find(param.first.c_str()));
 	}
 }
 
@@ -223,7 +297,6 @@ bool Replay::readFileDefinitions(std::ifstream &file)
 			break;
 
 		case (int)ULogMessageType::ADD_LOGGED_MSG:
-			_data_section_start = file.tellg() - (streamoff)ULOG_MSG_HEADER_LEN;
 			return true;
 
 		case (int)ULogMessageType::INFO: //skip
@@ -279,9 +352,9 @@ bool Replay::readFlagBits(std::ifstream &file, uint16_t msg_size)
 		memcpy(appended_offsets, message + 16, sizeof(appended_offsets));
 
 		if (appended_offsets[0] > 0) {
-			// the appended data is currently only used for hardfault dumps, so it's safe to ignore it.
+			// the appended data is currently only used for hardfault dumps, so it's safe to ignore it
+			// (the index of the data section stops there).
 			PX4_INFO("Log contains appended data. Replay will ignore this data");
-			_read_until_file_position = appended_offsets[0];
 		}
 	}
 
@@ -404,14 +477,8 @@ bool Replay::readAndAddSubscription(std::ifstream &file, uint16_t msg_size)
 	}
 
 	//find first data message (and the timestamp)
-	streampos cur_pos = file.tellg();
 	subscription.next_read_pos = this_message_pos; //this will be skipped
-
-	if (!nextDataMessage(file, subscription, msg_id)) {
-		return false;
-	}
-
-	file.seekg(cur_pos);
+	nextDataMessage(subscription, msg_id);
 
 	if (!subscription.orb_meta) {
 		//no message found. This is not a fatal error
@@ -467,7 +534,13 @@ bool Replay::readAndHandleAdditionalMessages(std::ifstream &file, std::streampos
 {
 	ulog_message_header_s message_header;
 
-	while (file.tellg() < end_position) {
+	const std::vector<uint64_t> &offsets = _reader.otherOffsets();
+
+	for (; _next_additional_message < offsets.size() &&
+	     offsets[_next_additional_message] < (uint64_t)(streamoff)end_position;
+	     ++_next_additional_message) {
+
+		file.seekg(offsets[_next_additional_message]);
 		file.read((char *)&message_header, ULOG_MSG_HEADER_LEN);
 
 		if (!file) {
@@ -486,8 +559,7 @@ bool Replay::readAndHandleAdditionalMessages(std::ifstream &file, std::streampos
 			readDropout(file, message_header.msg_size);
 			break;
 
-		default: //skip all others
-			file.seekg(message_header.msg_size, ios::cur);
+		default: //only the types above are indexed
 			break;
 		}
 	}
@@ -545,88 +617,52 @@ bool Replay::readDropout(std::ifstream &file, uint16_t msg_size)
 	return file.good();
 }
 
-bool Replay::nextDataMessage(std::ifstream &file, Subscription &subscription, int msg_id)
+void Replay::nextDataMessage(Subscription &subscription, int msg_id)
 {
-	ulog_message_header_s message_header;
-	file.seekg(subscription.next_read_pos);
-	//ignore the first message (it's data we already read)
-	file.read((char *)&message_header, ULOG_MSG_HEADER_LEN);
+	const std::vector<uint64_t> &offsets = _reader.dataOffsets(msg_id);
+	const uint64_t cur_pos = (streamoff)subscription.next_read_pos;
+	size_t index;
 
-	if (file) {
-		file.seekg(message_header.msg_size, ios::cur);
-	}
+	//skip the current message (it's data we already read)
+	if (subscription.next_index < offsets.size() && offsets[subscription.next_index] == cur_pos) {
+		index = subscription.next_index + 1;
 
-	uint16_t file_msg_id;
-	bool done = false;
+	} else {
+		index = std::upper_bound(offsets.begin(), offsets.end(), cur_pos) - offsets.begin();
+	}
 
-	while (file && !done) {
-		streampos cur_pos = file.tellg();
-		file.read((char *)&message_header, ULOG_MSG_HEADER_LEN);
+	for (; index < offsets.size(); ++index) {
+		ulog_message_header_s message_header;
+		memcpy(&message_header, _reader.fileData() + offsets[index], ULOG_MSG_HEADER_LEN);
 
-		if (!file) {
-			break;
+		if (message_header.msg_size == subscription.orb_meta->o_size_no_padding + 2) {
+			subscription.next_index = index;
+			subscription.next_read_pos = offsets[index];
+			subscription.next_timestamp = readTimestamp(subscription, offsets[index]);
+			return;
 		}
 
-		if (((streamoff)cur_pos) + ULOG_MSG_HEADER_LEN + message_header.msg_size > _read_until_file_position) {
-			file.setstate(std::ios::eofbit);
-			break;
-		}
-
-		switch (message_header.msg_type) {
-		case (int)ULogMessageType::ADD_LOGGED_MSG:
-			readAndAddSubscription(file, message_header.msg_size);
-			break;
-
-		case (int)ULogMessageType::DATA:
-			file.read((char *)&file_msg_id, sizeof(file_msg_id));
-
-			if (file) {
-				if (msg_id == file_msg_id) {
-					if (message_header.msg_size == subscription.orb_meta->o_size_no_padding + 2) {
-						subscription.next_read_pos = cur_pos;
-						file.seekg(subscription.timestamp_offset, ios::cur);
-						file.read((char *)&subscription.next_timestamp, sizeof(subscription.next_timestamp));
-						done = true;
-
-					} else { //sanity check failed!
-						PX4_ERR("data message %s has wrong size %i (expected %i). Skipping",
-							subscription.orb_meta->o_name, message_header.msg_size,
-							subscription.orb_meta->o_size_no_padding + 2);
-						file.seekg(message_header.msg_size - sizeof(file_msg_id), ios::cur);
-					}
-
-				} else { //not the one we are looking for
-					file.seekg(message_header.msg_size - sizeof(file_msg_id), ios::cur);
-				}
-			}
-
-			break;
+		//sanity check failed!
+		PX4_ERR("data message %s has wrong size %i (expected %i). Skipping",
+			subscription.orb_meta->o_name, message_header.msg_size,
+			subscription.orb_meta->o_size_no_padding + 2);
+	}
 
-		case (int)ULogMessageType::REMOVE_LOGGED_MSG: //skip these
-		case (int)ULogMessageType::PARAMETER:
-		case (int)ULogMessageType::DROPOUT:
-		case (int)ULogMessageType::INFO:
-		case (int)ULogMessageType::INFO_MULTIPLE:
-		case (int)ULogMessageType::SYNC:
-		case (int)ULogMessageType::LOGGING:
-			file.seekg(message_header.msg_size, ios::cur);
-			break;
+	//no more data messages for this subscription
+	subscription.orb_meta = nullptr;
+}
 
-		default:
-			//this really should not happen
-			PX4_ERR("unknown log message type %i, size %i (offset %i)",
-				(int)message_header.msg_type, (int)message_header.msg_size, (int)file.tellg());
-			file.seekg(message_header.msg_size, ios::cur);
-			break;
-		}
-	}
+uint64_t Replay::readTimestamp(const Subscription &sub, uint64_t offset) const
+{
+	ulog_message_header_s message_header;
+	memcpy(&message_header, _reader.fileData() + offset, ULOG_MSG_HEADER_LEN);
+	uint64_t timestamp = 0;
 
-	if (file.eof()) { //no more data messages for this subscription
-		subscription.orb_meta = nullptr;
-		file.clear();
+	if (message_header.msg_size >= 2 + sub.timestamp_offset + sizeof(timestamp)) {
+		memcpy(&timestamp, _reader.fileData() + offset + ULOG_MSG_HEADER_LEN + 2 + sub.timestamp_offset, sizeof(timestamp));
 	}
 
-	return file.good();
+	return timestamp;
 }
 
 const orb_metadata *Replay::findTopic(const std::string &name)
@@ -734,21 +770,98 @@ void Replay::run()
 		return;
 	}
 
+	if (!_reader.open(_replay_file)) {
+		PX4_ERR("Failed to index replay file: %s", _reader.error().c_str());
+		return;
+	}
+
+	PX4_INFO("Indexed %u topics", (unsigned)_reader.subscriptions().size());
+
+	if (!_sweep_file.empty() && !readSweepFile(_sweep_file.c_str())) {
+		return;
+	}
+
+	const uint32_t num_passes = _sweep_variants.empty() ? 1 : _sweep_variants.size();
+
+	for (_pass = 0; _pass < num_passes && !should_exit(); ++_pass) {
+
+		if (_pass > 0) {
+			//start from the parameters of the log again
+			replay_file.clear();
+
+			if (!readDefinitionsAndApplyParams(replay_file)) {
+				break;
+			}
+		}
+
+		if (!_sweep_variants.empty()) {
+			PX4_INFO("Replaying variant %u/%u: %s", _pass + 1, num_passes, _sweep_variants[_pass].name.c_str());
+			applyVariant(_sweep_variants[_pass]);
+		}
+
+		const hrt_abstime pass_start = hrt_absolute_time();
+		uint32_t nr_published_messages = replayPass(replay_file, num_passes);
+
+		if (!should_exit()) {
+			PX4_INFO("Replay done (published %u msgs, %.3lf s)", nr_published_messages,
+				 (double)hrt_elapsed_time(&pass_start) / 1.e6);
+
+			//TODO: should we close the log file & exit (optionally, by adding a parameter -q) ?
+		}
+
+		if (!_sweep_variants.empty()) {
+			resetVariant(_sweep_variants[_pass]);
+		}
+	}
+
+	if (_replay_status_pub) {
+		orb_unadvertise(_replay_status_pub);
+		_replay_status_pub = nullptr;
+	}
+}
+
+uint32_t Replay::replayPass(std::ifstream &replay_file, uint32_t num_passes)
+{
+	_subscriptions.clear();
+	_subscription_file_pos = 0;
+	_next_additional_message = 0;
+
 	onEnterMainLoop();
 
+	replay_status_s replay_status = {};
+	replay_status.timestamp = hrt_absolute_time();
+	replay_status.pass = _pass;
+	replay_status.num_passes = num_passes;
+
+	if (_replay_status_pub == nullptr) {
+		_replay_status_pub = orb_advertise(ORB_ID(replay_status), &replay_status);
+
+	} else {
+		orb_publish(ORB_ID(replay_status), _replay_status_pub, &replay_status);
+	}
+
+	onPassStarted();
+
 	_replay_start_time = hrt_absolute_time();
 
 	PX4_INFO("Replay in progress...");
 
-	ulog_message_header_s message_header;
-	replay_file.seekg(_data_section_start);
+	//add all subscriptions, in file order
+	for (uint64_t offset : _reader.otherOffsets()) {
+		ulog_message_header_s message_header;
+		memcpy(&message_header, _reader.fileData() + offset, ULOG_MSG_HEADER_LEN);
 
-	//we know the next message must be an ADD_LOGGED_MSG
-	replay_file.read((char *)&message_header, ULOG_MSG_HEADER_LEN);
+		if (message_header.msg_type != (int)ULogMessageType::ADD_LOGGED_MSG) {
+			continue;
+		}
 
-	if (!readAndAddSubscription(replay_file, message_header.msg_size)) {
-		PX4_ERR("Failed to read subscription");
-		return;
+		replay_file.seekg(offset + ULOG_MSG_HEADER_LEN);
+
+		if (!readAndAddSubscription(replay_file, message_header.msg_size)) {
+			PX4_ERR("Failed to read subscription");
+			onExitMainLoop();
+			return 0;
+		}
 	}
 
 
@@ -756,7 +869,6 @@ void Replay::run()
 	//the current replay time
 	const uint64_t timestamp_offset = _replay_start_time - _file_start_time;
 	uint32_t nr_published_messages = 0;
-	streampos last_additional_message_pos = _data_section_start;
 
 	while (!should_exit() && replay_file) {
 
@@ -784,30 +896,27 @@ void Replay::run()
 
 		if (next_file_time == 0) {
 			//someone didn't set the timestamp properly. Consider the message invalid
-			nextDataMessage(replay_file, sub, next_msg_id);
+			nextDataMessage(sub, next_msg_id);
 			continue;
 		}
 
 
 		//handle additional messages between last and next published data
-		replay_file.seekg(last_additional_message_pos);
-		streampos next_additional_message_pos = sub.next_read_pos;
-		readAndHandleAdditionalMessages(replay_file, next_additional_message_pos);
-		last_additional_message_pos = next_additional_message_pos;
+		readAndHandleAdditionalMessages(replay_file, sub.next_read_pos);
 
 
 		const uint64_t publish_timestamp = handleTopicDelay(next_file_time, timestamp_offset);
 
 
 		//It's time to publish
-		readTopicDataToBuffer(sub, replay_file);
+		readTopicDataToBuffer(sub);
 		memcpy(_read_buffer.data() + sub.timestamp_offset, &publish_timestamp, sizeof(uint64_t)); //adjust the timestamp
 
-		if (handleTopicUpdate(sub, _read_buffer.data(), replay_file)) {
+		if (handleTopicUpdate(sub, _read_buffer.data())) {
 			++nr_published_messages;
 		}
 
-		nextDataMessage(replay_file, sub, next_msg_id);
+		nextDataMessage(sub, next_msg_id);
 
 		//TODO: output status (eg. every sec), including total duration...
 	}
@@ -824,26 +933,21 @@ void Replay::run()
 		}
 	}
 
-	if (!should_exit()) {
-		PX4_INFO("Replay done (published %u msgs, %.3lf s)", nr_published_messages,
-			 (double)hrt_elapsed_time(&_replay_start_time) / 1.e6);
-
-		//TODO: should we close the log file & exit (optionally, by adding a parameter -q) ?
-	}
-
 	onExitMainLoop();
+
+	return nr_published_messages;
 }
 
-void Replay::readTopicDataToBuffer(const Subscription &sub, std::ifstream &replay_file)
+void Replay::readTopicDataToBuffer(const Subscription &sub)
 {
 	const size_t msg_read_size = sub.orb_meta->o_size_no_padding;
 	const size_t msg_write_size = sub.orb_meta->o_size;
 	_read_buffer.reserve(msg_write_size);
-	replay_file.seekg(sub.next_read_pos + (streamoff)(ULOG_MSG_HEADER_LEN + 2)); //skip header & msg id
-	replay_file.read((char *)_read_buffer.data(), msg_read_size);
+	//skip header & msg id
+	memcpy(_read_buffer.data(), _reader.fileData() + (streamoff)sub.next_read_pos + ULOG_MSG_HEADER_LEN + 2, msg_read_size);
 }
 
-bool Replay::handleTopicUpdate(Subscription &sub, void *data, std::ifstream &replay_file)
+bool Replay::handleTopicUpdate(Subscription &sub, void *data)
 {
 	return publishTopic(sub, data);
 }
@@ -909,28 +1013,38 @@ bool Replay::publishTopic(Subscription &sub, void *data)
 	return published;
 }
 
-bool ReplayEkf2::handleTopicUpdate(Subscription &sub, void *data, std::ifstream &replay_file)
+bool ReplayEkf2::handleTopicUpdate(Subscription &sub, void *data)
 {
 	if (sub.orb_meta == ORB_ID(ekf2_timestamps)) {
 		ekf2_timestamps_s ekf2_timestamps;
 		memcpy(&ekf2_timestamps, data, sub.orb_meta->o_size);
 
-		if (!publishEkf2Topics(ekf2_timestamps, replay_file)) {
+		if (!publishEkf2Topics(ekf2_timestamps)) {
 			return false;
 		}
 
-		px4_pollfd_struct_t fds[1];
-		fds[0].fd = _vehicle_attitude_sub;
-		fds[0].events = POLLIN;
-		// wait for a response from the estimator
-		int pret = px4_poll(fds, 1, 1000);
-
 		// introduce some breaks to make sure the logger can keep up
 		if (++_topic_counter == 50) {
 			usleep(1000);
 			_topic_counter = 0;
 		}
 
+		// in direct replay mode, the estimator already ran within the publication of sensor_combined
+		bool updated = false;
+		orb_check(_vehicle_attitude_sub, &updated);
+
+		if (updated) {
+			vehicle_attitude_s att;
+			orb_copy(ORB_ID(vehicle_attitude), _vehicle_attitude_sub, &att);
+			return true;
+		}
+
+		px4_pollfd_struct_t fds[1];
+		fds[0].fd = _vehicle_attitude_sub;
+		fds[0].events = POLLIN;
+		// wait for a response from the estimator
+		int pret = px4_poll(fds, 1, 1000);
+
 		if (pret == 0) {
 			PX4_WARN("poll timeout");
 
@@ -984,13 +1098,13 @@ void ReplayEkf2::onSubscriptionAdded(Subscription &sub, uint16_t msg_id)
 		      && sub.orb_meta != ORB_ID(vehicle_land_detected);
 }
 
-bool ReplayEkf2::publishEkf2Topics(const ekf2_timestamps_s &ekf2_timestamps, std::ifstream &replay_file)
+bool ReplayEkf2::publishEkf2Topics(const ekf2_timestamps_s &ekf2_timestamps)
 {
 	auto handle_sensor_publication = [&](int16_t timestamp_relative, uint16_t msg_id) {
 		if (timestamp_relative != ekf2_timestamps_s::RELATIVE_TIMESTAMP_INVALID) {
 			// timestamp_relative is already given in 0.1 ms
 			uint64_t t = timestamp_relative + ekf2_timestamps.timestamp / 100; // in 0.1 ms
-			findTimestampAndPublish(t, msg_id, replay_file);
+			findTimestampAndPublish(t, msg_id);
 		}
 	};
 	handle_sensor_publication(ekf2_timestamps.gps_timestamp_rel, _gps_msg_id); // gps
@@ -1003,7 +1117,7 @@ bool ReplayEkf2::publishEkf2Topics(const ekf2_timestamps_s &ekf2_timestamps, std
 				  _vehicle_vision_attitude_msg_id); // vision attitude
 
 	// sensor_combined: publish last because ekf2 is polling on this
-	if (!findTimestampAndPublish(ekf2_timestamps.timestamp / 100, _sensors_combined_msg_id, replay_file)) {
+	if (!findTimestampAndPublish(ekf2_timestamps.timestamp / 100, _sensors_combined_msg_id)) {
 		if (_sensors_combined_msg_id == msg_id_invalid) {
 			// subscription not found yet or sensor_combined not contained in log
 			return false;
@@ -1013,7 +1127,7 @@ bool ReplayEkf2::publishEkf2Topics(const ekf2_timestamps_s &ekf2_timestamps, std
 
 		} else {
 			// we should publish a topic, just publish the same again
-			readTopicDataToBuffer(_subscriptions[_sensors_combined_msg_id], replay_file);
+			readTopicDataToBuffer(_subscriptions[_sensors_combined_msg_id]);
 			publishTopic(_subscriptions[_sensors_combined_msg_id], _read_buffer.data());
 		}
 	}
@@ -1022,7 +1136,7 @@ bool ReplayEkf2::publishEkf2Topics(const ekf2_timestamps_s &ekf2_timestamps, std
 
 }
 
-bool ReplayEkf2::findTimestampAndPublish(uint64_t timestamp, uint16_t msg_id, std::ifstream &replay_file)
+bool ReplayEkf2::findTimestampAndPublish(uint64_t timestamp, uint16_t msg_id)
 {
 	if (msg_id == msg_id_invalid) {
 		// could happen if a topic is not logged
@@ -1031,8 +1145,17 @@ bool ReplayEkf2::findTimestampAndPublish(uint64_t timestamp, uint16_t msg_id, st
 
 	Subscription &sub = _subscriptions[msg_id];
 
-	while (sub.next_timestamp / 100 < timestamp && sub.orb_meta) {
-		nextDataMessage(replay_file, sub, msg_id);
+	if (sub.orb_meta && sub.next_timestamp / 100 < timestamp) {
+		// the timestamps of a topic are increasing: binary search for the first message not older than timestamp
+		const std::vector<uint64_t> &offsets = _reader.dataOffsets(msg_id);
+		auto found = std::partition_point(offsets.begin() + sub.next_index, offsets.end(), [&](uint64_t offset) {
+			return readTimestamp(sub, offset) / 100 < timestamp;
+		});
+
+		// continue from the message before, so that messages with a wrong size are skipped
+		sub.next_index = found - offsets.begin() - 1;
+		sub.next_read_pos = offsets[sub.next_index];
+		nextDataMessage(sub, msg_id);
 	}
 
 	if (!sub.orb_meta) { // no messages anymore
@@ -1047,7 +1170,7 @@ bool ReplayEkf2::findTimestampAndPublish(uint64_t timestamp, uint16_t msg_id, st
 		return false;
 	}
 
-	readTopicDataToBuffer(sub, replay_file);
+	readTopicDataToBuffer(sub);
 	publishTopic(sub, _read_buffer.data());
 	return true;
 }
@@ -1055,6 +1178,31 @@ bool ReplayEkf2::findTimestampAndPublish(uint64_t timestamp, uint16_t msg_id, st
 void ReplayEkf2::onEnterMainLoop()
 {
 	_vehicle_attitude_sub = orb_subscribe(ORB_ID(vehicle_attitude));
+
+	if (_pass > 0) {
+		// make sure the logger wrote the end of the previous pass before it starts a new file
+		usleep(100000);
+	}
+}
+
+void ReplayEkf2::onPassStarted()
+{
+	if (_pass == 0) {
+		return;
+	}
+
+	// the estimator restarts for the new pass: wait until it's ready (it publishes an attitude)
+	px4_pollfd_struct_t fds[1];
+	fds[0].fd = _vehicle_attitude_sub;
+	fds[0].events = POLLIN;
+
+	if (px4_poll(fds, 1, 5000) > 0 && (fds[0].revents & POLLIN)) {
+		vehicle_attitude_s att;
+		orb_copy(ORB_ID(vehicle_attitude), _vehicle_attitude_sub, &att);
+
+	} else {
+		PX4_WARN("estimator did not restart");
+	}
 }
 
 void ReplayEkf2::onExitMainLoop()
@@ -1118,7 +1266,8 @@ This module is used to replay ULog files.
 There are 2 environment variables used for configuration: `replay`, which must be set to an ULog file name - it's
 the log file to be replayed. The second is the mode, specified via `replay_mode`:
 - `replay_mode=ekf2`: specific EKF2 replay mode. It can only be used with the ekf2 module, but allows the replay
-  to run as fast as possible.
+  to run as fast as possible. When ekf2 is started in direct replay mode (`ekf2 start -d`), the filter updates run
+  synchronously in the replay thread, without a thread wakeup per sample.
 - Generic otherwise: this can be used to replay any module(s), but the replay will be done with the same speed as the
   log was recorded.
 
@@ -1126,6 +1275,11 @@ The module is typically used together with uORB publisher rules, to specify whic
 The replay module will just publish all messages that are found in the log. It also applies the parameters from
 the log.
 
+In ekf2 mode, the optional variable `replay_sweep` names a file with parameter variants, to replay the log once per
+variant without restarting: ekf2 is restarted for every variant and the logger writes one log per variant.
+Each variant starts with a line `[name]`, followed by lines `<param> <value>`, which override the parameters
+of the log. The variants can be split over several files, to replay them in parallel processes.
+
 The replay procedure is documented on the [System-wide Replay](https://dev.px4.io/en/debug/system_wide_replay.html)
 page.
 )DESCR_STR");
@@ -1150,10 +1304,11 @@ int Replay::task_spawn(int argc, char *argv[])
 		return -1;
 	}
 
+	// in direct replay mode, ekf2 runs in this task
 	_task_id = px4_task_spawn_cmd("replay",
 				      SCHED_DEFAULT,
 				      SCHED_PRIORITY_MAX - 5,
-				      4000,
+				      4000 + 6000,
 				      (px4_main_t)&run_trampoline,
 				      (char *const *)argv);
 
@@ -1199,13 +1354,23 @@ Replay *Replay::instantiate(int argc, char *argv[])
 	// check the replay mode
 	const char *replay_mode = getenv(replay::ENV_MODE);
 
+	const char *sweep_file = getenv(replay::ENV_SWEEP);
+
 	Replay *instance = nullptr;
 	if (replay_mode && strcmp(replay_mode, "ekf2") == 0) {
 		PX4_INFO("Ekf2 replay mode");
 		instance = new ReplayEkf2();
 
+		if (instance && sweep_file) {
+			instance->_sweep_file = sweep_file;
+		}
+
 	} else {
 		instance = new Replay();
+
+		if (sweep_file) {
+			PX4_WARN("parameter sweep (%s) requires %s=ekf2, ignoring it", replay::ENV_SWEEP, replay::ENV_MODE);
+		}
 	}
 
 	return instance;
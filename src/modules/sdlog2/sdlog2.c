@@ -152,6 +152,7 @@ static int32_t _utc_offset = 0;
 #endif
 static const char *mountpoint = MOUNTPOINT;
 static const char *log_root = MOUNTPOINT "/log";
+static const char *log_index = MOUNTPOINT "/log/logindex.txt";
 static orb_advert_t mavlink_log_pub = NULL;
 struct logbuffer_s lb;
 
@@ -730,6 +731,9 @@ void sdlog2_start_log()
 		return;
 	}
 
+	/* the log index (maintained by the logger) does not include our logs: have it rebuilt */
+	unlink(log_index);
+
 	/* initialize statistics counter */
 	log_bytes_written = 0;
 	start_time = hrt_absolute_time();
@@ -152,6 +152,9 @@ int initialize_parameter_handles(ParameterHandles &parameter_handles)
 	parameter_handles.board_offset[1] = param_find("SENS_BOARD_Y_OFF");
 	parameter_handles.board_offset[2] = param_find("SENS_BOARD_Z_OFF");
 
+	/* the per IMU data is only needed by additional EKF instances */
+	parameter_handles.ekf2_multi_inst = param_find("EKF2_MULTI_INST");
+
 	/* Barometer QNH */
 	parameter_handles.baro_qnh = param_find("SENS_BARO_QNH");
 
@@ -487,6 +490,10 @@ int update_parameters(const ParameterHandles &parameter_handles, Parameters &par
 	param_get(parameter_handles.board_offset[1], &(parameters.board_offset[1]));
 	param_get(parameter_handles.board_offset[2], &(parameters.board_offset[2]));
 
+	if (param_get(parameter_handles.ekf2_multi_inst, &(parameters.ekf2_multi_inst)) != OK) {
+		parameters.ekf2_multi_inst = 1;
+	}
+
 	param_get(parameter_handles.baro_qnh, &(parameters.baro_qnh));
 
 	param_get(parameter_handles.vibe_thresh, &parameters.vibration_warning_threshold);
@@ -70,6 +70,8 @@ struct Parameters {
 
 	float board_offset[3];
 
+	int32_t ekf2_multi_inst; /**< number of EKF instances, vehicle_imu is only published for more than one */
+
 	int32_t rc_map_roll;
 	int32_t rc_map_pitch;
 	int32_t rc_map_yaw;
@@ -226,6 +228,8 @@ struct ParameterHandles {
 
 	param_t board_offset[3];
 
+	param_t ekf2_multi_inst;
+
 	param_t baro_qnh;
 
 	param_t vibe_thresh; /**< vibration threshold */
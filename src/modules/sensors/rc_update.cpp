@@ -118,6 +118,39 @@ void RCUpdate::update_rc_functions()
 		_rc.function[rc_channels_s::RC_CHANNELS_FUNCTION_PARAM_1 + i] = _parameters.rc_map_param[i] - 1;
 	}
 
+	/* channel checked for the failsafe value: if not 0, RC_MAP_FAILS is the channel number */
+	if (_parameters.rc_map_failsafe > 0) {
+		_failsafe_channel = _parameters.rc_map_failsafe - 1;
+
+	} else {
+		_failsafe_channel = _rc.function[_parameters.rc_map_failsafe];
+	}
+
+	if (_failsafe_channel >= (int)RC_MAX_CHAN_COUNT || _parameters.rc_fails_thr <= 0) {
+		_failsafe_channel = -1;
+	}
+
+	/* precompute the channel scaling, so that rc_poll() does not divide per channel and frame */
+	for (unsigned i = 0; i < RC_MAX_CHAN_COUNT; i++) {
+		ChannelScaling &scaling = _channel_scaling[i];
+
+		scaling.min = _parameters.min[i];
+		scaling.max = _parameters.max[i];
+		scaling.upper_threshold = _parameters.trim[i] + _parameters.dz[i];
+		scaling.lower_threshold = _parameters.trim[i] - _parameters.dz[i];
+		scaling.upper_scale = _parameters.rev[i] / (_parameters.max[i] - _parameters.trim[i] - _parameters.dz[i]);
+		scaling.lower_scale = _parameters.rev[i] / (_parameters.trim[i] - _parameters.min[i] - _parameters.dz[i]);
+
+		/* handle any parameter-induced blowups */
+		if (!PX4_ISFINITE(scaling.upper_scale)) {
+			scaling.upper_scale = 0.0f;
+		}
+
+		if (!PX4_ISFINITE(scaling.lower_scale)) {
+			scaling.lower_scale = 0.0f;
+		}
+	}
+
 	/* update the RC low pass filter frequencies */
 	_filter_roll.set_cutoff_frequency(_parameters.rc_flt_smp_rate, _parameters.rc_flt_cutoff);
 	_filter_pitch.set_cutoff_frequency(_parameters.rc_flt_smp_rate, _parameters.rc_flt_cutoff);
@@ -273,13 +306,9 @@ RCUpdate::rc_poll(const ParameterHandles &parameter_handles)
 			signal_lost = false;
 
 			/* check failsafe */
-			int8_t fs_ch = _rc.function[_parameters.rc_map_failsafe]; // get channel mapped to throttle
-
-			if (_parameters.rc_map_failsafe > 0) { // if not 0, use channel number instead of rc.function mapping
-				fs_ch = _parameters.rc_map_failsafe - 1;
-			}
+			const int8_t fs_ch = _failsafe_channel;
 
-			if (_parameters.rc_fails_thr > 0 && fs_ch >= 0) {
+			if (fs_ch >= 0) {
 				/* failsafe configured */
 				if ((_parameters.rc_fails_thr < _parameters.min[fs_ch] && rc_input.values[fs_ch] < _parameters.rc_fails_thr) ||
 				    (_parameters.rc_fails_thr > _parameters.max[fs_ch] && rc_input.values[fs_ch] > _parameters.rc_fails_thr)) {
@@ -297,16 +326,18 @@ RCUpdate::rc_poll(const ParameterHandles &parameter_handles)
 
 		/* read out and scale values from raw message even if signal is invalid */
 		for (unsigned int i = 0; i < channel_limit; i++) {
+			const ChannelScaling &scaling = _channel_scaling[i];
+			float value = rc_input.values[i];
 
 			/*
 			 * 1) Constrain to min/max values, as later processing depends on bounds.
 			 */
-			if (rc_input.values[i] < _parameters.min[i]) {
-				rc_input.values[i] = _parameters.min[i];
+			if (value < scaling.min) {
+				value = scaling.min;
 			}
 
-			if (rc_input.values[i] > _parameters.max[i]) {
-				rc_input.values[i] = _parameters.max[i];
+			if (value > scaling.max) {
+				value = scaling.max;
 			}
 
 			/*
@@ -319,31 +350,22 @@ RCUpdate::rc_poll(const ParameterHandles &parameter_handles)
 			 * If center (trim) == min, scale to 0..1, if center (trim) == max,
 			 * scale to -1..0.
 			 *
-			 * As the min and max bounds were enforced in step 1), division by zero
-			 * cannot occur, as for the case of center == min or center == max the if
-			 * statement is mutually exclusive with the arithmetic NaN case.
+			 * As the min and max bounds were enforced in step 1), the scale of a range
+			 * with zero width (center == min or center == max) is never used.
+			 * The reverse factor is part of the precomputed scales.
 			 *
 			 * DO NOT REMOVE OR ALTER STEP 1!
 			 */
-			if (rc_input.values[i] > (_parameters.trim[i] + _parameters.dz[i])) {
-				_rc.channels[i] = (rc_input.values[i] - _parameters.trim[i] - _parameters.dz[i]) / (float)(
-							  _parameters.max[i] - _parameters.trim[i] - _parameters.dz[i]);
+			if (value > scaling.upper_threshold) {
+				_rc.channels[i] = (value - scaling.upper_threshold) * scaling.upper_scale;
 
-			} else if (rc_input.values[i] < (_parameters.trim[i] - _parameters.dz[i])) {
-				_rc.channels[i] = (rc_input.values[i] - _parameters.trim[i] + _parameters.dz[i]) / (float)(
-							  _parameters.trim[i] - _parameters.min[i] - _parameters.dz[i]);
+			} else if (value < scaling.lower_threshold) {
+				_rc.channels[i] = (value - scaling.lower_threshold) * scaling.lower_scale;
 
 			} else {
 				/* in the configured dead zone, output zero */
 				_rc.channels[i] = 0.0f;
 			}
-
-			_rc.channels[i] *= _parameters.rev[i];
-
-			/* handle any parameter-induced blowups */
-			if (!PX4_ISFINITE(_rc.channels[i])) {
-				_rc.channels[i] = 0.0f;
-			}
 		}
 
 		_rc.channel_count = rc_input.channel_count;
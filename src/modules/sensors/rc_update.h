@@ -80,7 +80,7 @@ public:
 	void rc_parameter_map_poll(ParameterHandles &parameter_handles, bool forced = false);
 
 	/**
-	 * update the RC functions. Call this when the parameters change.
+	 * update the RC functions and the channel scaling. Call this when the parameters change.
 	 */
 	void update_rc_functions();
 
@@ -120,6 +120,21 @@ private:
 
 	struct rc_channels_s _rc;			/**< r/c channel data */
 
+	/**
+	 * Scaling of a channel to -1..1, precomputed from RCx_MIN/TRIM/MAX/DZ/REV in update_rc_functions()
+	 */
+	struct ChannelScaling {
+		float min;
+		float max;
+		float upper_threshold;			/**< trim + dead zone */
+		float lower_threshold;			/**< trim - dead zone */
+		float upper_scale;			/**< reverse / (max - trim - dead zone), 0 if not finite */
+		float lower_scale;			/**< reverse / (trim - min - dead zone), 0 if not finite */
+	};
+
+	ChannelScaling _channel_scaling[RC_MAX_CHAN_COUNT] {};
+	int8_t _failsafe_channel = -1;			/**< channel checked against RC_FAILS_THR, -1 if none */
+
 	struct rc_parameter_map_s _rc_parameter_map;
 	float _param_rc_values[rc_parameter_map_s::RC_PARAM_MAP_NCHAN];	/**< parameter values for RC control */
 
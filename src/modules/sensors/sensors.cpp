@@ -660,12 +660,24 @@ Sensors::run()
 
 		perf_begin(_loop_perf);
 
+		/* low-latency path: the timestamp of the raw struct is updated by the gyro_poll() method
+		 * (this makes the gyro a mandatory sensor) */
+		_voted_sensors_update.imu_poll(raw);
+
+		if (raw.timestamp > 0) {
+
+			_voted_sensors_update.set_relative_timestamps(raw);
+
+			orb_publish(ORB_ID(sensor_combined), _sensor_pub, &raw);
+		}
+
+		/* Everything below is done after the publication. New mag and baro data is
+		 * published with the next gyro update (see the relative timestamps). */
+
 		/* check vehicle status for changes to publication state */
 		vehicle_control_mode_poll();
 
-		/* the timestamp of the raw struct is updated by the gyro_poll() method (this makes the gyro
-		 * a mandatory sensor) */
-		_voted_sensors_update.sensors_poll(raw);
+		_voted_sensors_update.aux_sensors_poll(raw);
 
 		/* check battery voltage */
 		adc_poll(raw);
@@ -674,10 +686,6 @@ Sensors::run()
 
 		if (raw.timestamp > 0) {
 
-			_voted_sensors_update.set_relative_timestamps(raw);
-
-			orb_publish(ORB_ID(sensor_combined), _sensor_pub, &raw);
-
 			_voted_sensors_update.check_failover();
 
 			/* If the the vehicle is disarmed calculate the length of the maximum difference between
@@ -787,6 +795,8 @@ The provided functionality includes:
 
 ### Implementation
 It runs in its own thread and polls on the currently selected gyro topic.
+On each gyro update, the accel and gyro data is processed and `sensor_combined` is published first. The
+slower sensors (mag, baro, airspeed, ADC) are handled after that, and their data goes out with the next update.
 
 )DESCR_STR");
 
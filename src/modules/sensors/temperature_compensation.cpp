@@ -51,6 +51,8 @@ int TemperatureCompensation::initialize_parameter_handles(ParameterHandles &para
 {
 	char nbuf[16];
 
+	parameter_handles.temperature_threshold = param_find("TC_TEMP_THR");
+
 	/* rate gyro calibration parameters */
 	parameter_handles.gyro_tc_enable = param_find("TC_G_ENABLE");
 
@@ -149,6 +151,8 @@ int TemperatureCompensation::parameters_update()
 		return ret;
 	}
 
+	param_get(parameter_handles.temperature_threshold, &(_parameters.temperature_threshold));
+
 	/* rate gyro calibration parameters */
 	param_get(parameter_handles.gyro_tc_enable, &(_parameters.gyro_tc_enable));
 
@@ -350,7 +354,11 @@ int TemperatureCompensation::set_sensor_id(uint32_t device_id, int topic_instanc
 {
 	for (int i = 0; i < sensor_count_max; ++i) {
 		if (device_id == sensor_cal_data[i].ID) {
-			sensor_data.device_mapping[topic_instance] = i;
+			if (sensor_data.device_mapping[topic_instance] != i) {
+				sensor_data.device_mapping[topic_instance] = i;
+				sensor_data.offsets_temperature[topic_instance] = -1000.0f;
+			}
+
 			return i;
 		}
 	}
@@ -358,62 +366,59 @@ int TemperatureCompensation::set_sensor_id(uint32_t device_id, int topic_instanc
 	return -1;
 }
 
-int TemperatureCompensation::apply_corrections_gyro(int topic_instance, math::Vector<3> &sensor_data, float temperature,
-		float *offsets, float *scales)
+int TemperatureCompensation::apply_corrections_3D(int topic_instance, math::Vector<3> &sensor_data, float temperature,
+		float *offsets, float *scales, PerSensorData &sensor_data_info, const SensorCalData3D *cal_data)
 {
-	if (_parameters.gyro_tc_enable != 1) {
-		return 0;
-	}
-
-	uint8_t mapping = _gyro_data.device_mapping[topic_instance];
+	uint8_t mapping = sensor_data_info.device_mapping[topic_instance];
 
 	if (mapping == 255) {
 		return -1;
 	}
 
-	calc_thermal_offsets_3D(_parameters.gyro_cal_data[mapping], temperature, offsets);
+	const SensorCalData3D &cal = cal_data[mapping];
+	float *cached_offsets = sensor_data_info.offsets[topic_instance];
+
+	// the temperature changes slowly, only evaluate the polynomials when it has moved
+	if (!(fabsf(temperature - sensor_data_info.offsets_temperature[topic_instance]) <= _parameters.temperature_threshold)) {
+		calc_thermal_offsets_3D(cal, temperature, cached_offsets);
+		sensor_data_info.offsets_temperature[topic_instance] = temperature;
+	}
 
 	// get the sensor scale factors and correct the data
 	for (unsigned axis_index = 0; axis_index < 3; axis_index++) {
-		scales[axis_index] = _parameters.gyro_cal_data[mapping].scale[axis_index];
+		offsets[axis_index] = cached_offsets[axis_index];
+		scales[axis_index] = cal.scale[axis_index];
 		sensor_data(axis_index) = (sensor_data(axis_index) - offsets[axis_index]) * scales[axis_index];
 	}
 
-	if (fabsf(temperature - _gyro_data.last_temperature[topic_instance]) > 1.0f) {
-		_gyro_data.last_temperature[topic_instance] = temperature;
+	if (fabsf(temperature - sensor_data_info.last_temperature[topic_instance]) > 1.0f) {
+		sensor_data_info.last_temperature[topic_instance] = temperature;
 		return 2;
 	}
 
 	return 1;
 }
 
-int TemperatureCompensation::apply_corrections_accel(int topic_instance, math::Vector<3> &sensor_data,
-		float temperature, float *offsets, float *scales)
+int TemperatureCompensation::apply_corrections_gyro(int topic_instance, math::Vector<3> &sensor_data, float temperature,
+		float *offsets, float *scales)
 {
-	if (_parameters.accel_tc_enable != 1) {
+	if (_parameters.gyro_tc_enable != 1) {
 		return 0;
 	}
 
-	uint8_t mapping = _accel_data.device_mapping[topic_instance];
-
-	if (mapping == 255) {
-		return -1;
-	}
-
-	calc_thermal_offsets_3D(_parameters.accel_cal_data[mapping], temperature, offsets);
-
-	// get the sensor scale factors and correct the data
-	for (unsigned axis_index = 0; axis_index < 3; axis_index++) {
-		scales[axis_index] = _parameters.accel_cal_data[mapping].scale[axis_index];
-		sensor_data(axis_index) = (sensor_data(axis_index) - offsets[axis_index]) * scales[axis_index];
-	}
+	return apply_corrections_3D(topic_instance, sensor_data, temperature, offsets, scales, _gyro_data,
+				    _parameters.gyro_cal_data);
+}
 
-	if (fabsf(temperature - _accel_data.last_temperature[topic_instance]) > 1.0f) {
-		_accel_data.last_temperature[topic_instance] = temperature;
-		return 2;
+int TemperatureCompensation::apply_corrections_accel(int topic_instance, math::Vector<3> &sensor_data,
+		float temperature, float *offsets, float *scales)
+{
+	if (_parameters.accel_tc_enable != 1) {
+		return 0;
 	}
 
-	return 1;
+	return apply_corrections_3D(topic_instance, sensor_data, temperature, offsets, scales, _accel_data,
+				    _parameters.accel_cal_data);
 }
 
 int TemperatureCompensation::apply_corrections_baro(int topic_instance, float &sensor_data, float temperature,
@@ -429,9 +434,15 @@ int TemperatureCompensation::apply_corrections_baro(int topic_instance, float &s
 		return -1;
 	}
 
-	calc_thermal_offsets_1D(_parameters.baro_cal_data[mapping], temperature, *offsets);
+	float &cached_offset = _baro_data.offsets[topic_instance][0];
+
+	if (!(fabsf(temperature - _baro_data.offsets_temperature[topic_instance]) <= _parameters.temperature_threshold)) {
+		calc_thermal_offsets_1D(_parameters.baro_cal_data[mapping], temperature, cached_offset);
+		_baro_data.offsets_temperature[topic_instance] = temperature;
+	}
 
 	// get the sensor scale factors and correct the data
+	*offsets = cached_offset;
 	*scales = _parameters.baro_cal_data[mapping].scale;
 	sensor_data = (sensor_data - *offsets) * *scales;
 
@@ -187,6 +187,7 @@ private:
 
 	// create a struct containing all thermal calibration parameters
 	struct Parameters {
+		float temperature_threshold;
 		int32_t gyro_tc_enable;
 		SensorCalData3D gyro_cal_data[GYRO_COUNT_MAX];
 		int32_t accel_tc_enable;
@@ -197,6 +198,7 @@ private:
 
 	// create a struct containing the handles required to access all calibration parameters
 	struct ParameterHandles {
+		param_t temperature_threshold;
 		param_t gyro_tc_enable;
 		SensorCalHandles3D gyro_cal_handles[GYRO_COUNT_MAX];
 		param_t accel_tc_enable;
@@ -258,20 +260,32 @@ private:
 	struct PerSensorData {
 		PerSensorData()
 		{
-			for (int i = 0; i < SENSOR_COUNT_MAX; ++i) { device_mapping[i] = 255; last_temperature[i] = -100.0f; }
+			for (int i = 0; i < SENSOR_COUNT_MAX; ++i) { device_mapping[i] = 255; }
+
+			reset_temperature();
 		}
 		void reset_temperature()
 		{
-			for (int i = 0; i < SENSOR_COUNT_MAX; ++i) { last_temperature[i] = -100.0f; }
+			for (int i = 0; i < SENSOR_COUNT_MAX; ++i) { last_temperature[i] = -100.0f; offsets_temperature[i] = -1000.0f; }
 		}
 		uint8_t device_mapping[SENSOR_COUNT_MAX]; /// map a topic instance to the parameters index
 		float last_temperature[SENSOR_COUNT_MAX];
+		float offsets_temperature[SENSOR_COUNT_MAX]; /// temperature at which the offsets were evaluated
+		float offsets[SENSOR_COUNT_MAX][3]; /// offsets at offsets_temperature (only the first one for the baro)
 	};
 	PerSensorData _gyro_data;
 	PerSensorData _accel_data;
 	PerSensorData _baro_data;
 
 
+	/**
+	 * Apply the corrections of a 3D sensor. The offsets are only re-evaluated if the temperature moved
+	 * by more than TC_TEMP_THR since the last evaluation.
+	 * @see apply_corrections_gyro()
+	 */
+	int apply_corrections_3D(int topic_instance, math::Vector<3> &sensor_data, float temperature,
+				 float *offsets, float *scales, PerSensorData &sensor_data_info, const SensorCalData3D *cal_data);
+
 	template<typename T>
 	static inline int set_sensor_id(uint32_t device_id, int topic_instance, PerSensorData &sensor_data,
 					const T *sensor_cal_data, uint8_t sensor_count_max);
@@ -708,6 +708,10 @@ void VotedSensorsUpdate::gyro_poll(struct sensor_combined_s &raw)
 			_last_sensor_data[uorb_index].timestamp = gyro_report.timestamp;
 			_gyro.voter.put(uorb_index, gyro_report.timestamp, _last_sensor_data[uorb_index].gyro_rad,
 					gyro_report.error_count, _gyro.priority[uorb_index]);
+
+#ifdef __PX4_POSIX
+			publish_imu(uorb_index);
+#endif
 		}
 	}
 
@@ -737,8 +741,50 @@ void VotedSensorsUpdate::gyro_poll(struct sensor_combined_s &raw)
 	}
 }
 
+void VotedSensorsUpdate::publish_imu(unsigned uorb_index)
+{
+	// only the additional EKF instances use it
+	if (_parameters.ekf2_multi_inst <= 1) {
+		return;
+	}
+
+	// the IMU needs an accelerometer with the same instance that has published data
+	if (uorb_index >= _accel.subscription_count || _last_accel_timestamp[uorb_index] == 0) {
+		return;
+	}
+
+	// The topic instance must match uorb_index (EKF instance i uses vehicle_imu instance i), and orb_advertise_multi()
+	// assigns the instances in advertise order: advertise only after all lower indices.
+	if (_vehicle_imu_pub[uorb_index] == nullptr) {
+		for (unsigned i = 0; i < uorb_index; i++) {
+			if (_vehicle_imu_pub[i] == nullptr) {
+				return;
+			}
+		}
+	}
+
+	vehicle_imu_s imu;
+	imu.timestamp = _last_sensor_data[uorb_index].timestamp;
+	imu.gyro_device_id = _gyro_device_id[uorb_index];
+	imu.accel_device_id = _accel_device_id[uorb_index];
+
+	for (unsigned axis_index = 0; axis_index < 3; axis_index++) {
+		imu.gyro_rad[axis_index] = _last_sensor_data[uorb_index].gyro_rad[axis_index];
+		imu.accelerometer_m_s2[axis_index] = _last_sensor_data[uorb_index].accelerometer_m_s2[axis_index];
+	}
+
+	imu.gyro_integral_dt = _last_sensor_data[uorb_index].gyro_integral_dt;
+	imu.accelerometer_timestamp_relative = (int32_t)((int64_t)_last_accel_timestamp[uorb_index] - (int64_t)imu.timestamp);
+	imu.accelerometer_integral_dt = _last_sensor_data[uorb_index].accelerometer_integral_dt;
+
+	int instance;
+	orb_publish_auto(ORB_ID(vehicle_imu), &_vehicle_imu_pub[uorb_index], &imu, &instance, ORB_PRIO_DEFAULT);
+}
+
 void VotedSensorsUpdate::mag_poll(struct sensor_combined_s &raw)
 {
+	bool got_update = false;
+
 	for (unsigned uorb_index = 0; uorb_index < _mag.subscription_count; uorb_index++) {
 		bool mag_updated;
 		orb_check(_mag.subscription[uorb_index], &mag_updated);
@@ -771,12 +817,18 @@ void VotedSensorsUpdate::mag_poll(struct sensor_combined_s &raw)
 			_last_sensor_data[uorb_index].magnetometer_ga[1] = vect(1);
 			_last_sensor_data[uorb_index].magnetometer_ga[2] = vect(2);
 
+			got_update = true;
 			_last_mag_timestamp[uorb_index] = mag_report.timestamp;
 			_mag.voter.put(uorb_index, mag_report.timestamp, vect.data,
 				       mag_report.error_count, _mag.priority[uorb_index]);
 		}
 	}
 
+	// the mag updates at a fraction of the gyro rate, only vote on new data (like the baro)
+	if (!got_update) {
+		return;
+	}
+
 	int best_index;
 	_mag.voter.get_best(hrt_absolute_time(), &best_index);
 
@@ -785,11 +837,11 @@ void VotedSensorsUpdate::mag_poll(struct sensor_combined_s &raw)
 		raw.magnetometer_ga[1] = _last_sensor_data[best_index].magnetometer_ga[1];
 		raw.magnetometer_ga[2] = _last_sensor_data[best_index].magnetometer_ga[2];
 		_mag.last_best_vote = (uint8_t)best_index;
-	}
 
-	if (_selection.mag_device_id != _mag_device_id[best_index]) {
-		_selection_changed = true;
-		_selection.mag_device_id = _mag_device_id[best_index];
+		if (_selection.mag_device_id != _mag_device_id[best_index]) {
+			_selection_changed = true;
+			_selection.mag_device_id = _mag_device_id[best_index];
+		}
 	}
 }
 
@@ -1059,9 +1111,19 @@ VotedSensorsUpdate::apply_mag_calibration(DevHandle &h, const struct mag_calibra
 }
 
 void VotedSensorsUpdate::sensors_poll(sensor_combined_s &raw)
+{
+	imu_poll(raw);
+	aux_sensors_poll(raw);
+}
+
+void VotedSensorsUpdate::imu_poll(sensor_combined_s &raw)
 {
 	accel_poll(raw);
 	gyro_poll(raw);
+}
+
+void VotedSensorsUpdate::aux_sensors_poll(sensor_combined_s &raw)
+{
 	mag_poll(raw);
 	baro_poll(raw);
 
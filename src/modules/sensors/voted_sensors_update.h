@@ -56,6 +56,7 @@
 #include <uORB/topics/sensor_preflight.h>
 #include <uORB/topics/sensor_correction.h>
 #include <uORB/topics/sensor_selection.h>
+#include <uORB/topics/vehicle_imu.h>
 
 #include <DevMgr.hpp>
 
@@ -107,10 +108,22 @@ public:
 	void parameters_update();
 
 	/**
-	 * read new sensor data
+	 * read new sensor data (imu_poll() followed by aux_sensors_poll())
 	 */
 	void sensors_poll(sensor_combined_s &raw);
 
+	/**
+	 * read new accel & gyro data. This is the low-latency path after a gyro update:
+	 * sensor_combined can be published right after it.
+	 */
+	void imu_poll(sensor_combined_s &raw);
+
+	/**
+	 * read new mag & baro data, and publish the sensor corrections & selection if they changed.
+	 * Call this after publishing the IMU data, the mag & baro data then goes out with the next gyro update.
+	 */
+	void aux_sensors_poll(sensor_combined_s &raw);
+
 	/**
 	 * set the relative timestamps of each sensor timestamp, based on the last sensors_poll,
 	 * so that the data can be published.
@@ -190,6 +203,14 @@ private:
 	 */
 	void		gyro_poll(struct sensor_combined_s &raw);
 
+	/**
+	 * Publish the corrected data of a single IMU after a gyro update.
+	 * This is only done on POSIX targets, where it is used by additional EKF instances.
+	 *
+	 * @param uorb_index		uORB instance of the gyro (and the accelerometer)
+	 */
+	void		publish_imu(unsigned uorb_index);
+
 	/**
 	 * Poll the magnetometer for updated data.
 	 *
@@ -285,6 +306,8 @@ private:
 	uint32_t _gyro_device_id[SENSOR_COUNT_MAX] = {};
 	uint32_t _mag_device_id[SENSOR_COUNT_MAX] = {};
 
+	orb_advert_t _vehicle_imu_pub[GYRO_COUNT_MAX] = {}; /**< handles to the per IMU uORB topic instances */
+
 	static const double	_msl_pressure;	/** average sea-level pressure in kPa */
 };
 
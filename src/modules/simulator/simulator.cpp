@@ -148,8 +148,19 @@ int Simulator::start(int argc, char *argv[])
 	if (_instance) {
 		drv_led_start();
 
-		if (argc == 5 && strcmp(argv[3], "-u") == 0) {
-			udp_port = atoi(argv[4]);
+		for (int i = 3; i < argc; i++) {
+			if (strcmp(argv[i], "-u") == 0 && i + 1 < argc) {
+				udp_port = atoi(argv[++i]);
+
+			} else if (strcmp(argv[i], "-l") == 0) {
+				_instance->_lockstep = true;
+
+			} else if (strcmp(argv[i], "-m") == 0) {
+				_instance->_use_shmem = true;
+
+			} else if (strcmp(argv[i], "-d") == 0) {
+				_instance->_publish_sensors_direct = true;
+			}
 		}
 
 		if (argv[2][1] == 's') {
@@ -178,10 +189,14 @@ int Simulator::start(int argc, char *argv[])
 
 static void usage()
 {
-	PX4_WARN("Usage: simulator {start -[spt] [-u udp_port] |stop}");
+	PX4_WARN("Usage: simulator {start -[spt] [-u udp_port] [-l] [-m] [-d] |stop}");
 	PX4_WARN("Simulate raw sensors:     simulator start -s");
 	PX4_WARN("Publish sensors combined: simulator start -p");
 	PX4_WARN("Dummy unit test data:     simulator start -t");
+	PX4_WARN("Run in lockstep with the simulation time: -l");
+	PX4_WARN("  (a datagram with a batch of HIL_SENSOR samples is one step, replied to with the controls)");
+	PX4_WARN("Use shared memory instead of UDP (/px4_sim_<udp_port>): -m");
+	PX4_WARN("With -s: publish gyro, accel, mag and baro directly, the sim drivers only provide the devices: -d");
 }
 
 __BEGIN_DECLS
@@ -204,9 +219,6 @@ extern "C" {
 					return 0;
 				}
 
-				// enable lockstep support
-				px4_enable_sim_lockstep();
-
 				g_sim_task = px4_task_spawn_cmd("simulator",
 								SCHED_DEFAULT,
 								SCHED_PRIORITY_MAX,
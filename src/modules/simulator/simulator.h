@@ -63,6 +63,9 @@
 #include <v1.0/mavlink_types.h>
 #include <v1.0/common/mavlink.h>
 #include <geo/geo.h>
+#ifndef __PX4_QURT
+#include "simulator_shmem.h"
+#endif
 namespace simulator
 {
 
@@ -196,7 +199,8 @@ public:
 	enum sim_dev_t {
 		SIM_GYRO,
 		SIM_ACCEL,
-		SIM_MAG
+		SIM_MAG,
+		SIM_BARO
 	};
 
 	struct sample {
@@ -225,6 +229,16 @@ public:
 
 	bool isInitialized() { return _initialized; }
 
+	/**
+	 * In direct mode (start -s -d) the simulator publishes sensor_gyro, sensor_accel, sensor_mag and sensor_baro
+	 * itself. The sim drivers then only register their devices for the calibration and the preflight checks,
+	 * they neither sample nor publish and pass their device ID with setDirectDeviceId().
+	 */
+	bool publishesSensorsDirectly() const { return _publish_sensors_direct; }
+
+	/** set the device ID of the direct publication of a sensor, which starts with the first non-zero ID */
+	void setDirectDeviceId(sim_dev_t dev, uint32_t device_id) { _direct_device_id[dev] = device_id; }
+
 private:
 	Simulator() : SuperBlock(nullptr, "SIM"),
 		_accel(1),
@@ -253,6 +267,10 @@ private:
 		_param_sub(-1),
 		_initialized(false),
 		_realtime_factor(1.0),
+		_lockstep(false),
+		_lockstep_synced(false),
+		_lockstep_offset(0),
+		_use_shmem(false),
 		_system_type(0)
 #ifndef __PX4_QURT
 		,
@@ -342,6 +360,15 @@ private:
 	hrt_abstime _last_sim_timestamp;
 	hrt_abstime _last_sitl_timestamp;
 
+	bool _lockstep;				///< The system time follows the simulation time (start -l)
+	bool _lockstep_synced;
+	int64_t _lockstep_offset;		///< Simulation time minus system time in lockstep
+
+	bool _use_shmem;			///< Talk to the simulator through shared memory instead of UDP (start -m)
+
+	bool _publish_sensors_direct{false};	///< Publish the sensor topics instead of the sim drivers (start -d)
+	volatile uint32_t _direct_device_id[SIM_BARO + 1] {};	///< device IDs of the sim drivers, 0: not started yet
+
 	// Lib used to do the battery calculations.
 	Battery _battery;
 
@@ -384,9 +411,14 @@ private:
 
 	control::BlockParamFloat _battery_drain_interval_s; ///< battery drain interval
 
+	simulator::ShmemTransport _shmem;
+
 	void poll_topics();
 	void handle_message(mavlink_message_t *msg, bool publish);
+	int handle_shmem_messages(bool publish, int timeout_ms, unsigned &sensor_samples);
+	void send_heartbeat();
 	void send_controls();
+	void send_lockstep_controls(hrt_abstime step_time);
 	void pollForMAVLinkMessages(bool publish, int udp_port);
 
 	void pack_actuator_message(mavlink_hil_actuator_controls_t &actuator_msg, unsigned index);
@@ -43,6 +43,7 @@
 #include <sys/socket.h>
 #include <netinet/in.h>
 #include <pthread.h>
+#include <conversion/attitude.h>
 #include <conversion/rotation.h>
 #include <mathlib/mathlib.h>
 #include <uORB/topics/vehicle_local_position.h>
@@ -52,6 +53,10 @@ extern "C" __EXPORT hrt_abstime hrt_reset(void);
 #define SEND_INTERVAL 	20
 #define UDP_PORT 	14560
 
+// lockstep: real time to wait for the controllers to process a simulation step before replying
+#define LOCKSTEP_CONTROLS_TIMEOUT_US	20000
+#define LOCKSTEP_CONTROLS_POLL_US	200
+
 #define PRESS_GROUND 101325.0f
 #define DENSITY 1.2041f
 
@@ -72,7 +77,7 @@ static int openUart(const char *uart_name, int baud);
 #endif
 
 static int _fd;
-static unsigned char _buf[1024];
+static unsigned char _buf[4096]; ///< one datagram, large enough for a lockstep batch of sensor samples
 sockaddr_in _srcaddr;
 static socklen_t _addrlen = sizeof(_srcaddr);
 static hrt_abstime batt_sim_start = 0;
@@ -186,6 +191,42 @@ void Simulator::send_controls()
 	}
 }
 
+void Simulator::send_lockstep_controls(hrt_abstime step_time)
+{
+	// Wait for the actuator outputs computed from this step's sensor data. The lockstep time only advances
+	// with the next step, so the wait is bounded in real time. Until the first actuator_outputs is published
+	// there is nothing to wait for.
+	if (_actuator_outputs_sub[0] >= 0 && _actuators[0].timestamp != 0) {
+		for (unsigned waited_us = 0; waited_us < LOCKSTEP_CONTROLS_TIMEOUT_US; waited_us += LOCKSTEP_CONTROLS_POLL_US) {
+			bool updated = false;
+			orb_check(_actuator_outputs_sub[0], &updated);
+
+			if (updated) {
+				orb_copy(ORB_ID(actuator_outputs), _actuator_outputs_sub[0], &_actuators[0]);
+
+				if (_actuators[0].timestamp >= step_time) {
+					break;
+				}
+			}
+
+			::usleep(LOCKSTEP_CONTROLS_POLL_US);
+		}
+	}
+
+	parameters_update(false);
+	poll_topics();
+
+	// the simulator waits for a reply to every step: send the (zero) controls of the first output even if
+	// there are no outputs yet
+	if (_actuators[0].timestamp == 0) {
+		mavlink_hil_actuator_controls_t msg;
+		pack_actuator_message(msg, 0);
+		send_mavlink_message(MAVLINK_MSG_ID_HIL_ACTUATOR_CONTROLS, &msg, 200);
+	}
+
+	send_controls();
+}
+
 static void fill_rc_input_msg(struct rc_input_values *rc, mavlink_rc_channels_t *rc_channels)
 {
 	rc->timestamp = hrt_absolute_time();
@@ -286,7 +327,17 @@ void Simulator::handle_message(mavlink_message_t *msg, bool publish)
 			mavlink_hil_sensor_t imu;
 			mavlink_msg_hil_sensor_decode(msg, &imu);
 
-			bool compensation_enabled = (imu.time_usec > 0);
+			bool compensation_enabled = (imu.time_usec > 0) && !_lockstep;
+
+			if (_lockstep && _initialized && imu.time_usec > 0) {
+				// the system time advances with the simulation time
+				if (!_lockstep_synced) {
+					_lockstep_offset = (int64_t)imu.time_usec - (int64_t)hrt_absolute_time();
+					_lockstep_synced = true;
+				}
+
+				hrt_lockstep_set_time(imu.time_usec - _lockstep_offset);
+			}
 
 			// set temperature to a decent value
 			imu.temperature = 32.0f;
@@ -350,7 +401,7 @@ void Simulator::handle_message(mavlink_message_t *msg, bool publish)
 			// correct timestamp
 			imu.time_usec = now;
 
-			if (publish) {
+			if (publish || _publish_sensors_direct) {
 				publish_sensor_topics(&imu);
 			}
 
@@ -447,6 +498,7 @@ void Simulator::handle_message(mavlink_message_t *msg, bool publish)
 
 			matrix::Quatf q(hil_state.attitude_quaternion);
 			q.copyTo(hil_attitude.q);
+			set_attitude_representations(hil_attitude);
 
 			hil_attitude.rollspeed = hil_state.rollspeed;
 			hil_attitude.pitchspeed = hil_state.pitchspeed;
@@ -533,6 +585,15 @@ void Simulator::send_mavlink_message(const uint8_t msgid, const void *msg, uint8
 {
 	component_ID = 0;
 	uint8_t payload_len = mavlink_message_lengths[msgid];
+
+	if (_use_shmem) {
+		if (!ShmemTransport::send(_shmem.from_px4(), msgid, msg, payload_len)) {
+			PX4_WARN("Failed sending mavlink message");
+		}
+
+		return;
+	}
+
 	unsigned packet_len = payload_len + MAVLINK_NUM_NON_PAYLOAD_BYTES;
 
 	uint8_t buf[MAVLINK_MAX_PACKET_LEN];
@@ -565,6 +626,36 @@ void Simulator::send_mavlink_message(const uint8_t msgid, const void *msg, uint8
 	}
 }
 
+void Simulator::send_heartbeat()
+{
+	mavlink_heartbeat_t hb = {};
+	hb.autopilot = 12;
+	hb.base_mode |= (_vehicle_status.arming_state == vehicle_status_s::ARMING_STATE_ARMED) ? 128 : 0;
+	send_mavlink_message(MAVLINK_MSG_ID_HEARTBEAT, &hb, 200);
+}
+
+int Simulator::handle_shmem_messages(bool publish, int timeout_ms, unsigned &sensor_samples)
+{
+	if (!ShmemTransport::wait(_shmem.to_px4(), timeout_ms)) {
+		return 0;
+	}
+
+	mavlink_message_t msg = {};
+	int handled = 0;
+
+	// the payload is decoded in place: no framing and checksums in shared memory
+	while (ShmemTransport::receive(_shmem.to_px4(), msg.msgid, _MAV_PAYLOAD_NON_CONST(&msg), msg.len)) {
+		handle_message(&msg, publish);
+		handled++;
+
+		if (msg.msgid == MAVLINK_MSG_ID_HIL_SENSOR) {
+			sensor_samples++;
+		}
+	}
+
+	return handled;
+}
+
 void Simulator::poll_topics()
 {
 	// copy new actuator data if available
@@ -689,14 +780,29 @@ void Simulator::pollForMAVLinkMessages(bool publish, int udp_port)
 	_myaddr.sin_addr.s_addr = htonl(INADDR_ANY);
 	_myaddr.sin_port = htons(udp_port);
 
-	if ((_fd = socket(AF_INET, SOCK_DGRAM, 0)) < 0) {
-		PX4_WARN("create socket failed\n");
-		return;
-	}
+	if (_use_shmem) {
+		char shmem_name[32];
 
-	if (bind(_fd, (struct sockaddr *)&_myaddr, sizeof(_myaddr)) < 0) {
-		PX4_WARN("bind failed\n");
-		return;
+		if (!ShmemTransport::get_name(shmem_name, sizeof(shmem_name), udp_port) || !_shmem.create(shmem_name)) {
+			PX4_WARN("create shared memory failed\n");
+			return;
+		}
+
+		PX4_INFO("Using shared memory %s instead of UDP", shmem_name);
+
+		// no socket, only the serial RC input is polled
+		_fd = -1;
+
+	} else {
+		if ((_fd = socket(AF_INET, SOCK_DGRAM, 0)) < 0) {
+			PX4_WARN("create socket failed\n");
+			return;
+		}
+
+		if (bind(_fd, (struct sockaddr *)&_myaddr, sizeof(_myaddr)) < 0) {
+			PX4_WARN("bind failed\n");
+			return;
+		}
 	}
 
 	// create a thread for sending data to the simulator
@@ -752,6 +858,25 @@ void Simulator::pollForMAVLinkMessages(bool publish, int udp_port)
 	bool no_sim_data = true;
 
 	while (!px4_exit_requested() && no_sim_data) {
+		if (_use_shmem) {
+			unsigned sensor_samples = 0;
+
+			if (handle_shmem_messages(publish, 100, sensor_samples) > 0) {
+				if (pstart_time == 0) {
+					pstart_time = hrt_system_time();
+				}
+
+				send_heartbeat();
+
+				if (hrt_system_time() - pstart_time > 1000000) {
+					PX4_INFO("Got initial simulation data, running sim..");
+					no_sim_data = false;
+				}
+			}
+
+			continue;
+		}
+
 		pret = ::poll(&fds[0], fd_count, 100);
 
 		if (fds[0].revents & POLLIN) {
@@ -761,10 +886,7 @@ void Simulator::pollForMAVLinkMessages(bool publish, int udp_port)
 
 			len = recvfrom(_fd, _buf, sizeof(_buf), 0, (struct sockaddr *)&_srcaddr, &_addrlen);
 			// send hearbeat
-			mavlink_heartbeat_t hb = {};
-			hb.autopilot = 12;
-			hb.base_mode |= (_vehicle_status.arming_state == vehicle_status_s::ARMING_STATE_ARMED) ? 128 : 0;
-			send_mavlink_message(MAVLINK_MSG_ID_HEARTBEAT, &hb, 200);
+			send_heartbeat();
 
 			if (len > 0) {
 				mavlink_message_t msg;
@@ -792,6 +914,11 @@ void Simulator::pollForMAVLinkMessages(bool publish, int udp_port)
 	// reset system time
 	(void)hrt_reset();
 
+	if (_lockstep) {
+		PX4_INFO("Running in lockstep with the simulation time");
+		hrt_lockstep_enable();
+	}
+
 	// subscribe to topics
 	for (unsigned i = 0; i < (sizeof(_actuator_outputs_sub) / sizeof(_actuator_outputs_sub[0])); i++) {
 		_actuator_outputs_sub[i] = orb_subscribe_multi(ORB_ID(actuator_outputs), i);
@@ -799,10 +926,6 @@ void Simulator::pollForMAVLinkMessages(bool publish, int udp_port)
 
 	_vehicle_status_sub = orb_subscribe(ORB_ID(vehicle_status));
 
-	// got data from simulator, now activate the sending thread
-	pthread_create(&sender_thread, &sender_thread_attr, Simulator::sending_trampoline, nullptr);
-	pthread_attr_destroy(&sender_thread_attr);
-
 	mavlink_status_t udp_status = {};
 
 	bool sim_delay = false;
@@ -816,16 +939,31 @@ void Simulator::pollForMAVLinkMessages(bool publish, int udp_port)
 	cmd_long.param2 = 5e3;
 	send_mavlink_message(MAVLINK_MSG_ID_COMMAND_LONG, &cmd_long, 200);
 
+	// got data from simulator, now activate the sending thread. In lockstep the
+	// controls are sent by this thread, once per simulation step. Nothing else is
+	// sent from here from now on (the shared memory ring has a single producer).
+	if (!_lockstep) {
+		pthread_create(&sender_thread, &sender_thread_attr, Simulator::sending_trampoline, nullptr);
+	}
+
+	pthread_attr_destroy(&sender_thread_attr);
+
 	_initialized = true;
 
 	// wait for new mavlink messages to arrive
 	while (true) {
+		unsigned sensor_samples = 0;
 
-		pret = ::poll(&fds[0], fd_count, max_wait_ms);
+		if (_use_shmem) {
+			pret = handle_shmem_messages(publish, max_wait_ms, sensor_samples);
+
+		} else {
+			pret = ::poll(&fds[0], fd_count, max_wait_ms);
+		}
 
 		//timed out
 		if (pret == 0) {
-			if (!sim_delay) {
+			if (!sim_delay && !_lockstep) {
 				// we do not want to spam the console by default
 				// PX4_WARN("mavlink sim timeout for %d ms", max_wait_ms);
 				sim_delay = true;
@@ -851,7 +989,7 @@ void Simulator::pollForMAVLinkMessages(bool publish, int udp_port)
 		}
 
 		// got data from simulator
-		if (fds[0].revents & POLLIN) {
+		if (!_use_shmem && (fds[0].revents & POLLIN)) {
 			len = recvfrom(_fd, _buf, sizeof(_buf), 0, (struct sockaddr *)&_srcaddr, &_addrlen);
 
 			if (len > 0) {
@@ -861,11 +999,22 @@ void Simulator::pollForMAVLinkMessages(bool publish, int udp_port)
 					if (mavlink_parse_char(MAVLINK_COMM_0, _buf[i], &msg, &udp_status)) {
 						// have a message, handle it
 						handle_message(&msg, publish);
+
+						if (msg.msgid == MAVLINK_MSG_ID_HIL_SENSOR) {
+							sensor_samples++;
+						}
 					}
 				}
 			}
 		}
 
+		// In lockstep a datagram (or a wakeup on shared memory) with sensor data is one simulation step.
+		// It can carry a batch of samples, each of which advanced the time: reply with the controls once,
+		// after the controllers have run.
+		if (_lockstep && sensor_samples > 0) {
+			send_lockstep_controls(hrt_absolute_time());
+		}
+
 #ifdef ENABLE_UART_RC_INPUT
 
 		// got data from PIXHAWK
@@ -1013,11 +1162,13 @@ int Simulator::publish_sensor_topics(mavlink_hil_sensor_t *imu)
 	}
 	last_timestamp = timestamp;
 	*/
+	// in direct mode a sensor is published once its sim driver has provided the device ID
 	/* gyro */
-	{
+	if (!_publish_sensors_direct || _direct_device_id[SIM_GYRO] != 0) {
 		struct gyro_report gyro = {};
 
 		gyro.timestamp = timestamp;
+		gyro.device_id = _direct_device_id[SIM_GYRO];
 		gyro.x_raw = imu->xgyro * 1000.0f;
 		gyro.y_raw = imu->ygyro * 1000.0f;
 		gyro.z_raw = imu->zgyro * 1000.0f;
@@ -1032,10 +1183,11 @@ int Simulator::publish_sensor_topics(mavlink_hil_sensor_t *imu)
 	}
 
 	/* accelerometer */
-	{
+	if (!_publish_sensors_direct || _direct_device_id[SIM_ACCEL] != 0) {
 		struct accel_report accel = {};
 
 		accel.timestamp = timestamp;
+		accel.device_id = _direct_device_id[SIM_ACCEL];
 		accel.x_raw = imu->xacc / mg2ms2;
 		accel.y_raw = imu->yacc / mg2ms2;
 		accel.z_raw = imu->zacc / mg2ms2;
@@ -1050,10 +1202,11 @@ int Simulator::publish_sensor_topics(mavlink_hil_sensor_t *imu)
 	}
 
 	/* magnetometer */
-	{
+	if (!_publish_sensors_direct || _direct_device_id[SIM_MAG] != 0) {
 		struct mag_report mag = {};
 
 		mag.timestamp = timestamp;
+		mag.device_id = _direct_device_id[SIM_MAG];
 		mag.x_raw = imu->xmag * 1000.0f;
 		mag.y_raw = imu->ymag * 1000.0f;
 		mag.z_raw = imu->zmag * 1000.0f;
@@ -1068,10 +1221,11 @@ int Simulator::publish_sensor_topics(mavlink_hil_sensor_t *imu)
 	}
 
 	/* baro */
-	{
+	if (!_publish_sensors_direct || _direct_device_id[SIM_BARO] != 0) {
 		struct baro_report baro = {};
 
 		baro.timestamp = timestamp;
+		baro.device_id = _direct_device_id[SIM_BARO];
 		baro.pressure = imu->abs_pressure;
 		baro.altitude = imu->pressure_alt;
 		baro.temperature = imu->temperature;
@@ -0,0 +1,334 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2017 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file simulator_shmem.h
+ *
+ * Shared memory transport between the simulator module and a local simulator
+ * (e.g. the Gazebo plugin), as an alternative to MAVLink over UDP.
+ *
+ * The segment holds two single producer, single consumer rings of MAVLink
+ * messages, one per direction. A slot carries the message id and the MAVLink
+ * payload (the packed message struct), so the messages have the same semantics
+ * as over UDP without the framing, the checksums and a syscall per message.
+ * The consumer of a ring is woken through a process-shared semaphore.
+ *
+ * The segment is created by PX4 (simulator start -m), the simulator attaches
+ * to it. This header is self-contained so that it can be used by the simulator.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <semaphore.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace simulator
+{
+
+struct ShmemMessage {
+	uint8_t msgid;
+	uint8_t len; ///< payload length
+	uint8_t reserved[2];
+	uint8_t payload[255];
+	uint8_t padding;
+};
+
+struct ShmemRing {
+	static constexpr uint32_t SLOT_COUNT = 64; ///< power of 2
+
+	volatile uint32_t head; ///< messages written, only changed by the producer
+	volatile uint32_t tail; ///< messages read, only changed by the consumer
+#ifndef __APPLE__
+	sem_t data_available; ///< posted for every send (no unnamed semaphores on macOS: the consumer polls)
+#endif
+	ShmemMessage slots[SLOT_COUNT];
+};
+
+struct ShmemLayout {
+	uint32_t magic;
+	uint32_t reserved;
+	ShmemRing to_px4; ///< sensor data from the simulator
+	ShmemRing from_px4; ///< actuator controls to the simulator
+};
+
+class ShmemTransport
+{
+public:
+	static constexpr uint32_t MAGIC = 0x53494d01; ///< 'SIM' + version
+
+	ShmemTransport() = default;
+	~ShmemTransport() { close(); }
+
+	// no copy, assignment, move, move assignment
+	ShmemTransport(const ShmemTransport &) = delete;
+	ShmemTransport &operator=(const ShmemTransport &) = delete;
+
+	/**
+	 * Generate the name of the shared memory object of a simulator instance
+	 * @param port UDP port of the instance, which identifies it
+	 * @return true on success
+	 */
+	static bool get_name(char *buf, size_t len, unsigned port)
+	{
+		int ret = snprintf(buf, len, "/px4_sim_%u", port);
+		return ret > 0 && (size_t)ret < len;
+	}
+
+	/**
+	 * Create (or reset) the segment. Used by PX4.
+	 * @return true on success
+	 */
+	bool create(const char *name)
+	{
+		int fd = shm_open(name, O_RDWR | O_CREAT, 0666);
+
+		if (fd < 0) {
+			return false;
+		}
+
+		if (ftruncate(fd, sizeof(ShmemLayout)) != 0 || !map(fd)) {
+			::close(fd);
+			return false;
+		}
+
+		::close(fd);
+
+		_layout->magic = 0;
+		__sync_synchronize();
+
+		if (!init_ring(_layout->to_px4) || !init_ring(_layout->from_px4)) {
+			close();
+			return false;
+		}
+
+		__sync_synchronize();
+		_layout->magic = MAGIC;
+		return true;
+	}
+
+	/**
+	 * Attach to an existing segment. Used by the simulator.
+	 * @return true on success
+	 */
+	bool open(const char *name)
+	{
+		int fd = shm_open(name, O_RDWR, 0);
+
+		if (fd < 0) {
+			return false;
+		}
+
+		struct stat st;
+
+		if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(ShmemLayout) || !map(fd)) {
+			::close(fd);
+			return false;
+		}
+
+		::close(fd);
+
+		if (_layout->magic != MAGIC) {
+			close();
+			return false;
+		}
+
+		return true;
+	}
+
+	void close()
+	{
+		if (_layout) {
+			munmap(_layout, sizeof(ShmemLayout));
+			_layout = nullptr;
+		}
+	}
+
+	bool valid() const { return _layout != nullptr; }
+
+	ShmemRing &to_px4() { return _layout->to_px4; }
+	ShmemRing &from_px4() { return _layout->from_px4; }
+
+	/**
+	 * Queue a message (producer side)
+	 * @param payload MAVLink payload (packed message struct) of len bytes
+	 * @return false if the ring is full
+	 */
+	static bool send(ShmemRing &ring, uint8_t msgid, const void *payload, uint8_t len)
+	{
+		const uint32_t head = ring.head;
+
+		if (head - ring.tail >= ShmemRing::SLOT_COUNT) {
+			return false;
+		}
+
+		ShmemMessage &slot = ring.slots[head % ShmemRing::SLOT_COUNT];
+		slot.msgid = msgid;
+		slot.len = len;
+		memcpy(slot.payload, payload, len);
+
+		__sync_synchronize();
+		ring.head = head + 1;
+
+#ifndef __APPLE__
+		sem_post(&ring.data_available);
+#endif
+		return true;
+	}
+
+	/**
+	 * Queue a batch of messages at once (producer side). In lockstep, the messages
+	 * available on a wakeup are one simulation step: the simulator sends a step as
+	 * a batch, so that PX4 never sees a part of it.
+	 * @return false if there is not enough space in the ring
+	 */
+	static bool send_batch(ShmemRing &ring, const ShmemMessage *messages, uint32_t count)
+	{
+		const uint32_t head = ring.head;
+
+		if (head - ring.tail + count > ShmemRing::SLOT_COUNT) {
+			return false;
+		}
+
+		for (uint32_t i = 0; i < count; i++) {
+			ring.slots[(head + i) % ShmemRing::SLOT_COUNT] = messages[i];
+		}
+
+		__sync_synchronize();
+		ring.head = head + count;
+
+#ifndef __APPLE__
+		sem_post(&ring.data_available);
+#endif
+		return true;
+	}
+
+	/**
+	 * Take the next message (consumer side)
+	 * @param payload buffer of at least 255 bytes
+	 * @return false if the ring is empty
+	 */
+	static bool receive(ShmemRing &ring, uint8_t &msgid, void *payload, uint8_t &len)
+	{
+		const uint32_t tail = ring.tail;
+
+		if (tail == ring.head) {
+			return false;
+		}
+
+		__sync_synchronize();
+
+		const ShmemMessage &slot = ring.slots[tail % ShmemRing::SLOT_COUNT];
+		msgid = slot.msgid;
+		len = slot.len;
+		memcpy(payload, slot.payload, len);
+
+		__sync_synchronize();
+		ring.tail = tail + 1;
+		return true;
+	}
+
+	/**
+	 * Wait until a message is available (consumer side)
+	 * @return true if a message is available, false on timeout
+	 */
+	static bool wait(ShmemRing &ring, int timeout_ms)
+	{
+#ifndef __APPLE__
+		struct timespec ts;
+		clock_gettime(CLOCK_REALTIME, &ts);
+		ts.tv_sec += timeout_ms / 1000;
+		ts.tv_nsec += (timeout_ms % 1000) * 1000000;
+
+		if (ts.tv_nsec >= 1000000000) {
+			ts.tv_sec++;
+			ts.tv_nsec -= 1000000000;
+		}
+
+		// the semaphore counts messages, but the consumer drains the ring after a wakeup:
+		// an empty ring after the wait is a stale post
+		while (ring.tail == ring.head) {
+			if (sem_timedwait(&ring.data_available, &ts) != 0 && errno != EINTR) {
+				return ring.tail != ring.head;
+			}
+		}
+
+#else
+
+		for (int waited_us = 0; ring.tail == ring.head; waited_us += 100) {
+			if (waited_us >= timeout_ms * 1000) {
+				return false;
+			}
+
+			usleep(100);
+		}
+
+#endif
+		return true;
+	}
+
+private:
+	static bool init_ring(ShmemRing &ring)
+	{
+		ring.head = 0;
+		ring.tail = 0;
+#ifndef __APPLE__
+		return sem_init(&ring.data_available, 1, 0) == 0;
+#else
+		return true;
+#endif
+	}
+
+	bool map(int fd)
+	{
+		void *base = mmap(nullptr, sizeof(ShmemLayout), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+		if (base == MAP_FAILED) {
+			return false;
+		}
+
+		_layout = (ShmemLayout *)base;
+		return true;
+	}
+
+	ShmemLayout *_layout{nullptr};
+};
+
+} // namespace simulator
@@ -63,6 +63,36 @@ read_x(bson_decoder_t decoder, void *p, size_t s)
 {
 	CODER_CHECK(decoder);
 
+	if (decoder->fd > -1 && decoder->filebuf != NULL) {
+		uint8_t *dst = (uint8_t *)p;
+
+		while (s > 0) {
+			if (decoder->filebuf_pos == decoder->filebuf_len) {
+				int ret = BSON_READ(decoder->fd, decoder->filebuf, decoder->filebuf_size);
+
+				if (ret <= 0) {
+					return -1;
+				}
+
+				decoder->filebuf_pos = 0;
+				decoder->filebuf_len = ret;
+			}
+
+			size_t n = decoder->filebuf_len - decoder->filebuf_pos;
+
+			if (n > s) {
+				n = s;
+			}
+
+			memcpy(dst, decoder->filebuf + decoder->filebuf_pos, n);
+			decoder->filebuf_pos += n;
+			dst += n;
+			s -= n;
+		}
+
+		return 0;
+	}
+
 	if (decoder->fd > -1) {
 		return (BSON_READ(decoder->fd, p, s) == (int)s) ? 0 : -1;
 	}
@@ -116,6 +146,7 @@ bson_decoder_init_file(bson_decoder_t decoder, int fd, bson_decoder_callback cal
 	int32_t	junk;
 
 	decoder->fd = fd;
+	decoder->filebuf = NULL;
 	decoder->buf = NULL;
 	decoder->dead = false;
 	decoder->callback = callback;
@@ -133,6 +164,25 @@ bson_decoder_init_file(bson_decoder_t decoder, int fd, bson_decoder_callback cal
 	return 0;
 }
 
+int
+bson_decoder_init_file_buffered(bson_decoder_t decoder, int fd, void *buf, size_t bufsize,
+				bson_decoder_callback callback, void *priv)
+{
+	if ((buf == NULL) || (bufsize == 0)) {
+		return -1;
+	}
+
+	int ret = bson_decoder_init_file(decoder, fd, callback, priv);
+
+	/* the document size is read unbuffered, the buffer is used from now on */
+	decoder->filebuf = (uint8_t *)buf;
+	decoder->filebuf_size = bufsize;
+	decoder->filebuf_pos = 0;
+	decoder->filebuf_len = 0;
+
+	return ret;
+}
+
 int
 bson_decoder_init_buf(bson_decoder_t decoder, void *buf, unsigned bufsize, bson_decoder_callback callback,
 		      void *priv)
@@ -145,6 +195,7 @@ bson_decoder_init_buf(bson_decoder_t decoder, void *buf, unsigned bufsize, bson_
 	}
 
 	decoder->fd = -1;
+	decoder->filebuf = NULL;
 	decoder->buf = (uint8_t *)buf;
 	decoder->dead = false;
 
@@ -225,6 +276,12 @@ bson_decoder_next(bson_decoder_t decoder)
 	if (decoder->node.type == BSON_EOO) {
 		decoder->node.name[0] = '\0';
 
+		/* end of the top-level document: give back what was read ahead of it */
+		if (decoder->nesting <= 1 && decoder->filebuf != NULL && decoder->filebuf_pos < decoder->filebuf_len) {
+			lseek(decoder->fd, -(off_t)(decoder->filebuf_len - decoder->filebuf_pos), SEEK_CUR);
+			decoder->filebuf_pos = decoder->filebuf_len;
+		}
+
 	} else {
 
 		/* get the node name */
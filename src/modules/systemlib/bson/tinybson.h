@@ -104,6 +104,10 @@ typedef int	(* bson_decoder_callback)(bson_decoder_t decoder, void *priv, bson_n
 struct bson_decoder_s {
 	/* file reader state */
 	int			fd;
+	uint8_t			*filebuf;	/**< read buffer, NULL for unbuffered reads */
+	size_t			filebuf_size;
+	size_t			filebuf_pos;
+	size_t			filebuf_len;
 
 	/* buffer reader state */
 	uint8_t			*buf;
@@ -129,6 +133,23 @@ struct bson_decoder_s {
  */
 __EXPORT int bson_decoder_init_file(bson_decoder_t decoder, int fd, bson_decoder_callback callback, void *priv);
 
+/**
+ * Initialise the decoder to read from a file in chunks of the size of a buffer.
+ *
+ * At the end of the document the file position is moved back to the end of the
+ * document, so that a following document can be read from the same file.
+ *
+ * @param decoder		Decoder state structure to be initialised.
+ * @param fd			File to read BSON data from.
+ * @param buf			Read buffer, which must remain valid while decoding.
+ * @param bufsize		Size of the read buffer.
+ * @param callback		Callback to be invoked by bson_decoder_next
+ * @param priv			Callback private data, stored in node.
+ * @return			Zero on success.
+ */
+__EXPORT int bson_decoder_init_file_buffered(bson_decoder_t decoder, int fd, void *buf, size_t bufsize,
+		bson_decoder_callback callback, void *priv);
+
 /**
  * Initialise the decoder to read from a buffer in memory.
  *
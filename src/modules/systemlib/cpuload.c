@@ -55,6 +55,8 @@
 #include <drivers/drv_hrt.h>
 
 #include "cpuload.h"
+#include "trace.h"
+#include "work_queue_stats.h"
 
 #ifdef CONFIG_SCHED_INSTRUMENTATION
 
@@ -145,6 +147,7 @@ void sched_note_stop(FAR struct tcb_s *tcb)
 
 void sched_note_suspend(FAR struct tcb_s *tcb)
 {
+	TRACE_EVENT(TRACE_EVENT_TASK_SUSPEND, tcb->pid, 0);
 
 	if (system_load.initialized) {
 		uint64_t new_time = hrt_absolute_time();
@@ -161,6 +164,7 @@ void sched_note_suspend(FAR struct tcb_s *tcb)
 
 void sched_note_resume(FAR struct tcb_s *tcb)
 {
+	TRACE_EVENT(TRACE_EVENT_TASK_RESUME, tcb->pid, 0);
 
 	if (system_load.initialized) {
 		uint64_t new_time = hrt_absolute_time();
@@ -175,6 +179,16 @@ void sched_note_resume(FAR struct tcb_s *tcb)
 
 }
 
+uint32_t sched_note_work_begin(void)
+{
+	return work_queue_stats_begin();
+}
+
+void sched_note_work_end(int qid, worker_t worker, uint32_t begin, systime_t late)
+{
+	work_queue_stats_end(qid, worker, begin, TICK2USEC(late));
+}
+
 #else
 __EXPORT struct system_load_s system_load;
 #endif
@@ -39,6 +39,9 @@
 /****************************************************************************
  * Included Files
  ****************************************************************************/
+
+#include <stddef.h>
+#include <stdint.h>
 /****************************************************************************
  * Pre-processor Definitions
  ****************************************************************************/
@@ -58,6 +61,9 @@
 /****************************************************************************
  * Public Function Prototypes
  ****************************************************************************/
+
+__BEGIN_DECLS
+
 /****************************************************************************
  * Name: crc16_add
  *
@@ -114,3 +120,25 @@ uint16_t crc16_signature(uint16_t initial, size_t length,
  ****************************************************************************/
 
 uint64_t crc64_add_word(uint64_t crc, uint32_t value);
+
+/****************************************************************************
+ * Name: crc32_fast
+ *
+ * Description:
+ *   Continues a CRC-32 (polynomial 0xEDB88320, reflected) calculation
+ *   like crc32part() but processes 8 bytes per step (slicing-by-8).
+ *   Use it for large buffers such as whole files, the tables take 8 KB.
+ *
+ * Input Parameters:
+ *    src    - A pointer to any array of len bytes
+ *    len    - The number of bytes to add to the crc
+ *    crc    - The running total of the crc 32
+ *
+ * Returned Value:
+ *   The current crc32 with the bytes processed, identical to crc32part().
+ *
+ ****************************************************************************/
+
+uint32_t crc32_fast(const uint8_t *src, size_t len, uint32_t crc);
+
+__END_DECLS
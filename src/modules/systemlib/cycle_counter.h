@@ -0,0 +1,95 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2017 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file cycle_counter.h
+ * Free-running 32 bit clock for timing short sections of code.
+ *
+ * On STM32 this is the Cortex-M DWT cycle counter, elsewhere the low 32 bits
+ * of hrt_absolute_time() (microseconds). It wraps, so only the difference of
+ * two readings is meaningful.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <px4_config.h>
+#include <drivers/drv_hrt.h>
+
+#ifdef __PX4_NUTTX
+#include <arch/board/board.h>
+#endif
+
+#if defined(__PX4_NUTTX) && defined(STM32_SYSCLK_FREQUENCY)
+#  define CYCLE_COUNTER_DWT
+#  define DWT_CTRL	(*(volatile uint32_t *)0xE0001000)
+#  define DWT_CYCCNT	(*(volatile uint32_t *)0xE0001004)
+#  define DWT_LAR	(*(volatile uint32_t *)0xE0001FB0)
+#  define DEMCR		(*(volatile uint32_t *)0xE000EDFC)
+#  define DEMCR_TRCENA	(1 << 24)
+#  define DWT_CTRL_CYCCNTENA	(1 << 0)
+#endif
+
+/**
+ * Start the counter. Needs to be called once before the first reading.
+ */
+static inline void cycle_counter_enable(void)
+{
+#ifdef CYCLE_COUNTER_DWT
+	DEMCR |= DEMCR_TRCENA;
+	DWT_LAR = 0xC5ACCE55; /* unlock, required on the Cortex-M7 */
+	DWT_CTRL |= DWT_CTRL_CYCCNTENA;
+#endif
+}
+
+static inline uint32_t cycle_counter_read(void)
+{
+#ifdef CYCLE_COUNTER_DWT
+	return DWT_CYCCNT;
+#else
+	return (uint32_t)hrt_absolute_time();
+#endif
+}
+
+/**
+ * @return counter frequency in Hz (the core clock with the DWT, 1 MHz otherwise)
+ */
+static inline uint32_t cycle_counter_frequency(void)
+{
+#ifdef CYCLE_COUNTER_DWT
+	return STM32_SYSCLK_FREQUENCY;
+#else
+	return 1000000;
+#endif
+}
@@ -0,0 +1,181 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2017 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file mem_pool.c
+ *
+ * Size-class pool allocator.
+ */
+
+#include "mem_pool.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+/** bytes requested from the heap at once per size class */
+#define MEM_POOL_CHUNK_SIZE	512
+
+struct mem_pool_block_s {
+	struct mem_pool_block_s *next;
+};
+
+struct mem_pool_class_s {
+	struct mem_pool_block_s *free_list;
+	struct mem_pool_stats_s stats;
+	pthread_mutex_t mutex;
+};
+
+static struct mem_pool_class_s mem_pool_classes[MEM_POOL_CLASS_COUNT] = {
+	{ NULL, { 16, 0, 0, 0 }, PTHREAD_MUTEX_INITIALIZER },
+	{ NULL, { 32, 0, 0, 0 }, PTHREAD_MUTEX_INITIALIZER },
+	{ NULL, { 64, 0, 0, 0 }, PTHREAD_MUTEX_INITIALIZER },
+	{ NULL, { 128, 0, 0, 0 }, PTHREAD_MUTEX_INITIALIZER },
+};
+
+static struct mem_pool_class_s *
+mem_pool_class(size_t size)
+{
+	for (unsigned i = 0; i < MEM_POOL_CLASS_COUNT; i++) {
+		if (size <= mem_pool_classes[i].stats.block_size) {
+			return &mem_pool_classes[i];
+		}
+	}
+
+	return NULL;
+}
+
+/**
+ * Add a chunk of blocks to the free list. Called with the class locked.
+ */
+static void
+mem_pool_grow(struct mem_pool_class_s *pool)
+{
+	const unsigned block_size = pool->stats.block_size;
+	const unsigned count = MEM_POOL_CHUNK_SIZE / block_size;
+	uint8_t *chunk = (uint8_t *)malloc(count * block_size);
+
+	if (chunk == NULL) {
+		return;
+	}
+
+	for (unsigned i = 0; i < count; i++) {
+		struct mem_pool_block_s *block = (struct mem_pool_block_s *)(chunk + i * block_size);
+		block->next = pool->free_list;
+		pool->free_list = block;
+	}
+
+	pool->stats.total += count;
+}
+
+void *
+mem_pool_alloc(size_t size)
+{
+	struct mem_pool_class_s *pool = mem_pool_class(size);
+
+	if (pool == NULL) {
+		return malloc(size);
+	}
+
+	pthread_mutex_lock(&pool->mutex);
+
+	if (pool->free_list == NULL) {
+		mem_pool_grow(pool);
+	}
+
+	struct mem_pool_block_s *block = pool->free_list;
+
+	if (block != NULL) {
+		pool->free_list = block->next;
+
+		if (++pool->stats.used > pool->stats.peak) {
+			pool->stats.peak = pool->stats.used;
+		}
+	}
+
+	pthread_mutex_unlock(&pool->mutex);
+
+	return block;
+}
+
+void
+mem_pool_free(void *ptr, size_t size)
+{
+	if (ptr == NULL) {
+		return;
+	}
+
+	struct mem_pool_class_s *pool = mem_pool_class(size);
+
+	if (pool == NULL) {
+		free(ptr);
+		return;
+	}
+
+	struct mem_pool_block_s *block = (struct mem_pool_block_s *)ptr;
+
+	pthread_mutex_lock(&pool->mutex);
+	block->next = pool->free_list;
+	pool->free_list = block;
+	pool->stats.used--;
+	pthread_mutex_unlock(&pool->mutex);
+}
+
+int
+mem_pool_get_stats(unsigned size_class, struct mem_pool_stats_s *stats)
+{
+	if (size_class >= MEM_POOL_CLASS_COUNT) {
+		return -1;
+	}
+
+	struct mem_pool_class_s *pool = &mem_pool_classes[size_class];
+
+	pthread_mutex_lock(&pool->mutex);
+	*stats = pool->stats;
+	pthread_mutex_unlock(&pool->mutex);
+
+	return 0;
+}
+
+void
+mem_pool_print_stats_buffer(char *buffer, size_t length)
+{
+	int len = snprintf(buffer, length, "Pools (used/total peak):");
+
+	for (unsigned i = 0; i < MEM_POOL_CLASS_COUNT && len >= 0 && (size_t)len < length; i++) {
+		struct mem_pool_stats_s stats;
+		mem_pool_get_stats(i, &stats);
+		len += snprintf(buffer + len, length - len, " %uB %u/%u %u", stats.block_size, stats.used, stats.total,
+				stats.peak);
+	}
+}
@@ -0,0 +1,107 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2017 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file mem_pool.h
+ *
+ * Size-class pool allocator for small objects that are allocated and freed at
+ * runtime (uORB subscriptions, dataman work items, ring buffers, ...).
+ *
+ * Blocks are carved from chunks obtained from the heap and recycled through a
+ * free list per size class, so allocation and release take constant time and
+ * do not fragment the heap. Chunks are never returned to the heap.
+ * Requests larger than the largest size class are passed to malloc().
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <px4_defines.h>
+
+/** Number of size classes: 16, 32, 64 and 128 bytes */
+#define MEM_POOL_CLASS_COUNT	4
+
+/**
+ * Statistics of one size class.
+ */
+struct mem_pool_stats_s {
+	uint16_t block_size;	/**< [bytes] */
+	uint16_t total;		/**< blocks obtained from the heap */
+	uint16_t used;		/**< blocks currently allocated */
+	uint16_t peak;		/**< maximum of used */
+};
+
+__BEGIN_DECLS
+
+/**
+ * Allocate a block of at least size bytes.
+ *
+ * @return the block (aligned like malloc()), or NULL if out of memory
+ */
+__EXPORT extern void *mem_pool_alloc(size_t size);
+
+/**
+ * Release a block from mem_pool_alloc().
+ *
+ * @param size		the size passed to mem_pool_alloc()
+ */
+__EXPORT extern void mem_pool_free(void *ptr, size_t size);
+
+/**
+ * Get the statistics of a size class.
+ *
+ * @return 0 on success, -1 if size_class is out of range
+ */
+__EXPORT extern int mem_pool_get_stats(unsigned size_class, struct mem_pool_stats_s *stats);
+
+/**
+ * Print a one-line summary of all size classes into buffer (for top).
+ */
+__EXPORT extern void mem_pool_print_stats_buffer(char *buffer, size_t length);
+
+__END_DECLS
+
+#ifdef __cplusplus
+
+/**
+ * Base class allocating the objects of the derived class from the pool.
+ */
+class MemPoolAllocated
+{
+public:
+	static void *operator new (size_t size) noexcept { return mem_pool_alloc(size); }
+	static void operator delete (void *ptr, size_t size) { mem_pool_free(ptr, size); }
+};
+
+#endif /* __cplusplus */
@@ -157,6 +157,23 @@ public:
 					    uint8_t control_index,
 					    float &control);
 
+	/**
+	 * Fetch a control value in fixed point, for MixerGroup::compile_fixed().
+	 *
+	 * @param control		The returned control in units of 1 / FIXED_ONE, or FIXED_INVALID.
+	 * @return			Zero if the value was fetched, nonzero otherwise.
+	 */
+	typedef int	(* ControlCallbackFixed)(uintptr_t handle,
+			uint8_t control_group,
+			uint8_t control_index,
+			int32_t &control);
+
+	/** fixed-point representation of 1.0, the resolution of the IO register values */
+	static constexpr int32_t	FIXED_ONE = 10000;
+
+	/** fixed-point control value that propagates to a NaN output, like a NaN control */
+	static constexpr int32_t	FIXED_INVALID = INT32_MIN;
+
 	/**
 	 * Constructor.
 	 *
@@ -211,6 +228,20 @@ public:
 	 */
 	virtual void 			set_thrust_factor(float val) {}
 
+	/**
+	 * @brief      Select the single-pass mixing mode, only implemented for MultirotorMixer and MixerGroup class.
+	 *
+	 * @param[in]  enable  true for single-pass mixing, false for the reference mixer
+	 */
+	virtual void			set_single_pass(bool enable) {}
+
+	/**
+	 * @brief      Configuration of a SimpleMixer, used by MixerGroup::compile().
+	 *
+	 * @return     The mixer configuration, nullptr for all other mixers.
+	 */
+	virtual const mixer_simple_s	*simple_info() const { return nullptr; }
+
 protected:
 	/** client-supplied callback used when fetching control values */
 	ControlCallback			_control_cb;
@@ -272,6 +303,41 @@ private:
 	Mixer &operator=(const Mixer &);
 };
 
+/**
+ * Precompiled (binary) mixer definition, generated from the text format at build time
+ * by Tools/px_generate_mixer_binaries.py. It is a header followed by one record per mixer:
+ *
+ * Z: no payload
+ * M: struct mixer_simple_s with control_count controls (MIXER_SIMPLE_SIZE(control_count) bytes)
+ * R: struct mixer_multirotor_binary_s
+ * H: struct mixer_heli_s
+ *
+ * The payloads are the in-memory configurations of the mixers (little endian),
+ * with the scalings of the text format already applied.
+ */
+#define MIXER_BINARY_MAGIC		0x4258494d	/**< 'MIXB' */
+#define MIXER_BINARY_VERSION		1
+
+struct mixer_binary_header_s {
+	uint32_t	magic;
+	uint16_t	version;
+	uint16_t	record_count;
+};
+
+struct mixer_binary_record_s {
+	uint8_t		type;		/**< mixer type tag of the text format ('Z', 'M', 'R', 'H') */
+	uint8_t		reserved;
+	uint16_t	length;		/**< length of the payload following the record header */
+};
+
+struct mixer_multirotor_binary_s {
+	char		geometry[8];	/**< geometry name of the text format, zero terminated */
+	float		roll_scale;
+	float		pitch_scale;
+	float		yaw_scale;
+	float		idle_speed;
+};
+
 /**
  * Group of mixers, built up from single mixers and processed
  * in order when mixing.
@@ -359,6 +425,26 @@ public:
 	 */
 	int				load_from_buf(const char *buf, unsigned &buflen);
 
+	/**
+	 * Adds mixers to the group based on a precompiled binary definition
+	 * (see struct mixer_binary_header_s). The mixer configurations are copied
+	 * from the buffer as they are, so there is no parsing involved.
+	 *
+	 * @param buf			The binary mixer definition.
+	 * @param buflen		The length of the buffer.
+	 * @return			Zero on successful load, nonzero otherwise.
+	 */
+	int				load_from_binary(const void *buf, unsigned buflen);
+
+	/**
+	 * Check whether a buffer contains a binary mixer definition.
+	 *
+	 * @param buf			The buffer.
+	 * @param buflen		The length of the buffer.
+	 * @return			true if the buffer starts with a binary mixer header.
+	 */
+	static bool			is_binary(const void *buf, unsigned buflen);
+
 	/**
 	 * @brief      Update slew rate parameter. This tells instances of the class MultirotorMixer
 	 *             the maximum allowed change of the output values per cycle.
@@ -389,9 +475,113 @@ public:
 	 */
 	virtual void	set_thrust_factor(float val);
 
+	/**
+	 * @brief      Select the single-pass mixing mode of all multirotor mixers in the group.
+	 *
+	 * @param[in]  enable  true for single-pass mixing, false for the reference mixer
+	 */
+	virtual void	set_single_pass(bool enable);
+
+	/**
+	 * Compile the loaded mixers into a flat program, which mix() then evaluates
+	 * in one loop instead of going through the mixer list.
+	 *
+	 * Each distinct control input is fetched once per cycle, and the simple mixers
+	 * are evaluated from the program with the fetched values. The other mixers
+	 * (multirotor, helicopter, null) keep mixing themselves, in order.
+	 * Adding or removing mixers discards the program, setting the trims updates it.
+	 *
+	 * @return			Zero on success, -ENOMEM if the program could not be allocated
+	 *				(the group then keeps mixing through the list).
+	 */
+	int				compile();
+
+	bool				compiled() const { return _program_outputs != nullptr; }
+
+	/**
+	 * Compile the group like compile(), but evaluate the simple mixers in integer
+	 * arithmetic, with the controls fetched through control_cb. Only the final value
+	 * of each simple mixer output is converted to float. This is meant for targets
+	 * without an FPU, where the float scalers are emulated in software.
+	 *
+	 * The scales are held in Q16, offsets and limits in units of 1 / FIXED_ONE, so
+	 * the outputs differ from the float mixer by the rounding of the parameters
+	 * (at most a few 1 / FIXED_ONE).
+	 *
+	 * @return			Zero on success, -ENOMEM if the program could not be allocated.
+	 */
+	int				compile_fixed(ControlCallbackFixed control_cb);
+
+	bool				compiled_fixed() const { return _fixed_terms != nullptr; }
+
 private:
+	/**
+	 * Control term of a compiled simple mixer.
+	 */
+	struct ProgramTerm {
+		mixer_scaler_s		scaler;
+		uint8_t			input;		/**< index into _program_inputs */
+	};
+
+	/**
+	 * Output of the compiled group: either a simple mixer output, evaluated from
+	 * the terms [first_term, first_term + term_count), or a mixer that mixes itself.
+	 */
+	struct ProgramOutput {
+		Mixer			*mixer;		/**< not a simple mixer: call its mix() */
+		mixer_scaler_s		scaler;		/**< output scaler of the simple mixer */
+		uint16_t		first_term;
+		uint16_t		term_count;
+	};
+
+	/**
+	 * Scaler of the fixed-point program.
+	 */
+	struct FixedScaler {
+		int32_t			negative_scale;	/**< Q16 */
+		int32_t			positive_scale;	/**< Q16 */
+		int32_t			offset;
+		int32_t			min_output;
+		int32_t			max_output;
+	};
+
+	/**
+	 * Control term of the fixed-point program, replaces ProgramTerm.
+	 */
+	struct FixedTerm {
+		FixedScaler		scaler;
+		uint8_t			input;		/**< index into _program_inputs */
+	};
+
+	/**
+	 * Distinct control input used by the compiled simple mixers.
+	 */
+	struct ProgramInput {
+		uint8_t			control_group;
+		uint8_t			control_index;
+	};
+
 	Mixer				*_first;	/**< linked list of mixers */
 
+	ProgramOutput			*_program_outputs{nullptr};
+	ProgramTerm			*_program_terms{nullptr};
+	ProgramInput			*_program_inputs{nullptr};
+	float				*_program_values{nullptr};	/**< input values of the current cycle */
+	unsigned			_program_output_count{0};
+	unsigned			_program_input_count{0};
+
+	ControlCallbackFixed		_fixed_cb{nullptr};
+	FixedTerm			*_fixed_terms{nullptr};
+	FixedScaler			*_fixed_outputs{nullptr};	/**< output scalers, by program output */
+	int32_t				*_fixed_values{nullptr};	/**< input values of the current cycle */
+
+	unsigned			mix_program(float *outputs, unsigned space);
+	unsigned			mix_program_fixed(float *outputs, unsigned space);
+	void				discard_program();
+
+	static FixedScaler		fixed_scaler(const mixer_scaler_s &scaler);
+	static int32_t			scale_fixed(const FixedScaler &scaler, int32_t input);
+
 	/* do not allow to copy due to pointer data members */
 	MixerGroup(const MixerGroup &);
 	MixerGroup operator=(const MixerGroup &);
@@ -475,6 +665,24 @@ public:
 			const char *buf,
 			unsigned &buflen);
 
+	/**
+	 * Factory method.
+	 *
+	 * Creates a mixer from the payload of a binary mixer record.
+	 *
+	 * @param control_cb		The callback to invoke when fetching a
+	 *				control value.
+	 * @param cb_handle		Handle passed to the control callback.
+	 * @param data			A struct mixer_simple_s.
+	 * @param length		Length of the data in bytes.
+	 * @return			A new SimpleMixer instance, or nullptr
+	 *				if the data is invalid.
+	 */
+	static SimpleMixer		*from_binary(Mixer::ControlCallback control_cb,
+			uintptr_t cb_handle,
+			const void *data,
+			unsigned length);
+
 	/**
 	 * Factory method for PWM/PPM input to internal float representation.
 	 *
@@ -507,6 +715,8 @@ public:
 
 	unsigned set_trim(float trim);
 
+	virtual const mixer_simple_s	*simple_info() const { return _pinfo; }
+
 protected:
 
 private:
@@ -596,6 +806,22 @@ public:
 	static MultirotorMixer		*from_text(Mixer::ControlCallback control_cb, uintptr_t cb_handle, const char *buf,
 			unsigned &buflen);
 
+	/**
+	 * Factory method.
+	 *
+	 * Creates a mixer from the payload of a binary mixer record.
+	 *
+	 * @param control_cb		The callback to invoke when fetching a
+	 *				control value.
+	 * @param cb_handle		Handle passed to the control callback.
+	 * @param data			A struct mixer_multirotor_binary_s.
+	 * @param length		Length of the data in bytes.
+	 * @return			A new MultirotorMixer instance, or nullptr
+	 *				if the data is invalid.
+	 */
+	static MultirotorMixer		*from_binary(Mixer::ControlCallback control_cb, uintptr_t cb_handle, const void *data,
+			unsigned length);
+
 	virtual unsigned		mix(float *outputs, unsigned space);
 	virtual uint16_t		get_saturation_status(void);
 	virtual void			groups_required(uint32_t &groups);
@@ -624,6 +850,29 @@ public:
 	 */
 	virtual void			set_thrust_factor(float val) {_thrust_factor = val;}
 
+	/**
+	 * @brief      Select the single-pass mixing mode. The rotor scales are then kept in
+	 *             struct-of-arrays form, the outputs are computed with branch-free loops,
+	 *             and yaw is limited in closed form from the bounds of all rotors instead
+	 *             of being corrected rotor by rotor. The saturation flags of each rotor are
+	 *             precomputed. Falls back to the reference mixer if the tables cannot be allocated.
+	 *
+	 * @param[in]  enable  true for single-pass mixing, false for the reference mixer
+	 */
+	virtual void			set_single_pass(bool enable);
+
+	bool				single_pass() const { return _tables != nullptr && _single_pass; }
+
+	/**
+	 * @brief      Number of geometries in the generated rotor tables (see multi_tables.py).
+	 */
+	static unsigned			geometry_count();
+
+	/**
+	 * @brief      Name of a geometry of the generated rotor tables, nullptr if out of range.
+	 */
+	static const char		*geometry_name(unsigned geometry);
+
 	union saturation_status {
 		struct {
 			uint16_t valid		: 1; // 0 - true when the saturation status is used
@@ -641,7 +890,23 @@ public:
 		uint16_t value;
 	};
 
+	static constexpr unsigned	MAX_ROTORS = 12;
+
 private:
+	/**
+	 * Rotor scales in struct-of-arrays form for the single-pass mixer.
+	 */
+	struct RotorTables {
+		float	roll[MAX_ROTORS];
+		float	pitch[MAX_ROTORS];
+		float	yaw[MAX_ROTORS];
+		float	yaw_inv[MAX_ROTORS];	/**< 1 / yaw scale, 0 if the rotor has no yaw effect */
+		float	yaw_free[MAX_ROTORS];	/**< widens the yaw bounds of rotors without yaw effect */
+		float	out[MAX_ROTORS];
+		uint16_t saturation_high[MAX_ROTORS];	/**< saturation flags set when the rotor clips high */
+		uint16_t saturation_low[MAX_ROTORS];	/**< saturation flags set when the rotor clips low */
+	};
+
 	float				_roll_scale;
 	float				_pitch_scale;
 	float				_yaw_scale;
@@ -652,11 +917,32 @@ private:
 	void update_saturation_status(unsigned index, bool clipping_high, bool clipping_low);
 	saturation_status _saturation_status;
 
+	/**
+	 * Thrust boost and roll/pitch scale to bring the roll/pitch mix back into range.
+	 */
+	static void compute_boost(float thrust, float min_out, float max_out, float &boost, float &roll_pitch_scale);
+
+	/**
+	 * Look up a geometry by its name in the mixer definition (e.g. "4x").
+	 * @return true if the name is known
+	 */
+	static bool parse_geometry(const char *name, MultirotorGeometry &geometry);
+
+	unsigned mix_single_pass(float *outputs);
+
+	/**
+	 * Slew rate limiting and saturation checking of the final outputs.
+	 */
+	void limit_outputs(float *outputs);
+
 	unsigned			_rotor_count;
 	const Rotor			*_rotors;
 
 	float 				*_outputs_prev = nullptr;
 
+	bool				_single_pass = false;
+	RotorTables			*_tables = nullptr;
+
 	/* do not allow to copy due to ptr data members */
 	MultirotorMixer(const MultirotorMixer &);
 	MultirotorMixer operator=(const MultirotorMixer &);
@@ -722,6 +1008,22 @@ public:
 	static HelicopterMixer		*from_text(Mixer::ControlCallback control_cb, uintptr_t cb_handle, const char *buf,
 			unsigned &buflen);
 
+	/**
+	 * Factory method.
+	 *
+	 * Creates a mixer from the payload of a binary mixer record.
+	 *
+	 * @param control_cb		The callback to invoke when fetching a
+	 *				control value.
+	 * @param cb_handle		Handle passed to the control callback.
+	 * @param data			A struct mixer_heli_s.
+	 * @param length		Length of the data in bytes.
+	 * @return			A new HelicopterMixer instance, or nullptr
+	 *				if the data is invalid.
+	 */
+	static HelicopterMixer		*from_binary(Mixer::ControlCallback control_cb, uintptr_t cb_handle, const void *data,
+			unsigned length);
+
 	virtual unsigned		mix(float *outputs, unsigned space);
 	virtual void			groups_required(uint32_t &groups);
 
@@ -69,6 +69,266 @@ MixerGroup::~MixerGroup()
 	reset();
 }
 
+void
+MixerGroup::discard_program()
+{
+	delete[] _program_outputs;
+	delete[] _program_terms;
+	delete[] _program_inputs;
+	delete[] _program_values;
+	delete[] _fixed_terms;
+	delete[] _fixed_outputs;
+	delete[] _fixed_values;
+
+	_program_outputs = nullptr;
+	_program_terms = nullptr;
+	_program_inputs = nullptr;
+	_program_values = nullptr;
+	_fixed_terms = nullptr;
+	_fixed_outputs = nullptr;
+	_fixed_values = nullptr;
+	_program_output_count = 0;
+	_program_input_count = 0;
+}
+
+int
+MixerGroup::compile()
+{
+	discard_program();
+
+	/* size the program */
+	unsigned output_count = 0;
+	unsigned term_count = 0;
+
+	for (Mixer *mixer = _first; mixer != nullptr; mixer = mixer->_next) {
+		const mixer_simple_s *info = mixer->simple_info();
+
+		if (info != nullptr) {
+			term_count += info->control_count;
+		}
+
+		output_count++;
+	}
+
+	if (output_count == 0) {
+		return 0;
+	}
+
+	_program_outputs = new ProgramOutput[output_count];
+	_program_terms = new ProgramTerm[term_count > 0 ? term_count : 1];
+	_program_inputs = new ProgramInput[term_count > 0 ? term_count : 1];
+	_program_values = new float[term_count > 0 ? term_count : 1];
+
+	if (_program_outputs == nullptr || _program_terms == nullptr || _program_inputs == nullptr
+	    || _program_values == nullptr || term_count > UINT16_MAX) {
+		discard_program();
+		return -ENOMEM;
+	}
+
+	unsigned term = 0;
+
+	for (Mixer *mixer = _first; mixer != nullptr; mixer = mixer->_next) {
+		ProgramOutput &output = _program_outputs[_program_output_count++];
+		const mixer_simple_s *info = mixer->simple_info();
+
+		if (info == nullptr) {
+			output.mixer = mixer;
+			output.first_term = 0;
+			output.term_count = 0;
+			continue;
+		}
+
+		output.mixer = nullptr;
+		output.scaler = info->output_scaler;
+		output.first_term = term;
+		output.term_count = info->control_count;
+
+		for (unsigned i = 0; i < info->control_count; i++) {
+			const mixer_control_s &control = info->controls[i];
+
+			/* share the input with the other terms using the same control */
+			unsigned input = 0;
+
+			while (input < _program_input_count &&
+			       (_program_inputs[input].control_group != control.control_group ||
+				_program_inputs[input].control_index != control.control_index)) {
+				input++;
+			}
+
+			if (input == _program_input_count) {
+				_program_inputs[input].control_group = control.control_group;
+				_program_inputs[input].control_index = control.control_index;
+				_program_input_count++;
+			}
+
+			_program_terms[term].scaler = control.scaler;
+			_program_terms[term].input = input;
+			term++;
+		}
+	}
+
+	return 0;
+}
+
+MixerGroup::FixedScaler
+MixerGroup::fixed_scaler(const mixer_scaler_s &scaler)
+{
+	FixedScaler fixed;
+
+	fixed.negative_scale = (int32_t)roundf(scaler.negative_scale * 65536.0f);
+	fixed.positive_scale = (int32_t)roundf(scaler.positive_scale * 65536.0f);
+	fixed.offset = (int32_t)roundf(scaler.offset * FIXED_ONE);
+	fixed.min_output = (int32_t)roundf(scaler.min_output * FIXED_ONE);
+	fixed.max_output = (int32_t)roundf(scaler.max_output * FIXED_ONE);
+
+	return fixed;
+}
+
+int32_t
+MixerGroup::scale_fixed(const FixedScaler &scaler, int32_t input)
+{
+	int32_t output;
+
+	if (input < 0) {
+		output = (int32_t)(((int64_t)input * scaler.negative_scale) >> 16) + scaler.offset;
+
+	} else {
+		output = (int32_t)(((int64_t)input * scaler.positive_scale) >> 16) + scaler.offset;
+	}
+
+	if (output > scaler.max_output) {
+		output = scaler.max_output;
+
+	} else if (output < scaler.min_output) {
+		output = scaler.min_output;
+	}
+
+	return output;
+}
+
+int
+MixerGroup::compile_fixed(ControlCallbackFixed control_cb)
+{
+	int ret = compile();
+
+	if (ret != 0 || !compiled()) {
+		return ret;
+	}
+
+	unsigned term_count = 0;
+
+	for (unsigned i = 0; i < _program_output_count; i++) {
+		term_count += _program_outputs[i].term_count;
+	}
+
+	_fixed_terms = new FixedTerm[term_count > 0 ? term_count : 1];
+	_fixed_outputs = new FixedScaler[_program_output_count];
+	_fixed_values = new int32_t[term_count > 0 ? term_count : 1];
+
+	if (_fixed_terms == nullptr || _fixed_outputs == nullptr || _fixed_values == nullptr) {
+		discard_program();
+		return -ENOMEM;
+	}
+
+	for (unsigned i = 0; i < term_count; i++) {
+		_fixed_terms[i].scaler = fixed_scaler(_program_terms[i].scaler);
+		_fixed_terms[i].input = _program_terms[i].input;
+	}
+
+	for (unsigned i = 0; i < _program_output_count; i++) {
+		_fixed_outputs[i] = fixed_scaler(_program_outputs[i].scaler);
+	}
+
+	/* the float terms are not used anymore */
+	delete[] _program_terms;
+	delete[] _program_values;
+	_program_terms = nullptr;
+	_program_values = nullptr;
+
+	_fixed_cb = control_cb;
+
+	return 0;
+}
+
+unsigned
+MixerGroup::mix_program_fixed(float *outputs, unsigned space)
+{
+	/* fetch each control once */
+	for (unsigned i = 0; i < _program_input_count; i++) {
+		int32_t value = 0;
+		_fixed_cb(_cb_handle, _program_inputs[i].control_group, _program_inputs[i].control_index, value);
+		_fixed_values[i] = value;
+	}
+
+	unsigned index = 0;
+
+	for (unsigned i = 0; (i < _program_output_count) && (index < space); i++) {
+		const ProgramOutput &output = _program_outputs[i];
+
+		if (output.mixer != nullptr) {
+			index += output.mixer->mix(outputs + index, space - index);
+			continue;
+		}
+
+		const FixedTerm *terms = &_fixed_terms[output.first_term];
+		int32_t sum = 0;
+		bool valid = true;
+
+		for (unsigned j = 0; j < output.term_count; j++) {
+			const int32_t value = _fixed_values[terms[j].input];
+
+			if (value == FIXED_INVALID) {
+				valid = false;
+				break;
+			}
+
+			sum += scale_fixed(terms[j].scaler, value);
+		}
+
+		if (valid) {
+			outputs[index++] = (float)scale_fixed(_fixed_outputs[i], sum) * (1.0f / FIXED_ONE);
+
+		} else {
+			outputs[index++] = NAN;
+		}
+	}
+
+	return index;
+}
+
+unsigned
+MixerGroup::mix_program(float *outputs, unsigned space)
+{
+	/* fetch each control once */
+	for (unsigned i = 0; i < _program_input_count; i++) {
+		float value = 0.0f;
+		_control_cb(_cb_handle, _program_inputs[i].control_group, _program_inputs[i].control_index, value);
+		_program_values[i] = value;
+	}
+
+	unsigned index = 0;
+
+	for (unsigned i = 0; (i < _program_output_count) && (index < space); i++) {
+		const ProgramOutput &output = _program_outputs[i];
+
+		if (output.mixer != nullptr) {
+			index += output.mixer->mix(outputs + index, space - index);
+			continue;
+		}
+
+		const ProgramTerm *terms = &_program_terms[output.first_term];
+		float sum = 0.0f;
+
+		for (unsigned j = 0; j < output.term_count; j++) {
+			sum += scale(terms[j].scaler, _program_values[terms[j].input]);
+		}
+
+		outputs[index++] = scale(output.scaler, sum);
+	}
+
+	return index;
+}
+
 void
 MixerGroup::add_mixer(Mixer *mixer)
 {
@@ -82,6 +342,8 @@ MixerGroup::add_mixer(Mixer *mixer)
 
 	*mpp = mixer;
 	mixer->_next = nullptr;
+
+	discard_program();
 }
 
 void
@@ -92,6 +354,7 @@ MixerGroup::reset()
 
 	/* flag mixer as invalid */
 	_first = nullptr;
+	discard_program();
 
 	/* discard sub-mixers */
 	while (next != nullptr) {
@@ -105,6 +368,14 @@ MixerGroup::reset()
 unsigned
 MixerGroup::mix(float *outputs, unsigned space)
 {
+	if (compiled_fixed()) {
+		return mix_program_fixed(outputs, space);
+	}
+
+	if (compiled()) {
+		return mix_program(outputs, space);
+	}
+
 	Mixer	*mixer = _first;
 	unsigned index = 0;
 
@@ -127,6 +398,7 @@ MixerGroup::set_trims(int16_t *values, unsigned n)
 {
 	Mixer	*mixer = _first;
 	unsigned index = 0;
+	unsigned output = 0;
 
 	while ((mixer != nullptr) && (index < n)) {
 		/* convert from integer to float */
@@ -138,8 +410,29 @@ MixerGroup::set_trims(int16_t *values, unsigned n)
 		if (offset >  0.2f) { offset =  0.2f; }
 
 		debug("set trim: %d, offset: %5.3f", values[index], (double)offset);
+
+		/*
+		 * The program holds a copy of the output scalers, with one output per mixer. Only the offset
+		 * changes, and IO calls this on every mixer tick: the fixed-point offset is in the same 1e-4
+		 * units as the trim, so it is updated without float math.
+		 */
+		if (compiled() && output < _program_output_count && mixer->simple_info() != nullptr) {
+			_program_outputs[output].scaler.offset = offset;
+
+			if (compiled_fixed()) {
+				int32_t trim = values[index];
+
+				if (trim < -2000) { trim = -2000; }
+
+				if (trim >  2000) { trim =  2000; }
+
+				_fixed_outputs[output].offset = trim * FIXED_ONE / 10000;
+			}
+		}
+
 		index += mixer->set_trim(offset);
 		mixer = mixer->_next;
+		output++;
 	}
 
 	return index;
@@ -157,6 +450,17 @@ MixerGroup::set_thrust_factor(float val)
 
 }
 
+void
+MixerGroup::set_single_pass(bool enable)
+{
+	Mixer	*mixer = _first;
+
+	while (mixer != nullptr) {
+		mixer->set_single_pass(enable);
+		mixer = mixer->_next;
+	}
+}
+
 uint16_t
 MixerGroup::get_saturation_status()
 {
@@ -264,6 +568,93 @@ MixerGroup::load_from_buf(const char *buf, unsigned &buflen)
 	return ret;
 }
 
+bool
+MixerGroup::is_binary(const void *buf, unsigned buflen)
+{
+	mixer_binary_header_s header;
+
+	if (buflen < sizeof(header)) {
+		return false;
+	}
+
+	memcpy(&header, buf, sizeof(header));
+	return header.magic == MIXER_BINARY_MAGIC;
+}
+
+int
+MixerGroup::load_from_binary(const void *buf, unsigned buflen)
+{
+	const uint8_t *p = (const uint8_t *)buf;
+	const uint8_t *end = p + buflen;
+	mixer_binary_header_s header;
+
+	if (!is_binary(buf, buflen)) {
+		debug("not a binary mixer definition");
+		return -1;
+	}
+
+	memcpy(&header, p, sizeof(header));
+	p += sizeof(header);
+
+	if (header.version != MIXER_BINARY_VERSION) {
+		debug("unsupported binary mixer version %u", header.version);
+		return -1;
+	}
+
+	for (unsigned i = 0; i < header.record_count; i++) {
+		mixer_binary_record_s record;
+
+		if ((unsigned)(end - p) < sizeof(record)) {
+			debug("binary mixer truncated at record %u", i);
+			return -1;
+		}
+
+		memcpy(&record, p, sizeof(record));
+		p += sizeof(record);
+
+		if ((unsigned)(end - p) < record.length) {
+			debug("binary mixer record %u truncated", i);
+			return -1;
+		}
+
+		Mixer *m = nullptr;
+
+		switch (record.type) {
+		case 'Z':
+			if (record.length == 0) {
+				m = new NullMixer;
+			}
+
+			break;
+
+		case 'M':
+			m = SimpleMixer::from_binary(_control_cb, _cb_handle, p, record.length);
+			break;
+
+		case 'R':
+			m = MultirotorMixer::from_binary(_control_cb, _cb_handle, p, record.length);
+			break;
+
+		case 'H':
+			m = HelicopterMixer::from_binary(_control_cb, _cb_handle, p, record.length);
+			break;
+
+		default:
+			break;
+		}
+
+		if (m == nullptr) {
+			debug("binary mixer record %u (type %u) invalid", i, record.type);
+			return -1;
+		}
+
+		add_mixer(m);
+		p += record.length;
+	}
+
+	return 0;
+}
+
 void MixerGroup::set_max_delta_out_once(float delta_out_max)
 {
 	Mixer	*mixer = _first;
@@ -233,6 +233,28 @@ HelicopterMixer::from_text(Mixer::ControlCallback control_cb, uintptr_t cb_handl
 	return hm;
 }
 
+HelicopterMixer *
+HelicopterMixer::from_binary(Mixer::ControlCallback control_cb, uintptr_t cb_handle, const void *data, unsigned length)
+{
+	static_assert(sizeof(mixer_heli_s) == 140, "binary mixer format: unexpected layout of mixer_heli_s");
+
+	mixer_heli_s mixer_info;
+
+	if (length != sizeof(mixer_info)) {
+		debug("helicopter record has invalid length %u", length);
+		return nullptr;
+	}
+
+	memcpy(&mixer_info, data, sizeof(mixer_info));
+
+	if (mixer_info.control_count < 3 || mixer_info.control_count > 4) {
+		debug("only supporting swash plate with 3 or 4 servos");
+		return nullptr;
+	}
+
+	return new HelicopterMixer(control_cb, cb_handle, &mixer_info);
+}
+
 unsigned
 HelicopterMixer::mix(float *outputs, unsigned space)
 {
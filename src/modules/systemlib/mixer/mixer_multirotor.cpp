@@ -95,95 +95,197 @@ MultirotorMixer::~MultirotorMixer()
 	if (_outputs_prev != nullptr) {
 		delete[] _outputs_prev;
 	}
+
+	delete _tables;
 }
 
-MultirotorMixer *
-MultirotorMixer::from_text(Mixer::ControlCallback control_cb, uintptr_t cb_handle, const char *buf, unsigned &buflen)
+void
+MultirotorMixer::set_single_pass(bool enable)
 {
-	MultirotorGeometry geometry;
-	char geomname[8];
-	int s[4];
-	int used;
+	_single_pass = enable;
 
-	/* enforce that the mixer ends with a new line */
-	if (!string_well_formed(buf, buflen)) {
-		return nullptr;
+	if (!enable || _tables != nullptr || _rotor_count > MAX_ROTORS) {
+		return;
 	}
 
-	if (sscanf(buf, "R: %7s %d %d %d %d%n", geomname, &s[0], &s[1], &s[2], &s[3], &used) != 5) {
-		debug("multirotor parse failed on '%s'", buf);
-		return nullptr;
+	_tables = new RotorTables;
+
+	if (_tables == nullptr) {
+		return;
 	}
 
-	if (used > (int)buflen) {
-		debug("OVERFLOW: multirotor spec used %d of %u", used, buflen);
+	for (unsigned i = 0; i < _rotor_count; i++) {
+		_tables->roll[i] = _rotors[i].roll_scale;
+		_tables->pitch[i] = _rotors[i].pitch_scale;
+		_tables->yaw[i] = _rotors[i].yaw_scale;
+		_tables->out[i] = _rotors[i].out_scale;
+
+		/* a rotor without yaw effect does not limit yaw, the yaw input range is [-1, 1] */
+		if (fabsf(_rotors[i].yaw_scale) <= FLT_EPSILON) {
+			_tables->yaw_inv[i] = 0.0f;
+			_tables->yaw_free[i] = 2.0f;
+
+		} else {
+			_tables->yaw_inv[i] = 1.0f / _rotors[i].yaw_scale;
+			_tables->yaw_free[i] = 0.0f;
+		}
+
+		/* the saturation flags only depend on the signs of the rotor scales */
+		_saturation_status.value = 0;
+		update_saturation_status(i, true, false);
+		_tables->saturation_high[i] = _saturation_status.value;
+
+		_saturation_status.value = 0;
+		update_saturation_status(i, false, true);
+		_tables->saturation_low[i] = _saturation_status.value;
+	}
+
+	_saturation_status.value = 0;
+}
+
+MultirotorMixer *
+MultirotorMixer::from_binary(Mixer::ControlCallback control_cb, uintptr_t cb_handle, const void *data,
+			     unsigned length)
+{
+	mixer_multirotor_binary_s info;
+	MultirotorGeometry geometry;
+
+	if (length != sizeof(info)) {
+		debug("multirotor record has invalid length %u", length);
 		return nullptr;
 	}
 
-	buf = skipline(buf, buflen);
+	memcpy(&info, data, sizeof(info));
+	info.geometry[sizeof(info.geometry) - 1] = '\0';
 
-	if (buf == nullptr) {
-		debug("no line ending, line is incomplete");
+	if (!parse_geometry(info.geometry, geometry)) {
+		debug("unrecognised geometry '%s'", info.geometry);
 		return nullptr;
 	}
 
-	debug("remaining in buf: %d, first char: %c", buflen, buf[0]);
+	return new MultirotorMixer(
+		       control_cb,
+		       cb_handle,
+		       geometry,
+		       info.roll_scale,
+		       info.pitch_scale,
+		       info.yaw_scale,
+		       info.idle_speed);
+}
 
-	if (!strcmp(geomname, "4+")) {
+bool
+MultirotorMixer::parse_geometry(const char *name, MultirotorGeometry &geometry)
+{
+	if (!strcmp(name, "4+")) {
 		geometry = MultirotorGeometry::QUAD_PLUS;
 
-	} else if (!strcmp(geomname, "4x")) {
+	} else if (!strcmp(name, "4x")) {
 		geometry = MultirotorGeometry::QUAD_X;
 
-	} else if (!strcmp(geomname, "4h")) {
+	} else if (!strcmp(name, "4h")) {
 		geometry = MultirotorGeometry::QUAD_H;
 
-	} else if (!strcmp(geomname, "4v")) {
+	} else if (!strcmp(name, "4v")) {
 		geometry = MultirotorGeometry::QUAD_V;
 
-	} else if (!strcmp(geomname, "4w")) {
+	} else if (!strcmp(name, "4w")) {
 		geometry = MultirotorGeometry::QUAD_WIDE;
 
-	} else if (!strcmp(geomname, "4s")) {
+	} else if (!strcmp(name, "4s")) {
 		geometry = MultirotorGeometry::QUAD_S250AQ;
 
-	} else if (!strcmp(geomname, "4dc")) {
+	} else if (!strcmp(name, "4dc")) {
 		geometry = MultirotorGeometry::QUAD_DEADCAT;
 
-	} else if (!strcmp(geomname, "6+")) {
+	} else if (!strcmp(name, "6+")) {
 		geometry = MultirotorGeometry::HEX_PLUS;
 
-	} else if (!strcmp(geomname, "6x")) {
+	} else if (!strcmp(name, "6x")) {
 		geometry = MultirotorGeometry::HEX_X;
 
-	} else if (!strcmp(geomname, "6c")) {
+	} else if (!strcmp(name, "6c")) {
 		geometry = MultirotorGeometry::HEX_COX;
 
-	} else if (!strcmp(geomname, "6t")) {
+	} else if (!strcmp(name, "6t")) {
 		geometry = MultirotorGeometry::HEX_T;
 
-	} else if (!strcmp(geomname, "8+")) {
+	} else if (!strcmp(name, "8+")) {
 		geometry = MultirotorGeometry::OCTA_PLUS;
 
-	} else if (!strcmp(geomname, "8x")) {
+	} else if (!strcmp(name, "8x")) {
 		geometry = MultirotorGeometry::OCTA_X;
 
-	} else if (!strcmp(geomname, "8c")) {
+	} else if (!strcmp(name, "8c")) {
 		geometry = MultirotorGeometry::OCTA_COX;
 
-	} else if (!strcmp(geomname, "6m")) {
+	} else if (!strcmp(name, "6m")) {
 		geometry = MultirotorGeometry::DODECA_TOP_COX;
 
-	} else if (!strcmp(geomname, "6a")) {
+	} else if (!strcmp(name, "6a")) {
 		geometry = MultirotorGeometry::DODECA_BOTTOM_COX;
 
-	} else if (!strcmp(geomname, "2-")) {
+	} else if (!strcmp(name, "2-")) {
 		geometry = MultirotorGeometry::TWIN_ENGINE;
 
-	} else if (!strcmp(geomname, "3y")) {
+	} else if (!strcmp(name, "3y")) {
 		geometry = MultirotorGeometry::TRI_Y;
 
 	} else {
+		return false;
+	}
+
+	return true;
+}
+
+unsigned
+MultirotorMixer::geometry_count()
+{
+	return (unsigned)MultirotorGeometry::MAX_GEOMETRY;
+}
+
+const char *
+MultirotorMixer::geometry_name(unsigned geometry)
+{
+	if (geometry >= geometry_count()) {
+		return nullptr;
+	}
+
+	return _config_name[geometry];
+}
+
+MultirotorMixer *
+MultirotorMixer::from_text(Mixer::ControlCallback control_cb, uintptr_t cb_handle, const char *buf, unsigned &buflen)
+{
+	MultirotorGeometry geometry;
+	char geomname[8];
+	int s[4];
+	int used;
+
+	/* enforce that the mixer ends with a new line */
+	if (!string_well_formed(buf, buflen)) {
+		return nullptr;
+	}
+
+	if (sscanf(buf, "R: %7s %d %d %d %d%n", geomname, &s[0], &s[1], &s[2], &s[3], &used) != 5) {
+		debug("multirotor parse failed on '%s'", buf);
+		return nullptr;
+	}
+
+	if (used > (int)buflen) {
+		debug("OVERFLOW: multirotor spec used %d of %u", used, buflen);
+		return nullptr;
+	}
+
+	buf = skipline(buf, buflen);
+
+	if (buf == nullptr) {
+		debug("no line ending, line is incomplete");
+		return nullptr;
+	}
+
+	debug("remaining in buf: %d, first char: %c", buflen, buf[0]);
+
+	if (!parse_geometry(geomname, geometry)) {
 		debug("unrecognised geometry '%s'", geomname);
 		return nullptr;
 	}
@@ -200,7 +302,53 @@ MultirotorMixer::from_text(Mixer::ControlCallback control_cb, uintptr_t cb_handl
 		       s[3] / 10000.0f);
 }
 
-unsigned
+void
+MultirotorMixer::compute_boost(float thrust, float min_out, float max_out, float &boost, float &roll_pitch_scale)
+{
+	// thrust boost parameters
+	const float thrust_increase_factor = 1.5f;
+	const float thrust_decrease_factor = 0.6f;
+
+	if (min_out < 0.0f && max_out < 1.0f && -min_out <= 1.0f - max_out) {
+		float max_thrust_diff = thrust * thrust_increase_factor - thrust;
+
+		if (max_thrust_diff >= -min_out) {
+			boost = -min_out;
+
+		} else {
+			boost = max_thrust_diff;
+			roll_pitch_scale = (thrust + boost) / (thrust - min_out);
+		}
+
+	} else if (max_out > 1.0f && min_out > 0.0f && min_out >= max_out - 1.0f) {
+		float max_thrust_diff = thrust - thrust_decrease_factor * thrust;
+
+		if (max_thrust_diff >= max_out - 1.0f) {
+			boost = -(max_out - 1.0f);
+
+		} else {
+			boost = -max_thrust_diff;
+			roll_pitch_scale = (1 - (thrust + boost)) / (max_out - thrust);
+		}
+
+	} else if (min_out < 0.0f && max_out < 1.0f && -min_out > 1.0f - max_out) {
+		float max_thrust_diff = thrust * thrust_increase_factor - thrust;
+		boost = math::constrain(-min_out - (1.0f - max_out) / 2.0f, 0.0f, max_thrust_diff);
+		roll_pitch_scale = (thrust + boost) / (thrust - min_out);
+
+	} else if (max_out > 1.0f && min_out > 0.0f && min_out < max_out - 1.0f) {
+		float max_thrust_diff = thrust - thrust_decrease_factor * thrust;
+		boost = math::constrain(-(max_out - 1.0f - min_out) / 2.0f, -max_thrust_diff, 0.0f);
+		roll_pitch_scale = (1 - (thrust + boost)) / (max_out - thrust);
+
+	} else if (min_out < 0.0f && max_out > 1.0f) {
+		boost = math::constrain(-(max_out - 1.0f + min_out) / 2.0f, thrust_decrease_factor * thrust - thrust,
+					thrust_increase_factor * thrust - thrust);
+		roll_pitch_scale = (thrust + boost) / (thrust - min_out);
+	}
+}
+
+PX4_FAST_CODE unsigned
 MultirotorMixer::mix(float *outputs, unsigned space)
 {
 	/* Summary of mixing strategy:
@@ -214,6 +362,10 @@ MultirotorMixer::mix(float *outputs, unsigned space)
 	4) scale all outputs to range [idle_speed,1]
 	*/
 
+	if (single_pass()) {
+		return mix_single_pass(outputs);
+	}
+
 	float		roll    = math::constrain(get_control(0, 0) * _roll_scale, -1.0f, 1.0f);
 	float		pitch   = math::constrain(get_control(0, 1) * _pitch_scale, -1.0f, 1.0f);
 	float		yaw     = math::constrain(get_control(0, 2) * _yaw_scale, -1.0f, 1.0f);
@@ -224,10 +376,6 @@ MultirotorMixer::mix(float *outputs, unsigned space)
 	// clean out class variable used to capture saturation
 	_saturation_status.value = 0;
 
-	// thrust boost parameters
-	float thrust_increase_factor = 1.5f;
-	float thrust_decrease_factor = 0.6f;
-
 	/* perform initial mix pass yielding unbounded outputs, ignore yaw */
 	for (unsigned i = 0; i < _rotor_count; i++) {
 		float out = roll * _rotors[i].roll_scale +
@@ -251,43 +399,7 @@ MultirotorMixer::mix(float *outputs, unsigned space)
 	float boost = 0.0f;		// value added to demanded thrust (can also be negative)
 	float roll_pitch_scale = 1.0f;	// scale for demanded roll and pitch
 
-	if (min_out < 0.0f && max_out < 1.0f && -min_out <= 1.0f - max_out) {
-		float max_thrust_diff = thrust * thrust_increase_factor - thrust;
-
-		if (max_thrust_diff >= -min_out) {
-			boost = -min_out;
-
-		} else {
-			boost = max_thrust_diff;
-			roll_pitch_scale = (thrust + boost) / (thrust - min_out);
-		}
-
-	} else if (max_out > 1.0f && min_out > 0.0f && min_out >= max_out - 1.0f) {
-		float max_thrust_diff = thrust - thrust_decrease_factor * thrust;
-
-		if (max_thrust_diff >= max_out - 1.0f) {
-			boost = -(max_out - 1.0f);
-
-		} else {
-			boost = -max_thrust_diff;
-			roll_pitch_scale = (1 - (thrust + boost)) / (max_out - thrust);
-		}
-
-	} else if (min_out < 0.0f && max_out < 1.0f && -min_out > 1.0f - max_out) {
-		float max_thrust_diff = thrust * thrust_increase_factor - thrust;
-		boost = math::constrain(-min_out - (1.0f - max_out) / 2.0f, 0.0f, max_thrust_diff);
-		roll_pitch_scale = (thrust + boost) / (thrust - min_out);
-
-	} else if (max_out > 1.0f && min_out > 0.0f && min_out < max_out - 1.0f) {
-		float max_thrust_diff = thrust - thrust_decrease_factor * thrust;
-		boost = math::constrain(-(max_out - 1.0f - min_out) / 2.0f, -max_thrust_diff, 0.0f);
-		roll_pitch_scale = (1 - (thrust + boost)) / (max_out - thrust);
-
-	} else if (min_out < 0.0f && max_out > 1.0f) {
-		boost = math::constrain(-(max_out - 1.0f + min_out) / 2.0f, thrust_decrease_factor * thrust - thrust,
-					thrust_increase_factor * thrust - thrust);
-		roll_pitch_scale = (thrust + boost) / (thrust - min_out);
-	}
+	compute_boost(thrust, min_out, max_out, boost, roll_pitch_scale);
 
 	// capture saturation
 	if (min_out < 0.0f) {
@@ -363,6 +475,14 @@ MultirotorMixer::mix(float *outputs, unsigned space)
 
 	}
 
+	limit_outputs(outputs);
+
+	return _rotor_count;
+}
+
+void
+MultirotorMixer::limit_outputs(float *outputs)
+{
 	/* slew rate limiting and saturation checking */
 	for (unsigned i = 0; i < _rotor_count; i++) {
 		bool clipping_high = false;
@@ -395,13 +515,116 @@ MultirotorMixer::mix(float *outputs, unsigned space)
 		_outputs_prev[i] = outputs[i];
 
 		// update the saturation status report
-		update_saturation_status(i, clipping_high, clipping_low);
+		if (single_pass()) {
+			_saturation_status.value |= (clipping_high ? _tables->saturation_high[i] : 0) |
+						    (clipping_low ? _tables->saturation_low[i] : 0);
+
+		} else {
+			update_saturation_status(i, clipping_high, clipping_low);
+		}
 	}
 
+	_saturation_status.flags.valid = true;
+
 	// this will force the caller of the mixer to always supply new slew rate values, otherwise no slew rate limiting will happen
 	_delta_out_max = 0.0f;
+}
 
-	return _rotor_count;
+PX4_FAST_CODE unsigned
+MultirotorMixer::mix_single_pass(float *outputs)
+{
+	/* same strategy as mix(), but on the struct-of-arrays tables and with yaw limited in closed form */
+	const RotorTables &t = *_tables;
+	const unsigned n = _rotor_count;
+
+	float		roll    = math::constrain(get_control(0, 0) * _roll_scale, -1.0f, 1.0f);
+	float		pitch   = math::constrain(get_control(0, 1) * _pitch_scale, -1.0f, 1.0f);
+	float		yaw     = math::constrain(get_control(0, 2) * _yaw_scale, -1.0f, 1.0f);
+	float		thrust  = math::constrain(get_control(0, 3), 0.0f, 1.0f);
+	float		min_out = 1.0f;
+	float		max_out = 0.0f;
+
+	_saturation_status.value = 0;
+
+	/* roll/pitch mix, kept in outputs[] for the next passes */
+	for (unsigned i = 0; i < n; i++) {
+		const float roll_pitch = roll * t.roll[i] + pitch * t.pitch[i];
+		const float out = (roll_pitch + thrust) * t.out[i];
+		outputs[i] = roll_pitch;
+		min_out = math::min(min_out, out);
+		max_out = math::max(max_out, out);
+	}
+
+	float boost = 0.0f;
+	float roll_pitch_scale = 1.0f;
+
+	compute_boost(thrust, min_out, max_out, boost, roll_pitch_scale);
+
+	if (min_out < 0.0f) {
+		_saturation_status.flags.motor_neg = true;
+	}
+
+	if (max_out > 1.0f) {
+		_saturation_status.flags.motor_pos = true;
+	}
+
+	/* apply the roll/pitch scale and the boost, and check the range of the yaw mix */
+	min_out = 1.0f;
+	max_out = 0.0f;
+
+	for (unsigned i = 0; i < n; i++) {
+		outputs[i] = outputs[i] * roll_pitch_scale + thrust + boost;
+		const float out = outputs[i] + yaw * t.yaw[i];
+		min_out = math::min(min_out, out);
+		max_out = math::max(max_out, out);
+	}
+
+	if (min_out < 0.0f || max_out > 1.0f) {
+		/* reduce the collective thrust by up to 0.15 if the yaw mix exceeds the upper limit */
+		const float thrust_reduction = math::constrain(max_out - 1.0f, 0.0f, 0.15f);
+
+		/* each rotor bounds yaw to the range that keeps its output within [0, 1] */
+		float yaw_min = -1.0f;
+		float yaw_max = 1.0f;
+
+		for (unsigned i = 0; i < n; i++) {
+			outputs[i] -= thrust_reduction;
+			const float yaw_low = -outputs[i] * t.yaw_inv[i];
+			const float yaw_high = (1.0f - outputs[i]) * t.yaw_inv[i];
+			yaw_min = math::max(yaw_min, math::min(yaw_low, yaw_high) - t.yaw_free[i]);
+			yaw_max = math::min(yaw_max, math::max(yaw_low, yaw_high) + t.yaw_free[i]);
+		}
+
+		if (yaw_min <= yaw_max) {
+			yaw = math::constrain(yaw, yaw_min, yaw_max);
+
+		} else {
+			/* no yaw keeps all outputs in range, split the violation */
+			yaw = 0.5f * (yaw_min + yaw_max);
+		}
+	}
+
+	for (unsigned i = 0; i < n; i++) {
+		outputs[i] += yaw * t.yaw[i];
+	}
+
+	/* thrust model, see mix() */
+	if (_thrust_factor > 0.0f) {
+		const float a = (1.0f - _thrust_factor) / (2.0f * _thrust_factor);
+		const float a2 = a * a;
+
+		for (unsigned i = 0; i < n; i++) {
+			outputs[i] = -a + sqrtf(a2 + math::max(outputs[i], 0.0f) / _thrust_factor);
+		}
+	}
+
+	for (unsigned i = 0; i < n; i++) {
+		outputs[i] = math::constrain(_idle_speed + (outputs[i] * (1.0f - _idle_speed)), _idle_speed, 1.0f);
+	}
+
+	limit_outputs(outputs);
+
+	return n;
 }
 
 /*
@@ -223,6 +223,44 @@ out:
 	return sm;
 }
 
+SimpleMixer *
+SimpleMixer::from_binary(Mixer::ControlCallback control_cb, uintptr_t cb_handle, const void *data, unsigned length)
+{
+	/* the record layout is the one of mixer_simple_s, which is also what the generator produces */
+	static_assert(sizeof(mixer_scaler_s) == 20 && sizeof(mixer_control_s) == 24 && sizeof(mixer_simple_s) == 24,
+		      "binary mixer format: unexpected layout of mixer_simple_s");
+
+	if (length < MIXER_SIMPLE_SIZE(0)) {
+		debug("simple record too short: %u", length);
+		return nullptr;
+	}
+
+	const unsigned inputs = ((const mixer_simple_s *)data)->control_count;
+
+	if (length != MIXER_SIMPLE_SIZE(inputs)) {
+		debug("simple record with %u input(s) has invalid length %u", inputs, length);
+		return nullptr;
+	}
+
+	mixer_simple_s *mixinfo = (mixer_simple_s *)malloc(length);
+
+	if (mixinfo == nullptr) {
+		debug("could not allocate memory for mixer info");
+		return nullptr;
+	}
+
+	memcpy(mixinfo, data, length);
+
+	SimpleMixer *sm = new SimpleMixer(control_cb, cb_handle, mixinfo);
+
+	if (sm == nullptr) {
+		debug("could not allocate memory for mixer");
+		free(mixinfo);
+	}
+
+	return sm;
+}
+
 SimpleMixer *
 SimpleMixer::pwm_input(Mixer::ControlCallback control_cb, uintptr_t cb_handle, unsigned input, uint16_t min,
 		       uint16_t mid, uint16_t max)
@@ -256,6 +256,12 @@ def printScaleTablesCounts():
         print("\t{}, /* {} */".format(len(table), variableName(table)))
     print("};\n")
 
+def printScaleTablesNames():
+    print("const char *_config_name[] = {")
+    for table in tables:
+        print("\t\"{}\",".format(variableName(table)))
+    print("};\n")
+
 
 
 printEnum()
@@ -264,6 +270,7 @@ print("namespace {")
 printScaleTables()
 printScaleTablesIndex()
 printScaleTablesCounts()
+printScaleTablesNames()
 
 print("} // anonymous namespace\n")
 print("#endif /* _MIXER_MULTI_TABLES */")
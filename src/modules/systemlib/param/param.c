@@ -46,6 +46,7 @@
 #include <px4_posix.h>
 #include <px4_config.h>
 #include <px4_shutdown.h>
+#include <stdio.h>
 #include <string.h>
 #include <stdbool.h>
 #include <float.h>
@@ -99,6 +100,25 @@ static char *param_user_file = NULL;
 #define PARAM_CLOSE	close
 #endif
 
+#define PARAM_IMPORT_BUFFER_SIZE	512 ///< read chunk size when importing a parameter file
+
+#if !defined(FLASH_BASED_PARAMS) && !defined(__PX4_QURT)
+/*
+ * Journal of the parameter changes next to the parameter file: the autosave appends
+ * a BSON document with the unsaved parameters to it instead of rewriting the file.
+ * It is replayed after loading the file, and compacted (the full file is written and
+ * the journal removed) after loading and when it grows too large.
+ */
+#define PARAM_JOURNAL
+#define PARAM_JOURNAL_SUFFIX	".jnl"
+#define PARAM_JOURNAL_MAX_SIZE	4096
+#define PARAM_JOURNAL_PATH_MAX	128
+static bool param_journal_compaction_required = true; ///< the journal cannot represent the changes, write the full file
+static px4_sem_t param_sem_file; ///< serializes the file writes with the journal appends
+static int param_save_journal(void);
+static int param_import_internal(int fd, bool mark_saved, bool reset);
+#endif
+
 #ifndef PARAM_NO_AUTOSAVE
 #include <px4_workqueue.h>
 /* autosaving variables */
@@ -108,6 +128,21 @@ static bool autosave_scheduled = false;
 static bool autosave_disabled = false;
 #endif /* PARAM_NO_AUTOSAVE */
 
+#if !defined(PARAM_NO_ORB) && !defined(PARAM_NO_AUTOSAVE)
+/*
+ * Deferred parameter_update: single parameter changes are published after a quiet period
+ * without further changes (SYS_PARAM_QUIET), so that a burst of changes (e.g. a GCS setting
+ * many parameters) makes every module reload its parameters once instead of for every change.
+ */
+#define PARAM_NOTIFY_DEFERRED
+#define PARAM_NOTIFY_MAX_DELAY	(2000 * 1000) ///< publish at the latest this long after the first deferred change
+static struct work_s notify_work;
+static bool notify_scheduled = false;
+static hrt_abstime notify_first_change = 0;
+static hrt_abstime notify_last_change = 0;
+static param_t notify_quiet_param = PARAM_INVALID;
+#endif
+
 /**
  * Array of static parameter info.
  */
@@ -149,12 +184,51 @@ get_param_info_count(void)
 	return param_info_count;
 }
 
+/** cached result of param_hash_check(), invalidated on every change */
+static uint32_t param_hash = 0;
+static bool param_hash_valid = false;
+
+/** ring buffer of the most recently changed parameters, see param_changed_since() */
+static param_t param_change_history[PARAM_CHANGE_HISTORY_SIZE];
+static uint32_t param_change_counter = 0; ///< number of changes since boot
+static uint32_t param_change_history_start = 0; ///< change counter of the oldest valid history entry
+
+/** record a change of a parameter value (must be called with the lock held) */
+static void
+param_record_change(param_t param)
+{
+	param_change_history[param_change_counter % PARAM_CHANGE_HISTORY_SIZE] = param;
+	++param_change_counter;
+
+	if (param_change_counter - param_change_history_start > PARAM_CHANGE_HISTORY_SIZE) {
+		param_change_history_start = param_change_counter - PARAM_CHANGE_HISTORY_SIZE;
+	}
+
+	param_hash_valid = false;
+}
+
+/** record a change that cannot be described by the history, e.g. a reset of all parameters */
+static void
+param_record_change_all(void)
+{
+	++param_change_counter;
+	param_change_history_start = param_change_counter;
+	param_hash_valid = false;
+}
+
 /** flexible array holding modified parameter values */
 FLASH_PARAMS_EXPOSE UT_array        *param_values;
 
 /** array info for the modified parameters array */
 FLASH_PARAMS_EXPOSE const UT_icd    param_icd = {sizeof(struct param_wbuf_s), NULL, NULL, NULL};
 
+/**
+ * Current values of the int32 and float parameters (default or modified), indexed
+ * by param_t, so that param_get() is a lock-free load for these. Written under the
+ * writer lock, along with param_values. Struct parameters are not cached.
+ */
+static volatile int32_t *param_current_values = NULL;
+
 #if !defined(PARAM_NO_ORB)
 /** parameter update topic handle */
 static orb_advert_t param_topic = NULL;
@@ -229,12 +303,36 @@ param_assert_locked(void)
 	/* XXX */
 }
 
+/**
+ * Update the cached current value of an int32 or float parameter.
+ */
+static void
+param_update_current_value(param_t param, const union param_value_u *val)
+{
+	const enum param_type_e type = param_type(param);
+
+	if (param_current_values != NULL && (type == PARAM_TYPE_INT32 || type == PARAM_TYPE_FLOAT)) {
+		/* the float shares the storage of the int32 */
+		param_current_values[param] = val->i;
+	}
+}
+
 void
 param_init(void)
 {
 	px4_sem_init(&param_sem, 0, 1);
 	px4_sem_init(&param_sem_save, 0, 1);
 	px4_sem_init(&reader_lock_holders_lock, 0, 1);
+#ifdef PARAM_JOURNAL
+	px4_sem_init(&param_sem_file, 0, 1);
+#endif
+
+	/* no parameter is modified yet: start from the defaults */
+	param_current_values = (volatile int32_t *)malloc(param_info_count * sizeof(int32_t));
+
+	for (param_t param = 0; param_current_values != NULL && param < param_info_count; param++) {
+		param_update_current_value(param, &param_info_base[param].val);
+	}
 }
 
 /**
@@ -295,15 +393,19 @@ param_find_changed(param_t param)
 	return s;
 }
 
+static uint32_t param_notified_change_count = 0; ///< change_count of the last parameter_update
+
 static void
 _param_notify_changes(void)
 {
 #if !defined(PARAM_NO_ORB)
 	struct parameter_update_s pup = {
 		.timestamp = hrt_absolute_time(),
-		.dummy = 0
+		.change_count = param_change_counter
 	};
 
+	param_notified_change_count = pup.change_count;
+
 	/*
 	 * If we don't have a handle to our topic, create one now; otherwise
 	 * just publish.
@@ -324,6 +426,91 @@ param_notify_changes(void)
 	_param_notify_changes();
 }
 
+#ifdef PARAM_NOTIFY_DEFERRED
+/** @return the quiet period in us, 0 if disabled (must be called without the lock held) */
+static hrt_abstime
+param_notify_quiet_period(void)
+{
+	if (notify_quiet_param == PARAM_INVALID) {
+		notify_quiet_param = param_find("SYS_PARAM_QUIET");
+	}
+
+	int32_t quiet_ms = 0;
+
+	if (notify_quiet_param == PARAM_INVALID || param_get(notify_quiet_param, &quiet_ms) != 0 || quiet_ms <= 0) {
+		return 0;
+	}
+
+	return (hrt_abstime)quiet_ms * 1000;
+}
+
+/**
+ * worker callback publishing the deferred changes once there was no change for the quiet period
+ * @param arg unused
+ */
+static void
+notify_worker(void *arg)
+{
+	const hrt_abstime quiet_period = param_notify_quiet_period();
+
+	param_lock_writer();
+
+	const hrt_abstime now = hrt_absolute_time();
+	hrt_abstime publish_time = notify_last_change + quiet_period;
+
+	if (publish_time > notify_first_change + PARAM_NOTIFY_MAX_DELAY) {
+		publish_time = notify_first_change + PARAM_NOTIFY_MAX_DELAY;
+	}
+
+	if (now < publish_time) {
+		/* changed again in the meantime */
+		work_queue(LPWORK, &notify_work, (worker_t)&notify_worker, NULL, USEC2TICK(publish_time - now));
+		param_unlock_writer();
+		return;
+	}
+
+	notify_scheduled = false;
+	const bool published = param_notified_change_count == param_change_counter;
+
+	param_unlock_writer();
+
+	/* an immediate notification might already have covered the changes */
+	if (!published) {
+		_param_notify_changes();
+	}
+}
+#endif /* PARAM_NOTIFY_DEFERRED */
+
+/**
+ * Notify about a change of a single parameter: deferred until the end of a burst of changes.
+ * Callers that need the change to be announced immediately call param_notify_changes() after
+ * setting it, which also makes the deferred notification a no-op.
+ */
+static void
+param_notify_change_deferred(void)
+{
+#ifdef PARAM_NOTIFY_DEFERRED
+	const hrt_abstime quiet_period = param_notify_quiet_period();
+
+	if (quiet_period > 0) {
+		param_lock_writer();
+		notify_last_change = hrt_absolute_time();
+
+		if (!notify_scheduled) {
+			notify_scheduled = true;
+			notify_first_change = notify_last_change;
+			work_queue(LPWORK, &notify_work, (worker_t)&notify_worker, NULL, USEC2TICK(quiet_period));
+		}
+
+		param_unlock_writer();
+		return;
+	}
+
+#endif /* PARAM_NOTIFY_DEFERRED */
+
+	_param_notify_changes();
+}
+
 param_t
 param_find_internal(const char *name, bool notification)
 {
@@ -372,6 +559,33 @@ param_find_no_notification(const char *name)
 	return param_find_internal(name, false);
 }
 
+/**
+ * Find a parameter, scanning forward from a cursor.
+ *
+ * Parameter files are written in handle order, which is the name order of
+ * param_info_base, so consecutive lookups during an import are a single merged
+ * pass over the table. Falls back to the binary search for out of order names.
+ *
+ * @param cursor	First handle to compare against, advanced past a match
+ */
+static param_t
+param_find_sorted(const char *name, param_t *cursor)
+{
+	for (param_t param = *cursor; handle_in_range(param); param++) {
+		int ret = strcmp(name, param_info_base[param].name);
+
+		if (ret == 0) {
+			*cursor = param + 1;
+			return param;
+
+		} else if (ret < 0) {
+			break;
+		}
+	}
+
+	return param_find_no_notification(name);
+}
+
 unsigned
 param_count(void)
 {
@@ -578,6 +792,14 @@ param_get(param_t param, void *val)
 {
 	int result = -1;
 
+	if (val && param_current_values != NULL && handle_in_range(param)
+	    && (param_type(param) == PARAM_TYPE_INT32 || param_type(param) == PARAM_TYPE_FLOAT)) {
+		/* an aligned 32-bit load is atomic, no lock needed */
+		const int32_t v = param_current_values[param];
+		memcpy(val, &v, sizeof(v));
+		return 0;
+	}
+
 	param_lock_reader();
 
 	const void *v = param_get_value_ptr(param);
@@ -614,7 +836,11 @@ autosave_worker(void *arg)
 	}
 
 	PX4_DEBUG("Autosaving params");
+#ifdef PARAM_JOURNAL
+	int ret = param_save_journal();
+#else
 	int ret = param_save_default();
+#endif
 
 	if (ret != 0) {
 		PX4_ERR("param save failed (%i)", ret);
@@ -672,13 +898,16 @@ param_control_autosave(bool enable)
 }
 
 
+/**
+ * Set a parameter value, with the writer lock held.
+ *
+ * @param params_changed	Set to true if the value changed
+ * @return			0 on success
+ */
 static int
-param_set_internal(param_t param, const void *val, bool mark_saved, bool notify_changes)
+param_set_locked(param_t param, const void *val, bool mark_saved, bool *params_changed)
 {
-	int result = -1;
-	bool params_changed = false;
-
-	param_lock_writer();
+	bool changed = false;
 
 	if (param_values == NULL) {
 		utarray_new(param_values, &param_icd);
@@ -686,78 +915,104 @@ param_set_internal(param_t param, const void *val, bool mark_saved, bool notify_
 
 	if (param_values == NULL) {
 		debug("failed to allocate modified values array");
-		goto out;
+		return -1;
 	}
 
-	if (handle_in_range(param)) {
+	if (!handle_in_range(param)) {
+		return -1;
+	}
 
-		struct param_wbuf_s *s = param_find_changed(param);
+	struct param_wbuf_s *s = param_find_changed(param);
+
+	if (s == NULL) {
+
+		/* construct a new parameter */
+		struct param_wbuf_s buf = {
+			.param = param,
+			.val.p = NULL,
+			.unsaved = false
+		};
+		changed = true;
+
+		/* imports come in ascending order: only sort if the new entry does not go to the end */
+		struct param_wbuf_s *last = (struct param_wbuf_s *)utarray_back(param_values);
+		const bool sorted = (last == NULL || last->param < param);
 
-		if (s == NULL) {
+		utarray_push_back(param_values, &buf);
 
-			/* construct a new parameter */
-			struct param_wbuf_s buf = {
-				.param = param,
-				.val.p = NULL,
-				.unsaved = false
-			};
-			params_changed = true;
+		if (sorted) {
+			s = (struct param_wbuf_s *)utarray_back(param_values);
 
-			/* add it to the array and sort */
-			utarray_push_back(param_values, &buf);
+		} else {
 			utarray_sort(param_values, param_compare_values);
 
 			/* find it after sorting */
 			s = param_find_changed(param);
 		}
+	}
 
-		/* update the changed value */
-		switch (param_type(param)) {
+	/* update the changed value */
+	switch (param_type(param)) {
 
-		case PARAM_TYPE_INT32:
-			params_changed = params_changed || s->val.i != *(int32_t *)val;
-			s->val.i = *(int32_t *)val;
-			break;
+	case PARAM_TYPE_INT32:
+		changed = changed || s->val.i != *(int32_t *)val;
+		s->val.i = *(int32_t *)val;
+		break;
 
-		case PARAM_TYPE_FLOAT:
-			params_changed = params_changed || fabsf(s->val.f - * (float *)val) > FLT_EPSILON;
-			s->val.f = *(float *)val;
-			break;
+	case PARAM_TYPE_FLOAT:
+		changed = changed || fabsf(s->val.f - * (float *)val) > FLT_EPSILON;
+		s->val.f = *(float *)val;
+		break;
 
-		case PARAM_TYPE_STRUCT ... PARAM_TYPE_STRUCT_MAX:
-			if (s->val.p == NULL) {
-				size_t psize = param_size(param);
+	case PARAM_TYPE_STRUCT ... PARAM_TYPE_STRUCT_MAX:
+		if (s->val.p == NULL) {
+			size_t psize = param_size(param);
 
-				if (psize > 0) {
-					s->val.p = malloc(psize);
+			if (psize > 0) {
+				s->val.p = malloc(psize);
 
-				} else {
-					s->val.p = NULL;
-				}
+			} else {
+				s->val.p = NULL;
+			}
 
-				if (s->val.p == NULL) {
-					debug("failed to allocate parameter storage");
-					goto out;
-				}
+			if (s->val.p == NULL) {
+				debug("failed to allocate parameter storage");
+				return -1;
 			}
+		}
 
-			memcpy(s->val.p, val, param_size(param));
-			params_changed = true;
-			break;
+		memcpy(s->val.p, val, param_size(param));
+		changed = true;
+		break;
 
-		default:
-			goto out;
-		}
+	default:
+		return -1;
+	}
 
-		s->unsaved = !mark_saved;
-		result = 0;
+	param_update_current_value(param, &s->val);
+	s->unsaved = !mark_saved;
 
-		if (!mark_saved) { // this is false when importing parameters
-			param_autosave();
-		}
+	if (changed) {
+		param_record_change(param);
+		*params_changed = true;
+	}
+
+	return 0;
+}
+
+static int
+param_set_internal(param_t param, const void *val, bool mark_saved, bool notify_changes)
+{
+	bool params_changed = false;
+
+	param_lock_writer();
+
+	int result = param_set_locked(param, val, mark_saved, &params_changed);
+
+	if (result == 0 && !mark_saved) { // this is false when importing parameters
+		param_autosave();
 	}
 
-out:
 	param_unlock_writer();
 
 	/*
@@ -765,7 +1020,7 @@ out:
 	 * a thing has been set.
 	 */
 	if (params_changed && notify_changes) {
-		_param_notify_changes();
+		param_notify_change_deferred();
 	}
 
 	return result;
@@ -816,9 +1071,16 @@ void param_set_used_internal(param_t param)
 		return;
 	}
 
-	// FIXME: this needs locking too
+	if (param_used(param)) {
+		return;
+	}
+
+	/* the set of used parameters changes, and with it the indices of the used parameters */
+	param_lock_writer();
 	param_changed_storage[param_index / bits_per_allocation_unit] |=
 		(1 << param_index % bits_per_allocation_unit);
+	param_record_change_all();
+	param_unlock_writer();
 }
 
 int
@@ -838,6 +1100,12 @@ param_reset(param_t param)
 		if (s != NULL) {
 			int pos = utarray_eltidx(param_values, s);
 			utarray_erase(param_values, pos, 1);
+			param_update_current_value(param, &param_info_base[param].val);
+			param_record_change(param);
+#ifdef PARAM_JOURNAL
+			/* the journal only holds values, not the removal of one */
+			param_journal_compaction_required = true;
+#endif
 		}
 
 		param_found = true;
@@ -853,11 +1121,12 @@ param_reset(param_t param)
 
 	return (!param_found);
 }
+/**
+ * Reset all parameters to their defaults, with the writer lock held.
+ */
 static void
-param_reset_all_internal(bool auto_save)
+param_reset_all_locked(void)
 {
-	param_lock_writer();
-
 	if (param_values != NULL) {
 		utarray_free(param_values);
 	}
@@ -865,6 +1134,24 @@ param_reset_all_internal(bool auto_save)
 	/* mark as reset / deleted */
 	param_values = NULL;
 
+	for (param_t param = 0; handle_in_range(param); param++) {
+		param_update_current_value(param, &param_info_base[param].val);
+	}
+
+	param_record_change_all();
+
+#ifdef PARAM_JOURNAL
+	param_journal_compaction_required = true;
+#endif
+}
+
+static void
+param_reset_all_internal(bool auto_save)
+{
+	param_lock_writer();
+
+	param_reset_all_locked();
+
 	if (auto_save) {
 		param_autosave();
 	}
@@ -921,6 +1208,10 @@ param_set_default_file(const char *filename)
 		param_user_file = strdup(filename);
 	}
 
+#ifdef PARAM_JOURNAL
+	param_journal_compaction_required = true;
+#endif
+
 	return 0;
 }
 
@@ -930,8 +1221,93 @@ param_get_default_file(void)
 	return (param_user_file != NULL) ? param_user_file : param_default_file;
 }
 
+#ifdef PARAM_JOURNAL
+static void
+param_journal_path(char *path, size_t size)
+{
+	snprintf(path, size, "%s" PARAM_JOURNAL_SUFFIX, param_get_default_file());
+}
+
+/**
+ * Check that the journal document at the current file position was written completely, so that
+ * an append torn by a power loss is not applied in part. The file position is not changed.
+ */
+static bool
+param_journal_document_complete(int fd, off_t file_size)
+{
+	const off_t start = lseek(fd, 0, SEEK_CUR);
+	int32_t len = 0;
+	uint8_t end = 0xff;
+
+	/* the document length is written first, the terminating zero last */
+	const bool complete = start >= 0 &&
+			      read(fd, &len, sizeof(len)) == sizeof(len) &&
+			      len > (int32_t)sizeof(len) && start + len <= file_size &&
+			      lseek(fd, start + len - 1, SEEK_SET) >= 0 &&
+			      read(fd, &end, sizeof(end)) == sizeof(end) && end == 0;
+
+	lseek(fd, start, SEEK_SET);
+	return complete;
+}
+
+/**
+ * Write all parameters to the parameter file, and remove the journal.
+ * Called with param_sem_file held.
+ */
+static int param_save_file(void);
+
 int
 param_save_default(void)
+{
+	do {} while (px4_sem_wait(&param_sem_file) != 0);
+
+	int res = param_save_file();
+
+	px4_sem_post(&param_sem_file);
+
+	return res;
+}
+
+static int
+param_save_journal(void)
+{
+	do {} while (px4_sem_wait(&param_sem_file) != 0);
+
+	char path[PARAM_JOURNAL_PATH_MAX];
+	param_journal_path(path, sizeof(path));
+	int res = -1;
+	int fd = -1;
+
+	if (!param_journal_compaction_required) {
+		fd = PARAM_OPEN(path, O_WRONLY | O_CREAT | O_APPEND, PX4_O_MODE_666);
+	}
+
+	if (fd >= 0) {
+		struct stat st;
+
+		if (fstat(fd, &st) == 0 && st.st_size < PARAM_JOURNAL_MAX_SIZE) {
+			res = param_export(fd, true);
+		}
+
+		PARAM_CLOSE(fd);
+	}
+
+	/* fall back to compacting if the journal is full or could not be written */
+	if (res != OK) {
+		res = param_save_file();
+	}
+
+	px4_sem_post(&param_sem_file);
+
+	return res;
+}
+
+static int
+param_save_file(void)
+#else
+int
+param_save_default(void)
+#endif
 {
 	int res;
 #if !defined(FLASH_BASED_PARAMS)
@@ -947,6 +1323,11 @@ param_save_default(void)
 		return ERROR;
 	}
 
+#ifdef PARAM_JOURNAL
+	/* cleared before the export, so that a parameter reset during it is not lost */
+	param_journal_compaction_required = false;
+#endif
+
 	res = 1;
 	int attempts = 5;
 
@@ -964,6 +1345,18 @@ param_save_default(void)
 	}
 
 	PARAM_CLOSE(fd);
+
+#ifdef PARAM_JOURNAL
+
+	/* the file holds everything now: the journal is obsolete */
+	char path[PARAM_JOURNAL_PATH_MAX];
+	param_journal_path(path, sizeof(path));
+
+	if (res != OK || (unlink(path) != 0 && errno != ENOENT)) {
+		param_journal_compaction_required = true;
+	}
+
+#endif
 #else
 	param_lock_writer();
 	res = flash_param_save();
@@ -1000,6 +1393,41 @@ param_load_default(void)
 		return -2;
 	}
 
+#ifdef PARAM_JOURNAL
+	/* replay the changes saved since the file was written */
+	char path[PARAM_JOURNAL_PATH_MAX];
+	param_journal_path(path, sizeof(path));
+	int fd_journal = PARAM_OPEN(path, O_RDONLY);
+
+	if (fd_journal >= 0) {
+		struct stat st;
+		int entries = 0;
+
+		if (fstat(fd_journal, &st) == 0) {
+			/* apply the documents on top of the file values (no reset), and stop at the first
+			 * incomplete document (e.g. power loss while appending) without applying any of it */
+			while (lseek(fd_journal, 0, SEEK_CUR) < st.st_size && param_journal_document_complete(fd_journal, st.st_size) &&
+			       param_import_internal(fd_journal, true, false) == 0) {
+				entries++;
+			}
+		}
+
+		PARAM_CLOSE(fd_journal);
+
+		if (entries > 0) {
+			PX4_INFO("replayed %i parameter journal entries", entries);
+		}
+
+		/* compact: write the merged parameters to the file */
+		param_save_default();
+
+	} else if (errno == ENOENT) {
+		/* the file matches the loaded parameters, changes can be journaled from now on */
+		param_journal_compaction_required = false;
+	}
+
+#endif
+
 #else
 	// no need for locking
 	res = flash_param_load();
@@ -1126,6 +1554,8 @@ out:
 
 struct param_import_state {
 	bool mark_saved;
+	bool params_changed;
+	param_t next;		///< lookup cursor, see param_find_sorted()
 };
 
 static int
@@ -1150,7 +1580,7 @@ param_import_callback(bson_decoder_t decoder, void *private, bson_node_t node)
 	 * Find the parameter this node represents.  If we don't know it,
 	 * ignore the node.
 	 */
-	param_t param = param_find_no_notification(node->name);
+	param_t param = param_find_sorted(node->name, &state->next);
 
 	if (param == PARAM_INVALID) {
 		debug("ignoring unrecognised parameter '%s'", node->name);
@@ -1225,7 +1655,7 @@ param_import_callback(bson_decoder_t decoder, void *private, bson_node_t node)
 		goto out;
 	}
 
-	if (param_set_internal(param, v, state->mark_saved, true)) {
+	if (param_set_locked(param, v, state->mark_saved, &state->params_changed)) {
 		debug("error setting value for '%s'", node->name);
 		goto out;
 	}
@@ -1247,25 +1677,51 @@ out:
 	return result;
 }
 
+/**
+ * Import parameters from a file, applying all of them under a single writer
+ * lock and sending a single change notification at the end.
+ *
+ * @param reset		reset all parameters to their defaults first
+ */
 static int
-param_import_internal(int fd, bool mark_saved)
+param_import_internal(int fd, bool mark_saved, bool reset)
 {
 	struct bson_decoder_s decoder;
 	int result = -1;
-	struct param_import_state state;
+	struct param_import_state state = {
+		.mark_saved = mark_saved,
+		.params_changed = reset,
+		.next = 0
+	};
+	void *buf = NULL;
 
+	param_lock_writer();
 
-	if (bson_decoder_init_file(&decoder, fd, param_import_callback, &state)) {
-		debug("decoder init failed");
-		goto out;
+	if (reset) {
+		param_reset_all_locked();
 	}
 
+#ifndef __PX4_QURT
+	/* read the file in chunks rather than one byte at a time */
+	buf = malloc(PARAM_IMPORT_BUFFER_SIZE);
+#endif
+
+	if (buf != NULL) {
+		result = bson_decoder_init_file_buffered(&decoder, fd, buf, PARAM_IMPORT_BUFFER_SIZE, param_import_callback,
+				&state);
+
+	} else {
+		result = bson_decoder_init_file(&decoder, fd, param_import_callback, &state);
+	}
 
-	state.mark_saved = mark_saved;
+	if (result) {
+		debug("decoder init failed");
+		result = -1;
+		goto out;
+	}
 
 	do {
 		result = bson_decoder_next(&decoder);
-		usleep(1);
 
 	} while (result > 0);
 
@@ -1275,6 +1731,20 @@ out:
 		debug("BSON error decoding parameters");
 	}
 
+	if (state.params_changed && !mark_saved) {
+		param_autosave();
+	}
+
+	param_unlock_writer();
+
+	if (buf != NULL) {
+		free(buf);
+	}
+
+	if (state.params_changed) {
+		_param_notify_changes();
+	}
+
 	return result;
 }
 
@@ -1282,7 +1752,7 @@ int
 param_import(int fd)
 {
 #if !defined(FLASH_BASED_PARAMS)
-	return param_import_internal(fd, false);
+	return param_import_internal(fd, false, false);
 #else
 	(void)fd; // unused
 	// no need for locking here
@@ -1293,8 +1763,7 @@ param_import(int fd)
 int
 param_load(int fd)
 {
-	param_reset_all_internal(false);
-	return param_import_internal(fd, true);
+	return param_import_internal(fd, true, true);
 }
 
 void
@@ -1319,10 +1788,16 @@ param_foreach(void (*func)(void *arg, param_t param), void *arg, bool only_chang
 
 uint32_t param_hash_check(void)
 {
-	uint32_t param_hash = 0;
-
 	param_lock_reader();
 
+	if (param_hash_valid) {
+		uint32_t hash = param_hash;
+		param_unlock_reader();
+		return hash;
+	}
+
+	uint32_t hash = 0;
+
 	/* compute the CRC32 over all string param names and 4 byte values */
 	for (param_t param = 0; handle_in_range(param); param++) {
 		if (!param_used(param)) {
@@ -1331,11 +1806,78 @@ uint32_t param_hash_check(void)
 
 		const char *name = param_name(param);
 		const void *val = param_get_value_ptr(param);
-		param_hash = crc32part((const uint8_t *)name, strlen(name), param_hash);
-		param_hash = crc32part(val, param_size(param), param_hash);
+		hash = crc32part((const uint8_t *)name, strlen(name), hash);
+		hash = crc32part(val, param_size(param), hash);
 	}
 
+	/* concurrent readers store the same value, writers are excluded by the lock */
+	param_hash = hash;
+	param_hash_valid = true;
+
 	param_unlock_reader();
 
-	return param_hash;
+	return hash;
+}
+
+uint32_t param_change_count(void)
+{
+	return param_change_counter;
+}
+
+int param_changed_since(uint32_t change_count, param_t *changed, int max_changed)
+{
+	int num_changed = 0;
+
+	param_lock_reader();
+
+	if (change_count < param_change_history_start || change_count > param_change_counter) {
+		num_changed = -1;
+	}
+
+	for (uint32_t i = change_count; num_changed >= 0 && i != param_change_counter; i++) {
+		param_t param = param_change_history[i % PARAM_CHANGE_HISTORY_SIZE];
+		bool duplicate = false;
+
+		for (int j = 0; j < num_changed; j++) {
+			if (changed[j] == param) {
+				duplicate = true;
+				break;
+			}
+		}
+
+		if (duplicate) {
+			continue;
+		}
+
+		if (num_changed >= max_changed) {
+			num_changed = -1;
+
+		} else {
+			changed[num_changed++] = param;
+		}
+	}
+
+	param_unlock_reader();
+
+	return num_changed;
+}
+
+bool param_group_changed_since(uint32_t change_count, const char *prefix)
+{
+	param_t changed[PARAM_CHANGE_HISTORY_SIZE];
+	const int num_changed = param_changed_since(change_count, changed, PARAM_CHANGE_HISTORY_SIZE);
+
+	if (num_changed < 0) {
+		return true;
+	}
+
+	const size_t prefix_len = strlen(prefix);
+
+	for (int i = 0; i < num_changed; i++) {
+		if (strncmp(param_name(changed[i]), prefix, prefix_len) == 0) {
+			return true;
+		}
+	}
+
+	return false;
 }
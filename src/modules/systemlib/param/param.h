@@ -241,6 +241,10 @@ __EXPORT int		param_get(param_t param, void *val);
 /**
  * Set the value of a parameter.
  *
+ * The announcement of the change to the system (parameter_update) can be deferred until no
+ * other parameter changed for SYS_PARAM_QUIET, so that a burst of changes is announced only
+ * once. Call param_notify_changes() afterwards if the change must be announced immediately.
+ *
  * @param param		A handle returned by param_find or passed by param_foreach.
  * @param val		The value to set; assumed to point to a variable of the parameter type.
  *			For structures, the pointer is assumed to point to a structure to be copied.
@@ -260,7 +264,8 @@ __EXPORT int		param_set_no_notification(param_t param, const void *val);
 
 /**
  * Notify the system about parameter changes. Can be used for example after several calls to
- * param_set_no_notification() to avoid unnecessary system notifications.
+ * param_set_no_notification() to avoid unnecessary system notifications, or after param_set()
+ * to announce the change immediately instead of after the SYS_PARAM_QUIET period.
  */
 __EXPORT void param_notify_changes(void);
 
@@ -378,11 +383,49 @@ __EXPORT int 		param_load_default(void);
 
 /**
  * Generate the hash of all parameters and their values
+ * The hash is cached, and only recomputed after a parameter change.
  *
  * @return		CRC32 hash of all param_ids and values
  */
 __EXPORT uint32_t	param_hash_check(void);
 
+/**
+ * Number of parameter changes that are kept in the history for param_changed_since()
+ */
+#define PARAM_CHANGE_HISTORY_SIZE 32
+
+/**
+ * Get the parameter change counter, which is incremented on every change of a
+ * parameter value and of the set of used parameters.
+ *
+ * @return		Number of changes since boot
+ */
+__EXPORT uint32_t	param_change_count(void);
+
+/**
+ * Get the parameters which changed since a given change count, from the history
+ * of the most recent changes.
+ *
+ * @param change_count	A value returned by param_change_count()
+ * @param changed	Filled with the changed parameters, each one listed once
+ * @param max_changed	Size of changed
+ * @return		Number of parameters written to changed, or -1 if the history does not
+ *			go back far enough or the set of used parameters changed, meaning that
+ *			all parameters need to be considered changed.
+ */
+__EXPORT int		param_changed_since(uint32_t change_count, param_t *changed, int max_changed);
+
+/**
+ * Check whether a parameter of a group changed since a given change count.
+ *
+ * @param change_count	A value returned by param_change_count(), or the change_count of a
+ *			parameter_update message
+ * @param prefix	Name prefix of the group, e.g. "MPC_"
+ * @return		true if a parameter of the group changed, or if this cannot be determined
+ *			(see param_changed_since())
+ */
+__EXPORT bool		param_group_changed_since(uint32_t change_count, const char *prefix);
+
 
 /**
  * Enable/disable the param autosaving.
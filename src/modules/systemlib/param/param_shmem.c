@@ -160,6 +160,38 @@ get_param_info_count(void)
 	return param_info_count;
 }
 
+/** cached result of param_hash_check(), invalidated on every change */
+static uint32_t param_hash = 0;
+static bool param_hash_valid = false;
+
+/** ring buffer of the most recently changed parameters, see param_changed_since() */
+static param_t param_change_history[PARAM_CHANGE_HISTORY_SIZE];
+static uint32_t param_change_counter = 0; ///< number of changes since boot
+static uint32_t param_change_history_start = 0; ///< change counter of the oldest valid history entry
+
+/** record a change of a parameter value (must be called with the lock held) */
+static void
+param_record_change(param_t param)
+{
+	param_change_history[param_change_counter % PARAM_CHANGE_HISTORY_SIZE] = param;
+	++param_change_counter;
+
+	if (param_change_counter - param_change_history_start > PARAM_CHANGE_HISTORY_SIZE) {
+		param_change_history_start = param_change_counter - PARAM_CHANGE_HISTORY_SIZE;
+	}
+
+	param_hash_valid = false;
+}
+
+/** record a change that cannot be described by the history, e.g. a reset of all parameters */
+static void
+param_record_change_all(void)
+{
+	++param_change_counter;
+	param_change_history_start = param_change_counter;
+	param_hash_valid = false;
+}
+
 /** flexible array holding modified parameter values */
 UT_array	*param_values;
 
@@ -269,7 +301,7 @@ param_find_changed(param_t param)
 static void
 _param_notify_changes(void)
 {
-	struct parameter_update_s pup = { .timestamp = hrt_absolute_time(), .dummy = 0 };
+	struct parameter_update_s pup = { .timestamp = hrt_absolute_time(), .change_count = param_change_counter };
 
 	/*
 	 * If we don't have a handle to our topic, create one now; otherwise
@@ -731,6 +763,7 @@ param_set_internal(param_t param, const void *val, bool mark_saved, bool notify_
 
 		s->unsaved = !mark_saved;
 		params_changed = true;
+		param_record_change(param);
 		result = 0;
 
 		if (!mark_saved) { // this is false when importing parameters
@@ -811,8 +844,16 @@ void param_set_used_internal(param_t param)
 		return;
 	}
 
+	if (param_used(param)) {
+		return;
+	}
+
+	/* the set of used parameters changes, and with it the indices of the used parameters */
+	param_lock();
 	param_changed_storage[param_index / bits_per_allocation_unit] |=
 		(1 << param_index % bits_per_allocation_unit);
+	param_record_change_all();
+	param_unlock();
 }
 
 int
@@ -832,6 +873,7 @@ param_reset(param_t param)
 		if (s != NULL) {
 			int pos = utarray_eltidx(param_values, s);
 			utarray_erase(param_values, pos, 1);
+			param_record_change(param);
 		}
 
 		param_found = true;
@@ -858,6 +900,7 @@ param_reset_all_internal(bool auto_save)
 
 	/* mark as reset / deleted */
 	param_values = NULL;
+	param_record_change_all();
 
 	if (auto_save) {
 		param_autosave();
@@ -1316,10 +1359,16 @@ param_foreach(void (*func)(void *arg, param_t param), void *arg, bool only_chang
 
 uint32_t param_hash_check(void)
 {
-	uint32_t param_hash = 0;
-
 	param_lock();
 
+	if (param_hash_valid) {
+		uint32_t hash = param_hash;
+		param_unlock();
+		return hash;
+	}
+
+	uint32_t hash = 0;
+
 	/* compute the CRC32 over all string param names and 4 byte values */
 	for (param_t param = 0; handle_in_range(param); param++) {
 		if (!param_used(param)) {
@@ -1328,13 +1377,80 @@ uint32_t param_hash_check(void)
 
 		const char *name = param_name(param);
 		const void *val = param_get_value_ptr(param);
-		param_hash = crc32part((const uint8_t *)name, strlen(name), param_hash);
-		param_hash = crc32part(val, sizeof(union param_value_u), param_hash);
+		hash = crc32part((const uint8_t *)name, strlen(name), hash);
+		hash = crc32part(val, sizeof(union param_value_u), hash);
 	}
 
+	/* concurrent readers store the same value, writers are excluded by the lock */
+	param_hash = hash;
+	param_hash_valid = true;
+
 	param_unlock();
 
-	return param_hash;
+	return hash;
+}
+
+uint32_t param_change_count(void)
+{
+	return param_change_counter;
+}
+
+int param_changed_since(uint32_t change_count, param_t *changed, int max_changed)
+{
+	int num_changed = 0;
+
+	param_lock();
+
+	if (change_count < param_change_history_start || change_count > param_change_counter) {
+		num_changed = -1;
+	}
+
+	for (uint32_t i = change_count; num_changed >= 0 && i != param_change_counter; i++) {
+		param_t param = param_change_history[i % PARAM_CHANGE_HISTORY_SIZE];
+		bool duplicate = false;
+
+		for (int j = 0; j < num_changed; j++) {
+			if (changed[j] == param) {
+				duplicate = true;
+				break;
+			}
+		}
+
+		if (duplicate) {
+			continue;
+		}
+
+		if (num_changed >= max_changed) {
+			num_changed = -1;
+
+		} else {
+			changed[num_changed++] = param;
+		}
+	}
+
+	param_unlock();
+
+	return num_changed;
+}
+
+bool param_group_changed_since(uint32_t change_count, const char *prefix)
+{
+	param_t changed[PARAM_CHANGE_HISTORY_SIZE];
+	const int num_changed = param_changed_since(change_count, changed, PARAM_CHANGE_HISTORY_SIZE);
+
+	if (num_changed < 0) {
+		return true;
+	}
+
+	const size_t prefix_len = strlen(prefix);
+
+	for (int i = 0; i < num_changed; i++) {
+		if (strncmp(param_name(changed[i]), prefix, prefix_len) == 0) {
+			return true;
+		}
+	}
+
+	return false;
 }
 
 void init_params(void)
@@ -47,6 +47,7 @@
 #include <systemlib/err.h>
 
 #include "perf_counter.h"
+#include "trace.h"
 
 
 #ifdef __PX4_QURT
@@ -85,6 +86,14 @@ struct perf_ctr_elapsed {
 	float			M2;
 };
 
+/**
+ * PC_HISTOGRAM counter.
+ */
+struct perf_ctr_histogram {
+	struct perf_ctr_elapsed	elapsed;	/**< must be first, the elapsed code paths are shared */
+	uint32_t		buckets[PERF_HISTOGRAM_BUCKETS];
+};
+
 /**
  * PC_INTERVAL counter.
  */
@@ -116,6 +125,9 @@ pthread_mutex_t perf_counters_mutex = PTHREAD_MUTEX_INITIALIZER;
 // The same holds for shared perf counters (perf_alloc_once), that can be updated
 // concurrently (this affects the 'ctrl_latency' counter).
 
+static void perf_update_elapsed(struct perf_ctr_elapsed *pce, int64_t elapsed);
+static unsigned perf_histogram_index(uint32_t elapsed);
+static int perf_print_histogram_buffer(char *buffer, int length, const struct perf_ctr_histogram *pch);
 
 perf_counter_t
 perf_alloc(enum perf_counter_type type, const char *name)
@@ -136,6 +148,10 @@ perf_alloc(enum perf_counter_type type, const char *name)
 
 		break;
 
+	case PC_HISTOGRAM:
+		ctr = (perf_counter_t)calloc(sizeof(struct perf_ctr_histogram), 1);
+		break;
+
 	default:
 		break;
 	}
@@ -261,6 +277,8 @@ perf_begin(perf_counter_t handle)
 
 	switch (handle->type) {
 	case PC_ELAPSED:
+	case PC_HISTOGRAM:
+		TRACE_EVENT(TRACE_EVENT_PERF_BEGIN, 0, handle->name);
 		((struct perf_ctr_elapsed *)handle)->time_start = hrt_absolute_time();
 		break;
 
@@ -277,34 +295,13 @@ perf_end(perf_counter_t handle)
 	}
 
 	switch (handle->type) {
-	case PC_ELAPSED: {
+	case PC_ELAPSED:
+	case PC_HISTOGRAM: {
 			struct perf_ctr_elapsed *pce = (struct perf_ctr_elapsed *)handle;
+			TRACE_EVENT(TRACE_EVENT_PERF_END, 0, handle->name);
 
 			if (pce->time_start != 0) {
-				int64_t elapsed = hrt_absolute_time() - pce->time_start;
-
-				if (elapsed >= 0) {
-
-					pce->event_count++;
-					pce->time_total += elapsed;
-
-					if ((pce->time_least > (uint32_t)elapsed) || (pce->time_least == 0)) {
-						pce->time_least = elapsed;
-					}
-
-					if (pce->time_most < (uint32_t)elapsed) {
-						pce->time_most = elapsed;
-					}
-
-					// maintain mean and variance of the elapsed time in seconds
-					// Knuth/Welford recursive mean and variance of update intervals (via Wikipedia)
-					float dt = elapsed / 1e6f;
-					float delta_intvl = dt - pce->mean;
-					pce->mean += delta_intvl / pce->event_count;
-					pce->M2 += delta_intvl * (dt - pce->mean);
-
-					pce->time_start = 0;
-				}
+				perf_update_elapsed(pce, hrt_absolute_time() - pce->time_start);
 			}
 		}
 		break;
@@ -322,37 +319,66 @@ perf_set_elapsed(perf_counter_t handle, int64_t elapsed)
 	}
 
 	switch (handle->type) {
-	case PC_ELAPSED: {
-			struct perf_ctr_elapsed *pce = (struct perf_ctr_elapsed *)handle;
+	case PC_ELAPSED:
+	case PC_HISTOGRAM:
+		perf_update_elapsed((struct perf_ctr_elapsed *)handle, elapsed);
+		break;
 
-			if (elapsed >= 0) {
+	default:
+		break;
+	}
+}
 
-				pce->event_count++;
-				pce->time_total += elapsed;
+/**
+ * Record one elapsed time measurement on a PC_ELAPSED or PC_HISTOGRAM counter.
+ */
+static void
+perf_update_elapsed(struct perf_ctr_elapsed *pce, int64_t elapsed)
+{
+	if (elapsed < 0) {
+		return;
+	}
 
-				if ((pce->time_least > (uint32_t)elapsed) || (pce->time_least == 0)) {
-					pce->time_least = elapsed;
-				}
+	pce->event_count++;
+	pce->time_total += elapsed;
 
-				if (pce->time_most < (uint32_t)elapsed) {
-					pce->time_most = elapsed;
-				}
+	if ((pce->time_least > (uint32_t)elapsed) || (pce->time_least == 0)) {
+		pce->time_least = elapsed;
+	}
 
-				// maintain mean and variance of the elapsed time in seconds
-				// Knuth/Welford recursive mean and variance of update intervals (via Wikipedia)
-				float dt = elapsed / 1e6f;
-				float delta_intvl = dt - pce->mean;
-				pce->mean += delta_intvl / pce->event_count;
-				pce->M2 += delta_intvl * (dt - pce->mean);
+	if (pce->time_most < (uint32_t)elapsed) {
+		pce->time_most = elapsed;
+	}
 
-				pce->time_start = 0;
-			}
-		}
-		break;
+	// maintain mean and variance of the elapsed time in seconds
+	// Knuth/Welford recursive mean and variance of update intervals (via Wikipedia)
+	float dt = elapsed / 1e6f;
+	float delta_intvl = dt - pce->mean;
+	pce->mean += delta_intvl / pce->event_count;
+	pce->M2 += delta_intvl * (dt - pce->mean);
 
-	default:
-		break;
+	pce->time_start = 0;
+
+	if (pce->hdr.type == PC_HISTOGRAM) {
+		uint32_t elapsed_us = (elapsed > UINT32_MAX) ? UINT32_MAX : (uint32_t)elapsed;
+		((struct perf_ctr_histogram *)pce)->buckets[perf_histogram_index(elapsed_us)]++;
+	}
+}
+
+/**
+ * Map an elapsed time in us to its log2 histogram bucket.
+ */
+static unsigned
+perf_histogram_index(uint32_t elapsed)
+{
+	if (elapsed < 2) {
+		return 0;
 	}
+
+	// position of the highest set bit, i.e. floor(log2(elapsed))
+	unsigned index = 31 - __builtin_clz(elapsed);
+
+	return (index < PERF_HISTOGRAM_BUCKETS) ? index : PERF_HISTOGRAM_BUCKETS - 1;
 }
 
 void
@@ -382,7 +408,8 @@ perf_cancel(perf_counter_t handle)
 	}
 
 	switch (handle->type) {
-	case PC_ELAPSED: {
+	case PC_ELAPSED:
+	case PC_HISTOGRAM: {
 			struct perf_ctr_elapsed *pce = (struct perf_ctr_elapsed *)handle;
 
 			pce->time_start = 0;
@@ -428,6 +455,19 @@ perf_reset(perf_counter_t handle)
 			pci->time_most = 0;
 			break;
 		}
+
+	case PC_HISTOGRAM: {
+			struct perf_ctr_histogram *pch = (struct perf_ctr_histogram *)handle;
+			pch->elapsed.event_count = 0;
+			pch->elapsed.time_start = 0;
+			pch->elapsed.time_total = 0;
+			pch->elapsed.time_least = 0;
+			pch->elapsed.time_most = 0;
+			pch->elapsed.mean = 0.0f;
+			pch->elapsed.M2 = 0.0f;
+			memset(pch->buckets, 0, sizeof(pch->buckets));
+			break;
+		}
 	}
 }
 
@@ -455,7 +495,8 @@ perf_print_counter_fd(int fd, perf_counter_t handle)
 			(unsigned long long)((struct perf_ctr_count *)handle)->event_count);
 		break;
 
-	case PC_ELAPSED: {
+	case PC_ELAPSED:
+	case PC_HISTOGRAM: {
 			struct perf_ctr_elapsed *pce = (struct perf_ctr_elapsed *)handle;
 			float rms = sqrtf(pce->M2 / (pce->event_count - 1));
 			dprintf(fd, "%s: %llu events, %lluus elapsed, %lluus avg, min %lluus max %lluus %5.3fus rms\n",
@@ -466,6 +507,13 @@ perf_print_counter_fd(int fd, perf_counter_t handle)
 				(unsigned long long)pce->time_least,
 				(unsigned long long)pce->time_most,
 				(double)(1e6f * rms));
+
+			if (handle->type == PC_HISTOGRAM) {
+				char buffer[256];
+				perf_print_histogram_buffer(buffer, sizeof(buffer), (struct perf_ctr_histogram *)handle);
+				dprintf(fd, "  %s\n", buffer);
+			}
+
 			break;
 		}
 
@@ -505,7 +553,8 @@ perf_print_counter_buffer(char *buffer, int length, perf_counter_t handle)
 				       (unsigned long long)((struct perf_ctr_count *)handle)->event_count);
 		break;
 
-	case PC_ELAPSED: {
+	case PC_ELAPSED:
+	case PC_HISTOGRAM: {
 			struct perf_ctr_elapsed *pce = (struct perf_ctr_elapsed *)handle;
 			float rms = sqrtf(pce->M2 / (pce->event_count - 1));
 			num_written = snprintf(buffer, length, "%s: %llu events, %lluus elapsed, %lluus avg, min %lluus max %lluus %5.3fus rms",
@@ -516,6 +565,14 @@ perf_print_counter_buffer(char *buffer, int length, perf_counter_t handle)
 					       (unsigned long long)pce->time_least,
 					       (unsigned long long)pce->time_most,
 					       (double)(1e6f * rms));
+
+			if (handle->type == PC_HISTOGRAM && num_written >= 0 && num_written < length - 2) {
+				buffer[num_written++] = ',';
+				buffer[num_written++] = ' ';
+				num_written += perf_print_histogram_buffer(buffer + num_written, length - num_written,
+						(struct perf_ctr_histogram *)handle);
+			}
+
 			break;
 		}
 
@@ -541,6 +598,30 @@ perf_print_counter_buffer(char *buffer, int length, perf_counter_t handle)
 	return num_written;
 }
 
+/**
+ * Print the non-empty buckets of a histogram as '<lower bound in us>:<count>' pairs.
+ * The output is kept compact so that it fits into the logger's perf info messages.
+ */
+static int
+perf_print_histogram_buffer(char *buffer, int length, const struct perf_ctr_histogram *pch)
+{
+	int num_written = snprintf(buffer, length, "hist [us]:");
+
+	for (unsigned i = 0; i < PERF_HISTOGRAM_BUCKETS && num_written >= 0 && num_written < length; ++i) {
+		if (pch->buckets[i] == 0) {
+			continue;
+		}
+
+		num_written += snprintf(buffer + num_written, length - num_written, " %u%s:%u",
+					(i == 0) ? 0 : (1u << i),
+					(i == PERF_HISTOGRAM_BUCKETS - 1) ? "+" : "",
+					(unsigned)pch->buckets[i]);
+	}
+
+	buffer[length - 1] = 0; // ensure 0-termination
+	return (num_written < length) ? num_written : length - 1;
+}
+
 uint64_t
 perf_event_count(perf_counter_t handle)
 {
@@ -552,7 +633,8 @@ perf_event_count(perf_counter_t handle)
 	case PC_COUNT:
 		return ((struct perf_ctr_count *)handle)->event_count;
 
-	case PC_ELAPSED: {
+	case PC_ELAPSED:
+	case PC_HISTOGRAM: {
 			struct perf_ctr_elapsed *pce = (struct perf_ctr_elapsed *)handle;
 			return pce->event_count;
 		}
@@ -613,6 +695,13 @@ perf_print_latency(int fd)
 
 	// print the overflow bucket value
 	dprintf(fd, " >%4i : %i\n", latency_buckets[latency_bucket_count - 1], latency_counters[latency_bucket_count]);
+
+	struct hrt_callout_stats stats;
+	hrt_callout_stats_get(&stats, false);
+	dprintf(fd, "callouts: %lu invoked, lateness avg %lluus max %luus, queued %u (max %u)\n",
+		(unsigned long)stats.invoked,
+		(unsigned long long)((stats.invoked > 0) ? stats.lateness_total / stats.invoked : 0),
+		(unsigned long)stats.lateness_max, (unsigned)stats.queued, (unsigned)stats.queued_max);
 }
 
 void
@@ -631,4 +720,17 @@ perf_reset_all(void)
 	for (int i = 0; i <= latency_bucket_count; i++) {
 		latency_counters[i] = 0;
 	}
+
+	struct hrt_callout_stats stats;
+	hrt_callout_stats_get(&stats, true);
+}
+
+uint32_t
+perf_histogram_bucket(perf_counter_t handle, unsigned bucket)
+{
+	if (handle == NULL || handle->type != PC_HISTOGRAM || bucket >= PERF_HISTOGRAM_BUCKETS) {
+		return 0;
+	}
+
+	return ((struct perf_ctr_histogram *)handle)->buckets[bucket];
 }
@@ -48,9 +48,16 @@
 enum perf_counter_type {
 	PC_COUNT,		/**< count the number of times an event occurs */
 	PC_ELAPSED,		/**< measure the time elapsed performing an event */
-	PC_INTERVAL		/**< measure the interval between instances of an event */
+	PC_INTERVAL,		/**< measure the interval between instances of an event */
+	PC_HISTOGRAM		/**< like PC_ELAPSED, plus a histogram of the elapsed times */
 };
 
+/**
+ * Number of PC_HISTOGRAM buckets. Bucket 0 counts elapsed times below 2us,
+ * bucket n counts [2^n, 2^(n+1)) us, and the last one everything above.
+ */
+#define PERF_HISTOGRAM_BUCKETS	16
+
 struct perf_ctr_header;
 typedef struct perf_ctr_header	*perf_counter_t;
 
@@ -97,7 +104,7 @@ __EXPORT extern void		perf_count(perf_counter_t handle);
 /**
  * Begin a performance event.
  *
- * This call applies to counters that operate over ranges of time; PC_ELAPSED etc.
+ * This call applies to counters that operate over ranges of time; PC_ELAPSED, PC_HISTOGRAM etc.
  *
  * @param handle		The handle returned from perf_alloc.
  */
@@ -106,7 +113,7 @@ __EXPORT extern void		perf_begin(perf_counter_t handle);
 /**
  * End a performance event.
  *
- * This call applies to counters that operate over ranges of time; PC_ELAPSED etc.
+ * This call applies to counters that operate over ranges of time; PC_ELAPSED, PC_HISTOGRAM etc.
  * If a call is made without a corresponding perf_begin call, or if perf_cancel
  * has been called subsequently, no change is made to the counter.
  *
@@ -117,7 +124,7 @@ __EXPORT extern void		perf_end(perf_counter_t handle);
 /**
  * Register a measurement
  *
- * This call applies to counters that operate over ranges of time; PC_ELAPSED etc.
+ * This call applies to counters that operate over ranges of time; PC_ELAPSED, PC_HISTOGRAM etc.
  * If a call is made without a corresponding perf_begin call. It sets the
  * value provided as argument as a new measurement.
  *
@@ -222,6 +229,15 @@ __EXPORT extern void		perf_reset_all(void);
  */
 __EXPORT extern uint64_t	perf_event_count(perf_counter_t handle);
 
+/**
+ * Return the event count of a histogram bucket
+ *
+ * @param handle		The counter returned from perf_alloc, of type PC_HISTOGRAM.
+ * @param bucket		Bucket index, see PERF_HISTOGRAM_BUCKETS.
+ * @return			bucket count, 0 for other counter types
+ */
+__EXPORT extern uint32_t	perf_histogram_bucket(perf_counter_t handle, unsigned bucket);
+
 __END_DECLS
 
 #endif
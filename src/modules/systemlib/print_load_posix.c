@@ -39,6 +39,10 @@
  * @author Lorenz Meier <lorenz@px4.io>
  */
 
+#if defined(__PX4_LINUX) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE // sched_getaffinity()
+#endif
+
 #include <px4_posix.h>
 
 #include <unistd.h>
@@ -47,6 +51,7 @@
 #include <stdbool.h>
 
 #include <systemlib/cpuload.h>
+#include <systemlib/mem_pool.h>
 #include <systemlib/printload.h>
 #include <drivers/drv_hrt.h>
 
@@ -54,6 +59,10 @@
 #include <mach/mach.h>
 #endif
 
+#ifdef __PX4_LINUX
+#include <sched.h>
+#endif
+
 #ifdef __PX4_QURT
 // dprintf is not available on QURT. Use the usual output to mini-dm.
 #define dprintf(_fd, _text, ...) ((_fd) == 1 ? PX4_INFO((_text), ##__VA_ARGS__) : (void)(_fd))
@@ -78,9 +87,172 @@ void init_print_load_s(uint64_t t, struct print_load_s *s)
 		s->last_times[i] = 0;
 	}
 
+#ifdef __PX4_LINUX
+	memset(s->last_tids, 0, sizeof(s->last_tids));
+	memset(s->last_stats, 0, sizeof(s->last_stats));
+#endif
+
 	s->interval_time_ms_inv = 0.f;
 }
 
+#ifdef __PX4_LINUX
+static const char *policy_name(int policy)
+{
+	switch (policy) {
+	case SCHED_OTHER:
+		return "OTHER";
+
+	case SCHED_FIFO:
+		return "FIFO";
+
+	case SCHED_RR:
+		return "RR";
+
+	default:
+		return "?";
+	}
+}
+
+/* Format the CPUs a thread may run on as a list like 0-1,3 */
+static void format_affinity(int tid, char *buf, size_t len)
+{
+	cpu_set_t set;
+
+	if (sched_getaffinity(tid, sizeof(set), &set) != 0) {
+		snprintf(buf, len, "?");
+		return;
+	}
+
+	if (CPU_COUNT(&set) == sysconf(_SC_NPROCESSORS_CONF)) {
+		snprintf(buf, len, "all");
+		return;
+	}
+
+	size_t pos = 0;
+	buf[0] = '\0';
+
+	for (int cpu = 0; cpu < CPU_SETSIZE && pos < len; cpu++) {
+		if (!CPU_ISSET(cpu, &set)) {
+			continue;
+		}
+
+		int last = cpu;
+
+		while (last + 1 < CPU_SETSIZE && CPU_ISSET(last + 1, &set)) {
+			last++;
+		}
+
+		if (last == cpu) {
+			pos += snprintf(buf + pos, len - pos, "%s%d", pos ? "," : "", cpu);
+
+		} else {
+			pos += snprintf(buf + pos, len - pos, "%s%d-%d", pos ? "," : "", cpu, last);
+		}
+
+		cpu = last;
+	}
+}
+
+/* Statistics of a thread from the last print, nullptr for a new thread */
+static const struct thread_stats_s *last_thread_stats(const struct print_load_s *print_state, int tid)
+{
+	for (int i = 0; i < THREAD_STATS_MAX_THREADS; i++) {
+		if (print_state->last_tids[i] == tid) {
+			return &print_state->last_stats[i];
+		}
+	}
+
+	return NULL;
+}
+
+/* Read the statistics of all threads, and remember the ones of the last print */
+static int read_all_thread_stats(struct print_load_s *print_state, int *tids, struct thread_stats_s *stats,
+				 const struct thread_stats_s **last)
+{
+	int thread_ids[THREAD_STATS_MAX_THREADS];
+	const int thread_count = thread_stats_list(thread_ids, THREAD_STATS_MAX_THREADS);
+	int count = 0;
+
+	for (int i = 0; i < thread_count; i++) {
+		if (thread_stats_get(thread_ids[i], &stats[count])) {
+			tids[count] = thread_ids[i];
+			count++;
+		}
+	}
+
+	for (int i = 0; i < count; i++) {
+		last[i] = last_thread_stats(print_state, tids[i]);
+	}
+
+	return count;
+}
+
+static void store_thread_stats(struct print_load_s *print_state, const int *tids, const struct thread_stats_s *stats,
+			       int count)
+{
+	for (int i = 0; i < THREAD_STATS_MAX_THREADS; i++) {
+		print_state->last_tids[i] = (i < count) ? tids[i] : 0;
+
+		if (i < count) {
+			print_state->last_stats[i] = stats[i];
+		}
+	}
+
+	print_state->interval_start_time = print_state->new_time;
+}
+
+void print_load_sched(uint64_t t, int fd, struct print_load_s *print_state)
+{
+	char *clear_line = "";
+
+	if (fd == 1) {
+		dprintf(fd, "\033[H"); /* move cursor home and clear screen */
+		clear_line = CL;
+	}
+
+	print_state->new_time = t;
+	const uint64_t interval_us = t - print_state->interval_start_time;
+
+	int tids[THREAD_STATS_MAX_THREADS];
+	struct thread_stats_s stats[THREAD_STATS_MAX_THREADS];
+	const struct thread_stats_s *last[THREAD_STATS_MAX_THREADS];
+	const int count = read_all_thread_stats(print_state, tids, stats, last);
+
+	dprintf(fd, "%s%6s %-16s %7s %7s %9s %7s %7s %4s\n",
+		clear_line, "TID", "COMMAND", "RUN(%)", "WAIT(%)", "LAT(us)", "VOL/s", "INVOL/s", "CPU#");
+
+	for (int i = 0; i < count; i++) {
+		const struct thread_stats_s *curr = &stats[i];
+		float run = 0.f, wait = 0.f, latency = 0.f, vol = 0.f, invol = 0.f;
+
+		// the statistics of the interval, nothing for a new thread
+		if (last[i] && interval_us > 0) {
+			const float interval_inv = 1e6f / interval_us;
+			const uint64_t slices = curr->timeslices - last[i]->timeslices;
+
+			run = (curr->run_time_us - last[i]->run_time_us) * interval_inv * 1e-4f;
+			wait = (curr->wait_time_us - last[i]->wait_time_us) * interval_inv * 1e-4f;
+			latency = slices > 0 ? (float)(curr->wait_time_us - last[i]->wait_time_us) / slices : 0.f;
+			vol = (curr->voluntary_switches - last[i]->voluntary_switches) * interval_inv;
+			invol = (curr->involuntary_switches - last[i]->involuntary_switches) * interval_inv;
+		}
+
+		dprintf(fd, "%s%6d %-16s %7.2f %7.2f %9.1f %7.0f %7.0f %4d\n",
+			clear_line,
+			tids[i],
+			curr->name,
+			(double)run,
+			(double)wait,
+			(double)latency,
+			(double)vol,
+			(double)invol,
+			curr->cpu);
+	}
+
+	store_thread_stats(print_state, tids, stats, count);
+}
+#endif
+
 void print_load(uint64_t t, int fd, struct print_load_s *print_state)
 {
 	char *clear_line = "";
@@ -92,8 +264,47 @@ void print_load(uint64_t t, int fd, struct print_load_s *print_state)
 	}
 
 #if defined (__PX4_LINUX)
-	dprintf(fd, "%sTOP NOT IMPLEMENTED ON LINUX\n",
-		clear_line);
+	print_state->new_time = t;
+
+	if (print_state->new_time > print_state->interval_start_time) {
+		print_state->interval_time_ms_inv = 1.f / ((float)((print_state->new_time - print_state->interval_start_time) / 1000));
+	}
+
+	int tids[THREAD_STATS_MAX_THREADS];
+	struct thread_stats_s stats[THREAD_STATS_MAX_THREADS];
+	const struct thread_stats_s *last[THREAD_STATS_MAX_THREADS];
+	const int count = read_all_thread_stats(print_state, tids, stats, last);
+
+	dprintf(fd, "%s%6s %-16s %8s %6s %-5s %4s %5s %4s %-10s\n",
+		clear_line, "TID", "COMMAND", "CPU(ms)", "CPU(%)", "POL", "PRIO", "STATE", "CPU#", "AFFINITY");
+
+	for (int i = 0; i < count; i++) {
+		const struct thread_stats_s *curr = &stats[i];
+		const uint32_t interval_runtime = (last[i] && curr->cpu_time_ms > last[i]->cpu_time_ms)
+						  ? curr->cpu_time_ms - last[i]->cpu_time_ms : 0;
+
+		char affinity[32];
+		format_affinity(tids[i], affinity, sizeof(affinity));
+
+		dprintf(fd, "%s%6d %-16s %8u %2d.%03d %-5s %4d %5c %4d %-10s\n",
+			clear_line,
+			tids[i],
+			curr->name,
+			(unsigned)curr->cpu_time_ms,
+			(int)(interval_runtime * print_state->interval_time_ms_inv * 100),
+			(int)(interval_runtime * print_state->interval_time_ms_inv * 100000) % 1000,
+			policy_name(curr->policy),
+			curr->priority,
+			curr->state,
+			curr->cpu,
+			affinity);
+	}
+
+	store_thread_stats(print_state, tids, stats, count);
+
+	char pool_stats[140];
+	mem_pool_print_stats_buffer(pool_stats, sizeof(pool_stats));
+	dprintf(fd, "%s\n%s%s\n", clear_line, clear_line, pool_stats);
 
 #elif defined (__PX4_QURT)
 	dprintf(fd, "%sTOP NOT IMPLEMENTED ON QURT\n",
@@ -43,6 +43,7 @@
 #include <stdio.h>
 
 #include <systemlib/cpuload.h>
+#include <systemlib/mem_pool.h>
 #include <systemlib/printload.h>
 #include <drivers/drv_hrt.h>
 
@@ -339,6 +340,8 @@ void print_load_buffer(uint64_t t, char *buffer, int buffer_length, print_load_c
 	}
 
 #endif
+	mem_pool_print_stats_buffer(buffer, buffer_length);
+	cb(user);
 	snprintf(buffer, buffer_length, "Uptime: %.3fs total, %.3fs idle",
 		 (double)curr_time_us / 1000000.d,
 		 (double)idle_time_us / 1000000.d);
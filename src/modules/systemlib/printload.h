@@ -45,6 +45,10 @@
 
 #include <stdint.h>
 
+#ifdef __PX4_LINUX
+#include <systemlib/thread_stats.h>
+#endif
+
 #ifndef CONFIG_MAX_TASKS
 #define CONFIG_MAX_TASKS 64
 #endif
@@ -58,6 +62,10 @@ struct print_load_s {
 	uint64_t new_time;
 	uint64_t interval_start_time;
 	uint32_t last_times[CONFIG_MAX_TASKS]; // in [ms]. This wraps if a process needs more than 49 days of CPU
+#ifdef __PX4_LINUX
+	int last_tids[THREAD_STATS_MAX_THREADS]; // thread ids of last_stats
+	struct thread_stats_s last_stats[THREAD_STATS_MAX_THREADS];
+#endif
 	float interval_time_ms_inv;
 };
 
@@ -67,6 +75,14 @@ __EXPORT void init_print_load_s(uint64_t t, struct print_load_s *s);
 
 __EXPORT void print_load(uint64_t t, int fd, struct print_load_s *print_state);
 
+#ifdef __PX4_LINUX
+/**
+ * Print the scheduling statistics of the threads over the interval since the last call:
+ * run time, time waiting on a run queue, average wait per timeslice, and context switches
+ */
+__EXPORT void print_load_sched(uint64_t t, int fd, struct print_load_s *print_state);
+#endif
+
 
 typedef void (*print_load_callback_f)(void *user);
 
@@ -145,6 +145,23 @@ PARAM_DEFINE_INT32(SYS_COMPANION, 157600);
  */
 PARAM_DEFINE_INT32(SYS_PARAM_VER, 1);
 
+/**
+ * Parameter change notification quiet period
+ *
+ * A parameter change is announced to the modules (parameter_update) once no other
+ * parameter changed for this long, so that a burst of changes from a ground station
+ * makes each module reload its parameters only once. The announcement is delayed by at
+ * most 2 seconds. Modules that set a parameter which must take effect immediately
+ * announce it themselves (param_notify_changes()). Set to 0 to announce every change
+ * immediately.
+ *
+ * @unit ms
+ * @min 0
+ * @max 1000
+ * @group System
+ */
+PARAM_DEFINE_INT32(SYS_PARAM_QUIET, 100);
+
 /**
  * SD logger
  *
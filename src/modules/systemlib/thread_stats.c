@@ -0,0 +1,197 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2017 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file thread_stats.c
+ *
+ * Scheduling statistics of the threads of the process, read from /proc (Linux only).
+ */
+
+#include "thread_stats.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+/* Read a file of /proc/self/task/<tid> into buf, false on error */
+static bool read_task_file(int tid, const char *file, char *buf, size_t len)
+{
+	snprintf(buf, len, "/proc/self/task/%d/%s", tid, file);
+
+	int fd = open(buf, O_RDONLY);
+
+	if (fd < 0) {
+		return false;
+	}
+
+	ssize_t ret = read(fd, buf, len - 1);
+	close(fd);
+
+	if (ret <= 0) {
+		return false;
+	}
+
+	buf[ret] = '\0';
+	return true;
+}
+
+/* Parse /proc/self/task/<tid>/stat */
+static bool read_stat(int tid, struct thread_stats_s *stats)
+{
+	char buf[512];
+
+	if (!read_task_file(tid, "stat", buf, sizeof(buf))) {
+		return false;
+	}
+
+	// the name is in parentheses and may contain spaces
+	char *name = strchr(buf, '(');
+	char *name_end = strrchr(buf, ')');
+
+	if (!name || !name_end || name_end < name) {
+		return false;
+	}
+
+	*name_end = '\0';
+	strncpy(stats->name, name + 1, sizeof(stats->name) - 1);
+	stats->name[sizeof(stats->name) - 1] = '\0';
+
+	// fields are numbered from 1, the state is field 3
+	unsigned long long utime = 0, stime = 0;
+	int field = 3;
+	char *saveptr;
+
+	for (char *tok = strtok_r(name_end + 2, " ", &saveptr); tok; tok = strtok_r(NULL, " ", &saveptr), ++field) {
+		switch (field) {
+		case 3:
+			stats->state = tok[0];
+			break;
+
+		case 14:
+			utime = strtoull(tok, NULL, 10);
+			break;
+
+		case 15:
+			stime = strtoull(tok, NULL, 10);
+			break;
+
+		case 39:
+			stats->cpu = atoi(tok);
+			break;
+
+		case 40:
+			stats->priority = atoi(tok);
+			break;
+
+		case 41:
+			stats->policy = atoi(tok);
+			break;
+		}
+	}
+
+	stats->cpu_time_ms = (uint32_t)((utime + stime) * 1000 / sysconf(_SC_CLK_TCK));
+	return field > 41;
+}
+
+/* Parse /proc/self/task/<tid>/schedstat: run time [ns], run queue wait time [ns], timeslices */
+static void read_schedstat(int tid, struct thread_stats_s *stats)
+{
+	char buf[128];
+	unsigned long long run_ns, wait_ns, timeslices;
+
+	if (read_task_file(tid, "schedstat", buf, sizeof(buf))
+	    && sscanf(buf, "%llu %llu %llu", &run_ns, &wait_ns, &timeslices) == 3) {
+		stats->run_time_us = run_ns / 1000;
+		stats->wait_time_us = wait_ns / 1000;
+		stats->timeslices = timeslices;
+	}
+}
+
+/* Get the context switch counts from /proc/self/task/<tid>/status */
+static void read_status(int tid, struct thread_stats_s *stats)
+{
+	char buf[4096];
+
+	if (!read_task_file(tid, "status", buf, sizeof(buf))) {
+		return;
+	}
+
+	const char *line = strstr(buf, "\nvoluntary_ctxt_switches:");
+
+	if (line) {
+		stats->voluntary_switches = strtoul(line + strlen("\nvoluntary_ctxt_switches:"), NULL, 10);
+	}
+
+	line = strstr(buf, "\nnonvoluntary_ctxt_switches:");
+
+	if (line) {
+		stats->involuntary_switches = strtoul(line + strlen("\nnonvoluntary_ctxt_switches:"), NULL, 10);
+	}
+}
+
+int thread_stats_list(int *tids, int max_count)
+{
+	DIR *dir = opendir("/proc/self/task");
+
+	if (!dir) {
+		return 0;
+	}
+
+	int count = 0;
+	struct dirent *entry;
+
+	while (count < max_count && (entry = readdir(dir)) != NULL) {
+		if (entry->d_name[0] != '.') {
+			tids[count++] = atoi(entry->d_name);
+		}
+	}
+
+	closedir(dir);
+	return count;
+}
+
+bool thread_stats_get(int tid, struct thread_stats_s *stats)
+{
+	memset(stats, 0, sizeof(*stats));
+
+	if (!read_stat(tid, stats)) {
+		return false;
+	}
+
+	read_schedstat(tid, stats);
+	read_status(tid, stats);
+	return true;
+}
@@ -0,0 +1,76 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2017 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file thread_stats.h
+ *
+ * Scheduling statistics of the threads of the process, read from /proc (Linux only).
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define THREAD_STATS_MAX_THREADS 128
+
+struct thread_stats_s {
+	char name[17];
+	char state;			///< R: running, S: sleeping, D: disk sleep, ...
+	int cpu;			///< CPU the thread last ran on
+	int priority;			///< real-time priority, 0 for SCHED_OTHER
+	int policy;			///< SCHED_OTHER, SCHED_FIFO, ...
+	uint32_t cpu_time_ms;		///< user and system time, in clock ticks resolution
+	uint64_t run_time_us;		///< time running on a CPU (schedstat)
+	uint64_t wait_time_us;		///< time waiting on a run queue (schedstat)
+	uint64_t timeslices;		///< number of times the thread got a CPU (schedstat)
+	uint32_t voluntary_switches;
+	uint32_t involuntary_switches;
+};
+
+__BEGIN_DECLS
+
+/**
+ * Get the thread ids of the process.
+ * @return number of thread ids written, at most max_count
+ */
+__EXPORT int thread_stats_list(int *tids, int max_count);
+
+/**
+ * Read the statistics of a thread of the process.
+ * The schedstat fields are 0 if the kernel does not provide them (CONFIG_SCHED_INFO).
+ * @return false if the thread does not exist (anymore)
+ */
+__EXPORT bool thread_stats_get(int tid, struct thread_stats_s *stats);
+
+__END_DECLS
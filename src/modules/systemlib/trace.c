@@ -0,0 +1,300 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2017 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file trace.c
+ * Binary event trace, see trace.h.
+ */
+
+#include <px4_config.h>
+#include <px4_defines.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <drivers/drv_hrt.h>
+#include <uORB/uORB.h>
+
+#ifdef __PX4_NUTTX
+#include <nuttx/sched.h>
+#endif
+
+#include "cycle_counter.h"
+#include "trace.h"
+
+#ifdef PX4_TRACE
+
+/* number of events in the ring, must be a power of 2 */
+#ifndef TRACE_BUFFER_EVENTS
+#define TRACE_BUFFER_EVENTS	1024
+#endif
+
+/* maximum number of distinct tasks and topics resolved in a dump */
+#define TRACE_MAX_NAMES		96
+
+static struct trace_event_s trace_buffer[TRACE_BUFFER_EVENTS];
+static volatile uint32_t trace_head;	///< total number of recorded events
+static volatile bool trace_enabled;
+
+#ifdef __PX4_NUTTX
+extern FAR struct tcb_s *sched_gettcb(pid_t pid);
+#endif
+
+uint32_t trace_clock_frequency(void)
+{
+	return cycle_counter_frequency();
+}
+
+void trace_event(enum trace_event_type type, uint16_t id, uintptr_t arg)
+{
+	if (!trace_enabled) {
+		return;
+	}
+
+	/* lock-free: interrupts and other tasks each get their own slot */
+	uint32_t index = __sync_fetch_and_add(&trace_head, 1);
+	struct trace_event_s *event = &trace_buffer[index & (TRACE_BUFFER_EVENTS - 1)];
+
+	event->time = cycle_counter_read();
+	event->type = type;
+	event->id = id;
+	event->arg = arg;
+}
+
+void trace_enable(bool enable)
+{
+	if (enable) {
+		cycle_counter_enable();
+	}
+
+	trace_enabled = enable;
+}
+
+void trace_reset(void)
+{
+	bool enabled = trace_enabled;
+	trace_enabled = false;
+	memset(trace_buffer, 0, sizeof(trace_buffer));
+	trace_head = 0;
+	trace_enabled = enabled;
+}
+
+static int add_name(struct trace_name_s *names, uint32_t *name_count, const struct trace_event_s *event)
+{
+	struct trace_name_s name;
+	memset(&name, 0, sizeof(name));
+
+	switch (event->type) {
+	case TRACE_EVENT_TASK_RESUME:
+	case TRACE_EVENT_TASK_SUSPEND:
+		name.type = TRACE_EVENT_TASK_RESUME;
+		name.id = event->id;
+		break;
+
+	case TRACE_EVENT_ORB_PUBLISH:
+	case TRACE_EVENT_ORB_COPY:
+		name.type = TRACE_EVENT_ORB_PUBLISH;
+		name.arg = event->arg;
+		break;
+
+	case TRACE_EVENT_PERF_BEGIN:
+	case TRACE_EVENT_PERF_END:
+		name.type = TRACE_EVENT_PERF_BEGIN;
+		name.arg = event->arg;
+		break;
+
+	default:
+		return 0;
+	}
+
+	for (uint32_t i = 0; i < *name_count; i++) {
+		if (names[i].type == name.type && names[i].id == name.id && names[i].arg == name.arg) {
+			return 0;
+		}
+	}
+
+	if (*name_count >= TRACE_MAX_NAMES) {
+		return -ENOSPC;
+	}
+
+	if (name.type == TRACE_EVENT_ORB_PUBLISH) {
+		const struct orb_metadata *meta = (const struct orb_metadata *)event->arg;
+		strncpy(name.name, meta->o_name, sizeof(name.name) - 1);
+
+	} else if (name.type == TRACE_EVENT_PERF_BEGIN) {
+		strncpy(name.name, (const char *)event->arg, sizeof(name.name) - 1);
+
+	} else {
+#ifdef __PX4_NUTTX
+		sched_lock();
+		FAR struct tcb_s *tcb = sched_gettcb(name.id);
+
+#if CONFIG_TASK_NAME_SIZE > 0
+
+		if (tcb != NULL) {
+			strncpy(name.name, tcb->name, sizeof(name.name) - 1);
+		}
+
+#endif
+		sched_unlock();
+
+		if (tcb == NULL) {
+			snprintf(name.name, sizeof(name.name), "pid %u", name.id);
+		}
+
+#else
+		snprintf(name.name, sizeof(name.name), "pid %u", name.id);
+#endif
+	}
+
+	names[(*name_count)++] = name;
+	return 0;
+}
+
+int trace_dump(const char *path)
+{
+	bool enabled = trace_enabled;
+	trace_enabled = false;
+
+	const uint32_t head = trace_head;
+	const uint32_t count = head < TRACE_BUFFER_EVENTS ? head : TRACE_BUFFER_EVENTS;
+
+	struct trace_name_s *names = (struct trace_name_s *)malloc(TRACE_MAX_NAMES * sizeof(struct trace_name_s));
+	int ret = 0;
+
+	if (names == NULL) {
+		ret = -ENOMEM;
+		goto out;
+	}
+
+	uint32_t name_count = 0;
+
+	for (uint32_t i = head - count; i != head; i++) {
+		if (add_name(names, &name_count, &trace_buffer[i & (TRACE_BUFFER_EVENTS - 1)]) != 0) {
+			PX4_WARN("too many names, some events will be unnamed");
+			break;
+		}
+	}
+
+	int fd = open(path, O_CREAT | O_WRONLY | O_TRUNC, PX4_O_MODE_666);
+
+	if (fd < 0) {
+		ret = -errno;
+		free(names);
+		goto out;
+	}
+
+	struct trace_file_header_s header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, TRACE_FILE_MAGIC, sizeof(header.magic));
+	header.version = TRACE_FILE_VERSION;
+	header.event_size = sizeof(struct trace_event_s);
+	header.pointer_size = sizeof(uintptr_t);
+	header.clock_frequency = trace_clock_frequency();
+	header.event_count = count;
+	header.lost_count = head - count;
+	header.name_count = name_count;
+
+	if (write(fd, &header, sizeof(header)) != sizeof(header)) {
+		ret = -EIO;
+	}
+
+	/* the ring in two chunks, oldest event first */
+	const uint32_t first = (head - count) & (TRACE_BUFFER_EVENTS - 1);
+	const uint32_t first_count = count < TRACE_BUFFER_EVENTS - first ? count : TRACE_BUFFER_EVENTS - first;
+	const size_t chunk_size[2] = {first_count * sizeof(struct trace_event_s), (count - first_count) * sizeof(struct trace_event_s)};
+	const void *chunk[2] = {&trace_buffer[first], &trace_buffer[0]};
+
+	for (int i = 0; i < 2 && ret == 0; i++) {
+		if (chunk_size[i] > 0 && write(fd, chunk[i], chunk_size[i]) != (ssize_t)chunk_size[i]) {
+			ret = -EIO;
+		}
+	}
+
+	if (ret == 0 && name_count > 0 &&
+	    write(fd, names, name_count * sizeof(struct trace_name_s)) != (ssize_t)(name_count * sizeof(struct trace_name_s))) {
+		ret = -EIO;
+	}
+
+	close(fd);
+	free(names);
+
+out:
+	trace_enabled = enabled;
+	return ret;
+}
+
+void trace_print_status(void)
+{
+	const uint32_t head = trace_head;
+
+	PX4_INFO("%s, %u events recorded, %u in the buffer (%u bytes), clock %u Hz",
+		 trace_enabled ? "recording" : "stopped", head,
+		 head < TRACE_BUFFER_EVENTS ? head : TRACE_BUFFER_EVENTS,
+		 (unsigned)sizeof(trace_buffer), (unsigned)trace_clock_frequency());
+}
+
+#else /* PX4_TRACE */
+
+void trace_event(enum trace_event_type type, uint16_t id, uintptr_t arg)
+{
+}
+
+void trace_enable(bool enable)
+{
+}
+
+void trace_reset(void)
+{
+}
+
+int trace_dump(const char *path)
+{
+	return -ENOSYS;
+}
+
+void trace_print_status(void)
+{
+	PX4_INFO("not enabled, build with TRACE=ON");
+}
+
+uint32_t trace_clock_frequency(void)
+{
+	return 0;
+}
+
+#endif /* PX4_TRACE */
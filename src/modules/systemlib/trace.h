@@ -0,0 +1,163 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2017 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file trace.h
+ * Binary event trace for timing analysis.
+ *
+ * A fixed-size ring of timestamped events (task switches, hrt callouts, uORB
+ * publications and copies, work queue items). Recording is compiled in with
+ * the TRACE cmake option (-DPX4_TRACE); without it the TRACE_EVENT() hooks are
+ * empty. The 'trace' command starts/stops recording and dumps the ring to a
+ * file (e.g. to fetch it over MAVLink FTP), which Tools/trace_to_chrome.py
+ * converts into the Chrome trace format.
+ *
+ * On POSIX the same hooks can be exported as USDT probes (provider 'px4') with
+ * the TRACE_USDT cmake option (-DPX4_TRACE_USDT), for bpftrace, perf or LTTng,
+ * see px4_usdt.h. The two options are independent.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <px4_defines.h>
+
+/**
+ * Event types. The BEGIN and END events describe a span on the task or
+ * interrupt they were recorded from, the others are instants.
+ */
+enum trace_event_type {
+	TRACE_EVENT_NONE = 0,
+	TRACE_EVENT_TASK_RESUME,	/**< id: pid of the task that starts running */
+	TRACE_EVENT_TASK_SUSPEND,	/**< id: pid of the task that stops running */
+	TRACE_EVENT_HRT_CALLOUT_BEGIN,	/**< arg: callout function */
+	TRACE_EVENT_HRT_CALLOUT_END,
+	TRACE_EVENT_ORB_PUBLISH,	/**< id: generation (low 16 bits), arg: struct orb_metadata * */
+	TRACE_EVENT_ORB_COPY,		/**< id: generation copied (low 16 bits), arg: struct orb_metadata * */
+	TRACE_EVENT_WORK_BEGIN,		/**< arg: worker function */
+	TRACE_EVENT_WORK_END,
+	TRACE_EVENT_PERF_BEGIN,		/**< arg: perf counter name (PC_ELAPSED and PC_HISTOGRAM counters) */
+	TRACE_EVENT_PERF_END,		/**< arg: perf counter name */
+	TRACE_EVENT_MAVLINK_SEND,	/**< id: message id (low 16 bits), arg: packet length */
+};
+
+struct trace_event_s {
+	uint32_t time;		/**< trace clock, see trace_clock_frequency() */
+	uint16_t type;		/**< enum trace_event_type */
+	uint16_t id;		/**< event specific */
+	uintptr_t arg;		/**< event specific */
+};
+
+#define TRACE_FILE_MAGIC	"PX4TRACE"
+#define TRACE_FILE_VERSION	1
+
+/**
+ * Dump file layout: the header, then event_count struct trace_event_s (oldest
+ * first), then name_count struct trace_name_s resolving the task pids and
+ * orb_metadata pointers found in the events.
+ */
+struct trace_file_header_s {
+	char magic[8];
+	uint16_t version;
+	uint8_t event_size;
+	uint8_t pointer_size;
+	uint32_t clock_frequency;	/**< trace clock in Hz */
+	uint32_t event_count;
+	uint32_t lost_count;		/**< events overwritten before the dump */
+	uint32_t name_count;
+};
+
+struct trace_name_s {
+	uint16_t type;			/**< TRACE_EVENT_TASK_RESUME for pids, TRACE_EVENT_ORB_PUBLISH for topics,
+					     TRACE_EVENT_PERF_BEGIN for perf counters */
+	uint16_t id;			/**< pid */
+	uint32_t reserved;
+	uint64_t arg;			/**< orb_metadata pointer or perf counter name */
+	char name[24];
+};
+
+__BEGIN_DECLS
+
+/**
+ * Record an event. Safe to call from interrupt context.
+ */
+__EXPORT extern void trace_event(enum trace_event_type type, uint16_t id, uintptr_t arg);
+
+/**
+ * Start or stop recording. Recording is off after boot. trace_dump() pauses
+ * it while writing the file.
+ */
+__EXPORT extern void trace_enable(bool enable);
+
+/**
+ * Clear the ring.
+ */
+__EXPORT extern void trace_reset(void);
+
+/**
+ * Write the ring to a file (see struct trace_file_header_s).
+ *
+ * @return 0 on success, -errno otherwise
+ */
+__EXPORT extern int trace_dump(const char *path);
+
+/**
+ * Print the buffer state.
+ */
+__EXPORT extern void trace_print_status(void);
+
+/**
+ * @return the frequency of the trace clock in Hz (CPU cycles on NuttX, microseconds on POSIX)
+ */
+__EXPORT extern uint32_t trace_clock_frequency(void);
+
+__END_DECLS
+
+#if defined(__PX4_POSIX) && defined(PX4_TRACE_USDT)
+#  include <px4_usdt.h>
+#else
+#  define TRACE_USDT(type, id, arg)
+#endif
+
+#ifdef PX4_TRACE
+#  define TRACE_RING(type, id, arg)	trace_event((type), (id), (uintptr_t)(arg))
+#else
+#  define TRACE_RING(type, id, arg)
+#endif
+
+/**
+ * Record an event. type must be one of the enum trace_event_type names, as it
+ * also selects the USDT probe.
+ */
+#define TRACE_EVENT(type, id, arg)	do { TRACE_RING(type, id, arg); TRACE_USDT(type, id, arg); } while (0)
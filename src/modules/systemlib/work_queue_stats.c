@@ -0,0 +1,246 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2017 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file work_queue_stats.c
+ * Work queue item statistics, see work_queue_stats.h.
+ */
+
+#include <px4_config.h>
+#include <px4_defines.h>
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <drivers/drv_hrt.h>
+
+#include "cycle_counter.h"
+#include "work_queue_stats.h"
+
+struct work_item_s {
+	worker_t volatile worker;	///< key, set once when the entry is claimed
+	char name[24];
+	uint8_t qid;
+	uint32_t run_count;
+	uint64_t run_cycles;
+	uint32_t run_cycles_max;
+	uint64_t lateness_us;
+	uint32_t lateness_max_us;
+};
+
+static struct work_item_s work_items[WORK_QUEUE_STATS_MAX_ITEMS];
+static volatile uint32_t work_items_dropped;	///< runs of callbacks that did not fit into the table
+static volatile bool cycle_counter_enabled;
+static hrt_abstime reset_time;
+
+/**
+ * Find the entry of a callback, or claim a new one.
+ * Lock-free: entries are only ever added, and claimed with an atomic
+ * compare and swap, so the work queue threads and registering tasks do not
+ * block each other.
+ */
+static struct work_item_s *find_item(worker_t worker)
+{
+	for (int i = 0; i < WORK_QUEUE_STATS_MAX_ITEMS; i++) {
+		struct work_item_s *item = &work_items[i];
+
+		if (item->worker == worker) {
+			return item;
+		}
+
+		if (item->worker == NULL && __sync_bool_compare_and_swap(&item->worker, NULL, worker)) {
+			return item;
+		}
+
+		/* another thread might just have claimed this entry for the same callback */
+		if (item->worker == worker) {
+			return item;
+		}
+	}
+
+	return NULL;
+}
+
+int work_queue_stats_register(worker_t worker, const char *name)
+{
+	struct work_item_s *item = find_item(worker);
+
+	if (item == NULL) {
+		return -ENOSPC;
+	}
+
+	strncpy(item->name, name, sizeof(item->name) - 1);
+	return 0;
+}
+
+uint32_t work_queue_stats_begin(void)
+{
+	if (!cycle_counter_enabled) {
+		cycle_counter_enable();
+		cycle_counter_enabled = true;
+	}
+
+	return cycle_counter_read();
+}
+
+void work_queue_stats_end(int qid, worker_t worker, uint32_t begin, uint32_t lateness_us)
+{
+	const uint32_t cycles = cycle_counter_read() - begin;
+
+	struct work_item_s *item = find_item(worker);
+
+	if (item == NULL) {
+		work_items_dropped++;
+		return;
+	}
+
+	/* an entry is only updated by the thread running its callback */
+	item->qid = qid;
+	item->run_count++;
+	item->run_cycles += cycles;
+	item->lateness_us += lateness_us;
+
+	if (cycles > item->run_cycles_max) {
+		item->run_cycles_max = cycles;
+	}
+
+	if (lateness_us > item->lateness_max_us) {
+		item->lateness_max_us = lateness_us;
+	}
+}
+
+int work_queue_stats_count(void)
+{
+	int count = 0;
+
+	while (count < WORK_QUEUE_STATS_MAX_ITEMS && work_items[count].worker != NULL) {
+		count++;
+	}
+
+	return count;
+}
+
+bool work_queue_stats_get(int index, struct work_queue_stats_s *stats)
+{
+	if (index < 0 || index >= WORK_QUEUE_STATS_MAX_ITEMS || work_items[index].worker == NULL) {
+		return false;
+	}
+
+	const struct work_item_s *item = &work_items[index];
+	const float us_per_cycle = 1e6f / cycle_counter_frequency();
+
+	stats->worker = item->worker;
+	memcpy(stats->name, item->name, sizeof(stats->name));
+	stats->name[sizeof(stats->name) - 1] = '\0';
+	stats->qid = item->qid;
+	stats->run_count = item->run_count;
+	stats->run_time_us = item->run_cycles / (cycle_counter_frequency() / 1000000);
+	stats->run_time_max_us = item->run_cycles_max * us_per_cycle;
+	stats->lateness_us = item->lateness_us;
+	stats->lateness_max_us = item->lateness_max_us;
+	return true;
+}
+
+void work_queue_stats_reset(void)
+{
+	for (int i = 0; i < WORK_QUEUE_STATS_MAX_ITEMS; i++) {
+		struct work_item_s *item = &work_items[i];
+		item->run_count = 0;
+		item->run_cycles = 0;
+		item->run_cycles_max = 0;
+		item->lateness_us = 0;
+		item->lateness_max_us = 0;
+	}
+
+	work_items_dropped = 0;
+	reset_time = hrt_absolute_time();
+}
+
+static const char *queue_name(int qid)
+{
+	if (qid == HPWORK) {
+		return "hp";
+
+	} else if (qid == LPWORK) {
+		return "lp";
+
+	} else if (qid == WORK_QUEUE_STATS_HRTWORK) {
+		return "hrt";
+	}
+
+	return "?";
+}
+
+void work_queue_stats_print(void)
+{
+	const float elapsed_us = hrt_elapsed_time(&reset_time);
+
+	printf("%-24s %-5s %9s %9s %9s %6s %9s %9s\n", "callback", "queue", "runs", "avg [us]", "max [us]",
+	       "load %", "late avg", "late max");
+
+	for (int i = 0; i < WORK_QUEUE_STATS_MAX_ITEMS; i++) {
+		struct work_queue_stats_s stats;
+
+		if (!work_queue_stats_get(i, &stats)) {
+			break;
+		}
+
+		char name[sizeof(stats.name)];
+
+		if (stats.name[0] != '\0') {
+			strcpy(name, stats.name);
+
+		} else {
+			snprintf(name, sizeof(name), "%p", (void *)(uintptr_t)stats.worker);
+		}
+
+		if (stats.run_count == 0) {
+			printf("%-24s %-5s %9u\n", name, "", 0);
+			continue;
+		}
+
+		printf("%-24s %-5s %9u %9.1f %9.1f %6.2f %9.0f %9u\n", name, queue_name(stats.qid),
+		       (unsigned)stats.run_count,
+		       (double)((float)stats.run_time_us / stats.run_count),
+		       (double)stats.run_time_max_us,
+		       (double)(100.f * stats.run_time_us / elapsed_us),
+		       (double)((float)stats.lateness_us / stats.run_count),
+		       (unsigned)stats.lateness_max_us);
+	}
+
+	if (work_items_dropped > 0) {
+		printf("%u runs of callbacks not in the table (full)\n", (unsigned)work_items_dropped);
+	}
+}
@@ -0,0 +1,119 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2017 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file work_queue_stats.h
+ * Run time and schedule lateness of the work queue items.
+ *
+ * The work queue threads report every item they run (NuttX: through the
+ * sched_note_work_* hooks, POSIX: directly). The statistics are kept per
+ * callback function, so all instances of a driver share an entry. Users can
+ * name their callback with work_queue_stats_register(), other entries show
+ * the function address.
+ *
+ * The run time is measured with the cycle counter (see cycle_counter.h). The
+ * lateness is the time between the scheduled time and the start of the item,
+ * in clock tick resolution on NuttX (CONFIG_USEC_PER_TICK).
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <px4_defines.h>
+#include <px4_workqueue.h>
+
+/** maximum number of distinct callbacks, the others are counted as dropped */
+#define WORK_QUEUE_STATS_MAX_ITEMS	32
+
+/** queue id of the POSIX hrt work queue, after HPWORK and LPWORK */
+#define WORK_QUEUE_STATS_HRTWORK	2
+
+struct work_queue_stats_s {
+	worker_t worker;
+	char name[24];			///< registered name, or empty
+	uint8_t qid;			///< queue the item last ran on
+	uint32_t run_count;
+	uint64_t run_time_us;		///< total run time
+	float run_time_max_us;
+	uint64_t lateness_us;		///< total lateness
+	uint32_t lateness_max_us;
+};
+
+__BEGIN_DECLS
+
+/**
+ * Name a work queue callback. Can be called before or after the first run,
+ * and several times for the same callback (e.g. from every driver instance).
+ * @return 0 on success, -ENOSPC if the table is full
+ */
+__EXPORT int work_queue_stats_register(worker_t worker, const char *name);
+
+/**
+ * Called by the work queue threads before running an item.
+ * @return value to pass to work_queue_stats_end()
+ */
+__EXPORT uint32_t work_queue_stats_begin(void);
+
+/**
+ * Called by the work queue threads after running an item.
+ * @param qid queue the item ran on
+ * @param worker the callback
+ * @param begin value returned by work_queue_stats_begin()
+ * @param lateness_us time between the scheduled time and the start of the item
+ */
+__EXPORT void work_queue_stats_end(int qid, worker_t worker, uint32_t begin, uint32_t lateness_us);
+
+/**
+ * @return number of table entries (registered or run callbacks)
+ */
+__EXPORT int work_queue_stats_count(void);
+
+/**
+ * Read the statistics of an entry, index in [0, work_queue_stats_count()).
+ * @return false if the entry does not exist
+ */
+__EXPORT bool work_queue_stats_get(int index, struct work_queue_stats_s *stats);
+
+/**
+ * Clear the statistics, keeping the registered names.
+ */
+__EXPORT void work_queue_stats_reset(void);
+
+/**
+ * Print a table of all entries.
+ */
+__EXPORT void work_queue_stats_print(void);
+
+__END_DECLS
@@ -33,9 +33,13 @@
 
 #pragma once
 
+#include <stdint.h>
 #include <string.h>
 #include <stdlib.h>
 
+#include <systemlib/mem_pool.h>
+
+struct orb_metadata;
 
 namespace uORB
 {
@@ -43,88 +47,108 @@ class DeviceNode;
 class ORBMap;
 }
 
+/**
+ * Hash map of all DeviceNodes, indexed by the node path and by the topic metadata & instance.
+ * Lookups are O(1) in the number of topics; the nodes are additionally kept in a singly-linked
+ * list in insertion order for iteration.
+ */
 class uORB::ORBMap
 {
 public:
 	struct Node {
-		struct Node *next;
+		struct Node *next; ///< next node in insertion order
+		struct Node *next_name; ///< next node in the same name bucket
+		struct Node *next_meta; ///< next node in the same meta bucket
+		uint32_t hash; ///< hash of node_name
 		const char *node_name;
+		const struct orb_metadata *meta;
+		uint8_t instance;
 		uORB::DeviceNode *node;
 	};
 
 	ORBMap() :
 		_top(nullptr),
 		_end(nullptr)
-	{ }
+	{
+		memset(_name_buckets, 0, sizeof(_name_buckets));
+		memset(_meta_buckets, 0, sizeof(_meta_buckets));
+	}
 	~ORBMap()
 	{
 		while (_top != nullptr) {
-			unlinkNext(_top);
-
-			if (_top->next == nullptr) {
-				free(_top);
-				_top = nullptr;
-				_end = nullptr;
-			}
+			Node *next = _top->next;
+			mem_pool_free(_top, sizeof(Node));
+			_top = next;
 		}
+
+		_end = nullptr;
 	}
 
 	/**
 	 * Insert an element with a unique name
 	 * @param node_name name of the node. This will not be copied, so the caller has to ensure
 	 *                  the pointer is valid until the node is removed from ORBMap
+	 * @param meta topic metadata of the node
+	 * @param instance topic instance of the node
 	 * @param node
 	 */
-	void insert(const char *node_name, uORB::DeviceNode *node)
+	void insert(const char *node_name, const struct orb_metadata *meta, uint8_t instance, uORB::DeviceNode *node)
 	{
-		Node **p;
+		Node *n = (Node *)mem_pool_alloc(sizeof(Node));
 
-		if (_top == nullptr) {
-			p = &_top;
-
-		} else {
-			p = &_end->next;
+		if (n == nullptr) {
+			return;
 		}
 
-		*p = (Node *)malloc(sizeof(Node));
+		n->next = nullptr;
+		n->hash = hash(node_name);
+		n->node_name = node_name;
+		n->meta = meta;
+		n->instance = instance;
+		n->node = node;
+
+		Node **name_bucket = &_name_buckets[n->hash % NUM_BUCKETS];
+		n->next_name = *name_bucket;
+		*name_bucket = n;
+
+		Node **meta_bucket = &_meta_buckets[meta_index(meta, instance)];
+		n->next_meta = *meta_bucket;
+		*meta_bucket = n;
 
 		if (_end) {
-			_end = _end->next;
+			_end->next = n;
 
 		} else {
-			_end = _top;
+			_top = n;
 		}
 
-		_end->next = nullptr;
-		_end->node_name = node_name;
-		_end->node = node;
+		_end = n;
 	}
 
 	bool find(const char *node_name)
 	{
-		Node *p = _top;
+		return get(node_name) != nullptr;
+	}
 
-		while (p) {
-			if (strcmp(p->node_name, node_name) == 0) {
-				return true;
-			}
+	uORB::DeviceNode *get(const char *node_name)
+	{
+		const uint32_t h = hash(node_name);
 
-			p = p->next;
+		for (Node *p = _name_buckets[h % NUM_BUCKETS]; p; p = p->next_name) {
+			if (p->hash == h && strcmp(p->node_name, node_name) == 0) {
+				return p->node;
+			}
 		}
 
-		return false;
+		return nullptr;
 	}
 
-	uORB::DeviceNode *get(const char *node_name)
+	uORB::DeviceNode *get(const struct orb_metadata *meta, uint8_t instance)
 	{
-		Node *p = _top;
-
-		while (p) {
-			if (strcmp(p->node_name, node_name) == 0) {
+		for (Node *p = _meta_buckets[meta_index(meta, instance)]; p; p = p->next_meta) {
+			if (p->meta == meta && p->instance == instance) {
 				return p->node;
 			}
-
-			p = p->next;
 		}
 
 		return nullptr;
@@ -140,22 +164,32 @@ public:
 		return !_top;
 	}
 
-private:
-	void unlinkNext(Node *a)
+	/**
+	 * FNV-1a string hash
+	 */
+	static uint32_t hash(const char *str)
 	{
-		Node *b = a->next;
-
-		if (b != nullptr) {
-			if (_end == b) {
-				_end = a;
-			}
+		uint32_t h = 2166136261u;
 
-			a->next = b->next;
-			free(b);
+		while (*str) {
+			h ^= (uint8_t) * str++;
+			h *= 16777619u;
 		}
+
+		return h;
+	}
+
+private:
+	static constexpr unsigned NUM_BUCKETS = 64; ///< must be a power of 2
+
+	static unsigned meta_index(const struct orb_metadata *meta, uint8_t instance)
+	{
+		// the metadata are statically allocated structs, the lower bits do not carry information
+		return (((uintptr_t)meta >> 4) + instance) & (NUM_BUCKETS - 1);
 	}
 
 	Node *_top;
 	Node *_end;
+	Node *_name_buckets[NUM_BUCKETS];
+	Node *_meta_buckets[NUM_BUCKETS];
 };
-
@@ -0,0 +1,119 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2017 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file SubscriptionCallback.cpp
+ *
+ */
+
+#include "SubscriptionCallback.hpp"
+#include <px4_defines.h>
+#include <px4_posix.h>
+#include <drivers/drv_orb_dev.h>
+
+namespace uORB
+{
+
+SubscriptionCallback::SubscriptionCallback(const struct orb_metadata *meta, worker_t worker, void *arg, int qid,
+		unsigned interval, unsigned instance) :
+	SubscriptionBase(meta, 0, instance),
+	_worker(worker),
+	_arg(arg),
+	_qid(qid),
+	_interval(interval * 1000)
+{
+}
+
+SubscriptionCallback::~SubscriptionCallback()
+{
+	unregister_callback();
+}
+
+bool SubscriptionCallback::register_callback()
+{
+	if (_registered) {
+		return true;
+	}
+
+	if (_handle < 0) {
+		return false;
+	}
+
+	if (px4_ioctl(_handle, ORBIOCREGISTERCALLBACK, (unsigned long)this) != PX4_OK) {
+		PX4_ERR("%s callback registration failed", _meta->o_name);
+		return false;
+	}
+
+	_registered = true;
+	return true;
+}
+
+void SubscriptionCallback::unregister_callback()
+{
+	if (!_registered) {
+		return;
+	}
+
+	px4_ioctl(_handle, ORBIOCUNREGISTERCALLBACK, (unsigned long)this);
+	_registered = false;
+
+	if (!direct()) {
+		work_cancel(_qid, &_work);
+	}
+}
+
+void SubscriptionCallback::call()
+{
+	if (_interval > 0) {
+		const hrt_abstime now = hrt_absolute_time();
+
+		if (now < _last_call + _interval) {
+			return;
+		}
+
+		_last_call = now;
+	}
+
+	if (direct()) {
+		_worker(_arg);
+		return;
+	}
+
+	/* only queue if not already pending, the worker will pick up the latest data */
+	if (_work.worker == nullptr) {
+		work_queue(_qid, &_work, _worker, _arg, 0);
+	}
+}
+
+} // namespace uORB
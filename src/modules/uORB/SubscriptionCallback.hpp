@@ -0,0 +1,123 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2017 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file SubscriptionCallback.hpp
+ *
+ * Subscription that schedules a work queue item on every publication
+ * of the topic, instead of requiring the consumer to poll().
+ */
+
+#pragma once
+
+#include <px4_workqueue.h>
+#include <drivers/drv_hrt.h>
+
+#include "Subscription.hpp"
+
+namespace uORB
+{
+
+class DeviceNode;
+
+/**
+ * Subscription which schedules a work item whenever the topic is published.
+ *
+ * The work item is queued directly from the publisher context
+ * (DeviceNode::write()), so the consumer does not need to own a task and
+ * px4_poll() on the subscription. The worker is expected to call update()
+ * to fetch the data.
+ */
+class __EXPORT SubscriptionCallback : public SubscriptionBase
+{
+public:
+	/**
+	 * Queue id to call the worker directly in the publisher's thread, after the publication, instead of
+	 * scheduling a work item. This is for synchronous, single-threaded setups like an offline replay:
+	 * the publisher must not run in interrupt context. unregister_callback() waits for a publication that is
+	 * calling the worker, so it must not be called from within the worker.
+	 */
+	static constexpr int DIRECT = -1;
+
+	/**
+	 * Constructor
+	 *
+	 * @param meta The uORB metadata (usually from the ORB_ID()
+	 * 	macro) for the topic.
+	 * @param worker The work queue callback, invoked on the work queue thread.
+	 * @param arg The argument passed to the worker.
+	 * @param qid The work queue to schedule on (HPWORK or LPWORK), or DIRECT.
+	 * @param interval The minimum interval in milliseconds between two
+	 * 	scheduled work items, 0 to schedule on every publication.
+	 * @param instance The instance for multi sub.
+	 */
+	SubscriptionCallback(const struct orb_metadata *meta, worker_t worker, void *arg, int qid = HPWORK,
+			     unsigned interval = 0, unsigned instance = 0);
+	virtual ~SubscriptionCallback();
+
+	/**
+	 * Register with the topic, so that every publication schedules the worker.
+	 * @return true on success
+	 */
+	bool register_callback();
+
+	/**
+	 * Stop scheduling the worker and cancel a pending work item.
+	 */
+	void unregister_callback();
+
+	bool registered() const { return _registered; }
+
+	bool direct() const { return _qid == DIRECT; }
+
+	/**
+	 * Called by the DeviceNode on publication. Can be called from interrupt context.
+	 */
+	void call();
+
+private:
+	friend class DeviceNode;
+
+	struct work_s _work {};
+	worker_t _worker;
+	void *_arg;
+	const int _qid;
+	const hrt_abstime _interval; ///< in us
+	hrt_abstime _last_call{0};
+	bool _registered{false};
+
+	SubscriptionCallback *_next_callback{nullptr}; ///< list of callbacks registered with DeviceNode
+};
+
+} // namespace uORB
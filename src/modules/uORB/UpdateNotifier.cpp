@@ -0,0 +1,77 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2017 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file UpdateNotifier.cpp
+ *
+ */
+
+#include "UpdateNotifier.hpp"
+#include <px4_posix.h>
+#include <drivers/drv_orb_dev.h>
+
+namespace uORB
+{
+
+UpdateNotifier::~UpdateNotifier()
+{
+	unregister_notifier();
+}
+
+bool UpdateNotifier::register_notifier(int handle)
+{
+	if (registered()) {
+		return true;
+	}
+
+	if (handle < 0 || px4_ioctl(handle, ORBIOCREGISTERNOTIFIER, (unsigned long)this) != PX4_OK) {
+		return false;
+	}
+
+	_handle = handle;
+	notify();
+	return true;
+}
+
+void UpdateNotifier::unregister_notifier()
+{
+	if (!registered()) {
+		return;
+	}
+
+	px4_ioctl(_handle, ORBIOCUNREGISTERNOTIFIER, (unsigned long)this);
+	_handle = -1;
+}
+
+} // namespace uORB
@@ -0,0 +1,107 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2017 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file UpdateNotifier.hpp
+ *
+ * Sets a bit in a consumer-owned bitmap on every publication of a topic,
+ * so that a consumer of many topics can find the updated ones without a
+ * system call per topic.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <px4_defines.h>
+
+namespace uORB
+{
+
+class DeviceNode;
+
+/**
+ * Publication notification as a bitmap: the publisher atomically sets mask in *word
+ * (from the publisher context, possibly an interrupt). The consumer fetches and clears
+ * the bits with fetch_and_clear(), and then only needs to orb_check()/orb_copy()
+ * the subscriptions with a bit set.
+ */
+class __EXPORT UpdateNotifier
+{
+public:
+	/**
+	 * @param word bitmap word to update, must stay valid while registered
+	 * @param mask bit(s) to set on publication
+	 */
+	UpdateNotifier(volatile uint32_t *word, uint32_t mask) : _word(word), _mask(mask) {}
+	~UpdateNotifier();
+
+	// no copy, assignment, move, move assignment
+	UpdateNotifier(const UpdateNotifier &) = delete;
+	UpdateNotifier &operator=(const UpdateNotifier &) = delete;
+	UpdateNotifier(UpdateNotifier &&) = delete;
+	UpdateNotifier &operator=(UpdateNotifier &&) = delete;
+
+	/**
+	 * Register with the topic of an existing subscription.
+	 * The bits are set once initially, so that already published data is not missed.
+	 * @param handle subscription handle (from orb_subscribe*()), must stay valid while registered
+	 * @return true on success
+	 */
+	bool register_notifier(int handle);
+
+	void unregister_notifier();
+
+	bool registered() const { return _handle >= 0; }
+
+	/**
+	 * Called by the DeviceNode on publication. Can be called from interrupt context.
+	 */
+	void notify() { __sync_fetch_and_or(_word, _mask); }
+
+	/**
+	 * Atomically read and clear a bitmap word
+	 */
+	static uint32_t fetch_and_clear(volatile uint32_t *word) { return __sync_fetch_and_and(word, 0); }
+
+private:
+	friend class DeviceNode;
+
+	volatile uint32_t *_word;
+	const uint32_t _mask;
+	int _handle{-1};
+
+	UpdateNotifier *_next_notifier{nullptr}; ///< list of notifiers registered with DeviceNode
+};
+
+} // namespace uORB
@@ -109,6 +109,12 @@ int  orb_copy(const struct orb_metadata *meta, int handle, void *buffer)
 	return uORB::Manager::get_instance()->orb_copy(meta, handle, buffer);
 }
 
+int  orb_copy_multi(const struct orb_metadata *meta, int handle, void *buffer, unsigned max_items, unsigned *count,
+		    unsigned *lost)
+{
+	return uORB::Manager::get_instance()->orb_copy_multi(meta, handle, buffer, max_items, count, lost);
+}
+
 int  orb_check(int handle, bool *updated)
 {
 	return uORB::Manager::get_instance()->orb_check(handle, updated);
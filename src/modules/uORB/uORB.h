@@ -197,6 +197,12 @@ extern int	orb_unsubscribe(int handle) __EXPORT;
  */
 extern int	orb_copy(const struct orb_metadata *meta, int handle, void *buffer) __EXPORT;
 
+/**
+ * @see uORB::Manager::orb_copy_multi()
+ */
+extern int	orb_copy_multi(const struct orb_metadata *meta, int handle, void *buffer, unsigned max_items,
+			       unsigned *count, unsigned *lost) __EXPORT;
+
 /**
  * @see uORB::Manager::orb_check()
  */
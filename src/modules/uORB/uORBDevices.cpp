@@ -37,38 +37,38 @@
 #include <errno.h>
 #include <poll.h>
 #include <systemlib/px4_macros.h>
+#include <systemlib/trace.h>
 
 #ifdef __PX4_NUTTX
 #define FILE_FLAGS(filp) filp->f_oflags
 #define FILE_PRIV(filp) filp->f_priv
-#define ITERATE_NODE_MAP() \
-	for (ORBMap::Node *node_iter = _node_map.top(); node_iter; node_iter = node_iter->next)
-#define INIT_NODE_MAP_VARS(node_obj, node_name_str) \
-	DeviceNode *node_obj = node_iter->node; \
-	const char *node_name_str = node_iter->node_name; \
-	UNUSED(node_name_str);
-
 #else
 #include <algorithm>
 #define FILE_FLAGS(filp) filp->flags
 #define FILE_PRIV(filp) filp->priv
+#endif
+
 #define ITERATE_NODE_MAP() \
-	for (const auto &node_iter : _node_map)
+	for (ORBMap::Node *node_iter = _node_map.top(); node_iter; node_iter = node_iter->next)
 #define INIT_NODE_MAP_VARS(node_obj, node_name_str) \
-	DeviceNode *node_obj = node_iter.second; \
-	const char *node_name_str = node_iter.first.c_str(); \
+	DeviceNode *node_obj = node_iter->node; \
+	const char *node_name_str = node_iter->node_name; \
 	UNUSED(node_name_str);
-#endif
 
 #include "uORBDevices.hpp"
 #include "uORBUtils.hpp"
 #include "uORBManager.hpp"
 #include "uORBCommunicator.hpp"
+#include "SubscriptionCallback.hpp"
+#include "UpdateNotifier.hpp"
 #include <px4_sem.hpp>
 #include <stdlib.h>
 
 using namespace device;
 
+bool uORB::DeviceNode::_latency_tracking = false;
+const uint16_t uORB::DeviceNode::latency_bucket_limit_us[latency_buckets - 1] = { 100, 500, 1000, 5000, 20000 };
+
 uORB::DeviceNode::SubscriberData *uORB::DeviceNode::filp_to_sd(device::file_t *filp)
 {
 #ifndef __PX4_NUTTX
@@ -88,20 +88,58 @@ uORB::DeviceNode::DeviceNode(const struct orb_metadata *meta, const char *name,
 	_data(nullptr),
 	_last_update(0),
 	_generation(0),
+	_seq(0),
+	_seq_ptr(&_seq),
+#ifdef ORB_USE_SHMEM
+	_shm(nullptr),
+	_vehicle_instance((uint8_t)uORB::Utils::vehicle_instance()),
+#endif
 	_priority((uint8_t)priority),
 	_published(false),
 	_queue_size(queue_size),
 	_subscriber_count(0),
+	_callbacks(nullptr),
+	_direct_callbacks_running(0),
+	_notifiers(nullptr),
+	_prealloc_data(nullptr),
+	_prealloc_queue_size(0),
+	_prealloc_unclaimed(false),
 	_publisher(0)
 {
 }
 
 uORB::DeviceNode::~DeviceNode()
 {
-	if (_data != nullptr) {
+#ifdef ORB_USE_SHMEM
+
+	if (_shm != nullptr) {
+		/* _data points into the segment */
+		delete _shm;
+		_data = nullptr;
+
+		char name[orb_maxpath];
+
+		if (shmem_name(name, sizeof(name))) {
+			ShmemSegment::remove(name);
+		}
+	}
+
+#endif
+
+	if (_data != nullptr && _data != _prealloc_data) {
 		delete[] _data;
 	}
 
+	delete[] _latency_histogram;
+}
+
+uint8_t *uORB::DeviceNode::allocate_data()
+{
+	if (_prealloc_data != nullptr && _queue_size <= _prealloc_queue_size) {
+		return _prealloc_data;
+	}
+
+	return new uint8_t[_meta->o_size * _queue_size];
 }
 
 int
@@ -212,36 +250,88 @@ uORB::DeviceNode::read(device::file_t *filp, char *buffer, size_t buflen)
 		return 0;
 	}
 
+#ifdef ORB_USE_SHMEM
+	shmem_sync();
+#endif
+
 	/* if the caller's buffer is the wrong size, that's an error */
 	if (buflen != _meta->o_size) {
 		return -EIO;
 	}
 
 	/*
-	 * Perform an atomic copy & state update
+	 * Perform a lock-free copy: retry if a publisher wrote to the node during the copy.
+	 * The generation bookkeeping is done on a local copy and only committed once the
+	 * copied data is known to be consistent.
 	 */
-	ATOMIC_ENTER;
+	unsigned generation = 0;
+	uint32_t lost_messages = 0;
 
-	if (_generation > sd->generation + _queue_size) {
-		/* Reader is too far behind: some messages are lost */
-		_lost_messages += _generation - (sd->generation + _queue_size);
-		sd->generation = _generation - _queue_size;
-	}
+	auto copy = [&]() {
+		const unsigned node_generation = _generation;
+		generation = sd->generation;
+		lost_messages = 0;
 
-	if (_generation == sd->generation && sd->generation > 0) {
-		/* The subscriber already read the latest message, but nothing new was published yet.
-		 * Return the previous message
+		if (generation > node_generation) {
+			/* only possible if the shared memory segment was reset */
+			generation = node_generation;
+		}
+
+		if (node_generation > generation + _queue_size) {
+			/* Reader is too far behind: some messages are lost */
+			lost_messages = node_generation - (generation + _queue_size);
+			generation = node_generation - _queue_size;
+		}
+
+		if (node_generation == generation && generation > 0) {
+			/* The subscriber already read the latest message, but nothing new was published yet.
+			 * Return the previous message
+			 */
+			--generation;
+		}
+
+		/* if the caller doesn't want the data, don't give it to them */
+		if (nullptr != buffer) {
+			memcpy(buffer, _data + (_meta->o_size * (generation % _queue_size)), _meta->o_size);
+		}
+
+		if (generation < node_generation) {
+			++generation;
+		}
+	};
+
+	if (sd->update_interval != nullptr) {
+		/*
+		 * Rate-limited subscribers share the update_reported flag with appears_updated(), which runs from the
+		 * publisher's poll notification (in a critical section on NuttX). Keep the copy and state update atomic for them.
 		 */
-		--sd->generation;
+		ATOMIC_ENTER;
+		seq_read(copy, true);
+		read_commit(sd, generation, lost_messages);
+		ATOMIC_LEAVE;
+
+	} else {
+		seq_read(copy, false);
+		read_commit(sd, generation, lost_messages);
 	}
 
-	/* if the caller doesn't want the data, don't give it to them */
-	if (nullptr != buffer) {
-		memcpy(buffer, _data + (_meta->o_size * (sd->generation % _queue_size)), _meta->o_size);
+	return _meta->o_size;
+}
+
+void
+uORB::DeviceNode::read_commit(SubscriberData *sd, unsigned generation, uint32_t lost_messages)
+{
+	/* only the latency to the latest element is known, as we do not store a timestamp per element */
+	if (_latency_tracking && generation != sd->generation && generation == _generation) {
+		update_latency_histogram();
 	}
 
-	if (sd->generation < _generation) {
-		++sd->generation;
+	sd->generation = generation;
+
+	TRACE_EVENT(TRACE_EVENT_ORB_COPY, generation, _meta);
+
+	if (lost_messages > 0) {
+		__sync_fetch_and_add(&_lost_messages, lost_messages);
 	}
 
 	/* set priority */
@@ -252,10 +342,6 @@ uORB::DeviceNode::read(device::file_t *filp, char *buffer, size_t buflen)
 	 * we have just collected it.
 	 */
 	sd->set_update_reported(false);
-
-	ATOMIC_LEAVE;
-
-	return _meta->o_size;
 }
 
 ssize_t
@@ -279,7 +365,7 @@ uORB::DeviceNode::write(device::file_t *filp, const char *buffer, size_t buflen)
 
 			/* re-check size */
 			if (nullptr == _data) {
-				_data = new uint8_t[_meta->o_size * _queue_size];
+				_data = allocate_data();
 			}
 
 			unlock();
@@ -290,7 +376,17 @@ uORB::DeviceNode::write(device::file_t *filp, const char *buffer, size_t buflen)
 
 		/* re-check size */
 		if (nullptr == _data) {
-			_data = new uint8_t[_meta->o_size * _queue_size];
+#ifdef ORB_USE_SHMEM
+
+			if (uORB::Manager::get_instance()->shmem_enabled()) {
+				shmem_allocate();
+			}
+
+			if (nullptr == _data)
+#endif
+			{
+				_data = allocate_data();
+			}
 		}
 
 		unlock();
@@ -307,22 +403,73 @@ uORB::DeviceNode::write(device::file_t *filp, const char *buffer, size_t buflen)
 		return -EIO;
 	}
 
-	/* Perform an atomic copy. */
+	/* Perform an atomic copy. Readers do not take the lock, they are synchronized via _seq. */
 	ATOMIC_ENTER;
+	(*_seq_ptr)++;
+	__sync_synchronize();
+
 	memcpy(_data + (_meta->o_size * (_generation % _queue_size)), buffer, _meta->o_size);
 
 	/* update the timestamp and generation count */
 	_last_update = hrt_absolute_time();
+
+#ifdef ORB_USE_SHMEM
+
+	if (_shm != nullptr) {
+		/* update the segment first, so that shmem_sync() never sees an outdated generation */
+		_shm->header()->timestamp = _last_update;
+		_shm->header()->generation = _generation + 1;
+	}
+
+#endif
+
 	/* wrap-around happens after ~49 days, assuming a publisher rate of 1 kHz */
 	_generation++;
 
+	TRACE_EVENT(TRACE_EVENT_ORB_PUBLISH, _generation, _meta);
+
 	_published = true;
 
+	__sync_synchronize();
+	(*_seq_ptr)++;
+
+	/* schedule the work items of callback subscribers */
+	bool direct_callbacks = false;
+
+	for (SubscriptionCallback *callback = _callbacks; callback != nullptr; callback = callback->_next_callback) {
+		if (callback->direct()) {
+			direct_callbacks = true;
+
+		} else {
+			callback->call();
+		}
+	}
+
+	if (direct_callbacks) {
+		/* unregister_callback() waits until the list walk below is done */
+		__sync_fetch_and_add(&_direct_callbacks_running, 1);
+	}
+
+	for (UpdateNotifier *notifier = _notifiers; notifier != nullptr; notifier = notifier->_next_notifier) {
+		notifier->notify();
+	}
+
 	ATOMIC_LEAVE;
 
 	/* notify any poll waiters */
 	poll_notify(POLLIN);
 
+	/* direct callbacks run outside of the lock, so that they can read the topic */
+	if (direct_callbacks) {
+		for (SubscriptionCallback *callback = _callbacks; callback != nullptr; callback = callback->_next_callback) {
+			if (callback->direct()) {
+				callback->call();
+			}
+		}
+
+		__sync_fetch_and_sub(&_direct_callbacks_running, 1);
+	}
+
 	return _meta->o_size;
 }
 
@@ -333,9 +480,14 @@ uORB::DeviceNode::ioctl(device::file_t *filp, int cmd, unsigned long arg)
 
 	switch (cmd) {
 	case ORBIOCLASTUPDATE: {
-			ATOMIC_ENTER;
-			*(hrt_abstime *)arg = _last_update;
-			ATOMIC_LEAVE;
+#ifdef ORB_USE_SHMEM
+			shmem_sync();
+#endif
+			hrt_abstime last_update = 0;
+
+			seq_read([&]() { last_update = _last_update; }, false);
+
+			*(hrt_abstime *)arg = last_update;
 			return PX4_OK;
 		}
 
@@ -355,6 +507,8 @@ uORB::DeviceNode::ioctl(device::file_t *filp, int cmd, unsigned long arg)
 
 			if (arg == 0) {
 				if (sd->update_interval) {
+					/* a deferred wakeup might still be pending */
+					hrt_cancel(&sd->update_interval->update_call);
 					delete (sd->update_interval);
 					sd->update_interval = nullptr;
 				}
@@ -362,9 +516,6 @@ uORB::DeviceNode::ioctl(device::file_t *filp, int cmd, unsigned long arg)
 			} else {
 				if (sd->update_interval) {
 					sd->update_interval->interval = arg;
-#ifndef __PX4_NUTTX
-					sd->update_interval->last_update = hrt_absolute_time();
-#endif
 
 				} else {
 					sd->update_interval = new UpdateIntervalData();
@@ -372,9 +523,6 @@ uORB::DeviceNode::ioctl(device::file_t *filp, int cmd, unsigned long arg)
 					if (sd->update_interval) {
 						memset(&sd->update_interval->update_call, 0, sizeof(hrt_call));
 						sd->update_interval->interval = arg;
-#ifndef __PX4_NUTTX
-						sd->update_interval->last_update = hrt_absolute_time();
-#endif
 
 					} else {
 						ret = -ENOMEM;
@@ -414,6 +562,21 @@ uORB::DeviceNode::ioctl(device::file_t *filp, int cmd, unsigned long arg)
 
 		return OK;
 
+	case ORBIOCCOPYMULTI:
+		return copy_multi(sd, (struct orb_copy_multi_s *)arg);
+
+	case ORBIOCREGISTERCALLBACK:
+		return register_callback((SubscriptionCallback *)arg);
+
+	case ORBIOCUNREGISTERCALLBACK:
+		return unregister_callback((SubscriptionCallback *)arg);
+
+	case ORBIOCREGISTERNOTIFIER:
+		return register_notifier((UpdateNotifier *)arg);
+
+	case ORBIOCUNREGISTERNOTIFIER:
+		return unregister_notifier((UpdateNotifier *)arg);
+
 	default:
 		/* give it to the superclass */
 		return CDev::ioctl(filp, cmd, arg);
@@ -541,15 +704,28 @@ uORB::DeviceNode::poll_notify_one(px4_pollfd_struct_t *fds, pollevent_t events)
 	}
 }
 
-#ifdef __PX4_NUTTX
 bool
 uORB::DeviceNode::appears_updated(SubscriberData *sd)
 {
+#ifndef __PX4_NUTTX
+
+	/* block if in simulation mode */
+	while (px4_sim_delay_enabled()) {
+		usleep(100);
+	}
+
+#endif
+
 	/* assume it doesn't look updated */
 	bool ret = false;
 
-	/* avoid racing between interrupt and non-interrupt context calls */
+	/*
+	 * Avoid racing between interrupt and non-interrupt context calls.
+	 * On POSIX, the callers already hold the lock.
+	 */
+#ifdef __PX4_NUTTX
 	irqstate_t state = px4_enter_critical_section();
+#endif
 
 	/* check if this topic has been published yet, if not bail out */
 	if (_data == nullptr) {
@@ -557,6 +733,11 @@ uORB::DeviceNode::appears_updated(SubscriberData *sd)
 		goto out;
 	}
 
+#ifdef ORB_USE_SHMEM
+	/* the callers hold the lock */
+	shmem_sync_locked();
+#endif
+
 	/*
 	 * If the subscriber's generation count matches the update generation
 	 * count, there has been no update from their perspective; if they
@@ -590,6 +771,8 @@ uORB::DeviceNode::appears_updated(SubscriberData *sd)
 		 * We have previously been through here, so the subscriber
 		 * must have collected the update we reported, otherwise
 		 * update_reported would still be true.
+		 * The subscriber is not woken up by the publisher in this case, but by
+		 * the deferred poll notification once the interval expired.
 		 */
 		if (!hrt_called(&sd->update_interval->update_call)) {
 			break;
@@ -615,77 +798,291 @@ uORB::DeviceNode::appears_updated(SubscriberData *sd)
 	}
 
 out:
+#ifdef __PX4_NUTTX
 	px4_leave_critical_section(state);
+#endif
 
 	/* consider it updated */
 	return ret;
 }
 
-#else
+void
+uORB::DeviceNode::update_latency_histogram()
+{
+	if (_latency_histogram == nullptr) {
+		uint32_t *histogram = new uint32_t[latency_buckets];
+
+		if (histogram == nullptr) {
+			return;
+		}
+
+		memset(histogram, 0, sizeof(uint32_t) * latency_buckets);
+
+		/* another subscriber might have allocated it concurrently */
+		if (!__sync_bool_compare_and_swap(&_latency_histogram, nullptr, histogram)) {
+			delete[] histogram;
+		}
+	}
+
+	const hrt_abstime latency = hrt_elapsed_time((const hrt_abstime *)&_last_update);
+	int bucket = 0;
+
+	while (bucket < latency_buckets - 1 && latency >= latency_bucket_limit_us[bucket]) {
+		++bucket;
+	}
+
+	__sync_fetch_and_add(&_latency_histogram[bucket], 1);
+}
 
 bool
-uORB::DeviceNode::appears_updated(SubscriberData *sd)
+uORB::DeviceNode::latency_histogram(uint32_t *histogram, bool reset)
 {
+	if (_latency_histogram == nullptr) {
+		return false;
+	}
 
-	/* block if in simulation mode */
-	while (px4_sim_delay_enabled()) {
-		usleep(100);
+	for (int i = 0; i < latency_buckets; ++i) {
+		histogram[i] = reset ? __sync_fetch_and_and(&_latency_histogram[i], 0) : _latency_histogram[i];
 	}
 
-	/* assume it doesn't look updated */
-	bool ret = false;
+	return true;
+}
 
-	/* check if this topic has been published yet, if not bail out */
-	if (_data == nullptr) {
-		return false;
+#ifdef ORB_USE_SHMEM
+bool
+uORB::DeviceNode::shmem_name(char *name, size_t len)
+{
+	const char *devname = get_devname();
+	const unsigned instance = devname[strlen(devname) - 1] - '0';
+	return ShmemSegment::get_name(name, len, _vehicle_instance, _meta->o_name, instance);
+}
+
+void
+uORB::DeviceNode::shmem_allocate()
+{
+	char name[orb_maxpath];
+
+	if (!shmem_name(name, sizeof(name))) {
+		return;
+	}
+
+	ShmemSegment *shm = new ShmemSegment();
+
+	if (shm == nullptr) {
+		return;
+	}
+
+	if (!shm->create(name, _meta->o_size, _queue_size)) {
+		PX4_WARN("%s: shared memory allocation failed (%i)", name, errno);
+		delete shm;
+		return;
+	}
+
+	_shm = shm;
+	_seq_ptr = &shm->header()->seq;
+	_data = shm->data();
+}
+
+void
+uORB::DeviceNode::shmem_sync()
+{
+	/* nothing to do unless the generation differs, which is rare: check that first without the lock */
+	if (_shm == nullptr || _shm->header()->generation == _generation) {
+		return;
+	}
+
+	lock();
+	shmem_sync_locked();
+	unlock();
+}
+
+void
+uORB::DeviceNode::shmem_sync_locked()
+{
+	if (_shm == nullptr) {
+		return;
 	}
 
+	const unsigned generation = _shm->header()->generation;
+
 	/*
-	 * If the subscriber's generation count matches the update generation
-	 * count, there has been no update from their perspective; if they
-	 * don't match then we might have a visible update.
+	 * An external process published to the segment. Subscribers are not woken up from poll()
+	 * for these publications, but orb_check() and orb_copy() see them.
 	 */
-	while (sd->generation != _generation) {
+	if (generation != _generation) {
+		_last_update = _shm->header()->timestamp;
+		_generation = generation;
+		_published = true;
+	}
+}
+#endif /* ORB_USE_SHMEM */
 
-		/*
-		 * Handle non-rate-limited subscribers.
-		 */
-		if (sd->update_interval == nullptr) {
-			ret = true;
-			break;
+int
+uORB::DeviceNode::copy_multi(SubscriberData *sd, struct orb_copy_multi_s *copy_multi)
+{
+	copy_multi->count = 0;
+	copy_multi->lost = 0;
+
+	if (sd == nullptr) {
+		return -EINVAL;
+	}
+
+	/* if the object has not been written yet, there is nothing to copy */
+	if (_data == nullptr || copy_multi->max_items == 0) {
+		return PX4_OK;
+	}
+
+#ifdef ORB_USE_SHMEM
+	shmem_sync();
+#endif
+
+	/* same as read(), but copy the whole range of pending generations at once */
+	unsigned generation = 0;
+	unsigned count = 0;
+	uint32_t lost_messages = 0;
+
+	auto copy = [&]() {
+		const unsigned node_generation = _generation;
+		generation = sd->generation;
+		lost_messages = 0;
+
+		if (node_generation > generation + _queue_size) {
+			lost_messages = node_generation - (generation + _queue_size);
+			generation = node_generation - _queue_size;
 		}
 
-		/*
-		 * If we have previously told the subscriber that there is data,
-		 * and they have not yet collected it, continue to tell them
-		 * that there has been an update.  This mimics the non-rate-limited
-		 * behaviour where checking / polling continues to report an update
-		 * until the topic is read.
-		 */
-		if (sd->update_reported()) {
-			ret = true;
-			break;
+		/* the generation can only be ahead of the node if the segment was reset */
+		count = node_generation > generation ? node_generation - generation : 0;
+
+		if (count > copy_multi->max_items) {
+			count = copy_multi->max_items;
+		}
+
+		uint8_t *buffer = (uint8_t *)copy_multi->buffer;
+
+		for (unsigned i = 0; i < count; ++i) {
+			memcpy(buffer, _data + (_meta->o_size * ((generation + i) % _queue_size)), _meta->o_size);
+			buffer += _meta->o_size;
+		}
+	};
+
+	auto commit = [&]() {
+		sd->generation = generation + count;
+		copy_multi->count = count;
+		copy_multi->lost = lost_messages;
+
+		if (lost_messages > 0) {
+			__sync_fetch_and_add(&_lost_messages, lost_messages);
+		}
+
+		sd->set_priority(_priority);
+
+		/* only clear the reported update if everything pending was collected */
+		if (sd->generation == _generation) {
+			sd->set_update_reported(false);
 		}
+	};
+
+	if (sd->update_interval != nullptr) {
+		/* atomic with appears_updated() for rate-limited subscribers, see read() */
+		ATOMIC_ENTER;
+		seq_read(copy, true);
+		commit();
+		ATOMIC_LEAVE;
+
+	} else {
+		seq_read(copy, false);
+		commit();
+	}
+
+	return PX4_OK;
+}
+
+int
+uORB::DeviceNode::register_callback(SubscriptionCallback *callback)
+{
+	if (callback == nullptr) {
+		return -EINVAL;
+	}
 
-		// If we have not yet reached the deadline, then assume that we can ignore any
-		// newly received data.
-		if (sd->update_interval->last_update + sd->update_interval->interval > hrt_absolute_time()) {
+	/* the list is traversed in write(), which can run in interrupt context */
+	ATOMIC_ENTER;
+	callback->_next_callback = _callbacks;
+	_callbacks = callback;
+	ATOMIC_LEAVE;
+
+	return PX4_OK;
+}
+
+int
+uORB::DeviceNode::unregister_callback(SubscriptionCallback *callback)
+{
+	int ret = -EINVAL;
+
+	ATOMIC_ENTER;
+
+	for (SubscriptionCallback **iter = &_callbacks; *iter != nullptr; iter = &(*iter)->_next_callback) {
+		if (*iter == callback) {
+			*iter = callback->_next_callback;
+			ret = PX4_OK;
 			break;
 		}
+	}
 
+	ATOMIC_LEAVE;
+
+	if (ret == PX4_OK) {
 		/*
-		 * Remember that we have told the subscriber that there is data.
+		 * A publication can still be walking the list outside of the lock and be calling the direct callbacks.
+		 * Wait until it is done: the callback (and the following ones, reached through its _next_callback)
+		 * must stay valid until then. New publications do not see the callback anymore.
 		 */
-		sd->set_update_reported(true);
-		sd->update_interval->last_update = hrt_absolute_time();
-		ret = true;
+		while (_direct_callbacks_running > 0) {
+			usleep(100);
+		}
 
-		break;
+		callback->_next_callback = nullptr;
+	}
+
+	return ret;
+}
+
+int
+uORB::DeviceNode::register_notifier(UpdateNotifier *notifier)
+{
+	if (notifier == nullptr) {
+		return -EINVAL;
+	}
+
+	/* the list is traversed in write(), which can run in interrupt context */
+	ATOMIC_ENTER;
+	notifier->_next_notifier = _notifiers;
+	_notifiers = notifier;
+	ATOMIC_LEAVE;
+
+	return PX4_OK;
+}
+
+int
+uORB::DeviceNode::unregister_notifier(UpdateNotifier *notifier)
+{
+	int ret = -EINVAL;
+
+	ATOMIC_ENTER;
+
+	for (UpdateNotifier **iter = &_notifiers; *iter != nullptr; iter = &(*iter)->_next_notifier) {
+		if (*iter == notifier) {
+			*iter = notifier->_next_notifier;
+			notifier->_next_notifier = nullptr;
+			ret = PX4_OK;
+			break;
+		}
 	}
 
+	ATOMIC_LEAVE;
+
 	return ret;
 }
-#endif /* ifdef __PX4_NUTTX */
 
 void
 uORB::DeviceNode::update_deferred()
@@ -835,16 +1232,84 @@ int16_t uORB::DeviceNode::process_received_message(int32_t length, uint8_t *data
 	return PX4_OK;
 }
 
-uORB::DeviceMaster::DeviceMaster(Flavor f) :
-	CDev((f == PUBSUB) ? "obj_master" : "param_master",
-	     (f == PUBSUB) ? TOPIC_MASTER_DEVICE_PATH : PARAM_MASTER_DEVICE_PATH),
-	_flavor(f)
+uORB::DeviceMaster::DeviceMaster(Flavor f, const char *devpath) :
+	CDev((f == PUBSUB) ? "obj_master" : "param_master", devpath),
+	_flavor(f),
+	_prealloc_arena(nullptr)
 {
 	_last_statistics_output = hrt_absolute_time();
 }
 
 uORB::DeviceMaster::~DeviceMaster()
 {
+	/* the nodes are never deleted, so neither is the arena */
+}
+
+int uORB::DeviceMaster::preallocate(const struct orb_prealloc_s *topics, size_t count)
+{
+	const size_t align = sizeof(uint64_t);
+	size_t arena_size = 0;
+
+	for (size_t i = 0; i < count; ++i) {
+		const size_t data_size = (topics[i].meta->o_size * topics[i].queue_size + align - 1) & ~(align - 1);
+		const unsigned instances = topics[i].instances < ORB_MULTI_MAX_INSTANCES ? topics[i].instances : ORB_MULTI_MAX_INSTANCES;
+		arena_size += data_size * instances;
+	}
+
+	if (arena_size == 0 || _prealloc_arena != nullptr) {
+		return PX4_OK;
+	}
+
+	_prealloc_arena = new uint8_t[arena_size];
+
+	if (_prealloc_arena == nullptr) {
+		return -ENOMEM;
+	}
+
+	uint8_t *data = _prealloc_arena;
+	SmartLock smart_lock(_lock);
+
+	for (size_t i = 0; i < count; ++i) {
+		const struct orb_metadata *meta = topics[i].meta;
+		const size_t data_size = (meta->o_size * topics[i].queue_size + align - 1) & ~(align - 1);
+
+		for (int instance = 0; instance < (int)topics[i].instances && instance < ORB_MULTI_MAX_INSTANCES; ++instance) {
+			char nodepath[orb_maxpath];
+
+			if (uORB::Utils::node_mkpath(nodepath, _flavor, meta, &instance) != PX4_OK) {
+				break;
+			}
+
+			/* driver wants a permanent copy of the path, so make one here */
+			const char *devpath = strdup(nodepath);
+
+			if (devpath == nullptr) {
+				return -ENOMEM;
+			}
+
+			uORB::DeviceNode *node = new uORB::DeviceNode(meta, meta->o_name, devpath, ORB_PRIO_DEFAULT);
+
+			if (node == nullptr) {
+				free((void *)devpath);
+				return -ENOMEM;
+			}
+
+			if (node->init() != PX4_OK) {
+				/* already exists (e.g. listed twice): keep the existing node */
+				delete node;
+				free((void *)devpath);
+				data += data_size;
+				continue;
+			}
+
+			node->set_preallocated(data, topics[i].queue_size);
+			data += data_size;
+			_node_map.insert(devpath, meta, instance, node);
+		}
+	}
+
+	PX4_DEBUG("preallocated %i topics (%i bytes)", (int)count, (int)arena_size);
+	return PX4_OK;
 }
 
 int
@@ -927,6 +1392,7 @@ uORB::DeviceMaster::ioctl(device::file_t *filp, int cmd, unsigned long arg)
 
 						if ((existing_node != nullptr) && !(existing_node->is_published())) {
 							/* nothing has been published yet, lets claim it */
+							existing_node->claim_preallocated(adv->priority);
 							ret = PX4_OK;
 
 						} else {
@@ -939,11 +1405,7 @@ uORB::DeviceMaster::ioctl(device::file_t *filp, int cmd, unsigned long arg)
 
 				} else {
 					// add to the node map;.
-#ifdef __PX4_NUTTX
-					_node_map.insert(devpath, node);
-#else
-					_node_map[std::string(devpath)] = node;
-#endif
+					_node_map.insert(devpath, meta, adv->instance ? *adv->instance : 0, node);
 				}
 
 				group_tries++;
@@ -1066,15 +1528,28 @@ void uORB::DeviceMaster::showTop(char **topic_filter, int num_filters)
 {
 
 	bool print_active_only = true;
+	bool print_latency = false;
 
-	if (topic_filter && num_filters > 0) {
+	while (topic_filter && num_filters > 0 && topic_filter[0][0] == '-') {
 		if (!strcmp("-a", topic_filter[0])) {
-			num_filters = 0;
+			print_active_only = false;
+
+		} else if (!strcmp("-l", topic_filter[0])) {
+			print_latency = true;
 		}
 
+		++topic_filter;
+		--num_filters;
+	}
+
+	if (num_filters > 0) {
 		print_active_only = false; // print non-active if -a or some filter given
 	}
 
+	if (print_latency) {
+		DeviceNode::set_latency_tracking(true);
+	}
+
 	printf("\033[2J\n"); //clear screen
 
 	lock();
@@ -1161,23 +1636,44 @@ void uORB::DeviceMaster::showTop(char **topic_filter, int num_filters)
 			printf("\033[H"); // move cursor home and clear screen
 			printf(CLEAR_LINE "update: 1s, num topics: %i\n", num_topics);
 #ifdef __PX4_NUTTX
-			printf(CLEAR_LINE "%*-s INST #SUB #MSG #LOST #QSIZE\n", (int)max_topic_name_length - 2, "TOPIC NAME");
+			printf(CLEAR_LINE "%*-s INST #SUB #MSG #LOST #QSIZE", (int)max_topic_name_length - 2, "TOPIC NAME");
 #else
-			printf(CLEAR_LINE "%*s INST #SUB #MSG #LOST #QSIZE\n", -(int)max_topic_name_length + 2, "TOPIC NAME");
+			printf(CLEAR_LINE "%*s INST #SUB #MSG #LOST #QSIZE", -(int)max_topic_name_length + 2, "TOPIC NAME");
 #endif
+
+			if (print_latency) {
+				for (int i = 0; i < DeviceNode::latency_buckets - 1; ++i) {
+					printf(" <%5ius", DeviceNode::latency_bucket_limit_us[i]);
+				}
+
+				printf(" %7s", "more");
+			}
+
+			printf("\n");
 			cur_node = first_node;
 
 			while (cur_node) {
 
 				if (!print_active_only || cur_node->pub_msg_delta > 0) {
 #ifdef __PX4_NUTTX
-					printf(CLEAR_LINE "%*-s %2i %4i %4i %5i %i\n", (int)max_topic_name_length,
+					printf(CLEAR_LINE "%*-s %2i %4i %4i %5i %6i", (int)max_topic_name_length,
 #else
-					printf(CLEAR_LINE "%*s %2i %4i %4i %5i %i\n", -(int)max_topic_name_length,
+					printf(CLEAR_LINE "%*s %2i %4i %4i %5i %6i", -(int)max_topic_name_length,
 #endif
 					       cur_node->node->get_meta()->o_name, (int)cur_node->instance,
 					       (int)cur_node->node->subscriber_count(), cur_node->pub_msg_delta,
 					       (int)cur_node->lost_msg_delta, cur_node->node->get_queue_size());
+
+					uint32_t histogram[DeviceNode::latency_buckets];
+
+					/* the number of copies per bucket during the last update interval */
+					if (print_latency && cur_node->node->latency_histogram(histogram, true)) {
+						for (int i = 0; i < DeviceNode::latency_buckets; ++i) {
+							printf(" %8u", (unsigned)histogram[i]);
+						}
+					}
+
+					printf("\n");
 				}
 
 				cur_node = cur_node->next;
@@ -1189,6 +1685,10 @@ void uORB::DeviceMaster::showTop(char **topic_filter, int num_filters)
 		}
 	}
 
+	if (print_latency) {
+		DeviceNode::set_latency_tracking(false);
+	}
+
 	//cleanup
 	cur_node = first_node;
 
@@ -1212,31 +1712,15 @@ uORB::DeviceNode *uORB::DeviceMaster::getDeviceNode(const char *nodepath)
 }
 
 
-#ifdef __PX4_NUTTX
-uORB::DeviceNode *uORB::DeviceMaster::getDeviceNodeLocked(const char *nodepath)
+uORB::DeviceNode *uORB::DeviceMaster::getDeviceNode(const struct orb_metadata *meta, uint8_t instance)
 {
-	uORB::DeviceNode *rc = nullptr;
-
-	if (_node_map.find(nodepath)) {
-		rc = _node_map.get(nodepath);
-	}
-
-	return rc;
+	lock();
+	uORB::DeviceNode *node = _node_map.get(meta, instance);
+	unlock();
+	return node;
 }
 
-#else
-
 uORB::DeviceNode *uORB::DeviceMaster::getDeviceNodeLocked(const char *nodepath)
 {
-	uORB::DeviceNode *rc = nullptr;
-	std::string np(nodepath);
-
-	auto iter = _node_map.find(np);
-
-	if (iter != _node_map.end()) {
-		rc = iter->second;
-	}
-
-	return rc;
+	return _node_map.get(nodepath);
 }
-#endif
@@ -34,26 +34,19 @@
 #pragma once
 
 #include <stdint.h>
+#include <systemlib/mem_pool.h>
 #include "uORBCommon.hpp"
-
-
-#ifdef __PX4_NUTTX
-#include <string.h>
-#include <stdlib.h>
 #include "ORBMap.hpp"
-
-#else
-
-#include <string>
-#include <map>
-
-#endif /* __PX4_NUTTX */
+#include "uORBShmem.hpp"
+#include "uORBTopics.h"
 
 namespace uORB
 {
 class DeviceNode;
 class DeviceMaster;
 class Manager;
+class SubscriptionCallback;
+class UpdateNotifier;
 }
 
 /**
@@ -179,6 +172,49 @@ public:
 	 */
 	bool print_statistics(bool reset);
 
+	/**
+	 * Publish to copy latency histogram: number of copies of the latest element with a latency
+	 * below latency_bucket_limit_us[i]. The last bucket counts all others.
+	 */
+	static constexpr int latency_buckets = 6;
+	static const uint16_t latency_bucket_limit_us[latency_buckets - 1];
+
+	/**
+	 * Enable/disable tracking of the publish to copy latency for all topics.
+	 * The histograms are allocated on the first copy after enabling.
+	 */
+	static void set_latency_tracking(bool enabled) { _latency_tracking = enabled; }
+
+	/**
+	 * Get the latency histogram and optionally reset it
+	 * @param histogram output array of latency_buckets elements
+	 * @return false if no histogram is available
+	 */
+	bool latency_histogram(uint32_t *histogram, bool reset);
+
+	/**
+	 * Use a preallocated buffer for the topic data instead of allocating it on the
+	 * first write. The buffer is only used if the queue size does not exceed queue_size.
+	 */
+	void set_preallocated(uint8_t *data, unsigned queue_size)
+	{
+		_prealloc_data = data;
+		_prealloc_queue_size = queue_size;
+		_prealloc_unclaimed = true;
+	}
+
+	/**
+	 * Called when an advertiser takes over a node that was created at uORB start.
+	 * The node was created before the priority was known, so take the advertiser's.
+	 */
+	void claim_preallocated(int priority)
+	{
+		if (_prealloc_unclaimed) {
+			_priority = (uint8_t)priority;
+			_prealloc_unclaimed = false;
+		}
+	}
+
 	unsigned int get_queue_size() const { return _queue_size; }
 	int16_t subscriber_count() const { return _subscriber_count; }
 	uint32_t lost_message_count() const { return _lost_messages; }
@@ -190,14 +226,11 @@ protected:
 	virtual void poll_notify_one(px4_pollfd_struct_t *fds, pollevent_t events);
 
 private:
-	struct UpdateIntervalData {
+	struct UpdateIntervalData : public MemPoolAllocated {
 		unsigned  interval; /**< if nonzero minimum interval between updates */
 		struct hrt_call update_call;  /**< deferred wakeup call if update_period is nonzero */
-#ifndef __PX4_NUTTX
-		uint64_t last_update; /**< time at which the last update was provided, used when update_interval is nonzero */
-#endif
 	};
-	struct SubscriberData {
+	struct SubscriberData : public MemPoolAllocated {
 		~SubscriberData() { if (update_interval) { delete (update_interval); } }
 
 		unsigned  generation; /**< last generation the subscriber has seen */
@@ -215,13 +248,89 @@ private:
 	uint8_t     *_data;   /**< allocated object buffer */
 	hrt_abstime   _last_update; /**< time the object was last updated */
 	volatile unsigned   _generation;  /**< object generation count */
-	const uint8_t   _priority;  /**< priority of the topic */
+	volatile unsigned   _seq;  /**< seqlock sequence: odd while a write is in progress */
+	volatile unsigned   *_seq_ptr; /**< points to _seq, or into the shared memory segment */
+#ifdef ORB_USE_SHMEM
+	ShmemSegment *_shm; /**< shared memory segment holding the data, if enabled */
+	uint8_t _vehicle_instance; /**< vehicle namespace of the node, part of the segment name */
+#endif
+	uint8_t   _priority;  /**< priority of the topic */
 	bool _published;  /**< has ever data been published */
 	uint8_t _queue_size; /**< maximum number of elements in the queue */
 	int16_t _subscriber_count;
+	SubscriptionCallback *_callbacks; /**< list of registered work queue callbacks */
+	volatile int _direct_callbacks_running; /**< publications calling the direct callbacks outside of the lock */
+	UpdateNotifier *_notifiers; /**< list of registered update notifiers */
+	uint8_t *_prealloc_data; /**< data buffer reserved at uORB start, or nullptr */
+	uint8_t _prealloc_queue_size;
+	bool _prealloc_unclaimed; /**< node was created at uORB start and not advertised yet */
 
 	inline static SubscriberData    *filp_to_sd(device::file_t *filp);
 
+	static constexpr unsigned SEQ_READ_SPINS = 64; ///< polls of a write in progress before a read attempt is given up
+	static constexpr unsigned SEQ_READ_ATTEMPTS = 4; ///< lock-free read attempts before falling back to a locked copy
+
+	/**
+	 * Seqlock reader side. Readers copy the topic data without taking the lock and
+	 * retry if a write happened in the meantime. Writers are still serialized among
+	 * each other via ATOMIC_ENTER/ATOMIC_LEAVE.
+	 * The wait for a write in progress is bounded: the returned count is odd if it did not complete.
+	 * @return sequence count to pass to seq_read_retry()
+	 */
+	inline unsigned seq_read_begin() const
+	{
+		unsigned seq = *_seq_ptr;
+
+		for (unsigned i = 0; (seq & 1) && i < SEQ_READ_SPINS; ++i) {
+			/* a write is in progress, wait for it to complete */
+			seq = *_seq_ptr;
+		}
+
+		__sync_synchronize();
+		return seq;
+	}
+
+	/**
+	 * @return true if the data read since seq_read_begin() may be torn and must be read again
+	 */
+	inline bool seq_read_retry(unsigned seq) const
+	{
+		__sync_synchronize();
+		return (seq & 1) || seq != *_seq_ptr;
+	}
+
+	/**
+	 * Run a copy from the node (a callable without arguments) consistently with the writers.
+	 * The copy is attempted lock-free SEQ_READ_ATTEMPTS times, and then done once more with the writers
+	 * excluded, so that a reader cannot be starved by frequent writes.
+	 * @param locked the caller already holds ATOMIC_ENTER: the lock-free attempts only guard against
+	 *        writers that do not take it (external shared memory writers), and there is no fallback
+	 */
+	template<typename Copy>
+	void seq_read(Copy copy, bool locked)
+	{
+		for (unsigned attempt = 0; attempt < SEQ_READ_ATTEMPTS; ++attempt) {
+			const unsigned seq = seq_read_begin();
+			copy();
+
+			if (!seq_read_retry(seq)) {
+				return;
+			}
+		}
+
+		if (!locked) {
+			ATOMIC_ENTER;
+			copy();
+			ATOMIC_LEAVE;
+		}
+	}
+
+	/**
+	 * Commit a read() to the subscriber state.
+	 * Called under ATOMIC_ENTER for rate-limited subscribers.
+	 */
+	void      read_commit(SubscriberData *sd, unsigned generation, uint32_t lost_messages);
+
 #ifdef __PX4_NUTTX
 	pid_t     _publisher; /**< if nonzero, current publisher. Only used inside the advertise call.
 					We allow one publisher to have an open file descriptor at the same time. */
@@ -230,6 +339,14 @@ private:
 					We allow one publisher to have an open file descriptor at the same time. */
 #endif
 
+	static bool _latency_tracking;
+	uint32_t *_latency_histogram = nullptr; ///< allocated if _latency_tracking is enabled
+
+	/**
+	 * Add the latency of the current copy to the histogram
+	 */
+	void      update_latency_histogram();
+
 	//statistics
 	uint32_t _lost_messages = 0; ///< nr of lost messages for all subscribers. If two subscribers lose the same
 	///message, it is counted as two.
@@ -256,6 +373,56 @@ private:
 	 */
 	bool      appears_updated(SubscriberData *sd);
 
+#ifdef ORB_USE_SHMEM
+	/**
+	 * Allocate the data buffer in a shared memory segment.
+	 * Lock must already be held when calling this.
+	 */
+	void      shmem_allocate();
+
+	/**
+	 * Name of the shared memory object of this topic instance
+	 * @return true on success
+	 */
+	bool      shmem_name(char *name, size_t len);
+
+	/**
+	 * Pick up publications made by an external process to the shared memory segment.
+	 * Takes the lock if there is something to update, so that it does not race with write().
+	 */
+	void      shmem_sync();
+
+	/**
+	 * shmem_sync() with the lock already held.
+	 */
+	void      shmem_sync_locked();
+#endif
+
+	/**
+	 * Copy all pending queue elements for a subscriber (ORBIOCCOPYMULTI).
+	 * @return PX4_OK on success, a negative errno otherwise
+	 */
+	int       copy_multi(SubscriberData *sd, struct orb_copy_multi_s *copy_multi);
+
+	/**
+	 * Add/remove a work queue callback to be scheduled on every publication.
+	 * Removing waits until no publication is calling the direct callbacks anymore, so it must not be called
+	 * from within a direct callback of the same topic.
+	 */
+	int       register_callback(SubscriptionCallback *callback);
+	int       unregister_callback(SubscriptionCallback *callback);
+
+	/**
+	 * Add/remove an update notifier to be notified on every publication.
+	 */
+	int       register_notifier(UpdateNotifier *notifier);
+	int       unregister_notifier(UpdateNotifier *notifier);
+
+	/**
+	 * Get the buffer for the topic data: the preallocated one if it is large enough,
+	 * otherwise a new allocation.
+	 */
+	uint8_t *allocate_data();
 
 	// disable copy and assignment operators
 	DeviceNode(const DeviceNode &);
@@ -279,6 +446,13 @@ public:
 	 */
 	uORB::DeviceNode *getDeviceNode(const char *node_name);
 
+	/**
+	 * Find a node given its topic and instance, without having to generate the node path.
+	 * Takes care of synchronization.
+	 * @return node if exists, nullptr otherwise
+	 */
+	uORB::DeviceNode *getDeviceNode(const struct orb_metadata *meta, uint8_t instance);
+
 	/**
 	 * Print statistics for each existing topic.
 	 * @param reset if true, reset statistics afterwards
@@ -294,9 +468,20 @@ public:
 	 */
 	void showTop(char **topic_filter, int num_filters);
 
+	/**
+	 * Create the nodes of the given topics and reserve their data in a single allocation,
+	 * instead of allocating them on first advertise. Topics not in the list are still
+	 * allocated dynamically.
+	 * @param topics topics with instance count and queue size (from orb_get_prealloc_topics())
+	 * @param count number of elements in topics
+	 * @return PX4_OK on success, -ENOMEM if the arena could not be allocated
+	 */
+	int preallocate(const struct orb_prealloc_s *topics, size_t count);
+
 private:
 	// Private constructor, uORB::Manager takes care of its creation
-	DeviceMaster(Flavor f);
+	// @param devpath path of the master device, must stay valid for its lifetime
+	DeviceMaster(Flavor f, const char *devpath);
 	virtual ~DeviceMaster();
 
 	struct DeviceNodeStatisticsData {
@@ -322,10 +507,7 @@ private:
 
 	const Flavor _flavor;
 
-#ifdef __PX4_NUTTX
 	ORBMap _node_map;
-#else
-	std::map<std::string, uORB::DeviceNode *> _node_map;
-#endif
 	hrt_abstime       _last_statistics_output;
+	uint8_t *_prealloc_arena; /**< data of the preallocated topics */
 };
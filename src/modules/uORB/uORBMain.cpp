@@ -64,6 +64,14 @@ publications, which use `orb_advert_t` handles, so that they can be used from in
 
 Messages are defined in the `/msg` directory. They are converted into C/C++ code at build-time.
 
+Topics listed in the board config (`config_uorb_prealloc_topics`) are created on `uorb start`, with their data
+reserved in a single allocation. All other topics are allocated when they are first advertised or subscribed.
+
+On Linux, the topic data can be placed into shared memory segments with `uorb start -s`, so that external
+processes can publish and subscribe to topics directly (see uORBShmem.hpp). Each topic instance gets a segment
+named `/px4_orb_<topic><instance>` (`/px4_orb_v<vehicle>_<topic><instance>` for vehicle namespaces other than 0),
+and only a single publisher per topic instance is supported.
+
 If compiled with ORB_USE_PUBLISHER_RULES, a file with uORB publication rules can be used to configure which
 modules are allowed to publish which topics. This is used for system-wide replay.
 
@@ -74,9 +82,13 @@ $ uorb top
 
 	PRINT_MODULE_USAGE_NAME("uorb", "communication");
 	PRINT_MODULE_USAGE_COMMAND("start");
+#ifdef ORB_USE_SHMEM
+	PRINT_MODULE_USAGE_PARAM_FLAG('s', "place topic data into shared memory for external processes", true);
+#endif
 	PRINT_MODULE_USAGE_COMMAND_DESCR("status", "Print topic statistics");
 	PRINT_MODULE_USAGE_COMMAND_DESCR("top", "Monitor topic publication rates");
 	PRINT_MODULE_USAGE_PARAM_FLAG('a', "print all instead of only currently publishing topics", true);
+	PRINT_MODULE_USAGE_PARAM_FLAG('l', "print a histogram of the publish to copy latency", true);
 	PRINT_MODULE_USAGE_ARG("<filter1> [<filter2>]", "topic(s) to match (implies -a)", true);
 }
 
@@ -104,6 +116,14 @@ uorb_main(int argc, char *argv[])
 			return -ENOMEM;
 		}
 
+#ifdef ORB_USE_SHMEM
+
+		if (argc > 2 && !strcmp(argv[2], "-s")) {
+			uORB::Manager::get_instance()->set_shmem_enabled(true);
+		}
+
+#endif
+
 		/* create the driver */
 		g_dev = uORB::Manager::get_instance()->get_device_master(uORB::PUBSUB);
 
@@ -111,6 +131,11 @@ uorb_main(int argc, char *argv[])
 			return -errno;
 		}
 
+		/* create the topics listed in the board config upfront, in one allocation */
+		if (g_dev->preallocate(orb_get_prealloc_topics(), orb_prealloc_count()) != PX4_OK) {
+			PX4_WARN("topic preallocation failed");
+		}
+
 #if !defined(__PX4_QURT) && !defined(__PX4_POSIX_EAGLE) && !defined(__PX4_POSIX_EXCELSIOR)
 		/* FIXME: this fails on Snapdragon (see https://github.com/PX4/Firmware/issues/5406),
 		 * so we disable logging messages to the ulog for now. This needs further investigations.
@@ -125,8 +150,11 @@ uorb_main(int argc, char *argv[])
 	 * Print driver information.
 	 */
 	if (!strcmp(argv[1], "status")) {
-		if (g_dev != nullptr) {
-			g_dev->printStatistics(true);
+		/* the topics of the vehicle instance of the caller */
+		uORB::DeviceMaster *dev = (g_dev != nullptr) ? uORB::Manager::get_instance()->get_device_master(uORB::PUBSUB) : nullptr;
+
+		if (dev != nullptr) {
+			dev->printStatistics(true);
 
 		} else {
 			PX4_INFO("uorb is not running");
@@ -136,8 +164,11 @@ uorb_main(int argc, char *argv[])
 	}
 
 	if (!strcmp(argv[1], "top")) {
-		if (g_dev != nullptr) {
-			g_dev->showTop(argv + 2, argc - 2);
+		/* the topics of the vehicle instance of the caller */
+		uORB::DeviceMaster *dev = (g_dev != nullptr) ? uORB::Manager::get_instance()->get_device_master(uORB::PUBSUB) : nullptr;
+
+		if (dev != nullptr) {
+			dev->showTop(argv + 2, argc - 2);
 
 		} else {
 			PX4_INFO("uorb is not running");
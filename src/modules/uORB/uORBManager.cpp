@@ -64,10 +64,16 @@ bool uORB::Manager::initialize()
 uORB::Manager::Manager()
 	: _comm_channel(nullptr)
 {
-	for (int i = 0; i < Flavor_count; ++i) {
-		_device_masters[i] = nullptr;
+	for (int v = 0; v < MAX_VEHICLE_INSTANCES; ++v) {
+		for (int i = 0; i < Flavor_count; ++i) {
+			_device_masters[v][i] = nullptr;
+		}
 	}
 
+#ifdef PX4_MAX_VEHICLE_INSTANCES
+	pthread_mutex_init(&_device_masters_mutex, nullptr);
+#endif
+
 #ifdef ORB_USE_PUBLISHER_RULES
 	const char *file_name = "./rootfs/orb_publisher.rules";
 	int ret = readPublisherRulesFromFile(file_name, _publisher_rule);
@@ -86,26 +92,52 @@ uORB::Manager::Manager()
 
 uORB::Manager::~Manager()
 {
-	for (int i = 0; i < Flavor_count; ++i) {
-		if (_device_masters[i]) {
-			delete _device_masters[i];
+	for (int v = 0; v < MAX_VEHICLE_INSTANCES; ++v) {
+		for (int i = 0; i < Flavor_count; ++i) {
+			if (_device_masters[v][i]) {
+				delete _device_masters[v][i];
+			}
 		}
 	}
+
+#ifdef PX4_MAX_VEHICLE_INSTANCES
+	pthread_mutex_destroy(&_device_masters_mutex);
+#endif
 }
 
 uORB::DeviceMaster *uORB::Manager::get_device_master(Flavor flavor)
 {
-	if (!_device_masters[flavor]) {
-		_device_masters[flavor] = new DeviceMaster(flavor);
+	const int vehicle = uORB::Utils::vehicle_instance();
+	DeviceMaster *&device_master = _device_masters[vehicle][flavor];
+
+	if (device_master) {
+		return device_master;
+	}
+
+#ifdef PX4_MAX_VEHICLE_INSTANCES
+	pthread_mutex_lock(&_device_masters_mutex);
+#endif
+
+	if (!device_master) {
+		char path[orb_maxpath];
+		int ret = uORB::Utils::master_mkpath(path, flavor, vehicle);
 
-		if (_device_masters[flavor]) {
-			int ret = _device_masters[flavor]->init();
+		/* the device keeps a reference to its path, and the masters are never deleted at runtime */
+		const char *devpath = (ret == PX4_OK) ? strdup(path) : nullptr;
+
+		DeviceMaster *new_master = devpath ? new DeviceMaster(flavor, devpath) : nullptr;
+
+		if (new_master) {
+			ret = new_master->init();
 
 			if (ret != PX4_OK) {
 				PX4_ERR("Initialization of DeviceMaster failed (%i)", ret);
 				errno = -ret;
-				delete _device_masters[flavor];
-				_device_masters[flavor] = nullptr;
+				delete new_master;
+
+			} else {
+				/* only publish it once initialized, it is read without holding the lock */
+				device_master = new_master;
 			}
 
 		} else {
@@ -114,11 +146,34 @@ uORB::DeviceMaster *uORB::Manager::get_device_master(Flavor flavor)
 		}
 	}
 
-	return _device_masters[flavor];
+#ifdef PX4_MAX_VEHICLE_INSTANCES
+	pthread_mutex_unlock(&_device_masters_mutex);
+#endif
+
+	return device_master;
 }
 
 int uORB::Manager::orb_exists(const struct orb_metadata *meta, int instance)
 {
+	if (meta == nullptr || instance < 0 || instance >= ORB_MULTI_MAX_INSTANCES) {
+		errno = EINVAL;
+		return ERROR;
+	}
+
+	/*
+	 * Fast path: look the node up directly in the device master, which avoids
+	 * generating the node path and going through the file system.
+	 */
+	DeviceMaster *device_master = _device_masters[uORB::Utils::vehicle_instance()][PUBSUB];
+
+	if (device_master != nullptr) {
+		uORB::DeviceNode *node = device_master->getDeviceNode(meta, instance);
+
+		if (node != nullptr) {
+			return node->is_published() ? OK : ERROR;
+		}
+	}
+
 	/*
 	 * Generate the path to the node and try to open it.
 	 */
@@ -295,6 +350,27 @@ int uORB::Manager::orb_copy(const struct orb_metadata *meta, int handle, void *b
 	return PX4_OK;
 }
 
+int uORB::Manager::orb_copy_multi(const struct orb_metadata *meta, int handle, void *buffer, unsigned max_items,
+				  unsigned *count, unsigned *lost)
+{
+	if (meta == nullptr || buffer == nullptr || count == nullptr) {
+		errno = EINVAL;
+		return ERROR;
+	}
+
+	struct orb_copy_multi_s copy_multi = { buffer, max_items, 0, 0 };
+
+	int ret = px4_ioctl(handle, ORBIOCCOPYMULTI, (unsigned long)(uintptr_t)&copy_multi);
+
+	*count = copy_multi.count;
+
+	if (lost) {
+		*lost = copy_multi.lost;
+	}
+
+	return ret;
+}
+
 int uORB::Manager::orb_check(int handle, bool *updated)
 {
 	/* Set to false here so that if `px4_ioctl` fails to false. */
@@ -339,8 +415,15 @@ int uORB::Manager::node_advertise
 	/* fill advertiser data */
 	const struct orb_advertdata adv = { meta, instance, priority };
 
-	/* open the control device */
-	fd = px4_open(TOPIC_MASTER_DEVICE_PATH, 0);
+	/* open the control device of the vehicle instance, creating it on first use */
+	char master_path[orb_maxpath];
+
+	if (get_device_master(PUBSUB) == nullptr ||
+	    uORB::Utils::master_mkpath(master_path, PUBSUB, uORB::Utils::vehicle_instance()) != PX4_OK) {
+		goto out;
+	}
+
+	fd = px4_open(master_path, 0);
 
 	if (fd < 0) {
 		goto out;
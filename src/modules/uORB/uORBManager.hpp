@@ -36,6 +36,7 @@
 
 #include "uORBCommon.hpp"
 #include "uORBDevices.hpp"
+#include "uORBUtils.hpp"
 #include <stdint.h>
 #ifdef __PX4_NUTTX
 #include "ORBSet.hpp"
@@ -86,6 +87,16 @@ public:
 	 */
 	uORB::DeviceMaster *get_device_master(Flavor flavor);
 
+#ifdef ORB_USE_SHMEM
+	/**
+	 * Enable placing the topic data into shared memory segments, so that external
+	 * processes can access them (see uORBShmem.hpp). Applies to topics that are
+	 * published for the first time after the call.
+	 */
+	void set_shmem_enabled(bool enabled) { _shmem_enabled = enabled; }
+	bool shmem_enabled() const { return _shmem_enabled; }
+#endif
+
 	// ==== uORB interface methods ====
 	/**
 	 * Advertise as the publisher of a topic.
@@ -266,6 +277,28 @@ public:
 	 */
 	int  orb_copy(const struct orb_metadata *meta, int handle, void *buffer);
 
+	/**
+	 * Fetch all pending elements from a queued topic in one operation.
+	 *
+	 * Copies the elements published since the last copy, oldest first, and
+	 * marks them as read. If more than max_items are pending, the oldest
+	 * max_items are copied and the rest remains pending. Unlike orb_copy(),
+	 * nothing is copied if there is no new data.
+	 *
+	 * @param meta    The uORB metadata (usually from the ORB_ID() macro)
+	 *      for the topic.
+	 * @param handle  A handle returned from orb_subscribe.
+	 * @param buffer  Pointer to the buffer receiving the data, must hold
+	 *      max_items elements of the topic.
+	 * @param max_items Maximum number of elements to copy.
+	 * @param count   Returns the number of elements copied.
+	 * @param lost    Returns the number of elements lost due to queue overflow
+	 *      since the last copy. Can be NULL.
+	 * @return    OK on success, ERROR otherwise with errno set accordingly.
+	 */
+	int  orb_copy_multi(const struct orb_metadata *meta, int handle, void *buffer, unsigned max_items,
+			    unsigned *count, unsigned *lost);
+
 	/**
 	 * Check whether a topic has been published to since the last orb_copy.
 	 *
@@ -411,7 +444,19 @@ private: // data members
 	ORBSet _remote_subscriber_topics;
 	ORBSet _remote_topics;
 
-	DeviceMaster *_device_masters[Flavor_count]; ///< Allow at most one DeviceMaster per Flavor
+#ifdef PX4_MAX_VEHICLE_INSTANCES
+	static constexpr int MAX_VEHICLE_INSTANCES = PX4_MAX_VEHICLE_INSTANCES;
+	pthread_mutex_t _device_masters_mutex; ///< namespaces are created on first use, from any thread
+#else
+	static constexpr int MAX_VEHICLE_INSTANCES = 1;
+#endif
+
+	/// Allow at most one DeviceMaster per Flavor and vehicle instance (uORB namespace)
+	DeviceMaster *_device_masters[MAX_VEHICLE_INSTANCES][Flavor_count];
+
+#ifdef ORB_USE_SHMEM
+	bool _shmem_enabled = false;
+#endif
 
 private: //class methods
 	Manager();
@@ -0,0 +1,301 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2017 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file uORBShmem.hpp
+ *
+ * Shared memory segment holding the data queue of a uORB topic instance, so that
+ * processes outside of PX4 can subscribe and publish to it without copying through
+ * a serialization layer.
+ *
+ * The segment consists of a header followed by queue_size elements of o_size bytes.
+ * Access is synchronized with a seqlock: a writer increments seq before and after
+ * writing (seq is odd while a write is in progress), readers copy and retry if seq
+ * changed. Only a single writer per topic instance is supported.
+ *
+ * This header is self-contained so that it can be used by external processes.
+ */
+
+#pragma once
+
+#if defined(__PX4_POSIX) && !defined(__PX4_QURT)
+#define ORB_USE_SHMEM
+#endif
+
+#ifdef ORB_USE_SHMEM
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace uORB
+{
+
+struct ShmemHeader {
+	uint32_t magic;
+	uint32_t o_size; ///< size of a single element
+	uint32_t queue_size; ///< number of elements
+	volatile unsigned seq; ///< seqlock sequence: odd while a write is in progress
+	volatile uint32_t generation; ///< number of published elements
+	uint32_t reserved;
+	volatile uint64_t timestamp; ///< time of the last publication
+};
+
+class ShmemSegment
+{
+public:
+	static constexpr uint32_t MAGIC = 0x4f52421a; ///< 'ORB' + version
+	static constexpr unsigned COPY_SPINS = 1000; ///< polls of a write in progress before copy() gives up
+	static constexpr unsigned COPY_ATTEMPTS = 4; ///< torn copies before copy() gives up
+
+	ShmemSegment() = default;
+	~ShmemSegment() { close(); }
+
+	// no copy, assignment, move, move assignment
+	ShmemSegment(const ShmemSegment &) = delete;
+	ShmemSegment &operator=(const ShmemSegment &) = delete;
+
+	/**
+	 * Generate the name of the shared memory object for a topic instance
+	 * ("/px4_orb_<topic><instance>", or "/px4_orb_v<vehicle>_<topic><instance>" for a vehicle
+	 * namespace other than 0, like the node paths).
+	 * @param buf output buffer
+	 * @param len length of buf
+	 * @param vehicle_instance uORB vehicle namespace of the topic
+	 * @param topic_name uORB topic name (o_name)
+	 * @param instance topic instance
+	 * @return true on success
+	 */
+	static bool get_name(char *buf, size_t len, unsigned vehicle_instance, const char *topic_name, unsigned instance)
+	{
+		int ret;
+
+		if (vehicle_instance == 0) {
+			ret = snprintf(buf, len, "/px4_orb_%s%u", topic_name, instance);
+
+		} else {
+			ret = snprintf(buf, len, "/px4_orb_v%u_%s%u", vehicle_instance, topic_name, instance);
+		}
+
+		return ret > 0 && (size_t)ret < len;
+	}
+
+	/**
+	 * Create (or reset) the segment. Used by the uORB DeviceNode owning the topic.
+	 * @return true on success
+	 */
+	bool create(const char *name, uint32_t o_size, uint32_t queue_size)
+	{
+		int fd = shm_open(name, O_RDWR | O_CREAT, 0666);
+
+		if (fd < 0) {
+			return false;
+		}
+
+		_size = data_offset() + (size_t)o_size * queue_size;
+
+		if (ftruncate(fd, _size) != 0 || !map(fd)) {
+			::close(fd);
+			return false;
+		}
+
+		::close(fd);
+
+		ShmemHeader *hdr = header();
+		hdr->seq = 0;
+		hdr->generation = 0;
+		hdr->timestamp = 0;
+		hdr->o_size = o_size;
+		hdr->queue_size = queue_size;
+		__sync_synchronize();
+		hdr->magic = MAGIC;
+		return true;
+	}
+
+	/**
+	 * Attach to an existing segment. Used by external processes.
+	 * @param o_size expected element size (sizeof the topic struct)
+	 * @return true on success
+	 */
+	bool open(const char *name, uint32_t o_size)
+	{
+		int fd = shm_open(name, O_RDWR, 0);
+
+		if (fd < 0) {
+			return false;
+		}
+
+		struct stat st;
+
+		if (fstat(fd, &st) != 0 || (size_t)st.st_size < data_offset()) {
+			::close(fd);
+			return false;
+		}
+
+		_size = st.st_size;
+
+		if (!map(fd)) {
+			::close(fd);
+			return false;
+		}
+
+		::close(fd);
+
+		if (header()->magic != MAGIC || header()->o_size != o_size ||
+		    data_offset() + (size_t)o_size * header()->queue_size > _size) {
+			close();
+			return false;
+		}
+
+		return true;
+	}
+
+	void close()
+	{
+		if (_base) {
+			munmap(_base, _size);
+			_base = nullptr;
+		}
+	}
+
+	/**
+	 * Remove the shared memory object. Used by the owner when the topic instance goes away, attached
+	 * processes keep their mapping until they close it.
+	 */
+	static void remove(const char *name)
+	{
+		shm_unlink(name);
+	}
+
+	bool valid() const { return _base != nullptr; }
+
+	ShmemHeader *header() const { return (ShmemHeader *)_base; }
+	uint8_t *data() const { return (uint8_t *)_base + data_offset(); }
+
+	/**
+	 * Publish an element (external writer side)
+	 * @param timestamp publication time to store in the header
+	 */
+	void publish(const void *buffer, uint64_t timestamp)
+	{
+		ShmemHeader *hdr = header();
+		hdr->seq++;
+		__sync_synchronize();
+		memcpy(data() + (size_t)hdr->o_size * (hdr->generation % hdr->queue_size), buffer, hdr->o_size);
+		hdr->timestamp = timestamp;
+		hdr->generation++;
+		__sync_synchronize();
+		hdr->seq++;
+	}
+
+	/**
+	 * Copy the next element (external reader side)
+	 * @param generation last generation seen by the reader, will be updated
+	 * @param buffer o_size bytes
+	 * @return true if a new element was copied, false if there is no new data or no consistent
+	 *         copy could be made (the writer is busy, try again later)
+	 */
+	bool copy(uint32_t &generation, void *buffer) const
+	{
+		const ShmemHeader *hdr = header();
+		uint32_t seq;
+		uint32_t next;
+		unsigned attempts = 0;
+
+		do {
+			if (attempts++ == COPY_ATTEMPTS) {
+				return false;
+			}
+
+			seq = hdr->seq;
+
+			for (unsigned i = 0; (seq & 1) && i < COPY_SPINS; ++i) {
+				/* write in progress */
+				seq = hdr->seq;
+			}
+
+			if (seq & 1) {
+				return false;
+			}
+
+			__sync_synchronize();
+
+			const uint32_t node_generation = hdr->generation;
+
+			if (node_generation == generation || node_generation == 0) {
+				return false;
+			}
+
+			next = generation;
+
+			if (node_generation - next > hdr->queue_size) {
+				/* reader is too far behind (or ahead, after the segment was reset), skip to the oldest element */
+				next = node_generation > hdr->queue_size ? node_generation - hdr->queue_size : 0;
+			}
+
+			memcpy(buffer, data() + (size_t)hdr->o_size * (next % hdr->queue_size), hdr->o_size);
+			__sync_synchronize();
+
+		} while (seq != hdr->seq);
+
+		generation = next + 1;
+		return true;
+	}
+
+private:
+	static size_t data_offset() { return (sizeof(ShmemHeader) + 7) & ~(size_t)7; }
+
+	bool map(int fd)
+	{
+		void *base = mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+		if (base == MAP_FAILED) {
+			return false;
+		}
+
+		_base = base;
+		return true;
+	}
+
+	void *_base{nullptr};
+	size_t _size{0};
+};
+
+} // namespace uORB
+
+#endif /* ORB_USE_SHMEM */
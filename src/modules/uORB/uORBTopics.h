@@ -47,4 +47,23 @@ extern size_t orb_topics_count() __EXPORT;
  */
 extern const struct orb_metadata **orb_get_topics() __EXPORT;
 
+/*
+ * Topic to preallocate at uORB start (from the board config)
+ */
+struct orb_prealloc_s {
+	const struct orb_metadata *meta;
+	unsigned instances;   /**< number of instances to preallocate */
+	unsigned queue_size;  /**< queue size to reserve data space for */
+};
+
+/*
+ * Returns count of the topics to preallocate.
+ */
+extern size_t orb_prealloc_count() __EXPORT;
+
+/*
+ * Returns array of the topics to preallocate (nullptr if there are none)
+ */
+extern const struct orb_prealloc_s *orb_get_prealloc_topics() __EXPORT;
+
 #endif /* MODULES_UORB_UORBTOPICS_H_ */
@@ -34,6 +34,34 @@
 #include "uORBUtils.hpp"
 #include <stdio.h>
 #include <errno.h>
+#include <drivers/drv_orb_dev.h>
+
+/**
+ * Generate the path of a node in the namespace of the calling thread's vehicle instance:
+ * /obj/<name><index> for vehicle instance 0, /obj/v<vehicle>/<name><index> otherwise.
+ */
+static int node_mkpath_namespaced(char *buf, uORB::Flavor f, const char *name, unsigned index)
+{
+	const int vehicle = uORB::Utils::vehicle_instance();
+	unsigned len;
+
+	if (vehicle == 0) {
+		len = snprintf(buf, uORB::orb_maxpath, "/%s/%s%d",
+			       (f == uORB::PUBSUB) ? "obj" : "param",
+			       name, index);
+
+	} else {
+		len = snprintf(buf, uORB::orb_maxpath, "/%s/v%d/%s%d",
+			       (f == uORB::PUBSUB) ? "obj" : "param",
+			       vehicle, name, index);
+	}
+
+	if (len >= uORB::orb_maxpath) {
+		return -ENAMETOOLONG;
+	}
+
+	return OK;
+}
 
 int uORB::Utils::node_mkpath
 (
@@ -43,36 +71,36 @@ int uORB::Utils::node_mkpath
 	int *instance
 )
 {
-	unsigned len;
-
 	unsigned index = 0;
 
 	if (instance != nullptr) {
 		index = *instance;
 	}
 
-	len = snprintf(buf, orb_maxpath, "/%s/%s%d",
-		       (f == PUBSUB) ? "obj" : "param",
-		       meta->o_name, index);
-
-	if (len >= orb_maxpath) {
-		return -ENAMETOOLONG;
-	}
-
-	return OK;
+	return node_mkpath_namespaced(buf, f, meta->o_name, index);
 }
 
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
 int uORB::Utils::node_mkpath(char *buf, Flavor f,
 			     const char *orbMsgName)
+{
+	return node_mkpath_namespaced(buf, f, orbMsgName, 0);
+}
+
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+int uORB::Utils::master_mkpath(char *buf, Flavor f, int vehicle_instance)
 {
 	unsigned len;
 
-	unsigned index = 0;
+	if (vehicle_instance == 0) {
+		len = snprintf(buf, orb_maxpath, "%s", (f == PUBSUB) ? TOPIC_MASTER_DEVICE_PATH : PARAM_MASTER_DEVICE_PATH);
 
-	len = snprintf(buf, orb_maxpath, "/%s/%s%d", (f == PUBSUB) ? "obj" : "param",
-		       orbMsgName, index);
+	} else {
+		len = snprintf(buf, orb_maxpath, "/%s/v%d/%s", (f == PUBSUB) ? "obj" : "param", vehicle_instance,
+			       (f == PUBSUB) ? "_obj_" : "_param_");
+	}
 
 	if (len >= orb_maxpath) {
 		return -ENAMETOOLONG;
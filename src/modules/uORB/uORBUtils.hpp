@@ -34,6 +34,7 @@
 #define _uORBUtils_hpp_
 
 #include "uORBCommon.hpp"
+#include <px4_tasks.h>
 
 namespace uORB
 {
@@ -56,6 +57,24 @@ public:
 	 */
 	static int node_mkpath(char *buf, Flavor f, const char *orbMsgName);
 
+	/**
+	 * Generate the path of the DeviceMaster of a vehicle instance.
+	 */
+	static int master_mkpath(char *buf, Flavor f, int vehicle_instance);
+
+	/**
+	 * Vehicle instance of the calling thread, which selects the uORB namespace
+	 * (see px4_set_vehicle_instance()). Always 0 on platforms without support.
+	 */
+	static int vehicle_instance()
+	{
+#ifdef PX4_MAX_VEHICLE_INSTANCES
+		return px4_get_vehicle_instance();
+#else
+		return 0;
+#endif
+	}
+
 };
 
 #endif // _uORBUtils_hpp_
@@ -0,0 +1,449 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2017 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file uORBBench.cpp
+ */
+
+#include "uORBBench.hpp"
+#include <px4_config.h>
+#include <px4_defines.h>
+#include <px4_posix.h>
+#include <drivers/drv_hrt.h>
+#include <version/version.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+ORB_DEFINE(orb_bench_small, struct orb_bench_small, sizeof(orb_bench_small),
+	   "ORB_BENCH_SMALL:uint64_t timestamp;uint8_t[8] data;");
+ORB_DEFINE(orb_bench_medium, struct orb_bench_medium, sizeof(orb_bench_medium),
+	   "ORB_BENCH_MEDIUM:uint64_t timestamp;uint8_t[120] data;");
+ORB_DEFINE(orb_bench_queue, struct orb_bench_medium, sizeof(orb_bench_medium),
+	   "ORB_BENCH_QUEUE:uint64_t timestamp;uint8_t[120] data;");
+ORB_DEFINE(orb_bench_large, struct orb_bench_large, sizeof(orb_bench_large),
+	   "ORB_BENCH_LARGE:uint64_t timestamp;uint8_t[1016] data;");
+
+uORBTest::Bench &uORBTest::Bench::instance()
+{
+	static uORBTest::Bench b;
+	return b;
+}
+
+static int compare_samples(const void *a, const void *b)
+{
+	const uint32_t sa = *(const uint32_t *)a;
+	const uint32_t sb = *(const uint32_t *)b;
+	return (sa > sb) - (sa < sb);
+}
+
+void uORBTest::Bench::report(const char *name, unsigned size, uint32_t *samples, unsigned count)
+{
+	if (count == 0) {
+		PX4_WARN("%s: no samples", name);
+		return;
+	}
+
+	qsort(samples, count, sizeof(samples[0]), compare_samples);
+
+	uint64_t sum = 0;
+
+	for (unsigned i = 0; i < count; ++i) {
+		sum += samples[i];
+	}
+
+	const uint32_t p50 = samples[(count - 1) * 50 / 100];
+	const uint32_t p90 = samples[(count - 1) * 90 / 100];
+	const uint32_t p99 = samples[(count - 1) * 99 / 100];
+	const uint32_t max = samples[count - 1];
+	const double mean = (double)sum / count;
+
+	PX4_INFO("%-18s %5u %7u %7u %7u %7u %9.2f", name, size, p50, p90, p99, max, mean);
+
+	if (_file) {
+		fprintf(_file, "%s,%u,%u,%u,%u,%u,%u,%.2f\n", name, size, count, p50, p90, p99, max, mean);
+	}
+}
+
+template<typename S>
+int uORBTest::Bench::bench_publish(orb_id_t T)
+{
+	S s{};
+	orb_advert_t pub = orb_advertise(T, &s);
+
+	if (pub == nullptr) {
+		PX4_ERR("orb_advertise failed (%i)", errno);
+		return PX4_ERROR;
+	}
+
+	for (unsigned i = 0; i < _iterations; ++i) {
+		const hrt_abstime t0 = hrt_absolute_time();
+		s.timestamp = t0;
+		orb_publish(T, pub, &s);
+		_samples[i] = hrt_elapsed_time(&t0);
+	}
+
+	orb_unadvertise(pub);
+	report("publish", sizeof(S), _samples, _iterations);
+	return PX4_OK;
+}
+
+template<typename S>
+int uORBTest::Bench::bench_copy(orb_id_t T)
+{
+	S s{};
+	orb_advert_t pub = orb_advertise(T, &s);
+
+	if (pub == nullptr) {
+		PX4_ERR("orb_advertise failed (%i)", errno);
+		return PX4_ERROR;
+	}
+
+	int sub = orb_subscribe(T);
+
+	if (sub < 0) {
+		PX4_ERR("orb_subscribe failed (%i)", errno);
+		orb_unadvertise(pub);
+		return PX4_ERROR;
+	}
+
+	for (unsigned i = 0; i < _iterations; ++i) {
+		s.timestamp = hrt_absolute_time();
+		orb_publish(T, pub, &s);
+
+		const hrt_abstime t0 = hrt_absolute_time();
+		orb_copy(T, sub, &s);
+		_samples[i] = hrt_elapsed_time(&t0);
+	}
+
+	orb_unsubscribe(sub);
+	orb_unadvertise(pub);
+	report("copy", sizeof(S), _samples, _iterations);
+	return PX4_OK;
+}
+
+template<typename S>
+int uORBTest::Bench::bench_poll_latency(orb_id_t T)
+{
+	S s{};
+	orb_advert_t pub = orb_advertise(T, &s);
+
+	if (pub == nullptr) {
+		PX4_ERR("orb_advertise failed (%i)", errno);
+		return PX4_ERROR;
+	}
+
+	if (start_subscribers(T, 1) != PX4_OK) {
+		orb_unadvertise(pub);
+		return PX4_ERROR;
+	}
+
+	for (unsigned i = 0; i < _iterations; ++i) {
+		s.timestamp = hrt_absolute_time();
+		orb_publish(T, pub, &s);
+
+		/* give the subscriber time to wake up and go back to sleep */
+		usleep(1000);
+	}
+
+	stop_subscribers();
+	orb_unadvertise(pub);
+	report("poll_latency", sizeof(S), _latency_samples, _latency_count);
+	return PX4_OK;
+}
+
+int uORBTest::Bench::bench_fanout(unsigned num_subscribers)
+{
+	struct orb_bench_small s {};
+	orb_advert_t pub = orb_advertise(ORB_ID(orb_bench_small), &s);
+
+	if (pub == nullptr) {
+		PX4_ERR("orb_advertise failed (%i)", errno);
+		return PX4_ERROR;
+	}
+
+	if (start_subscribers(ORB_ID(orb_bench_small), num_subscribers) != PX4_OK) {
+		orb_unadvertise(pub);
+		return PX4_ERROR;
+	}
+
+	for (unsigned i = 0; i < _iterations; ++i) {
+		const hrt_abstime t0 = hrt_absolute_time();
+		s.timestamp = t0;
+		orb_publish(ORB_ID(orb_bench_small), pub, &s);
+		_samples[i] = hrt_elapsed_time(&t0);
+
+		usleep(1000);
+	}
+
+	stop_subscribers();
+	orb_unadvertise(pub);
+
+	char name[24];
+	snprintf(name, sizeof(name), "fanout%u_publish", num_subscribers);
+	report(name, sizeof(s), _samples, _iterations);
+	snprintf(name, sizeof(name), "fanout%u_latency", num_subscribers);
+	report(name, sizeof(s), _latency_samples, _latency_count);
+	return PX4_OK;
+}
+
+int uORBTest::Bench::bench_queue_throughput()
+{
+	struct orb_bench_medium s {};
+
+	orb_advert_t pub = orb_advertise_queue(ORB_ID(orb_bench_queue), &s, queue_size);
+
+	if (pub == nullptr) {
+		PX4_ERR("orb_advertise_queue failed (%i)", errno);
+		return PX4_ERROR;
+	}
+
+	int sub = orb_subscribe(ORB_ID(orb_bench_queue));
+
+	if (sub < 0) {
+		PX4_ERR("orb_subscribe failed (%i)", errno);
+		orb_unadvertise(pub);
+		return PX4_ERROR;
+	}
+
+	struct orb_bench_medium *buffer = new struct orb_bench_medium[queue_size];
+
+	if (buffer == nullptr) {
+		orb_unsubscribe(sub);
+		orb_unadvertise(pub);
+		return -ENOMEM;
+	}
+
+	/* drain the initial message */
+	orb_copy(ORB_ID(orb_bench_queue), sub, &s);
+
+	unsigned total_messages = 0;
+	unsigned total_lost = 0;
+	const hrt_abstime start = hrt_absolute_time();
+
+	/* each sample is a full queue: queue_size publications drained with one orb_copy_multi() */
+	for (unsigned i = 0; i < _iterations; ++i) {
+		const hrt_abstime t0 = hrt_absolute_time();
+
+		for (unsigned j = 0; j < queue_size; ++j) {
+			s.timestamp = hrt_absolute_time();
+			orb_publish(ORB_ID(orb_bench_queue), pub, &s);
+		}
+
+		unsigned count = 0;
+		unsigned lost = 0;
+		orb_copy_multi(ORB_ID(orb_bench_queue), sub, buffer, queue_size, &count, &lost);
+		_samples[i] = hrt_elapsed_time(&t0);
+
+		total_messages += count;
+		total_lost += lost;
+	}
+
+	const hrt_abstime elapsed = hrt_elapsed_time(&start);
+
+	delete[] buffer;
+	orb_unsubscribe(sub);
+	orb_unadvertise(pub);
+
+	report("queue_batch", sizeof(s), _samples, _iterations);
+
+	const double throughput = elapsed > 0 ? total_messages * 1e6 / elapsed : 0.0;
+	PX4_INFO("queue throughput: %.0f msg/s (%u messages, %u lost)", throughput, total_messages, total_lost);
+
+	if (_file) {
+		fprintf(_file, "queue_throughput,%u,%u,%.0f\n", (unsigned)sizeof(s), total_messages, throughput);
+	}
+
+	return total_lost == 0 ? PX4_OK : PX4_ERROR;
+}
+
+int uORBTest::Bench::start_subscribers(orb_id_t T, unsigned num_subscribers)
+{
+	_subscriber_topic = T;
+	_subscribers_should_exit = false;
+	_subscribers_running = 0;
+	_latency_count = 0;
+
+	for (unsigned i = 0; i < num_subscribers; ++i) {
+		char *const args[1] = { nullptr };
+
+		/* the stack holds a copy of the largest benchmark topic (1 KB) */
+		if (px4_task_spawn_cmd("uorb_bench_sub",
+				       SCHED_DEFAULT,
+				       SCHED_PRIORITY_MAX - 5,
+				       2600,
+				       (px4_main_t)&uORBTest::Bench::subscriber_entry,
+				       args) < 0) {
+			PX4_ERR("failed launching task");
+			stop_subscribers();
+			return PX4_ERROR;
+		}
+	}
+
+	/* wait for all subscribers to be ready (up to 1s) */
+	for (int i = 0; i < 100 && _subscribers_running < num_subscribers; ++i) {
+		usleep(10000);
+	}
+
+	if (_subscribers_running < num_subscribers) {
+		PX4_ERR("subscribers did not start");
+		stop_subscribers();
+		return PX4_ERROR;
+	}
+
+	return PX4_OK;
+}
+
+void uORBTest::Bench::stop_subscribers()
+{
+	_subscribers_should_exit = true;
+
+	/* the subscribers poll with a timeout, so they will notice */
+	while (_subscribers_running > 0) {
+		usleep(10000);
+	}
+
+	if (_latency_count > _latency_samples_size) {
+		_latency_count = _latency_samples_size;
+	}
+}
+
+int uORBTest::Bench::subscriber_entry(char *const argv[])
+{
+	return uORBTest::Bench::instance().subscriber_main();
+}
+
+int uORBTest::Bench::subscriber_main()
+{
+	/* large enough for all benchmark topics */
+	struct orb_bench_large s;
+
+	int sub = orb_subscribe(_subscriber_topic);
+
+	if (sub < 0) {
+		return PX4_ERROR;
+	}
+
+	orb_copy(_subscriber_topic, sub, &s);
+
+	px4_pollfd_struct_t fds[1];
+	fds[0].fd = sub;
+	fds[0].events = POLLIN;
+
+	__sync_fetch_and_add(&_subscribers_running, 1);
+
+	while (!_subscribers_should_exit) {
+		int pret = px4_poll(fds, 1, 100);
+
+		if (pret > 0 && (fds[0].revents & POLLIN)) {
+			orb_copy(_subscriber_topic, sub, &s);
+			const uint32_t latency = hrt_elapsed_time(&s.timestamp);
+			const unsigned index = __sync_fetch_and_add(&_latency_count, 1);
+
+			if (index < _latency_samples_size) {
+				_latency_samples[index] = latency;
+
+			} else {
+				_latency_count = _latency_samples_size;
+			}
+		}
+	}
+
+	orb_unsubscribe(sub);
+	__sync_fetch_and_sub(&_subscribers_running, 1);
+	return PX4_OK;
+}
+
+int uORBTest::Bench::run(unsigned iterations, const char *filename)
+{
+	_iterations = iterations;
+	_samples = new uint32_t[iterations];
+	_latency_samples_size = iterations * max_subscribers;
+	_latency_samples = new uint32_t[_latency_samples_size];
+
+	if (_samples == nullptr || _latency_samples == nullptr) {
+		delete[] _samples;
+		delete[] _latency_samples;
+		_samples = _latency_samples = nullptr;
+		return -ENOMEM;
+	}
+
+	_file = nullptr;
+
+	if (filename) {
+		_file = fopen(filename, "a");
+
+		if (_file == nullptr) {
+			PX4_ERR("failed to open %s (%i)", filename, errno);
+
+		} else {
+			fprintf(_file, "# board: %s, version: %s, iterations: %u\n", px4_board_name(),
+				px4_firmware_version_string(), iterations);
+			fprintf(_file, "# name,size,samples,p50,p90,p99,max,mean [us]\n");
+		}
+	}
+
+	PX4_INFO("%-18s %5s %7s %7s %7s %7s %9s", "[us]", "size", "p50", "p90", "p99", "max", "mean");
+
+	int ret = PX4_OK;
+
+	ret |= bench_publish<struct orb_bench_small>(ORB_ID(orb_bench_small));
+	ret |= bench_publish<struct orb_bench_medium>(ORB_ID(orb_bench_medium));
+	ret |= bench_publish<struct orb_bench_large>(ORB_ID(orb_bench_large));
+
+	ret |= bench_copy<struct orb_bench_small>(ORB_ID(orb_bench_small));
+	ret |= bench_copy<struct orb_bench_medium>(ORB_ID(orb_bench_medium));
+	ret |= bench_copy<struct orb_bench_large>(ORB_ID(orb_bench_large));
+
+	ret |= bench_poll_latency<struct orb_bench_small>(ORB_ID(orb_bench_small));
+	ret |= bench_poll_latency<struct orb_bench_medium>(ORB_ID(orb_bench_medium));
+	ret |= bench_poll_latency<struct orb_bench_large>(ORB_ID(orb_bench_large));
+
+	for (unsigned num_subscribers = 1; num_subscribers <= max_subscribers; num_subscribers *= 2) {
+		ret |= bench_fanout(num_subscribers);
+	}
+
+	ret |= bench_queue_throughput();
+
+	if (_file) {
+		fclose(_file);
+		_file = nullptr;
+	}
+
+	delete[] _samples;
+	delete[] _latency_samples;
+	_samples = _latency_samples = nullptr;
+
+	return ret == PX4_OK ? PX4_OK : PX4_ERROR;
+}
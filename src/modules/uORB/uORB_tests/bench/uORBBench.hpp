@@ -0,0 +1,131 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2017 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file uORBBench.hpp
+ *
+ * Repeatable uORB micro-benchmarks: publish and copy cost, poll wakeup latency,
+ * multi-subscriber fan-out and queued topic throughput.
+ */
+
+#pragma once
+
+#include "../../uORBCommon.hpp"
+#include "../../uORB.h"
+#include <px4_time.h>
+#include <px4_tasks.h>
+#include <stdio.h>
+
+/* all benchmark topics start with the timestamp, so that subscribers can read it for any size */
+struct orb_bench_small {
+	uint64_t timestamp;
+	uint8_t data[8];
+};
+ORB_DECLARE(orb_bench_small);
+
+struct orb_bench_medium {
+	uint64_t timestamp;
+	uint8_t data[120];
+};
+ORB_DECLARE(orb_bench_medium);
+ORB_DECLARE(orb_bench_queue);
+
+struct orb_bench_large {
+	uint64_t timestamp;
+	uint8_t data[1016];
+};
+ORB_DECLARE(orb_bench_large);
+
+namespace uORBTest
+{
+class Bench;
+}
+
+class uORBTest::Bench
+{
+public:
+
+	// Singleton pattern
+	static uORBTest::Bench &instance();
+	~Bench() {}
+
+	/**
+	 * Run all benchmarks and print the results.
+	 * @param iterations number of samples per measurement
+	 * @param filename file to append the results to, nullptr to only print them
+	 * @return PX4_OK on success
+	 */
+	int run(unsigned iterations, const char *filename);
+
+private:
+	Bench() = default;
+
+	// Disallow copy
+	Bench(const uORBTest::Bench & /*unused*/) = delete;
+
+	static const unsigned queue_size = 16;
+	static const unsigned max_subscribers = 8;
+
+	template<typename S> int bench_publish(orb_id_t T);
+	template<typename S> int bench_copy(orb_id_t T);
+	template<typename S> int bench_poll_latency(orb_id_t T);
+	int bench_fanout(unsigned num_subscribers);
+	int bench_queue_throughput();
+
+	/**
+	 * Sort the samples and print (and write) the percentiles.
+	 */
+	void report(const char *name, unsigned size, uint32_t *samples, unsigned count);
+
+	/**
+	 * Start num_subscribers tasks polling on T and wait until they are subscribed.
+	 */
+	int start_subscribers(orb_id_t T, unsigned num_subscribers);
+	void stop_subscribers();
+
+	static int subscriber_entry(char *const argv[]);
+	int subscriber_main();
+
+	unsigned _iterations = 0;
+	uint32_t *_samples = nullptr; ///< _iterations samples
+	FILE *_file = nullptr;
+
+	orb_id_t _subscriber_topic = nullptr;
+	volatile bool _subscribers_should_exit = false;
+	volatile unsigned _subscribers_running = 0;
+
+	uint32_t *_latency_samples = nullptr; ///< publish to wakeup latency of all subscribers
+	unsigned _latency_samples_size = 0;
+	volatile unsigned _latency_count = 0;
+};
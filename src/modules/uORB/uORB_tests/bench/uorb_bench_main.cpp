@@ -0,0 +1,98 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2017 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+#include <px4_getopt.h>
+#include <px4_module.h>
+#include <px4_log.h>
+#include <stdlib.h>
+#include "uORBBench.hpp"
+
+extern "C" { __EXPORT int uorb_bench_main(int argc, char *argv[]); }
+
+static void usage()
+{
+	PRINT_MODULE_DESCRIPTION(
+		R"DESCR_STR(
+### Description
+uORB micro-benchmarks, to compare the uORB performance across boards and commits.
+
+Measures the publish and copy cost and the poll wakeup latency for several message sizes, the publish cost and
+wakeup latency with multiple polling subscribers (fan-out), and the throughput of a queued topic drained with
+`orb_copy_multi()`. For each measurement the percentiles are printed and appended to a CSV file.
+
+Run it on an otherwise idle system for comparable results.
+
+### Examples
+$ uorb_bench -n 1000 -o /fs/microsd/uorb_bench.csv
+)DESCR_STR");
+
+	PRINT_MODULE_USAGE_NAME("uorb_bench", "command");
+	PRINT_MODULE_USAGE_PARAM_INT('n', 1000, 10, 10000, "Number of samples per measurement", true);
+	PRINT_MODULE_USAGE_PARAM_STRING('o', PX4_ROOTFSDIR"/fs/microsd/uorb_bench.csv", "<file>",
+					"File to append the results to", true);
+}
+
+int
+uorb_bench_main(int argc, char *argv[])
+{
+	unsigned iterations = 1000;
+	const char *filename = PX4_ROOTFSDIR"/fs/microsd/uorb_bench.csv";
+
+	int myoptind = 1;
+	int ch;
+	const char *myoptarg = nullptr;
+
+	while ((ch = px4_getopt(argc, argv, "n:o:", &myoptind, &myoptarg)) != EOF) {
+		switch (ch) {
+		case 'n':
+			iterations = strtoul(myoptarg, nullptr, 10);
+			break;
+
+		case 'o':
+			filename = myoptarg;
+			break;
+
+		default:
+			usage();
+			return -EINVAL;
+		}
+	}
+
+	if (myoptind < argc || iterations < 10 || iterations > 10000) {
+		usage();
+		return -EINVAL;
+	}
+
+	return uORBTest::Bench::instance().run(iterations, filename);
+}
@@ -33,6 +33,8 @@
 
 #include "uORBTest_UnitTest.hpp"
 #include "../uORBCommon.hpp"
+#include "../uORBManager.hpp"
+#include "../uORBShmem.hpp"
 #include <px4_config.h>
 #include <px4_time.h>
 #include <stdio.h>
@@ -41,6 +43,7 @@
 
 ORB_DEFINE(orb_test, struct orb_test, sizeof(orb_test), "ORB_TEST:int val;hrt_abstime time;");
 ORB_DEFINE(orb_multitest, struct orb_test, sizeof(orb_test), "ORB_MULTITEST:int val;hrt_abstime time;");
+ORB_DEFINE(orb_test_shmem, struct orb_test, sizeof(orb_test), "ORB_TEST_SHMEM:int val;hrt_abstime time;");
 
 ORB_DEFINE(orb_test_medium, struct orb_test_medium, sizeof(orb_test_medium),
 	   "ORB_TEST_MEDIUM:int val;hrt_abstime time;char[64] junk;");
@@ -50,6 +53,8 @@ ORB_DEFINE(orb_test_medium_queue, struct orb_test_medium, sizeof(orb_test_medium
 	   "ORB_TEST_MEDIUM_MULTI:int val;hrt_abstime time;char[64] junk;");
 ORB_DEFINE(orb_test_medium_queue_poll, struct orb_test_medium, sizeof(orb_test_medium),
 	   "ORB_TEST_MEDIUM_MULTI:int val;hrt_abstime time;char[64] junk;");
+ORB_DEFINE(orb_test_medium_queue_multi, struct orb_test_medium, sizeof(orb_test_medium),
+	   "ORB_TEST_MEDIUM_MULTI:int val;hrt_abstime time;char[64] junk;");
 
 ORB_DEFINE(orb_test_large, struct orb_test_large, sizeof(orb_test_large),
 	   "ORB_TEST_LARGE:int val;hrt_abstime time;char[512] junk;");
@@ -195,7 +200,19 @@ int uORBTest::UnitTest::test()
 		return ret;
 	}
 
-	return test_queue_poll_notify();
+	ret = test_queue_copy_multi();
+
+	if (ret != OK) {
+		return ret;
+	}
+
+	ret = test_queue_poll_notify();
+
+	if (ret != OK) {
+		return ret;
+	}
+
+	return test_shmem_namespace();
 }
 
 int uORBTest::UnitTest::test_unadvertise()
@@ -707,6 +724,105 @@ int uORBTest::UnitTest::test_queue()
 }
 
 
+int uORBTest::UnitTest::test_queue_copy_multi()
+{
+	test_note("Testing orb queuing (copy multi)");
+
+	struct orb_test_medium t;
+	const unsigned int queue_size = 8;
+	struct orb_test_medium u[queue_size];
+	unsigned count, lost;
+	orb_advert_t ptopic;
+
+	int sfd = orb_subscribe(ORB_ID(orb_test_medium_queue_multi));
+
+	if (sfd < 0) {
+		return test_fail("subscribe failed: %d", errno);
+	}
+
+	t.val = 0;
+	ptopic = orb_advertise_queue(ORB_ID(orb_test_medium_queue_multi), &t, queue_size);
+
+	if (ptopic == nullptr) {
+		return test_fail("advertise failed: %d", errno);
+	}
+
+	/* the initial publication */
+	if (orb_copy_multi(ORB_ID(orb_test_medium_queue_multi), sfd, u, queue_size, &count, &lost) != PX4_OK) {
+		return test_fail("copy_multi failed: %d", errno);
+	}
+
+	if (count != 1 || u[0].val != 0) {
+		return test_fail("copy_multi(1): got %u elements, expected 1", count);
+	}
+
+	if (orb_copy_multi(ORB_ID(orb_test_medium_queue_multi), sfd, u, queue_size, &count, &lost) != PX4_OK || count != 0) {
+		return test_fail("copy_multi: got %u elements without publication", count);
+	}
+
+	test_note("  Testing to drain some elements...");
+
+	for (unsigned int i = 0; i < queue_size - 3; ++i) {
+		t.val = i;
+		orb_publish(ORB_ID(orb_test_medium_queue_multi), ptopic, &t);
+	}
+
+	orb_copy_multi(ORB_ID(orb_test_medium_queue_multi), sfd, u, queue_size, &count, &lost);
+
+	if (count != queue_size - 3 || lost != 0) {
+		return test_fail("got %u elements (%u lost), expected %u", count, lost, queue_size - 3);
+	}
+
+	for (unsigned int i = 0; i < count; ++i) {
+		if (u[i].val != (int)i) {
+			return test_fail("got wrong element from the queue (got %i, should be %i)", u[i].val, i);
+		}
+	}
+
+	test_note("  Testing overflow...");
+	const unsigned int overflow_by = 3;
+
+	for (unsigned int i = 0; i < queue_size + overflow_by; ++i) {
+		t.val = i;
+		orb_publish(ORB_ID(orb_test_medium_queue_multi), ptopic, &t);
+	}
+
+	/* drain in two steps to check max_items */
+	orb_copy_multi(ORB_ID(orb_test_medium_queue_multi), sfd, u, 2, &count, &lost);
+
+	if (count != 2 || lost != overflow_by) {
+		return test_fail("got %u elements (%u lost), expected 2 (%u lost)", count, lost, overflow_by);
+	}
+
+	if (u[0].val != (int)overflow_by || u[1].val != (int)overflow_by + 1) {
+		return test_fail("got wrong elements from the queue (got %i %i)", u[0].val, u[1].val);
+	}
+
+	orb_copy_multi(ORB_ID(orb_test_medium_queue_multi), sfd, u, queue_size, &count, &lost);
+
+	if (count != queue_size - 2 || lost != 0) {
+		return test_fail("got %u elements (%u lost), expected %u", count, lost, queue_size - 2);
+	}
+
+	for (unsigned int i = 0; i < count; ++i) {
+		if (u[i].val != (int)(i + overflow_by + 2)) {
+			return test_fail("got wrong element from the queue (got %i, should be %i)", u[i].val, i + overflow_by + 2);
+		}
+	}
+
+	bool updated;
+	orb_check(sfd, &updated);
+
+	if (updated) {
+		return test_fail("spurious updated flag");
+	}
+
+	orb_unadvertise(ptopic);
+	orb_unsubscribe(sfd);
+
+	return test_note("PASS orb queuing (copy multi)");
+}
+
 int uORBTest::UnitTest::pub_test_queue_entry(char *const argv[])
 {
 	uORBTest::UnitTest &t = uORBTest::UnitTest::instance();
@@ -814,6 +930,74 @@ int uORBTest::UnitTest::test_queue_poll_notify()
 	return test_note("PASS orb queuing (poll & notify), got %i messages", next_expected_val);
 }
 
+int uORBTest::UnitTest::test_shmem_namespace()
+{
+#if defined(ORB_USE_SHMEM) && defined(PX4_MAX_VEHICLE_INSTANCES)
+	test_note("Testing shared memory segments of vehicle namespaces");
+
+	const struct orb_metadata *meta = ORB_ID(orb_test_shmem);
+	char name[2][uORB::orb_maxpath];
+
+	if (!uORB::ShmemSegment::get_name(name[0], sizeof(name[0]), 0, meta->o_name, 0) ||
+	    !uORB::ShmemSegment::get_name(name[1], sizeof(name[1]), 1, meta->o_name, 0)) {
+		return test_fail("get_name failed");
+	}
+
+	if (strcmp(name[0], name[1]) == 0) {
+		return test_fail("vehicles share the segment %s", name[0]);
+	}
+
+	/* advertise the same topic on vehicle 0 and 1, each must create its own segment */
+	uORB::Manager *manager = uORB::Manager::get_instance();
+	const bool shmem_enabled = manager->shmem_enabled();
+	const int vehicle_instance = px4_get_vehicle_instance();
+	manager->set_shmem_enabled(true);
+
+	orb_advert_t pub[2];
+	struct orb_test t;
+
+	for (int i = 0; i < 2; ++i) {
+		px4_set_vehicle_instance(i);
+		t.val = i + 1;
+		t.time = hrt_absolute_time();
+		pub[i] = orb_advertise(ORB_ID(orb_test_shmem), &t);
+	}
+
+	px4_set_vehicle_instance(vehicle_instance);
+	manager->set_shmem_enabled(shmem_enabled);
+
+	int ret = OK;
+
+	for (int i = 0; i < 2 && ret == OK; ++i) {
+		uORB::ShmemSegment shm;
+		uint32_t generation = 0;
+
+		if (pub[i] == nullptr) {
+			ret = test_fail("advertise on vehicle %i failed", i);
+
+		} else if (!shm.open(name[i], sizeof(t))) {
+			ret = test_fail("segment %s not found", name[i]);
+
+		} else if (!shm.copy(generation, &t) || t.val != i + 1) {
+			ret = test_fail("segment %s: val %i expected %i", name[i], t.val, i + 1);
+		}
+	}
+
+	for (int i = 0; i < 2; ++i) {
+		if (pub[i] != nullptr) {
+			orb_unadvertise(pub[i]);
+		}
+	}
+
+	if (ret != OK) {
+		return ret;
+	}
+
+	return test_note("PASS shared memory segments of vehicle namespaces");
+#else
+	return OK;
+#endif
+}
 
 int uORBTest::UnitTest::test_fail(const char *fmt, ...)
 {
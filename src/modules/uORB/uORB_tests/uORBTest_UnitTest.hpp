@@ -44,6 +44,7 @@ struct orb_test {
 };
 ORB_DECLARE(orb_test);
 ORB_DECLARE(orb_multitest);
+ORB_DECLARE(orb_test_shmem);
 
 
 struct orb_test_medium {
@@ -55,6 +56,7 @@ ORB_DECLARE(orb_test_medium);
 ORB_DECLARE(orb_test_medium_multi);
 ORB_DECLARE(orb_test_medium_queue);
 ORB_DECLARE(orb_test_medium_queue_poll);
+ORB_DECLARE(orb_test_medium_queue_multi);
 
 struct orb_test_large {
 	int val;
@@ -114,8 +116,11 @@ private:
 	static int pub_test_queue_entry(char *const argv[]);
 	int pub_test_queue_main();
 	int test_queue_poll_notify();
+	int test_queue_copy_multi();
 	volatile int _num_messages_sent = 0;
 
+	int test_shmem_namespace();
+
 	int test_fail(const char *fmt, ...);
 	int test_note(const char *fmt, ...);
 };
@@ -51,6 +51,10 @@ UavcanEscController::UavcanEscController(uavcan::INode &node) :
 {
 	_uavcan_pub_raw_cmd.setPriority(UAVCAN_COMMAND_TRANSFER_PRIORITY);
 
+	// the TX queue is ordered by priority, so the commands overtake the lower priority traffic. A command
+	// still queued when the next one is due is dropped instead of being sent late.
+	_uavcan_pub_raw_cmd.setTxTimeout(uavcan::MonotonicDuration::fromUSec(1000000 / MAX_RATE_HZ));
+
 	if (_perfcnt_invalid_input == nullptr) {
 		errx(1, "uavcan: couldn't allocate _perfcnt_invalid_input");
 	}
@@ -58,12 +62,17 @@ UavcanEscController::UavcanEscController(uavcan::INode &node) :
 	if (_perfcnt_scaling_error == nullptr) {
 		errx(1, "uavcan: couldn't allocate _perfcnt_scaling_error");
 	}
+
+	if (_perfcnt_command_latency == nullptr) {
+		errx(1, "uavcan: couldn't allocate _perfcnt_command_latency");
+	}
 }
 
 UavcanEscController::~UavcanEscController()
 {
 	perf_free(_perfcnt_invalid_input);
 	perf_free(_perfcnt_scaling_error);
+	perf_free(_perfcnt_command_latency);
 }
 
 int UavcanEscController::init()
@@ -83,7 +92,7 @@ int UavcanEscController::init()
 	return res;
 }
 
-void UavcanEscController::update_outputs(float *outputs, unsigned num_outputs)
+void UavcanEscController::update_outputs(float *outputs, unsigned num_outputs, hrt_abstime command_timestamp)
 {
 	if ((outputs == nullptr) ||
 	    (num_outputs > uavcan::equipment::esc::RawCommand::FieldTypes::cmd::MaxSize) ||
@@ -165,7 +174,12 @@ void UavcanEscController::update_outputs(float *outputs, unsigned num_outputs)
 	 * Publish the command message to the bus
 	 * Note that for a quadrotor it takes one CAN frame
 	 */
-	(void)_uavcan_pub_raw_cmd.broadcast(msg);
+	if (_uavcan_pub_raw_cmd.broadcast(msg) >= 0 && command_timestamp > 0) {
+		// the frames are handed to the driver right away if a mailbox is free, queued otherwise
+		const hrt_abstime latency = hrt_elapsed_time(&command_timestamp);
+		perf_set_elapsed(_perfcnt_command_latency, latency);
+		_esc_status.command_latency_us = latency;
+	}
 
 	// Publish actuator outputs
 	if (_actuator_outputs_pub != nullptr) {
@@ -47,6 +47,7 @@
 #include <uavcan/uavcan.hpp>
 #include <uavcan/equipment/esc/RawCommand.hpp>
 #include <uavcan/equipment/esc/Status.hpp>
+#include <drivers/drv_hrt.h>
 #include <systemlib/perf_counter.h>
 #include <uORB/topics/esc_status.h>
 #include <uORB/topics/actuator_outputs.h>
@@ -60,7 +61,11 @@ public:
 
 	int init();
 
-	void update_outputs(float *outputs, unsigned num_outputs);
+	/**
+	 * Send the ESC command to the bus
+	 * @param command_timestamp publication time of the commanded values (0 if unknown), for the latency measurement
+	 */
+	void update_outputs(float *outputs, unsigned num_outputs, hrt_abstime command_timestamp = 0);
 
 	void arm_all_escs(bool arm);
 	void arm_single_esc(int num, bool arm);
@@ -116,4 +121,5 @@ private:
 	 */
 	perf_counter_t _perfcnt_invalid_input = perf_alloc(PC_COUNT, "uavcan_esc_invalid_input");
 	perf_counter_t _perfcnt_scaling_error = perf_alloc(PC_COUNT, "uavcan_esc_scaling_error");
+	perf_counter_t _perfcnt_command_latency = perf_alloc(PC_ELAPSED, "uavcan_esc_cmd_latency");
 };
@@ -41,6 +41,8 @@
 #include <uavcan/uavcan.hpp>
 #include <uavcan/helpers/heap_based_pool_allocator.hpp>
 
+#include <stdio.h>
+
 // TODO: Entire UAVCAN application should be moved into a namespace later; this is the first step.
 namespace uavcan_node
 {
@@ -50,6 +52,36 @@ struct AllocatorSynchronizer {
 	~AllocatorSynchronizer() { ::leave_critical_section(state); }
 };
 
+#if defined(UAVCAN_STATIC_POOL_BLOCKS) && UAVCAN_STATIC_POOL_BLOCKS > 0
+
+/**
+ * Pool of a fixed number of blocks, reserved with the node, for a constant allocation cost.
+ * The size is set per board with config_uavcan_static_pool_blocks.
+ */
+struct Allocator : public uavcan::PoolAllocator<UAVCAN_STATIC_POOL_BLOCKS * uavcan::MemPoolBlockSize,
+		uavcan::MemPoolBlockSize, AllocatorSynchronizer> {
+
+	~Allocator()
+	{
+		if (getNumUsedBlocks() > 0) {
+			warnx("UAVCAN LEAKS MEMORY: %u BLOCKS (%u BYTES) LOST",
+			      getNumUsedBlocks(), getNumUsedBlocks() * uavcan::MemPoolBlockSize);
+		}
+	}
+
+	void print_status() const
+	{
+		printf("Pool allocator status (static):\n");
+		printf("\tCapacity:  %u blocks\n", getBlockCapacity());
+		printf("\tAllocated: %u blocks\n", getNumUsedBlocks());
+		printf("\tPeak:      %u blocks\n", getPeakNumUsedBlocks());
+	}
+
+	void shrink() { } ///< nothing to give back
+};
+
+#else
+
 struct Allocator : public uavcan::HeapBasedPoolAllocator<uavcan::MemPoolBlockSize, AllocatorSynchronizer> {
 	static constexpr unsigned CapacitySoftLimit = 250;
 	static constexpr unsigned CapacityHardLimit = 500;
@@ -65,6 +97,32 @@ struct Allocator : public uavcan::HeapBasedPoolAllocator<uavcan::MemPoolBlockSiz
 			      getNumAllocatedBlocks(), getNumAllocatedBlocks() * uavcan::MemPoolBlockSize);
 		}
 	}
+
+	void *allocate(std::size_t size) override
+	{
+		void *const block = uavcan::HeapBasedPoolAllocator<uavcan::MemPoolBlockSize, AllocatorSynchronizer>::allocate(size);
+
+		AllocatorSynchronizer lock;
+
+		if (getNumAllocatedBlocks() > _peak_allocated_blocks) {
+			_peak_allocated_blocks = getNumAllocatedBlocks();
+		}
+
+		return block;
+	}
+
+	void print_status() const
+	{
+		printf("Pool allocator status (heap):\n");
+		printf("\tCapacity hard/soft: %u/%u blocks\n", getBlockCapacityHardLimit(), getBlockCapacity());
+		printf("\tReserved:  %u blocks\n", getNumReservedBlocks());
+		printf("\tAllocated: %u blocks\n", getNumAllocatedBlocks());
+		printf("\tPeak:      %u blocks\n", _peak_allocated_blocks);
+	}
+
+private:
+	uint16_t _peak_allocated_blocks{0};
 };
 
+#endif
 }
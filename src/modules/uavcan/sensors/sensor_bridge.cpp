@@ -37,6 +37,10 @@
 
 #include "sensor_bridge.hpp"
 #include <cassert>
+#include <cstring>
+
+#include <px4_log.h>
+#include <systemlib/param/param.h>
 
 #include "gnss.hpp"
 #include "mag.hpp"
@@ -53,20 +57,34 @@ void IUavcanSensorBridge::make_all(uavcan::INode &node, List<IUavcanSensorBridge
 }
 
 /*
- * UavcanCDevSensorBridgeBase
+ * UavcanSensorBridgeBase
  */
-UavcanCDevSensorBridgeBase::~UavcanCDevSensorBridgeBase()
+UavcanSensorBridgeBase::UavcanSensorBridgeBase(uavcan::INode &node, const orb_id_t orb_topic_sensor,
+		const unsigned max_channels) :
+	_max_channels(max_channels),
+	_channels(new Channel[max_channels]),
+	_orb_topic(orb_topic_sensor),
+	_publish_timer(node)
+{
+	int32_t rate_hz = 0;
+	(void)param_get(param_find("UAVCAN_SNS_RATE"), &rate_hz);
+
+	if (rate_hz > 0) {
+		_publish_timer.setCallback(TimerCbBinder(this, &UavcanSensorBridgeBase::publish_timer_cb));
+		_publish_timer.startPeriodic(uavcan::MonotonicDuration::fromUSec(1000000 / rate_hz));
+	}
+}
+
+UavcanSensorBridgeBase::~UavcanSensorBridgeBase()
 {
 	for (unsigned i = 0; i < _max_channels; i++) {
-		if (_channels[i].node_id >= 0) {
-			(void)unregister_class_devname(_class_devname, _channels[i].class_instance);
-		}
+		delete [] _channels[i].latest_report;
 	}
 
 	delete [] _channels;
 }
 
-void UavcanCDevSensorBridgeBase::publish(const int node_id, const void *report)
+void UavcanSensorBridgeBase::publish(const int node_id, const void *report)
 {
 	assert(report != nullptr);
 
@@ -86,7 +104,7 @@ void UavcanCDevSensorBridgeBase::publish(const int node_id, const void *report)
 			return;           // Give up immediately - saves some CPU time
 		}
 
-		DEVICE_LOG("adding channel %d...", node_id);
+		PX4_INFO("%s: adding channel %d...", _orb_topic->o_name, node_id);
 
 		// Search for the first free channel
 		for (unsigned i = 0; i < _max_channels; i++) {
@@ -99,20 +117,14 @@ void UavcanCDevSensorBridgeBase::publish(const int node_id, const void *report)
 		// No free channels left
 		if (channel == nullptr) {
 			_out_of_channels = true;
-			DEVICE_LOG("out of channels");
+			PX4_WARN("%s: out of channels", _orb_topic->o_name);
 			return;
 		}
 
-		// update device id as we now know our device node_id
-		_device_id.devid_s.address = static_cast<uint8_t>(node_id);
+		const int class_instance = register_channel(node_id, channel - _channels);
 
-		// Ask the CDev helper which class instance we can take
-		const int class_instance = register_class_devname(_class_devname);
-
-		if (class_instance < 0 || class_instance >= int(_max_channels)) {
+		if (class_instance < 0) {
 			_out_of_channels = true;
-			DEVICE_LOG("out of class instances");
-			(void)unregister_class_devname(_class_devname, class_instance);
 			return;
 		}
 
@@ -120,24 +132,49 @@ void UavcanCDevSensorBridgeBase::publish(const int node_id, const void *report)
 		channel->node_id        = node_id;
 		channel->class_instance = class_instance;
 
+		if (_publish_timer.isRunning()) {
+			channel->latest_report = new uint8_t[_orb_topic->o_size];
+		}
+
 		channel->orb_advert = orb_advertise_multi(_orb_topic, report, &channel->orb_instance, ORB_PRIO_VERY_HIGH);
 
 		if (channel->orb_advert == nullptr) {
-			DEVICE_LOG("ADVERTISE FAILED");
-			(void)unregister_class_devname(_class_devname, class_instance);
+			PX4_ERR("%s: advertise failed", _orb_topic->o_name);
+			unregister_channel(*channel);
+			delete [] channel->latest_report;
 			*channel = Channel();
 			return;
 		}
 
-		DEVICE_LOG("channel %d class instance %d ok", channel->node_id, channel->class_instance);
+		PX4_INFO("%s: channel %d class instance %d ok", _orb_topic->o_name, channel->node_id, channel->class_instance);
+		return; // advertised with this report
 	}
 
 	assert(channel != nullptr);
 
-	(void)orb_publish(_orb_topic, channel->orb_advert, report);
+	if (channel->latest_report != nullptr) {
+		// aggregated: only keep the latest one until the timer publishes it
+		memcpy(channel->latest_report, report, _orb_topic->o_size);
+		channel->report_pending = true;
+
+	} else {
+		(void)orb_publish(_orb_topic, channel->orb_advert, report);
+	}
 }
 
-unsigned UavcanCDevSensorBridgeBase::get_num_redundant_channels() const
+void UavcanSensorBridgeBase::publish_timer_cb(const uavcan::TimerEvent &)
+{
+	for (unsigned i = 0; i < _max_channels; i++) {
+		Channel &channel = _channels[i];
+
+		if (channel.report_pending) {
+			(void)orb_publish(_orb_topic, channel.orb_advert, channel.latest_report);
+			channel.report_pending = false;
+		}
+	}
+}
+
+unsigned UavcanSensorBridgeBase::get_num_redundant_channels() const
 {
 	unsigned out = 0;
 
@@ -150,9 +187,11 @@ unsigned UavcanCDevSensorBridgeBase::get_num_redundant_channels() const
 	return out;
 }
 
-void UavcanCDevSensorBridgeBase::print_status() const
+void UavcanSensorBridgeBase::print_status() const
 {
-	printf("devname: %s\n", _class_devname);
+	if (_publish_timer.isRunning()) {
+		printf("publication rate: %u Hz\n", unsigned(1000000 / _publish_timer.getPeriod().toUSec()));
+	}
 
 	for (unsigned i = 0; i < _max_channels; i++) {
 		if (_channels[i].node_id >= 0) {
@@ -164,3 +203,43 @@ void UavcanCDevSensorBridgeBase::print_status() const
 		}
 	}
 }
+
+/*
+ * UavcanCDevSensorBridgeBase
+ */
+UavcanCDevSensorBridgeBase::~UavcanCDevSensorBridgeBase()
+{
+	for (unsigned i = 0; i < _max_channels; i++) {
+		if (_channels[i].node_id >= 0) {
+			(void)unregister_class_devname(_class_devname, _channels[i].class_instance);
+		}
+	}
+}
+
+int UavcanCDevSensorBridgeBase::register_channel(int node_id, unsigned channel_index)
+{
+	// update device id as we now know our device node_id
+	_device_id.devid_s.address = static_cast<uint8_t>(node_id);
+
+	// Ask the CDev helper which class instance we can take
+	const int class_instance = register_class_devname(_class_devname);
+
+	if (class_instance < 0 || class_instance >= int(_max_channels)) {
+		DEVICE_LOG("out of class instances");
+		(void)unregister_class_devname(_class_devname, class_instance);
+		return -1;
+	}
+
+	return class_instance;
+}
+
+void UavcanCDevSensorBridgeBase::unregister_channel(const Channel &channel)
+{
+	(void)unregister_class_devname(_class_devname, channel.class_instance);
+}
+
+void UavcanCDevSensorBridgeBase::print_status() const
+{
+	printf("devname: %s\n", _class_devname);
+	UavcanSensorBridgeBase::print_status();
+}
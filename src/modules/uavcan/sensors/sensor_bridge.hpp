@@ -83,50 +83,88 @@ public:
 /**
  * This is the base class for redundant sensors with an independent ORB topic per each redundancy channel.
  * For example, sensor_mag0, sensor_mag1, etc.
+ *
+ * The measurements are published as they arrive, or, if UAVCAN_SNS_RATE is set, the latest one of each
+ * channel is published at that rate.
+ * Sensors that need a device (ioctl access) use UavcanCDevSensorBridgeBase.
  */
-class UavcanCDevSensorBridgeBase : public IUavcanSensorBridge, public device::CDev
+class UavcanSensorBridgeBase : public IUavcanSensorBridge
 {
+protected:
 	struct Channel {
 		int node_id              = -1;
 		orb_advert_t orb_advert  = nullptr;
 		int class_instance       = -1;
 		int orb_instance	 = -1;
+		uint8_t *latest_report   = nullptr; ///< aggregated publication only
+		bool report_pending      = false;
 	};
 
+	static constexpr unsigned DEFAULT_MAX_CHANNELS = 5; // 640 KB ought to be enough for anybody
+
+	UavcanSensorBridgeBase(uavcan::INode &node, const orb_id_t orb_topic_sensor,
+			       const unsigned max_channels = DEFAULT_MAX_CHANNELS);
+
+	/**
+	 * Sends one measurement into appropriate ORB topic.
+	 * New redundancy channels will be registered automatically.
+	 * @param node_id Sensor's Node ID
+	 * @param report  Pointer to ORB message object
+	 */
+	void publish(const int node_id, const void *report);
+
+	/**
+	 * Called for a new channel, before it is advertised.
+	 * @return class instance of the channel, negative to reject it
+	 */
+	virtual int register_channel(int node_id, unsigned channel_index) { return channel_index; }
+	virtual void unregister_channel(const Channel &channel) { }
+
 	const unsigned _max_channels;
-	const char *const _class_devname;
-	const orb_id_t _orb_topic;
 	Channel *const _channels;
+
+private:
+	void publish_timer_cb(const uavcan::TimerEvent &);
+
+	typedef uavcan::MethodBinder<UavcanSensorBridgeBase *, void (UavcanSensorBridgeBase::*)(const uavcan::TimerEvent &)>
+	TimerCbBinder;
+
+	const orb_id_t _orb_topic;
 	bool _out_of_channels = false;
+	uavcan::TimerEventForwarder<TimerCbBinder> _publish_timer;
 
-protected:
-	static constexpr unsigned DEFAULT_MAX_CHANNELS = 5; // 640 KB ought to be enough for anybody
+public:
+	virtual ~UavcanSensorBridgeBase();
+
+	unsigned get_num_redundant_channels() const override;
+
+	void print_status() const override;
+};
+
+/**
+ * Sensor bridge with a device, which registers a class device name for each redundancy channel.
+ */
+class UavcanCDevSensorBridgeBase : public UavcanSensorBridgeBase, public device::CDev
+{
+	const char *const _class_devname;
 
-	UavcanCDevSensorBridgeBase(const char *name, const char *devname, const char *class_devname,
+protected:
+	UavcanCDevSensorBridgeBase(uavcan::INode &node, const char *name, const char *devname, const char *class_devname,
 				   const orb_id_t orb_topic_sensor,
 				   const unsigned max_channels = DEFAULT_MAX_CHANNELS) :
+		UavcanSensorBridgeBase(node, orb_topic_sensor, max_channels),
 		device::CDev(name, devname),
-		_max_channels(max_channels),
-		_class_devname(class_devname),
-		_orb_topic(orb_topic_sensor),
-		_channels(new Channel[max_channels])
+		_class_devname(class_devname)
 	{
 		_device_id.devid_s.bus_type = DeviceBusType_UAVCAN;
 		_device_id.devid_s.bus = 0;
 	}
 
-	/**
-	 * Sends one measurement into appropriate ORB topic.
-	 * New redundancy channels will be registered automatically.
-	 * @param node_id Sensor's Node ID
-	 * @param report  Pointer to ORB message object
-	 */
-	void publish(const int node_id, const void *report);
+	int register_channel(int node_id, unsigned channel_index) override;
+	void unregister_channel(const Channel &channel) override;
 
 public:
 	virtual ~UavcanCDevSensorBridgeBase();
 
-	unsigned get_num_redundant_channels() const override;
-
 	void print_status() const override;
 };
@@ -852,13 +852,13 @@ int UavcanNode::run()
 
 		(void)pthread_mutex_lock(&_node_mutex);
 
-		node_spin_once();  // Non-blocking
-
 		bool new_output = false;
+		hrt_abstime command_timestamp = 0;
 
 		// this would be bad...
 		if (poll_ret < 0) {
 			DEVICE_LOG("poll error %d", errno);
+			node_spin_once();  // Non-blocking
 			continue;
 
 		} else {
@@ -870,6 +870,10 @@ int UavcanNode::run()
 					if (_poll_fds[_poll_ids[i]].revents & POLLIN) {
 						controls_updated = true;
 						orb_copy(_control_topics[i], _control_subs[i], &_controls[i]);
+
+						if (_controls[i].timestamp > command_timestamp) {
+							command_timestamp = _controls[i].timestamp;
+						}
 					}
 				}
 			}
@@ -888,6 +892,7 @@ int UavcanNode::run()
 				memcpy(&_outputs.output[0], &_actuator_direct.values[0],
 				       _actuator_direct.nvalues * sizeof(float));
 				_outputs.noutputs = _actuator_direct.nvalues;
+				command_timestamp = _actuator_direct.timestamp;
 				new_output = true;
 			}
 
@@ -900,6 +905,7 @@ int UavcanNode::run()
 					_outputs.noutputs = _test_motor.motor_number + 1;
 				}
 
+				command_timestamp = 0;
 				new_output = true;
 
 			} else if (controls_updated && (_mixers != nullptr)) {
@@ -941,9 +947,12 @@ int UavcanNode::run()
 
 			// Output to the bus
 			_outputs.timestamp = hrt_absolute_time();
-			_esc_controller.update_outputs(_outputs.output, _outputs.noutputs);
+			_esc_controller.update_outputs(_outputs.output, _outputs.noutputs, command_timestamp);
 		}
 
+		// The ESC command is sent first, in the cycle the controls arrived in: the spin processes the
+		// received frames, timers and the TX queue, which includes the command frames that did not go out yet.
+		node_spin_once();  // Non-blocking
 
 		// Check motor test state
 		bool updated = false;
@@ -1161,11 +1170,7 @@ UavcanNode::print_info()
 	(void)pthread_mutex_lock(&_node_mutex);
 
 	// Memory status
-	printf("Pool allocator status:\n");
-	printf("\tCapacity hard/soft: %u/%u blocks\n",
-	       _pool_allocator.getBlockCapacityHardLimit(), _pool_allocator.getBlockCapacity());
-	printf("\tReserved:  %u blocks\n", _pool_allocator.getNumReservedBlocks());
-	printf("\tAllocated: %u blocks\n", _pool_allocator.getNumAllocatedBlocks());
+	_pool_allocator.print_status();
 
 	// UAVCAN node perfcounters
 	printf("UAVCAN node status:\n");
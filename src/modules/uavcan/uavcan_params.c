@@ -87,3 +87,17 @@ PARAM_DEFINE_INT32(UAVCAN_BITRATE, 1000000);
  * @group UAVCAN
  */
 PARAM_DEFINE_INT32(UAVCAN_ESC_IDLT, 1);
+
+/**
+ * UAVCAN sensor publication rate.
+ *
+ * Publication rate of each UAVCAN sensor (baro, mag) to uORB, with the latest measurement
+ * of each sensor node. 0 publishes every received measurement.
+ *
+ * @unit Hz
+ * @min 0
+ * @max 1000
+ * @reboot_required true
+ * @group UAVCAN
+ */
+PARAM_DEFINE_INT32(UAVCAN_SNS_RATE, 0);
@@ -439,6 +439,7 @@ void Tailsitter::fill_actuator_outputs()
 	switch (_vtol_mode) {
 	case ROTARY_WING:
 		_actuators_out_0->timestamp = _actuators_mc_in->timestamp;
+		_actuators_out_0->timestamp_sample = _actuators_mc_in->timestamp_sample;
 		_actuators_out_0->control[actuator_controls_s::INDEX_ROLL] = _actuators_mc_in->control[actuator_controls_s::INDEX_ROLL];
 		_actuators_out_0->control[actuator_controls_s::INDEX_PITCH] =
 			_actuators_mc_in->control[actuator_controls_s::INDEX_PITCH];
@@ -447,6 +448,7 @@ void Tailsitter::fill_actuator_outputs()
 			_actuators_mc_in->control[actuator_controls_s::INDEX_THROTTLE];
 
 		_actuators_out_1->timestamp = _actuators_mc_in->timestamp;
+		_actuators_out_1->timestamp_sample = _actuators_mc_in->timestamp_sample;
 
 		if (_params->elevons_mc_lock == 1) {
 			_actuators_out_1->control[0] = 0;
@@ -465,6 +467,7 @@ void Tailsitter::fill_actuator_outputs()
 	case FIXED_WING:
 		// in fixed wing mode we use engines only for providing thrust, no moments are generated
 		_actuators_out_0->timestamp = _actuators_fw_in->timestamp;
+		_actuators_out_0->timestamp_sample = _actuators_fw_in->timestamp_sample;
 		_actuators_out_0->control[actuator_controls_s::INDEX_ROLL] = 0;
 		_actuators_out_0->control[actuator_controls_s::INDEX_PITCH] = 0;
 		_actuators_out_0->control[actuator_controls_s::INDEX_YAW] = 0;
@@ -485,7 +488,9 @@ void Tailsitter::fill_actuator_outputs()
 	case TRANSITION_TO_MC:
 		// in transition engines are mixed by weight (BACK TRANSITION ONLY)
 		_actuators_out_0->timestamp = _actuators_mc_in->timestamp;
+		_actuators_out_0->timestamp_sample = _actuators_mc_in->timestamp_sample;
 		_actuators_out_1->timestamp = _actuators_mc_in->timestamp;
+		_actuators_out_1->timestamp_sample = _actuators_mc_in->timestamp_sample;
 		_actuators_out_0->control[actuator_controls_s::INDEX_ROLL] = _actuators_mc_in->control[actuator_controls_s::INDEX_ROLL]
 				* _mc_roll_weight;
 		_actuators_out_0->control[actuator_controls_s::INDEX_PITCH] =
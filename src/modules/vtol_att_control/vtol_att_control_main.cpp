@@ -221,32 +221,6 @@ void VtolAttitudeControl::vehicle_manual_poll()
 	}
 }
 
-/**
-* Check for inputs from mc attitude controller.
-*/
-void VtolAttitudeControl::actuator_controls_mc_poll()
-{
-	bool updated;
-	orb_check(_actuator_inputs_mc, &updated);
-
-	if (updated) {
-		orb_copy(ORB_ID(actuator_controls_virtual_mc), _actuator_inputs_mc, &_actuators_mc_in);
-	}
-}
-
-/**
-* Check for inputs from fw attitude controller.
-*/
-void VtolAttitudeControl::actuator_controls_fw_poll()
-{
-	bool updated;
-	orb_check(_actuator_inputs_fw, &updated);
-
-	if (updated) {
-		orb_copy(ORB_ID(actuator_controls_virtual_fw), _actuator_inputs_fw, &_actuators_fw_in);
-	}
-}
-
 /**
 * Check for attitude rates setpoint from mc attitude controller
 */
@@ -331,24 +305,6 @@ VtolAttitudeControl::vehicle_battery_poll()
 	}
 }
 
-/**
-* Check for parameter updates.
-*/
-void
-VtolAttitudeControl::parameters_update_poll()
-{
-	bool updated;
-
-	/* Check if parameters have changed */
-	orb_check(_params_sub, &updated);
-
-	if (updated) {
-		struct parameter_update_s param_update;
-		orb_copy(ORB_ID(parameter_update), _params_sub, &param_update);
-		parameters_update();
-	}
-}
-
 /**
 * Check for sensor updates.
 */
@@ -770,19 +726,9 @@ void VtolAttitudeControl::task_main()
 		vehicle_manual_poll();			//Check for changes in manual inputs.
 		vehicle_attitude_setpoint_poll();//Check for changes in attitude set points
 		vehicle_attitude_poll();		//Check for changes in attitude
-		actuator_controls_mc_poll();	//Check for changes in mc_attitude_control output
-		actuator_controls_fw_poll();	//Check for changes in fw_attitude_control output
 		vehicle_rates_sp_mc_poll();
 		vehicle_rates_sp_fw_poll();
-		parameters_update_poll();
-		vehicle_local_pos_poll();			// Check for new sensor values
-		vehicle_local_pos_sp_poll();
-		pos_sp_triplet_poll();
 		vehicle_airspeed_poll();
-		vehicle_battery_poll();
-		vehicle_cmd_poll();
-		tecs_status_poll();
-		land_detected_poll();
 
 		// update the vtol state machine which decides which mode we are in
 		_vtol_type->update_vtol_state();
@@ -803,6 +749,10 @@ void VtolAttitudeControl::task_main()
 			}
 		}
 
+		// the actuator outputs are only recomputed and published when the controller of the
+		// current mode delivered new data, a wakeup by the other controller is not forwarded
+		bool got_new_data = false;
+
 		// check in which mode we are in and call mode specific functions
 		if (_vtol_type->get_mode() == ROTARY_WING) {
 			// vehicle is in rotary wing mode
@@ -814,6 +764,7 @@ void VtolAttitudeControl::task_main()
 				_vtol_type->update_mc_state();
 
 				fill_mc_att_rates_sp();
+				got_new_data = true;
 			}
 
 		} else if (_vtol_type->get_mode() == FIXED_WING) {
@@ -823,11 +774,10 @@ void VtolAttitudeControl::task_main()
 
 			// got data from fw attitude controller
 			if (fds[1].revents & POLLIN) {
-				vehicle_manual_poll();
-
 				_vtol_type->update_fw_state();
 
 				fill_fw_att_rates_sp();
+				got_new_data = true;
 			}
 
 		} else if (_vtol_type->get_mode() == TRANSITION_TO_MC || _vtol_type->get_mode() == TRANSITION_TO_FW) {
@@ -836,17 +786,7 @@ void VtolAttitudeControl::task_main()
 			_vtol_vehicle_status.vtol_in_rw_mode = true; //making mc attitude controller work during transition
 			_vtol_vehicle_status.in_transition_to_fw = (_vtol_type->get_mode() == TRANSITION_TO_FW);
 
-			bool got_new_data = false;
-
-			if (fds[0].revents & POLLIN) {
-				orb_copy(ORB_ID(actuator_controls_virtual_mc), _actuator_inputs_mc, &_actuators_mc_in);
-				got_new_data = true;
-			}
-
-			if (fds[1].revents & POLLIN) {
-				orb_copy(ORB_ID(actuator_controls_virtual_fw), _actuator_inputs_fw, &_actuators_fw_in);
-				got_new_data = true;
-			}
+			got_new_data = (fds[0].revents & POLLIN) || (fds[1].revents & POLLIN);
 
 			// update transition state if got any new data
 			if (got_new_data) {
@@ -857,37 +797,51 @@ void VtolAttitudeControl::task_main()
 		} else if (_vtol_type->get_mode() == EXTERNAL) {
 			// we are using external module to generate attitude/thrust setpoint
 			_vtol_type->update_external_state();
+			got_new_data = true;
 		}
 
 		publish_att_sp();
-		_vtol_type->fill_actuator_outputs();
 
-		/* Only publish if the proper mode(s) are enabled */
-		if (_v_control_mode.flag_control_attitude_enabled ||
-		    _v_control_mode.flag_control_rates_enabled ||
-		    _v_control_mode.flag_control_manual_enabled) {
-			if (_actuators_0_pub != nullptr) {
-				orb_publish(ORB_ID(actuator_controls_0), _actuators_0_pub, &_actuators_out_0);
+		if (got_new_data) {
+			_vtol_type->fill_actuator_outputs();
 
-			} else {
-				_actuators_0_pub = orb_advertise(ORB_ID(actuator_controls_0), &_actuators_out_0);
+			/* Only publish if the proper mode(s) are enabled */
+			if (_v_control_mode.flag_control_attitude_enabled ||
+			    _v_control_mode.flag_control_rates_enabled ||
+			    _v_control_mode.flag_control_manual_enabled) {
+				if (_actuators_0_pub != nullptr) {
+					orb_publish(ORB_ID(actuator_controls_0), _actuators_0_pub, &_actuators_out_0);
+
+				} else {
+					_actuators_0_pub = orb_advertise(ORB_ID(actuator_controls_0), &_actuators_out_0);
+				}
+
+				if (_actuators_1_pub != nullptr) {
+					orb_publish(ORB_ID(actuator_controls_1), _actuators_1_pub, &_actuators_out_1);
+
+				} else {
+					_actuators_1_pub = orb_advertise(ORB_ID(actuator_controls_1), &_actuators_out_1);
+				}
 			}
 
-			if (_actuators_1_pub != nullptr) {
-				orb_publish(ORB_ID(actuator_controls_1), _actuators_1_pub, &_actuators_out_1);
+			// publish the attitude rates setpoint
+			if (_v_rates_sp_pub != nullptr) {
+				orb_publish(ORB_ID(vehicle_rates_setpoint), _v_rates_sp_pub, &_v_rates_sp);
 
 			} else {
-				_actuators_1_pub = orb_advertise(ORB_ID(actuator_controls_1), &_actuators_out_1);
+				_v_rates_sp_pub = orb_advertise(ORB_ID(vehicle_rates_setpoint), &_v_rates_sp);
 			}
 		}
 
-		// publish the attitude rates setpoint
-		if (_v_rates_sp_pub != nullptr) {
-			orb_publish(ORB_ID(vehicle_rates_setpoint), _v_rates_sp_pub, &_v_rates_sp);
-
-		} else {
-			_v_rates_sp_pub = orb_advertise(ORB_ID(vehicle_rates_setpoint), &_v_rates_sp);
-		}
+		// inputs which are not needed for the outputs of this cycle are checked after
+		// publishing, so that they do not add to the latency of the actuator controls
+		vehicle_local_pos_poll();
+		vehicle_local_pos_sp_poll();
+		pos_sp_triplet_poll();
+		vehicle_battery_poll();
+		vehicle_cmd_poll();
+		tecs_status_poll();
+		land_detected_poll();
 	}
 
 	PX4_WARN("exit");
@@ -227,8 +227,6 @@ private:
 	void		vehicle_manual_poll();			//Check for changes in manual inputs.
 	void 		mc_virtual_att_sp_poll();
 	void 		fw_virtual_att_sp_poll();
-	void 		actuator_controls_mc_poll();	//Check for changes in mc_attitude_control output
-	void 		actuator_controls_fw_poll();	//Check for changes in fw_attitude_control output
 	void 		vehicle_rates_sp_mc_poll();
 	void 		vehicle_rates_sp_fw_poll();
 	void 		vehicle_local_pos_poll();		// Check for changes in sensor values
@@ -241,7 +239,6 @@ private:
 	void		vehicle_cmd_poll();
 	void		tecs_status_poll();
 	void		land_detected_poll();
-	void 		parameters_update_poll();		//Check if parameters have changed
 	int 		parameters_update();			//Update local paraemter cache
 	void 		fill_mc_att_rates_sp();
 	void 		fill_fw_att_rates_sp();
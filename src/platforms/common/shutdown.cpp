@@ -121,7 +121,7 @@ static uint16_t shutdown_counter = 0; ///< count how many times the shutdown wor
 static uint8_t shutdown_args = 0;
 
 
-static const int max_shutdown_hooks = 1;
+static const int max_shutdown_hooks = 2;
 static shutdown_hook_t shutdown_hooks[max_shutdown_hooks] = {};
 
 
@@ -353,6 +353,13 @@ ACCELSIM::init()
 	/* fill report structures */
 	_measure();
 
+	/* the simulator publishes the sensor topics itself, the devices stay for the calibration */
+	if (Simulator::getInstance() != nullptr && Simulator::getInstance()->publishesSensorsDirectly()) {
+		Simulator::getInstance()->setDirectDeviceId(Simulator::SIM_ACCEL, m_id.dev_id);
+		Simulator::getInstance()->setDirectDeviceId(Simulator::SIM_MAG, _mag->m_id.dev_id);
+		goto out;
+	}
+
 	/* advertise sensor topic, measure manually to initialize valid report */
 	_mag_reports->get(&mrp);
 
@@ -776,6 +783,11 @@ int
 ACCELSIM::start()
 {
 	//PX4_INFO("ACCELSIM::start");
+	/* no sampling if the simulator publishes the sensor topics */
+	if (Simulator::getInstance() != nullptr && Simulator::getInstance()->publishesSensorsDirectly()) {
+		return 0;
+	}
+
 	/* make sure we are stopped first */
 	stop();
 
@@ -1019,6 +1031,10 @@ ACCELSIM_mag::devIOCTL(unsigned long cmd, unsigned long arg)
 int ACCELSIM_mag::start()
 {
 	//PX4_INFO("ACCELSIM_mag::start");
+	if (Simulator::getInstance() != nullptr && Simulator::getInstance()->publishesSensorsDirectly()) {
+		return 0;
+	}
+
 	return VirtDevObj::start();
 }
 
@@ -77,6 +77,8 @@
 
 #define BAROSIM_MEASURE_INTERVAL_US (10000)
 
+#define BAROSIM_DEVICE_ID 478459
+
 using namespace DriverFramework;
 
 class BAROSIM : public VirtDevObj
@@ -87,6 +89,8 @@ public:
 
 	virtual int init() override;
 
+	virtual int start() override;
+
 	virtual int devIOCTL(unsigned long cmd, unsigned long arg) override;
 
 	/**
@@ -187,6 +191,12 @@ BAROSIM::init()
 
 	_reports->flush();
 
+	/* the simulator publishes the sensor topic itself, the device stays for the ioctls */
+	if (Simulator::getInstance() != nullptr && Simulator::getInstance()->publishesSensorsDirectly()) {
+		Simulator::getInstance()->setDirectDeviceId(Simulator::SIM_BARO, BAROSIM_DEVICE_ID);
+		goto out;
+	}
+
 	_baro_topic = orb_advertise_multi(ORB_ID(sensor_baro), &brp,
 					  &_orb_class_instance, (is_external()) ? ORB_PRIO_HIGH : ORB_PRIO_DEFAULT);
 
@@ -199,6 +209,17 @@ out:
 	return ret;
 }
 
+int
+BAROSIM::start()
+{
+	/* no sampling if the simulator publishes the sensor topic */
+	if (Simulator::getInstance() != nullptr && Simulator::getInstance()->publishesSensorsDirectly()) {
+		return 0;
+	}
+
+	return VirtDevObj::start();
+}
+
 int
 BAROSIM::devIOCTL(unsigned long cmd, unsigned long arg)
 {
@@ -268,7 +289,7 @@ BAROSIM::collect()
 	report.temperature = raw_baro.temperature;
 
 	/* fake device ID */
-	report.device_id = 478459;
+	report.device_id = BAROSIM_DEVICE_ID;
 
 	/* publish it */
 	if (!(m_pub_blocked)) {
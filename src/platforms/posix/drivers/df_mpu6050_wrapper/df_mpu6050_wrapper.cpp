@@ -57,6 +57,7 @@
 #include <drivers/drv_accel.h>
 #include <drivers/drv_gyro.h>
 #include <drivers/device/integrator.h>
+#include <drivers/device/imu_fifo_publisher.h>
 
 #include <lib/conversion/rotation.h>
 
@@ -68,6 +69,10 @@
 // We don't want to auto publish, therefore set this to 0.
 #define MPU6050_NEVER_AUTOPUBLISH_US 0
 
+// Scaling of the raw values for the FIFO topics, as configured by the DF driver (16 g, 2000 deg/s).
+#define MPU6050_ACCEL_FIFO_SCALE (9.80665f / 2048.0f)
+#define MPU6050_GYRO_FIFO_SCALE (M_PI_F / 180.0f / 16.4f)
+
 
 extern "C" { __EXPORT int df_mpu6050_wrapper_main(int argc, char *argv[]); }
 
@@ -139,6 +144,8 @@ private:
 	Integrator		    _accel_int;
 	Integrator		    _gyro_int;
 
+	ImuFifoPublisher	    _fifo_pub;
+
 	unsigned		    _publish_count;
 
 	perf_counter_t		    _read_counter;
@@ -166,6 +173,7 @@ DfMPU6050Wrapper::DfMPU6050Wrapper(enum Rotation rotation) :
 	_gyro_orb_class_instance(-1),
 	_accel_int(MPU6050_NEVER_AUTOPUBLISH_US, false),
 	_gyro_int(MPU6050_NEVER_AUTOPUBLISH_US, true),
+	_fifo_pub(),
 	_publish_count(0),
 	_read_counter(perf_alloc(PC_COUNT, "mpu6050_reads")),
 	_error_counter(perf_alloc(PC_COUNT, "mpu6050_errors")),
@@ -177,6 +185,8 @@ DfMPU6050Wrapper::DfMPU6050Wrapper(enum Rotation rotation) :
 	_last_accel_range_hit_time(0),
 	_last_accel_range_hit_count(0)
 {
+	_fifo_pub.set_scale(MPU6050_ACCEL_FIFO_SCALE, MPU6050_GYRO_FIFO_SCALE);
+
 	// Set sane default calibration values
 	_accel_calibration.x_scale = 1.0f;
 	_accel_calibration.y_scale = 1.0f;
@@ -439,6 +449,8 @@ int DfMPU6050Wrapper::_publish(struct imu_sensor_data &data)
 	// apply sensor rotation on the accel measurement
 	accel_val = _rotation_matrix * accel_val;
 
+	const math::Vector<3> accel_fifo = accel_val / MPU6050_ACCEL_FIFO_SCALE;
+
 	accel_val(0) = (accel_val(0) - _accel_calibration.x_offset) * _accel_calibration.x_scale;
 	accel_val(1) = (accel_val(1) - _accel_calibration.y_offset) * _accel_calibration.y_scale;
 	accel_val(2) = (accel_val(2) - _accel_calibration.z_offset) * _accel_calibration.z_scale;
@@ -453,6 +465,12 @@ int DfMPU6050Wrapper::_publish(struct imu_sensor_data &data)
 	// apply sensor rotation on the gyro measurement
 	gyro_val = _rotation_matrix * gyro_val;
 
+	// FIFO topics: all samples, published once per FIFO read
+	const math::Vector<3> gyro_fifo = gyro_val / MPU6050_GYRO_FIFO_SCALE;
+	_fifo_pub.set_device_ids(m_id.dev_id, m_id.dev_id);
+	_fifo_pub.set_sample_interval(data.fifo_sample_interval_us);
+	_fifo_pub.put(now, accel_fifo(0), accel_fifo(1), accel_fifo(2), gyro_fifo(0), gyro_fifo(1), gyro_fifo(2));
+
 	gyro_val(0) = (gyro_val(0) - _gyro_calibration.x_offset) * _gyro_calibration.x_scale;
 	gyro_val(1) = (gyro_val(1) - _gyro_calibration.y_offset) * _gyro_calibration.y_scale;
 	gyro_val(2) = (gyro_val(2) - _gyro_calibration.z_offset) * _gyro_calibration.z_scale;
@@ -468,6 +486,10 @@ int DfMPU6050Wrapper::_publish(struct imu_sensor_data &data)
 		return 0;
 	}
 
+	if (!(m_pub_blocked)) {
+		_fifo_pub.publish();
+	}
+
 	// The driver empties the FIFO buffer at 1kHz, however we only need to publish at 250Hz.
 	// Therefore, only publish every forth time.
 	++_publish_count;
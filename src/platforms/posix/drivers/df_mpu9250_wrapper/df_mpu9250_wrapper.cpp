@@ -60,6 +60,7 @@
 #include <drivers/drv_gyro.h>
 #include <drivers/drv_mag.h>
 #include <drivers/device/integrator.h>
+#include <drivers/device/imu_fifo_publisher.h>
 #include <mathlib/math/filter/LowPassFilter2p.hpp>
 
 #include <lib/conversion/rotation.h>
@@ -68,6 +69,7 @@
 
 #include <mpu9250/MPU9250.hpp>
 #include <DevMgr.hpp>
+#include <DFDiag.hpp>
 
 // We don't want to auto publish, therefore set this to 0.
 #define MPU9250_NEVER_AUTOPUBLISH_US 0
@@ -78,6 +80,10 @@
 #define MPU9250_ACCEL_DEFAULT_DRIVER_FILTER_FREQ 30
 #define MPU9250_GYRO_DEFAULT_DRIVER_FILTER_FREQ 30
 
+// Scaling of the raw values for the FIFO topics, as configured by the DF driver (16 g, 2000 deg/s).
+#define MPU9250_ACCEL_FIFO_SCALE (9.80665f / 2048.0f)
+#define MPU9250_GYRO_FIFO_SCALE GYRO_RAW_TO_RAD_S
+
 
 extern "C" { __EXPORT int df_mpu9250_wrapper_main(int argc, char *argv[]); }
 
@@ -166,6 +172,8 @@ private:
 	math::LowPassFilter2p	_gyro_filter_y;
 	math::LowPassFilter2p	_gyro_filter_z;
 
+	ImuFifoPublisher	    _fifo_pub;
+
 	unsigned		    _publish_count;
 
 	perf_counter_t		    _read_counter;
@@ -206,6 +214,7 @@ DfMpu9250Wrapper::DfMpu9250Wrapper(bool mag_enabled, enum Rotation rotation) :
 	_gyro_filter_x(MPU9250_GYRO_DEFAULT_RATE, MPU9250_GYRO_DEFAULT_DRIVER_FILTER_FREQ),
 	_gyro_filter_y(MPU9250_GYRO_DEFAULT_RATE, MPU9250_GYRO_DEFAULT_DRIVER_FILTER_FREQ),
 	_gyro_filter_z(MPU9250_GYRO_DEFAULT_RATE, MPU9250_GYRO_DEFAULT_DRIVER_FILTER_FREQ),
+	_fifo_pub(),
 	_publish_count(0),
 	_read_counter(perf_alloc(PC_COUNT, "mpu9250_reads")),
 	_error_counter(perf_alloc(PC_COUNT, "mpu9250_errors")),
@@ -220,6 +229,8 @@ DfMpu9250Wrapper::DfMpu9250Wrapper(bool mag_enabled, enum Rotation rotation) :
 	_mag_enabled(mag_enabled),
 	_rotation(rotation)
 {
+	_fifo_pub.set_scale(MPU9250_ACCEL_FIFO_SCALE, MPU9250_GYRO_FIFO_SCALE);
+
 	// Set sane default calibration values
 	_accel_calibration.x_scale = 1.0f;
 	_accel_calibration.y_scale = 1.0f;
@@ -343,6 +354,8 @@ void DfMpu9250Wrapper::info()
 	}
 
 	perf_print_counter(_publish_perf);
+
+	DFDiag::listWorkItems();
 }
 
 void DfMpu9250Wrapper::_update_gyro_calibration()
@@ -611,6 +624,10 @@ int DfMpu9250Wrapper::_publish(struct imu_sensor_data &data)
 	// apply user specified rotation
 	rotate_3f(_rotation, xraw_f, yraw_f, zraw_f);
 
+	const float accel_xr = xraw_f;
+	const float accel_yr = yraw_f;
+	const float accel_zr = zraw_f;
+
 	// adjust values according to the calibration
 	float x_in_new = (xraw_f - _accel_calibration.x_offset) * _accel_calibration.x_scale;
 	float y_in_new = (yraw_f - _accel_calibration.y_offset) * _accel_calibration.y_scale;
@@ -659,12 +676,23 @@ int DfMpu9250Wrapper::_publish(struct imu_sensor_data &data)
 	gyro_report.y_integral = gval_integrated(1);
 	gyro_report.z_integral = gval_integrated(2);
 
+	// FIFO topics: all samples, published once per FIFO read
+	_fifo_pub.set_device_ids(m_id.dev_id, m_id.dev_id);
+	_fifo_pub.set_sample_interval(data.fifo_sample_interval_us);
+	_fifo_pub.put(accel_report.timestamp,
+		      accel_xr / MPU9250_ACCEL_FIFO_SCALE, accel_yr / MPU9250_ACCEL_FIFO_SCALE, accel_zr / MPU9250_ACCEL_FIFO_SCALE,
+		      xraw_f / MPU9250_GYRO_FIFO_SCALE, yraw_f / MPU9250_GYRO_FIFO_SCALE, zraw_f / MPU9250_GYRO_FIFO_SCALE);
+
 	// If we are not receiving the last sample from the FIFO buffer yet, let's stop here
 	// and wait for more packets.
 	if (!data.is_last_fifo_sample) {
 		return 0;
 	}
 
+	if (!(m_pub_blocked)) {
+		_fifo_pub.publish();
+	}
+
 	// The driver empties the FIFO buffer at 1kHz, however we only need to publish at 250Hz.
 	// Therefore, only publish every forth time.
 	++_publish_count;
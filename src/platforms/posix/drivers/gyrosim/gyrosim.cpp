@@ -454,6 +454,12 @@ GYROSIM::init()
 
 	_measure();
 
+	/* the simulator publishes the sensor topics itself, the devices stay for the calibration */
+	if (Simulator::getInstance() != nullptr && Simulator::getInstance()->publishesSensorsDirectly()) {
+		Simulator::getInstance()->setDirectDeviceId(Simulator::SIM_GYRO, _gyro->m_id.dev_id);
+		goto out;
+	}
+
 	/* advertise sensor topic, measure manually to initialize valid report */
 	_accel_reports->get(&arp);
 
@@ -969,6 +975,11 @@ GYROSIM::set_accel_range(unsigned max_g_in)
 int
 GYROSIM::start()
 {
+	/* no sampling if the simulator publishes the sensor topics */
+	if (Simulator::getInstance() != nullptr && Simulator::getInstance()->publishesSensorsDirectly()) {
+		return 0;
+	}
+
 	/* make sure we are stopped first */
 	stop();
 
@@ -33,14 +33,15 @@
 
 #include <px4_log.h>
 #include <px4_posix.h>
-#include <semaphore.h>
+#include <pthread.h>
 #include <px4_workqueue.h>
 
 #pragma once
 
 __BEGIN_DECLS
 
-extern px4_sem_t _hrt_work_lock;
+extern pthread_mutex_t _hrt_work_lock;
+extern pthread_cond_t _hrt_work_cond;
 extern struct wqueue_s g_hrt_work;
 
 void hrt_work_queue_init(void);
@@ -50,13 +51,13 @@ void hrt_work_cancel(struct work_s *work);
 static inline void hrt_work_lock(void);
 static inline void hrt_work_lock()
 {
-	px4_sem_wait(&_hrt_work_lock);
+	pthread_mutex_lock(&_hrt_work_lock);
 }
 
 static inline void hrt_work_unlock(void);
 static inline void hrt_work_unlock()
 {
-	px4_sem_post(&_hrt_work_lock);
+	pthread_mutex_unlock(&_hrt_work_lock);
 }
 
 __END_DECLS
@@ -0,0 +1,74 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2017 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file px4_usdt.h
+ * USDT probes (provider 'px4') for the trace hooks of systemlib/trace.h.
+ *
+ * Enabled with the TRACE_USDT cmake option, needs <sys/sdt.h> (systemtap-sdt-dev).
+ * A disabled probe costs a nop. List and use them with e.g.
+ *
+ *   bpftrace -l 'usdt:build/posix_sitl_default/px4:px4:*'
+ *   bpftrace -e 'usdt:./px4:px4:orb_publish { @[str(arg0)] = count(); }'
+ *   perf probe -x ./px4 sdt_px4:perf_begin
+ *
+ * LTTng can record them through its uprobe support.
+ */
+
+#pragma once
+
+#include <sys/sdt.h>
+
+#define TRACE_USDT(type, id, arg)	TRACE_USDT_##type(id, arg)
+
+/* the kernel's sched_switch tracepoint covers task switches on Linux */
+#define TRACE_USDT_TRACE_EVENT_TASK_RESUME(id, arg)
+#define TRACE_USDT_TRACE_EVENT_TASK_SUSPEND(id, arg)
+
+#define TRACE_USDT_TRACE_EVENT_HRT_CALLOUT_BEGIN(id, arg)	STAP_PROBE1(px4, hrt_callout_begin, (arg))
+#define TRACE_USDT_TRACE_EVENT_HRT_CALLOUT_END(id, arg)		STAP_PROBE1(px4, hrt_callout_end, (arg))
+
+/* arg0: topic name, arg1: generation */
+#define TRACE_USDT_TRACE_EVENT_ORB_PUBLISH(id, arg)	STAP_PROBE2(px4, orb_publish, ((const struct orb_metadata *)(arg))->o_name, (id))
+#define TRACE_USDT_TRACE_EVENT_ORB_COPY(id, arg)	STAP_PROBE2(px4, orb_copy, ((const struct orb_metadata *)(arg))->o_name, (id))
+
+/* arg0: worker function */
+#define TRACE_USDT_TRACE_EVENT_WORK_BEGIN(id, arg)	STAP_PROBE1(px4, work_begin, (arg))
+#define TRACE_USDT_TRACE_EVENT_WORK_END(id, arg)	STAP_PROBE1(px4, work_end, (arg))
+
+/* arg0: perf counter name */
+#define TRACE_USDT_TRACE_EVENT_PERF_BEGIN(id, arg)	STAP_PROBE1(px4, perf_begin, (arg))
+#define TRACE_USDT_TRACE_EVENT_PERF_END(id, arg)	STAP_PROBE1(px4, perf_end, (arg))
+
+/* arg0: message id, arg1: packet length */
+#define TRACE_USDT_TRACE_EVENT_MAVLINK_SEND(id, arg)	STAP_PROBE2(px4, mavlink_send, (id), (arg))
@@ -51,6 +51,8 @@
 #include "px4_posix.h"
 #include "px4_log.h"
 #include "DriverFramework.hpp"
+#include <drivers/drv_hrt.h>
+#include <pthread.h>
 #include <termios.h>
 #include <sys/stat.h>
 
@@ -75,6 +77,17 @@ static volatile bool _ExitFlag = false;
 
 static struct termios orig_term;
 
+/**
+ * A command started in the background with a trailing '&'
+ */
+struct background_cmd {
+	vector<string> appargs;
+	hrt_abstime start;
+	int vehicle_instance;
+};
+
+static vector<pthread_t> _background_cmds; ///< only accessed from the shell thread
+
 extern "C" {
 	void _SigIntHandler(int sig_num);
 	void _SigIntHandler(int sig_num)
@@ -191,15 +204,16 @@ static void print_prompt()
 	cout.flush();
 }
 
+static void wait_background_cmds();
+
 static void run_cmd(const vector<string> &appargs, bool exit_on_fail, bool silently_fail = false)
 {
-	static apps_map_type apps;
-	static bool initialized = false;
-
-	if (!initialized) {
-		init_app_map(apps);
-		initialized = true;
-	}
+	// background commands can get here concurrently: rely on the thread-safe static initialization
+	static apps_map_type apps = []() {
+		apps_map_type map;
+		init_app_map(map);
+		return map;
+	}();
 
 	// command is appargs[0]
 	string command = appargs[0];
@@ -229,6 +243,9 @@ static void run_cmd(const vector<string> &appargs, bool exit_on_fail, bool silen
 	} else if (command == "help") {
 		list_builtins(apps);
 
+	} else if (command == "wait") {
+		wait_background_cmds();
+
 	} else if (command.length() == 0 || command[0] == '#') {
 		// Do nothing
 
@@ -250,6 +267,38 @@ static void usage()
 	cout << "   -h            - help/usage information" << endl;
 }
 
+static void *run_background_cmd(void *arg)
+{
+	background_cmd *cmd = (background_cmd *)arg;
+
+	px4_set_vehicle_instance(cmd->vehicle_instance);
+	run_cmd(cmd->appargs, false);
+
+	// add the command to the boot timeline (silently ignored if the boot command is not built)
+	string label;
+
+	for (unsigned i = 0; i < cmd->appargs.size() && cmd->appargs[i] != ""; ++i) {
+		label += (i == 0 ? "" : " ") + cmd->appargs[i];
+	}
+
+	run_cmd({"boot", "mark", "-s", to_string(cmd->start), label}, false, true);
+
+	delete cmd;
+	return nullptr;
+}
+
+/**
+ * Block until all commands started in the background have returned.
+ */
+static void wait_background_cmds()
+{
+	for (pthread_t thread : _background_cmds) {
+		pthread_join(thread, nullptr);
+	}
+
+	_background_cmds.clear();
+}
+
 static void process_line(string &line, bool exit_on_fail)
 {
 	vector<string> appargs(20);
@@ -257,6 +306,32 @@ static void process_line(string &line, bool exit_on_fail)
 	stringstream(line) >> appargs[0] >> appargs[1] >> appargs[2] >> appargs[3] >> appargs[4] >> appargs[5] >> appargs[6] >>
 			   appargs[7] >> appargs[8] >> appargs[9] >> appargs[10] >> appargs[11] >> appargs[12] >> appargs[13] >>
 			   appargs[14] >> appargs[15] >> appargs[16] >> appargs[17] >> appargs[18] >> appargs[19];
+
+	// a trailing '&' runs the command in the background, until the next 'wait'
+	int last = -1;
+
+	while (last + 1 < (int)appargs.size() && appargs[last + 1] != "") {
+		++last;
+	}
+
+	if (last > 0 && appargs[last] == "&") {
+		appargs[last] = "";
+
+		background_cmd *cmd = new background_cmd{appargs, hrt_absolute_time(), px4_get_vehicle_instance()};
+		pthread_t thread;
+
+		if (pthread_create(&thread, nullptr, run_background_cmd, cmd) == 0) {
+			_background_cmds.push_back(thread);
+
+		} else {
+			PX4_ERR("failed to start '%s' in the background", appargs[0].c_str());
+			delete cmd;
+			run_cmd(appargs, exit_on_fail);
+		}
+
+		return;
+	}
+
 	run_cmd(appargs, exit_on_fail);
 }
 
@@ -466,6 +541,9 @@ int main(int argc, char **argv)
 				process_line(line, false);
 			}
 
+			// don't leave the startup commands running into the shell
+			wait_background_cmds();
+
 		} else {
 			PX4_ERR("Error opening commands file: %s", commands_file.c_str());
 		}
@@ -43,14 +43,16 @@
 #include <px4_workqueue.h>
 #include <px4_tasks.h>
 #include <drivers/drv_hrt.h>
+#include <drivers/drv_hrt_callout_queue.h>
 #include <semaphore.h>
 #include <time.h>
 #include <string.h>
 #include <inttypes.h>
 #include <errno.h>
+#include <unistd.h>
 #include "hrt_work.h"
 
-static struct sq_queue_s	callout_queue;
+static struct hrt_callout_queue	callout_queue;
 
 /* latency histogram */
 #define LATENCY_BUCKET_COUNT 8
@@ -76,6 +78,23 @@ static hrt_abstime _delay_interval = 0;
 static hrt_abstime max_time = 0;
 pthread_mutex_t _hrt_mutex = PTHREAD_MUTEX_INITIALIZER;
 
+/* A thread waiting for the lockstep time to reach a deadline */
+struct lockstep_waiter {
+	struct lockstep_waiter *next;
+	hrt_abstime deadline;
+	px4_sem_t *sem;			/* posted at the deadline, or */
+	pthread_cond_t *cond;		/* signalled at the deadline with the mutex held */
+	pthread_mutex_t *mutex;
+	bool timed_out;
+	bool signalling;		/* hrt_lockstep_set_time() is signalling cond */
+};
+
+static volatile bool _lockstep_enabled = false;
+static hrt_abstime _lockstep_time = 0;
+static struct lockstep_waiter *_lockstep_waiters = NULL;
+static pthread_mutex_t _lockstep_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t _lockstep_cond = PTHREAD_COND_INITIALIZER;
+
 static void
 hrt_call_invoke(void);
 
@@ -194,14 +213,19 @@ hrt_abstime hrt_absolute_time(void)
 
 	hrt_abstime ret;
 
-	if (_start_delay_time > 0) {
-		ret = _start_delay_time;
+	if (_lockstep_enabled) {
+		ret = _lockstep_time;
 
 	} else {
-		ret = _hrt_absolute_time_internal();
-	}
+		if (_start_delay_time > 0) {
+			ret = _start_delay_time;
 
-	ret -= _delay_interval;
+		} else {
+			ret = _hrt_absolute_time_internal();
+		}
+
+		ret -= _delay_interval;
+	}
 
 	if (ret < max_time) {
 		PX4_ERR("WARNING! TIME IS NEGATIVE! %d vs %d", (int)ret, (int)max_time);
@@ -278,7 +302,7 @@ bool	hrt_called(struct hrt_call *entry)
 void	hrt_cancel(struct hrt_call *entry)
 {
 	hrt_lock();
-	sq_rem(&entry->link, &callout_queue);
+	hrt_callout_queue_remove(&callout_queue, entry);
 	entry->deadline = 0;
 
 	/* if this is a periodic call being removed by the callout, prevent it from
@@ -289,6 +313,16 @@ void	hrt_cancel(struct hrt_call *entry)
 	// endif
 }
 
+/*
+ * Get the callout statistics.
+ */
+void	hrt_callout_stats_get(struct hrt_callout_stats *stats, bool reset)
+{
+	hrt_lock();
+	hrt_callout_queue_stats(&callout_queue, stats, reset);
+	hrt_unlock();
+}
+
 /*
  * initialise a hrt_call structure
  */
@@ -314,7 +348,7 @@ void	hrt_call_delay(struct hrt_call *entry, hrt_abstime delay)
  */
 void	hrt_init(void)
 {
-	sq_init(&callout_queue);
+	hrt_callout_queue_init(&callout_queue);
 
 	int sem_ret = px4_sem_init(&_hrt_lock, 0, 1);
 
@@ -360,33 +394,189 @@ void	hrt_stop_delay()
 
 }
 
-static void
-hrt_call_enter(struct hrt_call *entry)
+void	hrt_lockstep_enable()
 {
-	struct hrt_call	*call, *next;
+	const hrt_abstime now = hrt_absolute_time();
 
-	//PX4_INFO("hrt_call_enter");
-	call = (struct hrt_call *)sq_peek(&callout_queue);
+	pthread_mutex_lock(&_hrt_mutex);
+	_lockstep_time = now;
+	_lockstep_enabled = true;
+	pthread_mutex_unlock(&_hrt_mutex);
+}
 
-	if ((call == NULL) || (entry->deadline < call->deadline)) {
-		sq_addfirst(&entry->link, &callout_queue);
-		//if (call != NULL) PX4_INFO("call enter at head, reschedule (%lu %lu)", entry->deadline, call->deadline);
-		/* we changed the next deadline, reschedule the timer event */
-		hrt_call_reschedule();
+bool	hrt_lockstep_enabled()
+{
+	return _lockstep_enabled;
+}
 
-	} else {
-		do {
-			next = (struct hrt_call *)sq_next(&call->link);
+/* Register a waiter, false if its deadline has already passed (with _lockstep_mutex held) */
+static bool lockstep_waiter_add(struct lockstep_waiter *waiter)
+{
+	if (waiter->deadline <= hrt_absolute_time()) {
+		return false;
+	}
 
-			if ((next == NULL) || (entry->deadline < next->deadline)) {
-				//lldbg("call enter after head\n");
-				sq_addafter(&call->link, &entry->link, &callout_queue);
-				break;
-			}
-		} while ((call = next) != NULL);
+	waiter->next = _lockstep_waiters;
+	_lockstep_waiters = waiter;
+	return true;
+}
+
+/* Unregister a waiter (with _lockstep_mutex held) */
+static void lockstep_waiter_remove(struct lockstep_waiter *waiter)
+{
+	struct lockstep_waiter **prev = &_lockstep_waiters;
+
+	while (*prev && *prev != waiter) {
+		prev = &(*prev)->next;
+	}
+
+	if (*prev) {
+		*prev = waiter->next;
+	}
+}
+
+void	hrt_lockstep_set_time(hrt_abstime time)
+{
+	pthread_mutex_lock(&_hrt_mutex);
+
+	if (time > _lockstep_time) {
+		_lockstep_time = time;
+	}
+
+	time = _lockstep_time;
+	pthread_mutex_unlock(&_hrt_mutex);
+
+	pthread_mutex_lock(&_lockstep_mutex);
+
+	struct lockstep_waiter *waiter = _lockstep_waiters;
+
+	while (waiter) {
+		if (waiter->timed_out || waiter->deadline > time) {
+			waiter = waiter->next;
+			continue;
+		}
+
+		waiter->timed_out = true;
+
+		if (waiter->sem) {
+			px4_sem_post(waiter->sem);
+			waiter = waiter->next;
+			continue;
+		}
+
+		/* The waiter holds its mutex while it takes _lockstep_mutex, so take its mutex
+		 * only after releasing ours. It stays registered until the signalling is done. */
+		waiter->signalling = true;
+		pthread_mutex_unlock(&_lockstep_mutex);
+
+		pthread_mutex_lock(waiter->mutex);
+		pthread_cond_broadcast(waiter->cond);
+		pthread_mutex_unlock(waiter->mutex);
+
+		pthread_mutex_lock(&_lockstep_mutex);
+		waiter->signalling = false;
+		pthread_cond_broadcast(&_lockstep_cond);
+
+		/* the list may have changed in the meantime */
+		waiter = _lockstep_waiters;
 	}
 
-	//PX4_INFO("scheduled");
+	pthread_mutex_unlock(&_lockstep_mutex);
+}
+
+int	hrt_lockstep_cond_timedwait(pthread_cond_t *cond, pthread_mutex_t *mutex, hrt_abstime deadline)
+{
+	struct lockstep_waiter waiter;
+	memset(&waiter, 0, sizeof(waiter));
+	waiter.deadline = deadline;
+	waiter.cond = cond;
+	waiter.mutex = mutex;
+
+	pthread_mutex_lock(&_lockstep_mutex);
+
+	if (!lockstep_waiter_add(&waiter)) {
+		pthread_mutex_unlock(&_lockstep_mutex);
+		return ETIMEDOUT;
+	}
+
+	pthread_mutex_unlock(&_lockstep_mutex);
+
+	pthread_cond_wait(cond, mutex);
+
+	pthread_mutex_lock(&_lockstep_mutex);
+
+	/* hrt_lockstep_set_time() needs the mutex to finish signalling */
+	const bool relock = waiter.signalling;
+
+	if (relock) {
+		pthread_mutex_unlock(mutex);
+
+		while (waiter.signalling) {
+			pthread_cond_wait(&_lockstep_cond, &_lockstep_mutex);
+		}
+	}
+
+	lockstep_waiter_remove(&waiter);
+	pthread_mutex_unlock(&_lockstep_mutex);
+
+	if (relock) {
+		pthread_mutex_lock(mutex);
+	}
+
+	return waiter.timed_out ? ETIMEDOUT : 0;
+}
+
+int	hrt_lockstep_sem_timedwait(px4_sem_t *sem, hrt_abstime deadline)
+{
+	struct lockstep_waiter waiter;
+	memset(&waiter, 0, sizeof(waiter));
+	waiter.deadline = deadline;
+	waiter.sem = sem;
+
+	pthread_mutex_lock(&_lockstep_mutex);
+
+	if (!lockstep_waiter_add(&waiter)) {
+		pthread_mutex_unlock(&_lockstep_mutex);
+		return ETIMEDOUT;
+	}
+
+	pthread_mutex_unlock(&_lockstep_mutex);
+
+	while (px4_sem_wait(sem) != 0 && errno == EINTR) {}
+
+	pthread_mutex_lock(&_lockstep_mutex);
+	lockstep_waiter_remove(&waiter);
+	pthread_mutex_unlock(&_lockstep_mutex);
+
+	return waiter.timed_out ? ETIMEDOUT : 0;
+}
+
+#ifndef __PX4_QURT
+int px4_usleep(useconds_t usec)
+{
+	if (!_lockstep_enabled) {
+		return usleep(usec);
+	}
+
+	/* nobody else posts the semaphore, so only the deadline ends the wait */
+	px4_sem_t sem;
+	px4_sem_init(&sem, 0, 0);
+	px4_sem_setprotocol(&sem, SEM_PRIO_NONE);
+
+	hrt_lockstep_sem_timedwait(&sem, hrt_absolute_time() + usec);
+
+	px4_sem_destroy(&sem);
+	return 0;
+}
+#endif
+
+static void
+hrt_call_enter(struct hrt_call *entry)
+{
+	if (hrt_callout_queue_insert(&callout_queue, entry)) {
+		/* we changed the next deadline, reschedule the timer event */
+		hrt_call_reschedule();
+	}
 }
 
 /**
@@ -420,7 +610,7 @@ hrt_call_reschedule()
 {
 	hrt_abstime	now = hrt_absolute_time();
 	hrt_abstime	delay = HRT_INTERVAL_MAX;
-	struct hrt_call	*next = (struct hrt_call *)sq_peek(&callout_queue);
+	struct hrt_call	*next = hrt_callout_queue_peek(&callout_queue);
 	hrt_abstime	deadline = now + HRT_INTERVAL_MAX;
 
 	//PX4_INFO("hrt_call_reschedule");
@@ -467,16 +657,7 @@ hrt_call_internal(struct hrt_call *entry, hrt_abstime deadline, hrt_abstime inte
 
 	//PX4_INFO("hrt_call_internal after lock");
 	/* if the entry is currently queued, remove it */
-	/* note that we are using a potentially uninitialised
-	   entry->link here, but it is safe as sq_rem() doesn't
-	   dereference the passed node unless it is found in the
-	   list. So we potentially waste a bit of time searching the
-	   queue for the uninitialised entry->link but we don't do
-	   anything actually unsafe.
-	*/
-	if (entry->deadline != 0) {
-		sq_rem(&entry->link, &callout_queue);
-	}
+	hrt_callout_queue_remove(&callout_queue, entry);
 
 #if 1
 
@@ -491,6 +672,9 @@ hrt_call_internal(struct hrt_call *entry, hrt_abstime deadline, hrt_abstime inte
 	entry->period = interval;
 	entry->callout = callout;
 	entry->arg = arg;
+#ifdef PX4_MAX_VEHICLE_INSTANCES
+	entry->vehicle_instance = px4_get_vehicle_instance();
+#endif
 
 	hrt_call_enter(entry);
 	hrt_unlock();
@@ -554,19 +738,12 @@ hrt_call_invoke(void)
 		/* get the current time */
 		hrt_abstime now = hrt_absolute_time();
 
-		call = (struct hrt_call *)sq_peek(&callout_queue);
+		call = hrt_callout_queue_pop_expired(&callout_queue, now);
 
 		if (call == NULL) {
 			break;
 		}
 
-		if (call->deadline > now) {
-			break;
-		}
-
-		sq_rem(&call->link, &callout_queue);
-		//PX4_INFO("call pop");
-
 		/* save the intended deadline for periodic calls */
 		deadline = call->deadline;
 
@@ -579,13 +756,17 @@ hrt_call_invoke(void)
 			hrt_unlock();
 
 			//PX4_INFO("call %p: %p(%p)", call, call->callout, call->arg);
+#ifdef PX4_MAX_VEHICLE_INSTANCES
+			px4_set_vehicle_instance(call->vehicle_instance);
+#endif
 			call->callout(call->arg);
 
 			hrt_lock();
 		}
 
-		/* if the callout has a non-zero period, it has to be re-entered */
-		if (call->period != 0) {
+		/* if the callout has a non-zero period, it has to be re-entered (unless
+		 * it already rescheduled itself while the lock was released) */
+		if (call->period != 0 && call->queued != HRT_CALL_QUEUED) {
 			// re-check call->deadline to allow for
 			// callouts to re-schedule themselves
 			// using hrt_call_delay()
@@ -51,6 +51,7 @@
 #include <string.h>
 #include <pthread.h>
 #include <limits.h>
+#include <inttypes.h>
 
 #include <sys/stat.h>
 #include <sys/types.h>
@@ -77,14 +78,62 @@ struct task_entry {
 
 static task_entry taskmap[PX4_MAX_TASKS] = {};
 
+/* Scheduling configuration of a task by name, see px4_task_set_config() */
+struct task_config {
+	std::string name;
+	int policy;
+	int priority;
+	uint64_t cpu_mask;
+	bool isused;
+	task_config() : policy(-1), priority(-1), cpu_mask(0), isused(false) {}
+};
+
+static task_config task_configs[PX4_MAX_TASKS] = {};
+
+/* Vehicle instance of the current thread, see px4_set_vehicle_instance() */
+static __thread int _vehicle_instance = 0;
+
 typedef struct {
 	px4_main_t entry;
 	char name[16]; //pthread_setname_np is restricted to 16 chars
+	uint64_t cpu_mask;
+	int vehicle_instance;
 	int argc;
 	char *argv[];
 	// strings are allocated after the struct data
 } pthdata_t;
 
+/* Restrict a thread to the CPUs in cpu_mask (bit n = CPU n) */
+static int set_thread_affinity(pthread_t thread, uint64_t cpu_mask)
+{
+#ifdef __PX4_LINUX
+	cpu_set_t set;
+	CPU_ZERO(&set);
+
+	for (unsigned cpu = 0; cpu < 64; cpu++) {
+		if (cpu_mask & (1ULL << cpu)) {
+			CPU_SET(cpu, &set);
+		}
+	}
+
+	return pthread_setaffinity_np(thread, sizeof(set), &set);
+#else
+	return ENOTSUP;
+#endif
+}
+
+/* Find the configuration of a task (with task_mutex held) */
+static task_config *find_task_config(const char *name)
+{
+	for (int i = 0; i < PX4_MAX_TASKS; ++i) {
+		if (task_configs[i].isused && task_configs[i].name == name) {
+			return &task_configs[i];
+		}
+	}
+
+	return nullptr;
+}
+
 static void *entry_adapter(void *ptr)
 {
 	pthdata_t *data = (pthdata_t *) ptr;
@@ -102,6 +151,18 @@ static void *entry_adapter(void *ptr)
 		PX4_ERR("px4_task_spawn_cmd: failed to set name of thread %d %d\n", rv, errno);
 	}
 
+	// the thread pins itself, so that it never runs on another CPU
+	if (data->cpu_mask != 0) {
+		rv = set_thread_affinity(pthread_self(), data->cpu_mask);
+
+		if (rv) {
+			PX4_ERR("px4_task_spawn_cmd: failed to set CPU affinity of %s (%d)", data->name, rv);
+		}
+	}
+
+	// the task inherits the vehicle instance of the thread that spawned it
+	_vehicle_instance = data->vehicle_instance;
+
 	data->entry(data->argc, data->argv);
 	free(ptr);
 	PX4_DEBUG("Before px4_task_exit");
@@ -132,6 +193,30 @@ px4_task_t px4_task_spawn_cmd(const char *name, int scheduler, int priority, int
 
 	pthread_attr_t attr;
 	struct sched_param param = {};
+	uint64_t cpu_mask = 0;
+
+	// a configured scheduling overrides the one of the caller
+	pthread_mutex_lock(&task_mutex);
+	const task_config *config = find_task_config(name);
+
+	if (config) {
+		if (config->policy >= 0) {
+			scheduler = config->policy;
+		}
+
+		if (config->priority >= 0) {
+			priority = config->priority;
+		}
+
+		cpu_mask = config->cpu_mask;
+	}
+
+	pthread_mutex_unlock(&task_mutex);
+
+	// SCHED_OTHER does not have priorities
+	if (scheduler == SCHED_OTHER) {
+		priority = 0;
+	}
 
 	// Calculate argc
 	while (p != (char *)nullptr) {
@@ -155,6 +240,8 @@ px4_task_t px4_task_spawn_cmd(const char *name, int scheduler, int priority, int
 	strncpy(taskdata->name, name, 16);
 	taskdata->name[15] = 0;
 	taskdata->entry = entry;
+	taskdata->cpu_mask = cpu_mask;
+	taskdata->vehicle_instance = _vehicle_instance;
 	taskdata->argc = argc;
 
 	for (i = 0; i < argc; i++) {
@@ -373,6 +460,104 @@ void px4_show_tasks()
 
 }
 
+int px4_task_set_config(const char *name, int policy, int priority, uint64_t cpu_mask)
+{
+	int ret = 0;
+
+	pthread_mutex_lock(&task_mutex);
+
+	task_config *config = find_task_config(name);
+
+	for (int i = 0; !config && i < PX4_MAX_TASKS; ++i) {
+		if (!task_configs[i].isused) {
+			config = &task_configs[i];
+			config->name = name;
+			config->isused = true;
+		}
+	}
+
+	if (!config) {
+		pthread_mutex_unlock(&task_mutex);
+		return -ENOSPC;
+	}
+
+	config->policy = policy;
+	config->priority = priority;
+	config->cpu_mask = cpu_mask;
+
+	// apply it to the running instances as well
+	for (int i = 0; i < PX4_MAX_TASKS; ++i) {
+		if (!taskmap[i].isused || taskmap[i].name != name) {
+			continue;
+		}
+
+		int rv = 0;
+
+		if (policy >= 0 || priority >= 0) {
+			int curr_policy;
+			struct sched_param param = {};
+			pthread_getschedparam(taskmap[i].pid, &curr_policy, &param);
+
+			if (policy >= 0) {
+				curr_policy = policy;
+			}
+
+			if (priority >= 0) {
+				param.sched_priority = priority;
+			}
+
+			if (curr_policy == SCHED_OTHER) {
+				param.sched_priority = 0;
+			}
+
+			rv = pthread_setschedparam(taskmap[i].pid, curr_policy, &param);
+		}
+
+		if (rv == 0 && cpu_mask != 0) {
+			rv = set_thread_affinity(taskmap[i].pid, cpu_mask);
+		}
+
+		if (rv != 0) {
+			PX4_ERR("failed to configure running task %s (%d)", name, rv);
+			ret = -rv;
+		}
+	}
+
+	pthread_mutex_unlock(&task_mutex);
+
+	return ret;
+}
+
+void px4_show_task_configs()
+{
+	pthread_mutex_lock(&task_mutex);
+
+	for (int i = 0; i < PX4_MAX_TASKS; ++i) {
+		const task_config &config = task_configs[i];
+
+		if (!config.isused) {
+			continue;
+		}
+
+		const char *policy = "default";
+
+		if (config.policy == SCHED_FIFO) {
+			policy = "fifo";
+
+		} else if (config.policy == SCHED_RR) {
+			policy = "rr";
+
+		} else if (config.policy == SCHED_OTHER) {
+			policy = "other";
+		}
+
+		PX4_INFO("   %-16s policy: %-7s priority: %3i CPU mask: 0x%" PRIx64, config.name.c_str(), policy,
+			 config.priority, config.cpu_mask);
+	}
+
+	pthread_mutex_unlock(&task_mutex);
+}
+
 bool px4_task_is_running(const char *taskname)
 {
 	int idx;
@@ -444,3 +629,17 @@ int px4_prctl(int option, const char *arg2, px4_task_t pid)
 	return rv;
 }
 
+int px4_set_vehicle_instance(int instance)
+{
+	if (instance < 0 || instance >= PX4_MAX_VEHICLE_INSTANCES) {
+		return -EINVAL;
+	}
+
+	_vehicle_instance = instance;
+	return 0;
+}
+
+int px4_get_vehicle_instance(void)
+{
+	return _vehicle_instance;
+}
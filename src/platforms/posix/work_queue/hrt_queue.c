@@ -51,6 +51,7 @@
 #include <px4_workqueue.h>
 #include <px4_posix.h>
 #include "hrt_work.h"
+#include "work_lock.h"
 
 /****************************************************************************
  * Pre-processor Definitions
@@ -113,6 +114,9 @@ int hrt_work_queue(struct work_s *work, worker_t worker, void *arg, uint32_t del
 	work->worker = worker;           /* Work callback */
 	work->arg    = arg;              /* Callback argument */
 	work->delay  = delay;            /* Delay until work performed */
+#ifdef PX4_MAX_VEHICLE_INSTANCES
+	work->vehicle_instance = px4_get_vehicle_instance();
+#endif
 
 	/* Now, time-tag that entry and put it in the work queue.  This must be
 	 * done with interrupts disabled.  This permits this function to be called
@@ -123,15 +127,9 @@ int hrt_work_queue(struct work_s *work, worker_t worker, void *arg, uint32_t del
 	work->qtime  = hrt_absolute_time(); /* Time work queued */
 	//PX4_INFO("hrt work_queue adding work delay=%u time=%lu", delay, work->qtime);
 
-	dq_addlast((dq_entry_t *)work, &wqueue->q);
-
-	if (px4_getpid() != wqueue->pid) { /* only need to wake up if called from a different thread */
-#ifdef __PX4_QURT
-		px4_task_kill(wqueue->pid, SIGALRM);      /* Wake up the worker thread */
-#else
-		//wqueue->pid == own task? -> don't signal
-		px4_task_kill(wqueue->pid, SIGCONT);      /* Wake up the worker thread */
-#endif
+	/* The worker thread waits for the first work in the queue, wake it up if that changes */
+	if (work_insert(&wqueue->q, work, 1)) {
+		pthread_cond_signal(&_hrt_work_cond);
 	}
 
 	hrt_work_unlock();
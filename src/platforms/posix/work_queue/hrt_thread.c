@@ -49,7 +49,10 @@
 #include <queue.h>
 #include <px4_workqueue.h>
 #include <drivers/drv_hrt.h>
+#include <systemlib/trace.h>
+#include <systemlib/work_queue_stats.h>
 #include "hrt_work.h"
+#include "work_lock.h"
 
 /****************************************************************************
  * Pre-processor Definitions
@@ -69,33 +72,14 @@ struct wqueue_s g_hrt_work;
 /****************************************************************************
  * Private Variables
  ****************************************************************************/
-px4_sem_t _hrt_work_lock;
+pthread_mutex_t _hrt_work_lock;
+pthread_cond_t _hrt_work_cond;
 
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
 static void hrt_work_process(void);
 
-static void _sighandler(int sig_num);
-
-/****************************************************************************
- * Name: _sighandler
- *
- * Description:
- *   This is the handler for the signal to wake the queue processing thread
- *
- * Input parameters:
- *   sig_num - the received signal
- *
- * Returned Value:
- *   None
- *
- ****************************************************************************/
-static void _sighandler(int sig_num)
-{
-	PX4_DEBUG("RECEIVED SIGNAL %d", sig_num);
-}
-
 /****************************************************************************
  * Name: work_process
  *
@@ -116,9 +100,6 @@ static void hrt_work_process()
 	volatile struct work_s *work;
 	worker_t  worker;
 	void *arg;
-	uint64_t elapsed;
-	uint32_t remaining;
-	uint32_t next;
 
 	// set the threads name
 #ifdef __PX4_DARWIN
@@ -128,96 +109,70 @@ static void hrt_work_process()
 	//rv = pthread_setname_np(pthread_self(), "HRT");
 #endif
 
-	/* Then process queued work.  We need to keep interrupts disabled while
-	 * we process items in the work list.
-	 */
-
-	/* Default to sleeping for 1 sec */
-	next  = 1000000;
-
 	hrt_work_lock();
 
-	work  = (struct work_s *)wqueue->q.head;
-
-	while (work) {
-		/* Is this work ready?  It is ready if there is no delay or if
-		 * the delay has elapsed. qtime is the time that the work was added
-		 * to the work queue.  It will always be greater than or equal to
-		 * zero.  Therefore a delay of zero will always execute immediately.
-		 */
+	/* The work list is ordered by deadline (see hrt_work_queue()), so only
+	 * the first work can be ready.  It is ready if there is no delay or if
+	 * the delay (in usec) has elapsed since qtime, the time that the work was
+	 * added to the work queue.
+	 */
 
-		elapsed = hrt_absolute_time() - work->qtime;
+	work  = (struct work_s *)wqueue->q.head;
 
-		//PX4_INFO("hrt work_process: in usec elapsed=%lu delay=%u work=%p", elapsed, work->delay, work);
-		if (elapsed >= work->delay) {
-			/* Remove the ready-to-execute work from the list */
+	hrt_abstime now = hrt_absolute_time();
 
-			(void)dq_rem((struct dq_entry_s *) & (work->dq), &(wqueue->q));
-			//PX4_INFO("Dequeued work=%p", work);
+	if (work && work_deadline(work, 1) <= now) {
+		uint32_t lateness = now - work_deadline(work, 1);
 
-			/* Extract the work description from the entry (in case the work
-			 * instance by the re-used after it has been de-queued).
-			 */
+		/* Remove the ready-to-execute work from the list */
 
-			worker = work->worker;
-			arg    = work->arg;
+		(void)dq_rem((struct dq_entry_s *) & (work->dq), &(wqueue->q));
+		//PX4_INFO("Dequeued work=%p", work);
 
-			/* Mark the work as no longer being queued */
+		/* Extract the work description from the entry (in case the work
+		 * instance by the re-used after it has been de-queued).
+		 */
 
-			work->worker = NULL;
+		worker = work->worker;
+		arg    = work->arg;
 
-			/* Do the work.  Re-enable interrupts while the work is being
-			 * performed... we don't have any idea how long that will take!
-			 */
+#ifdef PX4_MAX_VEHICLE_INSTANCES
+		/* the work queue threads are shared by all vehicle instances */
+		px4_set_vehicle_instance(work->vehicle_instance);
+#endif
 
-			hrt_work_unlock();
+		/* Mark the work as no longer being queued */
 
-			if (!worker) {
-				PX4_ERR("MESSED UP: worker = 0");
-				PX4_BACKTRACE();
+		work->worker = NULL;
 
-			} else {
-				worker(arg);
-			}
+		/* Do the work without holding the lock, we don't have any idea
+		 * how long that will take!
+		 */
 
-			/* Now, unfortunately, since we re-enabled interrupts we don't
-			 * know the state of the work list and we will have to start
-			 * back at the head of the list.
-			 */
+		hrt_work_unlock();
 
-			hrt_work_lock();
-			work  = (struct work_s *)wqueue->q.head;
+		if (!worker) {
+			PX4_ERR("MESSED UP: worker = 0");
+			PX4_BACKTRACE();
 
 		} else {
-			/* This one is not ready.. will it be ready before the next
-			 * scheduled wakeup interval?
-			 */
-
-			/* Here: elapsed < work->delay */
-			remaining = work->delay - elapsed;
-
-			//PX4_INFO("remaining=%u delay=%u elapsed=%lu", remaining, work->delay, elapsed);
-			if (remaining < next) {
-				/* Yes.. Then schedule to wake up when the work is ready */
-
-				next = remaining;
-			}
-
-			/* Then try the next in the list. */
-
-			work = (struct work_s *)work->dq.flink;
-			//PX4_INFO("next %u work %p", next, work);
+			TRACE_EVENT(TRACE_EVENT_WORK_BEGIN, 0, worker);
+			uint32_t begin = work_queue_stats_begin();
+			worker(arg);
+			work_queue_stats_end(WORK_QUEUE_STATS_HRTWORK, worker, begin, lateness);
+			TRACE_EVENT(TRACE_EVENT_WORK_END, 0, worker);
 		}
+
+		return;
 	}
 
-	/* Wait awhile to check the work list.  We will wait here until either
-	 * the time elapses or until we are awakened by a signal.
+	/* Wait until the first work is due, or until hrt_work_queue() signals
+	 * that work with an earlier deadline was queued.  An empty queue
+	 * waits without timeout.
 	 */
-	hrt_work_unlock();
+	work_cond_wait(&_hrt_work_cond, &_hrt_work_lock, work ? work_deadline(work, 1) : 0);
 
-	/* might sleep less if a signal received and new item was queued */
-	//PX4_INFO("Sleeping for %u usec", next);
-	usleep(next);
+	hrt_work_unlock();
 }
 
 /****************************************************************************
@@ -273,7 +228,8 @@ static int work_hrtthread(int argc, char *argv[])
 
 void hrt_work_queue_init(void)
 {
-	px4_sem_init(&_hrt_work_lock, 0, 1);
+	pthread_mutex_init(&_hrt_work_lock, NULL);
+	work_cond_init(&_hrt_work_cond);
 	memset(&g_hrt_work, 0, sizeof(g_hrt_work));
 
 	// Create high priority worker thread
@@ -284,11 +240,5 @@ void hrt_work_queue_init(void)
 					    work_hrtthread,
 					    (char *const *)NULL);
 
-
-#ifdef __PX4_QURT
-	signal(SIGALRM, _sighandler);
-#else
-	signal(SIGCONT, _sighandler);
-#endif
 }
 
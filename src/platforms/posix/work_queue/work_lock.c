@@ -32,18 +32,100 @@
  ****************************************************************************/
 #include <px4_log.h>
 #include <px4_posix.h>
+#include <px4_time.h>
 #include <stdio.h>
+#include <drivers/drv_hrt.h>
 #include "work_lock.h"
 
+/* Darwin and QuRT cannot wait on a condition with CLOCK_MONOTONIC */
+#if defined(__PX4_DARWIN) || defined(__PX4_QURT)
+#define WORK_COND_CLOCK CLOCK_REALTIME
+#else
+#define WORK_COND_CLOCK CLOCK_MONOTONIC
+#define WORK_COND_SET_CLOCK
+#endif
 
-extern px4_sem_t _work_lock[];
+extern pthread_mutex_t _work_lock[];
+extern pthread_cond_t _work_cond[];
 
 void work_lock(int id)
 {
-	px4_sem_wait(&_work_lock[id]);
+	pthread_mutex_lock(&_work_lock[id]);
 }
 
 void work_unlock(int id)
 {
-	px4_sem_post(&_work_lock[id]);
+	pthread_mutex_unlock(&_work_lock[id]);
+}
+
+void work_signal(int id)
+{
+	pthread_cond_signal(&_work_cond[id]);
+}
+
+void work_wait(int id, uint64_t deadline)
+{
+	work_cond_wait(&_work_cond[id], &_work_lock[id], deadline);
+}
+
+void work_cond_init(pthread_cond_t *cond)
+{
+#ifdef WORK_COND_SET_CLOCK
+	pthread_condattr_t attr;
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, WORK_COND_CLOCK);
+	pthread_cond_init(cond, &attr);
+	pthread_condattr_destroy(&attr);
+#else
+	pthread_cond_init(cond, NULL);
+#endif
+}
+
+void work_cond_wait(pthread_cond_t *cond, pthread_mutex_t *mutex, uint64_t deadline)
+{
+	if (deadline == 0) {
+		pthread_cond_wait(cond, mutex);
+		return;
+	}
+
+	const uint64_t now = hrt_absolute_time();
+
+	if (deadline <= now) {
+		return;
+	}
+
+	if (hrt_lockstep_enabled()) {
+		hrt_lockstep_cond_timedwait(cond, mutex, deadline);
+		return;
+	}
+
+	/* the deadline is in hrt time, the wait needs an absolute time of the condition clock */
+	struct timespec abstime;
+	px4_clock_gettime(WORK_COND_CLOCK, &abstime);
+	const uint64_t nsecs = abstime.tv_nsec + (deadline - now) * 1000;
+	abstime.tv_sec += nsecs / 1000000000;
+	abstime.tv_nsec = nsecs % 1000000000;
+
+	pthread_cond_timedwait(cond, mutex, &abstime);
+}
+
+bool work_insert(dq_queue_t *q, struct work_s *work, uint32_t usec_per_delay)
+{
+	const uint64_t deadline = work_deadline(work, usec_per_delay);
+
+	/* Most work is periodic and due after the work that is already queued, so search from the end.
+	 * Work with the same deadline is kept in the order it was queued. */
+	dq_entry_t *prev = q->tail;
+
+	while (prev && work_deadline((struct work_s *)prev, usec_per_delay) > deadline) {
+		prev = prev->blink;
+	}
+
+	if (prev) {
+		dq_addafter(prev, (dq_entry_t *)work, q);
+		return false;
+	}
+
+	dq_addfirst((dq_entry_t *)work, q);
+	return true;
 }
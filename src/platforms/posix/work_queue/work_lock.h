@@ -37,7 +37,40 @@
 
 //#pragma once
 
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <queue.h>
+#include <px4_workqueue.h>
+
+__BEGIN_DECLS
+
 void work_lock(int id);
 void work_unlock(int id);
 
+/* Wake up the worker thread of a queue (with the lock held) */
+void work_signal(int id);
+
+/* Wait for work_signal() or the deadline (with the lock held), see work_cond_wait() */
+void work_wait(int id, uint64_t deadline);
+
+/* Initialize a condition variable for work_cond_wait() */
+void work_cond_init(pthread_cond_t *cond);
+
+/* Wait for the condition to be signalled or until the deadline (hrt time, 0 waits without timeout).
+ * The mutex must be held. */
+void work_cond_wait(pthread_cond_t *cond, pthread_mutex_t *mutex, uint64_t deadline);
+
+/* Time when queued work is due, the delay is given in units of usec_per_delay */
+static inline uint64_t work_deadline(const volatile struct work_s *work, uint32_t usec_per_delay)
+{
+	return work->qtime + (uint64_t)work->delay * usec_per_delay;
+}
+
+/* Insert work into a queue that is ordered by deadline (with the lock held).
+ * Returns true if it is the first work in the queue, i.e. if the worker thread needs to be woken up. */
+bool work_insert(dq_queue_t *q, struct work_s *work, uint32_t usec_per_delay);
+
+__END_DECLS
+
 #endif // _work_lock_h_
@@ -47,6 +47,7 @@
 #include <queue.h>
 #include <stdio.h>
 #include <semaphore.h>
+#include <drivers/drv_hrt.h>
 #include "work_lock.h"
 
 #ifdef CONFIG_SCHED_WORKQUEUE
@@ -115,6 +116,9 @@ int work_queue(int qid, struct work_s *work, worker_t worker, void *arg, uint32_
 	work->worker = worker;           /* Work callback */
 	work->arg    = arg;              /* Callback argument */
 	work->delay  = delay;            /* Delay until work performed */
+#ifdef PX4_MAX_VEHICLE_INSTANCES
+	work->vehicle_instance = px4_get_vehicle_instance();
+#endif
 
 	/* Now, time-tag that entry and put it in the work queue.  This must be
 	 * done with interrupts disabled.  This permits this function to be called
@@ -122,14 +126,12 @@ int work_queue(int qid, struct work_s *work, worker_t worker, void *arg, uint32_
 	 */
 
 	work_lock(qid);
-	work->qtime  = clock_systimer(); /* Time work queued */
+	work->qtime  = hrt_absolute_time(); /* Time work queued */
 
-	dq_addlast((dq_entry_t *)work, &wqueue->q);
-#ifdef __PX4_QURT
-	px4_task_kill(wqueue->pid, SIGALRM);      /* Wake up the worker thread */
-#else
-	px4_task_kill(wqueue->pid, SIGCONT);      /* Wake up the worker thread */
-#endif
+	/* The worker thread waits for the first work in the queue, wake it up if that changes */
+	if (work_insert(&wqueue->q, work, USEC_PER_TICK)) {
+		work_signal(qid);
+	}
 
 	work_unlock(qid);
 	return PX4_OK;
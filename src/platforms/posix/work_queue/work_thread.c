@@ -49,6 +49,8 @@
 #include <queue.h>
 #include <pthread.h>
 #include <drivers/drv_hrt.h>
+#include <systemlib/trace.h>
+#include <systemlib/work_queue_stats.h>
 #include "work_lock.h"
 
 #ifdef CONFIG_SCHED_WORKQUEUE
@@ -71,7 +73,8 @@ struct wqueue_s g_work[NWORKERS];
 /****************************************************************************
  * Private Variables
  ****************************************************************************/
-px4_sem_t _work_lock[NWORKERS];
+pthread_mutex_t _work_lock[NWORKERS];
+pthread_cond_t _work_cond[NWORKERS];
 
 /****************************************************************************
  * Private Functions
@@ -96,93 +99,69 @@ static void work_process(struct wqueue_s *wqueue, int lock_id)
 	volatile struct work_s *work;
 	worker_t  worker;
 	void *arg;
-	uint64_t elapsed;
-	uint32_t remaining;
-	uint32_t next;
-
-	/* Then process queued work.  We need to keep interrupts disabled while
-	 * we process items in the work list.
-	 */
-
-	next  = CONFIG_SCHED_WORKPERIOD;
 
 	work_lock(lock_id);
 
-	work  = (struct work_s *)wqueue->q.head;
-
-	while (work) {
-		/* Is this work ready?  It is ready if there is no delay or if
-		 * the delay has elapsed. qtime is the time that the work was added
-		 * to the work queue.  It will always be greater than or equal to
-		 * zero.  Therefore a delay of zero will always execute immediately.
-		 */
+	/* The work list is ordered by deadline (see work_queue()), so only the
+	 * first work can be ready.  It is ready if there is no delay or if
+	 * the delay has elapsed since qtime, the time that the work was added
+	 * to the work queue.
+	 */
 
-		elapsed = USEC2TICK(clock_systimer() - work->qtime);
+	work  = (struct work_s *)wqueue->q.head;
 
-		//printf("work_process: in ticks elapsed=%lu delay=%u\n", elapsed, work->delay);
-		if (elapsed >= work->delay) {
-			/* Remove the ready-to-execute work from the list */
+	hrt_abstime now = hrt_absolute_time();
 
-			(void)dq_rem((struct dq_entry_s *)work, &wqueue->q);
+	if (work && work_deadline(work, USEC_PER_TICK) <= now) {
+		uint32_t lateness = now - work_deadline(work, USEC_PER_TICK);
 
-			/* Extract the work description from the entry (in case the work
-			 * instance by the re-used after it has been de-queued).
-			 */
+		/* Remove the ready-to-execute work from the list */
 
-			worker = work->worker;
-			arg    = work->arg;
+		(void)dq_rem((struct dq_entry_s *)work, &wqueue->q);
 
-			/* Mark the work as no longer being queued */
+		/* Extract the work description from the entry (in case the work
+		 * instance by the re-used after it has been de-queued).
+		 */
 
-			work->worker = NULL;
+		worker = work->worker;
+		arg    = work->arg;
 
-			/* Do the work.  Re-enable interrupts while the work is being
-			 * performed... we don't have any idea how long that will take!
-			 */
+#ifdef PX4_MAX_VEHICLE_INSTANCES
+		/* the work queue threads are shared by all vehicle instances */
+		px4_set_vehicle_instance(work->vehicle_instance);
+#endif
 
-			work_unlock(lock_id);
+		/* Mark the work as no longer being queued */
 
-			if (!worker) {
-				PX4_WARN("MESSED UP: worker = 0\n");
+		work->worker = NULL;
 
-			} else {
-				worker(arg);
-			}
+		/* Do the work without holding the lock, we don't have any idea
+		 * how long that will take!
+		 */
 
-			/* Now, unfortunately, since we re-enabled interrupts we don't
-			 * know the state of the work list and we will have to start
-			 * back at the head of the list.
-			 */
+		work_unlock(lock_id);
 
-			work_lock(lock_id);
-			work  = (struct work_s *)wqueue->q.head;
+		if (!worker) {
+			PX4_WARN("MESSED UP: worker = 0\n");
 
 		} else {
-			/* This one is not ready.. will it be ready before the next
-			 * scheduled wakeup interval?
-			 */
-
-			/* Here: elapsed < work->delay */
-			remaining = USEC_PER_TICK * (work->delay - elapsed);
-
-			if (remaining < next) {
-				/* Yes.. Then schedule to wake up when the work is ready */
-
-				next = remaining;
-			}
-
-			/* Then try the next in the list. */
-
-			work = (struct work_s *)work->dq.flink;
+			TRACE_EVENT(TRACE_EVENT_WORK_BEGIN, 0, worker);
+			uint32_t begin = work_queue_stats_begin();
+			worker(arg);
+			work_queue_stats_end(lock_id, worker, begin, lateness);
+			TRACE_EVENT(TRACE_EVENT_WORK_END, 0, worker);
 		}
+
+		return;
 	}
 
-	/* Wait awhile to check the work list.  We will wait here until either
-	 * the time elapses or until we are awakened by a signal.
+	/* Wait until the first work is due, or until work_queue() signals
+	 * that work with an earlier deadline was queued.  An empty queue
+	 * waits without timeout.
 	 */
-	work_unlock(lock_id);
+	work_wait(lock_id, work ? work_deadline(work, USEC_PER_TICK) : 0);
 
-	usleep(next);
+	work_unlock(lock_id);
 }
 
 /****************************************************************************
@@ -190,10 +169,13 @@ static void work_process(struct wqueue_s *wqueue, int lock_id)
  ****************************************************************************/
 void work_queues_init(void)
 {
-	px4_sem_init(&_work_lock[HPWORK], 0, 1);
-	px4_sem_init(&_work_lock[LPWORK], 0, 1);
+	pthread_mutex_init(&_work_lock[HPWORK], NULL);
+	pthread_mutex_init(&_work_lock[LPWORK], NULL);
+	work_cond_init(&_work_cond[HPWORK]);
+	work_cond_init(&_work_cond[LPWORK]);
 #ifdef CONFIG_SCHED_USRWORK
-	px4_sem_init(&_work_lock[USRWORK], 0, 1);
+	pthread_mutex_init(&_work_lock[USRWORK], NULL);
+	work_cond_init(&_work_cond[USRWORK]);
 #endif
 
 	// Create high priority worker thread
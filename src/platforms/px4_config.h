@@ -49,3 +49,5 @@
 #elif defined (__PX4_POSIX)
 # include <board_config.h>
 #endif
+
+#include "px4_fast_memory.h"
@@ -0,0 +1,56 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2017 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file px4_fast_memory.h
+ * Placement of hot functions and data into the tightly coupled memory.
+ *
+ * Boards whose linker script provides an .itcm output section (loaded from flash
+ * and copied to ITCM RAM by the board init code) define BOARD_HAS_ITCM_RAM in
+ * board_config.h. Everywhere else the attributes are empty and the code stays
+ * where it was.
+ *
+ * ITCM RAM is small (16 KiB on the STM32F7), so only mark functions that run on
+ * every control loop iteration. Use 'make <target> fast_memory' to list what
+ * ended up there.
+ */
+
+#pragma once
+
+#if defined(__PX4_NUTTX) && defined(BOARD_HAS_ITCM_RAM)
+#  define PX4_FAST_CODE __attribute__((section(".itcm_text")))
+#  define PX4_FAST_DATA __attribute__((section(".itcm_data")))
+#else
+#  define PX4_FAST_CODE
+#  define PX4_FAST_DATA
+#endif
@@ -354,12 +354,13 @@ protected:
 
 	static constexpr const int task_id_is_work_queue = -2; ///< special value if task runs on the work queue
 
+	/** lock access to _object and _task_id (also taken by the commands) */
+	static void lock_module() { pthread_mutex_lock(&px4_modules_mutex); }
+	static void unlock_module() { pthread_mutex_unlock(&px4_modules_mutex); }
+
 private:
 
 	volatile bool _task_should_exit = false;
-
-	static void lock_module() { pthread_mutex_lock(&px4_modules_mutex); }
-	static void unlock_module() { pthread_mutex_unlock(&px4_modules_mutex); }
 };
 
 template<class T>
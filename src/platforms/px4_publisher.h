@@ -40,6 +40,7 @@
 #if defined(__PX4_ROS)
 /* includes when building for ros */
 #include "ros/ros.h"
+#include <boost/make_shared.hpp>
 #else
 /* includes when building for NuttX */
 #include <uORB/Publication.hpp>
@@ -93,14 +94,18 @@ public:
 	~PublisherROS() {}
 
 	/** Publishes msg
+	 * The message is published as shared pointer: roscpp passes it to subscribers in the same process
+	 * without serialization and only serializes it for subscribers in other processes.
 	 * @param msg	    the message which is published to the topic
 	 */
 	int publish(const T &msg)
 	{
-		_ros_pub.publish(msg.data());
+		_ros_pub.publish(boost::make_shared<RosMessage>(msg.data()));
 		return 0;
 	}
 protected:
+	typedef typename std::remove_reference < decltype(((T *)nullptr)->data()) >::type RosMessage;	/**< native ROS message type */
+
 	static const uint32_t kQueueSizeDefault = 1;		/**< Size of queue for ROS */
 	ros::Publisher _ros_pub;	/**< Handle to the ros publisher */
 };
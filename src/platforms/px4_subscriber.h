@@ -134,6 +134,7 @@ protected:
 	/**
 	 * Called on topic update, saves the current message and then calls the provided callback function
 	 * needs to use the native type as it is called by ROS
+	 * Messages of publishers in the same process arrive without serialization (see PublisherROS::publish()).
 	 */
 	void callback(const typename std::remove_reference < decltype(((T *)nullptr)->data()) >::type &msg)
 	{
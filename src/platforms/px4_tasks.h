@@ -43,6 +43,7 @@
 #pragma once
 
 #include <stdbool.h>
+#include <stdint.h>
 
 #ifdef __PX4_ROS
 
@@ -184,6 +185,41 @@ __EXPORT bool px4_task_is_running(const char *taskname);
 __EXPORT int px4_prctl(int option, const char *arg2, px4_task_t pid);
 #endif
 
+#if defined(__PX4_POSIX) && !defined(__PX4_QURT)
+/**
+ * Configure the scheduling of a task by its name.
+ *
+ * The configuration overrides the arguments of px4_task_spawn_cmd() when the
+ * task is started, and is applied to it right away if it is running already.
+ *
+ * @param policy SCHED_FIFO, SCHED_RR or SCHED_OTHER, -1 to keep the one of the task
+ * @param priority scheduling priority, -1 to keep the one of the task
+ * @param cpu_mask CPUs the task may run on (bit n = CPU n), 0 for no restriction (Linux only)
+ * @return 0 on success, negative error otherwise
+ */
+__EXPORT int px4_task_set_config(const char *name, int policy, int priority, uint64_t cpu_mask);
+
+/** Show the task configurations set with px4_task_set_config() **/
+__EXPORT void px4_show_task_configs(void);
+
+/** Maximum number of vehicle instances in one process, see px4_set_vehicle_instance() */
+#define PX4_MAX_VEHICLE_INSTANCES 64
+
+/**
+ * Select the vehicle instance of the calling thread.
+ *
+ * Each vehicle instance has its own uORB namespace. Tasks spawned by the thread,
+ * and work queue items and HRT callouts it schedules run in the same instance.
+ *
+ * @param instance 0 (default) to PX4_MAX_VEHICLE_INSTANCES - 1
+ * @return 0 on success, -EINVAL for an invalid instance
+ */
+__EXPORT int px4_set_vehicle_instance(int instance);
+
+/** Return the vehicle instance of the calling thread */
+__EXPORT int px4_get_vehicle_instance(void);
+#endif
+
 /** return the name of the current task */
 __EXPORT const char *px4_get_taskname(void);
 
@@ -34,3 +34,18 @@ __EXPORT unsigned int sleep(unsigned int sec);
 
 __END_DECLS
 #endif
+
+#if defined(__PX4_POSIX) && !defined(__PX4_QURT)
+
+#include <unistd.h>
+
+__BEGIN_DECLS
+
+/* usleep() in HRT time, it follows the simulator in lockstep mode (see hrt_lockstep_enable()) */
+__EXPORT int px4_usleep(useconds_t usec);
+
+__END_DECLS
+
+#else
+#define px4_usleep usleep
+#endif
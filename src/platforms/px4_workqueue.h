@@ -74,6 +74,7 @@ struct work_s {
 	void *arg;             /* Callback argument */
 	uint64_t  qtime;       /* Time work queued */
 	uint32_t  delay;       /* Delay until work performed */
+	int vehicle_instance;  /* Vehicle instance the work runs in */
 };
 
 /****************************************************************************
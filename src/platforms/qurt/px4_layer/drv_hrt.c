@@ -40,6 +40,7 @@
 #include <px4_defines.h>
 #include <px4_workqueue.h>
 #include <drivers/drv_hrt.h>
+#include <drivers/drv_hrt_callout_queue.h>
 #include <semaphore.h>
 #include <time.h>
 #include <sys/time.h>
@@ -47,7 +48,7 @@
 #include <string.h>
 #include <stdio.h>
 
-static struct sq_queue_s	callout_queue;
+static struct hrt_callout_queue	callout_queue;
 
 /* latency histogram */
 #define LATENCY_BUCKET_COUNT 8
@@ -170,7 +171,7 @@ bool	hrt_called(struct hrt_call *entry)
 void	hrt_cancel(struct hrt_call *entry)
 {
 	hrt_lock();
-	sq_rem(&entry->link, &callout_queue);
+	hrt_callout_queue_remove(&callout_queue, entry);
 	entry->deadline = 0;
 
 	/* if this is a periodic call being removed by the callout, prevent it from
@@ -181,6 +182,16 @@ void	hrt_cancel(struct hrt_call *entry)
 	// endif
 }
 
+/*
+ * Get the callout statistics.
+ */
+void	hrt_callout_stats_get(struct hrt_callout_stats *stats, bool reset)
+{
+	hrt_lock();
+	hrt_callout_queue_stats(&callout_queue, stats, reset);
+	hrt_unlock();
+}
+
 /*
  * initialise a hrt_call structure
  */
@@ -207,7 +218,7 @@ void	hrt_call_delay(struct hrt_call *entry, hrt_abstime delay)
 void	hrt_init(void)
 {
 	//printf("hrt_init\n");
-	sq_init(&callout_queue);
+	hrt_callout_queue_init(&callout_queue);
 	sem_init(&_hrt_lock, 0, 1);
 	memset(&_hrt_work, 0, sizeof(_hrt_work));
 }
@@ -215,30 +226,10 @@ void	hrt_init(void)
 static void
 hrt_call_enter(struct hrt_call *entry)
 {
-	struct hrt_call	*call, *next;
-
-	//printf("hrt_call_enter\n");
-	call = (struct hrt_call *)sq_peek(&callout_queue);
-
-	if ((call == NULL) || (entry->deadline < call->deadline)) {
-		sq_addfirst(&entry->link, &callout_queue);
-		//lldbg("call enter at head, reschedule\n");
+	if (hrt_callout_queue_insert(&callout_queue, entry)) {
 		/* we changed the next deadline, reschedule the timer event */
 		hrt_call_reschedule();
-
-	} else {
-		do {
-			next = (struct hrt_call *)sq_next(&call->link);
-
-			if ((next == NULL) || (entry->deadline < next->deadline)) {
-				//lldbg("call enter after head\n");
-				sq_addafter(&call->link, &entry->link, &callout_queue);
-				break;
-			}
-		} while ((call = next) != NULL);
 	}
-
-	//lldbg("scheduled\n");
 }
 
 /**
@@ -271,7 +262,7 @@ static void
 hrt_call_reschedule()
 {
 	hrt_abstime	now = hrt_absolute_time();
-	struct hrt_call	*next = (struct hrt_call *)sq_peek(&callout_queue);
+	struct hrt_call	*next = hrt_callout_queue_peek(&callout_queue);
 	hrt_abstime	deadline = now + HRT_INTERVAL_MAX;
 	uint32_t	ticks = USEC2TICK(HRT_INTERVAL_MAX);
 
@@ -316,16 +307,7 @@ hrt_call_internal(struct hrt_call *entry, hrt_abstime deadline, hrt_abstime inte
 
 	//printf("hrt_call_internal after lock\n");
 	/* if the entry is currently queued, remove it */
-	/* note that we are using a potentially uninitialised
-	   entry->link here, but it is safe as sq_rem() doesn't
-	   dereference the passed node unless it is found in the
-	   list. So we potentially waste a bit of time searching the
-	   queue for the uninitialised entry->link but we don't do
-	   anything actually unsafe.
-	*/
-	if (entry->deadline != 0) {
-		sq_rem(&entry->link, &callout_queue);
-	}
+	hrt_callout_queue_remove(&callout_queue, entry);
 
 	entry->deadline = deadline;
 	entry->period = interval;
@@ -394,19 +376,12 @@ hrt_call_invoke(void)
 		/* get the current time */
 		hrt_abstime now = hrt_absolute_time();
 
-		call = (struct hrt_call *)sq_peek(&callout_queue);
+		call = hrt_callout_queue_pop_expired(&callout_queue, now);
 
 		if (call == NULL) {
 			break;
 		}
 
-		if (call->deadline > now) {
-			break;
-		}
-
-		sq_rem(&call->link, &callout_queue);
-		//lldbg("call pop\n");
-
 		/* save the intended deadline for periodic calls */
 		deadline = call->deadline;
 
@@ -424,8 +399,9 @@ hrt_call_invoke(void)
 			hrt_lock();
 		}
 
-		/* if the callout has a non-zero period, it has to be re-entered */
-		if (call->period != 0) {
+		/* if the callout has a non-zero period, it has to be re-entered (unless
+		 * it already rescheduled itself while the lock was released) */
+		if (call->period != 0 && call->queued != HRT_CALL_QUEUED) {
 			// re-check call->deadline to allow for
 			// callouts to re-schedule themselves
 			// using hrt_call_delay()
@@ -61,8 +61,8 @@ void copy_params_to_shmem(struct param_info_s *);
 void update_to_shmem(param_t param, union param_value_u value);
 int update_from_shmem(param_t param, union param_value_u *value);
 void update_index_from_shmem(void);
-uint64_t update_from_shmem_prev_time = 0, update_from_shmem_current_time = 0;
 static unsigned char krait_changed_index[MAX_SHMEM_PARAMS / 8 + 1];
+static uint32_t krait_generation_seen = 0; /*krait_generation of the last index update*/
 
 // Small helper to get log2 for ints
 static unsigned log2_for_int(unsigned v)
@@ -173,11 +173,11 @@ void copy_params_to_shmem(struct param_info_s *param_info_base)
 		struct param_wbuf_s *s = param_find_changed(param);
 
 		if (s == NULL) {
-			shmem_info_p->params_val[param] = param_info_base[param].val;
+			shmem_param_write(shmem_info_p, param, param_info_base[param].val);
 		}
 
 		else {
-			shmem_info_p->params_val[param] = s->val;
+			shmem_param_write(shmem_info_p, param, s->val);
 		}
 
 #ifdef SHMEM_DEBUG
@@ -216,11 +216,12 @@ void update_to_shmem(param_t param, union param_value_u value)
 		return;
 	}
 
-	shmem_info_p->params_val[param] = value;
+	shmem_param_write(shmem_info_p, param, value);
 
 	byte_changed = param / 8;
 	bit_changed = 1 << param % 8;
-	shmem_info_p->adsp_changed_index[byte_changed] |= bit_changed;
+	__sync_fetch_and_or(&shmem_info_p->adsp_changed_index[byte_changed], bit_changed);
+	shmem_info_p->adsp_generation++;
 
 	//PX4_INFO("set %d bit on adsp index[%d] to %d\n", bit_changed, byte_changed, shmem_info_p->adsp_changed_index[byte_changed]);
 
@@ -252,6 +253,8 @@ void update_index_from_shmem(void)
 		return;
 	}
 
+	krait_generation_seen = shmem_info_p->krait_generation;
+
 	for (i = 0; i < MAX_SHMEM_PARAMS / 8 + 1; i++) {
 		// Check if any param has been changed.
 		if (krait_changed_index[i] != shmem_info_p->krait_changed_index[i]) {
@@ -288,19 +291,12 @@ static void update_value_from_shmem(param_t param, union param_value_u *value)
 {
 	unsigned int byte_changed, bit_changed;
 
-	if (get_shmem_lock(__FILE__, __LINE__) != 0) {
-		PX4_ERR("Could not get shmem lock\n");
-		return;
-	}
-
-	*value = shmem_info_p->params_val[param];
-
-	/*also clear the index since we are holding the lock*/
+	/*clear the index first, so that a concurrent change sets it again*/
 	byte_changed = param / 8;
 	bit_changed = 1 << param % 8;
-	shmem_info_p->krait_changed_index[byte_changed] &= ~bit_changed;
+	__sync_fetch_and_and(&shmem_info_p->krait_changed_index[byte_changed], ~bit_changed);
 
-	release_shmem_lock(__FILE__, __LINE__);
+	*value = shmem_param_read(shmem_info_p, param);
 
 #ifdef SHMEM_DEBUG
 
@@ -326,11 +322,8 @@ int update_from_shmem(param_t param, union param_value_u *value)
 		return retval;
 	}
 
-	update_from_shmem_current_time = hrt_absolute_time();
-
-	if ((update_from_shmem_current_time - update_from_shmem_prev_time)
-	    > 1000000) { //update every 1 second
-		update_from_shmem_prev_time = update_from_shmem_current_time;
+	/*only scan the index if krait changed something since the last scan*/
+	if (shmem_info_p->krait_generation != krait_generation_seen) {
 		update_index_from_shmem();
 	}
 
@@ -38,6 +38,9 @@
 #define PARAM_BUFFER_SIZE (MAX_SHMEM_PARAMS / 8 + 1)
 
 struct shmem_info {
+	volatile uint32_t seq; /*seqlock of params_val: odd while a value is written*/
+	volatile uint32_t krait_generation; /*incremented for every param changed by krait*/
+	volatile uint32_t adsp_generation; /*incremented for every param changed by adsp*/
 	union param_value_u params_val[MAX_SHMEM_PARAMS];
 	unsigned char krait_changed_index[MAX_SHMEM_PARAMS / 8 + 1]; /*bit map of all params changed by krait*/
 	unsigned char adsp_changed_index[MAX_SHMEM_PARAMS / 8 + 1]; /*bit map of all params changed by adsp*/
@@ -64,3 +67,32 @@ struct shmem_info {
 #define TYPE_MASK 	0x1
 
 extern bool handle_in_range(param_t);
+
+/*
+ * Values are written with the shmem lock held (which serializes the writers), and read
+ * without it: the reader retries if a write was in progress. The changed bits are set and
+ * cleared with atomic operations, a reader clears the bit before reading the value.
+ */
+static inline void shmem_param_write(struct shmem_info *info, param_t param, union param_value_u value)
+{
+	info->seq++;
+	__sync_synchronize();
+	info->params_val[param] = value;
+	__sync_synchronize();
+	info->seq++;
+}
+
+static inline union param_value_u shmem_param_read(struct shmem_info *info, param_t param)
+{
+	union param_value_u value;
+	uint32_t seq;
+
+	do {
+		seq = info->seq;
+		__sync_synchronize();
+		value = info->params_val[param];
+		__sync_synchronize();
+	} while ((seq & 1) || seq != info->seq);
+
+	return value;
+}
@@ -0,0 +1,271 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2017 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file boot.cpp
+ *
+ * Helpers for the startup scripts: readiness barriers on uORB topics, so that
+ * independent modules can be started concurrently, and a boot timeline.
+ */
+
+#include <px4_config.h>
+#include <px4_getopt.h>
+#include <px4_log.h>
+#include <px4_module.h>
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <drivers/drv_hrt.h>
+#include <uORB/uORB.h>
+#include <uORB/uORBTopics.h>
+
+extern "C" __EXPORT int boot_main(int argc, char *argv[]);
+
+static constexpr int BOOT_TIMELINE_MAX_ENTRIES = 48;
+static constexpr int BOOT_TIMELINE_LABEL_LEN = 40;
+static constexpr unsigned BOOT_WAIT_POLL_INTERVAL_MS = 10;
+
+struct boot_timeline_entry_s {
+	hrt_abstime start;	///< start of the step, equal to end for single marks
+	hrt_abstime end;
+	char label[BOOT_TIMELINE_LABEL_LEN];
+};
+
+static boot_timeline_entry_s boot_timeline[BOOT_TIMELINE_MAX_ENTRIES];
+static int boot_timeline_count = 0;
+static pthread_mutex_t boot_timeline_mutex = PTHREAD_MUTEX_INITIALIZER; ///< steps can finish concurrently
+
+static void usage()
+{
+	PRINT_MODULE_DESCRIPTION(
+		R"DESCR_STR(
+### Description
+Helpers for the startup scripts to start modules concurrently and measure the boot time.
+
+Modules declare their readiness by publishing a topic (e.g. `sensors` publishes `sensor_combined`).
+Independent modules can be started in the background (`&`, supported by NuttX nsh and the POSIX shell),
+and the modules depending on them are started after a `boot wait` on their readiness topics.
+
+Each `boot mark` and `boot wait` adds an entry to the boot timeline, which is printed with `boot timeline`.
+The POSIX shell adds an entry for every background command.
+
+### Examples
+$ gyrosim start &
+$ accelsim start &
+$ boot wait sensor_gyro sensor_accel
+$ sensors start
+$ boot wait -t 5000 sensor_combined
+$ ekf2 start
+$ boot timeline
+)DESCR_STR");
+
+	PRINT_MODULE_USAGE_NAME_SIMPLE("boot", "command");
+	PRINT_MODULE_USAGE_COMMAND_DESCR("wait", "Block until all given topics are published");
+	PRINT_MODULE_USAGE_PARAM_INT('t', 10000, 0, 600000, "Timeout in ms (0 = wait forever)", true);
+	PRINT_MODULE_USAGE_ARG("<topic> [<topic> ...]", "Readiness topics", false);
+	PRINT_MODULE_USAGE_COMMAND_DESCR("mark", "Add an entry to the boot timeline");
+	PRINT_MODULE_USAGE_PARAM_INT('s', 0, 0, 0, "Start timestamp of the step (hrt, us), for entries with a duration",
+				     true);
+	PRINT_MODULE_USAGE_ARG("<label>", "Description of the step", false);
+	PRINT_MODULE_USAGE_COMMAND_DESCR("timeline", "Print the boot timeline");
+}
+
+/**
+ * Add a timeline entry, labelled with the optional prefix followed by the arguments.
+ */
+static void timeline_add(hrt_abstime start, hrt_abstime end, const char *prefix, int argc, char *argv[])
+{
+	pthread_mutex_lock(&boot_timeline_mutex);
+
+	if (boot_timeline_count < BOOT_TIMELINE_MAX_ENTRIES) {
+		boot_timeline_entry_s &entry = boot_timeline[boot_timeline_count++];
+		entry.start = start;
+		entry.end = end;
+		strncpy(entry.label, prefix ? prefix : "", sizeof(entry.label) - 1);
+		entry.label[sizeof(entry.label) - 1] = '\0';
+
+		for (int i = 0; i < argc; ++i) {
+			size_t len = strlen(entry.label);
+			snprintf(entry.label + len, sizeof(entry.label) - len, "%s%s", (len == 0) ? "" : " ", argv[i]);
+		}
+	}
+
+	pthread_mutex_unlock(&boot_timeline_mutex);
+}
+
+static void timeline_print()
+{
+	pthread_mutex_lock(&boot_timeline_mutex);
+
+	// entries are added when a step completes, and steps run concurrently: sort by completion time
+	for (int i = 1; i < boot_timeline_count; ++i) {
+		boot_timeline_entry_s entry = boot_timeline[i];
+		int j = i - 1;
+
+		while (j >= 0 && boot_timeline[j].end > entry.end) {
+			boot_timeline[j + 1] = boot_timeline[j];
+			--j;
+		}
+
+		boot_timeline[j + 1] = entry;
+	}
+
+	PX4_INFO("boot timeline [ms]:");
+	printf("     START       END  DURATION  STEP\n");
+
+	for (int i = 0; i < boot_timeline_count; ++i) {
+		const boot_timeline_entry_s &entry = boot_timeline[i];
+
+		if (entry.start == entry.end) {
+			printf("          %9.1f            %s\n", (double)(entry.end / 1e3f), entry.label);
+
+		} else {
+			printf("%9.1f %9.1f %9.1f  %s\n", (double)(entry.start / 1e3f), (double)(entry.end / 1e3f),
+			       (double)((entry.end - entry.start) / 1e3f), entry.label);
+		}
+	}
+
+	pthread_mutex_unlock(&boot_timeline_mutex);
+}
+
+static const orb_metadata *find_topic(const char *name)
+{
+	const orb_metadata **topics = orb_get_topics();
+
+	for (size_t i = 0; i < orb_topics_count(); ++i) {
+		if (strcmp(topics[i]->o_name, name) == 0) {
+			return topics[i];
+		}
+	}
+
+	return nullptr;
+}
+
+static int wait_for_topics(int argc, char *argv[], unsigned timeout_ms)
+{
+	const hrt_abstime start = hrt_absolute_time();
+
+	for (int i = 0; i < argc; ++i) {
+		const orb_metadata *meta = find_topic(argv[i]);
+
+		if (meta == nullptr) {
+			PX4_ERR("unknown topic %s", argv[i]);
+			return 1;
+		}
+
+		// Count the polls rather than comparing timestamps: in SITL lockstep, time does not
+		// advance before the simulator connects.
+		unsigned waited_ms = 0;
+
+		while (orb_exists(meta, 0) != PX4_OK) {
+			if (timeout_ms > 0 && waited_ms >= timeout_ms) {
+				PX4_ERR("timeout waiting for %s", argv[i]);
+				return 1;
+			}
+
+			usleep(BOOT_WAIT_POLL_INTERVAL_MS * 1000);
+			waited_ms += BOOT_WAIT_POLL_INTERVAL_MS;
+		}
+	}
+
+	timeline_add(start, hrt_absolute_time(), "wait", argc, argv);
+	return 0;
+}
+
+int boot_main(int argc, char *argv[])
+{
+	if (argc < 2) {
+		usage();
+		return 1;
+	}
+
+	int myoptind = 1;
+	int ch;
+	const char *myoptarg = nullptr;
+	unsigned timeout_ms = 10000;
+	hrt_abstime start = 0;
+
+	while ((ch = px4_getopt(argc, argv, "t:s:", &myoptind, &myoptarg)) != EOF) {
+		switch (ch) {
+		case 't':
+			timeout_ms = strtoul(myoptarg, nullptr, 10);
+			break;
+
+		case 's':
+			start = strtoull(myoptarg, nullptr, 10);
+			break;
+
+		default:
+			usage();
+			return 1;
+		}
+	}
+
+	if (myoptind >= argc) {
+		usage();
+		return 1;
+	}
+
+	// px4_getopt moves the options to the front, the command follows them
+	const char *command = argv[myoptind++];
+
+	if (!strcmp(command, "wait")) {
+		if (myoptind >= argc) {
+			usage();
+			return 1;
+		}
+
+		return wait_for_topics(argc - myoptind, argv + myoptind, timeout_ms);
+
+	} else if (!strcmp(command, "mark")) {
+		if (myoptind >= argc) {
+			usage();
+			return 1;
+		}
+
+		const hrt_abstime now = hrt_absolute_time();
+		timeline_add((start > 0 && start <= now) ? start : now, now, nullptr, argc - myoptind, argv + myoptind);
+		return 0;
+
+	} else if (!strcmp(command, "timeline")) {
+		timeline_print();
+		return 0;
+	}
+
+	usage();
+	return 1;
+}
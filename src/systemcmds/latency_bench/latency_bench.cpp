@@ -0,0 +1,458 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2018 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file latency_bench.cpp
+ *
+ * Control loop timing benchmark: publishes a synthetic IMU and measures the latency of the
+ * sensors -> mc_att_control -> mixer chain from the propagated sample timestamps.
+ */
+
+#include <px4_config.h>
+#include <px4_getopt.h>
+#include <px4_module.h>
+#include <px4_log.h>
+#include <px4_tasks.h>
+#include <px4_time.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include <drivers/drv_hrt.h>
+#include <geo/geo.h>
+#include <uORB/uORB.h>
+#include <uORB/topics/actuator_controls.h>
+#include <uORB/topics/actuator_outputs.h>
+#include <uORB/topics/cpuload.h>
+#include <uORB/topics/sensor_accel.h>
+#include <uORB/topics/sensor_gyro.h>
+#include <uORB/topics/vehicle_command.h>
+
+extern "C" { __EXPORT int latency_bench_main(int argc, char *argv[]); }
+
+namespace
+{
+
+/* device id of the synthetic IMU, so that it is not mistaken for a calibrated sensor */
+static constexpr uint32_t BENCH_DEVICE_ID = 0x00ff0000;
+
+/* number of published sample timestamps a response is matched against */
+static constexpr unsigned SAMPLE_HISTORY = 32;
+
+class Histogram
+{
+public:
+	static constexpr unsigned BIN_WIDTH = 20; ///< [us]
+	static constexpr unsigned BIN_COUNT = 250;
+
+	void add(uint32_t value)
+	{
+		const unsigned bin = value / BIN_WIDTH;
+		_bins[(bin < BIN_COUNT) ? bin : BIN_COUNT - 1]++;
+		_count++;
+		_sum += value;
+
+		if (value > _max) {
+			_max = value;
+		}
+	}
+
+	/**
+	 * @return upper edge of the bin of the percentile, but not above the largest value [us]
+	 */
+	uint32_t percentile(unsigned pct) const
+	{
+		const uint32_t rank = (_count * pct + 99) / 100;
+		uint32_t sum = 0;
+
+		for (unsigned bin = 0; bin < BIN_COUNT; bin++) {
+			sum += _bins[bin];
+
+			if (sum >= rank) {
+				const uint32_t value = (bin + 1) * BIN_WIDTH;
+				return (value < _max) ? value : _max;
+			}
+		}
+
+		return _max;
+	}
+
+	void print(const char *name) const
+	{
+		if (_count == 0) {
+			PX4_INFO("%-22s %8u %8s %8s %8s %8s %8s", name, 0u, "-", "-", "-", "-", "-");
+			return;
+		}
+
+		PX4_INFO("%-22s %8u %8u %8u %8u %8u %8u", name, (unsigned)_count, (unsigned)(_sum / _count),
+			 (unsigned)percentile(50), (unsigned)percentile(95), (unsigned)percentile(99), (unsigned)_max);
+	}
+
+	uint32_t count() const { return _count; }
+
+private:
+	uint32_t _bins[BIN_COUNT] {};
+	uint32_t _count{0};
+	uint64_t _sum{0};
+	uint32_t _max{0};
+};
+
+struct BenchResult {
+	Histogram controls_latency;	///< sample to actuator_controls_0 (sensors and controller)
+	Histogram outputs_latency;	///< sample to actuator_outputs (including the mixer)
+	Histogram loop_interval;	///< between consecutive actuator_controls_0
+
+	unsigned published{0};
+	unsigned publish_overruns{0};	///< samples published more than a period late
+	unsigned controls_matched{0};
+	unsigned controls_late{0};	///< responses later than one sample period
+
+	float headroom_min{1.0f};
+	float headroom_sum{0.0f};
+	unsigned headroom_count{0};
+};
+
+/* the histograms are too large for the stack of the shell */
+BenchResult *result = nullptr;
+
+unsigned rate_hz = 1000;
+unsigned duration_s = 10;
+bool load_system = false;
+volatile bool bench_running = false;
+
+hrt_abstime sample_history[SAMPLE_HISTORY] {};
+
+bool
+is_bench_sample(hrt_abstime timestamp_sample)
+{
+	if (timestamp_sample == 0) {
+		return false;
+	}
+
+	for (unsigned i = 0; i < SAMPLE_HISTORY; i++) {
+		if (sample_history[i] == timestamp_sample) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void
+send_logging_command(uint16_t command)
+{
+	vehicle_command_s cmd = {};
+	cmd.timestamp = hrt_absolute_time();
+	cmd.command = command;
+	cmd.from_external = false;
+
+	orb_advert_t pub = orb_advertise_queue(ORB_ID(vehicle_command), &cmd, vehicle_command_s::ORB_QUEUE_LENGTH);
+	orb_unadvertise(pub);
+}
+
+void
+process_responses(int controls_sub, int outputs_sub, int cpuload_sub, hrt_abstime period, hrt_abstime &last_controls)
+{
+	bool updated = false;
+	orb_check(controls_sub, &updated);
+
+	if (updated) {
+		actuator_controls_s controls;
+		orb_copy(ORB_ID(actuator_controls_0), controls_sub, &controls);
+
+		if (is_bench_sample(controls.timestamp_sample) && controls.timestamp >= controls.timestamp_sample) {
+			const uint32_t latency = controls.timestamp - controls.timestamp_sample;
+			result->controls_latency.add(latency);
+			result->controls_matched++;
+
+			if (latency > period) {
+				result->controls_late++;
+			}
+
+			if (last_controls != 0) {
+				result->loop_interval.add(controls.timestamp - last_controls);
+			}
+
+			last_controls = controls.timestamp;
+		}
+	}
+
+	orb_check(outputs_sub, &updated);
+
+	if (updated) {
+		actuator_outputs_s outputs;
+		orb_copy(ORB_ID(actuator_outputs), outputs_sub, &outputs);
+
+		if (is_bench_sample(outputs.timestamp_sample) && outputs.timestamp >= outputs.timestamp_sample) {
+			result->outputs_latency.add(outputs.timestamp - outputs.timestamp_sample);
+		}
+	}
+
+	orb_check(cpuload_sub, &updated);
+
+	if (updated) {
+		cpuload_s cpuload;
+		orb_copy(ORB_ID(cpuload), cpuload_sub, &cpuload);
+
+		const float headroom = 1.0f - cpuload.load;
+		result->headroom_min = fminf(result->headroom_min, headroom);
+		result->headroom_sum += headroom;
+		result->headroom_count++;
+	}
+}
+
+int
+bench_task(int argc, char *argv[])
+{
+	const hrt_abstime period = 1000000 / rate_hz;
+	const float dt = period * 1e-6f;
+
+	sensor_gyro_s gyro = {};
+	gyro.device_id = BENCH_DEVICE_ID;
+	gyro.integral_dt = period;
+	gyro.scaling = 1.0f;
+	gyro.range_rad_s = 2000.0f * M_DEG_TO_RAD_F;
+
+	sensor_accel_s accel = {};
+	accel.device_id = BENCH_DEVICE_ID;
+	accel.integral_dt = period;
+	accel.scaling = 1.0f;
+	accel.range_m_s2 = 16.0f * CONSTANTS_ONE_G;
+
+	int gyro_instance = -1;
+	int accel_instance = -1;
+	orb_advert_t gyro_pub = orb_advertise_multi(ORB_ID(sensor_gyro), &gyro, &gyro_instance, ORB_PRIO_MAX);
+	orb_advert_t accel_pub = orb_advertise_multi(ORB_ID(sensor_accel), &accel, &accel_instance, ORB_PRIO_MAX);
+
+	if (gyro_instance != 0) {
+		PX4_WARN("synthetic gyro is instance %d: stop the IMU drivers and restart sensors and mc_att_control to use it",
+			 gyro_instance);
+	}
+
+	int controls_sub = orb_subscribe(ORB_ID(actuator_controls_0));
+	int outputs_sub = orb_subscribe(ORB_ID(actuator_outputs));
+	int cpuload_sub = orb_subscribe(ORB_ID(cpuload));
+
+	if (load_system) {
+		/* stream the log over MAVLink: loads the logger and the MAVLink link */
+		send_logging_command(vehicle_command_s::VEHICLE_CMD_LOGGING_START);
+	}
+
+	const hrt_abstime start = hrt_absolute_time();
+	const hrt_abstime end = start + (hrt_abstime)duration_s * 1000000;
+	hrt_abstime next = start;
+	hrt_abstime last_controls = 0;
+
+	for (hrt_abstime now = start; now < end; now = hrt_absolute_time()) {
+		if (now < next) {
+			px4_usleep(next - now);
+			now = hrt_absolute_time();
+		}
+
+		if (now > next + period) {
+			/* the bench itself did not get the CPU in time, restart the schedule */
+			result->publish_overruns++;
+			next = now;
+		}
+
+		next += period;
+
+		/* a slow rotation about all axes, and gravity */
+		const float t = (now - start) * 1e-6f;
+		gyro.timestamp = now;
+		gyro.x = 0.2f * sinf(2.0f * M_PI_F * t);
+		gyro.y = 0.2f * cosf(2.0f * M_PI_F * t);
+		gyro.z = 0.1f * sinf(M_PI_F * t);
+		gyro.x_integral = gyro.x * dt;
+		gyro.y_integral = gyro.y * dt;
+		gyro.z_integral = gyro.z * dt;
+
+		accel.timestamp = now;
+		accel.z = -CONSTANTS_ONE_G;
+		accel.z_integral = accel.z * dt;
+
+		sample_history[result->published % SAMPLE_HISTORY] = now;
+		result->published++;
+
+		orb_publish(ORB_ID(sensor_gyro), gyro_pub, &gyro);
+		orb_publish(ORB_ID(sensor_accel), accel_pub, &accel);
+
+		process_responses(controls_sub, outputs_sub, cpuload_sub, period, last_controls);
+	}
+
+	/* collect the response to the last sample */
+	px4_usleep(2 * period);
+	process_responses(controls_sub, outputs_sub, cpuload_sub, period, last_controls);
+
+	if (load_system) {
+		send_logging_command(vehicle_command_s::VEHICLE_CMD_LOGGING_STOP);
+	}
+
+	orb_unsubscribe(controls_sub);
+	orb_unsubscribe(outputs_sub);
+	orb_unsubscribe(cpuload_sub);
+	orb_unadvertise(gyro_pub);
+	orb_unadvertise(accel_pub);
+
+	bench_running = false;
+	return 0;
+}
+
+void
+print_result()
+{
+	const unsigned missing = (result->published > result->controls_matched) ?
+				 result->published - result->controls_matched : 0;
+
+	PX4_INFO("%u samples at %u Hz, %u publication overruns", result->published, rate_hz, result->publish_overruns);
+	PX4_INFO("%-22s %8s %8s %8s %8s %8s %8s", "[us]", "count", "avg", "p50", "p95", "p99", "max");
+	result->controls_latency.print("sample -> controls");
+	result->outputs_latency.print("sample -> outputs");
+	result->loop_interval.print("controls interval");
+	PX4_INFO("missed deadlines: %u (%u samples without response, %u responses later than %u us)",
+		 missing + result->controls_late, missing, result->controls_late, 1000000 / rate_hz);
+
+	if (result->headroom_count > 0) {
+		PX4_INFO("CPU headroom: min %.1f %%, avg %.1f %%", (double)(100.0f * result->headroom_min),
+			 (double)(100.0f * result->headroom_sum / result->headroom_count));
+	}
+
+	if (result->controls_latency.count() == 0) {
+		PX4_WARN("no actuator_controls_0 based on the synthetic gyro: is mc_att_control running with rate control enabled?");
+	}
+}
+
+void
+usage()
+{
+	PRINT_MODULE_DESCRIPTION(
+		R"DESCR_STR(
+### Description
+Control loop timing benchmark. Publishes a synthetic IMU (sensor_gyro and sensor_accel) at a fixed
+rate and follows its samples through the real sensors, mc_att_control and mixer chain, using the
+sample timestamps propagated in actuator_controls_0 and actuator_outputs. Reports the latency
+percentiles from the sample to the controls and to the outputs, the controller loop interval, the
+missed deadlines (samples without a response, and responses later than one sample period) and the
+CPU headroom (from cpuload).
+
+The synthetic IMU must be the only one: stop the IMU drivers, then start the bench and restart
+sensors and mc_att_control. The output driver runs as usual, remove the propellers.
+With -l, the ULog is streamed over MAVLink during the run to load the logger and the link.
+
+### Examples
+$ latency_bench -r 1000 -d 30 -l
+)DESCR_STR");
+
+	PRINT_MODULE_USAGE_NAME("latency_bench", "command");
+	PRINT_MODULE_USAGE_PARAM_INT('r', 1000, 50, 8000, "Sample rate [Hz]", true);
+	PRINT_MODULE_USAGE_PARAM_INT('d', 10, 1, 3600, "Duration [s]", true);
+	PRINT_MODULE_USAGE_PARAM_FLAG('l', "Load the system with logging over MAVLink", true);
+}
+
+} // namespace
+
+int
+latency_bench_main(int argc, char *argv[])
+{
+	rate_hz = 1000;
+	duration_s = 10;
+	load_system = false;
+
+	int myoptind = 1;
+	int ch;
+	const char *myoptarg = nullptr;
+
+	while ((ch = px4_getopt(argc, argv, "r:d:l", &myoptind, &myoptarg)) != EOF) {
+		switch (ch) {
+		case 'r':
+			rate_hz = strtoul(myoptarg, nullptr, 10);
+			break;
+
+		case 'd':
+			duration_s = strtoul(myoptarg, nullptr, 10);
+			break;
+
+		case 'l':
+			load_system = true;
+			break;
+
+		default:
+			usage();
+			return -EINVAL;
+		}
+	}
+
+	if (myoptind < argc || rate_hz < 50 || rate_hz > 8000 || duration_s < 1 || duration_s > 3600) {
+		usage();
+		return -EINVAL;
+	}
+
+	if (bench_running) {
+		PX4_ERR("already running");
+		return -EBUSY;
+	}
+
+	result = new BenchResult();
+
+	if (result == nullptr) {
+		PX4_ERR("alloc failed");
+		return -ENOMEM;
+	}
+
+	for (unsigned i = 0; i < SAMPLE_HISTORY; i++) {
+		sample_history[i] = 0;
+	}
+
+	/* publish at the priority of an IMU driver */
+	bench_running = true;
+	int task = px4_task_spawn_cmd("latency_bench", SCHED_DEFAULT, SCHED_PRIORITY_FAST_DRIVER, 2000,
+				      (px4_main_t)&bench_task, nullptr);
+
+	if (task < 0) {
+		PX4_ERR("task start failed");
+		bench_running = false;
+		delete result;
+		result = nullptr;
+		return -errno;
+	}
+
+	while (bench_running) {
+		px4_usleep(100000);
+	}
+
+	print_result();
+
+	delete result;
+	result = nullptr;
+	return 0;
+}
@@ -60,6 +60,7 @@ extern "C" __EXPORT int mixer_main(int argc, char *argv[]);
 
 static void	usage(const char *reason);
 static int	load(const char *devname, const char *fname, bool append);
+static int	load_binary(int dev, const char *fname, char *buf, unsigned buflen);
 
 int
 mixer_main(int argc, char *argv[])
@@ -116,6 +117,10 @@ usage(const char *reason)
 Load or append mixer files to the ESC driver.
 
 Note that the driver must support the used ioctl's, which is the case on NuttX, but for example not on RPi.
+
+If the build generated a precompiled version of the mixer file (<file>.bin, see Tools/px_generate_mixer_binaries.py),
+it is loaded instead of the text file, which avoids parsing the text at boot. Drivers that do not support binary
+mixers get the text file.
 )DESCR_STR");
 
 
@@ -151,6 +156,10 @@ load(const char *devname, const char *fname, bool append)
 
 	char buf[2048];
 
+	if (load_binary(dev, fname, &buf[0], sizeof(buf)) == 0) {
+		return 0;
+	}
+
 	if (load_mixer_file(fname, &buf[0], sizeof(buf)) < 0) {
 		PX4_ERR("can't load mixer file: %s", fname);
 		return 1;
@@ -166,3 +175,33 @@ load(const char *devname, const char *fname, bool append)
 
 	return 0;
 }
+
+static int
+load_binary(int dev, const char *fname, char *buf, unsigned buflen)
+{
+	char path[128];
+
+	if (snprintf(path, sizeof(path), "%s.bin", fname) >= (int)sizeof(path)) {
+		return -1;
+	}
+
+	FILE *fp = fopen(path, "r");
+
+	if (fp == nullptr) {
+		return -1;
+	}
+
+	size_t len = fread(buf, 1, buflen, fp);
+	bool complete = feof(fp);
+	fclose(fp);
+
+	if (!complete || !MixerGroup::is_binary(buf, len)) {
+		PX4_WARN("ignoring invalid binary mixer %s", path);
+		return -1;
+	}
+
+	mixer_binary_buf_s binary = { buf, (unsigned)len };
+
+	/* drivers without binary support return ENOTTY, they get the text file */
+	return px4_ioctl(dev, MIXERIOCLOADBIN, (unsigned long)&binary) < 0 ? -1 : 0;
+}
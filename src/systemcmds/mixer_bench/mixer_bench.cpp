@@ -0,0 +1,201 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2017 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file mixer_bench.cpp
+ *
+ * Measures the cost of the multirotor mixer for each geometry of multi_tables.py,
+ * with the reference and the single-pass mixing mode.
+ */
+
+#include <px4_config.h>
+#include <px4_getopt.h>
+#include <px4_module.h>
+#include <px4_log.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include <drivers/drv_hrt.h>
+#include <systemlib/mixer/mixer.h>
+
+extern "C" { __EXPORT int mixer_bench_main(int argc, char *argv[]); }
+
+namespace
+{
+
+/* control sets the mixers cycle through: half of them small (unsaturated), half full range */
+static constexpr unsigned control_sets = 64;
+float controls[control_sets][4];
+unsigned control_index = 0;
+
+int
+control_callback(uintptr_t handle, uint8_t control_group, uint8_t control_index_in_group, float &control)
+{
+	control = controls[control_index][control_index_in_group & 3];
+	return 0;
+}
+
+void
+init_controls()
+{
+	/* fixed seed, so that runs are comparable */
+	uint32_t seed = 12345;
+
+	for (unsigned i = 0; i < control_sets; i++) {
+		const float range = (i & 1) ? 0.2f : 1.0f;
+
+		for (unsigned j = 0; j < 4; j++) {
+			seed = seed * 1103515245u + 12345u;
+			const float r = (seed >> 8) / (float)(1 << 24); // [0, 1)
+			controls[i][j] = (j == 3) ? r : range * (2.0f * r - 1.0f);
+		}
+	}
+}
+
+/**
+ * @return average time per mix() call [us]
+ */
+float
+time_mixer(MultirotorMixer &mixer, unsigned iterations)
+{
+	float outputs[MultirotorMixer::MAX_ROTORS];
+
+	const hrt_abstime start = hrt_absolute_time();
+
+	for (unsigned i = 0; i < iterations; i++) {
+		control_index = i % control_sets;
+		mixer.mix(outputs, MultirotorMixer::MAX_ROTORS);
+	}
+
+	return (float)hrt_elapsed_time(&start) / iterations;
+}
+
+/**
+ * @return largest output difference between the two mixers over all control sets
+ */
+float
+compare_mixers(MultirotorMixer &a, MultirotorMixer &b)
+{
+	float diff = 0.0f;
+
+	for (unsigned i = 0; i < control_sets; i++) {
+		float out_a[MultirotorMixer::MAX_ROTORS];
+		float out_b[MultirotorMixer::MAX_ROTORS];
+
+		control_index = i;
+		const unsigned n = a.mix(out_a, MultirotorMixer::MAX_ROTORS);
+		b.mix(out_b, MultirotorMixer::MAX_ROTORS);
+
+		for (unsigned j = 0; j < n; j++) {
+			diff = fmaxf(diff, fabsf(out_a[j] - out_b[j]));
+		}
+	}
+
+	return diff;
+}
+
+void
+usage()
+{
+	PRINT_MODULE_DESCRIPTION(
+		R"DESCR_STR(
+### Description
+Measures the cost of one multirotor mixer call for each geometry of the generated rotor tables
+(multi_tables.py), with the reference mixer and with the single-pass mode (MOT_MIX_MODE).
+The inputs cycle through a fixed set of saturated and unsaturated controls. The largest output
+difference between the two modes is printed as well: they only differ when yaw saturates.
+
+Run it on an otherwise idle system for comparable results.
+
+### Examples
+$ mixer_bench -n 10000
+)DESCR_STR");
+
+	PRINT_MODULE_USAGE_NAME("mixer_bench", "command");
+	PRINT_MODULE_USAGE_PARAM_INT('n', 10000, 100, 1000000, "Number of mixer calls per measurement", true);
+}
+
+} // namespace
+
+int
+mixer_bench_main(int argc, char *argv[])
+{
+	unsigned iterations = 10000;
+
+	int myoptind = 1;
+	int ch;
+	const char *myoptarg = nullptr;
+
+	while ((ch = px4_getopt(argc, argv, "n:", &myoptind, &myoptarg)) != EOF) {
+		switch (ch) {
+		case 'n':
+			iterations = strtoul(myoptarg, nullptr, 10);
+			break;
+
+		default:
+			usage();
+			return -EINVAL;
+		}
+	}
+
+	if (myoptind < argc || iterations < 100 || iterations > 1000000) {
+		usage();
+		return -EINVAL;
+	}
+
+	init_controls();
+
+	PX4_INFO("%-18s %6s %12s %12s %10s", "geometry", "rotors", "ref [us]", "single [us]", "max diff");
+
+	for (unsigned g = 0; g < MultirotorMixer::geometry_count(); g++) {
+		MultirotorMixer reference(control_callback, 0, (MultirotorGeometry)g, 1.0f, 1.0f, 1.0f, 0.1f);
+		MultirotorMixer single_pass(control_callback, 0, (MultirotorGeometry)g, 1.0f, 1.0f, 1.0f, 0.1f);
+		single_pass.set_single_pass(true);
+
+		if (!single_pass.single_pass()) {
+			PX4_ERR("%s: single-pass mode not available", MultirotorMixer::geometry_name(g));
+			continue;
+		}
+
+		const unsigned rotors = reference.set_trim(0.0f);
+		const float t_reference = time_mixer(reference, iterations);
+		const float t_single_pass = time_mixer(single_pass, iterations);
+		const float diff = compare_mixers(reference, single_pass);
+
+		PX4_INFO("%-18s %6u %12.3f %12.3f %10.4f", MultirotorMixer::geometry_name(g), rotors,
+			 (double)t_reference, (double)t_single_pass, (double)diff);
+	}
+
+	return 0;
+}
@@ -67,6 +67,8 @@
 
 #include <board_config.h>
 
+#include "mtd_writeback.h"
+
 __EXPORT int mtd_main(int argc, char *argv[]);
 
 #ifndef CONFIG_MTD
@@ -86,6 +88,11 @@ int mtd_main(int argc, char *argv[])
 #   define MTD_PARTITION_TABLE  {"/fs/mtd_params", "/fs/mtd_waypoints"}
 #  endif
 
+/* number of blocks buffered in RAM by the write-behind queue, 0 to write directly */
+#ifndef BOARD_MTD_WRITEBACK_BLOCKS
+#  define BOARD_MTD_WRITEBACK_BLOCKS 4
+#endif
+
 
 #ifdef CONFIG_MTD_RAMTRON
 static int	ramtron_attach(void);
@@ -107,12 +114,14 @@ static int	mtd_erase(char *partition_names[], unsigned n_partitions);
 static int	mtd_readtest(char *partition_names[], unsigned n_partitions);
 static int	mtd_rwtest(char *partition_names[], unsigned n_partitions);
 static int	mtd_print_info(void);
+static int	mtd_flush(void);
 static int	mtd_get_geometry(unsigned long *blocksize, unsigned long *erasesize, unsigned long *neraseblocks,
 				 unsigned *blkpererase, unsigned *nblocks, unsigned *partsize, unsigned n_partitions);
 
 static bool attached = false;
 static bool started = false;
 static struct mtd_dev_s *mtd_dev;
+static struct mtd_dev_s *mtd_writeback_dev = NULL;
 static unsigned n_partitions_current = 0;
 
 /* note, these will be equally sized */
@@ -141,6 +150,7 @@ static void	print_usage(void)
 	PRINT_MODULE_USAGE_COMMAND_DESCR("readtest", "Perform read test");
 	PRINT_MODULE_USAGE_COMMAND_DESCR("rwtest", "Perform read-write test");
 	PRINT_MODULE_USAGE_COMMAND_DESCR("erase", "Erase partition(s)");
+	PRINT_MODULE_USAGE_COMMAND_DESCR("flush", "Write the blocks queued by the write-behind queue to the device");
 
 	PRINT_MODULE_USAGE_PARAM_COMMENT("The commands 'start', 'readtest', 'rwtest' and 'erase' have an optional parameter:");
 	PRINT_MODULE_USAGE_ARG("<partition_name1> [<partition_name2> ...]",
@@ -183,6 +193,10 @@ int mtd_main(int argc, char *argv[])
 			return mtd_status();
 		}
 
+		if (!strcmp(argv[1], "flush")) {
+			return mtd_flush();
+		}
+
 		if (!strcmp(argv[1], "erase")) {
 			if (argc >= 3) {
 				return mtd_erase(argv + 2, argc - 2);
@@ -317,6 +331,22 @@ mtd_start(char *partition_names[], unsigned n_partitions)
 		return 1;
 	}
 
+#if BOARD_MTD_WRITEBACK_BLOCKS > 0
+
+	/* queue the writes in RAM, so that e.g. saving the parameters does not wait for the bus */
+	if (mtd_writeback_dev == NULL) {
+		mtd_writeback_dev = mtd_writeback_initialize(mtd_dev, BOARD_MTD_WRITEBACK_BLOCKS);
+
+		if (mtd_writeback_dev) {
+			mtd_dev = mtd_writeback_dev;
+
+		} else {
+			PX4_WARN("write-behind queue not available, writing directly");
+		}
+	}
+
+#endif
+
 	unsigned long blocksize, erasesize, neraseblocks;
 	unsigned blkpererase, nblocks, partsize;
 
@@ -447,6 +477,27 @@ int mtd_print_info(void)
 	printf("  Partition size: %u Blocks (%u bytes)\n", nblocks, partsize);
 	printf("  TOTAL SIZE: %u KiB\n", neraseblocks * erasesize / 1024);
 
+	if (mtd_writeback_dev) {
+		mtd_writeback_print_info(mtd_writeback_dev);
+	}
+
+	return 0;
+}
+
+static int
+mtd_flush(void)
+{
+	if (!mtd_writeback_dev) {
+		return 0;
+	}
+
+	int ret = mtd_writeback_flush(mtd_writeback_dev, false);
+
+	if (ret < 0) {
+		PX4_ERR("flush failed: %d", ret);
+		return 1;
+	}
+
 	return 0;
 }
 
@@ -584,6 +635,11 @@ mtd_rwtest(char *partition_names[], unsigned n_partitions)
 		}
 
 		close(fd);
+
+		/* the test is only done once the data is on the device */
+		if (mtd_flush() != 0) {
+			return 1;
+		}
 	}
 
 	printf("rwtest OK\n");
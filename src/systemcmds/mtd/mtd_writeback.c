@@ -0,0 +1,560 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2017 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file mtd_writeback.c
+ *
+ * Write-behind queue for MTD devices without a real erase (FRAM, EEPROM).
+ *
+ * Written blocks are copied into a small set of RAM blocks and marked dirty. A worker on the low
+ * priority work queue writes the dirty blocks to the device, so that e.g. saving the parameters
+ * does not wait for the SPI/I2C transfers (which use DMA if enabled for the bus in the NuttX config).
+ * The blocks stay in RAM after being written and serve the reads until they are replaced by other
+ * blocks. If no block is free or clean, a write goes directly to the device.
+ *
+ * Locking: _lock protects the blocks, _write_lock serializes the writes to the device (worker and
+ * flush), so that a single write buffer is enough and the device is never written concurrently
+ * with an erase. _write_lock is always taken before _lock.
+ */
+
+#include <px4_config.h>
+#include <px4_log.h>
+#include <px4_shutdown.h>
+
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <semaphore.h>
+
+#include <nuttx/wqueue.h>
+#include <nuttx/clock.h>
+#include <nuttx/fs/ioctl.h>
+#include <nuttx/mtd/mtd.h>
+
+#include <drivers/drv_mtd.h>
+
+#include "systemlib/perf_counter.h"
+
+#include "mtd_writeback.h"
+
+/* delay of the writes after the first queued block, to collect the blocks of a whole file */
+#define MTD_WRITEBACK_DELAY_US		20000
+
+/* retry interval after a write error */
+#define MTD_WRITEBACK_RETRY_US		100000
+
+struct mtd_writeback_block_s {
+	off_t		block;		/* block number on the device, -1 if unused */
+	bool		dirty;		/* changed since the last write to the device */
+	bool		writing;	/* being written to the device, must not be replaced until the write returns */
+	uint32_t	last_use;	/* value of use_counter at the last access, for the replacement */
+	FAR uint8_t	*data;
+};
+
+struct mtd_writeback_dev_s {
+	struct mtd_dev_s	mtd;		/* must be first, the wrapper is used as MTD device */
+	FAR struct mtd_dev_s	*dev;		/* wrapped device */
+
+	sem_t			lock;
+	sem_t			write_lock;
+	struct work_s		work;
+
+	uint32_t		blocksize;
+	uint32_t		blkpererase;
+	unsigned		nblocks;
+	uint32_t		use_counter;
+	FAR struct mtd_writeback_block_s *blocks;
+	FAR uint8_t		*write_buffer;	/* copy of the block being written, protected by write_lock */
+
+	perf_counter_t		perf_queued;
+	perf_counter_t		perf_direct;
+	perf_counter_t		perf_device_writes;
+	perf_counter_t		perf_read_hits;
+	perf_counter_t		perf_errors;
+};
+
+static FAR struct mtd_writeback_dev_s *g_writeback = NULL;
+
+static void
+writeback_lock(sem_t *sem)
+{
+	while (sem_wait(sem) != 0) {
+		/* interrupted by a signal */
+	}
+}
+
+static FAR struct mtd_writeback_block_s *
+writeback_find(FAR struct mtd_writeback_dev_s *priv, off_t block)
+{
+	for (unsigned i = 0; i < priv->nblocks; i++) {
+		if (priv->blocks[i].block == block) {
+			return &priv->blocks[i];
+		}
+	}
+
+	return NULL;
+}
+
+/* free or least recently used clean block, NULL if all are dirty or being written */
+static FAR struct mtd_writeback_block_s *
+writeback_replaceable(FAR struct mtd_writeback_dev_s *priv)
+{
+	FAR struct mtd_writeback_block_s *result = NULL;
+
+	for (unsigned i = 0; i < priv->nblocks; i++) {
+		FAR struct mtd_writeback_block_s *b = &priv->blocks[i];
+
+		if (b->block < 0) {
+			return b;
+		}
+
+		if (!b->dirty && !b->writing && (result == NULL || (int32_t)(b->last_use - result->last_use) < 0)) {
+			result = b;
+		}
+	}
+
+	return result;
+}
+
+static bool
+writeback_has_dirty(FAR struct mtd_writeback_dev_s *priv)
+{
+	for (unsigned i = 0; i < priv->nblocks; i++) {
+		if (priv->blocks[i].dirty || priv->blocks[i].writing) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/*
+ * Write one dirty block to the device (called with write_lock held).
+ * Returns 1 if a block was written, 0 if none is dirty, <0 on error.
+ */
+static int
+writeback_write_next(FAR struct mtd_writeback_dev_s *priv)
+{
+	FAR struct mtd_writeback_block_s *b = NULL;
+
+	writeback_lock(&priv->lock);
+
+	for (unsigned i = 0; i < priv->nblocks; i++) {
+		if (priv->blocks[i].dirty && (b == NULL || priv->blocks[i].block < b->block)) {
+			b = &priv->blocks[i];
+		}
+	}
+
+	if (b == NULL) {
+		sem_post(&priv->lock);
+		return 0;
+	}
+
+	/*
+	 * A write of the block while the device is written marks it dirty again. The block cannot be
+	 * replaced until the write returns, and erase waits for write_lock, so b stays valid.
+	 */
+	off_t block = b->block;
+	memcpy(priv->write_buffer, b->data, priv->blocksize);
+	b->dirty = false;
+	b->writing = true;
+
+	sem_post(&priv->lock);
+
+	perf_count(priv->perf_device_writes);
+	ssize_t ret = MTD_BWRITE(priv->dev, block, 1, priv->write_buffer);
+
+	writeback_lock(&priv->lock);
+
+	b->writing = false;
+
+	if (ret != 1) {
+		perf_count(priv->perf_errors);
+		b->dirty = true;
+	}
+
+	sem_post(&priv->lock);
+
+	return ret != 1 ? (ret < 0 ? (int)ret : -EIO) : 1;
+}
+
+static void
+writeback_worker(FAR void *arg)
+{
+	FAR struct mtd_writeback_dev_s *priv = (FAR struct mtd_writeback_dev_s *)arg;
+	int ret;
+
+	writeback_lock(&priv->write_lock);
+
+	do {
+		ret = writeback_write_next(priv);
+	} while (ret > 0);
+
+	sem_post(&priv->write_lock);
+
+	if (ret < 0) {
+		work_queue(LPWORK, &priv->work, writeback_worker, priv, USEC2TICK(MTD_WRITEBACK_RETRY_US));
+	}
+}
+
+/* called with lock held */
+static void
+writeback_schedule(FAR struct mtd_writeback_dev_s *priv, uint32_t delay_us)
+{
+	if (work_available(&priv->work)) {
+		work_queue(LPWORK, &priv->work, writeback_worker, priv, USEC2TICK(delay_us));
+	}
+}
+
+static int
+writeback_erase(FAR struct mtd_dev_s *dev, off_t startblock, size_t nblocks)
+{
+	FAR struct mtd_writeback_dev_s *priv = (FAR struct mtd_writeback_dev_s *)dev;
+
+	/* the erase replaces any queued write of these blocks */
+	writeback_lock(&priv->write_lock);
+	writeback_lock(&priv->lock);
+
+	const off_t first = startblock * priv->blkpererase;
+	const off_t last = (startblock + nblocks) * priv->blkpererase;
+
+	for (unsigned i = 0; i < priv->nblocks; i++) {
+		if (priv->blocks[i].block >= first && priv->blocks[i].block < last) {
+			priv->blocks[i].block = -1;
+			priv->blocks[i].dirty = false;
+		}
+	}
+
+	sem_post(&priv->lock);
+
+	int ret = MTD_ERASE(priv->dev, startblock, nblocks);
+
+	sem_post(&priv->write_lock);
+	return ret;
+}
+
+static ssize_t
+writeback_bread(FAR struct mtd_dev_s *dev, off_t startblock, size_t nblocks, FAR uint8_t *buffer)
+{
+	FAR struct mtd_writeback_dev_s *priv = (FAR struct mtd_writeback_dev_s *)dev;
+	ssize_t ret = nblocks;
+
+	writeback_lock(&priv->lock);
+
+	size_t i = 0;
+
+	while (i < nblocks) {
+		FAR struct mtd_writeback_block_s *b = writeback_find(priv, startblock + i);
+
+		if (b != NULL) {
+			memcpy(buffer + i * priv->blocksize, b->data, priv->blocksize);
+			b->last_use = ++priv->use_counter;
+			perf_count(priv->perf_read_hits);
+			i++;
+			continue;
+		}
+
+		/* read the run of blocks which are not in RAM at once */
+		size_t n = 1;
+
+		while (i + n < nblocks && writeback_find(priv, startblock + i + n) == NULL) {
+			n++;
+		}
+
+		ssize_t nread = MTD_BREAD(priv->dev, startblock + i, n, buffer + i * priv->blocksize);
+
+		if (nread != (ssize_t)n) {
+			ret = nread < 0 ? nread : (ssize_t)(i + (nread > 0 ? nread : 0));
+			break;
+		}
+
+		i += n;
+	}
+
+	sem_post(&priv->lock);
+	return ret;
+}
+
+static ssize_t
+writeback_read(FAR struct mtd_dev_s *dev, off_t offset, size_t nbytes, FAR uint8_t *buffer)
+{
+	FAR struct mtd_writeback_dev_s *priv = (FAR struct mtd_writeback_dev_s *)dev;
+	size_t done = 0;
+	ssize_t ret = 0;
+
+	writeback_lock(&priv->lock);
+
+	while (done < nbytes) {
+		const off_t block = (offset + done) / priv->blocksize;
+		const size_t block_offset = (offset + done) % priv->blocksize;
+		size_t n = priv->blocksize - block_offset;
+
+		if (n > nbytes - done) {
+			n = nbytes - done;
+		}
+
+		FAR struct mtd_writeback_block_s *b = writeback_find(priv, block);
+
+		if (b != NULL) {
+			memcpy(buffer + done, b->data + block_offset, n);
+			b->last_use = ++priv->use_counter;
+			perf_count(priv->perf_read_hits);
+
+		} else {
+			ret = priv->dev->read(priv->dev, offset + done, n, buffer + done);
+
+			if (ret != (ssize_t)n) {
+				break;
+			}
+		}
+
+		done += n;
+	}
+
+	sem_post(&priv->lock);
+	return done == nbytes ? (ssize_t)nbytes : (ret < 0 ? ret : (ssize_t)done);
+}
+
+static ssize_t
+writeback_bwrite(FAR struct mtd_dev_s *dev, off_t startblock, size_t nblocks, FAR const uint8_t *buffer)
+{
+	FAR struct mtd_writeback_dev_s *priv = (FAR struct mtd_writeback_dev_s *)dev;
+
+	writeback_lock(&priv->lock);
+
+	for (size_t i = 0; i < nblocks; i++) {
+		const off_t block = startblock + i;
+		FAR const uint8_t *data = buffer + i * priv->blocksize;
+		FAR struct mtd_writeback_block_s *b = writeback_find(priv, block);
+
+		if (b == NULL) {
+			b = writeback_replaceable(priv);
+		}
+
+		if (b == NULL) {
+			/* all blocks are dirty: write directly, the block is not in RAM */
+			perf_count(priv->perf_direct);
+			ssize_t ret = MTD_BWRITE(priv->dev, block, 1, data);
+
+			if (ret != 1) {
+				perf_count(priv->perf_errors);
+				sem_post(&priv->lock);
+				return ret < 0 ? ret : -EIO;
+			}
+
+			continue;
+		}
+
+		memcpy(b->data, data, priv->blocksize);
+		b->block = block;
+		b->dirty = true;
+		b->last_use = ++priv->use_counter;
+		perf_count(priv->perf_queued);
+	}
+
+	writeback_schedule(priv, MTD_WRITEBACK_DELAY_US);
+
+	sem_post(&priv->lock);
+	return nblocks;
+}
+
+int
+mtd_writeback_flush(FAR struct mtd_dev_s *dev, bool drop_clean)
+{
+	FAR struct mtd_writeback_dev_s *priv = (FAR struct mtd_writeback_dev_s *)dev;
+	int ret;
+
+	writeback_lock(&priv->write_lock);
+
+	do {
+		ret = writeback_write_next(priv);
+	} while (ret > 0);
+
+	if (ret == 0 && drop_clean) {
+		writeback_lock(&priv->lock);
+
+		for (unsigned i = 0; i < priv->nblocks; i++) {
+			if (!priv->blocks[i].dirty) {
+				priv->blocks[i].block = -1;
+			}
+		}
+
+		sem_post(&priv->lock);
+	}
+
+	sem_post(&priv->write_lock);
+	return ret;
+}
+
+static int
+writeback_ioctl(FAR struct mtd_dev_s *dev, int cmd, unsigned long arg)
+{
+	FAR struct mtd_writeback_dev_s *priv = (FAR struct mtd_writeback_dev_s *)dev;
+
+	switch (cmd) {
+	case MTDBUFIOCFLUSH:
+		return mtd_writeback_flush(dev, arg != 0);
+
+	case MTDIOC_BULKERASE: {
+			writeback_lock(&priv->write_lock);
+			writeback_lock(&priv->lock);
+
+			for (unsigned i = 0; i < priv->nblocks; i++) {
+				priv->blocks[i].block = -1;
+				priv->blocks[i].dirty = false;
+			}
+
+			sem_post(&priv->lock);
+
+			int ret = MTD_IOCTL(priv->dev, cmd, arg);
+
+			sem_post(&priv->write_lock);
+			return ret;
+		}
+
+	default:
+		return MTD_IOCTL(priv->dev, cmd, arg);
+	}
+}
+
+/* let a shutdown or reboot wait for the queued writes */
+static bool
+writeback_shutdown_hook(void)
+{
+	FAR struct mtd_writeback_dev_s *priv = g_writeback;
+
+	if (sem_trywait(&priv->lock) != 0) {
+		return false;
+	}
+
+	bool done = !writeback_has_dirty(priv);
+
+	if (!done) {
+		writeback_schedule(priv, 0);
+	}
+
+	sem_post(&priv->lock);
+	return done;
+}
+
+FAR struct mtd_dev_s *
+mtd_writeback_initialize(FAR struct mtd_dev_s *dev, unsigned nblocks)
+{
+	struct mtd_geometry_s geo;
+
+	if (g_writeback != NULL || nblocks == 0 ||
+	    MTD_IOCTL(dev, MTDIOC_GEOMETRY, (unsigned long)((uintptr_t)&geo)) != OK ||
+	    geo.blocksize == 0 || geo.erasesize < geo.blocksize) {
+		return NULL;
+	}
+
+	FAR struct mtd_writeback_dev_s *priv = (FAR struct mtd_writeback_dev_s *)calloc(1, sizeof(*priv));
+
+	if (priv == NULL) {
+		return NULL;
+	}
+
+	priv->blocks = (FAR struct mtd_writeback_block_s *)calloc(nblocks, sizeof(*priv->blocks));
+	priv->write_buffer = (FAR uint8_t *)malloc((nblocks + 1) * geo.blocksize);
+
+	if (priv->blocks == NULL || priv->write_buffer == NULL) {
+		free(priv->blocks);
+		free(priv->write_buffer);
+		free(priv);
+		return NULL;
+	}
+
+	priv->dev = dev;
+	priv->blocksize = geo.blocksize;
+	priv->blkpererase = geo.erasesize / geo.blocksize;
+	priv->nblocks = nblocks;
+
+	/* the block data follows the write buffer */
+	for (unsigned i = 0; i < nblocks; i++) {
+		priv->blocks[i].block = -1;
+		priv->blocks[i].data = priv->write_buffer + (i + 1) * geo.blocksize;
+	}
+
+	sem_init(&priv->lock, 0, 1);
+	sem_init(&priv->write_lock, 0, 1);
+
+	priv->mtd.erase = writeback_erase;
+	priv->mtd.bread = writeback_bread;
+	priv->mtd.bwrite = writeback_bwrite;
+	priv->mtd.read = dev->read != NULL ? writeback_read : NULL;
+	priv->mtd.ioctl = writeback_ioctl;
+
+	priv->perf_queued = perf_alloc(PC_COUNT, "mtd_wb_queued");
+	priv->perf_direct = perf_alloc(PC_COUNT, "mtd_wb_direct");
+	priv->perf_device_writes = perf_alloc(PC_COUNT, "mtd_wb_dev_writes");
+	priv->perf_read_hits = perf_alloc(PC_COUNT, "mtd_wb_read_hits");
+	priv->perf_errors = perf_alloc(PC_COUNT, "mtd_wb_errors");
+
+	g_writeback = priv;
+
+	if (px4_register_shutdown_hook(writeback_shutdown_hook) != 0) {
+		PX4_WARN("mtd: no shutdown hook, use 'mtd flush' before power off");
+	}
+
+	return &priv->mtd;
+}
+
+void
+mtd_writeback_print_info(FAR struct mtd_dev_s *dev)
+{
+	FAR struct mtd_writeback_dev_s *priv = (FAR struct mtd_writeback_dev_s *)dev;
+	unsigned used = 0;
+	unsigned dirty = 0;
+
+	writeback_lock(&priv->lock);
+
+	for (unsigned i = 0; i < priv->nblocks; i++) {
+		if (priv->blocks[i].block >= 0) {
+			used++;
+		}
+
+		if (priv->blocks[i].dirty) {
+			dirty++;
+		}
+	}
+
+	sem_post(&priv->lock);
+
+	printf("  Write-behind:   %u blocks in RAM, %u used, %u dirty\n", priv->nblocks, used, dirty);
+	perf_print_counter(priv->perf_queued);
+	perf_print_counter(priv->perf_direct);
+	perf_print_counter(priv->perf_device_writes);
+	perf_print_counter(priv->perf_read_hits);
+	perf_print_counter(priv->perf_errors);
+}
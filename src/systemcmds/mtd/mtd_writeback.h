@@ -0,0 +1,70 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2017 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file mtd_writeback.h
+ *
+ * Write-behind queue for MTD devices without a real erase (FRAM, EEPROM).
+ */
+
+#pragma once
+
+#include <nuttx/mtd/mtd.h>
+
+__BEGIN_DECLS
+
+/**
+ * Wrap an MTD device with a write-behind queue: written blocks are copied to RAM and written to
+ * the device on the low priority work queue, reads of these blocks are served from RAM.
+ * Erasing is a no-op on the supported devices, it only drops the queued writes of the erased blocks.
+ * Only one device can be wrapped.
+ *
+ * @param dev the MTD device
+ * @param nblocks number of blocks kept in RAM. Writes which find no free block are written directly.
+ * @return the wrapping MTD device, or NULL on error
+ */
+FAR struct mtd_dev_s *mtd_writeback_initialize(FAR struct mtd_dev_s *dev, unsigned nblocks);
+
+/**
+ * Write all the queued blocks to the device, in the context of the caller.
+ * @param drop_clean drop the RAM copies as well
+ * @return 0 on success, <0 on a write error
+ */
+int mtd_writeback_flush(FAR struct mtd_dev_s *dev, bool drop_clean);
+
+/**
+ * Print the state of the queue and its perf counters.
+ */
+void mtd_writeback_print_info(FAR struct mtd_dev_s *dev);
+
+__END_DECLS
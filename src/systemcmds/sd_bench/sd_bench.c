@@ -37,8 +37,13 @@
  * SD Card benchmarking
  */
 
+#ifdef __PX4_LINUX
+#define _GNU_SOURCE /* fallocate() */
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <fcntl.h>
 #include <unistd.h>
 
@@ -50,11 +55,18 @@
 
 #include <drivers/drv_hrt.h>
 
+#ifdef __PX4_LINUX
+#include <linux/falloc.h>
+#endif
+
 static void	usage(void);
 
 /** sequential write speed test */
 static void	write_test(int fd, uint8_t *block, int block_size);
 
+/** write pattern of the logger, for each write size and fsync interval */
+static void	logger_test(int fd, uint8_t *block);
+
 /**
  * Measure the time for fsync.
  * @param fd
@@ -69,17 +81,61 @@ static const char *BENCHMARK_FILE = PX4_ROOTFSDIR"/fs/microsd/benchmark.tmp";
 static int num_runs; ///< number of runs
 static int run_duration; ///< duration of a single run [ms]
 static bool synchronized; ///< call fsync after each block?
+static int log_rate; ///< logging rate of the logger pattern [KB/s]
+
+/* settings of the logger (LogWriterFile) the pattern reproduces */
+static const int logger_write_sizes[] = { 4, 8, 16, 32 }; ///< SDLOG_WR_SIZE range [KB]
+static const int logger_fsync_intervals[] = { 64, 256, 1024 }; ///< [KB]
+static const int logger_fsync_interval = 256; ///< fsync interval of the logger [KB]
+static const int logger_cluster_size = 4096; ///< writes end on a cluster boundary
+static const int logger_default_buffer = 12; ///< default buffer size (logger -b) [KB]
+static const int logger_throttle_percent = 60; ///< the logger starts to drop topics at this buffer fill
+#ifdef __PX4_LINUX
+static const off_t logger_preallocate_step = 8 * 1024 * 1024;
+#endif
+
+#define LOGGER_MAX_WRITE_SIZE (32 * 1024)
+
+/* histogram of the write times of one run */
+#define LATENCY_BIN_WIDTH 250 ///< [us]
+#define LATENCY_BIN_COUNT 400
+static uint32_t latency_bins[LATENCY_BIN_COUNT];
+
+struct logger_run_s {
+	unsigned writes;
+	uint32_t write_p50; ///< [us]
+	uint32_t write_p99; ///< [us]
+	uint32_t write_max; ///< [us]
+	uint32_t fsync_max; ///< [us]
+	size_t backlog_max; ///< largest amount of data waiting to be written [bytes]
+	bool kept_up; ///< the data rate was sustained
+};
 
 static void
 usage()
 {
-	PRINT_MODULE_DESCRIPTION("Test the speed of an SD Card");
+	PRINT_MODULE_DESCRIPTION(
+		"### Description\n"
+		"Test the speed of an SD Card.\n"
+		"\n"
+		"By default, blocks of a fixed size are written back to back. With -l, the write pattern of the\n"
+		"logger is reproduced instead: data is produced at a fixed rate (-R), written in chunks of at least\n"
+		"the write size that end on a cluster boundary, with an fsync after a fixed amount of data (and file\n"
+		"preallocation on Linux). Each write size of SDLOG_WR_SIZE is run with several fsync intervals\n"
+		"(the logger uses 256 KB). The write time percentiles, the fsync time and the largest backlog are\n"
+		"reported, and the SDLOG_WR_SIZE and logger buffer size (logger -b) with the smallest buffer\n"
+		"requirement are recommended.\n"
+		"\n"
+		"### Examples\n"
+		"$ sd_bench -l -R 150 -d 10000\n");
 
 	PRINT_MODULE_USAGE_NAME_SIMPLE("sd_bench", "command");
 	PRINT_MODULE_USAGE_PARAM_INT('b', 4096, 1, 1000000, "Block size for each read/write", true);
 	PRINT_MODULE_USAGE_PARAM_INT('r', 5, 1, 1000, "Number of runs", true);
 	PRINT_MODULE_USAGE_PARAM_INT('d', 2000, 1, 100000, "Duration of a run in ms", true);
 	PRINT_MODULE_USAGE_PARAM_FLAG('s', "Call fsync after each block (default=at end of each run)", true);
+	PRINT_MODULE_USAGE_PARAM_FLAG('l', "Reproduce the write pattern of the logger and sweep its settings", true);
+	PRINT_MODULE_USAGE_PARAM_INT('R', 100, 1, 10000, "Logging rate for -l in KB/s", true);
 }
 
 int
@@ -89,11 +145,13 @@ sd_bench_main(int argc, char *argv[])
 	int myoptind = 1;
 	int ch;
 	const char *myoptarg = NULL;
+	bool logger_pattern = false;
 	synchronized = false;
 	num_runs = 5;
 	run_duration = 2000;
+	log_rate = 100;
 
-	while ((ch = px4_getopt(argc, argv, "b:r:d:s", &myoptind, &myoptarg)) != EOF) {
+	while ((ch = px4_getopt(argc, argv, "b:r:d:slR:", &myoptind, &myoptarg)) != EOF) {
 		switch (ch) {
 		case 'b':
 			block_size = strtol(myoptarg, NULL, 0);
@@ -111,6 +169,14 @@ sd_bench_main(int argc, char *argv[])
 			synchronized = true;
 			break;
 
+		case 'l':
+			logger_pattern = true;
+			break;
+
+		case 'R':
+			log_rate = strtol(myoptarg, NULL, 0);
+			break;
+
 		default:
 			usage();
 			return -1;
@@ -118,7 +184,11 @@ sd_bench_main(int argc, char *argv[])
 		}
 	}
 
-	if (block_size <= 0 || num_runs <= 0) {
+	if (logger_pattern) {
+		block_size = LOGGER_MAX_WRITE_SIZE;
+	}
+
+	if (block_size <= 0 || num_runs <= 0 || run_duration <= 0 || log_rate <= 0) {
 		PX4_ERR("invalid argument");
 		return -1;
 	}
@@ -143,8 +213,13 @@ sd_bench_main(int argc, char *argv[])
 		block[i] = (uint8_t)i;
 	}
 
-	PX4_INFO("Using block size = %i bytes, sync=%i", block_size, (int)synchronized);
-	write_test(bench_fd, block, block_size);
+	if (logger_pattern) {
+		logger_test(bench_fd, block);
+
+	} else {
+		PX4_INFO("Using block size = %i bytes, sync=%i", block_size, (int)synchronized);
+		write_test(bench_fd, block, block_size);
+	}
 
 	free(block);
 	close(bench_fd);
@@ -212,3 +287,190 @@ void write_test(int fd, uint8_t *block, int block_size)
 
 	PX4_INFO("  Avg   : %8.2lf KB/s", (double)block_size * total_blocks / total_elapsed / 1024.);
 }
+
+static uint32_t latency_percentile(unsigned count, uint32_t max, int pct)
+{
+	const unsigned rank = (count * pct + 99) / 100;
+	unsigned sum = 0;
+
+	for (int bin = 0; bin < LATENCY_BIN_COUNT; bin++) {
+		sum += latency_bins[bin];
+
+		if (sum >= rank) {
+			/* upper edge of the bin, but not above the largest value */
+			const uint32_t latency = (bin + 1) * LATENCY_BIN_WIDTH;
+			return latency < max ? latency : max;
+		}
+	}
+
+	return max;
+}
+
+/**
+ * Run the logger pattern with one setting.
+ * @return 0 on success, -1 on a write error
+ */
+static int logger_run(int fd, uint8_t *block, int write_size, int fsync_interval, struct logger_run_s *result)
+{
+	const uint64_t rate = (uint64_t)log_rate * 1024; /* [bytes/s] */
+
+	memset(result, 0, sizeof(*result));
+	memset(latency_bins, 0, sizeof(latency_bins));
+
+	/* start with an empty file, like a new log */
+	if (ftruncate(fd, 0) != 0 || lseek(fd, 0, SEEK_SET) != 0) {
+		PX4_ERR("Can't truncate benchmark file");
+		return -1;
+	}
+
+#ifdef __PX4_LINUX
+	off_t preallocated = 0;
+#endif
+	uint64_t written = 0;
+	uint64_t since_fsync = 0;
+	size_t backlog = 0;
+	const hrt_abstime start = hrt_absolute_time();
+	hrt_abstime elapsed = 0;
+
+	while ((elapsed = hrt_elapsed_time(&start)) < (hrt_abstime)run_duration * 1000) {
+		const uint64_t produced = rate * elapsed / 1000000;
+		backlog = produced > written ? produced - written : 0;
+
+		if (backlog > result->backlog_max) {
+			result->backlog_max = backlog;
+		}
+
+		/* the writer waits for at least one write size of data */
+		if (backlog < (size_t)write_size) {
+			const uint64_t ready = (written + write_size) * 1000000 / rate;
+			usleep(ready > elapsed ? ready - elapsed : 1);
+			continue;
+		}
+
+		/* write what is available, ending on a cluster boundary */
+		size_t size = backlog & ~(size_t)(logger_cluster_size - 1);
+
+		if (size > LOGGER_MAX_WRITE_SIZE) {
+			size = LOGGER_MAX_WRITE_SIZE;
+		}
+
+		const hrt_abstime write_start = hrt_absolute_time();
+		const ssize_t ret = write(fd, block, size);
+		const uint32_t write_time = hrt_elapsed_time(&write_start);
+
+		if (ret != (ssize_t)size) {
+			PX4_ERR("Write error");
+			return -1;
+		}
+
+		latency_bins[write_time / LATENCY_BIN_WIDTH < LATENCY_BIN_COUNT ?
+			     write_time / LATENCY_BIN_WIDTH : LATENCY_BIN_COUNT - 1]++;
+		++result->writes;
+
+		if (write_time > result->write_max) {
+			result->write_max = write_time;
+		}
+
+		written += size;
+		since_fsync += size;
+
+		if (since_fsync >= (uint64_t)fsync_interval * 1024) {
+			const hrt_abstime fsync_start = hrt_absolute_time();
+			fsync(fd);
+			const uint32_t fsync_time = hrt_elapsed_time(&fsync_start);
+
+			if (fsync_time > result->fsync_max) {
+				result->fsync_max = fsync_time;
+			}
+
+			since_fsync = 0;
+		}
+
+#ifdef __PX4_LINUX
+
+		/* reserve the file space upfront, as the logger does */
+		if ((off_t)written + write_size * 2 > preallocated) {
+			if (fallocate(fd, FALLOC_FL_KEEP_SIZE, preallocated, logger_preallocate_step) == 0) {
+				preallocated += logger_preallocate_step;
+			}
+		}
+
+#endif /* __PX4_LINUX */
+	}
+
+	/* a card that is too slow accumulates the data until the end of the run */
+	result->kept_up = backlog <= 2 * (size_t)write_size || backlog < result->backlog_max / 2;
+	result->write_p50 = latency_percentile(result->writes, result->write_max, 50);
+	result->write_p99 = latency_percentile(result->writes, result->write_max, 99);
+
+	return 0;
+}
+
+/**
+ * @return logger buffer size that holds the backlog below the throttling threshold [KB]
+ */
+static int logger_buffer_size(const struct logger_run_s *result, int write_size)
+{
+	/* the logger keeps collecting a write size while the backlog is written */
+	const size_t required = (result->backlog_max + write_size * 1024) * 100 / logger_throttle_percent;
+	int buffer = (int)((required + 1023) / 1024);
+
+	/* the write size is limited to half of the buffer */
+	if (buffer < 2 * write_size) {
+		buffer = 2 * write_size;
+	}
+
+	return buffer < logger_default_buffer ? logger_default_buffer : buffer;
+}
+
+void logger_test(int fd, uint8_t *block)
+{
+	const int num_write_sizes = sizeof(logger_write_sizes) / sizeof(logger_write_sizes[0]);
+	const int num_fsync_intervals = sizeof(logger_fsync_intervals) / sizeof(logger_fsync_intervals[0]);
+	int best_write_size = 0;
+	int best_buffer = 0;
+
+	PX4_INFO("");
+	PX4_INFO("Testing the logger write pattern at %i KB/s...", log_rate);
+	PX4_INFO("  write fsync  writes  p50 [ms]  p99 [ms]  max [ms]  fsync [ms]  backlog [KB]  buffer [KB]");
+
+	for (int i = 0; i < num_write_sizes; ++i) {
+		for (int j = 0; j < num_fsync_intervals; ++j) {
+			const int write_size = logger_write_sizes[i];
+			const int fsync_interval = logger_fsync_intervals[j];
+			struct logger_run_s result;
+
+			if (logger_run(fd, block, write_size * 1024, fsync_interval, &result) != 0) {
+				return;
+			}
+
+			const int buffer = logger_buffer_size(&result, write_size);
+			char buffer_str[12] = "too slow";
+
+			if (result.kept_up) {
+				snprintf(buffer_str, sizeof(buffer_str), "%i", buffer);
+			}
+
+			PX4_INFO("  %5i %5i %7u %9.2f %9.2f %9.2f %11.2f %13u %12s",
+				 write_size, fsync_interval, result.writes,
+				 (double)result.write_p50 / 1000., (double)result.write_p99 / 1000.,
+				 (double)result.write_max / 1000., (double)result.fsync_max / 1000.,
+				 (unsigned)((result.backlog_max + 1023) / 1024), buffer_str);
+
+			/* the recommendation is for the fsync interval of the logger */
+			if (result.kept_up && fsync_interval == logger_fsync_interval &&
+			    (best_write_size == 0 || buffer < best_buffer)) {
+				best_write_size = write_size;
+				best_buffer = buffer;
+			}
+		}
+	}
+
+	if (best_write_size == 0) {
+		PX4_WARN("The card does not sustain %i KB/s: reduce the logging rate (SDLOG_PROFILE)", log_rate);
+		return;
+	}
+
+	PX4_INFO("Recommended: SDLOG_WR_SIZE %i, logger buffer %i KB (logger start -b %i)",
+		 best_write_size, best_buffer, best_buffer);
+}
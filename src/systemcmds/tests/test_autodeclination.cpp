@@ -29,6 +29,16 @@ bool AutoDeclinationTest::autodeclination_check()
 	ut_assert("declination differs more than 0.1 degrees", get_mag_declination(-90.0, -180.0) - 47.0f < 0.1f);
 	ut_assert("declination differs more than 0.1 degrees", get_mag_declination(90.0, -180.0) - 3.0f < 0.1f);
 	ut_assert("declination differs more than 0.1 degrees", get_mag_declination(90.0, 180.0) - 3.0f < 0.1f);
+	// Test interpolation on the southern and western hemisphere
+	ut_assert("declination differs more than 0.1 degrees", fabsf(get_mag_declination(-30.0, -50.0) + 17.0f) < 0.1f);
+	ut_assert("declination differs more than 0.1 degrees", fabsf(get_mag_declination(-35.0, -55.0) + 10.0f) < 0.1f);
+
+	// The cached value is kept for small position changes
+	mag_declination_cache_s cache{};
+	ut_assert("declination differs more than 0.1 degrees",
+		  fabsf(get_mag_declination_cached(&cache, -35.0, -55.0) + 10.0f) < 0.1f);
+	ut_assert("cached declination changed", get_mag_declination_cached(&cache, -35.005, -55.005) == cache.declination);
+	ut_assert("declination not updated", fabsf(get_mag_declination_cached(&cache, -30.0, -50.0) + 17.0f) < 0.1f);
 
 	return true;
 }
@@ -157,6 +157,70 @@ fail:
 	return -1;
 }
 
+#define NUM_RANGE_ITEMS_TEST 20
+#define RANGE_ITEM_SIZE 16
+
+static volatile ssize_t async_result;
+static volatile bool async_done;
+
+static void
+async_completed(void *arg, ssize_t result)
+{
+	async_result = result;
+	async_done = true;
+}
+
+static int
+test_range(void)
+{
+	static uint8_t items[NUM_RANGE_ITEMS_TEST][RANGE_ITEM_SIZE];
+	static uint8_t read_items[NUM_RANGE_ITEMS_TEST][RANGE_ITEM_SIZE];
+
+	for (unsigned i = 0; i < NUM_RANGE_ITEMS_TEST; i++) {
+		memset(items[i], i + 1, RANGE_ITEM_SIZE);
+	}
+
+	/* first half blocking, second half asynchronous */
+	if (dm_write_range(DM_KEY_WAYPOINTS_OFFBOARD_1, 0, NUM_RANGE_ITEMS_TEST / 2, DM_PERSIST_VOLATILE, items,
+			   RANGE_ITEM_SIZE) != NUM_RANGE_ITEMS_TEST / 2) {
+		PX4_ERR("range write failed");
+		return -1;
+	}
+
+	async_done = false;
+
+	if (dm_write_range_async(DM_KEY_WAYPOINTS_OFFBOARD_1, NUM_RANGE_ITEMS_TEST / 2, NUM_RANGE_ITEMS_TEST / 2,
+				 DM_PERSIST_VOLATILE, items[NUM_RANGE_ITEMS_TEST / 2], RANGE_ITEM_SIZE, async_completed, NULL) != 0) {
+		PX4_ERR("async range write failed");
+		return -1;
+	}
+
+	/* requests are processed in order: the async write is completed when this returns */
+	if (dm_read_range(DM_KEY_WAYPOINTS_OFFBOARD_1, 0, NUM_RANGE_ITEMS_TEST, read_items,
+			  RANGE_ITEM_SIZE) != NUM_RANGE_ITEMS_TEST) {
+		PX4_ERR("range read failed");
+		return -1;
+	}
+
+	if (!async_done || async_result != NUM_RANGE_ITEMS_TEST / 2) {
+		PX4_ERR("async range write not completed (%d)", (int)async_result);
+		return -1;
+	}
+
+	if (memcmp(items, read_items, sizeof(items)) != 0) {
+		PX4_ERR("range data verification failed");
+		return -1;
+	}
+
+	/* reading stops at the end of the item type */
+	if (dm_read_range(DM_KEY_SAFE_POINTS, DM_KEY_SAFE_POINTS_MAX - 1, 2, read_items, RANGE_ITEM_SIZE) > 1) {
+		PX4_ERR("range read beyond the last index");
+		return -1;
+	}
+
+	return 0;
+}
+
 int test_dataman(int argc, char *argv[])
 {
 	int i = 0;
@@ -234,5 +298,11 @@ int test_dataman(int argc, char *argv[])
 		}
 	}
 
+	if (test_range() != 0) {
+		return -1;
+	}
+
+	dm_restart(DM_INIT_REASON_POWER_ON);
+
 	return 0;
 }
@@ -0,0 +1,151 @@
+#include <unit_test.h>
+
+#include <drivers/drv_hrt.h>
+#include <geo/geo.h>
+#include <px4_log.h>
+
+#include <float.h>
+#include <math.h>
+
+class GeoTest : public UnitTest
+{
+public:
+	virtual bool run_tests();
+
+private:
+	bool projectLocalAccuracy();
+	bool reprojectLocalAccuracy();
+	bool projectLocalBenchmark();
+
+	/** maximum allowed error of the local projection at a distance from the reference (m) */
+	static float max_error(float distance) { return 1e-6f * distance + 1e-3f; }
+
+	static constexpr int num_refs = 5;
+	static const double refs[num_refs][2];
+};
+
+const double GeoTest::refs[num_refs][2] = {
+	{47.3977419, 8.5455938},
+	{-33.8688197, 151.2092955},
+	{0.0, 179.99},
+	{78.2232, 15.6267},
+	{-60.5, -45.0}
+};
+
+bool GeoTest::run_tests()
+{
+	ut_run_test(projectLocalAccuracy);
+	ut_run_test(reprojectLocalAccuracy);
+	ut_run_test(projectLocalBenchmark);
+
+	return (_tests_failed == 0);
+}
+
+bool GeoTest::projectLocalAccuracy()
+{
+	const float distances[] = {1.0f, 100.0f, 1000.0f, 10000.0f, 100000.0f};
+
+	for (int i = 0; i < num_refs; i++) {
+		struct map_projection_reference_s ref;
+		map_projection_init(&ref, refs[i][0], refs[i][1]);
+
+		for (float distance : distances) {
+			for (int j = 0; j < 16; j++) {
+				const float bearing = j * M_TWOPI_F / 16;
+				double lat, lon;
+				map_projection_reproject(&ref, distance * cosf(bearing), distance * sinf(bearing), &lat, &lon);
+
+				float x, y, x_local, y_local;
+				map_projection_project(&ref, lat, lon, &x, &y);
+				ut_assert_true(map_projection_project_local(&ref, lat, lon, &x_local, &y_local) == 0);
+				ut_assert("local projection error", sqrtf((x_local - x) * (x_local - x) + (y_local - y) * (y_local - y))
+					  < max_error(distance));
+			}
+		}
+	}
+
+	return true;
+}
+
+bool GeoTest::reprojectLocalAccuracy()
+{
+	const float distances[] = {0.0f, 0.1f, 10.0f, 1000.0f, 10000.0f, 100000.0f};
+
+	for (int i = 0; i < num_refs; i++) {
+		struct map_projection_reference_s ref;
+		map_projection_init(&ref, refs[i][0], refs[i][1]);
+
+		for (float distance : distances) {
+			for (int j = 0; j < 16; j++) {
+				const float bearing = j * M_TWOPI_F / 16;
+				const float x = distance * cosf(bearing);
+				const float y = distance * sinf(bearing);
+
+				double lat, lon;
+				ut_assert_true(map_projection_reproject_local(&ref, x, y, &lat, &lon) == 0);
+
+				float x_local, y_local;
+				map_projection_project_local(&ref, lat, lon, &x_local, &y_local);
+				ut_assert("local round trip error", sqrtf((x_local - x) * (x_local - x) + (y_local - y) * (y_local - y))
+					  < max_error(distance));
+			}
+		}
+	}
+
+	return true;
+}
+
+bool GeoTest::projectLocalBenchmark()
+{
+	struct map_projection_reference_s ref;
+	map_projection_init(&ref, refs[0][0], refs[0][1]);
+
+	const int n = 10000;
+	float x = 0.0f;
+	float y = 0.0f;
+	double lat = 0.0;
+	double lon = 0.0;
+	double x_sum = 0.0;
+	double lat_sum = 0.0;
+
+	hrt_abstime t0 = hrt_absolute_time();
+
+	for (int i = 0; i < n; i++) {
+		map_projection_project(&ref, refs[0][0] + i * 1e-7, refs[0][1], &x, &y);
+		x_sum += x;
+	}
+
+	hrt_abstime t1 = hrt_absolute_time();
+
+	for (int i = 0; i < n; i++) {
+		map_projection_project_local(&ref, refs[0][0] + i * 1e-7, refs[0][1], &x, &y);
+		x_sum -= x;
+	}
+
+	hrt_abstime t2 = hrt_absolute_time();
+
+	for (int i = 0; i < n; i++) {
+		map_projection_reproject(&ref, i * 0.1f, 10.0f, &lat, &lon);
+		lat_sum += lat;
+	}
+
+	hrt_abstime t3 = hrt_absolute_time();
+
+	for (int i = 0; i < n; i++) {
+		map_projection_reproject_local(&ref, i * 0.1f, 10.0f, &lat, &lon);
+		lat_sum -= lat;
+	}
+
+	hrt_abstime t4 = hrt_absolute_time();
+
+	PX4_INFO("map_projection_project: %.3f us, local: %.3f us", (double)(t1 - t0) / n, (double)(t2 - t1) / n);
+	PX4_INFO("map_projection_reproject: %.3f us, local: %.3f us", (double)(t3 - t2) / n, (double)(t4 - t3) / n);
+
+	// the sums are only used to keep the calls from being optimized away, they are close to zero
+	ut_assert_true(fabs(x_sum) < 1.0);
+	ut_assert_true(fabs(lat_sum) < 1e-3);
+
+	return true;
+}
+
+ut_declare_test_c(test_geo, GeoTest)
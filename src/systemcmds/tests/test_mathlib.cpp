@@ -73,6 +73,7 @@ private:
 	bool testQuaternionfrom_dcm();
 	bool testQuaternionfrom_euler();
 	bool testQuaternionRotate();
+	bool testFastMath();
 };
 
 #define TEST_OP(_title, _op) { unsigned int n = 30000; hrt_abstime t0, t1; t0 = hrt_absolute_time(); for (unsigned int j = 0; j < n; j++) { _op; }; t1 = hrt_absolute_time(); PX4_INFO(_title ": %.6fus", (double)(t1 - t0) / n); }
@@ -419,6 +420,63 @@ bool MathlibTest::testQuaternionRotate()
 	return true;
 }
 
+bool MathlibTest::testFastMath()
+{
+	float max_error_atan2 = 0.0f;
+	float max_error_asin = 0.0f;
+	float max_error_sin = 0.0f;
+	float max_error_cos = 0.0f;
+
+	for (int i = 0; i <= 20000; i++) {
+		const float angle = -M_PI_F + M_TWOPI_F * i / 20000;
+		const float y = 3.7f * sinf(angle);
+		const float x = 3.7f * cosf(angle);
+		float error = fabsf(fast_atan2f(y, x) - atan2f(y, x));
+
+		/* +-pi is the same angle */
+		if (error > M_PI_F) {
+			error = fabsf(error - M_TWOPI_F);
+		}
+
+		max_error_atan2 = math::max(max_error_atan2, error);
+
+		const float v = -1.0f + 2.0f * i / 20000;
+		max_error_asin = math::max(max_error_asin, fabsf(fast_asinf(v) - asinf(v)));
+
+		const float a = 2.0f * angle;
+		max_error_sin = math::max(max_error_sin, fabsf(fast_sinf(a) - sinf(a)));
+		max_error_cos = math::max(max_error_cos, fabsf(fast_cosf(a) - cosf(a)));
+	}
+
+	PX4_INFO("max error atan2 %.2e asin %.2e sin %.2e cos %.2e", (double)max_error_atan2, (double)max_error_asin,
+		 (double)max_error_sin, (double)max_error_cos);
+
+	ut_assert("fast_atan2f outside tolerance", max_error_atan2 < 1.2e-5f);
+	ut_assert("fast_asinf outside tolerance", max_error_asin < 2e-5f);
+	ut_assert("fast_sinf outside tolerance", max_error_sin < 1e-6f);
+	ut_assert("fast_cosf outside tolerance", max_error_cos < 1e-6f);
+	ut_assert("fast_sqrtf wrong", fast_sqrtf(2.0f) == sqrtf(2.0f));
+	ut_assert("fast_atan2f(0, 0) not 0", fast_atan2f(0.0f, 0.0f) == 0.0f);
+
+	/* volatile operands, so that the compiler cannot hoist the calls out of the loop */
+	volatile float in_y = 0.3f;
+	volatile float in_x = -0.7f;
+	volatile float out;
+	TEST_OP("atan2f", out = atan2f(in_y, in_x));
+	TEST_OP("fast_atan2f", out = fast_atan2f(in_y, in_x));
+	TEST_OP("asinf", out = asinf(in_y));
+	TEST_OP("fast_asinf", out = fast_asinf(in_y));
+	TEST_OP("sinf", out = sinf(in_x));
+	TEST_OP("fast_sinf", out = fast_sinf(in_x));
+	TEST_OP("cosf", out = cosf(in_x));
+	TEST_OP("fast_cosf", out = fast_cosf(in_x));
+	TEST_OP("sqrtf", out = sqrtf(in_y));
+	TEST_OP("fast_sqrtf", out = fast_sqrtf(in_y));
+	(void)out;
+
+	return true;
+}
+
 bool MathlibTest::run_tests()
 {
 	ut_run_test(testVector2);
@@ -432,6 +490,7 @@ bool MathlibTest::run_tests()
 	ut_run_test(testQuaternionfrom_dcm);
 	ut_run_test(testQuaternionfrom_euler);
 	ut_run_test(testQuaternionRotate);
+	ut_run_test(testFastMath);
 
 	return (_tests_failed == 0);
 }
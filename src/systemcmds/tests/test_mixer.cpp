@@ -70,6 +70,10 @@ static int	mixer_callback(uintptr_t handle,
 			       uint8_t control_group,
 			       uint8_t control_index,
 			       float &control);
+static int	mixer_callback_fixed(uintptr_t handle,
+				     uint8_t control_group,
+				     uint8_t control_index,
+				     int32_t &control);
 
 const unsigned output_max = 8;
 static float actuator_controls[output_max];
@@ -110,6 +114,9 @@ public:
 
 private:
 	bool mixerTest();
+	bool singlePassTest();
+	bool compiledTest();
+	bool binaryTest();
 	bool loadIOPass();
 	bool loadVTOL1Test();
 	bool loadVTOL2Test();
@@ -137,6 +144,9 @@ bool MixerTest::run_tests()
 	ut_run_test(loadComplexTest);
 	ut_run_test(loadAllTest);
 	ut_run_test(mixerTest);
+	ut_run_test(singlePassTest);
+	ut_run_test(compiledTest);
+	ut_run_test(binaryTest);
 
 	return (_tests_failed == 0);
 }
@@ -587,6 +597,193 @@ bool MixerTest::mixerTest()
 	return true;
 }
 
+bool MixerTest::singlePassTest()
+{
+	const float idle_speed = 0.1f;
+	uint32_t seed = 1;
+
+	for (unsigned g = 0; g < MultirotorMixer::geometry_count(); g++) {
+		MultirotorMixer reference(mixer_callback, 0, (MultirotorGeometry)g, 1.0f, 1.0f, 1.0f, idle_speed);
+		MultirotorMixer single_pass(mixer_callback, 0, (MultirotorGeometry)g, 1.0f, 1.0f, 1.0f, idle_speed);
+		single_pass.set_single_pass(true);
+		ut_assert("single-pass mode enabled", single_pass.single_pass());
+
+		for (unsigned k = 0; k < 1000; k++) {
+			/* alternate small (unsaturated) and full range controls */
+			const float range = (k & 1) ? 0.2f : 1.0f;
+
+			for (unsigned i = 0; i < 4; i++) {
+				seed = seed * 1103515245u + 12345u;
+				const float r = (seed >> 8) / (float)(1 << 24);
+				actuator_controls[i] = (i == 3) ? (0.3f + 0.4f * r) : range * (2.0f * r - 1.0f);
+			}
+
+			float out_ref[MultirotorMixer::MAX_ROTORS];
+			float out_single[MultirotorMixer::MAX_ROTORS];
+			const unsigned n = reference.mix(out_ref, MultirotorMixer::MAX_ROTORS);
+			ut_compare("rotor count", single_pass.mix(out_single, MultirotorMixer::MAX_ROTORS), n);
+
+			/* without saturation, both modes must produce the same outputs and status */
+			const bool saturated = (reference.get_saturation_status() & ~1) != 0;
+
+			for (unsigned i = 0; i < n; i++) {
+				/* the outputs are in [-1, 1], with the idle speed shifted accordingly */
+				ut_assert("output in range", out_single[i] >= 2.0f * idle_speed - 1.0f && out_single[i] <= 1.0f);
+
+				if (!saturated) {
+					ut_assert("unsaturated output", fabsf(out_single[i] - out_ref[i]) < 1e-5f);
+				}
+			}
+
+			if (!saturated) {
+				ut_compare("saturation status", single_pass.get_saturation_status(), reference.get_saturation_status());
+			}
+		}
+	}
+
+	return true;
+}
+
+bool MixerTest::compiledTest()
+{
+	const char *files[] = { MIXER_PATH(complex_test.mix), MIXER_PATH(quad_test.mix), MIXER_PATH(vtol2_test.mix) };
+
+	for (unsigned f = 0; f < sizeof(files) / sizeof(files[0]); f++) {
+		char buf[2048];
+		ut_assert("load mixer file", load_mixer_file(files[f], &buf[0], sizeof(buf)) == 0);
+
+		MixerGroup list(mixer_callback, 0);
+		MixerGroup program(mixer_callback, 0);
+		unsigned buflen = strlen(buf);
+		ut_compare("load list", list.load_from_buf(buf, buflen), 0);
+		buflen = strlen(buf);
+		ut_compare("load program", program.load_from_buf(buf, buflen), 0);
+
+		ut_compare("compile", program.compile(), 0);
+		ut_assert("compiled", program.compiled());
+
+		MixerGroup fixed(mixer_callback, 0);
+		buflen = strlen(buf);
+		ut_compare("load fixed", fixed.load_from_buf(buf, buflen), 0);
+		ut_compare("compile fixed", fixed.compile_fixed(mixer_callback_fixed), 0);
+
+		for (unsigned k = 0; k < 100; k++) {
+			for (unsigned i = 0; i < output_max; i++) {
+				actuator_controls[i] = (((k * 7 + i * 13) % 41) - 20) / 20.0f;
+			}
+
+			float out_list[output_max * 2];
+			float out_program[output_max * 2];
+			const unsigned n = list.mix(out_list, output_max * 2);
+			ut_compare("output count", program.mix(out_program, output_max * 2), n);
+
+			/* same operations in the same order, so the outputs are identical */
+			for (unsigned i = 0; i < n; i++) {
+				ut_assert("compiled output", out_program[i] == out_list[i]);
+			}
+		}
+
+		/* trims must reach the program */
+		int16_t trims[output_max * 2] = { 1000, -1000, 500 };
+		list.set_trims(trims, output_max * 2);
+		program.set_trims(trims, output_max * 2);
+		fixed.set_trims(trims, output_max * 2);
+		ut_assert("still compiled", program.compiled());
+
+		float out_list[output_max * 2];
+		float out_program[output_max * 2];
+		float out_fixed[output_max * 2];
+		const unsigned n = list.mix(out_list, output_max * 2);
+		program.mix(out_program, output_max * 2);
+		fixed.mix(out_fixed, output_max * 2);
+
+		for (unsigned i = 0; i < n; i++) {
+			ut_assert("trimmed output", out_program[i] == out_list[i]);
+			ut_assert("trimmed fixed output", fabsf(out_fixed[i] - out_list[i]) < 1.5e-4f);
+		}
+
+		/* adding a mixer discards the program */
+		program.add_mixer(new NullMixer());
+		ut_assert("program discarded", !program.compiled());
+	}
+
+	return true;
+}
+
+static uint8_t *append_record(uint8_t *p, uint8_t type, const void *payload, uint16_t length)
+{
+	mixer_binary_record_s record = { type, 0, length };
+	memcpy(p, &record, sizeof(record));
+	memcpy(p + sizeof(record), payload, length);
+	return p + sizeof(record) + length;
+}
+
+bool MixerTest::binaryTest()
+{
+	char text[] =
+		"Z:\n"
+		"M: 2\n"
+		"O: 10000 8000 500 -9000 9500\n"
+		"S: 0 0 10000 10000 0 -10000 10000\n"
+		"S: 0 1 -5000 -7000 1000 -10000 10000\n"
+		"R: 4x 10000 9000 5000 1000\n";
+
+	/* the same mixers as generated by Tools/px_generate_mixer_binaries.py */
+	uint8_t binary[512];
+	mixer_binary_header_s header = { MIXER_BINARY_MAGIC, MIXER_BINARY_VERSION, 3 };
+	memcpy(binary, &header, sizeof(header));
+	uint8_t *p = append_record(binary + sizeof(header), 'Z', nullptr, 0);
+
+	uint8_t simple_buf[MIXER_SIMPLE_SIZE(2)];
+	mixer_simple_s *simple = (mixer_simple_s *)simple_buf;
+	memset(simple_buf, 0, sizeof(simple_buf));
+	simple->control_count = 2;
+	simple->output_scaler = { 1.0f, 8000 / 10000.0f, 500 / 10000.0f, -9000 / 10000.0f, 9500 / 10000.0f };
+	simple->controls[0] = { 0, 0, { 1.0f, 1.0f, 0.0f, -1.0f, 1.0f } };
+	simple->controls[1] = { 0, 1, { -5000 / 10000.0f, -7000 / 10000.0f, 1000 / 10000.0f, -1.0f, 1.0f } };
+	p = append_record(p, 'M', simple_buf, sizeof(simple_buf));
+
+	mixer_multirotor_binary_s multirotor = { "4x", 1.0f, 9000 / 10000.0f, 5000 / 10000.0f, 1000 / 10000.0f };
+	p = append_record(p, 'R', &multirotor, sizeof(multirotor));
+	const unsigned binary_len = p - binary;
+
+	MixerGroup text_group(mixer_callback, 0);
+	MixerGroup binary_group(mixer_callback, 0);
+	unsigned buflen = strlen(text);
+	ut_compare("load text", text_group.load_from_buf(text, buflen), 0);
+	ut_assert("binary detected", MixerGroup::is_binary(binary, binary_len));
+	ut_assert("text not detected as binary", !MixerGroup::is_binary(text, strlen(text)));
+	ut_compare("load binary", binary_group.load_from_binary(binary, binary_len), 0);
+	ut_compare("mixer count", binary_group.count(), text_group.count());
+
+	for (unsigned k = 0; k < 100; k++) {
+		for (unsigned i = 0; i < output_max; i++) {
+			actuator_controls[i] = (((k * 7 + i * 13) % 41) - 20) / 20.0f;
+		}
+
+		float out_text[output_max * 2];
+		float out_binary[output_max * 2];
+		const unsigned n = text_group.mix(out_text, output_max * 2);
+		ut_compare("output count", binary_group.mix(out_binary, output_max * 2), n);
+
+		for (unsigned i = 0; i < n; i++) {
+			ut_assert("binary output", out_binary[i] == out_text[i]);
+		}
+	}
+
+	/* truncated or corrupted definitions are rejected */
+	for (unsigned len = 0; len < binary_len; len++) {
+		MixerGroup group(mixer_callback, 0);
+		ut_assert("truncated binary rejected", group.load_from_binary(binary, len) != 0);
+	}
+
+	binary[sizeof(header)] = 'X';
+	MixerGroup group(mixer_callback, 0);
+	ut_assert("invalid record rejected", group.load_from_binary(binary, binary_len) != 0);
+
+	return true;
+}
+
 static int
 mixer_callback(uintptr_t handle, uint8_t control_group, uint8_t control_index, float &control)
 {
@@ -609,3 +806,14 @@ mixer_callback(uintptr_t handle, uint8_t control_group, uint8_t control_index, f
 
 	return 0;
 }
+
+static int
+mixer_callback_fixed(uintptr_t handle, uint8_t control_group, uint8_t control_index, int32_t &control)
+{
+	float value;
+	const int ret = mixer_callback(handle, control_group, control_index, value);
+
+	control = PX4_ISFINITE(value) ? (int32_t)roundf(value * Mixer::FIXED_ONE) : Mixer::FIXED_INVALID;
+
+	return ret;
+}
@@ -1,5 +1,9 @@
 #include <unit_test.h>
 
+#include <drivers/drv_hrt.h>
+#include <uORB/uORB.h>
+#include <uORB/topics/parameter_update.h>
+
 class ParameterTest : public UnitTest
 {
 public:
@@ -29,6 +33,8 @@ private:
 	bool ResetAllExcludesTwo();
 	bool ResetAllExcludesBoundaryCheck();
 	bool ResetAllExcludesWildcard();
+	bool NotificationCoalesced();
+	bool NotificationImmediate();
 };
 
 bool ParameterTest::_assert_parameter_int_value(param_t param, int32_t expected)
@@ -157,6 +163,82 @@ bool ParameterTest::ResetAllExcludesWildcard()
 	return ret;
 }
 
+bool ParameterTest::NotificationCoalesced()
+{
+	int32_t quiet_ms = 0;
+	param_get(param_find("SYS_PARAM_QUIET"), &quiet_ms);
+
+	if (quiet_ms <= 0) {
+		PX4_INFO("SYS_PARAM_QUIET disabled, skipping");
+		return true;
+	}
+
+	int sub = orb_subscribe(ORB_ID(parameter_update));
+	parameter_update_s update{};
+
+	// let a pending notification of the previous tests pass
+	usleep(quiet_ms * 1000 + 50000);
+	orb_copy(ORB_ID(parameter_update), sub, &update);
+
+	_set_all_int_parameters_to(60);
+	const uint32_t change_count = param_change_count();
+
+	bool updated = true;
+	orb_check(sub, &updated);
+	ut_assert_false(updated);
+
+	// a single notification covering all the changes
+	const hrt_abstime start = hrt_absolute_time();
+
+	while (!updated && hrt_elapsed_time(&start) < 3000000) {
+		usleep(10000);
+		orb_check(sub, &updated);
+	}
+
+	ut_assert_true(updated);
+	orb_copy(ORB_ID(parameter_update), sub, &update);
+	ut_compare("notification does not include all changes", change_count, update.change_count);
+
+	usleep(quiet_ms * 1000 + 50000);
+	orb_check(sub, &updated);
+	orb_unsubscribe(sub);
+	ut_assert_false(updated);
+
+	return true;
+}
+
+bool ParameterTest::NotificationImmediate()
+{
+	int32_t quiet_ms = 0;
+	param_get(param_find("SYS_PARAM_QUIET"), &quiet_ms);
+
+	int sub = orb_subscribe(ORB_ID(parameter_update));
+	parameter_update_s update{};
+
+	// let a pending notification of the previous tests pass
+	usleep(quiet_ms * 1000 + 50000);
+	orb_copy(ORB_ID(parameter_update), sub, &update);
+
+	// the caller announces the change without waiting for the quiet period
+	int32_t value = 70;
+	param_set(param_find("TEST_1"), &value);
+	param_notify_changes();
+
+	bool updated = false;
+	orb_check(sub, &updated);
+	ut_assert_true(updated);
+	orb_copy(ORB_ID(parameter_update), sub, &update);
+	ut_compare("notification does not include the change", param_change_count(), update.change_count);
+
+	// the deferred notification is covered by the immediate one
+	usleep(quiet_ms * 1000 + 50000);
+	orb_check(sub, &updated);
+	orb_unsubscribe(sub);
+	ut_assert_false(updated);
+
+	return true;
+}
+
 bool ParameterTest::run_tests()
 {
 	ut_run_test(SimpleFind);
@@ -165,6 +247,8 @@ bool ParameterTest::run_tests()
 	ut_run_test(ResetAllExcludesTwo);
 	ut_run_test(ResetAllExcludesBoundaryCheck);
 	ut_run_test(ResetAllExcludesWildcard);
+	ut_run_test(NotificationCoalesced);
+	ut_run_test(NotificationImmediate);
 
 	return (_tests_failed == 0);
 }
@@ -64,6 +64,22 @@ static void print_usage(void)
 
 	PRINT_MODULE_USAGE_NAME_SIMPLE("top", "command");
 	PRINT_MODULE_USAGE_COMMAND_DESCR("once", "print load only once");
+#ifdef __PX4_LINUX
+	PRINT_MODULE_USAGE_COMMAND_DESCR("sched", "show run queue wait times and context switches instead of the load");
+#endif
+}
+
+static void print(uint64_t t, bool sched, struct print_load_s *load)
+{
+#ifdef __PX4_LINUX
+
+	if (sched) {
+		print_load_sched(t, 1, load);
+		return;
+	}
+
+#endif
+	print_load(t, 1, load);
 }
 
 int
@@ -74,24 +90,37 @@ top_main(int argc, char *argv[])
 	struct print_load_s load;
 	init_print_load_s(curr_time, &load);
 
-	/* clear screen */
-	dprintf(1, "\033[2J\n");
+	bool once = false;
+	bool sched = false;
+
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "once")) {
+			once = true;
 
-	if (argc > 1) {
-		if (!strcmp(argv[1], "once")) {
-			print_load(curr_time, 1, &load);
-			sleep(1);
-			print_load(hrt_absolute_time(), 1, &load);
+#ifdef __PX4_LINUX
+
+		} else if (!strcmp(argv[i], "sched")) {
+			sched = true;
+#endif
 
 		} else {
 			print_usage();
+			return 0;
 		}
+	}
+
+	/* clear screen */
+	dprintf(1, "\033[2J\n");
 
+	if (once) {
+		print(curr_time, sched, &load);
+		sleep(1);
+		print(hrt_absolute_time(), sched, &load);
 		return 0;
 	}
 
 	for (;;) {
-		print_load(curr_time, 1, &load);
+		print(curr_time, sched, &load);
 
 		/* Sleep 200 ms waiting for user input five times ~ 1s */
 		for (int k = 0; k < 5; k++) {
@@ -153,6 +153,9 @@ for m in messages:
 print("""
 extern "C" __EXPORT int listener_main(int argc, char *argv[]);
 
+// capture and rate modes (listener_capture.cpp)
+int listener_capture_main(int argc, char *argv[]);
+
 int listener_main(int argc, char *argv[]) {
 	int sub = -1;
 	orb_id_t ID;
@@ -160,6 +163,9 @@ int listener_main(int argc, char *argv[]) {
 		printf("need at least two arguments: topic name. [optional number of messages to print] [optional instance]\\n");
 		return 1;
 	}
+	if (argv[1][0] == '-') {
+		return listener_capture_main(argc, argv);
+	}
 """)
 print("\tunsigned num_msgs = (argc > 2) ? atoi(argv[2]) : 1;")
 print("\tunsigned topic_instance = (argc > 3) ? atoi(argv[3]) : 0;")
@@ -0,0 +1,559 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2017 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file listener_capture.cpp
+ *
+ * Low overhead modes of the listener, for use on a running system: a binary capture of
+ * several topics into a ULog file (-c) and a rate and latency summary (-r). Both only copy
+ * the topic data while measuring and format the output afterwards.
+ */
+
+#include <px4_config.h>
+#include <px4_getopt.h>
+#include <px4_log.h>
+#include <px4_module.h>
+#include <px4_posix.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <drivers/drv_hrt.h>
+#include <logger/messages.h>
+#include <uORB/uORB.h>
+#include <uORB/uORBTopics.h>
+
+int listener_capture_main(int argc, char *argv[]);
+
+namespace
+{
+
+static constexpr unsigned MAX_TOPICS = 8;
+static constexpr unsigned MAX_FORMATS = 16;
+
+/* give up if none of the topics is updated for this long */
+static constexpr hrt_abstime UPDATE_TIMEOUT = 2000000;
+
+static constexpr const char *CAPTURE_FILE = PX4_ROOTFSDIR"/fs/microsd/capture.ulg";
+
+struct CaptureTopic {
+	const orb_metadata *meta;
+	unsigned instance;
+	int fd;
+	unsigned samples;
+
+	/* rate mode */
+	hrt_abstime first_update;
+	hrt_abstime last_update;
+	uint32_t interval_min;
+	uint32_t interval_max;
+	uint64_t latency_sum;
+	unsigned latency_count;
+	uint32_t latency_max;
+};
+
+/** in-memory ULog file */
+struct CaptureBuffer {
+	uint8_t *data;
+	size_t size;
+	size_t pos;
+
+	bool write(const void *src, size_t len)
+	{
+		if (pos + len > size) {
+			return false;
+		}
+
+		memcpy(data + pos, src, len);
+		pos += len;
+		return true;
+	}
+};
+
+void usage()
+{
+	PRINT_MODULE_USAGE_NAME_SIMPLE("listener", "command");
+	PRINT_MODULE_USAGE_PARAM_FLAG('c', "Capture the topics to a ULog file in RAM, written out at the end", true);
+	PRINT_MODULE_USAGE_PARAM_INT('n', 100, 1, 100000, "Samples per topic to capture", true);
+	PRINT_MODULE_USAGE_PARAM_INT('b', 32, 1, 1024, "Capture buffer size in KB", true);
+	PRINT_MODULE_USAGE_PARAM_STRING('o', CAPTURE_FILE, "<file>", "Capture file", true);
+	PRINT_MODULE_USAGE_PARAM_FLAG('r', "Print the update rate, interval and latency of the topics", true);
+	PRINT_MODULE_USAGE_PARAM_INT('t', 5, 1, 3600, "Rate measurement duration in seconds", true);
+	PRINT_MODULE_USAGE_ARG("<topic>[:<instance>] ...", "uORB topics (up to 8)", false);
+}
+
+const orb_metadata *find_topic(const char *name, size_t len)
+{
+	const orb_metadata **topics = orb_get_topics();
+
+	for (size_t i = 0; i < orb_topics_count(); i++) {
+		if (strlen(topics[i]->o_name) == len && strncmp(name, topics[i]->o_name, len) == 0) {
+			return topics[i];
+		}
+	}
+
+	return nullptr;
+}
+
+bool is_basic_type(const char *type, size_t len)
+{
+	static const char *basic_types[] = {"int8_t", "uint8_t", "int16_t", "uint16_t", "int32_t", "uint32_t",
+					    "int64_t", "uint64_t", "float", "double", "bool", "char"
+					   };
+
+	for (const char *basic : basic_types) {
+		if (strlen(basic) == len && strncmp(type, basic, len) == 0) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/**
+ * Write the format of a topic and the formats of the message types it contains, once each.
+ */
+bool write_format(CaptureBuffer &buf, const orb_metadata *meta, const orb_metadata **written, unsigned &num_written)
+{
+	for (unsigned i = 0; i < num_written; i++) {
+		if (written[i] == meta) {
+			return true;
+		}
+	}
+
+	if (num_written >= MAX_FORMATS) {
+		return false;
+	}
+
+	written[num_written++] = meta;
+
+	ulog_message_header_s header;
+	header.msg_type = static_cast<uint8_t>(ULogMessageType::FORMAT);
+	const size_t name_len = strlen(meta->o_name);
+	const size_t fields_len = strlen(meta->o_fields);
+	header.msg_size = name_len + 1 + fields_len;
+
+	if (!buf.write(&header, sizeof(header)) || !buf.write(meta->o_name, name_len) ||
+	    !buf.write(":", 1) || !buf.write(meta->o_fields, fields_len)) {
+		return false;
+	}
+
+	/* fields are "<type>[<array size>] <name>;" */
+	for (const char *field = meta->o_fields; *field != '\0';) {
+		const char *end = strchr(field, ';');
+		size_t type_len = strcspn(field, "[ ");
+
+		if (end == nullptr) {
+			break;
+		}
+
+		if (!is_basic_type(field, type_len)) {
+			const orb_metadata *nested = find_topic(field, type_len);
+
+			if (nested == nullptr || !write_format(buf, nested, written, num_written)) {
+				return false;
+			}
+		}
+
+		field = end + 1;
+	}
+
+	return true;
+}
+
+bool write_ulog_header(CaptureBuffer &buf, CaptureTopic *topics, unsigned num_topics)
+{
+	ulog_file_header_s header = {};
+	memcpy(header.magic, "ULog\x01\x12\x35\x01", sizeof(header.magic));
+	header.timestamp = hrt_absolute_time();
+
+	ulog_message_flag_bits_s flag_bits{};
+	flag_bits.msg_size = sizeof(flag_bits) - ULOG_MSG_HEADER_LEN;
+	flag_bits.msg_type = static_cast<uint8_t>(ULogMessageType::FLAG_BITS);
+
+	if (!buf.write(&header, sizeof(header)) || !buf.write(&flag_bits, sizeof(flag_bits))) {
+		return false;
+	}
+
+	const orb_metadata *written[MAX_FORMATS];
+	unsigned num_written = 0;
+
+	for (unsigned i = 0; i < num_topics; i++) {
+		if (!write_format(buf, topics[i].meta, written, num_written)) {
+			return false;
+		}
+	}
+
+	for (unsigned i = 0; i < num_topics; i++) {
+		ulog_message_add_logged_s msg;
+		const size_t name_len = strlen(topics[i].meta->o_name);
+		msg.msg_id = i;
+		msg.multi_id = topics[i].instance;
+		memcpy(msg.message_name, topics[i].meta->o_name, name_len);
+
+		const size_t msg_size = sizeof(msg) - sizeof(msg.message_name) + name_len;
+		msg.msg_size = msg_size - ULOG_MSG_HEADER_LEN;
+
+		if (!buf.write(&msg, msg_size)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+int capture(CaptureTopic *topics, unsigned num_topics, unsigned num_samples, size_t buffer_size,
+	    const char *file_name)
+{
+	CaptureBuffer buf{};
+	buf.data = (uint8_t *)malloc(buffer_size);
+	buf.size = buffer_size;
+
+	if (buf.data == nullptr) {
+		PX4_ERR("alloc failed");
+		return -ENOMEM;
+	}
+
+	if (!write_ulog_header(buf, topics, num_topics)) {
+		PX4_ERR("buffer too small for the formats");
+		free(buf.data);
+		return -ENOMEM;
+	}
+
+	px4_pollfd_struct_t fds[MAX_TOPICS] = {};
+
+	for (unsigned i = 0; i < num_topics; i++) {
+		fds[i].fd = topics[i].fd;
+		fds[i].events = POLLIN;
+	}
+
+	const hrt_abstime start_time = hrt_absolute_time();
+	hrt_abstime last_update = start_time;
+	unsigned done = 0;
+	bool buffer_full = false;
+
+	while (done < num_topics && !buffer_full && hrt_elapsed_time(&last_update) < UPDATE_TIMEOUT) {
+		if (px4_poll(fds, num_topics, 100) <= 0) {
+			continue;
+		}
+
+		last_update = hrt_absolute_time();
+
+		for (unsigned i = 0; i < num_topics; i++) {
+			if (!(fds[i].revents & POLLIN)) {
+				continue;
+			}
+
+			CaptureTopic &topic = topics[i];
+			const size_t msg_size = sizeof(ulog_message_data_header_s) + topic.meta->o_size_no_padding;
+
+			/* orb_copy() writes the padded size, the message only keeps the unpadded part */
+			if (buf.pos + sizeof(ulog_message_data_header_s) + topic.meta->o_size > buf.size) {
+				buffer_full = true;
+				break;
+			}
+
+			if (topic.samples >= num_samples) {
+				/* only clear the update, keep the buffer for the other topics */
+				orb_copy(topic.meta, topic.fd, buf.data + buf.pos + sizeof(ulog_message_data_header_s));
+				continue;
+			}
+
+			ulog_message_data_header_s header;
+			header.msg_size = msg_size - ULOG_MSG_HEADER_LEN;
+			header.msg_id = i;
+			memcpy(buf.data + buf.pos, &header, sizeof(header));
+			orb_copy(topic.meta, topic.fd, buf.data + buf.pos + sizeof(header));
+			buf.pos += msg_size;
+
+			if (++topic.samples == num_samples) {
+				done++;
+			}
+		}
+	}
+
+	const hrt_abstime duration = hrt_elapsed_time(&start_time);
+
+	if (buffer_full) {
+		PX4_WARN("capture buffer full");
+
+	} else if (done < num_topics) {
+		PX4_WARN("no update for %.1f s, stopping", (double)(UPDATE_TIMEOUT / 1e6f));
+	}
+
+	int ret = PX4_OK;
+	int fd = ::open(file_name, O_CREAT | O_WRONLY | O_TRUNC, PX4_O_MODE_666);
+
+	if (fd < 0) {
+		PX4_ERR("can't open %s", file_name);
+		ret = -errno;
+
+	} else {
+		if (::write(fd, buf.data, buf.pos) != (ssize_t)buf.pos) {
+			PX4_ERR("write failed");
+			ret = -EIO;
+		}
+
+		::close(fd);
+	}
+
+	free(buf.data);
+
+	for (unsigned i = 0; i < num_topics; i++) {
+		PX4_INFO("%s:%u: %u samples", topics[i].meta->o_name, topics[i].instance, topics[i].samples);
+	}
+
+	if (ret == PX4_OK) {
+		PX4_INFO("%u bytes in %.3f s written to %s", (unsigned)buf.pos, (double)(duration / 1e6f), file_name);
+	}
+
+	return ret;
+}
+
+int rate(CaptureTopic *topics, unsigned num_topics, unsigned duration_s)
+{
+	size_t max_size = 0;
+
+	for (unsigned i = 0; i < num_topics; i++) {
+		if (topics[i].meta->o_size > max_size) {
+			max_size = topics[i].meta->o_size;
+		}
+
+		topics[i].interval_min = UINT32_MAX;
+	}
+
+	/* every topic starts with the uint64_t timestamp */
+	uint64_t *data = (uint64_t *)malloc(max_size);
+
+	if (data == nullptr) {
+		PX4_ERR("alloc failed");
+		return -ENOMEM;
+	}
+
+	px4_pollfd_struct_t fds[MAX_TOPICS] = {};
+
+	for (unsigned i = 0; i < num_topics; i++) {
+		fds[i].fd = topics[i].fd;
+		fds[i].events = POLLIN;
+	}
+
+	/* discard the current data, so that the first update is a new one */
+	for (unsigned i = 0; i < num_topics; i++) {
+		bool updated = false;
+		orb_check(topics[i].fd, &updated);
+
+		if (updated) {
+			orb_copy(topics[i].meta, topics[i].fd, data);
+		}
+	}
+
+	const hrt_abstime start_time = hrt_absolute_time();
+
+	while (hrt_elapsed_time(&start_time) < duration_s * 1000000ULL) {
+		if (px4_poll(fds, num_topics, 100) <= 0) {
+			continue;
+		}
+
+		const hrt_abstime now = hrt_absolute_time();
+
+		for (unsigned i = 0; i < num_topics; i++) {
+			if (!(fds[i].revents & POLLIN)) {
+				continue;
+			}
+
+			CaptureTopic &topic = topics[i];
+			orb_copy(topic.meta, topic.fd, data);
+
+			if (topic.samples == 0) {
+				topic.first_update = now;
+
+			} else {
+				const uint32_t interval = now - topic.last_update;
+
+				if (interval < topic.interval_min) {
+					topic.interval_min = interval;
+				}
+
+				if (interval > topic.interval_max) {
+					topic.interval_max = interval;
+				}
+			}
+
+			if (data[0] != 0 && data[0] <= now) {
+				const uint32_t latency = now - data[0];
+				topic.latency_sum += latency;
+				topic.latency_count++;
+
+				if (latency > topic.latency_max) {
+					topic.latency_max = latency;
+				}
+			}
+
+			topic.last_update = now;
+			topic.samples++;
+		}
+	}
+
+	free(data);
+
+	printf("%-28s %8s %8s %8s %8s %8s %8s\n", "topic", "updates", "rate Hz", "int min", "int max", "lat avg", "lat max");
+
+	for (unsigned i = 0; i < num_topics; i++) {
+		const CaptureTopic &topic = topics[i];
+		char name[32];
+		snprintf(name, sizeof(name), "%s:%u", topic.meta->o_name, topic.instance);
+
+		if (topic.samples < 2) {
+			printf("%-28s %8u\n", name, topic.samples);
+			continue;
+		}
+
+		const float rate_hz = (topic.samples - 1) * 1e6f / (topic.last_update - topic.first_update);
+		printf("%-28s %8u %8.1f %8u %8u %8u %8u\n", name, topic.samples, (double)rate_hz,
+		       (unsigned)topic.interval_min, (unsigned)topic.interval_max,
+		       (unsigned)(topic.latency_count > 0 ? topic.latency_sum / topic.latency_count : 0), (unsigned)topic.latency_max);
+	}
+
+	printf("intervals and latencies (update time - topic timestamp) in us\n");
+
+	return PX4_OK;
+}
+
+} // namespace
+
+int
+listener_capture_main(int argc, char *argv[])
+{
+	bool capture_mode = false;
+	bool rate_mode = false;
+	unsigned num_samples = 100;
+	unsigned buffer_kb = 32;
+	unsigned duration_s = 5;
+	const char *file_name = CAPTURE_FILE;
+
+	int myoptind = 1;
+	int ch;
+	const char *myoptarg = nullptr;
+
+	while ((ch = px4_getopt(argc, argv, "cn:b:o:rt:", &myoptind, &myoptarg)) != EOF) {
+		switch (ch) {
+		case 'c':
+			capture_mode = true;
+			break;
+
+		case 'n':
+			num_samples = strtoul(myoptarg, nullptr, 10);
+			break;
+
+		case 'b':
+			buffer_kb = strtoul(myoptarg, nullptr, 10);
+			break;
+
+		case 'o':
+			file_name = myoptarg;
+			break;
+
+		case 'r':
+			rate_mode = true;
+			break;
+
+		case 't':
+			duration_s = strtoul(myoptarg, nullptr, 10);
+			break;
+
+		default:
+			usage();
+			return -EINVAL;
+		}
+	}
+
+	const unsigned num_topics = argc - myoptind;
+
+	if (capture_mode == rate_mode || num_topics < 1 || num_topics > MAX_TOPICS || num_samples < 1
+	    || buffer_kb < 1 || buffer_kb > 1024 || duration_s < 1 || duration_s > 3600) {
+		usage();
+		return -EINVAL;
+	}
+
+	CaptureTopic topics[MAX_TOPICS] = {};
+	bool topics_valid = true;
+
+	for (unsigned i = 0; i < num_topics; i++) {
+		topics[i].fd = -1;
+	}
+
+	for (unsigned i = 0; i < num_topics && topics_valid; i++) {
+		const char *arg = argv[myoptind + i];
+		const char *separator = strchr(arg, ':');
+		const size_t name_len = separator ? (size_t)(separator - arg) : strlen(arg);
+
+		topics[i].meta = find_topic(arg, name_len);
+		topics[i].instance = separator ? strtoul(separator + 1, nullptr, 10) : 0;
+
+		if (topics[i].meta == nullptr) {
+			PX4_ERR("unknown topic %s", arg);
+			topics_valid = false;
+
+		} else if (topics[i].instance >= ORB_MULTI_MAX_INSTANCES
+			   || orb_exists(topics[i].meta, topics[i].instance) != PX4_OK) {
+			PX4_ERR("%s not advertised", arg);
+			topics_valid = false;
+
+		} else {
+			topics[i].fd = orb_subscribe_multi(topics[i].meta, topics[i].instance);
+		}
+	}
+
+	int ret = -EINVAL;
+
+	if (topics_valid) {
+		if (capture_mode) {
+			ret = capture(topics, num_topics, num_samples, buffer_kb * 1024, file_name);
+
+		} else {
+			ret = rate(topics, num_topics, duration_s);
+		}
+	}
+
+	for (unsigned i = 0; i < num_topics; i++) {
+		if (topics[i].fd >= 0) {
+			orb_unsubscribe(topics[i].fd);
+		}
+	}
+
+	return ret;
+}
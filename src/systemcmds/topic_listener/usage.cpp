@@ -47,9 +47,29 @@ Utility to listen on uORB topics and print the data to the console.
 
 Limitation: it can only listen to the first instance of a topic.
 
+Printing every field is slow, so for a running system there are two low overhead modes:
+- `-c` captures several topics into a ULog file in RAM, which is written out at the end
+  (to be analyzed with the usual log tools).
+- `-r` prints the update rate, the update interval and the latency (time of the update
+  minus the topic timestamp) of several topics.
+
+### Examples
+Capture 500 samples of the attitude and the attitude setpoint:
+$ listener -c -n 500 vehicle_attitude vehicle_attitude_setpoint
+
+Rate of the second gyro over 10 seconds:
+$ listener -r -t 10 sensor_gyro:1
+
 )DESCR_STR");
 
 	PRINT_MODULE_USAGE_NAME_SIMPLE("listener", "command");
 	PRINT_MODULE_USAGE_ARG("<topic_name> [<num_msgs>]", "uORB topic name and optionally number of messages (default=1)", false);
+	PRINT_MODULE_USAGE_PARAM_FLAG('c', "Capture the topics to a ULog file in RAM, written out at the end", true);
+	PRINT_MODULE_USAGE_PARAM_INT('n', 100, 1, 100000, "Samples per topic to capture", true);
+	PRINT_MODULE_USAGE_PARAM_INT('b', 32, 1, 1024, "Capture buffer size in KB", true);
+	PRINT_MODULE_USAGE_PARAM_STRING('o', "/fs/microsd/capture.ulg", "<file>", "Capture file", true);
+	PRINT_MODULE_USAGE_PARAM_FLAG('r', "Print the update rate, interval and latency of the topics", true);
+	PRINT_MODULE_USAGE_PARAM_INT('t', 5, 1, 3600, "Rate measurement duration in seconds", true);
+	PRINT_MODULE_USAGE_ARG("<topic>[:<instance>] ...", "Topics for -c and -r (up to 8)", true);
 }
 
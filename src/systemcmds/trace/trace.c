@@ -0,0 +1,98 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2017 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file trace.c
+ * Control and dump the event trace, see systemlib/trace.h.
+ */
+
+#include <px4_config.h>
+#include <px4_module.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <systemlib/trace.h>
+
+__EXPORT int trace_main(int argc, char *argv[]);
+
+
+static void print_usage(void)
+{
+	PRINT_MODULE_DESCRIPTION("Record a timeline of task switches, hrt callouts, uORB publications/copies and "
+				 "work queue items into a RAM ring buffer (firmware built with the TRACE cmake option). "
+				 "Fetch the dump over MAVLink FTP and convert it with Tools/trace_to_chrome.py.");
+
+	PRINT_MODULE_USAGE_NAME_SIMPLE("trace", "command");
+	PRINT_MODULE_USAGE_COMMAND_DESCR("start", "Start recording");
+	PRINT_MODULE_USAGE_COMMAND_DESCR("stop", "Stop recording");
+	PRINT_MODULE_USAGE_COMMAND_DESCR("reset", "Clear the buffer");
+	PRINT_MODULE_USAGE_COMMAND_DESCR("dump", "Write the buffer to a file");
+	PRINT_MODULE_USAGE_ARG("<file>", "Output file", false);
+	PRINT_MODULE_USAGE_COMMAND_DESCR("status", "Print the buffer state");
+}
+
+
+int trace_main(int argc, char *argv[])
+{
+	if (argc < 2) {
+		print_usage();
+		return 1;
+	}
+
+	if (strcmp(argv[1], "start") == 0) {
+		trace_enable(true);
+
+	} else if (strcmp(argv[1], "stop") == 0) {
+		trace_enable(false);
+
+	} else if (strcmp(argv[1], "reset") == 0) {
+		trace_reset();
+
+	} else if (strcmp(argv[1], "dump") == 0 && argc > 2) {
+		int ret = trace_dump(argv[2]);
+
+		if (ret != 0) {
+			PX4_ERR("dump failed (%i)", ret);
+			return 1;
+		}
+
+	} else if (strcmp(argv[1], "status") == 0) {
+		trace_print_status();
+
+	} else {
+		print_usage();
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,81 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2017 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file work_queue.c
+ * Show the work queue item statistics, see systemlib/work_queue_stats.h.
+ */
+
+#include <px4_config.h>
+#include <px4_module.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <systemlib/work_queue_stats.h>
+
+__EXPORT int work_queue_main(int argc, char *argv[]);
+
+
+static void print_usage(void)
+{
+	PRINT_MODULE_DESCRIPTION("Show the run time and schedule lateness of the work queue items, per callback. "
+				 "Unnamed callbacks are shown with their address. The load is the share of the "
+				 "CPU time since the last reset. The same data is logged as `work_item_stats`.");
+
+	PRINT_MODULE_USAGE_NAME_SIMPLE("work_queue", "command");
+	PRINT_MODULE_USAGE_COMMAND_DESCR("status", "Print the statistics");
+	PRINT_MODULE_USAGE_COMMAND_DESCR("reset", "Clear the statistics");
+}
+
+
+int work_queue_main(int argc, char *argv[])
+{
+	if (argc < 2) {
+		print_usage();
+		return 1;
+	}
+
+	if (strcmp(argv[1], "status") == 0) {
+		work_queue_stats_print();
+
+	} else if (strcmp(argv[1], "reset") == 0) {
+		work_queue_stats_reset();
+
+	} else {
+		print_usage();
+		return 1;
+	}
+
+	return 0;
+}